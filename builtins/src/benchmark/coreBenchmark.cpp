@@ -0,0 +1,876 @@
+//////////////////////////////////////////////////////////////////////////////
+// Benchmark of the OpenCV based cores on the images of visiondata
+//
+// Runs each core through its C API, as the generated code calls it, on the
+// images the examples use:
+//
+//   disparityBM    visiondata/NewTsukuba; consecutive frames stand in for
+//                  the left and right images, the cost of block matching
+//                  does not depend on the images being a true stereo pair
+//   farneback      visiondata/NewTsukuba, stateful object, frames in order
+//   detectFAST     visiondata/calibration, all the boards
+//   detectBRISK    visiondata/calibration, with 0 to 4 octaves, once with
+//                  the AGAST decision trees and once with the compact
+//                  corner scores, see detectBRISK_setScoreMethod
+//   cascade        visiondata/stopSignImages, with the cascade of -c
+//   HOG            visiondata/vehicles, default people detector
+//   matchFeatures  visiondata/bookCovers; FREAK descriptors of FAST corners
+//                  are extracted before the timing, and each cover is
+//                  matched against the next one with the exhaustive search
+//   foreground     visiondata/NewTsukuba, uint8 images with single
+//                  precision statistics, with -DBENCHMARK_WITH_FOREGROUND
+//
+// Every core is swept over the resolutions of -s, the images being resized
+// by that factor, and over the thread counts of -t, or 1 to N with -T N,
+// which are set with cgSetNumThreads and foregroundDetector_setNumThreads.
+// Each run calls the core on the images of its data set in turn, after one
+// untimed call, until it has seen every image and -m seconds have passed.
+//
+// For scalability, the run with the fewest threads of each resolution is
+// the baseline of the others: speedup is its time over the time of the
+// run, and efficiency the speedup divided by the ratio of their thread
+// counts. An efficiency well below 1 means the extra threads are wasted.
+//
+// The results are printed as a table and written with -o as JSON, in the
+// layout of Google Benchmark, so that two releases can be compared with its
+// tools (e.g. compare.py benchmarks old.json new.json). real_time is the
+// mean wall time of a call and cpu_time the mean process time, both in ms;
+// items_per_second counts input pixels.
+//
+// Build it with the sources of libmwcvstrt and OpenCV, e.g.
+//
+//   g++ -O2 -std=c++11 -DPARALLEL -I<ocv/include> -I<opencv/include>
+//       coreBenchmark.cpp <ocv/*.cpp> -lopencv_world -lpthread
+//
+// and add -DBENCHMARK_WITH_FOREGROUND and the foreground detector library,
+// which links TBB, to run the foreground detector. Run it from the root of
+// the repository, or point -r at it.
+//
+// Usage:
+//   coreBenchmark [-r root] [-s scale]... [-t numThreads]... [-T maxThreads]
+//                 [-n numImages] [-m seconds] [-c cascade] [-b core]...
+//                 [-o file.json]
+//
+// Copyright 2016 The MathWorks, Inc.
+//
+//////////////////////////////////////////////////////////////////////////////
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <algorithm>
+#include <chrono>
+#include <ctime>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "cgThreadPool.hpp"
+#include "CascadeClassifierCore_api.hpp"
+#include "HOGDescriptorCore_api.hpp"
+#include "detectBRISKCore_api.hpp"
+#include "detectFASTCore_api.hpp"
+#include "disparityBMCore_api.hpp"
+#include "extractFreakCore_api.hpp"
+#include "matchFeaturesCore_api.hpp"
+#include "opticalFlowFarnebackCore_api.hpp"
+
+#ifdef BENCHMARK_WITH_FOREGROUND
+#include "foregroundDetector_published_c_api.hpp"
+#endif
+
+#include "opencv2/opencv.hpp"
+
+namespace
+{
+
+const char *DEFAULT_CASCADE =
+    "visionutilities/classifierdata/cascade/haar/haarcascade_frontalface_alt2.xml";
+
+// FAST threshold of detectFASTFeatures, MinContrast = 0.2
+const int FAST_THRESHOLD = 51;
+
+// BRISK threshold of detectBRISKFeatures, MinContrast = 0.2
+const int BRISK_THRESHOLD = 51;
+
+//////////////////////////////////////////////////////////////////////////////
+// Cores. begin() does the untimed setup of a run on the given images, which
+// are continuous row major CV_8UC1; step() calls the core on image k.
+//////////////////////////////////////////////////////////////////////////////
+class Core
+{
+public:
+    virtual ~Core() {}
+    virtual const char *name() const = 0;
+
+    // name selected with -b, shared by the variants of a core
+    virtual const char *group() const { return name(); }
+
+    // directory of the images, relative to visiondata, and whether the
+    // images are searched for in its subdirectories too
+    virtual const char *dataset() const = 0;
+    virtual bool isRecursive() const { return false; }
+
+    // true if all the images must have the size of the first one
+    virtual bool isSameSize() const { return false; }
+
+    virtual bool begin(std::vector<cv::Mat> &images) { (void)images; return true; }
+    virtual void step(std::vector<cv::Mat> &images, size_t k) = 0;
+    virtual void end() {}
+};
+
+class CoreDisparityBM : public Core
+{
+public:
+    CoreDisparityBM() : mObj(NULL) {}
+    const char *name() const { return "disparityBM"; }
+    const char *dataset() const { return "NewTsukuba"; }
+    bool isSameSize() const { return true; }
+
+    bool begin(std::vector<cv::Mat> &images)
+    {
+        // defaults of disparityBM
+        mParams.preFilterCap        = 31;
+        mParams.SADWindowSize       = 15;
+        mParams.minDisparity        = 0;
+        mParams.numberOfDisparities = 64;
+        mParams.textureThreshold    = 0;
+        mParams.uniquenessRatio     = 15;
+        mParams.disp12MaxDiff       = -1;
+        mParams.preFilterType       = 1;
+        mParams.preFilterSize       = 9;
+        mParams.speckleWindowSize   = 0;
+        mParams.speckleRange        = 0;
+        mParams.trySmallerWindows   = 0;
+        mParams.useGPU              = 0;
+        mParams.numStrips           = 0;
+        mParams.coarseToFine        = 0;
+
+        mDisparity.resize(images[0].total());
+        disparityBM_construct(&mObj);
+        return images.size() >= 2;
+    }
+
+    void step(std::vector<cv::Mat> &images, size_t k)
+    {
+        const cv::Mat &left = images[k];
+        const cv::Mat &right = images[(k + 1) % images.size()];
+        disparityBM_stepRM(mObj, left.data, right.data, left.rows, left.cols,
+                           &mDisparity[0], &mParams);
+    }
+
+    void end()
+    {
+        if (mObj)
+            disparityBM_deleteObj(mObj);
+        mObj = NULL;
+    }
+
+private:
+    void *mObj;
+    cvstDBMStruct_T mParams;
+    std::vector<real32_T> mDisparity;
+};
+
+class CoreFarneback : public Core
+{
+public:
+    CoreFarneback() : mObj(NULL) {}
+    const char *name() const { return "farneback"; }
+    const char *dataset() const { return "NewTsukuba"; }
+    bool isSameSize() const { return true; }
+
+    bool begin(std::vector<cv::Mat> &images)
+    {
+        // defaults of opticalFlowFarneback
+        mParams.pyr_scale  = 0.5;
+        mParams.poly_sigma = 1.1;
+        mParams.levels     = 3;
+        mParams.winsize    = 15;
+        mParams.iterations = 3;
+        mParams.poly_n     = 5;
+        mParams.flags      = 0;
+
+        mFlow.resize(2*images[0].total());
+        opticalFlowFarneback_construct(&mObj);
+        return true;
+    }
+
+    void step(std::vector<cv::Mat> &images, size_t k)
+    {
+        opticalFlowFarneback_stepRM(mObj, images[k].data, &mFlow[0], &mParams,
+                                    images[k].rows, images[k].cols);
+    }
+
+    void end()
+    {
+        if (mObj)
+            opticalFlowFarneback_deleteObj(mObj);
+        mObj = NULL;
+    }
+
+private:
+    void *mObj;
+    cvstFarnebackStruct_T mParams;
+    std::vector<float> mFlow;
+};
+
+class CoreFAST : public Core
+{
+public:
+    const char *name() const { return "detectFAST"; }
+    const char *dataset() const { return "calibration"; }
+    bool isRecursive() const { return true; }
+
+    void step(std::vector<cv::Mat> &images, size_t k)
+    {
+        cv::Mat &img = images[k];
+        void *keypoints = NULL;
+        const int32_T numel = detectFAST_computeRM(img.data, img.rows, img.cols,
+                                                   0, FAST_THRESHOLD, &keypoints);
+        mLoc.resize(2*numel + 2);
+        mMetric.resize(numel + 1);
+        detectFAST_assignOutputRM(keypoints, &mLoc[0], &mMetric[0]);
+    }
+
+private:
+    std::vector<real32_T> mLoc, mMetric;
+};
+
+class CoreBRISK : public Core
+{
+public:
+    CoreBRISK(int scoreMethod, int numOctaves)
+        : mScoreMethod(scoreMethod), mNumOctaves(numOctaves), mSavedMethod(0)
+    {
+        sprintf(mName, "detectBRISK/%s/octaves:%d",
+                (scoreMethod == BRISK_SCORE_TREE) ? "tree" : "compact", numOctaves);
+    }
+
+    const char *name() const { return mName; }
+    const char *group() const { return "detectBRISK"; }
+    const char *dataset() const { return "calibration"; }
+    bool isRecursive() const { return true; }
+
+    bool begin(std::vector<cv::Mat> &images)
+    {
+        (void)images;
+        mSavedMethod = detectBRISK_getScoreMethod();
+        detectBRISK_setScoreMethod(mScoreMethod);
+        return true;
+    }
+
+    void step(std::vector<cv::Mat> &images, size_t k)
+    {
+        cv::Mat &img = images[k];
+        void *keypoints = NULL;
+        const int32_T numel = detectBRISK_detectRM(img.data, img.rows, img.cols,
+                                                   BRISK_THRESHOLD, mNumOctaves,
+                                                   &keypoints);
+        mLoc.resize(2*numel + 2);
+        mMetric.resize(numel + 1);
+        mScale.resize(numel + 1);
+        mOrientation.resize(numel + 1);
+        detectBRISK_assignOutputsRM(keypoints, &mLoc[0], &mMetric[0],
+                                    &mScale[0], &mOrientation[0]);
+    }
+
+    void end()
+    {
+        detectBRISK_setScoreMethod(mSavedMethod);
+    }
+
+private:
+    int mScoreMethod;
+    int mNumOctaves;
+    int mSavedMethod;
+    char mName[64];
+    std::vector<real32_T> mLoc, mMetric, mScale, mOrientation;
+};
+
+class CoreCascade : public Core
+{
+public:
+    CoreCascade(const std::string &cascadeFile) : mCascadeFile(cascadeFile), mObj(NULL) {}
+
+    const char *name() const { return "cascade"; }
+    const char *dataset() const { return "stopSignImages"; }
+
+    bool begin(std::vector<cv::Mat> &images)
+    {
+        (void)images;
+        FILE *f = fopen(mCascadeFile.c_str(), "rb");
+        if (!f)
+        {
+            fprintf(stderr, "%s: cannot read the cascade\n", mCascadeFile.c_str());
+            return false;
+        }
+        fclose(f);
+
+        cascadeClassifier_construct(&mObj);
+        cascadeClassifier_load(mObj, mCascadeFile.c_str());
+        return true;
+    }
+
+    void step(std::vector<cv::Mat> &images, size_t k)
+    {
+        cv::Mat &img = images[k];
+        int32_T minSize[2] = { 0, 0 };
+        int32_T maxSize[2] = { 0, 0 };
+        void *detected = NULL;
+        const int32_T numel = cascadeClassifier_detectMultiScale(mObj, &detected,
+            img.data, img.rows, img.cols, 1.1, 4, minSize, maxSize);
+        mBBox.resize(4*numel + 4);
+        cascadeClassifier_assignOutputDeleteBboxRM(detected, &mBBox[0]);
+    }
+
+    void end()
+    {
+        if (mObj)
+            cascadeClassifier_deleteObj(mObj);
+        mObj = NULL;
+    }
+
+private:
+    std::string mCascadeFile;
+    void *mObj;
+    std::vector<int32_T> mBBox;
+};
+
+class CoreHOG : public Core
+{
+public:
+    CoreHOG() : mObj(NULL) {}
+    const char *name() const { return "HOG"; }
+    const char *dataset() const { return "vehicles"; }
+
+    bool begin(std::vector<cv::Mat> &images)
+    {
+        (void)images;
+        HOGDescriptor_construct(&mObj);
+        HOGDescriptor_setup(mObj, 1);
+        return true;
+    }
+
+    void step(std::vector<cv::Mat> &images, size_t k)
+    {
+        // defaults of peopleDetector
+        cv::Mat &img = images[k];
+        int32_T minSize[2] = { 128, 64 };
+        int32_T maxSize[2] = { img.rows, img.cols };
+        int32_T winStride[2] = { 8, 8 };
+        void *detected = NULL;
+        void *scores = NULL;
+        int32_T numDetected = 0, numScores = 0;
+        HOGDescriptor_detectMultiScaleRM(mObj, &detected, &scores,
+            img.data, img.rows, img.cols, false, 1.05, 1, 0.65,
+            minSize, maxSize, winStride, true, &numDetected, &numScores);
+        mBBox.resize(4*numDetected + 4);
+        mScores.resize(numScores + 1);
+        HOGDescriptor_assignOutputDeleteVectorsRM(detected, scores,
+                                                  &mBBox[0], &mScores[0]);
+    }
+
+    void end()
+    {
+        if (mObj)
+            HOGDescriptor_deleteObj(mObj);
+        mObj = NULL;
+    }
+
+private:
+    void *mObj;
+    std::vector<int32_T> mBBox;
+    std::vector<double> mScores;
+};
+
+class CoreMatchFeatures : public Core
+{
+public:
+    const char *name() const { return "matchFeatures"; }
+    const char *dataset() const { return "bookCovers"; }
+
+    bool begin(std::vector<cv::Mat> &images)
+    {
+        mFeatures.clear();
+        mFeatures.resize(images.size());
+        size_t maxNumFeatures = 0;
+        for (size_t k = 0; k < images.size(); k++)
+        {
+            describe(images[k], mFeatures[k]);
+            maxNumFeatures = std::max(maxNumFeatures, mFeatures[k].size()/DESCRIPTOR_LEN);
+        }
+        mIndexPairs.resize(2*maxNumFeatures*NUM_NEIGHBORS + 2);
+        mDist.resize(maxNumFeatures*NUM_NEIGHBORS + 1);
+        return images.size() >= 2;
+    }
+
+    void step(std::vector<cv::Mat> &images, size_t k)
+    {
+        const std::vector<uint8_T> &features1 = mFeatures[k];
+        const std::vector<uint8_T> &features2 = mFeatures[(k + 1) % images.size()];
+        const int32_T numFeatures1 = (int32_T)(features1.size()/DESCRIPTOR_LEN);
+        const int32_T numFeatures2 = (int32_T)(features2.size()/DESCRIPTOR_LEN);
+        if (numFeatures1 == 0 || numFeatures2 < NUM_NEIGHBORS)
+            return;
+        findExactNearestNeighbors_uint8(&features1[0], &features2[0],
+            numFeatures1, numFeatures2, DESCRIPTOR_LEN, NUM_NEIGHBORS,
+            &mIndexPairs[0], &mDist[0]);
+    }
+
+private:
+    // FREAK descriptors are 512 bits; the ratio test needs two neighbors
+    static const int32_T DESCRIPTOR_LEN = 64;
+    static const int32_T NUM_NEIGHBORS = 2;
+
+    // FREAK descriptors of the FAST corners of img, one per row
+    static void describe(cv::Mat &img, std::vector<uint8_T> &features)
+    {
+        void *keypoints = NULL;
+        const int32_T numel = detectFAST_computeRM(img.data, img.rows, img.cols,
+                                                   0, FAST_THRESHOLD, &keypoints);
+        std::vector<real32_T> loc(2*numel + 2), metric(numel + 1);
+        detectFAST_assignOutputRM(keypoints, &loc[0], &metric[0]);
+
+        // the scale extractFeatures gives to corners
+        std::vector<real32_T> scale(numel + 1, 12.0f);
+        std::vector<int32_T> misc(numel + 1, 0);
+        void *described = NULL;
+        void *descriptors = NULL;
+        const int32_T numDescribed = extractFreak_computeRM(img.data, img.rows,
+            img.cols, 2, &loc[0], &scale[0], &metric[0], &misc[0], numel,
+            4, true, true, 22.0f, &described, &descriptors);
+
+        std::vector<real32_T> outLoc(2*numDescribed + 2), outScale(numDescribed + 1);
+        std::vector<real32_T> outMetric(numDescribed + 1), outOrientation(numDescribed + 1);
+        std::vector<int32_T> outMisc(numDescribed + 1);
+        features.resize(numDescribed*DESCRIPTOR_LEN + 1);
+        extractFreak_assignOutputRM(described, descriptors, &outLoc[0], &outScale[0],
+            &outMetric[0], &outMisc[0], &outOrientation[0], &features[0]);
+        features.resize(numDescribed*DESCRIPTOR_LEN);
+    }
+
+    std::vector<std::vector<uint8_T> > mFeatures;
+    std::vector<int32_T> mIndexPairs, mDist;
+};
+
+#ifdef BENCHMARK_WITH_FOREGROUND
+class CoreForeground : public Core
+{
+public:
+    CoreForeground() : mObj(NULL) {}
+    const char *name() const { return "foreground"; }
+    const char *dataset() const { return "NewTsukuba"; }
+    bool isSameSize() const { return true; }
+
+    bool begin(std::vector<cv::Mat> &images)
+    {
+        // defaults of vision.ForegroundDetector for uint8 images
+        int32_T dims[2] = { images[0].rows, images[0].cols };
+        foregroundDetector_construct_uint8_float(&mObj);
+        foregroundDetector_initialize_uint8_float(mObj, 2, dims, 5,
+            30.0f*30.0f, 0.05f, 2.5f*2.5f, 0.7f);
+        mMask.resize(images[0].total());
+        return true;
+    }
+
+    void step(std::vector<cv::Mat> &images, size_t k)
+    {
+        foregroundDetector_step_rowMaj_uint8_float(mObj, images[k].data,
+                                                   &mMask[0], 0.005f);
+    }
+
+    void end()
+    {
+        if (mObj)
+            foregroundDetector_deleteObj_uint8_float(mObj);
+        mObj = NULL;
+    }
+
+private:
+    void *mObj;
+    std::vector<boolean_T> mMask;
+};
+#endif
+
+//////////////////////////////////////////////////////////////////////////////
+// Images
+//////////////////////////////////////////////////////////////////////////////
+
+// reads up to maxNumImages images of dir in name order, as grayscale
+std::vector<cv::Mat> readImages(const std::string &dir, bool isRecursive,
+                                bool isSameSize, int maxNumImages)
+{
+    std::vector<cv::String> files;
+    cv::glob(dir, files, isRecursive);
+    std::sort(files.begin(), files.end());
+
+    std::vector<cv::Mat> images;
+    for (size_t k = 0; k < files.size() && (int)images.size() < maxNumImages; k++)
+    {
+        cv::Mat img = cv::imread(files[k], cv::IMREAD_GRAYSCALE);
+        if (img.empty())
+            continue;
+        if (isSameSize && !images.empty() && img.size() != images[0].size())
+            continue;
+        images.push_back(img);
+    }
+    return images;
+}
+
+// images resized by scale, continuous
+std::vector<cv::Mat> resizeImages(const std::vector<cv::Mat> &images, double scale)
+{
+    std::vector<cv::Mat> resized(images.size());
+    for (size_t k = 0; k < images.size(); k++)
+    {
+        if (scale == 1)
+        {
+            resized[k] = images[k].clone();
+            continue;
+        }
+        const cv::Size size(std::max(cvRound(images[k].cols*scale), 1),
+                            std::max(cvRound(images[k].rows*scale), 1));
+        cv::resize(images[k], resized[k], size, 0, 0,
+                   (scale < 1) ? cv::INTER_AREA : cv::INTER_LINEAR);
+    }
+    return resized;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// Measurement
+//////////////////////////////////////////////////////////////////////////////
+struct Result
+{
+    std::string name;
+    double scale;
+    int numThreads;
+    int rows;       // of the first image
+    int cols;
+    int iterations; // 0 if the core could not run
+    double meanMs;
+    double medianMs;
+    double minMs;
+    double cpuMs;
+    double mpixPerSec;
+    double speedup;    // negative for the baseline of a resolution
+    double efficiency;
+};
+
+void setNumThreads(int numThreads)
+{
+    // cgSetNumThreads also sets the threads of cv::parallel_for_
+    cgSetNumThreads(numThreads);
+#ifdef BENCHMARK_WITH_FOREGROUND
+    foregroundDetector_setNumThreads(numThreads);
+#endif
+}
+
+Result runCore(Core &core, std::vector<cv::Mat> &images, double scale,
+               int numThreads, double minSeconds)
+{
+    Result res;
+    char name[128];
+    sprintf(name, "%s/%s/scale:%.2f/threads:%d", core.name(), core.dataset(),
+            scale, numThreads);
+    res.name = name;
+    res.scale = scale;
+    res.numThreads = numThreads;
+    res.rows = images[0].rows;
+    res.cols = images[0].cols;
+    res.iterations = 0;
+    res.meanMs = res.medianMs = res.minMs = res.cpuMs = res.mpixPerSec = -1;
+    res.speedup = res.efficiency = -1;
+
+    setNumThreads(numThreads);
+    if (!core.begin(images))
+    {
+        core.end();
+        return res;
+    }
+
+    // the first call warms up caches and lazy allocations
+    core.step(images, 0);
+
+    std::vector<double> ms;
+    double seconds = 0;
+    double pixels = 0;
+    const std::clock_t c0 = std::clock();
+    size_t k = 0;
+    while (ms.size() < images.size() || seconds < minSeconds)
+    {
+        std::chrono::steady_clock::time_point t0 = std::chrono::steady_clock::now();
+        core.step(images, k);
+        std::chrono::steady_clock::time_point t1 = std::chrono::steady_clock::now();
+
+        const double dt = std::chrono::duration<double>(t1 - t0).count();
+        ms.push_back(1000*dt);
+        seconds += dt;
+        pixels += (double)images[k].total();
+        k = (k + 1) % images.size();
+    }
+    const std::clock_t c1 = std::clock();
+    core.end();
+
+    std::sort(ms.begin(), ms.end());
+    res.iterations = (int)ms.size();
+    res.meanMs     = 1000*seconds/ms.size();
+    res.medianMs   = ms[ms.size()/2];
+    res.minMs      = ms[0];
+    res.cpuMs      = 1000.0*(c1 - c0)/CLOCKS_PER_SEC/ms.size();
+    res.mpixPerSec = pixels/seconds/1e6;
+    return res;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// Output
+//////////////////////////////////////////////////////////////////////////////
+bool writeJson(const char *filename, const char *executable, const std::string &root,
+               const std::vector<Result> &results)
+{
+    FILE *f = fopen(filename, "w");
+    if (!f)
+        return false;
+
+    char date[64];
+    const time_t now = time(NULL);
+    strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%S", localtime(&now));
+
+    fprintf(f, "{\n  \"context\": {\n");
+    fprintf(f, "    \"date\": \"%s\",\n", date);
+    fprintf(f, "    \"executable\": \"%s\",\n", executable);
+    fprintf(f, "    \"num_cpus\": %u,\n", std::thread::hardware_concurrency());
+#ifdef PARALLEL
+    fprintf(f, "    \"library_build_type\": \"parallel\",\n");
+#else
+    fprintf(f, "    \"library_build_type\": \"serial\",\n");
+#endif
+    fprintf(f, "    \"opencv_version\": \"%s\",\n", CV_VERSION);
+    fprintf(f, "    \"data_root\": \"%s\"\n", root.c_str());
+    fprintf(f, "  },\n  \"benchmarks\": [");
+
+    bool isFirst = true;
+    for (size_t r = 0; r < results.size(); r++)
+    {
+        const Result &res = results[r];
+        if (res.iterations == 0)
+            continue;
+        fprintf(f, "%s\n    {\n", isFirst ? "" : ",");
+        fprintf(f, "      \"name\": \"%s\",\n", res.name.c_str());
+        fprintf(f, "      \"run_name\": \"%s\",\n", res.name.c_str());
+        fprintf(f, "      \"run_type\": \"iteration\",\n");
+        fprintf(f, "      \"iterations\": %d,\n", res.iterations);
+        fprintf(f, "      \"real_time\": %.6f,\n", res.meanMs);
+        fprintf(f, "      \"cpu_time\": %.6f,\n", res.cpuMs);
+        fprintf(f, "      \"time_unit\": \"ms\",\n");
+        fprintf(f, "      \"median_time\": %.6f,\n", res.medianMs);
+        fprintf(f, "      \"min_time\": %.6f,\n", res.minMs);
+        fprintf(f, "      \"scale\": %.4f,\n", res.scale);
+        fprintf(f, "      \"threads\": %d,\n", res.numThreads);
+        fprintf(f, "      \"rows\": %d,\n", res.rows);
+        fprintf(f, "      \"cols\": %d,\n", res.cols);
+        if (res.speedup > 0)
+        {
+            fprintf(f, "      \"speedup\": %.4f,\n", res.speedup);
+            fprintf(f, "      \"efficiency\": %.4f,\n", res.efficiency);
+        }
+        fprintf(f, "      \"items_per_second\": %.1f\n", res.mpixPerSec*1e6);
+        fprintf(f, "    }");
+        isFirst = false;
+    }
+    fprintf(f, "\n  ]\n}\n");
+    return fclose(f) == 0;
+}
+
+void usage(const char *prog)
+{
+    printf("usage: %s [-r root] [-s scale]... [-t numThreads]... [-T maxThreads]\n"
+           "       [-n numImages] [-m seconds] [-c cascade] [-b core]... [-o file.json]\n"
+           "  -r  root of the repository (default .)\n"
+           "  -s  resolution factor of the images (default 0.5, 1)\n"
+           "  -t  number of threads (default 1, 2, 4, ... up to the number of cores)\n"
+           "  -T  run every number of threads from 1 to maxThreads\n"
+           "  -n  maximum number of images of each data set (default 20)\n"
+           "  -m  minimum time of each run in seconds (default 0.5)\n"
+           "  -c  cascade of the cascade core, relative to the root\n"
+           "      (default %s)\n"
+           "  -b  core to run (default all): disparityBM, farneback, detectFAST,\n"
+           "      detectBRISK, cascade, HOG, matchFeatures, foreground\n"
+           "  -o  JSON file of the results\n", prog, DEFAULT_CASCADE);
+}
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+    std::string root = ".";
+    std::string cascade = DEFAULT_CASCADE;
+    std::vector<double> scales;
+    std::vector<int> threads;
+    std::vector<std::string> selected;
+    const char *jsonFile = NULL;
+    int maxNumImages = 20;
+    double minSeconds = 0.5;
+
+    for (int k = 1; k < argc; k++)
+    {
+        const bool hasValue = (k + 1 < argc);
+        if (!strcmp(argv[k], "-r") && hasValue)
+        {
+            root = argv[++k];
+        }
+        else if (!strcmp(argv[k], "-s") && hasValue && atof(argv[k+1]) > 0)
+        {
+            scales.push_back(atof(argv[++k]));
+        }
+        else if (!strcmp(argv[k], "-t") && hasValue && atoi(argv[k+1]) > 0)
+        {
+            threads.push_back(atoi(argv[++k]));
+        }
+        else if (!strcmp(argv[k], "-T") && hasValue && atoi(argv[k+1]) > 0)
+        {
+            const int maxThreads = atoi(argv[++k]);
+            for (int t = 1; t <= maxThreads; t++)
+                threads.push_back(t);
+        }
+        else if (!strcmp(argv[k], "-n") && hasValue && atoi(argv[k+1]) >= 2)
+        {
+            maxNumImages = atoi(argv[++k]);
+        }
+        else if (!strcmp(argv[k], "-m") && hasValue && atof(argv[k+1]) >= 0)
+        {
+            minSeconds = atof(argv[++k]);
+        }
+        else if (!strcmp(argv[k], "-c") && hasValue)
+        {
+            cascade = argv[++k];
+        }
+        else if (!strcmp(argv[k], "-b") && hasValue)
+        {
+            selected.push_back(argv[++k]);
+        }
+        else if (!strcmp(argv[k], "-o") && hasValue)
+        {
+            jsonFile = argv[++k];
+        }
+        else
+        {
+            usage(argv[0]);
+            return 1;
+        }
+    }
+    if (scales.empty())
+    {
+        scales.push_back(0.5);
+        scales.push_back(1);
+    }
+    if (threads.empty())
+    {
+        const int numCores = std::max((int)std::thread::hardware_concurrency(), 1);
+        for (int t = 1; t < numCores; t *= 2)
+            threads.push_back(t);
+        threads.push_back(numCores);
+    }
+
+    // the fewest threads first, as the baseline of the speedup
+    std::sort(threads.begin(), threads.end());
+    threads.erase(std::unique(threads.begin(), threads.end()), threads.end());
+
+    CoreDisparityBM disparityBM;
+    CoreFarneback farneback;
+    CoreFAST fast;
+    std::vector<CoreBRISK> brisk;
+    for (int m = BRISK_SCORE_TREE; m <= BRISK_SCORE_COMPACT; m++)
+        for (int numOctaves = 0; numOctaves <= 4; numOctaves++)
+            brisk.push_back(CoreBRISK(m, numOctaves));
+    CoreCascade cascadeCore(root + "/" + cascade);
+    CoreHOG hog;
+    CoreMatchFeatures matchFeatures;
+    std::vector<Core *> all;
+    all.push_back(&disparityBM);
+    all.push_back(&farneback);
+    all.push_back(&fast);
+    for (size_t b = 0; b < brisk.size(); b++)
+        all.push_back(&brisk[b]);
+    all.push_back(&cascadeCore);
+    all.push_back(&hog);
+    all.push_back(&matchFeatures);
+#ifdef BENCHMARK_WITH_FOREGROUND
+    CoreForeground foreground;
+    all.push_back(&foreground);
+#endif
+
+    std::vector<Core *> cores;
+    for (size_t c = 0; c < all.size(); c++)
+    {
+        if (selected.empty() ||
+            std::find(selected.begin(), selected.end(), all[c]->group()) != selected.end())
+            cores.push_back(all[c]);
+    }
+    if (cores.empty())
+    {
+        usage(argv[0]);
+        return 1;
+    }
+
+    std::vector<Result> results;
+    for (size_t c = 0; c < cores.size(); c++)
+    {
+        const std::string dir = root + "/visiondata/" + cores[c]->dataset();
+        std::vector<cv::Mat> images = readImages(dir, cores[c]->isRecursive(),
+                                                 cores[c]->isSameSize(), maxNumImages);
+        if (images.empty())
+        {
+            fprintf(stderr, "%s: no images\n", dir.c_str());
+            continue;
+        }
+
+        printf("\n%s, %d images of %s\n", cores[c]->name(), (int)images.size(), dir.c_str());
+        printf("%-8s%-12s%8s%10s%10s%10s%10s%10s%10s%10s\n", "scale", "size",
+               "threads", "calls", "ms/call", "median", "min", "MPix/s",
+               "speedup", "effic.");
+        for (size_t s = 0; s < scales.size(); s++)
+        {
+            std::vector<cv::Mat> scaled = resizeImages(images, scales[s]);
+            Result base;
+            for (size_t t = 0; t < threads.size(); t++)
+            {
+                Result res = runCore(*cores[c], scaled, scales[s], threads[t], minSeconds);
+                if (res.iterations == 0)
+                {
+                    fprintf(stderr, "%s: the core could not run\n", res.name.c_str());
+                    break;
+                }
+                if (t == 0)
+                {
+                    base = res;
+                }
+                else
+                {
+                    res.speedup = base.meanMs/res.meanMs;
+                    res.efficiency = res.speedup*base.numThreads/res.numThreads;
+                }
+                results.push_back(res);
+
+                char size[32];
+                sprintf(size, "%dx%d", res.rows, res.cols);
+                printf("%-8.2f%-12s%8d%10d%10.2f%10.2f%10.2f%10.2f", res.scale, size,
+                       res.numThreads, res.iterations, res.meanMs, res.medianMs,
+                       res.minMs, res.mpixPerSec);
+                if (t == 0)
+                    printf("%10s%10s\n", "-", "-");
+                else
+                    printf("%10.2f%10.2f\n", res.speedup, res.efficiency);
+            }
+        }
+    }
+
+    if (jsonFile && !writeJson(jsonFile, argv[0], root, results))
+    {
+        fprintf(stderr, "%s: cannot write the results\n", jsonFile);
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,756 @@
+//////////////////////////////////////////////////////////////////////////////
+// Dense optical flow benchmark
+//
+// Runs the Horn-Schunck, Lucas-Kanade, Lucas-Kanade DoG and Farneback
+// implementations on the same frames and reports, for each of them:
+//
+//   ms/frame  mean time of one call
+//   MPix/s    input pixels processed per second
+//   peak MB   peak resident memory of the run; each run creates its frames
+//             in a child process, so the value is not shared between runs
+//   EPE       mean endpoint error against the ground truth flow
+//
+// The synthetic sequences translate a smooth texture by a known subpixel
+// velocity, so the endpoint error is known at any resolution. Image
+// sequences (e.g. visiondata/NewTsukuba) have no ground truth, so only the
+// timing and memory are reported; they are read with OpenCV. All the
+// algorithms use the default properties of their objects, and the
+// coarse-to-fine ones use NUM_PYR_LEVELS levels.
+//
+// Build it with the sources of libmwcvstrt, e.g.
+//
+//   g++ -O2 -std=c++11 -DPARALLEL -I<vision/include> -I<ocv/include>
+//       opticalFlowBenchmark.cpp <vision/*.cpp> -lpthread
+//
+// and add -DBENCHMARK_WITH_OPENCV, ocv/opticalFlowFarnebackCore.cpp and the
+// OpenCV libraries to run Farneback and to read image sequences.
+//
+// Usage:
+//   opticalFlowBenchmark [-s ROWSxCOLS]... [-n numFrames] [-d dir]
+//                        [-a algorithm]...
+//
+// Copyright 2016 The MathWorks, Inc.
+//
+//////////////////////////////////////////////////////////////////////////////
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <algorithm>
+#include <chrono>
+#include <string>
+#include <vector>
+
+#ifndef _WIN32
+#include <sys/resource.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+#include "opticalFlowHSCore_api.hpp"
+#include "opticalFlowLKCore_api.hpp"
+#include "opticalFlowLKDoGCore_api.hpp"
+
+#ifdef BENCHMARK_WITH_OPENCV
+#include "opticalFlowFarnebackCore_api.hpp"
+#include "opencv2/opencv.hpp"
+#endif
+
+namespace
+{
+
+// velocity of the synthetic sequences, in pixels per frame
+const real32_T SYNTH_VEL_C = 0.9f;
+const real32_T SYNTH_VEL_R = 0.6f;
+
+// pixels closer than this to the border are not used for the endpoint error
+const int EPE_BORDER = 8;
+
+// number of pyramid levels of the coarse-to-fine algorithms
+const int32_T NUM_PYR_LEVELS = 4;
+
+//////////////////////////////////////////////////////////////////////////////
+// A sequence of column major uint8 frames of the same size
+//////////////////////////////////////////////////////////////////////////////
+struct Sequence
+{
+    int_T inRows;
+    int_T inCols;
+    std::vector<std::vector<uint8_T> > frames;
+    bool hasGroundTruth;
+};
+
+// texture with enough contrast for the default noise thresholds
+inline real32_T texture(real32_T r, real32_T c)
+{
+    return 127.5f + 55.0f*sinf(0.55f*r + 0.35f*c)
+                  + 45.0f*cosf(0.30f*r - 0.60f*c)
+                  + 20.0f*sinf(0.11f*r)*cosf(0.13f*c);
+}
+
+Sequence makeSynthetic(int_T inRows, int_T inCols, int numFrames)
+{
+    Sequence seq;
+    seq.inRows = inRows;
+    seq.inCols = inCols;
+    seq.hasGroundTruth = true;
+    seq.frames.resize(numFrames);
+
+    for (int t = 0; t < numFrames; t++)
+    {
+        std::vector<uint8_T> &f = seq.frames[t];
+        f.resize(inRows*inCols);
+        // frame t is frame 0 moved by t times the velocity
+        for (int_T j = 0; j < inCols; j++)
+        {
+            for (int_T i = 0; i < inRows; i++)
+            {
+                real32_T v = texture(i - t*SYNTH_VEL_R, j - t*SYNTH_VEL_C);
+                f[i + j*inRows] = (uint8_T)(v + 0.5f);
+            }
+        }
+    }
+    return seq;
+}
+
+#ifdef BENCHMARK_WITH_OPENCV
+// reads the images of dir in name order, as grayscale
+bool readSequence(const std::string &dir, int numFrames, Sequence &seq)
+{
+    std::vector<cv::String> files;
+    cv::glob(dir + "/*", files, false);
+    std::sort(files.begin(), files.end());
+
+    seq.hasGroundTruth = false;
+    for (size_t k = 0; k < files.size() && (int)seq.frames.size() < numFrames; k++)
+    {
+        cv::Mat img = cv::imread(files[k], cv::IMREAD_GRAYSCALE);
+        if (img.empty())
+            continue;
+        if (seq.frames.empty())
+        {
+            seq.inRows = img.rows;
+            seq.inCols = img.cols;
+        }
+        else if (img.rows != seq.inRows || img.cols != seq.inCols)
+        {
+            continue;
+        }
+
+        // OpenCV is row major
+        std::vector<uint8_T> f(img.rows*img.cols);
+        for (int i = 0; i < img.rows; i++)
+            for (int j = 0; j < img.cols; j++)
+                f[i + j*img.rows] = img.at<uint8_T>(i, j);
+        seq.frames.push_back(f);
+    }
+    return seq.frames.size() >= 2;
+}
+#endif
+
+// synthetic sequence of size inRows x inCols, or the images of dir
+struct SequenceSpec
+{
+    int_T inRows;
+    int_T inCols;
+    std::string dir;
+};
+
+std::string specName(const SequenceSpec &spec)
+{
+    if (!spec.dir.empty())
+        return spec.dir;
+    char name[64];
+    sprintf(name, "synthetic %dx%d", (int)spec.inRows, (int)spec.inCols);
+    return name;
+}
+
+bool loadSequence(const SequenceSpec &spec, int numFrames, Sequence &seq)
+{
+    if (spec.dir.empty())
+    {
+        seq = makeSynthetic(spec.inRows, spec.inCols, numFrames);
+        return true;
+    }
+#ifdef BENCHMARK_WITH_OPENCV
+    return readSequence(spec.dir, numFrames, seq);
+#else
+    return false;
+#endif
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// Algorithms. begin() allocates what the caller of the C API owns; step()
+// estimates the flow from the previous frame to the current frame.
+//////////////////////////////////////////////////////////////////////////////
+class Algorithm
+{
+public:
+    virtual ~Algorithm() {}
+    virtual const char *name() const = 0;
+    virtual void begin(int_T inRows, int_T inCols) = 0;
+    virtual void step(const uint8_T *curr, const uint8_T *prev,
+                      real32_T *velC, real32_T *velR) = 0;
+    virtual void end() {}
+};
+
+class AlgHS : public Algorithm
+{
+public:
+    AlgHS(bool redBlack) : mRedBlack(redBlack) {}
+    const char *name() const { return mRedBlack ? "HS_RB" : "HS"; }
+
+    void begin(int_T inRows, int_T inCols)
+    {
+        mRows = inRows;
+        mCols = inCols;
+        mBuffC.assign(2*inRows, 0);
+        mBuffR.assign(2*inCols, 0);
+        mGrad.assign(6*inRows*inCols, 0);
+        mVelBuf.assign(4*inRows, 0);
+    }
+
+    void step(const uint8_T *curr, const uint8_T *prev,
+              real32_T *velC, real32_T *velR)
+    {
+        const int_T n = mRows*mCols;
+        const real32_T lambda = 1;
+        const int32_T maxIter = 10;
+        const real32_T velDiff = 0;
+        real32_T *g = &mGrad[0];
+
+        if (mRedBlack)
+        {
+            MWCV_OpticalFlow_HS_RB_uint8(curr, prev, velC, velR,
+                &mBuffC[0], &mBuffC[mRows], &mBuffR[0], &mBuffR[mCols],
+                g, g + n, g + 2*n, g + 3*n, g + 4*n, g + 5*n,
+                &lambda, true, false, &maxIter, &velDiff, mRows, mCols);
+        }
+        else
+        {
+            MWCV_OpticalFlow_HS_uint8(curr, prev, velC, velR,
+                &mBuffC[0], &mBuffC[mRows], &mBuffR[0], &mBuffR[mCols],
+                g, g + n, g + 2*n, g + 3*n, g + 4*n, g + 5*n,
+                &mVelBuf[0], &mVelBuf[mRows], &mVelBuf[2*mRows], &mVelBuf[3*mRows],
+                &lambda, true, false, &maxIter, &velDiff, mRows, mCols);
+        }
+    }
+
+private:
+    bool mRedBlack;
+    int_T mRows, mCols;
+    std::vector<real32_T> mBuffC, mBuffR, mGrad, mVelBuf;
+};
+
+class AlgHSPyr : public Algorithm
+{
+public:
+    const char *name() const { return "HS_Pyr"; }
+    void begin(int_T inRows, int_T inCols) { mRows = inRows; mCols = inCols; }
+    void step(const uint8_T *curr, const uint8_T *prev,
+              real32_T *velC, real32_T *velR)
+    {
+        const real32_T lambda = 1;
+        const int32_T maxIter = 10;
+        const real32_T velDiff = 0;
+        MWCV_OpticalFlow_HS_Pyr_uint8(curr, prev, velC, velR, &lambda,
+            true, false, &maxIter, &velDiff, NUM_PYR_LEVELS, mRows, mCols);
+    }
+private:
+    int_T mRows, mCols;
+};
+
+class AlgLK : public Algorithm
+{
+public:
+    enum Kind { LK_BUFFERED, LK_FUSED, LK_PYRAMID };
+    AlgLK(Kind kind) : mKind(kind) {}
+
+    const char *name() const
+    {
+        return (mKind == LK_BUFFERED) ? "LK" : ((mKind == LK_FUSED) ? "LK_Fused" : "LK_Pyr");
+    }
+
+    void begin(int_T inRows, int_T inCols)
+    {
+        mRows = inRows;
+        mCols = inCols;
+        if (mKind == LK_BUFFERED)
+            mBuf.assign(5*inRows*inCols, 0);
+        else if (mKind == LK_FUSED)
+            mBuf.assign(30*inRows, 0);
+    }
+
+    void step(const uint8_T *curr, const uint8_T *prev,
+              real32_T *velC, real32_T *velR)
+    {
+        const real32_T eigTh = 0.0039f;
+        const int_T n = mRows*mCols;
+        if (mKind == LK_BUFFERED)
+        {
+            real32_T *g = &mBuf[0];
+            MWCV_OpticalFlow_LK_uint8(curr, prev, velC, velR,
+                g, g + n, g + 2*n, g + 3*n, g + 4*n, &eigTh, mRows, mCols);
+        }
+        else if (mKind == LK_FUSED)
+        {
+            MWCV_OpticalFlow_LK_Fused_uint8(curr, prev, velC, velR,
+                &mBuf[0], &eigTh, mRows, mCols);
+        }
+        else
+        {
+            MWCV_OpticalFlow_LK_Pyr_uint8(curr, prev, velC, velR,
+                &eigTh, NUM_PYR_LEVELS, mRows, mCols);
+        }
+    }
+
+private:
+    Kind mKind;
+    int_T mRows, mCols;
+    std::vector<real32_T> mBuf;
+};
+
+// kernels of opticalFlowLKDoG with its default properties: NumFrames = 3,
+// ImageFilterSigma = 1.5 and GradientFilterSigma = 1
+inline int kernelWidth(double sigma)
+{
+    int width = (int)floor(6*sigma + 1);
+    return (width % 2) ? width : width + 1;
+}
+
+std::vector<real32_T> gaussKernel(int len, double sigma, bool derivative)
+{
+    std::vector<real32_T> k(len);
+    const int halfWidth = len/2;
+    const double s2 = 2*sigma*sigma;
+    const double coeff = derivative ? 1.0/(sqrt(2.0*M_PI)*sigma*sigma*sigma)
+                                    : 1.0/(sqrt(2.0*M_PI)*sigma);
+    for (int x = -halfWidth; x <= halfWidth; x++)
+    {
+        const double g = coeff*exp(-x*x/s2);
+        k[x + halfWidth] = (real32_T)(derivative ? -x*g : g);
+    }
+    return k;
+}
+
+class AlgLKDoG : public Algorithm
+{
+public:
+    AlgLKDoG(bool stream) : mStream(stream), mIsFirstStep(true), mObj(NULL)
+    {
+        const double sigmaT = 0.0139 + (0.124 - 0.0139)*0.5;
+        const double sigmaS = 1.5;
+        mTGradKernel = gaussKernel(3, sqrt(2*sigmaT), true);
+        mTKernel     = gaussKernel(kernelWidth(sigmaT), sigmaT, false);
+        mSGradKernel = gaussKernel(kernelWidth(sqrt(2*sigmaS)), sqrt(2*sigmaS), true);
+        mSKernel     = gaussKernel(kernelWidth(sigmaS), sigmaS, false);
+        mWKernel     = gaussKernel(kernelWidth(1.0), 1.0, false);
+        mNumInFrames = (int_T)std::max(mTGradKernel.size(), mTKernel.size());
+    }
+
+    const char *name() const { return mStream ? "LKDoG_Stream" : "LKDoG"; }
+
+    void begin(int_T inRows, int_T inCols)
+    {
+        mRows = inRows;
+        mCols = inCols;
+        mIsFirstStep = true;
+        if (mStream)
+        {
+            MWCV_OpticalFlow_LKDoG_Stream_construct_uint8(&mObj,
+                &mTGradKernel[0], &mSGradKernel[0], &mTKernel[0],
+                &mSKernel[0], &mWKernel[0], inRows, inCols,
+                (int_T)mTGradKernel.size(), (int_T)mSGradKernel.size(),
+                (int_T)mTKernel.size(), (int_T)mSKernel.size(),
+                (int_T)mWKernel.size());
+        }
+        else
+        {
+            mGrad.assign(5*inRows*inCols, 0);
+            mDelayBuffer.assign((mNumInFrames-1)*inRows*inCols, 0);
+            mAllIdx.resize(mNumInFrames-1);
+        }
+    }
+
+    // the LKDoG flow is that of the center frame of the temporal window;
+    // prev feeds the delay buffer, and the stream on its first step
+    void step(const uint8_T *curr, const uint8_T *prev,
+              real32_T *velC, real32_T *velR)
+    {
+        const real32_T eigTh = 0.0039f;
+        if (mStream)
+        {
+            if (mIsFirstStep)
+            {
+                MWCV_OpticalFlow_LKDoG_Stream_step_uint8(mObj, prev, velC, velR,
+                                                         &eigTh, false);
+                mIsFirstStep = false;
+            }
+            MWCV_OpticalFlow_LKDoG_Stream_step_uint8(mObj, curr, velC, velR,
+                                                     &eigTh, false);
+            return;
+        }
+
+        const int_T n = mRows*mCols;
+        // the newest previous frame goes to the slot of the oldest one
+        std::copy_backward(mDelayBuffer.begin(), mDelayBuffer.end() - n,
+                           mDelayBuffer.end());
+        std::copy(prev, prev + n, mDelayBuffer.begin());
+        for (int_T p = 0; p < mNumInFrames-1; p++)
+            mAllIdx[p] = (uint32_T)(p+1);
+
+        real32_T *g = &mGrad[0];
+        MWCV_OpticalFlow_LKDoG_uint8(curr, &mDelayBuffer[0], &mAllIdx[0],
+            mNumInFrames-1, velC, velR, g, g + n, g + 2*n, g + 3*n, g + 4*n,
+            &eigTh, &mTGradKernel[0], &mSGradKernel[0], &mTKernel[0],
+            &mSKernel[0], &mWKernel[0], mRows, mCols,
+            (int_T)mTGradKernel.size(), (int_T)mSGradKernel.size(),
+            (int_T)mTKernel.size(), (int_T)mSKernel.size(),
+            (int_T)mWKernel.size(), false);
+    }
+
+    void end()
+    {
+        if (mObj)
+        {
+            MWCV_OpticalFlow_LKDoG_Stream_deleteObj_uint8(mObj);
+            mObj = NULL;
+        }
+    }
+
+private:
+    bool mStream;
+    bool mIsFirstStep;
+    void *mObj;
+    int_T mRows, mCols, mNumInFrames;
+    std::vector<real32_T> mTGradKernel, mSGradKernel, mTKernel, mSKernel, mWKernel;
+    std::vector<real32_T> mGrad;
+    std::vector<uint8_T> mDelayBuffer;
+    std::vector<uint32_T> mAllIdx;
+};
+
+#ifdef BENCHMARK_WITH_OPENCV
+class AlgFarneback : public Algorithm
+{
+public:
+    const char *name() const { return "Farneback"; }
+
+    void begin(int_T inRows, int_T inCols)
+    {
+        mRows = inRows;
+        mCols = inCols;
+        mCurr.resize(inRows*inCols);
+        mPrev.resize(inRows*inCols);
+        mFlow.resize(2*inRows*inCols);
+
+        // defaults of opticalFlowFarneback
+        mParams.pyr_scale  = 0.5;
+        mParams.poly_sigma = 1.1;
+        mParams.levels     = 3;
+        mParams.winsize    = 15;
+        mParams.iterations = 3;
+        mParams.poly_n     = 5;
+        mParams.flags      = 0;
+    }
+
+    void step(const uint8_T *curr, const uint8_T *prev,
+              real32_T *velC, real32_T *velR)
+    {
+        // the row major entry point avoids transposing the flow twice
+        toRowMajor(curr, &mCurr[0]);
+        toRowMajor(prev, &mPrev[0]);
+        opticalFlowFarneback_computeRM(&mPrev[0], &mCurr[0], NULL, &mFlow[0],
+                                       &mParams, mRows, mCols);
+        for (int_T j = 0; j < mCols; j++)
+        {
+            for (int_T i = 0; i < mRows; i++)
+            {
+                const int_T ij = i*mCols + j;
+                velC[i + j*mRows] = mFlow[2*ij + 1];
+                velR[i + j*mRows] = mFlow[2*ij];
+            }
+        }
+    }
+
+private:
+    void toRowMajor(const uint8_T *in, uint8_T *out)
+    {
+        for (int_T j = 0; j < mCols; j++)
+            for (int_T i = 0; i < mRows; i++)
+                out[i*mCols + j] = in[i + j*mRows];
+    }
+
+    int_T mRows, mCols;
+    std::vector<uint8_T> mCurr, mPrev;
+    std::vector<real32_T> mFlow;
+    cvstFarnebackStruct_T mParams;
+};
+#endif
+
+//////////////////////////////////////////////////////////////////////////////
+// Measurement
+//////////////////////////////////////////////////////////////////////////////
+struct Result
+{
+    int numFrames;  // 0 if the sequence could not be read
+    double msPerFrame;
+    double mpixPerSec;
+    double peakMB;
+    double epe;     // negative without ground truth
+};
+
+// mean endpoint error of the interior pixels
+double endpointError(const real32_T *velC, const real32_T *velR,
+                     int_T inRows, int_T inCols)
+{
+    double sum = 0;
+    int count = 0;
+    for (int_T j = EPE_BORDER; j < inCols - EPE_BORDER; j++)
+    {
+        for (int_T i = EPE_BORDER; i < inRows - EPE_BORDER; i++)
+        {
+            const double dc = velC[i + j*inRows] - SYNTH_VEL_C;
+            const double dr = velR[i + j*inRows] - SYNTH_VEL_R;
+            sum += sqrt(dc*dc + dr*dr);
+            count++;
+        }
+    }
+    return count ? sum/count : -1;
+}
+
+Result runAlgorithm(Algorithm &alg, const SequenceSpec &spec, int numFrames)
+{
+    Result res;
+    res.numFrames = 0;
+    res.msPerFrame = res.mpixPerSec = res.peakMB = res.epe = -1;
+
+    Sequence seq;
+    if (!loadSequence(spec, numFrames, seq))
+        return res;
+
+    const int_T n = seq.inRows*seq.inCols;
+    std::vector<real32_T> velC(n), velR(n);
+
+    alg.begin(seq.inRows, seq.inCols);
+
+    // the first pair is not measured, unless it is the only one: it warms
+    // up caches and lazy allocations. The stateful algorithms see every
+    // frame once and in order.
+    const int numPairs = (int)seq.frames.size() - 1;
+    const int firstMeasured = (numPairs > 1) ? 2 : 1;
+    const int numSteps = numPairs - firstMeasured + 1;
+    double epeSum = 0;
+    double seconds = 0;
+    for (int t = 1; t <= numPairs; t++)
+    {
+        std::chrono::steady_clock::time_point t0 = std::chrono::steady_clock::now();
+        alg.step(&seq.frames[t][0], &seq.frames[t-1][0], &velC[0], &velR[0]);
+        std::chrono::steady_clock::time_point t1 = std::chrono::steady_clock::now();
+        if (t < firstMeasured)
+            continue;
+
+        seconds += std::chrono::duration<double>(t1 - t0).count();
+        if (seq.hasGroundTruth)
+            epeSum += endpointError(&velC[0], &velR[0], seq.inRows, seq.inCols);
+    }
+    alg.end();
+
+    res.numFrames  = (int)seq.frames.size();
+    res.msPerFrame = 1000*seconds/numSteps;
+    res.mpixPerSec = (double)n*numSteps/seconds/1e6;
+    res.peakMB     = -1;
+    res.epe        = seq.hasGroundTruth ? epeSum/numSteps : -1;
+    return res;
+}
+
+#ifndef _WIN32
+// runs the algorithm in a child process to measure its own peak memory
+Result runIsolated(Algorithm &alg, const SequenceSpec &spec, int numFrames)
+{
+    Result res;
+    res.numFrames = 0;
+    res.msPerFrame = res.mpixPerSec = res.peakMB = res.epe = -1;
+
+    int fd[2];
+    if (pipe(fd) != 0)
+        return runAlgorithm(alg, spec, numFrames);
+
+    fflush(stdout);
+    pid_t pid = fork();
+    if (pid == 0)
+    {
+        close(fd[0]);
+        Result childRes = runAlgorithm(alg, spec, numFrames);
+        ssize_t written = write(fd[1], &childRes, sizeof(childRes));
+        close(fd[1]);
+        _exit(written == (ssize_t)sizeof(childRes) ? 0 : 1);
+    }
+    close(fd[1]);
+    if (pid < 0)
+    {
+        close(fd[0]);
+        return runAlgorithm(alg, spec, numFrames);
+    }
+
+    ssize_t got = read(fd[0], &res, sizeof(res));
+    close(fd[0]);
+
+    int status = 0;
+    struct rusage usage;
+    if (wait4(pid, &status, 0, &usage) == pid && got == (ssize_t)sizeof(res))
+    {
+#ifdef __APPLE__
+        res.peakMB = usage.ru_maxrss/(1024.0*1024.0);  // bytes
+#else
+        res.peakMB = usage.ru_maxrss/1024.0;           // kilobytes
+#endif
+    }
+    else
+    {
+        res.numFrames = 0;
+        res.msPerFrame = res.mpixPerSec = res.peakMB = res.epe = -1;
+    }
+    return res;
+}
+#else
+Result runIsolated(Algorithm &alg, const SequenceSpec &spec, int numFrames)
+{
+    return runAlgorithm(alg, spec, numFrames);
+}
+#endif
+
+void printValue(double v, const char *fmt)
+{
+    if (v < 0)
+        printf("%10s", "-");
+    else
+        printf(fmt, v);
+}
+
+void usage(const char *prog)
+{
+    printf("usage: %s [-s ROWSxCOLS]... [-n numFrames] [-d dir] [-a algorithm]...\n"
+           "  -s  size of a synthetic sequence (default 240x320, 480x640, 720x1280)\n"
+           "  -n  number of frames of each sequence (default 10)\n"
+           "  -d  directory of an image sequence (requires OpenCV)\n"
+           "  -a  algorithm to run (default all): HS, HS_RB, HS_Pyr, LK, LK_Fused,\n"
+           "      LK_Pyr, LKDoG, LKDoG_Stream, Farneback\n", prog);
+}
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+    std::vector<std::pair<int, int> > sizes;
+    std::vector<std::string> dirs;
+    std::vector<std::string> selected;
+    int numFrames = 10;
+
+    for (int k = 1; k < argc; k++)
+    {
+        const bool hasValue = (k + 1 < argc);
+        int r, c;
+        if (!strcmp(argv[k], "-s") && hasValue && sscanf(argv[k+1], "%dx%d", &r, &c) == 2
+            && r > 0 && c > 0)
+        {
+            sizes.push_back(std::make_pair(r, c));
+            k++;
+        }
+        else if (!strcmp(argv[k], "-n") && hasValue && atoi(argv[k+1]) >= 2)
+        {
+            numFrames = atoi(argv[++k]);
+        }
+        else if (!strcmp(argv[k], "-d") && hasValue)
+        {
+            dirs.push_back(argv[++k]);
+        }
+        else if (!strcmp(argv[k], "-a") && hasValue)
+        {
+            selected.push_back(argv[++k]);
+        }
+        else
+        {
+            usage(argv[0]);
+            return 1;
+        }
+    }
+    if (sizes.empty() && dirs.empty())
+    {
+        sizes.push_back(std::make_pair(240, 320));
+        sizes.push_back(std::make_pair(480, 640));
+        sizes.push_back(std::make_pair(720, 1280));
+    }
+
+    AlgHS hs(false), hsRB(true);
+    AlgHSPyr hsPyr;
+    AlgLK lk(AlgLK::LK_BUFFERED), lkFused(AlgLK::LK_FUSED), lkPyr(AlgLK::LK_PYRAMID);
+    AlgLKDoG lkdog(false), lkdogStream(true);
+    std::vector<Algorithm *> all;
+    all.push_back(&hs);
+    all.push_back(&hsRB);
+    all.push_back(&hsPyr);
+    all.push_back(&lk);
+    all.push_back(&lkFused);
+    all.push_back(&lkPyr);
+    all.push_back(&lkdog);
+    all.push_back(&lkdogStream);
+#ifdef BENCHMARK_WITH_OPENCV
+    AlgFarneback farneback;
+    all.push_back(&farneback);
+#endif
+
+    std::vector<Algorithm *> algs;
+    for (size_t a = 0; a < all.size(); a++)
+    {
+        if (selected.empty() ||
+            std::find(selected.begin(), selected.end(), all[a]->name()) != selected.end())
+            algs.push_back(all[a]);
+    }
+    if (algs.empty())
+    {
+        usage(argv[0]);
+        return 1;
+    }
+
+    std::vector<SequenceSpec> specs;
+    for (size_t s = 0; s < sizes.size(); s++)
+    {
+        SequenceSpec spec = { sizes[s].first, sizes[s].second, "" };
+        specs.push_back(spec);
+    }
+    for (size_t d = 0; d < dirs.size(); d++)
+    {
+#ifdef BENCHMARK_WITH_OPENCV
+        SequenceSpec spec = { 0, 0, dirs[d] };
+        specs.push_back(spec);
+#else
+        fprintf(stderr, "%s: image sequences require BENCHMARK_WITH_OPENCV\n", dirs[d].c_str());
+#endif
+    }
+
+    for (size_t s = 0; s < specs.size(); s++)
+    {
+        printf("\n%s, %d frames\n", specName(specs[s]).c_str(), numFrames);
+        printf("%-14s%10s%10s%10s%10s\n", "algorithm", "ms/frame", "MPix/s", "peak MB", "EPE");
+        for (size_t a = 0; a < algs.size(); a++)
+        {
+            Result res = runIsolated(*algs[a], specs[s], numFrames);
+            if (res.numFrames == 0)
+            {
+                fprintf(stderr, "%s: fewer than 2 images of the same size\n",
+                        specName(specs[s]).c_str());
+                break;
+            }
+            printf("%-14s", algs[a]->name());
+            printValue(res.msPerFrame, "%10.2f");
+            printValue(res.mpixPerSec, "%10.2f");
+            printValue(res.peakMB,     "%10.1f");
+            printValue(res.epe,        "%10.3f");
+            printf("\n");
+        }
+    }
+    return 0;
+}
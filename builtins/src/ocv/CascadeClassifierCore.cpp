@@ -9,9 +9,12 @@
 
 #include "CascadeClassifierCore_api.hpp"
 #include "mwobjdetect.hpp" 
+#include "ObjectDetectorCuda.hpp"
+#include "ImageHandle.hpp"
 #include "opencv2/opencv.hpp"
 #include "cgCommon.hpp"
 #include <stdio.h>
+#include "cgProfile.hpp"
 
 #define PLATFORM_DIRECTORY_SEPARATOR_BS '\\'   /* only on windows */
 #define PLATFORM_DIRECTORY_SEPARATOR_FS '/'    /* win and *ux */
@@ -28,17 +31,20 @@ int32_T cascadeClassifier_detectMultiScale(void *ptrClass, void **ptr2ptrDetecte
     double scaleFactor, uint32_T minNeighbors, 
     int32_T *ptrMinSize, int32_T *ptrMaxSize)
 {
+    CG_PROFILE_CALL();
     cv::Mat img = cv::Mat(nRows, (int)nCols, CV_8UC1, inImg);
+    CG_PROFILE_PHASE(CG_PROFILE_COMPUTE);
 
     cv::Size minSize      = cv::Size((int)ptrMinSize[1], (int)ptrMinSize[0]);
     cv::Size maxSize      = cv::Size((int)ptrMaxSize[1], (int)ptrMaxSize[0]);
 
-    std::vector<cv::Rect> *ptrDetectedObj = (std::vector<cv::Rect> *)new std::vector<cv::Rect>();
+    std::vector<cv::Rect> *ptrDetectedObj = vision::ResultPool<std::vector<cv::Rect> >::acquire();
     *ptr2ptrDetectedObj = ptrDetectedObj;
     std::vector<cv::Rect> &refDetectedObj = *ptrDetectedObj;
 
-    //
-    int32_T flags(2);
+    // scale the image, and search all the scale levels in one parallel
+    // region so that the small levels do not leave threads idle
+    int32_T flags(MWCASCADE_SCALE_IMAGE | MWCASCADE_SCALE_PARALLEL);
 
     // call OpenCV Classifiercascade::detectMultiScale      
     cv::MWCascadeClassifier *ptrClass_ = (cv::MWCascadeClassifier *)ptrClass;
@@ -48,6 +54,89 @@ int32_T cascadeClassifier_detectMultiScale(void *ptrClass, void **ptr2ptrDetecte
     return  ((int32_T)(refDetectedObj.size())); 
 }
 
+//////////////////////////////////////////////////////////////////////////////
+// Invoke OpenCV cvcascadeClassifier on regions of interest only
+//   ptrROIs:     numROIs-by-4 [x y width height] boxes, as output by the
+//                detection
+//   ptrMinSizes: numROIs-by-2 [height width] object size range per region
+//   ptrMaxSizes
+//////////////////////////////////////////////////////////////////////////////
+
+int32_T cascadeClassifier_detectMultiScaleROI(void *ptrClass, void **ptr2ptrDetectedObj,
+    uint8_T *inImg, int32_T nRows, int32_T nCols,
+    double scaleFactor, uint32_T minNeighbors,
+    int32_T *ptrROIs, int32_T numROIs, int32_T *ptrMinSizes, int32_T *ptrMaxSizes)
+{
+    CG_PROFILE_CALL();
+    cv::Mat img = cv::Mat(nRows, (int)nCols, CV_8UC1, inImg);
+
+    std::vector<cv::Rect> rois;
+    boundingBoxToCvRect(ptrROIs, numROIs, rois);
+    std::vector<cv::Size> minSizes(numROIs), maxSizes(numROIs);
+    for (int32_T i = 0; i < numROIs; i++)
+    {
+        minSizes[i] = cv::Size((int)ptrMinSizes[numROIs + i], (int)ptrMinSizes[i]);
+        maxSizes[i] = cv::Size((int)ptrMaxSizes[numROIs + i], (int)ptrMaxSizes[i]);
+    }
+
+    CG_PROFILE_PHASE(CG_PROFILE_COMPUTE);
+    std::vector<cv::Rect> *ptrDetectedObj = vision::ResultPool<std::vector<cv::Rect> >::acquire();
+    *ptr2ptrDetectedObj = ptrDetectedObj;
+    std::vector<cv::Rect> &refDetectedObj = *ptrDetectedObj;
+
+    int32_T flags(MWCASCADE_SCALE_IMAGE | MWCASCADE_SCALE_PARALLEL);
+
+    cv::MWCascadeClassifier *ptrClass_ = (cv::MWCascadeClassifier *)ptrClass;
+    ptrClass_->detectMultiScaleInROIs(img, rois, minSizes, maxSizes, refDetectedObj,
+        scaleFactor, minNeighbors, flags);
+
+    return  ((int32_T)(refDetectedObj.size()));
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// Invoke several cascades on one image pyramid
+//////////////////////////////////////////////////////////////////////////////
+
+void cascadeClassifier_detectMultiScaleMulti(void **ptrClasses, int32_T numClassifiers,
+    void **ptr2ptrDetectedObj, int32_T *numDetectedObj,
+    uint8_T *inImg, int32_T nRows, int32_T nCols, 
+    double scaleFactor, uint32_T *minNeighbors, 
+    int32_T *ptrMinSize, int32_T *ptrMaxSize)
+{
+    CG_PROFILE_CALL();
+    cv::Mat img = cv::Mat(nRows, (int)nCols, CV_8UC1, inImg);
+
+    std::vector<cv::MWCascadeClassifier *> classifiers(numClassifiers);
+    std::vector<int> minNeighbors_(numClassifiers);
+    std::vector<cv::Size> minSize(numClassifiers), maxSize(numClassifiers);
+    std::vector<cv::Rect> *detectedObj = new std::vector<cv::Rect>[numClassifiers];
+
+    // ptrMinSize and ptrMaxSize hold [rows cols] of each classifier
+    for (int32_T i = 0; i < numClassifiers; i++)
+    {
+        classifiers[i]   = (cv::MWCascadeClassifier *)ptrClasses[i];
+        minNeighbors_[i] = (int)minNeighbors[i];
+        minSize[i]       = cv::Size((int)ptrMinSize[2*i+1], (int)ptrMinSize[2*i]);
+        maxSize[i]       = cv::Size((int)ptrMaxSize[2*i+1], (int)ptrMaxSize[2*i]);
+    }
+
+    CG_PROFILE_PHASE(CG_PROFILE_COMPUTE);
+    cv::MWCascadeClassifier::detectMultiModel(&classifiers[0], (int)numClassifiers, img,
+        detectedObj, scaleFactor, &minNeighbors_[0], &minSize[0], &maxSize[0]);
+
+    CG_PROFILE_PHASE(CG_PROFILE_OUTPUT);
+    // each output is freed by cascadeClassifier_assignOutputDeleteBbox
+    for (int32_T i = 0; i < numClassifiers; i++)
+    {
+        std::vector<cv::Rect> *ptrDetectedObj = vision::ResultPool<std::vector<cv::Rect> >::acquire();
+        // copied rather than swapped, so that the pooled buffer is kept
+        ptrDetectedObj->assign(detectedObj[i].begin(), detectedObj[i].end());
+        ptr2ptrDetectedObj[i] = ptrDetectedObj;
+        numDetectedObj[i] = (int32_T)(ptrDetectedObj->size());
+    }
+    delete [] detectedObj;
+}
+
 std::string
 filenameNoPath( std::string const& pathname )
 {
@@ -95,39 +184,58 @@ bool file_exists(const char * filename)
     return false;
 }
 
-void cascadeClassifier_load(void *ptrClass, const char * filename)
+// Returns the path of the cascade file, or an empty string if it is not
+// found. If filename does not exist, the file is looked up relative to the
+// current directory.
+static std::string findCascadeFile(const char * filename)
 {
-	cv::MWCascadeClassifier *ptrClass_ = (cv::MWCascadeClassifier *)ptrClass;
-	// check if file exists; if it does not exist, try to load from it from current directory
 	if (file_exists(filename)){
-		ptrClass_->load(filename);
+		return filename;
+	}
+
+	// This code path is necessary only for packngo.
+	// During codegen, it's not easy to detect from Matlab code if codegen is for packngo.
+	// In packngo, we copy the xml file with all dependent dlls.
+	// for flat packType, xml file and dependent dlls will be copied to 
+	//                    directory where exe file lives
+	// for hierarchical packType, xml file and dependent dlls will be 
+	//                    with the sandbox directory structure
+	// so here we try to load the file from current directory
+	std::string baseFileName = filenameNoPath(filename);
+	if (file_exists((const char *)baseFileName.c_str())){
+		// for flat packType
+		return baseFileName;
+	}
+
+	// for hierarchical packType
+	std::string methodDir = (baseFileName[0] == 'h') ? "haar" : "lbp";
+	std::string filenameWithPath = "matlab/toolbox/vision/visionutilities/classifierdata/cascade/" +
+		methodDir + "/" + baseFileName;
+	if (file_exists((const char *)filenameWithPath.c_str())){
+		return filenameWithPath;
 	}
-	else{
-		// This code path is necessary only for packngo.
-		// During codegen, it's not easy to detect from Matlab code if codegen is for packngo.
-		// In packngo, we copy the xml file with all dependent dlls.
-		// for flat packType, xml file and dependent dlls will be copied to 
-		//                    directory where exe file lives
-		// for hierarchical packType, xml file and dependent dlls will be 
-		//                    with the sandbox directory structure
-		// so here we try to load the file from current directory
-		std::string baseFileName = filenameNoPath(filename);
-		if (file_exists((const char *)baseFileName.c_str())){
-			// for flat packType
-			ptrClass_->load(baseFileName.c_str());
-		}
-		else{
-			// for hierarchical packType
-			std::string methodDir = (baseFileName[0] == 'h') ? "haar" : "lbp";
-			std::string filenameWithPath = "matlab/toolbox/vision/visionutilities/classifierdata/cascade/" +
-				methodDir + "/" + baseFileName;
-			if (file_exists((const char *)filenameWithPath.c_str())){
-				ptrClass_->load(filenameWithPath.c_str());
-			}
-		}
+	return std::string();
+}
+
+void cascadeClassifier_load(void *ptrClass, const char * filename)
+{
+	cv::MWCascadeClassifier *ptrClass_ = (cv::MWCascadeClassifier *)ptrClass;
+	std::string cascadeFile = findCascadeFile(filename);
+	if (!cascadeFile.empty()){
+		ptrClass_->load(cascadeFile);
 	}
 }
 
+// converts an XML cascade to the binary format, which cascadeClassifier_load
+// reads without parsing
+boolean_T cascadeClassifier_convertToBinary(const char *xmlFilename, const char *binFilename)
+{
+    cv::MWCascadeClassifier classifier;
+    if (!classifier.load(xmlFilename))
+        return false;
+    return classifier.saveBinary(binFilename);
+}
+
 void cascadeClassifier_deleteObj(void *ptrClass)
 {
     delete((cv::MWCascadeClassifier *)ptrClass);    
@@ -173,20 +281,131 @@ void cascadeClassifier_construct(void **ptr2ptrClass)
 
 void cascadeClassifier_assignOutputDeleteBbox(void *ptrDetectedObj, int32_T *outBBox)
 {
+    CG_PROFILE_CALL();
+    CG_PROFILE_PHASE(CG_PROFILE_OUTPUT);
     std::vector<cv::Rect> detectedObj = ((std::vector<cv::Rect> *)ptrDetectedObj)[0];
 
     cvRectToBoundingBox(detectedObj, outBBox);
 
-    delete((std::vector<cv::Rect> *)ptrDetectedObj);
+    vision::ResultPool<std::vector<cv::Rect> >::release((std::vector<cv::Rect> *)ptrDetectedObj);
 }
 
 void cascadeClassifier_assignOutputDeleteBboxRM(void *ptrDetectedObj, int32_T *outBBox)
 {
+	CG_PROFILE_CALL();
+	CG_PROFILE_PHASE(CG_PROFILE_OUTPUT);
 	std::vector<cv::Rect> detectedObj = ((std::vector<cv::Rect> *)ptrDetectedObj)[0];
 	
 	cvRectToBoundingBoxRowMajor(detectedObj, outBBox);
 
-	delete((std::vector<cv::Rect> *)ptrDetectedObj);
+	vision::ResultPool<std::vector<cv::Rect> >::release((std::vector<cv::Rect> *)ptrDetectedObj);
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// Cascade detection on a CUDA device. Without CUDA support, construct
+// returns NULL and the other functions are never called.
+//////////////////////////////////////////////////////////////////////////////
+
+void cascadeClassifierCuda_construct(void **ptr2ptrClass, int32_T device)
+{
+    *ptr2ptrClass = NULL;
+#if defined(OBJECT_DETECTOR_HAVE_CUDA)
+    if (objectDetector::isCudaDevice((int)device))
+    {
+        *ptr2ptrClass = new objectDetector::CascadeClassifierCuda((int)device);
+    }
+#endif
+}
+
+boolean_T cascadeClassifierCuda_load(void *ptrClass, const char * filename)
+{
+#if defined(OBJECT_DETECTOR_HAVE_CUDA)
+    objectDetector::CascadeClassifierCuda *ptrClass_ = (objectDetector::CascadeClassifierCuda *)ptrClass;
+    std::string cascadeFile = findCascadeFile(filename);
+    return !cascadeFile.empty() && ptrClass_->load(cascadeFile);
+#else
+    (void)ptrClass; (void)filename;
+    return false;
+#endif
+}
+
+int32_T cascadeClassifierCuda_detectMultiScale(void *ptrClass, void **ptr2ptrDetectedObj,
+    uint8_T *inImg, int32_T nRows, int32_T nCols,
+    double scaleFactor, uint32_T minNeighbors,
+    int32_T *ptrMinSize, int32_T *ptrMaxSize)
+{
+    CG_PROFILE_CALL();
+#if defined(OBJECT_DETECTOR_HAVE_CUDA)
+    cv::Mat img = cv::Mat(nRows, (int)nCols, CV_8UC1, inImg);
+    CG_PROFILE_PHASE(CG_PROFILE_COMPUTE);
+
+    cv::Size minSize      = cv::Size((int)ptrMinSize[1], (int)ptrMinSize[0]);
+    cv::Size maxSize      = cv::Size((int)ptrMaxSize[1], (int)ptrMaxSize[0]);
+
+    std::vector<cv::Rect> *ptrDetectedObj = vision::ResultPool<std::vector<cv::Rect> >::acquire();
+    *ptr2ptrDetectedObj = ptrDetectedObj;
+
+    objectDetector::CascadeClassifierCuda *ptrClass_ = (objectDetector::CascadeClassifierCuda *)ptrClass;
+    ptrClass_->detectMultiScale(img, *ptrDetectedObj, scaleFactor,
+        (int)minNeighbors, minSize, maxSize);
+
+    return ((int32_T)(ptrDetectedObj->size()));
+#else
+    (void)ptrClass; (void)ptr2ptrDetectedObj; (void)inImg; (void)nRows; (void)nCols;
+    (void)scaleFactor; (void)minNeighbors; (void)ptrMinSize; (void)ptrMaxSize;
+    return 0;
+#endif
+}
+
+int32_T cascadeClassifierCuda_detectMultiScaleImage(void *ptrClass, void **ptr2ptrDetectedObj,
+    void *ptrImage,
+    double scaleFactor, uint32_T minNeighbors,
+    int32_T *ptrMinSize, int32_T *ptrMaxSize)
+{
+    CG_PROFILE_CALL();
+#if defined(OBJECT_DETECTOR_HAVE_CUDA)
+    vision::ImageHandle *ptrImage_ = (vision::ImageHandle *)ptrImage;
+    objectDetector::CascadeClassifierCuda *ptrClass_ = (objectDetector::CascadeClassifierCuda *)ptrClass;
+
+    // the host frame is only needed when the image is not on the device
+    const cv::cuda::GpuMat *deviceImage = NULL;
+#if defined(IMAGE_HANDLE_HAVE_CUDA)
+    if (ptrImage_->getDevice() == ptrClass_->getDevice())
+    {
+        deviceImage = &ptrImage_->getDeviceConverted();
+    }
+#endif
+    cv::Mat img;
+    if (!deviceImage)
+    {
+        img = ptrImage_->getConverted();
+    }
+
+    CG_PROFILE_PHASE(CG_PROFILE_COMPUTE);
+    cv::Size minSize      = cv::Size((int)ptrMinSize[1], (int)ptrMinSize[0]);
+    cv::Size maxSize      = cv::Size((int)ptrMaxSize[1], (int)ptrMaxSize[0]);
+
+    std::vector<cv::Rect> *ptrDetectedObj = vision::ResultPool<std::vector<cv::Rect> >::acquire();
+    *ptr2ptrDetectedObj = ptrDetectedObj;
+
+    ptrClass_->detectMultiScale(img, *ptrDetectedObj, scaleFactor,
+        (int)minNeighbors, minSize, maxSize, deviceImage);
+
+    return ((int32_T)(ptrDetectedObj->size()));
+#else
+    (void)ptrClass; (void)ptr2ptrDetectedObj; (void)ptrImage;
+    (void)scaleFactor; (void)minNeighbors; (void)ptrMinSize; (void)ptrMaxSize;
+    return 0;
+#endif
+}
+
+void cascadeClassifierCuda_deleteObj(void *ptrClass)
+{
+#if defined(OBJECT_DETECTOR_HAVE_CUDA)
+    delete ((objectDetector::CascadeClassifierCuda *)ptrClass);
+#else
+    (void)ptrClass;
+#endif
 }
 
 #endif
@@ -10,9 +10,12 @@
 
 #include "precomp_objdetect.hpp"
 #include "mwobjdetect.hpp" // for MWHOGDescriptor
+#include "ObjectDetectorCuda.hpp"
+#include "ImageHandle.hpp"
 
 #include "opencv2/opencv.hpp"
 #include "cgCommon.hpp"
+#include "cgProfile.hpp"
 
 using namespace cv;
 using namespace std;
@@ -28,10 +31,12 @@ void HOGDescriptor_detectMultiScale(void *ptrClass,
     int32_T *ptrMinSize, int32_T *ptrMaxSize, int32_T *ptrWinStride,
     boolean_T useMeanShiftMerging,
     int32_T *numDetectedObj, int32_T *numDetectionScores)
-{       
-    cv::Ptr<cv::Mat> inImage = new cv::Mat;
+{
+    CG_PROFILE_CALL();
+    cv::Mat inImage;
 	bool isRGB_ = (isRGB != 0);
-    cArrayToMat<uint8_T>(inImg, nRows, nCols, isRGB_, *inImage);
+    cArrayToMat<uint8_T>(inImg, nRows, nCols, isRGB_, inImage);
+    CG_PROFILE_PHASE(CG_PROFILE_COMPUTE);
 
     cv::Size minSize        = cv::Size((int)ptrMinSize[1], (int)ptrMinSize[0]);
     cv::Size maxSize        = cv::Size((int)ptrMaxSize[1], (int)ptrMaxSize[0]);
@@ -41,18 +46,18 @@ void HOGDescriptor_detectMultiScale(void *ptrClass,
     cv::Size padding(16,16); // used to pad input prior to gradient computations
 
     // Define output vectors
-    std::vector<cv::Rect> *ptrDetectedObj = (std::vector<cv::Rect> *)new std::vector<cv::Rect>();
+    std::vector<cv::Rect> *ptrDetectedObj = vision::ResultPool<std::vector<cv::Rect> >::acquire();
     *ptr2ptrDetectedObj = ptrDetectedObj;
     std::vector<cv::Rect> &refDetectedObj = *ptrDetectedObj;
 
-    std::vector<double> *ptrDetectionScores = (std::vector<double> *)new std::vector<double>();
+    std::vector<double> *ptrDetectionScores = vision::ResultPool<std::vector<double> >::acquire();
     *ptr2ptrDetectionScores = ptrDetectionScores;
     std::vector<double> &refDetectionScores = *ptrDetectionScores;
 
     // call OpenCV HOGDescriptor::detectMultiScale
     cv::MWHOGDescriptor *ptrClass_ = (cv::MWHOGDescriptor *)ptrClass;
 	bool useMeanShiftMerging_ = (useMeanShiftMerging != 0);
-    ptrClass_->detectMultiScale(*inImage, 
+    ptrClass_->detectMultiScale(inImage, 
         refDetectedObj, refDetectionScores, 
         svmThreshold, winStride, padding, scaleFactor, mergeThreshold, 
         useMeanShiftMerging_, minSize, maxSize);  		
@@ -69,9 +74,12 @@ void HOGDescriptor_detectMultiScaleRM(void *ptrClass,
 	boolean_T useMeanShiftMerging,
 	int32_T *numDetectedObj, int32_T *numDetectionScores)
 {
-	cv::Ptr<cv::Mat> inImage = new cv::Mat;
+	CG_PROFILE_CALL();
+	// grayscale row major input is used in place, without a copy
+	cv::Mat inImage;
 	bool isRGB_ = (isRGB != 0);
-	cArrayToMat_RowMaj<uint8_T>(inImg, nRows, nCols, isRGB_, *inImage);
+	cArrayToMatView_RowMaj<uint8_T>(inImg, nRows, nCols, isRGB_, inImage);
+	CG_PROFILE_PHASE(CG_PROFILE_COMPUTE);
 
 	cv::Size minSize = cv::Size((int)ptrMinSize[1], (int)ptrMinSize[0]);
 	cv::Size maxSize = cv::Size((int)ptrMaxSize[1], (int)ptrMaxSize[0]);
@@ -81,18 +89,18 @@ void HOGDescriptor_detectMultiScaleRM(void *ptrClass,
 	cv::Size padding(16, 16); // used to pad input prior to gradient computations
 
 	// Define output vectors
-	std::vector<cv::Rect> *ptrDetectedObj = (std::vector<cv::Rect> *)new std::vector<cv::Rect>();
+	std::vector<cv::Rect> *ptrDetectedObj = vision::ResultPool<std::vector<cv::Rect> >::acquire();
 	*ptr2ptrDetectedObj = ptrDetectedObj;
 	std::vector<cv::Rect> &refDetectedObj = *ptrDetectedObj;
 
-	std::vector<double> *ptrDetectionScores = (std::vector<double> *)new std::vector<double>();
+	std::vector<double> *ptrDetectionScores = vision::ResultPool<std::vector<double> >::acquire();
 	*ptr2ptrDetectionScores = ptrDetectionScores;
 	std::vector<double> &refDetectionScores = *ptrDetectionScores;
 
 	// call OpenCV HOGDescriptor::detectMultiScale
 	cv::MWHOGDescriptor *ptrClass_ = (cv::MWHOGDescriptor *)ptrClass;
 	bool useMeanShiftMerging_ = (useMeanShiftMerging != 0);
-	ptrClass_->detectMultiScale(*inImage,
+	ptrClass_->detectMultiScale(inImage,
 		refDetectedObj, refDetectionScores,
 		svmThreshold, winStride, padding, scaleFactor, mergeThreshold,
 		useMeanShiftMerging_, minSize, maxSize);
@@ -101,6 +109,215 @@ void HOGDescriptor_detectMultiScaleRM(void *ptrClass,
 	numDetectionScores[0] = (int32_T)(refDetectionScores.size());
 }
 
+///////////////////////////////////////////////////////////////////////////////
+// detectMultiScale on regions of interest only
+//   ptrROIs:     numROIs-by-4 [x y width height] boxes
+//   ptrMinSizes: numROIs-by-2 [height width] object size range per region
+//   ptrMaxSizes
+// The outputs are returned as by HOGDescriptor_detectMultiScale.
+///////////////////////////////////////////////////////////////////////////////
+void HOGDescriptor_detectMultiScaleROI(void *ptrClass,
+    void **ptr2ptrDetectedObj, void **ptr2ptrDetectionScores,
+    uint8_T *inImg, int32_T nRows, int32_T nCols, boolean_T isRGB,
+    double scaleFactor, double svmThreshold, double mergeThreshold,
+    int32_T *ptrROIs, int32_T numROIs, int32_T *ptrMinSizes, int32_T *ptrMaxSizes,
+    int32_T *ptrWinStride, boolean_T useMeanShiftMerging,
+    int32_T *numDetectedObj, int32_T *numDetectionScores)
+{
+    CG_PROFILE_CALL();
+    cv::Mat inImage;
+    bool isRGB_ = (isRGB != 0);
+    cArrayToMat<uint8_T>(inImg, nRows, nCols, isRGB_, inImage);
+    CG_PROFILE_PHASE(CG_PROFILE_COMPUTE);
+
+    std::vector<cv::Rect> rois;
+    boundingBoxToCvRect(ptrROIs, numROIs, rois);
+    std::vector<cv::Size> minSizes(numROIs), maxSizes(numROIs);
+    for (int32_T i = 0; i < numROIs; i++)
+    {
+        minSizes[i] = cv::Size((int)ptrMinSizes[numROIs + i], (int)ptrMinSizes[i]);
+        maxSizes[i] = cv::Size((int)ptrMaxSizes[numROIs + i], (int)ptrMaxSizes[i]);
+    }
+
+    cv::Size winStride = cv::Size((int)ptrWinStride[0], (int)ptrWinStride[1]);
+    cv::Size padding(16,16); // used to pad input prior to gradient computations
+
+    std::vector<cv::Rect> *ptrDetectedObj = vision::ResultPool<std::vector<cv::Rect> >::acquire();
+    *ptr2ptrDetectedObj = ptrDetectedObj;
+    std::vector<cv::Rect> &refDetectedObj = *ptrDetectedObj;
+
+    std::vector<double> *ptrDetectionScores = vision::ResultPool<std::vector<double> >::acquire();
+    *ptr2ptrDetectionScores = ptrDetectionScores;
+    std::vector<double> &refDetectionScores = *ptrDetectionScores;
+
+    cv::MWHOGDescriptor *ptrClass_ = (cv::MWHOGDescriptor *)ptrClass;
+    bool useMeanShiftMerging_ = (useMeanShiftMerging != 0);
+    ptrClass_->detectMultiScaleInROIs(inImage, rois, minSizes, maxSizes,
+        refDetectedObj, refDetectionScores,
+        svmThreshold, winStride, padding, scaleFactor, mergeThreshold,
+        useMeanShiftMerging_);
+
+    numDetectedObj[0] = (int32_T)(refDetectedObj.size());
+    numDetectionScores[0] = (int32_T)(refDetectionScores.size());
+}
+
+void HOGDescriptor_detectMultiScaleROIRM(void *ptrClass,
+    void **ptr2ptrDetectedObj, void **ptr2ptrDetectionScores,
+    uint8_T *inImg, int32_T nRows, int32_T nCols, boolean_T isRGB,
+    double scaleFactor, double svmThreshold, double mergeThreshold,
+    int32_T *ptrROIs, int32_T numROIs, int32_T *ptrMinSizes, int32_T *ptrMaxSizes,
+    int32_T *ptrWinStride, boolean_T useMeanShiftMerging,
+    int32_T *numDetectedObj, int32_T *numDetectionScores)
+{
+    CG_PROFILE_CALL();
+    cv::Mat inImage;
+    bool isRGB_ = (isRGB != 0);
+    cArrayToMatView_RowMaj<uint8_T>(inImg, nRows, nCols, isRGB_, inImage);
+    CG_PROFILE_PHASE(CG_PROFILE_COMPUTE);
+
+    std::vector<cv::Rect> rois;
+    boundingBoxToCvRectRowMajor(ptrROIs, numROIs, rois);
+    std::vector<cv::Size> minSizes(numROIs), maxSizes(numROIs);
+    for (int32_T i = 0; i < numROIs; i++)
+    {
+        minSizes[i] = cv::Size((int)ptrMinSizes[2*i+1], (int)ptrMinSizes[2*i]);
+        maxSizes[i] = cv::Size((int)ptrMaxSizes[2*i+1], (int)ptrMaxSizes[2*i]);
+    }
+
+    cv::Size winStride = cv::Size((int)ptrWinStride[0], (int)ptrWinStride[1]);
+    cv::Size padding(16,16); // used to pad input prior to gradient computations
+
+    std::vector<cv::Rect> *ptrDetectedObj = vision::ResultPool<std::vector<cv::Rect> >::acquire();
+    *ptr2ptrDetectedObj = ptrDetectedObj;
+    std::vector<cv::Rect> &refDetectedObj = *ptrDetectedObj;
+
+    std::vector<double> *ptrDetectionScores = vision::ResultPool<std::vector<double> >::acquire();
+    *ptr2ptrDetectionScores = ptrDetectionScores;
+    std::vector<double> &refDetectionScores = *ptrDetectionScores;
+
+    cv::MWHOGDescriptor *ptrClass_ = (cv::MWHOGDescriptor *)ptrClass;
+    bool useMeanShiftMerging_ = (useMeanShiftMerging != 0);
+    ptrClass_->detectMultiScaleInROIs(inImage, rois, minSizes, maxSizes,
+        refDetectedObj, refDetectionScores,
+        svmThreshold, winStride, padding, scaleFactor, mergeThreshold,
+        useMeanShiftMerging_);
+
+    numDetectedObj[0] = (int32_T)(refDetectedObj.size());
+    numDetectionScores[0] = (int32_T)(refDetectionScores.size());
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Dense score maps: the raw SVM score of every window of every scale, in
+// scale order. HOGDescriptor_getNumScoreMaps and HOGDescriptor_getScoreMapSizes
+// give the sizes of the output buffer of HOGDescriptor_computeScoreMaps.
+///////////////////////////////////////////////////////////////////////////////
+int32_T HOGDescriptor_getNumScoreMaps(void *ptrClass, int32_T nRows, int32_T nCols,
+    double scaleFactor, int32_T *ptrMinSize, int32_T *ptrMaxSize)
+{
+    cv::MWHOGDescriptor *ptrClass_ = (cv::MWHOGDescriptor *)ptrClass;
+    cv::Size minSize = cv::Size((int)ptrMinSize[1], (int)ptrMinSize[0]);
+    cv::Size maxSize = cv::Size((int)ptrMaxSize[1], (int)ptrMaxSize[0]);
+
+    std::vector<double> scales;
+    ptrClass_->getLevelScales(cv::Size((int)nCols, (int)nRows), scaleFactor, minSize, maxSize, scales);
+    return (int32_T)scales.size();
+}
+
+void HOGDescriptor_getScoreMapSizes(void *ptrClass, int32_T nRows, int32_T nCols,
+    double scaleFactor, int32_T *ptrMinSize, int32_T *ptrMaxSize, int32_T *ptrWinStride,
+    int32_T *mapSizes, double *scales)
+{
+    cv::MWHOGDescriptor *ptrClass_ = (cv::MWHOGDescriptor *)ptrClass;
+    cv::Size minSize = cv::Size((int)ptrMinSize[1], (int)ptrMinSize[0]);
+    cv::Size maxSize = cv::Size((int)ptrMaxSize[1], (int)ptrMaxSize[0]);
+    cv::Size winStride = cv::Size((int)ptrWinStride[0], (int)ptrWinStride[1]);
+    cv::Size padding(16,16);
+
+    std::vector<double> levelScale;
+    ptrClass_->getLevelScales(cv::Size((int)nCols, (int)nRows), scaleFactor, minSize, maxSize, levelScale);
+    for (size_t i = 0; i < levelScale.size(); i++)
+    {
+        // same rounding as the pyramid levels of detectMultiScale
+        cv::Size sz(cvRound(nCols/levelScale[i]), cvRound(nRows/levelScale[i]));
+        cv::Size mapSize = ptrClass_->getScoreMapSize(sz, winStride, padding);
+        mapSizes[2*i]   = (int32_T)mapSize.height;
+        mapSizes[2*i+1] = (int32_T)mapSize.width;
+        scales[i] = levelScale[i];
+    }
+}
+
+// computes the score maps of all scales into headers of outScores
+static void computeScoreMapsInto(cv::MWHOGDescriptor *ptrClass_, const cv::Mat& inImage,
+    double scaleFactor, int32_T *ptrMinSize, int32_T *ptrMaxSize, int32_T *ptrWinStride,
+    double *outScores, bool isRowMajor)
+{
+    cv::Size minSize = cv::Size((int)ptrMinSize[1], (int)ptrMinSize[0]);
+    cv::Size maxSize = cv::Size((int)ptrMaxSize[1], (int)ptrMaxSize[0]);
+    cv::Size winStride = cv::Size((int)ptrWinStride[0], (int)ptrWinStride[1]);
+    cv::Size padding(16,16);
+
+    std::vector<double> scales;
+    ptrClass_->getLevelScales(inImage.size(), scaleFactor, minSize, maxSize, scales);
+
+    // row major maps are written in place; column major maps are
+    // transposed into the output from the maps of the descriptor
+    std::vector<cv::Mat> scoreMaps(scales.size());
+    double *out = outScores;
+    for (size_t i = 0; i < scales.size(); i++)
+    {
+        cv::Size sz(cvRound(inImage.cols/scales[i]), cvRound(inImage.rows/scales[i]));
+        cv::Size mapSize = ptrClass_->getScoreMapSize(sz, winStride, padding);
+        if (isRowMajor)
+            scoreMaps[i] = cv::Mat(mapSize, CV_64F, out);
+        out += mapSize.area();
+    }
+
+    ptrClass_->computeScoreMaps(inImage, scoreMaps, scales, winStride, padding,
+        scaleFactor, minSize, maxSize);
+
+    if (!isRowMajor)
+    {
+        out = outScores;
+        for (size_t i = 0; i < scoreMaps.size(); i++)
+        {
+            const cv::Mat& map = scoreMaps[i];
+            cv::Mat outMap(map.cols, map.rows, CV_64F, out);
+            cv::transpose(map, outMap);
+            out += map.total();
+        }
+    }
+}
+
+void HOGDescriptor_computeScoreMaps(void *ptrClass,
+    uint8_T *inImg, int32_T nRows, int32_T nCols, boolean_T isRGB,
+    double scaleFactor, int32_T *ptrMinSize, int32_T *ptrMaxSize, int32_T *ptrWinStride,
+    double *outScores)
+{
+    CG_PROFILE_CALL();
+    cv::Mat inImage;
+    bool isRGB_ = (isRGB != 0);
+    cArrayToMat<uint8_T>(inImg, nRows, nCols, isRGB_, inImage);
+    CG_PROFILE_PHASE(CG_PROFILE_COMPUTE);
+
+    computeScoreMapsInto((cv::MWHOGDescriptor *)ptrClass, inImage, scaleFactor,
+        ptrMinSize, ptrMaxSize, ptrWinStride, outScores, false);
+}
+
+void HOGDescriptor_computeScoreMapsRM(void *ptrClass,
+    uint8_T *inImg, int32_T nRows, int32_T nCols, boolean_T isRGB,
+    double scaleFactor, int32_T *ptrMinSize, int32_T *ptrMaxSize, int32_T *ptrWinStride,
+    double *outScores)
+{
+    CG_PROFILE_CALL();
+    cv::Mat inImage;
+    bool isRGB_ = (isRGB != 0);
+    cArrayToMatView_RowMaj<uint8_T>(inImg, nRows, nCols, isRGB_, inImage);
+    CG_PROFILE_PHASE(CG_PROFILE_COMPUTE);
+
+    computeScoreMapsInto((cv::MWHOGDescriptor *)ptrClass, inImage, scaleFactor,
+        ptrMinSize, ptrMaxSize, ptrWinStride, outScores, true);
+}
+
 void HOGDescriptor_deleteObj(void *ptrClass)
 {
     delete((cv::HOGDescriptor *)ptrClass);    
@@ -132,6 +349,26 @@ void HOGDescriptor_setup(void *ptrClass, int whichModel)
     }  
 }
 
+void HOGDescriptor_setMemoryBudget(void *ptrClass, double budgetMB)
+{
+    cv::MWHOGDescriptor *ptrClass_ = (cv::MWHOGDescriptor *)ptrClass;
+    ptrClass_->memoryBudget = std::max(budgetMB, 0.0) * 1024.0 * 1024.0;
+}
+
+void HOGDescriptor_estimateMemory(void *ptrClass, int32_T nRows, int32_T nCols,
+    boolean_T isRGB, double scaleFactor, int32_T *ptrMinSize, int32_T *ptrMaxSize,
+    int32_T *ptrWinStride, double *peakBytes, double *steadyBytes)
+{
+    cv::Size minSize   = cv::Size((int)ptrMinSize[1], (int)ptrMinSize[0]);
+    cv::Size maxSize   = cv::Size((int)ptrMaxSize[1], (int)ptrMaxSize[0]);
+    cv::Size winStride = cv::Size((int)ptrWinStride[0], (int)ptrWinStride[1]);
+    cv::Size padding(16,16); // as in HOGDescriptor_detectMultiScale
+
+    const cv::MWHOGDescriptor *ptrClass_ = (const cv::MWHOGDescriptor *)ptrClass;
+    ptrClass_->estimateMemory(cv::Size(nCols, nRows), isRGB ? 3 : 1, scaleFactor,
+        minSize, maxSize, winStride, padding, *peakBytes, *steadyBytes);
+}
+
 void HOGDescriptor_construct(void **ptr2ptrClass)
 {
     cv::HOGDescriptor *ptrClass_ = (cv::HOGDescriptor *)new MWHOGDescriptor();
@@ -141,6 +378,8 @@ void HOGDescriptor_construct(void **ptr2ptrClass)
 void HOGDescriptor_assignOutputDeleteVectors(void *ptrDetectedObj, void *ptrDetectionScores, 
     int32_T *outBBox, double *outScore)
 {
+    CG_PROFILE_CALL();
+    CG_PROFILE_PHASE(CG_PROFILE_OUTPUT);
     std::vector<cv::Rect> detectedObj   = ((std::vector<cv::Rect> *)ptrDetectedObj)[0];
     std::vector<double> detectionScores = ((std::vector<double> *)ptrDetectionScores)[0];
 
@@ -148,13 +387,15 @@ void HOGDescriptor_assignOutputDeleteVectors(void *ptrDetectedObj, void *ptrDete
 
     std::copy(detectionScores.begin(),detectionScores.end(), outScore);
 
-    delete((std::vector<cv::Rect> *)ptrDetectedObj);
-    delete((std::vector<double> *)ptrDetectionScores);
+    vision::ResultPool<std::vector<cv::Rect> >::release((std::vector<cv::Rect> *)ptrDetectedObj);
+    vision::ResultPool<std::vector<double> >::release((std::vector<double> *)ptrDetectionScores);
 }
 
 void HOGDescriptor_assignOutputDeleteVectorsRM(void *ptrDetectedObj, void *ptrDetectionScores,
 	int32_T *outBBox, double *outScore)
 {
+	CG_PROFILE_CALL();
+	CG_PROFILE_PHASE(CG_PROFILE_OUTPUT);
 	std::vector<cv::Rect> detectedObj = ((std::vector<cv::Rect> *)ptrDetectedObj)[0];
 	std::vector<double> detectionScores = ((std::vector<double> *)ptrDetectionScores)[0];
 
@@ -162,7 +403,168 @@ void HOGDescriptor_assignOutputDeleteVectorsRM(void *ptrDetectedObj, void *ptrDe
 
 	std::copy(detectionScores.begin(), detectionScores.end(), outScore);
 
-	delete((std::vector<cv::Rect> *)ptrDetectedObj);
-	delete((std::vector<double> *)ptrDetectionScores);
+	vision::ResultPool<std::vector<cv::Rect> >::release((std::vector<cv::Rect> *)ptrDetectedObj);
+	vision::ResultPool<std::vector<double> >::release((std::vector<double> *)ptrDetectionScores);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// HOG detection on a CUDA device. Without CUDA support, construct returns
+// NULL and the other functions are never called.
+///////////////////////////////////////////////////////////////////////////////
+void HOGDescriptorCuda_construct(void **ptr2ptrClass, int32_T device)
+{
+    *ptr2ptrClass = NULL;
+#if defined(OBJECT_DETECTOR_HAVE_CUDA)
+    if (objectDetector::isCudaDevice((int)device))
+    {
+        *ptr2ptrClass = new objectDetector::HOGDescriptorCuda((int)device);
+    }
+#endif
+}
+
+void HOGDescriptorCuda_setup(void *ptrClass, int whichModel)
+{
+#if defined(OBJECT_DETECTOR_HAVE_CUDA)
+    ((objectDetector::HOGDescriptorCuda *)ptrClass)->setup(whichModel);
+#else
+    (void)ptrClass; (void)whichModel;
+#endif
+}
+
+#if defined(OBJECT_DETECTOR_HAVE_CUDA)
+static void detectMultiScaleCuda(void *ptrClass, const cv::Mat& inImage,
+    void **ptr2ptrDetectedObj, void **ptr2ptrDetectionScores,
+    double scaleFactor, double svmThreshold, double mergeThreshold,
+    int32_T *ptrMinSize, int32_T *ptrMaxSize, int32_T *ptrWinStride,
+    boolean_T useMeanShiftMerging,
+    int32_T *numDetectedObj, int32_T *numDetectionScores,
+    const cv::cuda::GpuMat *deviceImage = NULL)
+{
+    cv::Size minSize   = cv::Size((int)ptrMinSize[1], (int)ptrMinSize[0]);
+    cv::Size maxSize   = cv::Size((int)ptrMaxSize[1], (int)ptrMaxSize[0]);
+    cv::Size winStride = cv::Size((int)ptrWinStride[0], (int)ptrWinStride[1]);
+
+    // padding of the CPU fallback for window strides the device cannot use
+    cv::Size padding(16,16);
+
+    std::vector<cv::Rect> *ptrDetectedObj = vision::ResultPool<std::vector<cv::Rect> >::acquire();
+    *ptr2ptrDetectedObj = ptrDetectedObj;
+
+    std::vector<double> *ptrDetectionScores = vision::ResultPool<std::vector<double> >::acquire();
+    *ptr2ptrDetectionScores = ptrDetectionScores;
+
+    objectDetector::HOGDescriptorCuda *ptrClass_ = (objectDetector::HOGDescriptorCuda *)ptrClass;
+    ptrClass_->detectMultiScale(inImage, *ptrDetectedObj, *ptrDetectionScores,
+        svmThreshold, winStride, padding, scaleFactor, mergeThreshold,
+        useMeanShiftMerging != 0, minSize, maxSize, deviceImage);
+
+    numDetectedObj[0] = (int32_T)(ptrDetectedObj->size());
+    numDetectionScores[0] = (int32_T)(ptrDetectionScores->size());
+}
+#endif
+
+void HOGDescriptorCuda_detectMultiScale(void *ptrClass,
+    void **ptr2ptrDetectedObj, void **ptr2ptrDetectionScores,
+    uint8_T *inImg, int32_T nRows, int32_T nCols, boolean_T isRGB,
+    double scaleFactor, double svmThreshold, double mergeThreshold,
+    int32_T *ptrMinSize, int32_T *ptrMaxSize, int32_T *ptrWinStride,
+    boolean_T useMeanShiftMerging,
+    int32_T *numDetectedObj, int32_T *numDetectionScores)
+{
+    CG_PROFILE_CALL();
+#if defined(OBJECT_DETECTOR_HAVE_CUDA)
+    cv::Mat inImage;
+    cArrayToMat<uint8_T>(inImg, nRows, nCols, isRGB != 0, inImage);
+    CG_PROFILE_PHASE(CG_PROFILE_COMPUTE);
+
+    detectMultiScaleCuda(ptrClass, inImage, ptr2ptrDetectedObj, ptr2ptrDetectionScores,
+        scaleFactor, svmThreshold, mergeThreshold, ptrMinSize, ptrMaxSize, ptrWinStride,
+        useMeanShiftMerging, numDetectedObj, numDetectionScores);
+#else
+    (void)ptrClass; (void)ptr2ptrDetectedObj; (void)ptr2ptrDetectionScores;
+    (void)inImg; (void)nRows; (void)nCols; (void)isRGB;
+    (void)scaleFactor; (void)svmThreshold; (void)mergeThreshold;
+    (void)ptrMinSize; (void)ptrMaxSize; (void)ptrWinStride;
+    (void)useMeanShiftMerging; (void)numDetectedObj; (void)numDetectionScores;
+#endif
+}
+
+void HOGDescriptorCuda_detectMultiScaleRM(void *ptrClass,
+    void **ptr2ptrDetectedObj, void **ptr2ptrDetectionScores,
+    uint8_T *inImg, int32_T nRows, int32_T nCols, boolean_T isRGB,
+    double scaleFactor, double svmThreshold, double mergeThreshold,
+    int32_T *ptrMinSize, int32_T *ptrMaxSize, int32_T *ptrWinStride,
+    boolean_T useMeanShiftMerging,
+    int32_T *numDetectedObj, int32_T *numDetectionScores)
+{
+    CG_PROFILE_CALL();
+#if defined(OBJECT_DETECTOR_HAVE_CUDA)
+    cv::Mat inImage;
+    cArrayToMatView_RowMaj<uint8_T>(inImg, nRows, nCols, isRGB != 0, inImage);
+    CG_PROFILE_PHASE(CG_PROFILE_COMPUTE);
+
+    detectMultiScaleCuda(ptrClass, inImage, ptr2ptrDetectedObj, ptr2ptrDetectionScores,
+        scaleFactor, svmThreshold, mergeThreshold, ptrMinSize, ptrMaxSize, ptrWinStride,
+        useMeanShiftMerging, numDetectedObj, numDetectionScores);
+#else
+    (void)ptrClass; (void)ptr2ptrDetectedObj; (void)ptr2ptrDetectionScores;
+    (void)inImg; (void)nRows; (void)nCols; (void)isRGB;
+    (void)scaleFactor; (void)svmThreshold; (void)mergeThreshold;
+    (void)ptrMinSize; (void)ptrMaxSize; (void)ptrWinStride;
+    (void)useMeanShiftMerging; (void)numDetectedObj; (void)numDetectionScores;
+#endif
+}
+
+void HOGDescriptorCuda_detectMultiScaleImage(void *ptrClass,
+    void **ptr2ptrDetectedObj, void **ptr2ptrDetectionScores,
+    void *ptrImage,
+    double scaleFactor, double svmThreshold, double mergeThreshold,
+    int32_T *ptrMinSize, int32_T *ptrMaxSize, int32_T *ptrWinStride,
+    boolean_T useMeanShiftMerging,
+    int32_T *numDetectedObj, int32_T *numDetectionScores)
+{
+    CG_PROFILE_CALL();
+#if defined(OBJECT_DETECTOR_HAVE_CUDA)
+    vision::ImageHandle *ptrImage_ = (vision::ImageHandle *)ptrImage;
+
+    // The device HOG reads RGB frames as RGBA, converted on the host, and
+    // the host frame is only needed when the search runs on the CPU
+    const cv::cuda::GpuMat *deviceImage = NULL;
+#if defined(IMAGE_HANDLE_HAVE_CUDA)
+    objectDetector::HOGDescriptorCuda *ptrClass_ = (objectDetector::HOGDescriptorCuda *)ptrClass;
+    cv::Size winStride = cv::Size((int)ptrWinStride[0], (int)ptrWinStride[1]);
+    if (ptrImage_->getChannels() == 1 && ptrImage_->getDevice() == ptrClass_->getDevice() &&
+        ptrClass_->isDeviceStride(winStride))
+    {
+        deviceImage = &ptrImage_->getDeviceConverted();
+    }
+#endif
+    cv::Mat inImage;
+    if (!deviceImage)
+    {
+        inImage = ptrImage_->getConverted();
+    }
+
+    CG_PROFILE_PHASE(CG_PROFILE_COMPUTE);
+    detectMultiScaleCuda(ptrClass, inImage,
+        ptr2ptrDetectedObj, ptr2ptrDetectionScores,
+        scaleFactor, svmThreshold, mergeThreshold, ptrMinSize, ptrMaxSize, ptrWinStride,
+        useMeanShiftMerging, numDetectedObj, numDetectionScores, deviceImage);
+#else
+    (void)ptrClass; (void)ptr2ptrDetectedObj; (void)ptr2ptrDetectionScores;
+    (void)ptrImage;
+    (void)scaleFactor; (void)svmThreshold; (void)mergeThreshold;
+    (void)ptrMinSize; (void)ptrMaxSize; (void)ptrWinStride;
+    (void)useMeanShiftMerging; (void)numDetectedObj; (void)numDetectionScores;
+#endif
+}
+
+void HOGDescriptorCuda_deleteObj(void *ptrClass)
+{
+#if defined(OBJECT_DETECTOR_HAVE_CUDA)
+    delete ((objectDetector::HOGDescriptorCuda *)ptrClass);
+#else
+    (void)ptrClass;
+#endif
 }
 #endif
@@ -0,0 +1,143 @@
+//////////////////////////////////////////////////////////////////////////////
+// Aggregate channel features object detector, see AcfDetector.hpp
+//
+// Copyright 2016 The MathWorks, Inc.
+//
+//////////////////////////////////////////////////////////////////////////////
+
+#ifndef COMPILE_FOR_VISION_BUILTINS
+#include "acfObjectDetectorCore_api.hpp"
+#include "AcfDetector.hpp"
+
+#include "cgCommon.hpp"
+#include "cgProfile.hpp"
+#include "cgResultPool.hpp"
+
+void acfObjectDetector_construct(void **ptr2ptrClass)
+{
+    *ptr2ptrClass = new acf::AcfDetector();
+}
+
+void acfObjectDetector_setup(void *ptrClass,
+    const double *modelSize, const double *modelSizePadded,
+    const double *channelPadding, int32_T shrink, int32_T numApprox,
+    int32_T numUpscaledOctaves, double smoothChannels,
+    double preSmoothColor, const double *lambdas,
+    boolean_T fullOrientation, double normalizationRadius,
+    double normalizationConstant, int32_T numBins, int32_T cellSize,
+    boolean_T interpolateOrientation)
+{
+    acf::AcfParams params;
+    params.modelHeight           = (int)modelSize[0];
+    params.modelWidth            = (int)modelSize[1];
+    params.modelHeightPadded     = (int)modelSizePadded[0];
+    params.modelWidthPadded      = (int)modelSizePadded[1];
+    params.padRows               = (int)channelPadding[0];
+    params.padCols               = (int)channelPadding[1];
+    params.shrink                = std::max((int)shrink, 1);
+    params.numApprox             = std::max((int)numApprox, 0);
+    params.numUpscaledOctaves    = (int)numUpscaledOctaves;
+    params.smoothChannels        = (float)smoothChannels;
+    params.preSmoothColor        = (float)preSmoothColor;
+    params.lambdas[0]            = (float)lambdas[0];
+    params.lambdas[1]            = (float)lambdas[1];
+    params.lambdas[2]            = (float)lambdas[2];
+    params.fullOrientation       = fullOrientation != 0;
+    params.normalizationRadius   = (float)normalizationRadius;
+    params.normalizationConstant = (float)normalizationConstant;
+    params.numBins               = (int)numBins;
+    params.cellSize              = std::max((int)cellSize, 1);
+    params.interpolateOrientation = interpolateOrientation != 0;
+
+    ((acf::AcfDetector *)ptrClass)->setParams(params);
+}
+
+void acfObjectDetector_setClassifier(void *ptrClass,
+    const uint32_T *fids, const real32_T *thrs, const uint32_T *child,
+    const real32_T *hs, int32_T numNodes, int32_T numTrees,
+    int32_T treeDepth)
+{
+    ((acf::AcfDetector *)ptrClass)->setClassifier(fids, thrs, child, hs,
+        (int)numNodes, (int)numTrees, (int)treeDepth);
+}
+
+void acfObjectDetector_detect(void *ptrClass,
+    void **ptr2ptrBBoxes, void **ptr2ptrScores,
+    const real32_T *inImg, int32_T nRows, int32_T nCols, boolean_T isRGB,
+    int32_T numScaleLevels, const int32_T *ptrMinSize,
+    const int32_T *ptrMaxSize, int32_T windowStride, double threshold,
+    int32_T *numDetections)
+{
+    CG_PROFILE_CALL();
+
+    acf::AcfDetectParams params;
+    params.numScaleLevels = (int)numScaleLevels;
+    params.minHeight      = (int)ptrMinSize[0];
+    params.minWidth       = (int)ptrMinSize[1];
+    params.maxHeight      = (int)ptrMaxSize[0];
+    params.maxWidth       = (int)ptrMaxSize[1];
+    params.windowStride   = (int)windowStride;
+    params.threshold      = (float)threshold;
+    CG_PROFILE_PHASE(CG_PROFILE_COMPUTE);
+
+    std::vector<cv::Rect2d> *ptrBBoxes = vision::ResultPool<std::vector<cv::Rect2d> >::acquire();
+    *ptr2ptrBBoxes = ptrBBoxes;
+
+    std::vector<double> *ptrScores = vision::ResultPool<std::vector<double> >::acquire();
+    *ptr2ptrScores = ptrScores;
+
+    ((acf::AcfDetector *)ptrClass)->detect(inImg, (int)nRows, (int)nCols,
+        isRGB != 0, params, *ptrBBoxes, *ptrScores);
+
+    numDetections[0] = (int32_T)ptrBBoxes->size();
+}
+
+void acfObjectDetector_assignOutputDeleteVectors(void *ptrBBoxes, void *ptrScores,
+    double *outBBox, double *outScore)
+{
+    CG_PROFILE_CALL();
+    CG_PROFILE_PHASE(CG_PROFILE_OUTPUT);
+    const std::vector<cv::Rect2d> &bboxes = *(std::vector<cv::Rect2d> *)ptrBBoxes;
+    const std::vector<double> &scores = *(std::vector<double> *)ptrScores;
+
+    const size_t n = bboxes.size();
+    for (size_t i = 0; i < n; i++)
+    {
+        outBBox[i]         = bboxes[i].x;
+        outBBox[i + n]     = bboxes[i].y;
+        outBBox[i + 2 * n] = bboxes[i].width;
+        outBBox[i + 3 * n] = bboxes[i].height;
+    }
+    std::copy(scores.begin(), scores.end(), outScore);
+
+    vision::ResultPool<std::vector<cv::Rect2d> >::release((std::vector<cv::Rect2d> *)ptrBBoxes);
+    vision::ResultPool<std::vector<double> >::release((std::vector<double> *)ptrScores);
+}
+
+void acfObjectDetector_assignOutputDeleteVectorsRM(void *ptrBBoxes, void *ptrScores,
+    double *outBBox, double *outScore)
+{
+    CG_PROFILE_CALL();
+    CG_PROFILE_PHASE(CG_PROFILE_OUTPUT);
+    const std::vector<cv::Rect2d> &bboxes = *(std::vector<cv::Rect2d> *)ptrBBoxes;
+    const std::vector<double> &scores = *(std::vector<double> *)ptrScores;
+
+    for (size_t i = 0; i < bboxes.size(); i++)
+    {
+        outBBox[4 * i]     = bboxes[i].x;
+        outBBox[4 * i + 1] = bboxes[i].y;
+        outBBox[4 * i + 2] = bboxes[i].width;
+        outBBox[4 * i + 3] = bboxes[i].height;
+    }
+    std::copy(scores.begin(), scores.end(), outScore);
+
+    vision::ResultPool<std::vector<cv::Rect2d> >::release((std::vector<cv::Rect2d> *)ptrBBoxes);
+    vision::ResultPool<std::vector<double> >::release((std::vector<double> *)ptrScores);
+}
+
+void acfObjectDetector_deleteObj(void *ptrClass)
+{
+    delete ((acf::AcfDetector *)ptrClass);
+}
+
+#endif
@@ -0,0 +1,155 @@
+//////////////////////////////////////////////////////////////////////////////
+// Boosted tree training of trainACFObjectDetector, see AcfTrainer.hpp
+//
+// Copyright 2016 The MathWorks, Inc.
+//
+//////////////////////////////////////////////////////////////////////////////
+
+#ifndef COMPILE_FOR_VISION_BUILTINS
+#include "acfTrainerCore_api.hpp"
+#include "AcfTrainer.hpp"
+
+#include "cgCommon.hpp"
+#include "cgProfile.hpp"
+
+void acfTrainer_construct(void **ptr2ptrClass)
+{
+    *ptr2ptrClass = new acf::AcfTrainer();
+}
+
+void acfTrainer_setup(void *ptrClass,
+    const double *modelSize, const double *modelSizePadded,
+    const double *channelPadding, int32_T shrink, int32_T numApprox,
+    int32_T numUpscaledOctaves, double smoothChannels,
+    double preSmoothColor, const double *lambdas,
+    boolean_T fullOrientation, double normalizationRadius,
+    double normalizationConstant, int32_T numBins, int32_T cellSize,
+    boolean_T interpolateOrientation)
+{
+    acf::AcfParams params;
+    params.modelHeight           = (int)modelSize[0];
+    params.modelWidth            = (int)modelSize[1];
+    params.modelHeightPadded     = (int)modelSizePadded[0];
+    params.modelWidthPadded      = (int)modelSizePadded[1];
+    params.padRows               = (int)channelPadding[0];
+    params.padCols               = (int)channelPadding[1];
+    params.shrink                = std::max((int)shrink, 1);
+    params.numApprox             = std::max((int)numApprox, 0);
+    params.numUpscaledOctaves    = (int)numUpscaledOctaves;
+    params.smoothChannels        = (float)smoothChannels;
+    params.preSmoothColor        = (float)preSmoothColor;
+    params.lambdas[0]            = (float)lambdas[0];
+    params.lambdas[1]            = (float)lambdas[1];
+    params.lambdas[2]            = (float)lambdas[2];
+    params.fullOrientation       = fullOrientation != 0;
+    params.normalizationRadius   = (float)normalizationRadius;
+    params.normalizationConstant = (float)normalizationConstant;
+    params.numBins               = (int)numBins;
+    params.cellSize              = std::max((int)cellSize, 1);
+    params.interpolateOrientation = interpolateOrientation != 0;
+
+    ((acf::AcfTrainer *)ptrClass)->setParams(params);
+}
+
+void acfTrainer_addPositives(void *ptrClass,
+    const real32_T *X, int32_T numSamples, int32_T numFeatures)
+{
+    ((acf::AcfTrainer *)ptrClass)->addPositives(X, (int)numSamples,
+        (int)numFeatures, false);
+}
+
+void acfTrainer_addPositivesRM(void *ptrClass,
+    const real32_T *X, int32_T numSamples, int32_T numFeatures)
+{
+    ((acf::AcfTrainer *)ptrClass)->addPositives(X, (int)numSamples,
+        (int)numFeatures, true);
+}
+
+void acfTrainer_addNegatives(void *ptrClass,
+    const real32_T *X, int32_T numSamples, int32_T numFeatures)
+{
+    ((acf::AcfTrainer *)ptrClass)->addNegatives(X, (int)numSamples,
+        (int)numFeatures, false);
+}
+
+void acfTrainer_addNegativesRM(void *ptrClass,
+    const real32_T *X, int32_T numSamples, int32_T numFeatures)
+{
+    ((acf::AcfTrainer *)ptrClass)->addNegatives(X, (int)numSamples,
+        (int)numFeatures, true);
+}
+
+int32_T acfTrainer_mineNegatives(void *ptrClass,
+    const real32_T *inImg, int32_T nRows, int32_T nCols, boolean_T isRGB,
+    const double *gtBoxes, int32_T numGt, int32_T numScaleLevels,
+    int32_T windowStride, double threshold, int32_T maxPerImage)
+{
+    CG_PROFILE_CALL();
+
+    std::vector<cv::Rect2d> gt(numGt);
+    for (int i = 0; i < numGt; i++)
+    {
+        gt[i] = cv::Rect2d(gtBoxes[i], gtBoxes[i + numGt],
+            gtBoxes[i + 2 * numGt], gtBoxes[i + 3 * numGt]);
+    }
+
+    acf::AcfDetectParams params;
+    params.numScaleLevels = (int)numScaleLevels;
+    params.windowStride   = (int)windowStride;
+    params.threshold      = (float)threshold;
+    CG_PROFILE_PHASE(CG_PROFILE_COMPUTE);
+
+    return (int32_T)((acf::AcfTrainer *)ptrClass)->mineNegatives(inImg,
+        (int)nRows, (int)nCols, isRGB != 0, gt, params, (int)maxPerImage);
+}
+
+int32_T acfTrainer_getNumNegatives(void *ptrClass)
+{
+    return (int32_T)((acf::AcfTrainer *)ptrClass)->getNumNegatives();
+}
+
+int32_T acfTrainer_trainStage(void *ptrClass,
+    int32_T numWeak, int32_T maxDepth, double fracFeatures,
+    double minWeight, double calibration, int32_T numNegatives,
+    int32_T *numNodes, int32_T *treeDepth)
+{
+    CG_PROFILE_CALL();
+
+    acf::AcfBoostParams params;
+    params.numWeak      = (int)numWeak;
+    params.maxDepth     = (int)maxDepth;
+    params.fracFeatures = (float)fracFeatures;
+    params.minWeight    = (float)minWeight;
+    params.calibration  = (float)calibration;
+    params.numNegatives = (int)numNegatives;
+    CG_PROFILE_PHASE(CG_PROFILE_COMPUTE);
+
+    acf::AcfTrainer *ptrTrainer = (acf::AcfTrainer *)ptrClass;
+    const int numTrees = ptrTrainer->trainStage(params);
+    numNodes[0] = (int32_T)ptrTrainer->getNumNodes();
+    treeDepth[0] = (int32_T)ptrTrainer->getTreeDepth();
+    return (int32_T)numTrees;
+}
+
+void acfTrainer_getClassifier(void *ptrClass,
+    uint32_T *fids, real32_T *thrs, uint32_T *child, real32_T *hs,
+    real32_T *weights, uint32_T *depth)
+{
+    ((acf::AcfTrainer *)ptrClass)->getClassifier(fids, thrs, child, hs,
+        weights, depth, false);
+}
+
+void acfTrainer_getClassifierRM(void *ptrClass,
+    uint32_T *fids, real32_T *thrs, uint32_T *child, real32_T *hs,
+    real32_T *weights, uint32_T *depth)
+{
+    ((acf::AcfTrainer *)ptrClass)->getClassifier(fids, thrs, child, hs,
+        weights, depth, true);
+}
+
+void acfTrainer_deleteObj(void *ptrClass)
+{
+    delete ((acf::AcfTrainer *)ptrClass);
+}
+
+#endif
@@ -44,6 +44,10 @@ The references are:
 
 #include "include/agast_score_mw.hpp"
 
+#ifdef PARALLEL
+#include <atomic>
+#endif
+
 #ifdef _MSC_VER
 #pragma warning( disable : 4127 )
 #endif
@@ -94,6 +98,7 @@ void makeAgastOffsets(int pixel[16], int rowStride, int type)
 }
 
 #if (defined __i386__ || defined(_M_IX86) || defined __x86_64__ || defined(_M_X64))
+#if !CV_SSE2
 // 16 pixel mask
 template<>
 int agast_cornerScore<AgastFeatureDetector::OAST_9_16>(const uchar* ptr, const int pixel[], int threshold)
@@ -2168,6 +2173,7 @@ int agast_cornerScore<AgastFeatureDetector::OAST_9_16>(const uchar* ptr, const i
         b_test = (bmin + bmax) / 2;
     }
 }
+#endif // !CV_SSE2
 
 // 12 pixel mask in diamond format
 template<>
@@ -9854,13 +9860,187 @@ int agast_cornerScore<AgastFeatureDetector::AGAST_7_12s>(const uchar* ptr, const
     return AGAST_ALL_SCORE(ptr, pixel, threshold, AgastFeatureDetector::AGAST_7_12s);
 }
 
+#if !CV_NEON
 // 16 pixel mask
 template<>
 int agast_cornerScore<AgastFeatureDetector::OAST_9_16>(const uchar* ptr, const int pixel[], int threshold)
 {
     return AGAST_ALL_SCORE(ptr, pixel, threshold, AgastFeatureDetector::OAST_9_16);
 }
+#endif
 
 #endif // !(defined __i386__ || defined(_M_IX86) || defined __x86_64__ || defined(_M_X64))
 
+// TMW edit: compact scores, an alternative to the decision trees above that
+// keeps the code of a score to a few short loops. The largest threshold at
+// which the segment test holds is, over the arcs of arcLength contiguous
+// pixels of the circle, the largest smallest difference of one sign to the
+// center, less one. With SSE2 or NEON the arcs are evaluated 8 at a time,
+// as in cornerScore<16> of the FAST detector. Otherwise the extrema over an arc are
+// those of two overlapping runs of a power of two pixels, which are built
+// by doubling. Below threshold, threshold is returned, as the bisection
+// does, so the scores are those of the trees.
+template<int numPixels, int arcLength>
+static int agastScoreCompact(const uchar* ptr, const int pixel[], int threshold)
+{
+    int k, v = ptr[0];
+    int score;
+#if CV_SSE2 || CV_NEON
+    // the arcs from 0 to numPixels rounded up to 8, the last ones wrapping
+    const int N = (numPixels + 7)/8*8 + arcLength;
+    short d[N];
+    for( k = 0; k < N; k++ )
+        d[k] = (short)(v - ptr[pixel[k % numPixels]]);
+#if CV_SSE2
+    __m128i q0 = _mm_set1_epi16(-1000), q1 = _mm_set1_epi16(1000);
+    for( k = 0; k < numPixels; k += 8 )
+    {
+        __m128i v0 = _mm_loadu_si128((const __m128i*)(d+k+1));
+        __m128i v1 = _mm_loadu_si128((const __m128i*)(d+k+2));
+        __m128i a = _mm_min_epi16(v0, v1);
+        __m128i b = _mm_max_epi16(v0, v1);
+        for( int m = 3; m < arcLength; m++ )
+        {
+            v0 = _mm_loadu_si128((const __m128i*)(d+k+m));
+            a = _mm_min_epi16(a, v0);
+            b = _mm_max_epi16(b, v0);
+        }
+        v0 = _mm_loadu_si128((const __m128i*)(d+k));
+        q0 = _mm_max_epi16(q0, _mm_min_epi16(a, v0));
+        q1 = _mm_min_epi16(q1, _mm_max_epi16(b, v0));
+        v0 = _mm_loadu_si128((const __m128i*)(d+k+arcLength));
+        q0 = _mm_max_epi16(q0, _mm_min_epi16(a, v0));
+        q1 = _mm_min_epi16(q1, _mm_max_epi16(b, v0));
+    }
+    q0 = _mm_max_epi16(q0, _mm_sub_epi16(_mm_setzero_si128(), q1));
+    q0 = _mm_max_epi16(q0, _mm_unpackhi_epi64(q0, q0));
+    q0 = _mm_max_epi16(q0, _mm_srli_si128(q0, 4));
+    q0 = _mm_max_epi16(q0, _mm_srli_si128(q0, 2));
+    score = (short)_mm_cvtsi128_si32(q0) - 1;
+#else
+    int16x8_t q0 = vdupq_n_s16(-1000), q1 = vdupq_n_s16(1000);
+    for( k = 0; k < numPixels; k += 8 )
+    {
+        int16x8_t v0 = vld1q_s16(d+k+1);
+        int16x8_t v1 = vld1q_s16(d+k+2);
+        int16x8_t a = vminq_s16(v0, v1);
+        int16x8_t b = vmaxq_s16(v0, v1);
+        for( int m = 3; m < arcLength; m++ )
+        {
+            v0 = vld1q_s16(d+k+m);
+            a = vminq_s16(a, v0);
+            b = vmaxq_s16(b, v0);
+        }
+        v0 = vld1q_s16(d+k);
+        q0 = vmaxq_s16(q0, vminq_s16(a, v0));
+        q1 = vminq_s16(q1, vmaxq_s16(b, v0));
+        v0 = vld1q_s16(d+k+arcLength);
+        q0 = vmaxq_s16(q0, vminq_s16(a, v0));
+        q1 = vminq_s16(q1, vmaxq_s16(b, v0));
+    }
+    q0 = vmaxq_s16(q0, vnegq_s16(q1));
+    int16x4_t q = vmax_s16(vget_low_s16(q0), vget_high_s16(q0));
+    q = vpmax_s16(q, q);
+    q = vpmax_s16(q, q);
+    score = vget_lane_s16(q, 0) - 1;
+#endif
+#else
+    // the longest run of a power of two pixels within an arc
+    const int run = arcLength >= 8 ? 8 : arcLength >= 4 ? 4 : 2;
+    const int N = numPixels + arcLength - 1;
+    short lo[N], hi[N];
+    for( k = 0; k < N; k++ )
+        lo[k] = hi[k] = (short)(v - ptr[pixel[k % numPixels]]);
+
+    // lo[k] and hi[k] become the extrema of the run of len pixels from k
+    for( int len = 1; len < run; len *= 2 )
+        for( k = 0; k + 2*len <= N; k++ )
+        {
+            lo[k] = std::min(lo[k], lo[k+len]);
+            hi[k] = std::max(hi[k], hi[k+len]);
+        }
+
+    int best = -1000;
+    for( k = 0; k < numPixels; k++ )
+    {
+        const int a = std::min(lo[k], lo[k+arcLength-run]);
+        const int b = std::max(hi[k], hi[k+arcLength-run]);
+        best = std::max(best, std::max(a, -b));
+    }
+    score = best - 1;
+#endif
+    return std::max(threshold, score);
+}
+
+#if CV_SSE2 || CV_NEON
+// 16 pixel mask, without the bisection over the decision tree
+template<>
+int agast_cornerScore<AgastFeatureDetector::OAST_9_16>(const uchar* ptr, const int pixel[], int threshold)
+{
+    return agastScoreCompact<16, 9>(ptr, pixel, threshold);
+}
+#endif // CV_SSE2 || CV_NEON
+
+template<>
+int agast_cornerScoreCompact<AgastFeatureDetector::AGAST_5_8>(const uchar* ptr, const int pixel[], int threshold)
+{
+    return agastScoreCompact<8, 5>(ptr, pixel, threshold);
+}
+
+template<>
+int agast_cornerScoreCompact<AgastFeatureDetector::AGAST_7_12d>(const uchar* ptr, const int pixel[], int threshold)
+{
+    return agastScoreCompact<12, 7>(ptr, pixel, threshold);
+}
+
+template<>
+int agast_cornerScoreCompact<AgastFeatureDetector::AGAST_7_12s>(const uchar* ptr, const int pixel[], int threshold)
+{
+    return agastScoreCompact<12, 7>(ptr, pixel, threshold);
+}
+
+template<>
+int agast_cornerScoreCompact<AgastFeatureDetector::OAST_9_16>(const uchar* ptr, const int pixel[], int threshold)
+{
+    return agastScoreCompact<16, 9>(ptr, pixel, threshold);
+}
+
+#ifdef PARALLEL
+static std::atomic<int> agastScoreMethod(AGAST_SCORE_DEFAULT);
+#else
+static int agastScoreMethod = AGAST_SCORE_DEFAULT;
+#endif
+
+void setAgastScoreMethod(int method)
+{
+    agastScoreMethod = (method == AGAST_SCORE_COMPACT) ? AGAST_SCORE_COMPACT : AGAST_SCORE_TREE;
+}
+
+int getAgastScoreMethod()
+{
+    return agastScoreMethod;
+}
+
+AgastScoreFunc getAgastScoreFunc(int type)
+{
+    const bool isCompact = (agastScoreMethod == AGAST_SCORE_COMPACT);
+    switch( type )
+    {
+    case AgastFeatureDetector::AGAST_5_8:
+        return isCompact ? agast_cornerScoreCompact<AgastFeatureDetector::AGAST_5_8>
+                         : agast_cornerScore<AgastFeatureDetector::AGAST_5_8>;
+    case AgastFeatureDetector::AGAST_7_12d:
+        return isCompact ? agast_cornerScoreCompact<AgastFeatureDetector::AGAST_7_12d>
+                         : agast_cornerScore<AgastFeatureDetector::AGAST_7_12d>;
+    case AgastFeatureDetector::AGAST_7_12s:
+        return isCompact ? agast_cornerScoreCompact<AgastFeatureDetector::AGAST_7_12s>
+                         : agast_cornerScore<AgastFeatureDetector::AGAST_7_12s>;
+    case AgastFeatureDetector::OAST_9_16:
+        return isCompact ? agast_cornerScoreCompact<AgastFeatureDetector::OAST_9_16>
+                         : agast_cornerScore<AgastFeatureDetector::OAST_9_16>;
+    }
+    CV_Error(Error::StsBadArg, "Unknown AGAST type");
+    return 0;
+}
+
 } // namespace cv
\ No newline at end of file
@@ -0,0 +1,73 @@
+///////////////////////////////////////////////////////////////////////////////
+// This file contains the shared library function calls used in codegen for
+// the approximate k-means of bagOfFeatures.
+///////////////////////////////////////////////////////////////////////////////
+#ifndef COMPILE_FOR_VISION_BUILTINS
+#include "approximateKMeansCore_api.hpp"
+#include "ApproxKMeans.hpp"
+#include "MappedFile.hpp"
+#include "cgProfile.hpp"
+
+static int32_T approximateKMeans(const real32_T * features,
+        const int32_T numFeatures, const int32_T numelInFeatureVec,
+        const int32_T numClusters, const int32_T maxIterations,
+        const real32_T threshold, const int32_T numTrials,
+        const boolean_T useKMeansPlusPlus, const uint32_T seed,
+        real32_T * centers, int32_T * assignments)
+{
+    bagOfFeatures::ApproxKMeansParams params;
+    params.numClusters       = (int)numClusters;
+    params.maxIterations     = (int)maxIterations;
+    params.threshold         = (float)threshold;
+    params.numTrials         = (int)numTrials;
+    params.useKMeansPlusPlus = useKMeansPlusPlus != 0;
+    params.seed              = (unsigned int)seed;
+
+    bagOfFeatures::ApproxKMeans kmeans(features, numFeatures, numelInFeatureVec);
+    const int numClustered = kmeans.cluster(params, centers, assignments);
+    return (numClustered < 0) ? APPROX_KMEANS_ERR_TOO_FEW_FEATURES :
+                                (int32_T)numClustered;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Features in memory
+///////////////////////////////////////////////////////////////////////////////
+int32_T approximateKMeans_real32(const real32_T * features,
+        const int32_T numFeatures, const int32_T numelInFeatureVec,
+        const int32_T numClusters, const int32_T maxIterations,
+        const real32_T threshold, const int32_T numTrials,
+        const boolean_T useKMeansPlusPlus, const uint32_T seed,
+        real32_T * centers, int32_T * assignments)
+{
+    CG_PROFILE_CALL();
+    return approximateKMeans(features, numFeatures, numelInFeatureVec,
+        numClusters, maxIterations, threshold, numTrials, useKMeansPlusPlus,
+        seed, centers, assignments);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Features mapped from a file. The pages of a chunk are read when the chunk
+// is clustered and may be evicted afterwards, so the features need not fit
+// in memory.
+///////////////////////////////////////////////////////////////////////////////
+int32_T approximateKMeans_file_real32(const char * filename,
+        const int32_T numFeatures, const int32_T numelInFeatureVec,
+        const int32_T numClusters, const int32_T maxIterations,
+        const real32_T threshold, const int32_T numTrials,
+        const boolean_T useKMeansPlusPlus, const uint32_T seed,
+        real32_T * centers, int32_T * assignments)
+{
+    CG_PROFILE_CALL();
+    vision::MappedFile mapping;
+    const size_t dataBytes = (size_t)numFeatures * numelInFeatureVec * sizeof(real32_T);
+    if (!mapping.open(filename) || mapping.size() < dataBytes)
+    {
+        return APPROX_KMEANS_ERR_FILE;
+    }
+
+    return approximateKMeans((const real32_T *)mapping.data(), numFeatures,
+        numelInFeatureVec, numClusters, maxIterations, threshold, numTrials,
+        useKMeansPlusPlus, seed, centers, assignments);
+}
+
+#endif
@@ -0,0 +1,135 @@
+///////////////////////////////////////////////////////////////////////////////
+// This file contains the shared library function calls used in codegen for
+// assignDetectionsToTracks, see AssignmentSolver.hpp.
+///////////////////////////////////////////////////////////////////////////////
+#ifndef COMPILE_FOR_VISION_BUILTINS
+#include "assignDetectionsToTracksCore_api.hpp"
+#include "AssignmentSolver.hpp"
+#include "cgProfile.hpp"
+
+// detection of each track, -1 when unassigned, and track of each detection
+struct Assignment
+{
+    std::vector<int> detectionOfTrack;
+    std::vector<int> trackOfDetection;
+};
+
+static void solve(const double * cost, int32_T numTracks, int32_T numDetections,
+        bool isRowMajor,
+        const double * costUnassignedTracks, const double * costUnassignedDetections,
+        int32_T * numMatches, int32_T * numUnassignedTracks,
+        int32_T * numUnassignedDetections, void ** ptr2ptrAssignment)
+{
+    Assignment *result = new Assignment();
+    *ptr2ptrAssignment = result;
+
+    assignment::AssignmentSolver solver;
+    solver.solve(cost, (int)numTracks, (int)numDetections, isRowMajor,
+        costUnassignedTracks, costUnassignedDetections, result->detectionOfTrack);
+
+    int32_T matched = 0;
+    result->trackOfDetection.assign(numDetections, -1);
+    for (int32_T i = 0; i < numTracks; i++)
+    {
+        const int j = result->detectionOfTrack[i];
+        if (j >= 0)
+        {
+            result->trackOfDetection[j] = i;
+            matched++;
+        }
+    }
+    *numMatches = matched;
+    *numUnassignedTracks = numTracks - matched;
+    *numUnassignedDetections = numDetections - matched;
+}
+
+void assignDetectionsToTracks_solve(const double * cost,
+        int32_T numTracks, int32_T numDetections,
+        const double * costUnassignedTracks, const double * costUnassignedDetections,
+        int32_T * numMatches, int32_T * numUnassignedTracks,
+        int32_T * numUnassignedDetections, void ** ptr2ptrAssignment)
+{
+    CG_PROFILE_CALL();
+    CG_PROFILE_PHASE(CG_PROFILE_COMPUTE);
+    solve(cost, numTracks, numDetections, false, costUnassignedTracks,
+        costUnassignedDetections, numMatches, numUnassignedTracks,
+        numUnassignedDetections, ptr2ptrAssignment);
+}
+
+void assignDetectionsToTracks_solveRM(const double * cost,
+        int32_T numTracks, int32_T numDetections,
+        const double * costUnassignedTracks, const double * costUnassignedDetections,
+        int32_T * numMatches, int32_T * numUnassignedTracks,
+        int32_T * numUnassignedDetections, void ** ptr2ptrAssignment)
+{
+    CG_PROFILE_CALL();
+    CG_PROFILE_PHASE(CG_PROFILE_COMPUTE);
+    solve(cost, numTracks, numDetections, true, costUnassignedTracks,
+        costUnassignedDetections, numMatches, numUnassignedTracks,
+        numUnassignedDetections, ptr2ptrAssignment);
+}
+
+static void assignOutputDelete(void * ptrAssignment, bool isRowMajor,
+        uint32_T * matches, uint32_T * unassignedTracks,
+        uint32_T * unassignedDetections)
+{
+    Assignment *result = (Assignment *)ptrAssignment;
+    const size_t numTracks = result->detectionOfTrack.size();
+    const size_t numDetections = result->trackOfDetection.size();
+
+    size_t numMatches = 0;
+    for (size_t j = 0; j < numDetections; j++)
+        numMatches += (result->trackOfDetection[j] >= 0);
+
+    size_t m = 0, u = 0;
+    for (size_t j = 0; j < numDetections; j++)
+    {
+        const int i = result->trackOfDetection[j];
+        if (i < 0)
+        {
+            unassignedDetections[u++] = (uint32_T)(j + 1);
+        }
+        else if (isRowMajor)
+        {
+            matches[2 * m]     = (uint32_T)(i + 1);
+            matches[2 * m + 1] = (uint32_T)(j + 1);
+            m++;
+        }
+        else
+        {
+            matches[m]              = (uint32_T)(i + 1);
+            matches[m + numMatches] = (uint32_T)(j + 1);
+            m++;
+        }
+    }
+    u = 0;
+    for (size_t i = 0; i < numTracks; i++)
+    {
+        if (result->detectionOfTrack[i] < 0)
+            unassignedTracks[u++] = (uint32_T)(i + 1);
+    }
+
+    delete result;
+}
+
+void assignDetectionsToTracks_assignOutputDelete(void * ptrAssignment,
+        uint32_T * matches, uint32_T * unassignedTracks,
+        uint32_T * unassignedDetections)
+{
+    CG_PROFILE_CALL();
+    CG_PROFILE_PHASE(CG_PROFILE_OUTPUT);
+    assignOutputDelete(ptrAssignment, false, matches, unassignedTracks,
+        unassignedDetections);
+}
+
+void assignDetectionsToTracks_assignOutputDeleteRM(void * ptrAssignment,
+        uint32_T * matches, uint32_T * unassignedTracks,
+        uint32_T * unassignedDetections)
+{
+    CG_PROFILE_CALL();
+    CG_PROFILE_PHASE(CG_PROFILE_OUTPUT);
+    assignOutputDelete(ptrAssignment, true, matches, unassignedTracks,
+        unassignedDetections);
+}
+
+#endif
@@ -0,0 +1,99 @@
+///////////////////////////////////////////////////////////////////////////////
+// This file contains the shared library function calls used in codegen for
+// bboxOverlapRatio and selectStrongestBbox, see BoxOverlap.hpp.
+///////////////////////////////////////////////////////////////////////////////
+#ifndef COMPILE_FOR_VISION_BUILTINS
+#include "bboxOverlapCore_api.hpp"
+#include "BoxOverlap.hpp"
+#include "cgProfile.hpp"
+
+template <typename T>
+static void suppress(const T * bbox, const double * score, int32_T numBoxes,
+        bool isRowMajor, double threshold, boolean_T isDivByUnion,
+        boolean_T * isKept)
+{
+    std::vector<char> kept;
+    bbox::OverlapSuppression<T> suppression;
+    suppression.suppress(bbox, score, (int)numBoxes, isRowMajor, (T)threshold,
+        isDivByUnion != 0, kept);
+    for (int32_T i = 0; i < numBoxes; i++)
+        isKept[i] = kept[i] != 0;
+}
+
+void bboxOverlap_ratio(const double * bboxA, int32_T numA,
+        const double * bboxB, int32_T numB, boolean_T isDivByUnion,
+        double * ratio)
+{
+    CG_PROFILE_CALL();
+    CG_PROFILE_PHASE(CG_PROFILE_COMPUTE);
+    bbox::overlapRatio(bboxA, (int)numA, bboxB, (int)numB, false,
+        isDivByUnion != 0, ratio);
+}
+
+void bboxOverlap_ratioRM(const double * bboxA, int32_T numA,
+        const double * bboxB, int32_T numB, boolean_T isDivByUnion,
+        double * ratio)
+{
+    CG_PROFILE_CALL();
+    CG_PROFILE_PHASE(CG_PROFILE_COMPUTE);
+    bbox::overlapRatio(bboxA, (int)numA, bboxB, (int)numB, true,
+        isDivByUnion != 0, ratio);
+}
+
+void bboxOverlap_ratio_single(const float * bboxA, int32_T numA,
+        const float * bboxB, int32_T numB, boolean_T isDivByUnion,
+        float * ratio)
+{
+    CG_PROFILE_CALL();
+    CG_PROFILE_PHASE(CG_PROFILE_COMPUTE);
+    bbox::overlapRatio(bboxA, (int)numA, bboxB, (int)numB, false,
+        isDivByUnion != 0, ratio);
+}
+
+void bboxOverlap_ratio_singleRM(const float * bboxA, int32_T numA,
+        const float * bboxB, int32_T numB, boolean_T isDivByUnion,
+        float * ratio)
+{
+    CG_PROFILE_CALL();
+    CG_PROFILE_PHASE(CG_PROFILE_COMPUTE);
+    bbox::overlapRatio(bboxA, (int)numA, bboxB, (int)numB, true,
+        isDivByUnion != 0, ratio);
+}
+
+void bboxOverlap_suppress(const double * bbox, const double * score,
+        int32_T numBoxes, double threshold, boolean_T isDivByUnion,
+        boolean_T * isKept)
+{
+    CG_PROFILE_CALL();
+    CG_PROFILE_PHASE(CG_PROFILE_COMPUTE);
+    suppress(bbox, score, numBoxes, false, threshold, isDivByUnion, isKept);
+}
+
+void bboxOverlap_suppressRM(const double * bbox, const double * score,
+        int32_T numBoxes, double threshold, boolean_T isDivByUnion,
+        boolean_T * isKept)
+{
+    CG_PROFILE_CALL();
+    CG_PROFILE_PHASE(CG_PROFILE_COMPUTE);
+    suppress(bbox, score, numBoxes, true, threshold, isDivByUnion, isKept);
+}
+
+void bboxOverlap_suppress_single(const float * bbox, const double * score,
+        int32_T numBoxes, double threshold, boolean_T isDivByUnion,
+        boolean_T * isKept)
+{
+    CG_PROFILE_CALL();
+    CG_PROFILE_PHASE(CG_PROFILE_COMPUTE);
+    suppress(bbox, score, numBoxes, false, threshold, isDivByUnion, isKept);
+}
+
+void bboxOverlap_suppress_singleRM(const float * bbox, const double * score,
+        int32_T numBoxes, double threshold, boolean_T isDivByUnion,
+        boolean_T * isKept)
+{
+    CG_PROFILE_CALL();
+    CG_PROFILE_PHASE(CG_PROFILE_COMPUTE);
+    suppress(bbox, score, numBoxes, true, threshold, isDivByUnion, isKept);
+}
+
+#endif
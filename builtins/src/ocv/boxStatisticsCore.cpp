@@ -0,0 +1,97 @@
+//////////////////////////////////////////////////////////////////////////////
+// Sliding box mean, standard deviation, minimum and maximum of uint8 images
+//
+// A column major image is processed as the row major transpose, with the
+// box transposed as well, so no copy of the image is made.
+//
+// Copyright 2016 The MathWorks, Inc.
+//  
+//////////////////////////////////////////////////////////////////////////////
+
+#ifndef COMPILE_FOR_VISION_BUILTINS
+#include "boxStatisticsCore_api.hpp"
+
+#include "opencv2/opencv.hpp"
+
+#include "cgBoxStatistics.hpp"
+#include "cgProfile.hpp"
+
+// row major header of the image and the box in the same layout
+static void boxStatisticsLayout(int nRows, int nCols, int winRows, int winCols,
+    bool isRowMajor, int &matRows, int &matCols, int &boxRows, int &boxCols)
+{
+    matRows = isRowMajor ? nRows : nCols;
+    matCols = isRowMajor ? nCols : nRows;
+    boxRows = isRowMajor ? winRows : winCols;
+    boxCols = isRowMajor ? winCols : winRows;
+}
+
+static void boxStatistics_meanStd(const uint8_T* img, int nRows, int nCols,
+    int winRows, int winCols, real32_T* mean, real32_T* stdDev, bool isRowMajor)
+{
+    CG_PROFILE_CALL();
+    int matRows, matCols, boxRows, boxCols;
+    boxStatisticsLayout(nRows, nCols, winRows, winCols, isRowMajor,
+                        matRows, matCols, boxRows, boxCols);
+
+    const cv::Mat src(matRows, matCols, CV_8UC1, (void *)img);
+    cv::Mat meanMat(matRows, matCols, CV_32FC1, (void *)mean);
+    cv::Mat stdMat;
+    if (stdDev)
+    {
+        stdMat = cv::Mat(matRows, matCols, CV_32FC1, (void *)stdDev);
+    }
+
+    CG_PROFILE_PHASE(CG_PROFILE_COMPUTE);
+    vision::boxMeanStd(src, boxRows, boxCols, meanMat, stdDev ? &stdMat : NULL);
+}
+
+static void boxStatistics_minMax(const uint8_T* img, int nRows, int nCols,
+    int winRows, int winCols, uint8_T* minImg, uint8_T* maxImg, bool isRowMajor)
+{
+    CG_PROFILE_CALL();
+    int matRows, matCols, boxRows, boxCols;
+    boxStatisticsLayout(nRows, nCols, winRows, winCols, isRowMajor,
+                        matRows, matCols, boxRows, boxCols);
+
+    const cv::Mat src(matRows, matCols, CV_8UC1, (void *)img);
+    cv::Mat minMat, maxMat;
+    if (minImg)
+    {
+        minMat = cv::Mat(matRows, matCols, CV_8UC1, (void *)minImg);
+    }
+    if (maxImg)
+    {
+        maxMat = cv::Mat(matRows, matCols, CV_8UC1, (void *)maxImg);
+    }
+
+    CG_PROFILE_PHASE(CG_PROFILE_COMPUTE);
+    vision::boxMinMax(src, boxRows, boxCols, minImg ? &minMat : NULL,
+                      maxImg ? &maxMat : NULL);
+}
+
+void boxStatistics_meanStd_uint8(const uint8_T* img, int nRows, int nCols,
+    int winRows, int winCols, real32_T* mean, real32_T* stdDev)
+{
+    boxStatistics_meanStd(img, nRows, nCols, winRows, winCols, mean, stdDev, false);
+}
+
+void boxStatistics_meanStd_uint8RM(const uint8_T* img, int nRows, int nCols,
+    int winRows, int winCols, real32_T* mean, real32_T* stdDev)
+{
+    boxStatistics_meanStd(img, nRows, nCols, winRows, winCols, mean, stdDev, true);
+}
+
+void boxStatistics_minMax_uint8(const uint8_T* img, int nRows, int nCols,
+    int winRows, int winCols, uint8_T* minImg, uint8_T* maxImg)
+{
+    boxStatistics_minMax(img, nRows, nCols, winRows, winCols, minImg, maxImg, false);
+}
+
+void boxStatistics_minMax_uint8RM(const uint8_T* img, int nRows, int nCols,
+    int winRows, int winCols, uint8_T* minImg, uint8_T* maxImg)
+{
+    boxStatistics_minMax(img, nRows, nCols, winRows, winCols, minImg, maxImg, true);
+}
+
+#endif
@@ -0,0 +1,60 @@
+///////////////////////////////////////////////////////////////////////////////
+// This file contains the shared library function calls used in codegen for
+// the sparse bundle adjustment of bundleAdjustment.
+///////////////////////////////////////////////////////////////////////////////
+#ifndef COMPILE_FOR_VISION_BUILTINS
+#include "bundleAdjustmentCore_api.hpp"
+#include "BundleAdjuster.hpp"
+#include "cgProfile.hpp"
+
+int32_T bundleAdjustment_solve(double * xyzPoints, const int32_T numPoints,
+        double * orientations, double * locations, const int32_T numViews,
+        const double * measurements, const int32_T * pointIndex,
+        const int32_T * viewIndex, const int32_T numObservations,
+        const double * intrinsics, const int32_T numIntrinsics,
+        const boolean_T * isFixedView, const int32_T maxIterations,
+        const double absoluteTolerance, const double relativeTolerance,
+        const int32_T solver, const double pcgTolerance,
+        const int32_T maxPCGIterations, double * reprojectionErrors,
+        int32_T * numIterations)
+{
+    CG_PROFILE_CALL();
+
+    sfm::BundleAdjustmentParams params;
+    params.maxIterations     = (int)maxIterations;
+    params.absoluteTolerance = absoluteTolerance;
+    params.relativeTolerance = relativeTolerance;
+    params.solver            = (sfm::BundleAdjustmentSolver)solver;
+    params.pcgTolerance      = pcgTolerance;
+    params.maxPCGIterations  = (int)maxPCGIterations;
+
+    std::vector<sfm::BundleAdjustmentIntrinsics> cameras(std::max((int)numIntrinsics, 1));
+    for (int n = 0; n < (int)numIntrinsics; n++)
+    {
+        const double *K = intrinsics + 10 * n;
+        sfm::BundleAdjustmentIntrinsics &camera = cameras[n];
+        camera.fx   = K[0];
+        camera.fy   = K[1];
+        camera.cx   = K[2];
+        camera.cy   = K[3];
+        camera.skew = K[4];
+        camera.k1   = K[5];
+        camera.k2   = K[6];
+        camera.k3   = K[7];
+        camera.p1   = K[8];
+        camera.p2   = K[9];
+    }
+
+    CG_PROFILE_PHASE(CG_PROFILE_COMPUTE);
+    sfm::BundleAdjuster adjuster((int)numPoints, (int)numViews, measurements,
+        pointIndex, viewIndex, (int)numObservations, &cameras[0],
+        (int)numIntrinsics, isFixedView);
+
+    int iterations = 0;
+    const int status = adjuster.solve(params, xyzPoints, orientations,
+        locations, reprojectionErrors, &iterations);
+    numIterations[0] = (int32_T)iterations;
+    return (int32_T)status;
+}
+
+#endif
@@ -0,0 +1,84 @@
+///////////////////////////////////////////////////////////////////////////////
+// This file contains the shared library function calls used in codegen for
+// the native training of trainCascadeObjectDetector, see CascadeTrainer.hpp.
+///////////////////////////////////////////////////////////////////////////////
+#ifndef COMPILE_FOR_VISION_BUILTINS
+#include "cascadeTrainerCore_api.hpp"
+#include "CascadeTrainer.hpp"
+#include "cgProfile.hpp"
+
+using cascadetrainer::CascadeTrainer;
+
+///////////////////////////////////////////////////////////////////////////////
+void cascadeTrainer_construct(int32_T featureType, int32_T winWidth,
+        int32_T winHeight, double precalcBufSizeMB, void **ptr2ptrTrainer)
+{
+    CascadeTrainer *ptrTrainer_ = new CascadeTrainer((int)featureType,
+        (int)winWidth, (int)winHeight,
+        (size_t)(precalcBufSizeMB * 1024 * 1024));
+    *ptr2ptrTrainer = ptrTrainer_;
+}
+
+void cascadeTrainer_addPositives(void *ptrTrainer, const uint8_T * samples,
+        int32_T numSamples)
+{
+    CascadeTrainer *ptrTrainer_ = (CascadeTrainer *)ptrTrainer;
+    ptrTrainer_->addPositives(samples, (int)numSamples, false);
+}
+
+void cascadeTrainer_addPositivesRM(void *ptrTrainer, const uint8_T * samples,
+        int32_T numSamples)
+{
+    CascadeTrainer *ptrTrainer_ = (CascadeTrainer *)ptrTrainer;
+    ptrTrainer_->addPositives(samples, (int)numSamples, true);
+}
+
+void cascadeTrainer_addNegativeImage(void *ptrTrainer, const uint8_T * image,
+        int32_T rows, int32_T cols)
+{
+    CascadeTrainer *ptrTrainer_ = (CascadeTrainer *)ptrTrainer;
+    ptrTrainer_->addNegativeImage(image, (int)rows, (int)cols, false);
+}
+
+void cascadeTrainer_addNegativeImageRM(void *ptrTrainer, const uint8_T * image,
+        int32_T rows, int32_T cols)
+{
+    CascadeTrainer *ptrTrainer_ = (CascadeTrainer *)ptrTrainer;
+    ptrTrainer_->addNegativeImage(image, (int)rows, (int)cols, true);
+}
+
+int32_T cascadeTrainer_trainStage(void *ptrTrainer, int32_T numPos,
+        int32_T numNeg, double minHitRate, double maxFalseAlarm,
+        double weightTrimRate, int32_T maxWeakCount,
+        double * acceptanceRatio)
+{
+    CG_PROFILE_CALL();
+    CG_PROFILE_PHASE(CG_PROFILE_COMPUTE);
+    CascadeTrainer *ptrTrainer_ = (CascadeTrainer *)ptrTrainer;
+
+    cascadetrainer::StageParams params;
+    params.minHitRate     = minHitRate;
+    params.maxFalseAlarm  = maxFalseAlarm;
+    params.weightTrimRate = weightTrimRate;
+    params.maxWeakCount   = (int)maxWeakCount;
+    return (int32_T)ptrTrainer_->trainStage((int)numPos, (int)numNeg, params,
+        *acceptanceRatio);
+}
+
+int32_T cascadeTrainer_getNumStages(void *ptrTrainer)
+{
+    CascadeTrainer *ptrTrainer_ = (CascadeTrainer *)ptrTrainer;
+    return (int32_T)ptrTrainer_->getNumStages();
+}
+
+boolean_T cascadeTrainer_write(void *ptrTrainer, const char * filename)
+{
+    CascadeTrainer *ptrTrainer_ = (CascadeTrainer *)ptrTrainer;
+    return ptrTrainer_->write(filename);
+}
+
+void cascadeTrainer_deleteObj(void *ptrTrainer)
+{
+    delete((CascadeTrainer *)ptrTrainer);
+}
+#endif
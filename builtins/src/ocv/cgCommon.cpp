@@ -5,6 +5,19 @@
  */
 
 #include "cgCommon.hpp"
+#include "cgProfile.hpp"
+#include "cgPyramidCache.hpp"
+
+#include <cstring>
+#include <exception>
+#include <map>
+
+#if defined(PARALLEL) && defined(__linux__)
+#include <cstdio>
+#include <dirent.h>
+#include <pthread.h>
+#include <sched.h>
+#endif
 
 using namespace std;
 using namespace cv;
@@ -64,3 +77,979 @@ void cvRectToBoundingBoxRowMajor(const std::vector<cv::Rect> & rects, int32_T *b
 	}
 }
 
+
+///////////////////////////////////////////////////////////////////////////////
+// boundingBoxToCvRect:
+//  Converts an M-by-4 array of 1-based [x y width height] bounding boxes
+//  to vector<cv::Rect>, the inverse of cvRectToBoundingBox
+///////////////////////////////////////////////////////////////////////////////
+void boundingBoxToCvRect(const int32_T *boundingBoxes, int32_T numBoxes, std::vector<cv::Rect> & rects)
+{
+    // input boundingBoxes: column major (MATLAB MEX or EXE)
+    rects.resize(numBoxes);
+    for (int32_T i = 0; i < numBoxes; i++)
+    {
+        rects[i] = cv::Rect(boundingBoxes[i] - 1, boundingBoxes[numBoxes + i] - 1,
+                            boundingBoxes[numBoxes*2 + i], boundingBoxes[numBoxes*3 + i]);
+    }
+}
+
+void boundingBoxToCvRectRowMajor(const int32_T *boundingBoxes, int32_T numBoxes, std::vector<cv::Rect> & rects)
+{
+    rects.resize(numBoxes);
+    for (int32_T i = 0; i < numBoxes; i++)
+    {
+        const int32_T *box = &boundingBoxes[4*i];
+        rects[i] = cv::Rect(box[0] - 1, box[1] - 1, box[2], box[3]);
+    }
+}
+
+
+// heap order of selectStrongestPerCell: the weakest keypoint on top, the
+// later one on equal responses
+struct KeyPointIsWeaker
+{
+    const std::vector<cv::KeyPoint> &kp;
+    KeyPointIsWeaker(const std::vector<cv::KeyPoint> &kp_) : kp(kp_) {}
+    bool operator()(int a, int b) const
+    {
+        return kp[a].response > kp[b].response ||
+              (kp[a].response == kp[b].response && a < b);
+    }
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// selectStrongestPerCell:
+//  Keeps the maxPerCell keypoints of strongest response in each cellSize by
+//  cellSize cell of an imgRows by imgCols image. Each cell holds a min-heap
+//  of at most maxPerCell keypoints whose root is the weakest kept one, so
+//  the selection is a single pass over the keypoints. The kept keypoints
+//  stay in their detection order; on equal responses the first detected
+//  one is kept. Nothing is removed when cellSize or maxPerCell is not
+//  positive.
+///////////////////////////////////////////////////////////////////////////////
+void selectStrongestPerCell(std::vector<cv::KeyPoint> & keypoints,
+                            int imgRows, int imgCols, int cellSize, int maxPerCell)
+{
+    if (cellSize <= 0 || maxPerCell <= 0 || keypoints.size() <= (size_t)maxPerCell)
+        return;
+
+    const int gridCols = std::max((imgCols + cellSize - 1) / cellSize, 1);
+    const int gridRows = std::max((imgRows + cellSize - 1) / cellSize, 1);
+    const size_t numCells = (size_t)gridRows*gridCols;
+
+    // heap of cell c: heaps[c*maxPerCell .. c*maxPerCell + heapSize[c]-1]
+    std::vector<int> heaps(numCells*maxPerCell);
+    std::vector<int> heapSize(numCells, 0);
+
+    KeyPointIsWeaker weaker(keypoints);
+
+    for (int i = 0; i < (int)keypoints.size(); i++)
+    {
+        const cv::Point2f &pt = keypoints[i].pt;
+        int gx = std::min(std::max(cvFloor(pt.x) / cellSize, 0), gridCols - 1);
+        int gy = std::min(std::max(cvFloor(pt.y) / cellSize, 0), gridRows - 1);
+        size_t c = (size_t)gy*gridCols + gx;
+        int *heap = &heaps[c*maxPerCell];
+        int &n = heapSize[c];
+
+        if (n < maxPerCell)
+        {
+            heap[n++] = i;
+            std::push_heap(heap, heap + n, weaker);
+        }
+        else if (keypoints[i].response > keypoints[heap[0]].response)
+        {
+            std::pop_heap(heap, heap + n, weaker);
+            heap[n - 1] = i;
+            std::push_heap(heap, heap + n, weaker);
+        }
+    }
+
+    std::vector<uchar> isKept(keypoints.size(), 0);
+    for (size_t c = 0; c < numCells; c++)
+    {
+        for (int k = 0; k < heapSize[c]; k++)
+            isKept[heaps[c*maxPerCell + k]] = 1;
+    }
+
+    size_t numKept = 0;
+    for (size_t i = 0; i < keypoints.size(); i++)
+    {
+        if (isKept[i])
+            keypoints[numKept++] = keypoints[i];
+    }
+    keypoints.resize(numKept);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// selectStrongest:
+//  Keeps the maxNum keypoints of strongest response, with the same min-heap
+//  and ordering as selectStrongestPerCell over a single cell. If rows is
+//  not NULL and not empty, its row i belongs to keypoint i, e.g. the
+//  descriptors; the rows of the kept keypoints are moved up and rows is
+//  cut to maxNum rows. Nothing is removed when there are at most maxNum
+//  keypoints.
+///////////////////////////////////////////////////////////////////////////////
+void selectStrongest(std::vector<cv::KeyPoint> & keypoints, int maxNum,
+                     cv::Mat * rows)
+{
+    maxNum = std::max(maxNum, 0);
+    if (keypoints.size() <= (size_t)maxNum)
+        return;
+
+    std::vector<int> heap;
+    heap.reserve(maxNum);
+
+    KeyPointIsWeaker weaker(keypoints);
+
+    for (int i = 0; i < (int)keypoints.size() && maxNum > 0; i++)
+    {
+        if ((int)heap.size() < maxNum)
+        {
+            heap.push_back(i);
+            std::push_heap(heap.begin(), heap.end(), weaker);
+        }
+        else if (keypoints[i].response > keypoints[heap[0]].response)
+        {
+            std::pop_heap(heap.begin(), heap.end(), weaker);
+            heap.back() = i;
+            std::push_heap(heap.begin(), heap.end(), weaker);
+        }
+    }
+
+    // detection order; kept index k is never below k, so the moves are safe
+    std::sort(heap.begin(), heap.end());
+    const bool hasRows = (rows != NULL && !rows->empty());
+    for (int k = 0; k < (int)heap.size(); k++)
+    {
+        if (heap[k] == k)
+            continue;
+        keypoints[k] = keypoints[heap[k]];
+        if (hasRows)
+            rows->row(heap[k]).copyTo(rows->row(k));
+    }
+    keypoints.resize(heap.size());
+    if (hasRows)
+        *rows = rows->rowRange(0, (int)heap.size());
+}
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Native column major processing
+///////////////////////////////////////////////////////////////////////////////
+
+#ifdef PARALLEL
+static std::atomic<int> nativeColumnMajor(0);
+#else
+static int nativeColumnMajor = 0;
+#endif
+
+void cgSetNativeColumnMajor(int32_T enable)
+{
+    nativeColumnMajor = (enable != 0) ? 1 : 0;
+}
+
+int32_T cgGetNativeColumnMajor(void)
+{
+    return (int32_T)nativeColumnMajor;
+}
+
+// The angle, measured from the x axis towards the y axis, becomes 90 - angle;
+// the -1 of keypoints without orientation is kept.
+void transposeKeyPoints(vector<KeyPoint> & keypoints)
+{
+    for (size_t i = 0; i < keypoints.size(); ++i)
+    {
+        KeyPoint & kp = keypoints[i];
+        std::swap(kp.pt.x, kp.pt.y);
+        if (kp.angle >= 0)
+        {
+            kp.angle = 90.0f - kp.angle;
+            if (kp.angle < 0)
+                kp.angle += 360.0f;
+        }
+    }
+}
+
+void transposeRegions(vector< vector<Point> > & regions)
+{
+    for (size_t i = 0; i < regions.size(); ++i)
+    {
+        vector<Point> & region = regions[i];
+        for (size_t j = 0; j < region.size(); ++j)
+            std::swap(region[j].x, region[j].y);
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Worker pool
+///////////////////////////////////////////////////////////////////////////////
+
+#ifdef PARALLEL
+
+namespace vision
+{
+
+// true on the threads owned by the pool
+static thread_local bool isPoolThread = false;
+
+static int getDefaultNumThreads()
+{
+    unsigned int n = std::thread::hardware_concurrency();
+    return n > 0 ? (int)n : 1;
+}
+
+#ifdef __linux__
+
+// Parses a sysfs CPU list such as "0-3,8-11" into cpus.
+static void parseCpuList(const char *list, std::vector<int> &cpus)
+{
+    while (*list != '\0' && *list != '\n')
+    {
+        int first = 0, last = 0, numRead = 0;
+        if (std::sscanf(list, "%d-%d%n", &first, &last, &numRead) != 2)
+        {
+            if (std::sscanf(list, "%d%n", &first, &numRead) != 1)
+                return;
+            last = first;
+        }
+        for (int cpu = first; cpu <= last; ++cpu)
+            cpus.push_back(cpu);
+        list += numRead;
+        if (*list == ',')
+            ++list;
+    }
+}
+
+// CPUs the process may run on, grouped by NUMA node. Without NUMA
+// information all of them form a single node.
+static std::vector<std::vector<int> > getAllowedCpusPerNode()
+{
+    std::vector<std::vector<int> > nodes;
+
+    cpu_set_t allowed;
+    CPU_ZERO(&allowed);
+    if (sched_getaffinity(0, sizeof(allowed), &allowed) != 0)
+        return nodes;
+
+    DIR *dir = opendir("/sys/devices/system/node");
+    if (dir != NULL)
+    {
+        std::vector<int> nodeIds;
+        while (struct dirent *entry = readdir(dir))
+        {
+            int id;
+            char tail;
+            if (std::sscanf(entry->d_name, "node%d%c", &id, &tail) == 1)
+                nodeIds.push_back(id);
+        }
+        closedir(dir);
+        std::sort(nodeIds.begin(), nodeIds.end());
+
+        for (size_t n = 0; n < nodeIds.size(); ++n)
+        {
+            char path[64];
+            std::snprintf(path, sizeof(path),
+                "/sys/devices/system/node/node%d/cpulist", nodeIds[n]);
+            FILE *file = std::fopen(path, "r");
+            if (file == NULL)
+                continue;
+            char list[4096];
+            std::vector<int> cpus, nodeCpus;
+            if (std::fgets(list, sizeof(list), file) != NULL)
+                parseCpuList(list, cpus);
+            std::fclose(file);
+
+            for (size_t c = 0; c < cpus.size(); ++c)
+                if (cpus[c] < CPU_SETSIZE && CPU_ISSET(cpus[c], &allowed))
+                    nodeCpus.push_back(cpus[c]);
+            if (!nodeCpus.empty())
+                nodes.push_back(nodeCpus);
+        }
+    }
+
+    if (nodes.empty())
+    {
+        std::vector<int> cpus;
+        for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu)
+            if (CPU_ISSET(cpu, &allowed))
+                cpus.push_back(cpu);
+        if (!cpus.empty())
+            nodes.push_back(cpus);
+    }
+    return nodes;
+}
+
+// Order in which the workers are given CPUs: node by node for
+// CG_AFFINITY_COMPACT, one CPU of each node in turn for CG_AFFINITY_SCATTER.
+// The topology is only read once per process.
+static const std::vector<int> &getCpuOrder(int policy)
+{
+    static const std::vector<std::vector<int> > nodes = getAllowedCpusPerNode();
+    static std::vector<int> compact, scatter;
+    static std::once_flag isOrdered;
+    std::call_once(isOrdered, [] {
+        size_t maxNodeSize = 0;
+        for (size_t n = 0; n < nodes.size(); ++n)
+        {
+            compact.insert(compact.end(), nodes[n].begin(), nodes[n].end());
+            maxNodeSize = std::max(maxNodeSize, nodes[n].size());
+        }
+        for (size_t c = 0; c < maxNodeSize; ++c)
+            for (size_t n = 0; n < nodes.size(); ++n)
+                if (c < nodes[n].size())
+                    scatter.push_back(nodes[n][c]);
+    });
+    return (policy == CG_AFFINITY_SCATTER) ? scatter : compact;
+}
+
+// Pins the calling worker. The calling thread of the pool typically stays
+// on the first CPU of the order, so worker index takes the CPU after it.
+static void pinWorker(int index, int policy)
+{
+    if (policy != CG_AFFINITY_COMPACT && policy != CG_AFFINITY_SCATTER)
+        return;
+
+    const std::vector<int> &order = getCpuOrder(policy);
+    if (order.size() < 2)
+        return;
+
+    cpu_set_t cpus;
+    CPU_ZERO(&cpus);
+    CPU_SET(order[(index + 1) % order.size()], &cpus);
+    pthread_setaffinity_np(pthread_self(), sizeof(cpus), &cpus);
+}
+
+#else
+
+static void pinWorker(int, int)
+{
+}
+
+#endif // __linux__
+
+ThreadPool &ThreadPool::instance()
+{
+    // initialized on first use; thread-safe in C++11
+    static ThreadPool pool;
+    return pool;
+}
+
+ThreadPool::ThreadPool() : mTask(NULL), mNumTasks(0), mNextTask(0),
+    mNumPending(0), mGeneration(0), mStop(false),
+    mRequestedThreads(getDefaultNumThreads()), mAffinity(CG_AFFINITY_NONE),
+    mIsAffinityChanged(false)
+{
+}
+
+ThreadPool::~ThreadPool()
+{
+    stopWorkers();
+}
+
+void ThreadPool::setNumThreads(int numThreads)
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    mRequestedThreads = numThreads > 0 ? numThreads : getDefaultNumThreads();
+}
+
+int ThreadPool::getNumThreads()
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    return mRequestedThreads;
+}
+
+void ThreadPool::setAffinity(int policy)
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    if (policy != mAffinity)
+    {
+        mAffinity = policy;
+        mIsAffinityChanged = true;
+    }
+}
+
+int ThreadPool::getAffinity()
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    return mAffinity;
+}
+
+void ThreadPool::run(int numTasks, const std::function<void(int)> &task)
+{
+    // nested or concurrent calls do not wait for the pool
+    std::unique_lock<std::mutex> runLock(mRunMutex, std::defer_lock);
+    if (numTasks <= 1 || isPoolThread || !runLock.try_lock())
+    {
+        for (int i = 0; i < numTasks; ++i)
+            task(i);
+        return;
+    }
+
+    // the calling thread is one of the requested threads
+    resize(getNumThreads() - 1);
+
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mTask = &task;
+        mNumTasks = numTasks;
+        mNextTask = 0;
+        mNumPending = numTasks;
+        ++mGeneration;
+    }
+    mWorkAvailable.notify_all();
+
+    executeTasks();
+
+    CG_TRACE_SPAN("pool wait");
+    std::unique_lock<std::mutex> lock(mMutex);
+    mWorkDone.wait(lock, [this] { return mNumPending == 0; });
+    mTask = NULL;
+}
+
+// Called with mRunMutex held and no job in flight.
+void ThreadPool::resize(int numThreads)
+{
+    numThreads = std::max(numThreads, 0);
+    {
+        // workers pinned with an old policy are restarted
+        std::lock_guard<std::mutex> lock(mMutex);
+        if ((int)mWorkers.size() == numThreads && !mIsAffinityChanged)
+            return;
+        mIsAffinityChanged = false;
+    }
+
+    stopWorkers();
+
+    mStop = false;
+    mWorkers.reserve(numThreads);
+    for (int t = 0; t < numThreads; ++t)
+        mWorkers.push_back(std::thread(&ThreadPool::workerLoop, this, t));
+}
+
+void ThreadPool::stopWorkers()
+{
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mStop = true;
+    }
+    mWorkAvailable.notify_all();
+
+    for (size_t t = 0; t < mWorkers.size(); ++t)
+        mWorkers[t].join();
+    mWorkers.clear();
+}
+
+void ThreadPool::workerLoop(int index)
+{
+    isPoolThread = true;
+#ifdef CG_PROFILE
+    cgTraceSetThreadName("pool worker");
+#endif
+
+    unsigned int lastGeneration = 0;
+    int affinity = CG_AFFINITY_NONE;
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        lastGeneration = mGeneration;
+        affinity = mAffinity;
+    }
+
+    // pinned before the first task, so that the memory the worker touches
+    // first is allocated on its node
+    pinWorker(index, affinity);
+
+    for (;;)
+    {
+        {
+            std::unique_lock<std::mutex> lock(mMutex);
+            mWorkAvailable.wait(lock, [&] {
+                return mStop || mGeneration != lastGeneration; });
+            if (mStop)
+                return;
+            lastGeneration = mGeneration;
+        }
+        executeTasks();
+    }
+}
+
+// Takes tasks of the current job until none are left.
+void ThreadPool::executeTasks()
+{
+    for (;;)
+    {
+        const std::function<void(int)> *task;
+        int i;
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            if (mTask == NULL || mNextTask >= mNumTasks)
+                return;
+            task = mTask;
+            i = mNextTask++;
+        }
+
+        {
+            CG_TRACE_SPAN("pool task");
+            (*task)(i);
+        }
+
+        bool isLast;
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            isLast = (--mNumPending == 0);
+        }
+        if (isLast)
+            mWorkDone.notify_all();
+    }
+}
+
+} // namespace vision
+
+void cgSetNumThreads(int32_T numThreads)
+{
+    vision::ThreadPool::instance().setNumThreads((int)numThreads);
+
+    // cv::parallel_for_, whatever its backend, and the cores that size
+    // their work with cv::getNumThreads follow the same setting
+    cv::setNumThreads(numThreads > 0 ? (int)numThreads : -1);
+}
+
+int32_T cgGetNumThreads(void)
+{
+    return (int32_T)vision::ThreadPool::instance().getNumThreads();
+}
+
+void cgSetThreadAffinity(int32_T policy)
+{
+    vision::ThreadPool::instance().setAffinity((int)policy);
+}
+
+int32_T cgGetThreadAffinity(void)
+{
+    return (int32_T)vision::ThreadPool::instance().getAffinity();
+}
+
+#else
+
+void cgSetNumThreads(int32_T numThreads)
+{
+    cv::setNumThreads(numThreads > 0 ? (int)numThreads : -1);
+}
+
+int32_T cgGetNumThreads(void)
+{
+    return 1;
+}
+
+static int32_T threadAffinity = CG_AFFINITY_NONE;
+
+void cgSetThreadAffinity(int32_T policy)
+{
+    threadAffinity = policy;
+}
+
+int32_T cgGetThreadAffinity(void)
+{
+    return threadAffinity;
+}
+
+#endif // PARALLEL
+
+///////////////////////////////////////////////////////////////////////////////
+// Result pools
+///////////////////////////////////////////////////////////////////////////////
+
+namespace vision
+{
+
+static ResultPoolMutex &getResultPoolMutex()
+{
+    static ResultPoolMutex mutex;
+    return mutex;
+}
+
+// protected by getResultPoolMutex()
+static std::vector<ResultPoolRegistry::TrimFcn> &getResultPoolTrims()
+{
+    static std::vector<ResultPoolRegistry::TrimFcn> trims;
+    return trims;
+}
+
+#ifdef PARALLEL
+static std::atomic<int> resultPoolSize(CG_RESULT_POOL_DEFAULT_SIZE);
+#else
+static int resultPoolSize = CG_RESULT_POOL_DEFAULT_SIZE;
+#endif
+
+void ResultPoolRegistry::add(TrimFcn trim)
+{
+    ResultPoolLock lock(getResultPoolMutex());
+    getResultPoolTrims().push_back(trim);
+}
+
+int ResultPoolRegistry::getMaxSize()
+{
+    return resultPoolSize;
+}
+
+void ResultPoolRegistry::setMaxSize(int maxSize)
+{
+    resultPoolSize = maxSize;
+    trim(maxSize);
+}
+
+void ResultPoolRegistry::trim(int maxSize)
+{
+    // the pools are trimmed without the registry lock, since a pool made
+    // meanwhile registers itself under it
+    std::vector<TrimFcn> trims;
+    {
+        ResultPoolLock lock(getResultPoolMutex());
+        trims = getResultPoolTrims();
+    }
+    for (size_t i = 0; i < trims.size(); ++i)
+        trims[i](maxSize);
+}
+
+} // namespace vision
+
+void cgSetResultPoolSize(int32_T maxPerType)
+{
+    vision::ResultPoolRegistry::setMaxSize(maxPerType > 0 ? (int)maxPerType : 0);
+}
+
+int32_T cgGetResultPoolSize(void)
+{
+    return (int32_T)vision::ResultPoolRegistry::getMaxSize();
+}
+
+void cgReleaseResultPool(void)
+{
+    vision::ResultPoolRegistry::trim(0);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Pyramid cache
+///////////////////////////////////////////////////////////////////////////////
+
+namespace vision
+{
+
+struct CachedFrame
+{
+    uint64 hash;
+    FramePyramidPtr pyramid;
+};
+
+static PyramidMutex &getPyramidCacheMutex()
+{
+    static PyramidMutex mutex;
+    return mutex;
+}
+
+// protected by getPyramidCacheMutex(), the most recently acquired first
+static std::vector<CachedFrame> &getCachedFrames()
+{
+    static std::vector<CachedFrame> frames;
+    return frames;
+}
+
+#ifdef PARALLEL
+static std::atomic<int> pyramidCacheSize(CG_PYRAMID_CACHE_DEFAULT_SIZE);
+#else
+static int pyramidCacheSize = CG_PYRAMID_CACHE_DEFAULT_SIZE;
+#endif
+
+// FNV-1a over the 64-bit words of the rows, the bytes left over folded in
+// one by one
+static uint64 hashPixels(const cv::Mat &frame)
+{
+    const uint64 prime = 1099511628211ULL;
+    uint64 hash = 14695981039346656037ULL;
+    const size_t rowBytes = frame.cols * frame.elemSize();
+    for (int r = 0; r < frame.rows; r++)
+    {
+        const uchar *p = frame.ptr(r);
+        size_t i = 0;
+        for (; i + sizeof(uint64) <= rowBytes; i += sizeof(uint64))
+        {
+            uint64 word;
+            memcpy(&word, p + i, sizeof(word));
+            hash = (hash ^ word) * prime;
+        }
+        for (; i < rowBytes; i++)
+            hash = (hash ^ p[i]) * prime;
+    }
+    return hash;
+}
+
+static bool samePixels(const cv::Mat &a, const cv::Mat &b)
+{
+    if (a.size() != b.size() || a.type() != b.type())
+        return false;
+    const size_t rowBytes = a.cols * a.elemSize();
+    for (int r = 0; r < a.rows; r++)
+    {
+        if (memcmp(a.ptr(r), b.ptr(r), rowBytes) != 0)
+            return false;
+    }
+    return true;
+}
+
+FramePyramidPtr PyramidCache::acquire(const cv::Mat &frame)
+{
+    const int maxFrames = pyramidCacheSize;
+    if (maxFrames <= 0)
+        return FramePyramidPtr(new FramePyramid(frame));
+
+    const uint64 hash = hashPixels(frame);
+    {
+        PyramidLock lock(getPyramidCacheMutex());
+        std::vector<CachedFrame> &frames = getCachedFrames();
+        for (size_t i = 0; i < frames.size(); i++)
+        {
+            if (frames[i].hash == hash && samePixels(frames[i].pyramid->getFrame(), frame))
+            {
+                std::rotate(frames.begin(), frames.begin() + i, frames.begin() + i + 1);
+                return frames[0].pyramid;
+            }
+        }
+    }
+
+    // the copy is made outside the lock; should another core have cached
+    // the same frame meanwhile, both pyramids are valid
+    CachedFrame cached;
+    cached.hash = hash;
+    cached.pyramid = FramePyramidPtr(new FramePyramid(frame));
+
+    PyramidLock lock(getPyramidCacheMutex());
+    std::vector<CachedFrame> &frames = getCachedFrames();
+    frames.insert(frames.begin(), cached);
+    if ((int)frames.size() > maxFrames)
+        frames.resize(maxFrames);
+    return cached.pyramid;
+}
+
+int PyramidCache::getMaxFrames()
+{
+    return pyramidCacheSize;
+}
+
+void PyramidCache::setMaxFrames(int maxFrames)
+{
+    pyramidCacheSize = maxFrames;
+    PyramidLock lock(getPyramidCacheMutex());
+    std::vector<CachedFrame> &frames = getCachedFrames();
+    if ((int)frames.size() > maxFrames)
+        frames.resize(maxFrames);
+}
+
+void PyramidCache::release()
+{
+    PyramidLock lock(getPyramidCacheMutex());
+    getCachedFrames().clear();
+}
+
+} // namespace vision
+
+void cgSetPyramidCacheSize(int32_T numFrames)
+{
+    vision::PyramidCache::setMaxFrames(numFrames > 0 ? (int)numFrames : 0);
+}
+
+int32_T cgGetPyramidCacheSize(void)
+{
+    return (int32_T)vision::PyramidCache::getMaxFrames();
+}
+
+void cgReleasePyramidCache(void)
+{
+    vision::PyramidCache::release();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Frame pipeline
+///////////////////////////////////////////////////////////////////////////////
+
+namespace vision
+{
+
+int FramePipeline::runSequential(cgPipelineSourceFcn source, void *sourceState)
+{
+    int numFrames = 0;
+    while (source(sourceState, 0))
+    {
+        for (size_t k = 0; k < mStages.size(); ++k)
+            mStages[k].fcn(mStages[k].state, 0);
+        ++numFrames;
+    }
+    return numFrames;
+}
+
+#ifdef PARALLEL
+
+int FramePipeline::run(cgPipelineSourceFcn source, void *sourceState)
+{
+    if (mMaxInFlight <= 1 || mStages.empty())
+        return runSequential(source, sourceState);
+
+    const int numStages = (int)mStages.size();
+
+    // all below is protected by mutex
+    std::mutex mutex;
+    std::condition_variable changed;
+    // the frames waiting for each stage: frame number -> slot
+    std::vector<std::map<int, int> > waiting(numStages);
+    // the frame number each serial stage takes next
+    std::vector<int> nextFrame(numStages, 0);
+    std::vector<int> freeSlots;
+    for (int s = mMaxInFlight - 1; s >= 0; --s)
+        freeSlots.push_back(s);
+    int numFrames = 0;
+    int numDone = 0;
+    bool isEnd = false;
+    std::exception_ptr error;
+
+    // after an error the frames in flight go through the stages unprocessed
+    auto stageLoop = [&](int k) {
+        const Stage &stage = mStages[k];
+        std::map<int, int> &queue = waiting[k];
+        std::unique_lock<std::mutex> lock(mutex);
+        for (;;)
+        {
+            changed.wait(lock, [&] {
+                return (isEnd && numDone == numFrames) ||
+                    (!queue.empty() && (stage.isParallel || queue.begin()->first == nextFrame[k]));
+            });
+            if (queue.empty())
+                return;
+
+            const int frame = queue.begin()->first;
+            const int slot = queue.begin()->second;
+            queue.erase(queue.begin());
+            const bool isFailed = (bool)error;
+            lock.unlock();
+
+            if (!isFailed)
+            {
+                try
+                {
+                    CG_TRACE_SPAN("pipeline stage");
+                    stage.fcn(stage.state, slot);
+                }
+                catch (...)
+                {
+                    std::lock_guard<std::mutex> errorLock(mutex);
+                    if (!error)
+                        error = std::current_exception();
+                }
+            }
+
+            lock.lock();
+            if (!stage.isParallel)
+                ++nextFrame[k];
+            if (k + 1 < numStages)
+            {
+                waiting[k + 1][frame] = slot;
+            }
+            else
+            {
+                freeSlots.push_back(slot);
+                ++numDone;
+            }
+            changed.notify_all();
+        }
+    };
+
+    // a thread per serial stage; a parallel stage has up to a thread per
+    // slot, within the number of threads of the pool
+    const int numParallel = std::max(1, std::min(ThreadPool::instance().getNumThreads(), mMaxInFlight));
+    std::vector<std::thread> threads;
+    for (int k = 0; k < numStages; ++k)
+    {
+        const int numThreads = mStages[k].isParallel ? numParallel : 1;
+        for (int t = 0; t < numThreads; ++t)
+            threads.push_back(std::thread(stageLoop, k));
+    }
+
+    // the calling thread reads the frames
+    for (;;)
+    {
+        int slot = 0;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            changed.wait(lock, [&] { return !freeSlots.empty() || error; });
+            if (error)
+                break;
+            slot = freeSlots.back();
+            freeSlots.pop_back();
+        }
+
+        bool hasFrame = false;
+        try
+        {
+            hasFrame = source(sourceState, slot) != 0;
+        }
+        catch (...)
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (!error)
+                error = std::current_exception();
+        }
+
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!hasFrame)
+        {
+            freeSlots.push_back(slot);
+            break;
+        }
+        waiting[0][numFrames++] = slot;
+        changed.notify_all();
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        isEnd = true;
+    }
+    changed.notify_all();
+    for (size_t t = 0; t < threads.size(); ++t)
+        threads[t].join();
+
+    if (error)
+        std::rethrow_exception(error);
+    return numFrames;
+}
+
+#else
+
+int FramePipeline::run(cgPipelineSourceFcn source, void *sourceState)
+{
+    return runSequential(source, sourceState);
+}
+
+#endif // PARALLEL
+
+} // namespace vision
+
+void cgPipeline_construct(int32_T maxInFlight, void **ptrPipeline)
+{
+    *ptrPipeline = (void *)new vision::FramePipeline((int)maxInFlight);
+}
+
+void cgPipeline_addStage(void *ptrPipeline, cgPipelineStageFcn fcn, void *stageState,
+    boolean_T isParallel)
+{
+    ((vision::FramePipeline *)ptrPipeline)->addStage(fcn, stageState, isParallel != 0);
+}
+
+int32_T cgPipeline_run(void *ptrPipeline, cgPipelineSourceFcn source, void *sourceState)
+{
+    CG_PROFILE_CALL();
+    return (int32_T)((vision::FramePipeline *)ptrPipeline)->run(source, sourceState);
+}
+
+void cgPipeline_deleteObj(void *ptrPipeline)
+{
+    delete (vision::FramePipeline *)ptrPipeline;
+}
@@ -0,0 +1,438 @@
+//////////////////////////////////////////////////////////////////////////////
+// Timing and allocation instrumentation of the cgwrapper cores, and the
+// Chrome trace of their spans
+//
+// Copyright 2016 The MathWorks, Inc.
+//
+//////////////////////////////////////////////////////////////////////////////
+
+#include "cgProfile.hpp"
+
+#ifdef CG_PROFILE
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+#include "opencv2/core.hpp"
+
+namespace vision
+{
+
+typedef std::chrono::steady_clock ProfileClock;
+
+// Profiling state of a thread. Zero initialized, so the first access does
+// not run a constructor.
+struct ThreadProfile
+{
+    cgProfileRecord_T ring[CG_PROFILE_RING_SIZE];
+    int head;          // oldest record
+    int count;         // records in the ring
+    uint32_T numDropped;
+
+    // call in progress
+    bool isActive;
+    int phase;
+    cgProfileRecord_T current;
+    ProfileClock::time_point callStart;
+    ProfileClock::time_point phaseStart;
+};
+
+static thread_local ThreadProfile threadProfile;
+
+static real_T elapsedNs(ProfileClock::time_point from, ProfileClock::time_point to)
+{
+    return (real_T)std::chrono::duration_cast<std::chrono::nanoseconds>(to - from).count();
+}
+
+static long long toNs(ProfileClock::time_point t)
+{
+    return (long long)std::chrono::duration_cast<std::chrono::nanoseconds>(
+        t.time_since_epoch()).count();
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// Trace
+//////////////////////////////////////////////////////////////////////////////
+
+struct TraceEvent
+{
+    const char *name;
+    const char *category;
+    long long startNs;
+    long long durationNs;
+};
+
+// Spans of a thread. The registry shares them with the thread, so that the
+// spans of threads that have exited are still written.
+struct TraceBuffer
+{
+    TraceBuffer() : numDropped(0), tid(0), threadName(NULL) {}
+
+    // taken by the thread when it adds a span, and by cgTraceStart and
+    // cgTraceWrite
+    std::mutex mutex;
+    std::vector<TraceEvent> events;
+    uint32_T numDropped;
+
+    int tid;
+    const char *threadName;
+
+    // spans opened by cgTraceBegin, only used by the thread
+    std::vector<std::pair<const char *, long long> > open;
+};
+
+static std::atomic<bool> isTracing(false);
+static std::atomic<long long> traceEpochNs(0);
+
+static std::mutex registryMutex;
+static std::vector<std::shared_ptr<TraceBuffer> > registry;
+
+static TraceBuffer &threadTraceBuffer()
+{
+    static thread_local std::shared_ptr<TraceBuffer> buffer;
+    if (!buffer)
+    {
+        buffer = std::make_shared<TraceBuffer>();
+        std::lock_guard<std::mutex> lock(registryMutex);
+        buffer->tid = (int)registry.size() + 1;
+        registry.push_back(buffer);
+    }
+    return *buffer;
+}
+
+static void addSpan(const char *name, const char *category,
+                    long long startNs, long long endNs)
+{
+    if (!isTracing.load(std::memory_order_relaxed))
+        return;
+
+    // spans open when the trace started are clipped to its start
+    startNs = std::max(startNs, traceEpochNs.load(std::memory_order_relaxed));
+
+    TraceBuffer &buffer = threadTraceBuffer();
+    std::lock_guard<std::mutex> lock(buffer.mutex);
+    if (buffer.events.size() >= (size_t)CG_TRACE_MAX_SPANS)
+    {
+        ++buffer.numDropped;
+        return;
+    }
+    TraceEvent event = { name, category, startNs, std::max(endNs - startNs, 0LL) };
+    buffer.events.push_back(event);
+}
+
+static const char *const phaseNames[CG_PROFILE_NUM_PHASES] = { "input", "compute", "output" };
+
+TraceSpan::TraceSpan(const char *name, const char *category)
+    : mName(name), mCategory(category), mStartNs(toNs(ProfileClock::now()))
+{
+}
+
+TraceSpan::~TraceSpan()
+{
+    addSpan(mName, mCategory, mStartNs, toNs(ProfileClock::now()));
+}
+
+// Writes s as a JSON string
+static void writeJsonString(std::FILE *fp, const char *s)
+{
+    std::fputc('"', fp);
+    for (; *s; ++s)
+    {
+        const unsigned char c = (unsigned char)*s;
+        if (c == '"' || c == '\\')
+            std::fprintf(fp, "\\%c", c);
+        else if (c < 0x20)
+            std::fprintf(fp, "\\u%04x", c);
+        else
+            std::fputc(c, fp);
+    }
+    std::fputc('"', fp);
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// Calls
+//////////////////////////////////////////////////////////////////////////////
+
+// Forwards to the allocator it replaces and counts the buffers allocated
+// during a call
+class CountingMatAllocator : public cv::MatAllocator
+{
+public:
+    explicit CountingMatAllocator(cv::MatAllocator *base) : mBase(base) {}
+
+    cv::UMatData *allocate(int dims, const int *sizes, int type, void *data,
+                           size_t *step, int flags, cv::UMatUsageFlags usageFlags) const
+    {
+        cv::UMatData *u = mBase->allocate(dims, sizes, type, data, step, flags, usageFlags);
+        ThreadProfile &tp = threadProfile;
+        if (u && !data && tp.isActive)
+        {
+            ++tp.current.numAllocs;
+            tp.current.allocBytes += (real_T)u->size;
+        }
+        return u;
+    }
+
+    bool allocate(cv::UMatData *data, int accessflags, cv::UMatUsageFlags usageFlags) const
+    {
+        return mBase->allocate(data, accessflags, usageFlags);
+    }
+
+    // buffers are freed by the allocator that made them, which is mBase
+    void deallocate(cv::UMatData *data) const
+    {
+        mBase->deallocate(data);
+    }
+
+private:
+    cv::MatAllocator *mBase;
+};
+
+static void installAllocator()
+{
+    static std::once_flag once;
+    std::call_once(once, [] {
+        static CountingMatAllocator allocator(cv::Mat::getDefaultAllocator());
+        cv::Mat::setDefaultAllocator(&allocator);
+    });
+}
+
+ProfileCall::ProfileCall(const char *name) : mIsOuter(false)
+{
+    ThreadProfile &tp = threadProfile;
+    if (tp.isActive)
+        return;
+
+    installAllocator();
+
+    mIsOuter = true;
+    std::memset(&tp.current, 0, sizeof(tp.current));
+    tp.current.name = name;
+    tp.phase = CG_PROFILE_INPUT;
+    tp.isActive = true;
+    tp.callStart = tp.phaseStart = ProfileClock::now();
+}
+
+ProfileCall::~ProfileCall()
+{
+    if (!mIsOuter)
+        return;
+
+    ThreadProfile &tp = threadProfile;
+    const ProfileClock::time_point now = ProfileClock::now();
+    tp.current.phaseNs[tp.phase] += elapsedNs(tp.phaseStart, now);
+    tp.current.totalNs = elapsedNs(tp.callStart, now);
+    tp.isActive = false;
+
+    addSpan(phaseNames[tp.phase], "phase", toNs(tp.phaseStart), toNs(now));
+    addSpan(tp.current.name, "call", toNs(tp.callStart), toNs(now));
+
+    if (tp.count == CG_PROFILE_RING_SIZE)
+    {
+        tp.head = (tp.head + 1) % CG_PROFILE_RING_SIZE;
+        --tp.count;
+        ++tp.numDropped;
+    }
+    tp.ring[(tp.head + tp.count) % CG_PROFILE_RING_SIZE] = tp.current;
+    ++tp.count;
+}
+
+void ProfileCall::setPhase(int phase)
+{
+    ThreadProfile &tp = threadProfile;
+    if (!tp.isActive || phase == tp.phase)
+        return;
+
+    const ProfileClock::time_point now = ProfileClock::now();
+    tp.current.phaseNs[tp.phase] += elapsedNs(tp.phaseStart, now);
+    addSpan(phaseNames[tp.phase], "phase", toNs(tp.phaseStart), toNs(now));
+    tp.phaseStart = now;
+    tp.phase = phase;
+}
+
+} // namespace vision
+
+boolean_T cgProfileIsEnabled(void)
+{
+    return true;
+}
+
+int32_T cgProfileRead(cgProfileRecord_T *records, int32_T maxRecords)
+{
+    vision::ThreadProfile &tp = vision::threadProfile;
+    int32_T n = 0;
+    while (n < maxRecords && tp.count > 0)
+    {
+        records[n++] = tp.ring[tp.head];
+        tp.head = (tp.head + 1) % CG_PROFILE_RING_SIZE;
+        --tp.count;
+    }
+    return n;
+}
+
+uint32_T cgProfileNumDropped(void)
+{
+    return vision::threadProfile.numDropped;
+}
+
+void cgTraceStart(void)
+{
+    using namespace vision;
+
+    std::lock_guard<std::mutex> lock(registryMutex);
+    for (size_t t = 0; t < registry.size(); ++t)
+    {
+        std::lock_guard<std::mutex> bufferLock(registry[t]->mutex);
+        registry[t]->events.clear();
+        registry[t]->numDropped = 0;
+    }
+    traceEpochNs = toNs(ProfileClock::now());
+    isTracing = true;
+}
+
+void cgTraceStop(void)
+{
+    vision::isTracing = false;
+}
+
+int32_T cgTraceWrite(const char *filename)
+{
+    using namespace vision;
+
+    std::FILE *fp = std::fopen(filename, "w");
+    if (!fp)
+        return -1;
+
+    std::vector<std::shared_ptr<TraceBuffer> > buffers;
+    {
+        std::lock_guard<std::mutex> lock(registryMutex);
+        buffers = registry;
+    }
+
+    const long long epochNs = traceEpochNs;
+    int32_T numSpans = 0;
+    uint32_T numDropped = 0;
+    const char *separator = "\n";
+
+    std::fprintf(fp, "{\"traceEvents\":[");
+    for (size_t t = 0; t < buffers.size(); ++t)
+    {
+        TraceBuffer &buffer = *buffers[t];
+        std::lock_guard<std::mutex> bufferLock(buffer.mutex);
+        if (buffer.events.empty())
+            continue;
+
+        std::fprintf(fp, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,"
+                     "\"args\":{\"name\":", separator, buffer.tid);
+        if (buffer.threadName)
+        {
+            writeJsonString(fp, buffer.threadName);
+        }
+        else
+        {
+            std::fprintf(fp, "\"thread %d\"", buffer.tid);
+        }
+        std::fprintf(fp, "}}");
+        separator = ",\n";
+
+        for (size_t i = 0; i < buffer.events.size(); ++i)
+        {
+            const TraceEvent &event = buffer.events[i];
+            std::fprintf(fp, "%s{\"name\":", separator);
+            writeJsonString(fp, event.name);
+            std::fprintf(fp, ",\"cat\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%d,"
+                         "\"ts\":%.3f,\"dur\":%.3f}",
+                         event.category, buffer.tid,
+                         (double)(event.startNs - epochNs) / 1000.0,
+                         (double)event.durationNs / 1000.0);
+        }
+        numSpans += (int32_T)buffer.events.size();
+        numDropped += buffer.numDropped;
+    }
+    std::fprintf(fp, "\n],\"displayTimeUnit\":\"ns\",\"otherData\":{\"droppedSpans\":%u}}\n",
+                 (unsigned int)numDropped);
+
+    const bool isWritten = !std::ferror(fp);
+    if (std::fclose(fp) != 0 || !isWritten)
+        return -1;
+    return numSpans;
+}
+
+void cgTraceBegin(const char *name)
+{
+    using namespace vision;
+
+    threadTraceBuffer().open.push_back(
+        std::make_pair(name, toNs(ProfileClock::now())));
+}
+
+void cgTraceEnd(void)
+{
+    using namespace vision;
+
+    TraceBuffer &buffer = threadTraceBuffer();
+    if (buffer.open.empty())
+        return;
+
+    const std::pair<const char *, long long> span = buffer.open.back();
+    buffer.open.pop_back();
+    addSpan(span.first, "span", span.second, toNs(ProfileClock::now()));
+}
+
+void cgTraceSetThreadName(const char *name)
+{
+    vision::TraceBuffer &buffer = vision::threadTraceBuffer();
+    std::lock_guard<std::mutex> lock(buffer.mutex);
+    buffer.threadName = name;
+}
+
+#else
+
+boolean_T cgProfileIsEnabled(void)
+{
+    return false;
+}
+
+int32_T cgProfileRead(cgProfileRecord_T *, int32_T)
+{
+    return 0;
+}
+
+uint32_T cgProfileNumDropped(void)
+{
+    return 0;
+}
+
+void cgTraceStart(void)
+{
+}
+
+void cgTraceStop(void)
+{
+}
+
+int32_T cgTraceWrite(const char *)
+{
+    return -1;
+}
+
+void cgTraceBegin(const char *)
+{
+}
+
+void cgTraceEnd(void)
+{
+}
+
+void cgTraceSetThreadName(const char *)
+{
+}
+
+#endif // CG_PROFILE
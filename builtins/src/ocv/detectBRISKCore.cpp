@@ -10,23 +10,27 @@
 
 #include "detectBRISKCore_api.hpp"
 #include "features2d_other_mw.hpp"
+#include "agast_score_mw.hpp"
 
 #include "opencv2/opencv.hpp"
 #include "cgCommon.hpp"
+#include "cgProfile.hpp"
 
 ////////////////////////////////////////////////////////////////////////////////
 // copy BRISK keyPoints to struct
 ////////////////////////////////////////////////////////////////////////////////
+// location is stride-by-2, stride being at least the number of keypoints
 void briskKeyPointToStruct(std::vector<cv::KeyPoint> &keypoints,
                            real32_T * location,real32_T * metric,
-                           real32_T * scale, real32_T * orientation)
+                           real32_T * scale, real32_T * orientation,
+                           size_t stride)
 {
     size_t m = keypoints.size();
 
     for(size_t i = 0; i < m; i++ ) {
         const cv::KeyPoint& kp = keypoints[i];
         location[i]    = kp.pt.x+1;     // Convert to 1 based indexing
-        location[m+i]  = kp.pt.y+1;
+        location[stride+i] = kp.pt.y+1;
         metric[i]      = kp.response; 
         scale[i]       = kp.size;
         orientation[i] = 0.0F; // detector does not compute angle
@@ -57,6 +61,7 @@ void briskKeyPointToStructRM(std::vector<cv::KeyPoint> &keypoints,
 int32_T detectBRISK_detect(uint8_T *img, int nRows, int nCols,
                            int threshold, int numOctaves, void **outKeyPoints)
 {
+    CG_PROFILE_CALL();
 
     using namespace cv;
 
@@ -65,9 +70,10 @@ int32_T detectBRISK_detect(uint8_T *img, int nRows, int nCols,
     Ptr<Mat> mat = new Mat;
     
     cArrayToMat<uint8_T>(img, nRows, nCols, isRGB, *mat);
+    CG_PROFILE_PHASE(CG_PROFILE_COMPUTE);
 
     // create keypoint container
-    std::vector<KeyPoint> *ptrKeypoints = new std::vector<KeyPoint>();
+    std::vector<KeyPoint> *ptrKeypoints = vision::ResultPool<std::vector<KeyPoint> >::acquire();
     *outKeyPoints = (void *)ptrKeypoints;
 
     float patternScale = 1.0f;
@@ -87,23 +93,25 @@ int32_T detectBRISK_detect(uint8_T *img, int nRows, int nCols,
 int32_T detectBRISK_detectRM(uint8_T *img, int nRows, int nCols,
 	int threshold, int numOctaves, void **outKeyPoints)
 {
+	CG_PROFILE_CALL();
 
 	using namespace cv;
 
 	const bool isRGB = false; // only grayscale images are supported for BRISK
 
-	Ptr<Mat> mat = new Mat;
+	Mat mat;
 
-	cArrayToMat_RowMaj<uint8_T>(img, nRows, nCols, isRGB, *mat);
+	cArrayToMatView_RowMaj<uint8_T>(img, nRows, nCols, isRGB, mat);
+	CG_PROFILE_PHASE(CG_PROFILE_COMPUTE);
 
 	// create keypoint container
-	std::vector<KeyPoint> *ptrKeypoints = new std::vector<KeyPoint>();
+	std::vector<KeyPoint> *ptrKeypoints = vision::ResultPool<std::vector<KeyPoint> >::acquire();
 	*outKeyPoints = (void *)ptrKeypoints;
 
-	// construct BRISK object. Assign to static variable because
-	// construction costs are high due to one-time look-up table creation.
+	// the descriptor look-up tables are only built by compute, so the
+	// detector is cheap to construct
 	float patternScale = 1.0f;
-	static Ptr<MWBRISK> brisk = cv::MWBRISK::create(threshold, numOctaves, patternScale);
+	Ptr<MWBRISK> brisk = cv::MWBRISK::create(threshold, numOctaves, patternScale);
 
 	if (brisk.empty()) {
 		CV_Error(CV_StsNotImplemented, "OpenCV was built without BRISK support");
@@ -111,11 +119,119 @@ int32_T detectBRISK_detectRM(uint8_T *img, int nRows, int nCols,
 
 	// detect keypoints
 	std::vector<KeyPoint> &refKeypoints = *ptrKeypoints;
-	brisk->detect(*mat, refKeypoints, cv::Mat());
+	brisk->detect(mat, refKeypoints, cv::Mat());
 
 	return static_cast<int32_T>(refKeypoints.size());
 }
 
+////////////////////////////////////////////////////////////////////////////////
+// Same as detectBRISK_detect, but only the maxPerCell strongest keypoints of
+// each cellSize by cellSize cell of the image, over all the scales, are
+// returned.
+////////////////////////////////////////////////////////////////////////////////
+int32_T detectBRISK_detectBucketed(uint8_T *img, int nRows, int nCols,
+                                   int threshold, int numOctaves,
+                                   int cellSize, int maxPerCell,
+                                   void **outKeyPoints)
+{
+    CG_PROFILE_CALL();
+    detectBRISK_detect(img, nRows, nCols, threshold, numOctaves, outKeyPoints);
+
+    std::vector<cv::KeyPoint> &refKeypoints = *((std::vector<cv::KeyPoint> *)*outKeyPoints);
+    selectStrongestPerCell(refKeypoints, nRows, nCols, cellSize, maxPerCell);
+
+    return static_cast<int32_T>(refKeypoints.size());
+}
+
+int32_T detectBRISK_detectBucketedRM(uint8_T *img, int nRows, int nCols,
+                                     int threshold, int numOctaves,
+                                     int cellSize, int maxPerCell,
+                                     void **outKeyPoints)
+{
+	CG_PROFILE_CALL();
+	detectBRISK_detectRM(img, nRows, nCols, threshold, numOctaves, outKeyPoints);
+
+	std::vector<cv::KeyPoint> &refKeypoints = *((std::vector<cv::KeyPoint> *)*outKeyPoints);
+	selectStrongestPerCell(refKeypoints, nRows, nCols, cellSize, maxPerCell);
+
+	return static_cast<int32_T>(refKeypoints.size());
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Corner score method, read by the layers of a scale space when they are
+// filled
+////////////////////////////////////////////////////////////////////////////////
+void detectBRISK_setScoreMethod(int32_T method)
+{
+    cv::setAgastScoreMethod((method == BRISK_SCORE_COMPACT) ?
+                            cv::AGAST_SCORE_COMPACT : cv::AGAST_SCORE_TREE);
+}
+
+int32_T detectBRISK_getScoreMethod(void)
+{
+    return (cv::getAgastScoreMethod() == cv::AGAST_SCORE_COMPACT) ?
+        BRISK_SCORE_COMPACT : BRISK_SCORE_TREE;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Persistent BRISK detector: the object keeps the layer buffers of its scale
+// space from one image to the next of the same size.
+////////////////////////////////////////////////////////////////////////////////
+void detectBRISK_construct(void **ptr2ptrClass, int threshold, int numOctaves)
+{
+    float patternScale = 1.0f;
+    cv::Ptr<cv::MWBRISK> *ptrClass_ = new cv::Ptr<cv::MWBRISK>(
+        cv::MWBRISK::create(threshold, numOctaves, patternScale));
+    *ptr2ptrClass = ptrClass_;
+}
+
+int32_T detectBRISK_detectObj(void *ptrClass, uint8_T *img, int nRows, int nCols,
+                              void **outKeyPoints)
+{
+    CG_PROFILE_CALL();
+    using namespace cv;
+
+    const bool isRGB = false; // only grayscale images are supported for BRISK
+
+    Mat mat;
+    cArrayToMat<uint8_T>(img, nRows, nCols, isRGB, mat);
+    CG_PROFILE_PHASE(CG_PROFILE_COMPUTE);
+
+    std::vector<KeyPoint> *ptrKeypoints = vision::ResultPool<std::vector<KeyPoint> >::acquire();
+    *outKeyPoints = (void *)ptrKeypoints;
+
+    Ptr<MWBRISK> &brisk = *((Ptr<MWBRISK> *)ptrClass);
+    brisk->detect(mat, *ptrKeypoints, cv::Mat());
+
+    return static_cast<int32_T>(ptrKeypoints->size());
+}
+
+int32_T detectBRISK_detectObjRM(void *ptrClass, uint8_T *img, int nRows, int nCols,
+                                void **outKeyPoints)
+{
+    CG_PROFILE_CALL();
+    using namespace cv;
+
+    const bool isRGB = false; // only grayscale images are supported for BRISK
+
+    Mat mat;
+    cArrayToMatView_RowMaj<uint8_T>(img, nRows, nCols, isRGB, mat);
+    CG_PROFILE_PHASE(CG_PROFILE_COMPUTE);
+
+    std::vector<KeyPoint> *ptrKeypoints = vision::ResultPool<std::vector<KeyPoint> >::acquire();
+    *outKeyPoints = (void *)ptrKeypoints;
+
+    Ptr<MWBRISK> &brisk = *((Ptr<MWBRISK> *)ptrClass);
+    brisk->detect(mat, *ptrKeypoints, cv::Mat());
+
+    return static_cast<int32_T>(ptrKeypoints->size());
+}
+
+void detectBRISK_deleteObj(void *ptrClass)
+{
+    delete((cv::Ptr<cv::MWBRISK> *)ptrClass);
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 // Copy keypoints to struct and delete keypoint data 
 ////////////////////////////////////////////////////////////////////////////////
@@ -123,23 +239,102 @@ void detectBRISK_assignOutputs(void *ptrKeypoints,
                                real32_T * location,real32_T * metric,
                                real32_T * scale, real32_T * orientation)
 {
+    CG_PROFILE_CALL();
+    CG_PROFILE_PHASE(CG_PROFILE_OUTPUT);
     
     // Populate the outputs
-    briskKeyPointToStruct(*((std::vector<cv::KeyPoint> *)ptrKeypoints),
-                          location, metric, scale, orientation);
+    std::vector<cv::KeyPoint> &keypoints = *((std::vector<cv::KeyPoint> *)ptrKeypoints);
+    briskKeyPointToStruct(keypoints, location, metric, scale, orientation,
+                          keypoints.size());
     
-    delete((std::vector<cv::KeyPoint> *)ptrKeypoints);
+    vision::ResultPool<std::vector<cv::KeyPoint> >::release((std::vector<cv::KeyPoint> *)ptrKeypoints);
 }
 
 void detectBRISK_assignOutputsRM(void *ptrKeypoints,
 	real32_T * location, real32_T * metric,
 	real32_T * scale, real32_T * orientation)
 {
+	CG_PROFILE_CALL();
+	CG_PROFILE_PHASE(CG_PROFILE_OUTPUT);
 
 	// Populate the outputs
 	briskKeyPointToStructRM(*((std::vector<cv::KeyPoint> *)ptrKeypoints),
 		location, metric, scale, orientation);
 
-	delete((std::vector<cv::KeyPoint> *)ptrKeypoints);
+	vision::ResultPool<std::vector<cv::KeyPoint> >::release((std::vector<cv::KeyPoint> *)ptrKeypoints);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Single call detection: the outputs are written straight into caller
+// buffers of capacity keypoints, location being capacity-by-2. If more
+// keypoints are found, the capacity strongest are written, in detection
+// order. Returns the number of keypoints found, which may exceed capacity;
+// min(count, capacity) of them are written.
+////////////////////////////////////////////////////////////////////////////////
+static int32_T briskKeyPointsInto(void *ptrKeypoints, int capacity, bool isRowMajor,
+                                  real32_T * location, real32_T * metric,
+                                  real32_T * scale, real32_T * orientation)
+{
+    CG_PROFILE_PHASE(CG_PROFILE_OUTPUT);
+    std::vector<cv::KeyPoint> &keypoints = *((std::vector<cv::KeyPoint> *)ptrKeypoints);
+    const int32_T numKeypoints = static_cast<int32_T>(keypoints.size());
+
+    selectStrongest(keypoints, capacity);
+    if (isRowMajor)
+        briskKeyPointToStructRM(keypoints, location, metric, scale, orientation);
+    else
+        briskKeyPointToStruct(keypoints, location, metric, scale, orientation,
+                              (size_t)std::max(capacity, 0));
+
+    vision::ResultPool<std::vector<cv::KeyPoint> >::release(&keypoints);
+    return numKeypoints;
+}
+
+int32_T detectBRISK_detectInto(uint8_T *img, int nRows, int nCols,
+                               int threshold, int numOctaves, int capacity,
+                               real32_T * location, real32_T * metric,
+                               real32_T * scale, real32_T * orientation)
+{
+    CG_PROFILE_CALL();
+    void *ptrKeypoints = NULL;
+    detectBRISK_detect(img, nRows, nCols, threshold, numOctaves, &ptrKeypoints);
+    return briskKeyPointsInto(ptrKeypoints, capacity, false,
+                              location, metric, scale, orientation);
+}
+
+int32_T detectBRISK_detectIntoRM(uint8_T *img, int nRows, int nCols,
+                                 int threshold, int numOctaves, int capacity,
+                                 real32_T * location, real32_T * metric,
+                                 real32_T * scale, real32_T * orientation)
+{
+    CG_PROFILE_CALL();
+    void *ptrKeypoints = NULL;
+    detectBRISK_detectRM(img, nRows, nCols, threshold, numOctaves, &ptrKeypoints);
+    return briskKeyPointsInto(ptrKeypoints, capacity, true,
+                              location, metric, scale, orientation);
+}
+
+int32_T detectBRISK_detectObjInto(void *ptrClass, uint8_T *img, int nRows, int nCols,
+                                  int capacity,
+                                  real32_T * location, real32_T * metric,
+                                  real32_T * scale, real32_T * orientation)
+{
+    CG_PROFILE_CALL();
+    void *ptrKeypoints = NULL;
+    detectBRISK_detectObj(ptrClass, img, nRows, nCols, &ptrKeypoints);
+    return briskKeyPointsInto(ptrKeypoints, capacity, false,
+                              location, metric, scale, orientation);
+}
+
+int32_T detectBRISK_detectObjIntoRM(void *ptrClass, uint8_T *img, int nRows, int nCols,
+                                    int capacity,
+                                    real32_T * location, real32_T * metric,
+                                    real32_T * scale, real32_T * orientation)
+{
+    CG_PROFILE_CALL();
+    void *ptrKeypoints = NULL;
+    detectBRISK_detectObjRM(ptrClass, img, nRows, nCols, &ptrKeypoints);
+    return briskKeyPointsInto(ptrKeypoints, capacity, true,
+                              location, metric, scale, orientation);
 }
 #endif
\ No newline at end of file
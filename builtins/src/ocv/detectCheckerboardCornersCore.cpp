@@ -0,0 +1,68 @@
+///////////////////////////////////////////////////////////////////////////////
+// This file contains the shared library function calls used in codegen for
+// the checkerboard corner candidates of detectCheckerboardPoints, see
+// CheckerboardCornerDetector.hpp.
+///////////////////////////////////////////////////////////////////////////////
+#ifndef COMPILE_FOR_VISION_BUILTINS
+#include "detectCheckerboardCornersCore_api.hpp"
+#include "CheckerboardCornerDetector.hpp"
+#include "cgProfile.hpp"
+
+typedef std::vector<std::vector<checkerboard::CornerCandidate> > CandidateBatch;
+
+int32_T detectCheckerboardCorners_detect(const real32_T * images,
+        const int32_T nRows, const int32_T nCols, const int32_T numImages,
+        const double sigma, const double peakThreshold,
+        int32_T * numCandidates, void ** ptr2ptrBatch)
+{
+    CG_PROFILE_CALL();
+    CG_PROFILE_PHASE(CG_PROFILE_COMPUTE);
+
+    CandidateBatch *batch = new CandidateBatch();
+    *ptr2ptrBatch = batch;
+    checkerboard::detectCornerCandidates(images, (int)nRows, (int)nCols,
+        (int)numImages, sigma, peakThreshold, *batch);
+
+    int32_T numTotal = 0;
+    for (size_t k = 0; k < batch->size(); k++)
+    {
+        numCandidates[k] = (int32_T)(*batch)[k].size();
+        numTotal += numCandidates[k];
+    }
+    return numTotal;
+}
+
+void detectCheckerboardCorners_assignOutputDeleteBatch(void * ptrBatch,
+        real32_T * points, real32_T * scores, real32_T * orientations,
+        real32_T * subPixelPoints)
+{
+    CG_PROFILE_CALL();
+    CG_PROFILE_PHASE(CG_PROFILE_OUTPUT);
+    const CandidateBatch &batch = *(CandidateBatch *)ptrBatch;
+
+    size_t n = 0;
+    for (size_t k = 0; k < batch.size(); k++)
+        n += batch[k].size();
+
+    size_t i = 0;
+    for (size_t k = 0; k < batch.size(); k++)
+    {
+        for (size_t j = 0; j < batch[k].size(); j++, i++)
+        {
+            const checkerboard::CornerCandidate &c = batch[k][j];
+            points[i]               = c.x;
+            points[i + n]           = c.y;
+            scores[i]               = c.score;
+            orientations[i]         = c.v1[0];
+            orientations[i + n]     = c.v1[1];
+            orientations[i + 2 * n] = c.v2[0];
+            orientations[i + 3 * n] = c.v2[1];
+            subPixelPoints[i]       = c.subPixelX;
+            subPixelPoints[i + n]   = c.subPixelY;
+        }
+    }
+
+    delete (CandidateBatch *)ptrBatch;
+}
+
+#endif
@@ -12,22 +12,23 @@
 
 #include "opencv2/opencv.hpp"
 #include "cgCommon.hpp"
+#include "cgProfile.hpp"
 
 using namespace cv;
 using namespace std;
 
 //////////////////////////////////////////////////////////////////////////////
-//
+// points is stride-by-2, stride being at least the number of keypoints
 //////////////////////////////////////////////////////////////////////////////
 void fastKeyPointToFields(vector<KeyPoint> &keypoints,
-    real32_T *points, real32_T *metric)
+    real32_T *points, real32_T *metric, size_t stride)
 {
     size_t m = keypoints.size();
 
     for(size_t i = 0; i < m; i++ ) {
         cv::KeyPoint& kp = keypoints[i];
         points[i]     = kp.pt.x+1;     // Convert to MATLAB's 1 based indexing
-        points[m+i]   = kp.pt.y+1;
+        points[stride+i] = kp.pt.y+1;
         metric[i]     = kp.response;   // Copy corner metric
     }
 }
@@ -53,24 +54,29 @@ int32_T detectFAST_compute(uint8_T *inImg,
     int threshold,
     void **outKeypoints)
 {
-    // Use OpenCV smart pointer to manage image 
-    cv::Ptr<cv::Mat> inImage = new cv::Mat;
+    CG_PROFILE_CALL();
+    // Grayscale input is used in place, as its transpose, when native
+    // column major processing is on
+    cv::Mat inImage;
 	bool isRGB_ = (bool)(isRGB != 0);
-	cArrayToMat<uint8_T>(inImg, nRows, nCols, isRGB_, *inImage);
+	const bool isTransposed = cArrayToMatView_ColMaj<uint8_T>(inImg, nRows, nCols, isRGB_, inImage);
+	CG_PROFILE_PHASE(CG_PROFILE_COMPUTE);
 
     // keypoints
-    vector<KeyPoint> *ptrKeypoints = (vector<KeyPoint> *)new vector<KeyPoint>();
+    vector<KeyPoint> *ptrKeypoints = vision::ResultPool<vector<KeyPoint> >::acquire();
     *outKeypoints = ptrKeypoints;
     vector<KeyPoint> &refKeypoints = *ptrKeypoints;
 
     try
     {
-        cv::FAST(*inImage, refKeypoints, threshold);
+        cv::FAST(inImage, refKeypoints, threshold);
     }
     catch (...)
     {
         CV_Error(CV_StsNotImplemented, "OpenCV was built without FAST support");
     }
+    if (isTransposed)
+        transposeKeyPoints(refKeypoints);
 
     return ((int32_T)(refKeypoints.size())); //actual_numel
 }
@@ -80,19 +86,21 @@ int32_T detectFAST_computeRM(uint8_T *inImg,
 	int threshold,
 	void **outKeypoints)
 {
-	// Use OpenCV smart pointer to manage image 
-	cv::Ptr<cv::Mat> inImage = new cv::Mat;
+	CG_PROFILE_CALL();
+	// Grayscale row major input is used in place, without a copy
+	cv::Mat inImage;
 	bool isRGB_ = (bool)(isRGB != 0);
-	cArrayToMat_RowMaj<uint8_T>(inImg, nRows, nCols, isRGB_, *inImage);
+	cArrayToMatView_RowMaj<uint8_T>(inImg, nRows, nCols, isRGB_, inImage);
+	CG_PROFILE_PHASE(CG_PROFILE_COMPUTE);
 
 	// keypoints
-	vector<KeyPoint> *ptrKeypoints = (vector<KeyPoint> *)new vector<KeyPoint>();
+	vector<KeyPoint> *ptrKeypoints = vision::ResultPool<vector<KeyPoint> >::acquire();
 	*outKeypoints = ptrKeypoints;
 	vector<KeyPoint> &refKeypoints = *ptrKeypoints;
 
 	try
 	{
-		cv::FAST(*inImage, refKeypoints, threshold);
+		cv::FAST(inImage, refKeypoints, threshold);
 	}
 	catch (...)
 	{
@@ -102,26 +110,109 @@ int32_T detectFAST_computeRM(uint8_T *inImg,
 	return ((int32_T)(refKeypoints.size())); //actual_numel
 }
 
+//////////////////////////////////////////////////////////////////////////////
+// Same as detectFAST_compute, but only the maxPerCell strongest corners of
+// each cellSize by cellSize cell of the image are returned, which bounds
+// the number of keypoints copied out and described downstream.
+//////////////////////////////////////////////////////////////////////////////
+int32_T detectFAST_computeBucketed(uint8_T *inImg,
+    int32_T nRows, int32_T nCols, int32_T isRGB,
+    int threshold, int32_T cellSize, int32_T maxPerCell,
+    void **outKeypoints)
+{
+    CG_PROFILE_CALL();
+    detectFAST_compute(inImg, nRows, nCols, isRGB, threshold, outKeypoints);
+
+    vector<KeyPoint> &refKeypoints = *((vector<KeyPoint> *)*outKeypoints);
+    selectStrongestPerCell(refKeypoints, nRows, nCols, cellSize, maxPerCell);
+
+    return ((int32_T)(refKeypoints.size())); //actual_numel
+}
+
+int32_T detectFAST_computeBucketedRM(uint8_T *inImg,
+	int32_T nRows, int32_T nCols, int32_T isRGB,
+	int threshold, int32_T cellSize, int32_T maxPerCell,
+	void **outKeypoints)
+{
+	CG_PROFILE_CALL();
+	detectFAST_computeRM(inImg, nRows, nCols, isRGB, threshold, outKeypoints);
+
+	vector<KeyPoint> &refKeypoints = *((vector<KeyPoint> *)*outKeypoints);
+	selectStrongestPerCell(refKeypoints, nRows, nCols, cellSize, maxPerCell);
+
+	return ((int32_T)(refKeypoints.size())); //actual_numel
+}
+
 void detectFAST_assignOutput(void *ptrKeypoints,
     real32_T *outLoc, real32_T *outMetric)
 {
-    vector<KeyPoint> keypoints = ((vector<KeyPoint> *)ptrKeypoints)[0];
+    CG_PROFILE_CALL();
+    CG_PROFILE_PHASE(CG_PROFILE_OUTPUT);
+    vector<KeyPoint> &keypoints = ((vector<KeyPoint> *)ptrKeypoints)[0];
 
     // Populate the outputs
-    fastKeyPointToFields(keypoints, outLoc, outMetric);
+    fastKeyPointToFields(keypoints, outLoc, outMetric, keypoints.size());
 
-    delete((vector<KeyPoint> *)ptrKeypoints);
+    vision::ResultPool<vector<KeyPoint> >::release((vector<KeyPoint> *)ptrKeypoints);
 }
 
 void detectFAST_assignOutputRM(void *ptrKeypoints,
 	real32_T *outLoc, real32_T *outMetric)
 {
-	vector<KeyPoint> keypoints = ((vector<KeyPoint> *)ptrKeypoints)[0];
+	CG_PROFILE_CALL();
+	CG_PROFILE_PHASE(CG_PROFILE_OUTPUT);
+	vector<KeyPoint> &keypoints = ((vector<KeyPoint> *)ptrKeypoints)[0];
 
 	// Populate the outputs
 	fastKeyPointToFieldsRM(keypoints, outLoc, outMetric);
 
-	delete((vector<KeyPoint> *)ptrKeypoints);
+	vision::ResultPool<vector<KeyPoint> >::release((vector<KeyPoint> *)ptrKeypoints);
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// Single call detection: detectFAST_compute followed by the output copy,
+// straight into caller buffers of capacity corners. outLoc is capacity-by-2.
+// If more corners are found, the capacity strongest are written, in
+// detection order. Returns the number of corners found, which may exceed
+// capacity; min(count, capacity) of them are written.
+//////////////////////////////////////////////////////////////////////////////
+int32_T detectFAST_computeInto(uint8_T *inImg,
+    int32_T nRows, int32_T nCols, int32_T isRGB,
+    int threshold, int32_T capacity,
+    real32_T *outLoc, real32_T *outMetric)
+{
+    CG_PROFILE_CALL();
+    void *ptrKeypoints = NULL;
+    const int32_T numCorners = detectFAST_compute(inImg, nRows, nCols, isRGB,
+        threshold, &ptrKeypoints);
+    vector<KeyPoint> &keypoints = *((vector<KeyPoint> *)ptrKeypoints);
+
+    CG_PROFILE_PHASE(CG_PROFILE_OUTPUT);
+    selectStrongest(keypoints, capacity);
+    fastKeyPointToFields(keypoints, outLoc, outMetric, (size_t)std::max(capacity, 0));
+
+    vision::ResultPool<vector<KeyPoint> >::release((vector<KeyPoint> *)ptrKeypoints);
+    return numCorners;
+}
+
+// Row major outputs: outLoc is capacity-by-2 in row major order
+int32_T detectFAST_computeIntoRM(uint8_T *inImg,
+	int32_T nRows, int32_T nCols, int32_T isRGB,
+	int threshold, int32_T capacity,
+	real32_T *outLoc, real32_T *outMetric)
+{
+	CG_PROFILE_CALL();
+	void *ptrKeypoints = NULL;
+	const int32_T numCorners = detectFAST_computeRM(inImg, nRows, nCols, isRGB,
+		threshold, &ptrKeypoints);
+	vector<KeyPoint> &keypoints = *((vector<KeyPoint> *)ptrKeypoints);
+
+	CG_PROFILE_PHASE(CG_PROFILE_OUTPUT);
+	selectStrongest(keypoints, capacity);
+	fastKeyPointToFieldsRM(keypoints, outLoc, outMetric);
+
+	vision::ResultPool<vector<KeyPoint> >::release((vector<KeyPoint> *)ptrKeypoints);
+	return numCorners;
 }
 
 #endif
\ No newline at end of file
@@ -10,6 +10,7 @@
 
 #include "opencv2/opencv.hpp"
 #include "cgCommon.hpp"
+#include "cgProfile.hpp"
 
 using namespace cv;
 using namespace std;
@@ -96,6 +97,227 @@ void regionsToPointsArrayRM(vector< vector<Point> > &in, int32_T numTotalPts,
 	}
 }
 
+//////////////////////////////////////////////////////////////////////////////
+// Convert the regions to horizontal pixel runs. The points of each region
+// are sorted by row, then column, so that each run is a sequence of
+// consecutive points.
+//////////////////////////////////////////////////////////////////////////////
+static bool isBeforeInRow(const Point &a, const Point &b)
+{
+    return a.y < b.y || (a.y == b.y && a.x < b.x);
+}
+
+static int32_T countRegionRuns(const vector<Point> &region)
+{
+    int32_T numRuns = region.empty() ? 0 : 1;
+    for (size_t j = 1; j < region.size(); j++)
+    {
+        if (region[j].y != region[j-1].y || region[j].x != region[j-1].x + 1)
+            numRuns++;
+    }
+    return numRuns;
+}
+
+void regionsToRunsArray(vector< vector<Point> > &in, int32_T numTotalRuns,
+    int32_T *outRuns, int32_T *outLengths)
+{
+    int32_T *runs_y      = outRuns;
+    int32_T *runs_xStart = outRuns + numTotalRuns;
+    int32_T *runs_xEnd   = outRuns + 2*numTotalRuns;
+
+    mwSize k = 0;
+    for (mwSize i = 0; i < in.size(); i++)
+    {
+        const vector<Point> &region = in[i];
+        outLengths[i] = countRegionRuns(region);
+        for (mwSize j = 0; j < region.size(); j++)
+        {
+            if (j == 0 || region[j].y != region[j-1].y || region[j].x != region[j-1].x + 1)
+            {
+                runs_y[k]      = region[j].y+1;
+                runs_xStart[k] = region[j].x+1;
+                k++;
+            }
+            runs_xEnd[k-1] = region[j].x+1;
+        }
+        /*
+        outRuns           outLengths
+        [ay1 ax1 ax1';    2
+         ay2 ax2 ax2';
+
+         by1 bx1 bx1';    1
+         .    .   .  ]
+        */
+    }
+}
+
+void regionsToRunsArrayRM(vector< vector<Point> > &in, int32_T numTotalRuns,
+	int32_T *outRuns, int32_T *outLengths)
+{
+	(void)numTotalRuns;
+	int32_T *run = outRuns - 3;
+	for (mwSize i = 0; i < in.size(); i++)
+	{
+		const vector<Point> &region = in[i];
+		outLengths[i] = countRegionRuns(region);
+		for (mwSize j = 0; j < region.size(); j++)
+		{
+			if (j == 0 || region[j].y != region[j-1].y || region[j].x != region[j-1].x + 1)
+			{
+				run += 3;
+				run[0] = region[j].y + 1;
+				run[1] = region[j].x + 1;
+			}
+			run[2] = region[j].x + 1;
+		}
+	}
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// Statistics of the regions, computed from their points in one pass: area,
+// 1-based bounding box and centroid, and the second central moments, i.e.
+// the covariance of the point coordinates, which give the ellipse of the
+// region. Row major outputs hold the fields of a region next to each
+// other, column major ones one field of all the regions after the other.
+//////////////////////////////////////////////////////////////////////////////
+static void regionsToStats(const vector< vector<Point> > &in,
+    int32_T *outArea, int32_T *outBBox, real_T *outCentroid,
+    real_T *outMoments, bool isRowMajor)
+{
+    const mwSize n = in.size();
+    const mwSize field = isRowMajor ? 1 : n;
+
+    for (mwSize i = 0; i < n; i++)
+    {
+        const vector<Point> &region = in[i];
+        const mwSize m = region.size();
+        const mwSize bboxIdx = isRowMajor ? 4*i : i;
+        const mwSize pairIdx = isRowMajor ? 2*i : i;
+        const mwSize momIdx  = isRowMajor ? 3*i : i;
+
+        outArea[i] = (int32_T)m;
+        if (m == 0)
+        {
+            for (int f = 0; f < 4; f++) outBBox[bboxIdx + f*field] = 0;
+            for (int f = 0; f < 2; f++) outCentroid[pairIdx + f*field] = 0;
+            for (int f = 0; f < 3; f++) outMoments[momIdx + f*field] = 0;
+            continue;
+        }
+
+        int xMin = region[0].x, xMax = region[0].x;
+        int yMin = region[0].y, yMax = region[0].y;
+        // sums relative to the first point, exact in double
+        double sx = 0, sy = 0, sxx = 0, sxy = 0, syy = 0;
+        for (mwSize j = 0; j < m; j++)
+        {
+            const Point &p = region[j];
+            xMin = std::min(xMin, p.x); xMax = std::max(xMax, p.x);
+            yMin = std::min(yMin, p.y); yMax = std::max(yMax, p.y);
+            double dx = p.x - region[0].x, dy = p.y - region[0].y;
+            sx += dx; sy += dy;
+            sxx += dx*dx; sxy += dx*dy; syy += dy*dy;
+        }
+        const double cx = sx/m, cy = sy/m;
+
+        outBBox[bboxIdx]           = xMin+1;
+        outBBox[bboxIdx + field]   = yMin+1;
+        outBBox[bboxIdx + 2*field] = xMax-xMin+1;
+        outBBox[bboxIdx + 3*field] = yMax-yMin+1;
+        outCentroid[pairIdx]         = region[0].x + cx + 1;
+        outCentroid[pairIdx + field] = region[0].y + cy + 1;
+        outMoments[momIdx]           = sxx/m - cx*cx;
+        outMoments[momIdx + field]   = sxy/m - cx*cy;
+        outMoments[momIdx + 2*field] = syy/m - cy*cy;
+    }
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// Run MSER with the passes of each channel as parallel tasks. detectRegions
+// finds the dark-to-bright regions of an image, then the bright-to-dark
+// ones; the second pass alone (pass2Only) on the inverted image gives the
+// regions of the first pass. The regions are returned in the order of
+// detectRegions, for each channel in turn.
+//////////////////////////////////////////////////////////////////////////////
+static void detectMserPass(Ptr<MSER> &mser, const Mat &plane, bool invert,
+    vector< vector<Point> > &regions)
+{
+    Mat src;
+    if (invert)
+        bitwise_not(plane, src);
+    else
+        src = plane;
+    std::vector<Rect> bboxes;
+    mser->detectRegions(src, regions, bboxes);
+}
+
+static void detectMserParallel(const cv::Mat &image, bool perChannel,
+    int delta, int minArea, int maxArea, float maxVariation,
+    float minDiversity, int maxEvolution, double areaThreshold,
+    double minMargin, int edgeBlurSize,
+    vector< vector<Point> > &regions)
+{
+    std::vector<Rect> bboxes;
+    std::vector<Mat> planes;
+
+    if (image.channels() == 1)
+    {
+        planes.push_back(image);
+    }
+    else if (perChannel)
+    {
+        // OpenCV holds BGR, the channels are processed as R, G and B
+        split(image, planes);
+        std::swap(planes[0], planes[2]);
+    }
+    else
+    {
+        // the color algorithm runs in one pass
+        Ptr<MSER> mser = cv::MSER::create(delta, minArea, maxArea, maxVariation,
+                         minDiversity, maxEvolution,
+                         areaThreshold, minMargin,
+                         edgeBlurSize);
+        mser->detectRegions(image, regions, bboxes);
+        return;
+    }
+
+    const int numTasks = 2*(int)planes.size();
+    vector< vector< vector<Point> > > taskRegions(numTasks);
+
+    // MSER keeps its buffers in the object: one object per task
+    vector< Ptr<MSER> > msers(numTasks);
+    for (int t = 0; t < numTasks; t++)
+    {
+        msers[t] = cv::MSER::create(delta, minArea, maxArea, maxVariation,
+                   minDiversity, maxEvolution,
+                   areaThreshold, minMargin,
+                   edgeBlurSize);
+        msers[t]->setPass2Only(true);
+    }
+
+#ifdef PARALLEL
+    vision::ThreadPool::instance().run(numTasks, [&](int t) {
+        detectMserPass(msers[t], planes[t/2], t % 2 == 0, taskRegions[t]);
+    });
+#else
+    for (int t = 0; t < numTasks; t++)
+        detectMserPass(msers[t], planes[t/2], t % 2 == 0, taskRegions[t]);
+#endif
+
+    size_t n = 0;
+    for (int t = 0; t < numTasks; t++)
+        n += taskRegions[t].size();
+    regions.clear();
+    regions.reserve(n);
+    for (int t = 0; t < numTasks; t++)
+    {
+        for (size_t i = 0; i < taskRegions[t].size(); i++)
+        {
+            regions.push_back(vector<Point>());
+            regions.back().swap(taskRegions[t][i]);
+        }
+    }
+}
+
 //////////////////////////////////////////////////////////////////////////////
 // Invoke OpenCV cvDetectMser
 //////////////////////////////////////////////////////////////////////////////
@@ -115,10 +337,13 @@ void detectMser_compute(uint8_T *inImg,
     int32_T *numRegions,
     void **outRegions)
 {
-    // Use OpenCV smart pointer to manage image 
-    cv::Ptr<cv::Mat> inImage = new cv::Mat;
+    CG_PROFILE_CALL();
+    // Grayscale input is used in place, as its transpose, when native
+    // column major processing is on
+    cv::Mat inImage;
 	bool isRGB_ = (bool)(isRGB != 0);
-	cArrayToMat<uint8_T>(inImg, nRows, nCols, isRGB_, *inImage);
+	const bool isTransposed = cArrayToMatView_ColMaj<uint8_T>(inImg, nRows, nCols, isRGB_, inImage);
+	CG_PROFILE_PHASE(CG_PROFILE_COMPUTE);
 
     // comute the regions
     Ptr<MSER> mser = cv::MSER::create(delta, minArea, maxArea, maxVariation,
@@ -127,12 +352,14 @@ void detectMser_compute(uint8_T *inImg,
                      edgeBlurSize);
     
     // keypoints
-    vector< vector<Point> > *ptrRegions = (vector< vector<Point> > *)new vector< vector<Point> >();
+    vector< vector<Point> > *ptrRegions = vision::ResultPool<vector< vector<Point> > >::acquire();
     *outRegions = ptrRegions;
     vector< vector<Point> > &refRegions = *ptrRegions;
     
     std::vector<Rect> bboxes;
-    mser->detectRegions(*inImage, refRegions, bboxes);
+    mser->detectRegions(inImage, refRegions, bboxes);
+    if (isTransposed)
+        transposeRegions(refRegions);
 
     numTotalPts[0] = 0;
     numRegions[0] = (int)refRegions.size();
@@ -156,10 +383,12 @@ void detectMser_computeRM(uint8_T *inImg,
 	int32_T *numRegions,
 	void **outRegions)
 {
-	// Use OpenCV smart pointer to manage image 
-	cv::Ptr<cv::Mat> inImage = new cv::Mat;
+	CG_PROFILE_CALL();
+	// Grayscale row major input is used in place, without a copy
+	cv::Mat inImage;
 	bool isRGB_ = (bool)(isRGB != 0);
-	cArrayToMat_RowMaj<uint8_T>(inImg, nRows, nCols, isRGB_, *inImage);
+	cArrayToMatView_RowMaj<uint8_T>(inImg, nRows, nCols, isRGB_, inImage);
+	CG_PROFILE_PHASE(CG_PROFILE_COMPUTE);
 
 	// comute the regions
 	Ptr<MSER> mser = cv::MSER::create(delta, minArea, maxArea, maxVariation,
@@ -168,12 +397,12 @@ void detectMser_computeRM(uint8_T *inImg,
 		edgeBlurSize);
 
 	// keypoints
-	vector< vector<Point> > *ptrRegions = (vector< vector<Point> > *)new vector< vector<Point> >();
+	vector< vector<Point> > *ptrRegions = vision::ResultPool<vector< vector<Point> > >::acquire();
 	*outRegions = ptrRegions;
 	vector< vector<Point> > &refRegions = *ptrRegions;
 
 	std::vector<Rect> bboxes;
-	mser->detectRegions(*inImage, refRegions, bboxes);
+	mser->detectRegions(inImage, refRegions, bboxes);
 
 	numTotalPts[0] = 0;
 	numRegions[0] = (int)refRegions.size();
@@ -182,26 +411,171 @@ void detectMser_computeRM(uint8_T *inImg,
 	}
 }
 
+void detectMser_computeParallel(uint8_T *inImg,
+	int32_T nRows, int32_T nCols, int32_T isRGB,
+	int delta,
+	int minArea,
+	int maxArea,
+	float maxVariation,
+	float minDiversity,
+	int maxEvolution,
+	double areaThreshold,
+	double minMargin,
+	int edgeBlurSize,
+	boolean_T perChannel,
+	int32_T *numTotalPts,
+	int32_T *numRegions,
+	void **outRegions)
+{
+	CG_PROFILE_CALL();
+	// Grayscale input is used in place, as its transpose, when native
+	// column major processing is on
+	cv::Mat inImage;
+	bool isRGB_ = (bool)(isRGB != 0);
+	const bool isTransposed = cArrayToMatView_ColMaj<uint8_T>(inImg, nRows, nCols, isRGB_, inImage);
+	CG_PROFILE_PHASE(CG_PROFILE_COMPUTE);
+
+	vector< vector<Point> > *ptrRegions = vision::ResultPool<vector< vector<Point> > >::acquire();
+	*outRegions = ptrRegions;
+	vector< vector<Point> > &refRegions = *ptrRegions;
+
+	detectMserParallel(inImage, perChannel != 0, delta, minArea, maxArea,
+		maxVariation, minDiversity, maxEvolution, areaThreshold, minMargin,
+		edgeBlurSize, refRegions);
+	if (isTransposed)
+		transposeRegions(refRegions);
+
+	numTotalPts[0] = 0;
+	numRegions[0] = (int)refRegions.size();
+	for (int i = 0; i < numRegions[0]; i++){
+		numTotalPts[0] += (int)refRegions[i].size();
+	}
+}
+
+void detectMser_computeParallelRM(uint8_T *inImg,
+	int32_T nRows, int32_T nCols, int32_T isRGB,
+	int delta,
+	int minArea,
+	int maxArea,
+	float maxVariation,
+	float minDiversity,
+	int maxEvolution,
+	double areaThreshold,
+	double minMargin,
+	int edgeBlurSize,
+	boolean_T perChannel,
+	int32_T *numTotalPts,
+	int32_T *numRegions,
+	void **outRegions)
+{
+	CG_PROFILE_CALL();
+	// Grayscale row major input is used in place, without a copy
+	cv::Mat inImage;
+	bool isRGB_ = (bool)(isRGB != 0);
+	cArrayToMatView_RowMaj<uint8_T>(inImg, nRows, nCols, isRGB_, inImage);
+	CG_PROFILE_PHASE(CG_PROFILE_COMPUTE);
+
+	vector< vector<Point> > *ptrRegions = vision::ResultPool<vector< vector<Point> > >::acquire();
+	*outRegions = ptrRegions;
+	vector< vector<Point> > &refRegions = *ptrRegions;
+
+	detectMserParallel(inImage, perChannel != 0, delta, minArea, maxArea,
+		maxVariation, minDiversity, maxEvolution, areaThreshold, minMargin,
+		edgeBlurSize, refRegions);
+
+	numTotalPts[0] = 0;
+	numRegions[0] = (int)refRegions.size();
+	for (int i = 0; i < numRegions[0]; i++){
+		numTotalPts[0] += (int)refRegions[i].size();
+	}
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// Sort the points of the regions into runs and return the number of runs,
+// to size the output of detectMser_assignRuns. After this call the points
+// of detectMser_assignOutput are in row order.
+//////////////////////////////////////////////////////////////////////////////
+int32_T detectMser_countRuns(void *ptrRegions)
+{
+	vector< vector<Point> > &regions = *((vector< vector<Point> > *)ptrRegions);
+
+	int32_T numTotalRuns = 0;
+	for (size_t i = 0; i < regions.size(); i++)
+	{
+		std::sort(regions[i].begin(), regions[i].end(), isBeforeInRow);
+		numTotalRuns += countRegionRuns(regions[i]);
+	}
+	return numTotalRuns;
+}
+
+void detectMser_assignRuns(void *ptrRegions,
+	int32_T numTotalRuns, int32_T *outRuns, int32_T *outLengths)
+{
+	CG_PROFILE_CALL();
+	CG_PROFILE_PHASE(CG_PROFILE_OUTPUT);
+	vector< vector<Point> > &regions = *((vector< vector<Point> > *)ptrRegions);
+
+	// Populate the outputs
+	regionsToRunsArray(regions, numTotalRuns, outRuns, outLengths);
+
+	vision::ResultPool<vector< vector<Point> > >::release((vector< vector<Point> > *)ptrRegions);
+}
+
+void detectMser_assignRunsRM(void *ptrRegions,
+	int32_T numTotalRuns, int32_T *outRuns, int32_T *outLengths)
+{
+	CG_PROFILE_CALL();
+	CG_PROFILE_PHASE(CG_PROFILE_OUTPUT);
+	vector< vector<Point> > &regions = *((vector< vector<Point> > *)ptrRegions);
+
+	// Populate the outputs
+	regionsToRunsArrayRM(regions, numTotalRuns, outRuns, outLengths);
+
+	vision::ResultPool<vector< vector<Point> > >::release((vector< vector<Point> > *)ptrRegions);
+}
+
+void detectMser_assignStats(void *ptrRegions,
+	int32_T *outArea, int32_T *outBBox, real_T *outCentroid, real_T *outMoments)
+{
+	CG_PROFILE_CALL();
+	CG_PROFILE_PHASE(CG_PROFILE_OUTPUT);
+	regionsToStats(*((vector< vector<Point> > *)ptrRegions),
+		outArea, outBBox, outCentroid, outMoments, false);
+}
+
+void detectMser_assignStatsRM(void *ptrRegions,
+	int32_T *outArea, int32_T *outBBox, real_T *outCentroid, real_T *outMoments)
+{
+	CG_PROFILE_CALL();
+	CG_PROFILE_PHASE(CG_PROFILE_OUTPUT);
+	regionsToStats(*((vector< vector<Point> > *)ptrRegions),
+		outArea, outBBox, outCentroid, outMoments, true);
+}
+
 void detectMser_assignOutput(void *ptrRegions,
     int32_T numTotalPts, int32_T *outPts, int32_T *outLengths)
 {
+    CG_PROFILE_CALL();
+    CG_PROFILE_PHASE(CG_PROFILE_OUTPUT);
     vector< vector<Point> > regions = ((vector< vector<Point> > *)ptrRegions)[0];
 
     // Populate the outputs
     regionsToPointsArray(regions, numTotalPts, outPts, outLengths);
 
-    delete((vector< vector<Point> > *)ptrRegions);
+    vision::ResultPool<vector< vector<Point> > >::release((vector< vector<Point> > *)ptrRegions);
 }
 
 void detectMser_assignOutputRM(void *ptrRegions,
 	int32_T numTotalPts, int32_T *outPts, int32_T *outLengths)
 {
+	CG_PROFILE_CALL();
+	CG_PROFILE_PHASE(CG_PROFILE_OUTPUT);
 	vector< vector<Point> > regions = ((vector< vector<Point> > *)ptrRegions)[0];
 
 	// Populate the outputs
 	regionsToPointsArrayRM(regions, numTotalPts, outPts, outLengths);
 
-	delete((vector< vector<Point> > *)ptrRegions);
+	vision::ResultPool<vector< vector<Point> > >::release((vector< vector<Point> > *)ptrRegions);
 }
 #endif
 
@@ -12,6 +12,7 @@
 
 #include "opencv2/opencv.hpp"
 #include "cgCommon.hpp"
+#include "cgProfile.hpp"
 
 ////////////////////////////////////////////////////////////////////////////////
 // struct to keypoints - convert keypoint struct from M to cv::KeyPoints
@@ -98,6 +99,7 @@ int32_T extractBRISK_compute(const uint8_T * img, const int32_T nRows, const int
                              const int32_T numKeyPoints, const boolean_T upright,
                              void ** features, void ** keypoints)
 {
+    CG_PROFILE_CALL();
 
     using namespace cv;
     using namespace std;
@@ -106,9 +108,10 @@ int32_T extractBRISK_compute(const uint8_T * img, const int32_T nRows, const int
 
     Ptr<Mat> mat = new Mat;
     cArrayToMat<uint8_T>(img, nRows, nCols, isRGB, *mat);
+    CG_PROFILE_PHASE(CG_PROFILE_COMPUTE);
 
     // create KeyPoint vector
-    vector<KeyPoint> * keypointPtr = new vector<KeyPoint>();
+    vector<KeyPoint> * keypointPtr = vision::ResultPool<vector<KeyPoint> >::acquire();
     *keypoints = (void *)keypointPtr;
 
     // copy keypoint data
@@ -124,7 +127,7 @@ int32_T extractBRISK_compute(const uint8_T * img, const int32_T nRows, const int
         CV_Error(CV_StsNotImplemented, "OpenCV was built without BRISK support");
     }
 
-    Mat * descriptors = new Mat();
+    Mat * descriptors = vision::ResultPool<Mat>::acquire();
     *features = (void *)descriptors;
     brisk->compute(*mat, *keypointPtr, *descriptors);
 
@@ -137,17 +140,19 @@ int32_T extractBRISK_computeRM(const uint8_T * img, const int32_T nRows, const i
 	const int32_T numKeyPoints, const boolean_T upright,
 	void ** features, void ** keypoints)
 {
+	CG_PROFILE_CALL();
 
 	using namespace cv;
 	using namespace std;
 
 	const bool isRGB = false; // only grayscale images are supported for BRISK
 
-	Ptr<Mat> mat = new Mat;
-	cArrayToMat_RowMaj<uint8_T>(img, nRows, nCols, isRGB, *mat);
+	Mat mat;
+	cArrayToMatView_RowMaj<uint8_T>(img, nRows, nCols, isRGB, mat);
+	CG_PROFILE_PHASE(CG_PROFILE_COMPUTE);
 
 	// create KeyPoint vector
-	vector<KeyPoint> * keypointPtr = new vector<KeyPoint>();
+	vector<KeyPoint> * keypointPtr = vision::ResultPool<vector<KeyPoint> >::acquire();
 	*keypoints = (void *)keypointPtr;
 
 	// copy keypoint data
@@ -163,13 +168,283 @@ int32_T extractBRISK_computeRM(const uint8_T * img, const int32_T nRows, const i
 		CV_Error(CV_StsNotImplemented, "OpenCV was built without BRISK support");
 	}
 
-	Mat * descriptors = new Mat();
+	Mat * descriptors = vision::ResultPool<Mat>::acquire();
 	*features = (void *)descriptors;
-	brisk->compute(*mat, *keypointPtr, *descriptors);
+	brisk->compute(mat, *keypointPtr, *descriptors);
 
 	return static_cast<int32_T>(keypointPtr->size());
 }
 
+////////////////////////////////////////////////////////////////////////////////
+// Detect BRISK keypoints and extract their features in one call: the image is
+// converted once and MWBRISK::detectAndCompute describes the keypoints of its
+// own scale space. The outputs are copied with extractBRISK_assignOutput.
+////////////////////////////////////////////////////////////////////////////////
+int32_T extractBRISK_detectAndCompute(const uint8_T * img, const int32_T nRows, const int32_T nCols,
+                                      const int32_T threshold, const int32_T numOctaves,
+                                      const boolean_T upright,
+                                      void ** features, void ** keypoints)
+{
+    CG_PROFILE_CALL();
+    using namespace cv;
+    using namespace std;
+
+    const bool isRGB = false; // only grayscale images are supported for BRISK
+
+    Mat mat;
+    cArrayToMat<uint8_T>(img, nRows, nCols, isRGB, mat);
+    CG_PROFILE_PHASE(CG_PROFILE_COMPUTE);
+
+    vector<KeyPoint> * keypointPtr = vision::ResultPool<vector<KeyPoint> >::acquire();
+    *keypoints = (void *)keypointPtr;
+
+    float patternScale = 1.0f;
+    Ptr<MWBRISK> brisk = cv::MWBRISK::create(threshold, numOctaves, patternScale);
+
+    if (brisk.empty()) {
+        CV_Error(CV_StsNotImplemented, "OpenCV was built without BRISK support");
+    }
+    // To avoid C4800 on MSVC: make bool != 0 to force bool type.
+    brisk->setUpright(upright != 0);
+
+    Mat * descriptors = vision::ResultPool<Mat>::acquire();
+    *features = (void *)descriptors;
+    const bool useProvidedKeypoints = false;
+    brisk->detectAndCompute(mat, noArray(), *keypointPtr, *descriptors, useProvidedKeypoints);
+
+    return static_cast<int32_T>(keypointPtr->size());
+}
+
+int32_T extractBRISK_detectAndComputeRM(const uint8_T * img, const int32_T nRows, const int32_T nCols,
+                                        const int32_T threshold, const int32_T numOctaves,
+                                        const boolean_T upright,
+                                        void ** features, void ** keypoints)
+{
+    CG_PROFILE_CALL();
+    using namespace cv;
+    using namespace std;
+
+    const bool isRGB = false; // only grayscale images are supported for BRISK
+
+    Mat mat;
+    cArrayToMatView_RowMaj<uint8_T>(img, nRows, nCols, isRGB, mat);
+    CG_PROFILE_PHASE(CG_PROFILE_COMPUTE);
+
+    vector<KeyPoint> * keypointPtr = vision::ResultPool<vector<KeyPoint> >::acquire();
+    *keypoints = (void *)keypointPtr;
+
+    float patternScale = 1.0f;
+    Ptr<MWBRISK> brisk = cv::MWBRISK::create(threshold, numOctaves, patternScale);
+
+    if (brisk.empty()) {
+        CV_Error(CV_StsNotImplemented, "OpenCV was built without BRISK support");
+    }
+    // To avoid C4800 on MSVC: make bool != 0 to force bool type.
+    brisk->setUpright(upright != 0);
+
+    Mat * descriptors = vision::ResultPool<Mat>::acquire();
+    *features = (void *)descriptors;
+    const bool useProvidedKeypoints = false;
+    brisk->detectAndCompute(mat, noArray(), *keypointPtr, *descriptors, useProvidedKeypoints);
+
+    return static_cast<int32_T>(keypointPtr->size());
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Batch of images: each worker thread detects and describes whole images
+// with its own BRISK object, created once for the batch. The descriptors
+// are collected with extractBRISK_assignBatch into one array.
+////////////////////////////////////////////////////////////////////////////////
+static void detectAndComputeBRISKImage(cv::Ptr<cv::MWBRISK> &brisk,
+                                       const uint8_T * img, int nRows, int nCols,
+                                       bool isRowMajor, int threshold, int numOctaves,
+                                       bool upright, FeatureBatch &batch, int i)
+{
+    using namespace cv;
+
+    const bool isRGB = false; // only grayscale images are supported for BRISK
+
+    if (brisk.empty())
+    {
+        float patternScale = 1.0f;
+        brisk = cv::MWBRISK::create(threshold, numOctaves, patternScale);
+        if (brisk.empty()) {
+            CV_Error(CV_StsNotImplemented, "OpenCV was built without BRISK support");
+        }
+        brisk->setUpright(upright);
+    }
+
+    Mat mat;
+    if (isRowMajor)
+        cArrayToMatView_RowMaj<uint8_T>(img, nRows, nCols, isRGB, mat);
+    else
+        cArrayToMat<uint8_T>(img, nRows, nCols, isRGB, mat);
+
+    const bool useProvidedKeypoints = false;
+    brisk->detectAndCompute(mat, noArray(), batch.keypoints[i], batch.descriptors[i],
+                            useProvidedKeypoints);
+}
+
+static int32_T detectAndComputeBRISKBatch(const uint8_T * const * images,
+                                          const int32_T * nRows, const int32_T * nCols,
+                                          int numImages, bool isRowMajor,
+                                          int threshold, int numOctaves, bool upright,
+                                          int32_T * outNumFeatures, void ** batch)
+{
+    FeatureBatch *ptrBatch = new FeatureBatch();
+    *batch = (void *)ptrBatch;
+    ptrBatch->keypoints.resize(numImages);
+    ptrBatch->descriptors.resize(numImages);
+
+    CG_PROFILE_PHASE(CG_PROFILE_COMPUTE);
+    // one extractor per worker
+    std::vector< cv::Ptr<cv::MWBRISK> > brisks(std::max((int)cgGetNumThreads(), 1));
+#ifdef PARALLEL
+    cgParallelForWorkers(numImages, [&](int w, int i) {
+        detectAndComputeBRISKImage(brisks[w], images[i], nRows[i], nCols[i], isRowMajor,
+                                   threshold, numOctaves, upright, *ptrBatch, i);
+    });
+#else
+    for (int i = 0; i < numImages; i++)
+        detectAndComputeBRISKImage(brisks[0], images[i], nRows[i], nCols[i], isRowMajor,
+                                   threshold, numOctaves, upright, *ptrBatch, i);
+#endif
+
+    int32_T numTotal = 0;
+    for (int i = 0; i < numImages; i++)
+    {
+        outNumFeatures[i] = static_cast<int32_T>(ptrBatch->keypoints[i].size());
+        numTotal += outNumFeatures[i];
+    }
+    return numTotal;
+}
+
+int32_T extractBRISK_detectAndComputeBatch(const uint8_T * const * images,
+                                           const int32_T * nRows, const int32_T * nCols,
+                                           const int32_T numImages,
+                                           const int32_T threshold, const int32_T numOctaves,
+                                           const boolean_T upright,
+                                           int32_T * outNumFeatures, void ** batch)
+{
+    CG_PROFILE_CALL();
+    // To avoid C4800 on MSVC: make bool != 0 to force bool type.
+    return detectAndComputeBRISKBatch(images, nRows, nCols, numImages, false,
+                                      threshold, numOctaves, upright != 0,
+                                      outNumFeatures, batch);
+}
+
+int32_T extractBRISK_detectAndComputeBatchRM(const uint8_T * const * images,
+                                             const int32_T * nRows, const int32_T * nCols,
+                                             const int32_T numImages,
+                                             const int32_T threshold, const int32_T numOctaves,
+                                             const boolean_T upright,
+                                             int32_T * outNumFeatures, void ** batch)
+{
+    CG_PROFILE_CALL();
+    return detectAndComputeBRISKBatch(images, nRows, nCols, numImages, true,
+                                      threshold, numOctaves, upright != 0,
+                                      outNumFeatures, batch);
+}
+
+void extractBRISK_assignBatch(void *ptrBatch, real32_T * location,
+                              uint8_T * features, int32_T * offsets)
+{
+    CG_PROFILE_CALL();
+    CG_PROFILE_PHASE(CG_PROFILE_OUTPUT);
+    featureBatchToArrays<uint8_T>(*((FeatureBatch *)ptrBatch), false,
+                                  location, features, offsets);
+    delete((FeatureBatch *)ptrBatch);
+}
+
+void extractBRISK_assignBatchRM(void *ptrBatch, real32_T * location,
+                                uint8_T * features, int32_T * offsets)
+{
+    CG_PROFILE_CALL();
+    CG_PROFILE_PHASE(CG_PROFILE_OUTPUT);
+    featureBatchToArrays<uint8_T>(*((FeatureBatch *)ptrBatch), true,
+                                  location, features, offsets);
+    delete((FeatureBatch *)ptrBatch);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Persistent BRISK extractor: the sampling pattern and its rotated tables are
+// generated once, when the object is constructed.
+////////////////////////////////////////////////////////////////////////////////
+void extractBRISK_construct(void **ptr2ptrClass)
+{
+    cv::Ptr<cv::MWBRISK> *ptrClass_ = new cv::Ptr<cv::MWBRISK>(cv::MWBRISK::create());
+    *ptr2ptrClass = ptrClass_;
+}
+
+int32_T extractBRISK_computeObj(void *ptrClass,
+                                const uint8_T * img, const int32_T nRows, const int32_T nCols,
+                                real32_T * location, real32_T * metric,
+                                real32_T * scale, real32_T * orientation, int32_T * misc,
+                                const int32_T numKeyPoints, const boolean_T upright,
+                                void ** features, void ** keypoints)
+{
+    CG_PROFILE_CALL();
+    using namespace cv;
+    using namespace std;
+
+    const bool isRGB = false; // only grayscale images are supported for BRISK
+
+    Mat mat;
+    cArrayToMat<uint8_T>(img, nRows, nCols, isRGB, mat);
+    CG_PROFILE_PHASE(CG_PROFILE_COMPUTE);
+
+    vector<KeyPoint> * keypointPtr = vision::ResultPool<vector<KeyPoint> >::acquire();
+    *keypoints = (void *)keypointPtr;
+    structToBRISKKeyPoints(location, metric, scale, orientation, misc,
+                           numKeyPoints, *keypointPtr);
+
+    Ptr<MWBRISK> &brisk = *((Ptr<MWBRISK> *)ptrClass);
+    brisk->setUpright(upright != 0);
+
+    Mat * descriptors = vision::ResultPool<Mat>::acquire();
+    *features = (void *)descriptors;
+    brisk->compute(mat, *keypointPtr, *descriptors);
+
+    return static_cast<int32_T>(keypointPtr->size());
+}
+
+int32_T extractBRISK_computeObjRM(void *ptrClass,
+                                  const uint8_T * img, const int32_T nRows, const int32_T nCols,
+                                  real32_T * location, real32_T * metric,
+                                  real32_T * scale, real32_T * orientation, int32_T * misc,
+                                  const int32_T numKeyPoints, const boolean_T upright,
+                                  void ** features, void ** keypoints)
+{
+    CG_PROFILE_CALL();
+    using namespace cv;
+    using namespace std;
+
+    const bool isRGB = false; // only grayscale images are supported for BRISK
+
+    Mat mat;
+    cArrayToMatView_RowMaj<uint8_T>(img, nRows, nCols, isRGB, mat);
+    CG_PROFILE_PHASE(CG_PROFILE_COMPUTE);
+
+    vector<KeyPoint> * keypointPtr = vision::ResultPool<vector<KeyPoint> >::acquire();
+    *keypoints = (void *)keypointPtr;
+    structToBRISKKeyPointsRM(location, metric, scale, orientation, misc,
+                             numKeyPoints, *keypointPtr);
+
+    Ptr<MWBRISK> &brisk = *((Ptr<MWBRISK> *)ptrClass);
+    brisk->setUpright(upright != 0);
+
+    Mat * descriptors = vision::ResultPool<Mat>::acquire();
+    *features = (void *)descriptors;
+    brisk->compute(mat, *keypointPtr, *descriptors);
+
+    return static_cast<int32_T>(keypointPtr->size());
+}
+
+void extractBRISK_deleteObj(void *ptrClass)
+{
+    delete((cv::Ptr<cv::MWBRISK> *)ptrClass);
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 // Copy data
 ////////////////////////////////////////////////////////////////////////////////
@@ -178,6 +453,8 @@ void extractBRISK_assignOutput(void *ptrDescriptors, void *ptrKeyPoints,
                                real32_T * scale, real32_T * orientation,
                                int32_T * misc, uint8_T * features)
 {
+    CG_PROFILE_CALL();
+    CG_PROFILE_PHASE(CG_PROFILE_OUTPUT);
 
     // copy feature data
     const cv::Mat & descriptors = *((cv::Mat *)ptrDescriptors);
@@ -188,8 +465,8 @@ void extractBRISK_assignOutput(void *ptrDescriptors, void *ptrKeyPoints,
     briskKeyPointsToStruct(keypoints, location, metric, scale, orientation, misc);
 
     // free memory
-    delete((std::vector<cv::KeyPoint> *)ptrKeyPoints);
-    delete((cv::Mat *)ptrDescriptors);
+    vision::ResultPool<std::vector<cv::KeyPoint> >::release((std::vector<cv::KeyPoint> *)ptrKeyPoints);
+    vision::ResultPool<cv::Mat>::release((cv::Mat *)ptrDescriptors);
 
 }
 
@@ -198,6 +475,8 @@ void extractBRISK_assignOutputRM(void *ptrDescriptors, void *ptrKeyPoints,
 	real32_T * scale, real32_T * orientation,
 	int32_T * misc, uint8_T * features)
 {
+	CG_PROFILE_CALL();
+	CG_PROFILE_PHASE(CG_PROFILE_OUTPUT);
 
 	// copy feature data
 	const cv::Mat & descriptors = *((cv::Mat *)ptrDescriptors);
@@ -208,8 +487,8 @@ void extractBRISK_assignOutputRM(void *ptrDescriptors, void *ptrKeyPoints,
 	briskKeyPointsToStructRM(keypoints, location, metric, scale, orientation, misc);
 
 	// free memory
-	delete((std::vector<cv::KeyPoint> *)ptrKeyPoints);
-	delete((cv::Mat *)ptrDescriptors);
+	vision::ResultPool<std::vector<cv::KeyPoint> >::release((std::vector<cv::KeyPoint> *)ptrKeyPoints);
+	vision::ResultPool<cv::Mat>::release((cv::Mat *)ptrDescriptors);
 
 }
 
@@ -10,6 +10,7 @@
 
 #include "opencv2/opencv.hpp"
 #include "cgCommon.hpp"
+#include "cgProfile.hpp"
 
 // common defines
 #define SURF_SIZE_TO_SCALE_FACTOR (1.2f/9.0f)
@@ -18,12 +19,12 @@ using namespace cv;
 using namespace std;
 
 //////////////////////////////////////////////////////////////////////////////
-//
+// outLoc is stride-by-2, stride being at least the number of keypoints
 //////////////////////////////////////////////////////////////////////////////
 template <typename T_MiscOrSignOfLap> // int8_T (=char) or int32_T
 void keyPointsToFields_freak(vector<KeyPoint> &in, bool isOrientationIncluded, bool isSurf,
 	real32_T *outLoc, real32_T *outScale, real32_T *outMetric,
-	T_MiscOrSignOfLap *outMiscOrSignOfLap, real32_T *outOrientation)
+	T_MiscOrSignOfLap *outMiscOrSignOfLap, real32_T *outOrientation, mwSize stride)
 {
 	const mwSize m = in.size();
 
@@ -54,7 +55,7 @@ void keyPointsToFields_freak(vector<KeyPoint> &in, bool isOrientationIncluded, b
 		{
 			// OpenCV point info
 			points[i]     = in[i].pt.x+1;     // Convert to MATLAB's 1 based indexing
-			points[m+i]   = in[i].pt.y+1;
+			points[stride+i] = in[i].pt.y+1;
 			scale[i]      = isSurf ? in[i].size*SURF_SIZE_TO_SCALE_FACTOR : in[i].size; // convert to FREAK's scale
 			hessian[i]    = in[i].response;  // hessian (float)
 			laplacian[i]  = in[i].class_id;  // laplacian
@@ -207,13 +208,14 @@ int32_T extractFreak_compute(uint8_T *inImg,
 	boolean_T orientationNormalized, boolean_T scaleNormalized, real32_T patternScale,
 	void **outKeypoints, void **outDescriptors)
 {
+	CG_PROFILE_CALL();
 	cv::Mat img = cv::Mat(nRows, (int)nCols, CV_8UC1, inImg);
 	// transpose matrix
 	// https://code.ros.org/trac/opencv/ticket/1090
 	// cv::transpose(img, img);
 	(void)nDims;
 	// keypoints
-	vector<KeyPoint> *ptrKeypoints = (vector<KeyPoint> *)new vector<KeyPoint>();
+	vector<KeyPoint> *ptrKeypoints = vision::ResultPool<vector<KeyPoint> >::acquire();
 	*outKeypoints = ptrKeypoints;
 	vector<KeyPoint> &refKeypoints = *ptrKeypoints;
 
@@ -228,12 +230,13 @@ int32_T extractFreak_compute(uint8_T *inImg,
                                                       scaleNormalized != 0,
                                                       patternScale,
                                                       nbOctave);
+	CG_PROFILE_PHASE(CG_PROFILE_COMPUTE);
 
     if( freakExtractor.empty() )
         CV_Error(CV_StsNotImplemented, "OpenCV was built without FREAK support");
 
 	// run the extractor
-	cv::Mat *ptrDescriptors = (cv::Mat *)new cv::Mat();
+	cv::Mat *ptrDescriptors = vision::ResultPool<cv::Mat>::acquire();
 	*outDescriptors = ptrDescriptors;
 	cv::Mat &refDescriptors = *ptrDescriptors;
 	freakExtractor->compute(img, refKeypoints, refDescriptors);
@@ -259,13 +262,14 @@ int32_T extractFreak_computeRM(uint8_T *inImg,
 	boolean_T orientationNormalized, boolean_T scaleNormalized, real32_T patternScale,
 	void **outKeypoints, void **outDescriptors)
 {
+	CG_PROFILE_CALL();
 	cv::Mat img = cv::Mat(nRows, (int)nCols, CV_8UC1, inImg);
 	// transpose matrix
 	// https://code.ros.org/trac/opencv/ticket/1090
 	// cv::transpose(img, img);
 	(void)nDims;
 	// keypoints
-	vector<KeyPoint> *ptrKeypoints = (vector<KeyPoint> *)new vector<KeyPoint>();
+	vector<KeyPoint> *ptrKeypoints = vision::ResultPool<vector<KeyPoint> >::acquire();
 	*outKeypoints = ptrKeypoints;
 	vector<KeyPoint> &refKeypoints = *ptrKeypoints;
 
@@ -280,12 +284,13 @@ int32_T extractFreak_computeRM(uint8_T *inImg,
 		scaleNormalized != 0,
 		patternScale,
 		nbOctave);
+	CG_PROFILE_PHASE(CG_PROFILE_COMPUTE);
 
 	if (freakExtractor.empty())
 		CV_Error(CV_StsNotImplemented, "OpenCV was built without FREAK support");
 
 	// run the extractor
-	cv::Mat *ptrDescriptors = (cv::Mat *)new cv::Mat();
+	cv::Mat *ptrDescriptors = vision::ResultPool<cv::Mat>::acquire();
 	*outDescriptors = ptrDescriptors;
 	cv::Mat &refDescriptors = *ptrDescriptors;
 	freakExtractor->compute(img, refKeypoints, refDescriptors);
@@ -304,36 +309,226 @@ int32_T extractFreak_computeRM(uint8_T *inImg,
 	return ((int32_T)(refKeypoints.size())); //actual_numel
 }
 
+//////////////////////////////////////////////////////////////////////////////
+// Persistent extractor: the pattern lookup table is built once, by the first
+// compute, and reused as long as the parameters of the handle do not change
+//////////////////////////////////////////////////////////////////////////////
+
+void extractFreak_construct(void **ptr2ptrClass, int32_T nbOctave,
+	boolean_T orientationNormalized, boolean_T scaleNormalized, real32_T patternScale)
+{
+	// To avoid C4800 on MSVC: make bool != 0 to force bool type.
+	Ptr<MWFREAK> *ptrClass_ = new Ptr<MWFREAK>(cv::MWFREAK::create(orientationNormalized != 0,
+		scaleNormalized != 0,
+		patternScale,
+		nbOctave));
+	*ptr2ptrClass = ptrClass_;
+}
+
+static int32_T extractFreak_computeWith(Ptr<MWFREAK> &freakExtractor, cv::Mat &img,
+	vector<KeyPoint> &refKeypoints, void **outDescriptors)
+{
+	if (freakExtractor.empty())
+		CV_Error(CV_StsNotImplemented, "OpenCV was built without FREAK support");
+
+	// run the extractor
+	cv::Mat *ptrDescriptors = vision::ResultPool<cv::Mat>::acquire();
+	*outDescriptors = ptrDescriptors;
+	freakExtractor->compute(img, refKeypoints, *ptrDescriptors);
+
+	// angles in [-180 180] to [0 360], as in extractFreak_compute
+	for (size_t i = 0; i < refKeypoints.size(); ++i)
+	{
+		if (refKeypoints[i].angle < 0)
+			refKeypoints[i].angle += 360.f;
+	}
+
+	return ((int32_T)(refKeypoints.size())); //actual_numel
+}
+
+int32_T extractFreak_computeObj(void *ptrClass, uint8_T *inImg,
+	int32_T nRows, int32_T nCols, int32_T nDims,
+	real32_T *inLoc, real32_T *inScale, real32_T *inMetric, int32_T *inMiscOrSignOfLap,
+	int32_T numel, void **outKeypoints, void **outDescriptors)
+{
+	CG_PROFILE_CALL();
+	cv::Mat img = cv::Mat(nRows, (int)nCols, CV_8UC1, inImg);
+	(void)nDims;
+	// keypoints
+	vector<KeyPoint> *ptrKeypoints = vision::ResultPool<vector<KeyPoint> >::acquire();
+	*outKeypoints = ptrKeypoints;
+
+	struct2KeyPoints<int32_T>(inLoc, inScale, inMetric, inMiscOrSignOfLap, *ptrKeypoints, numel, false);// isSurf = false
+
+	return extractFreak_computeWith(*((Ptr<MWFREAK> *)ptrClass), img, *ptrKeypoints, outDescriptors);
+	CG_PROFILE_PHASE(CG_PROFILE_COMPUTE);
+}
+
+int32_T extractFreak_computeObjRM(void *ptrClass, uint8_T *inImg,
+	int32_T nRows, int32_T nCols, int32_T nDims,
+	real32_T *inLoc, real32_T *inScale, real32_T *inMetric, int32_T *inMiscOrSignOfLap,
+	int32_T numel, void **outKeypoints, void **outDescriptors)
+{
+	CG_PROFILE_CALL();
+	cv::Mat img = cv::Mat(nRows, (int)nCols, CV_8UC1, inImg);
+	(void)nDims;
+	// keypoints
+	vector<KeyPoint> *ptrKeypoints = vision::ResultPool<vector<KeyPoint> >::acquire();
+	*outKeypoints = ptrKeypoints;
+
+	struct2KeyPointsRM<int32_T>(inLoc, inScale, inMetric, inMiscOrSignOfLap, *ptrKeypoints, numel, false);// isSurf = false
+
+	return extractFreak_computeWith(*((Ptr<MWFREAK> *)ptrClass), img, *ptrKeypoints, outDescriptors);
+	CG_PROFILE_PHASE(CG_PROFILE_COMPUTE);
+}
+
+void extractFreak_deleteObj(void *ptrClass)
+{
+	delete((Ptr<MWFREAK> *)ptrClass);
+}
+
 void extractFreak_assignOutput(void *ptrKeypoints, void *ptrDescriptors,
 	real32_T *outLoc, real32_T *outScale, real32_T *outMetric,
 	int32_T *outMiscOrSignOfLap, real32_T *outOrientation, uint8_T *outFeatures)
 {
-	vector<KeyPoint> keypoints = ((vector<KeyPoint> *)ptrKeypoints)[0];
-	cv::Mat descriptors = ((cv::Mat *)ptrDescriptors)[0];
+	CG_PROFILE_CALL();
+	CG_PROFILE_PHASE(CG_PROFILE_OUTPUT);
+	vector<KeyPoint> &keypoints = ((vector<KeyPoint> *)ptrKeypoints)[0];
+	cv::Mat &descriptors = ((cv::Mat *)ptrDescriptors)[0];
 
 	// Populate the outputs
 	keyPointsToFields_freak<int32_T>(keypoints, true, false, outLoc, outScale,
-		outMetric, outMiscOrSignOfLap, outOrientation);
+		outMetric, outMiscOrSignOfLap, outOrientation, keypoints.size());
 	cArrayFromMat<uint8_T>(outFeatures, descriptors);
 
-	delete((vector<KeyPoint> *)ptrKeypoints);
-	delete((cv::Mat *)ptrDescriptors);
+	vision::ResultPool<vector<KeyPoint> >::release((vector<KeyPoint> *)ptrKeypoints);
+	vision::ResultPool<cv::Mat>::release((cv::Mat *)ptrDescriptors);
 }
 
 void extractFreak_assignOutputRM(void *ptrKeypoints, void *ptrDescriptors,
 	real32_T *outLoc, real32_T *outScale, real32_T *outMetric,
 	int32_T *outMiscOrSignOfLap, real32_T *outOrientation, uint8_T *outFeatures)
 {
-	vector<KeyPoint> keypoints = ((vector<KeyPoint> *)ptrKeypoints)[0];
-	cv::Mat descriptors = ((cv::Mat *)ptrDescriptors)[0];
+	CG_PROFILE_CALL();
+	CG_PROFILE_PHASE(CG_PROFILE_OUTPUT);
+	vector<KeyPoint> &keypoints = ((vector<KeyPoint> *)ptrKeypoints)[0];
+	cv::Mat &descriptors = ((cv::Mat *)ptrDescriptors)[0];
 
 	// Populate the outputs
 	keyPointsToFields_freakRM<int32_T>(keypoints, true, false, outLoc, outScale,
 		outMetric, outMiscOrSignOfLap, outOrientation);
 	cArrayFromMat_RowMaj<uint8_T>(outFeatures, descriptors);
 
-	delete((vector<KeyPoint> *)ptrKeypoints);
-	delete((cv::Mat *)ptrDescriptors);
+	vision::ResultPool<vector<KeyPoint> >::release((vector<KeyPoint> *)ptrKeypoints);
+	vision::ResultPool<cv::Mat>::release((cv::Mat *)ptrDescriptors);
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// Single call extraction: the outputs are written straight into caller
+// buffers of capacity features, outLoc being capacity-by-2 and outFeatures
+// capacity-by-64. If more features are valid, the capacity strongest are
+// written, in input order. Returns the number of valid features, which may
+// exceed capacity; min(count, capacity) of them are written. A capacity of
+// numel is always enough.
+//////////////////////////////////////////////////////////////////////////////
+static int32_T freakFeaturesInto(void *ptrKeypoints, void *ptrDescriptors,
+	int32_T capacity, bool isRowMajor,
+	real32_T *outLoc, real32_T *outScale, real32_T *outMetric,
+	int32_T *outMiscOrSignOfLap, real32_T *outOrientation, uint8_T *outFeatures)
+{
+	CG_PROFILE_PHASE(CG_PROFILE_OUTPUT);
+	vector<KeyPoint> &keypoints = *((vector<KeyPoint> *)ptrKeypoints);
+	cv::Mat &descriptors = *((cv::Mat *)ptrDescriptors);
+	const int32_T numFeatures = (int32_T)keypoints.size();
+
+	selectStrongest(keypoints, capacity, &descriptors);
+	if (isRowMajor)
+	{
+		keyPointsToFields_freakRM<int32_T>(keypoints, true, false, outLoc, outScale,
+			outMetric, outMiscOrSignOfLap, outOrientation);
+		cArrayFromMat_RowMaj<uint8_T>(outFeatures, descriptors);
+	}
+	else
+	{
+		const mwSize stride = (mwSize)std::max(capacity, 0);
+		keyPointsToFields_freak<int32_T>(keypoints, true, false, outLoc, outScale,
+			outMetric, outMiscOrSignOfLap, outOrientation, stride);
+		if (!keypoints.empty() && !descriptors.empty())
+		{
+			vision::transposeTiled<uint8_T>(descriptors.ptr<uint8_T>(0), descriptors.step1(),
+				outFeatures, stride, descriptors.cols, descriptors.rows);
+		}
+	}
+
+	vision::ResultPool<vector<KeyPoint> >::release(&keypoints);
+	vision::ResultPool<cv::Mat>::release(&descriptors);
+	return numFeatures;
+}
+
+int32_T extractFreak_computeInto(uint8_T *inImg,
+	int32_T nRows, int32_T nCols, int32_T nDims,
+	real32_T *inLoc, real32_T *inScale, real32_T *inMetric, int32_T *inMiscOrSignOfLap,
+	int32_T numel, int32_T nbOctave,
+	boolean_T orientationNormalized, boolean_T scaleNormalized, real32_T patternScale,
+	int32_T capacity,
+	real32_T *outLoc, real32_T *outScale, real32_T *outMetric,
+	int32_T *outMiscOrSignOfLap, real32_T *outOrientation, uint8_T *outFeatures)
+{
+	CG_PROFILE_CALL();
+	void *ptrKeypoints = NULL, *ptrDescriptors = NULL;
+	extractFreak_compute(inImg, nRows, nCols, nDims, inLoc, inScale, inMetric,
+		inMiscOrSignOfLap, numel, nbOctave, orientationNormalized, scaleNormalized,
+		patternScale, &ptrKeypoints, &ptrDescriptors);
+	return freakFeaturesInto(ptrKeypoints, ptrDescriptors, capacity, false,
+		outLoc, outScale, outMetric, outMiscOrSignOfLap, outOrientation, outFeatures);
+}
+
+int32_T extractFreak_computeIntoRM(uint8_T *inImg,
+	int32_T nRows, int32_T nCols, int32_T nDims,
+	real32_T *inLoc, real32_T *inScale, real32_T *inMetric, int32_T *inMiscOrSignOfLap,
+	int32_T numel, int32_T nbOctave,
+	boolean_T orientationNormalized, boolean_T scaleNormalized, real32_T patternScale,
+	int32_T capacity,
+	real32_T *outLoc, real32_T *outScale, real32_T *outMetric,
+	int32_T *outMiscOrSignOfLap, real32_T *outOrientation, uint8_T *outFeatures)
+{
+	CG_PROFILE_CALL();
+	void *ptrKeypoints = NULL, *ptrDescriptors = NULL;
+	extractFreak_computeRM(inImg, nRows, nCols, nDims, inLoc, inScale, inMetric,
+		inMiscOrSignOfLap, numel, nbOctave, orientationNormalized, scaleNormalized,
+		patternScale, &ptrKeypoints, &ptrDescriptors);
+	return freakFeaturesInto(ptrKeypoints, ptrDescriptors, capacity, true,
+		outLoc, outScale, outMetric, outMiscOrSignOfLap, outOrientation, outFeatures);
+}
+
+int32_T extractFreak_computeObjInto(void *ptrClass, uint8_T *inImg,
+	int32_T nRows, int32_T nCols, int32_T nDims,
+	real32_T *inLoc, real32_T *inScale, real32_T *inMetric, int32_T *inMiscOrSignOfLap,
+	int32_T numel, int32_T capacity,
+	real32_T *outLoc, real32_T *outScale, real32_T *outMetric,
+	int32_T *outMiscOrSignOfLap, real32_T *outOrientation, uint8_T *outFeatures)
+{
+	CG_PROFILE_CALL();
+	void *ptrKeypoints = NULL, *ptrDescriptors = NULL;
+	extractFreak_computeObj(ptrClass, inImg, nRows, nCols, nDims, inLoc, inScale,
+		inMetric, inMiscOrSignOfLap, numel, &ptrKeypoints, &ptrDescriptors);
+	return freakFeaturesInto(ptrKeypoints, ptrDescriptors, capacity, false,
+		outLoc, outScale, outMetric, outMiscOrSignOfLap, outOrientation, outFeatures);
+}
+
+int32_T extractFreak_computeObjIntoRM(void *ptrClass, uint8_T *inImg,
+	int32_T nRows, int32_T nCols, int32_T nDims,
+	real32_T *inLoc, real32_T *inScale, real32_T *inMetric, int32_T *inMiscOrSignOfLap,
+	int32_T numel, int32_T capacity,
+	real32_T *outLoc, real32_T *outScale, real32_T *outMetric,
+	int32_T *outMiscOrSignOfLap, real32_T *outOrientation, uint8_T *outFeatures)
+{
+	CG_PROFILE_CALL();
+	void *ptrKeypoints = NULL, *ptrDescriptors = NULL;
+	extractFreak_computeObjRM(ptrClass, inImg, nRows, nCols, nDims, inLoc, inScale,
+		inMetric, inMiscOrSignOfLap, numel, &ptrKeypoints, &ptrDescriptors);
+	return freakFeaturesInto(ptrKeypoints, ptrDescriptors, capacity, true,
+		outLoc, outScale, outMetric, outMiscOrSignOfLap, outOrientation, outFeatures);
 }
 
 #endif
@@ -0,0 +1,85 @@
+///////////////////////////////////////////////////////////////////////////////
+// This file contains the shared library function calls used in codegen for
+// extractHOGFeatures on batches of same sized images, see
+// HOGFeatureExtractor.hpp.
+///////////////////////////////////////////////////////////////////////////////
+#ifndef COMPILE_FOR_VISION_BUILTINS
+#include "extractHOGFeaturesCore_api.hpp"
+#include "HOGFeatureExtractor.hpp"
+#include "cgProfile.hpp"
+
+template <typename T>
+static void extractHOGFeatures(const T * images, int32_T nRows, int32_T nCols,
+        int32_T nChannels, int32_T numImages, const int32_T * cellSize,
+        const int32_T * blockSize, const int32_T * blockOverlap,
+        int32_T numBins, boolean_T useSignedOrientation, bool isRowMajor,
+        real32_T * outFeatures)
+{
+    hogfeatures::HOGParams params;
+    for (int d = 0; d < 2; d++)
+    {
+        params.cellSize[d]     = (int)cellSize[d];
+        params.blockSize[d]    = (int)blockSize[d];
+        params.blockOverlap[d] = (int)blockOverlap[d];
+    }
+    params.numBins = (int)numBins;
+    params.useSignedOrientation = useSignedOrientation != 0;
+
+    hogfeatures::HOGFeatureExtractor extractor((int)nRows, (int)nCols, params);
+    extractor.compute(images, (int)nChannels, (int)numImages, isRowMajor,
+        outFeatures);
+}
+
+void extractHOGFeatures_uint8(const uint8_T * images, int32_T nRows,
+        int32_T nCols, int32_T nChannels, int32_T numImages,
+        const int32_T * cellSize, const int32_T * blockSize,
+        const int32_T * blockOverlap, int32_T numBins,
+        boolean_T useSignedOrientation, real32_T * outFeatures)
+{
+    CG_PROFILE_CALL();
+    CG_PROFILE_PHASE(CG_PROFILE_COMPUTE);
+    extractHOGFeatures(images, nRows, nCols, nChannels, numImages, cellSize,
+        blockSize, blockOverlap, numBins, useSignedOrientation, false,
+        outFeatures);
+}
+
+void extractHOGFeatures_uint8RM(const uint8_T * images, int32_T nRows,
+        int32_T nCols, int32_T nChannels, int32_T numImages,
+        const int32_T * cellSize, const int32_T * blockSize,
+        const int32_T * blockOverlap, int32_T numBins,
+        boolean_T useSignedOrientation, real32_T * outFeatures)
+{
+    CG_PROFILE_CALL();
+    CG_PROFILE_PHASE(CG_PROFILE_COMPUTE);
+    extractHOGFeatures(images, nRows, nCols, nChannels, numImages, cellSize,
+        blockSize, blockOverlap, numBins, useSignedOrientation, true,
+        outFeatures);
+}
+
+void extractHOGFeatures_single(const real32_T * images, int32_T nRows,
+        int32_T nCols, int32_T nChannels, int32_T numImages,
+        const int32_T * cellSize, const int32_T * blockSize,
+        const int32_T * blockOverlap, int32_T numBins,
+        boolean_T useSignedOrientation, real32_T * outFeatures)
+{
+    CG_PROFILE_CALL();
+    CG_PROFILE_PHASE(CG_PROFILE_COMPUTE);
+    extractHOGFeatures(images, nRows, nCols, nChannels, numImages, cellSize,
+        blockSize, blockOverlap, numBins, useSignedOrientation, false,
+        outFeatures);
+}
+
+void extractHOGFeatures_singleRM(const real32_T * images, int32_T nRows,
+        int32_T nCols, int32_T nChannels, int32_T numImages,
+        const int32_T * cellSize, const int32_T * blockSize,
+        const int32_T * blockOverlap, int32_T numBins,
+        boolean_T useSignedOrientation, real32_T * outFeatures)
+{
+    CG_PROFILE_CALL();
+    CG_PROFILE_PHASE(CG_PROFILE_COMPUTE);
+    extractHOGFeatures(images, nRows, nCols, nChannels, numImages, cellSize,
+        blockSize, blockOverlap, numBins, useSignedOrientation, true,
+        outFeatures);
+}
+
+#endif
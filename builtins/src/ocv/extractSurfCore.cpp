@@ -10,6 +10,8 @@
 #include "extractSurfCore_api.hpp"
 #include "surfCommon.hpp" // for initModule_mwsurf
 #include "cgCommon.hpp"
+#include "cgProfile.hpp"
+#include "mwcompactdescriptor.hpp"
 
 // common defines
 #define SURF_SIZE_TO_SCALE_FACTOR (1.2f/9.0f)
@@ -201,14 +203,16 @@ int32_T extractSurf_compute(uint8_T *inImg,
 	int32_T numel, boolean_T isExtended, boolean_T isUpright,
 	void **outKeypoints, void **outDescriptors)
 {
+	CG_PROFILE_CALL();
 	cv::Mat img = cv::Mat(nRows, (int)nCols, CV_8UC1, inImg);
 	(void)nDims;
 	// keypoints
-	vector<KeyPoint> *ptrKeypoints = (vector<KeyPoint> *)new vector<KeyPoint>();
+	vector<KeyPoint> *ptrKeypoints = vision::ResultPool<vector<KeyPoint> >::acquire();
 	*outKeypoints = ptrKeypoints;
 	vector<KeyPoint> &refKeypoints = *ptrKeypoints;
 
 	struct2KeyPoints(inLoc,inScale,inMetric,inSignOfLap,refKeypoints, numel);
+	CG_PROFILE_PHASE(CG_PROFILE_COMPUTE);
 
 	// output
 	// Note: OpenCV extractor does not reduce the number of feature points.
@@ -224,7 +228,7 @@ int32_T extractSurf_compute(uint8_T *inImg,
     surfExtractor->setExtended(isExtended != 0);
 
 	// run the extractor
-	cv::Mat *ptrDescriptors = (cv::Mat *)new cv::Mat();
+	cv::Mat *ptrDescriptors = vision::ResultPool<cv::Mat>::acquire();
 	*outDescriptors = ptrDescriptors;
 	cv::Mat &refDescriptors = *ptrDescriptors;
 	surfExtractor->compute(img, refKeypoints, refDescriptors);
@@ -238,14 +242,16 @@ int32_T extractSurf_computeRM(uint8_T *inImg,
 	int32_T numel, boolean_T isExtended, boolean_T isUpright,
 	void **outKeypoints, void **outDescriptors)
 {
+	CG_PROFILE_CALL();
 	cv::Mat img = cv::Mat(nRows, (int)nCols, CV_8UC1, inImg);
 	(void)nDims;
 	// keypoints
-	vector<KeyPoint> *ptrKeypoints = (vector<KeyPoint> *)new vector<KeyPoint>();
+	vector<KeyPoint> *ptrKeypoints = vision::ResultPool<vector<KeyPoint> >::acquire();
 	*outKeypoints = ptrKeypoints;
 	vector<KeyPoint> &refKeypoints = *ptrKeypoints;
 
 	struct2KeyPointsRM(inLoc, inScale, inMetric, inSignOfLap, refKeypoints, numel);
+	CG_PROFILE_PHASE(CG_PROFILE_COMPUTE);
 
 	// output
 	// Note: OpenCV extractor does not reduce the number of feature points.
@@ -261,7 +267,7 @@ int32_T extractSurf_computeRM(uint8_T *inImg,
 	surfExtractor->setExtended(isExtended != 0);
 
 	// run the extractor
-	cv::Mat *ptrDescriptors = (cv::Mat *)new cv::Mat();
+	cv::Mat *ptrDescriptors = vision::ResultPool<cv::Mat>::acquire();
 	*outDescriptors = ptrDescriptors;
 	cv::Mat &refDescriptors = *ptrDescriptors;
 	surfExtractor->compute(img, refKeypoints, refDescriptors);
@@ -269,10 +275,51 @@ int32_T extractSurf_computeRM(uint8_T *inImg,
 	return ((int32_T)(refKeypoints.size())); //actual_numel
 }
 
+//////////////////////////////////////////////////////////////////////////////
+// Same as extractSurf_compute, on the integral image of inImg computed by
+// fastHessianDetector_uint8WithIntegral, so that the frame is not
+// integrated a second time. The integral image is not freed.
+//////////////////////////////////////////////////////////////////////////////
+int32_T extractSurf_computeWithIntegral(void *ptrIntegral,
+	uint8_T *inImg, int32_T nRows, int32_T nCols, int32_T nDims,
+	real32_T *inLoc, real32_T *inScale, real32_T *inMetric, int8_T *inSignOfLap,
+	int32_T numel, boolean_T isExtended, boolean_T isUpright,
+	void **outKeypoints, void **outDescriptors)
+{
+	CG_PROFILE_CALL();
+	cv::Mat img = cv::Mat(nRows, (int)nCols, CV_8UC1, inImg);
+	const cv::Mat &sum = *((cv::Mat *)ptrIntegral);
+	(void)nDims;
+	// keypoints
+	vector<KeyPoint> *ptrKeypoints = vision::ResultPool<vector<KeyPoint> >::acquire();
+	*outKeypoints = ptrKeypoints;
+	vector<KeyPoint> &refKeypoints = *ptrKeypoints;
+
+	struct2KeyPoints(inLoc,inScale,inMetric,inSignOfLap,refKeypoints, numel);
+	CG_PROFILE_PHASE(CG_PROFILE_COMPUTE);
+
+	Ptr<MWSURF> surfExtractor = cv::makePtr<MWSURF>();
+    if( surfExtractor.empty() )
+        CV_Error(CV_StsNotImplemented, "OpenCV was built without SURF support");
+
+    // To avoid C4800 on MSVC: make bool != 0 to force bool type.
+    surfExtractor->setUpright(isUpright != 0);
+    surfExtractor->setExtended(isExtended != 0);
+
+	// run the extractor
+	cv::Mat *ptrDescriptors = vision::ResultPool<cv::Mat>::acquire();
+	*outDescriptors = ptrDescriptors;
+	surfExtractor->computeWithIntegral(img, sum, refKeypoints, *ptrDescriptors);
+
+	return ((int32_T)(refKeypoints.size())); //actual_numel
+}
+
 void extractSurf_assignOutput(void *ptrKeypoints, void *ptrDescriptors,
 	real32_T *outLoc, real32_T *outScale, real32_T *outMetric, int8_T *outSignOfLap,
 	real32_T *outOrientation, real32_T *outFeatures)
 {
+	CG_PROFILE_CALL();
+	CG_PROFILE_PHASE(CG_PROFILE_OUTPUT);
 	vector<KeyPoint> keypoints = ((vector<KeyPoint> *)ptrKeypoints)[0];
 	cv::Mat descriptors = ((cv::Mat *)ptrDescriptors)[0];
 
@@ -280,8 +327,8 @@ void extractSurf_assignOutput(void *ptrKeypoints, void *ptrDescriptors,
 	keyPoints2Fields(keypoints, true, outLoc, outScale, outMetric, outSignOfLap, outOrientation);
 	cArrayFromMat<real32_T>(outFeatures, descriptors);
 
-	delete((vector<KeyPoint> *)ptrKeypoints);
-	delete((cv::Mat *)ptrDescriptors);
+	vision::ResultPool<vector<KeyPoint> >::release((vector<KeyPoint> *)ptrKeypoints);
+	vision::ResultPool<cv::Mat>::release((cv::Mat *)ptrDescriptors);
 }
 
 
@@ -289,6 +336,8 @@ void extractSurf_assignOutputRM(void *ptrKeypoints, void *ptrDescriptors,
 	real32_T *outLoc, real32_T *outScale, real32_T *outMetric, int8_T *outSignOfLap,
 	real32_T *outOrientation, real32_T *outFeatures)
 {
+	CG_PROFILE_CALL();
+	CG_PROFILE_PHASE(CG_PROFILE_OUTPUT);
 	vector<KeyPoint> keypoints = ((vector<KeyPoint> *)ptrKeypoints)[0];
 	cv::Mat descriptors = ((cv::Mat *)ptrDescriptors)[0];
 
@@ -296,8 +345,75 @@ void extractSurf_assignOutputRM(void *ptrKeypoints, void *ptrDescriptors,
 	keyPoints2FieldsRM(keypoints, true, outLoc, outScale, outMetric, outSignOfLap, outOrientation);
 	cArrayFromMat_RowMaj<real32_T>(outFeatures, descriptors);
 
-	delete((vector<KeyPoint> *)ptrKeypoints);
-	delete((cv::Mat *)ptrDescriptors);
+	vision::ResultPool<vector<KeyPoint> >::release((vector<KeyPoint> *)ptrKeypoints);
+	vision::ResultPool<cv::Mat>::release((cv::Mat *)ptrDescriptors);
+}
+
+
+//////////////////////////////////////////////////////////////////////////////
+// Outputs with the descriptors converted to half precision or scaled int8,
+// see mwcompactdescriptor.hpp
+//////////////////////////////////////////////////////////////////////////////
+template <typename T>
+static void assignCompactOutput(void *ptrKeypoints, void *ptrDescriptors,
+	bool isRowMajor, real32_T *outLoc, real32_T *outScale, real32_T *outMetric,
+	int8_T *outSignOfLap, real32_T *outOrientation, T *outFeatures)
+{
+	vector<KeyPoint> &keypoints = ((vector<KeyPoint> *)ptrKeypoints)[0];
+	cv::Mat descriptors = ((cv::Mat *)ptrDescriptors)[0];
+	if (!descriptors.isContinuous())
+		descriptors = descriptors.clone();
+
+	// Populate the outputs
+	if (isRowMajor)
+		keyPoints2FieldsRM(keypoints, true, outLoc, outScale, outMetric, outSignOfLap, outOrientation);
+	else
+		keyPoints2Fields(keypoints, true, outLoc, outScale, outMetric, outSignOfLap, outOrientation);
+	vision::compactDescriptors((const float *)descriptors.data, descriptors.rows,
+		descriptors.cols, isRowMajor, outFeatures);
+
+	vision::ResultPool<vector<KeyPoint> >::release((vector<KeyPoint> *)ptrKeypoints);
+	vision::ResultPool<cv::Mat>::release((cv::Mat *)ptrDescriptors);
+}
+
+void extractSurf_assignOutputHalf(void *ptrKeypoints, void *ptrDescriptors,
+	real32_T *outLoc, real32_T *outScale, real32_T *outMetric, int8_T *outSignOfLap,
+	real32_T *outOrientation, uint16_T *outFeatures)
+{
+	CG_PROFILE_CALL();
+	CG_PROFILE_PHASE(CG_PROFILE_OUTPUT);
+	assignCompactOutput(ptrKeypoints, ptrDescriptors, false, outLoc, outScale,
+		outMetric, outSignOfLap, outOrientation, outFeatures);
+}
+
+void extractSurf_assignOutputHalfRM(void *ptrKeypoints, void *ptrDescriptors,
+	real32_T *outLoc, real32_T *outScale, real32_T *outMetric, int8_T *outSignOfLap,
+	real32_T *outOrientation, uint16_T *outFeatures)
+{
+	CG_PROFILE_CALL();
+	CG_PROFILE_PHASE(CG_PROFILE_OUTPUT);
+	assignCompactOutput(ptrKeypoints, ptrDescriptors, true, outLoc, outScale,
+		outMetric, outSignOfLap, outOrientation, outFeatures);
+}
+
+void extractSurf_assignOutputInt8(void *ptrKeypoints, void *ptrDescriptors,
+	real32_T *outLoc, real32_T *outScale, real32_T *outMetric, int8_T *outSignOfLap,
+	real32_T *outOrientation, int8_T *outFeatures)
+{
+	CG_PROFILE_CALL();
+	CG_PROFILE_PHASE(CG_PROFILE_OUTPUT);
+	assignCompactOutput(ptrKeypoints, ptrDescriptors, false, outLoc, outScale,
+		outMetric, outSignOfLap, outOrientation, outFeatures);
+}
+
+void extractSurf_assignOutputInt8RM(void *ptrKeypoints, void *ptrDescriptors,
+	real32_T *outLoc, real32_T *outScale, real32_T *outMetric, int8_T *outSignOfLap,
+	real32_T *outOrientation, int8_T *outFeatures)
+{
+	CG_PROFILE_CALL();
+	CG_PROFILE_PHASE(CG_PROFILE_OUTPUT);
+	assignCompactOutput(ptrKeypoints, ptrDescriptors, true, outLoc, outScale,
+		outMetric, outSignOfLap, outOrientation, outFeatures);
 }
 
 #endif
@@ -9,6 +9,8 @@
 
 #include "fastHessianDetectorCore_api.hpp"
 #include "surfCommon.hpp" // for initModule_mwsurf
+#include "cgCommon.hpp"
+#include "cgProfile.hpp"
 
 // common defines
 #define SURF_SIZE_TO_SCALE_FACTOR (1.2f/9.0f)
@@ -76,6 +78,8 @@ void configureSURFDetectorCore(Ptr<MWSURF> surfDetector,
 void fastHessianDetector_keyPoints2field(void *ptrKeypoints, 
 	real32_T *outLoc, real32_T *outScale, real32_T *outMetric, int8_T *outSignOfLap)
 {
+	CG_PROFILE_CALL();
+	CG_PROFILE_PHASE(CG_PROFILE_OUTPUT);
 	vector<KeyPoint> &in = ((vector<KeyPoint> *)ptrKeypoints)[0];
 
 	const mwSize m = in.size();
@@ -97,6 +101,8 @@ void fastHessianDetector_keyPoints2field(void *ptrKeypoints,
 void fastHessianDetector_keyPoints2fieldRM(void *ptrKeypoints,
 	real32_T *outLoc, real32_T *outScale, real32_T *outMetric, int8_T *outSignOfLap)
 {
+	CG_PROFILE_CALL();
+	CG_PROFILE_PHASE(CG_PROFILE_OUTPUT);
 	vector<KeyPoint> &in = ((vector<KeyPoint> *)ptrKeypoints)[0];
 
 	const mwSize m = in.size();
@@ -120,10 +126,12 @@ void fastHessianDetector_keyPoints2fieldRM(void *ptrKeypoints,
 int32_T fastHessianDetector_uint8(uint8_T *inImg, 
 	int32_T nRows, int32_T nCols, int32_T nDims, 
 	int32_T nOctaveLayers, int32_T nOctaves, int32_T hessianThreshold, void **outKeypoint)
-{ 
+{
+	CG_PROFILE_CALL();
 	(void)nDims;
 	// inImg: column major
 	cv::Mat img = cv::Mat(nRows, (int)nCols, CV_8UC1, inImg);
+	CG_PROFILE_PHASE(CG_PROFILE_COMPUTE);
 
 	Ptr<MWSURF> surfDetector = cv::makePtr<MWSURF>();
     if( surfDetector.empty() )
@@ -134,16 +142,195 @@ int32_T fastHessianDetector_uint8(uint8_T *inImg,
 		hessianThreshold, img.rows, img.cols);
 
     // run the detector
-	vector<KeyPoint> *ptrKeypoints = (vector<KeyPoint> *)new vector<KeyPoint>();
+	vector<KeyPoint> *ptrKeypoints = vision::ResultPool<vector<KeyPoint> >::acquire();
 	*outKeypoint = ptrKeypoints;
 	vector<KeyPoint> &refKeypoints = *ptrKeypoints;
 	surfDetector->detect(img, refKeypoints);
 	return ((int32_T)(refKeypoints.size()));
 }
 
+//////////////////////////////////////////////////////////////////////////////
+// Same as fastHessianDetector_uint8, but only the maxPerCell strongest
+// keypoints of each cellSize by cellSize cell of the image, over all the
+// scales, are returned.
+//////////////////////////////////////////////////////////////////////////////
+int32_T fastHessianDetector_uint8Bucketed(uint8_T *inImg,
+	int32_T nRows, int32_T nCols, int32_T nDims,
+	int32_T nOctaveLayers, int32_T nOctaves, int32_T hessianThreshold,
+	int32_T cellSize, int32_T maxPerCell, void **outKeypoint)
+{
+	CG_PROFILE_CALL();
+	fastHessianDetector_uint8(inImg, nRows, nCols, nDims,
+		nOctaveLayers, nOctaves, hessianThreshold, outKeypoint);
+
+	vector<KeyPoint> &refKeypoints = *((vector<KeyPoint> *)*outKeypoint);
+	selectStrongestPerCell(refKeypoints, nRows, nCols, cellSize, maxPerCell);
+	return ((int32_T)(refKeypoints.size()));
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// Same as fastHessianDetector_uint8, but the integral image of inImg is
+// also returned, for extractSurf_computeWithIntegral on the same image. It
+// is freed with fastHessianDetector_deleteIntegral.
+//////////////////////////////////////////////////////////////////////////////
+int32_T fastHessianDetector_uint8WithIntegral(uint8_T *inImg,
+	int32_T nRows, int32_T nCols, int32_T nDims,
+	int32_T nOctaveLayers, int32_T nOctaves, int32_T hessianThreshold,
+	void **outKeypoint, void **outIntegral)
+{
+	CG_PROFILE_CALL();
+	(void)nDims;
+	// inImg: column major
+	cv::Mat img = cv::Mat(nRows, (int)nCols, CV_8UC1, inImg);
+	CG_PROFILE_PHASE(CG_PROFILE_COMPUTE);
+
+	Ptr<MWSURF> surfDetector = cv::makePtr<MWSURF>();
+    if( surfDetector.empty() )
+        CV_Error(CV_StsNotImplemented, "OpenCV was built without SURF support");
+
+    configureSURFDetectorCore(surfDetector, nOctaveLayers, nOctaves,
+		hessianThreshold, img.rows, img.cols);
+
+	vector<KeyPoint> *ptrKeypoints = vision::ResultPool<vector<KeyPoint> >::acquire();
+	*outKeypoint = ptrKeypoints;
+	cv::Mat *ptrIntegral = vision::ResultPool<cv::Mat>::acquire();
+	*outIntegral = ptrIntegral;
+
+	surfDetector->detectWithIntegral(img, *ptrKeypoints, *ptrIntegral);
+	return ((int32_T)(ptrKeypoints->size()));
+}
+
+void fastHessianDetector_deleteIntegral(void *ptrIntegral)
+{
+	vision::ResultPool<cv::Mat>::release((cv::Mat *)ptrIntegral);
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// Detect SURF keypoints and extract their features in one call: one integral
+// image serves the detector and the extractor. The outputs are copied with
+// extractSurf_assignOutput, which also frees them.
+//////////////////////////////////////////////////////////////////////////////
+int32_T fastHessianDetector_detectAndExtract(uint8_T *inImg,
+	int32_T nRows, int32_T nCols, int32_T nDims,
+	int32_T nOctaveLayers, int32_T nOctaves, int32_T hessianThreshold,
+	boolean_T isExtended, boolean_T isUpright,
+	void **outKeypoints, void **outDescriptors)
+{
+	CG_PROFILE_CALL();
+	(void)nDims;
+	// inImg: column major
+	cv::Mat img = cv::Mat(nRows, (int)nCols, CV_8UC1, inImg);
+	CG_PROFILE_PHASE(CG_PROFILE_COMPUTE);
+
+	Ptr<MWSURF> surf = cv::makePtr<MWSURF>();
+    if( surf.empty() )
+        CV_Error(CV_StsNotImplemented, "OpenCV was built without SURF support");
+
+    configureSURFDetectorCore(surf, nOctaveLayers, nOctaves,
+		hessianThreshold, img.rows, img.cols);
+    // To avoid C4800 on MSVC: make bool != 0 to force bool type.
+    surf->setUpright(isUpright != 0);
+    surf->setExtended(isExtended != 0);
+
+	vector<KeyPoint> *ptrKeypoints = vision::ResultPool<vector<KeyPoint> >::acquire();
+	*outKeypoints = ptrKeypoints;
+	cv::Mat *ptrDescriptors = vision::ResultPool<cv::Mat>::acquire();
+	*outDescriptors = ptrDescriptors;
+
+	surf->detectAndCompute(img, *ptrKeypoints, *ptrDescriptors);
+	return ((int32_T)(ptrKeypoints->size()));
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// Batch of images: each worker thread detects and describes whole images
+// with its own SURF object, configured again for the size of each image.
+// The descriptors are collected with fastHessianDetector_assignBatch into
+// one array.
+//////////////////////////////////////////////////////////////////////////////
+static void detectAndExtractSURFImage(Ptr<MWSURF> &surf, uint8_T *inImg,
+	int32_T nRows, int32_T nCols, int32_T nOctaveLayers, int32_T nOctaves,
+	int32_T hessianThreshold, bool isExtended, bool isUpright,
+	FeatureBatch &batch, int i)
+{
+	if (surf.empty())
+	{
+		surf = cv::makePtr<MWSURF>();
+		if( surf.empty() )
+			CV_Error(CV_StsNotImplemented, "OpenCV was built without SURF support");
+		surf->setUpright(isUpright);
+		surf->setExtended(isExtended);
+	}
+
+	// inImg: column major
+	cv::Mat img = cv::Mat(nRows, (int)nCols, CV_8UC1, inImg);
+	configureSURFDetectorCore(surf, nOctaveLayers, nOctaves,
+		hessianThreshold, img.rows, img.cols);
+	surf->detectAndCompute(img, batch.keypoints[i], batch.descriptors[i]);
+}
+
+int32_T fastHessianDetector_detectAndExtractBatch(
+	uint8_T * const *images, const int32_T *nRows, const int32_T *nCols, int32_T numImages,
+	int32_T nOctaveLayers, int32_T nOctaves, int32_T hessianThreshold,
+	boolean_T isExtended, boolean_T isUpright,
+	int32_T *outNumFeatures, void **outBatch)
+{
+	CG_PROFILE_CALL();
+	FeatureBatch *ptrBatch = new FeatureBatch();
+	*outBatch = ptrBatch;
+	ptrBatch->keypoints.resize(numImages);
+	ptrBatch->descriptors.resize(numImages);
+
+	// To avoid C4800 on MSVC: make bool != 0 to force bool type.
+	const bool isExtended_ = isExtended != 0, isUpright_ = isUpright != 0;
+
+	CG_PROFILE_PHASE(CG_PROFILE_COMPUTE);
+	// one detector per worker
+	vector< Ptr<MWSURF> > surfs(std::max((int)cgGetNumThreads(), 1));
+#ifdef PARALLEL
+	cgParallelForWorkers(numImages, [&](int w, int i) {
+		detectAndExtractSURFImage(surfs[w], images[i], nRows[i], nCols[i],
+			nOctaveLayers, nOctaves, hessianThreshold, isExtended_, isUpright_,
+			*ptrBatch, i);
+	});
+#else
+	for (int i = 0; i < numImages; i++)
+		detectAndExtractSURFImage(surfs[0], images[i], nRows[i], nCols[i],
+			nOctaveLayers, nOctaves, hessianThreshold, isExtended_, isUpright_,
+			*ptrBatch, i);
+#endif
+
+	int32_T numTotal = 0;
+	for (int i = 0; i < numImages; i++)
+	{
+		outNumFeatures[i] = (int32_T)ptrBatch->keypoints[i].size();
+		numTotal += outNumFeatures[i];
+	}
+	return numTotal;
+}
+
+void fastHessianDetector_assignBatch(void *ptrBatch,
+	real32_T *outLoc, real32_T *outFeatures, int32_T *outOffsets)
+{
+	CG_PROFILE_CALL();
+	CG_PROFILE_PHASE(CG_PROFILE_OUTPUT);
+	featureBatchToArrays<real32_T>(*((FeatureBatch *)ptrBatch), false,
+		outLoc, outFeatures, outOffsets);
+	delete((FeatureBatch *)ptrBatch);
+}
+
+void fastHessianDetector_assignBatchRM(void *ptrBatch,
+	real32_T *outLoc, real32_T *outFeatures, int32_T *outOffsets)
+{
+	CG_PROFILE_CALL();
+	CG_PROFILE_PHASE(CG_PROFILE_OUTPUT);
+	featureBatchToArrays<real32_T>(*((FeatureBatch *)ptrBatch), true,
+		outLoc, outFeatures, outOffsets);
+	delete((FeatureBatch *)ptrBatch);
+}
+
 void fastHessianDetector_deleteKeypoint(void *ptrKeypoints)
 {
- 	delete((vector<KeyPoint> *)ptrKeypoints);
+ 	vision::ResultPool<vector<KeyPoint> >::release((vector<KeyPoint> *)ptrKeypoints);
 }
 
 #endif
\ No newline at end of file
@@ -163,6 +163,32 @@ int cornerScore<16>(const uchar* ptr, const int pixel[], int threshold)
     q0 = _mm_max_epi16(q0, _mm_srli_si128(q0, 4));
     q0 = _mm_max_epi16(q0, _mm_srli_si128(q0, 2));
     threshold = (short)_mm_cvtsi128_si32(q0) - 1;
+#elif CV_NEON
+    int16x8_t q0 = vdupq_n_s16(-1000), q1 = vdupq_n_s16(1000);
+    for( k = 0; k < 16; k += 8 )
+    {
+        int16x8_t v0 = vld1q_s16(d+k+1);
+        int16x8_t v1 = vld1q_s16(d+k+2);
+        int16x8_t a = vminq_s16(v0, v1);
+        int16x8_t b = vmaxq_s16(v0, v1);
+        for( int m = 3; m <= K; m++ )
+        {
+            v0 = vld1q_s16(d+k+m);
+            a = vminq_s16(a, v0);
+            b = vmaxq_s16(b, v0);
+        }
+        v0 = vld1q_s16(d+k);
+        q0 = vmaxq_s16(q0, vminq_s16(a, v0));
+        q1 = vminq_s16(q1, vmaxq_s16(b, v0));
+        v0 = vld1q_s16(d+k+K+1);
+        q0 = vmaxq_s16(q0, vminq_s16(a, v0));
+        q1 = vminq_s16(q1, vmaxq_s16(b, v0));
+    }
+    q0 = vmaxq_s16(q0, vnegq_s16(q1));
+    int16x4_t q = vmax_s16(vget_low_s16(q0), vget_high_s16(q0));
+    q = vpmax_s16(q, q);
+    q = vpmax_s16(q, q);
+    threshold = vget_lane_s16(q, 0) - 1;
 #else
     int a0 = threshold;
     for( k = 0; k < 16; k += 2 )
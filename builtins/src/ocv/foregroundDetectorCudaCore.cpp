@@ -0,0 +1,92 @@
+//////////////////////////////////////////////////////////////////////////////
+// OpenCV CUDA foreground detector wrapper
+//
+// Copyright 2016 The MathWorks, Inc.
+//
+//////////////////////////////////////////////////////////////////////////////
+
+#ifndef COMPILE_FOR_VISION_BUILTINS
+#include "foregroundDetectorCudaCore_api.hpp"
+
+#include "ForegroundDetectorCudaOcv.hpp"
+#include "cgProfile.hpp"
+
+using namespace foregroundDetector;
+
+//////////////////////////////////////////////////////////////////////////////
+// Without CUDA support, construct returns NULL and the other functions are
+// never called
+//////////////////////////////////////////////////////////////////////////////
+
+boolean_T foregroundDetectorCuda_isAvailable(int32_T device)
+{
+    return isCudaDevice((int)device);
+}
+
+void foregroundDetectorCuda_construct(void **ptr2ptrClass, int32_T device)
+{
+    *ptr2ptrClass = NULL;
+#if defined(FOREGROUND_DETECTOR_HAVE_CUDA)
+    if (isCudaDevice((int)device))
+    {
+        *ptr2ptrClass = new ForegroundDetectorCudaOcv((int)device);
+    }
+#endif
+}
+
+void foregroundDetectorCuda_initialize(void *ptrClass,
+    int32_T nRows, int32_T nCols, int32_T nChannels,
+    cvstFGDCudaStruct_T *params)
+{
+#if defined(FOREGROUND_DETECTOR_HAVE_CUDA)
+    ForegroundDetectorCudaOcv *ptrClass_ = (ForegroundDetectorCudaOcv *)ptrClass;
+    ptrClass_->initialize((int)nRows, (int)nCols, (int)nChannels, params);
+#else
+    (void)ptrClass; (void)nRows; (void)nCols; (void)nChannels; (void)params;
+#endif
+}
+
+void foregroundDetectorCuda_step(void *ptrClass,
+    const uint8_T *inImg, boolean_T *mask, float learningRate)
+{
+    CG_PROFILE_CALL();
+#if defined(FOREGROUND_DETECTOR_HAVE_CUDA)
+    ForegroundDetectorCudaOcv *ptrClass_ = (ForegroundDetectorCudaOcv *)ptrClass;
+    ptrClass_->step(inImg, mask, learningRate, false);
+#else
+    (void)ptrClass; (void)inImg; (void)mask; (void)learningRate;
+#endif
+}
+
+void foregroundDetectorCuda_stepRM(void *ptrClass,
+    const uint8_T *inImg, boolean_T *mask, float learningRate)
+{
+    CG_PROFILE_CALL();
+#if defined(FOREGROUND_DETECTOR_HAVE_CUDA)
+    ForegroundDetectorCudaOcv *ptrClass_ = (ForegroundDetectorCudaOcv *)ptrClass;
+    ptrClass_->step(inImg, mask, learningRate, true);
+#else
+    (void)ptrClass; (void)inImg; (void)mask; (void)learningRate;
+#endif
+}
+
+void foregroundDetectorCuda_reset(void *ptrClass)
+{
+#if defined(FOREGROUND_DETECTOR_HAVE_CUDA)
+    ForegroundDetectorCudaOcv *ptrClass_ = (ForegroundDetectorCudaOcv *)ptrClass;
+    ptrClass_->reset();
+#else
+    (void)ptrClass;
+#endif
+}
+
+void foregroundDetectorCuda_deleteObj(void *ptrClass)
+{
+#if defined(FOREGROUND_DETECTOR_HAVE_CUDA)
+    delete ((ForegroundDetectorCudaOcv *)ptrClass);
+#else
+    (void)ptrClass;
+#endif
+}
+
+#endif
@@ -0,0 +1,86 @@
+///////////////////////////////////////////////////////////////////////////////
+// This file contains the shared library function calls used in codegen for
+// detectHarrisFeatures and detectMinEigenFeatures, see HarrisMinEigen.hpp.
+///////////////////////////////////////////////////////////////////////////////
+#ifndef COMPILE_FOR_VISION_BUILTINS
+#include "harrisMinEigenCore_api.hpp"
+#include "HarrisMinEigen.hpp"
+#include "cgResultPool.hpp"
+#include "cgProfile.hpp"
+
+using cornerdetector::Corners;
+using cornerdetector::HarrisMinEigen;
+
+static int32_T computeCorners(const real32_T *inImg, int32_T nRows,
+	int32_T nCols, int32_T method, int32_T filterSize, real32_T minQuality,
+	bool isRowMajor, void **ptrCorners)
+{
+	Corners *corners = vision::ResultPool<Corners>::acquire();
+	HarrisMinEigen::detect(inImg, (int)nRows, (int)nCols, isRowMajor,
+		(int)method, (int)filterSize, minQuality, *corners);
+	*ptrCorners = (void *)corners;
+
+	return (int32_T)corners->size();
+}
+
+int32_T harrisMinEigen_compute(const real32_T *inImg,
+	int32_T nRows, int32_T nCols, int32_T method,
+	int32_T filterSize, real32_T minQuality,
+	void **ptrCorners)
+{
+	CG_PROFILE_CALL();
+	CG_PROFILE_PHASE(CG_PROFILE_COMPUTE);
+	return computeCorners(inImg, nRows, nCols, method, filterSize,
+		minQuality, false, ptrCorners);
+}
+
+int32_T harrisMinEigen_computeRM(const real32_T *inImg,
+	int32_T nRows, int32_T nCols, int32_T method,
+	int32_T filterSize, real32_T minQuality,
+	void **ptrCorners)
+{
+	CG_PROFILE_CALL();
+	CG_PROFILE_PHASE(CG_PROFILE_COMPUTE);
+	return computeCorners(inImg, nRows, nCols, method, filterSize,
+		minQuality, true, ptrCorners);
+}
+
+void harrisMinEigen_assignOutputDelete(void *ptrCorners,
+	real32_T *outLoc, real32_T *outMetric)
+{
+	CG_PROFILE_CALL();
+	CG_PROFILE_PHASE(CG_PROFILE_OUTPUT);
+	Corners *corners = (Corners *)ptrCorners;
+	const size_t m = corners->size();
+
+	for (size_t i = 0; i < m; i++)
+	{
+		const cornerdetector::Corner &corner = (*corners)[i];
+		outLoc[i]     = corner.x;
+		outLoc[m + i] = corner.y;
+		outMetric[i]  = corner.metric;
+	}
+
+	vision::ResultPool<Corners>::release(corners);
+}
+
+void harrisMinEigen_assignOutputDeleteRM(void *ptrCorners,
+	real32_T *outLoc, real32_T *outMetric)
+{
+	CG_PROFILE_CALL();
+	CG_PROFILE_PHASE(CG_PROFILE_OUTPUT);
+	Corners *corners = (Corners *)ptrCorners;
+	const size_t m = corners->size();
+
+	for (size_t i = 0; i < m; i++)
+	{
+		const cornerdetector::Corner &corner = (*corners)[i];
+		outLoc[2 * i]     = corner.x;
+		outLoc[2 * i + 1] = corner.y;
+		outMetric[i]      = corner.metric;
+	}
+
+	vision::ResultPool<Corners>::release(corners);
+}
+
+#endif
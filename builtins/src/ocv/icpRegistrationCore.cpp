@@ -0,0 +1,147 @@
+///////////////////////////////////////////////////////////////////////////////
+// This file contains the shared library function calls used in codegen for
+// the rigid registration of pcregrigid, see RigidIcp.hpp.
+///////////////////////////////////////////////////////////////////////////////
+#ifndef COMPILE_FOR_VISION_BUILTINS
+#include "icpRegistrationCore_api.hpp"
+#include "RigidIcp.hpp"
+#include "cgProfile.hpp"
+
+template <typename T>
+static int32_T setFixed(void *ptrIcp, const T * location, const T * normal,
+        int32_T numPoints, boolean_T hasNormal, const double * gridSteps,
+        int32_T numLevels, boolean_T isPointToPlane, bool isRowMajor)
+{
+    icp::RigidIcp<T> *ptrIcp_ = (icp::RigidIcp<T> *)ptrIcp;
+    return (int32_T)ptrIcp_->setFixed(location, hasNormal ? normal : NULL,
+        (int)numPoints, isRowMajor, gridSteps, (int)numLevels, isPointToPlane != 0);
+}
+
+template <typename T>
+static int32_T registerMoving(void *ptrIcp, const T * location, int32_T numPoints,
+        double inlierRatio, int32_T maxIterations, const double * tolerance,
+        const double * initialTform, double * tform, double * rmse,
+        int32_T * numIterations, bool isRowMajor)
+{
+    icp::RigidIcp<T> *ptrIcp_ = (icp::RigidIcp<T> *)ptrIcp;
+    icp::IcpParams params;
+    params.inlierRatio = inlierRatio;
+    params.maxIterations = (int)maxIterations;
+    params.tolerance[0] = tolerance[0];
+    params.tolerance[1] = tolerance[1];
+
+    int iterations = 0;
+    const int status = ptrIcp_->registerMoving(location, (int)numPoints, isRowMajor,
+        params, initialTform, tform, rmse, &iterations);
+    *numIterations = (int32_T)iterations;
+    return (int32_T)status;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void icpRegistration_construct(void **ptr2ptrIcp)
+{
+    icp::RigidIcp<double> *ptrIcp_ = new icp::RigidIcp<double>();
+    *ptr2ptrIcp = ptrIcp_;
+}
+
+int32_T icpRegistration_setFixed(void *ptrIcp, const double * location,
+        const double * normal, int32_T numPoints, boolean_T hasNormal,
+        const double * gridSteps, int32_T numLevels, boolean_T isPointToPlane)
+{
+    CG_PROFILE_CALL();
+    CG_PROFILE_PHASE(CG_PROFILE_COMPUTE);
+    return setFixed(ptrIcp, location, normal, numPoints, hasNormal, gridSteps,
+        numLevels, isPointToPlane, false);
+}
+
+int32_T icpRegistration_setFixedRM(void *ptrIcp, const double * location,
+        const double * normal, int32_T numPoints, boolean_T hasNormal,
+        const double * gridSteps, int32_T numLevels, boolean_T isPointToPlane)
+{
+    CG_PROFILE_CALL();
+    CG_PROFILE_PHASE(CG_PROFILE_COMPUTE);
+    return setFixed(ptrIcp, location, normal, numPoints, hasNormal, gridSteps,
+        numLevels, isPointToPlane, true);
+}
+
+int32_T icpRegistration_register(void *ptrIcp, const double * location,
+        int32_T numPoints, double inlierRatio, int32_T maxIterations,
+        const double * tolerance, const double * initialTform, double * tform,
+        double * rmse, int32_T * numIterations)
+{
+    CG_PROFILE_CALL();
+    CG_PROFILE_PHASE(CG_PROFILE_COMPUTE);
+    return registerMoving(ptrIcp, location, numPoints, inlierRatio, maxIterations,
+        tolerance, initialTform, tform, rmse, numIterations, false);
+}
+
+int32_T icpRegistration_registerRM(void *ptrIcp, const double * location,
+        int32_T numPoints, double inlierRatio, int32_T maxIterations,
+        const double * tolerance, const double * initialTform, double * tform,
+        double * rmse, int32_T * numIterations)
+{
+    CG_PROFILE_CALL();
+    CG_PROFILE_PHASE(CG_PROFILE_COMPUTE);
+    return registerMoving(ptrIcp, location, numPoints, inlierRatio, maxIterations,
+        tolerance, initialTform, tform, rmse, numIterations, true);
+}
+
+void icpRegistration_deleteObj(void *ptrIcp)
+{
+    delete((icp::RigidIcp<double> *)ptrIcp);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void icpRegistration_construct_single(void **ptr2ptrIcp)
+{
+    icp::RigidIcp<float> *ptrIcp_ = new icp::RigidIcp<float>();
+    *ptr2ptrIcp = ptrIcp_;
+}
+
+int32_T icpRegistration_setFixed_single(void *ptrIcp, const float * location,
+        const float * normal, int32_T numPoints, boolean_T hasNormal,
+        const double * gridSteps, int32_T numLevels, boolean_T isPointToPlane)
+{
+    CG_PROFILE_CALL();
+    CG_PROFILE_PHASE(CG_PROFILE_COMPUTE);
+    return setFixed(ptrIcp, location, normal, numPoints, hasNormal, gridSteps,
+        numLevels, isPointToPlane, false);
+}
+
+int32_T icpRegistration_setFixed_singleRM(void *ptrIcp, const float * location,
+        const float * normal, int32_T numPoints, boolean_T hasNormal,
+        const double * gridSteps, int32_T numLevels, boolean_T isPointToPlane)
+{
+    CG_PROFILE_CALL();
+    CG_PROFILE_PHASE(CG_PROFILE_COMPUTE);
+    return setFixed(ptrIcp, location, normal, numPoints, hasNormal, gridSteps,
+        numLevels, isPointToPlane, true);
+}
+
+int32_T icpRegistration_register_single(void *ptrIcp, const float * location,
+        int32_T numPoints, double inlierRatio, int32_T maxIterations,
+        const double * tolerance, const double * initialTform, double * tform,
+        double * rmse, int32_T * numIterations)
+{
+    CG_PROFILE_CALL();
+    CG_PROFILE_PHASE(CG_PROFILE_COMPUTE);
+    return registerMoving(ptrIcp, location, numPoints, inlierRatio, maxIterations,
+        tolerance, initialTform, tform, rmse, numIterations, false);
+}
+
+int32_T icpRegistration_register_singleRM(void *ptrIcp, const float * location,
+        int32_T numPoints, double inlierRatio, int32_T maxIterations,
+        const double * tolerance, const double * initialTform, double * tform,
+        double * rmse, int32_T * numIterations)
+{
+    CG_PROFILE_CALL();
+    CG_PROFILE_PHASE(CG_PROFILE_COMPUTE);
+    return registerMoving(ptrIcp, location, numPoints, inlierRatio, maxIterations,
+        tolerance, initialTform, tform, rmse, numIterations, true);
+}
+
+void icpRegistration_deleteObj_single(void *ptrIcp)
+{
+    delete((icp::RigidIcp<float> *)ptrIcp);
+}
+#endif
@@ -0,0 +1,55 @@
+//////////////////////////////////////////////////////////////////////////////
+// Image handle shared by the cores of a pipeline
+//
+// Copyright 2016 The MathWorks, Inc.
+//
+//////////////////////////////////////////////////////////////////////////////
+
+#ifndef COMPILE_FOR_VISION_BUILTINS
+#include "imageHandleCore_api.hpp"
+
+#include "ImageHandle.hpp"
+#include "cgProfile.hpp"
+
+using namespace vision;
+
+void imageHandle_construct(void **ptr2ptrImage, int32_T device)
+{
+    ImageHandle *ptrImage_ = new ImageHandle((int)device);
+    *ptr2ptrImage = ptrImage_;
+}
+
+boolean_T imageHandle_isOnDevice(void *ptrImage)
+{
+    return ((ImageHandle *)ptrImage)->getDevice() >= 0;
+}
+
+void imageHandle_setImage(void *ptrImage, const uint8_T *inImg,
+    int32_T nRows, int32_T nCols, int32_T nChannels)
+{
+    CG_PROFILE_CALL();
+    ImageHandle *ptrImage_ = (ImageHandle *)ptrImage;
+    ptrImage_->setImage(inImg, (int)nRows, (int)nCols, (int)nChannels, false);
+}
+
+void imageHandle_setImageRM(void *ptrImage, const uint8_T *inImg,
+    int32_T nRows, int32_T nCols, int32_T nChannels)
+{
+    CG_PROFILE_CALL();
+    ImageHandle *ptrImage_ = (ImageHandle *)ptrImage;
+    ptrImage_->setImage(inImg, (int)nRows, (int)nCols, (int)nChannels, true);
+}
+
+void imageHandle_getImage(void *ptrImage, uint8_T *outImg)
+{
+    CG_PROFILE_CALL();
+    CG_PROFILE_PHASE(CG_PROFILE_OUTPUT);
+    ((ImageHandle *)ptrImage)->getImage(outImg);
+}
+
+void imageHandle_deleteObj(void *ptrImage)
+{
+    delete ((ImageHandle *)ptrImage);
+}
+
+#endif
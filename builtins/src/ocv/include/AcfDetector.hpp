@@ -0,0 +1,1262 @@
+//////////////////////////////////////////////////////////////////////////////
+// Aggregate channel features (ACF) object detector, as acfObjectDetector
+// and detectPeopleACF run it with vision.internal.acf.computePyramid and
+// vision.internal.acf.detect.
+//
+// The channels of an image are its LUV color, its normalized gradient
+// magnitude and numBins gradient orientation histograms, all aggregated
+// over blocks of shrink-by-shrink pixels [Dollar 2009]. The channels are
+// only computed from the image at every numApprox+1-th scale of the
+// pyramid. Those of the scales in between are resampled from the nearest
+// computed scale and multiplied by (s/sRef)^-lambda, the power law of each
+// type of channel [Dollar 2014]. The classifier is a soft cascade of
+// boosted decision trees, with a path of its own for the depth-2 trees
+// trainACFObjectDetector trains.
+//
+// Channels are stored as in MATLAB, column major, one channel after the
+// other. The per-pixel work uses the 128-bit universal intrinsics of
+// OpenCV, so SSE2 or NEON when OpenCV is built with them. The computed
+// scales run in parallel, then the approximated ones, and the windows are
+// classified in parallel in blocks of columns of every scale. The
+// detections do not depend on the number of threads.
+//
+// References
+// [Dollar 2009] P. Dollar, Z. Tu, P. Perona and S. Belongie, "Integral
+//   Channel Features", BMVC 2009.
+// [Dollar 2014] P. Dollar, R. Appel, S. Belongie and P. Perona, "Fast
+//   Feature Pyramids for Object Detection", PAMI 2014.
+//
+// Copyright 2016 The MathWorks, Inc.
+//
+//////////////////////////////////////////////////////////////////////////////
+#ifndef ACF_DETECTOR
+#define ACF_DETECTOR
+
+#include <algorithm>
+#include <cfloat>
+#include <climits>
+#include <cmath>
+#include <cstring>
+#include <vector>
+
+#include "vision_defines.h"
+#include "opencv2/core.hpp"
+#include "opencv2/core/hal/intrin.hpp"
+#include "cgThreadPool.hpp"
+
+namespace acf
+{
+
+// Columns of windows classified by one task of the pool
+const int ACF_BLOCK_COLUMNS = 8;
+
+// Resolution of the arc cosine table of the gradient orientation
+const int ACF_ACOS_STEPS = 10000;
+const int ACF_ACOS_MARGIN = 16;
+
+// Size of the table of the L channel, indexed by 1024*Y
+const int ACF_LUV_TABLE_SIZE = 1064;
+
+// Training options, see acfObjectDetector.TrainingOptions. Sizes are
+// [height width] as two fields.
+struct AcfParams
+{
+    AcfParams() : modelHeight(0), modelWidth(0), modelHeightPadded(0),
+        modelWidthPadded(0), padRows(0), padCols(0), shrink(4),
+        numApprox(7), numUpscaledOctaves(0), smoothChannels(1.0f),
+        preSmoothColor(1.0f), fullOrientation(false),
+        normalizationRadius(5.0f), normalizationConstant(0.005f),
+        numBins(6), cellSize(4), interpolateOrientation(true)
+    {
+        lambdas[0] = lambdas[1] = lambdas[2] = 0.0f;
+    }
+
+    // ModelSize and ModelSizePadded
+    int modelHeight;
+    int modelWidth;
+    int modelHeightPadded;
+    int modelWidthPadded;
+
+    // ChannelPadding, in pixels of the image
+    int padRows;
+    int padCols;
+
+    int shrink;
+    int numApprox;
+    int numUpscaledOctaves;
+    float smoothChannels;
+    float preSmoothColor;
+
+    // power laws of the color, gradient magnitude and histogram channels
+    float lambdas[3];
+
+    // gradient
+    bool fullOrientation;
+    float normalizationRadius;
+    float normalizationConstant;
+
+    // hog: Interpolation is 'Orientation' or 'None'
+    int numBins;
+    int cellSize;
+    bool interpolateOrientation;
+};
+
+// Options of a detection, see acfObjectDetector/detect
+struct AcfDetectParams
+{
+    AcfDetectParams() : numScaleLevels(8), minHeight(0), minWidth(0),
+        maxHeight(INT_MAX), maxWidth(INT_MAX), windowStride(4),
+        threshold(-1.0f) {}
+
+    int numScaleLevels;
+    int minHeight;
+    int minWidth;
+    int maxHeight;
+    int maxWidth;
+    int windowStride;
+    float threshold;
+};
+
+// Channels of one scale: numChannels height-by-width column major planes
+struct AcfChannels
+{
+    AcfChannels() : height(0), width(0), numChannels(0) {}
+
+    void create(int h, int w, int d)
+    {
+        height = h;
+        width = w;
+        numChannels = d;
+        data.resize((size_t)h * w * d + 1); // never empty
+    }
+
+    float *channel(int c) { return &data[(size_t)c * height * width]; }
+    const float *channel(int c) const { return &data[(size_t)c * height * width]; }
+
+    int height;
+    int width;
+    int numChannels;
+    std::vector<float> data;
+};
+
+// Window of level `level` of the pyramid whose top left corner is at row
+// row*stride and column column*stride of the level, in pixels
+struct AcfWindow
+{
+    int level;
+    int row;
+    int column;
+    float score;
+};
+
+//////////////////////////////////////////////////////////////////////////////
+// Array helpers, SIMD when available
+//////////////////////////////////////////////////////////////////////////////
+
+// dst[i] = a*src[i]
+inline void scaleArray(float *dst, const float *src, float a, int n)
+{
+    int i = 0;
+#if CV_SIMD128
+    const cv::v_float32x4 va = cv::v_setall_f32(a);
+    for (; i <= n - 4; i += 4)
+        cv::v_store(dst + i, cv::v_load(src + i) * va);
+#endif
+    for (; i < n; i++)
+        dst[i] = a * src[i];
+}
+
+// dst[i] += a*src[i]
+inline void addScaledArray(float *dst, const float *src, float a, int n)
+{
+    int i = 0;
+#if CV_SIMD128
+    const cv::v_float32x4 va = cv::v_setall_f32(a);
+    for (; i <= n - 4; i += 4)
+        cv::v_store(dst + i, cv::v_muladd(cv::v_load(src + i), va, cv::v_load(dst + i)));
+#endif
+    for (; i < n; i++)
+        dst[i] += a * src[i];
+}
+
+// Index into [0, n) of the symmetric padding, as padarray(..., 'symmetric')
+inline int reflectIndex(int i, int n)
+{
+    while (i < 0 || i >= n)
+        i = (i < 0) ? -i - 1 : 2 * n - i - 1;
+    return i;
+}
+
+// round half away from zero, as round of MATLAB
+inline double acfRound(double x)
+{
+    return (x < 0) ? -std::floor(0.5 - x) : std::floor(x + 0.5);
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// rgbToLuv: LUV of a single RGB or grayscale image in [0, 1], normalized as
+// vision.internal.acf.rgb2luv does. luv receives 3 planes.
+//////////////////////////////////////////////////////////////////////////////
+// L/270 of Y in [0, 1]
+inline std::vector<float> buildLuvTable()
+{
+    std::vector<float> t(ACF_LUV_TABLE_SIZE);
+    const double y0 = (6.0 / 29) * (6.0 / 29) * (6.0 / 29);
+    const double a = (29.0 / 3) * (29.0 / 3) * (29.0 / 3);
+    for (int i = 0; i <= 1024; i++)
+    {
+        const double y = i / 1024.0;
+        const double l = (y > y0) ? 116 * std::pow(y, 1.0 / 3.0) - 16 : y * a;
+        t[i] = (float)(l / 270);
+    }
+    for (int i = 1025; i < ACF_LUV_TABLE_SIZE; i++)
+        t[i] = t[i - 1];
+    return t;
+}
+
+inline const float *luvTable()
+{
+    // built on first use
+    static const std::vector<float> table = buildLuvTable();
+    return &table[0];
+}
+
+inline void rgbToLuv(const float *I, int numPixels, bool isRGB, float *luv)
+{
+    const float *R = I;
+    const float *G = isRGB ? I + numPixels : I;
+    const float *B = isRGB ? I + 2 * (size_t)numPixels : I;
+    float *L = luv, *U = luv + numPixels, *V = luv + 2 * (size_t)numPixels;
+
+    const float *table = luvTable();
+    const float maxIndex = (float)(ACF_LUV_TABLE_SIZE - 1);
+    const float uOffset = 88.0f / 270, vOffset = 134.0f / 270;
+    const float uRef = 13 * 0.197833f, vRef = 13 * 0.468331f;
+
+    int i = 0;
+#if CV_SIMD128
+    int idx[4];
+    for (; i <= numPixels - 4; i += 4)
+    {
+        const cv::v_float32x4 r = cv::v_load(R + i), g = cv::v_load(G + i), b = cv::v_load(B + i);
+        const cv::v_float32x4 x = r * cv::v_setall_f32(0.430574f) +
+            g * cv::v_setall_f32(0.341550f) + b * cv::v_setall_f32(0.178325f);
+        const cv::v_float32x4 y = r * cv::v_setall_f32(0.222015f) +
+            g * cv::v_setall_f32(0.706655f) + b * cv::v_setall_f32(0.071330f);
+        const cv::v_float32x4 z = r * cv::v_setall_f32(0.020183f) +
+            g * cv::v_setall_f32(0.129553f) + b * cv::v_setall_f32(0.939180f);
+        const cv::v_float32x4 c = cv::v_setall_f32(1.0f) / (x +
+            y * cv::v_setall_f32(15.0f) + z * cv::v_setall_f32(3.0f) +
+            cv::v_setall_f32(1e-6f));
+
+        const cv::v_float32x4 yIdx = cv::v_min(cv::v_max(y * cv::v_setall_f32(1024.0f),
+            cv::v_setzero_f32()), cv::v_setall_f32(maxIndex));
+        cv::v_store(idx, cv::v_trunc(yIdx));
+        const cv::v_float32x4 l(table[idx[0]], table[idx[1]], table[idx[2]], table[idx[3]]);
+
+        cv::v_store(L + i, l);
+        cv::v_store(U + i, l * (x * c * cv::v_setall_f32(52.0f) -
+            cv::v_setall_f32(uRef)) + cv::v_setall_f32(uOffset));
+        cv::v_store(V + i, l * (y * c * cv::v_setall_f32(117.0f) -
+            cv::v_setall_f32(vRef)) + cv::v_setall_f32(vOffset));
+    }
+#endif
+    for (; i < numPixels; i++)
+    {
+        const float r = R[i], g = G[i], b = B[i];
+        const float x = r * 0.430574f + g * 0.341550f + b * 0.178325f;
+        const float y = r * 0.222015f + g * 0.706655f + b * 0.071330f;
+        const float z = r * 0.020183f + g * 0.129553f + b * 0.939180f;
+        const float c = 1.0f / (x + 15 * y + 3 * z + 1e-6f);
+
+        const float l = table[(int)std::min(std::max(y * 1024.0f, 0.0f), maxIndex)];
+        L[i] = l;
+        U[i] = l * (52 * x * c - uRef) + uOffset;
+        V[i] = l * (117 * y * c - vRef) + vOffset;
+    }
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// convTri: triangle filter of radius r of each of the d planes of I, as
+// vision.internal.acf.convTri with no downsampling. r below 1 is the
+// 3-tap filter [1 p 1]/(2+p) with p = 12/r/(r+2)-2. J may be I.
+//////////////////////////////////////////////////////////////////////////////
+inline void convTri(const float *I, float *J, int h, int w, int d, float r)
+{
+    const size_t planeSize = (size_t)h * w;
+    if (r <= 0)
+    {
+        if (J != I)
+            std::memcpy(J, I, planeSize * d * sizeof(float));
+        return;
+    }
+
+    int rad;
+    std::vector<float> f;
+    if (r < 1)
+    {
+        const float p = 12 / r / (r + 2) - 2;
+        rad = 1;
+        f.push_back(1 / (2 + p));
+        f.push_back(p / (2 + p));
+        f.push_back(1 / (2 + p));
+    }
+    else
+    {
+        rad = (int)(r + 0.5f);
+        const float nrm = 1.0f / ((rad + 1) * (rad + 1));
+        for (int k = 0; k <= 2 * rad; k++)
+            f.push_back((std::min(k, 2 * rad - k) + 1) * nrm);
+    }
+
+    std::vector<float> padded(h + 2 * rad), tmp(planeSize);
+    for (int c = 0; c < d; c++)
+    {
+        const float *Ic = I + c * planeSize;
+        float *Jc = J + c * planeSize;
+
+        // along the columns, padded to apply all taps to whole columns
+        for (int x = 0; x < w; x++)
+        {
+            const float *col = Ic + (size_t)x * h;
+            for (int i = 0; i < rad; i++)
+            {
+                padded[i] = col[reflectIndex(i - rad, h)];
+                padded[h + rad + i] = col[reflectIndex(h + i, h)];
+            }
+            std::memcpy(&padded[rad], col, h * sizeof(float));
+
+            float *out = &tmp[(size_t)x * h];
+            scaleArray(out, &padded[0], f[0], h);
+            for (int k = 1; k <= 2 * rad; k++)
+                addScaledArray(out, &padded[k], f[k], h);
+        }
+
+        // along the rows, one column at a time
+        for (int x = 0; x < w; x++)
+        {
+            float *out = Jc + (size_t)x * h;
+            scaleArray(out, &tmp[(size_t)reflectIndex(x - rad, w) * h], f[0], h);
+            for (int k = 1; k <= 2 * rad; k++)
+                addScaledArray(out, &tmp[(size_t)reflectIndex(x - rad + k, w) * h], f[k], h);
+        }
+    }
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// gradMag: gradient magnitude M and orientation O of the d planes of I, as
+// vision.internal.acf.gradient before normalization. At every pixel the
+// plane with the largest gradient is used. O is in [0, pi), or [0, 2*pi)
+// if full.
+//////////////////////////////////////////////////////////////////////////////
+// acos(i/ACF_ACOS_STEPS), clamped past [-1, 1]
+inline std::vector<float> buildAcosTable()
+{
+    std::vector<float> t(2 * (ACF_ACOS_STEPS + ACF_ACOS_MARGIN) + 1);
+    for (int i = -ACF_ACOS_STEPS - ACF_ACOS_MARGIN; i <= ACF_ACOS_STEPS + ACF_ACOS_MARGIN; i++)
+    {
+        const double a = std::max(-1.0, std::min(1.0, (double)i / ACF_ACOS_STEPS));
+        t[i + ACF_ACOS_STEPS + ACF_ACOS_MARGIN] = (float)std::acos(a);
+    }
+    return t;
+}
+
+inline const float *acosTable()
+{
+    // built on first use
+    static const std::vector<float> table = buildAcosTable();
+    return &table[ACF_ACOS_STEPS + ACF_ACOS_MARGIN];
+}
+
+// gradient of one column: gx from its neighbors left and right, gy along
+// the column, and the squared magnitude m2
+inline void gradientColumn(const float *col, const float *left,
+    const float *right, float gxScale, int h,
+    float *gx, float *gy, float *m2)
+{
+    if (h > 1)
+    {
+        gy[0] = col[1] - col[0];
+        gy[h - 1] = col[h - 1] - col[h - 2];
+    }
+    else
+    {
+        gy[0] = 0;
+    }
+
+    int y = 1;
+#if CV_SIMD128
+    const cv::v_float32x4 half = cv::v_setall_f32(0.5f);
+    for (; y <= h - 5; y += 4)
+        cv::v_store(gy + y, (cv::v_load(col + y + 1) - cv::v_load(col + y - 1)) * half);
+#endif
+    for (; y < h - 1; y++)
+        gy[y] = (col[y + 1] - col[y - 1]) * 0.5f;
+
+    y = 0;
+#if CV_SIMD128
+    const cv::v_float32x4 s = cv::v_setall_f32(gxScale);
+    for (; y <= h - 4; y += 4)
+    {
+        const cv::v_float32x4 vx = (cv::v_load(right + y) - cv::v_load(left + y)) * s;
+        const cv::v_float32x4 vy = cv::v_load(gy + y);
+        cv::v_store(gx + y, vx);
+        cv::v_store(m2 + y, cv::v_muladd(vx, vx, vy * vy));
+    }
+#endif
+    for (; y < h; y++)
+    {
+        gx[y] = (right[y] - left[y]) * gxScale;
+        m2[y] = gx[y] * gx[y] + gy[y] * gy[y];
+    }
+}
+
+// keeps in (gx, gy, m2) the gradient of the plane of largest magnitude
+inline void keepLargestGradient(const float *gx, const float *gy,
+    const float *m2, int h, float *maxGx, float *maxGy, float *maxM2)
+{
+    int y = 0;
+#if CV_SIMD128
+    for (; y <= h - 4; y += 4)
+    {
+        const cv::v_float32x4 vm2 = cv::v_load(m2 + y), vMax = cv::v_load(maxM2 + y);
+        const cv::v_float32x4 larger = vm2 > vMax;
+        cv::v_store(maxM2 + y, (larger & vm2) | (~larger & vMax));
+        cv::v_store(maxGx + y, (larger & cv::v_load(gx + y)) | (~larger & cv::v_load(maxGx + y)));
+        cv::v_store(maxGy + y, (larger & cv::v_load(gy + y)) | (~larger & cv::v_load(maxGy + y)));
+    }
+#endif
+    for (; y < h; y++)
+    {
+        if (m2[y] > maxM2[y])
+        {
+            maxM2[y] = m2[y];
+            maxGx[y] = gx[y];
+            maxGy[y] = gy[y];
+        }
+    }
+}
+
+inline void gradMag(const float *I, float *M, float *O, int h, int w, int d,
+    bool full)
+{
+    const size_t planeSize = (size_t)h * w;
+    const float *acosT = acosTable();
+    const float pi = (float)CV_PI;
+
+    std::vector<float> buf(6 * (size_t)h);
+    float *gx = &buf[0], *gy = gx + h, *m2 = gy + h;
+    float *maxGx = m2 + h, *maxGy = maxGx + h, *maxM2 = maxGy + h;
+
+    for (int x = 0; x < w; x++)
+    {
+        // one-sided differences on the first and last columns
+        const int xl = std::max(x - 1, 0), xr = std::min(x + 1, w - 1);
+        const float gxScale = (xr - xl == 2) ? 0.5f : 1.0f;
+
+        for (int c = 0; c < d; c++)
+        {
+            const float *plane = I + c * planeSize;
+            if (c == 0)
+            {
+                gradientColumn(plane + (size_t)x * h, plane + (size_t)xl * h,
+                    plane + (size_t)xr * h, gxScale, h, maxGx, maxGy, maxM2);
+            }
+            else
+            {
+                gradientColumn(plane + (size_t)x * h, plane + (size_t)xl * h,
+                    plane + (size_t)xr * h, gxScale, h, gx, gy, m2);
+                keepLargestGradient(gx, gy, m2, h, maxGx, maxGy, maxM2);
+            }
+        }
+
+        float *Mcol = M + (size_t)x * h;
+        int y = 0;
+#if CV_SIMD128
+        for (; y <= h - 4; y += 4)
+            cv::v_store(Mcol + y, cv::v_sqrt(cv::v_load(maxM2 + y)));
+#endif
+        for (; y < h; y++)
+            Mcol[y] = std::sqrt(maxM2[y]);
+
+        // the angle of (gx, gy) folded to [0, pi) is acos(+-gx/m), then
+        // shifted to [pi, 2*pi) for gy < 0 if full
+        float *Ocol = O + (size_t)x * h;
+        for (y = 0; y < h; y++)
+        {
+            const float m = Mcol[y];
+            float cosine = (m > 0) ? maxGx[y] / m : 0.0f;
+            if (maxGy[y] < 0)
+                cosine = -cosine;
+            const int idx = (int)(std::min(std::max(cosine, -1.0f), 1.0f) * ACF_ACOS_STEPS);
+            float o = acosT[idx];
+            if (full && maxGy[y] < 0)
+                o += pi;
+            Ocol[y] = o;
+        }
+    }
+}
+
+// M = M./(convTri(M, radius) + constant)
+inline void normalizeGradMag(float *M, int h, int w, float radius, float constant)
+{
+    if (radius <= 0)
+        return;
+
+    const int n = h * w;
+    std::vector<float> S(n);
+    convTri(M, &S[0], h, w, 1, radius);
+
+    int i = 0;
+#if CV_SIMD128
+    const cv::v_float32x4 vc = cv::v_setall_f32(constant);
+    for (; i <= n - 4; i += 4)
+        cv::v_store(M + i, cv::v_load(M + i) / (cv::v_load(&S[i]) + vc));
+#endif
+    for (; i < n; i++)
+        M[i] = M[i] / (S[i] + constant);
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// gradHist: numBins histograms of the gradient orientations, weighted by
+// magnitude, over bin-by-bin cells, as vision.internal.acf.gradientHist.
+// H receives numBins (h/bin)-by-(w/bin) planes. Each gradient is split
+// between its two nearest orientations if interpolate, else added to the
+// nearest one.
+//////////////////////////////////////////////////////////////////////////////
+inline void gradHist(const float *M, const float *O, float *H, int h, int w,
+    int bin, int numBins, bool interpolate, bool full)
+{
+    const int hb = h / bin, wb = w / bin, h0 = hb * bin;
+    const int nb = hb * wb;
+    std::fill(H, H + (size_t)nb * numBins, 0.0f);
+    if (nb == 0)
+        return;
+
+    const float oMult = (float)(numBins / (full ? 2 * CV_PI : CV_PI));
+    const float norm = 1.0f / (bin * bin);
+
+    // per row of the column: first and second bin offsets and weights
+    std::vector<int> bins(2 * (size_t)h0);
+    std::vector<float> weights(2 * (size_t)h0);
+    int *O0 = &bins[0], *O1 = O0 + h0;
+    float *M0 = &weights[0], *M1 = M0 + h0;
+
+    for (int x = 0; x < wb * bin; x++)
+    {
+        const float *Mcol = M + (size_t)x * h, *Ocol = O + (size_t)x * h;
+
+        int y = 0;
+#if CV_SIMD128
+        const cv::v_float32x4 vMult = cv::v_setall_f32(oMult), vNorm = cv::v_setall_f32(norm);
+        const cv::v_int32x4 vBins = cv::v_setall_s32(numBins), vOne = cv::v_setall_s32(1);
+        const cv::v_int32x4 vStride = cv::v_setall_s32(nb);
+        for (; y <= h0 - 4; y += 4)
+        {
+            const cv::v_float32x4 o = cv::v_load(Ocol + y) * vMult;
+            const cv::v_float32x4 m = cv::v_load(Mcol + y) * vNorm;
+            if (interpolate)
+            {
+                cv::v_int32x4 o0 = cv::v_trunc(o);
+                const cv::v_float32x4 m1 = (o - cv::v_cvt_f32(o0)) * m;
+                o0 = o0 & (o0 < vBins);
+                cv::v_int32x4 o1 = o0 + vOne;
+                o1 = o1 & (o1 < vBins);
+                cv::v_store(O0 + y, o0 * vStride);
+                cv::v_store(O1 + y, o1 * vStride);
+                cv::v_store(M0 + y, m - m1);
+                cv::v_store(M1 + y, m1);
+            }
+            else
+            {
+                cv::v_int32x4 o0 = cv::v_trunc(o + cv::v_setall_f32(0.5f));
+                o0 = o0 & (o0 < vBins);
+                cv::v_store(O0 + y, o0 * vStride);
+                cv::v_store(M0 + y, m);
+            }
+        }
+#endif
+        for (; y < h0; y++)
+        {
+            const float o = Ocol[y] * oMult, m = Mcol[y] * norm;
+            if (interpolate)
+            {
+                int o0 = (int)o;
+                const float m1 = (o - o0) * m;
+                if (o0 >= numBins)
+                    o0 = 0;
+                int o1 = o0 + 1;
+                if (o1 >= numBins)
+                    o1 = 0;
+                O0[y] = o0 * nb;
+                O1[y] = o1 * nb;
+                M0[y] = m - m1;
+                M1[y] = m1;
+            }
+            else
+            {
+                int o0 = (int)(o + 0.5f);
+                if (o0 >= numBins)
+                    o0 = 0;
+                O0[y] = o0 * nb;
+                M0[y] = m;
+            }
+        }
+
+        float *Hx = H + (size_t)(x / bin) * hb;
+        if (interpolate)
+        {
+            for (y = 0; y < h0; y++)
+            {
+                Hx[O0[y] + y / bin] += M0[y];
+                Hx[O1[y] + y / bin] += M1[y];
+            }
+        }
+        else
+        {
+            for (y = 0; y < h0; y++)
+                Hx[O0[y] + y / bin] += M0[y];
+        }
+    }
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// resample: resizes the d planes of A to hb-by-wb and multiplies them by
+// ratio, as visionACFResize. Downsampling averages the area each output
+// pixel covers, upsampling interpolates bilinearly.
+//////////////////////////////////////////////////////////////////////////////
+
+// output i is the sum of weight[k]*input[index[k]], first[i] <= k < first[i+1]
+struct ResampleCoefs
+{
+    std::vector<int> first;
+    std::vector<int> index;
+    std::vector<float> weight;
+};
+
+inline void resampleCoefs(int na, int nb, ResampleCoefs &coefs)
+{
+    const float s = (float)nb / na, sInv = 1 / s;
+    coefs.first.assign(1, 0);
+    coefs.index.clear();
+    coefs.weight.clear();
+
+    for (int i = 0; i < nb; i++)
+    {
+        const size_t start = coefs.index.size();
+        if (na > nb)
+        {
+            const float a0f = i * sInv, a1f = a0f + sInv;
+            const int a0 = (int)std::ceil(a0f), a1 = (int)a1f;
+            float W = 0;
+            for (int a = a0 - 1; a <= a1; a++)
+            {
+                float wt = s;
+                if (a == a0 - 1)
+                    wt = (a0 - a0f) * s;
+                else if (a == a1)
+                    wt = (a1f - a1) * s;
+                if (wt > 1e-3f * s && a >= 0 && a < na)
+                {
+                    coefs.index.push_back(a);
+                    coefs.weight.push_back(wt);
+                    W += wt;
+                }
+            }
+            if (W > 1)
+            {
+                for (size_t k = start; k < coefs.index.size(); k++)
+                    coefs.weight[k] /= W;
+            }
+        }
+        else
+        {
+            const float af = (0.5f + i) * sInv - 0.5f;
+            int a = (int)std::floor(af);
+            float wt = 1;
+            if (a >= 0 && a < na - 1)
+                wt = 1 - (af - a);
+            a = std::min(std::max(a, 0), na - 1);
+            coefs.index.push_back(a);
+            coefs.weight.push_back(wt);
+            if (wt < 1)
+            {
+                coefs.index.push_back(a + 1);
+                coefs.weight.push_back(1 - wt);
+            }
+        }
+        coefs.first.push_back((int)coefs.index.size());
+    }
+}
+
+inline void resample(const float *A, int ha, int wa, float *B, int hb, int wb,
+    int d, float ratio)
+{
+    ResampleCoefs ys, xs;
+    resampleCoefs(ha, hb, ys);
+    resampleCoefs(wa, wb, xs);
+
+    std::vector<float> tmp((size_t)ha * wb);
+    for (int c = 0; c < d; c++)
+    {
+        const float *Ac = A + (size_t)c * ha * wa;
+        float *Bc = B + (size_t)c * hb * wb;
+
+        // across the columns first, whole columns at a time
+        for (int x = 0; x < wb; x++)
+        {
+            float *t = &tmp[(size_t)x * ha];
+            int k = xs.first[x];
+            scaleArray(t, Ac + (size_t)xs.index[k] * ha, ratio * xs.weight[k], ha);
+            for (k++; k < xs.first[x + 1]; k++)
+                addScaledArray(t, Ac + (size_t)xs.index[k] * ha, ratio * xs.weight[k], ha);
+        }
+
+        // then along the columns
+        if (ha == hb)
+        {
+            std::memcpy(Bc, &tmp[0], (size_t)hb * wb * sizeof(float));
+            continue;
+        }
+        for (int x = 0; x < wb; x++)
+        {
+            const float *t = &tmp[(size_t)x * ha];
+            float *b = Bc + (size_t)x * hb;
+            for (int y = 0; y < hb; y++)
+            {
+                float v = 0;
+                for (int k = ys.first[y]; k < ys.first[y + 1]; k++)
+                    v += ys.weight[k] * t[ys.index[k]];
+                b[y] = v;
+            }
+        }
+    }
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// getScales: scales of the pyramid, as computePyramid/getScales. Each scale
+// is adjusted so that the image scaled by it is nearly a multiple of
+// shrink in both dimensions. scalesH and scalesW are the exact ratios of
+// the sizes of the scaled images.
+//////////////////////////////////////////////////////////////////////////////
+inline void getScales(int numPerOctave, int numUpscaledOctaves,
+    double modelHeight, double modelWidth, int shrink, int h, int w,
+    std::vector<double> &scales, std::vector<double> &scalesH,
+    std::vector<double> &scalesW)
+{
+    scales.clear();
+    scalesH.clear();
+    scalesW.clear();
+    if (h == 0 || w == 0 || numPerOctave <= 0)
+        return;
+
+    const int numScales = (int)std::floor(numPerOctave * (numUpscaledOctaves +
+        std::log(std::min(h / modelHeight, w / modelWidth)) / std::log(2.0)) + 1);
+    const double d0 = std::min(h, w), d1 = std::max(h, w);
+
+    std::vector<double> candidates;
+    for (int i = 0; i < numScales; i++)
+    {
+        const double s = std::pow(2.0, -(double)i / numPerOctave + numUpscaledOctaves);
+        const double base = acfRound(d0 * s / shrink) * shrink;
+        const double s0 = (base - 0.25 * shrink) / d0, s1 = (base + 0.25 * shrink) / d0;
+
+        // the scale in [s0, s1) of the smallest rounding error
+        double bestErr = DBL_MAX, best = s0;
+        for (int j = 0; j < 100; j++)
+        {
+            const double ss = j * 0.01 * (s1 - s0) + s0;
+            const double e0 = std::abs(d0 * ss - acfRound(d0 * ss / shrink) * shrink);
+            const double e1 = std::abs(d1 * ss - acfRound(d1 * ss / shrink) * shrink);
+            const double err = std::max(e0, e1);
+            if (err < bestErr)
+            {
+                bestErr = err;
+                best = ss;
+            }
+        }
+        candidates.push_back(best);
+    }
+
+    for (int i = 0; i < numScales; i++)
+    {
+        if (i + 1 < numScales && candidates[i] == candidates[i + 1])
+            continue;
+        const double s = candidates[i];
+        scales.push_back(s);
+        scalesH.push_back(acfRound(h * s / shrink) * shrink / h);
+        scalesW.push_back(acfRound(w * s / shrink) * shrink / w);
+    }
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// AcfDetector
+//////////////////////////////////////////////////////////////////////////////
+class AcfDetector
+{
+public:
+    AcfDetector() : mNumNodes(0), mNumTrees(0), mTreeDepth(0), mMaxFid(0) {}
+
+    void setParams(const AcfParams &params)
+    {
+        mParams = params;
+    }
+
+    // Boosted trees, numNodes-by-numTrees column major, see
+    // trainBoostTreeClassifier. fids are 0-based features and child the
+    // 1-based node of the left child, 0 at the leaves. treeDepth is the
+    // depth of all leaves, 0 if it varies.
+    void setClassifier(const uint32_T *fids, const float *thrs,
+        const uint32_T *child, const float *hs, int numNodes, int numTrees,
+        int treeDepth)
+    {
+        const size_t n = (size_t)numNodes * numTrees;
+        mFids.assign(fids, fids + n);
+        mThrs.assign(thrs, thrs + n);
+        mChild.assign(child, child + n);
+        mHs.assign(hs, hs + n);
+        mNumNodes = numNodes;
+        mNumTrees = numTrees;
+        // the depth-2 path needs the 7 nodes of complete trees
+        mTreeDepth = (treeDepth == 2 && numNodes < 7) ? 0 : treeDepth;
+        mMaxFid = n ? *std::max_element(mFids.begin(), mFids.end()) : 0;
+    }
+
+    // Channel pyramid of the height-by-width single image I in [0, 1],
+    // RGB or grayscale, column major. The padded and smoothed channels of
+    // scale i are getChannels(i).
+    void computePyramid(const float *I, int height, int width, bool isRGB,
+        const AcfDetectParams &detectParams)
+    {
+        const AcfParams &p = mParams;
+        const int numPixels = height * width;
+
+        mLuv.resize(3 * (size_t)numPixels + 1);
+        rgbToLuv(I, numPixels, isRGB, &mLuv[0]);
+
+        getScales(detectParams.numScaleLevels, p.numUpscaledOctaves,
+            p.modelHeight, p.modelWidth, p.shrink, height, width,
+            mScales, mScalesH, mScalesW);
+        selectScales(detectParams);
+
+        const int numScales = (int)mScales.size();
+        mChannels.resize(numScales);
+        mLevels.resize(numScales);
+        if (numScales == 0)
+            return;
+
+        // computed scales and the nearest computed scale of all scales,
+        // with the ties going to the smaller scale
+        std::vector<int> computed, reference(numScales);
+        for (int i = 0; i < numScales; i += p.numApprox + 1)
+            computed.push_back(i);
+        for (size_t k = 0; k < computed.size(); k++)
+        {
+            const int first = (k == 0) ? 0 : (computed[k - 1] + computed[k] + 2) / 2;
+            const int last = (k + 1 == computed.size()) ? numScales :
+                (computed[k] + computed[k + 1] + 2) / 2;
+            for (int i = first; i < last; i++)
+                reference[i] = computed[k];
+        }
+
+        std::vector<int> approximated;
+        for (int i = 0; i < numScales; i++)
+        {
+            if (i % (p.numApprox + 1) != 0)
+                approximated.push_back(i);
+        }
+
+#ifdef PARALLEL
+        cgParallelForWorkers((int)computed.size(), [&](int, int k) {
+            computeChannels(height, width, mScales[computed[k]], mChannels[computed[k]]);
+        });
+        cgParallelForWorkers((int)approximated.size(), [&](int, int k) {
+            approximateLevel(approximated[k], reference[approximated[k]], height, width);
+        });
+        cgParallelForWorkers(numScales, [&](int, int i) {
+            smoothAndPad(mChannels[i], mLevels[i]);
+        });
+#else
+        for (size_t k = 0; k < computed.size(); k++)
+            computeChannels(height, width, mScales[computed[k]], mChannels[computed[k]]);
+        for (size_t k = 0; k < approximated.size(); k++)
+            approximateLevel(approximated[k], reference[approximated[k]], height, width);
+        for (int i = 0; i < numScales; i++)
+            smoothAndPad(mChannels[i], mLevels[i]);
+#endif
+    }
+
+    int getNumScales() const { return (int)mLevels.size(); }
+    const AcfChannels &getChannels(int i) const { return mLevels[i]; }
+    double getScale(int i) const { return mScales[i]; }
+
+    // Detections of the trees on the pyramid of I, as
+    // vision.internal.acf.detect: [x y width height] boxes and scores
+    void detect(const float *I, int height, int width, bool isRGB,
+        const AcfDetectParams &detectParams, std::vector<cv::Rect2d> &bboxes,
+        std::vector<double> &scores)
+    {
+        bboxes.clear();
+        scores.clear();
+
+        computePyramid(I, height, width, isRGB, detectParams);
+
+        std::vector<AcfWindow> windows;
+        classifyWindows(detectParams, windows);
+        bboxes.resize(windows.size());
+        scores.resize(windows.size());
+        for (size_t k = 0; k < windows.size(); k++)
+        {
+            bboxes[k] = getWindowBox(windows[k], detectParams.windowStride);
+            scores[k] = windows[k].score;
+        }
+    }
+
+    // Windows of the pyramid of I scoring above the threshold, in the
+    // order of the boxes of detect. The pyramid is kept for the boxes and
+    // features of the windows.
+    void detectWindows(const float *I, int height, int width, bool isRGB,
+        const AcfDetectParams &detectParams, std::vector<AcfWindow> &windows)
+    {
+        windows.clear();
+        computePyramid(I, height, width, isRGB, detectParams);
+        classifyWindows(detectParams, windows);
+    }
+
+    // Box of a window in the image, shifted by the padding of the model and
+    // of the channels, as vision.internal.acf.detect
+    cv::Rect2d getWindowBox(const AcfWindow &window, int windowStride) const
+    {
+        const AcfParams &p = mParams;
+        const int stride = std::max(windowStride, 1), i = window.level;
+        const double shiftY = (p.modelHeightPadded - p.modelHeight) / 2.0 - p.padRows;
+        const double shiftX = (p.modelWidthPadded - p.modelWidth) / 2.0 - p.padCols;
+        return cv::Rect2d((window.column * stride + shiftX) / mScalesW[i],
+            (window.row * stride + shiftY) / mScalesH[i],
+            p.modelWidth / mScales[i], p.modelHeight / mScales[i]);
+    }
+
+    // Number of features of a window: the padded model in cells times the
+    // number of channels
+    int getNumFeatures() const
+    {
+        const AcfParams &p = mParams;
+        return (p.modelHeightPadded / p.shrink) * (p.modelWidthPadded / p.shrink) *
+            (4 + p.numBins);
+    }
+
+    // Features of a window in the order of the fids of the trees, column
+    // major cells of one channel after the other
+    void getWindowFeatures(const AcfWindow &window, int windowStride,
+        float *features) const
+    {
+        const AcfParams &p = mParams;
+        const AcfChannels &chns = mLevels[window.level];
+        const int stride = std::max(windowStride, 1);
+        const int hc = p.modelHeightPadded / p.shrink, wc = p.modelWidthPadded / p.shrink;
+        const int y0 = window.row * stride / p.shrink, x0 = window.column * stride / p.shrink;
+        for (int z = 0; z < chns.numChannels; z++)
+        {
+            for (int x = 0; x < wc; x++)
+            {
+                std::memcpy(features, chns.channel(z) + (size_t)(x0 + x) * chns.height + y0,
+                    hc * sizeof(float));
+                features += hc;
+            }
+        }
+    }
+
+private:
+    struct Task
+    {
+        int level;
+        int firstColumn;
+        int lastColumn;
+    };
+
+    // keeps the scales whose object size is within [minSize, maxSize], or
+    // the two scales around the range if none is
+    void selectScales(const AcfDetectParams &dp)
+    {
+        const int numScales = (int)mScales.size();
+        const double mh = acfRound((double)mParams.modelHeight);
+        const double mw = acfRound((double)mParams.modelWidth);
+
+        std::vector<bool> belowMax(numScales), aboveMin(numScales), keep(numScales);
+        bool any = false;
+        for (int i = 0; i < numScales; i++)
+        {
+            const double sh = (i == 0) ? mh : std::floor(mh / mScales[i]);
+            const double sw = (i == 0) ? mw : std::floor(mw / mScales[i]);
+            belowMax[i] = sh <= dp.maxHeight && sw <= dp.maxWidth;
+            aboveMin[i] = sh >= dp.minHeight && sw >= dp.minWidth;
+            keep[i] = belowMax[i] && aboveMin[i];
+            any = any || keep[i];
+        }
+
+        if (!any)
+        {
+            int lastBelowMax = -1, firstAboveMin = -1;
+            for (int i = 0; i < numScales; i++)
+            {
+                if (belowMax[i])
+                    lastBelowMax = i;
+                if (aboveMin[i] && firstAboveMin < 0)
+                    firstAboveMin = i;
+            }
+            if (lastBelowMax >= 0 && firstAboveMin >= 0)
+                keep[lastBelowMax] = keep[firstAboveMin] = true;
+        }
+
+        int n = 0;
+        for (int i = 0; i < numScales; i++)
+        {
+            if (keep[i])
+            {
+                mScales[n] = mScales[i];
+                mScalesH[n] = mScalesH[i];
+                mScalesW[n] = mScalesW[i];
+                n++;
+            }
+        }
+        mScales.resize(n);
+        mScalesH.resize(n);
+        mScalesW.resize(n);
+    }
+
+    // channels of the LUV image scaled by s, as computeChannels.m
+    void computeChannels(int height, int width, double s, AcfChannels &out) const
+    {
+        const AcfParams &p = mParams;
+        const int shrink = p.shrink;
+        const int hs = (int)acfRound(height * s / shrink) * shrink;
+        const int ws = (int)acfRound(width * s / shrink) * shrink;
+        const size_t planeSize = (size_t)hs * ws;
+
+        std::vector<float> luv(3 * planeSize), M(planeSize), O(planeSize);
+        if (hs == height && ws == width)
+            std::memcpy(&luv[0], &mLuv[0], 3 * planeSize * sizeof(float));
+        else
+            resample(&mLuv[0], height, width, &luv[0], hs, ws, 3, 1.0f);
+
+        convTri(&luv[0], &luv[0], hs, ws, 3, p.preSmoothColor);
+        gradMag(&luv[0], &M[0], &O[0], hs, ws, 3, p.fullOrientation);
+        normalizeGradMag(&M[0], hs, ws, p.normalizationRadius, p.normalizationConstant);
+
+        const int hc = hs / shrink, wc = ws / shrink;
+        out.create(hc, wc, 4 + p.numBins);
+        resample(&luv[0], hs, ws, out.channel(0), hc, wc, 3, 1.0f);
+        resample(&M[0], hs, ws, out.channel(3), hc, wc, 1, 1.0f);
+
+        const int bin = p.cellSize;
+        if (hs / bin == hc && ws / bin == wc)
+        {
+            gradHist(&M[0], &O[0], out.channel(4), hs, ws, bin, p.numBins,
+                p.interpolateOrientation, p.fullOrientation);
+        }
+        else
+        {
+            const int hh = hs / bin, wh = ws / bin;
+            std::vector<float> H((size_t)hh * wh * p.numBins + 1);
+            gradHist(&M[0], &O[0], &H[0], hs, ws, bin, p.numBins,
+                p.interpolateOrientation, p.fullOrientation);
+            resample(&H[0], hh, wh, out.channel(4), hc, wc, p.numBins, 1.0f);
+        }
+    }
+
+    // channels of scale i approximated from those of the computed scale ref
+    void approximateLevel(int i, int ref, int height, int width)
+    {
+        approximateChannels(mChannels[ref], height, width,
+            mScales[i] / mScales[ref], mScales[i], mChannels[i]);
+    }
+
+    // channels at scale s resampled from those of a computed scale,
+    // ratio = s/sRef
+    void approximateChannels(const AcfChannels &ref, int height, int width,
+        double ratio, double s, AcfChannels &out) const
+    {
+        const AcfParams &p = mParams;
+        const int hc = (int)acfRound(height * s / p.shrink);
+        const int wc = (int)acfRound(width * s / p.shrink);
+        out.create(hc, wc, ref.numChannels);
+
+        const int first[3] = { 0, 3, 4 };
+        const int count[3] = { 3, 1, p.numBins };
+        for (int t = 0; t < 3; t++)
+        {
+            const float r = (float)std::pow(ratio, -(double)p.lambdas[t]);
+            resample(ref.channel(first[t]), ref.height, ref.width,
+                out.channel(first[t]), hc, wc, count[t], r);
+        }
+    }
+
+    // smooths the channels and pads them with zeros for the windows on
+    // the border
+    void smoothAndPad(AcfChannels &channels, AcfChannels &out) const
+    {
+        const AcfParams &p = mParams;
+        const int h = channels.height, w = channels.width, d = channels.numChannels;
+        convTri(channels.channel(0), channels.channel(0), h, w, d, p.smoothChannels);
+
+        const int pr = p.padRows / p.shrink, pc = p.padCols / p.shrink;
+        const int ho = h + 2 * pr, wo = w + 2 * pc;
+        out.create(ho, wo, d);
+        std::fill(out.data.begin(), out.data.end(), 0.0f);
+        for (int c = 0; c < d; c++)
+        {
+            for (int x = 0; x < w; x++)
+            {
+                std::memcpy(out.channel(c) + (size_t)(x + pc) * ho + pr,
+                    channels.channel(c) + (size_t)x * h, h * sizeof(float));
+            }
+        }
+    }
+
+    // soft cascade of the trees on the window at chns
+    float classifyWindow(const float *chns, const uint32_T *cids,
+        float threshold) const
+    {
+        const uint32_T *fids = &mFids[0], *child = &mChild[0];
+        const float *thrs = &mThrs[0], *hs = &mHs[0];
+        float h = 0;
+
+        if (mTreeDepth == 2)
+        {
+            // complete trees, in breadth first order
+            for (int t = 0; t < mNumTrees; t++)
+            {
+                const uint32_T offset = (uint32_T)t * mNumNodes;
+                uint32_T k = (chns[cids[fids[offset]]] < thrs[offset]) ? 1 : 2;
+                k = 2 * k + ((chns[cids[fids[offset + k]]] < thrs[offset + k]) ? 1 : 2);
+                h += hs[offset + k];
+                if (h <= threshold)
+                    break;
+            }
+        }
+        else
+        {
+            for (int t = 0; t < mNumTrees; t++)
+            {
+                const uint32_T offset = (uint32_T)t * mNumNodes;
+                uint32_T k = offset;
+                while (child[k])
+                {
+                    const uint32_T left = (chns[cids[fids[k]]] < thrs[k]) ? 1 : 0;
+                    k = child[k] - left + offset;
+                }
+                h += hs[k];
+                if (h <= threshold)
+                    break;
+            }
+        }
+        return h;
+    }
+
+    // windows of the columns of task, of numRows rows, above the threshold;
+    // cids are the features of a window
+    void classifyTask(const Task &task, const uint32_T *cids, int numRows,
+        int stride, float threshold, std::vector<AcfWindow> &found) const
+    {
+        const int shrink = mParams.shrink;
+        const AcfChannels &chns = mLevels[task.level];
+        for (int col = task.firstColumn; col < task.lastColumn; col++)
+        {
+            for (int row = 0; row < numRows; row++)
+            {
+                const float *window = chns.channel(0) +
+                    (size_t)(col * stride / shrink) * chns.height + row * stride / shrink;
+                const float h = classifyWindow(window, cids, threshold);
+                if (h > threshold)
+                {
+                    AcfWindow det = { task.level, row, col, h };
+                    found.push_back(det);
+                }
+            }
+        }
+    }
+
+    // windows above the threshold, level by level and column by column
+    void classifyWindows(const AcfDetectParams &dp,
+        std::vector<AcfWindow> &windows) const
+    {
+        const AcfParams &p = mParams;
+        const int shrink = p.shrink, stride = std::max(dp.windowStride, 1);
+        const int modelH = p.modelHeightPadded, modelW = p.modelWidthPadded;
+        const int numLevels = (int)mLevels.size();
+        if (mNumTrees == 0 || modelH < shrink || modelW < shrink)
+            return;
+
+        // features of a window, as offsets from its top left corner, and
+        // the blocks of columns of windows of every level
+        std::vector<std::vector<uint32_T> > cids(numLevels);
+        std::vector<int> numRows(numLevels, 0);
+        std::vector<Task> tasks;
+        for (int i = 0; i < numLevels; i++)
+        {
+            const AcfChannels &chns = mLevels[i];
+            const int rows = (int)std::ceil((double)(chns.height * shrink - modelH + 1) / stride);
+            const int cols = (int)std::ceil((double)(chns.width * shrink - modelW + 1) / stride);
+            const size_t numFtrs = (size_t)(modelH / shrink) * (modelW / shrink) * chns.numChannels;
+            if (rows <= 0 || cols <= 0 || mMaxFid >= numFtrs)
+                continue;
+
+            std::vector<uint32_T> &c = cids[i];
+            c.reserve(numFtrs);
+            for (int z = 0; z < chns.numChannels; z++)
+                for (int x = 0; x < modelW / shrink; x++)
+                    for (int y = 0; y < modelH / shrink; y++)
+                        c.push_back((uint32_T)(((size_t)z * chns.width + x) * chns.height + y));
+
+            numRows[i] = rows;
+            for (int c0 = 0; c0 < cols; c0 += ACF_BLOCK_COLUMNS)
+            {
+                Task task = { i, c0, std::min(c0 + ACF_BLOCK_COLUMNS, cols) };
+                tasks.push_back(task);
+            }
+        }
+
+        std::vector<std::vector<AcfWindow> > found(tasks.size());
+#ifdef PARALLEL
+        cgParallelForWorkers((int)tasks.size(), [&](int, int t) {
+            classifyTask(tasks[t], &cids[tasks[t].level][0], numRows[tasks[t].level],
+                stride, dp.threshold, found[t]);
+        });
+#else
+        for (size_t t = 0; t < tasks.size(); t++)
+            classifyTask(tasks[t], &cids[tasks[t].level][0], numRows[tasks[t].level],
+                stride, dp.threshold, found[t]);
+#endif
+
+        for (size_t t = 0; t < tasks.size(); t++)
+            windows.insert(windows.end(), found[t].begin(), found[t].end());
+    }
+
+    AcfParams mParams;
+
+    // trees
+    std::vector<uint32_T> mFids;
+    std::vector<float> mThrs;
+    std::vector<uint32_T> mChild;
+    std::vector<float> mHs;
+    int mNumNodes;
+    int mNumTrees;
+    int mTreeDepth;
+    uint32_T mMaxFid;
+
+    // pyramid of the last image, kept to reuse the buffers
+    std::vector<float> mLuv;
+    std::vector<double> mScales;
+    std::vector<double> mScalesH;
+    std::vector<double> mScalesW;
+    std::vector<AcfChannels> mChannels;
+    std::vector<AcfChannels> mLevels;
+
+    // copying and assignment are disallowed
+    AcfDetector(const AcfDetector &);
+    AcfDetector &operator=(const AcfDetector &);
+};
+
+} // namespace acf
+
+#endif // ACF_DETECTOR
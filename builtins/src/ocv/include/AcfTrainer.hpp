@@ -0,0 +1,647 @@
+//////////////////////////////////////////////////////////////////////////////
+// Boosted decision trees of aggregate channel features, as
+// trainACFObjectDetector trains them with
+// vision.internal.acf.trainBoostTreeClassifier and
+// trainBinaryTreeClassifier, with the hard negatives of every stage mined
+// by the trees of the previous stage.
+//
+// The features of the samples are kept as single, one sample after the
+// other. At every stage they are quantized to 256 bins per feature and
+// stored column major, one feature after the other, so the histograms of
+// the split search read contiguous uint8 columns. The candidate features of
+// a node are searched in parallel in blocks of features; the best split is
+// the first one of the smallest error, as min, so the trees do not depend on
+// the number of threads. The trees of discrete AdaBoost then evaluate the
+// samples in parallel on their quantized features [Appel 2013].
+//
+// Hard negatives are the highest scoring windows of AcfDetector on the
+// negative images that do not overlap the ground truth, with the features
+// of the window read from the channel pyramid.
+//
+// References
+// [Appel 2013] R. Appel, T. Fuchs, P. Dollar and P. Perona, "Quickly
+//   Boosting Decision Trees - Pruning Underachieving Features Early",
+//   ICML 2013.
+//
+// Copyright 2016 The MathWorks, Inc.
+//
+//////////////////////////////////////////////////////////////////////////////
+#ifndef ACF_TRAINER
+#define ACF_TRAINER
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include <vector>
+
+#include "AcfDetector.hpp"
+
+namespace acf
+{
+
+// Quantization of the features
+const int ACF_NUM_BINS = 256;
+
+// Features of one task of the split search and samples of one task of the
+// tree evaluation
+const int ACF_FEATURE_BLOCK = 64;
+const int ACF_SAMPLE_BLOCK = 4096;
+
+// Options of a stage, see trainACFObjectDetector
+struct AcfBoostParams
+{
+    AcfBoostParams() : numWeak(2048), maxDepth(2), fracFeatures(1.0f),
+        minWeight(0.01f), calibration(0.005f), numNegatives(INT_MAX) {}
+
+    // MaxWeakLearners of the stage, MaxTreeDepth and FracFeatures
+    int numWeak;
+    int maxDepth;
+    float fracFeatures;
+
+    // nodes lighter than minWeight are not split
+    float minWeight;
+
+    // CalibrationValue, added to the outputs of the trees
+    float calibration;
+
+    // NumNegativeSamples, the accumulated negatives kept for the stage
+    int numNegatives;
+};
+
+// Node of a tree, in breadth first order. child is the 1-based node of the
+// left child, the right child follows it, and 0 at the leaves.
+struct AcfTreeNode
+{
+    uint32_T fid;
+    float thr;
+    int bin;
+    uint32_T child;
+    float hs;
+    float weight;
+    uint32_T depth;
+};
+
+typedef std::vector<AcfTreeNode> AcfTree;
+
+//////////////////////////////////////////////////////////////////////////////
+// AcfTrainer
+//////////////////////////////////////////////////////////////////////////////
+class AcfTrainer
+{
+public:
+    AcfTrainer() : mNumFeatures(0), mNumSamples(0), mNumNodes(0),
+        mTreeDepth(0), mRng(0) {}
+
+    void setParams(const AcfParams &params)
+    {
+        mDetector.setParams(params);
+        mNumFeatures = mDetector.getNumFeatures();
+    }
+
+    int getNumFeatures() const { return mNumFeatures; }
+    int getNumPositives() const { return numRows(mPositives); }
+    int getNumNegatives() const { return numRows(mNegatives); }
+
+    // numSamples-by-numFeatures features of the positive instances, as
+    // computeSingleScaleChannels returns them. Features of another size
+    // than getNumFeatures are ignored.
+    void addPositives(const float *X, int numSamples, int numFeatures,
+        bool isRowMajor)
+    {
+        appendRows(X, numSamples, numFeatures, isRowMajor, mPositives);
+    }
+
+    // negatives that were not mined, such as those of the first stage
+    void addNegatives(const float *X, int numSamples, int numFeatures,
+        bool isRowMajor)
+    {
+        appendRows(X, numSamples, numFeatures, isRowMajor, mNegatives);
+    }
+
+    // Adds the maxPerImage highest scoring windows of the trees of the last
+    // stage on the image I, as the detector of detect. Windows overlapping
+    // a box of gt by 0.1 or more are discarded, as in sampleWindows.
+    // Returns the number of negatives added.
+    int mineNegatives(const float *I, int height, int width, bool isRGB,
+        const std::vector<cv::Rect2d> &gt, const AcfDetectParams &detectParams,
+        int maxPerImage)
+    {
+        if (mTrees.empty() || mNumFeatures == 0)
+            return 0;
+
+        std::vector<AcfWindow> windows;
+        mDetector.detectWindows(I, height, width, isRGB, detectParams, windows);
+
+        // highest scores first, ties in the order of the detections
+        std::vector<int> order(windows.size());
+        for (size_t k = 0; k < order.size(); k++)
+            order[k] = (int)k;
+        std::stable_sort(order.begin(), order.end(), ScoreGreater(windows));
+        order.resize(std::min((int)order.size(), std::max(maxPerImage, 0)));
+
+        int numAdded = 0;
+        for (size_t k = 0; k < order.size(); k++)
+        {
+            const AcfWindow &window = windows[order[k]];
+            const cv::Rect2d box = mDetector.getWindowBox(window, detectParams.windowStride);
+            bool keep = true;
+            for (size_t j = 0; j < gt.size() && keep; j++)
+                keep = overlapRatio(box, gt[j]) < 0.1;
+            if (!keep)
+                continue;
+
+            const size_t offset = mNegatives.size();
+            mNegatives.resize(offset + mNumFeatures);
+            mDetector.getWindowFeatures(window, detectParams.windowStride,
+                &mNegatives[offset]);
+            numAdded++;
+        }
+        return numAdded;
+    }
+
+    // Trains the trees of the next stage on the positives and the
+    // accumulated negatives, as trainBoostTreeClassifier, and uses them to
+    // mine the negatives of the following stage. Returns the number of
+    // trees, which can be less than numWeak.
+    int trainStage(const AcfBoostParams &bp)
+    {
+        mTrees.clear();
+        mNumNodes = 0;
+        mTreeDepth = 0;
+
+        sampleNegatives(bp.numNegatives);
+        const int N0 = getNumNegatives(), N1 = getNumPositives();
+        if (N0 == 0 || N1 == 0)
+        {
+            mDetector.setClassifier(NULL, NULL, NULL, NULL, 0, 0, 0);
+            return 0;
+        }
+        quantize();
+
+        // cumulative scores and weights, negatives then positives
+        const int N = N0 + N1;
+        std::vector<double> H(N, 0.0), W(N), h(N);
+        std::fill(W.begin(), W.begin() + N0, 1.0 / N0);
+        std::fill(W.begin() + N0, W.end(), 1.0 / N1);
+
+        for (int i = 0; i < bp.numWeak; i++)
+        {
+            AcfTree tree;
+            const double err = trainTree(W, bp, tree);
+
+            for (size_t k = 0; k < tree.size(); k++)
+                tree[k].hs = (tree[k].hs > 0) ? 1.0f : -1.0f;
+            evaluateTree(tree, h);
+
+            const double alpha = std::max(-5.0, std::min(5.0, 0.5 * std::log((1 - err) / err)));
+            if (alpha <= 0)
+                break;
+
+            for (size_t k = 0; k < tree.size(); k++)
+                tree[k].hs = (float)(tree[k].hs * alpha);
+
+            double loss = 0;
+            for (int j = 0; j < N; j++)
+            {
+                H[j] += h[j] * alpha;
+                W[j] = (j < N0) ? std::exp(H[j]) / N0 / 2 : std::exp(-H[j]) / N1 / 2;
+                loss += W[j];
+            }
+            mTrees.push_back(tree);
+
+            if (loss < 1e-40)
+                break;
+        }
+
+        // calibrated trees of the detector mining the next negatives
+        for (size_t t = 0; t < mTrees.size(); t++)
+        {
+            for (size_t k = 0; k < mTrees[t].size(); k++)
+                mTrees[t][k].hs += bp.calibration;
+            mNumNodes = std::max(mNumNodes, (int)mTrees[t].size());
+        }
+        setTreeDepth();
+
+        const size_t n = (size_t)mNumNodes * mTrees.size() + 1; // never empty
+        std::vector<uint32_T> fids(n), child(n), depth(n);
+        std::vector<float> thrs(n), hs(n), weights(n);
+        getClassifier(&fids[0], &thrs[0], &child[0], &hs[0], &weights[0],
+            &depth[0], false);
+        mDetector.setClassifier(&fids[0], &thrs[0], &child[0], &hs[0],
+            mNumNodes, (int)mTrees.size(), mTreeDepth);
+
+        return (int)mTrees.size();
+    }
+
+    int getNumTrees() const { return (int)mTrees.size(); }
+    int getNumNodes() const { return mNumNodes; }
+    int getTreeDepth() const { return mTreeDepth; }
+
+    // Trees of the last stage, numNodes-by-numTrees, as the fields of the
+    // model of trainBoostTreeClassifier. Missing nodes are zeros.
+    void getClassifier(uint32_T *fids, float *thrs, uint32_T *child,
+        float *hs, float *weights, uint32_T *depth, bool isRowMajor) const
+    {
+        const int K = mNumNodes, T = (int)mTrees.size();
+        const size_t n = (size_t)K * T;
+        std::fill(fids, fids + n, 0);
+        std::fill(thrs, thrs + n, 0.0f);
+        std::fill(child, child + n, 0);
+        std::fill(hs, hs + n, 0.0f);
+        std::fill(weights, weights + n, 0.0f);
+        std::fill(depth, depth + n, 0);
+        for (int t = 0; t < T; t++)
+        {
+            for (size_t k = 0; k < mTrees[t].size(); k++)
+            {
+                const size_t i = isRowMajor ? k * T + t : (size_t)t * K + k;
+                const AcfTreeNode &node = mTrees[t][k];
+                fids[i] = node.fid;
+                thrs[i] = node.thr;
+                child[i] = node.child;
+                hs[i] = node.hs;
+                weights[i] = node.weight;
+                depth[i] = node.depth;
+            }
+        }
+    }
+
+private:
+    // orders window indices by decreasing score
+    struct ScoreGreater
+    {
+        const std::vector<AcfWindow> &windows;
+        explicit ScoreGreater(const std::vector<AcfWindow> &w) : windows(w) {}
+        bool operator()(int a, int b) const
+        {
+            return windows[a].score > windows[b].score;
+        }
+    };
+
+    int numRows(const std::vector<float> &X) const
+    {
+        return mNumFeatures ? (int)(X.size() / mNumFeatures) : 0;
+    }
+
+    void appendRows(const float *X, int numSamples, int numFeatures,
+        bool isRowMajor, std::vector<float> &rows)
+    {
+        if (numFeatures != mNumFeatures || numSamples <= 0)
+            return;
+
+        const size_t offset = rows.size();
+        rows.resize(offset + (size_t)numSamples * numFeatures);
+        float *dst = &rows[offset];
+        if (isRowMajor)
+        {
+            std::copy(X, X + (size_t)numSamples * numFeatures, dst);
+            return;
+        }
+        for (int i = 0; i < numSamples; i++)
+            for (int f = 0; f < numFeatures; f++)
+                dst[(size_t)i * numFeatures + f] = X[(size_t)f * numSamples + i];
+    }
+
+    // bboxOverlapRatio with the 'Union' ratio
+    static double overlapRatio(const cv::Rect2d &a, const cv::Rect2d &b)
+    {
+        const double w = std::min(a.x + a.width, b.x + b.width) - std::max(a.x, b.x);
+        const double h = std::min(a.y + a.height, b.y + b.height) - std::max(a.y, b.y);
+        if (w <= 0 || h <= 0)
+            return 0;
+        const double intersection = w * h;
+        return intersection / (a.width * a.height + b.width * b.height - intersection);
+    }
+
+    // keeps numNegatives of the accumulated negatives at random, in their
+    // order
+    void sampleNegatives(int numNegatives)
+    {
+        const int n = getNumNegatives();
+        if (n <= numNegatives || numNegatives < 0)
+            return;
+
+        std::vector<int> index(n);
+        for (int i = 0; i < n; i++)
+            index[i] = i;
+        for (int i = 0; i < numNegatives; i++)
+            std::swap(index[i], index[i + mRng.uniform(0, n - i)]);
+        std::sort(index.begin(), index.begin() + numNegatives);
+
+        for (int i = 0; i < numNegatives; i++)
+        {
+            std::copy(mNegatives.begin() + (size_t)index[i] * mNumFeatures,
+                mNegatives.begin() + (size_t)(index[i] + 1) * mNumFeatures,
+                mNegatives.begin() + (size_t)i * mNumFeatures);
+        }
+        mNegatives.resize((size_t)numNegatives * mNumFeatures);
+    }
+
+    // 256 bins between the extrema of every feature, one column of the
+    // negatives then the positives per feature
+    void quantize()
+    {
+        const int N0 = getNumNegatives(), N1 = getNumPositives(), F = mNumFeatures;
+        const int N = N0 + N1;
+        mNumSamples = N;
+        mBins.resize((size_t)N * F);
+        mXMin.resize(F);
+        mXStep.resize(F);
+
+        const int numBlocks = (F + ACF_FEATURE_BLOCK - 1) / ACF_FEATURE_BLOCK;
+#ifdef PARALLEL
+        cgParallelForWorkers(numBlocks, [&](int, int b) {
+            quantizeBlock(b);
+        });
+#else
+        for (int b = 0; b < numBlocks; b++)
+            quantizeBlock(b);
+#endif
+    }
+
+    // bins of the features of block b
+    void quantizeBlock(int b)
+    {
+        const int N0 = getNumNegatives(), N = mNumSamples, F = mNumFeatures;
+        const int f1 = std::min(F, (b + 1) * ACF_FEATURE_BLOCK);
+        for (int f = b * ACF_FEATURE_BLOCK; f < f1; f++)
+        {
+            float xMin = FLT_MAX, xMax = -FLT_MAX;
+            for (int i = 0; i < N; i++)
+            {
+                const float x = sample(i, N0)[f];
+                xMin = std::min(xMin, x);
+                xMax = std::max(xMax, x);
+            }
+            xMin -= 0.01f;
+            xMax += 0.01f;
+            const float xStep = (xMax - xMin) / (ACF_NUM_BINS - 1);
+            const float scale = 1 / xStep;
+            mXMin[f] = xMin;
+            mXStep[f] = xStep;
+
+            uint8_T *column = &mBins[(size_t)f * N];
+            for (int i = 0; i < N; i++)
+            {
+                // rounds half away from zero and saturates, as uint8
+                const float v = (sample(i, N0)[f] - xMin) * scale;
+                column[i] = (v >= ACF_NUM_BINS - 1) ? (uint8_T)(ACF_NUM_BINS - 1) :
+                    (uint8_T)(v + 0.5f);
+            }
+        }
+    }
+
+    const float *sample(int i, int N0) const
+    {
+        return (i < N0) ? &mNegatives[(size_t)i * mNumFeatures] :
+            &mPositives[(size_t)(i - N0) * mNumFeatures];
+    }
+
+    // Decision tree of the samples weighted by W, as
+    // trainBinaryTreeClassifier. Returns the training error.
+    double trainTree(const std::vector<double> &W, const AcfBoostParams &bp,
+        AcfTree &tree)
+    {
+        const int N = mNumSamples, N0 = getNumNegatives(), F = mNumFeatures;
+        const double total = std::accumulate(W.begin(), W.end(), 0.0);
+        const double norm = (std::abs(total - 1) > 1e-3) ? total : 1.0;
+
+        // samples of the nodes still to split, negatives first
+        std::vector<std::vector<int> > samples(1);
+        samples[0].resize(N);
+        for (int i = 0; i < N; i++)
+            samples[0][i] = i;
+
+        std::vector<int> fids(F);
+        std::vector<float> errs, w;
+        std::vector<int> thrs;
+        double err = 0;
+
+        AcfTreeNode root = { 0, 0.0f, 0, 0, 0.0f, 0.0f, 0 };
+        tree.assign(1, root);
+        for (size_t k = 0; k < tree.size(); k++)
+        {
+            std::vector<int> nodeSamples;
+            nodeSamples.swap(samples[k]);
+
+            double Wn = 0, Wp = 0;
+            for (size_t j = 0; j < nodeSamples.size(); j++)
+            {
+                const int i = nodeSamples[j];
+                (i < N0 ? Wn : Wp) += W[i] / norm;
+            }
+            const double Wk = Wn + Wp, prior = Wp / Wk;
+            const float nodeErr = (float)std::min(prior, 1 - prior);
+            tree[k].weight = (float)Wk;
+            tree[k].hs = (float)std::max(-4.0, std::min(4.0, 0.5 * std::log(prior / (1 - prior))));
+
+            if (prior < 1e-3 || prior > 1 - 1e-3 || (int)tree[k].depth >= bp.maxDepth ||
+                Wk < bp.minWeight)
+            {
+                err += nodeErr * tree[k].weight;
+                continue;
+            }
+
+            // candidate features
+            int numFids = F;
+            for (int j = 0; j < F; j++)
+                fids[j] = j;
+            if (bp.fracFeatures < 1)
+            {
+                numFids = (int)std::floor(F * bp.fracFeatures);
+                for (int j = 0; j < numFids; j++)
+                    std::swap(fids[j], fids[j + mRng.uniform(0, F - j)]);
+            }
+
+            w.resize(nodeSamples.size());
+            for (size_t j = 0; j < nodeSamples.size(); j++)
+                w[j] = (float)(W[nodeSamples[j]] / norm / Wk);
+            findSplits(nodeSamples, w, (float)prior, fids, numFids, errs, thrs);
+
+            const int best = (int)(std::min_element(errs.begin(), errs.begin() + numFids) - errs.begin());
+            const int fid = fids[best], bin = thrs[best];
+
+            // split the samples, x < thr is bin <= thr - 0.5
+            const uint8_T *column = &mBins[(size_t)fid * N];
+            std::vector<int> left, right;
+            for (size_t j = 0; j < nodeSamples.size(); j++)
+            {
+                const int i = nodeSamples[j];
+                (column[i] <= bin ? left : right).push_back(i);
+            }
+            if (left.empty() || right.empty())
+            {
+                err += nodeErr * tree[k].weight;
+                continue;
+            }
+
+            tree[k].fid = (uint32_T)fid;
+            tree[k].bin = bin;
+            tree[k].thr = mXMin[fid] + mXStep[fid] * (bin + 0.5f);
+            tree[k].child = (uint32_T)tree.size() + 1;
+
+            AcfTreeNode node = root;
+            node.depth = tree[k].depth + 1;
+            tree.push_back(node);
+            tree.push_back(node);
+            samples.resize(tree.size());
+            samples[tree.size() - 2].swap(left);
+            samples[tree.size() - 1].swap(right);
+        }
+        return err;
+    }
+
+    // Error and bin of the best threshold of the candidate features fids on
+    // the samples of a node, from the cumulative histograms of their
+    // normalized weights w
+    void findSplits(const std::vector<int> &nodeSamples, const std::vector<float> &w,
+        float prior, const std::vector<int> &fids, int numFids,
+        std::vector<float> &errs, std::vector<int> &thrs) const
+    {
+        const int N0 = getNumNegatives();
+        errs.resize(numFids);
+        thrs.resize(numFids);
+
+        // negatives are first in the samples of a node
+        const int numNeg = (int)(std::lower_bound(nodeSamples.begin(),
+            nodeSamples.end(), N0) - nodeSamples.begin());
+
+        const int numWorkers = std::max((int)cgGetNumThreads(), 1);
+        std::vector<float> cdfs(2 * (size_t)ACF_NUM_BINS * numWorkers);
+        const int numBlocks = (numFids + ACF_FEATURE_BLOCK - 1) / ACF_FEATURE_BLOCK;
+#ifdef PARALLEL
+        cgParallelForWorkers(numBlocks, [&](int worker, int b) {
+            splitBlock(nodeSamples, numNeg, w, prior, fids, numFids, b,
+                &cdfs[2 * (size_t)ACF_NUM_BINS * worker], errs, thrs);
+        });
+#else
+        for (int b = 0; b < numBlocks; b++)
+            splitBlock(nodeSamples, numNeg, w, prior, fids, numFids, b, &cdfs[0], errs, thrs);
+#endif
+    }
+
+    // errors and bins of the candidate features of block b, the first
+    // numNeg samples of the node negatives; cdf0 holds 2*ACF_NUM_BINS
+    // values
+    void splitBlock(const std::vector<int> &nodeSamples, int numNeg,
+        const std::vector<float> &w, float prior, const std::vector<int> &fids, int numFids,
+        int b, float *cdf0, std::vector<float> &errs, std::vector<int> &thrs) const
+    {
+        const int N = mNumSamples, numNode = (int)nodeSamples.size();
+        float *cdf1 = cdf0 + ACF_NUM_BINS;
+        const int j1 = std::min(numFids, (b + 1) * ACF_FEATURE_BLOCK);
+        for (int j = b * ACF_FEATURE_BLOCK; j < j1; j++)
+        {
+            const uint8_T *column = &mBins[(size_t)fids[j] * N];
+            std::fill(cdf0, cdf0 + 2 * ACF_NUM_BINS, 0.0f);
+            for (int s = 0; s < numNeg; s++)
+                cdf0[column[nodeSamples[s]]] += w[s];
+            for (int s = numNeg; s < numNode; s++)
+                cdf1[column[nodeSamples[s]]] += w[s];
+
+            // error of the positives above the bin, or its complement
+            float e0 = std::min(prior, 1 - prior);
+            int thr = 0;
+            float c0 = 0, c1 = 0;
+            for (int q = 0; q < ACF_NUM_BINS; q++)
+            {
+                c0 += cdf0[q];
+                c1 += cdf1[q];
+                const float e = prior - c1 + c0;
+                if (e < e0)
+                {
+                    e0 = e;
+                    thr = q;
+                }
+                else if (1 - e < e0)
+                {
+                    e0 = 1 - e;
+                    thr = q;
+                }
+            }
+            errs[j] = e0;
+            thrs[j] = thr;
+        }
+    }
+
+    // outputs of the tree on all samples
+    void evaluateTree(const AcfTree &tree, std::vector<double> &h) const
+    {
+        const int N = mNumSamples;
+        const int numBlocks = (N + ACF_SAMPLE_BLOCK - 1) / ACF_SAMPLE_BLOCK;
+#ifdef PARALLEL
+        cgParallelForWorkers(numBlocks, [&](int, int b) {
+            evaluateBlock(tree, b, h);
+        });
+#else
+        for (int b = 0; b < numBlocks; b++)
+            evaluateBlock(tree, b, h);
+#endif
+    }
+
+    // outputs of the tree on the samples of block b
+    void evaluateBlock(const AcfTree &tree, int b, std::vector<double> &h) const
+    {
+        const int N = mNumSamples;
+        const int i1 = std::min(N, (b + 1) * ACF_SAMPLE_BLOCK);
+        for (int i = b * ACF_SAMPLE_BLOCK; i < i1; i++)
+        {
+            size_t k = 0;
+            while (tree[k].child)
+            {
+                const AcfTreeNode &node = tree[k];
+                const bool left = mBins[(size_t)node.fid * N + i] <= node.bin;
+                k = node.child - (left ? 1 : 0);
+            }
+            h[i] = tree[k].hs;
+        }
+    }
+
+    // depth of all leaves, or 0 if it varies
+    void setTreeDepth()
+    {
+        uint32_T maxDepth = 0;
+        for (size_t t = 0; t < mTrees.size(); t++)
+            for (size_t k = 0; k < mTrees[t].size(); k++)
+                maxDepth = std::max(maxDepth, mTrees[t][k].depth);
+
+        bool same = true;
+        for (size_t t = 0; t < mTrees.size() && same; t++)
+        {
+            for (size_t k = 0; k < mTrees[t].size() && same; k++)
+                same = mTrees[t][k].child || mTrees[t][k].depth == maxDepth;
+        }
+        // the zero nodes padding the smaller trees are leaves of depth 0
+        for (size_t t = 0; t < mTrees.size() && same; t++)
+            same = (int)mTrees[t].size() == mNumNodes || maxDepth == 0;
+        mTreeDepth = same ? (int)maxDepth : 0;
+    }
+
+    AcfDetector mDetector;
+    int mNumFeatures;
+
+    // features, one sample after the other
+    std::vector<float> mPositives;
+    std::vector<float> mNegatives;
+
+    // quantized features of the stage, one column per feature
+    std::vector<uint8_T> mBins;
+    std::vector<float> mXMin;
+    std::vector<float> mXStep;
+    int mNumSamples;
+
+    // trees of the last stage
+    std::vector<AcfTree> mTrees;
+    int mNumNodes;
+    int mTreeDepth;
+
+    cv::RNG mRng;
+
+    // copying and assignment are disallowed
+    AcfTrainer(const AcfTrainer &);
+    AcfTrainer &operator=(const AcfTrainer &);
+};
+
+} // namespace acf
+
+#endif // ACF_TRAINER
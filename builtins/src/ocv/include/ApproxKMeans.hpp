@@ -0,0 +1,522 @@
+//////////////////////////////////////////////////////////////////////////////
+// Approximate k-means clustering used to build the visual vocabulary of
+// bagOfFeatures, as approximateKMeans.m does.
+//
+// Each iteration indexes the cluster centers with a randomized kd-forest
+// and assigns every feature to the center found by an approximate nearest
+// neighbor search [Philbin 2007]. A feature only moves to another cluster
+// if it is not farther from the new center than it was from the old one.
+// Empty clusters take the features farthest from their centers. The
+// centers are initialized with k-means++ or at random, and of several
+// trials the one with the smallest compactness, the sum of the squared
+// distances of the features to their centers, is kept.
+//
+// The features are read in chunks of consecutive rows, so that they can be
+// mapped from a file larger than memory: an iteration reads every chunk
+// once, assigns its features in parallel and adds them to the sums of their
+// clusters while the chunk is in memory. Besides the centers, the
+// clustering keeps 8 bytes per feature, its cluster and squared distance,
+// and a double per element of the centers. The compactness is computed from
+// these sums, without another pass over the features.
+//
+// The sums of a cluster are accumulated in the order of its features,
+// whatever the number of threads, so the results only depend on the seed.
+//
+// Copyright 2016 The MathWorks, Inc.
+//
+//////////////////////////////////////////////////////////////////////////////
+#ifndef APPROX_KMEANS
+#define APPROX_KMEANS
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <cstring>
+#include <vector>
+
+#include "vision_defines.h"
+#include "opencv2/core.hpp"
+#include "opencv2/flann.hpp"
+#include "cgThreadPool.hpp"
+#include "cgProfile.hpp"
+
+namespace bagOfFeatures
+{
+
+// Rows read at a time from the features
+const int APPROX_KMEANS_CHUNK_ROWS = 65536;
+
+// Rows handled by one task of the pool
+const int APPROX_KMEANS_BLOCK_ROWS = 1024;
+
+struct ApproxKMeansParams
+{
+    ApproxKMeansParams() : numClusters(0), maxIterations(100),
+        threshold(0.0001f), numTrials(1), useKMeansPlusPlus(true), seed(0),
+        numTrees(4), checks(32) {}
+
+    int numClusters;
+    int maxIterations;
+
+    // relative change of the compactness at which a trial stops
+    float threshold;
+    int numTrials;
+    bool useKMeansPlusPlus;
+    unsigned int seed;
+
+    // trees of the kd-forest and leaves visited by a search
+    int numTrees;
+    int checks;
+};
+
+// Heap order of the features by distance to their centers, the farthest
+// on top, the first one of equal distances first
+struct IsCloser
+{
+    const float *dists;
+    bool operator()(int a, int b) const
+    {
+        return dists[a] < dists[b] || (dists[a] == dists[b] && a > b);
+    }
+};
+
+class ApproxKMeans
+{
+public:
+    // features is numFeatures-by-dim, row major. It is not copied and must
+    // outlive the object.
+    ApproxKMeans(const float *features, int numFeatures, int dim)
+        : mFeatures(features), mNumFeatures(numFeatures), mDim(dim),
+          mNumValid(0), mSumSquares(0) {}
+
+    // Clusters the features. centers receives the numClusters-by-dim
+    // centers, row major, and assignments the 0-based cluster of each
+    // feature. Features with Inf or NaN values are not clustered and are
+    // assigned -1. Returns the number of features clustered, or -1 if it is
+    // less than numClusters.
+    int cluster(const ApproxKMeansParams &params, float *centers,
+                int32_T *assignments)
+    {
+        const int K = params.numClusters;
+        if (K <= 0 || mDim <= 0)
+            return -1;
+
+        scanFeatures();
+        if (mNumValid < K)
+            return -1;
+
+        cv::RNG rng((uint64)params.seed);
+        std::vector<float> trialCenters((size_t)K * mDim);
+        mAssignments.resize(mNumFeatures);
+        mDists.resize(mNumFeatures);
+
+        double bestCompactness = DBL_MAX;
+        for (int trial = 0; trial < std::max(params.numTrials, 1); ++trial)
+        {
+            if (params.useKMeansPlusPlus)
+                initKMeansPlusPlus(rng, K, &trialCenters[0]);
+            else
+                initRandom(rng, K, &trialCenters[0]);
+
+            double prevCompactness = iterate(params, rng, false, &trialCenters[0]);
+            double compactness = prevCompactness;
+            for (int i = 0; i < params.maxIterations; ++i)
+            {
+                compactness = iterate(params, rng, true, &trialCenters[0]);
+
+                const double delta = std::abs(prevCompactness - compactness) /
+                    (prevCompactness + FLT_EPSILON);
+                if (delta <= params.threshold)
+                    break;
+                prevCompactness = compactness;
+            }
+
+            if (compactness < bestCompactness)
+            {
+                bestCompactness = compactness;
+                memcpy(centers, &trialCenters[0], trialCenters.size() * sizeof(float));
+                memcpy(assignments, &mAssignments[0], mAssignments.size() * sizeof(int32_T));
+            }
+        }
+        return mNumValid;
+    }
+
+private:
+    const float *row(int i) const
+    {
+        return mFeatures + (size_t)i * mDim;
+    }
+
+    static int numBlocks(int numRows)
+    {
+        return (numRows + APPROX_KMEANS_BLOCK_ROWS - 1) / APPROX_KMEANS_BLOCK_ROWS;
+    }
+
+    // Rows [startRowIdx, endRowIdx) of block b of the rows from startRow
+    // to endRow
+    static void blockRows(int startRow, int endRow, int b, int &startRowIdx,
+                          int &endRowIdx)
+    {
+        startRowIdx = startRow + b * APPROX_KMEANS_BLOCK_ROWS;
+        endRowIdx = std::min(startRowIdx + APPROX_KMEANS_BLOCK_ROWS, endRow);
+    }
+
+    // Validity of the features of block b, and the sum of the squared norms
+    // and number of the valid ones
+    void scanBlock(int b, double &squares, int &numValid)
+    {
+        int startRowIdx, endRowIdx;
+        blockRows(0, mNumFeatures, b, startRowIdx, endRowIdx);
+        for (int i = startRowIdx; i < endRowIdx; ++i)
+        {
+            // Inf, NaN, or values whose squares overflow
+            const double s = cv::normL2Sqr<float, double>(row(i), mDim);
+            const bool isValid = !cvIsNaN(s) && !cvIsInf(s);
+            mIsValid[i] = isValid ? 1 : 0;
+            if (isValid)
+            {
+                squares += s;
+                numValid++;
+            }
+        }
+    }
+
+    // Finds the features with Inf or NaN values, which are left out, and
+    // the sum of the squared norms of the others
+    void scanFeatures()
+    {
+        if (mIsValid.size() == (size_t)mNumFeatures)
+            return;
+
+        CG_PROFILE_PHASE(CG_PROFILE_COMPUTE);
+        mIsValid.resize(mNumFeatures);
+        std::vector<double> blockSquares(numBlocks(mNumFeatures), 0.0);
+        std::vector<int> blockValid(blockSquares.size(), 0);
+#ifdef PARALLEL
+        cgParallelForWorkers((int)blockSquares.size(), [&](int, int b) {
+            scanBlock(b, blockSquares[b], blockValid[b]);
+        });
+#else
+        for (int b = 0; b < (int)blockSquares.size(); ++b)
+            scanBlock(b, blockSquares[b], blockValid[b]);
+#endif
+
+        // summed in block order, whatever the number of threads
+        mSumSquares = 0;
+        mNumValid = 0;
+        for (size_t b = 0; b < blockSquares.size(); ++b)
+        {
+            mSumSquares += blockSquares[b];
+            mNumValid += blockValid[b];
+        }
+    }
+
+    int randomValidFeature(cv::RNG &rng) const
+    {
+        int i;
+        do
+        {
+            i = rng.uniform(0, mNumFeatures);
+        } while (!mIsValid[i]);
+        return i;
+    }
+
+    // K distinct features at random
+    void initRandom(cv::RNG &rng, int K, float *centers)
+    {
+        std::vector<int> valid;
+        valid.reserve(mNumValid);
+        for (int i = 0; i < mNumFeatures; ++i)
+        {
+            if (mIsValid[i])
+                valid.push_back(i);
+        }
+        for (int k = 0; k < K; ++k)
+        {
+            std::swap(valid[k], valid[rng.uniform(k, (int)valid.size())]);
+            memcpy(centers + (size_t)k * mDim, row(valid[k]), mDim * sizeof(float));
+        }
+    }
+
+    // k-means++: each center is drawn with a probability proportional to
+    // the squared distance of a feature to the nearest center so far. The
+    // distances are updated in parallel, and the draw first selects the
+    // block of the feature from the sums of the blocks.
+    void initKMeansPlusPlus(cv::RNG &rng, int K, float *centers)
+    {
+        CG_PROFILE_PHASE(CG_PROFILE_COMPUTE);
+        std::vector<float> &minDists = mDists;
+        std::vector<double> blockSums(numBlocks(mNumFeatures));
+
+        for (int i = 0; i < mNumFeatures; ++i)
+            minDists[i] = mIsValid[i] ? FLT_MAX : 0.0f;
+
+        int idx = randomValidFeature(rng);
+        memcpy(centers, row(idx), mDim * sizeof(float));
+
+        for (int k = 1; k < K; ++k)
+        {
+            const float *center = centers + (size_t)(k - 1) * mDim;
+#ifdef PARALLEL
+            cgParallelForWorkers((int)blockSums.size(), [&](int, int b) {
+                blockSums[b] = updateMinDists(b, center);
+            });
+#else
+            for (int b = 0; b < (int)blockSums.size(); ++b)
+                blockSums[b] = updateMinDists(b, center);
+#endif
+
+            double total = 0;
+            for (size_t b = 0; b < blockSums.size(); ++b)
+                total += blockSums[b];
+
+            idx = -1;
+            if (total > 0 && total < DBL_MAX)
+            {
+                double r = rng.uniform(0.0, 1.0) * total;
+                size_t b = 0;
+                while (b + 1 < blockSums.size() && r >= blockSums[b])
+                    r -= blockSums[b++];
+
+                const int startRowIdx = (int)b * APPROX_KMEANS_BLOCK_ROWS;
+                const int endRowIdx = std::min(startRowIdx + APPROX_KMEANS_BLOCK_ROWS, mNumFeatures);
+                for (int i = startRowIdx; i < endRowIdx; ++i)
+                {
+                    if (minDists[i] > 0)
+                    {
+                        idx = i;
+                        if (r < minDists[i])
+                            break;
+                        r -= minDists[i];
+                    }
+                }
+            }
+            // all the features are on a center, or the distances overflow
+            if (idx < 0)
+                idx = randomValidFeature(rng);
+
+            memcpy(centers + (size_t)k * mDim, row(idx), mDim * sizeof(float));
+        }
+    }
+
+    // Distances of the features of block b to the nearest center, with
+    // center added. Returns their sum.
+    double updateMinDists(int b, const float *center)
+    {
+        std::vector<float> &minDists = mDists;
+        int startRowIdx, endRowIdx;
+        blockRows(0, mNumFeatures, b, startRowIdx, endRowIdx);
+        double sum = 0;
+        for (int i = startRowIdx; i < endRowIdx; ++i)
+        {
+            if (!mIsValid[i])
+                continue;
+            minDists[i] = std::min(minDists[i], cv::normL2Sqr(row(i), center, mDim));
+            sum += minDists[i];
+        }
+        return sum;
+    }
+
+    // One iteration: assigns the features to the given centers and replaces
+    // them by the means of their clusters. With keepCloser, a feature keeps
+    // its cluster if it is closer to the old center than to the new one.
+    // Returns the compactness of the new clusters.
+    double iterate(const ApproxKMeansParams &params, cv::RNG &rng,
+                   bool keepCloser, float *centers)
+    {
+        CG_PROFILE_PHASE(CG_PROFILE_COMPUTE);
+        const int K = params.numClusters;
+
+        // the randomized trees of FLANN are drawn with rand
+        cvflann::seed_random(rng.next());
+        cv::Mat centersMat(K, mDim, CV_32F, centers);
+        cv::flann::Index index(centersMat,
+                               cv::flann::KDTreeIndexParams(params.numTrees),
+                               cvflann::FLANN_DIST_L2);
+        const cv::flann::SearchParams searchParams(params.checks, 0.0f);
+
+        mSums.assign((size_t)K * mDim, 0.0);
+        mCounts.assign(K, 0);
+
+        // the clusters are split into ranges summed in parallel; each range
+        // scans the assignments of the chunk for its features
+        const int numRanges = std::min(K, (int)cgGetNumThreads());
+
+        for (int chunk = 0; chunk < mNumFeatures; chunk += APPROX_KMEANS_CHUNK_ROWS)
+        {
+            const int chunkEnd = std::min(chunk + APPROX_KMEANS_CHUNK_ROWS, mNumFeatures);
+
+            const int numChunkBlocks = numBlocks(chunkEnd - chunk);
+#ifdef PARALLEL
+            cgParallelForWorkers(numChunkBlocks, [&](int, int b) {
+                assignBlock(index, searchParams, keepCloser, chunk, chunkEnd, b);
+            });
+            cgParallelForWorkers(numRanges, [&](int, int r) {
+                sumRange(K, numRanges, chunk, chunkEnd, r);
+            });
+#else
+            for (int b = 0; b < numChunkBlocks; ++b)
+                assignBlock(index, searchParams, keepCloser, chunk, chunkEnd, b);
+            for (int r = 0; r < numRanges; ++r)
+                sumRange(K, numRanges, chunk, chunkEnd, r);
+#endif
+        }
+
+        reinitializeEmptyClusters(K);
+
+        // sum over the clusters of the squared distances to the mean, which
+        // is the sum of the squared norms less count times the squared norm
+        // of the mean
+        double compactness = mSumSquares;
+        for (int k = 0; k < K; ++k)
+        {
+            const double *sum = &mSums[(size_t)k * mDim];
+            float *center = centers + (size_t)k * mDim;
+            if (mCounts[k] == 0)
+            {
+                std::fill(center, center + mDim, 0.0f);
+                continue;
+            }
+            const double scale = 1.0 / mCounts[k];
+            double squares = 0;
+            for (int d = 0; d < mDim; ++d)
+            {
+                center[d] = (float)(sum[d] * scale);
+                squares += sum[d] * sum[d];
+            }
+            compactness -= squares * scale;
+        }
+        return std::max(compactness, 0.0);
+    }
+
+    // Assigns the features of block b of the chunk to the nearest center
+    // found in index
+    void assignBlock(cv::flann::Index &index, const cv::flann::SearchParams &searchParams,
+                     bool keepCloser, int chunk, int chunkEnd, int b)
+    {
+        int startRowIdx, endRowIdx;
+        blockRows(chunk, chunkEnd, b, startRowIdx, endRowIdx);
+        const int n = endRowIdx - startRowIdx;
+        int32_T nearest[APPROX_KMEANS_BLOCK_ROWS];
+        float dists[APPROX_KMEANS_BLOCK_ROWS];
+        cv::Mat query(n, mDim, CV_32F, (void *)row(startRowIdx));
+        cv::Mat indexMat(n, 1, CV_32S, nearest);
+        cv::Mat distMat(n, 1, CV_32F, dists);
+        index.knnSearch(query, indexMat, distMat, 1, searchParams);
+
+        for (int j = 0; j < n; ++j)
+        {
+            const int i = startRowIdx + j;
+            if (!mIsValid[i])
+            {
+                mAssignments[i] = -1;
+                mDists[i] = -FLT_MAX;
+                continue;
+            }
+            // as approximateKMeans.m, the distance to the new
+            // center is kept even when the cluster is
+            const bool isFarther = keepCloser &&
+                nearest[j] != mAssignments[i] && mDists[i] < dists[j];
+            if (!isFarther)
+                mAssignments[i] = nearest[j];
+            mDists[i] = dists[j];
+        }
+    }
+
+    // Adds the features of the chunk that belong to range r of the
+    // clusters to the sums of their clusters
+    void sumRange(int K, int numRanges, int chunk, int chunkEnd, int r)
+    {
+        const int startCluster = (int)((long long)K * r / numRanges);
+        const int endCluster = (int)((long long)K * (r + 1) / numRanges);
+        for (int i = chunk; i < chunkEnd; ++i)
+        {
+            const int k = mAssignments[i];
+            if (k < startCluster || k >= endCluster)
+                continue;
+            const float *x = row(i);
+            double *sum = &mSums[(size_t)k * mDim];
+            for (int d = 0; d < mDim; ++d)
+                sum[d] += x[d];
+            mCounts[k]++;
+        }
+    }
+
+    // Each empty cluster takes the feature farthest from its center whose
+    // cluster keeps at least one feature, as approximateKMeans.m does
+    void reinitializeEmptyClusters(int K)
+    {
+        std::vector<int> empty;
+        for (int k = 0; k < K; ++k)
+        {
+            if (mCounts[k] == 0)
+                empty.push_back(k);
+        }
+        if (empty.empty())
+            return;
+
+        // valid features, farthest first
+        const IsCloser isCloser = { &mDists[0] };
+
+        std::vector<int> candidates;
+        for (int i = 0; i < mNumFeatures; ++i)
+        {
+            if (mIsValid[i])
+                candidates.push_back(i);
+        }
+        std::make_heap(candidates.begin(), candidates.end(), isCloser);
+
+        for (size_t e = 0; e < empty.size() && !candidates.empty(); ++e)
+        {
+            const int k = empty[e];
+            while (!candidates.empty())
+            {
+                std::pop_heap(candidates.begin(), candidates.end(), isCloser);
+                const int i = candidates.back();
+                candidates.pop_back();
+
+                const int previous = mAssignments[i];
+                if (mCounts[previous] <= 1)
+                    continue;
+
+                const float *x = row(i);
+                double *prevSum = &mSums[(size_t)previous * mDim];
+                double *sum = &mSums[(size_t)k * mDim];
+                for (int d = 0; d < mDim; ++d)
+                {
+                    prevSum[d] -= x[d];
+                    sum[d] = x[d];
+                }
+                mCounts[previous]--;
+                mCounts[k] = 1;
+                mAssignments[i] = k;
+                break;
+            }
+        }
+    }
+
+    const float *mFeatures;
+    int mNumFeatures;
+    int mDim;
+
+    // features without Inf or NaN, and the sum of their squared norms
+    std::vector<uchar> mIsValid;
+    int mNumValid;
+    double mSumSquares;
+
+    // cluster and squared distance to its center of each feature
+    std::vector<int32_T> mAssignments;
+    std::vector<float> mDists;
+
+    // sums and sizes of the clusters
+    std::vector<double> mSums;
+    std::vector<int> mCounts;
+
+    // copying and assignment are disallowed
+    ApproxKMeans(const ApproxKMeans &);
+    ApproxKMeans &operator=(const ApproxKMeans &);
+};
+
+} // namespace bagOfFeatures
+
+#endif
@@ -0,0 +1,591 @@
+//////////////////////////////////////////////////////////////////////////////
+// Persistent FLANN index used by matchFeatures's Approximate method.
+//
+// The index owns a copy of the database features so that it can be built
+// once and queried many times. Features appended with addPoints() are
+// accumulated into the same buffer. The FLANN indices have no incremental
+// insertion, so the whole index is rebuilt over all the features, lazily on
+// the next search so that many consecutive additions only pay for one build.
+//
+// The index of real features can be autotuned: FLANN picks the algorithm
+// (linear, kd-trees or k-means tree) and its parameters that reach a target
+// precision on a sample of the features, weighing search time against
+// build time and memory. The chosen configuration is kept, saved with the
+// index and can be read back and set on another index, so that later
+// builds skip the tuning.
+//
+// Copyright 2016 The MathWorks, Inc.
+//
+//////////////////////////////////////////////////////////////////////////////
+#ifndef APPROX_NN_INDEX
+#define APPROX_NN_INDEX
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <limits>
+#include <string>
+
+#include "vision_defines.h"
+#include "opencv2/core.hpp"
+#include "opencv2/flann.hpp"
+#include "MappedFile.hpp"
+#include "cgProfile.hpp"
+#include "flann/all_indices.h"
+
+namespace matchFeatures
+{
+
+// Multi-threaded kNN search: the query rows are partitioned into blocks
+// that are searched independently. Each block writes into its own rows of
+// the caller-owned output buffers.
+struct ApproxNNSearchInvoker : cv::ParallelLoopBody
+{
+    ApproxNNSearchInvoker(cv::flann::Index &_index, const cv::Mat &_query,
+                          cv::Mat &_indices, cv::Mat &_dists, int _knn,
+                          const cv::flann::SearchParams &_params)
+    {
+        index = &_index;
+        query = &_query;
+        indices = &_indices;
+        dists = &_dists;
+        knn = _knn;
+        params = &_params;
+    }
+
+    void operator()(const cv::Range& range) const
+    {
+        CG_TRACE_SPAN("ApproxNNSearchInvoker");
+        // row ranges of continuous matrices are continuous, so FLANN
+        // writes straight into the caller's buffers
+        cv::Mat q = query->rowRange(range);
+        cv::Mat i = indices->rowRange(range);
+        cv::Mat d = dists->rowRange(range);
+        index->knnSearch(q, i, d, knn, *params);
+    }
+
+    cv::flann::Index *index;
+    const cv::Mat *query;
+    cv::Mat *indices;
+    cv::Mat *dists;
+    int knn;
+    const cv::flann::SearchParams *params;
+};
+
+// Minimum number of query rows handled by one block. Smaller blocks do not
+// amortize the scheduling overhead.
+const int APPROX_NN_MIN_ROWS_PER_BLOCK = 64;
+
+inline void approxKnnSearch(cv::flann::Index &index, const cv::Mat &query,
+                            cv::Mat &indices, cv::Mat &dists, int knn,
+                            const cv::flann::SearchParams &params)
+{
+    const int numBlocks = std::min(4 * cv::getNumThreads(),
+        (query.rows + APPROX_NN_MIN_ROWS_PER_BLOCK - 1) / APPROX_NN_MIN_ROWS_PER_BLOCK);
+
+    if (numBlocks <= 1)
+    {
+        index.knnSearch(query, indices, dists, knn, params);
+    }
+    else
+    {
+        cv::parallel_for_(cv::Range(0, query.rows),
+            ApproxNNSearchInvoker(index, query, indices, dists, knn, params),
+            numBlocks);
+    }
+}
+
+class ApproxNNIndex
+{
+public:
+    // Layout of the configuration chosen by autotuning. The parameters
+    // that do not apply to the algorithm are ignored.
+    enum
+    {
+        TUNED_ALGORITHM = 0,  // cvflann::flann_algorithm_t
+        TUNED_TREES,          // kd-trees
+        TUNED_BRANCHING,      // k-means tree
+        TUNED_ITERATIONS,     // k-means tree
+        TUNED_CENTERS_INIT,   // k-means tree, cvflann::flann_centers_init_t
+        TUNED_CB_INDEX,       // k-means tree
+        TUNED_CHECKS,         // checks of the searches
+        TUNED_CONFIG_LENGTH
+    };
+
+    ApproxNNIndex() : mIndex(new cv::flann::Index()),
+        mDistType(cvflann::FLANN_DIST_L2), mIsDirty(false),
+        mUseLsh(false), mLshTableNumber(0), mLshKeySize(0),
+        mLshMultiProbeLevel(0), mUseAutotune(false), mTargetPrecision(0.8f),
+        mBuildWeight(0.01f), mMemoryWeight(0.0f), mSampleFraction(0.1f),
+        mIsTuned(false)
+    {
+        std::fill(mTunedConfig, mTunedConfig + TUNED_CONFIG_LENGTH, 0.0);
+    }
+
+    // Selects locality sensitive hashing for binary features instead of
+    // hierarchical clustering. Must be called before build().
+    //  tableNumber:      number of hash tables
+    //  keySize:          number of bits in a hash key
+    //  multiProbeLevel:  number of neighboring buckets to probe, 0 for
+    //                    standard LSH
+    void setLshParams(int tableNumber, int keySize, int multiProbeLevel)
+    {
+        mUseLsh = true;
+        mLshTableNumber = tableNumber;
+        mLshKeySize = keySize;
+        mLshMultiProbeLevel = multiProbeLevel;
+    }
+
+    // Autotunes the index of real features on the next build. Binary
+    // features keep hierarchical clustering or LSH.
+    //  targetPrecision:  fraction of the searches that must find the
+    //                    exact nearest neighbor
+    //  buildWeight:      weight of the build time against the search time
+    //  memoryWeight:     weight of the memory used by the index
+    //  sampleFraction:   fraction of the features the tuning runs on
+    void setAutotuneParams(float targetPrecision, float buildWeight,
+                           float memoryWeight, float sampleFraction)
+    {
+        mUseAutotune = true;
+        mTargetPrecision = targetPrecision;
+        mBuildWeight = buildWeight;
+        mMemoryWeight = memoryWeight;
+        mSampleFraction = sampleFraction;
+        mIsTuned = false;
+    }
+
+    // Configuration chosen by autotuning, TUNED_CONFIG_LENGTH values laid
+    // out as above. Returns false when the index was not tuned.
+    bool getTunedConfig(double *config) const
+    {
+        std::copy(mTunedConfig, mTunedConfig + TUNED_CONFIG_LENGTH, config);
+        return mIsTuned;
+    }
+
+    // Uses a configuration returned by getTunedConfig() for the next builds
+    // of the index of real features, without tuning.
+    void setTunedConfig(const double *config)
+    {
+        std::copy(config, config + TUNED_CONFIG_LENGTH, mTunedConfig);
+        mIsTuned = true;
+        mIsDirty = true;
+    }
+
+    // Builds the index over numFeatures-by-numelInFeatureVec row-major
+    // features. Data are copied, the caller's buffer may be released.
+    // build() selects the distance and must precede addPoints().
+    template <typename T>
+    void build(const T *features, const char *metric,
+               int numFeatures, int numelInFeatureVec)
+    {
+        mDistType = getDistanceType(metric, cv::DataType<T>::type);
+        cv::Mat f(numFeatures, numelInFeatureVec, cv::DataType<T>::type,
+                  (void *)features);
+        f.copyTo(mFeatures);
+        mIsDirty = true;
+        if (!mFeatures.empty())
+            buildIndex();
+    }
+
+    // Appends features to the database. The index is rebuilt over all the
+    // features, not updated, on the next call to knnSearch().
+    template <typename T>
+    void addPoints(const T *features, int numFeatures, int numelInFeatureVec)
+    {
+        if (numFeatures <= 0)
+            return;
+
+        cv::Mat f(numFeatures, numelInFeatureVec, cv::DataType<T>::type,
+                  (void *)features);
+        if (mFeatures.empty())
+        {
+            f.copyTo(mFeatures);
+        }
+        else
+        {
+            CV_Assert(mFeatures.cols == numelInFeatureVec &&
+                      mFeatures.type() == f.type());
+            // cv::Mat::push_back grows the buffer geometrically, so
+            // repeated additions are amortized.
+            mFeatures.push_back(f);
+        }
+        mIsDirty = true;
+    }
+
+    // Finds the knn nearest neighbors for each row of features1. Results
+    // are written directly into the numFeatures1-by-knn row-major output
+    // buffers that are owned by the caller. checks is the number of leaves
+    // visited per query (-1 for unlimited, -2 for that of the tuned
+    // configuration or 32 without one) and eps the approximation tolerance
+    // of the search. An empty index finds no neighbors: the indices are -1
+    // and the distances the largest value of DistT, as FLANN reports the
+    // neighbors it could not find.
+    template <typename T, typename DistT>
+    void knnSearch(const T *features1, int numFeatures1, int knn,
+                   int32_T *indexPairs, DistT *dist,
+                   int checks = cvflann::FLANN_CHECKS_AUTOTUNED, float eps = 0.0f)
+    {
+        if (mFeatures.empty())
+        {
+            const size_t n = (size_t)std::max(numFeatures1, 0) * std::max(knn, 0);
+            std::fill(indexPairs, indexPairs + n, -1);
+            std::fill(dist, dist + n, std::numeric_limits<DistT>::max());
+            return;
+        }
+
+        if (mIsDirty)
+            buildIndex();
+
+        if (checks == cvflann::FLANN_CHECKS_AUTOTUNED)
+        {
+            checks = (mIsTuned && mDistType != cvflann::FLANN_DIST_HAMMING) ?
+                (int)mTunedConfig[TUNED_CHECKS] : 32;
+        }
+
+        cv::Mat f1Mat(numFeatures1, mFeatures.cols, mFeatures.type(),
+                      (void *)features1);
+        cv::Mat distMat (numFeatures1, knn, cv::DataType<DistT>::type,
+                         (void *)dist);
+        cv::Mat indexMat(numFeatures1, knn, CV_32S, (void *)indexPairs);
+
+        approxKnnSearch(*mIndex, f1Mat, indexMat, distMat, knn,
+                        cv::flann::SearchParams(checks, eps));
+    }
+
+    // Saves the index. The database features are written to filename,
+    // after a small header and padded to a page boundary so that load()
+    // can map them read-only. The FLANN tree is written to filename.flann.
+    // Returns false when either file could not be written, or when the
+    // index has no features.
+    bool save(const char *filename)
+    {
+        if (mFeatures.empty())
+            return false;
+        if (mIsDirty)
+            buildIndex();
+
+        FILE *fout = fopen(filename, "wb");
+        if (fout == NULL)
+            return false;
+
+        FileHeader header;
+        memcpy(header.magic, getMagic(), sizeof(header.magic));
+        header.version      = FILE_VERSION;
+        header.featureType  = (int32_T)mFeatures.type();
+        header.distType     = (int32_T)mDistType;
+        header.rows         = (int32_T)mFeatures.rows;
+        header.cols         = (int32_T)mFeatures.cols;
+        header.dataOffset   = PAGE_ALIGNMENT;
+
+        TunedHeader tuned;
+        tuned.isTuned  = mIsTuned ? 1 : 0;
+        tuned.reserved = 0;
+        std::copy(mTunedConfig, mTunedConfig + TUNED_CONFIG_LENGTH, tuned.config);
+
+        LshHeader lsh;
+        lsh.useLsh          = mUseLsh ? 1 : 0;
+        lsh.tableNumber     = (int32_T)mLshTableNumber;
+        lsh.keySize         = (int32_T)mLshKeySize;
+        lsh.multiProbeLevel = (int32_T)mLshMultiProbeLevel;
+
+        bool ok = fwrite(&header, sizeof(header), 1, fout) == 1 &&
+                  fwrite(&tuned, sizeof(tuned), 1, fout) == 1 &&
+                  fwrite(&lsh, sizeof(lsh), 1, fout) == 1;
+
+        // pad up to the start of the features
+        const char zeros[64] = {0};
+        size_t pos = sizeof(header) + sizeof(tuned) + sizeof(lsh);
+        while (ok && pos < (size_t)header.dataOffset)
+        {
+            size_t n = std::min(sizeof(zeros), (size_t)header.dataOffset - pos);
+            ok = fwrite(zeros, 1, n, fout) == n;
+            pos += n;
+        }
+
+        const size_t rowBytes = mFeatures.cols * mFeatures.elemSize();
+        for (int i = 0; ok && i < mFeatures.rows; ++i)
+        {
+            ok = fwrite(mFeatures.ptr(i), 1, rowBytes, fout) == rowBytes;
+        }
+        ok = fclose(fout) == 0 && ok;
+
+        // the tree is written by FLANN, which raises an error when it
+        // cannot open its file
+        bool treeSaved = false;
+        if (ok)
+        {
+            try
+            {
+                mIndex->save(getTreeFilename(filename));
+                treeSaved = true;
+            }
+            catch (const cv::Exception &)
+            {
+            }
+        }
+        return ok && treeSaved;
+    }
+
+    // Loads an index written by save(). The features are memory-mapped,
+    // not copied; processes loading the same file share the pages. The
+    // file is validated and loaded aside; on failure the index is left as
+    // it was.
+    bool load(const char *filename)
+    {
+        vision::MappedFile mapping;
+        if (!mapping.open(filename) || mapping.size() < sizeof(FileHeader))
+            return false;
+
+        FileHeader header;
+        memcpy(&header, mapping.data(), sizeof(header));
+
+        // files of version 1 have no tuned configuration, those before
+        // version 3 no index kind
+        const size_t headerBytes = sizeof(header) +
+            (header.version >= 2 ? sizeof(TunedHeader) : 0) +
+            (header.version >= 3 ? sizeof(LshHeader) : 0);
+        const size_t elemSize = CV_ELEM_SIZE(header.featureType);
+        if (memcmp(header.magic, getMagic(), sizeof(header.magic)) != 0 ||
+            header.version < 1 || header.version > FILE_VERSION ||
+            (header.featureType != CV_32F && header.featureType != CV_8U) ||
+            (header.distType != cvflann::FLANN_DIST_L2 &&
+             header.distType != cvflann::FLANN_DIST_L1 &&
+             header.distType != cvflann::FLANN_DIST_HAMMING) ||
+            header.rows <= 0 || header.cols <= 0 ||
+            header.dataOffset < 0 || (size_t)header.dataOffset < headerBytes ||
+            (size_t)header.dataOffset +
+                (size_t)header.rows * header.cols * elemSize > mapping.size())
+        {
+            return false;
+        }
+
+        cv::Mat mapped(header.rows, header.cols, header.featureType,
+                       (void *)(mapping.data() + header.dataOffset));
+
+        cv::Ptr<cv::flann::Index> index(new cv::flann::Index());
+        if (!index->load(mapped, getTreeFilename(filename)))
+            return false;
+
+        TunedHeader tuned;
+        memset(&tuned, 0, sizeof(tuned));
+        if (header.version >= 2)
+            memcpy(&tuned, mapping.data() + sizeof(header), sizeof(tuned));
+
+        LshHeader lsh;
+        memset(&lsh, 0, sizeof(lsh));
+        if (header.version >= 3)
+            memcpy(&lsh, mapping.data() + sizeof(header) + sizeof(tuned), sizeof(lsh));
+
+        // Swap the loaded index in. The previous index and features are
+        // dropped before the previous mapping, now in mapping, is closed.
+        mIndex = index;
+        mFeatures = mapped;
+        mMapping.swap(mapping);
+        mDistType = (cvflann::flann_distance_t)header.distType;
+        mIsTuned = tuned.isTuned != 0;
+        std::copy(tuned.config, tuned.config + TUNED_CONFIG_LENGTH, mTunedConfig);
+
+        // a rebuild after addPoints() keeps the saved kind of index; older
+        // files keep the LSH parameters set on this index
+        if (header.version >= 3)
+        {
+            mUseLsh = lsh.useLsh != 0;
+            mLshTableNumber = lsh.tableNumber;
+            mLshKeySize = lsh.keySize;
+            mLshMultiProbeLevel = lsh.multiProbeLevel;
+        }
+
+        // mFeatures refers to the mapping; addPoints() reallocates it
+        mIsDirty = false;
+        return true;
+    }
+
+    int getNumFeatures() const
+    {
+        return mFeatures.rows;
+    }
+
+    int getNumelInFeatureVec() const
+    {
+        return mFeatures.cols;
+    }
+
+    // Maps the matchFeatures metric onto a FLANN distance. Binary features
+    // always use the Hamming distance.
+    static cvflann::flann_distance_t getDistanceType(const char *metric,
+                                                     int featureType)
+    {
+        if (featureType == CV_8U)
+            return cvflann::FLANN_DIST_HAMMING;
+
+        std::string metricString(metric);
+        if (metricString == "ssd")
+            return cvflann::FLANN_DIST_L2;
+        else
+            return cvflann::FLANN_DIST_L1;
+    }
+
+private:
+    // On-disk header of a saved index.
+    struct FileHeader
+    {
+        char    magic[8];
+        int32_T version;
+        int32_T featureType;
+        int32_T distType;
+        int32_T rows;
+        int32_T cols;
+        int32_T dataOffset;
+    };
+
+    // Tuned configuration, after the header from version 2 on
+    struct TunedHeader
+    {
+        int32_T isTuned;
+        int32_T reserved;
+        double  config[TUNED_CONFIG_LENGTH];
+    };
+
+    // Index kind of binary features, after the tuned configuration from
+    // version 3 on
+    struct LshHeader
+    {
+        int32_T useLsh;
+        int32_T tableNumber;
+        int32_T keySize;
+        int32_T multiProbeLevel;
+    };
+
+    enum { FILE_VERSION = 3, PAGE_ALIGNMENT = 4096 };
+
+    static const char *getMagic()
+    {
+        return "MWANNIDX";
+    }
+
+    static std::string getTreeFilename(const char *filename)
+    {
+        return std::string(filename) + ".flann";
+    }
+
+    void buildIndex()
+    {
+        if (mDistType == cvflann::FLANN_DIST_HAMMING && mUseLsh)
+        {
+            mIndex->build(mFeatures,
+                         cv::flann::LshIndexParams(mLshTableNumber,
+                             mLshKeySize, mLshMultiProbeLevel),
+                         mDistType);
+        }
+        else if (mDistType == cvflann::FLANN_DIST_HAMMING)
+        {
+            // Index binary features using hierarchical clustering.
+            mIndex->build(mFeatures,
+                         cv::flann::HierarchicalClusteringIndexParams(),
+                         mDistType);
+        }
+        else
+        {
+            if (mUseAutotune && !mIsTuned)
+            {
+                if (mDistType == cvflann::FLANN_DIST_L2)
+                    tune<cvmwflann::L2<float> >();
+                else
+                    tune<cvmwflann::L1<float> >();
+            }
+
+            if (!mIsTuned)
+            {
+                mIndex->build(mFeatures, cv::flann::KDTreeIndexParams(),
+                             mDistType);
+            }
+            else if (mTunedConfig[TUNED_ALGORITHM] == cvflann::FLANN_INDEX_KMEANS)
+            {
+                mIndex->build(mFeatures,
+                             cv::flann::KMeansIndexParams(
+                                 (int)mTunedConfig[TUNED_BRANCHING],
+                                 (int)mTunedConfig[TUNED_ITERATIONS],
+                                 (cvflann::flann_centers_init_t)(int)mTunedConfig[TUNED_CENTERS_INIT],
+                                 (float)mTunedConfig[TUNED_CB_INDEX]),
+                             mDistType);
+            }
+            else if (mTunedConfig[TUNED_ALGORITHM] == cvflann::FLANN_INDEX_KDTREE)
+            {
+                mIndex->build(mFeatures,
+                             cv::flann::KDTreeIndexParams((int)mTunedConfig[TUNED_TREES]),
+                             mDistType);
+            }
+            else
+            {
+                mIndex->build(mFeatures, cv::flann::LinearIndexParams(),
+                             mDistType);
+            }
+        }
+        mIsDirty = false;
+    }
+
+    // Runs the FLANN autotuning on the features and keeps the chosen
+    // configuration. The tuned index itself is discarded, buildIndex()
+    // builds that of the configuration.
+    template <typename Distance>
+    void tune()
+    {
+        CG_TRACE_SPAN("ApproxNNIndex::tune");
+        cvmwflann::Matrix<float> data((float *)mFeatures.data,
+                                      mFeatures.rows, mFeatures.cols);
+        cvmwflann::AutotunedIndex<Distance> index(data,
+            cvmwflann::AutotunedIndexParams(mTargetPrecision, mBuildWeight,
+                                            mMemoryWeight, mSampleFraction));
+        index.buildIndex();
+
+        const cvmwflann::IndexParams best = index.getParameters();
+        const cvmwflann::SearchParams search = index.getSearchParameters();
+
+        mTunedConfig[TUNED_ALGORITHM] = (int)cvmwflann::get_param(best,
+            "algorithm", cvmwflann::FLANN_INDEX_LINEAR);
+        mTunedConfig[TUNED_TREES] = cvmwflann::get_param(best, "trees", 4);
+        mTunedConfig[TUNED_BRANCHING] = cvmwflann::get_param(best, "branching", 32);
+        mTunedConfig[TUNED_ITERATIONS] = cvmwflann::get_param(best, "iterations", 11);
+        mTunedConfig[TUNED_CENTERS_INIT] = (int)cvmwflann::get_param(best,
+            "centers_init", cvmwflann::FLANN_CENTERS_RANDOM);
+        mTunedConfig[TUNED_CB_INDEX] = cvmwflann::get_param(best, "cb_index", 0.2f);
+        mTunedConfig[TUNED_CHECKS] = cvmwflann::get_param(search, "checks", 32);
+        mIsTuned = true;
+    }
+
+    // database features, row major
+    cv::Mat mFeatures;
+
+    // backing store of mFeatures after load()
+    vision::MappedFile mMapping;
+
+    // a pointer so that load() can swap in an index it loaded aside
+    cv::Ptr<cv::flann::Index> mIndex;
+    cvflann::flann_distance_t mDistType;
+
+    // true when features were added after the index was last built
+    bool mIsDirty;
+
+    // LSH parameters for binary features
+    bool mUseLsh;
+    int mLshTableNumber;
+    int mLshKeySize;
+    int mLshMultiProbeLevel;
+
+    // autotuning of the index of real features, and the configuration it
+    // chose or that was set
+    bool mUseAutotune;
+    float mTargetPrecision;
+    float mBuildWeight;
+    float mMemoryWeight;
+    float mSampleFraction;
+    bool mIsTuned;
+    double mTunedConfig[TUNED_CONFIG_LENGTH];
+
+    // copying and assignment are disallowed
+    ApproxNNIndex(const ApproxNNIndex &);
+    ApproxNNIndex &operator=(const ApproxNNIndex &);
+};
+
+} // namespace matchFeatures
+#endif
@@ -0,0 +1,222 @@
+//////////////////////////////////////////////////////////////////////////////
+// Assignment of detections to tracks of assignDetectionsToTracks.
+//
+// assignDetectionsToTracks pads the numTracks-by-numDetections cost matrix
+// to a square matrix of size numTracks + numDetections: track i may go to
+// its own dummy detection at costUnassignedTracks(i), detection j may go to
+// its own dummy track at costUnassignedDetections(j), and dummy tracks go
+// to dummy detections at no cost. The padded matrix is never formed here.
+//
+// A pair (i, j) costing at least costUnassignedTracks(i) +
+// costUnassignedDetections(j) is never better than leaving both unassigned,
+// so it is gated out, as are the infinite costs. The remaining pairs are
+// kept compressed by rows, the tracks, and the problem is solved with the
+// shortest augmenting paths of Jonker and Volgenant, one Dijkstra search
+// per row over the reduced costs, in O(n^3) for n = numTracks +
+// numDetections and less when the gating leaves few pairs.
+//
+// The total cost is that of the Munkres algorithm of
+// assignDetectionsToTracks. When several assignments reach it, the one
+// returned may differ.
+//
+// Copyright 2016 The MathWorks, Inc.
+//
+//////////////////////////////////////////////////////////////////////////////
+#ifndef ASSIGNMENT_SOLVER
+#define ASSIGNMENT_SOLVER
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <vector>
+
+namespace assignment
+{
+
+class AssignmentSolver
+{
+public:
+    AssignmentSolver() : mNumTracks(0), mNumDetections(0) {}
+
+    // cost is numTracks-by-numDetections, column major unless isRowMajor.
+    // costUnassignedTracks and costUnassignedDetections have one element
+    // per track and per detection. detectionOfTrack[i] receives the
+    // detection of track i, or -1 when it is unassigned.
+    void solve(const double *cost, int numTracks, int numDetections, bool isRowMajor,
+               const double *costUnassignedTracks, const double *costUnassignedDetections,
+               std::vector<int> &detectionOfTrack)
+    {
+        mNumTracks = numTracks;
+        mNumDetections = numDetections;
+        mCostTracks.assign(costUnassignedTracks, costUnassignedTracks + numTracks);
+        mCostDetections.assign(costUnassignedDetections, costUnassignedDetections + numDetections);
+        compress(cost, isRowMajor);
+        augmentAll();
+
+        detectionOfTrack.assign(numTracks, -1);
+        for (int i = 0; i < numTracks; i++)
+        {
+            if (mCol4Row[i] < numDetections)
+                detectionOfTrack[i] = mCol4Row[i];
+        }
+    }
+
+private:
+    // Pairs below the gate, by track: the detections of track i are
+    // mDetections[mRowStart[i] .. mRowStart[i+1]-1]
+    void compress(const double *cost, bool isRowMajor)
+    {
+        const int R = mNumTracks, C = mNumDetections;
+        mRowStart.assign(R + 1, 0);
+        mDetections.clear();
+        mCosts.clear();
+        for (int i = 0; i < R; i++)
+        {
+            for (int j = 0; j < C; j++)
+            {
+                const double c = isRowMajor ? cost[(size_t)i * C + j] : cost[i + (size_t)j * R];
+                if (c < mCostTracks[i] + mCostDetections[j])
+                {
+                    mDetections.push_back(j);
+                    mCosts.push_back(c);
+                }
+            }
+            mRowStart[i + 1] = (int)mDetections.size();
+        }
+    }
+
+    // Rows of the padded problem are the tracks, then a dummy track per
+    // detection; columns are the detections, then a dummy detection per
+    // track. relaxRow relaxes the shortest paths through each finite entry
+    // of row, base being the reduced distance to row.
+    void relaxRow(int row, double base)
+    {
+        const int R = mNumTracks, C = mNumDetections;
+        if (row < R)
+        {
+            for (int k = mRowStart[row]; k < mRowStart[row + 1]; k++)
+                relax(row, mDetections[k], base + mCosts[k]);
+            relax(row, C + row, base + mCostTracks[row]);
+        }
+        else
+        {
+            const int j = row - R;
+            relax(row, j, base + mCostDetections[j]);
+            for (int k = 0; k < R; k++)
+                relax(row, C + k, base);
+        }
+    }
+
+    // shortest path to col through row, of length d before the reduction
+    // by v(col)
+    void relax(int row, int col, double d)
+    {
+        if (mScannedCols[col])
+            return;
+        const double r = d - mV[col];
+        if (r < mShortest[col])
+        {
+            mPath[col] = row;
+            mShortest[col] = r;
+        }
+    }
+
+    // Adds the rows one at a time, each along the shortest augmenting path
+    // of the reduced costs cost - u(row) - v(col), which stay nonnegative
+    void augmentAll()
+    {
+        const int n = mNumTracks + mNumDetections;
+        const double inf = std::numeric_limits<double>::infinity();
+        mU.assign(n, 0.0);
+        mV.assign(n, 0.0);
+        mCol4Row.assign(n, -1);
+        mRow4Col.assign(n, -1);
+        mShortest.resize(n);
+        mPath.resize(n);
+        mScannedCols.resize(n);
+        mScannedRows.reserve(n);
+
+        for (int curRow = 0; curRow < n; curRow++)
+        {
+            std::fill(mShortest.begin(), mShortest.end(), inf);
+            std::fill(mPath.begin(), mPath.end(), -1);
+            std::fill(mScannedCols.begin(), mScannedCols.end(), (char)0);
+            mScannedRows.clear();
+
+            double minVal = 0;
+            int i = curRow, sink = -1;
+            while (sink < 0)
+            {
+                mScannedRows.push_back(i);
+                relaxRow(i, minVal - mU[i]);
+
+                // closest column, an unassigned one on ties
+                int best = -1;
+                double lowest = inf;
+                for (int j = 0; j < n; j++)
+                {
+                    if (mScannedCols[j])
+                        continue;
+                    if (mShortest[j] < lowest ||
+                        (mShortest[j] == lowest && best >= 0 && mRow4Col[best] >= 0 && mRow4Col[j] < 0))
+                    {
+                        lowest = mShortest[j];
+                        best = j;
+                    }
+                }
+                // a dummy assignment is always feasible
+                if (best < 0)
+                    return;
+
+                minVal = lowest;
+                mScannedCols[best] = 1;
+                if (mRow4Col[best] < 0)
+                    sink = best;
+                else
+                    i = mRow4Col[best];
+            }
+
+            // update the dual variables
+            mU[curRow] += minVal;
+            for (size_t k = 1; k < mScannedRows.size(); k++)
+            {
+                const int r = mScannedRows[k];
+                mU[r] += minVal - mShortest[mCol4Row[r]];
+            }
+            for (int j = 0; j < n; j++)
+            {
+                if (mScannedCols[j])
+                    mV[j] -= minVal - mShortest[j];
+            }
+
+            // augment along the path back to curRow
+            int j = sink;
+            while (true)
+            {
+                const int r = mPath[j];
+                mRow4Col[j] = r;
+                std::swap(mCol4Row[r], j);
+                if (r == curRow)
+                    break;
+            }
+        }
+    }
+
+    int mNumTracks, mNumDetections;
+    std::vector<double> mCostTracks, mCostDetections;
+
+    std::vector<int> mRowStart, mDetections;
+    std::vector<double> mCosts;
+
+    std::vector<double> mU, mV, mShortest;
+    std::vector<int> mCol4Row, mRow4Col, mPath, mScannedRows;
+    std::vector<char> mScannedCols;
+
+    // prevent copying
+    AssignmentSolver(const AssignmentSolver &);
+    AssignmentSolver &operator=(const AssignmentSolver &);
+};
+
+} // namespace assignment
+
+#endif
@@ -0,0 +1,391 @@
+//////////////////////////////////////////////////////////////////////////////
+// Overlap ratio of bounding boxes and greedy non-maximum suppression, as in
+// bboxOverlapRatio and selectStrongestBbox.
+//
+// Boxes are [x y width height], with positive width and height. The overlap
+// of two boxes is the area of their intersection divided by the area of
+// their union, or by the smaller of their areas, and is 0 unless the
+// intersection has a positive width and height.
+//
+// The overlap ratio of every pair of boxes is computed with the 128-bit
+// universal intrinsics of OpenCV, four single or two double boxes at a time,
+// and with PARALLEL on blocks of boxes of the pool. The ratios are those of
+// the scalar loops of bboxOverlapRatio.
+//
+// Suppression visits the boxes by decreasing score, keeping a box unless it
+// overlaps a box kept before it by more than the threshold. This keeps the
+// boxes of the greedy loop of selectStrongestBbox, which suppresses the
+// boxes after each kept one, but a box stops being tested at the first kept
+// box that suppresses it. With many boxes the kept ones are binned in a
+// uniform grid of about the mean box size, so a box is only tested against
+// the kept boxes of the cells it covers; the few kept boxes covering many
+// cells are tested linearly.
+//
+// Copyright 2016 The MathWorks, Inc.
+//
+//////////////////////////////////////////////////////////////////////////////
+#ifndef BOX_OVERLAP
+#define BOX_OVERLAP
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include "opencv2/core.hpp"
+#include "opencv2/core/hal/intrin.hpp"
+#include "cgThreadPool.hpp"
+
+// boxes per block of the pool
+#define BBOX_MIN_BOXES_PER_BLOCK 16
+// boxes from which suppression bins the kept boxes in a grid
+#define BBOX_GRID_MIN_BOXES 256
+// cells above which a kept box is tested linearly instead of binned
+#define BBOX_GRID_MAX_CELLS_PER_BOX 16
+
+namespace bbox
+{
+
+// sort order of suppression: by decreasing score
+struct ScoreDescending
+{
+    explicit ScoreDescending(const double *s) : score(s) {}
+    bool operator()(int a, int b) const { return score[a] > score[b]; }
+    const double *score;
+};
+
+// Boxes by coordinate: corners (x1, y1) and (x2, y2) and area
+template <typename T>
+struct BoxSet
+{
+    std::vector<T> x1, y1, x2, y2, area;
+
+    int size() const { return (int)x1.size(); }
+
+    void clear()
+    {
+        x1.clear();
+        y1.clear();
+        x2.clear();
+        y2.clear();
+        area.clear();
+    }
+
+    void push(T x, T y, T width, T height)
+    {
+        x1.push_back(x);
+        y1.push_back(y);
+        x2.push_back(x + width);
+        y2.push_back(y + height);
+        area.push_back(width * height);
+    }
+
+    // numBoxes-by-4 boxes, column major unless isRowMajor
+    void assign(const T *bbox, int numBoxes, bool isRowMajor)
+    {
+        clear();
+        for (int i = 0; i < numBoxes; i++)
+        {
+            if (isRowMajor)
+                push(bbox[4 * i], bbox[4 * i + 1], bbox[4 * i + 2], bbox[4 * i + 3]);
+            else
+                push(bbox[i], bbox[i + numBoxes], bbox[i + 2 * numBoxes], bbox[i + 3 * numBoxes]);
+        }
+    }
+};
+
+// Overlap ratio of box i of a and box j of b, 0 when they do not intersect
+template <typename T>
+inline T overlap(const BoxSet<T> &a, int i, const BoxSet<T> &b, int j, bool isDivByUnion)
+{
+    const T width = std::min(a.x2[i], b.x2[j]) - std::max(a.x1[i], b.x1[j]);
+    if (width <= 0)
+        return 0;
+    const T height = std::min(a.y2[i], b.y2[j]) - std::max(a.y1[i], b.y1[j]);
+    if (height <= 0)
+        return 0;
+    const T intersection = width * height;
+    if (isDivByUnion)
+        return intersection / (a.area[i] + b.area[j] - intersection);
+    return intersection / std::min(a.area[i], b.area[j]);
+}
+
+// Vector of the universal intrinsics holding T, when there is one
+template <typename T>
+struct Simd
+{
+    enum { lanes = 0 };
+};
+
+#if CV_SIMD128
+template <>
+struct Simd<float>
+{
+    typedef cv::v_float32x4 type;
+    enum { lanes = 4 };
+    static type all(float v) { return cv::v_setall_f32(v); }
+};
+#endif
+
+#if CV_SIMD128_64F
+template <>
+struct Simd<double>
+{
+    typedef cv::v_float64x2 type;
+    enum { lanes = 2 };
+    static type all(double v) { return cv::v_setall_f64(v); }
+};
+#endif
+
+// Overlap ratios of box j of b with lanes boxes of a from i, in the lanes
+// of the result, with the operations of overlap()
+template <typename T, typename V>
+inline V overlapLanes(const BoxSet<T> &a, int i, const BoxSet<T> &b, int j, bool isDivByUnion)
+{
+    const V zero = Simd<T>::all(0);
+    const V width = cv::v_min(cv::v_load(&a.x2[i]), Simd<T>::all(b.x2[j])) -
+                    cv::v_max(cv::v_load(&a.x1[i]), Simd<T>::all(b.x1[j]));
+    const V height = cv::v_min(cv::v_load(&a.y2[i]), Simd<T>::all(b.y2[j])) -
+                     cv::v_max(cv::v_load(&a.y1[i]), Simd<T>::all(b.y1[j]));
+    const V intersection = width * height;
+    const V areaA = cv::v_load(&a.area[i]);
+    const V areaB = Simd<T>::all(b.area[j]);
+    const V ratio = isDivByUnion ? intersection / (areaA + areaB - intersection)
+                                 : intersection / cv::v_min(areaA, areaB);
+    return cv::v_select((width > zero) & (height > zero), ratio, zero);
+}
+
+// ratio[i] = overlap of box i of a with box j of b, i in [0, a.size())
+template <typename T>
+inline void overlapColumn(const BoxSet<T> &a, const BoxSet<T> &b, int j, bool isDivByUnion,
+                          T *ratio, typename Simd<T>::type * = 0)
+{
+    typedef typename Simd<T>::type V;
+    const int n = a.size();
+    int i = 0;
+    for (; i <= n - (int)Simd<T>::lanes; i += Simd<T>::lanes)
+        cv::v_store(ratio + i, overlapLanes<T, V>(a, i, b, j, isDivByUnion));
+    for (; i < n; i++)
+        ratio[i] = overlap(a, i, b, j, isDivByUnion);
+}
+
+template <typename T>
+inline void overlapColumn(const BoxSet<T> &a, const BoxSet<T> &b, int j, bool isDivByUnion,
+                          T *ratio, ...)
+{
+    for (int i = 0; i < a.size(); i++)
+        ratio[i] = overlap(a, i, b, j, isDivByUnion);
+}
+
+// Whether box j of b overlaps a box of a in [begin, end) by more than
+// threshold
+template <typename T>
+inline bool anyAbove(const BoxSet<T> &a, int begin, int end, const BoxSet<T> &b, int j,
+                     T threshold, bool isDivByUnion, typename Simd<T>::type * = 0)
+{
+    typedef typename Simd<T>::type V;
+    const V thresh = Simd<T>::all(threshold);
+    int i = begin;
+    for (; i <= end - (int)Simd<T>::lanes; i += Simd<T>::lanes)
+    {
+        if (cv::v_check_any(overlapLanes<T, V>(a, i, b, j, isDivByUnion) > thresh))
+            return true;
+    }
+    for (; i < end; i++)
+    {
+        if (overlap(a, i, b, j, isDivByUnion) > threshold)
+            return true;
+    }
+    return false;
+}
+
+template <typename T>
+inline bool anyAbove(const BoxSet<T> &a, int begin, int end, const BoxSet<T> &b, int j,
+                     T threshold, bool isDivByUnion, ...)
+{
+    for (int i = begin; i < end; i++)
+    {
+        if (overlap(a, i, b, j, isDivByUnion) > threshold)
+            return true;
+    }
+    return false;
+}
+
+// Overlap ratio of bboxOverlapRatio: ratio is numA-by-numB, column major
+// unless isRowMajor, as are bboxA and bboxB, numA-by-4 and numB-by-4
+template <typename T>
+void overlapRatio(const T *bboxA, int numA, const T *bboxB, int numB, bool isRowMajor,
+                  bool isDivByUnion, T *ratio)
+{
+    // a column of a column major ratio is a box of B against all of A,
+    // a row of a row major one a box of A against all of B
+    BoxSet<T> inner, outer;
+    inner.assign(isRowMajor ? bboxB : bboxA, isRowMajor ? numB : numA, isRowMajor);
+    outer.assign(isRowMajor ? bboxA : bboxB, isRowMajor ? numA : numB, isRowMajor);
+    const size_t stride = (size_t)inner.size();
+
+#ifdef PARALLEL
+    cgParallelForRows(outer.size(), BBOX_MIN_BOXES_PER_BLOCK, [&](int begin, int end) {
+        for (int j = begin; j < end; j++)
+            overlapColumn(inner, outer, j, isDivByUnion, ratio + j * stride, 0);
+    });
+#else
+    for (int j = 0; j < outer.size(); j++)
+        overlapColumn(inner, outer, j, isDivByUnion, ratio + j * stride, 0);
+#endif
+}
+
+template <typename T>
+class OverlapSuppression
+{
+public:
+    OverlapSuppression() : mNumCols(0), mNumRows(0), mCellWidth(1), mCellHeight(1), mX0(0), mY0(0) {}
+
+    // Boxes of selectStrongestBbox: bbox is numBoxes-by-4, column major
+    // unless isRowMajor, with a score per box. isKept[i] receives whether
+    // box i is kept.
+    void suppress(const T *bbox, const double *score, int numBoxes, bool isRowMajor,
+                  T threshold, bool isDivByUnion, std::vector<char> &isKept)
+    {
+        mBoxes.assign(bbox, numBoxes, isRowMajor);
+        isKept.assign(numBoxes, 0);
+
+        // stable, as sort(score, 'descend')
+        mOrder.resize(numBoxes);
+        for (int i = 0; i < numBoxes; i++)
+            mOrder[i] = i;
+        std::stable_sort(mOrder.begin(), mOrder.end(), ScoreDescending(score));
+
+        const bool useGrid = numBoxes >= BBOX_GRID_MIN_BOXES;
+        if (useGrid)
+            initGrid();
+        mKept.clear();
+        mLarge.clear();
+
+        for (int k = 0; k < numBoxes; k++)
+        {
+            const int j = mOrder[k];
+            bool isSuppressed;
+            if (useGrid)
+                isSuppressed = isSuppressedInGrid(j, threshold, isDivByUnion);
+            else
+                isSuppressed = anyAbove(mKept, 0, mKept.size(), mBoxes, j, threshold,
+                                        isDivByUnion, 0);
+            if (isSuppressed)
+                continue;
+
+            isKept[j] = 1;
+            if (useGrid)
+                addToGrid(j);
+            else
+                keep(mKept, j);
+        }
+    }
+
+private:
+    void keep(BoxSet<T> &set, int j)
+    {
+        set.x1.push_back(mBoxes.x1[j]);
+        set.y1.push_back(mBoxes.y1[j]);
+        set.x2.push_back(mBoxes.x2[j]);
+        set.y2.push_back(mBoxes.y2[j]);
+        set.area.push_back(mBoxes.area[j]);
+    }
+
+    // Cells of about the mean box size over the extent of the boxes, at
+    // most about 4 per box
+    void initGrid()
+    {
+        const int n = mBoxes.size();
+        double sumWidth = 0, sumHeight = 0;
+        double xMin = mBoxes.x1[0], yMin = mBoxes.y1[0];
+        double xMax = mBoxes.x2[0], yMax = mBoxes.y2[0];
+        for (int i = 0; i < n; i++)
+        {
+            sumWidth += (double)mBoxes.x2[i] - mBoxes.x1[i];
+            sumHeight += (double)mBoxes.y2[i] - mBoxes.y1[i];
+            xMin = std::min(xMin, (double)mBoxes.x1[i]);
+            yMin = std::min(yMin, (double)mBoxes.y1[i]);
+            xMax = std::max(xMax, (double)mBoxes.x2[i]);
+            yMax = std::max(yMax, (double)mBoxes.y2[i]);
+        }
+        mX0 = xMin;
+        mY0 = yMin;
+        mCellWidth = std::max(sumWidth / n, (xMax - xMin) / 2048);
+        mCellHeight = std::max(sumHeight / n, (yMax - yMin) / 2048);
+        while (((xMax - xMin) / mCellWidth + 1) * ((yMax - yMin) / mCellHeight + 1) > 4.0 * n)
+        {
+            mCellWidth *= 2;
+            mCellHeight *= 2;
+        }
+        mNumCols = (int)((xMax - xMin) / mCellWidth) + 1;
+        mNumRows = (int)((yMax - yMin) / mCellHeight) + 1;
+
+        mCells.resize((size_t)mNumCols * mNumRows);
+        for (size_t c = 0; c < mCells.size(); c++)
+            mCells[c].clear();
+    }
+
+    // Cells covered by box j. Boxes with an intersection of positive
+    // width and height share a cell.
+    void cellRange(int j, int &c0, int &c1, int &r0, int &r1) const
+    {
+        c0 = std::min((int)((mBoxes.x1[j] - mX0) / mCellWidth), mNumCols - 1);
+        c1 = std::min((int)((mBoxes.x2[j] - mX0) / mCellWidth), mNumCols - 1);
+        r0 = std::min((int)((mBoxes.y1[j] - mY0) / mCellHeight), mNumRows - 1);
+        r1 = std::min((int)((mBoxes.y2[j] - mY0) / mCellHeight), mNumRows - 1);
+    }
+
+    void addToGrid(int j)
+    {
+        int c0, c1, r0, r1;
+        cellRange(j, c0, c1, r0, r1);
+        if ((c1 - c0 + 1) * (r1 - r0 + 1) > BBOX_GRID_MAX_CELLS_PER_BOX)
+        {
+            keep(mLarge, j);
+            return;
+        }
+        for (int r = r0; r <= r1; r++)
+        {
+            for (int c = c0; c <= c1; c++)
+                mCells[(size_t)r * mNumCols + c].push_back(j);
+        }
+    }
+
+    bool isSuppressedInGrid(int j, T threshold, bool isDivByUnion) const
+    {
+        if (anyAbove(mLarge, 0, mLarge.size(), mBoxes, j, threshold, isDivByUnion,
+                     0))
+            return true;
+
+        int c0, c1, r0, r1;
+        cellRange(j, c0, c1, r0, r1);
+        for (int r = r0; r <= r1; r++)
+        {
+            for (int c = c0; c <= c1; c++)
+            {
+                const std::vector<int> &cell = mCells[(size_t)r * mNumCols + c];
+                for (size_t k = 0; k < cell.size(); k++)
+                {
+                    if (overlap(mBoxes, cell[k], mBoxes, j, isDivByUnion) > threshold)
+                        return true;
+                }
+            }
+        }
+        return false;
+    }
+
+    BoxSet<T> mBoxes, mKept, mLarge;
+    std::vector<int> mOrder;
+
+    int mNumCols, mNumRows;
+    double mCellWidth, mCellHeight, mX0, mY0;
+    std::vector<std::vector<int> > mCells;
+
+    // prevent copying
+    OverlapSuppression(const OverlapSuppression &);
+    OverlapSuppression &operator=(const OverlapSuppression &);
+};
+
+} // namespace bbox
+
+#endif
@@ -0,0 +1,876 @@
+//////////////////////////////////////////////////////////////////////////////
+// Sparse bundle adjustment of camera poses and 3-D points, the variant of
+// Levenberg-Marquardt of bundleAdjustment.m [Lourakis 2009].
+//
+// Each iteration linearizes the reprojection of every observation and
+// accumulates the normal equations in blocks: U and ea per camera, V and eb
+// per point and W per observation. The points are eliminated with the
+// Schur complement, and the reduced camera system
+//
+//     S = U - sum_i W_i V_i^-1 W_i'
+//
+// has a 6x6 block for each pair of cameras that see a common point. It is
+// solved with a dense Cholesky factorization or, for many cameras, with
+// conjugate gradients preconditioned by its diagonal blocks; the points are
+// then solved for one by one. The observations are linearized per point and
+// the blocks of S built per camera in parallel, in blocks of a fixed size,
+// so the results do not depend on the number of threads.
+//
+// The poses follow cameraPose: a world point X is at Orientation*(X -
+// Location) in the camera. The rotations are updated as R <- exp([dr]x)*R,
+// so that the rotation parameters are always linearized at zero. The
+// projection follows cameraIntrinsics, with radial and tangential
+// distortion.
+//
+// Copyright 2016 The MathWorks, Inc.
+//
+//////////////////////////////////////////////////////////////////////////////
+#ifndef BUNDLE_ADJUSTER
+#define BUNDLE_ADJUSTER
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include "vision_defines.h"
+#include "opencv2/core.hpp"
+#include "cgThreadPool.hpp"
+
+namespace sfm
+{
+
+// Stop conditions, the status codes of bundleAdjustment.m
+enum BundleAdjustmentStatus
+{
+    BA_NO_STOP            = 0,
+    BA_SMALL_GRAD         = 1,
+    BA_SMALL_INCREMENT    = 2,
+    BA_MAX_ITERS          = 3,
+    BA_SMALL_REL_DECREASE = 4,
+    BA_SMALL_ABS_ERROR    = 5,
+    BA_NO_CONVERGE        = 6
+};
+
+// Solvers of the reduced camera system
+enum BundleAdjustmentSolver
+{
+    BA_SOLVER_AUTO     = 0,
+    BA_SOLVER_CHOLESKY = 1,
+    BA_SOLVER_PCG      = 2
+};
+
+// Above this number of refined cameras, BA_SOLVER_AUTO uses conjugate
+// gradients
+const int BA_AUTO_PCG_CAMERAS = 500;
+
+// Points or cameras handled by one task of the pool
+const int BA_BLOCK_SIZE = 256;
+
+struct BundleAdjustmentParams
+{
+    BundleAdjustmentParams() : maxIterations(50), absoluteTolerance(1.0),
+        relativeTolerance(1e-5), gradientTolerance(1e-12),
+        incrementTolerance(1e-12), solver(BA_SOLVER_AUTO),
+        pcgTolerance(1e-6), maxPCGIterations(0) {}
+
+    int maxIterations;
+    // mean squared reprojection error, in pixels, at which to stop
+    double absoluteTolerance;
+    // relative reduction of the reprojection error at which to stop
+    double relativeTolerance;
+    double gradientTolerance;
+    double incrementTolerance;
+    BundleAdjustmentSolver solver;
+    // relative residual at which conjugate gradients stop, and their
+    // largest number of iterations, 0 for the size of the reduced system
+    double pcgTolerance;
+    int maxPCGIterations;
+};
+
+// cameraIntrinsics of a view. skew is in pixels, as the Skew property.
+struct BundleAdjustmentIntrinsics
+{
+    double fx, fy, cx, cy, skew;
+    double k1, k2, k3, p1, p2;
+};
+
+class BundleAdjuster
+{
+public:
+    // The numObservations observations are the [x y] measurements of point
+    // pointIndex[k] in view viewIndex[k], 0-based. intrinsics holds one
+    // entry for all the views, or one per view. isFixedView, if not NULL,
+    // flags the views whose pose is not refined. The arrays are not used
+    // after the constructor.
+    BundleAdjuster(int numPoints, int numViews, const double *measurements,
+                   const int32_T *pointIndex, const int32_T *viewIndex,
+                   int numObservations,
+                   const BundleAdjustmentIntrinsics *intrinsics,
+                   int numIntrinsics, const boolean_T *isFixedView)
+        : mNumPoints(numPoints), mNumViews(numViews),
+          mNumObs(numObservations), mNumVar(0), mUseCG(false)
+    {
+        mIntrinsics.assign(intrinsics, intrinsics + std::max(numIntrinsics, 1));
+        sortObservations(measurements, pointIndex, viewIndex);
+
+        mCamVar.assign(numViews, -1);
+        for (int j = 0; j < numViews; ++j)
+        {
+            if (isFixedView == NULL || !isFixedView[j])
+                mCamVar[j] = mNumVar++;
+        }
+        buildStructure();
+    }
+
+    // Refines the points, 3-by-numPoints, and the poses in place.
+    // orientations holds the 3x3 Orientation of each view and locations its
+    // Location, column major. Returns the stop condition; numIterations
+    // receives the iterations run and reprojectionErrors, if not NULL, the
+    // mean reprojection error of each point.
+    int solve(const BundleAdjustmentParams &params, double *points,
+              double *orientations, double *locations,
+              double *reprojectionErrors, int *numIterations)
+    {
+        const double tau = 1e-3;
+        double mu = 0, v = 2;
+        int iter = 0;
+        int stopCondition = BA_NO_STOP;
+
+        mUseCG = (params.solver == BA_SOLVER_PCG) ||
+                 (params.solver == BA_SOLVER_AUTO && mNumVar > BA_AUTO_PCG_CAMERAS);
+
+        std::vector<Pose> poses(mNumViews), newPoses(mNumViews);
+        for (int j = 0; j < mNumViews; ++j)
+        {
+            // column major Orientation
+            poses[j].R = cv::Matx33d(orientations + 9 * j).t();
+            poses[j].t = -(poses[j].R * cv::Vec3d(locations + 3 * j));
+        }
+        std::vector<double> newPoints((size_t)3 * mNumPoints);
+
+        while (stopCondition == BA_NO_STOP)
+        {
+            iter++;
+            if (iter > params.maxIterations)
+            {
+                stopCondition = BA_MAX_ITERS;
+                break;
+            }
+
+            const double e1 = evaluate(points, poses, true);
+            const double meanReprojError = e1 / std::max(mNumObs, 1);
+            if (!isFinite(meanReprojError))
+            {
+                stopCondition = BA_NO_CONVERGE;
+                break;
+            }
+            if (meanReprojError < params.absoluteTolerance)
+            {
+                stopCondition = BA_SMALL_ABS_ERROR;
+                break;
+            }
+
+            buildNormalEquations();
+
+            double gInf = 0, maxDiag = 0, pL2 = 0;
+            for (int j = 0; j < mNumVar; ++j)
+            {
+                for (int k = 0; k < 6; ++k)
+                {
+                    gInf = std::max(gInf, std::abs(mEa[j][k]));
+                    maxDiag = std::max(maxDiag, mU[j](k, k));
+                }
+            }
+            for (int i = 0; i < mNumPoints; ++i)
+            {
+                for (int k = 0; k < 3; ++k)
+                {
+                    gInf = std::max(gInf, std::abs(mEb[i][k]));
+                    maxDiag = std::max(maxDiag, mV[i](k, k));
+                    pL2 += points[3 * i + k] * points[3 * i + k];
+                }
+            }
+            for (int j = 0; j < mNumViews; ++j)
+                pL2 += poses[j].t.dot(poses[j].t);
+            pL2 = std::sqrt(pL2);
+
+            if (gInf < params.gradientTolerance)
+            {
+                stopCondition = BA_SMALL_GRAD;
+                break;
+            }
+            if (iter == 1)
+                mu = tau * maxDiag;
+
+            while (true)
+            {
+                double deltaNorm2 = 0, dL = 0;
+                const bool isSolved = solveStep(params, mu);
+                if (isSolved)
+                {
+                    for (int j = 0; j < mNumVar; ++j)
+                    {
+                        deltaNorm2 += mDa[j].dot(mDa[j]);
+                        dL += mDa[j].dot(mu * mDa[j] + mEa[j]);
+                    }
+                    for (int i = 0; i < mNumPoints; ++i)
+                    {
+                        deltaNorm2 += mDb[i].dot(mDb[i]);
+                        dL += mDb[i].dot(mu * mDb[i] + mEb[i]);
+                    }
+                    if (std::sqrt(deltaNorm2) <= params.incrementTolerance * pL2)
+                    {
+                        stopCondition = BA_SMALL_INCREMENT;
+                        break;
+                    }
+                }
+
+                double dF = 0, e2 = 0;
+                if (isSolved)
+                {
+                    for (int j = 0; j < mNumViews; ++j)
+                    {
+                        newPoses[j] = poses[j];
+                        if (mCamVar[j] >= 0)
+                        {
+                            const cv::Vec6d &d = mDa[mCamVar[j]];
+                            newPoses[j].R = rotationFromVector(cv::Vec3d(d[0], d[1], d[2])) * poses[j].R;
+                            newPoses[j].t = poses[j].t + cv::Vec3d(d[3], d[4], d[5]);
+                        }
+                    }
+                    for (int i = 0; i < mNumPoints; ++i)
+                    {
+                        for (int k = 0; k < 3; ++k)
+                            newPoints[3 * i + k] = points[3 * i + k] + mDb[i][k];
+                    }
+                    e2 = evaluate(&newPoints[0], newPoses, false);
+                    dF = e1 - e2;
+                }
+
+                if (isSolved && dL > 0 && dF > 0)
+                {
+                    // reduction in error, the increment is accepted
+                    double tmp = 2 * dF / dL - 1;
+                    tmp = 1 - tmp * tmp * tmp;
+                    mu = mu * std::max(1.0 / 3, tmp);
+                    v = 2;
+
+                    const double de = std::sqrt(e1) - std::sqrt(e2);
+                    if (de * de < params.relativeTolerance * e1)
+                        stopCondition = BA_SMALL_REL_DECREASE;
+
+                    poses.swap(newPoses);
+                    std::copy(newPoints.begin(), newPoints.end(), points);
+                    break;
+                }
+                else
+                {
+                    mu = mu * v;
+                    const double v2 = 2 * v;
+                    // v has wrapped around, too many failed attempts to
+                    // increase the damping factor
+                    if (v2 <= v || !isFinite(v2))
+                    {
+                        stopCondition = BA_NO_CONVERGE;
+                        break;
+                    }
+                    v = v2;
+                }
+            }
+        }
+
+        for (int j = 0; j < mNumViews; ++j)
+        {
+            const cv::Matx33d &R = poses[j].R;
+            const cv::Vec3d location = -(R.t() * poses[j].t);
+            for (int r = 0; r < 3; ++r)
+            {
+                for (int c = 0; c < 3; ++c)
+                    orientations[9 * j + r + 3 * c] = R(r, c);
+                locations[3 * j + r] = location[r];
+            }
+        }
+
+        if (reprojectionErrors != NULL)
+        {
+            evaluate(points, poses, false);
+            for (int i = 0; i < mNumPoints; ++i)
+            {
+                double sum = 0;
+                for (int k = mPointStart[i]; k < mPointStart[i + 1]; ++k)
+                    sum += cv::norm(mRes[k]);
+                const int n = mPointStart[i + 1] - mPointStart[i];
+                reprojectionErrors[i] = (n > 0) ? sum / n : 0;
+            }
+        }
+        *numIterations = std::min(iter, params.maxIterations);
+        return stopCondition;
+    }
+
+private:
+    struct Pose
+    {
+        cv::Matx33d R;
+        cv::Vec3d t;
+    };
+
+    typedef cv::Matx<double, 2, 6> Matx26d;
+    typedef cv::Matx<double, 2, 3> Matx23d;
+    typedef cv::Matx<double, 6, 3> Matx63d;
+
+    static bool isFinite(double v)
+    {
+        return !cvIsNaN(v) && !cvIsInf(v);
+    }
+
+#ifdef PARALLEL
+    // Calls fcn(b, start, end) for the blocks of BA_BLOCK_SIZE items of
+    // [0, n) on the pool
+    template <typename Fcn>
+    static void forEachBlock(int n, Fcn fcn)
+    {
+        cgParallelForWorkers(numBlocks(n), [&](int w, int b) {
+            (void)w;
+            const int start = b * BA_BLOCK_SIZE;
+            fcn(b, start, std::min(start + BA_BLOCK_SIZE, n));
+        });
+    }
+#endif
+
+    static int numBlocks(int n)
+    {
+        return (n + BA_BLOCK_SIZE - 1) / BA_BLOCK_SIZE;
+    }
+
+    // exp([w]x), Rodrigues' formula
+    static cv::Matx33d rotationFromVector(const cv::Vec3d &w)
+    {
+        const double theta = cv::norm(w);
+        const cv::Matx33d W(0, -w[2], w[1],
+                            w[2], 0, -w[0],
+                            -w[1], w[0], 0);
+        if (theta < 1e-12)
+            return cv::Matx33d::eye() + W;
+        const double a = std::sin(theta) / theta;
+        const double b = (1 - std::cos(theta)) / (theta * theta);
+        return cv::Matx33d::eye() + a * W + b * (W * W);
+    }
+
+    // Pixel at which pose and K project X. A and B, if A is not NULL,
+    // receive the derivatives with respect to [dr dt] and X.
+    static cv::Vec2d project(const BundleAdjustmentIntrinsics &K,
+                             const Pose &pose, const cv::Vec3d &X,
+                             Matx26d *A, Matx23d *B)
+    {
+        const cv::Vec3d RX = pose.R * X;
+        const cv::Vec3d Xc = RX + pose.t;
+        const double iz = 1.0 / Xc[2];
+        const double x = Xc[0] * iz, y = Xc[1] * iz;
+        const double r2 = x * x + y * y;
+        const double radial = 1 + r2 * (K.k1 + r2 * (K.k2 + r2 * K.k3));
+        const double xd = x * radial + 2 * K.p1 * x * y + K.p2 * (r2 + 2 * x * x);
+        const double yd = y * radial + K.p1 * (r2 + 2 * y * y) + 2 * K.p2 * x * y;
+
+        if (A != NULL)
+        {
+            // distortion, then focal length and skew
+            const double dRadial = 2 * (K.k1 + r2 * (2 * K.k2 + 3 * K.k3 * r2));
+            const double dxdx = radial + dRadial * x * x + 2 * K.p1 * y + 6 * K.p2 * x;
+            const double dxdy = dRadial * x * y + 2 * K.p1 * x + 2 * K.p2 * y;
+            const double dydx = dRadial * x * y + 2 * K.p1 * x + 2 * K.p2 * y;
+            const double dydy = radial + dRadial * y * y + 6 * K.p1 * y + 2 * K.p2 * x;
+            const cv::Matx22d J(K.fx * dxdx + K.skew * dydx, K.fx * dxdy + K.skew * dydy,
+                                K.fy * dydx, K.fy * dydy);
+            // perspective division
+            const Matx23d P = J * Matx23d(iz, 0, -x * iz,
+                                          0, iz, -y * iz);
+            // d(exp([dr]x)*RX)/d(dr) = -[RX]x
+            const Matx23d Pr = P * cv::Matx33d(0, RX[2], -RX[1],
+                                               -RX[2], 0, RX[0],
+                                               RX[1], -RX[0], 0);
+            for (int r = 0; r < 2; ++r)
+            {
+                for (int c = 0; c < 3; ++c)
+                {
+                    (*A)(r, c) = Pr(r, c);
+                    (*A)(r, c + 3) = P(r, c);
+                }
+            }
+            *B = P * pose.R;
+        }
+        return cv::Vec2d(K.fx * xd + K.skew * yd + K.cx, K.fy * yd + K.cy);
+    }
+
+    // Sorts the observations by point, in a stable way
+    void sortObservations(const double *measurements, const int32_T *pointIndex,
+                          const int32_T *viewIndex)
+    {
+        mPointStart.assign(mNumPoints + 1, 0);
+        for (int k = 0; k < mNumObs; ++k)
+            mPointStart[pointIndex[k] + 1]++;
+        for (int i = 0; i < mNumPoints; ++i)
+            mPointStart[i + 1] += mPointStart[i];
+
+        std::vector<int> next(mPointStart.begin(), mPointStart.end() - 1);
+        mObsView.resize(mNumObs);
+        mMeas.resize(mNumObs);
+        for (int k = 0; k < mNumObs; ++k)
+        {
+            const int o = next[pointIndex[k]]++;
+            mObsView[o] = viewIndex[k];
+            mMeas[o] = cv::Vec2d(measurements[2 * k], measurements[2 * k + 1]);
+        }
+    }
+
+    // Observations of each refined camera, and the blocks of the reduced
+    // camera system: the cameras of row j are those sharing a point with
+    // camera j. mPairBlock lists, for each observation of each camera j and
+    // each observation of its point by a refined camera k, the block (j, k).
+    void buildStructure()
+    {
+        mObsPoint.resize(mNumObs);
+        for (int i = 0; i < mNumPoints; ++i)
+        {
+            for (int o = mPointStart[i]; o < mPointStart[i + 1]; ++o)
+                mObsPoint[o] = i;
+        }
+
+        mVarObsStart.assign(mNumVar + 1, 0);
+        for (int o = 0; o < mNumObs; ++o)
+        {
+            if (mCamVar[mObsView[o]] >= 0)
+                mVarObsStart[mCamVar[mObsView[o]] + 1]++;
+        }
+        for (int j = 0; j < mNumVar; ++j)
+            mVarObsStart[j + 1] += mVarObsStart[j];
+        mVarObs.resize(mVarObsStart[mNumVar]);
+        std::vector<int> next(mVarObsStart.begin(), mVarObsStart.end() - 1);
+        for (int o = 0; o < mNumObs; ++o)
+        {
+            if (mCamVar[mObsView[o]] >= 0)
+                mVarObs[next[mCamVar[mObsView[o]]]++] = o;
+        }
+
+        mRowStart.assign(mNumVar + 1, 0);
+        mBlockCol.clear();
+        mDiagBlock.resize(mNumVar);
+        mPairStart.resize(mVarObs.size() + 1);
+        mPairBlock.clear();
+        std::vector<int> blockOf(mNumVar, -1);
+        for (int j = 0; j < mNumVar; ++j)
+        {
+            std::vector<int> cols(1, j);
+            for (int p = mVarObsStart[j]; p < mVarObsStart[j + 1]; ++p)
+            {
+                const int i = mObsPoint[mVarObs[p]];
+                for (int o = mPointStart[i]; o < mPointStart[i + 1]; ++o)
+                {
+                    if (mCamVar[mObsView[o]] >= 0)
+                        cols.push_back(mCamVar[mObsView[o]]);
+                }
+            }
+            std::sort(cols.begin(), cols.end());
+            cols.erase(std::unique(cols.begin(), cols.end()), cols.end());
+            for (size_t c = 0; c < cols.size(); ++c)
+            {
+                blockOf[cols[c]] = (int)mBlockCol.size();
+                mBlockCol.push_back(cols[c]);
+            }
+            mRowStart[j + 1] = (int)mBlockCol.size();
+            mDiagBlock[j] = blockOf[j];
+
+            for (int p = mVarObsStart[j]; p < mVarObsStart[j + 1]; ++p)
+            {
+                const int i = mObsPoint[mVarObs[p]];
+                mPairStart[p] = (int)mPairBlock.size();
+                for (int o = mPointStart[i]; o < mPointStart[i + 1]; ++o)
+                {
+                    if (mCamVar[mObsView[o]] >= 0)
+                        mPairBlock.push_back(blockOf[mCamVar[mObsView[o]]]);
+                }
+            }
+        }
+        mPairStart[mVarObs.size()] = (int)mPairBlock.size();
+
+        mRes.resize(mNumObs);
+        mA.resize(mNumObs);
+        mB.resize(mNumObs);
+        mW.resize(mNumObs);
+        mY.resize(mNumObs);
+        mU.resize(mNumVar);
+        mEa.resize(mNumVar);
+        mDa.resize(mNumVar);
+        mV.resize(mNumPoints);
+        mVinv.resize(mNumPoints);
+        mEb.resize(mNumPoints);
+        mDb.resize(mNumPoints);
+        mS.resize(mBlockCol.size());
+        mRhs.resize(mNumVar);
+    }
+
+    const BundleAdjustmentIntrinsics &intrinsicsOf(int view) const
+    {
+        return mIntrinsics[(mIntrinsics.size() > 1) ? view : 0];
+    }
+
+    // Sum of the squared reprojection errors. The residuals, projected
+    // minus measured, are kept in mRes and, with linearize, their
+    // derivatives in mA and mB.
+    double evaluate(const double *points, const std::vector<Pose> &poses,
+                    bool linearize)
+    {
+        std::vector<double> sums(numBlocks(mNumPoints), 0.0);
+#ifdef PARALLEL
+        forEachBlock(mNumPoints, [&](int b, int start, int end) {
+            sums[b] = evaluatePoints(points, poses, linearize, start, end);
+        });
+#else
+        for (int b = 0; b < (int)sums.size(); ++b)
+        {
+            const int start = b * BA_BLOCK_SIZE;
+            sums[b] = evaluatePoints(points, poses, linearize, start,
+                                     std::min(start + BA_BLOCK_SIZE, mNumPoints));
+        }
+#endif
+        double total = 0;
+        for (size_t b = 0; b < sums.size(); ++b)
+            total += sums[b];
+        return total;
+    }
+
+    // Squared reprojection errors of the points [start, end), see evaluate
+    double evaluatePoints(const double *points, const std::vector<Pose> &poses,
+                          bool linearize, int start, int end)
+    {
+        double sum = 0;
+        for (int i = start; i < end; ++i)
+        {
+            const cv::Vec3d X(points + 3 * i);
+            for (int o = mPointStart[i]; o < mPointStart[i + 1]; ++o)
+            {
+                const int j = mObsView[o];
+                mRes[o] = project(intrinsicsOf(j), poses[j], X,
+                                  linearize ? &mA[o] : NULL, &mB[o]) - mMeas[o];
+                sum += mRes[o].dot(mRes[o]);
+            }
+        }
+        return sum;
+    }
+
+    // U, ea, V, eb and W of the linearization; ea and eb are minus the
+    // gradient
+    void buildNormalEquations()
+    {
+#ifdef PARALLEL
+        forEachBlock(mNumPoints, [&](int, int start, int end) {
+            buildPointEquations(start, end);
+        });
+        forEachBlock(mNumVar, [&](int, int start, int end) {
+            buildCameraEquations(start, end);
+        });
+#else
+        buildPointEquations(0, mNumPoints);
+        buildCameraEquations(0, mNumVar);
+#endif
+    }
+
+    // V, eb and W of the points [start, end)
+    void buildPointEquations(int start, int end)
+    {
+        for (int i = start; i < end; ++i)
+        {
+            cv::Matx33d V = cv::Matx33d::zeros();
+            cv::Vec3d eb(0, 0, 0);
+            for (int o = mPointStart[i]; o < mPointStart[i + 1]; ++o)
+            {
+                const Matx23d &B = mB[o];
+                V += B.t() * B;
+                eb -= B.t() * mRes[o];
+                if (mCamVar[mObsView[o]] >= 0)
+                    mW[o] = mA[o].t() * B;
+            }
+            mV[i] = V;
+            mEb[i] = eb;
+        }
+    }
+
+    // U and ea of the refined cameras [start, end)
+    void buildCameraEquations(int start, int end)
+    {
+        for (int j = start; j < end; ++j)
+        {
+            cv::Matx66d U = cv::Matx66d::zeros();
+            cv::Vec6d ea = cv::Vec6d::all(0);
+            for (int p = mVarObsStart[j]; p < mVarObsStart[j + 1]; ++p)
+            {
+                const Matx26d &A = mA[mVarObs[p]];
+                U += A.t() * A;
+                ea -= A.t() * mRes[mVarObs[p]];
+            }
+            mU[j] = U;
+            mEa[j] = ea;
+        }
+    }
+
+    // Solves the damped normal equations for mDa and mDb
+    bool solveStep(const BundleAdjustmentParams &params, double mu)
+    {
+        bool isSolved = true;
+
+#ifdef PARALLEL
+        forEachBlock(mNumPoints, [&](int, int start, int end) {
+            invertPoints(mu, start, end);
+        });
+        forEachBlock(mNumVar, [&](int, int start, int end) {
+            reduceCameras(mu, start, end);
+        });
+#else
+        invertPoints(mu, 0, mNumPoints);
+        reduceCameras(mu, 0, mNumVar);
+#endif
+
+        if (mNumVar > 0)
+            isSolved = mUseCG ? solveCG(params) : solveCholesky();
+
+#ifdef PARALLEL
+        forEachBlock(mNumPoints, [&](int, int start, int end) {
+            backSubstitutePoints(start, end);
+        });
+#else
+        backSubstitutePoints(0, mNumPoints);
+#endif
+
+        for (int j = 0; j < mNumVar && isSolved; ++j)
+            isSolved = isFinite(mDa[j].dot(mDa[j]));
+        return isSolved;
+    }
+
+    // V* inverses of the points [start, end), and Y = W*V*^-1 of their
+    // observations by refined cameras
+    void invertPoints(double mu, int start, int end)
+    {
+        for (int i = start; i < end; ++i)
+        {
+            mVinv[i] = (mV[i] + mu * cv::Matx33d::eye()).inv(cv::DECOMP_CHOLESKY);
+            for (int o = mPointStart[i]; o < mPointStart[i + 1]; ++o)
+            {
+                if (mCamVar[mObsView[o]] >= 0)
+                    mY[o] = mW[o] * mVinv[i];
+            }
+        }
+    }
+
+    // rows [start, end) of the reduced camera system
+    void reduceCameras(double mu, int start, int end)
+    {
+        for (int j = start; j < end; ++j)
+        {
+            for (int b = mRowStart[j]; b < mRowStart[j + 1]; ++b)
+                mS[b] = cv::Matx66d::zeros();
+            mS[mDiagBlock[j]] = mU[j] + mu * cv::Matx66d::eye();
+            cv::Vec6d rhs = mEa[j];
+            for (int p = mVarObsStart[j]; p < mVarObsStart[j + 1]; ++p)
+            {
+                const int o = mVarObs[p];
+                const int i = mObsPoint[o];
+                const Matx63d &Y = mY[o];
+                rhs -= Y * mEb[i];
+                int pair = mPairStart[p];
+                for (int o2 = mPointStart[i]; o2 < mPointStart[i + 1]; ++o2)
+                {
+                    if (mCamVar[mObsView[o2]] >= 0)
+                        mS[mPairBlock[pair++]] -= Y * mW[o2].t();
+                }
+            }
+            mRhs[j] = rhs;
+        }
+    }
+
+    // back substitution of the points [start, end)
+    void backSubstitutePoints(int start, int end)
+    {
+        for (int i = start; i < end; ++i)
+        {
+            cv::Vec3d eb = mEb[i];
+            for (int o = mPointStart[i]; o < mPointStart[i + 1]; ++o)
+            {
+                const int j = mCamVar[mObsView[o]];
+                if (j >= 0)
+                    eb -= mW[o].t() * mDa[j];
+            }
+            mDb[i] = mVinv[i] * eb;
+        }
+    }
+
+    // Dense Cholesky of the reduced system, for the smaller problems
+    bool solveCholesky()
+    {
+        const int n = 6 * mNumVar;
+        std::vector<double> S((size_t)n * n, 0.0);
+        std::vector<double> x((size_t)n);
+        for (int j = 0; j < mNumVar; ++j)
+        {
+            for (int b = mRowStart[j]; b < mRowStart[j + 1]; ++b)
+            {
+                const int k = mBlockCol[b];
+                for (int r = 0; r < 6; ++r)
+                {
+                    for (int c = 0; c < 6; ++c)
+                        S[(size_t)(6 * j + r) * n + 6 * k + c] = mS[b](r, c);
+                }
+            }
+            for (int r = 0; r < 6; ++r)
+                x[6 * j + r] = mRhs[j][r];
+        }
+        if (!cv::Cholesky(&S[0], n * sizeof(double), n, &x[0], sizeof(double), 1))
+            return false;
+        for (int j = 0; j < mNumVar; ++j)
+        {
+            for (int r = 0; r < 6; ++r)
+                mDa[j][r] = x[6 * j + r];
+        }
+        return true;
+    }
+
+    // y = S*x, by rows of blocks
+    void multiplyS(const std::vector<cv::Vec6d> &x, std::vector<cv::Vec6d> &y)
+    {
+#ifdef PARALLEL
+        forEachBlock(mNumVar, [&](int, int start, int end) {
+            multiplyRows(x, y, start, end);
+        });
+#else
+        multiplyRows(x, y, 0, mNumVar);
+#endif
+    }
+
+    // rows [start, end) of y = S*x
+    void multiplyRows(const std::vector<cv::Vec6d> &x, std::vector<cv::Vec6d> &y,
+                      int start, int end)
+    {
+        for (int j = start; j < end; ++j)
+        {
+            cv::Vec6d sum = cv::Vec6d::all(0);
+            for (int b = mRowStart[j]; b < mRowStart[j + 1]; ++b)
+                sum += mS[b] * x[mBlockCol[b]];
+            y[j] = sum;
+        }
+    }
+
+    // inverses of the diagonal blocks [start, end) of S, and z = Minv*r
+    void invertDiagonal(std::vector<cv::Matx66d> &Minv, const std::vector<cv::Vec6d> &r,
+                        std::vector<cv::Vec6d> &z, int start, int end)
+    {
+        for (int j = start; j < end; ++j)
+        {
+            Minv[j] = mS[mDiagBlock[j]].inv(cv::DECOMP_CHOLESKY);
+            z[j] = Minv[j] * r[j];
+        }
+    }
+
+    static double dot(const std::vector<cv::Vec6d> &a, const std::vector<cv::Vec6d> &b)
+    {
+        double sum = 0;
+        for (size_t j = 0; j < a.size(); ++j)
+            sum += a[j].dot(b[j]);
+        return sum;
+    }
+
+    // Conjugate gradients preconditioned by the inverses of the diagonal
+    // blocks of S
+    bool solveCG(const BundleAdjustmentParams &params)
+    {
+        const int maxIterations = (params.maxPCGIterations > 0) ?
+                                  params.maxPCGIterations : 6 * mNumVar;
+        std::vector<cv::Matx66d> Minv(mNumVar);
+        std::vector<cv::Vec6d> r(mRhs), z(mNumVar), p(mNumVar), q(mNumVar);
+
+#ifdef PARALLEL
+        forEachBlock(mNumVar, [&](int, int start, int end) {
+            invertDiagonal(Minv, r, z, start, end);
+        });
+#else
+        invertDiagonal(Minv, r, z, 0, mNumVar);
+#endif
+        std::fill(mDa.begin(), mDa.end(), cv::Vec6d::all(0));
+        p = z;
+
+        const double rhsNorm = std::sqrt(dot(r, r));
+        double rz = dot(r, z);
+        if (rhsNorm == 0)
+            return true;
+        for (int it = 0; it < maxIterations; ++it)
+        {
+            multiplyS(p, q);
+            const double pq = dot(p, q);
+            if (!(pq > 0))
+                return it > 0;
+            const double alpha = rz / pq;
+            for (int j = 0; j < mNumVar; ++j)
+            {
+                mDa[j] += alpha * p[j];
+                r[j] -= alpha * q[j];
+            }
+            if (std::sqrt(dot(r, r)) <= params.pcgTolerance * rhsNorm)
+                break;
+
+            for (int j = 0; j < mNumVar; ++j)
+                z[j] = Minv[j] * r[j];
+            const double rzNext = dot(r, z);
+            const double beta = rzNext / rz;
+            rz = rzNext;
+            for (int j = 0; j < mNumVar; ++j)
+                p[j] = z[j] + beta * p[j];
+        }
+        return true;
+    }
+
+    int mNumPoints;
+    int mNumViews;
+    int mNumObs;
+    int mNumVar;
+    bool mUseCG;
+    std::vector<BundleAdjustmentIntrinsics> mIntrinsics;
+
+    // observations sorted by point
+    std::vector<int> mPointStart;
+    std::vector<int> mObsPoint;
+    std::vector<int> mObsView;
+    std::vector<cv::Vec2d> mMeas;
+
+    // refined camera of each view, -1 if fixed, and its observations
+    std::vector<int> mCamVar;
+    std::vector<int> mVarObsStart;
+    std::vector<int> mVarObs;
+
+    // block structure of the reduced camera system
+    std::vector<int> mRowStart;
+    std::vector<int> mBlockCol;
+    std::vector<int> mDiagBlock;
+    std::vector<int> mPairStart;
+    std::vector<int> mPairBlock;
+
+    // linearization and normal equations
+    std::vector<cv::Vec2d> mRes;
+    std::vector<Matx26d> mA;
+    std::vector<Matx23d> mB;
+    std::vector<Matx63d> mW;
+    std::vector<Matx63d> mY;
+    std::vector<cv::Matx66d> mU;
+    std::vector<cv::Vec6d> mEa;
+    std::vector<cv::Matx33d> mV;
+    std::vector<cv::Matx33d> mVinv;
+    std::vector<cv::Vec3d> mEb;
+    std::vector<cv::Matx66d> mS;
+    std::vector<cv::Vec6d> mRhs;
+    std::vector<cv::Vec6d> mDa;
+    std::vector<cv::Vec3d> mDb;
+
+    // copying and assignment are disallowed
+    BundleAdjuster(const BundleAdjuster &);
+    BundleAdjuster &operator=(const BundleAdjuster &);
+};
+
+} // namespace sfm
+
+#endif
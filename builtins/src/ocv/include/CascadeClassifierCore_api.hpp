@@ -10,7 +10,19 @@ EXTERN_C LIBMWCVSTRT_API int32_T cascadeClassifier_detectMultiScale(void *ptrCla
 	double scaleFactor, uint32_T minNeighbors, 
     int32_T *ptrMinSize, int32_T *ptrMaxSize);
 
+EXTERN_C LIBMWCVSTRT_API void cascadeClassifier_detectMultiScaleMulti(void **ptrClasses, int32_T numClassifiers,
+	void **ptr2ptrDetectedObj, int32_T *numDetectedObj,
+	uint8_T *inImg, int32_T nRows, int32_T nCols, 
+	double scaleFactor, uint32_T *minNeighbors, 
+    int32_T *ptrMinSize, int32_T *ptrMaxSize);
+
+EXTERN_C LIBMWCVSTRT_API int32_T cascadeClassifier_detectMultiScaleROI(void *ptrClass, void **ptr2ptrDetectedObj,
+	uint8_T *inImg, int32_T nRows, int32_T nCols,
+	double scaleFactor, uint32_T minNeighbors,
+	int32_T *ptrROIs, int32_T numROIs, int32_T *ptrMinSizes, int32_T *ptrMaxSizes);
+
 EXTERN_C LIBMWCVSTRT_API void cascadeClassifier_load(void *ptrClass, const char * filename);
+EXTERN_C LIBMWCVSTRT_API boolean_T cascadeClassifier_convertToBinary(const char *xmlFilename, const char *binFilename);
 EXTERN_C LIBMWCVSTRT_API void cascadeClassifier_getClassifierInfo(void *ptrClass, 
 	uint32_T *originalWindowSize, uint32_T *featureTypeID);
 EXTERN_C LIBMWCVSTRT_API void cascadeClassifier_construct(void **ptr2ptrClass);
@@ -18,4 +30,25 @@ EXTERN_C LIBMWCVSTRT_API void cascadeClassifier_assignOutputDeleteBbox(void *ptr
 EXTERN_C LIBMWCVSTRT_API void cascadeClassifier_assignOutputDeleteBboxRM(void *ptrDetectedObj, int32_T *outBBox);
 EXTERN_C LIBMWCVSTRT_API void cascadeClassifier_deleteObj(void *ptrClass);
 
+/* cascade detection on a CUDA device. device is the index of the CUDA
+ * device. construct sets *ptr2ptrClass to NULL when the device is not
+ * available or OpenCV was built without CUDA object detection, and load
+ * returns false for a cascade the CUDA classifier cannot read; the caller
+ * then uses the CPU classifier. The detections are freed by
+ * cascadeClassifier_assignOutputDeleteBbox. */
+EXTERN_C LIBMWCVSTRT_API void cascadeClassifierCuda_construct(void **ptr2ptrClass, int32_T device);
+EXTERN_C LIBMWCVSTRT_API boolean_T cascadeClassifierCuda_load(void *ptrClass, const char * filename);
+EXTERN_C LIBMWCVSTRT_API int32_T cascadeClassifierCuda_detectMultiScale(void *ptrClass, void **ptr2ptrDetectedObj,
+	uint8_T *inImg, int32_T nRows, int32_T nCols,
+	double scaleFactor, uint32_T minNeighbors,
+	int32_T *ptrMinSize, int32_T *ptrMaxSize);
+/* detectMultiScaleImage reads the image from an image handle (see
+ * imageHandleCore_api.hpp), on the device when it is on the device of the
+ * classifier. */
+EXTERN_C LIBMWCVSTRT_API int32_T cascadeClassifierCuda_detectMultiScaleImage(void *ptrClass, void **ptr2ptrDetectedObj,
+	void *ptrImage,
+	double scaleFactor, uint32_T minNeighbors,
+	int32_T *ptrMinSize, int32_T *ptrMaxSize);
+EXTERN_C LIBMWCVSTRT_API void cascadeClassifierCuda_deleteObj(void *ptrClass);
+
 #endif
@@ -0,0 +1,1370 @@
+//////////////////////////////////////////////////////////////////////////////
+// Training of the boosted cascades of trainCascadeObjectDetector.
+//
+// The cascade is that of OpenCV traincascade with the parameters
+// trainCascadeObjectDetector passes to it: Gentle AdaBoost stages of
+// stumps on the Haar (BASIC), LBP or HOG features of a window. The
+// feature pool, the feature values, weight trimming, the stage threshold
+// and the XML file written are those of traincascade, so the file is read
+// by vision.CascadeObjectDetector.
+//
+// A stage is trained on the positives and negatives that pass the stages
+// so far:
+//  - the integral images of the samples are computed once, then as many
+//    features as the precalculation buffer holds are computed for all
+//    samples, one column per feature: the values and the samples sorted by
+//    value for ordered features, one byte per sample for LBP. The sorted
+//    indices are 16-bit when there are at most 65536 samples.
+//  - each round, the best split of every feature is searched in parallel
+//    over blocks of features; the features that are not precalculated are
+//    computed in the search.
+//  - negatives are mined from the negative images with the windows and
+//    scales of traincascade, in parallel over images: each scale level is
+//    integrated once and its windows are rejected stage by stage.
+//
+// Copyright 2016 The MathWorks, Inc.
+//
+//////////////////////////////////////////////////////////////////////////////
+#ifndef CASCADE_TRAINER
+#define CASCADE_TRAINER
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <string>
+#include <vector>
+
+#include "opencv2/core/core.hpp"
+#include "opencv2/imgproc/imgproc.hpp"
+
+#include "vision_defines.h"
+#include "cgThreadPool.hpp"
+
+// bins and cells of a HOG feature
+#define CASCADE_HOG_BINS 9
+#define CASCADE_HOG_CELLS 4
+// categories of an LBP feature, and the 32-bit words of a subset of them
+#define CASCADE_LBP_CATEGORIES 256
+#define CASCADE_LBP_SUBSET 8
+// of traincascade: a sample is rejected by a stage when its sum is below
+// the stage threshold minus CASCADE_THRESHOLD_EPS
+#define CASCADE_THRESHOLD_EPS 1e-5f
+// features searched by a task of the split search
+#define CASCADE_FEATURE_BLOCK 256
+
+namespace cascadetrainer
+{
+
+enum FeatureType
+{
+    FEATURE_HAAR = 0,
+    FEATURE_LBP = 1,
+    FEATURE_HOG = 2
+};
+
+struct StageParams
+{
+    double minHitRate;
+    double maxFalseAlarm;
+    double weightTrimRate;
+    int maxWeakCount;
+};
+
+// A feature of the pool. Haar: up to 3 weighted rectangles, the weight of
+// an unused one being 0. LBP: rect[0] is a block of the 3x3 blocks. HOG:
+// rect[0] is the first of the 2x2 cells, component the cell and bin.
+struct Feature
+{
+    int rect[3][4];
+    float weight[3];
+    int component;
+};
+
+// Offsets of the corners of the rectangles of a feature in integral images
+// of a given stride
+struct FeatureOffsets
+{
+    int p[16];
+    float weight[3];
+    int bin;
+};
+
+// Integral images of a window or an image, of stride cols + 1. sqsum is
+// used by Haar features only; hist holds the CASCADE_HOG_BINS histograms
+// then the gradient norm, plane apart.
+struct IntegralView
+{
+    const int *sum;
+    const double *sqsum;
+    const float *hist;
+    size_t plane;
+    int stride;
+};
+
+struct Stump
+{
+    int feature;
+    float threshold;
+    int subset[CASCADE_LBP_SUBSET];
+    float left;
+    float right;
+};
+
+struct Stage
+{
+    std::vector<Stump> stumps;
+    float threshold;
+};
+
+class CascadeTrainer
+{
+public:
+    // precalcBufSize is the memory, in bytes, of the precalculated features
+    CascadeTrainer(int featureType, int winWidth, int winHeight, size_t precalcBufSize)
+        : mFeatureType(featureType), mWinWidth(winWidth), mWinHeight(winHeight),
+          mPrecalcBufSize(precalcBufSize), mNegCursor(0), mNumPos(0), mNumSamples(0),
+          mNumPrecalc(0)
+    {
+        mParams.minHitRate = 0.995;
+        mParams.maxFalseAlarm = 0.5;
+        mParams.weightTrimRate = 0.95;
+        mParams.maxWeakCount = 100;
+        generateFeatures();
+    }
+
+    int getNumFeatures() const
+    {
+        return (int)mFeatures.size();
+    }
+
+    int getNumStages() const
+    {
+        return (int)mStages.size();
+    }
+
+    // samples is winHeight-by-winWidth-by-numSamples, column major unless
+    // isRowMajor
+    void addPositives(const uint8_T *samples, int numSamples, bool isRowMajor)
+    {
+        const int h = mWinHeight, w = mWinWidth;
+        const size_t area = (size_t)h * w, first = mPositives.size();
+        mPositives.resize(first + area * numSamples);
+        uint8_T *out = &mPositives[first];
+        for (int n = 0; n < numSamples; n++)
+        {
+            for (int r = 0; r < h; r++)
+            {
+                for (int c = 0; c < w; c++)
+                {
+                    const size_t in = isRowMajor
+                        ? ((size_t)r * w + c) * numSamples + n
+                        : n * area + (size_t)c * h + r;
+                    out[n * area + (size_t)r * w + c] = samples[in];
+                }
+            }
+        }
+    }
+
+    // image is rows-by-cols grayscale, column major unless isRowMajor.
+    // Images smaller than the window are ignored.
+    void addNegativeImage(const uint8_T *image, int rows, int cols, bool isRowMajor)
+    {
+        if (rows < mWinHeight || cols < mWinWidth)
+            return;
+
+        cv::Mat img(rows, cols, CV_8UC1);
+        for (int r = 0; r < rows; r++)
+        {
+            uint8_T *out = img.ptr<uint8_T>(r);
+            for (int c = 0; c < cols; c++)
+                out[c] = isRowMajor ? image[(size_t)r * cols + c] : image[(size_t)c * rows + r];
+        }
+        mNegatives.push_back(img);
+    }
+
+    // Trains the next stage on the first numPos positives that pass the
+    // stages so far and on numNeg negatives mined from the negative
+    // images. acceptanceRatio is the fraction of the negative windows
+    // scanned that passed. Returns the number of stumps of the stage, 0
+    // when not enough samples pass, in which case no stage is added.
+    int trainStage(int numPos, int numNeg, const StageParams &params, double &acceptanceRatio)
+    {
+        mParams = params;
+        acceptanceRatio = 0;
+
+        std::vector<uint8_T> windows;
+        if (selectPositives(numPos, windows) < numPos)
+            return 0;
+        if (mineNegatives(numNeg, windows, acceptanceRatio) < numNeg)
+            return 0;
+
+        mNumPos = numPos;
+        mNumSamples = numPos + numNeg;
+        computeSampleIntegrals(windows);
+        precalculate();
+
+        Stage stage;
+        boostStage(stage);
+        mStages.push_back(stage);
+
+        releaseSamples();
+        return (int)stage.stumps.size();
+    }
+
+    // Writes the cascade in the XML format of traincascade, with the
+    // features used only
+    bool write(const std::string &filename) const
+    {
+        cv::FileStorage fs(filename, cv::FileStorage::WRITE);
+        if (!fs.isOpened())
+            return false;
+
+        // used features in increasing order, and their index in the file
+        std::vector<int> map(mFeatures.size(), -1);
+        for (size_t s = 0; s < mStages.size(); s++)
+        {
+            for (size_t k = 0; k < mStages[s].stumps.size(); k++)
+                map[mStages[s].stumps[k].feature] = 0;
+        }
+        int numUsed = 0;
+        for (size_t f = 0; f < map.size(); f++)
+        {
+            if (map[f] >= 0)
+                map[f] = numUsed++;
+        }
+
+        static const char *typeNames[] = {"HAAR", "LBP", "HOG"};
+        fs << "cascade" << "{";
+        fs << "stageType" << "BOOST";
+        fs << "featureType" << typeNames[mFeatureType];
+        fs << "height" << mWinHeight;
+        fs << "width" << mWinWidth;
+
+        fs << "stageParams" << "{";
+        fs << "boostType" << "GAB";
+        fs << "minHitRate" << (float)mParams.minHitRate;
+        fs << "maxFalseAlarm" << (float)mParams.maxFalseAlarm;
+        fs << "weightTrimRate" << (float)mParams.weightTrimRate;
+        fs << "maxDepth" << 1;
+        fs << "maxWeakCount" << mParams.maxWeakCount;
+        fs << "}";
+
+        fs << "featureParams" << "{";
+        fs << "maxCatCount" << (mFeatureType == FEATURE_LBP ? CASCADE_LBP_CATEGORIES : 0);
+        fs << "featSize" << (mFeatureType == FEATURE_HOG ? CASCADE_HOG_BINS * CASCADE_HOG_CELLS : 1);
+        if (mFeatureType == FEATURE_HAAR)
+            fs << "mode" << "BASIC";
+        fs << "}";
+
+        fs << "stageNum" << (int)mStages.size();
+        fs << "stages" << "[";
+        for (size_t s = 0; s < mStages.size(); s++)
+        {
+            const Stage &stage = mStages[s];
+            fs << "{";
+            fs << "maxWeakCount" << (int)stage.stumps.size();
+            fs << "stageThreshold" << stage.threshold;
+            fs << "weakClassifiers" << "[";
+            for (size_t k = 0; k < stage.stumps.size(); k++)
+            {
+                const Stump &stump = stage.stumps[k];
+                fs << "{";
+                fs << "internalNodes" << "[:" << 0 << -1 << map[stump.feature];
+                if (mFeatureType == FEATURE_LBP)
+                {
+                    for (int j = 0; j < CASCADE_LBP_SUBSET; j++)
+                        fs << stump.subset[j];
+                }
+                else
+                {
+                    fs << stump.threshold;
+                }
+                fs << "]";
+                fs << "leafValues" << "[:" << stump.left << stump.right << "]";
+                fs << "}";
+            }
+            fs << "]";
+            fs << "}";
+        }
+        fs << "]";
+
+        fs << "features" << "[";
+        for (size_t f = 0; f < mFeatures.size(); f++)
+        {
+            if (map[f] < 0)
+                continue;
+            const Feature &feature = mFeatures[f];
+            const int *r = feature.rect[0];
+            fs << "{";
+            if (mFeatureType == FEATURE_HAAR)
+            {
+                fs << "rects" << "[";
+                for (int k = 0; k < 3 && feature.weight[k] != 0; k++)
+                {
+                    r = feature.rect[k];
+                    fs << "[:" << r[0] << r[1] << r[2] << r[3] << feature.weight[k] << "]";
+                }
+                fs << "]";
+                fs << "tilted" << 0;
+            }
+            else if (mFeatureType == FEATURE_LBP)
+            {
+                fs << "rect" << "[:" << r[0] << r[1] << r[2] << r[3] << "]";
+            }
+            else
+            {
+                fs << "rect" << "[:" << r[0] << r[1] << r[2] << r[3] << feature.component << "]";
+            }
+            fs << "}";
+        }
+        fs << "]";
+        fs << "}";
+        return true;
+    }
+
+private:
+    //------------------------------------------------------------------------
+    // feature pool
+    //------------------------------------------------------------------------
+    static Feature makeFeature(int x0, int y0, int w0, int h0, float weight0,
+                               int x1, int y1, int w1, int h1, float weight1,
+                               int x2 = 0, int y2 = 0, int w2 = 0, int h2 = 0,
+                               float weight2 = 0)
+    {
+        Feature f;
+        const int r[3][4] = {{x0, y0, w0, h0}, {x1, y1, w1, h1}, {x2, y2, w2, h2}};
+        const float weight[3] = {weight0, weight1, weight2};
+        for (int k = 0; k < 3; k++)
+        {
+            for (int j = 0; j < 4; j++)
+                f.rect[k][j] = r[k][j];
+            f.weight[k] = weight[k];
+        }
+        f.component = 0;
+        return f;
+    }
+
+    static Feature makeBlockFeature(int x, int y, int w, int h, int component)
+    {
+        Feature f = makeFeature(x, y, w, h, 0, 0, 0, 0, 0, 0);
+        f.component = component;
+        return f;
+    }
+
+    // The features of traincascade, in its order
+    void generateFeatures()
+    {
+        const int W = mWinWidth, H = mWinHeight;
+        mFeatures.clear();
+
+        if (mFeatureType == FEATURE_HAAR)
+        {
+            // BASIC mode
+            for (int x = 0; x < W; x++)
+                for (int y = 0; y < H; y++)
+                    for (int dx = 1; dx <= W; dx++)
+                        for (int dy = 1; dy <= H; dy++)
+                        {
+                            if (x + dx * 2 <= W && y + dy <= H)
+                                mFeatures.push_back(makeFeature(x, y, dx * 2, dy, -1, x + dx, y, dx, dy, +2));
+                            if (x + dx <= W && y + dy * 2 <= H)
+                                mFeatures.push_back(makeFeature(x, y, dx, dy * 2, -1, x, y + dy, dx, dy, +2));
+                            if (x + dx * 3 <= W && y + dy <= H)
+                                mFeatures.push_back(makeFeature(x, y, dx * 3, dy, -1, x + dx, y, dx, dy, +3));
+                            if (x + dx <= W && y + dy * 3 <= H)
+                                mFeatures.push_back(makeFeature(x, y, dx, dy * 3, -1, x, y + dy, dx, dy, +3));
+                            if (x + dx * 2 <= W && y + dy * 2 <= H)
+                                mFeatures.push_back(makeFeature(x, y, dx * 2, dy * 2, -1, x, y, dx, dy, +2,
+                                                                x + dx, y + dy, dx, dy, +2));
+                        }
+        }
+        else if (mFeatureType == FEATURE_LBP)
+        {
+            for (int x = 0; x < W; x++)
+                for (int y = 0; y < H; y++)
+                    for (int w = 1; w <= W / 3; w++)
+                        for (int h = 1; h <= H / 3; h++)
+                            if (x + 3 * w <= W && y + 3 * h <= H)
+                                mFeatures.push_back(makeBlockFeature(x, y, w, h, 0));
+        }
+        else
+        {
+            // cells of t pixels and blocks of 2x2 cells, 3 aspect ratios,
+            // each cell and bin being a feature
+            const int blockStep = 4;
+            for (int t = 8; t <= W / 2; t += 8)
+            {
+                const int cells[3][2] = {{t, t}, {t, 2 * t}, {2 * t, t}};
+                for (int k = 0; k < 3; k++)
+                {
+                    const int cw = cells[k][0], ch = cells[k][1];
+                    for (int x = 0; x <= W - 2 * cw; x += blockStep)
+                        for (int y = 0; y <= H - 2 * ch; y += blockStep)
+                            for (int c = 0; c < CASCADE_HOG_BINS * CASCADE_HOG_CELLS; c++)
+                                mFeatures.push_back(makeBlockFeature(x, y, cw, ch, c));
+                }
+            }
+        }
+    }
+
+    static void cornerOffsets(int x, int y, int w, int h, int stride, int *p)
+    {
+        p[0] = y * stride + x;
+        p[1] = p[0] + w;
+        p[2] = p[0] + h * stride;
+        p[3] = p[2] + w;
+    }
+
+    FeatureOffsets makeOffsets(const Feature &f, int stride) const
+    {
+        FeatureOffsets o;
+        std::fill(o.p, o.p + 16, 0);
+        o.weight[0] = f.weight[0];
+        o.weight[1] = f.weight[1];
+        o.weight[2] = f.weight[2];
+        o.bin = 0;
+
+        const int *r = f.rect[0];
+        if (mFeatureType == FEATURE_HAAR)
+        {
+            for (int k = 0; k < 3; k++)
+                cornerOffsets(f.rect[k][0], f.rect[k][1], f.rect[k][2], f.rect[k][3], stride,
+                              o.p + 4 * k);
+        }
+        else if (mFeatureType == FEATURE_LBP)
+        {
+            // the 4x4 corners of the 3x3 blocks
+            for (int i = 0; i < 4; i++)
+                for (int j = 0; j < 4; j++)
+                    o.p[4 * i + j] = (r[1] + i * r[3]) * stride + r[0] + j * r[2];
+        }
+        else
+        {
+            const int cell = f.component / CASCADE_HOG_BINS;
+            o.bin = f.component % CASCADE_HOG_BINS;
+            cornerOffsets(r[0] + (cell & 1) * r[2], r[1] + (cell >> 1) * r[3], r[2], r[3],
+                          stride, o.p);
+            cornerOffsets(r[0], r[1], 2 * r[2], 2 * r[3], stride, o.p + 4);
+        }
+        return o;
+    }
+
+    //------------------------------------------------------------------------
+    // feature values
+    //------------------------------------------------------------------------
+    template <typename T>
+    static T rectSum(const T *s, const int *p)
+    {
+        return s[p[0]] - s[p[1]] - s[p[2]] + s[p[3]];
+    }
+
+    // 1 / standard deviation times area of the window at origin, without
+    // its border pixels, as the Haar evaluator of detection
+    float windowInvNorm(const IntegralView &v, size_t origin) const
+    {
+        int p[4];
+        cornerOffsets(1, 1, mWinWidth - 2, mWinHeight - 2, v.stride, p);
+        const double area = (double)(mWinWidth - 2) * (mWinHeight - 2);
+        const double sum = (double)rectSum(v.sum + origin, p);
+        const double sqsum = rectSum(v.sqsum + origin, p);
+        double nf = area * sqsum - sum * sum;
+        nf = nf > 0 ? std::sqrt(nf) : 1.;
+        return (float)(1. / nf);
+    }
+
+    static float haarValue(const FeatureOffsets &o, const IntegralView &v, size_t origin,
+                           float invNorm)
+    {
+        const int *s = v.sum + origin;
+        float value = o.weight[0] * (float)rectSum(s, o.p) + o.weight[1] * (float)rectSum(s, o.p + 4);
+        if (o.weight[2] != 0)
+            value += o.weight[2] * (float)rectSum(s, o.p + 8);
+        return value * invNorm;
+    }
+
+    static int lbpCode(const FeatureOffsets &o, const IntegralView &v, size_t origin)
+    {
+        const int *s = v.sum + origin;
+        const int *p = o.p;
+#define CASCADE_BLOCK(a, b, c, d) (s[p[a]] - s[p[b]] - s[p[c]] + s[p[d]])
+        const int center = CASCADE_BLOCK(5, 6, 9, 10);
+        // clockwise from the top left block
+        return (CASCADE_BLOCK(0, 1, 4, 5) >= center ? 128 : 0) |
+               (CASCADE_BLOCK(1, 2, 5, 6) >= center ? 64 : 0) |
+               (CASCADE_BLOCK(2, 3, 6, 7) >= center ? 32 : 0) |
+               (CASCADE_BLOCK(6, 7, 10, 11) >= center ? 16 : 0) |
+               (CASCADE_BLOCK(10, 11, 14, 15) >= center ? 8 : 0) |
+               (CASCADE_BLOCK(9, 10, 13, 14) >= center ? 4 : 0) |
+               (CASCADE_BLOCK(8, 9, 12, 13) >= center ? 2 : 0) |
+               (CASCADE_BLOCK(4, 5, 8, 9) >= center ? 1 : 0);
+#undef CASCADE_BLOCK
+    }
+
+    static float hogValue(const FeatureOffsets &o, const IntegralView &v, size_t origin)
+    {
+        const float value = rectSum(v.hist + o.bin * v.plane + origin, o.p);
+        const float norm = rectSum(v.hist + CASCADE_HOG_BINS * v.plane + origin, o.p + 4);
+        return value > 0.001f ? value / (norm + 0.001f) : 0.f;
+    }
+
+    float orderedValue(const FeatureOffsets &o, const IntegralView &v, size_t origin,
+                       float invNorm) const
+    {
+        return mFeatureType == FEATURE_HAAR ? haarValue(o, v, origin, invNorm)
+                                            : hogValue(o, v, origin);
+    }
+
+    //------------------------------------------------------------------------
+    // integral images
+    //------------------------------------------------------------------------
+    struct Integrals
+    {
+        std::vector<int> sum;
+        std::vector<double> sqsum;
+        std::vector<float> hist;
+        int stride;
+
+        IntegralView view() const
+        {
+            IntegralView v;
+            v.sum = sum.empty() ? NULL : &sum[0];
+            v.sqsum = sqsum.empty() ? NULL : &sqsum[0];
+            v.hist = hist.empty() ? NULL : &hist[0];
+            v.plane = hist.size() / (CASCADE_HOG_BINS + 1);
+            v.stride = stride;
+            return v;
+        }
+    };
+
+    // img is a row major image of stride cols
+    void integrate(const uint8_T *img, int rows, int cols, Integrals &out) const
+    {
+        const int stride = cols + 1;
+        const size_t area = (size_t)(rows + 1) * stride;
+        out.stride = stride;
+        if (mFeatureType == FEATURE_HOG)
+        {
+            out.hist.resize((CASCADE_HOG_BINS + 1) * area);
+            integralHistogram(img, rows, cols, &out.hist[0]);
+            return;
+        }
+
+        out.sum.resize(area);
+        if (mFeatureType == FEATURE_HAAR)
+            out.sqsum.resize(area);
+        int *sum = &out.sum[0];
+        double *sqsum = out.sqsum.empty() ? NULL : &out.sqsum[0];
+        std::fill(sum, sum + stride, 0);
+        if (sqsum)
+            std::fill(sqsum, sqsum + stride, 0.);
+        for (int r = 0; r < rows; r++)
+        {
+            const uint8_T *in = img + (size_t)r * cols;
+            int *s = sum + (size_t)(r + 1) * stride;
+            int rowSum = 0;
+            s[0] = 0;
+            for (int c = 0; c < cols; c++)
+            {
+                rowSum += in[c];
+                s[c + 1] = s[c + 1 - stride] + rowSum;
+            }
+            if (sqsum)
+            {
+                double *q = sqsum + (size_t)(r + 1) * stride;
+                double rowSqSum = 0;
+                q[0] = 0;
+                for (int c = 0; c < cols; c++)
+                {
+                    rowSqSum += (double)in[c] * in[c];
+                    q[c + 1] = q[c + 1 - stride] + rowSqSum;
+                }
+            }
+        }
+    }
+
+    // Integral histograms of the gradient orientations, weighted by the
+    // gradient norm, and integral of the norm, as HOGEvaluator of detection
+    static void integralHistogram(const uint8_T *img, int rows, int cols, float *hist)
+    {
+        const int stride = cols + 1;
+        const size_t area = (size_t)(rows + 1) * stride;
+        std::fill(hist, hist + (CASCADE_HOG_BINS + 1) * area, 0.f);
+
+        cv::Mat dx(1, cols, CV_32F), dy(1, cols, CV_32F), mag(1, cols, CV_32F),
+            angle(1, cols, CV_32F);
+        float *pdx = dx.ptr<float>(), *pdy = dy.ptr<float>();
+        const float *pmag = mag.ptr<float>(), *pangle = angle.ptr<float>();
+        const float angleScale = (float)(CASCADE_HOG_BINS / CV_PI);
+        std::vector<float> rowSum(CASCADE_HOG_BINS + 1);
+
+        for (int y = 0; y < rows; y++)
+        {
+            const uint8_T *curr = img + (size_t)y * cols;
+            const uint8_T *prev = img + (size_t)std::max(y - 1, 0) * cols;
+            const uint8_T *next = img + (size_t)std::min(y + 1, rows - 1) * cols;
+            for (int x = 0; x < cols; x++)
+            {
+                pdx[x] = (float)(curr[std::min(x + 1, cols - 1)] - curr[std::max(x - 1, 0)]);
+                pdy[x] = (float)(next[x] - prev[x]);
+            }
+            cv::cartToPolar(dx, dy, mag, angle, false);
+
+            std::fill(rowSum.begin(), rowSum.end(), 0.f);
+            float *out = hist + (size_t)(y + 1) * stride + 1;
+            for (int x = 0; x < cols; x++)
+            {
+                int bin = cvFloor(pangle[x] * angleScale - 0.5f);
+                if (bin < 0)
+                    bin += CASCADE_HOG_BINS;
+                else if (bin >= CASCADE_HOG_BINS)
+                    bin -= CASCADE_HOG_BINS;
+                rowSum[bin] += pmag[x];
+                rowSum[CASCADE_HOG_BINS] += pmag[x];
+                for (int b = 0; b <= CASCADE_HOG_BINS; b++)
+                {
+                    float *plane = out + b * area;
+                    plane[x] = plane[x - stride] + rowSum[b];
+                }
+            }
+        }
+    }
+
+    //------------------------------------------------------------------------
+    // cascade evaluation
+    //------------------------------------------------------------------------
+    bool passesStages(const std::vector<FeatureOffsets> &offsets, const IntegralView &v,
+                      size_t origin) const
+    {
+        const float invNorm = mFeatureType == FEATURE_HAAR ? windowInvNorm(v, origin) : 1.f;
+        size_t k = 0;
+        for (size_t s = 0; s < mStages.size(); s++)
+        {
+            const Stage &stage = mStages[s];
+            double sum = 0;
+            for (size_t i = 0; i < stage.stumps.size(); i++, k++)
+            {
+                const Stump &stump = stage.stumps[i];
+                bool isLeft;
+                if (mFeatureType == FEATURE_LBP)
+                {
+                    const int c = lbpCode(offsets[k], v, origin);
+                    isLeft = (stump.subset[c >> 5] & (1 << (c & 31))) != 0;
+                }
+                else
+                {
+                    isLeft = orderedValue(offsets[k], v, origin, invNorm) < stump.threshold;
+                }
+                sum += isLeft ? stump.left : stump.right;
+            }
+            if (sum < stage.threshold - CASCADE_THRESHOLD_EPS)
+                return false;
+        }
+        return true;
+    }
+
+    // offsets of the stumps of all stages, in order
+    std::vector<FeatureOffsets> stageOffsets(int stride) const
+    {
+        std::vector<FeatureOffsets> offsets;
+        for (size_t s = 0; s < mStages.size(); s++)
+        {
+            for (size_t i = 0; i < mStages[s].stumps.size(); i++)
+                offsets.push_back(makeOffsets(mFeatures[mStages[s].stumps[i].feature], stride));
+        }
+        return offsets;
+    }
+
+    // Whether positive k passes the stages, in integrals a work buffer
+    bool positivePasses(const std::vector<FeatureOffsets> &offsets, int k,
+                        Integrals &integrals) const
+    {
+        const uint8_T *window = &mPositives[k * (size_t)mWinWidth * mWinHeight];
+        integrate(window, mWinHeight, mWinWidth, integrals);
+        return passesStages(offsets, integrals.view(), 0);
+    }
+
+    // Appends the first numPos positives that pass the stages to windows,
+    // returns their number
+    int selectPositives(int numPos, std::vector<uint8_T> &windows) const
+    {
+        const size_t area = (size_t)mWinWidth * mWinHeight;
+        const int numAvailable = (int)(mPositives.size() / area);
+        const std::vector<FeatureOffsets> offsets = stageOffsets(mWinWidth + 1);
+        const int numWorkers = std::max((int)cgGetNumThreads(), 1);
+        std::vector<Integrals> integrals(numWorkers);
+
+        int numSelected = 0;
+        for (int first = 0; first < numAvailable && numSelected < numPos;)
+        {
+            const int count = std::min(numAvailable - first, std::max(numPos - numSelected, 256));
+            std::vector<unsigned char> passes(count);
+#ifdef PARALLEL
+            cgParallelForWorkers(count, [&](int worker, int i) {
+                passes[i] = positivePasses(offsets, first + i, integrals[worker]);
+            });
+#else
+            for (int i = 0; i < count; i++)
+                passes[i] = positivePasses(offsets, first + i, integrals[0]);
+#endif
+            for (int i = 0; i < count && numSelected < numPos; i++)
+            {
+                if (passes[i])
+                {
+                    const uint8_T *window = &mPositives[(first + i) * area];
+                    windows.insert(windows.end(), window, window + area);
+                    numSelected++;
+                }
+            }
+            first += count;
+        }
+        return numSelected;
+    }
+
+    // windows of a negative image that pass the stages, in scan order
+    struct MinedWindows
+    {
+        std::vector<uint8_T> pixels;
+        std::vector<size_t> scanIndex;
+        size_t numScanned;
+    };
+
+    // Scans a negative image as NegReader of traincascade: windows at half
+    // window steps from an offset that changes each pass over the images,
+    // on levels upscaled by sqrt(2) from the level where the image is the
+    // size of the window plus offset, to the image itself
+    void scanNegative(const cv::Mat &src, long long round, Integrals &integrals,
+                      MinedWindows &mined) const
+    {
+        const int W = mWinWidth, H = mWinHeight;
+        const int area = W * H;
+        mined.pixels.clear();
+        mined.scanIndex.clear();
+        mined.numScanned = 0;
+
+        const int r = (int)(round % area);
+        const int ox = std::min(r % W, src.cols - W);
+        const int oy = std::min(r / W, src.rows - H);
+        const int stepX = W / 2, stepY = H / 2;
+        const float scaleFactor = 1.4142f;
+
+        float scale = std::max((float)(W + ox) / src.cols, (float)(H + oy) / src.rows);
+        cv::Mat level;
+        cv::resize(src, level, cv::Size((int)(scale * src.cols + 0.5f), (int)(scale * src.rows + 0.5f)));
+        while (true)
+        {
+            if (!level.isContinuous())
+                level = level.clone();
+            std::vector<FeatureOffsets> offsets;
+            IntegralView v = IntegralView();
+            if (!mStages.empty())
+            {
+                integrate(level.ptr<uint8_T>(), level.rows, level.cols, integrals);
+                offsets = stageOffsets(level.cols + 1);
+                v = integrals.view();
+            }
+
+            for (int y = oy;; y += stepY)
+            {
+                for (int x = ox;; x += stepX)
+                {
+                    const size_t origin = (size_t)y * (level.cols + 1) + x;
+                    if (mStages.empty() || passesStages(offsets, v, origin))
+                    {
+                        for (int i = 0; i < H; i++)
+                        {
+                            const uint8_T *row = level.ptr<uint8_T>(y + i) + x;
+                            mined.pixels.insert(mined.pixels.end(), row, row + W);
+                        }
+                        mined.scanIndex.push_back(mined.numScanned);
+                    }
+                    mined.numScanned++;
+                    if ((int)(x + 1.5f * W) >= level.cols)
+                        break;
+                }
+                if ((int)(y + 1.5f * H) >= level.rows)
+                    break;
+            }
+
+            scale *= scaleFactor;
+            if (scale > 1.f)
+                break;
+            cv::resize(src, level, cv::Size((int)(scale * src.cols), (int)(scale * src.rows)));
+        }
+    }
+
+    // Appends numNeg negative windows that pass the stages to windows,
+    // scanning the negative images from where the previous stage stopped,
+    // in parallel batches of images. Returns their number, less when a
+    // pass over all the images finds none.
+    int mineNegatives(int numNeg, std::vector<uint8_T> &windows, double &acceptanceRatio)
+    {
+        const size_t area = (size_t)mWinWidth * mWinHeight;
+        const long long numImages = (long long)mNegatives.size();
+        const int numWorkers = std::max((int)cgGetNumThreads(), 1);
+        std::vector<Integrals> integrals(numWorkers);
+        const int batchSize = (int)std::min<long long>(4 * numWorkers, std::max(numImages, 1LL));
+        std::vector<MinedWindows> mined(batchSize);
+
+        int numMined = 0;
+        double numScanned = 0;
+        long long imagesWithoutWindows = 0;
+        while (numMined < numNeg && numImages > 0 && imagesWithoutWindows < numImages)
+        {
+            const long long first = mNegCursor;
+#ifdef PARALLEL
+            cgParallelForWorkers(batchSize, [&](int worker, int i) {
+                const long long cursor = first + i;
+                scanNegative(mNegatives[(size_t)(cursor % numImages)], cursor / numImages,
+                             integrals[worker], mined[i]);
+            });
+#else
+            for (int i = 0; i < batchSize; i++)
+            {
+                const long long cursor = first + i;
+                scanNegative(mNegatives[(size_t)(cursor % numImages)], cursor / numImages,
+                             integrals[0], mined[i]);
+            }
+#endif
+
+            for (int i = 0; i < batchSize && numMined < numNeg; i++)
+            {
+                const MinedWindows &m = mined[i];
+                const int numTaken = std::min((int)m.scanIndex.size(), numNeg - numMined);
+                windows.insert(windows.end(), m.pixels.begin(), m.pixels.begin() + numTaken * area);
+                numMined += numTaken;
+                numScanned += numTaken < (int)m.scanIndex.size() ? m.scanIndex[numTaken - 1] + 1
+                                                                  : m.numScanned;
+                imagesWithoutWindows = m.scanIndex.empty() ? imagesWithoutWindows + 1 : 0;
+                mNegCursor++;
+                if (imagesWithoutWindows >= numImages)
+                    break;
+            }
+        }
+
+        acceptanceRatio = numScanned > 0 ? numMined / numScanned : 0;
+        return numMined;
+    }
+
+    //------------------------------------------------------------------------
+    // training samples
+    //------------------------------------------------------------------------
+    IntegralView sampleView(int i) const
+    {
+        const size_t area = (size_t)(mWinHeight + 1) * (mWinWidth + 1);
+        IntegralView v;
+        v.sum = mSums.empty() ? NULL : &mSums[i * area];
+        v.sqsum = NULL;
+        v.hist = mHists.empty() ? NULL : &mHists[i * (CASCADE_HOG_BINS + 1) * area];
+        v.plane = area;
+        v.stride = mWinWidth + 1;
+        return v;
+    }
+
+    void computeSampleIntegrals(const std::vector<uint8_T> &windows)
+    {
+        const size_t area = (size_t)(mWinHeight + 1) * (mWinWidth + 1);
+        const int numWorkers = std::max((int)cgGetNumThreads(), 1);
+        std::vector<Integrals> integrals(numWorkers);
+
+        if (mFeatureType == FEATURE_HOG)
+            mHists.resize(mNumSamples * (CASCADE_HOG_BINS + 1) * area);
+        else
+            mSums.resize(mNumSamples * area);
+        mInvNorm.assign(mNumSamples, 1.f);
+
+#ifdef PARALLEL
+        cgParallelForWorkers(mNumSamples, [&](int worker, int i) {
+            sampleIntegrals(windows, i, integrals[worker]);
+        });
+#else
+        for (int i = 0; i < mNumSamples; i++)
+            sampleIntegrals(windows, i, integrals[0]);
+#endif
+    }
+
+    // Integral images of sample i, in a work buffer
+    void sampleIntegrals(const std::vector<uint8_T> &windows, int i, Integrals &in)
+    {
+        const size_t area = (size_t)(mWinHeight + 1) * (mWinWidth + 1);
+        integrate(&windows[i * (size_t)mWinWidth * mWinHeight], mWinHeight, mWinWidth, in);
+        if (mFeatureType == FEATURE_HOG)
+        {
+            std::copy(in.hist.begin(), in.hist.end(),
+                      mHists.begin() + i * (CASCADE_HOG_BINS + 1) * area);
+        }
+        else
+        {
+            std::copy(in.sum.begin(), in.sum.end(), mSums.begin() + i * area);
+            if (mFeatureType == FEATURE_HAAR)
+                mInvNorm[i] = windowInvNorm(in.view(), 0);
+        }
+    }
+
+    void releaseSamples()
+    {
+        std::vector<int>().swap(mSums);
+        std::vector<float>().swap(mHists);
+        std::vector<float>().swap(mInvNorm);
+        std::vector<float>().swap(mValues);
+        std::vector<unsigned short>().swap(mSorted16);
+        std::vector<int>().swap(mSorted32);
+        std::vector<uint8_T>().swap(mCodes);
+        mNumPrecalc = 0;
+    }
+
+    // values of feature f for all samples
+    void computeValues(int f, float *values) const
+    {
+        const FeatureOffsets o = makeOffsets(mFeatures[f], mWinWidth + 1);
+        for (int i = 0; i < mNumSamples; i++)
+            values[i] = orderedValue(o, sampleView(i), 0, mInvNorm[i]);
+    }
+
+    void computeCodes(int f, uint8_T *codes) const
+    {
+        const FeatureOffsets o = makeOffsets(mFeatures[f], mWinWidth + 1);
+        for (int i = 0; i < mNumSamples; i++)
+            codes[i] = (uint8_T)lbpCode(o, sampleView(i), 0);
+    }
+
+    template <typename Index>
+    static void sortByValue(const float *values, int n, Index *sorted)
+    {
+        for (int i = 0; i < n; i++)
+            sorted[i] = (Index)i;
+        std::sort(sorted, sorted + n, ValueLess(values));
+    }
+
+    // Orders sample indices by value, then by index
+    struct ValueLess
+    {
+        const float *values;
+        explicit ValueLess(const float *v) : values(v) {}
+        template <typename Index>
+        bool operator()(Index a, Index b) const
+        {
+            return values[a] < values[b] || (values[a] == values[b] && a < b);
+        }
+    };
+
+    bool useSorted16() const
+    {
+        return mNumSamples <= 65536;
+    }
+
+    // Precalculates the columns of the first features that fit the buffer
+    void precalculate()
+    {
+        const size_t n = (size_t)mNumSamples;
+        const size_t bytesPerFeature = mFeatureType == FEATURE_LBP
+            ? n : n * (sizeof(float) + (useSorted16() ? sizeof(unsigned short) : sizeof(int)));
+        mNumPrecalc = (int)std::min(mFeatures.size(), mPrecalcBufSize / bytesPerFeature);
+
+        if (mFeatureType == FEATURE_LBP)
+        {
+            mCodes.resize(mNumPrecalc * n);
+#ifdef PARALLEL
+            cgParallelForWorkers(mNumPrecalc, [&](int, int f) {
+                computeCodes(f, &mCodes[f * n]);
+            });
+#else
+            for (int f = 0; f < mNumPrecalc; f++)
+                computeCodes(f, &mCodes[f * n]);
+#endif
+            return;
+        }
+
+        mValues.resize(mNumPrecalc * n);
+        if (useSorted16())
+            mSorted16.resize(mNumPrecalc * n);
+        else
+            mSorted32.resize(mNumPrecalc * n);
+#ifdef PARALLEL
+        cgParallelForWorkers(mNumPrecalc, [&](int, int f) {
+            precalculateValues(f);
+        });
+#else
+        for (int f = 0; f < mNumPrecalc; f++)
+            precalculateValues(f);
+#endif
+    }
+
+    // values of feature f and the samples sorted by them
+    void precalculateValues(int f)
+    {
+        const size_t n = (size_t)mNumSamples;
+        float *values = &mValues[f * n];
+        computeValues(f, values);
+        if (useSorted16())
+            sortByValue(values, mNumSamples, &mSorted16[f * n]);
+        else
+            sortByValue(values, mNumSamples, &mSorted32[f * n]);
+    }
+
+    //------------------------------------------------------------------------
+    // boosting
+    //------------------------------------------------------------------------
+    struct Split
+    {
+        double quality;
+        int feature;
+        float threshold;
+        int subset[CASCADE_LBP_SUBSET];
+        double left;
+        double right;
+    };
+
+    // Sample weights of the round: w and w*y of the active samples, 0 for
+    // the trimmed ones
+    struct RoundWeights
+    {
+        std::vector<double> w;
+        std::vector<double> wy;
+        std::vector<unsigned char> active;
+        double sumW;
+        double sumWy;
+    };
+
+    // Best Gentle AdaBoost split of an ordered feature: the left and right
+    // values are the weighted means of the responses, which minimizes the
+    // weighted squared error
+    template <typename Index>
+    static void orderedSplit(const float *values, const Index *sorted, int n,
+                             const RoundWeights &rw, int feature, Split &best)
+    {
+        const double eps = 2 * FLT_EPSILON;
+        double sumW = 0, sumWy = 0;
+        int prev = -1;
+        for (int k = 0; k < n; k++)
+        {
+            const int i = (int)sorted[k];
+            if (!rw.active[i])
+                continue;
+            if (prev >= 0 && values[prev] + eps < values[i])
+            {
+                const double rightW = rw.sumW - sumW, rightWy = rw.sumWy - sumWy;
+                if (sumW > DBL_EPSILON && rightW > DBL_EPSILON)
+                {
+                    const double q = sumWy * sumWy / sumW + rightWy * rightWy / rightW;
+                    if (q > best.quality)
+                    {
+                        best.quality = q;
+                        best.feature = feature;
+                        best.threshold = (values[prev] + values[i]) * 0.5f;
+                        best.left = sumWy / sumW;
+                        best.right = rightWy / rightW;
+                    }
+                }
+            }
+            sumW += rw.w[i];
+            sumWy += rw.wy[i];
+            prev = i;
+        }
+    }
+
+    // Orders categories by mean response, then by category
+    struct MeanLess
+    {
+        const double *catW;
+        const double *catWy;
+        MeanLess(const double *w, const double *wy) : catW(w), catWy(wy) {}
+        bool operator()(int a, int b) const
+        {
+            return catWy[a] / catW[a] < catWy[b] / catW[b] ||
+                   (catWy[a] / catW[a] == catWy[b] / catW[b] && a < b);
+        }
+    };
+
+    // Best split of an LBP feature into a subset of categories and the
+    // rest: the categories sorted by mean response are split in two
+    static void categoricalSplit(const uint8_T *codes, int n, const RoundWeights &rw,
+                                 int feature, Split &best)
+    {
+        double catW[CASCADE_LBP_CATEGORIES] = {0}, catWy[CASCADE_LBP_CATEGORIES] = {0};
+        for (int i = 0; i < n; i++)
+        {
+            catW[codes[i]] += rw.w[i];
+            catWy[codes[i]] += rw.wy[i];
+        }
+
+        int order[CASCADE_LBP_CATEGORIES], numCats = 0;
+        for (int c = 0; c < CASCADE_LBP_CATEGORIES; c++)
+        {
+            if (catW[c] > DBL_EPSILON)
+                order[numCats++] = c;
+        }
+        std::sort(order, order + numCats, MeanLess(catW, catWy));
+
+        double sumW = 0, sumWy = 0;
+        int bestCount = 0;
+        for (int k = 0; k + 1 < numCats; k++)
+        {
+            sumW += catW[order[k]];
+            sumWy += catWy[order[k]];
+            const double rightW = rw.sumW - sumW, rightWy = rw.sumWy - sumWy;
+            const double q = sumWy * sumWy / sumW + rightWy * rightWy / rightW;
+            if (q > best.quality)
+            {
+                best.quality = q;
+                best.feature = feature;
+                best.left = sumWy / sumW;
+                best.right = rightWy / rightW;
+                bestCount = k + 1;
+            }
+        }
+        if (best.feature == feature && bestCount > 0)
+        {
+            std::fill(best.subset, best.subset + CASCADE_LBP_SUBSET, 0);
+            for (int k = 0; k < bestCount; k++)
+                best.subset[order[k] >> 5] |= 1 << (order[k] & 31);
+        }
+    }
+
+    static Split emptySplit()
+    {
+        Split s;
+        s.quality = -DBL_MAX;
+        s.feature = -1;
+        s.threshold = 0;
+        std::fill(s.subset, s.subset + CASCADE_LBP_SUBSET, 0);
+        s.left = s.right = 0;
+        return s;
+    }
+
+    // Best split of the features of block b, values, sorted and codes work
+    // buffers
+    void blockSplit(const RoundWeights &rw, int b, std::vector<float> &values,
+                    std::vector<int> &sorted, std::vector<uint8_T> &codes, Split &best) const
+    {
+        const size_t n = (size_t)mNumSamples;
+        const int f1 = std::min((b + 1) * CASCADE_FEATURE_BLOCK, (int)mFeatures.size());
+        for (int f = b * CASCADE_FEATURE_BLOCK; f < f1; f++)
+        {
+            if (mFeatureType == FEATURE_LBP)
+            {
+                if (f < mNumPrecalc)
+                {
+                    categoricalSplit(&mCodes[f * n], mNumSamples, rw, f, best);
+                    continue;
+                }
+                codes.resize(n);
+                computeCodes(f, &codes[0]);
+                categoricalSplit(&codes[0], mNumSamples, rw, f, best);
+            }
+            else if (f < mNumPrecalc)
+            {
+                if (useSorted16())
+                    orderedSplit(&mValues[f * n], &mSorted16[f * n], mNumSamples, rw, f, best);
+                else
+                    orderedSplit(&mValues[f * n], &mSorted32[f * n], mNumSamples, rw, f, best);
+            }
+            else
+            {
+                values.resize(n);
+                sorted.resize(n);
+                computeValues(f, &values[0]);
+                sortByValue(&values[0], mNumSamples, &sorted[0]);
+                orderedSplit(&values[0], &sorted[0], mNumSamples, rw, f, best);
+            }
+        }
+    }
+
+    // Best split over all features, searched in parallel over blocks of
+    // features. Ties go to the first feature.
+    Split findBestSplit(const RoundWeights &rw) const
+    {
+        const int numFeatures = (int)mFeatures.size();
+        const int numBlocks = (numFeatures + CASCADE_FEATURE_BLOCK - 1) / CASCADE_FEATURE_BLOCK;
+        const int numWorkers = std::max((int)cgGetNumThreads(), 1);
+        std::vector<std::vector<float> > values(numWorkers);
+        std::vector<std::vector<int> > sorted(numWorkers);
+        std::vector<std::vector<uint8_T> > codes(numWorkers);
+        std::vector<Split> blockBest(numBlocks, emptySplit());
+
+#ifdef PARALLEL
+        cgParallelForWorkers(numBlocks, [&](int worker, int b) {
+            blockSplit(rw, b, values[worker], sorted[worker], codes[worker], blockBest[b]);
+        });
+#else
+        for (int b = 0; b < numBlocks; b++)
+            blockSplit(rw, b, values[0], sorted[0], codes[0], blockBest[b]);
+#endif
+
+        Split best = emptySplit();
+        for (int b = 0; b < numBlocks; b++)
+        {
+            if (blockBest[b].quality > best.quality)
+                best = blockBest[b];
+        }
+        return best;
+    }
+
+    // Response of the stump for every sample
+    void stumpResponses(const Stump &stump, std::vector<double> &h) const
+    {
+        const size_t n = (size_t)mNumSamples;
+        h.resize(n);
+        if (mFeatureType == FEATURE_LBP)
+        {
+            std::vector<uint8_T> buffer;
+            const uint8_T *codes = stump.feature < mNumPrecalc ? &mCodes[stump.feature * n] : NULL;
+            if (!codes)
+            {
+                buffer.resize(n);
+                computeCodes(stump.feature, &buffer[0]);
+                codes = &buffer[0];
+            }
+            for (size_t i = 0; i < n; i++)
+            {
+                const int c = codes[i];
+                h[i] = (stump.subset[c >> 5] & (1 << (c & 31))) ? stump.left : stump.right;
+            }
+        }
+        else
+        {
+            std::vector<float> buffer;
+            const float *values = stump.feature < mNumPrecalc ? &mValues[stump.feature * n] : NULL;
+            if (!values)
+            {
+                buffer.resize(n);
+                computeValues(stump.feature, &buffer[0]);
+                values = &buffer[0];
+            }
+            for (size_t i = 0; i < n; i++)
+                h[i] = values[i] < stump.threshold ? stump.left : stump.right;
+        }
+    }
+
+    // Deactivates the samples of smallest weight that sum to at most
+    // 1 - weightTrimRate of the total, as CvBoost::trim_weights
+    void trimWeights(const std::vector<double> &weights, RoundWeights &rw) const
+    {
+        const size_t n = weights.size();
+        double threshold = -DBL_MAX;
+        const double rate = mParams.weightTrimRate;
+        if (rate > 0 && rate < 1)
+        {
+            std::vector<double> sorted(weights);
+            std::sort(sorted.begin(), sorted.end());
+            double sum = 1. - rate;
+            size_t i = 0;
+            for (; i < n; i++)
+            {
+                if (sum <= 0)
+                    break;
+                sum -= sorted[i];
+            }
+            threshold = i < n ? sorted[i] : DBL_MAX;
+        }
+
+        rw.sumW = rw.sumWy = 0;
+        for (size_t i = 0; i < n; i++)
+        {
+            const bool isActive = weights[i] >= threshold;
+            const double y = (int)i < mNumPos ? 1. : -1.;
+            rw.active[i] = isActive;
+            rw.w[i] = isActive ? weights[i] : 0.;
+            rw.wy[i] = rw.w[i] * y;
+            rw.sumW += rw.w[i];
+            rw.sumWy += rw.wy[i];
+        }
+    }
+
+    // Threshold passing minHitRate of the positives, and false alarm rate
+    // of the negatives at that threshold, as CvCascadeBoost::isErrDesired
+    double stageFalseAlarm(const std::vector<double> &sums, float &threshold) const
+    {
+        std::vector<float> eval(sums.begin(), sums.begin() + mNumPos);
+        std::sort(eval.begin(), eval.end());
+        const int thresholdIdx = (int)((1. - mParams.minHitRate) * mNumPos);
+        threshold = eval[std::min(thresholdIdx, mNumPos - 1)];
+
+        int numFalse = 0;
+        for (int i = mNumPos; i < mNumSamples; i++)
+        {
+            if (!((float)sums[i] < threshold - CASCADE_THRESHOLD_EPS))
+                numFalse++;
+        }
+        return (double)numFalse / (mNumSamples - mNumPos);
+    }
+
+    void boostStage(Stage &stage) const
+    {
+        const size_t n = (size_t)mNumSamples;
+        std::vector<double> weights(n, 1. / n), sums(n, 0.), h;
+        RoundWeights rw;
+        rw.w.resize(n);
+        rw.wy.resize(n);
+        rw.active.resize(n);
+
+        stage.stumps.clear();
+        stage.threshold = 0;
+        for (int k = 0; k < mParams.maxWeakCount; k++)
+        {
+            trimWeights(weights, rw);
+            const Split split = findBestSplit(rw);
+            if (split.feature < 0)
+                break;
+
+            Stump stump;
+            stump.feature = split.feature;
+            stump.threshold = split.threshold;
+            std::copy(split.subset, split.subset + CASCADE_LBP_SUBSET, stump.subset);
+            stump.left = (float)split.left;
+            stump.right = (float)split.right;
+            stage.stumps.push_back(stump);
+
+            // w *= exp(-y h), normalized
+            stumpResponses(stump, h);
+            double sumW = 0;
+            for (size_t i = 0; i < n; i++)
+            {
+                const double y = (int)i < mNumPos ? 1. : -1.;
+                sums[i] += h[i];
+                weights[i] *= std::exp(-y * h[i]);
+                sumW += weights[i];
+            }
+            for (size_t i = 0; i < n; i++)
+                weights[i] /= sumW;
+
+            if (stageFalseAlarm(sums, stage.threshold) <= mParams.maxFalseAlarm)
+                break;
+        }
+    }
+
+    int mFeatureType;
+    int mWinWidth;
+    int mWinHeight;
+    size_t mPrecalcBufSize;
+    StageParams mParams;
+
+    std::vector<Feature> mFeatures;
+    std::vector<Stage> mStages;
+
+    // positives, row major windows, and negative images
+    std::vector<uint8_T> mPositives;
+    std::vector<cv::Mat> mNegatives;
+    // images scanned for negatives so far
+    long long mNegCursor;
+
+    // samples of the stage being trained, positives first
+    int mNumPos;
+    int mNumSamples;
+    std::vector<int> mSums;
+    std::vector<float> mHists;
+    std::vector<float> mInvNorm;
+
+    // precalculated feature columns
+    int mNumPrecalc;
+    std::vector<float> mValues;
+    std::vector<unsigned short> mSorted16;
+    std::vector<int> mSorted32;
+    std::vector<uint8_T> mCodes;
+
+    CascadeTrainer(const CascadeTrainer &);
+    CascadeTrainer &operator=(const CascadeTrainer &);
+};
+
+} // namespace cascadetrainer
+
+#endif
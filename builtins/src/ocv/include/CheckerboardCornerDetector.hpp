@@ -0,0 +1,524 @@
+//////////////////////////////////////////////////////////////////////////////
+// Checkerboard corner candidates of
+// vision.internal.calibration.checkerboard.detectCheckerboard, for a whole
+// set of calibration images.
+//
+// For every image this computes the two corner metrics of
+// secondDerivCornerMetric, cxy for boards aligned with the image axes and
+// c45 for boards at 45 degrees, and their peaks as find_peaks does. At every
+// peak it also computes what growCheckerboard and subPixelLocation use:
+// the orientations of the edges from the smoothed structure tensor, as
+// cornerOrientations, and the location refined to subpixel accuracy with a
+// quadratic fit to the second derivative, Ixy for cxy and I_45_45 for c45.
+// Growing the board from these candidates is left to the caller.
+//
+// Images are single, column major. The Gaussian and derivative filters are
+// separable and run along the columns and across them with the 128-bit
+// universal intrinsics of OpenCV, with the zero padding of imfilter. The
+// structure tensor is only smoothed at the peaks. Images of a set are
+// processed in parallel, one image per task, and each worker keeps its
+// buffers over the images it gets, so the results do not depend on the
+// number of threads.
+//
+// The peaks are the local maxima of the 8-neighborhood that reach the
+// threshold, away from the border. On a plateau of equal values only its
+// first pixel in column-major order is kept, where imregionalmax followed by
+// bwmorph(..., 'shrink', Inf) keeps its center.
+//
+// Copyright 2016 The MathWorks, Inc.
+//
+//////////////////////////////////////////////////////////////////////////////
+#ifndef CHECKERBOARD_CORNER_DETECTOR
+#define CHECKERBOARD_CORNER_DETECTOR
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include "vision_defines.h"
+#include "opencv2/core.hpp"
+#include "opencv2/core/hal/intrin.hpp"
+#include "cgThreadPool.hpp"
+
+namespace checkerboard
+{
+
+// Corner metrics of secondDerivCornerMetric
+enum CornerMetricType
+{
+    CORNER_METRIC_XY = 0, // cxy, board aligned with the image axes
+    CORNER_METRIC_45 = 1, // c45, board rotated by 45 degrees
+    CORNER_METRIC_COUNT = 2
+};
+
+// Half size of the patch of subPixelLocation
+const int CB_SUBPIXEL_HALF_SIZE = 2;
+
+// Size and sigma of the Gaussian of computeJacobianEntries
+const int CB_TENSOR_SIZE = 7;
+const double CB_TENSOR_SIGMA = 1.5;
+
+// A corner candidate. x and y are 1-based, as the points of find_peaks, and
+// score is the value of the metric there. v1 and v2 are the orientations
+// of cornerOrientations. subPixelX and subPixelY are the location of
+// subPixelLocation.
+struct CornerCandidate
+{
+    float x, y;
+    float score;
+    float v1[2], v2[2];
+    float subPixelX, subPixelY;
+};
+
+//////////////////////////////////////////////////////////////////////////////
+// Separable filters with the zero padding of imfilter. Images are column
+// major, so filtering along a column is filtering in y.
+//////////////////////////////////////////////////////////////////////////////
+
+// Offsets of the taps of the n-tap kernel h applied by imfilter with
+// 'conv', h(k) weighting in(i + offset[k]), or with correlation
+inline void kernelOffsets(int n, bool isConv, std::vector<int> &offsets)
+{
+    // center of imfilter, 0-based
+    const int center = (n + 1) / 2 - 1;
+    offsets.resize(n);
+    for (int k = 0; k < n; k++)
+        offsets[k] = isConv ? (n - 1 - center) - k : k - center;
+}
+
+// Taps of the separable Gaussian of fspecial('gaussian', n, sigma)
+inline void gaussianKernel(int n, double sigma, std::vector<float> &h)
+{
+    std::vector<double> g(n);
+    double sum = 0;
+    for (int k = 0; k < n; k++)
+    {
+        const double x = k - (n - 1) / 2.0;
+        g[k] = std::exp(-x * x / (2 * sigma * sigma));
+        sum += g[k];
+    }
+    h.resize(n);
+    for (int k = 0; k < n; k++)
+        h[k] = (float)(g[k] / sum);
+}
+
+// dst[i] += a*src[i]
+inline void addScaled(float *dst, const float *src, float a, int n)
+{
+    int i = 0;
+#if CV_SIMD128
+    const cv::v_float32x4 va = cv::v_setall_f32(a);
+    for (; i <= n - 4; i += 4)
+        cv::v_store(dst + i, cv::v_muladd(cv::v_load(src + i), va, cv::v_load(dst + i)));
+#endif
+    for (; i < n; i++)
+        dst[i] += a * src[i];
+}
+
+// dst[i] = src[i - 1] - src[i + 1] in a zero padded column of n values, the
+// [-1 0 1] derivative of imfilter with 'conv'
+inline void derivativeColumn(float *dst, const float *src, int n)
+{
+    if (n == 1)
+    {
+        dst[0] = 0;
+        return;
+    }
+    dst[0] = -src[1];
+    int i = 1;
+#if CV_SIMD128
+    for (; i <= n - 5; i += 4)
+        cv::v_store(dst + i, cv::v_load(src + i - 1) - cv::v_load(src + i + 1));
+#endif
+    for (; i < n - 1; i++)
+        dst[i] = src[i - 1] - src[i + 1];
+    dst[n - 1] = src[n - 2];
+}
+
+class CheckerboardCornerDetector
+{
+public:
+    CheckerboardCornerDetector() : mRows(0), mCols(0), mSigma(0) {}
+
+    // Candidates of the nRows-by-nCols image I, single and column major,
+    // in candidates[m] for each metric m. sigma is that of
+    // detectCheckerboard and quality the peakThreshold of find_peaks.
+    void detect(const float *I, int nRows, int nCols, double sigma,
+                double quality, std::vector<CornerCandidate> *candidates)
+    {
+        for (int m = 0; m < CORNER_METRIC_COUNT; m++)
+            candidates[m].clear();
+        if (nRows < 3 || nCols < 3)
+            return;
+        setup(nRows, nCols, sigma);
+        computeMetrics(I);
+
+        const float *metric[CORNER_METRIC_COUNT] = { &mCxy[0], &mC45[0] };
+        const float *derivative[CORNER_METRIC_COUNT] = { &mIxy[0], &mI4545[0] };
+        for (int m = 0; m < CORNER_METRIC_COUNT; m++)
+        {
+            std::vector<CornerCandidate> &c = candidates[m];
+            findPeaks(metric[m], quality, c);
+            for (size_t k = 0; k < c.size(); k++)
+            {
+                cornerOrientations(c[k]);
+                subPixelLocation(derivative[m], c[k]);
+            }
+        }
+    }
+
+private:
+    CheckerboardCornerDetector(const CheckerboardCornerDetector &);
+    CheckerboardCornerDetector &operator=(const CheckerboardCornerDetector &);
+
+    void setup(int nRows, int nCols, double sigma)
+    {
+        const size_t n = (size_t)nRows * nCols;
+        if (sigma != mSigma)
+        {
+            // as round(sigma * 7) + 1
+            const int size = (int)std::floor(sigma * 7 + 0.5) + 1;
+            gaussianKernel(size, sigma, mGauss);
+            kernelOffsets(size, true, mGaussOffsets);
+            mSigma = sigma;
+        }
+        if (mTensorGauss.empty())
+        {
+            gaussianKernel(CB_TENSOR_SIZE, CB_TENSOR_SIGMA, mTensorGauss);
+            kernelOffsets(CB_TENSOR_SIZE, false, mTensorOffsets);
+        }
+        mRows = nRows;
+        mCols = nCols;
+        mIg.resize(n);
+        mIx.resize(n);
+        mIy.resize(n);
+        mIxy.resize(n);
+        mI45.resize(n);
+        mI4545.resize(n);
+        mCxy.resize(n);
+        mC45.resize(n);
+        mColumn.resize(nRows + 2 * mGauss.size());
+    }
+
+    // dst = h applied across the columns of src
+    void filterAcross(float *dst, const float *src, const std::vector<float> &h,
+                      const std::vector<int> &offsets) const
+    {
+        for (int c = 0; c < mCols; c++)
+        {
+            float *out = dst + (size_t)c * mRows;
+            std::fill(out, out + mRows, 0.0f);
+            for (size_t k = 0; k < h.size(); k++)
+            {
+                const int cc = c + offsets[k];
+                if (cc >= 0 && cc < mCols)
+                    addScaled(out, src + (size_t)cc * mRows, h[k], mRows);
+            }
+        }
+    }
+
+    // dst = h applied along the columns of src
+    void filterAlong(float *dst, const float *src, const std::vector<float> &h,
+                     const std::vector<int> &offsets)
+    {
+        const int pad = (int)h.size();
+        float *column = &mColumn[0];
+        std::fill(column, column + pad, 0.0f);
+        std::fill(column + pad + mRows, column + 2 * pad + mRows, 0.0f);
+        for (int c = 0; c < mCols; c++)
+        {
+            float *out = dst + (size_t)c * mRows;
+            std::copy(src + (size_t)c * mRows, src + (size_t)(c + 1) * mRows,
+                      column + pad);
+            std::fill(out, out + mRows, 0.0f);
+            for (size_t k = 0; k < h.size(); k++)
+                addScaled(out, column + pad + offsets[k], h[k], mRows);
+        }
+    }
+
+    // dst = the [-1 0 1] derivative across the columns of src
+    void derivativeAcross(float *dst, const float *src) const
+    {
+        for (int c = 0; c < mCols; c++)
+        {
+            float *out = dst + (size_t)c * mRows;
+            std::fill(out, out + mRows, 0.0f);
+            if (c > 0)
+                addScaled(out, src + (size_t)(c - 1) * mRows, 1.0f, mRows);
+            if (c < mCols - 1)
+                addScaled(out, src + (size_t)(c + 1) * mRows, -1.0f, mRows);
+        }
+    }
+
+    // dst = the [-1 0 1] derivative along the columns of src
+    void derivativeAlong(float *dst, const float *src) const
+    {
+        for (int c = 0; c < mCols; c++)
+            derivativeColumn(dst + (size_t)c * mRows, src + (size_t)c * mRows, mRows);
+    }
+
+    // secondDerivCornerMetric
+    void computeMetrics(const float *I)
+    {
+        const int n = mRows * mCols;
+        float *tmp = &mCxy[0];
+        filterAlong(tmp, I, mGauss, mGaussOffsets);
+        filterAcross(&mIg[0], tmp, mGauss, mGaussOffsets);
+
+        derivativeAlong(&mIy[0], &mIg[0]);
+        derivativeAcross(&mIx[0], &mIg[0]);
+        derivativeAlong(&mIxy[0], &mIx[0]);
+
+        const float c = (float)std::cos(CV_PI / 4);
+        for (int i = 0; i < n; i++)
+            mI45[i] = mIx[i] * c + mIy[i] * c;
+
+        // I_45_45 = cos(-pi/4)*I_45_x + sin(-pi/4)*I_45_y
+        float *I45y = &mC45[0];
+        derivativeAcross(&mI4545[0], &mI45[0]);
+        derivativeAlong(I45y, &mI45[0]);
+        const float sigma = (float)mSigma;
+        const float s2 = sigma * sigma, s15 = 1.5f * sigma;
+        int i = 0;
+#if CV_SIMD128
+        const cv::v_float32x4 vc = cv::v_setall_f32(c);
+        const cv::v_float32x4 vs2 = cv::v_setall_f32(s2);
+        const cv::v_float32x4 vs15 = cv::v_setall_f32(s15);
+        const cv::v_float32x4 zero = cv::v_setzero_f32();
+        for (; i <= n - 4; i += 4)
+        {
+            const cv::v_float32x4 ix = cv::v_load(&mIx[i]);
+            const cv::v_float32x4 iy = cv::v_load(&mIy[i]);
+            const cv::v_float32x4 i45 = cv::v_load(&mI45[i]);
+            const cv::v_float32x4 in45 = ix * vc - iy * vc;
+            const cv::v_float32x4 i4545 = cv::v_load(&mI4545[i]) * vc - cv::v_load(I45y + i) * vc;
+            cv::v_store(&mI4545[i], i4545);
+            cv::v_store(&mCxy[i], cv::v_max(vs2 * cv::v_abs(cv::v_load(&mIxy[i])) -
+                vs15 * (cv::v_abs(i45) + cv::v_abs(in45)), zero));
+            cv::v_store(&mC45[i], cv::v_max(vs2 * cv::v_abs(i4545) -
+                vs15 * (cv::v_abs(ix) + cv::v_abs(iy)), zero));
+        }
+#endif
+        for (; i < n; i++)
+        {
+            const float in45 = mIx[i] * c - mIy[i] * c;
+            const float i4545 = mI4545[i] * c - I45y[i] * c;
+            mI4545[i] = i4545;
+            mCxy[i] = std::max(s2 * std::abs(mIxy[i]) -
+                s15 * (std::abs(mI45[i]) + std::abs(in45)), 0.0f);
+            mC45[i] = std::max(s2 * std::abs(i4545) -
+                s15 * (std::abs(mIx[i]) + std::abs(mIy[i])), 0.0f);
+        }
+    }
+
+    // find_peaks
+    void findPeaks(const float *metric, double quality,
+                   std::vector<CornerCandidate> &candidates) const
+    {
+        candidates.clear();
+        const int n = mRows * mCols;
+        float maxMetric = 0;
+        for (int i = 0; i < n; i++)
+            maxMetric = std::max(maxMetric, metric[i]);
+        if (maxMetric <= 0)
+            return;
+        const float threshold = (float)(quality * maxMetric);
+
+        for (int c = 1; c < mCols - 1; c++)
+        {
+            const float *col = metric + (size_t)c * mRows;
+            for (int r = 1; r < mRows - 1; r++)
+            {
+                const float v = col[r];
+                if (v < threshold)
+                    continue;
+                // strictly above the neighbors before it in column-major
+                // order, not below those after it
+                const float *prev = col - mRows, *next = col + mRows;
+                if (v <= prev[r - 1] || v <= prev[r] || v <= prev[r + 1] ||
+                    v <= col[r - 1] || v < col[r + 1] ||
+                    v < next[r - 1] || v < next[r] || v < next[r + 1])
+                    continue;
+                CornerCandidate cand;
+                cand.x = (float)(c + 1);
+                cand.y = (float)(r + 1);
+                cand.score = v;
+                candidates.push_back(cand);
+            }
+        }
+    }
+
+    // cornerOrientations, with the structure tensor of computeJacobianEntries
+    // smoothed at the candidate only
+    void cornerOrientations(CornerCandidate &cand) const
+    {
+        const int r0 = (int)cand.y - 1, c0 = (int)cand.x - 1;
+        float a = 0, b = 0, c = 0;
+        for (int kc = 0; kc < CB_TENSOR_SIZE; kc++)
+        {
+            const int cc = c0 + mTensorOffsets[kc];
+            if (cc < 0 || cc >= mCols)
+                continue;
+            for (int kr = 0; kr < CB_TENSOR_SIZE; kr++)
+            {
+                const int rr = r0 + mTensorOffsets[kr];
+                if (rr < 0 || rr >= mRows)
+                    continue;
+                const size_t i = (size_t)cc * mRows + rr;
+                const float g = mTensorGauss[kr] * mTensorGauss[kc];
+                a += g * (mIx[i] * mIx[i]);
+                b += g * (mIx[i] * mIy[i]);
+                c += g * (mIy[i] * mIy[i]);
+            }
+        }
+
+        // eigenvectors of [a b; b c], computed as in cornerOrientations
+        const float sm = a + c;
+        const float df = a - c;
+        const float adf = std::abs(df);
+        const float tb = b + b;
+        const float ab = std::abs(tb);
+        float rt;
+        if (adf > ab)
+            rt = adf * std::sqrt(1 + (ab / adf) * (ab / adf));
+        else if (adf < ab)
+            rt = ab * std::sqrt(1 + (adf / ab) * (adf / ab));
+        else
+            rt = ab * std::sqrt(2.0f);
+        const int sgn1 = (sm < 0) ? -1 : 1;
+        float cs;
+        int sgn2;
+        if (df > 0)
+        {
+            cs = df + rt;
+            sgn2 = 1;
+        }
+        else
+        {
+            cs = df - rt;
+            sgn2 = -1;
+        }
+        float cs1, sn1;
+        if (std::abs(cs) > ab)
+        {
+            const float ct = -tb / cs;
+            sn1 = 1 / std::sqrt(1 + ct * ct);
+            cs1 = ct * sn1;
+        }
+        else if (ab == 0)
+        {
+            cs1 = 1;
+            sn1 = 0;
+        }
+        else
+        {
+            const float tn = -cs / tb;
+            cs1 = 1 / std::sqrt(1 + tn * tn);
+            sn1 = tn * cs1;
+        }
+        if (sgn1 == sgn2)
+        {
+            const float tn = cs1;
+            cs1 = -sn1;
+            sn1 = tn;
+        }
+
+        // rotated by 45 degrees to align with the edges, v*R
+        const float k = (float)std::cos(CV_PI / 4);
+        cand.v1[0] = (-sn1 + cs1) * k;
+        cand.v1[1] = ( sn1 + cs1) * k;
+        cand.v2[0] = ( cs1 + sn1) * k;
+        cand.v2[1] = (-cs1 + sn1) * k;
+    }
+
+    // subPixelLocation: the maximum of the least-squares quadratic
+    // f(x,y) = Ax^2 + By^2 + Cx + Dy + Exy + F on the 5-by-5 patch. On the
+    // symmetric patch the normal equations have a closed form.
+    void subPixelLocation(const float *metric, CornerCandidate &cand) const
+    {
+        const int h = CB_SUBPIXEL_HALF_SIZE;
+        const int x0 = (int)cand.x, y0 = (int)cand.y;
+        cand.subPixelX = cand.x;
+        cand.subPixelY = cand.y;
+        if (x0 < h + 1 || y0 < h + 1 || x0 > mCols - h - 1 || y0 > mRows - h - 1)
+            return;
+
+        double s = 0, sx = 0, sy = 0, sxx = 0, syy = 0, sxy = 0;
+        for (int dx = -h; dx <= h; dx++)
+        {
+            const float *col = metric + (size_t)(x0 - 1 + dx) * mRows + (y0 - 1);
+            for (int dy = -h; dy <= h; dy++)
+            {
+                const double f = col[dy];
+                s   += f;
+                sx  += dx * f;
+                sy  += dy * f;
+                sxx += dx * dx * f;
+                syy += dy * dy * f;
+                sxy += dx * dy * f;
+            }
+        }
+        // sums over the patch of x^2, x^4 - x^2 y^2, and x^2 y^2
+        const double n2 = 50, n4 = 70, n22 = 100;
+        const double A = (sxx - 2 * s) / n4;
+        const double B = (syy - 2 * s) / n4;
+        const double C = sx / n2;
+        const double D = sy / n2;
+        const double E = sxy / n22;
+
+        const double det = 4 * A * B - E * E;
+        double x = -(2 * B * C - D * E) / det;
+        double y = -(2 * A * D - C * E) / det;
+        if (!isFinite(x) || std::abs(x) > h || !isFinite(y) || std::abs(y) > h)
+        {
+            x = 0;
+            y = 0;
+        }
+        cand.subPixelX = cand.x + (float)x;
+        cand.subPixelY = cand.y + (float)y;
+    }
+
+    static bool isFinite(double v)
+    {
+        return !cvIsNaN(v) && !cvIsInf(v);
+    }
+
+    int mRows, mCols;
+    double mSigma;
+
+    std::vector<float> mGauss, mTensorGauss;
+    std::vector<int> mGaussOffsets, mTensorOffsets;
+
+    std::vector<float> mIg, mIx, mIy, mIxy, mI45, mI4545, mCxy, mC45;
+    std::vector<float> mColumn;
+};
+
+// Candidates of the numImages images of the stack images, as detect. Those
+// of metric m of image i are in candidates[CORNER_METRIC_COUNT*i + m].
+inline void detectCornerCandidates(const float *images, int nRows, int nCols,
+                                   int numImages, double sigma, double quality,
+                                   std::vector<std::vector<CornerCandidate> > &candidates)
+{
+    candidates.assign((size_t)numImages * CORNER_METRIC_COUNT,
+                      std::vector<CornerCandidate>());
+    if (numImages == 0)
+        return;
+    const size_t imageSize = (size_t)nRows * nCols;
+#ifdef PARALLEL
+    // one detector, and so one set of buffers, per worker
+    std::vector<CheckerboardCornerDetector> detectors(std::max((int)cgGetNumThreads(), 1));
+    cgParallelForWorkers(numImages, [&](int w, int i) {
+        detectors[w].detect(images + i * imageSize, nRows, nCols, sigma, quality,
+                            &candidates[(size_t)i * CORNER_METRIC_COUNT]);
+    });
+#else
+    CheckerboardCornerDetector detector;
+    for (int i = 0; i < numImages; i++)
+        detector.detect(images + i * imageSize, nRows, nCols, sigma, quality,
+                        &candidates[(size_t)i * CORNER_METRIC_COUNT]);
+#endif
+}
+
+} // namespace checkerboard
+
+#endif
@@ -0,0 +1,48 @@
+//////////////////////////////////////////////////////////////////////////////
+// CUDA devices of the cores.
+//
+// The CUDA cores (ImageHandle, pointTracker, opticalFlowFarneback,
+// foregroundDetector, the object detectors, matchFeatures and disparity)
+// take the index of the device they run on. isCudaDevice checks the index
+// against the devices OpenCV can use, and each core checks in addition that
+// its OpenCV CUDA module was built. selectCudaDevice makes the device
+// current before a core creates its stream and buffers on it.
+//
+// Copyright 2016 The MathWorks, Inc.
+//
+//////////////////////////////////////////////////////////////////////////////
+#ifndef CUDA_DEVICE
+#define CUDA_DEVICE
+
+#include "opencv2/core.hpp"
+#include "opencv2/core/cuda.hpp"
+
+namespace vision
+{
+
+// Returns the number of CUDA devices OpenCV can use, 0 without any. The
+// count is only queried once per process.
+inline int getCudaDeviceCount()
+{
+    // getCudaEnabledDeviceCount returns -1 for an incompatible driver
+    static const int numDevices = cv::cuda::getCudaEnabledDeviceCount();
+    return numDevices > 0 ? numDevices : 0;
+}
+
+// Returns true if device is the index of a CUDA device
+inline bool isCudaDevice(int device)
+{
+    return device >= 0 && device < getCudaDeviceCount();
+}
+
+// Makes device current for the calling thread and returns it, so that a
+// core selects its device before it creates its stream.
+inline int selectCudaDevice(int device)
+{
+    cv::cuda::setDevice(device);
+    return device;
+}
+
+} // namespace vision
+
+#endif
@@ -0,0 +1,394 @@
+//////////////////////////////////////////////////////////////////////////////
+// Stateful block matcher.
+//
+// The OpenCV matcher, the padded input frames and the disparity buffer are
+// kept across calls to step(), so stepping frames of a fixed size does not
+// allocate. Row major frames whose width is a multiple of 4 are matched in
+// place, without a padded copy, and the disparity is converted straight
+// into the caller's output.
+//
+// The CPU matcher splits the frame into numStrips horizontal strips (the
+// number of pool threads when 0, see cgSetNumThreads), each matched by its
+// own cv::StereoBM on the worker pool. A strip is matched together with
+// the rows around it that its prefilter and blocks read, so the strips
+// give the disparity of the whole frame. Speckle filtering, which follows
+// regions across strips, runs on a single strip.
+//
+// With coarseToFine, a match of the frames at 1/4 of their size gives
+// each strip its own search range (see DisparityCoarse.hpp); the frame is
+// then always matched in strips, at least one per COARSE_STRIP_ROWS rows,
+// and speckles are filtered within each strip.
+//
+// When useGPU is set and a CUDA device is present, the frames are matched
+// by cv::cuda::StereoBM. The CUDA matcher searches from disparity 0, only
+// implements the x-Sobel prefilter and has no uniqueness, left-right or
+// speckle filtering. It writes 0 where the texture threshold rejects a
+// pixel, so 0 is reported as invalid. A minimum disparity or a search range
+// it does not support falls back to the CPU matcher.
+//
+// Copyright 2016 The MathWorks, Inc.
+//
+//////////////////////////////////////////////////////////////////////////////
+#ifndef DISPARITY_BM_OCV
+#define DISPARITY_BM_OCV
+
+#include <algorithm>
+#include <cfloat>
+#include <vector>
+
+#include "disparityBMCore_api.hpp"
+#include "disparityBM.hpp"
+#include "cgThreadPool.hpp"
+#include "cgProfile.hpp"
+#include "DisparityCuda.hpp"
+#include "DisparityCoarse.hpp"
+
+#include "opencv2/calib3d.hpp"
+
+namespace disparity
+{
+
+class DisparityBMOcv
+{
+public:
+    DisparityBMOcv() : mIsWrapped(false) {}
+
+    // Computes the disparity of image1 relative to image2. Both images and
+    // dis are nRows-by-nCols, column major unless isRowMajor is true.
+    void step(const uint8_T *image1, const uint8_T *image2,
+              int nRows, int nCols, real32_T *dis,
+              const cvstDBMStruct_T *params, bool isRowMajor)
+    {
+        mwSize numRows   = (mwSize)nRows;
+        mwSize numInCols = (mwSize)nCols;
+        mwSize numCols   = getNumPaddedCols(nCols);
+
+        if (isRowMajor && numCols == numInCols && !useCuda(params))
+        {
+            // already in OpenCV layout: matched in place
+            mMat1 = cv::Mat(nRows, nCols, CV_8UC1, (void *)image1);
+            mMat2 = cv::Mat(nRows, nCols, CV_8UC1, (void *)image2);
+            mIsWrapped = true;
+        }
+        else
+        {
+            createFrames(nRows, nCols, params);
+            copyFrames(image1, image2, numRows, numInCols, numCols, isRowMajor);
+        }
+
+        stepFrames(nRows, nCols, dis, params, isRowMajor);
+    }
+
+    // OpenCV requires the number of column to be divisible by 4, in order
+    // to use fast computation. So, if the input image does not meet this
+    // requirement, extra columns are padded to the image.
+    static int getNumPaddedCols(int nCols)
+    {
+        return (nCols + 3) / 4 * 4;
+    }
+
+    // Allocates the row major nRows-by-getNumPaddedCols(nCols) frames, which
+    // the caller fills through frame1() and frame2() before stepFrames().
+    // Buffers are only reallocated when the frame size changes.
+    void createFrames(int nRows, int nCols, const cvstDBMStruct_T *params)
+    {
+        unwrap();
+        const int numCols = getNumPaddedCols(nCols);
+#if defined(DISPARITY_HAVE_CUDA)
+        if (useCuda(params))
+        {
+            mCudaFrames.createHostFrames(nRows, numCols, mMat1, mMat2);
+            return;
+        }
+#else
+        (void)params;
+#endif
+        mMat1.create(nRows, numCols, CV_8UC1);
+        mMat2.create(nRows, numCols, CV_8UC1);
+    }
+
+    cv::Mat &frame1() { return mMat1; }
+    cv::Mat &frame2() { return mMat2; }
+
+    // Matches the frames of an nRows-by-nCols step, and writes dis
+    void stepFrames(int nRows, int nCols, real32_T *dis,
+                    const cvstDBMStruct_T *params, bool isRowMajor)
+    {
+        const int16_T invalidValue = (int16_T)(params->minDisparity - 1);
+        const int borderWidth = params->SADWindowSize / 2;
+
+#if defined(DISPARITY_HAVE_CUDA)
+        if (useCuda(params))
+        {
+            configureCuda(params);
+            CG_PROFILE_PHASE(CG_PROFILE_COMPUTE);
+
+            // The CUDA matcher outputs whole pixels in 8 bits; scale them
+            // to the 4 fractional bits of the CPU matcher on the device.
+            mCudaFrames.upload();
+            mCudaBm->compute(mCudaFrames.device1(), mCudaFrames.device2(),
+                             mCudaFrames.deviceDisparity(), mCudaFrames.stream());
+            mDisparity = mCudaFrames.download(CV_16SC1, 16.0);
+            CG_PROFILE_PHASE(CG_PROFILE_OUTPUT);
+
+            // it writes 0 where the texture threshold rejects a pixel
+            clipAndCastRowsBM((const int16_T *)mDisparity.data, mDisparity.step1(), dis,
+                nRows, nCols, 0, nRows, 0, mCudaBm->getBlockSize() / 2, isRowMajor);
+            return;
+        }
+#endif
+
+        configure(mBm, params);
+        CG_PROFILE_PHASE(CG_PROFILE_COMPUTE);
+
+        const int numStrips = getNumStrips(nRows, params);
+        mRanges.clear();
+        if (params->coarseToFine)
+        {
+            matchCoarse(nRows, numStrips, params);
+        }
+        else if (numStrips <= 1)
+        {
+            // Invoke StereoBM function in OpenCV
+            mBm->compute(mMat1, mMat2, mDisparity);
+            CG_PROFILE_PHASE(CG_PROFILE_OUTPUT);
+            clipAndCastRowsBM((const int16_T *)mDisparity.data, mDisparity.step1(), dis,
+                nRows, nCols, 0, nRows, invalidValue, borderWidth, isRowMajor);
+            return;
+        }
+
+        // Each strip is matched with a margin of rows on either side that
+        // covers the prefilter and block neighborhoods of its own rows, so
+        // its rows come out as they do from the whole frame. Each strip
+        // writes its rows of dis directly.
+        const int margin = getStripMargin(params);
+        if ((int)mStripBms.size() < numStrips)
+        {
+            mStripBms.resize(numStrips);
+            mStripDisparities.resize(numStrips);
+        }
+        for (int s = 0; s < numStrips; ++s)
+        {
+            configure(mStripBms[s], params);
+        }
+
+#ifdef PARALLEL
+        vision::ThreadPool::instance().run(numStrips, [&](int s) {
+            matchStrip(s, numStrips, margin, dis, nRows, nCols,
+                       invalidValue, borderWidth, isRowMajor);
+        });
+#else
+        for (int s = 0; s < numStrips; ++s)
+        {
+            matchStrip(s, numStrips, margin, dis, nRows, nCols,
+                       invalidValue, borderWidth, isRowMajor);
+        }
+#endif
+    }
+
+private:
+    // Matches strip s of numStrips and writes its rows of dis
+    void matchStrip(int s, int numStrips, int margin, real32_T *dis,
+                    int nRows, int nCols, int16_T invalidValue, int borderWidth,
+                    bool isRowMajor)
+    {
+        const int rowBegin = (int)((long long)nRows * s / numStrips);
+        const int rowEnd = (int)((long long)nRows * (s + 1) / numStrips);
+        const cv::Range rows(std::max(rowBegin - margin, 0),
+                             std::min(rowEnd + margin, nRows));
+
+        if (!mRanges.empty())
+        {
+            // the strip marks its invalid pixels below its own range
+            const DisparityRange &range = mRanges[s];
+            mStripBms[s]->setMinDisparity(range.minDisparity);
+            mStripBms[s]->setNumDisparities(range.numberOfDisparities);
+            invalidValue = std::max(invalidValue,
+                                    (int16_T)((range.minDisparity - 1) * 16));
+        }
+
+        cv::Mat &stripDisparity = mStripDisparities[s];
+        mStripBms[s]->compute(mMat1.rowRange(rows), mMat2.rowRange(rows),
+                              stripDisparity);
+        clipAndCastRowsBM(stripDisparity.ptr<int16_T>(rowBegin - rows.start),
+            stripDisparity.step1(), dis, nRows, nCols, rowBegin, rowEnd,
+            invalidValue, borderWidth, isRowMajor);
+    }
+
+    // Matches the frames at 1/4 of their size and plans the range of each
+    // of the numStrips strips in mRanges; mRanges is left empty otherwise
+    void matchCoarse(int nRows, int numStrips, const cvstDBMStruct_T *params)
+    {
+        const DisparityRange coarse = coarseRange(params->minDisparity,
+                                                  params->numberOfDisparities);
+        cvstDBMStruct_T coarseParams = *params;
+        coarseParams.minDisparity = coarse.minDisparity;
+        coarseParams.numberOfDisparities = coarse.numberOfDisparities;
+        coarseParams.SADWindowSize = coarseBlockSize(params->SADWindowSize, 5);
+        coarseParams.speckleWindowSize = 0;
+        configure(mCoarseBm, &coarseParams);
+
+        mCoarse.downsample(mMat1, mMat2);
+        mCoarseBm->compute(mCoarse.small1(), mCoarse.small2(),
+                           mCoarse.coarseDisparity());
+        mCoarse.planRanges(nRows, numStrips, coarse, params->minDisparity,
+                           params->numberOfDisparities, mRanges);
+    }
+
+    // Drops the headers of the caller's frames, which must not be written
+    // by the padding path
+    void unwrap()
+    {
+        if (mIsWrapped)
+        {
+            mMat1.release();
+            mMat2.release();
+            mIsWrapped = false;
+        }
+    }
+
+    // Copies the frames to mMat1 and mMat2, transposed to row major and
+    // padded to numCols columns
+    void copyFrames(const uint8_T *image1, const uint8_T *image2, mwSize numRows,
+                    mwSize numInCols, mwSize numCols, bool isRowMajor)
+    {
+        if (isRowMajor)
+        {
+            copyAndPadRM((uint8_T *)image1, mMat1.data, numRows, numInCols, numRows, numCols, numRows);
+            copyAndPadRM((uint8_T *)image2, mMat2.data, numRows, numInCols, numRows, numCols, numRows);
+        }
+        else
+        {
+            transposeAndPad((uint8_T *)image1, mMat1.data, numRows, numInCols, numRows, numCols, numRows);
+            transposeAndPad((uint8_T *)image2, mMat2.data, numRows, numInCols, numRows, numCols, numRows);
+        }
+    }
+
+    void configure(cv::Ptr<cv::StereoBM> &bm, const cvstDBMStruct_T *params)
+    {
+        if (bm.empty())
+        {
+            bm = cv::StereoBM::create(params->numberOfDisparities,
+                                      params->SADWindowSize);
+        }
+        else
+        {
+            bm->setNumDisparities(params->numberOfDisparities);
+            bm->setBlockSize(params->SADWindowSize);
+        }
+
+        bm->setPreFilterCap(params->preFilterCap);
+        bm->setMinDisparity(params->minDisparity);
+        bm->setTextureThreshold(params->textureThreshold);
+        bm->setUniquenessRatio(params->uniquenessRatio);
+        bm->setDisp12MaxDiff(params->disp12MaxDiff);
+        bm->setPreFilterType(params->preFilterType);
+        bm->setPreFilterSize(params->preFilterSize);
+        bm->setSpeckleWindowSize(params->speckleWindowSize);
+        bm->setSpeckleRange(params->speckleRange);
+    }
+
+    // Rows above and below a strip that reach its rows through the
+    // prefilter (preFilterSize, or 3 for the x-Sobel) and the block
+    static int getStripMargin(const cvstDBMStruct_T *params)
+    {
+        return params->SADWindowSize / 2 + std::max(params->preFilterSize, 3) / 2 + 1;
+    }
+
+    // numStrips, or the number of pool threads if it is 0. Speckle
+    // filtering follows regions across the frame, so it runs on a single
+    // strip, as do frames too short for strips well above their margins.
+    // With coarseToFine, there is at least one strip per COARSE_STRIP_ROWS
+    // rows, each with its own range, and speckles are filtered per strip.
+    static int getNumStrips(int nRows, const cvstDBMStruct_T *params)
+    {
+        if (!params->coarseToFine &&
+            params->speckleWindowSize > 0 && params->speckleRange >= 0)
+        {
+            return 1;
+        }
+        int requested = (params->numStrips > 0) ? params->numStrips
+                                                : (int)cgGetNumThreads();
+        if (params->coarseToFine)
+        {
+            requested = std::max(requested,
+                (nRows + COARSE_STRIP_ROWS - 1) / COARSE_STRIP_ROWS);
+        }
+        const int minRows = std::max(4 * getStripMargin(params), 32);
+        return std::max(1, std::min(requested, nRows / minRows));
+    }
+
+    static bool useCuda(const cvstDBMStruct_T *params)
+    {
+#if defined(DISPARITY_HAVE_CUDA)
+        return params->useGPU && canUseCuda(params);
+#else
+        (void)params;
+        return false;
+#endif
+    }
+
+    // The CUDA matcher has no minimum disparity and limits the search range
+    // and the block size
+    static bool canUseCuda(const cvstDBMStruct_T *params)
+    {
+        return isCudaAvailable() &&
+            params->minDisparity == 0 &&
+            params->numberOfDisparities <= 256 &&
+            params->SADWindowSize <= 31;
+    }
+
+#if defined(DISPARITY_HAVE_CUDA)
+    void configureCuda(const cvstDBMStruct_T *params)
+    {
+        if (mCudaBm.empty())
+        {
+            mCudaBm = cv::cuda::createStereoBM(params->numberOfDisparities,
+                                               params->SADWindowSize);
+        }
+        else
+        {
+            mCudaBm->setNumDisparities(params->numberOfDisparities);
+            mCudaBm->setBlockSize(params->SADWindowSize);
+        }
+
+        mCudaBm->setPreFilterType(params->preFilterType);
+        mCudaBm->setPreFilterCap(params->preFilterCap);
+        mCudaBm->setTextureThreshold(params->textureThreshold);
+    }
+
+    cv::Ptr<cv::cuda::StereoBM> mCudaBm;
+
+    // page-locked input frames and device buffers
+    DisparityCudaFrames mCudaFrames;
+#endif
+
+    cv::Ptr<cv::StereoBM> mBm;
+
+    // row major input frames: padded copies, or headers of the caller's
+    // frames when mIsWrapped
+    cv::Mat mMat1;
+    cv::Mat mMat2;
+    bool mIsWrapped;
+
+    // matchers and disparities of the strips; each strip matcher keeps
+    // its own buffers
+    std::vector<cv::Ptr<cv::StereoBM> > mStripBms;
+    std::vector<cv::Mat> mStripDisparities;
+
+    // coarse frames, matcher and the search range of each strip
+    DisparityCoarseRanges mCoarse;
+    cv::Ptr<cv::StereoBM> mCoarseBm;
+    std::vector<DisparityRange> mRanges;
+
+    // fixed point disparity
+    cv::Mat mDisparity;
+
+    // copying and assignment are disallowed
+    DisparityBMOcv(const DisparityBMOcv &);
+    DisparityBMOcv &operator=(const DisparityBMOcv &);
+};
+
+} // namespace disparity
+
+#endif
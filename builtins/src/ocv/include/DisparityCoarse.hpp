@@ -0,0 +1,204 @@
+//////////////////////////////////////////////////////////////////////////////
+// Coarse to fine search ranges shared by the CPU disparity matchers.
+//
+// The frames are matched at 1/4 of their size over 1/4 of the disparity
+// range, which costs about 1/64 of a full match. The full size frame is
+// then matched in horizontal strips, each over the range its coarse
+// disparities span, widened by a margin and rounded up to a multiple of
+// 16, within the range of the parameters. A strip whose coarse disparity
+// is mostly invalid, as in untextured regions, is searched over the whole
+// range. OpenCV searches one range per call, so the ranges follow rows of
+// strips and not single pixels; the strips of wide baseline scenes, where
+// near and far objects rarely share rows, typically search a fraction of
+// the range.
+//
+// Each strip marks its invalid pixels with its own minimum disparity. The
+// strip rows are copied into the frame disparity with the invalid value
+// of the whole range, so the output is marked as with a single search.
+//
+// Copyright 2016 The MathWorks, Inc.
+//
+//////////////////////////////////////////////////////////////////////////////
+#ifndef DISPARITY_COARSE
+#define DISPARITY_COARSE
+
+#include <algorithm>
+#include <vector>
+
+#include "opencv2/core.hpp"
+#include "opencv2/imgproc.hpp"
+
+namespace disparity
+{
+
+// Size reduction of the coarse frames
+const int COARSE_SCALE = 4;
+
+// Rows of the full size strips that get their own range
+const int COARSE_STRIP_ROWS = 128;
+
+// Full size disparities searched beyond those the coarse match found
+const int COARSE_MARGIN = 8;
+
+// Fraction of valid coarse pixels below which a strip searches the whole
+// range, and fraction of them ignored at either end of their histogram
+const double COARSE_MIN_VALID = 0.25;
+const double COARSE_OUTLIERS  = 0.01;
+
+struct DisparityRange
+{
+    int minDisparity;
+    int numberOfDisparities;
+};
+
+inline int floorDiv(int a, int b)
+{
+    return (a >= 0) ? a / b : -((-a + b - 1) / b);
+}
+
+inline int roundUp16(int n)
+{
+    return std::max((n + 15) / 16 * 16, 16);
+}
+
+// Range of the coarse match, covering the scaled full range
+inline DisparityRange coarseRange(int minDisparity, int numberOfDisparities)
+{
+    DisparityRange r;
+    r.minDisparity = floorDiv(minDisparity, COARSE_SCALE);
+    r.numberOfDisparities = roundUp16(
+        -floorDiv(-(minDisparity + numberOfDisparities), COARSE_SCALE) - r.minDisparity);
+    return r;
+}
+
+// Odd block size of the coarse match, at least minSize
+inline int coarseBlockSize(int blockSize, int minSize)
+{
+    return std::max((blockSize / COARSE_SCALE) | 1, minSize);
+}
+
+class DisparityCoarseRanges
+{
+public:
+    DisparityCoarseRanges() {}
+
+    // Reduces the row major frames to the coarse frames
+    void downsample(const cv::Mat &mat1, const cv::Mat &mat2)
+    {
+        const cv::Size size(std::max(mat1.cols / COARSE_SCALE, 1),
+                            std::max(mat1.rows / COARSE_SCALE, 1));
+        cv::resize(mat1, mSmall1, size, 0, 0, cv::INTER_AREA);
+        cv::resize(mat2, mSmall2, size, 0, 0, cv::INTER_AREA);
+    }
+
+    const cv::Mat &small1() const { return mSmall1; }
+    const cv::Mat &small2() const { return mSmall2; }
+
+    // fixed point disparity of the coarse match, 4 fractional bits
+    cv::Mat &coarseDisparity() { return mCoarseDisparity; }
+
+    // Range of each of numStrips strips of a numRows frame, from the coarse
+    // disparity matched over coarse, within [minDisparity,
+    // minDisparity + numberOfDisparities)
+    void planRanges(int numRows, int numStrips, const DisparityRange &coarse,
+                    int minDisparity, int numberOfDisparities,
+                    std::vector<DisparityRange> &ranges)
+    {
+        const int maxDisparity = minDisparity + numberOfDisparities;
+        const int numBins = coarse.numberOfDisparities;
+        const int cRows = mCoarseDisparity.rows, cCols = mCoarseDisparity.cols;
+
+        ranges.resize(numStrips);
+        mHistogram.resize(numBins);
+        for (int s = 0; s < numStrips; ++s)
+        {
+            DisparityRange &r = ranges[s];
+            r.minDisparity = minDisparity;
+            r.numberOfDisparities = numberOfDisparities;
+
+            // coarse rows of the strip, and one on either side
+            const int y0 = (int)((long long)numRows * s / numStrips);
+            const int y1 = (int)((long long)numRows * (s + 1) / numStrips);
+            const int c0 = std::max(y0 / COARSE_SCALE - 1, 0);
+            const int c1 = std::min((y1 + COARSE_SCALE - 1) / COARSE_SCALE + 1, cRows);
+            if (c0 >= c1)
+            {
+                continue;
+            }
+
+            std::fill(mHistogram.begin(), mHistogram.end(), 0);
+            int numValid = 0;
+            for (int y = c0; y < c1; ++y)
+            {
+                const short *row = mCoarseDisparity.ptr<short>(y);
+                for (int x = 0; x < cCols; ++x)
+                {
+                    const int bin = (row[x] >> 4) - coarse.minDisparity;
+                    if (bin >= 0 && bin < numBins)
+                    {
+                        ++mHistogram[bin];
+                        ++numValid;
+                    }
+                }
+            }
+            if (numValid < COARSE_MIN_VALID * (c1 - c0) * cCols)
+            {
+                continue;
+            }
+
+            // coarse disparities between the outliers
+            const int skip = (int)(COARSE_OUTLIERS * numValid);
+            int lo = 0, hi = numBins - 1, count = 0;
+            for (; lo < numBins && count + mHistogram[lo] <= skip; ++lo)
+            {
+                count += mHistogram[lo];
+            }
+            for (count = 0; hi > lo && count + mHistogram[hi] <= skip; --hi)
+            {
+                count += mHistogram[hi];
+            }
+
+            // to full size, with the margin and the fraction of the top bin
+            int first = (lo + coarse.minDisparity) * COARSE_SCALE - COARSE_MARGIN;
+            int last  = (hi + coarse.minDisparity + 1) * COARSE_SCALE + COARSE_MARGIN;
+            first = std::max(first, minDisparity);
+            last  = std::min(last, maxDisparity - 1);
+            if (first > last)
+            {
+                continue;
+            }
+            const int num = std::min(roundUp16(last - first + 1), numberOfDisparities);
+            r.minDisparity = std::max(std::min(first, maxDisparity - num), minDisparity);
+            r.numberOfDisparities = num;
+        }
+    }
+
+private:
+    cv::Mat mSmall1;
+    cv::Mat mSmall2;
+    cv::Mat mCoarseDisparity;
+    std::vector<int> mHistogram;
+};
+
+// Copies rows [y0, y1) of the frame disparity from the strip disparity,
+// whose row firstRow is frame row y0, matched over range. The pixels the
+// strip marks invalid get the invalid value of the whole range.
+inline void copyStripRows(const cv::Mat &strip, int firstRow, cv::Mat &disparity,
+                          int y0, int y1, const DisparityRange &range,
+                          short invalidValue)
+{
+    const short minValid = (short)(range.minDisparity * 16);
+    for (int y = y0; y < y1; ++y)
+    {
+        const short *in = strip.ptr<short>(firstRow + y - y0);
+        short *out = disparity.ptr<short>(y);
+        for (int x = 0; x < disparity.cols; ++x)
+        {
+            out[x] = (in[x] < minValid) ? invalidValue : in[x];
+        }
+    }
+}
+
+} // namespace disparity
+
+#endif
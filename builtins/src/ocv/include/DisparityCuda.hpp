@@ -0,0 +1,113 @@
+//////////////////////////////////////////////////////////////////////////////
+// Device buffers shared by the CUDA disparity matchers.
+//
+// The padded input frames are staged in page-locked host memory so that the
+// uploads run asynchronously on the matcher's stream. The device frames and
+// the device disparity are kept across calls to step(), so stepping frames
+// of a fixed size does not allocate on either side.
+//
+// The CUDA path is only compiled when the OpenCV build provides the
+// cudastereo module, and only taken when a CUDA device is present.
+//
+// Copyright 2016 The MathWorks, Inc.
+//
+//////////////////////////////////////////////////////////////////////////////
+#ifndef DISPARITY_CUDA
+#define DISPARITY_CUDA
+
+#include "opencv2/opencv_modules.hpp"
+#include "opencv2/core.hpp"
+
+#if defined(HAVE_OPENCV_CUDASTEREO)
+#include "opencv2/core/cuda.hpp"
+#include "CudaDevice.hpp"
+#include "opencv2/cudastereo.hpp"
+#define DISPARITY_HAVE_CUDA
+#endif
+
+namespace disparity
+{
+
+// Returns true if the disparity matchers can run on a CUDA device
+inline bool isCudaAvailable()
+{
+#if defined(DISPARITY_HAVE_CUDA)
+    return vision::getCudaDeviceCount() > 0;
+#else
+    return false;
+#endif
+}
+
+#if defined(DISPARITY_HAVE_CUDA)
+
+class DisparityCudaFrames
+{
+public:
+    DisparityCudaFrames() {}
+
+    // Allocates the page-locked host frames. The returned headers are
+    // filled by the caller before upload().
+    void createHostFrames(int numRows, int numCols, cv::Mat &host1, cv::Mat &host2)
+    {
+        if (mHost1.rows != numRows || mHost1.cols != numCols)
+        {
+            mHost1.create(numRows, numCols, CV_8UC1);
+            mHost2.create(numRows, numCols, CV_8UC1);
+        }
+        host1 = mHost1.createMatHeader();
+        host2 = mHost2.createMatHeader();
+    }
+
+    // Queues the copies of the host frames to the device
+    void upload()
+    {
+        mDevice1.upload(mHost1, mStream);
+        mDevice2.upload(mHost2, mStream);
+    }
+
+    // Queues the conversion of the device disparity to the given type and
+    // scale and its copy to page-locked host memory, then waits for all
+    // work queued on the stream. The returned header stays valid until the
+    // next call.
+    cv::Mat download(int rtype, double alpha)
+    {
+        mDeviceDisparity.convertTo(mDeviceConverted, rtype, alpha, mStream);
+        mHostDisparity.create(mDeviceConverted.rows, mDeviceConverted.cols, rtype);
+        mDeviceConverted.download(mHostDisparity, mStream);
+        mStream.waitForCompletion();
+        return mHostDisparity.createMatHeader();
+    }
+
+    cv::cuda::GpuMat &device1() { return mDevice1; }
+    cv::cuda::GpuMat &device2() { return mDevice2; }
+    cv::cuda::GpuMat &deviceDisparity() { return mDeviceDisparity; }
+    cv::cuda::Stream &stream() { return mStream; }
+
+private:
+    // page-locked padded row major input frames
+    cv::cuda::HostMem mHost1;
+    cv::cuda::HostMem mHost2;
+
+    // device copies of the input frames
+    cv::cuda::GpuMat mDevice1;
+    cv::cuda::GpuMat mDevice2;
+
+    // disparity as computed by the matcher, and after conversion
+    cv::cuda::GpuMat mDeviceDisparity;
+    cv::cuda::GpuMat mDeviceConverted;
+
+    // page-locked copy of the converted disparity
+    cv::cuda::HostMem mHostDisparity;
+
+    cv::cuda::Stream mStream;
+
+    // copying and assignment are disallowed
+    DisparityCudaFrames(const DisparityCudaFrames &);
+    DisparityCudaFrames &operator=(const DisparityCudaFrames &);
+};
+
+#endif // DISPARITY_HAVE_CUDA
+
+} // namespace disparity
+
+#endif
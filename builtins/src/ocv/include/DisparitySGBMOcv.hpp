@@ -0,0 +1,515 @@
+//////////////////////////////////////////////////////////////////////////////
+// Stateful semi-global block matcher.
+//
+// The OpenCV matcher, the padded input frames and the disparity buffers are
+// kept across calls to step(). OpenCV keeps its cost volume inside the
+// matcher, so once the frame size is fixed, stepping does not allocate.
+//
+// In strip mode, the frame is split into horizontal strips that are matched
+// in parallel. Neighboring strips overlap so that the vertical aggregation
+// paths settle before the rows that are kept. Each thread owns one matcher,
+// which bounds the peak memory by the number of threads times the buffer of
+// one strip. A memory budget reduces the number of concurrent strips and,
+// in HH mode where the buffer grows with the number of rows, makes the
+// strips shorter.
+//
+// With coarseToFine, a match of the frames at 1/4 of their size gives
+// each strip its own search range (see DisparityCoarse.hpp); the frame is
+// then always matched in strips, at least one per COARSE_STRIP_ROWS rows.
+//
+// When useGPU is set and a CUDA device is present, the frames are matched
+// on the device by cv::cuda::StereoConstantSpaceBP. It is the closest CUDA
+// counterpart of the semi-global matcher: it also enforces smoothness
+// between neighboring pixels, but by loopy belief propagation on a pyramid
+// rather than by aggregating costs along paths. It searches from disparity
+// 0 in whole pixels and produces a dense map, so no pixel is marked
+// invalid. A minimum disparity falls back to the CPU matcher.
+//
+// Copyright 2016 The MathWorks, Inc.
+//
+//////////////////////////////////////////////////////////////////////////////
+#ifndef DISPARITY_SGBM_OCV
+#define DISPARITY_SGBM_OCV
+
+#include <algorithm>
+#include <cfloat>
+#include <vector>
+
+#include "disparitySGBMCore_api.hpp"
+#include "disparityBM.hpp"
+#include "DisparityCuda.hpp"
+#include "DisparityCoarse.hpp"
+#include "cgProfile.hpp"
+
+#include "opencv2/calib3d.hpp"
+
+namespace disparity
+{
+
+// Rows computed above and below each strip, in addition to half the block
+// size, and discarded afterwards
+const int SGBM_STRIP_OVERLAP = 32;
+
+// Minimum number of rows kept from a strip
+const int SGBM_MIN_STRIP_ROWS = 32;
+
+// Matches the strips assigned to each matcher, each over its own range
+// when ranges is not NULL
+struct DisparitySGBMStripInvoker : cv::ParallelLoopBody
+{
+    DisparitySGBMStripInvoker(std::vector<cv::Ptr<cv::StereoSGBM> > &_matchers,
+                              std::vector<cv::Mat> &_stripDisparity,
+                              const cv::Mat &_mat1, const cv::Mat &_mat2,
+                              cv::Mat &_disparity, int _numStrips, int _overlap,
+                              const std::vector<DisparityRange> *_ranges = NULL,
+                              short _invalidValue = 0)
+    {
+        matchers = &_matchers;
+        stripDisparity = &_stripDisparity;
+        mat1 = &_mat1;
+        mat2 = &_mat2;
+        disparity = &_disparity;
+        numStrips = _numStrips;
+        overlap = _overlap;
+        ranges = _ranges;
+        invalidValue = _invalidValue;
+    }
+
+    void operator()(const cv::Range& range) const
+    {
+        CG_TRACE_SPAN("DisparitySGBMStripInvoker");
+        const int numSlots = (int)matchers->size();
+        const int numRows = mat1->rows;
+
+        for (int slot = range.start; slot < range.end; ++slot)
+        {
+            cv::StereoSGBM &matcher = *(*matchers)[slot];
+            cv::Mat &stripOut = (*stripDisparity)[slot];
+
+            const int firstStrip = slot * numStrips / numSlots;
+            const int lastStrip  = (slot + 1) * numStrips / numSlots;
+            for (int i = firstStrip; i < lastStrip; ++i)
+            {
+                // rows kept from this strip and rows that are computed
+                const int y0 = (int)((long long)numRows * i / numStrips);
+                const int y1 = (int)((long long)numRows * (i + 1) / numStrips);
+                const int c0 = std::max(y0 - overlap, 0);
+                const int c1 = std::min(y1 + overlap, numRows);
+
+                if (ranges)
+                {
+                    matcher.setMinDisparity((*ranges)[i].minDisparity);
+                    matcher.setNumDisparities((*ranges)[i].numberOfDisparities);
+                }
+                matcher.compute(mat1->rowRange(c0, c1), mat2->rowRange(c0, c1),
+                                stripOut);
+
+                if (ranges)
+                {
+                    copyStripRows(stripOut, y0 - c0, *disparity, y0, y1,
+                                  (*ranges)[i], invalidValue);
+                    continue;
+                }
+                cv::Mat kept = disparity->rowRange(y0, y1);
+                stripOut.rowRange(y0 - c0, y1 - c0).copyTo(kept);
+            }
+        }
+    }
+
+    std::vector<cv::Ptr<cv::StereoSGBM> > *matchers;
+    std::vector<cv::Mat> *stripDisparity;
+    const cv::Mat *mat1;
+    const cv::Mat *mat2;
+    cv::Mat *disparity;
+    int numStrips;
+    int overlap;
+    const std::vector<DisparityRange> *ranges;
+    short invalidValue;
+};
+
+class DisparitySGBMOcv
+{
+public:
+    DisparitySGBMOcv() {}
+
+    // Computes the disparity of image1 relative to image2. Both images and
+    // dis are nRows-by-nCols, column major unless isRowMajor is true.
+    void step(const uint8_T *image1, const uint8_T *image2,
+              int nRows, int nCols, real32_T *dis,
+              const cvstDSGBMStruct_T *params, bool isRowMajor)
+    {
+        mwSize numRows   = (mwSize)nRows;
+        mwSize numInCols = (mwSize)nCols;
+        mwSize numCols   = getNumPaddedCols(nCols);
+
+        createFrames(nRows, nCols, params);
+        if (isRowMajor)
+        {
+            copyAndPadRM((uint8_T *)image1, mMat1.data, numRows, numInCols, numRows, numCols, numRows);
+            copyAndPadRM((uint8_T *)image2, mMat2.data, numRows, numInCols, numRows, numCols, numRows);
+        }
+        else
+        {
+            transposeAndPad((uint8_T *)image1, mMat1.data, numRows, numInCols, numRows, numCols, numRows);
+            transposeAndPad((uint8_T *)image2, mMat2.data, numRows, numInCols, numRows, numCols, numRows);
+        }
+
+        stepFrames(nRows, nCols, dis, params, isRowMajor);
+    }
+
+    // OpenCV requires the number of column to be divisible by 4, in order
+    // to use fast computation. So, if the input image does not meet this
+    // requirement, extra columns are padded to the image.
+    static int getNumPaddedCols(int nCols)
+    {
+        return (nCols + 3) / 4 * 4;
+    }
+
+    // Allocates the row major nRows-by-getNumPaddedCols(nCols) frames, which
+    // the caller fills through frame1() and frame2() before stepFrames().
+    // Buffers are only reallocated when the frame size changes.
+    void createFrames(int nRows, int nCols, const cvstDSGBMStruct_T *params)
+    {
+        const int numCols = getNumPaddedCols(nCols);
+#if defined(DISPARITY_HAVE_CUDA)
+        if (useCuda(params))
+        {
+            mCudaFrames.createHostFrames(nRows, numCols, mMat1, mMat2);
+            return;
+        }
+#else
+        (void)params;
+#endif
+        mMat1.create(nRows, numCols, CV_8UC1);
+        mMat2.create(nRows, numCols, CV_8UC1);
+    }
+
+    cv::Mat &frame1() { return mMat1; }
+    cv::Mat &frame2() { return mMat2; }
+
+    // Matches the frames of an nRows-by-nCols step, and writes dis
+    void stepFrames(int nRows, int nCols, real32_T *dis,
+                    const cvstDSGBMStruct_T *params, bool isRowMajor)
+    {
+        mwSize numRows   = (mwSize)nRows;
+        mwSize numInCols = (mwSize)nCols;
+        mwSize numCols   = getNumPaddedCols(nCols);
+        CG_PROFILE_PHASE(CG_PROFILE_COMPUTE);
+
+#if defined(DISPARITY_HAVE_CUDA)
+        if (useCuda(params))
+        {
+            configureCuda((int)numRows, (int)numCols, params);
+
+            // The CUDA matcher outputs whole pixels; the conversion to
+            // float runs on the device.
+            mCudaFrames.upload();
+            mCudaBp->compute(mCudaFrames.device1(), mCudaFrames.device2(),
+                             mCudaFrames.deviceDisparity(), mCudaFrames.stream());
+            mDisparityFloat = mCudaFrames.download(CV_32FC1, 1.0);
+        }
+        else
+#endif
+        {
+            computeOnHost((int)numRows, (int)numCols, params);
+        }
+        CG_PROFILE_PHASE(CG_PROFILE_OUTPUT);
+        real32_T *outData = (real32_T *)mDisparityFloat.data;
+
+        // Transpose the image from row major to column major and clip
+        // it if the image was padded earlier.
+        real32_T invalidValue = (real32_T)(params->minDisparity - 1);
+        mwSize borderWidth = 0;
+        if (isRowMajor)
+        {
+            copyAndClipRM(outData, dis, numInCols, numRows, numInCols, numRows,
+                numCols, invalidValue, borderWidth);
+        }
+        else
+        {
+            transposeAndClip(outData, dis, numInCols, numRows, numInCols, numRows,
+                numCols, invalidValue, borderWidth);
+        }
+    }
+
+    // Bytes used to match numRows-by-numCols frames on the CPU: peak
+    // during a step and steady, kept by the matcher between steps. The
+    // matchers keep their buffers, so both are the same; the strips and
+    // the number of concurrent matchers are those the memory budget and
+    // the number of threads select.
+    static void estimateFootprint(int numRows, int numCols,
+                                  const cvstDSGBMStruct_T *params,
+                                  double &peakBytes, double &steadyBytes)
+    {
+        const int numPaddedCols = (numCols + 3) / 4 * 4;
+        int numStrips, numSlots;
+        planStrips(numRows, numPaddedCols, params, numStrips, numSlots);
+
+        // input frames and float disparity
+        double bytes = (double)numRows * numPaddedCols * (2 + sizeof(float));
+        if (numStrips <= 1)
+        {
+            bytes += estimateMemory(numRows, numPaddedCols, params);
+        }
+        else
+        {
+            const int stripRows = std::min((numRows + numStrips - 1) / numStrips +
+                2 * getStripOverlap(params), numRows);
+            bytes += numSlots * estimateMemory(stripRows, numPaddedCols, params) +
+                (double)numRows * numPaddedCols * sizeof(short);
+        }
+        peakBytes = bytes;
+        steadyBytes = bytes;
+    }
+
+private:
+    void computeOnHost(int numRows, int numCols, const cvstDSGBMStruct_T *params)
+    {
+        int numStrips, numSlots;
+        planStrips(numRows, numCols, params, numStrips, numSlots);
+        if (params->coarseToFine)
+        {
+            const int maxStrips = std::max(numRows / SGBM_MIN_STRIP_ROWS, 1);
+            numStrips = std::min(std::max(numStrips,
+                (numRows + COARSE_STRIP_ROWS - 1) / COARSE_STRIP_ROWS), maxStrips);
+        }
+
+        if (mMatchers.size() != (size_t)numSlots)
+        {
+            mMatchers.resize(numSlots);
+            mStripDisparity.resize(numSlots);
+        }
+        for (int slot = 0; slot < numSlots; ++slot)
+        {
+            configure(mMatchers[slot], params);
+        }
+
+        if (params->coarseToFine)
+        {
+            matchCoarseToFine(numRows, numCols, numStrips, numSlots, params);
+        }
+        // Invoke StereoSGBM function in OpenCV
+        else if (numStrips <= 1)
+        {
+            mMatchers[0]->compute(mMat1, mMat2, mDisparity);
+        }
+        else
+        {
+            mDisparity.create(numRows, numCols, CV_16SC1);
+            cv::parallel_for_(cv::Range(0, numSlots),
+                DisparitySGBMStripInvoker(mMatchers, mStripDisparity,
+                    mMat1, mMat2, mDisparity, numStrips,
+                    getStripOverlap(params)),
+                numSlots);
+        }
+
+        // For class support, int becomes float
+        mDisparity.convertTo(mDisparityFloat, CV_32FC1, 1/16.);
+    }
+
+    // Matches the frames at 1/4 of their size, then each strip over the
+    // range of its coarse disparities
+    void matchCoarseToFine(int numRows, int numCols, int numStrips, int numSlots,
+                           const cvstDSGBMStruct_T *params)
+    {
+        // the penalties follow the area of the smaller blocks
+        const DisparityRange coarse = coarseRange(params->minDisparity,
+                                                  params->numberOfDisparities);
+        cvstDSGBMStruct_T coarseParams = *params;
+        coarseParams.minDisparity = coarse.minDisparity;
+        coarseParams.numberOfDisparities = coarse.numberOfDisparities;
+        coarseParams.SADWindowSize = coarseBlockSize(params->SADWindowSize, 3);
+        const double area = (double)(coarseParams.SADWindowSize * coarseParams.SADWindowSize) /
+                            std::max(params->SADWindowSize * params->SADWindowSize, 1);
+        coarseParams.P1 = (int)(params->P1 * area + 0.5);
+        coarseParams.P2 = std::max((int)(params->P2 * area + 0.5), coarseParams.P1 + 1);
+        coarseParams.speckleWindowSize = 0;
+        configure(mCoarseMatcher, &coarseParams);
+
+        mCoarse.downsample(mMat1, mMat2);
+        mCoarseMatcher->compute(mCoarse.small1(), mCoarse.small2(),
+                                mCoarse.coarseDisparity());
+        mCoarse.planRanges(numRows, numStrips, coarse, params->minDisparity,
+                           params->numberOfDisparities, mRanges);
+
+        mDisparity.create(numRows, numCols, CV_16SC1);
+        cv::parallel_for_(cv::Range(0, numSlots),
+            DisparitySGBMStripInvoker(mMatchers, mStripDisparity,
+                mMat1, mMat2, mDisparity, numStrips,
+                getStripOverlap(params), &mRanges,
+                (short)((params->minDisparity - 1) * 16)),
+            numSlots);
+    }
+
+    static bool useCuda(const cvstDSGBMStruct_T *params)
+    {
+#if defined(DISPARITY_HAVE_CUDA)
+        return params->useGPU && canUseCuda(params);
+#else
+        (void)params;
+        return false;
+#endif
+    }
+
+    // The CUDA matcher has no minimum disparity
+    static bool canUseCuda(const cvstDSGBMStruct_T *params)
+    {
+        return isCudaAvailable() && params->minDisparity == 0;
+    }
+
+#if defined(DISPARITY_HAVE_CUDA)
+    // The number of iterations, levels and planes follow OpenCV's
+    // recommendation for the frame size; they only change with it.
+    void configureCuda(int numRows, int numCols, const cvstDSGBMStruct_T *params)
+    {
+        if (mCudaBp.empty() || numRows != mCudaRows || numCols != mCudaCols)
+        {
+            int ndisp, iters, levels, nrPlane;
+            cv::cuda::StereoConstantSpaceBP::estimateRecommendedParams(
+                numCols, numRows, ndisp, iters, levels, nrPlane);
+
+            mCudaBp = cv::cuda::createStereoConstantSpaceBP(
+                params->numberOfDisparities, iters, levels, nrPlane, CV_32F);
+            mCudaRows = numRows;
+            mCudaCols = numCols;
+        }
+        mCudaBp->setNumDisparities(params->numberOfDisparities);
+    }
+
+    cv::Ptr<cv::cuda::StereoConstantSpaceBP> mCudaBp;
+    int mCudaRows;
+    int mCudaCols;
+
+    // page-locked input frames and device buffers
+    DisparityCudaFrames mCudaFrames;
+#endif
+
+    // Estimated size in bytes of the buffer allocated by OpenCV's
+    // StereoSGBM for a numRows-by-numCols frame, and of its output. Only
+    // the HH mode keeps the costs of all rows.
+    static double estimateMemory(int numRows, int numCols,
+                                 const cvstDSGBMStruct_T *params)
+    {
+        const double D  = std::max(params->numberOfDisparities, 16);
+        const double D2 = D + 16;
+        const double width1 = std::max(numCols - params->numberOfDisparities, 1);
+        const int NR2 = 8, NLR = 2;
+
+        const double costBufSize = width1 * D;
+        const double CSBufSize = costBufSize *
+            (params->mode == cv::StereoSGBM::MODE_HH ? numRows : 1);
+        const double minLrSize = (width1 + 2) * NR2;
+        const double LrSize = minLrSize * D2;
+        const double hsumRows = (params->SADWindowSize / 2) * 2 + 2;
+
+        return ((LrSize + minLrSize) * NLR + CSBufSize * 2 +
+                hsumRows * numCols * D) * sizeof(short) +
+               (double)numRows * numCols * sizeof(short);
+    }
+
+    static int getStripOverlap(const cvstDSGBMStruct_T *params)
+    {
+        return SGBM_STRIP_OVERLAP + params->SADWindowSize / 2;
+    }
+
+    // Chooses the number of strips and the number of matchers that run
+    // concurrently.
+    static void planStrips(int numRows, int numCols,
+                           const cvstDSGBMStruct_T *params,
+                           int &numStrips, int &numSlots)
+    {
+        const double budget = params->memoryBudgetMB * 1024.0 * 1024.0;
+        const int overlap = getStripOverlap(params);
+        const int maxStrips = std::max(numRows / SGBM_MIN_STRIP_ROWS, 1);
+
+        numStrips = 1;
+        numSlots  = 1;
+        if (!params->useStrips &&
+            (budget <= 0 || estimateMemory(numRows, numCols, params) <= budget))
+        {
+            return;
+        }
+
+        const int maxSlots = params->useStrips ?
+            std::max(cv::getNumThreads(), 1) : 1;
+        numStrips = std::min(maxSlots, maxStrips);
+
+        for (;;)
+        {
+            const int stripRows = std::min(
+                (numRows + numStrips - 1) / numStrips + 2 * overlap, numRows);
+            const double stripMemory = estimateMemory(stripRows, numCols, params);
+
+            numSlots = std::min(numStrips, maxSlots);
+            while (budget > 0 && numSlots > 1 && numSlots * stripMemory > budget)
+            {
+                --numSlots;
+            }
+
+            // Shorter strips only reduce the memory of the HH mode. With the
+            // other modes, the budget may not be met with a single matcher.
+            if (budget <= 0 || numSlots * stripMemory <= budget ||
+                params->mode != cv::StereoSGBM::MODE_HH ||
+                numStrips >= maxStrips)
+            {
+                break;
+            }
+            numStrips = std::min(numStrips * 2, maxStrips);
+        }
+    }
+
+    static void configure(cv::Ptr<cv::StereoSGBM> &sgbm,
+                          const cvstDSGBMStruct_T *params)
+    {
+        if (sgbm.empty())
+        {
+            sgbm = cv::StereoSGBM::create(params->minDisparity,
+                params->numberOfDisparities, params->SADWindowSize,
+                params->P1, params->P2, params->disp12MaxDiff,
+                params->preFilterCap, params->uniquenessRatio,
+                params->speckleWindowSize, params->speckleRange,
+                params->mode);
+            return;
+        }
+
+        // parameters may be tuned between frames
+        sgbm->setMinDisparity(params->minDisparity);
+        sgbm->setNumDisparities(params->numberOfDisparities);
+        sgbm->setBlockSize(params->SADWindowSize);
+        sgbm->setP1(params->P1);
+        sgbm->setP2(params->P2);
+        sgbm->setDisp12MaxDiff(params->disp12MaxDiff);
+        sgbm->setPreFilterCap(params->preFilterCap);
+        sgbm->setUniquenessRatio(params->uniquenessRatio);
+        sgbm->setSpeckleWindowSize(params->speckleWindowSize);
+        sgbm->setSpeckleRange(params->speckleRange);
+        sgbm->setMode(params->mode);
+    }
+
+    // one matcher per concurrent strip; the first one matches whole frames
+    std::vector<cv::Ptr<cv::StereoSGBM> > mMatchers;
+
+    // disparity of the strip processed by each matcher
+    std::vector<cv::Mat> mStripDisparity;
+
+    // coarse frames, matcher and the search range of each strip
+    DisparityCoarseRanges mCoarse;
+    cv::Ptr<cv::StereoSGBM> mCoarseMatcher;
+    std::vector<DisparityRange> mRanges;
+
+    // padded row major input frames
+    cv::Mat mMat1;
+    cv::Mat mMat2;
+
+    // fixed point and floating point disparity
+    cv::Mat mDisparity;
+    cv::Mat mDisparityFloat;
+
+    // copying and assignment are disallowed
+    DisparitySGBMOcv(const DisparitySGBMOcv &);
+    DisparitySGBMOcv &operator=(const DisparitySGBMOcv &);
+};
+
+} // namespace disparity
+
+#endif
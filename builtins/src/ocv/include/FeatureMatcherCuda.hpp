@@ -0,0 +1,218 @@
+//////////////////////////////////////////////////////////////////////////////
+// Exhaustive feature matching on a CUDA device for matchFeatures.
+//
+// The database features (features2) are uploaded once and stay on the
+// device, so that a stream of queries only uploads the query features.
+// Each query runs a brute force 2-NN search of features1 against
+// features2 and, for unique matching, a 1-NN search of features2 against
+// features1, both queued on the matcher's stream. The host then applies the
+// match threshold, the ratio test and the bidirectional check to the
+// nearest neighbors, exactly as cvalgMatchFeatures does with the Exhaustive
+// method, and returns the surviving pairs only.
+//
+// The metric values are those of matchFeatures: the squared L2 distance for
+// 'ssd', the L1 distance for 'sad' and the Hamming distance for binary
+// features. When several features are at the same distance the device may
+// select a different one than the CPU, which takes the lowest index.
+//
+// Copyright 2016 The MathWorks, Inc.
+//
+//////////////////////////////////////////////////////////////////////////////
+#ifndef FEATURE_MATCHER_CUDA
+#define FEATURE_MATCHER_CUDA
+
+#include <string>
+#include <vector>
+
+#include "vision_defines.h"
+#include "cgProfile.hpp"
+
+#include "opencv2/opencv_modules.hpp"
+#include "opencv2/core.hpp"
+
+#if defined(HAVE_OPENCV_CUDAFEATURES2D)
+#include "opencv2/core/cuda.hpp"
+#include "CudaDevice.hpp"
+#include "opencv2/cudafeatures2d.hpp"
+#define FEATURE_MATCHER_HAVE_CUDA
+#endif
+
+namespace matchFeatures
+{
+
+// Returns true if device is a CUDA device the matcher can run on
+inline bool isCudaDevice(int device)
+{
+#if defined(FEATURE_MATCHER_HAVE_CUDA)
+    return vision::isCudaDevice(device);
+#else
+    (void)device;
+    return false;
+#endif
+}
+
+#if defined(FEATURE_MATCHER_HAVE_CUDA)
+
+class FeatureMatcherCuda
+{
+public:
+    // The stream and the buffers belong to the given device
+    explicit FeatureMatcherCuda(int device)
+        : mDevice(vision::selectCudaDevice(device)), mSquareDistances(false) {}
+
+    // Uploads the numFeatures2-by-numelInFeatureVec database features:
+    // CV_32F features matched with metric 'ssd' or 'sad', or CV_8U binary
+    // features matched with the Hamming distance.
+    void setFeatures2(const cv::Mat &features2, const std::string &metric)
+    {
+        cv::cuda::setDevice(mDevice);
+
+        int normType = cv::NORM_HAMMING;
+        mSquareDistances = false;
+        if (features2.type() == CV_32F)
+        {
+            mSquareDistances = (metric == "ssd");
+            normType = mSquareDistances ? cv::NORM_L2 : cv::NORM_L1;
+        }
+        mMatcher = cv::cuda::DescriptorMatcher::createBFMatcher(normType);
+
+        stage(features2, mHostFeatures2);
+        CG_PROFILE_PHASE(CG_PROFILE_COMPUTE);
+        mDeviceFeatures2.upload(mHostFeatures2, mStream);
+        mStream.waitForCompletion();
+    }
+
+    // Matches features1, of the type and length of features2. A query
+    // feature i matches its nearest neighbor j if their metric is at most
+    // matchThreshold, if the ratio of the metrics of the two nearest
+    // neighbors is at most maxRatio, and, for unique matches, if i is also
+    // the nearest neighbor of j. The 0-based indices and the metric of the
+    // matches are written in query order to the outputs, which hold at least
+    // one element per query feature. Returns the number of matches.
+    int match(const cv::Mat &features1, float matchThreshold, float maxRatio,
+              bool uniqueMatches, int32_T *queryIdx, int32_T *trainIdx,
+              real32_T *matchMetric)
+    {
+        cv::cuda::setDevice(mDevice);
+
+        const int numFeatures2 = mDeviceFeatures2.rows;
+        if (features1.rows == 0 || numFeatures2 == 0)
+        {
+            return 0;
+        }
+
+        // the ratio test needs two neighbors
+        const int knn = (numFeatures2 > 1) ? 2 : 1;
+
+        stage(features1, mHostFeatures1);
+        CG_PROFILE_PHASE(CG_PROFILE_COMPUTE);
+        mDeviceFeatures1.upload(mHostFeatures1, mStream);
+
+        mMatcher->knnMatchAsync(mDeviceFeatures1, mDeviceFeatures2,
+                                mDeviceKnnMatches, knn, cv::noArray(), mStream);
+        mDeviceKnnMatches.download(mHostKnnMatches, mStream);
+        if (uniqueMatches)
+        {
+            mMatcher->matchAsync(mDeviceFeatures2, mDeviceFeatures1,
+                                 mDeviceBackMatches, cv::noArray(), mStream);
+            mDeviceBackMatches.download(mHostBackMatches, mStream);
+        }
+        mStream.waitForCompletion();
+
+        mMatcher->knnMatchConvert(mHostKnnMatches.createMatHeader(), mKnnMatches);
+        if (uniqueMatches)
+        {
+            mMatcher->matchConvert(mHostBackMatches.createMatHeader(), mBackMatches);
+
+            // nearest query feature of each database feature
+            mNearestQuery.assign(numFeatures2, -1);
+            for (size_t j = 0; j < mBackMatches.size(); ++j)
+            {
+                mNearestQuery[mBackMatches[j].queryIdx] = mBackMatches[j].trainIdx;
+            }
+        }
+
+        int numMatches = 0;
+        for (size_t i = 0; i < mKnnMatches.size(); ++i)
+        {
+            const std::vector<cv::DMatch> &neighbors = mKnnMatches[i];
+            if (neighbors.empty())
+            {
+                continue;
+            }
+
+            const float metric1 = toMetric(neighbors[0].distance);
+            if (metric1 > matchThreshold)
+            {
+                continue;
+            }
+
+            if (neighbors.size() > 1)
+            {
+                // as in matchFeatures, a second neighbor at an effective
+                // zero distance passes the ratio test
+                const float metric2 = toMetric(neighbors[1].distance);
+                const float ratio = (metric2 < 1e-6f) ? 1.0f : metric1 / metric2;
+                if (ratio > maxRatio)
+                {
+                    continue;
+                }
+            }
+
+            if (uniqueMatches &&
+                mNearestQuery[neighbors[0].trainIdx] != neighbors[0].queryIdx)
+            {
+                continue;
+            }
+
+            queryIdx[numMatches] = (int32_T)neighbors[0].queryIdx;
+            trainIdx[numMatches] = (int32_T)neighbors[0].trainIdx;
+            matchMetric[numMatches] = (real32_T)metric1;
+            ++numMatches;
+        }
+        return numMatches;
+    }
+
+private:
+    static void stage(const cv::Mat &features, cv::cuda::HostMem &staged)
+    {
+        staged.create(features.rows, features.cols, features.type());
+        cv::Mat header = staged.createMatHeader();
+        features.copyTo(header);
+    }
+
+    // the L2 norm of OpenCV is the square root of the 'ssd' metric
+    float toMetric(float distance) const
+    {
+        return mSquareDistances ? distance * distance : distance;
+    }
+
+    // device index, selected before the stream is created
+    int mDevice;
+    cv::cuda::Stream mStream;
+
+    cv::Ptr<cv::cuda::DescriptorMatcher> mMatcher;
+    bool mSquareDistances;
+
+    // page-locked features and device copies
+    cv::cuda::HostMem mHostFeatures1, mHostFeatures2;
+    cv::cuda::GpuMat mDeviceFeatures1, mDeviceFeatures2;
+
+    // nearest neighbors in the internal format of the matcher
+    cv::cuda::GpuMat mDeviceKnnMatches, mDeviceBackMatches;
+    cv::cuda::HostMem mHostKnnMatches, mHostBackMatches;
+
+    std::vector<std::vector<cv::DMatch> > mKnnMatches;
+    std::vector<cv::DMatch> mBackMatches;
+    std::vector<int> mNearestQuery;
+
+    // copying and assignment are disallowed
+    FeatureMatcherCuda(const FeatureMatcherCuda &);
+    FeatureMatcherCuda &operator=(const FeatureMatcherCuda &);
+};
+
+#endif // FEATURE_MATCHER_HAVE_CUDA
+
+} // namespace matchFeatures
+
+#endif
@@ -0,0 +1,187 @@
+//////////////////////////////////////////////////////////////////////////////
+// Gaussian mixture foreground detector on a CUDA device.
+//
+// cv::cuda::BackgroundSubtractorMOG implements the same Stauffer-Grimson
+// model as the CPU foregroundDetector: numGaussians modes per pixel, ranked
+// by weight over standard deviation, with the first modes whose weights add
+// up to minBGRatio forming the background. A new mode starts with the
+// initial variance, and the learning rate of each step updates the weights,
+// means and variances. OpenCV fixes the initial weight to 0.05 and the match
+// threshold to 2.5 standard deviations, the foregroundDetector defaults, and
+// keeps the variances above a quarter of the initial variance.
+//
+// The mixtures stay on the device across steps. Frames and masks are staged
+// in page-locked host memory, and the layout conversions of column major
+// images run on the device, so a step is one upload, a few kernels and one
+// download queued on the detector's stream.
+//
+// Copyright 2016 The MathWorks, Inc.
+//
+//////////////////////////////////////////////////////////////////////////////
+#ifndef FOREGROUND_DETECTOR_CUDA_OCV
+#define FOREGROUND_DETECTOR_CUDA_OCV
+
+#include <cmath>
+#include <cstring>
+#include <vector>
+
+#include "foregroundDetectorCudaCore_api.hpp"
+#include "cgProfile.hpp"
+
+#include "opencv2/opencv_modules.hpp"
+#include "opencv2/core.hpp"
+
+#if defined(HAVE_OPENCV_CUDABGSEGM) && defined(HAVE_OPENCV_CUDAARITHM)
+#include "opencv2/core/cuda.hpp"
+#include "CudaDevice.hpp"
+#include "opencv2/cudaarithm.hpp"
+#include "opencv2/cudabgsegm.hpp"
+#define FOREGROUND_DETECTOR_HAVE_CUDA
+#endif
+
+namespace foregroundDetector
+{
+
+// Returns true if device is a CUDA device the detector can run on
+inline bool isCudaDevice(int device)
+{
+#if defined(FOREGROUND_DETECTOR_HAVE_CUDA)
+    return vision::isCudaDevice(device);
+#else
+    (void)device;
+    return false;
+#endif
+}
+
+#if defined(FOREGROUND_DETECTOR_HAVE_CUDA)
+
+class ForegroundDetectorCudaOcv
+{
+public:
+    // The stream and the buffers belong to the given device
+    explicit ForegroundDetectorCudaOcv(int device)
+        : mDevice(vision::selectCudaDevice(device)), mRows(0), mCols(0), mChannels(0) {}
+
+    // Sets the image size and creates an empty model. nRows and nCols are
+    // the size of the image as seen by MATLAB.
+    void initialize(int nRows, int nCols, int nChannels,
+                    const cvstFGDCudaStruct_T *params)
+    {
+        cv::cuda::setDevice(mDevice);
+
+        mRows = nRows;
+        mCols = nCols;
+        mChannels = nChannels;
+        mParams = *params;
+        reset();
+
+        // the mask buffer is sized by its first download
+        mHostFrame.create(mRows * mChannels, mCols, CV_8UC1);
+    }
+
+    // discards the mixtures; the next step starts a new model
+    void reset()
+    {
+        cv::cuda::setDevice(mDevice);
+
+        // OpenCV sets the initial variance to (2*noiseSigma)^2
+        mMog = cv::cuda::createBackgroundSubtractorMOG(200,
+            mParams.numGaussians, mParams.minBGRatio,
+            std::sqrt(mParams.initialVariance) / 2);
+    }
+
+    void step(const uint8_T *image, boolean_T *mask, float learningRate,
+              bool isRowMajor)
+    {
+        cv::cuda::setDevice(mDevice);
+
+        const size_t numPixels = (size_t)mRows * mCols;
+        cv::Mat staged = mHostFrame.createMatHeader();
+        std::memcpy(staged.data, image, numPixels * mChannels);
+        CG_PROFILE_PHASE(CG_PROFILE_COMPUTE);
+
+        if (isRowMajor)
+        {
+            // interleaved channels, as OpenCV expects
+            mDeviceFrame.upload(staged.reshape(mChannels, mRows), mStream);
+        }
+        else
+        {
+            // each channel is a column major plane, which reads as its
+            // transpose: transpose the planes on the device, then
+            // interleave them
+            mDeviceStaged.upload(staged.reshape(1, mChannels * mCols), mStream);
+            mDevicePlanes.resize(mChannels);
+            for (int c = 0; c < mChannels; ++c)
+            {
+                cv::cuda::transpose(mDeviceStaged.rowRange(c * mCols, (c + 1) * mCols),
+                                    mDevicePlanes[c], mStream);
+            }
+            if (mChannels == 1)
+            {
+                mDeviceFrame = mDevicePlanes[0];
+            }
+            else
+            {
+                cv::cuda::merge(mDevicePlanes, mDeviceFrame, mStream);
+            }
+        }
+
+        mMog->apply(mDeviceFrame, mDeviceMask, learningRate, mStream);
+
+        // 255 becomes 1 for boolean_T, and column major masks are
+        // transposed back
+        if (isRowMajor)
+        {
+            mDeviceMask.convertTo(mDeviceMaskOut, CV_8UC1, 1.0 / 255, mStream);
+        }
+        else
+        {
+            mDeviceMask.convertTo(mDeviceMaskScaled, CV_8UC1, 1.0 / 255, mStream);
+            cv::cuda::transpose(mDeviceMaskScaled, mDeviceMaskOut, mStream);
+        }
+        mDeviceMaskOut.download(mHostMask, mStream);
+        mStream.waitForCompletion();
+        CG_PROFILE_PHASE(CG_PROFILE_OUTPUT);
+
+        cv::Mat hostMask = mHostMask.createMatHeader();
+        std::memcpy(mask, hostMask.data, numPixels);
+    }
+
+private:
+    // device index, selected before the stream is created
+    int mDevice;
+    cv::cuda::Stream mStream;
+
+    cv::Ptr<cv::cuda::BackgroundSubtractorMOG> mMog;
+    cvstFGDCudaStruct_T mParams;
+
+    // image size as seen by MATLAB
+    int mRows;
+    int mCols;
+    int mChannels;
+
+    // page-locked frame and mask
+    cv::cuda::HostMem mHostFrame;
+    cv::cuda::HostMem mHostMask;
+
+    // uploaded column major planes, transposed planes and input frame
+    cv::cuda::GpuMat mDeviceStaged;
+    std::vector<cv::cuda::GpuMat> mDevicePlanes;
+    cv::cuda::GpuMat mDeviceFrame;
+
+    // mask from OpenCV, scaled to 0 and 1, and in the output layout
+    cv::cuda::GpuMat mDeviceMask;
+    cv::cuda::GpuMat mDeviceMaskScaled;
+    cv::cuda::GpuMat mDeviceMaskOut;
+
+    // copying and assignment are disallowed
+    ForegroundDetectorCudaOcv(const ForegroundDetectorCudaOcv &);
+    ForegroundDetectorCudaOcv &operator=(const ForegroundDetectorCudaOcv &);
+};
+
+#endif // FOREGROUND_DETECTOR_HAVE_CUDA
+
+} // namespace foregroundDetector
+
+#endif
@@ -19,10 +19,87 @@ EXTERN_C LIBMWCVSTRT_API void HOGDescriptor_detectMultiScaleRM(void *ptrClass, v
 	boolean_T useMeanShiftMerging,
 	int32_T *numDetectedObj, int32_T *numDetectionScores);
 
+// detection restricted to numROIs [x y width height] regions, each with
+// its own [height width] object size range
+EXTERN_C LIBMWCVSTRT_API void HOGDescriptor_detectMultiScaleROI(void *ptrClass, void **ptr2ptrDetectedObj, void **ptr2ptrDetectionScores,
+	uint8_T *inImg, int32_T nRows, int32_T nCols, boolean_T isRGB,
+	double scaleFactor, double svmThreshold, double mergeThreshold,
+	int32_T *ptrROIs, int32_T numROIs, int32_T *ptrMinSizes, int32_T *ptrMaxSizes,
+	int32_T *ptrWinStride, boolean_T useMeanShiftMerging,
+	int32_T *numDetectedObj, int32_T *numDetectionScores);
+
+EXTERN_C LIBMWCVSTRT_API void HOGDescriptor_detectMultiScaleROIRM(void *ptrClass, void **ptr2ptrDetectedObj, void **ptr2ptrDetectionScores,
+	uint8_T *inImg, int32_T nRows, int32_T nCols, boolean_T isRGB,
+	double scaleFactor, double svmThreshold, double mergeThreshold,
+	int32_T *ptrROIs, int32_T numROIs, int32_T *ptrMinSizes, int32_T *ptrMaxSizes,
+	int32_T *ptrWinStride, boolean_T useMeanShiftMerging,
+	int32_T *numDetectedObj, int32_T *numDetectionScores);
+
+// dense mode: the SVM score of every window, scale after scale. mapSizes
+// holds [rows cols] of each of the HOGDescriptor_getNumScoreMaps maps; the
+// window (r,c) of the map of scale s has its top left corner at
+// ((c*winStride(1) - 16)*s, (r*winStride(2) - 16)*s) in the input image
+EXTERN_C LIBMWCVSTRT_API int32_T HOGDescriptor_getNumScoreMaps(void *ptrClass, int32_T nRows, int32_T nCols,
+	double scaleFactor, int32_T *ptrMinSize, int32_T *ptrMaxSize);
+
+EXTERN_C LIBMWCVSTRT_API void HOGDescriptor_getScoreMapSizes(void *ptrClass, int32_T nRows, int32_T nCols,
+	double scaleFactor, int32_T *ptrMinSize, int32_T *ptrMaxSize, int32_T *ptrWinStride,
+	int32_T *mapSizes, double *scales);
+
+EXTERN_C LIBMWCVSTRT_API void HOGDescriptor_computeScoreMaps(void *ptrClass,
+	uint8_T *inImg, int32_T nRows, int32_T nCols, boolean_T isRGB,
+	double scaleFactor, int32_T *ptrMinSize, int32_T *ptrMaxSize, int32_T *ptrWinStride,
+	double *outScores);
+
+EXTERN_C LIBMWCVSTRT_API void HOGDescriptor_computeScoreMapsRM(void *ptrClass,
+	uint8_T *inImg, int32_T nRows, int32_T nCols, boolean_T isRGB,
+	double scaleFactor, int32_T *ptrMinSize, int32_T *ptrMaxSize, int32_T *ptrWinStride,
+	double *outScores);
+
 EXTERN_C LIBMWCVSTRT_API void HOGDescriptor_setup(void *ptrClass, int whichModel);
+/* memory cap of detectMultiScale, 0 for none: above it the scale levels
+ * free their buffers once scanned and fewer levels are scanned at once */
+EXTERN_C LIBMWCVSTRT_API void HOGDescriptor_setMemoryBudget(void *ptrClass, double budgetMB);
+/* bytes used by detectMultiScale of the set up descriptor on nRows-by-nCols
+ * images: at the peak of a call and kept between calls. The descriptor
+ * itself holds no image buffers before its first detection. */
+EXTERN_C LIBMWCVSTRT_API void HOGDescriptor_estimateMemory(void *ptrClass, int32_T nRows, int32_T nCols,
+	boolean_T isRGB, double scaleFactor, int32_T *ptrMinSize, int32_T *ptrMaxSize,
+	int32_T *ptrWinStride, double *peakBytes, double *steadyBytes);
 EXTERN_C LIBMWCVSTRT_API void HOGDescriptor_construct(void **ptr2ptrClass);
 EXTERN_C LIBMWCVSTRT_API void HOGDescriptor_assignOutputDeleteVectors(void *ptrDetectedObj, void *ptrDetectionScores, int32_T *outBBox, double *outScore);
 EXTERN_C LIBMWCVSTRT_API void HOGDescriptor_assignOutputDeleteVectorsRM(void *ptrDetectedObj, void *ptrDetectionScores, int32_T *outBBox, double *outScore);
 EXTERN_C LIBMWCVSTRT_API void HOGDescriptor_deleteObj(void *ptrClass);
 
+/* HOG people detection on a CUDA device. device is the index of the CUDA
+ * device. construct sets *ptr2ptrClass to NULL when the device is not
+ * available or OpenCV was built without CUDA object detection; the caller
+ * then uses the CPU descriptor. The outputs of detectMultiScale are those
+ * of HOGDescriptor_detectMultiScale and are freed by
+ * HOGDescriptor_assignOutputDeleteVectors. */
+EXTERN_C LIBMWCVSTRT_API void HOGDescriptorCuda_construct(void **ptr2ptrClass, int32_T device);
+EXTERN_C LIBMWCVSTRT_API void HOGDescriptorCuda_setup(void *ptrClass, int whichModel);
+EXTERN_C LIBMWCVSTRT_API void HOGDescriptorCuda_detectMultiScale(void *ptrClass, void **ptr2ptrDetectedObj, void **ptr2ptrDetectionScores,
+	uint8_T *inImg, int32_T nRows, int32_T nCols, boolean_T isRGB,
+	double scaleFactor, double svmThreshold, double mergeThreshold,
+	int32_T *ptrMinSize, int32_T *ptrMaxSize, int32_T *ptrWinStride,
+	boolean_T useMeanShiftMerging,
+	int32_T *numDetectedObj, int32_T *numDetectionScores);
+EXTERN_C LIBMWCVSTRT_API void HOGDescriptorCuda_detectMultiScaleRM(void *ptrClass, void **ptr2ptrDetectedObj, void **ptr2ptrDetectionScores,
+	uint8_T *inImg, int32_T nRows, int32_T nCols, boolean_T isRGB,
+	double scaleFactor, double svmThreshold, double mergeThreshold,
+	int32_T *ptrMinSize, int32_T *ptrMaxSize, int32_T *ptrWinStride,
+	boolean_T useMeanShiftMerging,
+	int32_T *numDetectedObj, int32_T *numDetectionScores);
+/* detectMultiScaleImage reads the image from an image handle (see
+ * imageHandleCore_api.hpp), on the device when a grayscale image is on the
+ * device of the detector. */
+EXTERN_C LIBMWCVSTRT_API void HOGDescriptorCuda_detectMultiScaleImage(void *ptrClass, void **ptr2ptrDetectedObj, void **ptr2ptrDetectionScores,
+	void *ptrImage,
+	double scaleFactor, double svmThreshold, double mergeThreshold,
+	int32_T *ptrMinSize, int32_T *ptrMaxSize, int32_T *ptrWinStride,
+	boolean_T useMeanShiftMerging,
+	int32_T *numDetectedObj, int32_T *numDetectionScores);
+EXTERN_C LIBMWCVSTRT_API void HOGDescriptorCuda_deleteObj(void *ptrClass);
+
 #endif
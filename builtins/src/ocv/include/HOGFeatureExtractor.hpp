@@ -0,0 +1,408 @@
+//////////////////////////////////////////////////////////////////////////////
+// HOG features of batches of same sized images, as extractHOGFeatures
+// computes them for a whole image.
+//
+// The gradients are central differences, forward differences on the image
+// border, and the direction is that of atan2d(-gy, gx). Each pixel of a
+// block votes with its magnitude, weighted by a Gaussian of sigma half the
+// block height, for the two nearest orientation bins of the four nearest
+// cells. The blocks are normalized with L2-Hys.
+//
+// As MWHOGCache does for a detection window, the cells, weights and
+// histogram offsets of the pixels of a block and the offsets of the blocks
+// are tabulated once for the image size, and every image of the batch only
+// computes its gradients. The tables are not those of MWHOGCache, which
+// follows OpenCV: its Gaussian is centered half a pixel off, its borders are
+// reflected, its orientations are mirrored and its normalization has a
+// larger epsilon, so its features differ from those of extractHOGFeatures.
+// The arithmetic here is that of the MATLAB implementation, in single
+// precision and in the same order.
+//
+// The images are processed in parallel, each by one thread, so the features
+// do not depend on the number of threads.
+//
+// Copyright 2016 The MathWorks, Inc.
+//
+//////////////////////////////////////////////////////////////////////////////
+#ifndef HOG_FEATURE_EXTRACTOR
+#define HOG_FEATURE_EXTRACTOR
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <vector>
+
+#include "vision_defines.h"
+#include "cgThreadPool.hpp"
+
+namespace hogfeatures
+{
+
+// extractHOGFeatures parameters; the sizes are [rows cols], in pixels for
+// cellSize and in cells for blockSize and blockOverlap
+struct HOGParams
+{
+    int cellSize[2];
+    int blockSize[2];
+    int blockOverlap[2];
+    int numBins;
+    bool useSignedOrientation;
+};
+
+class HOGFeatureExtractor
+{
+public:
+    HOGFeatureExtractor(int nRows, int nCols, const HOGParams &params)
+        : mNumRows(nRows), mNumCols(nCols), mParams(params)
+    {
+        init();
+    }
+
+    // vision.internal.hog.getFeatureSize
+    int getFeatureSize() const
+    {
+        return (int)mBlockData.size() * mBlockHistogramSize;
+    }
+
+    // Features of the nRows-by-nCols-by-nChannels-by-numImages images,
+    // column major unless isRowMajor, into the numImages-by-featureSize
+    // outFeatures of the same layout. nChannels is 1 or 3.
+    template <typename T>
+    void compute(const T *images, int nChannels, int numImages, bool isRowMajor,
+                 real32_T *outFeatures) const
+    {
+        const int featureSize = getFeatureSize();
+        if (numImages <= 0 || featureSize == 0)
+            return;
+
+        // strides of rows, columns, channels and images
+        size_t strides[4];
+        if (isRowMajor)
+        {
+            strides[3] = 1;
+            strides[2] = (size_t)numImages;
+            strides[1] = strides[2] * nChannels;
+            strides[0] = strides[1] * mNumCols;
+        }
+        else
+        {
+            strides[0] = 1;
+            strides[1] = (size_t)mNumRows;
+            strides[2] = strides[1] * mNumCols;
+            strides[3] = strides[2] * nChannels;
+        }
+
+        std::vector<Workspace> workspaces(std::max((int)cgGetNumThreads(), 1));
+#ifdef PARALLEL
+        cgParallelForWorkers(numImages, [&](int worker, int n) {
+            computeImage(images, nChannels, numImages, isRowMajor, strides, n,
+                         workspaces[worker], outFeatures);
+        });
+#else
+        for (int n = 0; n < numImages; n++)
+            computeImage(images, nChannels, numImages, isRowMajor, strides, n,
+                         workspaces[0], outFeatures);
+#endif
+    }
+
+private:
+    // a pixel of a block: its offset in the gradients from the top left
+    // pixel of the block, its Gaussian weight and, for its four nearest
+    // cells, the offset of their histogram and their spatial weight
+    struct PixData
+    {
+        size_t gradOfs;
+        int histOfs[4];
+        real32_T histWeights[4];
+        real32_T gradWeight;
+    };
+
+    // a block: the offsets of its top left pixel in the gradients and of
+    // its histogram in the features
+    struct BlockData
+    {
+        size_t gradOfs;
+        int histOfs;
+    };
+
+    struct Workspace
+    {
+        std::vector<real32_T> magnitude, weight;
+        std::vector<int> bin;
+        std::vector<real32_T> histogram, features;
+
+        void resize(const HOGFeatureExtractor &extractor, int featureSize)
+        {
+            const size_t numPixels = (size_t)extractor.mNumRows * extractor.mNumCols;
+            magnitude.resize(numPixels);
+            weight.resize(numPixels);
+            bin.resize(numPixels);
+            histogram.resize(extractor.mPaddedHistogramSize);
+            features.resize(featureSize);
+        }
+    };
+
+    // lower bin center x1 of x, and the bin, 1-based with a bin before the
+    // first: computeLowerHistBin of extractHOGFeatures
+    static int lowerHistBin(real32_T x, real32_T width, real32_T &x1)
+    {
+        const real32_T invWidth = 1.0f / width;
+        const real32_T bin = std::floor(x * invWidth - 0.5f);
+        x1 = width * (bin + 0.5f);
+        return (int)bin + 1;
+    }
+
+    void init()
+    {
+        const int *cellSize = mParams.cellSize;
+        const int *blockSize = mParams.blockSize;
+        const int numBins = mParams.numBins;
+
+        // vision.internal.hog.getNumBlocksPerWindow
+        int numBlocks[2];
+        for (int d = 0; d < 2; d++)
+        {
+            const int numCells = (d == 0 ? mNumRows : mNumCols) / cellSize[d];
+            numBlocks[d] = (int)std::floor((real32_T)(numCells - blockSize[d]) /
+                                           (real32_T)(blockSize[d] - mParams.blockOverlap[d])) + 1;
+            if (numBlocks[d] < 0)
+                numBlocks[d] = 0;
+        }
+
+        const int blockHeight = cellSize[0] * blockSize[0];
+        const int blockWidth = cellSize[1] * blockSize[1];
+        mBlockHistogramSize = numBins * blockSize[0] * blockSize[1];
+
+        // block histogram with a bin before and after the orientations and
+        // a cell around the cells, orientations fastest and then rows
+        mPaddedRowStride = numBins + 2;
+        mPaddedColStride = mPaddedRowStride * (blockSize[0] + 2);
+        mPaddedHistogramSize = mPaddedColStride * (blockSize[1] + 2);
+
+        // Gaussian weights, fspecial('gaussian', blockSizeInPixels, sigma)
+        const double sigma = 0.5 * blockHeight;
+        std::vector<double> gaussian((size_t)blockHeight * blockWidth);
+        double maxGaussian = 0;
+        for (int x = 0; x < blockWidth; x++)
+        {
+            for (int y = 0; y < blockHeight; y++)
+            {
+                const double dx = x - (blockWidth - 1) / 2.0;
+                const double dy = y - (blockHeight - 1) / 2.0;
+                const double g = std::exp(-(dx * dx + dy * dy) / (2 * sigma * sigma));
+                gaussian[y + (size_t)x * blockHeight] = g;
+                maxGaussian = std::max(maxGaussian, g);
+            }
+        }
+        double sumGaussian = 0;
+        for (size_t k = 0; k < gaussian.size(); k++)
+        {
+            if (gaussian[k] < DBL_EPSILON * maxGaussian)
+                gaussian[k] = 0;
+            sumGaussian += gaussian[k];
+        }
+
+        // spatial weights of the lower cells along each dimension, from
+        // the pixel centers
+        std::vector<int> cellY(blockHeight), cellX(blockWidth);
+        std::vector<real32_T> wy1(blockHeight), wx1(blockWidth);
+        for (int y = 0; y < blockHeight; y++)
+        {
+            const real32_T p = (real32_T)y + 0.5f, width = (real32_T)cellSize[0];
+            real32_T y1;
+            cellY[y] = lowerHistBin(p, width, y1);
+            wy1[y] = 1.0f - (p - y1) / width;
+        }
+        for (int x = 0; x < blockWidth; x++)
+        {
+            const real32_T p = (real32_T)x + 0.5f, width = (real32_T)cellSize[1];
+            real32_T x1;
+            cellX[x] = lowerHistBin(p, width, x1);
+            wx1[x] = 1.0f - (p - x1) / width;
+        }
+
+        // the pixels in the order extractHOGFeatures accumulates them,
+        // columns outer, and their cells (x1,y1), (x1,y2), (x2,y1), (x2,y2)
+        mPixData.resize((size_t)blockHeight * blockWidth);
+        for (int x = 0; x < blockWidth; x++)
+        {
+            for (int y = 0; y < blockHeight; y++)
+            {
+                PixData &data = mPixData[y + (size_t)x * blockHeight];
+                data.gradOfs = y + (size_t)x * mNumRows;
+                data.gradWeight = (real32_T)(sumGaussian != 0 ?
+                    gaussian[y + (size_t)x * blockHeight] / sumGaussian :
+                    gaussian[y + (size_t)x * blockHeight]);
+
+                const int ofs = cellY[y] * mPaddedRowStride + cellX[x] * mPaddedColStride;
+                data.histOfs[0] = ofs;
+                data.histOfs[1] = ofs + mPaddedRowStride;
+                data.histOfs[2] = ofs + mPaddedColStride;
+                data.histOfs[3] = ofs + mPaddedRowStride + mPaddedColStride;
+                data.histWeights[0] = wy1[y] * wx1[x];
+                data.histWeights[1] = (1.0f - wy1[y]) * wx1[x];
+                data.histWeights[2] = wy1[y] * (1.0f - wx1[x]);
+                data.histWeights[3] = (1.0f - wy1[y]) * (1.0f - wx1[x]);
+            }
+        }
+
+        // blocks, rows fastest
+        const int stepY = cellSize[0] * (blockSize[0] - mParams.blockOverlap[0]);
+        const int stepX = cellSize[1] * (blockSize[1] - mParams.blockOverlap[1]);
+        mBlockData.resize((size_t)numBlocks[0] * numBlocks[1]);
+        for (int j = 0; j < numBlocks[1]; j++)
+        {
+            for (int i = 0; i < numBlocks[0]; i++)
+            {
+                BlockData &data = mBlockData[i + (size_t)j * numBlocks[0]];
+                data.gradOfs = (size_t)i * stepY + (size_t)j * stepX * mNumRows;
+                data.histOfs = (i + j * numBlocks[0]) * mBlockHistogramSize;
+            }
+        }
+    }
+
+    // features of image n of compute, in the workspace ws
+    template <typename T>
+    void computeImage(const T *images, int nChannels, int numImages, bool isRowMajor,
+                      const size_t strides[4], int n, Workspace &ws,
+                      real32_T *outFeatures) const
+    {
+        const int featureSize = getFeatureSize();
+        ws.resize(*this, isRowMajor ? 0 : featureSize);
+        computeGradient(images + n * strides[3], nChannels, strides, ws);
+
+        real32_T *features = isRowMajor ?
+            outFeatures + (size_t)n * featureSize : &ws.features[0];
+        for (size_t b = 0; b < mBlockData.size(); b++)
+            computeBlock(mBlockData[b], ws, features);
+
+        if (!isRowMajor)
+        {
+            for (int k = 0; k < featureSize; k++)
+                outFeatures[n + (size_t)k * numImages] = features[k];
+        }
+    }
+
+    // Magnitude, lower orientation bin (0-based with the bin before the
+    // first) and its weight of each pixel, column major. For color images,
+    // those of the channel of largest magnitude.
+    template <typename T>
+    void computeGradient(const T *image, int nChannels, const size_t *strides,
+                         Workspace &ws) const
+    {
+        const real32_T histRange = mParams.useSignedOrientation ? 360.0f : 180.0f;
+        const real32_T binWidth = histRange / (real32_T)mParams.numBins;
+        const real32_T radToDeg = (real32_T)(180.0 / 3.14159265358979323846);
+
+        for (int c = 0; c < mNumCols; c++)
+        {
+            const int cl = std::max(c - 1, 0), cr = std::min(c + 1, mNumCols - 1);
+            for (int r = 0; r < mNumRows; r++)
+            {
+                const int ru = std::max(r - 1, 0), rd = std::min(r + 1, mNumRows - 1);
+                real32_T mag = 0, dir = 0;
+                for (int ch = 0; ch < nChannels; ch++)
+                {
+                    const T *p = image + ch * strides[2];
+                    const real32_T gx = (real32_T)p[r * strides[0] + cr * strides[1]] -
+                                        (real32_T)p[r * strides[0] + cl * strides[1]];
+                    const real32_T gy = (real32_T)p[rd * strides[0] + c * strides[1]] -
+                                        (real32_T)p[ru * strides[0] + c * strides[1]];
+                    const real32_T m = std::sqrt(gx * gx + gy * gy);
+                    // first channel of largest magnitude
+                    if (ch == 0 || m > mag)
+                    {
+                        mag = m;
+                        dir = radToDeg * std::atan2(-gy, gx);
+                    }
+                }
+
+                if (dir < 0)
+                    dir = histRange + dir;
+                real32_T x1;
+                const size_t k = r + (size_t)c * mNumRows;
+                ws.bin[k] = lowerHistBin(dir, binWidth, x1);
+                ws.weight[k] = 1.0f - (dir - x1) / binWidth;
+                ws.magnitude[k] = mag;
+            }
+        }
+    }
+
+    void computeBlock(const BlockData &block, Workspace &ws, real32_T *features) const
+    {
+        real32_T *h = &ws.histogram[0];
+        std::fill(ws.histogram.begin(), ws.histogram.end(), 0.0f);
+
+        const real32_T *magnitude = &ws.magnitude[block.gradOfs];
+        const real32_T *weight = &ws.weight[block.gradOfs];
+        const int *bin = &ws.bin[block.gradOfs];
+        for (size_t p = 0; p < mPixData.size(); p++)
+        {
+            const PixData &data = mPixData[p];
+            const real32_T m = magnitude[data.gradOfs] * data.gradWeight;
+            const real32_T wz1 = weight[data.gradOfs];
+            const int z = bin[data.gradOfs];
+            for (int k = 0; k < 4; k++)
+            {
+                const real32_T w1 = wz1 * data.histWeights[k];
+                const real32_T w2 = data.histWeights[k] - w1;
+                h[data.histOfs[k] + z] += m * w1;
+                h[data.histOfs[k] + z + 1] += m * w2;
+            }
+        }
+
+        // wrap the orientation bins, and keep the cells of the block
+        const int numBins = mParams.numBins;
+        real32_T *out = features + block.histOfs;
+        int o = 0;
+        for (int cx = 1; cx <= mParams.blockSize[1]; cx++)
+        {
+            for (int cy = 1; cy <= mParams.blockSize[0]; cy++)
+            {
+                real32_T *cell = h + cy * mPaddedRowStride + cx * mPaddedColStride;
+                cell[1] += cell[numBins + 1];
+                cell[numBins] += cell[0];
+                for (int z = 1; z <= numBins; z++)
+                    out[o++] = cell[z];
+            }
+        }
+
+        normalizeL2Hys(out, mBlockHistogramSize);
+    }
+
+    static real32_T norm(const real32_T *x, int n)
+    {
+        double sum = 0;
+        for (int i = 0; i < n; i++)
+            sum += (double)x[i] * x[i];
+        return (real32_T)std::sqrt(sum);
+    }
+
+    static void normalizeL2Hys(real32_T *x, int n)
+    {
+        real32_T scale = norm(x, n) + FLT_EPSILON;
+        for (int i = 0; i < n; i++)
+        {
+            x[i] = x[i] / scale;
+            if (x[i] > 0.2f)
+                x[i] = 0.2f;
+        }
+        scale = norm(x, n) + FLT_EPSILON;
+        for (int i = 0; i < n; i++)
+            x[i] = x[i] / scale;
+    }
+
+    int mNumRows, mNumCols;
+    HOGParams mParams;
+    int mBlockHistogramSize;
+    int mPaddedRowStride, mPaddedColStride, mPaddedHistogramSize;
+    std::vector<PixData> mPixData;
+    std::vector<BlockData> mBlockData;
+
+    HOGFeatureExtractor(const HOGFeatureExtractor &);
+    HOGFeatureExtractor &operator=(const HOGFeatureExtractor &);
+};
+
+} // namespace hogfeatures
+
+#endif
@@ -0,0 +1,495 @@
+//////////////////////////////////////////////////////////////////////////////
+// Harris and minimum eigenvalue corners of detectHarrisFeatures and
+// detectMinEigenFeatures.
+//
+// The corner metric is that of harrisMinEigen: central difference
+// gradients of the interior pixels, replicated to the border, and their
+// products Ix^2, Iy^2 and IxIy smoothed by the separable Gaussian of
+// fspecial('gaussian', filterSize, filterSize/3) with replicated borders.
+// It is computed in strips of rows in parallel: each strip computes the
+// gradient products of its rows and of the rows of its filter halo, filters
+// them horizontally into a ring of filterSize rows, then filters them
+// vertically and computes the metric, in one pass over the image with the
+// 128-bit universal intrinsics of OpenCV.
+//
+// The corners are the pixels, off the border, of metric at least
+// minQuality times the largest metric that are maxima of their 3x3
+// neighborhood, the first in raster order on a plateau, in place of the
+// regional maxima shrunk to points of vision.internal.findPeaks. They are
+// refined to sub-pixel locations by fitting a quadratic to their
+// neighborhood, and their metric is interpolated there, as harrisMinEigen
+// does.
+//
+// The metric is symmetric in x and y, so an image in column major is
+// processed as its row major transpose, without a copy. The corners are
+// returned by column, then row, as find returns them.
+//
+// Copyright 2016 The MathWorks, Inc.
+//
+//////////////////////////////////////////////////////////////////////////////
+#ifndef HARRIS_MIN_EIGEN
+#define HARRIS_MIN_EIGEN
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <vector>
+
+#include "vision_defines.h"
+#include "cgThreadPool.hpp"
+#include "opencv2/core/hal/intrin.hpp"
+
+// rows of the metric per strip
+#define CORNER_STRIP_ROWS 32
+
+namespace cornerdetector
+{
+
+enum CornerMethod
+{
+    CORNER_HARRIS = 0,
+    CORNER_MIN_EIGEN = 1
+};
+
+// Corner as harrisMinEigen returns it: 1-based [x y] location and metric
+struct Corner
+{
+    real32_T x;
+    real32_T y;
+    real32_T metric;
+};
+
+// by column and then row
+typedef std::vector<Corner> Corners;
+
+class HarrisMinEigen
+{
+public:
+    // image is nRows-by-nCols single, column major unless isRowMajor.
+    // filterSize is odd, at least 3 and at most the image size.
+    static void detect(const real32_T *image, int nRows, int nCols, bool isRowMajor,
+                       int method, int filterSize, real32_T minQuality, Corners &corners)
+    {
+        // the rows of the processing layout are the columns of a column
+        // major image
+        HarrisMinEigen detector(image, isRowMajor ? nRows : nCols,
+                                isRowMajor ? nCols : nRows, method, filterSize);
+        const real32_T maxMetric = detector.computeMetric();
+        detector.findCorners(maxMetric, minQuality, isRowMajor, corners);
+    }
+
+private:
+    HarrisMinEigen(const real32_T *image, int numRows, int numCols, int method,
+                   int filterSize)
+        : mImage(image), mNumRows(numRows), mNumCols(numCols), mMethod(method),
+          mHalf(filterSize / 2), mMetric((size_t)numRows * numCols)
+    {
+        // the normalized 1-D Gaussian whose outer product is that of
+        // fspecial
+        const double sigma = filterSize / 3.0;
+        std::vector<double> g(filterSize);
+        double sum = 0;
+        for (int d = -mHalf; d <= mHalf; d++)
+        {
+            g[d + mHalf] = std::exp(-(double)(d * d) / (2 * sigma * sigma));
+            sum += g[d + mHalf];
+        }
+        mFilter.resize(filterSize);
+        for (int d = 0; d < filterSize; d++)
+            mFilter[d] = (real32_T)(g[d] / sum);
+    }
+
+    int numStrips() const
+    {
+        return (mNumRows + CORNER_STRIP_ROWS - 1) / CORNER_STRIP_ROWS;
+    }
+
+    static int clamp(int i, int lo, int hi)
+    {
+        return std::min(std::max(i, lo), hi);
+    }
+
+    // Sum of the Gaussian weights of the size values p[0], p[step], ...,
+    // the filter being symmetric
+    real32_T filterScalar(const real32_T *p, size_t step) const
+    {
+        const int half = mHalf;
+        const real32_T *g = &mFilter[0];
+        real32_T s = g[half] * p[half * step];
+        for (int d = 0; d < half; d++)
+            s += g[d] * (p[d * step] + p[(2 * half - d) * step]);
+        return s;
+    }
+
+#if CV_SIMD128
+    cv::v_float32x4 filterVector(const real32_T *p, size_t step) const
+    {
+        const int half = mHalf;
+        const real32_T *g = &mFilter[0];
+        cv::v_float32x4 s = cv::v_setall_f32(g[half]) * cv::v_load(p + half * step);
+        for (int d = 0; d < half; d++)
+            s += cv::v_setall_f32(g[d]) *
+                 (cv::v_load(p + d * step) + cv::v_load(p + (2 * half - d) * step));
+        return s;
+    }
+#endif
+
+    // Ix^2, Iy^2 and IxIy of row r of the image, gradients of the interior
+    // replicated to the border, filtered horizontally into a, b and c.
+    // padded holds 3 rows of numCols + 2*half.
+    void filterRow(int r, real32_T *padded, real32_T *a, real32_T *b, real32_T *c) const
+    {
+        const int n = mNumCols, half = mHalf;
+        const int width = n + 2 * half;
+        const size_t gr = (size_t)clamp(r, 1, mNumRows - 2);
+        const real32_T *row = mImage + gr * n;
+        const real32_T *up = row - n;
+        const real32_T *down = row + n;
+
+        real32_T *pa = padded + half, *pb = pa + width, *pc = pb + width;
+        int x = 1;
+#if CV_SIMD128
+        for (; x + 4 < n; x += 4)
+        {
+            const cv::v_float32x4 ix = cv::v_load(row + x + 1) - cv::v_load(row + x - 1);
+            const cv::v_float32x4 iy = cv::v_load(down + x) - cv::v_load(up + x);
+            cv::v_store(pa + x, ix * ix);
+            cv::v_store(pb + x, iy * iy);
+            cv::v_store(pc + x, ix * iy);
+        }
+#endif
+        for (; x < n - 1; x++)
+        {
+            const real32_T ix = row[x + 1] - row[x - 1];
+            const real32_T iy = down[x] - up[x];
+            pa[x] = ix * ix;
+            pb[x] = iy * iy;
+            pc[x] = ix * iy;
+        }
+        for (x = -half; x < 1; x++)
+        {
+            pa[x] = pa[1];
+            pb[x] = pb[1];
+            pc[x] = pc[1];
+        }
+        for (x = n - 1; x < n + half; x++)
+        {
+            pa[x] = pa[n - 2];
+            pb[x] = pb[n - 2];
+            pc[x] = pc[n - 2];
+        }
+
+        pa -= half;
+        pb -= half;
+        pc -= half;
+        x = 0;
+#if CV_SIMD128
+        for (; x + 4 <= n; x += 4)
+        {
+            cv::v_store(a + x, filterVector(pa + x, 1));
+            cv::v_store(b + x, filterVector(pb + x, 1));
+            cv::v_store(c + x, filterVector(pc + x, 1));
+        }
+#endif
+        for (; x < n; x++)
+        {
+            a[x] = filterScalar(pa + x, 1);
+            b[x] = filterScalar(pb + x, 1);
+            c[x] = filterScalar(pc + x, 1);
+        }
+    }
+
+    // Metric of a row from its filtered Ix^2, Iy^2 and IxIy, returns its
+    // maximum
+    real32_T rowMetric(const real32_T *a, const real32_T *b, const real32_T *c,
+                       real32_T *metric) const
+    {
+        const int n = mNumCols;
+        int x = 0;
+        if (mMethod == CORNER_HARRIS)
+        {
+            // k of Harris and Stephens
+            const real32_T k = 0.04f;
+#if CV_SIMD128
+            const cv::v_float32x4 vk = cv::v_setall_f32(k);
+            for (; x + 4 <= n; x += 4)
+            {
+                const cv::v_float32x4 va = cv::v_load(a + x), vb = cv::v_load(b + x),
+                                      vc = cv::v_load(c + x), s = va + vb;
+                cv::v_store(metric + x, va * vb - vc * vc - vk * (s * s));
+            }
+#endif
+            for (; x < n; x++)
+            {
+                const real32_T s = a[x] + b[x];
+                metric[x] = a[x] * b[x] - c[x] * c[x] - k * (s * s);
+            }
+        }
+        else
+        {
+#if CV_SIMD128
+            const cv::v_float32x4 four = cv::v_setall_f32(4.0f), half = cv::v_setall_f32(0.5f);
+            for (; x + 4 <= n; x += 4)
+            {
+                const cv::v_float32x4 va = cv::v_load(a + x), vb = cv::v_load(b + x),
+                                      vc = cv::v_load(c + x), d = va - vb;
+                cv::v_store(metric + x,
+                            ((va + vb) - cv::v_sqrt(d * d + four * (vc * vc))) * half);
+            }
+#endif
+            for (; x < n; x++)
+            {
+                const real32_T d = a[x] - b[x];
+                metric[x] = ((a[x] + b[x]) - std::sqrt(d * d + 4.0f * (c[x] * c[x]))) * 0.5f;
+            }
+        }
+
+        real32_T maxMetric = -FLT_MAX;
+        x = 0;
+#if CV_SIMD128
+        if (n >= 4)
+        {
+            cv::v_float32x4 vmax = cv::v_load(metric);
+            for (x = 4; x + 4 <= n; x += 4)
+                vmax = cv::v_max(vmax, cv::v_load(metric + x));
+            maxMetric = cv::v_reduce_max(vmax);
+        }
+#endif
+        for (; x < n; x++)
+            maxMetric = std::max(maxMetric, metric[x]);
+        return maxMetric;
+    }
+
+    // Fills the rows of strip s of mMetric and returns their maximum,
+    // buffer a work buffer
+    real32_T stripMetric(int s, std::vector<real32_T> &buffer)
+    {
+        const int n = mNumCols, half = mHalf, size = 2 * half + 1;
+        const int r0 = s * CORNER_STRIP_ROWS;
+        const int r1 = std::min(r0 + CORNER_STRIP_ROWS, mNumRows);
+
+        // padded row, the horizontally filtered products of the last
+        // size rows, in a ring, and a row of vertical sums. The ring
+        // holds each plane twice so that the size rows ending at any
+        // position are contiguous.
+        const size_t plane = 2 * (size_t)size * n;
+        buffer.resize(3 * (size_t)(n + 2 * half) + 3 * plane + 3 * (size_t)n);
+        real32_T *padded = &buffer[0];
+        real32_T *ha = padded + 3 * (size_t)(n + 2 * half);
+        real32_T *hb = ha + plane, *hc = hb + plane;
+        real32_T *va = hc + plane, *vb = va + n, *vc = vb + n;
+
+        // buffer row i holds image row r0 - half + i
+        const int numBufferRows = r1 - r0 + 2 * half;
+        real32_T maxMetric = -FLT_MAX;
+        for (int i = 0; i < numBufferRows; i++)
+        {
+            const size_t slot = (size_t)(i % size) * n;
+            filterRow(clamp(r0 - half + i, 0, mNumRows - 1), padded, ha + slot, hb + slot, hc + slot);
+            std::copy(ha + slot, ha + slot + n, ha + slot + (size_t)size * n);
+            std::copy(hb + slot, hb + slot + n, hb + slot + (size_t)size * n);
+            std::copy(hc + slot, hc + slot + n, hc + slot + (size_t)size * n);
+            if (i < 2 * half)
+                continue;
+
+            // the size rows of output row r0 + i - 2*half
+            const size_t first = (size_t)((i + 1) % size) * n;
+            const real32_T *pa = ha + first, *pb = hb + first, *pc = hc + first;
+            int x = 0;
+#if CV_SIMD128
+            for (; x + 4 <= n; x += 4)
+            {
+                cv::v_store(va + x, filterVector(pa + x, n));
+                cv::v_store(vb + x, filterVector(pb + x, n));
+                cv::v_store(vc + x, filterVector(pc + x, n));
+            }
+#endif
+            for (; x < n; x++)
+            {
+                va[x] = filterScalar(pa + x, n);
+                vb[x] = filterScalar(pb + x, n);
+                vc[x] = filterScalar(pc + x, n);
+            }
+            real32_T *metric = &mMetric[(size_t)(r0 + i - 2 * half) * n];
+            maxMetric = std::max(maxMetric, rowMetric(va, vb, vc, metric));
+        }
+        return maxMetric;
+    }
+
+    // Fills mMetric and returns its maximum
+    real32_T computeMetric()
+    {
+        const int numWorkers = std::max((int)cgGetNumThreads(), 1);
+        std::vector<std::vector<real32_T> > buffers(numWorkers);
+        std::vector<real32_T> stripMax(numStrips());
+
+#ifdef PARALLEL
+        cgParallelForWorkers(numStrips(), [&](int worker, int s) {
+            stripMax[s] = stripMetric(s, buffers[worker]);
+        });
+#else
+        for (int s = 0; s < numStrips(); s++)
+            stripMax[s] = stripMetric(s, buffers[0]);
+#endif
+
+        return *std::max_element(stripMax.begin(), stripMax.end());
+    }
+
+    // Orders row major pixel indices of rows of n pixels by column
+    struct ColumnLess
+    {
+        int n;
+        explicit ColumnLess(int numCols) : n(numCols) {}
+        bool operator()(int a, int b) const { return a % n < b % n; }
+    };
+
+    // Whether the pixel at p, off the border, is a maximum of its 3x3
+    // neighborhood and greater than the neighbors before it in raster
+    // order
+    bool isPeak(const real32_T *p) const
+    {
+        const int n = mNumCols;
+        const real32_T v = *p;
+        return v > p[-n - 1] && v > p[-n] && v > p[-n + 1] && v > p[-1] &&
+               v >= p[1] && v >= p[n - 1] && v >= p[n] && v >= p[n + 1];
+    }
+
+    // Peaks of strip s at or above threshold, in raster order
+    void stripPeaks(int s, real32_T threshold, std::vector<int> &peaks) const
+    {
+        const int n = mNumCols;
+        const int r0 = std::max(s * CORNER_STRIP_ROWS, 1);
+        const int r1 = std::min((s + 1) * CORNER_STRIP_ROWS, mNumRows - 1);
+        for (int r = r0; r < r1; r++)
+        {
+            const real32_T *row = &mMetric[(size_t)r * n];
+            int x = 1;
+#if CV_SIMD128
+            // skip the pixels below the threshold or below their left
+            // and right neighbors, 4 at a time
+            const cv::v_float32x4 vt = cv::v_setall_f32(threshold);
+            for (; x + 4 < n; x += 4)
+            {
+                const cv::v_float32x4 v = cv::v_load(row + x);
+                const cv::v_float32x4 candidates = (v >= vt) &
+                    (v > cv::v_load(row + x - 1)) & (v >= cv::v_load(row + x + 1));
+                if (!cv::v_check_any(candidates))
+                    continue;
+                for (int k = x; k < x + 4; k++)
+                {
+                    if (row[k] >= threshold && isPeak(row + k))
+                        peaks.push_back(r * n + k);
+                }
+            }
+#endif
+            for (; x < n - 1; x++)
+            {
+                if (row[x] >= threshold && isPeak(row + x))
+                    peaks.push_back(r * n + x);
+            }
+        }
+    }
+
+    void findCorners(real32_T maxMetric, real32_T minQuality, bool isRowMajor,
+                     Corners &corners) const
+    {
+        corners.clear();
+
+        // eps(0)
+        if (!(maxMetric > 4.9406564584124654e-324))
+            return;
+        const real32_T threshold = minQuality * maxMetric;
+
+        // peaks of each strip, in raster order
+        const int n = mNumCols;
+        std::vector<std::vector<int> > peaks(numStrips());
+#ifdef PARALLEL
+        cgParallelForWorkers(numStrips(), [&](int, int s) {
+            stripPeaks(s, threshold, peaks[s]);
+        });
+#else
+        for (int s = 0; s < numStrips(); s++)
+            stripPeaks(s, threshold, peaks[s]);
+#endif
+
+        std::vector<int> all;
+        for (size_t s = 0; s < peaks.size(); s++)
+            all.insert(all.end(), peaks[s].begin(), peaks[s].end());
+        // by column of the image: the rows of a column major image are
+        // already in that order
+        if (isRowMajor)
+        {
+            std::stable_sort(all.begin(), all.end(), ColumnLess(n));
+        }
+
+        const int numCorners = (int)all.size();
+        corners.resize(numCorners);
+        for (int i = 0; i < numCorners; i++)
+        {
+            const int r = all[i] / n, c = all[i] % n;
+            real32_T dc, dr;
+            subPixelOffset(r, c, dc, dr);
+            const real32_T pc = (real32_T)c + dc, pr = (real32_T)r + dr;
+
+            // 1-based [x y]
+            corners[i].x = (isRowMajor ? pc : pr) + 1;
+            corners[i].y = (isRowMajor ? pr : pc) + 1;
+            corners[i].metric = interpolate(pc, pr);
+        }
+    }
+
+    // Offset of the peak of the quadratic fitted to the 3x3 neighborhood
+    // of (r,c), zero unless below a pixel along both dimensions
+    void subPixelOffset(int r, int c, real32_T &dc, real32_T &dr) const
+    {
+        const int n = mNumCols;
+        const real32_T *p = &mMetric[(size_t)r * n + c];
+        const real32_T p11 = p[-n - 1], p12 = p[-n], p13 = p[-n + 1];
+        const real32_T p21 = p[-1], p22 = p[0], p23 = p[1];
+        const real32_T p31 = p[n - 1], p32 = p[n], p33 = p[n + 1];
+
+        const real32_T dx2 = (p11 - 2 * p12 + p13 + 2 * p21 - 4 * p22 + 2 * p23 +
+                              p31 - 2 * p32 + p33) / 8;
+        const real32_T dy2 = ((p11 + 2 * p12 + p13) - 2 * (p21 + 2 * p22 + p23) +
+                              (p31 + 2 * p32 + p33)) / 8;
+        const real32_T dxy = (p11 - p13 - p31 + p33) / 4;
+        const real32_T dx = (-p11 - 2 * p21 - p31 + p13 + 2 * p23 + p33) / 8;
+        const real32_T dy = (-p11 - 2 * p12 - p13 + p31 + 2 * p32 + p33) / 8;
+
+        const real32_T detinv = 1 / (dx2 * dy2 - 0.25f * dxy * dxy);
+        dc = -0.5f * (dy2 * dx - 0.5f * dxy * dy) * detinv;
+        dr = -0.5f * (dx2 * dy - 0.5f * dxy * dx) * detinv;
+
+        // false for NaN
+        if (!(std::abs(dc) < 1 && std::abs(dr) < 1))
+        {
+            dc = 0;
+            dr = 0;
+        }
+    }
+
+    // Bilinear interpolation of the metric at (pr,pc)
+    real32_T interpolate(real32_T pc, real32_T pr) const
+    {
+        const int n = mNumCols;
+        const real32_T c1 = std::floor(pc), r1 = std::floor(pr);
+        const real32_T c2 = c1 + 1, r2 = r1 + 1;
+        const real32_T *p = &mMetric[(size_t)r1 * n + (size_t)c1];
+        return p[0] * (c2 - pc) * (r2 - pr) + p[1] * (pc - c1) * (r2 - pr) +
+               p[n] * (c2 - pc) * (pr - r1) + p[n + 1] * (pc - c1) * (pr - r1);
+    }
+
+    const real32_T *mImage;
+    int mNumRows, mNumCols;
+    int mMethod;
+    int mHalf;
+    std::vector<real32_T> mFilter;
+    std::vector<real32_T> mMetric;
+
+    HarrisMinEigen(const HarrisMinEigen &);
+    HarrisMinEigen &operator=(const HarrisMinEigen &);
+};
+
+} // namespace cornerdetector
+
+#endif
@@ -9,6 +9,7 @@
 
 #include "opencv/cv.h"
 #include "opencv2/video.hpp"
+#include "cgPyramidCache.hpp"
 
 namespace pointTracker
 {
@@ -71,6 +72,39 @@ class  ImageBuffers
         computePyramid(mIndex2, blockSize, numLevels);
     }
 
+    // Bytes of the frames and pyramids of the tracker for frames of size:
+    // peak, while a pyramid is built, and steady, kept between steps. The
+    // steady bytes include the Gaussian levels the pyramid cache keeps for
+    // the current and the previous frame.
+    static void estimateMemory(const cv::Size &size, const cv::Size &blockSize,
+                               int numLevels, double &peakBytes, double &steadyBytes)
+    {
+        const int bw = blockSize.width, bh = blockSize.height;
+        double pyramidBytes = 0, gaussianBytes = 0;
+        cv::Size levelSize = size;
+        for (int level = 0; level <= numLevels; level++)
+        {
+            const double area = (double)levelSize.area();
+            const double paddedArea = (double)(levelSize.width + 2 * bw) *
+                (levelSize.height + 2 * bh);
+            gaussianBytes += area;
+            // padded level and its CV_16SC2 derivatives
+            pyramidBytes += paddedArea * (1 + 2 * sizeof(short));
+
+            levelSize = cv::Size((levelSize.width + 1) / 2, (levelSize.height + 1) / 2);
+            if (levelSize.width <= bw || levelSize.height <= bh)
+                break;
+        }
+
+        const int numCached = std::min(vision::PyramidCache::getMaxFrames(), 2);
+        steadyBytes = 2 * ((double)size.area() + pyramidBytes) + numCached * gaussianBytes;
+
+        // Scharr derivatives of level 0 before they are merged and padded,
+        // and the Gaussian levels of a frame the cache does not keep
+        peakBytes = steadyBytes + (double)size.area() * 4 * sizeof(short) +
+            (numCached < 2 ? gaussianBytes : 0);
+    }
+
   private:
     // allocates the images and the pyramids
     void allocateImage2()
@@ -80,10 +114,51 @@ class  ImageBuffers
         mImages[mIndex2].create(size, type);
     }
 
+    // Builds the pyramid of cv::buildOpticalFlowPyramid, with the
+    // derivatives, from the Gaussian levels of the shared pyramid of the
+    // frame: each level and its derivatives are the ROI of a buffer padded
+    // by blockSize, and levels not larger than blockSize are left out.
     void computePyramid(int idx, const cv::Size &blockSize, int numLevels)
     {
-        cv::buildOpticalFlowPyramid(mImages[idx], mPyramids[idx], blockSize, 
-	   numLevels, true, cv::BORDER_REFLECT_101, cv::BORDER_CONSTANT, false);
+        if (mImages[idx].type() != CV_8UC1)
+        {
+            cv::buildOpticalFlowPyramid(mImages[idx], mPyramids[idx], blockSize, 
+               numLevels, true, cv::BORDER_REFLECT_101, cv::BORDER_CONSTANT, false);
+            return;
+        }
+
+        vision::FramePyramidPtr frame = vision::PyramidCache::acquire(mImages[idx]);
+        Pyramid &pyramid = mPyramids[idx];
+        pyramid.resize(2 * (numLevels + 1));
+
+        const int bw = blockSize.width, bh = blockSize.height;
+        int level = 0;
+        for (; level <= numLevels; level++)
+        {
+            const cv::Mat &img = frame->getImage(frame->getGaussianLevel(level));
+            cv::Mat &padded = pyramid[2 * level];
+            if (!padded.empty())
+                padded.adjustROI(bh, bh, bw, bw);
+            cv::copyMakeBorder(img, padded, bh, bh, bw, bw, cv::BORDER_REFLECT_101);
+            padded.adjustROI(-bh, -bh, -bw, -bw);
+
+            cv::Mat dx, dy;
+            cv::Scharr(img, dx, CV_16S, 1, 0);
+            cv::Scharr(img, dy, CV_16S, 0, 1);
+            cv::Mat deriv;
+            const cv::Mat channels[] = {dx, dy};
+            cv::merge(channels, 2, deriv);
+            cv::Mat &paddedDeriv = pyramid[2 * level + 1];
+            if (!paddedDeriv.empty())
+                paddedDeriv.adjustROI(bh, bh, bw, bw);
+            cv::copyMakeBorder(deriv, paddedDeriv, bh, bh, bw, bw, cv::BORDER_CONSTANT);
+            paddedDeriv.adjustROI(-bh, -bh, -bw, -bw);
+
+            if ((img.cols + 1) / 2 <= bw || (img.rows + 1) / 2 <= bh)
+                break;
+        }
+        if (level < numLevels)
+            pyramid.resize(2 * (level + 1));
     }
 
     // indices of previous and next image or pyramid
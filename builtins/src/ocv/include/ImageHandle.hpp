@@ -0,0 +1,220 @@
+//////////////////////////////////////////////////////////////////////////////
+// uint8 image shared by the cores of a pipeline.
+//
+// The cores take their frames in one of two forms: the MATLAB buffer
+// wrapped as is, which is the transposed frame for column major code
+// (opticalFlowFarneback), or the frame in OpenCV layout, which the
+// generated code transposes before the call (pointTracker,
+// cascadeClassifier) or the core converts with cArrayToMat
+// (HOGDescriptor). An ImageHandle holds a copy of the MATLAB buffer and
+// makes each form, on the host or on its CUDA device, at most once per
+// frame. Cores that run on the same device read the device copies directly,
+// so a frame fed to several of them is uploaded and converted once instead
+// of once per core.
+//
+// The host copy is page-locked when the handle has a device, so uploads do
+// not go through a staging buffer. The forms are created on first use and
+// stay valid until the next setImage().
+//
+// Copyright 2016 The MathWorks, Inc.
+//
+//////////////////////////////////////////////////////////////////////////////
+#ifndef IMAGE_HANDLE
+#define IMAGE_HANDLE
+
+#include <cstring>
+
+#include "cgCommon.hpp"
+
+#include "opencv2/opencv_modules.hpp"
+#include "opencv2/core.hpp"
+
+#if defined(HAVE_OPENCV_CUDAARITHM)
+#include "opencv2/core/cuda.hpp"
+#include "CudaDevice.hpp"
+#include "opencv2/cudaarithm.hpp"
+#define IMAGE_HANDLE_HAVE_CUDA
+#endif
+
+namespace vision
+{
+
+class ImageHandle
+{
+public:
+    // device is the index of the CUDA device the device forms are created
+    // on, or -1 for a host only image. Without such a device the handle is
+    // host only.
+    explicit ImageHandle(int device = -1)
+        : mDevice(-1), mRows(0), mCols(0), mChannels(0), mIsRowMajor(false),
+          mHasConverted(false), mHasDeviceStored(false), mHasDeviceConverted(false)
+    {
+#if defined(IMAGE_HANDLE_HAVE_CUDA)
+        if (isCudaDevice(device))
+        {
+            mDevice = device;
+        }
+#else
+        (void)device;
+#endif
+    }
+
+    // Copies the nRows-by-nCols-by-nChannels MATLAB image, in column major
+    // order unless isRowMajor is true. nChannels is 1 or 3.
+    void setImage(const uint8_T *image, int nRows, int nCols, int nChannels,
+                  bool isRowMajor)
+    {
+        // a row major grayscale image is its own OpenCV form, which must
+        // not be reused as the buffer of a column major conversion
+        if (isRowMajor != mIsRowMajor)
+        {
+            mConverted.release();
+        }
+
+        mRows = nRows;
+        mCols = nCols;
+        mChannels = nChannels;
+        mIsRowMajor = isRowMajor;
+
+        const int storedRows = isRowMajor ? nRows : nCols * nChannels;
+        const int storedCols = isRowMajor ? nCols * nChannels : nRows;
+#if defined(IMAGE_HANDLE_HAVE_CUDA)
+        if (mDevice >= 0)
+        {
+            mHostStored.create(storedRows, storedCols, CV_8UC1);
+            mStored = mHostStored.createMatHeader();
+        }
+        else
+#endif
+        {
+            mStored.create(storedRows, storedCols, CV_8UC1);
+        }
+        std::memcpy(mStored.data, image, (size_t)storedRows * storedCols);
+
+        mHasConverted = false;
+        mHasDeviceStored = false;
+        mHasDeviceConverted = false;
+    }
+
+    // Copies the image back to a MATLAB buffer of the layout it was set with
+    void getImage(uint8_T *image) const
+    {
+        std::memcpy(image, mStored.data, mStored.total());
+    }
+
+    // CUDA device of the device forms, or -1
+    int getDevice() const { return mDevice; }
+
+    bool isRowMajor() const { return mIsRowMajor; }
+
+    // MATLAB size of the image
+    int getRows() const { return mRows; }
+    int getCols() const { return mCols; }
+    int getChannels() const { return mChannels; }
+
+    // The MATLAB buffer wrapped as is. For single channel images this is
+    // nCols-by-nRows for column major code, the transposed frame, and
+    // nRows-by-nCols for row major code.
+    const cv::Mat &getStored() const
+    {
+        return mStored;
+    }
+
+    // The image in OpenCV layout, as cArrayToMat and cArrayToMatView_RowMaj
+    // return it: nRows-by-nCols, BGR interleaved for RGB images
+    const cv::Mat &getConverted()
+    {
+        if (!mHasConverted)
+        {
+            if (mIsRowMajor)
+            {
+                cArrayToMatView_RowMaj<uint8_T>(mStored.data, mRows, mCols,
+                    mChannels == 3, mConverted);
+            }
+            else
+            {
+                cArrayToMat<uint8_T>(mStored.data, mRows, mCols,
+                    mChannels == 3, mConverted);
+            }
+            mHasConverted = true;
+        }
+        return mConverted;
+    }
+
+#if defined(IMAGE_HANDLE_HAVE_CUDA)
+    // getStored() on the device. Only valid if getDevice() is not -1.
+    const cv::cuda::GpuMat &getDeviceStored()
+    {
+        if (!mHasDeviceStored)
+        {
+            cv::cuda::setDevice(mDevice);
+            mDeviceStored.upload(mHostStored, mStream);
+            mStream.waitForCompletion();
+            mHasDeviceStored = true;
+        }
+        return mDeviceStored;
+    }
+
+    // getConverted() on the device. Only valid if getDevice() is not -1.
+    const cv::cuda::GpuMat &getDeviceConverted()
+    {
+        if (!mHasDeviceConverted)
+        {
+            if (mChannels == 1 && mIsRowMajor)
+            {
+                // already in OpenCV layout
+                return getDeviceStored();
+            }
+
+            cv::cuda::setDevice(mDevice);
+            if (mChannels == 1)
+            {
+                // the uploaded buffer is the transposed frame
+                cv::cuda::transpose(getDeviceStored(), mDeviceConverted, mStream);
+                mStream.waitForCompletion();
+            }
+            else
+            {
+                // the planes are interleaved on the host
+                mDeviceConverted.upload(getConverted(), mStream);
+                mStream.waitForCompletion();
+            }
+            mHasDeviceConverted = true;
+        }
+        return mDeviceConverted;
+    }
+#endif
+
+private:
+    int mDevice;
+
+    // MATLAB size and layout
+    int mRows;
+    int mCols;
+    int mChannels;
+    bool mIsRowMajor;
+
+    // copy of the MATLAB buffer, in page-locked memory with a device
+    cv::Mat mStored;
+
+    // OpenCV layout, when asked for
+    cv::Mat mConverted;
+    bool mHasConverted;
+
+#if defined(IMAGE_HANDLE_HAVE_CUDA)
+    cv::cuda::HostMem mHostStored;
+    cv::cuda::Stream mStream;
+    cv::cuda::GpuMat mDeviceStored;
+    cv::cuda::GpuMat mDeviceConverted;
+#endif
+    bool mHasDeviceStored;
+    bool mHasDeviceConverted;
+
+    // copying and assignment are disallowed
+    ImageHandle(const ImageHandle &);
+    ImageHandle &operator=(const ImageHandle &);
+};
+
+} // namespace vision
+
+#endif
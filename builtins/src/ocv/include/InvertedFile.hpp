@@ -0,0 +1,819 @@
+//////////////////////////////////////////////////////////////////////////////
+// Compressed inverted file of visual word histograms, for the search of
+// invertedImageIndex and retrieveImages.
+//
+// The images are kept in shards of INVFILE_SHARD_IMAGES consecutive
+// images. A shard stores the posting list of every word, the images that
+// contain it with their counts, and the word list of every image, both
+// delta and varint coded, so a posting takes 2 or 3 bytes. The word lists
+// give the norms of the tf-idf vectors of the images and let shards be
+// rebuilt when images are added to the last shard or removed.
+//
+// A search scores the shards in parallel. Each shard decodes the posting
+// lists of the query words into a dense array of scores of its images,
+// the weights of a block of postings being computed with the 128-bit
+// universal intrinsics of OpenCV, and keeps its best images in a heap. The
+// scores are the cosine similarities of the tf-idf vectors, restricted to
+// the query words in the word frequency range, as invertedImageIndex.
+//
+// An index is saved as a single file that load() maps read-only, so large
+// indices are not read into memory and are shared between processes.
+// Shards rebuilt after a load are held in memory.
+//
+// Copyright 2016 The MathWorks, Inc.
+//
+//////////////////////////////////////////////////////////////////////////////
+#ifndef INVERTED_FILE
+#define INVERTED_FILE
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <utility>
+#include <vector>
+
+#include "vision_defines.h"
+#include "opencv2/core/hal/intrin.hpp"
+#include "MappedFile.hpp"
+#include "cgThreadPool.hpp"
+
+// images per shard
+#define INVFILE_SHARD_IMAGES 16384
+// postings decoded per block of a search
+#define INVFILE_DECODE_BLOCK 256
+
+namespace invfile
+{
+
+inline void putVarint(std::vector<uint8_T> &out, uint32_T v)
+{
+    while (v >= 0x80)
+    {
+        out.push_back((uint8_T)(v | 0x80));
+        v >>= 7;
+    }
+    out.push_back((uint8_T)v);
+}
+
+inline int varintLength(uint32_T v)
+{
+    int n = 1;
+    while (v >= 0x80)
+    {
+        v >>= 7;
+        n++;
+    }
+    return n;
+}
+
+inline uint8_T *writeVarint(uint8_T *p, uint32_T v)
+{
+    while (v >= 0x80)
+    {
+        *p++ = (uint8_T)(v | 0x80);
+        v >>= 7;
+    }
+    *p++ = (uint8_T)v;
+    return p;
+}
+
+inline uint32_T getVarint(const uint8_T *&p)
+{
+    uint32_T v = *p & 0x7F;
+    int shift = 7;
+    while (*p++ & 0x80)
+    {
+        v |= (uint32_T)(*p & 0x7F) << shift;
+        shift += 7;
+    }
+    return v;
+}
+
+// Word, 0-based, and count
+typedef std::pair<uint32_T, uint32_T> WordCount;
+
+class InvertedFile
+{
+public:
+    InvertedFile(int numWords) : mNumWords(numWords), mNumImages(0), mIsDirty(true)
+    {
+        mNumImagesPerWord.assign(numWords, 0);
+    }
+
+    ~InvertedFile()
+    {
+        clearShards();
+    }
+
+    // Appends numImages images. The histograms are the numEntries
+    // (image, word, count) of a sparse numImages-by-numWords matrix, images
+    // and words 1-based, in any order.
+    void addImages(const uint32_T *image, const uint32_T *word, const double *count,
+                   int numEntries, int numImages)
+    {
+        if (numImages <= 0)
+            return;
+
+        std::vector<int> order;
+        for (int k = 0; k < numEntries; k++)
+        {
+            if (image[k] >= 1 && (int)image[k] <= numImages && word[k] >= 1 &&
+                (int)word[k] <= mNumWords && count[k] >= 0.5)
+                order.push_back(k);
+        }
+        std::sort(order.begin(), order.end(), EntryLess(image, word));
+
+        std::vector<std::vector<WordCount> > images(numImages);
+        for (size_t k = 0; k < order.size(); k++)
+        {
+            std::vector<WordCount> &words = images[image[order[k]] - 1];
+            const uint32_T w = word[order[k]] - 1;
+            const uint32_T c = (uint32_T)std::floor(count[order[k]] + 0.5);
+            if (!words.empty() && words.back().first == w)
+                words.back().second += c;
+            else
+                words.push_back(WordCount(w, c));
+        }
+
+        for (int i = 0; i < numImages; i++)
+            addStatistics(images[i], 1);
+
+        // the last shard is refilled with the new images
+        int first = mNumImages;
+        if (!mShards.empty() && mShards.back()->numImages < INVFILE_SHARD_IMAGES)
+        {
+            Shard *last = mShards.back();
+            std::vector<std::vector<WordCount> > lastImages(last->numImages);
+            for (int i = 0; i < last->numImages; i++)
+                last->decodeImage(i, lastImages[i]);
+            images.insert(images.begin(), lastImages.begin(), lastImages.end());
+            first = last->firstImage;
+            delete last;
+            mShards.pop_back();
+        }
+        mNumImages += numImages;
+
+        const int numNew = ((int)images.size() + INVFILE_SHARD_IMAGES - 1) / INVFILE_SHARD_IMAGES;
+        const size_t begin = mShards.size();
+        mShards.resize(begin + numNew, NULL);
+#ifdef PARALLEL
+        cgParallelForWorkers(numNew, [&](int, int s) {
+            mShards[begin + s] = buildShard(first, images, s);
+        });
+#else
+        for (int s = 0; s < numNew; s++)
+            mShards[begin + s] = buildShard(first, images, s);
+#endif
+        mIsDirty = true;
+    }
+
+    // Removes the images of 1-based indices. Shards with removed images are
+    // rebuilt from the word lists of the others.
+    void removeImages(const double *indices, int numIndices)
+    {
+        std::vector<char> isRemoved(mNumImages, 0);
+        for (int k = 0; k < numIndices; k++)
+        {
+            const double i = indices[k];
+            if (i >= 1 && i <= mNumImages)
+                isRemoved[(int)i - 1] = 1;
+        }
+
+        std::vector<Shard *> shards;
+        std::vector<WordCount> words;
+        int first = 0;
+        for (size_t s = 0; s < mShards.size(); s++)
+        {
+            Shard *shard = mShards[s];
+            std::vector<std::vector<WordCount> > kept;
+            bool hasRemoved = false;
+            for (int i = 0; i < shard->numImages; i++)
+            {
+                if (!isRemoved[shard->firstImage + i])
+                    continue;
+                hasRemoved = true;
+                shard->decodeImage(i, words);
+                addStatistics(words, -1);
+            }
+            if (hasRemoved)
+            {
+                for (int i = 0; i < shard->numImages; i++)
+                {
+                    if (isRemoved[shard->firstImage + i])
+                        continue;
+                    kept.push_back(std::vector<WordCount>());
+                    shard->decodeImage(i, kept.back());
+                }
+                delete shard;
+                shard = kept.empty() ? NULL
+                    : Shard::build(first, kept, 0, (int)kept.size(), mNumWords);
+            }
+            if (shard)
+            {
+                shard->firstImage = first;
+                first += shard->numImages;
+                shards.push_back(shard);
+            }
+        }
+        mShards.swap(shards);
+
+        int numKept = 0;
+        for (int i = 0; i < mNumImages; i++)
+        {
+            if (!isRemoved[i])
+                mWordsPerImage[numKept++] = mWordsPerImage[i];
+        }
+        mWordsPerImage.resize(numKept);
+        mNumImages = numKept;
+        mIsDirty = true;
+    }
+
+    // Images of best score for the query histogram, numQueryWords words,
+    // 1-based, and counts. Only the query words whose frequency is within
+    // freqRange are scored, and only the images that contain at least
+    // matchThreshold of them. Writes at most numResults 1-based images and
+    // their scores, best first, and returns their number.
+    int search(const uint32_T *queryWords, const double *queryCounts, int numQueryWords,
+               const double *freqRange, double matchThreshold, int numResults,
+               uint32_T *imageIDs, double *scores)
+    {
+        if (mNumImages == 0 || numResults <= 0)
+            return 0;
+        if (mIsDirty)
+            updateStatistics();
+
+        // normalized tf-idf of the query, over all its words
+        std::vector<double> counts(mNumWords, 0.0), query(mNumWords);
+        double sumCounts = 0;
+        for (int k = 0; k < numQueryWords; k++)
+        {
+            if (queryWords[k] >= 1 && (int)queryWords[k] <= mNumWords && queryCounts[k] > 0)
+            {
+                counts[queryWords[k] - 1] += queryCounts[k];
+                sumCounts += queryCounts[k];
+            }
+        }
+        double sumSquares = 0;
+        for (int w = 0; w < mNumWords; w++)
+        {
+            query[w] = counts[w] / (sumCounts + DBL_EPSILON) * mIdf[w];
+            sumSquares += query[w] * query[w];
+        }
+        const double queryScale = 1 / (std::sqrt(sumSquares) + DBL_EPSILON);
+
+        // query words in the frequency range, with their weight
+        std::vector<int> words;
+        std::vector<double> weights;
+        for (int w = 0; w < mNumWords; w++)
+        {
+            if (counts[w] > 0 && mWordFrequency[w] >= freqRange[0] &&
+                mWordFrequency[w] <= freqRange[1])
+            {
+                words.push_back(w);
+                weights.push_back(query[w] * queryScale * mIdf[w]);
+            }
+        }
+        if (words.empty())
+            return 0;
+
+        const int numShards = (int)mShards.size();
+        std::vector<std::vector<Candidate> > best(numShards);
+        std::vector<SearchBuffers> buffers(std::max((int)cgGetNumThreads(), 1));
+#ifdef PARALLEL
+        cgParallelForWorkers(numShards, [&](int worker, int s) {
+            searchShard(*mShards[s], words, weights, matchThreshold, numResults,
+                        buffers[worker], best[s]);
+        });
+#else
+        for (int s = 0; s < numShards; s++)
+            searchShard(*mShards[s], words, weights, matchThreshold, numResults,
+                        buffers[0], best[s]);
+#endif
+
+        std::vector<Candidate> all;
+        for (int s = 0; s < numShards; s++)
+            all.insert(all.end(), best[s].begin(), best[s].end());
+        const int numOut = std::min(numResults, (int)all.size());
+        std::partial_sort(all.begin(), all.begin() + numOut, all.end(), isBetter);
+        for (int k = 0; k < numOut; k++)
+        {
+            imageIDs[k] = all[k].image + 1;
+            scores[k] = all[k].score;
+        }
+        return numOut;
+    }
+
+    int getNumImages() const
+    {
+        return mNumImages;
+    }
+
+    int getNumWords() const
+    {
+        return mNumWords;
+    }
+
+    // Fraction of the images that contain each word
+    void getWordFrequency(double *frequency)
+    {
+        if (mIsDirty)
+            updateStatistics();
+        std::copy(mWordFrequency.begin(), mWordFrequency.end(), frequency);
+    }
+
+    // Saves the index to a single file, which load() maps
+    bool save(const char *filename) const
+    {
+        FILE *fout = fopen(filename, "wb");
+        if (fout == NULL)
+            return false;
+
+        FileHeader header;
+        memcpy(header.magic, getMagic(), sizeof(header.magic));
+        header.version = FILE_VERSION;
+        header.numWords = mNumWords;
+        header.numImages = mNumImages;
+        header.numShards = (int32_T)mShards.size();
+
+        size_t pos = 0;
+        bool ok = write(fout, &header, sizeof(header), pos) &&
+                  write(fout, mNumImagesPerWord.data(), mNumWords * sizeof(uint32_T), pos) &&
+                  pad(fout, pos) &&
+                  write(fout, mWordsPerImage.data(), mNumImages * sizeof(double), pos);
+
+        for (size_t s = 0; ok && s < mShards.size(); s++)
+        {
+            const Shard &shard = *mShards[s];
+            ShardHeader shardHeader;
+            shardHeader.numImages = shard.numImages;
+            shardHeader.reserved = 0;
+            shardHeader.postingBytes = shard.wordOffsets[mNumWords];
+            shardHeader.forwardBytes = shard.imageOffsets[shard.numImages];
+            ok = write(fout, &shardHeader, sizeof(shardHeader), pos) &&
+                 write(fout, shard.wordOffsets, (mNumWords + 1) * sizeof(uint32_T), pos) &&
+                 write(fout, shard.imageOffsets, (shard.numImages + 1) * sizeof(uint32_T), pos) &&
+                 write(fout, shard.postings, shardHeader.postingBytes, pos) &&
+                 write(fout, shard.forward, shardHeader.forwardBytes, pos) &&
+                 pad(fout, pos);
+        }
+        ok = fclose(fout) == 0 && ok;
+        return ok;
+    }
+
+    // Loads an index written by save(). The shards refer to the mapped
+    // file; the number of words must match.
+    bool load(const char *filename)
+    {
+        clearShards();
+        mNumImages = 0;
+        mWordsPerImage.clear();
+        std::fill(mNumImagesPerWord.begin(), mNumImagesPerWord.end(), 0);
+        mIsDirty = true;
+
+        vision::MappedFile &mapping = mMapping;
+        FileHeader header;
+        if (!mapping.open(filename) || mapping.size() < sizeof(header))
+        {
+            mapping.close();
+            return false;
+        }
+        memcpy(&header, mapping.data(), sizeof(header));
+        if (memcmp(header.magic, getMagic(), sizeof(header.magic)) != 0 ||
+            header.version != FILE_VERSION || header.numWords != mNumWords ||
+            header.numImages < 0 || header.numShards < 0)
+        {
+            mapping.close();
+            return false;
+        }
+
+        const unsigned char *data = mapping.data();
+        const size_t size = mapping.size();
+        size_t pos = sizeof(header);
+        bool ok = pos + mNumWords * sizeof(uint32_T) <= size;
+        if (ok)
+        {
+            memcpy(mNumImagesPerWord.data(), data + pos, mNumWords * sizeof(uint32_T));
+            pos = align(pos + mNumWords * sizeof(uint32_T));
+            ok = pos + header.numImages * sizeof(double) <= size;
+        }
+        if (ok)
+        {
+            mWordsPerImage.resize(header.numImages);
+            memcpy(mWordsPerImage.data(), data + pos, header.numImages * sizeof(double));
+            pos += header.numImages * sizeof(double);
+        }
+
+        int first = 0;
+        for (int s = 0; ok && s < header.numShards; s++)
+        {
+            ShardHeader shardHeader;
+            ok = pos + sizeof(shardHeader) <= size;
+            if (!ok)
+                break;
+            memcpy(&shardHeader, data + pos, sizeof(shardHeader));
+            pos += sizeof(shardHeader);
+
+            Shard *shard = new Shard();
+            shard->firstImage = first;
+            shard->numImages = shardHeader.numImages;
+            const size_t imageOffsetBytes = ((size_t)shardHeader.numImages + 1) * sizeof(uint32_T);
+            const size_t end = pos + (mNumWords + 1) * sizeof(uint32_T) + imageOffsetBytes +
+                               shardHeader.postingBytes + shardHeader.forwardBytes;
+            ok = shardHeader.numImages > 0 && end <= size;
+            if (ok)
+            {
+                shard->wordOffsets = (const uint32_T *)(data + pos);
+                pos += (mNumWords + 1) * sizeof(uint32_T);
+                shard->imageOffsets = (const uint32_T *)(data + pos);
+                pos += imageOffsetBytes;
+                shard->postings = data + pos;
+                pos += shardHeader.postingBytes;
+                shard->forward = data + pos;
+                pos = align(pos + shardHeader.forwardBytes);
+                first += shard->numImages;
+            }
+            mShards.push_back(shard);
+        }
+
+        if (!ok || first != header.numImages)
+        {
+            clearShards();
+            mWordsPerImage.clear();
+            std::fill(mNumImagesPerWord.begin(), mNumImagesPerWord.end(), 0);
+            mapping.close();
+            return false;
+        }
+        mNumImages = header.numImages;
+        return true;
+    }
+
+private:
+    // Orders the entries of addImages by image, then by word
+    struct EntryLess
+    {
+        const uint32_T *image;
+        const uint32_T *word;
+        EntryLess(const uint32_T *i, const uint32_T *w) : image(i), word(w) {}
+        bool operator()(int a, int b) const
+        {
+            return image[a] != image[b] ? image[a] < image[b] : word[a] < word[b];
+        }
+    };
+
+    // Images [firstImage, firstImage + numImages). The posting list of word
+    // w is postings [wordOffsets[w], wordOffsets[w + 1]), pairs of varints
+    // of the image, from the previous image of the list, and the count. The
+    // word list of image i is forward [imageOffsets[i], imageOffsets[i + 1]),
+    // pairs of varints of the word, from the previous word, and the count.
+    // The arrays are owned by the shard, or refer to a mapped file.
+    struct Shard
+    {
+        Shard() : firstImage(0), numImages(0), wordOffsets(NULL), postings(NULL),
+                  imageOffsets(NULL), forward(NULL) {}
+
+        // Shard of images [from, to) of images, the first being firstImage
+        static Shard *build(int firstImage, const std::vector<std::vector<WordCount> > &images,
+                            int from, int to, int numWords)
+        {
+            Shard *shard = new Shard();
+            shard->firstImage = firstImage;
+            shard->numImages = to - from;
+
+            // bytes of each posting list, then the lists
+            std::vector<uint32_T> &wordOffsets = shard->ownWordOffsets;
+            std::vector<uint32_T> last(numWords, 0);
+            wordOffsets.assign(numWords + 1, 0);
+            std::vector<uint32_T> &imageOffsets = shard->ownImageOffsets;
+            imageOffsets.assign(shard->numImages + 1, 0);
+            std::vector<uint8_T> &forward = shard->ownForward;
+            for (int i = from; i < to; i++)
+            {
+                const uint32_T local = (uint32_T)(i - from);
+                uint32_T prevWord = 0;
+                for (size_t k = 0; k < images[i].size(); k++)
+                {
+                    const uint32_T w = images[i][k].first, c = images[i][k].second;
+                    wordOffsets[w + 1] += varintLength(local - last[w]) + varintLength(c);
+                    last[w] = local;
+                    putVarint(forward, w - prevWord);
+                    putVarint(forward, c);
+                    prevWord = w;
+                }
+                imageOffsets[local + 1] = (uint32_T)forward.size();
+            }
+            for (int w = 0; w < numWords; w++)
+                wordOffsets[w + 1] += wordOffsets[w];
+
+            std::vector<uint8_T> &postings = shard->ownPostings;
+            postings.resize(wordOffsets[numWords]);
+            std::vector<uint8_T *> at(numWords);
+            for (int w = 0; w < numWords; w++)
+            {
+                at[w] = postings.data() + wordOffsets[w];
+                last[w] = 0;
+            }
+            for (int i = from; i < to; i++)
+            {
+                const uint32_T local = (uint32_T)(i - from);
+                for (size_t k = 0; k < images[i].size(); k++)
+                {
+                    const uint32_T w = images[i][k].first;
+                    at[w] = writeVarint(at[w], local - last[w]);
+                    at[w] = writeVarint(at[w], images[i][k].second);
+                    last[w] = local;
+                }
+            }
+
+            shard->wordOffsets = wordOffsets.data();
+            shard->postings = postings.data();
+            shard->imageOffsets = imageOffsets.data();
+            shard->forward = forward.data();
+            return shard;
+        }
+
+        // Words of image i of the shard
+        void decodeImage(int i, std::vector<WordCount> &words) const
+        {
+            words.clear();
+            const uint8_T *p = forward + imageOffsets[i];
+            const uint8_T *end = forward + imageOffsets[i + 1];
+            uint32_T w = 0;
+            while (p < end)
+            {
+                w += getVarint(p);
+                const uint32_T c = getVarint(p);
+                words.push_back(WordCount(w, c));
+            }
+        }
+
+        int firstImage;
+        int numImages;
+        const uint32_T *wordOffsets;
+        const uint8_T *postings;
+        const uint32_T *imageOffsets;
+        const uint8_T *forward;
+
+        std::vector<uint32_T> ownWordOffsets, ownImageOffsets;
+        std::vector<uint8_T> ownPostings, ownForward;
+
+    private:
+        Shard(const Shard &);
+        Shard &operator=(const Shard &);
+    };
+
+    struct Candidate
+    {
+        double score;
+        uint32_T image;
+    };
+
+    // Better score first, then lower image, as a stable descending sort
+    static bool isBetter(const Candidate &a, const Candidate &b)
+    {
+        return a.score > b.score || (a.score == b.score && a.image < b.image);
+    }
+
+    // Per worker buffers of a search
+    struct SearchBuffers
+    {
+        std::vector<double> scores;
+        std::vector<uint32_T> matches;
+        uint32_T images[INVFILE_DECODE_BLOCK];
+        double weights[INVFILE_DECODE_BLOCK];
+    };
+
+    void searchShard(const Shard &shard, const std::vector<int> &words,
+                     const std::vector<double> &weights, double matchThreshold, int numResults,
+                     SearchBuffers &buffers, std::vector<Candidate> &best) const
+    {
+        const int n = shard.numImages;
+        std::vector<double> &scores = buffers.scores;
+        std::vector<uint32_T> &matches = buffers.matches;
+        scores.assign(n, 0.0);
+        matches.assign(n, 0);
+
+        for (size_t k = 0; k < words.size(); k++)
+        {
+            const uint8_T *p = shard.postings + shard.wordOffsets[words[k]];
+            const uint8_T *end = shard.postings + shard.wordOffsets[words[k] + 1];
+            uint32_T image = 0;
+            while (p < end)
+            {
+                // a block of postings, then their weights
+                int count = 0;
+                for (; count < INVFILE_DECODE_BLOCK && p < end; count++)
+                {
+                    image += getVarint(p);
+                    buffers.images[count] = image;
+                    buffers.weights[count] = (double)getVarint(p);
+                }
+                scaleBlock(buffers.weights, count, weights[k]);
+                for (int j = 0; j < count; j++)
+                {
+                    scores[buffers.images[j]] += buffers.weights[j];
+                    matches[buffers.images[j]]++;
+                }
+            }
+        }
+
+        // image scores, kept in a heap of the numResults best
+        scaleBlockBy(&scores[0], &mImageFactor[shard.firstImage], n);
+        const double numWords = (double)words.size();
+        for (int i = 0; i < n; i++)
+        {
+            if (matches[i] == 0 || matches[i] / numWords < matchThreshold)
+                continue;
+            Candidate c;
+            c.score = scores[i];
+            c.image = (uint32_T)(shard.firstImage + i);
+            if ((int)best.size() < numResults)
+            {
+                best.push_back(c);
+                std::push_heap(best.begin(), best.end(), isBetter);
+            }
+            else if (isBetter(c, best.front()))
+            {
+                std::pop_heap(best.begin(), best.end(), isBetter);
+                best.back() = c;
+                std::push_heap(best.begin(), best.end(), isBetter);
+            }
+        }
+    }
+
+    // x *= a
+    static void scaleBlock(double *x, int n, double a)
+    {
+        int i = 0;
+#if CV_SIMD128_64F
+        const cv::v_float64x2 va = cv::v_setall_f64(a);
+        for (; i + 4 <= n; i += 4)
+        {
+            cv::v_store(x + i, cv::v_load(x + i) * va);
+            cv::v_store(x + i + 2, cv::v_load(x + i + 2) * va);
+        }
+#endif
+        for (; i < n; i++)
+            x[i] *= a;
+    }
+
+    // x .*= a
+    static void scaleBlockBy(double *x, const double *a, int n)
+    {
+        int i = 0;
+#if CV_SIMD128_64F
+        for (; i + 4 <= n; i += 4)
+        {
+            cv::v_store(x + i, cv::v_load(x + i) * cv::v_load(a + i));
+            cv::v_store(x + i + 2, cv::v_load(x + i + 2) * cv::v_load(a + i + 2));
+        }
+#endif
+        for (; i < n; i++)
+            x[i] *= a[i];
+    }
+
+    // Adds sign times image to the word counts of the images
+    void addStatistics(const std::vector<WordCount> &words, int sign)
+    {
+        double sumCounts = 0;
+        for (size_t k = 0; k < words.size(); k++)
+        {
+            mNumImagesPerWord[words[k].first] += sign;
+            sumCounts += words[k].second;
+        }
+        if (sign > 0)
+            mWordsPerImage.push_back(sumCounts);
+    }
+
+    // Word frequencies, inverse document frequencies and the factor of the
+    // score of each image, 1 / ((S + eps) * (norm + eps)) for S words and
+    // a tf-idf vector of L2 norm norm
+    void updateStatistics()
+    {
+        mIdf.resize(mNumWords);
+        mWordFrequency.resize(mNumWords);
+        for (int w = 0; w < mNumWords; w++)
+        {
+            mWordFrequency[w] = (double)mNumImagesPerWord[w] / mNumImages;
+            mIdf[w] = std::log(mNumImages / ((double)mNumImagesPerWord[w] + DBL_EPSILON));
+        }
+
+        mImageFactor.resize(mNumImages);
+        std::vector<std::vector<WordCount> > words(std::max((int)cgGetNumThreads(), 1));
+#ifdef PARALLEL
+        cgParallelForWorkers((int)mShards.size(), [&](int worker, int s) {
+            updateImageFactors(*mShards[s], words[worker]);
+        });
+#else
+        for (size_t s = 0; s < mShards.size(); s++)
+            updateImageFactors(*mShards[s], words[0]);
+#endif
+        mIsDirty = false;
+    }
+
+    // The factors of the images of a shard, words a buffer of the word
+    // lists
+    void updateImageFactors(const Shard &shard, std::vector<WordCount> &words)
+    {
+        for (int i = 0; i < shard.numImages; i++)
+        {
+            const int image = shard.firstImage + i;
+            const double S = mWordsPerImage[image] + DBL_EPSILON;
+            shard.decodeImage(i, words);
+            double sumSquares = 0;
+            for (size_t k = 0; k < words.size(); k++)
+            {
+                const double v = words[k].second / S * mIdf[words[k].first];
+                sumSquares += v * v;
+            }
+            mImageFactor[image] = 1 / (S * (std::sqrt(sumSquares) + DBL_EPSILON));
+        }
+    }
+
+    // Shard s of the images appended from image first
+    Shard *buildShard(int first, const std::vector<std::vector<WordCount> > &images, int s) const
+    {
+        const int from = s * INVFILE_SHARD_IMAGES;
+        const int to = std::min((int)images.size(), from + INVFILE_SHARD_IMAGES);
+        return Shard::build(first + from, images, from, to, mNumWords);
+    }
+
+    void clearShards()
+    {
+        for (size_t s = 0; s < mShards.size(); s++)
+            delete mShards[s];
+        mShards.clear();
+    }
+
+    // On-disk header of a saved index, followed by the images per word,
+    // the words per image and the shards, each 8-byte aligned
+    struct FileHeader
+    {
+        char    magic[8];
+        int32_T version;
+        int32_T numWords;
+        int32_T numImages;
+        int32_T numShards;
+    };
+
+    // Header of a shard, followed by its word and image offsets, postings
+    // and word lists
+    struct ShardHeader
+    {
+        int32_T  numImages;
+        int32_T  reserved;
+        uint32_T postingBytes;
+        uint32_T forwardBytes;
+    };
+
+    enum { FILE_VERSION = 1, FILE_ALIGNMENT = 8 };
+
+    static const char *getMagic()
+    {
+        return "MWINVIDX";
+    }
+
+    static size_t align(size_t pos)
+    {
+        return (pos + FILE_ALIGNMENT - 1) / FILE_ALIGNMENT * FILE_ALIGNMENT;
+    }
+
+    static bool write(FILE *fout, const void *data, size_t bytes, size_t &pos)
+    {
+        pos += bytes;
+        return bytes == 0 || fwrite(data, 1, bytes, fout) == bytes;
+    }
+
+    static bool pad(FILE *fout, size_t &pos)
+    {
+        const char zeros[FILE_ALIGNMENT] = {0};
+        return write(fout, zeros, align(pos) - pos, pos);
+    }
+
+    int mNumWords;
+    int mNumImages;
+
+    std::vector<Shard *> mShards;
+
+    // images that contain each word and words of each image
+    std::vector<uint32_T> mNumImagesPerWord;
+    std::vector<double> mWordsPerImage;
+
+    // statistics of the images, updated on the next search when dirty
+    bool mIsDirty;
+    std::vector<double> mWordFrequency;
+    std::vector<double> mIdf;
+    std::vector<double> mImageFactor;
+
+    // file the loaded shards refer to
+    vision::MappedFile mMapping;
+
+    // prevent copying
+    InvertedFile(const InvertedFile &);
+    InvertedFile &operator=(const InvertedFile &);
+};
+
+} // namespace invfile
+
+#endif
@@ -0,0 +1,1109 @@
+//////////////////////////////////////////////////////////////////////////////
+// KAZE features of detectKAZEFeatures and extractFeatures, after the KAZE
+// of OpenCV (Alcantarilla, Bartoli and Davison, "KAZE Features", ECCV 2012).
+//
+// The nonlinear scale space has numOctaves*numScaleLevels levels, all at the
+// size of the image. Each level evolves the previous one with the Fast
+// Explicit Diffusion (FED) cycles that reach its time, with the Perona-Malik
+// g1 or g2 or the Weickert conductance of the gradient of the smoothed
+// level. The conductance and the explicit diffusion steps run on rows of the
+// image with the 128-bit universal intrinsics of OpenCV and, with PARALLEL,
+// on blocks of rows of the pool.
+//
+// Once the levels are built, their scale normalized Scharr derivatives and
+// the determinant of the Hessian are computed in parallel, one level per
+// task, as are the maxima of the determinant over the 3x3x3 neighborhood.
+// The maxima are refined to subpixel location and scale with a quadratic fit
+// and described, in parallel over blocks of keypoints, with the dominant
+// orientation of the first derivatives and the 64 or 128 element M-SURF
+// descriptor.
+//
+// Images are uint8, column major. Keypoints are 0-based, in the fields of
+// cv::KeyPoint as OpenCV fills them: size is a diameter, angle is in
+// radians and classId is the level of the keypoint.
+//
+// Copyright 2016 The MathWorks, Inc.
+//
+//////////////////////////////////////////////////////////////////////////////
+#ifndef KAZE_FEATURES
+#define KAZE_FEATURES
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include "vision_defines.h"
+#include "opencv2/core.hpp"
+#include "opencv2/core/hal/intrin.hpp"
+#include "cgThreadPool.hpp"
+
+namespace kaze
+{
+
+// Conductance codes of convertKAZEDiffusionToOCVCode
+enum Diffusivity
+{
+    DIFF_PM_G1    = 0, // 'sharpedge'
+    DIFF_PM_G2    = 1, // 'region'
+    DIFF_WEICKERT = 2  // 'edge'
+};
+
+// Options of the KAZE of OpenCV that detectKAZEFeatures does not set
+const float KAZE_SIGMA_OFFSET        = 1.6f; // sigma of the first level
+const float KAZE_SIGMA_DERIVATIVES   = 1.0f; // smoothing of the derivatives
+const float KAZE_CONTRAST_PERCENTILE = 0.7f;
+const int   KAZE_CONTRAST_NUM_BINS   = 300;
+const float KAZE_FED_TAU_MAX         = 0.25f;
+
+// Keypoints described by one task
+const int KAZE_KEYPOINTS_PER_BLOCK = 64;
+const int KAZE_MIN_ROWS_PER_BLOCK = 32;
+
+struct KazeParams
+{
+    int numOctaves;
+    int numScaleLevels;
+    int diffusivity;
+    float threshold;
+    bool extended;
+    bool upright;
+};
+
+struct KazeKeypoint
+{
+    float x, y;
+    float size;
+    float response;
+    float angle;
+    int octave;
+    int classId;
+};
+
+//////////////////////////////////////////////////////////////////////////////
+// Image helpers. Images are row major, width by height.
+//////////////////////////////////////////////////////////////////////////////
+
+#ifdef PARALLEL
+// fcn(startRow, endRow) over blocks of rows, on the pool when parallel
+template <typename Fcn>
+inline void forRows(int numRows, bool parallel, Fcn fcn)
+{
+    if (parallel)
+    {
+        cgParallelForRows(numRows, KAZE_MIN_ROWS_PER_BLOCK, fcn);
+        return;
+    }
+    if (numRows > 0)
+        fcn(0, numRows);
+}
+#endif
+
+// BORDER_REFLECT_101 and BORDER_REPLICATE of OpenCV
+inline int borderIndex(int i, int n, bool replicate)
+{
+    if (replicate || n == 1)
+        return std::min(std::max(i, 0), n - 1);
+    while (i < 0 || i >= n)
+        i = (i < 0) ? -i : 2 * (n - 1) - i;
+    return i;
+}
+
+// Tap of a separable kernel, weighting in[i + offset]
+struct Tap
+{
+    int offset;
+    float weight;
+};
+
+// Taps of cv::getGaussianKernel, with the size of gaussian_2D_convolution
+inline void gaussianTaps(float sigma, std::vector<Tap> &taps)
+{
+    int n = (int)std::ceil(2.0f * (1.0f + (sigma - 0.8f) / 0.3f));
+    if (n % 2 == 0)
+        n++;
+    std::vector<double> g(n);
+    double sum = 0;
+    for (int k = 0; k < n; k++)
+    {
+        const double x = k - (n - 1) * 0.5;
+        g[k] = std::exp(-x * x / (2.0 * sigma * sigma));
+        sum += g[k];
+    }
+    taps.resize(n);
+    for (int k = 0; k < n; k++)
+    {
+        taps[k].offset = k - (n - 1) / 2;
+        taps[k].weight = (float)(g[k] / sum);
+    }
+}
+
+// Taps of the Scharr kernels of compute_derivative_kernels at the given
+// scale, the derivative [-1 0 1] or the smoothing [3 10 3] normalized, with
+// their taps scale pixels apart. At scale 1 they are those of the
+// normalized cv::getDerivKernels.
+inline void scharrTaps(int scale, bool derivative, std::vector<Tap> &taps)
+{
+    taps.resize(derivative ? 2 : 3);
+    if (derivative)
+    {
+        taps[0].offset = -scale; taps[0].weight = -1.0f;
+        taps[1].offset = scale;  taps[1].weight = 1.0f;
+        return;
+    }
+    const float w = 10.0f / 3.0f;
+    const float norm = 1.0f / (2.0f * scale * (w + 2.0f));
+    taps[0].offset = -scale; taps[0].weight = norm;
+    taps[1].offset = 0;      taps[1].weight = w * norm;
+    taps[2].offset = scale;  taps[2].weight = norm;
+}
+
+// dst[i] += a*src[i]
+inline void addScaled(float *dst, const float *src, float a, int n)
+{
+    int i = 0;
+#if CV_SIMD128
+    const cv::v_float32x4 va = cv::v_setall_f32(a);
+    for (; i <= n - 4; i += 4)
+        cv::v_store(dst + i, cv::v_muladd(cv::v_load(src + i), va, cv::v_load(dst + i)));
+#endif
+    for (; i < n; i++)
+        dst[i] += a * src[i];
+}
+
+// rows [startRow, endRow) of tmp, src filtered with tapsX along the rows
+inline void sepFilterRowsX(const float *src, float *tmp, int width, int radius,
+                           const std::vector<Tap> &tapsX, bool replicate,
+                           int startRow, int endRow)
+{
+    std::vector<float> padded(width + 2 * radius);
+    for (int y = startRow; y < endRow; y++)
+    {
+        const float *in = src + (size_t)y * width;
+        for (int x = -radius; x < width + radius; x++)
+            padded[x + radius] = in[(x >= 0 && x < width) ? x : borderIndex(x, width, replicate)];
+        float *out = tmp + (size_t)y * width;
+        std::fill(out, out + width, 0.0f);
+        for (size_t k = 0; k < tapsX.size(); k++)
+            addScaled(out, &padded[radius + tapsX[k].offset], tapsX[k].weight, width);
+    }
+}
+
+// rows [startRow, endRow) of dst, tmp filtered with tapsY along the columns
+inline void sepFilterRowsY(const float *tmp, float *dst, int width, int height,
+                           const std::vector<Tap> &tapsY, bool replicate,
+                           int startRow, int endRow)
+{
+    for (int y = startRow; y < endRow; y++)
+    {
+        float *out = dst + (size_t)y * width;
+        std::fill(out, out + width, 0.0f);
+        for (size_t k = 0; k < tapsY.size(); k++)
+        {
+            const int yy = borderIndex(y + tapsY[k].offset, height, replicate);
+            addScaled(out, tmp + (size_t)yy * width, tapsY[k].weight, width);
+        }
+    }
+}
+
+// dst = src filtered with tapsX along the rows and tapsY along the columns,
+// as cv::sepFilter2D with BORDER_REPLICATE or BORDER_REFLECT_101. tmp holds
+// the result of the first pass.
+inline void sepFilter(const float *src, float *dst, int width, int height,
+                      const std::vector<Tap> &tapsX, const std::vector<Tap> &tapsY,
+                      bool replicate, bool parallel, std::vector<float> &tmp)
+{
+    int radius = 0;
+    for (size_t k = 0; k < tapsX.size(); k++)
+        radius = std::max(radius, std::abs(tapsX[k].offset));
+    tmp.resize((size_t)width * height);
+
+    float *t = tmp.empty() ? NULL : &tmp[0];
+
+#ifdef PARALLEL
+    forRows(height, parallel, [&](int startRow, int endRow) {
+        sepFilterRowsX(src, t, width, radius, tapsX, replicate, startRow, endRow);
+    });
+    forRows(height, parallel, [&](int startRow, int endRow) {
+        sepFilterRowsY(t, dst, width, height, tapsY, replicate, startRow, endRow);
+    });
+#else
+    (void)parallel;
+    sepFilterRowsX(src, t, width, radius, tapsX, replicate, 0, height);
+    sepFilterRowsY(t, dst, width, height, tapsY, replicate, 0, height);
+#endif
+}
+
+// Conductance of the gradient (lx, ly) of n pixels, k the contrast factor
+inline void conductance(const float *lx, const float *ly, float *g, int n,
+                        int diffusivity, float k)
+{
+    const float inv = 1.0f / (k * k);
+    int i = 0;
+#if CV_SIMD128
+    const cv::v_float32x4 vinv = cv::v_setall_f32(inv);
+    const cv::v_float32x4 one = cv::v_setall_f32(1.0f);
+    for (; i <= n - 4; i += 4)
+    {
+        const cv::v_float32x4 vx = cv::v_load(lx + i);
+        const cv::v_float32x4 vy = cv::v_load(ly + i);
+        const cv::v_float32x4 t = cv::v_muladd(vx, vx, vy * vy) * vinv;
+        // the exponentials of g1 and Weickert are taken below
+        cv::v_store(g + i, (diffusivity == DIFF_PM_G2) ? one / (one + t) : t);
+    }
+    if (diffusivity == DIFF_PM_G2)
+    {
+        for (; i < n; i++)
+            g[i] = 1.0f / (1.0f + (lx[i] * lx[i] + ly[i] * ly[i]) * inv);
+        return;
+    }
+#endif
+    for (; i < n; i++)
+        g[i] = (lx[i] * lx[i] + ly[i] * ly[i]) * inv;
+    for (i = 0; i < n; i++)
+    {
+        const float t = g[i];
+        if (diffusivity == DIFF_PM_G1)
+            g[i] = std::exp(-t);
+        else if (diffusivity == DIFF_PM_G2)
+            g[i] = 1.0f / (1.0f + t);
+        else
+            g[i] = 1.0f - std::exp(-3.315f / (t * t * t * t));
+    }
+}
+
+// One explicit step of nld_step_scalar on a row of n pixels: out = halfTau
+// times the divergence of c*grad(L), with no flux across the border. up and
+// down are the rows above and below, or the row itself at the border, which
+// makes their flux zero.
+inline void diffusionStepRow(const float *L, const float *c,
+                             const float *Lup, const float *cup,
+                             const float *Ldown, const float *cdown,
+                             float *out, int n, float halfTau)
+{
+    if (n == 1)
+    {
+        out[0] = halfTau * ((c[0] + cdown[0]) * (Ldown[0] - L[0]) -
+                            (cup[0] + c[0]) * (L[0] - Lup[0]));
+        return;
+    }
+    out[0] = halfTau * ((c[0] + c[1]) * (L[1] - L[0]) +
+                        (c[0] + cdown[0]) * (Ldown[0] - L[0]) -
+                        (cup[0] + c[0]) * (L[0] - Lup[0]));
+    int i = 1;
+#if CV_SIMD128
+    const cv::v_float32x4 vh = cv::v_setall_f32(halfTau);
+    for (; i <= n - 5; i += 4)
+    {
+        const cv::v_float32x4 l = cv::v_load(L + i);
+        const cv::v_float32x4 cc = cv::v_load(c + i);
+        const cv::v_float32x4 xpos = (cc + cv::v_load(c + i + 1)) * (cv::v_load(L + i + 1) - l);
+        const cv::v_float32x4 xneg = (cv::v_load(c + i - 1) + cc) * (l - cv::v_load(L + i - 1));
+        const cv::v_float32x4 ypos = (cc + cv::v_load(cdown + i)) * (cv::v_load(Ldown + i) - l);
+        const cv::v_float32x4 yneg = (cv::v_load(cup + i) + cc) * (l - cv::v_load(Lup + i));
+        cv::v_store(out + i, vh * ((xpos - xneg) + (ypos - yneg)));
+    }
+#endif
+    for (; i < n - 1; i++)
+    {
+        const float xpos = (c[i] + c[i + 1]) * (L[i + 1] - L[i]);
+        const float xneg = (c[i - 1] + c[i]) * (L[i] - L[i - 1]);
+        const float ypos = (c[i] + cdown[i]) * (Ldown[i] - L[i]);
+        const float yneg = (cup[i] + c[i]) * (L[i] - Lup[i]);
+        out[i] = halfTau * ((xpos - xneg) + (ypos - yneg));
+    }
+    const int e = n - 1;
+    out[e] = halfTau * (-(c[e - 1] + c[e]) * (L[e] - L[e - 1]) +
+                        (c[e] + cdown[e]) * (Ldown[e] - L[e]) -
+                        (cup[e] + c[e]) * (L[e] - Lup[e]));
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// Fast Explicit Diffusion step sizes of fed.cpp
+//////////////////////////////////////////////////////////////////////////////
+
+inline bool fedIsPrime(int number)
+{
+    if (number <= 1)
+        return false;
+    if (number == 2 || number == 3 || number == 5 || number == 7)
+        return true;
+    if (number % 2 == 0 || number % 3 == 0 || number % 5 == 0 || number % 7 == 0)
+        return false;
+    const int upperLimit = (int)std::sqrt(number + 1.0);
+    for (int divisor = 11; divisor <= upperLimit; divisor += 2)
+    {
+        if (number % divisor == 0)
+            return false;
+    }
+    return true;
+}
+
+// Step sizes of the FED cycle reaching time t with steps of at most tauMax
+// stability, in the reordered sequence of fed_tau_by_cycle_time
+inline void fedTauByCycleTime(float t, float tauMax, std::vector<float> &tau)
+{
+    tau.clear();
+    const int n = (int)(std::ceil(std::sqrt(3.0f * t / tauMax + 0.25f) - 0.5f - 1.0e-8f) + 0.5f);
+    if (n <= 0)
+        return;
+    const float scale = 3.0f * t / (tauMax * (float)(n * (n + 1)));
+    const float c = 1.0f / (4.0f * (float)n + 2.0f);
+    const float d = scale * tauMax / 2.0f;
+    std::vector<float> tauh(n);
+    for (int k = 0; k < n; k++)
+    {
+        const float h = std::cos((float)CV_PI * (2.0f * (float)k + 1.0f) * c);
+        tauh[k] = d / (h * h);
+    }
+    // the permutation of fed_tau_internal is not defined for a single step
+    if (n == 1)
+    {
+        tau = tauh;
+        return;
+    }
+    const int kappa = n / 2;
+    int prime = n + 1;
+    while (!fedIsPrime(prime))
+        prime++;
+    tau.resize(n);
+    for (int k = 0, l = 0; l < n; ++k, ++l)
+    {
+        int index;
+        while ((index = ((k + 1) * kappa) % prime - 1) >= n)
+            k++;
+        tau[l] = tauh[index];
+    }
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// Descriptor helpers of KAZEFeatures.cpp
+//////////////////////////////////////////////////////////////////////////////
+
+inline float gaussianWeight(float x, float y, float sigma)
+{
+    return std::exp(-(x * x + y * y) / (2.0f * sigma * sigma));
+}
+
+// Angle of (x, y) in [0, 2*pi), NaN for (0, 0) as getAngle
+inline float getAngle(float x, float y)
+{
+    if (x >= 0 && y >= 0)
+        return std::atan(y / x);
+    if (x < 0 && y >= 0)
+        return (float)CV_PI - std::atan(-y / x);
+    if (x < 0 && y < 0)
+        return (float)CV_PI + std::atan(y / x);
+    if (x >= 0 && y < 0)
+        return (float)(2.0 * CV_PI) - std::atan(-y / x);
+    return 0;
+}
+
+inline int fRound(float v)
+{
+    return (int)(v + (v >= 0 ? 0.5f : -0.5f));
+}
+
+class KazeFeatures
+{
+public:
+    KazeFeatures() : mWidth(0), mHeight(0), mContrast(0) {}
+
+    // Keypoints of the nRows-by-nCols image, as KAZE::detect
+    void detect(const uint8_T *img, int nRows, int nCols, const KazeParams &params,
+                std::vector<KazeKeypoint> &keypoints)
+    {
+        setup(img, nRows, nCols, params);
+        computeDerivatives(true);
+        findExtrema(keypoints);
+        refineExtrema(keypoints);
+    }
+
+    // Orientations, unless upright, and descriptors of the keypoints of
+    // the image, as KAZE::compute. The descriptor of keypoint i is
+    // descriptors[i*descriptorSize(), ...].
+    void compute(const uint8_T *img, int nRows, int nCols, const KazeParams &params,
+                 std::vector<KazeKeypoint> &keypoints, std::vector<float> &descriptors)
+    {
+        setup(img, nRows, nCols, params);
+        computeDerivatives(false);
+        describe(keypoints, descriptors);
+    }
+
+    // Detection and description on one scale space, as KAZE::detectAndCompute
+    void detectAndCompute(const uint8_T *img, int nRows, int nCols, const KazeParams &params,
+                          std::vector<KazeKeypoint> &keypoints, std::vector<float> &descriptors)
+    {
+        setup(img, nRows, nCols, params);
+        computeDerivatives(true);
+        findExtrema(keypoints);
+        refineExtrema(keypoints);
+        describe(keypoints, descriptors);
+    }
+
+    int descriptorSize() const
+    {
+        return mParams.extended ? 128 : 64;
+    }
+
+    int numLevels() const
+    {
+        return (int)mLevels.size();
+    }
+
+private:
+    struct EvolutionLevel
+    {
+        float esigma;
+        float etime;
+        int sigmaSize;
+        int octave;
+        int sublevel;
+        std::vector<float> Lsmooth, Lx, Ly, Ldet;
+    };
+
+    // Evolution levels and their FED cycles, as Allocate_Memory_Evolution,
+    // and the scale space of the image
+    void setup(const uint8_T *img, int nRows, int nCols, const KazeParams &params)
+    {
+        mParams = params;
+        mParams.numOctaves = std::max(mParams.numOctaves, 1);
+        mParams.numScaleLevels = std::max(mParams.numScaleLevels, 1);
+        mWidth = nCols;
+        mHeight = nRows;
+
+        mLevels.resize((size_t)mParams.numOctaves * mParams.numScaleLevels);
+        for (int i = 0; i < mParams.numOctaves; i++)
+        {
+            for (int j = 0; j < mParams.numScaleLevels; j++)
+            {
+                EvolutionLevel &level = mLevels[(size_t)i * mParams.numScaleLevels + j];
+                level.esigma = KAZE_SIGMA_OFFSET *
+                    std::pow(2.0f, (float)j / (float)mParams.numScaleLevels + i);
+                level.etime = 0.5f * level.esigma * level.esigma;
+                level.sigmaSize = fRound(level.esigma);
+                level.octave = i;
+                level.sublevel = j;
+            }
+        }
+        mSteps.resize(mLevels.size() > 0 ? mLevels.size() - 1 : 0);
+        for (size_t i = 1; i < mLevels.size(); i++)
+            fedTauByCycleTime(mLevels[i].etime - mLevels[i - 1].etime, KAZE_FED_TAU_MAX, mSteps[i - 1]);
+
+        createScaleSpace(img);
+    }
+
+    // Create_Nonlinear_Scale_Space. Only the smoothed image of each level
+    // is kept; the derivatives are taken from it afterwards.
+    void createScaleSpace(const uint8_T *img)
+    {
+        const int w = mWidth, h = mHeight;
+        const size_t numPixels = (size_t)w * h;
+        mLt.resize(numPixels);
+        mFlow.resize(numPixels);
+        mStep.resize(numPixels);
+        mGx.resize(numPixels);
+        mGy.resize(numPixels);
+
+#ifdef PARALLEL
+        forRows(h, true, [&](int startRow, int endRow) {
+            convertRows(img, startRow, endRow);
+        });
+#else
+        convertRows(img, 0, h);
+#endif
+
+        std::vector<Tap> gaussOffset, gaussDerivatives, scharrDeriv, scharrSmooth;
+        gaussianTaps(KAZE_SIGMA_OFFSET, gaussOffset);
+        gaussianTaps(KAZE_SIGMA_DERIVATIVES, gaussDerivatives);
+        // the unnormalized Scharr kernels of cv::Scharr
+        scharrDeriv.resize(2);
+        scharrDeriv[0].offset = -1; scharrDeriv[0].weight = -1.0f;
+        scharrDeriv[1].offset = 1;  scharrDeriv[1].weight = 1.0f;
+        scharrSmooth.resize(3);
+        scharrSmooth[0].offset = -1; scharrSmooth[0].weight = 3.0f;
+        scharrSmooth[1].offset = 0;  scharrSmooth[1].weight = 10.0f;
+        scharrSmooth[2].offset = 1;  scharrSmooth[2].weight = 3.0f;
+
+        sepFilter(&mStep[0], &mLt[0], w, h, gaussOffset, gaussOffset, true, true, mTmp);
+        mLevels[0].Lsmooth.resize(numPixels);
+        sepFilter(&mLt[0], &mLevels[0].Lsmooth[0], w, h, gaussDerivatives, gaussDerivatives, true, true, mTmp);
+        sepFilter(&mLevels[0].Lsmooth[0], &mGx[0], w, h, scharrDeriv, scharrSmooth, false, true, mTmp);
+        sepFilter(&mLevels[0].Lsmooth[0], &mGy[0], w, h, scharrSmooth, scharrDeriv, false, true, mTmp);
+        mContrast = contrastFactor();
+
+        for (size_t i = 1; i < mLevels.size(); i++)
+        {
+            EvolutionLevel &level = mLevels[i];
+            level.Lsmooth.resize(numPixels);
+            sepFilter(&mLt[0], &level.Lsmooth[0], w, h, gaussDerivatives, gaussDerivatives, true, true, mTmp);
+            sepFilter(&level.Lsmooth[0], &mGx[0], w, h, scharrDeriv, scharrSmooth, false, true, mTmp);
+            sepFilter(&level.Lsmooth[0], &mGy[0], w, h, scharrSmooth, scharrDeriv, false, true, mTmp);
+
+#ifdef PARALLEL
+            forRows(h, true, [&](int startRow, int endRow) {
+                conductanceRows(startRow, endRow);
+            });
+#else
+            conductanceRows(0, h);
+#endif
+
+            const std::vector<float> &tau = mSteps[i - 1];
+            for (size_t j = 0; j < tau.size(); j++)
+                diffusionStep(0.5f * tau[j]);
+        }
+    }
+
+    // rows [startRow, endRow) of mStep, the column major uint8 image img
+    // as row major float in [0 1]
+    void convertRows(const uint8_T *img, int startRow, int endRow)
+    {
+        const int w = mWidth, h = mHeight;
+        for (int y = startRow; y < endRow; y++)
+            for (int x = 0; x < w; x++)
+                mStep[(size_t)y * w + x] = img[y + (size_t)x * h] * (1.0f / 255.0f);
+    }
+
+    // rows [startRow, endRow) of the conductance mFlow of mGx and mGy
+    void conductanceRows(int startRow, int endRow)
+    {
+        const size_t first = (size_t)startRow * mWidth;
+        conductance(&mGx[first], &mGy[first], &mFlow[first],
+                    (endRow - startRow) * mWidth, mParams.diffusivity, mContrast);
+    }
+
+    // Lt += halfTau*div(c*grad(Lt)), from the Lt of before the step
+    void diffusionStep(float halfTau)
+    {
+#ifdef PARALLEL
+        forRows(mHeight, true, [&](int startRow, int endRow) {
+            diffusionRows(halfTau, startRow, endRow);
+        });
+        forRows(mHeight, true, [&](int startRow, int endRow) {
+            applyStepRows(startRow, endRow);
+        });
+#else
+        diffusionRows(halfTau, 0, mHeight);
+        applyStepRows(0, mHeight);
+#endif
+    }
+
+    // rows [startRow, endRow) of the step mStep of diffusionStep
+    void diffusionRows(float halfTau, int startRow, int endRow)
+    {
+        const int w = mWidth, h = mHeight;
+        for (int y = startRow; y < endRow; y++)
+        {
+            const size_t row = (size_t)y * w;
+            const size_t up = (y > 0) ? row - w : row;
+            const size_t down = (y < h - 1) ? row + w : row;
+            diffusionStepRow(&mLt[row], &mFlow[row], &mLt[up], &mFlow[up],
+                             &mLt[down], &mFlow[down], &mStep[row], w, halfTau);
+        }
+    }
+
+    // rows [startRow, endRow) of Lt += mStep
+    void applyStepRows(int startRow, int endRow)
+    {
+        const size_t first = (size_t)startRow * mWidth;
+        addScaled(&mLt[first], &mStep[first], 1.0f, (endRow - startRow) * mWidth);
+    }
+
+    // compute_k_percentile on the gradient of the smoothed first level, in
+    // mGx and mGy. A flat image has no contrast; it gets the 0.03 of
+    // OpenCV for too few gradients instead of a zero factor.
+    float contrastFactor() const
+    {
+        const int w = mWidth, h = mHeight;
+        const int nbins = KAZE_CONTRAST_NUM_BINS;
+        float hmax = 0.0f;
+        for (int y = 1; y < h - 1; y++)
+        {
+            for (int x = 1; x < w - 1; x++)
+            {
+                const size_t i = (size_t)y * w + x;
+                hmax = std::max(hmax, std::sqrt(mGx[i] * mGx[i] + mGy[i] * mGy[i]));
+            }
+        }
+        std::vector<int> hist(nbins, 0);
+        int npoints = 0;
+        for (int y = 1; y < h - 1; y++)
+        {
+            for (int x = 1; x < w - 1; x++)
+            {
+                const size_t i = (size_t)y * w + x;
+                const float modg = std::sqrt(mGx[i] * mGx[i] + mGy[i] * mGy[i]);
+                if (modg != 0.0f)
+                {
+                    int nbin = (int)std::floor(nbins * (modg / hmax));
+                    if (nbin == nbins)
+                        nbin--;
+                    hist[nbin]++;
+                    npoints++;
+                }
+            }
+        }
+        const int nthreshold = (int)(npoints * KAZE_CONTRAST_PERCENTILE);
+        int nelements = 0, k = 0;
+        for (k = 0; nelements < nthreshold && k < nbins; k++)
+            nelements += hist[k];
+        const float kperc = (nelements < nthreshold) ? 0.03f : hmax * ((float)k / (float)nbins);
+        return (kperc > 0.0f) ? kperc : 0.03f;
+    }
+
+    // Compute_Multiscale_Derivatives and, when withResponse, the
+    // determinant of the Hessian of Compute_Detector_Response, one level
+    // per task. The smoothed images are released afterwards.
+    void computeDerivatives(bool withResponse)
+    {
+        const int numWorkers = std::max((int)cgGetNumThreads(), 1);
+        std::vector<std::vector<float> > scratch((size_t)numWorkers * 4);
+
+#ifdef PARALLEL
+        cgParallelForWorkers((int)mLevels.size(), [&](int worker, int i) {
+            computeLevelDerivatives(mLevels[i], withResponse, &scratch[4 * worker]);
+        });
+#else
+        for (size_t i = 0; i < mLevels.size(); i++)
+            computeLevelDerivatives(mLevels[i], withResponse, &scratch[0]);
+#endif
+    }
+
+    // derivatives of one level, with the 4 buffers of a worker
+    void computeLevelDerivatives(EvolutionLevel &level, bool withResponse,
+                                 std::vector<float> *scratch)
+    {
+        const int w = mWidth, h = mHeight;
+        const size_t numPixels = (size_t)w * h;
+        std::vector<float> &tmp = scratch[0];
+        std::vector<float> &Lxx = scratch[1];
+        std::vector<float> &Lxy = scratch[2];
+        std::vector<float> &Lyy = scratch[3];
+        std::vector<Tap> deriv, smooth;
+        scharrTaps(level.sigmaSize, true, deriv);
+        scharrTaps(level.sigmaSize, false, smooth);
+
+        level.Lx.resize(numPixels);
+        level.Ly.resize(numPixels);
+        sepFilter(&level.Lsmooth[0], &level.Lx[0], w, h, deriv, smooth, false, false, tmp);
+        sepFilter(&level.Lsmooth[0], &level.Ly[0], w, h, smooth, deriv, false, false, tmp);
+
+        const float s = (float)level.sigmaSize;
+        if (withResponse)
+        {
+            Lxx.resize(numPixels);
+            Lxy.resize(numPixels);
+            Lyy.resize(numPixels);
+            sepFilter(&level.Lx[0], &Lxx[0], w, h, deriv, smooth, false, false, tmp);
+            sepFilter(&level.Ly[0], &Lyy[0], w, h, smooth, deriv, false, false, tmp);
+            sepFilter(&level.Lx[0], &Lxy[0], w, h, smooth, deriv, false, false, tmp);
+            // of the derivatives scaled by s*s
+            const float s4 = s * s * s * s;
+            level.Ldet.resize(numPixels);
+            for (size_t k = 0; k < numPixels; k++)
+                level.Ldet[k] = s4 * (Lxx[k] * Lyy[k] - Lxy[k] * Lxy[k]);
+        }
+        for (size_t k = 0; k < numPixels; k++)
+        {
+            level.Lx[k] *= s;
+            level.Ly[k] *= s;
+        }
+        std::vector<float>().swap(level.Lsmooth);
+    }
+
+    // check_maximum_neighbourhood with dsize 1: no value of the 3x3
+    // neighborhood of (x, y) above value, (x, y) itself excluded unless
+    // withCenter
+    bool isMaximum(const std::vector<float> &Ldet, float value, int x, int y, bool withCenter) const
+    {
+        for (int i = y - 1; i <= y + 1; i++)
+        {
+            const float *row = &Ldet[(size_t)i * mWidth];
+            for (int j = x - 1; j <= x + 1; j++)
+            {
+                if (!withCenter && i == y && j == x)
+                    continue;
+                if (row[j] > value)
+                    return false;
+            }
+        }
+        return true;
+    }
+
+    // Determinant_Hessian: maxima above the threshold of each inner level,
+    // one level per task, in the order of the levels
+    void findExtrema(std::vector<KazeKeypoint> &keypoints) const
+    {
+        keypoints.clear();
+        const int numInner = (int)mLevels.size() - 2;
+        if (numInner <= 0 || mWidth < 3 || mHeight < 3)
+            return;
+        std::vector<std::vector<KazeKeypoint> > perLevel(numInner);
+
+#ifdef PARALLEL
+        cgParallelForWorkers(numInner, [&](int, int n) {
+            findLevelExtrema(n + 1, perLevel[n]);
+        });
+#else
+        for (int n = 0; n < numInner; n++)
+            findLevelExtrema(n + 1, perLevel[n]);
+#endif
+
+        for (int n = 0; n < numInner; n++)
+            keypoints.insert(keypoints.end(), perLevel[n].begin(), perLevel[n].end());
+    }
+
+    // maxima above the threshold of the inner level i
+    void findLevelExtrema(int i, std::vector<KazeKeypoint> &keypoints) const
+    {
+        const EvolutionLevel &level = mLevels[i];
+        for (int y = 1; y < mHeight - 1; y++)
+        {
+            const float *row = &level.Ldet[(size_t)y * mWidth];
+            for (int x = 1; x < mWidth - 1; x++)
+            {
+                const float value = row[x];
+                if (value > mParams.threshold && value >= row[x - 1] &&
+                    isMaximum(level.Ldet, value, x, y, false) &&
+                    isMaximum(mLevels[i - 1].Ldet, value, x, y, true) &&
+                    isMaximum(mLevels[i + 1].Ldet, value, x, y, true))
+                {
+                    KazeKeypoint kp;
+                    kp.x = (float)x;
+                    kp.y = (float)y;
+                    kp.response = std::fabs(value);
+                    kp.size = level.esigma;
+                    kp.octave = level.octave;
+                    kp.classId = i;
+                    // the sublevel until refineExtrema
+                    kp.angle = (float)level.sublevel;
+                    keypoints.push_back(kp);
+                }
+            }
+        }
+    }
+
+    // Do_Subpixel_Refinement: quadratic fit of the determinant in x, y and
+    // the level. Keypoints whose offset is over a pixel or a level are
+    // removed.
+    void refineExtrema(std::vector<KazeKeypoint> &keypoints) const
+    {
+        size_t numKept = 0;
+        for (size_t n = 0; n < keypoints.size(); n++)
+        {
+            KazeKeypoint kp = keypoints[n];
+            const int x = fRound(kp.x), y = fRound(kp.y), k = kp.classId;
+            const float *prev = &mLevels[k - 1].Ldet[0];
+            const float *cur = &mLevels[k].Ldet[0];
+            const float *next = &mLevels[k + 1].Ldet[0];
+            const size_t w = (size_t)mWidth;
+            const size_t i = (size_t)y * w + x;
+
+            const float Dx = 0.5f * (cur[i + 1] - cur[i - 1]);
+            const float Dy = 0.5f * (cur[i + w] - cur[i - w]);
+            const float Ds = 0.5f * (next[i] - prev[i]);
+            const float Dxx = cur[i + 1] + cur[i - 1] - 2.0f * cur[i];
+            const float Dyy = cur[i + w] + cur[i - w] - 2.0f * cur[i];
+            const float Dss = next[i] + prev[i] - 2.0f * cur[i];
+            const float Dxy = 0.25f * (cur[i + w + 1] + cur[i - w - 1]) -
+                              0.25f * (cur[i - w + 1] + cur[i + w - 1]);
+            const float Dxs = 0.25f * (next[i + 1] + prev[i - 1]) -
+                              0.25f * (next[i - 1] + prev[i + 1]);
+            const float Dys = 0.25f * (next[i + w] + prev[i - w]) -
+                              0.25f * (next[i - w] + prev[i + w]);
+
+            const cv::Matx33f A(Dxx, Dxy, Dxs,
+                                Dxy, Dyy, Dys,
+                                Dxs, Dys, Dss);
+            const cv::Vec3f b(-Dx, -Dy, -Ds);
+            const cv::Vec3f d = A.solve(b, cv::DECOMP_LU);
+
+            if (std::fabs(d[0]) <= 1.0f && std::fabs(d[1]) <= 1.0f && std::fabs(d[2]) <= 1.0f)
+            {
+                kp.x += d[0];
+                kp.y += d[1];
+                const float dsc = kp.octave + (kp.angle + d[2]) / (float)mParams.numScaleLevels;
+                // twice the sigma, as the size of the SURF keypoints of OpenCV
+                kp.size = 2.0f * KAZE_SIGMA_OFFSET * std::pow(2.0f, dsc);
+                kp.angle = 0.0f;
+                keypoints[numKept++] = kp;
+            }
+        }
+        keypoints.resize(numKept);
+    }
+
+    // Level of a keypoint that is not one of the scale space, as those of
+    // points of other detectors: the level whose sigma is closest to the
+    // radius of the keypoint
+    int levelOf(const KazeKeypoint &kp) const
+    {
+        if (kp.classId >= 0 && kp.classId < (int)mLevels.size())
+            return kp.classId;
+        int best = 0;
+        for (size_t i = 1; i < mLevels.size(); i++)
+        {
+            if (std::fabs(mLevels[i].esigma - 0.5f * kp.size) <
+                std::fabs(mLevels[best].esigma - 0.5f * kp.size))
+                best = (int)i;
+        }
+        return best;
+    }
+
+    // Feature_Description, in parallel over blocks of keypoints
+    void describe(std::vector<KazeKeypoint> &keypoints, std::vector<float> &descriptors) const
+    {
+        const int dsize = descriptorSize();
+        const int numKeypoints = (int)keypoints.size();
+        descriptors.assign((size_t)numKeypoints * dsize, 0.0f);
+        const int numBlocks = (numKeypoints + KAZE_KEYPOINTS_PER_BLOCK - 1) / KAZE_KEYPOINTS_PER_BLOCK;
+
+#ifdef PARALLEL
+        cgParallelForWorkers(numBlocks, [&](int, int b) {
+            describeBlock(b, keypoints, descriptors);
+        });
+#else
+        for (int b = 0; b < numBlocks; b++)
+            describeBlock(b, keypoints, descriptors);
+#endif
+    }
+
+    // orientation and descriptor of the keypoints of block b
+    void describeBlock(int b, std::vector<KazeKeypoint> &keypoints,
+                       std::vector<float> &descriptors) const
+    {
+        const int dsize = descriptorSize();
+        const int last = std::min((b + 1) * KAZE_KEYPOINTS_PER_BLOCK, (int)keypoints.size());
+        for (int n = b * KAZE_KEYPOINTS_PER_BLOCK; n < last; n++)
+        {
+            KazeKeypoint &kp = keypoints[n];
+            kp.classId = levelOf(kp);
+            if (mParams.upright)
+                kp.angle = 0.0f;
+            else
+                kp.angle = mainOrientation(kp);
+            describeKeypoint(kp, &descriptors[(size_t)n * dsize]);
+        }
+    }
+
+    // Compute_Main_Orientation: the direction of the largest sum of the
+    // Gaussian weighted first derivatives within a pi/3 sliding window,
+    // sampled on a circle of radius 6 times the scale
+    float mainOrientation(const KazeKeypoint &kp) const
+    {
+        const EvolutionLevel &level = mLevels[kp.classId];
+        const int s = fRound(kp.size / 2.0f);
+        float resX[109], resY[109], ang[109];
+        int idx = 0;
+        for (int i = -6; i <= 6; ++i)
+        {
+            for (int j = -6; j <= 6; ++j)
+            {
+                if (i * i + j * j >= 36)
+                    continue;
+                const int iy = fRound(kp.y + j * s);
+                const int ix = fRound(kp.x + i * s);
+                if (iy >= 0 && iy < mHeight && ix >= 0 && ix < mWidth)
+                {
+                    const float gweight = gaussianWeight(iy - kp.y, ix - kp.x, 2.5f * s);
+                    resX[idx] = gweight * level.Lx[(size_t)iy * mWidth + ix];
+                    resY[idx] = gweight * level.Ly[(size_t)iy * mWidth + ix];
+                }
+                else
+                {
+                    resX[idx] = 0.0f;
+                    resY[idx] = 0.0f;
+                }
+                ang[idx] = getAngle(resX[idx], resY[idx]);
+                ++idx;
+            }
+        }
+
+        const float twoPi = (float)(2.0 * CV_PI);
+        float maxNorm = 0.0f, angle = 0.0f;
+        for (float ang1 = 0; ang1 < twoPi; ang1 += 0.15f)
+        {
+            const float ang2 = (ang1 + (float)(CV_PI / 3.0) > twoPi) ?
+                ang1 - (float)(5.0 * CV_PI / 3.0) : ang1 + (float)(CV_PI / 3.0);
+            float sumX = 0.0f, sumY = 0.0f;
+            for (int k = 0; k < idx; ++k)
+            {
+                const float a = ang[k];
+                if ((ang1 < ang2 && ang1 < a && a < ang2) ||
+                    (ang2 < ang1 && ((a > 0 && a < ang2) || (a > ang1 && a < twoPi))))
+                {
+                    sumX += resX[k];
+                    sumY += resY[k];
+                }
+            }
+            if (sumX * sumX + sumY * sumY > maxNorm)
+            {
+                maxNorm = sumX * sumX + sumY * sumY;
+                angle = getAngle(sumX, sumY);
+            }
+        }
+        return angle;
+    }
+
+    // First derivatives of the level at (sampleX, sampleY), bilinear with
+    // the clamped corners of Get_KAZE_Descriptor_64
+    void sampleDerivatives(const EvolutionLevel &level, float sampleX, float sampleY,
+                           bool isUpright, float &rx, float &ry) const
+    {
+        // the rotated descriptors round the lower corner
+        int x1 = isUpright ? (int)(sampleX - 0.5f) : fRound(sampleX - 0.5f);
+        int y1 = isUpright ? (int)(sampleY - 0.5f) : fRound(sampleY - 0.5f);
+        x1 = std::min(std::max(x1, 0), mWidth - 1);
+        y1 = std::min(std::max(y1, 0), mHeight - 1);
+        const int x2 = std::min(std::max((int)(sampleX + 0.5f), 0), mWidth - 1);
+        const int y2 = std::min(std::max((int)(sampleY + 0.5f), 0), mHeight - 1);
+        const float fx = sampleX - x1, fy = sampleY - y1;
+
+        const size_t i11 = (size_t)y1 * mWidth + x1, i12 = (size_t)y1 * mWidth + x2;
+        const size_t i21 = (size_t)y2 * mWidth + x1, i22 = (size_t)y2 * mWidth + x2;
+        const float w11 = (1.0f - fx) * (1.0f - fy), w12 = fx * (1.0f - fy);
+        const float w21 = (1.0f - fx) * fy, w22 = fx * fy;
+        rx = w11 * level.Lx[i11] + w12 * level.Lx[i12] + w21 * level.Lx[i21] + w22 * level.Lx[i22];
+        ry = w11 * level.Ly[i11] + w12 * level.Ly[i12] + w21 * level.Ly[i21] + w22 * level.Ly[i22];
+    }
+
+    // The M-SURF descriptors of Get_KAZE_[Upright_]Descriptor_64 and _128:
+    // 4x4 overlapping subregions of 9x9 samples, scale pixels apart, over
+    // 24 times the scale. Subregions sum the Gaussian weighted derivatives
+    // and their absolute values, split by the sign of the other derivative
+    // for 128 elements, and are Gaussian weighted in turn.
+    void describeKeypoint(const KazeKeypoint &kp, float *desc) const
+    {
+        const EvolutionLevel &level = mLevels[kp.classId];
+        const bool isUpright = mParams.upright;
+        const bool isExtended = mParams.extended;
+        const int dsize = descriptorSize();
+        const int sampleStep = 5, patternSize = 12;
+        const float scale = (float)fRound(kp.size / 2.0f);
+        const float co = isUpright ? 1.0f : std::cos(kp.angle);
+        const float si = isUpright ? 0.0f : std::sin(kp.angle);
+        float len = 0.0f, cx = -0.5f;
+        int dcount = 0;
+
+        for (int i = -8; i < patternSize; i += 5)
+        {
+            const int i0 = i - 4;
+            float cy = -0.5f;
+            cx += 1.0f;
+            for (int j = -8; j < patternSize; j += 5)
+            {
+                const int j0 = j - 4;
+                cy += 1.0f;
+                const int ky = i0 + sampleStep, kx = j0 + sampleStep;
+                // center of the subregion
+                float xs, ys;
+                if (isUpright)
+                {
+                    xs = kp.x + kx * scale;
+                    ys = kp.y + ky * scale;
+                }
+                else
+                {
+                    xs = kp.x + (-kx * scale * si + ky * scale * co);
+                    ys = kp.y + (kx * scale * co + ky * scale * si);
+                }
+
+                // dx, dy, mdx, mdy, or their halves by sign for 128
+                float sums[8] = {0, 0, 0, 0, 0, 0, 0, 0};
+                for (int k = i0; k < i0 + 9; k++)
+                {
+                    for (int l = j0; l < j0 + 9; l++)
+                    {
+                        float sampleX, sampleY;
+                        if (isUpright)
+                        {
+                            sampleY = k * scale + kp.y;
+                            sampleX = l * scale + kp.x;
+                        }
+                        else
+                        {
+                            sampleY = kp.y + (l * scale * co + k * scale * si);
+                            sampleX = kp.x + (-l * scale * si + k * scale * co);
+                        }
+                        const float gauss = gaussianWeight(xs - sampleX, ys - sampleY, 2.5f * scale);
+                        float rx, ry;
+                        sampleDerivatives(level, sampleX, sampleY, isUpright, rx, ry);
+                        // derivatives on the rotated axes
+                        float dx, dy;
+                        if (isUpright)
+                        {
+                            dx = gauss * rx;
+                            dy = gauss * ry;
+                        }
+                        else
+                        {
+                            dy = gauss * (rx * co + ry * si);
+                            dx = gauss * (-rx * si + ry * co);
+                        }
+
+                        if (!isExtended)
+                        {
+                            sums[0] += dx;
+                            sums[1] += dy;
+                            sums[2] += std::fabs(dx);
+                            sums[3] += std::fabs(dy);
+                            continue;
+                        }
+                        if (dy >= 0.0f)
+                        {
+                            sums[0] += dx;
+                            sums[2] += std::fabs(dx);
+                        }
+                        else
+                        {
+                            sums[1] += dx;
+                            sums[3] += std::fabs(dx);
+                        }
+                        if (dx >= 0.0f)
+                        {
+                            sums[4] += dy;
+                            sums[6] += std::fabs(dy);
+                        }
+                        else
+                        {
+                            sums[5] += dy;
+                            sums[7] += std::fabs(dy);
+                        }
+                    }
+                }
+
+                const float gauss2 = gaussianWeight(cx - 2.0f, cy - 2.0f, 1.5f);
+                const int numSums = isExtended ? 8 : 4;
+                for (int m = 0; m < numSums; m++)
+                {
+                    desc[dcount++] = sums[m] * gauss2;
+                    len += sums[m] * sums[m] * gauss2 * gauss2;
+                }
+            }
+        }
+
+        // unit vector
+        len = std::sqrt(len);
+        if (len > 0.0f)
+        {
+            for (int m = 0; m < dsize; m++)
+                desc[m] /= len;
+        }
+    }
+
+    int mWidth, mHeight;
+    KazeParams mParams;
+    float mContrast;
+
+    std::vector<EvolutionLevel> mLevels;
+    std::vector<std::vector<float> > mSteps;
+
+    // current level, conductance, step and gradient of the evolution
+    std::vector<float> mLt, mFlow, mStep, mGx, mGy, mTmp;
+
+    // prevent copying
+    KazeFeatures(const KazeFeatures &);
+    KazeFeatures &operator=(const KazeFeatures &);
+};
+
+} // namespace kaze
+
+#endif
@@ -0,0 +1,150 @@
+//////////////////////////////////////////////////////////////////////////////
+// Read-only memory mapping of a file.
+//
+// Pages are shared between all processes that map the same file, so large
+// read-only databases (e.g. feature vocabularies) are kept once per node.
+//
+// Copyright 2016 The MathWorks, Inc.
+//
+//////////////////////////////////////////////////////////////////////////////
+#ifndef MW_MAPPED_FILE
+#define MW_MAPPED_FILE
+
+#include <algorithm>
+#include <cstddef>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace vision
+{
+
+class MappedFile
+{
+public:
+    MappedFile() : mData(NULL), mSize(0)
+#ifdef _WIN32
+        , mFile(INVALID_HANDLE_VALUE), mMapping(NULL)
+#endif
+    {}
+
+    ~MappedFile()
+    {
+        close();
+    }
+
+    // Maps the entire file read-only. Returns false on failure.
+    bool open(const char *filename)
+    {
+        close();
+#ifdef _WIN32
+        mFile = CreateFileA(filename, GENERIC_READ, FILE_SHARE_READ, NULL,
+                            OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+        if (mFile == INVALID_HANDLE_VALUE)
+            return false;
+
+        LARGE_INTEGER fileSize;
+        if (!GetFileSizeEx(mFile, &fileSize) || fileSize.QuadPart == 0)
+        {
+            close();
+            return false;
+        }
+        mSize = (size_t)fileSize.QuadPart;
+
+        mMapping = CreateFileMappingA(mFile, NULL, PAGE_READONLY, 0, 0, NULL);
+        if (mMapping == NULL)
+        {
+            close();
+            return false;
+        }
+        mData = (const unsigned char *)MapViewOfFile(mMapping, FILE_MAP_READ,
+                                                     0, 0, 0);
+        if (mData == NULL)
+        {
+            close();
+            return false;
+        }
+#else
+        int fd = ::open(filename, O_RDONLY);
+        if (fd < 0)
+            return false;
+
+        struct stat st;
+        if (fstat(fd, &st) != 0 || st.st_size == 0)
+        {
+            ::close(fd);
+            return false;
+        }
+        mSize = (size_t)st.st_size;
+
+        void *addr = mmap(NULL, mSize, PROT_READ, MAP_SHARED, fd, 0);
+        // the mapping stays valid after the descriptor is closed
+        ::close(fd);
+        if (addr == MAP_FAILED)
+        {
+            mSize = 0;
+            return false;
+        }
+        mData = (const unsigned char *)addr;
+#endif
+        return true;
+    }
+
+    void close()
+    {
+#ifdef _WIN32
+        if (mData)
+            UnmapViewOfFile(mData);
+        if (mMapping)
+            CloseHandle(mMapping);
+        if (mFile != INVALID_HANDLE_VALUE)
+            CloseHandle(mFile);
+        mMapping = NULL;
+        mFile = INVALID_HANDLE_VALUE;
+#else
+        if (mData)
+            munmap((void *)mData, mSize);
+#endif
+        mData = NULL;
+        mSize = 0;
+    }
+
+    // Exchanges the mappings of two objects
+    void swap(MappedFile &other)
+    {
+        std::swap(mData, other.mData);
+        std::swap(mSize, other.mSize);
+#ifdef _WIN32
+        std::swap(mFile, other.mFile);
+        std::swap(mMapping, other.mMapping);
+#endif
+    }
+
+    const unsigned char *data() const { return mData; }
+    size_t size() const { return mSize; }
+    bool isOpen() const { return mData != NULL; }
+
+private:
+    const unsigned char *mData;
+    size_t mSize;
+#ifdef _WIN32
+    HANDLE mFile;
+    HANDLE mMapping;
+#endif
+
+    // copying and assignment are disallowed
+    MappedFile(const MappedFile &);
+    MappedFile &operator=(const MappedFile &);
+};
+
+} // namespace vision
+#endif
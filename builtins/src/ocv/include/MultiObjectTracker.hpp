@@ -0,0 +1,446 @@
+//////////////////////////////////////////////////////////////////////////////
+// Multiple object tracking with one Kalman filter per track, as the tracks
+// of configureKalmanFilter, assignDetectionsToTracks and the track
+// maintenance of the motion-based multiple object tracking example.
+//
+// configureKalmanFilter makes every model block diagonal: each dimension of
+// the location has its own constant velocity or constant acceleration
+// filter, with a scalar measurement, and the same noise. The covariance
+// stays block diagonal, so a track of numDims dimensions is numDims
+// independent filters of 2 or 3 states. The filters of all the tracks are
+// kept structure of arrays, one array per state and per element of the
+// upper triangle of the covariance, and predict and correct run over all of
+// them at once, two lanes at a time with the 128-bit universal intrinsics of
+// OpenCV. The tracks without a detection are corrected with a zero gain.
+//
+// The cost of assigning a detection to a track is the distance of
+// vision.KalmanFilter, the Mahalanobis distance of the detection to the
+// predicted location plus the log of the determinant of the residual
+// covariance, and the assignment is that of AssignmentSolver.hpp.
+//
+// Copyright 2016 The MathWorks, Inc.
+//
+//////////////////////////////////////////////////////////////////////////////
+#ifndef MULTI_OBJECT_TRACKER
+#define MULTI_OBJECT_TRACKER
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include "opencv2/core.hpp"
+#include "opencv2/core/hal/intrin.hpp"
+#include "AssignmentSolver.hpp"
+
+namespace tracking
+{
+
+struct TrackerParams
+{
+    bool isConstantAcceleration; // else constant velocity
+    int numDims;                 // of the locations
+    // of configureKalmanFilter, per state of a dimension
+    double initialEstimateError[3];
+    double motionNoise[3];
+    double measurementNoise;
+    // of assignDetectionsToTracks, for tracks and detections
+    double costOfNonAssignment;
+    // a track is deleted when it is invisible for invisibleForTooLong
+    // frames in a row, or when younger than ageThreshold frames and
+    // visible in less than minVisibility of them
+    int invisibleForTooLong;
+    int ageThreshold;
+    double minVisibility;
+};
+
+//////////////////////////////////////////////////////////////////////////////
+// Loads, stores and constants of a lane type, double or v_float64x2
+//////////////////////////////////////////////////////////////////////////////
+template <typename V>
+struct Lanes;
+
+template <>
+struct Lanes<double>
+{
+    enum { width = 1 };
+    static double load(const double *p) { return *p; }
+    static void store(double *p, double v) { *p = v; }
+    static double splat(double v) { return v; }
+};
+
+#if CV_SIMD128_64F
+template <>
+struct Lanes<cv::v_float64x2>
+{
+    enum { width = 2 };
+    static cv::v_float64x2 load(const double *p) { return cv::v_load(p); }
+    static void store(double *p, const cv::v_float64x2 &v) { cv::v_store(p, v); }
+    static cv::v_float64x2 splat(double v) { return cv::v_setall_f64(v); }
+};
+#endif
+
+class MultiObjectTracker
+{
+public:
+    MultiObjectTracker() : mNextId(1)
+    {
+        mParams.isConstantAcceleration = false;
+        mParams.numDims = 2;
+        for (int k = 0; k < 3; k++)
+        {
+            mParams.initialEstimateError[k] = 1;
+            mParams.motionNoise[k] = 1;
+        }
+        mParams.measurementNoise = 1;
+        mParams.costOfNonAssignment = 20;
+        mParams.invisibleForTooLong = 20;
+        mParams.ageThreshold = 8;
+        mParams.minVisibility = 0.6;
+    }
+
+    // Also drops the tracks
+    void setParams(const TrackerParams &params)
+    {
+        mParams = params;
+        mParams.numDims = std::max(mParams.numDims, 1);
+        reset();
+    }
+
+    void reset()
+    {
+        mNextId = 1;
+        mIds.clear();
+        mAge.clear();
+        mTotalVisible.clear();
+        mConsecutiveInvisible.clear();
+        mAssignedDetection.clear();
+        for (int k = 0; k < 3; k++)
+            mX[k].clear();
+        for (int k = 0; k < 6; k++)
+            mP[k].clear();
+    }
+
+    // One frame: predicts the tracks, assigns the numDetections
+    // detections, numDetections-by-numDims column major, corrects the
+    // assigned tracks, deletes the lost ones and starts a track at each
+    // unassigned detection
+    void step(const double *detections, int numDetections)
+    {
+        predict();
+
+        const int numTracks = this->numTracks();
+        std::vector<int> detectionOfTrack;
+        if (numTracks > 0 && numDetections > 0)
+        {
+            computeCost(detections, numDetections);
+            std::vector<double> costTracks(numTracks, mParams.costOfNonAssignment);
+            std::vector<double> costDetections(numDetections, mParams.costOfNonAssignment);
+            mSolver.solve(&mCost[0], numTracks, numDetections, true,
+                          &costTracks[0], &costDetections[0], detectionOfTrack);
+        }
+        else
+        {
+            detectionOfTrack.assign(numTracks, -1);
+        }
+
+        correct(detections, numDetections, detectionOfTrack);
+
+        std::vector<char> isAssigned(numDetections, 0);
+        for (int t = 0; t < numTracks; t++)
+        {
+            mAge[t]++;
+            mAssignedDetection[t] = detectionOfTrack[t];
+            if (detectionOfTrack[t] >= 0)
+            {
+                isAssigned[detectionOfTrack[t]] = 1;
+                mTotalVisible[t]++;
+                mConsecutiveInvisible[t] = 0;
+            }
+            else
+            {
+                mConsecutiveInvisible[t]++;
+            }
+        }
+
+        deleteLostTracks();
+        for (int j = 0; j < numDetections; j++)
+        {
+            if (!isAssigned[j])
+                createTrack(detections, numDetections, j);
+        }
+    }
+
+    int numTracks() const
+    {
+        return (int)mIds.size();
+    }
+
+    int stateLength() const
+    {
+        return mParams.isConstantAcceleration ? 3 : 2;
+    }
+
+    const TrackerParams &params() const
+    {
+        return mParams;
+    }
+
+    // Track t: its id, age, counts of frames, and the detection of the last
+    // step, -1 for none
+    unsigned int id(int t) const { return mIds[t]; }
+    unsigned int age(int t) const { return mAge[t]; }
+    unsigned int totalVisibleCount(int t) const { return mTotalVisible[t]; }
+    unsigned int consecutiveInvisibleCount(int t) const { return mConsecutiveInvisible[t]; }
+    int assignedDetection(int t) const { return mAssignedDetection[t]; }
+
+    // State k of dimension d of track t, location, velocity or acceleration
+    double state(int t, int d, int k) const
+    {
+        return mX[k][(size_t)t * mParams.numDims + d];
+    }
+
+private:
+    // x = A*x, P = A*P*A' + Q on the filters [i, n), width at a time;
+    // returns where it stopped
+    template <typename V>
+    int predictRange(int i, int n)
+    {
+        typedef Lanes<V> L;
+        const V half = L::splat(0.5), two = L::splat(2.0);
+        const V q0 = L::splat(mParams.motionNoise[0]);
+        const V q1 = L::splat(mParams.motionNoise[1]);
+        const V q2 = L::splat(mParams.motionNoise[2]);
+        double *x0 = &mX[0][0], *x1 = &mX[1][0], *x2 = &mX[2][0];
+        double *p00 = &mP[0][0], *p01 = &mP[1][0], *p02 = &mP[2][0];
+        double *p11 = &mP[3][0], *p12 = &mP[4][0], *p22 = &mP[5][0];
+
+        for (; i + (int)L::width <= n; i += L::width)
+        {
+            const V a00 = L::load(p00 + i), a01 = L::load(p01 + i), a11 = L::load(p11 + i);
+            if (!mParams.isConstantAcceleration)
+            {
+                // A = [1 1; 0 1]
+                L::store(x0 + i, L::load(x0 + i) + L::load(x1 + i));
+                L::store(p00 + i, a00 + two * a01 + a11 + q0);
+                L::store(p01 + i, a01 + a11);
+                L::store(p11 + i, a11 + q1);
+                continue;
+            }
+            // A = [1 1 0.5; 0 1 1; 0 0 1], B = A*P
+            const V a02 = L::load(p02 + i), a12 = L::load(p12 + i), a22 = L::load(p22 + i);
+            const V v1 = L::load(x1 + i), v2 = L::load(x2 + i);
+            L::store(x0 + i, L::load(x0 + i) + v1 + half * v2);
+            L::store(x1 + i, v1 + v2);
+            const V b00 = a00 + a01 + half * a02;
+            const V b01 = a01 + a11 + half * a12;
+            const V b02 = a02 + a12 + half * a22;
+            const V b11 = a11 + a12;
+            const V b12 = a12 + a22;
+            L::store(p00 + i, b00 + b01 + half * b02 + q0);
+            L::store(p01 + i, b01 + b02);
+            L::store(p02 + i, b02);
+            L::store(p11 + i, b11 + b12 + q1);
+            L::store(p12 + i, b12);
+            L::store(p22 + i, a22 + q2);
+        }
+        return i;
+    }
+
+    void predict()
+    {
+        const int n = (int)mX[0].size();
+        if (n == 0)
+            return;
+        int i = 0;
+#if CV_SIMD128_64F
+        i = predictRange<cv::v_float64x2>(i, n);
+#endif
+        predictRange<double>(i, n);
+    }
+
+    // Kalman update with the measurements z of the filters [i, n), the
+    // gains scaled by w, 1 for the filters with a detection and 0 for the
+    // others
+    template <typename V>
+    int correctRange(int i, int n, const double *z, const double *w)
+    {
+        typedef Lanes<V> L;
+        const V r = L::splat(mParams.measurementNoise);
+        double *x0 = &mX[0][0], *x1 = &mX[1][0], *x2 = &mX[2][0];
+        double *p00 = &mP[0][0], *p01 = &mP[1][0], *p02 = &mP[2][0];
+        double *p11 = &mP[3][0], *p12 = &mP[4][0], *p22 = &mP[5][0];
+
+        for (; i + (int)L::width <= n; i += L::width)
+        {
+            const V a00 = L::load(p00 + i), a01 = L::load(p01 + i);
+            const V scale = L::load(w + i) / (a00 + r);
+            const V k0 = scale * a00, k1 = scale * a01;
+            const V y = L::load(z + i) - L::load(x0 + i);
+            L::store(x0 + i, L::load(x0 + i) + k0 * y);
+            L::store(x1 + i, L::load(x1 + i) + k1 * y);
+            L::store(p00 + i, a00 - k0 * a00);
+            L::store(p01 + i, a01 - k0 * a01);
+            L::store(p11 + i, L::load(p11 + i) - k1 * a01);
+            if (!mParams.isConstantAcceleration)
+                continue;
+            const V a02 = L::load(p02 + i);
+            const V k2 = scale * a02;
+            L::store(x2 + i, L::load(x2 + i) + k2 * y);
+            L::store(p02 + i, a02 - k0 * a02);
+            L::store(p12 + i, L::load(p12 + i) - k1 * a02);
+            L::store(p22 + i, L::load(p22 + i) - k2 * a02);
+        }
+        return i;
+    }
+
+    void correct(const double *detections, int numDetections,
+                 const std::vector<int> &detectionOfTrack)
+    {
+        const int numDims = mParams.numDims;
+        const int n = (int)mX[0].size();
+        if (n == 0)
+            return;
+        mZ.assign(n, 0.0);
+        mW.assign(n, 0.0);
+        for (int t = 0; t < (int)detectionOfTrack.size(); t++)
+        {
+            const int j = detectionOfTrack[t];
+            if (j < 0)
+                continue;
+            for (int d = 0; d < numDims; d++)
+            {
+                mZ[(size_t)t * numDims + d] = detections[j + (size_t)d * numDetections];
+                mW[(size_t)t * numDims + d] = 1.0;
+            }
+        }
+        int i = 0;
+#if CV_SIMD128_64F
+        i = correctRange<cv::v_float64x2>(i, n, &mZ[0], &mW[0]);
+#endif
+        correctRange<double>(i, n, &mZ[0], &mW[0]);
+    }
+
+    // mCost, numTracks-by-numDetections row major: the normalizedDistance
+    // of vision.KalmanFilter/distance of each detection to each track
+    void computeCost(const double *detections, int numDetections)
+    {
+        const int numDims = mParams.numDims;
+        const int numTracks = this->numTracks();
+        mCost.assign((size_t)numTracks * numDetections, 0.0);
+        for (int t = 0; t < numTracks; t++)
+        {
+            double *row = &mCost[(size_t)t * numDetections];
+            double logDet = 0;
+            for (int d = 0; d < numDims; d++)
+            {
+                const size_t f = (size_t)t * numDims + d;
+                const double s = mP[0][f] + mParams.measurementNoise;
+                const double mu = mX[0][f], invS = 1.0 / s;
+                const double *z = detections + (size_t)d * numDetections;
+                logDet += std::log(s);
+                int j = 0;
+#if CV_SIMD128_64F
+                const cv::v_float64x2 vmu = cv::v_setall_f64(mu), vinv = cv::v_setall_f64(invS);
+                for (; j <= numDetections - 2; j += 2)
+                {
+                    const cv::v_float64x2 e = cv::v_load(z + j) - vmu;
+                    cv::v_store(row + j, cv::v_muladd(e * e, vinv, cv::v_load(row + j)));
+                }
+#endif
+                for (; j < numDetections; j++)
+                {
+                    const double e = z[j] - mu;
+                    row[j] += e * e * invS;
+                }
+            }
+            for (int j = 0; j < numDetections; j++)
+                row[j] += logDet;
+        }
+    }
+
+    void deleteLostTracks()
+    {
+        const int numDims = mParams.numDims;
+        int numKept = 0;
+        for (int t = 0; t < numTracks(); t++)
+        {
+            const double visibility = (double)mTotalVisible[t] / (double)mAge[t];
+            const bool isLost = ((int)mAge[t] < mParams.ageThreshold && visibility < mParams.minVisibility) ||
+                                (int)mConsecutiveInvisible[t] >= mParams.invisibleForTooLong;
+            if (isLost)
+                continue;
+            if (numKept != t)
+            {
+                mIds[numKept] = mIds[t];
+                mAge[numKept] = mAge[t];
+                mTotalVisible[numKept] = mTotalVisible[t];
+                mConsecutiveInvisible[numKept] = mConsecutiveInvisible[t];
+                mAssignedDetection[numKept] = mAssignedDetection[t];
+                for (int d = 0; d < numDims; d++)
+                {
+                    const size_t from = (size_t)t * numDims + d, to = (size_t)numKept * numDims + d;
+                    for (int k = 0; k < 3; k++)
+                        mX[k][to] = mX[k][from];
+                    for (int k = 0; k < 6; k++)
+                        mP[k][to] = mP[k][from];
+                }
+            }
+            numKept++;
+        }
+        mIds.resize(numKept);
+        mAge.resize(numKept);
+        mTotalVisible.resize(numKept);
+        mConsecutiveInvisible.resize(numKept);
+        mAssignedDetection.resize(numKept);
+        for (int k = 0; k < 3; k++)
+            mX[k].resize((size_t)numKept * numDims);
+        for (int k = 0; k < 6; k++)
+            mP[k].resize((size_t)numKept * numDims);
+    }
+
+    // The filter of configureKalmanFilter at detection j
+    void createTrack(const double *detections, int numDetections, int j)
+    {
+        const int L = stateLength();
+        mIds.push_back(mNextId++);
+        mAge.push_back(1);
+        mTotalVisible.push_back(1);
+        mConsecutiveInvisible.push_back(0);
+        mAssignedDetection.push_back(j);
+        for (int d = 0; d < mParams.numDims; d++)
+        {
+            mX[0].push_back(detections[j + (size_t)d * numDetections]);
+            mX[1].push_back(0.0);
+            mX[2].push_back(0.0);
+            // diagonal initial covariance; p00, p11 and p22 are 0, 3 and 5
+            mP[0].push_back(mParams.initialEstimateError[0]);
+            mP[1].push_back(0.0);
+            mP[2].push_back(0.0);
+            mP[3].push_back(mParams.initialEstimateError[1]);
+            mP[4].push_back(0.0);
+            mP[5].push_back(L == 3 ? mParams.initialEstimateError[2] : 0.0);
+        }
+    }
+
+    TrackerParams mParams;
+    unsigned int mNextId;
+
+    std::vector<unsigned int> mIds, mAge, mTotalVisible, mConsecutiveInvisible;
+    std::vector<int> mAssignedDetection;
+
+    // states and upper triangle of the covariance, p00 p01 p02 p11 p12 p22,
+    // of filter t*numDims + d; the third state is unused at constant velocity
+    std::vector<double> mX[3];
+    std::vector<double> mP[6];
+
+    std::vector<double> mCost, mZ, mW;
+    assignment::AssignmentSolver mSolver;
+
+    // prevent copying
+    MultiObjectTracker(const MultiObjectTracker &);
+    MultiObjectTracker &operator=(const MultiObjectTracker &);
+};
+
+} // namespace tracking
+
+#endif
@@ -0,0 +1,299 @@
+//////////////////////////////////////////////////////////////////////////////
+// HOG people detection and cascade object detection on a CUDA device.
+//
+// HOGDescriptorCuda searches the scale levels of MWHOGDescriptor: the
+// levels come from MWHOGDescriptor::getLevelScales, each level image is the
+// input resized by 1/scale, and the detections are scaled back and merged
+// exactly as MWHOGDescriptor::detectMultiScale does, so both return the
+// same boxes in the same order. The results can still differ where the
+// CUDA HOG differs from the CPU one:
+//   - windows are only placed inside the image, while the CPU descriptor
+//     pads the image by 16 pixels and also places windows across its
+//     border;
+//   - the gradients of RGB images are taken on an RGBA copy, which gives
+//     the same maximum over the color channels;
+//   - the histograms are accumulated in a different order, so scores close
+//     to the classification threshold may fall on the other side.
+// The window stride must be a multiple of the block stride; other strides
+// run on the CPU descriptor of the same object.
+//
+// CascadeClassifierCuda runs cv::cuda::CascadeClassifier, which reads the
+// old Haar format and the LBP format of OpenCV cascades. It groups the
+// candidates as the CPU classifier does, with minNeighbors and an eps of
+// 0.2, but the candidates themselves come from a different image pyramid.
+//
+// Frames are staged in page-locked host memory and uploaded on the stream
+// of the detector, unless the caller passes the frame already on the
+// device. The level images and the detector buffers stay on the device from
+// frame to frame.
+//
+// Copyright 2016 The MathWorks, Inc.
+//
+//////////////////////////////////////////////////////////////////////////////
+#ifndef OBJECT_DETECTOR_CUDA
+#define OBJECT_DETECTOR_CUDA
+
+#include <string>
+#include <vector>
+
+#include "mwobjdetect.hpp" // for MWHOGDescriptor
+
+#include "opencv2/opencv_modules.hpp"
+#include "opencv2/core.hpp"
+#include "opencv2/imgproc.hpp"
+
+#if defined(HAVE_OPENCV_CUDAOBJDETECT) && defined(HAVE_OPENCV_CUDAWARPING)
+#include "opencv2/core/cuda.hpp"
+#include "CudaDevice.hpp"
+#include "opencv2/cudaobjdetect.hpp"
+#include "opencv2/cudawarping.hpp"
+#define OBJECT_DETECTOR_HAVE_CUDA
+#endif
+
+namespace objectDetector
+{
+
+// Returns true if device is a CUDA device the detectors can run on
+inline bool isCudaDevice(int device)
+{
+#if defined(OBJECT_DETECTOR_HAVE_CUDA)
+    return vision::isCudaDevice(device);
+#else
+    (void)device;
+    return false;
+#endif
+}
+
+#if defined(OBJECT_DETECTOR_HAVE_CUDA)
+
+class HOGDescriptorCuda
+{
+public:
+    // The stream and the buffers belong to the given device
+    explicit HOGDescriptorCuda(int device) : mDevice(vision::selectCudaDevice(device)) {}
+
+    int getDevice() const { return mDevice; }
+
+    // selects the people model as HOGDescriptor_setup does
+    void setup(int whichModel)
+    {
+        cv::cuda::setDevice(mDevice);
+
+        std::vector<float> detector;
+        if (whichModel == 1)
+        {
+            mHost.winSize = cv::Size(64, 128);
+            detector = cv::MWHOGDescriptor::getDefaultPeopleDetector();
+        }
+        else
+        {
+            mHost.winSize = cv::Size(48, 96);
+            detector = cv::MWHOGDescriptor::getDaimlerPeopleDetector();
+        }
+        mHost.setSVMDetector(detector);
+
+        mHog = cv::cuda::HOG::create(mHost.winSize, mHost.blockSize,
+            mHost.blockStride, mHost.cellSize, mHost.nbins);
+        mHog->setWinSigma(mHost.getWinSigma());
+        mHog->setL2HysThreshold(mHost.L2HysThreshold);
+        mHog->setGammaCorrection(mHost.gammaCorrection);
+        mHog->setSVMDetector(detector);
+    }
+
+    // true if windows placed winStride apart are searched on the device
+    bool isDeviceStride(cv::Size winStride) const
+    {
+        return winStride.width % mHost.blockStride.width == 0 &&
+               winStride.height % mHost.blockStride.height == 0;
+    }
+
+    // img is CV_8UC1 or CV_8UC3; the arguments are those of
+    // MWHOGDescriptor::detectMultiScale. deviceImg, if not NULL, is a
+    // CV_8UC1 image already on the device of the detector and is read
+    // instead of uploading img, which may then be empty if winStride is a
+    // device stride.
+    void detectMultiScale(const cv::Mat &img,
+        std::vector<cv::Rect> &foundLocations, std::vector<double> &foundWeights,
+        double hitThreshold, cv::Size winStride, cv::Size padding,
+        double scale0, double finalThreshold, bool useMeanshiftGrouping,
+        cv::Size minSize, cv::Size maxSize,
+        const cv::cuda::GpuMat *deviceImg = NULL)
+    {
+        if (!isDeviceStride(winStride))
+        {
+            mHost.detectMultiScale(img, foundLocations, foundWeights,
+                hitThreshold, winStride, padding, scale0, finalThreshold,
+                useMeanshiftGrouping, minSize, maxSize);
+            return;
+        }
+
+        foundLocations.clear();
+        foundWeights.clear();
+
+        const cv::Size imgSize = deviceImg ? deviceImg->size() : img.size();
+        std::vector<double> levelScale;
+        mHost.getLevelScales(imgSize, scale0, minSize, maxSize, levelScale);
+        if (levelScale.empty())
+        {
+            return;
+        }
+
+        cv::cuda::setDevice(mDevice);
+        const cv::cuda::GpuMat &frame = deviceImg ? *deviceImg : uploadFrame(img);
+
+        mHog->setHitThreshold(hitThreshold);
+        mHog->setWinStride(winStride);
+
+        std::vector<double> foundScales;
+        for (size_t i = 0; i < levelScale.size(); ++i)
+        {
+            const double scale = levelScale[i];
+            cv::Size levelSize(cvRound(imgSize.width / scale), cvRound(imgSize.height / scale));
+            const cv::cuda::GpuMat *levelImage = &frame;
+            if (levelSize != imgSize)
+            {
+                cv::cuda::resize(frame, mDeviceLevel, levelSize,
+                                 0, 0, cv::INTER_LINEAR, mStream);
+                levelImage = &mDeviceLevel;
+            }
+
+            // detect runs on the default stream
+            mStream.waitForCompletion();
+            mHog->detect(*levelImage, mLocations, &mConfidences);
+
+            cv::Size scaledWinSize(cvRound(mHost.winSize.width * scale),
+                                   cvRound(mHost.winSize.height * scale));
+            for (size_t j = 0; j < mLocations.size(); ++j)
+            {
+                foundLocations.push_back(cv::Rect(cvRound(mLocations[j].x * scale),
+                    cvRound(mLocations[j].y * scale),
+                    scaledWinSize.width, scaledWinSize.height));
+                foundWeights.push_back(mConfidences[j]);
+                foundScales.push_back(scale);
+            }
+        }
+
+        // the CPU descriptor either merges with mean shift or returns the
+        // detections unmerged
+        if (useMeanshiftGrouping)
+        {
+            cv::MWgroupRectangles_meanshift(foundLocations, foundWeights,
+                foundScales, finalThreshold, mHost.winSize);
+        }
+    }
+
+private:
+    // The CUDA HOG reads one or four channels: RGB frames are staged as
+    // RGBA. Returns the device frame.
+    const cv::cuda::GpuMat &uploadFrame(const cv::Mat &img)
+    {
+        const int type = (img.channels() == 3) ? CV_8UC4 : CV_8UC1;
+        mHostFrame.create(img.rows, img.cols, type);
+        cv::Mat staged = mHostFrame.createMatHeader();
+        if (img.channels() == 3)
+        {
+            cv::cvtColor(img, staged, cv::COLOR_RGB2RGBA);
+        }
+        else
+        {
+            img.copyTo(staged);
+        }
+        mDeviceFrame.upload(mHostFrame, mStream);
+        return mDeviceFrame;
+    }
+
+    // device index, selected before the stream is created
+    int mDevice;
+    cv::cuda::Stream mStream;
+
+    // model and level scales of the CPU detector
+    cv::MWHOGDescriptor mHost;
+    cv::Ptr<cv::cuda::HOG> mHog;
+
+    cv::cuda::HostMem mHostFrame;
+    cv::cuda::GpuMat mDeviceFrame;
+    cv::cuda::GpuMat mDeviceLevel;
+
+    // detections of one level
+    std::vector<cv::Point> mLocations;
+    std::vector<double> mConfidences;
+
+    // copying and assignment are disallowed
+    HOGDescriptorCuda(const HOGDescriptorCuda &);
+    HOGDescriptorCuda &operator=(const HOGDescriptorCuda &);
+};
+
+class CascadeClassifierCuda
+{
+public:
+    // The stream and the buffers belong to the given device
+    explicit CascadeClassifierCuda(int device) : mDevice(vision::selectCudaDevice(device)) {}
+
+    int getDevice() const { return mDevice; }
+
+    // false if the file is not a cascade the CUDA classifier can read
+    bool load(const std::string &filename)
+    {
+        cv::cuda::setDevice(mDevice);
+        try
+        {
+            mCascade = cv::cuda::CascadeClassifier::create(filename);
+        }
+        catch (const cv::Exception &)
+        {
+            mCascade.release();
+        }
+        return !mCascade.empty();
+    }
+
+    // img is CV_8UC1; minSize and maxSize of 0 do not limit the size.
+    // deviceImg, if not NULL, is img already on the device of the detector
+    // and is read instead of uploading img, which may then be empty.
+    void detectMultiScale(const cv::Mat &img, std::vector<cv::Rect> &objects,
+        double scaleFactor, int minNeighbors, cv::Size minSize, cv::Size maxSize,
+        const cv::cuda::GpuMat *deviceImg = NULL)
+    {
+        cv::cuda::setDevice(mDevice);
+
+        mCascade->setScaleFactor(scaleFactor);
+        mCascade->setMinNeighbors(minNeighbors);
+        mCascade->setMinObjectSize(minSize);
+        mCascade->setMaxObjectSize(maxSize);
+
+        const cv::cuda::GpuMat *frame = deviceImg;
+        if (!frame)
+        {
+            mHostFrame.create(img.rows, img.cols, CV_8UC1);
+            cv::Mat staged = mHostFrame.createMatHeader();
+            img.copyTo(staged);
+            mDeviceFrame.upload(mHostFrame, mStream);
+            frame = &mDeviceFrame;
+        }
+
+        mCascade->detectMultiScale(*frame, mDeviceObjects, mStream);
+        mStream.waitForCompletion();
+
+        mCascade->convert(mDeviceObjects, objects);
+    }
+
+private:
+    // device index, selected before the stream is created
+    int mDevice;
+    cv::cuda::Stream mStream;
+
+    cv::Ptr<cv::cuda::CascadeClassifier> mCascade;
+
+    cv::cuda::HostMem mHostFrame;
+    cv::cuda::GpuMat mDeviceFrame;
+    cv::cuda::GpuMat mDeviceObjects;
+
+    // copying and assignment are disallowed
+    CascadeClassifierCuda(const CascadeClassifierCuda &);
+    CascadeClassifierCuda &operator=(const CascadeClassifierCuda &);
+};
+
+#endif // OBJECT_DETECTOR_HAVE_CUDA
+
+} // namespace objectDetector
+
+#endif
@@ -0,0 +1,289 @@
+//////////////////////////////////////////////////////////////////////////////
+// Tesseract handles of ocr kept across calls, and recognition of many
+// regions of interest at once.
+//
+// The codegen path of ocr initializes a Tesseract handle through the
+// ocrutils library, recognizes one image and cleans the handle up, loading
+// the language data of tessdata on every call. The pool keeps one handle per
+// thread of the pool instead. A handle is created by the first recognition
+// it runs, with a NULL handle, and reused by the next ones; the language
+// data is only reloaded, with resetParameters, when the options change.
+//
+// The regions are cropped from the image and recognized in parallel, each
+// region by the handle of the worker running it. The text and metadata of
+// all regions are gathered in one result: the text of the regions one after
+// the other, and for each level of the metadata (characters, words, text
+// lines, paragraphs, blocks) the rows of the regions one after the other.
+// Bounding boxes are in the coordinates of the image; the indices of a
+// region, e.g. the word of a character, are 1-based within the region.
+//
+// Copyright 2016 The MathWorks, Inc.
+//
+//////////////////////////////////////////////////////////////////////////////
+#ifndef OCR_HANDLE_POOL
+#define OCR_HANDLE_POOL
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "vision_defines.h"
+#include "cgThreadPool.hpp"
+
+// Entry points of the ocrutils library, as the codegen path of ocr calls
+// them. Recognition returns the length of the UTF-8 text, or -1, -2 or -3
+// on failure; a NULL handle is initialized by the first call.
+EXTERN_C int32_T tesseractRecognizeTextUint8(void **tessAPI, const uint8_T *image,
+    char **utf8Text, int32_T width, int32_T height, const char *textLayout,
+    const char *characterSet, const char *tessdata, const char *lang,
+    boolean_T resetParameters);
+EXTERN_C int32_T tesseractRecognizeTextLogical(void **tessAPI, const boolean_T *image,
+    char **utf8Text, int32_T width, int32_T height, const char *textLayout,
+    const char *characterSet, const char *tessdata, const char *lang,
+    boolean_T resetParameters);
+EXTERN_C void collectMetadata(void *tessAPI, void **metadata, int32_T *numChars,
+    int32_T *numWords, int32_T *numTextlines, int32_T *numParagraphs, int32_T *numBlocks);
+EXTERN_C void copyMetadata(void *metadata,
+    real_T *charBBox, int32_T *charWordIndex, real32_T *charConfidence,
+    real_T *wordBBox, int32_T *wordTextLineIndex, real32_T *wordConfidence, int32_T *wordCharacterIndex,
+    real_T *textlineBBox, int32_T *textlineParagraphIndex, real32_T *textlineConfidence, int32_T *textlineCharacterIndex,
+    real_T *paragraphBBox, int32_T *paragraphBlockIndex, real32_T *paragraphConfidence, int32_T *paragraphCharacterIndex,
+    real_T *blockBBox, int32_T *blockPageIndex, real32_T *blockConfidence, int32_T *blockCharacterIndex);
+EXTERN_C int32_T getTextFromMetadata(void *metadata, char **text);
+EXTERN_C void copyTextAndCleanup(char *utf8Text, uint8_T *out, int32_T length);
+EXTERN_C void cleanupMetadata(void *metadata);
+EXTERN_C void cleanupTesseract(void *tessAPI);
+
+namespace ocr
+{
+
+// levels of the metadata
+enum { CHARACTER = 0, WORD, TEXTLINE, PARAGRAPH, BLOCK, NUM_LEVELS };
+
+struct OcrOptions
+{
+    std::string textLayout;
+    std::string characterSet;
+    std::string tessdata;
+    std::string lang;
+
+    bool operator==(const OcrOptions &other) const
+    {
+        return textLayout == other.textLayout && characterSet == other.characterSet &&
+               tessdata == other.tessdata && lang == other.lang;
+    }
+};
+
+// Metadata of one level of a region: bbox is count-by-4, column major,
+// parentIndex the 1-based index in the next level (the page for blocks),
+// and characterIndex count-by-2, column major, the first and last
+// characters. Characters have no characterIndex.
+struct OcrLevel
+{
+    int32_T count;
+    std::vector<double> bbox;
+    std::vector<int32_T> parentIndex;
+    std::vector<float> confidence;
+    std::vector<int32_T> characterIndex;
+
+    void resize(int32_T n, bool hasCharacterIndex)
+    {
+        count = n;
+        bbox.resize(4 * (size_t)n);
+        parentIndex.resize(n);
+        confidence.resize(n);
+        characterIndex.resize(hasCharacterIndex ? 2 * (size_t)n : 0);
+    }
+};
+
+// Recognition of one region. status is the length of the text or the
+// negative error code of ocrutils: -1 initialization, -2 memory, -3
+// internal.
+struct OcrRegion
+{
+    int32_T status;
+    std::vector<uint8_T> text;
+    std::vector<uint8_T> metadataText;
+    OcrLevel levels[NUM_LEVELS];
+};
+
+class OcrHandlePool
+{
+public:
+    OcrHandlePool() {}
+
+    ~OcrHandlePool()
+    {
+        for (size_t w = 0; w < mHandles.size(); w++)
+        {
+            if (mHandles[w])
+                cleanupTesseract(mHandles[w]);
+        }
+    }
+
+    // Options of the next recognitions. Handles created with other options
+    // reload the language data on their next use.
+    void setOptions(const OcrOptions &options)
+    {
+        if (options == mOptions)
+            return;
+        mOptions = options;
+        std::fill(mIsStale.begin(), mIsStale.end(), (char)1);
+    }
+
+    // Recognizes the numRois regions [x y width height] (1-based, rows of
+    // rois, column major) of image, numRows-by-numCols, column major unless
+    // isRowMajor. image is boolean_T when isLogical, uint8_T otherwise. No
+    // regions recognize the whole image.
+    void recognize(const void *image, int32_T numRows, int32_T numCols, bool isLogical,
+                   bool isRowMajor, const int32_T *rois, int32_T numRois,
+                   std::vector<OcrRegion> &regions)
+    {
+        const int numRegions = std::max((int)numRois, 1);
+        regions.resize(numRegions);
+
+        const size_t numWorkers = (size_t)std::max((int)cgGetNumThreads(), 1);
+        if (mHandles.size() < numWorkers)
+        {
+            mHandles.resize(numWorkers, (void *)NULL);
+            mIsStale.resize(numWorkers, (char)0);
+            mCrops.resize(numWorkers);
+        }
+
+#ifdef PARALLEL
+        cgParallelForWorkers(numRegions, [&](int w, int r) {
+            recognizeRoi(w, r, image, numRows, numCols, isLogical, isRowMajor, rois,
+                         numRois, regions);
+        });
+#else
+        for (int r = 0; r < numRegions; r++)
+            recognizeRoi(0, r, image, numRows, numCols, isLogical, isRowMajor, rois,
+                         numRois, regions);
+#endif
+    }
+
+private:
+    // Recognizes region r of rois, the whole image when there are none, on
+    // worker w
+    void recognizeRoi(int w, int r, const void *image, int32_T numRows, int32_T numCols,
+                      bool isLogical, bool isRowMajor, const int32_T *rois, int32_T numRois,
+                      std::vector<OcrRegion> &regions)
+    {
+        int32_T roi[4] = {1, 1, numCols, numRows};
+        if (numRois > 0)
+        {
+            for (int k = 0; k < 4; k++)
+                roi[k] = rois[r + k * numRois];
+        }
+        recognizeRegion(w, (const uint8_T *)image, numRows, numCols, isLogical,
+                        isRowMajor, roi, regions[r]);
+    }
+
+    // Crops roi into the column major buffer of worker w and runs it
+    // through the handle of w
+    void recognizeRegion(int w, const uint8_T *image, int32_T numRows, int32_T numCols,
+                         bool isLogical, bool isRowMajor, const int32_T *roi, OcrRegion &region)
+    {
+        const int32_T x0 = roi[0] - 1, y0 = roi[1] - 1;
+        const int32_T width = roi[2], height = roi[3];
+
+        std::vector<uint8_T> &crop = mCrops[w];
+        crop.resize((size_t)width * height);
+        for (int32_T c = 0; c < width; c++)
+        {
+            uint8_T *dst = &crop[(size_t)c * height];
+            if (isRowMajor)
+            {
+                for (int32_T r = 0; r < height; r++)
+                    dst[r] = image[(size_t)(y0 + r) * numCols + x0 + c];
+            }
+            else
+            {
+                const uint8_T *src = image + (size_t)(x0 + c) * numRows + y0;
+                std::copy(src, src + height, dst);
+            }
+        }
+
+        const boolean_T resetParameters = mIsStale[w] != 0;
+        mIsStale[w] = 0;
+
+        char *utf8Text = NULL;
+        if (isLogical)
+            region.status = tesseractRecognizeTextLogical(&mHandles[w], (boolean_T *)&crop[0],
+                &utf8Text, width, height, mOptions.textLayout.c_str(),
+                mOptions.characterSet.c_str(), mOptions.tessdata.c_str(),
+                mOptions.lang.c_str(), resetParameters);
+        else
+            region.status = tesseractRecognizeTextUint8(&mHandles[w], &crop[0],
+                &utf8Text, width, height, mOptions.textLayout.c_str(),
+                mOptions.characterSet.c_str(), mOptions.tessdata.c_str(),
+                mOptions.lang.c_str(), resetParameters);
+
+        if (region.status < 0)
+        {
+            region.text.clear();
+            region.metadataText.clear();
+            for (int l = 0; l < NUM_LEVELS; l++)
+                region.levels[l].resize(0, l != CHARACTER);
+            return;
+        }
+
+        void *metadata = NULL;
+        int32_T counts[NUM_LEVELS];
+        collectMetadata(mHandles[w], &metadata, &counts[CHARACTER], &counts[WORD],
+            &counts[TEXTLINE], &counts[PARAGRAPH], &counts[BLOCK]);
+        for (int l = 0; l < NUM_LEVELS; l++)
+            region.levels[l].resize(counts[l], l != CHARACTER);
+
+        OcrLevel *lv = region.levels;
+        copyMetadata(metadata,
+            data(lv[CHARACTER].bbox), data(lv[CHARACTER].parentIndex), data(lv[CHARACTER].confidence),
+            data(lv[WORD].bbox), data(lv[WORD].parentIndex), data(lv[WORD].confidence), data(lv[WORD].characterIndex),
+            data(lv[TEXTLINE].bbox), data(lv[TEXTLINE].parentIndex), data(lv[TEXTLINE].confidence), data(lv[TEXTLINE].characterIndex),
+            data(lv[PARAGRAPH].bbox), data(lv[PARAGRAPH].parentIndex), data(lv[PARAGRAPH].confidence), data(lv[PARAGRAPH].characterIndex),
+            data(lv[BLOCK].bbox), data(lv[BLOCK].parentIndex), data(lv[BLOCK].confidence), data(lv[BLOCK].characterIndex));
+
+        // from the region to the image
+        for (int l = 0; l < NUM_LEVELS; l++)
+        {
+            const int32_T n = lv[l].count;
+            for (int32_T i = 0; i < n; i++)
+            {
+                lv[l].bbox[i] += x0;
+                lv[l].bbox[i + n] += y0;
+            }
+        }
+
+        region.text.resize(region.status);
+        copyTextAndCleanup(utf8Text, data(region.text), region.status);
+
+        char *metadataText = NULL;
+        const int32_T length = getTextFromMetadata(metadata, &metadataText);
+        region.metadataText.resize(length);
+        copyTextAndCleanup(metadataText, data(region.metadataText), length);
+
+        cleanupMetadata(metadata);
+    }
+
+    template <typename T>
+    static T *data(std::vector<T> &v)
+    {
+        return v.empty() ? NULL : &v[0];
+    }
+
+    OcrOptions mOptions;
+
+    // per worker of the pool: handle, whether it must reload the language
+    // data, and buffer of the cropped region
+    std::vector<void *> mHandles;
+    std::vector<char> mIsStale;
+    std::vector<std::vector<uint8_T> > mCrops;
+
+    // prevent copying
+    OcrHandlePool(const OcrHandlePool &);
+    OcrHandlePool &operator=(const OcrHandlePool &);
+};
+
+} // namespace ocr
+
+#endif
@@ -0,0 +1,249 @@
+//////////////////////////////////////////////////////////////////////////////
+// Stateful Farneback optical flow on a CUDA device.
+//
+// The previous frame and the last flow field stay on the device, and the
+// last flow is the initial estimate of the next one, as in
+// OpticalFlowFarnebackOcv. Each frame is staged in page-locked host memory
+// and uploaded on its own stream, so that the upload of a frame overlaps
+// the flow computation of the frame before it:
+//
+//   submit(k+1)    upload k+1  ---------------->|
+//                                               | waits for the upload
+//   compute stream      ... flow of k ----------+--> flow of k+1 --> ...
+//   getFlow()           <- flow of k
+//
+// submit() only stages the frame and queues the work; getFlow() waits for
+// the oldest submitted frame and returns its flow. Up to two frames can be
+// in flight. The device frames form a ring of three, the frame being
+// uploaded and the two frames of the flow being computed, so that an upload
+// never waits for the flow of the frame before it.
+//
+// Copyright 2016 The MathWorks, Inc.
+//
+//////////////////////////////////////////////////////////////////////////////
+#ifndef OPTICAL_FLOW_FARNEBACK_CUDA
+#define OPTICAL_FLOW_FARNEBACK_CUDA
+
+#include <cstring>
+
+#include "opticalFlowFarnebackCore_api.hpp"
+
+#include "opencv2/opencv_modules.hpp"
+#include "opencv2/core.hpp"
+#include "opencv2/video/tracking.hpp"
+
+#if defined(HAVE_OPENCV_CUDAOPTFLOW)
+#include "opencv2/core/cuda.hpp"
+#include "CudaDevice.hpp"
+#include "opencv2/cudaoptflow.hpp"
+#define OPTICAL_FLOW_FARNEBACK_HAVE_CUDA
+#endif
+
+namespace opticalFlow
+{
+
+// Returns true if device is a CUDA device the flow can be computed on
+inline bool isCudaDevice(int device)
+{
+#if defined(OPTICAL_FLOW_FARNEBACK_HAVE_CUDA)
+    return vision::isCudaDevice(device);
+#else
+    (void)device;
+    return false;
+#endif
+}
+
+#if defined(OPTICAL_FLOW_FARNEBACK_HAVE_CUDA)
+
+class OpticalFlowFarnebackCuda
+{
+public:
+    // The streams and the buffers belong to the given device
+    explicit OpticalFlowFarnebackCuda(int device)
+        : mDevice(vision::selectCudaDevice(device)), mRows(0), mCols(0), mNumFrames(0),
+          mNumPending(0) {}
+
+    // Forgets the previous frame and flow. The next frame starts over.
+    void reset()
+    {
+        cv::cuda::setDevice(mDevice);
+        mComputeStream.waitForCompletion();
+        mUploadStream.waitForCompletion();
+        mNumFrames = 0;
+        mNumPending = 0;
+    }
+
+    int getDevice() const { return mDevice; }
+
+    // Queues the flow from the previous frame to frame, nRows-by-nCols in
+    // OpenCV order. The first frame, or a frame of a new size, gives zero
+    // flow. If two frames are already in flight, the flow of the oldest is
+    // discarded.
+    void submit(const uint8_T *frame, int nRows, int nCols,
+                const cvstFarnebackStruct_T *params)
+    {
+        cv::cuda::setDevice(mDevice);
+        const int hostIdx = beginFrame(nRows, nCols);
+
+        // The host buffers and events of frame k were last used by frame
+        // k-2. Its upload must be done before the staging buffer is
+        // overwritten, and its flow, the last to read the device frame of
+        // frame k, before the device frame is.
+        mUploaded[hostIdx].waitForCompletion();
+        cv::Mat staged = mHostFrames[hostIdx].createMatHeader();
+        std::memcpy(staged.data, frame, (size_t)nRows * nCols);
+
+        mUploadStream.waitEvent(mComputed[hostIdx]);
+        mDeviceFrames[mNumFrames % 3].upload(mHostFrames[hostIdx], mUploadStream);
+        mUploaded[hostIdx].record(mUploadStream);
+
+        queueFlow(hostIdx, params);
+    }
+
+    // submit() of a CV_8UC1 frame already on the device. The frame is
+    // copied on the device before submit() returns, so the caller may
+    // overwrite it afterwards.
+    void submit(const cv::cuda::GpuMat &frame, const cvstFarnebackStruct_T *params)
+    {
+        cv::cuda::setDevice(mDevice);
+        const int hostIdx = beginFrame(frame.rows, frame.cols);
+
+        mUploadStream.waitEvent(mComputed[hostIdx]);
+        frame.copyTo(mDeviceFrames[mNumFrames % 3], mUploadStream);
+        mUploaded[hostIdx].record(mUploadStream);
+        mUploaded[hostIdx].waitForCompletion();
+
+        queueFlow(hostIdx, params);
+    }
+
+    // Waits for the flow of the oldest frame in flight and returns it as a
+    // CV_32FC2 header into page-locked memory, valid until the next submit.
+    // Returns an empty header if no frame is in flight.
+    cv::Mat getFlow()
+    {
+        if (mNumPending == 0)
+        {
+            return cv::Mat();
+        }
+
+        cv::cuda::setDevice(mDevice);
+        const int hostIdx = (mNumFrames - mNumPending) % 2;
+        mComputed[hostIdx].waitForCompletion();
+        --mNumPending;
+        return mHostFlows[hostIdx].createMatHeader();
+    }
+
+private:
+    // Starts frame mNumFrames: reallocates for a new size and makes room
+    // for it in flight. Returns the index of its host buffers and events.
+    int beginFrame(int nRows, int nCols)
+    {
+        if (nRows != mRows || nCols != mCols)
+        {
+            reset();
+            allocate(nRows, nCols);
+        }
+        if (mNumPending == 2)
+        {
+            // the host buffers of the oldest frame are reused
+            --mNumPending;
+        }
+        return mNumFrames % 2;
+    }
+
+    // queues the flow to the device frame of frame mNumFrames once it is
+    // uploaded, and the download of the flow
+    void queueFlow(int hostIdx, const cvstFarnebackStruct_T *params)
+    {
+        mComputeStream.waitEvent(mUploaded[hostIdx]);
+        if (mNumFrames == 0)
+        {
+            mDeviceFlow.setTo(cv::Scalar::all(0), mComputeStream);
+        }
+        else
+        {
+            configure(params);
+            mFarneback->calc(mDeviceFrames[(mNumFrames + 2) % 3],
+                             mDeviceFrames[mNumFrames % 3], mDeviceFlow, mComputeStream);
+        }
+        mDeviceFlow.download(mHostFlows[hostIdx], mComputeStream);
+        mComputed[hostIdx].record(mComputeStream);
+
+        ++mNumFrames;
+        ++mNumPending;
+    }
+
+    void allocate(int nRows, int nCols)
+    {
+        mRows = nRows;
+        mCols = nCols;
+        for (int i = 0; i < 2; ++i)
+        {
+            mHostFrames[i].create(nRows, nCols, CV_8UC1);
+            mHostFlows[i].create(nRows, nCols, CV_32FC2);
+        }
+        for (int i = 0; i < 3; ++i)
+        {
+            mDeviceFrames[i].create(nRows, nCols, CV_8UC1);
+        }
+        mDeviceFlow.create(nRows, nCols, CV_32FC2);
+    }
+
+    // the parameters may change from frame to frame
+    void configure(const cvstFarnebackStruct_T *params)
+    {
+        const int flags = params->flags | cv::OPTFLOW_USE_INITIAL_FLOW;
+        if (mFarneback.empty())
+        {
+            mFarneback = cv::cuda::FarnebackOpticalFlow::create(params->levels,
+                params->pyr_scale, false, params->winsize, params->iterations,
+                params->poly_n, params->poly_sigma, flags);
+            return;
+        }
+        mFarneback->setNumLevels(params->levels);
+        mFarneback->setPyrScale(params->pyr_scale);
+        mFarneback->setWinSize(params->winsize);
+        mFarneback->setNumIters(params->iterations);
+        mFarneback->setPolyN(params->poly_n);
+        mFarneback->setPolySigma(params->poly_sigma);
+        mFarneback->setFlags(flags);
+    }
+
+    // device index, selected before the streams are created
+    int mDevice;
+    cv::cuda::Stream mUploadStream;
+    cv::cuda::Stream mComputeStream;
+
+    cv::Ptr<cv::cuda::FarnebackOpticalFlow> mFarneback;
+
+    int mRows;
+    int mCols;
+
+    // frames submitted since the last reset
+    int mNumFrames;
+
+    // frames in flight, the last ones submitted
+    int mNumPending;
+
+    // page-locked frames of the even and odd frames, and the ring of
+    // device frames
+    cv::cuda::HostMem mHostFrames[2];
+    cv::cuda::Event mUploaded[2];
+    cv::cuda::GpuMat mDeviceFrames[3];
+
+    // last flow on the device, and page-locked copies of the flows of the
+    // even and odd frames
+    cv::cuda::GpuMat mDeviceFlow;
+    cv::cuda::HostMem mHostFlows[2];
+    cv::cuda::Event mComputed[2];
+
+    // copying and assignment are disallowed
+    OpticalFlowFarnebackCuda(const OpticalFlowFarnebackCuda &);
+    OpticalFlowFarnebackCuda &operator=(const OpticalFlowFarnebackCuda &);
+};
+
+#endif // OPTICAL_FLOW_FARNEBACK_HAVE_CUDA
+
+} // namespace opticalFlow
+
+#endif
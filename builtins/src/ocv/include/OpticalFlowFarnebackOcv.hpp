@@ -0,0 +1,286 @@
+//////////////////////////////////////////////////////////////////////////////
+// Stateful Farneback optical flow.
+//
+// The previous frame and the last flow field are kept across calls to
+// step(). Each step only receives the current frame, and the last flow is
+// used as the initial estimate (OPTFLOW_USE_INITIAL_FLOW), which lets video
+// converge with fewer pyramid levels and iterations. Once the frame size is
+// fixed, stepping does not reallocate the frame or flow buffers.
+//
+// The flow can also be computed on a CUDA device, see
+// OpticalFlowFarnebackCuda.hpp. submit() and getFlow() split a step so that
+// the caller can prepare the next frame while the flow is computed; on the
+// CPU, submit() computes the flow and getFlow() returns it.
+//
+// Copyright 2016 The MathWorks, Inc.
+//
+//////////////////////////////////////////////////////////////////////////////
+#ifndef OPTICAL_FLOW_FARNEBACK_OCV
+#define OPTICAL_FLOW_FARNEBACK_OCV
+
+#include <algorithm>
+
+#include "opticalFlowFarnebackCore_api.hpp"
+#include "cgCommon.hpp"
+#include "OpticalFlowFarnebackCuda.hpp"
+#include "ImageHandle.hpp"
+#include "cgProfile.hpp"
+
+#include "opencv2/video/tracking.hpp"
+
+namespace opticalFlow
+{
+
+//////////////////////////////////////////////////////////////////////////////
+// Convert a flow field in the layout written by cArrayFromMat (column major
+// planes in reverse channel order) to an OpenCV CV_32FC2 matrix
+//////////////////////////////////////////////////////////////////////////////
+inline void flowToMat(const real32_T *inFlowXY, int nRows, int nCols,
+                      cv::Mat &flow)
+{
+    flow.create(nRows, nCols, CV_32FC2);
+    vision::transposePlanarToInterleaved<real32_T>(inFlowXY, (size_t)nRows,
+        (size_t)nRows*nCols, (real32_T *)flow.data, (size_t)nCols*2,
+        nRows, nCols, 2);
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// Row major counterpart of flowToMat: the channels of each pixel are
+// interleaved in reverse order, as written by cArrayFromMat_RowMaj
+//////////////////////////////////////////////////////////////////////////////
+inline void flowToMat_RowMaj(const real32_T *inFlowXY, int nRows, int nCols,
+                             cv::Mat &flow)
+{
+    flow.create(nRows, nCols, CV_32FC2);
+    real32_T *dst = (real32_T *)flow.data;
+    const int numPixels = nRows*nCols;
+    for (int ij = 0; ij < numPixels; ++ij)
+    {
+        dst[2*ij]     = inFlowXY[2*ij + 1];
+        dst[2*ij + 1] = inFlowXY[2*ij];
+    }
+}
+
+class OpticalFlowFarnebackOcv
+{
+public:
+    // device is the index of the CUDA device that computes the flow, or -1
+    // for the CPU. Without such a device, the flow is computed on the CPU.
+    explicit OpticalFlowFarnebackOcv(int device = -1)
+        : mNumPending(0)
+    {
+#if defined(OPTICAL_FLOW_FARNEBACK_HAVE_CUDA)
+        if (isCudaDevice(device))
+        {
+            mCuda = cv::makePtr<OpticalFlowFarnebackCuda>(device);
+        }
+#else
+        (void)device;
+#endif
+    }
+
+    // returns true if the flow is computed on a CUDA device
+    bool isOnDevice() const
+    {
+#if defined(OPTICAL_FLOW_FARNEBACK_HAVE_CUDA)
+        return !mCuda.empty();
+#else
+        return false;
+#endif
+    }
+
+    // Forgets the previous frame and flow. The next step() starts over.
+    void reset()
+    {
+#if defined(OPTICAL_FLOW_FARNEBACK_HAVE_CUDA)
+        if (!mCuda.empty())
+        {
+            mCuda->reset();
+        }
+#endif
+        mPrevFrame.release();
+        mFlow.release();
+        mNumPending = 0;
+    }
+
+    // Computes the flow from the previous frame to frame. frame is
+    // nRows-by-nCols in OpenCV order (the caller transposes column major
+    // images). The first frame, or a frame of a new size, only sets the
+    // previous frame and gives zero flow.
+    void step(const uint8_T *frame, int nRows, int nCols,
+              const cvstFarnebackStruct_T *params, real32_T *outFlowXY,
+              bool isRowMajor)
+    {
+        // the flows of frames in flight are discarded
+#if defined(OPTICAL_FLOW_FARNEBACK_HAVE_CUDA)
+        if (!mCuda.empty())
+        {
+            mCuda->submit(frame, nRows, nCols, params);
+            copyFlow(getLatestFlow(), outFlowXY, isRowMajor);
+            return;
+        }
+#endif
+        compute(frame, nRows, nCols, params);
+        copyFlow(mFlow, outFlowXY, isRowMajor);
+        mNumPending = 0;
+    }
+
+    // Queues the flow to frame, as step() computes it. Up to two frames can
+    // be in flight; the flow of the oldest is discarded by a third submit.
+    void submit(const uint8_T *frame, int nRows, int nCols,
+                const cvstFarnebackStruct_T *params)
+    {
+#if defined(OPTICAL_FLOW_FARNEBACK_HAVE_CUDA)
+        if (!mCuda.empty())
+        {
+            mCuda->submit(frame, nRows, nCols, params);
+            return;
+        }
+#endif
+        compute(frame, nRows, nCols, params);
+
+        // keep the flows of the frames in flight, oldest first
+        if (mNumPending == 2)
+        {
+            std::swap(mPendingFlows[0], mPendingFlows[1]);
+            --mNumPending;
+        }
+        mFlow.copyTo(mPendingFlows[mNumPending]);
+        ++mNumPending;
+    }
+
+    // step() and submit() on a shared image, with the flow in the layout of
+    // the image. The frame is read on the device when the image has a copy
+    // on the device of the flow.
+    void step(vision::ImageHandle &image, const cvstFarnebackStruct_T *params,
+              real32_T *outFlowXY)
+    {
+#if defined(OPTICAL_FLOW_FARNEBACK_HAVE_CUDA)
+        if (!mCuda.empty())
+        {
+            submit(image, params);
+            copyFlow(getLatestFlow(), outFlowXY, image.isRowMajor());
+            return;
+        }
+#endif
+        const cv::Mat &frame = image.getStored();
+        step(frame.data, frame.rows, frame.cols, params, outFlowXY,
+             image.isRowMajor());
+    }
+
+    void submit(vision::ImageHandle &image, const cvstFarnebackStruct_T *params)
+    {
+#if defined(OPTICAL_FLOW_FARNEBACK_HAVE_CUDA) && defined(IMAGE_HANDLE_HAVE_CUDA)
+        if (!mCuda.empty() && image.getDevice() == mCuda->getDevice())
+        {
+            mCuda->submit(image.getDeviceStored(), params);
+            return;
+        }
+#endif
+        const cv::Mat &frame = image.getStored();
+        submit(frame.data, frame.rows, frame.cols, params);
+    }
+
+    // Writes the flow of the oldest frame in flight to outFlowXY. Returns
+    // false, without writing, if no frame is in flight.
+    bool getFlow(real32_T *outFlowXY, bool isRowMajor)
+    {
+#if defined(OPTICAL_FLOW_FARNEBACK_HAVE_CUDA)
+        if (!mCuda.empty())
+        {
+            cv::Mat flow = mCuda->getFlow();
+            if (flow.empty())
+            {
+                return false;
+            }
+            copyFlow(flow, outFlowXY, isRowMajor);
+            return true;
+        }
+#endif
+        if (mNumPending == 0)
+        {
+            return false;
+        }
+        copyFlow(mPendingFlows[0], outFlowXY, isRowMajor);
+        std::swap(mPendingFlows[0], mPendingFlows[1]);
+        --mNumPending;
+        return true;
+    }
+
+    const cv::Mat &getFlow() const
+    {
+        return mFlow;
+    }
+
+private:
+#if defined(OPTICAL_FLOW_FARNEBACK_HAVE_CUDA)
+    // the flow of the last frame submitted; the flows of the frames before
+    // it are discarded
+    cv::Mat getLatestFlow()
+    {
+        cv::Mat flow = mCuda->getFlow();
+        for (cv::Mat next = mCuda->getFlow(); !next.empty(); next = mCuda->getFlow())
+        {
+            flow = next;
+        }
+        return flow;
+    }
+#endif
+
+    static void copyFlow(const cv::Mat &flow, real32_T *outFlowXY, bool isRowMajor)
+    {
+        CG_PROFILE_PHASE(CG_PROFILE_OUTPUT);
+        if (isRowMajor)
+            cArrayFromMat_RowMaj<real32_T>(outFlowXY, flow);
+        else
+            cArrayFromMat<real32_T>(outFlowXY, flow);
+    }
+
+    // computes the flow to frame on the CPU
+    void compute(const uint8_T *frame, int nRows, int nCols,
+                 const cvstFarnebackStruct_T *params)
+    {
+        cv::Mat imgCurr = cv::Mat(nRows, nCols, CV_8UC1, (void *)frame);
+        CG_PROFILE_PHASE(CG_PROFILE_COMPUTE);
+
+        if (mPrevFrame.rows != nRows || mPrevFrame.cols != nCols)
+        {
+            imgCurr.copyTo(mPrevFrame);
+            mFlow.create(nRows, nCols, CV_32FC2);
+            mFlow.setTo(cv::Scalar::all(0));
+        }
+        else
+        {
+            // the last flow is the initial estimate
+            cv::calcOpticalFlowFarneback(mPrevFrame, imgCurr, mFlow,
+                params->pyr_scale, params->levels, params->winsize,
+                params->iterations, params->poly_n, params->poly_sigma,
+                params->flags | cv::OPTFLOW_USE_INITIAL_FLOW);
+
+            // same size and type: copies without reallocating
+            imgCurr.copyTo(mPrevFrame);
+        }
+    }
+
+    // previous frame, owned
+    cv::Mat mPrevFrame;
+
+    // flow from the frame before mPrevFrame to mPrevFrame
+    cv::Mat mFlow;
+
+    // flows of the frames in flight between submit() and getFlow()
+    cv::Mat mPendingFlows[2];
+    int mNumPending;
+
+#if defined(OPTICAL_FLOW_FARNEBACK_HAVE_CUDA)
+    // device frames and flow, empty when computing on the CPU
+    cv::Ptr<OpticalFlowFarnebackCuda> mCuda;
+#endif
+
+    // copying and assignment are disallowed
+    OpticalFlowFarnebackOcv(const OpticalFlowFarnebackOcv &);
+    OpticalFlowFarnebackOcv &operator=(const OpticalFlowFarnebackOcv &);
+};
+
+} // namespace opticalFlow
+#endif
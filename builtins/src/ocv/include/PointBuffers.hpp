@@ -17,6 +17,8 @@ namespace pointTracker
 class  PointBuffers
 {
   public:
+    PointBuffers() : mNPoints(0) {}
+
     // copy ctor, operator=, destructor ok
 
     // point struct used by cvCalcOpticalFlowPyrLK
@@ -32,9 +34,28 @@ class  PointBuffers
     // copies validity flags from mxLogicalArray
     void setValidity(const uchar *validityData);
 
+    // pre-allocates the buffers for capacity points. The buffers are only
+    // reallocated when the number of points grows beyond their capacity.
+    void reservePoints(int capacity, bool useBidirectionalConstraint);
+
+    // replaces the points at the 1-based indices with the numPoints points
+    // of pointData and marks them valid. The other points are kept.
+    void replacePoints(int numPoints, const int32_T *indices,
+                       const float *pointData, bool isRowMajor);
+
+    // appends numPoints valid points after the current points
+    void appendPoints(int numPoints, const float *pointData, bool isRowMajor,
+                      bool useBidirectionalConstraint);
+
     void swap()
     {
         updateValidity();
+        swapBuffers();
+    }
+
+    // swaps the buffers without updating the validity
+    void swapBuffers()
+    {
         mPoints1.swap(mPoints2);
         mStatus1.swap(mStatus2);
     }
@@ -46,20 +67,42 @@ class  PointBuffers
     const std::vector<uchar> &getStatus1() const {return mStatus1;}
     std::vector<uchar> &getStatus2() {return mStatus2;}
     const std::vector<float> &getErr() const {return mErr;}
+    std::vector<float> &getErr() {return mErr;}
 
     // these functions are used for forward-backward error constraint
     std::vector<Point> &getTmpPoints() {return mTmpPoints;}
     std::vector<uchar> &getTmpStatus() {return mTmpStatus;}
     std::vector<float> &getTmpErr() {return mTmpErr;}
     void updateValidityForwardBackward(double maxBidirectionalErrorSq);
+    void updateValidityForwardBackward(double maxBidirectionalErrorSq,
+                                       int first, int last);
     void initializeValidity();
    
+    // bytes of the buffers of numPoints points
+    inline static double estimateMemory(int numPoints)
+    {
+        return (double)numPoints *
+            (3 * sizeof(Point) + 3 * sizeof(uchar) + 2 * sizeof(float));
+    }
+
   private:
     void updateValidity();
     
     // allocates buffers for point, validity, and scores
     void allocatePointBuffers(bool useBidirectionalConstraint);
 
+    // reads point i of the numPoints points of pointData, which is
+    // [numPoints 2] column major or row major, 1-based
+    inline static Point readPoint(const float *pointData, int i,
+                                  int numPoints, bool isRowMajor)
+    {
+        // pointData is assumed to come from Matlab, which is 1-based.
+        // Converting to 0-based coordinates.
+        if (isRowMajor)
+            return Point(pointData[2*i] - 1, pointData[2*i + 1] - 1);
+        return Point(pointData[i] - 1, pointData[i + numPoints] - 1);
+    }
+
     // computes the squared Euclidean distance between
     // two 2D points.
     inline static double distSq(const Point &p1, const Point &p2)
@@ -113,6 +156,53 @@ inline void PointBuffers::setPointsRM(int numPoints, const float *pointData,
 	}
 }
 
+///////////////////////////////////////////////////////////////////////////////
+inline void PointBuffers::reservePoints(int capacity, bool useBidirectionalConstraint)
+{
+    mPoints1.reserve(capacity);
+    mPoints2.reserve(capacity);
+    mStatus1.reserve(capacity);
+    mStatus2.reserve(capacity);
+    mErr.reserve(capacity);
+
+    if(useBidirectionalConstraint)
+    {
+        mTmpPoints.reserve(capacity);
+        mTmpStatus.reserve(capacity);
+        mTmpErr.reserve(capacity);
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+inline void PointBuffers::replacePoints(int numPoints, const int32_T *indices,
+                                        const float *pointData, bool isRowMajor)
+{
+    for(int i = 0; i < numPoints; ++i)
+    {
+        const int idx = indices[i] - 1;
+        if (idx < 0 || idx >= mNPoints)
+            continue;
+
+        mPoints1[idx] = readPoint(pointData, i, numPoints, isRowMajor);
+        mStatus1[idx] = (uchar)1;
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+inline void PointBuffers::appendPoints(int numPoints, const float *pointData,
+                                       bool isRowMajor,
+                                       bool useBidirectionalConstraint)
+{
+    const int first = mNPoints;
+    mNPoints += numPoints;
+    allocatePointBuffers(useBidirectionalConstraint);
+    for(int i = 0; i < numPoints; ++i)
+    {
+        mPoints1[first + i] = readPoint(pointData, i, numPoints, isRowMajor);
+        mStatus1[first + i] = (uchar)1;
+    }
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 inline void PointBuffers::allocatePointBuffers(bool useBidirectionalConstraint)
 {
@@ -157,11 +247,17 @@ inline void PointBuffers::updateValidity()
 
 ///////////////////////////////////////////////////////////////////////////////
 inline void PointBuffers::updateValidityForwardBackward(double maxBidirectionalErrorSq)
+{
+    updateValidityForwardBackward(maxBidirectionalErrorSq, 0, mNPoints);
+}
+
+inline void PointBuffers::updateValidityForwardBackward(double maxBidirectionalErrorSq,
+                                                        int first, int last)
 {
     // mark points that were lost during backward tracking,
     // or which did not pass the bidirectional constraint as
     // invalid.
-    for(int i = 0; i < mNPoints; ++i)
+    for(int i = first; i < last; ++i)
     {
         mStatus2[i] = mStatus2[i] && mTmpStatus[i] && 
             (distSq(mPoints1[i], mTmpPoints[i]) < 
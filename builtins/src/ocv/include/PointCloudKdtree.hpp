@@ -0,0 +1,472 @@
+//////////////////////////////////////////////////////////////////////////////
+// Exact kd-tree over the 3-D points of a point cloud, for the nearest
+// neighbor and radius searches of pointCloud, pcdenoise, pcnormals,
+// pcregrigid and pcfitplane.
+//
+// The tree is the single kd-tree of FLANN specialized for 3-D: a node splits
+// its points at the median of the dimension of largest extent, and keeps
+// the largest coordinate of its left points and the smallest of its right
+// ones. The search descends to the closest leaf first and visits the other
+// child of a node when the distance from the query to the box of that child,
+// updated one dimension at a time, is within the current radius [Arya 1993].
+//
+// The points are copied in the order of the leaves, one array per
+// coordinate, so a leaf is a contiguous bucket of at most
+// PCKDTREE_LEAF_SIZE points whose distances are computed with the 128-bit
+// universal intrinsics of OpenCV. Points with a NaN or infinite coordinate
+// are not indexed. Queries are searched in parallel with PARALLEL, the
+// results do not depend on the number of threads.
+//
+// Distances are squared Euclidean distances and indices are 1-based into
+// the points given to index().
+//
+// Copyright 2016 The MathWorks, Inc.
+//
+//////////////////////////////////////////////////////////////////////////////
+#ifndef POINT_CLOUD_KDTREE
+#define POINT_CLOUD_KDTREE
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <utility>
+#include <vector>
+
+#include "vision_defines.h"
+#include "opencv2/core.hpp"
+#include "opencv2/core/hal/intrin.hpp"
+#include "cgThreadPool.hpp"
+
+// maximum number of points of a leaf
+#define PCKDTREE_LEAF_SIZE 16
+// queries per block of the pool
+#define PCKDTREE_MIN_QUERIES_PER_BLOCK 64
+
+namespace pckdtree
+{
+
+#ifdef PARALLEL
+template <typename Fcn>
+inline void forRows(int numRows, Fcn fcn)
+{
+    cgParallelForRows(numRows, PCKDTREE_MIN_QUERIES_PER_BLOCK, fcn);
+}
+#endif
+
+// dist[i] = squared distance from q to point i of the bucket, i in [0, n)
+inline void bucketDistances(const float *x, const float *y, const float *z, int n,
+                            const float *q, float *dist)
+{
+    int i = 0;
+#if CV_SIMD128
+    const cv::v_float32x4 qx = cv::v_setall_f32(q[0]);
+    const cv::v_float32x4 qy = cv::v_setall_f32(q[1]);
+    const cv::v_float32x4 qz = cv::v_setall_f32(q[2]);
+    for (; i <= n - 4; i += 4)
+    {
+        const cv::v_float32x4 dx = cv::v_load(x + i) - qx;
+        const cv::v_float32x4 dy = cv::v_load(y + i) - qy;
+        const cv::v_float32x4 dz = cv::v_load(z + i) - qz;
+        cv::v_store(dist + i, dx * dx + dy * dy + dz * dz);
+    }
+#endif
+    for (; i < n; i++)
+    {
+        const float dx = x[i] - q[0], dy = y[i] - q[1], dz = z[i] - q[2];
+        dist[i] = dx * dx + dy * dy + dz * dz;
+    }
+}
+
+inline void bucketDistances(const double *x, const double *y, const double *z, int n,
+                            const double *q, double *dist)
+{
+    int i = 0;
+#if CV_SIMD128_64F
+    const cv::v_float64x2 qx = cv::v_setall_f64(q[0]);
+    const cv::v_float64x2 qy = cv::v_setall_f64(q[1]);
+    const cv::v_float64x2 qz = cv::v_setall_f64(q[2]);
+    for (; i <= n - 2; i += 2)
+    {
+        const cv::v_float64x2 dx = cv::v_load(x + i) - qx;
+        const cv::v_float64x2 dy = cv::v_load(y + i) - qy;
+        const cv::v_float64x2 dz = cv::v_load(z + i) - qz;
+        cv::v_store(dist + i, dx * dx + dy * dy + dz * dz);
+    }
+#endif
+    for (; i < n; i++)
+    {
+        const double dx = x[i] - q[0], dy = y[i] - q[1], dz = z[i] - q[2];
+        dist[i] = dx * dx + dy * dy + dz * dz;
+    }
+}
+
+// Neighbors found by a radius search: the squared distances and indices of
+// the neighbors of each query
+template <typename T>
+struct RadiusResult
+{
+    std::vector<std::vector<std::pair<T, uint32_T> > > neighbors;
+};
+
+template <typename T>
+class PointCloudKdtree
+{
+public:
+    PointCloudKdtree() {}
+
+    // Indexes numPoints-by-3 location, column major unless isRowMajor
+    void index(const T *location, int numPoints, bool isRowMajor)
+    {
+        mX.clear();
+        mY.clear();
+        mZ.clear();
+        mIndices.clear();
+        mNodes.clear();
+
+        std::vector<uint32_T> order;
+        order.reserve(numPoints);
+        std::vector<T> xyz;
+        xyz.reserve(3 * (size_t)numPoints);
+        for (int i = 0; i < numPoints; i++)
+        {
+            T p[3];
+            for (int d = 0; d < 3; d++)
+                p[d] = isRowMajor ? location[3 * (size_t)i + d]
+                                  : location[i + (size_t)d * numPoints];
+            if (!isFinite(p[0]) || !isFinite(p[1]) || !isFinite(p[2]))
+                continue;
+            order.push_back((uint32_T)i);
+            xyz.insert(xyz.end(), p, p + 3);
+        }
+
+        const int n = (int)order.size();
+        if (n == 0)
+            return;
+
+        // positions into xyz, reordered by the build into the leaves
+        std::vector<int> perm(n);
+        for (int i = 0; i < n; i++)
+            perm[i] = i;
+        mNodes.reserve(2 * (n / (PCKDTREE_LEAF_SIZE / 2) + 1));
+        divide(&perm[0], 0, n, xyz);
+
+        mX.resize(n);
+        mY.resize(n);
+        mZ.resize(n);
+        mIndices.resize(n);
+        for (int i = 0; i < n; i++)
+        {
+            const T *p = &xyz[3 * (size_t)perm[i]];
+            mX[i] = p[0];
+            mY[i] = p[1];
+            mZ[i] = p[2];
+            mIndices[i] = order[perm[i]] + 1;
+        }
+    }
+
+    int getNumPoints() const
+    {
+        return (int)mIndices.size();
+    }
+
+    // K nearest neighbors of numQueries-by-3 points, column major unless
+    // isRowMajor, nearest first. indices and dists are K-by-numQueries, in
+    // the same order as points; the neighbors of query q beyond valid[q]
+    // are 0. maxLeafChecks bounds the leaves visited per query once K
+    // neighbors are found, 0 for an exact search.
+    void knnSearch(const T *points, int numQueries, int K, int maxLeafChecks,
+                   bool isRowMajor, uint32_T *indices, T *dists, uint32_T *valid) const
+    {
+        if (K <= 0)
+        {
+            std::fill(valid, valid + numQueries, (uint32_T)0);
+            return;
+        }
+
+#ifdef PARALLEL
+        forRows(numQueries, [&](int begin, int end) {
+            knnSearchRows(points, numQueries, K, maxLeafChecks, isRowMajor,
+                          indices, dists, valid, begin, end);
+        });
+#else
+        knnSearchRows(points, numQueries, K, maxLeafChecks, isRowMajor,
+                      indices, dists, valid, 0, numQueries);
+#endif
+    }
+
+    // Neighbors within radius of numQueries-by-3 points, column major
+    // unless isRowMajor, sorted by distance when doSort.
+    void radiusSearch(const T *points, int numQueries, T radius, int maxLeafChecks,
+                      bool doSort, bool isRowMajor, RadiusResult<T> &result) const
+    {
+        result.neighbors.resize(numQueries);
+#ifdef PARALLEL
+        forRows(numQueries, [&](int begin, int end) {
+            radiusSearchRows(points, numQueries, radius, maxLeafChecks, doSort,
+                             isRowMajor, result, begin, end);
+        });
+#else
+        radiusSearchRows(points, numQueries, radius, maxLeafChecks, doSort,
+                         isRowMajor, result, 0, numQueries);
+#endif
+    }
+
+private:
+    // Internal node when left >= 0: points of left have coordinate dim
+    // at most low, points of right at least high. Leaf otherwise, of the
+    // points [begin, end).
+    struct Node
+    {
+        int left, right;
+        int begin, end;
+        int dim;
+        T low, high;
+    };
+
+    // K nearest neighbors found so far, nearest first
+    struct KnnResult
+    {
+        explicit KnnResult(int k) : K(k), count(0), indices(k), dists(k) {}
+
+        void clear() { count = 0; }
+
+        bool isFull() const { return count == K; }
+
+        T worstDist() const
+        {
+            return isFull() ? dists[K - 1] : std::numeric_limits<T>::max();
+        }
+
+        void add(T dist, uint32_T index)
+        {
+            if (count == K && dist >= dists[K - 1])
+                return;
+            int i = count < K ? count++ : K - 1;
+            for (; i > 0 && dists[i - 1] > dist; i--)
+            {
+                dists[i] = dists[i - 1];
+                indices[i] = indices[i - 1];
+            }
+            dists[i] = dist;
+            indices[i] = index;
+        }
+
+        int K;
+        int count;
+        std::vector<uint32_T> indices;
+        std::vector<T> dists;
+    };
+
+    struct RadiusCollector
+    {
+        RadiusCollector(T r2, std::vector<std::pair<T, uint32_T> > &n)
+            : radius2(r2), neighbors(n) {}
+
+        bool isFull() const { return true; }
+
+        T worstDist() const { return radius2; }
+
+        void add(T dist, uint32_T index)
+        {
+            if (dist <= radius2)
+                neighbors.push_back(std::make_pair(dist, index));
+        }
+
+        T radius2;
+        std::vector<std::pair<T, uint32_T> > &neighbors;
+    };
+
+    // Order of point indices by coordinate dim of xyz
+    struct CoordinateLess
+    {
+        CoordinateLess(const std::vector<T> &p, int d) : xyz(p), dim(d) {}
+
+        bool operator()(int a, int b) const
+        {
+            return xyz[3 * (size_t)a + dim] < xyz[3 * (size_t)b + dim];
+        }
+
+        const std::vector<T> &xyz;
+        int dim;
+    };
+
+    // knnSearch of the queries [begin, end)
+    void knnSearchRows(const T *points, int numQueries, int K, int maxLeafChecks,
+                       bool isRowMajor, uint32_T *indices, T *dists, uint32_T *valid,
+                       int begin, int end) const
+    {
+        KnnResult result(K);
+        for (int qi = begin; qi < end; qi++)
+        {
+            T q[3];
+            getQuery(points, numQueries, qi, isRowMajor, q);
+            result.clear();
+            search(q, result, maxLeafChecks);
+            valid[qi] = (uint32_T)result.count;
+            for (int k = 0; k < K; k++)
+            {
+                const size_t at = isRowMajor ? (size_t)k * numQueries + qi
+                                             : (size_t)qi * K + k;
+                indices[at] = k < result.count ? result.indices[k] : 0;
+                dists[at] = k < result.count ? result.dists[k] : 0;
+            }
+        }
+    }
+
+    // radiusSearch of the queries [begin, end)
+    void radiusSearchRows(const T *points, int numQueries, T radius, int maxLeafChecks,
+                          bool doSort, bool isRowMajor, RadiusResult<T> &result,
+                          int begin, int end) const
+    {
+        for (int qi = begin; qi < end; qi++)
+        {
+            T q[3];
+            getQuery(points, numQueries, qi, isRowMajor, q);
+            RadiusCollector collector(radius * radius, result.neighbors[qi]);
+            collector.neighbors.clear();
+            search(q, collector, maxLeafChecks);
+            if (doSort)
+                std::sort(collector.neighbors.begin(), collector.neighbors.end());
+        }
+    }
+
+    static bool isFinite(T v)
+    {
+        return v - v == 0;
+    }
+
+    static void getQuery(const T *points, int numQueries, int qi, bool isRowMajor, T *q)
+    {
+        for (int d = 0; d < 3; d++)
+            q[d] = isRowMajor ? points[3 * (size_t)qi + d] : points[qi + (size_t)d * numQueries];
+    }
+
+    // Builds the subtree of perm[begin, end) and returns its node
+    int divide(int *perm, int begin, int end, const std::vector<T> &xyz)
+    {
+        const int nodeIdx = (int)mNodes.size();
+        mNodes.push_back(Node());
+        Node node;
+        node.left = node.right = -1;
+        node.begin = begin;
+        node.end = end;
+        node.dim = 0;
+        node.low = node.high = 0;
+
+        if (end - begin > PCKDTREE_LEAF_SIZE)
+        {
+            T lo[3], hi[3];
+            for (int d = 0; d < 3; d++)
+                lo[d] = hi[d] = xyz[3 * (size_t)perm[begin] + d];
+            for (int i = begin + 1; i < end; i++)
+            {
+                const T *p = &xyz[3 * (size_t)perm[i]];
+                for (int d = 0; d < 3; d++)
+                {
+                    lo[d] = std::min(lo[d], p[d]);
+                    hi[d] = std::max(hi[d], p[d]);
+                }
+            }
+            int dim = 0;
+            for (int d = 1; d < 3; d++)
+            {
+                if (hi[d] - lo[d] > hi[dim] - lo[dim])
+                    dim = d;
+            }
+
+            // median split; ties go to either side, so low <= high
+            const int mid = begin + (end - begin) / 2;
+            std::nth_element(perm + begin, perm + mid, perm + end, CoordinateLess(xyz, dim));
+            T low = xyz[3 * (size_t)perm[begin] + dim];
+            for (int i = begin + 1; i < mid; i++)
+                low = std::max(low, xyz[3 * (size_t)perm[i] + dim]);
+
+            node.dim = dim;
+            node.low = low;
+            node.high = xyz[3 * (size_t)perm[mid] + dim];
+            node.left = divide(perm, begin, mid, xyz);
+            node.right = divide(perm, mid, end, xyz);
+        }
+        mNodes[nodeIdx] = node;
+        return nodeIdx;
+    }
+
+    template <typename Result>
+    void search(const T *q, Result &result, int maxLeafChecks) const
+    {
+        if (mNodes.empty())
+            return;
+        T offsets[3] = {0, 0, 0};
+        int leafChecks = 0;
+        searchLevel(0, q, 0, offsets, result, leafChecks, maxLeafChecks);
+    }
+
+    // mindist is the squared distance from q to the box of the node, of
+    // which offsets are the components
+    template <typename Result>
+    void searchLevel(int nodeIdx, const T *q, T mindist, T *offsets, Result &result,
+                     int &leafChecks, int maxLeafChecks) const
+    {
+        const Node &node = mNodes[nodeIdx];
+        if (node.left < 0)
+        {
+            if (maxLeafChecks > 0 && leafChecks >= maxLeafChecks && result.isFull())
+                return;
+            leafChecks++;
+
+            T dist[PCKDTREE_LEAF_SIZE];
+            const int n = node.end - node.begin;
+            bucketDistances(&mX[node.begin], &mY[node.begin], &mZ[node.begin], n, q, dist);
+            for (int i = 0; i < n; i++)
+            {
+                if (dist[i] <= result.worstDist())
+                    result.add(dist[i], mIndices[node.begin + i]);
+            }
+            return;
+        }
+
+        const T diffLow = q[node.dim] - node.low;
+        const T diffHigh = q[node.dim] - node.high;
+        int bestChild, otherChild;
+        T cut;
+        if (diffLow + diffHigh < 0)
+        {
+            bestChild = node.left;
+            otherChild = node.right;
+            cut = diffHigh;
+        }
+        else
+        {
+            bestChild = node.right;
+            otherChild = node.left;
+            cut = diffLow;
+        }
+
+        searchLevel(bestChild, q, mindist, offsets, result, leafChecks, maxLeafChecks);
+
+        const T saved = offsets[node.dim];
+        const T otherMindist = mindist + cut * cut - saved * saved;
+        if (otherMindist <= result.worstDist())
+        {
+            offsets[node.dim] = cut;
+            searchLevel(otherChild, q, otherMindist, offsets, result, leafChecks, maxLeafChecks);
+            offsets[node.dim] = saved;
+        }
+    }
+
+    // coordinates and 1-based indices of the points, in the order of the
+    // leaves
+    std::vector<T> mX, mY, mZ;
+    std::vector<uint32_T> mIndices;
+
+    // nodes, the root first
+    std::vector<Node> mNodes;
+
+    // prevent copying
+    PointCloudKdtree(const PointCloudKdtree &);
+    PointCloudKdtree &operator=(const PointCloudKdtree &);
+};
+
+} // namespace pckdtree
+
+#endif
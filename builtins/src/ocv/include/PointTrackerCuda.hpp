@@ -0,0 +1,208 @@
+//////////////////////////////////////////////////////////////////////////////
+// CUDA pyramidal Lucas-Kanade tracking for the PointTracker.
+//
+// The previous and the current frames stay on the device, so each step only
+// uploads the new frame and the points. Frames and points are staged in
+// page-locked host memory and all copies and both tracking passes are
+// queued on one stream, with a single wait at the end of the step.
+//
+// cv::cuda::SparsePyrLKOpticalFlow builds the pyramids of both frames into
+// its own device buffers on every call; these buffers are kept by the
+// tracker object and are not reallocated for a fixed frame size. It runs a
+// fixed number of iterations, so the epsilon of the termination criteria
+// is not used.
+//
+// Copyright 2016 The MathWorks, Inc.
+//
+//////////////////////////////////////////////////////////////////////////////
+#ifndef POINT_TRACKER_CUDA
+#define POINT_TRACKER_CUDA
+
+#include <algorithm>
+
+#include "PointTrackerParams.hpp"
+#include "PointBuffers.hpp"
+
+#include "opencv2/opencv_modules.hpp"
+
+#if defined(HAVE_OPENCV_CUDAOPTFLOW)
+#include "opencv2/core/cuda.hpp"
+#include "CudaDevice.hpp"
+#include "opencv2/cudaoptflow.hpp"
+#define POINT_TRACKER_HAVE_CUDA
+#endif
+
+namespace pointTracker
+{
+
+// Returns true if device is a CUDA device the tracker can run on
+inline bool isCudaDevice(int device)
+{
+#if defined(POINT_TRACKER_HAVE_CUDA)
+    return vision::isCudaDevice(device);
+#else
+    (void)device;
+    return false;
+#endif
+}
+
+#if defined(POINT_TRACKER_HAVE_CUDA)
+
+class PointTrackerCuda
+{
+public:
+    // The stream and the buffers belong to the given device
+    explicit PointTrackerCuda(int device)
+        : mDevice(vision::selectCudaDevice(device)), mIndex1(0), mIndex2(1) {}
+
+    int getDevice() const { return mDevice; }
+
+    // uploads the first frame. deviceFrame, if not NULL, is frame already
+    // on the device of the tracker and is copied instead.
+    void initialize(const PointTrackerParams &params, const cv::Mat &frame,
+                    const cv::cuda::GpuMat *deviceFrame = NULL)
+    {
+        cv::cuda::setDevice(mDevice);
+        configure(params);
+        setFrame(frame, deviceFrame, mIndex1);
+
+        // the staging buffer is reused by the next upload
+        mStream.waitForCompletion();
+    }
+
+    // Tracks the points of pointBuffers from the previous frame into frame.
+    // The results are written to the second point buffers of pointBuffers
+    // as calcOpticalFlowPyrLK would, including the bidirectional check.
+    // deviceFrame is as in initialize().
+    void track(const PointTrackerParams &params, const cv::Mat &frame,
+               PointBuffers &pointBuffers,
+               const cv::cuda::GpuMat *deviceFrame = NULL)
+    {
+        cv::cuda::setDevice(mDevice);
+        configure(params);
+        setFrame(frame, deviceFrame, mIndex2);
+
+        const int numPoints = pointBuffers.getNumPoints();
+        const bool useBidirectionalConstraint = params.useBidirectionalConstraint();
+        if (numPoints > 0)
+        {
+            // CUDA LK takes the points as a single row
+            const std::vector<PointBuffers::Point> &points1 = pointBuffers.getPoints1();
+            mHostPoints1.create(1, numPoints, CV_32FC2);
+            std::copy(points1.begin(), points1.begin() + numPoints,
+                mHostPoints1.createMatHeader().ptr<PointBuffers::Point>());
+            mDevicePoints1.upload(mHostPoints1, mStream);
+
+            const cv::cuda::GpuMat &frame1 = mDeviceFrames[mIndex1];
+            const cv::cuda::GpuMat &frame2 = mDeviceFrames[mIndex2];
+
+            mLK->calc(frame1, frame2, mDevicePoints1, mDevicePoints2,
+                      mDeviceStatus2, mDeviceErr, mStream);
+            if (useBidirectionalConstraint)
+            {
+                mLK->calc(frame2, frame1, mDevicePoints2, mDeviceTmpPoints,
+                          mDeviceTmpStatus, cv::noArray(), mStream);
+            }
+
+            mDevicePoints2.download(mHostPoints2, mStream);
+            mDeviceStatus2.download(mHostStatus2, mStream);
+            mDeviceErr.download(mHostErr, mStream);
+            if (useBidirectionalConstraint)
+            {
+                mDeviceTmpPoints.download(mHostTmpPoints, mStream);
+                mDeviceTmpStatus.download(mHostTmpStatus, mStream);
+            }
+        }
+        mStream.waitForCompletion();
+
+        if (numPoints > 0)
+        {
+            copyRow<PointBuffers::Point>(mHostPoints2, numPoints, pointBuffers.getPoints2());
+            copyRow<uchar>(mHostStatus2, numPoints, pointBuffers.getStatus2());
+            copyRow<float>(mHostErr, numPoints, pointBuffers.getErr());
+            if (useBidirectionalConstraint)
+            {
+                copyRow<PointBuffers::Point>(mHostTmpPoints, numPoints,
+                    pointBuffers.getTmpPoints());
+                copyRow<uchar>(mHostTmpStatus, numPoints, pointBuffers.getTmpStatus());
+
+                pointBuffers.updateValidityForwardBackward(
+                    params.getMaxBidirectionalErrorSq());
+            }
+        }
+
+        // the current frame becomes the previous frame
+        std::swap(mIndex1, mIndex2);
+    }
+
+private:
+    template <class T>
+    static void copyRow(const cv::cuda::HostMem &src, int numPoints,
+                        std::vector<T> &dst)
+    {
+        const T *row = src.createMatHeader().ptr<T>();
+        std::copy(row, row + numPoints, dst.begin());
+    }
+
+    // parameters may change when the tracker is re-initialized
+    void configure(const PointTrackerParams &params)
+    {
+        const int numIters = params.getTerminationCriteria().maxCount;
+        if (mLK.empty())
+        {
+            mLK = cv::cuda::SparsePyrLKOpticalFlow::create(params.getBlockSize(),
+                params.getNumPyramidLevels(), numIters);
+            return;
+        }
+        mLK->setWinSize(params.getBlockSize());
+        mLK->setMaxLevel(params.getNumPyramidLevels());
+        mLK->setNumIters(numIters);
+    }
+
+    // stages frame in page-locked memory and queues its upload, or queues
+    // the copy of the frame already on the device
+    void setFrame(const cv::Mat &frame, const cv::cuda::GpuMat *deviceFrame,
+                  int idx)
+    {
+        if (deviceFrame)
+        {
+            deviceFrame->copyTo(mDeviceFrames[idx], mStream);
+            return;
+        }
+        mHostFrame.create(frame.rows, frame.cols, frame.type());
+        cv::Mat staged = mHostFrame.createMatHeader();
+        frame.copyTo(staged);
+        mDeviceFrames[idx].upload(mHostFrame, mStream);
+    }
+
+    // device index, selected before the stream is created
+    int mDevice;
+    cv::cuda::Stream mStream;
+
+    cv::Ptr<cv::cuda::SparsePyrLKOpticalFlow> mLK;
+
+    // indices of the previous and the current device frame
+    int mIndex1, mIndex2;
+    cv::cuda::GpuMat mDeviceFrames[2];
+
+    // device points, validity and scores
+    cv::cuda::GpuMat mDevicePoints1, mDevicePoints2, mDeviceTmpPoints;
+    cv::cuda::GpuMat mDeviceStatus2, mDeviceTmpStatus;
+    cv::cuda::GpuMat mDeviceErr;
+
+    // page-locked staging buffers
+    cv::cuda::HostMem mHostFrame;
+    cv::cuda::HostMem mHostPoints1, mHostPoints2, mHostTmpPoints;
+    cv::cuda::HostMem mHostStatus2, mHostTmpStatus;
+    cv::cuda::HostMem mHostErr;
+
+    // copying and assignment are disallowed
+    PointTrackerCuda(const PointTrackerCuda &);
+    PointTrackerCuda &operator=(const PointTrackerCuda &);
+};
+
+#endif // POINT_TRACKER_HAVE_CUDA
+
+} // namespace pointTracker
+
+#endif
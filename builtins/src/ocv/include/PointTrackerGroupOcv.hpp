@@ -0,0 +1,214 @@
+//////////////////////////////////////////////////////////////////////////////
+// Group of point sets tracked on the same video.
+//
+// The group holds one pair of frame pyramids and any number of point sets,
+// each one with its own parameters, points and validity. The pyramid of a
+// frame is built once, with the largest block size and number of levels of
+// the group, and all point sets are tracked in a single parallel loop.
+//
+// Copyright 2016 The MathWorks, Inc.
+//
+//////////////////////////////////////////////////////////////////////////////
+#ifndef POINT_TRACKER_GROUP_OCV
+#define POINT_TRACKER_GROUP_OCV
+
+#include <algorithm>
+#include <vector>
+
+#include "PointTrackerOcv.hpp"
+
+namespace pointTracker
+{
+
+// Runs the chunks of all point sets. Chunks [chunkOffsets[s],
+// chunkOffsets[s+1]) belong to point set s.
+struct PointTrackerGroupInvoker : cv::ParallelLoopBody
+{
+    PointTrackerGroupInvoker(const std::vector<PointTrackerLKInvoker> &_invokers,
+                             const std::vector<int> &_chunkOffsets)
+    {
+        invokers = &_invokers;
+        chunkOffsets = &_chunkOffsets;
+    }
+
+    void operator()(const cv::Range& range) const
+    {
+        CG_TRACE_SPAN("PointTrackerGroupInvoker");
+        for (int i = range.start; i < range.end; ++i)
+        {
+            // last point set whose first chunk is not after i
+            const int s = (int)(std::upper_bound(chunkOffsets->begin(),
+                chunkOffsets->end(), i) - chunkOffsets->begin()) - 1;
+            const int chunk = i - (*chunkOffsets)[s];
+            (*invokers)[s](cv::Range(chunk, chunk + 1));
+        }
+    }
+
+    const std::vector<PointTrackerLKInvoker> *invokers;
+    const std::vector<int> *chunkOffsets;
+};
+
+class PointTrackerGroupOcv
+{
+public:
+    PointTrackerGroupOcv() : mNPyramidLevels(0) {}
+
+    // sets the first frame. The point sets are kept.
+    void initialize(const cv::Mat &frame)
+    {
+        mImageBuffers.setInitialFrame(frame);
+        mImageBuffers.computePyramid1(mBlockSize, mNPyramidLevels);
+    }
+
+    // adds a point set tracked from the current frame and returns its index
+    int addPointSet(const PointTrackerParams &params, int numPoints,
+                    const float *pointData, bool isRowMajor)
+    {
+        mPointSets.push_back(PointSet());
+        PointSet &pointSet = mPointSets.back();
+        pointSet.params = params;
+        setPoints((int)mPointSets.size() - 1, numPoints, pointData, NULL,
+                  isRowMajor);
+
+        // the pyramids must cover the largest window and number of levels
+        const cv::Size &blockSize = params.getBlockSize();
+        if (blockSize.width > mBlockSize.width ||
+            blockSize.height > mBlockSize.height ||
+            params.getNumPyramidLevels() > mNPyramidLevels)
+        {
+            mBlockSize.width  = std::max(mBlockSize.width, blockSize.width);
+            mBlockSize.height = std::max(mBlockSize.height, blockSize.height);
+            mNPyramidLevels   = std::max(mNPyramidLevels, params.getNumPyramidLevels());
+            if (!getPreviousFrame().empty())
+            {
+                mImageBuffers.computePyramid1(mBlockSize, mNPyramidLevels);
+            }
+        }
+        return (int)mPointSets.size() - 1;
+    }
+
+    // replaces the points of a point set. All points are valid unless
+    // validityData is given.
+    void setPoints(int idx, int numPoints, const float *pointData,
+                   const uchar *validityData, bool isRowMajor)
+    {
+        PointSet &pointSet = mPointSets[idx];
+        const bool useBidirectionalConstraint =
+            pointSet.params.useBidirectionalConstraint();
+        if (isRowMajor)
+        {
+            pointSet.buffers.setPointsRM(numPoints, pointData,
+                                         useBidirectionalConstraint);
+        }
+        else
+        {
+            pointSet.buffers.setPoints(numPoints, pointData,
+                                       useBidirectionalConstraint);
+        }
+
+        if (validityData)
+            pointSet.buffers.setValidity(validityData);
+        else
+            pointSet.buffers.initializeValidity();
+    }
+
+    // tracks all point sets from the previous frame to frame
+    void step(const cv::Mat &frame)
+    {
+        mImageBuffers.setCurrentFrame(frame);
+        mImageBuffers.computePyramid2(mBlockSize, mNPyramidLevels);
+
+        const int numSets = (int)mPointSets.size();
+        const int numThreads = std::max(cv::getNumThreads(), 1);
+
+        mInvokers.clear();
+        mChunkOffsets.assign(1, 0);
+        for (int s = 0; s < numSets; ++s)
+        {
+            PointSet &pointSet = mPointSets[s];
+            const int numChunks = std::max(1, std::min(numThreads,
+                pointSet.buffers.getNumPoints() / PTRACKER_MIN_CHUNK_POINTS));
+
+            mInvokers.push_back(PointTrackerLKInvoker(
+                mImageBuffers.getPyramid1(), mImageBuffers.getPyramid2(),
+                pointSet.buffers, pointSet.params, numChunks));
+            mChunkOffsets.push_back(mChunkOffsets.back() + numChunks);
+        }
+
+        const int numChunks = mChunkOffsets.back();
+        if (numChunks > 0)
+        {
+            cv::parallel_for_(cv::Range(0, numChunks),
+                PointTrackerGroupInvoker(mInvokers, mChunkOffsets),
+                std::min(numChunks, numThreads));
+        }
+
+        // swaps image and point buffers between calls to step()
+        mImageBuffers.swap();
+        for (int s = 0; s < numSets; ++s)
+        {
+            mPointSets[s].buffers.swap();
+        }
+    }
+
+    int getNumPointSets() const
+    {
+        return (int)mPointSets.size();
+    }
+
+    int getNumPoints(int idx) const
+    {
+        return mPointSets[idx].buffers.getNumPoints();
+    }
+
+    const std::vector<PointBuffers::Point> &getPoints(int idx) const
+    {
+        return mPointSets[idx].buffers.getPoints1();
+    }
+
+    const std::vector<uchar> &getStatus(int idx) const
+    {
+        return mPointSets[idx].buffers.getStatus1();
+    }
+
+    const std::vector<float> &getErr(int idx) const
+    {
+        return mPointSets[idx].buffers.getErr();
+    }
+
+    const cv::Mat &getPreviousFrame() const
+    {
+        return mImageBuffers.getImage1();
+    }
+
+private:
+    struct PointSet
+    {
+        // KLT parameters
+        PointTrackerParams params;
+
+        // points, validity, scores
+        PointBuffers buffers;
+    };
+
+    // point sets; they are not moved during step()
+    std::vector<PointSet> mPointSets;
+
+    // images and pyramids shared by all point sets
+    ImageBuffers mImageBuffers;
+
+    // largest half-window size and number of levels of the point sets
+    cv::Size mBlockSize;
+    int mNPyramidLevels;
+
+    // work items of the last step
+    std::vector<PointTrackerLKInvoker> mInvokers;
+    std::vector<int> mChunkOffsets;
+
+    // copying and assignment are disallowed
+    PointTrackerGroupOcv(const PointTrackerGroupOcv &);
+    PointTrackerGroupOcv &operator=(const PointTrackerGroupOcv &);
+};
+
+} // namespace pointTracker
+#endif
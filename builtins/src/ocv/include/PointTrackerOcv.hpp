@@ -1,19 +1,118 @@
 #ifndef POINT_TRACKER_OCV
 #define POINT_TRACKER_OCV
 
+#include <algorithm>
+
 #include "PointTrackerParams.hpp"
 #include "PointBuffers.hpp"
 #include "ImageBuffers.hpp"
+#include "PointTrackerCuda.hpp"
+#include "ImageHandle.hpp"
+#include "cgProfile.hpp"
 
 #include "opencv2/video.hpp"
 
 namespace pointTracker
 {
 
+// Minimum number of points tracked by a task
+const int PTRACKER_MIN_CHUNK_POINTS = 256;
+
+// Tracks chunks of points forward and, with the bidirectional constraint,
+// backward. The pyramids hold the derivatives of each level, so neither
+// pass differentiates the images. A chunk runs both passes while its
+// patches are in cache, without waiting for the other chunks in between.
+struct PointTrackerLKInvoker : cv::ParallelLoopBody
+{
+    PointTrackerLKInvoker(const ImageBuffers::Pyramid &_pyramid1,
+                          const ImageBuffers::Pyramid &_pyramid2,
+                          PointBuffers &_pointBuffers,
+                          const PointTrackerParams &_params,
+                          int _numChunks)
+    {
+        pyramid1 = &_pyramid1;
+        pyramid2 = &_pyramid2;
+        pointBuffers = &_pointBuffers;
+        params = &_params;
+        numChunks = _numChunks;
+    }
+
+    void operator()(const cv::Range& range) const
+    {
+        CG_TRACE_SPAN("PointTrackerLKInvoker");
+        const int numPoints = pointBuffers->getNumPoints();
+        const bool useBidirectionalConstraint = params->useBidirectionalConstraint();
+
+        for (int chunk = range.start; chunk < range.end; ++chunk)
+        {
+            const int first = (int)((long long)numPoints * chunk / numChunks);
+            const int last  = (int)((long long)numPoints * (chunk + 1) / numChunks);
+            const int n = last - first;
+            if (n <= 0)
+            {
+                continue;
+            }
+
+            // headers on the slices of the point buffers. OpenCV writes
+            // the outputs in place since their size and type match.
+            cv::Mat points1(n, 1, CV_32FC2,
+                (void *)&pointBuffers->getPoints1()[first]);
+            cv::Mat points2(n, 1, CV_32FC2, &pointBuffers->getPoints2()[first]);
+            cv::Mat status2(n, 1, CV_8UC1,  &pointBuffers->getStatus2()[first]);
+            cv::Mat err(n, 1, CV_32FC1,     &pointBuffers->getErr()[first]);
+
+            cv::calcOpticalFlowPyrLK(*pyramid1, *pyramid2, points1, points2,
+                status2, err, params->getBlockSize(),
+                params->getNumPyramidLevels(), params->getTerminationCriteria());
+
+            if (useBidirectionalConstraint)
+            {
+                cv::Mat tmpPoints(n, 1, CV_32FC2, &pointBuffers->getTmpPoints()[first]);
+                cv::Mat tmpStatus(n, 1, CV_8UC1,  &pointBuffers->getTmpStatus()[first]);
+
+                cv::calcOpticalFlowPyrLK(*pyramid2, *pyramid1, points2, tmpPoints,
+                    tmpStatus, err, params->getBlockSize(),
+                    params->getNumPyramidLevels(), params->getTerminationCriteria());
+
+                pointBuffers->updateValidityForwardBackward(
+                    params->getMaxBidirectionalErrorSq(), first, last);
+            }
+        }
+    }
+
+    const ImageBuffers::Pyramid *pyramid1;
+    const ImageBuffers::Pyramid *pyramid2;
+    PointBuffers *pointBuffers;
+    const PointTrackerParams *params;
+    int numChunks;
+};
+
 class  PointTrackerOcv
 {
 public:
-    PointTrackerOcv() {}
+    // device is the index of the CUDA device that tracks the points, or -1
+    // for the CPU. Without such a device, the points are tracked on the CPU.
+    explicit PointTrackerOcv(int device = -1)
+    {
+#if defined(POINT_TRACKER_HAVE_CUDA)
+      if (isCudaDevice(device))
+      {
+        mCuda = cv::makePtr<PointTrackerCuda>(device);
+      }
+#else
+      (void)device;
+#endif
+    }
+
+    // returns true if the points are tracked on a CUDA device
+    bool isOnDevice() const
+    {
+#if defined(POINT_TRACKER_HAVE_CUDA)
+      return !mCuda.empty();
+#else
+      return false;
+#endif
+    }
 
     void initialize(const PointTrackerParams &params, const cv::Mat &frame, 
                     int numPoints, const float *pointData)
@@ -23,8 +122,7 @@ public:
       mPointBuffers.setPoints(numPoints, pointData,
                               mParams.useBidirectionalConstraint());
       mPointBuffers.initializeValidity();
-      mImageBuffers.computePyramid1(mParams.getBlockSize(), 
-	                            mParams.getNumPyramidLevels());
+      initializeFrame(frame);
     }
 
 	void initializeRM(const PointTrackerParams &params, const cv::Mat &frame,
@@ -35,10 +133,35 @@ public:
 		mPointBuffers.setPointsRM(numPoints, pointData,
 			mParams.useBidirectionalConstraint());
 		mPointBuffers.initializeValidity();
-		mImageBuffers.computePyramid1(mParams.getBlockSize(),
-			mParams.getNumPyramidLevels());
+		initializeFrame(frame);
 	}
 
+    // initialize() from a shared image, with the points in the layout of
+    // the image. The frame is read on the device when the image has a copy
+    // on the device of the tracker.
+    void initialize(const PointTrackerParams &params, vision::ImageHandle &image,
+                    int numPoints, const float *pointData)
+    {
+      const cv::Mat &frame = image.getConverted();
+      mParams = params;
+      mImageBuffers.setInitialFrame(frame);
+      if (image.isRowMajor())
+        mPointBuffers.setPointsRM(numPoints, pointData,
+                                  mParams.useBidirectionalConstraint());
+      else
+        mPointBuffers.setPoints(numPoints, pointData,
+                                mParams.useBidirectionalConstraint());
+      mPointBuffers.initializeValidity();
+#if defined(POINT_TRACKER_HAVE_CUDA)
+      if (!mCuda.empty())
+      {
+        mCuda->initialize(mParams, frame, getDeviceFrame(image));
+        return;
+      }
+#endif
+      initializeFrame(frame);
+    }
+
     void setPoints(int numPoints, const float *pointData, const uchar *validityData=NULL)
     {
       mPointBuffers.setPoints(numPoints, pointData, 
@@ -55,30 +178,171 @@ public:
 			mPointBuffers.setValidity(validityData);
 	}
 
+    // pre-allocates the point buffers for capacity points
+    void reservePoints(int capacity)
+    {
+      mPointBuffers.reservePoints(capacity,
+                                  mParams.useBidirectionalConstraint());
+    }
+
+    // replaces a subset of the points, e.g. re-detections of lost points,
+    // without resetting the others
+    void replacePoints(int numPoints, const int32_T *indices,
+                       const float *pointData, bool isRowMajor)
+    {
+      mPointBuffers.replacePoints(numPoints, indices, pointData, isRowMajor);
+    }
+
+    void appendPoints(int numPoints, const float *pointData, bool isRowMajor)
+    {
+      mPointBuffers.appendPoints(numPoints, pointData, isRowMajor,
+                                 mParams.useBidirectionalConstraint());
+    }
+
     void step(const cv::Mat &frame)
     {
        mImageBuffers.setCurrentFrame(frame);
+
+#if defined(POINT_TRACKER_HAVE_CUDA)
+       if (!mCuda.empty())
+       {
+          mCuda->track(mParams, frame, mPointBuffers);
+          swapBuffers();
+          return;
+       }
+#endif
  
        mImageBuffers.computePyramid2(mParams.getBlockSize(), 
 	  mParams.getNumPyramidLevels());
 
+       const int numPoints = mPointBuffers.getNumPoints();
+       const int numChunks = std::min(std::max(cv::getNumThreads(), 1),
+           numPoints / PTRACKER_MIN_CHUNK_POINTS);
+
+       if (numChunks > 1)
+       {
+          cv::parallel_for_(cv::Range(0, numChunks),
+              PointTrackerLKInvoker(mImageBuffers.getPyramid1(),
+                  mImageBuffers.getPyramid2(), mPointBuffers, mParams,
+                  numChunks),
+              numChunks);
+       }
+       else
+       {
+          calcOpticalFlowPyrLK(mImageBuffers.getPyramid1(),
+                            mImageBuffers.getPyramid2(),
+                            mPointBuffers.getPoints1(), 
+                            mPointBuffers.getPoints2(),
+                            mPointBuffers.getStatus2(), 
+                            mPointBuffers.getErr(),
+                            mParams.getBlockSize(), 
+                            mParams.getNumPyramidLevels(), 
+			    mParams.getTerminationCriteria()); 
+
+          if(mParams.useBidirectionalConstraint())
+          {
+             applyBidirectionalConstraint();      
+          }
+       }
+
+       swapBuffers();
+    } 
+
+    // step() on a shared image, read as initialize() reads it
+    void step(vision::ImageHandle &image)
+    {
+#if defined(POINT_TRACKER_HAVE_CUDA)
+       if (!mCuda.empty())
+       {
+          const cv::Mat &frame = image.getConverted();
+          mImageBuffers.setCurrentFrame(frame);
+          mCuda->track(mParams, frame, mPointBuffers, getDeviceFrame(image));
+          swapBuffers();
+          return;
+       }
+#endif
+       step(image.getConverted());
+    }
+
+    // step() that writes the tracked points, 0-based and interleaved as
+    // cv::Point2f, their validity and their scores straight from OpenCV
+    // into caller memory of getNumPoints() elements each. The caller's
+    // arrays are only used during the call.
+    void stepInto(const cv::Mat &frame, PointBuffers::Point *outPoints,
+                  uchar *outStatus, float *outErr)
+    {
+       if (isOnDevice())
+       {
+          // the device results arrive in page-locked buffers first
+          step(frame);
+          const int n = mPointBuffers.getNumPoints();
+          std::copy(getPoints().begin(), getPoints().begin() + n, outPoints);
+          std::copy(getStatus().begin(), getStatus().begin() + n, outStatus);
+          std::copy(getErr().begin(), getErr().begin() + n, outErr);
+          return;
+       }
+
+       mImageBuffers.setCurrentFrame(frame);
+       mImageBuffers.computePyramid2(mParams.getBlockSize(),
+	  mParams.getNumPyramidLevels());
+
+       const int numPoints = mPointBuffers.getNumPoints();
+       std::vector<PointBuffers::Point> &nextPoints = mPointBuffers.getPoints2();
+       std::vector<uchar> &nextStatus = mPointBuffers.getStatus2();
+
+       // the previous points and validity are read from the first buffers
+       cv::Mat nextPts(numPoints, 1, CV_32FC2, outPoints);
+       cv::Mat status(numPoints, 1, CV_8UC1, outStatus);
+       cv::Mat err(numPoints, 1, CV_32FC1, outErr);
+
        calcOpticalFlowPyrLK(mImageBuffers.getPyramid1(),
                          mImageBuffers.getPyramid2(),
-                         mPointBuffers.getPoints1(), 
-                         mPointBuffers.getPoints2(),
-                         mPointBuffers.getStatus2(), 
-                         mPointBuffers.getErr(),
-                         mParams.getBlockSize(), 
-                         mParams.getNumPyramidLevels(), 
-			 mParams.getTerminationCriteria()); 
+                         mPointBuffers.getPoints1(),
+                         nextPts, status, err,
+                         mParams.getBlockSize(),
+                         mParams.getNumPyramidLevels(),
+			 mParams.getTerminationCriteria());
 
        if(mParams.useBidirectionalConstraint())
        {
-          applyBidirectionalConstraint();      
+          std::vector<PointBuffers::Point> &tmpPoints = mPointBuffers.getTmpPoints();
+          std::vector<uchar> &tmpStatus = mPointBuffers.getTmpStatus();
+          cv::calcOpticalFlowPyrLK(mImageBuffers.getPyramid2(),
+                            mImageBuffers.getPyramid1(),
+                            nextPts, tmpPoints, tmpStatus, err,
+                            mParams.getBlockSize(),
+                            mParams.getNumPyramidLevels(),
+			    mParams.getTerminationCriteria());
+
+          const double maxErrorSq = mParams.getMaxBidirectionalErrorSq();
+          const std::vector<PointBuffers::Point> &prevPoints = mPointBuffers.getPoints1();
+          for (int i = 0; i < numPoints; ++i)
+          {
+             const double dx = prevPoints[i].x - tmpPoints[i].x;
+             const double dy = prevPoints[i].y - tmpPoints[i].y;
+             outStatus[i] = outStatus[i] && tmpStatus[i] &&
+                 (dx * dx + dy * dy < maxErrorSq);
+          }
        }
 
-       swapBuffers();
-    } 
+       // invalid points stay invalid, at their last valid location. The
+       // results become the previous points of the next step.
+       const std::vector<PointBuffers::Point> &prevPoints = mPointBuffers.getPoints1();
+       const std::vector<uchar> &prevStatus = mPointBuffers.getStatus1();
+       for (int i = 0; i < numPoints; ++i)
+       {
+          outStatus[i] = prevStatus[i] && outStatus[i];
+          if (outStatus[i] == 0)
+             outPoints[i] = prevPoints[i];
+       }
+       std::copy(outPoints, outPoints + numPoints, nextPoints.begin());
+       std::copy(outStatus, outStatus + numPoints, nextStatus.begin());
+
+       // the new points are in the second buffers, swap them in
+       mImageBuffers.swap();
+       mPointBuffers.swapBuffers();
+       mParams.setPyramid1Ready();
+    }
 
     int getNumPoints() const
     {
@@ -115,6 +379,37 @@ public:
        return mImageBuffers.getImageWidth();
     }
 private:
+    // computes the pyramid of the first frame, or uploads it to the device
+    void initializeFrame(const cv::Mat &frame)
+    {
+#if defined(POINT_TRACKER_HAVE_CUDA)
+      if (!mCuda.empty())
+      {
+        mCuda->initialize(mParams, frame);
+        return;
+      }
+#endif
+      (void)frame;
+      mImageBuffers.computePyramid1(mParams.getBlockSize(),
+                                    mParams.getNumPyramidLevels());
+    }
+
+#if defined(POINT_TRACKER_HAVE_CUDA)
+    // the device copy of image, if it is on the device of the tracker
+    const cv::cuda::GpuMat *getDeviceFrame(vision::ImageHandle &image)
+    {
+#if defined(IMAGE_HANDLE_HAVE_CUDA)
+      if (image.getDevice() == mCuda->getDevice())
+      {
+        return &image.getDeviceConverted();
+      }
+#else
+      (void)image;
+#endif
+      return NULL;
+    }
+#endif
+
     // swaps image and point buffers between calls to step()
     void swapBuffers()
     {
@@ -152,6 +447,11 @@ private:
     // images and pyramids
     ImageBuffers mImageBuffers;
 
+#if defined(POINT_TRACKER_HAVE_CUDA)
+    // device frames and buffers, empty when tracking on the CPU
+    cv::Ptr<PointTrackerCuda> mCuda;
+#endif
+
     // copying and assignment are disallowed
     PointTrackerOcv(const PointTrackerOcv &);
     PointTrackerOcv &operator=(const PointTrackerOcv &);
@@ -0,0 +1,516 @@
+//////////////////////////////////////////////////////////////////////////////
+// Product-quantized index of real features for matchFeatures, an
+// alternative to the FLANN index of ApproxNNIndex.hpp for databases too
+// large to keep as single precision matrices [Jegou 2011].
+//
+// The feature vector is split into numSubspaces subvectors and each one is
+// replaced by the closest of 256 centroids of its subspace, so a feature is
+// stored in numSubspaces bytes, e.g. 8 or 16 bytes for the 64 or 128
+// values of SURF and KAZE descriptors. With numLists > 0 the features are
+// first assigned to the closest of numLists coarse centers and the
+// residuals, the differences to the centers, are quantized instead (IVF-PQ);
+// a search then only visits the lists of the numProbes centers closest to
+// the query. The coarse centers and the codebooks are trained with the
+// approximate k-means of ApproxKMeans.hpp.
+//
+// Distances are asymmetric: the query is not quantized. For each visited
+// list a table of the squared distances of the query subvectors to the
+// centroids is computed, with the 128-bit universal intrinsics of OpenCV,
+// and the distance to a feature is the sum of numSubspaces table entries.
+// Distances approximate the sum of squared differences ('ssd').
+//
+// Copyright 2016 The MathWorks, Inc.
+//
+//////////////////////////////////////////////////////////////////////////////
+#ifndef PRODUCT_QUANTIZER
+#define PRODUCT_QUANTIZER
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <utility>
+#include <vector>
+
+#include "vision_defines.h"
+#include "opencv2/core/hal/intrin.hpp"
+#include "ApproxKMeans.hpp"
+#include "cgThreadPool.hpp"
+
+namespace matchFeatures
+{
+
+// Centroids per subspace, the values of a code byte
+const int PQ_NUM_CENTROIDS = 256;
+
+// Features encoded, or queries searched, by one task of the pool
+const int PQ_BLOCK_ROWS = 256;
+
+// Errors returned by PQIndex::train
+enum PQStatus
+{
+    PQ_SUCCESS = 0,
+    // fewer valid features than coarse centers or centroids
+    PQ_ERR_TOO_FEW_FEATURES = -1,
+    // more subspaces than values, or more than 255 bytes per code
+    PQ_ERR_INVALID_SUBSPACES = -2
+};
+
+// Squared Euclidean distance of a and b, n values
+inline float pqDistance(const float *a, const float *b, int n)
+{
+    int i = 0;
+    float d = 0;
+#if CV_SIMD128
+    cv::v_float32x4 sum = cv::v_setzero_f32();
+    for (; i + 4 <= n; i += 4)
+    {
+        const cv::v_float32x4 diff = cv::v_load(a + i) - cv::v_load(b + i);
+        sum = cv::v_muladd(diff, diff, sum);
+    }
+    d = cv::v_reduce_sum(sum);
+#endif
+    for (; i < n; i++)
+    {
+        const float diff = a[i] - b[i];
+        d += diff * diff;
+    }
+    return d;
+}
+
+class PQIndex
+{
+public:
+    // numSubspaces bytes per feature, numLists coarse centers, 0 for a
+    // flat index that scans all the codes
+    PQIndex(int numSubspaces, int numLists)
+        : mNumSubspaces(numSubspaces), mNumLists(std::max(numLists, 0)),
+          mDim(0), mNumFeatures(0) {}
+
+    // Trains the coarse centers and the codebooks on numFeatures-by-dim
+    // features, row major, and empties the index.
+    int train(const float *features, int numFeatures, int dim, unsigned int seed)
+    {
+        if (mNumSubspaces <= 0 || mNumSubspaces > dim || mNumSubspaces > 255)
+            return PQ_ERR_INVALID_SUBSPACES;
+
+        mDim = dim;
+        mNumFeatures = 0;
+        const int numLists = std::max(mNumLists, 1);
+        mCodes.assign(numLists, std::vector<uint8_T>());
+        mIds.assign(numLists, std::vector<int32_T>());
+        mCoarse.assign((size_t)numLists * dim, 0.0f);
+
+        bagOfFeatures::ApproxKMeansParams params;
+        params.maxIterations = 25;
+        params.seed = seed;
+
+        // residuals to the coarse centers
+        std::vector<float> residuals(features, features + (size_t)numFeatures * dim);
+        if (mNumLists > 0)
+        {
+            params.numClusters = mNumLists;
+            std::vector<int32_T> assignments(numFeatures);
+            bagOfFeatures::ApproxKMeans coarse(features, numFeatures, dim);
+            if (coarse.cluster(params, &mCoarse[0], &assignments[0]) < 0)
+                return PQ_ERR_TOO_FEW_FEATURES;
+            for (int i = 0; i < numFeatures; i++)
+            {
+                // features left out by the clustering stay NaN
+                if (assignments[i] < 0)
+                    continue;
+                const float *center = &mCoarse[(size_t)assignments[i] * dim];
+                for (int j = 0; j < dim; j++)
+                    residuals[(size_t)i * dim + j] -= center[j];
+            }
+        }
+
+        // a codebook per subspace
+        mCodebooks.assign((size_t)PQ_NUM_CENTROIDS * dim, 0.0f);
+        params.numClusters = PQ_NUM_CENTROIDS;
+        std::vector<float> sub;
+        std::vector<int32_T> assignments(numFeatures);
+        for (int m = 0; m < mNumSubspaces; m++)
+        {
+            const int begin = subBegin(m), subDim = subBegin(m + 1) - begin;
+            sub.resize((size_t)numFeatures * subDim);
+            for (int i = 0; i < numFeatures; i++)
+                memcpy(&sub[(size_t)i * subDim], &residuals[(size_t)i * dim + begin],
+                       subDim * sizeof(float));
+
+            bagOfFeatures::ApproxKMeans kmeans(&sub[0], numFeatures, subDim);
+            if (kmeans.cluster(params, codebook(m), &assignments[0]) < 0)
+                return PQ_ERR_TOO_FEW_FEATURES;
+        }
+        return PQ_SUCCESS;
+    }
+
+    // Encodes and appends numFeatures-by-dim features, row major. Their
+    // indices follow those of the features already added.
+    void addPoints(const float *features, int numFeatures)
+    {
+        if (mCodes.empty() || numFeatures <= 0)
+            return;
+
+        std::vector<int32_T> lists(numFeatures);
+        std::vector<uint8_T> codes((size_t)numFeatures * mNumSubspaces);
+        std::vector<std::vector<float> > residuals(std::max((int)cgGetNumThreads(), 1));
+
+        const int numBlocks = (numFeatures + PQ_BLOCK_ROWS - 1) / PQ_BLOCK_ROWS;
+#ifdef PARALLEL
+        cgParallelForWorkers(numBlocks, [&](int worker, int b) {
+            encodeBlock(features, numFeatures, b, residuals[worker], &lists[0], &codes[0]);
+        });
+#else
+        for (int b = 0; b < numBlocks; b++)
+            encodeBlock(features, numFeatures, b, residuals[0], &lists[0], &codes[0]);
+#endif
+
+        for (int i = 0; i < numFeatures; i++)
+        {
+            const uint8_T *code = &codes[(size_t)i * mNumSubspaces];
+            mCodes[lists[i]].insert(mCodes[lists[i]].end(), code, code + mNumSubspaces);
+            mIds[lists[i]].push_back(mNumFeatures + i);
+        }
+        mNumFeatures += numFeatures;
+    }
+
+    // knn nearest features of numQueries-by-dim queries, row major,
+    // visiting the lists of the numProbes closest coarse centers. indices,
+    // 0-based, and squared distances are numQueries-by-knn, row major,
+    // nearest first; missing neighbors are -1 with distance FLT_MAX.
+    void search(const float *queries, int numQueries, int knn, int numProbes,
+                int32_T *indices, float *dists) const
+    {
+        const int numLists = (int)mCodes.size();
+        numProbes = std::min(std::max(numProbes, 1), numLists);
+        std::vector<SearchBuffers> buffers(std::max((int)cgGetNumThreads(), 1));
+
+        const int numBlocks = (numQueries + PQ_BLOCK_ROWS - 1) / PQ_BLOCK_ROWS;
+#ifdef PARALLEL
+        cgParallelForWorkers(numBlocks, [&](int worker, int b) {
+            searchBlock(queries, numQueries, knn, numProbes, b, buffers[worker], indices, dists);
+        });
+#else
+        for (int b = 0; b < numBlocks; b++)
+            searchBlock(queries, numQueries, knn, numProbes, b, buffers[0], indices, dists);
+#endif
+    }
+
+    int getNumFeatures() const
+    {
+        return mNumFeatures;
+    }
+
+    int getNumelInFeatureVec() const
+    {
+        return mDim;
+    }
+
+    // Saves the centers, codebooks and codes
+    bool save(const char *filename) const
+    {
+        FILE *fout = fopen(filename, "wb");
+        if (fout == NULL)
+            return false;
+
+        FileHeader header;
+        memcpy(header.magic, getMagic(), sizeof(header.magic));
+        header.version      = FILE_VERSION;
+        header.numSubspaces = mNumSubspaces;
+        header.numLists     = mNumLists;
+        header.dim          = mDim;
+        header.numFeatures  = mNumFeatures;
+
+        bool ok = fwrite(&header, sizeof(header), 1, fout) == 1 &&
+                  write(fout, mCoarse) && write(fout, mCodebooks);
+        for (size_t l = 0; ok && l < mCodes.size(); l++)
+        {
+            const int32_T count = (int32_T)mIds[l].size();
+            ok = fwrite(&count, sizeof(count), 1, fout) == 1 &&
+                 write(fout, mIds[l]) && write(fout, mCodes[l]);
+        }
+        ok = fclose(fout) == 0 && ok;
+        return ok;
+    }
+
+    // Loads an index written by save(), replacing the parameters given to
+    // the constructor
+    bool load(const char *filename)
+    {
+        FILE *fin = fopen(filename, "rb");
+        if (fin == NULL)
+            return false;
+
+        FileHeader header;
+        bool ok = fread(&header, sizeof(header), 1, fin) == 1 &&
+                  memcmp(header.magic, getMagic(), sizeof(header.magic)) == 0 &&
+                  header.version == FILE_VERSION && header.numSubspaces > 0 &&
+                  header.numSubspaces <= header.dim && header.numLists >= 0;
+        if (ok)
+        {
+            mNumSubspaces = header.numSubspaces;
+            mNumLists     = header.numLists;
+            mDim          = header.dim;
+            mNumFeatures  = header.numFeatures;
+
+            const int numLists = std::max(mNumLists, 1);
+            mCoarse.resize((size_t)numLists * mDim);
+            mCodebooks.resize((size_t)PQ_NUM_CENTROIDS * mDim);
+            mCodes.assign(numLists, std::vector<uint8_T>());
+            mIds.assign(numLists, std::vector<int32_T>());
+            ok = read(fin, mCoarse) && read(fin, mCodebooks);
+
+            int total = 0;
+            for (int l = 0; ok && l < numLists; l++)
+            {
+                int32_T count = 0;
+                ok = fread(&count, sizeof(count), 1, fin) == 1 && count >= 0;
+                if (!ok)
+                    break;
+                mIds[l].resize(count);
+                mCodes[l].resize((size_t)count * mNumSubspaces);
+                ok = read(fin, mIds[l]) && read(fin, mCodes[l]);
+                total += count;
+            }
+            ok = ok && total == mNumFeatures;
+        }
+        fclose(fin);
+
+        if (!ok)
+        {
+            mDim = 0;
+            mNumFeatures = 0;
+            mCodes.clear();
+            mIds.clear();
+        }
+        return ok;
+    }
+
+private:
+    // Per worker buffers of a search
+    struct SearchBuffers
+    {
+        std::vector<float> table;
+        std::vector<float> residual;
+        std::vector<std::pair<float, int> > lists;
+        std::vector<std::pair<float, int32_T> > heap;
+    };
+
+    // First value of subspace m; the values are split as evenly as
+    // possible
+    int subBegin(int m) const
+    {
+        return m * mDim / mNumSubspaces;
+    }
+
+    // 256-by-subDim centroids of subspace m, row major
+    float *codebook(int m)
+    {
+        return &mCodebooks[(size_t)PQ_NUM_CENTROIDS * subBegin(m)];
+    }
+
+    const float *codebook(int m) const
+    {
+        return &mCodebooks[(size_t)PQ_NUM_CENTROIDS * subBegin(m)];
+    }
+
+    int closestCenter(const float *x) const
+    {
+        const int numLists = (int)mCodes.size();
+        int best = 0;
+        float bestDist = FLT_MAX;
+        for (int l = 0; l < numLists && numLists > 1; l++)
+        {
+            const float d = pqDistance(x, &mCoarse[(size_t)l * mDim], mDim);
+            if (d < bestDist)
+            {
+                bestDist = d;
+                best = l;
+            }
+        }
+        return best;
+    }
+
+    void encode(const float *residual, uint8_T *code) const
+    {
+        for (int m = 0; m < mNumSubspaces; m++)
+        {
+            const int begin = subBegin(m), subDim = subBegin(m + 1) - begin;
+            const float *centroids = codebook(m);
+            int best = 0;
+            float bestDist = FLT_MAX;
+            for (int k = 0; k < PQ_NUM_CENTROIDS; k++)
+            {
+                const float d = pqDistance(residual + begin, centroids + (size_t)k * subDim, subDim);
+                if (d < bestDist)
+                {
+                    bestDist = d;
+                    best = k;
+                }
+            }
+            code[m] = (uint8_T)best;
+        }
+    }
+
+    // Squared distances of the subvectors of residual to the centroids,
+    // numSubspaces-by-256
+    void computeTable(const float *residual, float *table) const
+    {
+        for (int m = 0; m < mNumSubspaces; m++)
+        {
+            const int begin = subBegin(m), subDim = subBegin(m + 1) - begin;
+            const float *centroids = codebook(m);
+            float *row = table + (size_t)m * PQ_NUM_CENTROIDS;
+            for (int k = 0; k < PQ_NUM_CENTROIDS; k++)
+                row[k] = pqDistance(residual + begin, centroids + (size_t)k * subDim, subDim);
+        }
+    }
+
+    // Coarse lists and codes of the features of block b, residual a work
+    // buffer
+    void encodeBlock(const float *features, int numFeatures, int b,
+                     std::vector<float> &residual, int32_T *lists, uint8_T *codes) const
+    {
+        residual.resize(mDim);
+        const int end = std::min(numFeatures, (b + 1) * PQ_BLOCK_ROWS);
+        for (int i = b * PQ_BLOCK_ROWS; i < end; i++)
+        {
+            const float *x = features + (size_t)i * mDim;
+            lists[i] = closestCenter(x);
+            const float *center = &mCoarse[(size_t)lists[i] * mDim];
+            for (int j = 0; j < mDim; j++)
+                residual[j] = x[j] - center[j];
+            encode(&residual[0], &codes[(size_t)i * mNumSubspaces]);
+        }
+    }
+
+    // Searches the queries of block b
+    void searchBlock(const float *queries, int numQueries, int knn, int numProbes, int b,
+                     SearchBuffers &buf, int32_T *indices, float *dists) const
+    {
+        buf.table.resize((size_t)mNumSubspaces * PQ_NUM_CENTROIDS);
+        buf.residual.resize(mDim);
+        const int end = std::min(numQueries, (b + 1) * PQ_BLOCK_ROWS);
+        for (int i = b * PQ_BLOCK_ROWS; i < end; i++)
+        {
+            searchQuery(queries + (size_t)i * mDim, knn, numProbes, buf,
+                        indices + (size_t)i * knn, dists + (size_t)i * knn);
+        }
+    }
+
+    static bool isCloser(const std::pair<float, int32_T> &a, const std::pair<float, int32_T> &b)
+    {
+        return a.first < b.first || (a.first == b.first && a.second < b.second);
+    }
+
+    void searchQuery(const float *q, int knn, int numProbes, SearchBuffers &buf,
+                     int32_T *indices, float *dists) const
+    {
+        // the numProbes closest lists
+        const int numLists = (int)mCodes.size();
+        buf.lists.resize(numLists);
+        for (int l = 0; l < numLists; l++)
+        {
+            const float d = numLists > 1 ? pqDistance(q, &mCoarse[(size_t)l * mDim], mDim) : 0;
+            buf.lists[l] = std::make_pair(d, l);
+        }
+        std::partial_sort(buf.lists.begin(), buf.lists.begin() + numProbes, buf.lists.end());
+
+        // the knn closest codes of the lists, the farthest on top
+        std::vector<std::pair<float, int32_T> > &heap = buf.heap;
+        heap.clear();
+        for (int p = 0; p < numProbes; p++)
+        {
+            const int l = buf.lists[p].second;
+            const float *center = &mCoarse[(size_t)l * mDim];
+            for (int j = 0; j < mDim; j++)
+                buf.residual[j] = q[j] - center[j];
+            computeTable(&buf.residual[0], &buf.table[0]);
+
+            const uint8_T *code = mCodes[l].data();
+            const int32_T *ids = mIds[l].data();
+            const int count = (int)mIds[l].size();
+            for (int i = 0; i < count; i++, code += mNumSubspaces)
+            {
+                const float *row = &buf.table[0];
+                float d = 0;
+                for (int m = 0; m < mNumSubspaces; m++, row += PQ_NUM_CENTROIDS)
+                    d += row[code[m]];
+
+                const std::pair<float, int32_T> c(d, ids[i]);
+                if ((int)heap.size() < knn)
+                {
+                    heap.push_back(c);
+                    std::push_heap(heap.begin(), heap.end(), isCloser);
+                }
+                else if (isCloser(c, heap.front()))
+                {
+                    std::pop_heap(heap.begin(), heap.end(), isCloser);
+                    heap.back() = c;
+                    std::push_heap(heap.begin(), heap.end(), isCloser);
+                }
+            }
+        }
+
+        std::sort_heap(heap.begin(), heap.end(), isCloser);
+        for (int k = 0; k < knn; k++)
+        {
+            indices[k] = k < (int)heap.size() ? heap[k].second : -1;
+            dists[k] = k < (int)heap.size() ? heap[k].first : FLT_MAX;
+        }
+    }
+
+    template <typename T>
+    static bool write(FILE *fout, const std::vector<T> &v)
+    {
+        return v.empty() || fwrite(&v[0], sizeof(T), v.size(), fout) == v.size();
+    }
+
+    template <typename T>
+    static bool read(FILE *fin, std::vector<T> &v)
+    {
+        return v.empty() || fread(&v[0], sizeof(T), v.size(), fin) == v.size();
+    }
+
+    // On-disk header, followed by the coarse centers, the codebooks and,
+    // for each list, its number of features, their indices and codes
+    struct FileHeader
+    {
+        char    magic[8];
+        int32_T version;
+        int32_T numSubspaces;
+        int32_T numLists;
+        int32_T dim;
+        int32_T numFeatures;
+    };
+
+    enum { FILE_VERSION = 1 };
+
+    static const char *getMagic()
+    {
+        return "MWPQINDX";
+    }
+
+    int mNumSubspaces;
+    int mNumLists;
+    int mDim;
+    int mNumFeatures;
+
+    // numLists-by-dim coarse centers, a single zero center when flat
+    std::vector<float> mCoarse;
+    // the codebooks of the subspaces, one after the other
+    std::vector<float> mCodebooks;
+    // codes and indices of the features of each list
+    std::vector<std::vector<uint8_T> > mCodes;
+    std::vector<std::vector<int32_T> > mIds;
+
+    // prevent copying
+    PQIndex(const PQIndex &);
+    PQIndex &operator=(const PQIndex &);
+};
+
+} // namespace matchFeatures
+
+#endif
@@ -0,0 +1,781 @@
+//////////////////////////////////////////////////////////////////////////////
+// Rigid registration of point clouds with the iterative closest point
+// algorithm, as in pcregrigid.
+//
+// Each iteration matches every moving point to its nearest fixed point with
+// the kd-tree of PointCloudKdtree.hpp, keeps the matches of the inlier
+// ratio with the smallest distances, and estimates the transformation that
+// minimizes the point to point distances (SVD of the cross-covariance) or
+// the point to plane distances (the 6x6 normal equations of the linearized
+// rotation). The iterations stop when the average change of the rotation
+// and translation over the last three iterations is within the tolerance.
+//
+// The registration can run coarse to fine: the fixed and moving clouds are
+// downsampled with the voxel grid filter of VoxelGridFilter.hpp at each grid
+// step of a schedule, 0 for the full clouds, and each level starts from the
+// transformation of the previous one. The fixed levels, their kd-trees and
+// normals are built once by setFixed and kept across registrations, so
+// successive scans can be registered to the same map.
+//
+// The transforms, matching and sums of an iteration run on fixed blocks of
+// points in parallel with PARALLEL; the sums of the blocks are added in
+// order, so the results do not depend on the number of threads. The normal
+// equations are accumulated with the 128-bit universal intrinsics of OpenCV.
+//
+// Transformations are the 4-by-4 matrices of affine3d, [R' 0; T' 1], which
+// maps a point p to R*p + T.
+//
+// Copyright 2016 The MathWorks, Inc.
+//
+//////////////////////////////////////////////////////////////////////////////
+#ifndef RIGID_ICP
+#define RIGID_ICP
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <vector>
+
+#include "vision_defines.h"
+#include "opencv2/core.hpp"
+#include "opencv2/core/hal/intrin.hpp"
+#include "PointCloudKdtree.hpp"
+#include "VoxelGridFilter.hpp"
+#include "cgThreadPool.hpp"
+
+// points per block of the sums of an iteration
+#define ICP_BLOCK_POINTS 4096
+// neighbors of the normals computed by PCA, as pcregrigid
+#define ICP_NORMAL_NEIGHBORS 6
+
+namespace icp
+{
+
+enum IcpStatus
+{
+    ICP_SUCCESS = 0,
+    // fewer than 3 points, or inliers
+    ICP_NOT_ENOUGH_POINTS = -1,
+    // the transformation could not be estimated
+    ICP_SINGULAR_MATRIX = -2
+};
+
+struct IcpParams
+{
+    IcpParams() : inlierRatio(1.0), maxIterations(20)
+    {
+        tolerance[0] = 0.01;
+        tolerance[1] = 0.009;
+    }
+
+    double inlierRatio;
+    // per level of the schedule
+    int maxIterations;
+    // translation and rotation, in radians
+    double tolerance[2];
+};
+
+// Rigid transformation p -> R*p + T
+struct Pose
+{
+    cv::Matx33d R;
+    cv::Vec3d T;
+};
+
+// C += cn*cn' and b += r*cn, C 6-by-6 row major
+inline void accumulatePointToPlane(const double *cn, double r, double *C, double *b)
+{
+#if CV_SIMD128_64F
+    const cv::v_float64x2 c01 = cv::v_load(cn), c23 = cv::v_load(cn + 2), c45 = cv::v_load(cn + 4);
+    for (int i = 0; i < 6; i++)
+    {
+        const cv::v_float64x2 ci = cv::v_setall_f64(cn[i]);
+        double *row = C + 6 * i;
+        cv::v_store(row, cv::v_muladd(ci, c01, cv::v_load(row)));
+        cv::v_store(row + 2, cv::v_muladd(ci, c23, cv::v_load(row + 2)));
+        cv::v_store(row + 4, cv::v_muladd(ci, c45, cv::v_load(row + 4)));
+    }
+    const cv::v_float64x2 vr = cv::v_setall_f64(r);
+    cv::v_store(b, cv::v_muladd(vr, c01, cv::v_load(b)));
+    cv::v_store(b + 2, cv::v_muladd(vr, c23, cv::v_load(b + 2)));
+    cv::v_store(b + 4, cv::v_muladd(vr, c45, cv::v_load(b + 4)));
+#else
+    for (int i = 0; i < 6; i++)
+    {
+        for (int j = 0; j < 6; j++)
+            C[6 * i + j] += cn[i] * cn[j];
+        b[i] += r * cn[i];
+    }
+#endif
+}
+
+template <typename T>
+class RigidIcp
+{
+public:
+    RigidIcp() : mIsPointToPlane(false) {}
+
+    ~RigidIcp()
+    {
+        clearLevels();
+    }
+
+    // Sets the fixed cloud, numPoints-by-3 location and normal, column
+    // major unless isRowMajor. normal may be NULL; it is then computed for
+    // the point to plane metric. gridSteps are the numLevels grid steps of
+    // the schedule, coarse to fine, 0 for the full cloud; no steps
+    // register the full clouds. Points or normals that are not finite are
+    // ignored.
+    int setFixed(const T *location, const T *normal, int numPoints, bool isRowMajor,
+                 const double *gridSteps, int numLevels, bool isPointToPlane)
+    {
+        clearLevels();
+        mIsPointToPlane = isPointToPlane;
+
+        std::vector<T> points, normals;
+        compact(location, isPointToPlane ? normal : NULL, numPoints, isRowMajor, points, normals);
+
+        const double fullStep = 0;
+        if (numLevels <= 0)
+        {
+            gridSteps = &fullStep;
+            numLevels = 1;
+        }
+
+        for (int l = 0; l < numLevels; l++)
+        {
+            Level *level = new Level();
+            mLevels.push_back(level);
+            level->gridStep = gridSteps[l];
+            downsample(points, normals, gridSteps[l], level->location, level->normal);
+
+            if (isPointToPlane)
+            {
+                if (level->normal.empty())
+                    computeNormals(*level);
+                removeInvalidNormals(*level);
+            }
+
+            const int n = (int)level->location.size() / 3;
+            if (n < 3)
+                return ICP_NOT_ENOUGH_POINTS;
+            level->tree.index(&level->location[0], n, true);
+        }
+        return ICP_SUCCESS;
+    }
+
+    // Registers numPoints-by-3 moving location, column major unless
+    // isRowMajor, to the fixed cloud starting from initialTform. tform is
+    // the transformation found, rmse the root mean square distance of the
+    // inlier matches at the finest level and numIterations the iterations
+    // of all levels. initialTform and tform are 4-by-4, column major
+    // unless isRowMajor.
+    int registerMoving(const T *location, int numPoints, bool isRowMajor,
+                       const IcpParams &params, const double *initialTform,
+                       double *tform, double *rmse, int *numIterations)
+    {
+        *numIterations = 0;
+        *rmse = 0;
+
+        Pose pose = fromTform(initialTform, isRowMajor);
+        toTform(pose, isRowMajor, tform);
+        if (mLevels.empty())
+            return ICP_NOT_ENOUGH_POINTS;
+
+        std::vector<T> points, unused;
+        compact(location, NULL, numPoints, isRowMajor, points, unused);
+
+        for (size_t l = 0; l < mLevels.size(); l++)
+        {
+            std::vector<T> moving, movingNormal;
+            downsample(points, unused, mLevels[l]->gridStep, moving, movingNormal);
+
+            int levelIterations = 0;
+            const int status = registerLevel(*mLevels[l], moving, params, pose, rmse,
+                                             &levelIterations);
+            *numIterations += levelIterations;
+            if (status != ICP_SUCCESS)
+                return status;
+        }
+
+        // remove the drift of the rotation from orthogonality
+        cv::Matx33d w, u, vt;
+        cv::SVD::compute(pose.R, w, u, vt);
+        pose.R = u * vt;
+        toTform(pose, isRowMajor, tform);
+        return ICP_SUCCESS;
+    }
+
+private:
+    // Fixed cloud at a grid step, row major
+    struct Level
+    {
+        double gridStep;
+        std::vector<T> location;
+        std::vector<T> normal;
+        pckdtree::PointCloudKdtree<T> tree;
+    };
+
+    // Sums of the blocks of an iteration
+    struct BlockSums
+    {
+        double sumP[3], sumQ[3];
+        double H[9];
+        double C[36], b[6];
+        double sumSquares;
+
+        void clear()
+        {
+            std::fill(sumP, sumP + 3, 0.0);
+            std::fill(sumQ, sumQ + 3, 0.0);
+            std::fill(H, H + 9, 0.0);
+            std::fill(C, C + 36, 0.0);
+            std::fill(b, b + 6, 0.0);
+            sumSquares = 0;
+        }
+    };
+
+    // Orders indices by distance, then by index
+    struct DistanceLess
+    {
+        const std::vector<T> &dists;
+        explicit DistanceLess(const std::vector<T> &d) : dists(d) {}
+        bool operator()(int a, int b) const
+        {
+            return dists[a] < dists[b] || (dists[a] == dists[b] && a < b);
+        }
+    };
+
+    void clearLevels()
+    {
+        for (size_t l = 0; l < mLevels.size(); l++)
+            delete mLevels[l];
+        mLevels.clear();
+    }
+
+    // Finite points, and normals when normal is not NULL, row major
+    static void compact(const T *location, const T *normal, int numPoints, bool isRowMajor,
+                        std::vector<T> &points, std::vector<T> &normals)
+    {
+        points.clear();
+        normals.clear();
+        for (int i = 0; i < numPoints; i++)
+        {
+            T p[3], n[3];
+            bool isValid = true;
+            for (int d = 0; d < 3; d++)
+            {
+                const size_t at = isRowMajor ? 3 * (size_t)i + d : i + (size_t)d * numPoints;
+                p[d] = location[at];
+                n[d] = normal ? normal[at] : 0;
+                isValid = isValid && isFinite(p[d]) && isFinite(n[d]);
+            }
+            if (!isValid)
+                continue;
+            points.insert(points.end(), p, p + 3);
+            if (normal)
+                normals.insert(normals.end(), n, n + 3);
+        }
+    }
+
+    static bool isFinite(T v)
+    {
+        return v - v == 0;
+    }
+
+    // Averages the points and normals in voxels of gridStep over their
+    // bounding box, or copies them when gridStep is 0
+    static void downsample(const std::vector<T> &points, const std::vector<T> &normals,
+                           double gridStep, std::vector<T> &outPoints, std::vector<T> &outNormals)
+    {
+        const int n = (int)points.size() / 3;
+        if (gridStep <= 0 || n == 0)
+        {
+            outPoints = points;
+            outNormals = normals;
+            return;
+        }
+
+        T limits[6];
+        for (int d = 0; d < 3; d++)
+        {
+            limits[2 * d] = limits[2 * d + 1] = points[d];
+            for (int i = 1; i < n; i++)
+            {
+                limits[2 * d] = std::min(limits[2 * d], points[3 * (size_t)i + d]);
+                limits[2 * d + 1] = std::max(limits[2 * d + 1], points[3 * (size_t)i + d]);
+            }
+        }
+
+        voxelgrid::VoxelGridResult<T> result;
+        voxelgrid::VoxelGridFilter<T>::filter(&points[0], NULL,
+            normals.empty() ? NULL : &normals[0], n, true, (T)gridStep, limits, result);
+        outPoints.swap(result.location);
+        outNormals.swap(result.normal);
+    }
+
+    // Normals of the points of the level, from the principal axes of their
+    // ICP_NORMAL_NEIGHBORS nearest neighbors
+    static void computeNormals(Level &level)
+    {
+        const int n = (int)level.location.size() / 3;
+        level.normal.assign(3 * (size_t)n, std::numeric_limits<T>::quiet_NaN());
+        if (n < 3)
+            return;
+
+        const int K = std::min(ICP_NORMAL_NEIGHBORS, n);
+        level.tree.index(&level.location[0], n, true);
+        std::vector<uint32_T> indices((size_t)K * n), valid(n);
+        std::vector<T> dists((size_t)K * n);
+        level.tree.knnSearch(&level.location[0], n, K, 0, true, &indices[0], &dists[0], &valid[0]);
+
+        const int numBlocks = (n + ICP_BLOCK_POINTS - 1) / ICP_BLOCK_POINTS;
+#ifdef PARALLEL
+        cgParallelForWorkers(numBlocks, [&](int, int blk) {
+            normalsBlock(level, indices, valid, blk);
+        });
+#else
+        for (int blk = 0; blk < numBlocks; blk++)
+            normalsBlock(level, indices, valid, blk);
+#endif
+    }
+
+    // Normals of block blk of the points of the level, from the K nearest
+    // neighbors of each point, K-by-n in indices
+    static void normalsBlock(Level &level, const std::vector<uint32_T> &indices,
+                             const std::vector<uint32_T> &valid, int blk)
+    {
+        const int n = (int)valid.size();
+        const int end = std::min(n, (blk + 1) * ICP_BLOCK_POINTS);
+        for (int i = blk * ICP_BLOCK_POINTS; i < end; i++)
+        {
+            const int count = (int)valid[i];
+            if (count < 3)
+                continue;
+            cv::Vec3d mean(0, 0, 0);
+            for (int k = 0; k < count; k++)
+            {
+                const T *p = &level.location[3 * (size_t)(indices[(size_t)k * n + i] - 1)];
+                mean += cv::Vec3d(p[0], p[1], p[2]);
+            }
+            mean *= 1.0 / count;
+            cv::Matx33d cov = cv::Matx33d::zeros();
+            for (int k = 0; k < count; k++)
+            {
+                const T *p = &level.location[3 * (size_t)(indices[(size_t)k * n + i] - 1)];
+                const cv::Vec3d v = cv::Vec3d(p[0], p[1], p[2]) - mean;
+                cov += v * v.t();
+            }
+            cv::Matx31d eigenvalues;
+            cv::Matx33d eigenvectors;
+            cv::eigen(cov, eigenvalues, eigenvectors);
+            // eigenvalues in descending order
+            for (int d = 0; d < 3; d++)
+                level.normal[3 * (size_t)i + d] = (T)eigenvectors(2, d);
+        }
+    }
+
+    // Normalizes the normals of the level and removes the points without
+    // one
+    static void removeInvalidNormals(Level &level)
+    {
+        const int n = (int)level.location.size() / 3;
+        int numValid = 0;
+        for (int i = 0; i < n; i++)
+        {
+            const T *p = &level.location[3 * (size_t)i];
+            const T *nv = &level.normal[3 * (size_t)i];
+            const double norm = std::sqrt((double)nv[0] * nv[0] + (double)nv[1] * nv[1] +
+                                          (double)nv[2] * nv[2]);
+            if (!(norm > 0) || !isFinite((T)norm))
+                continue;
+            for (int d = 0; d < 3; d++)
+            {
+                level.normal[3 * (size_t)numValid + d] = (T)(nv[d] / norm);
+                level.location[3 * (size_t)numValid + d] = p[d];
+            }
+            numValid++;
+        }
+        level.location.resize(3 * (size_t)numValid);
+        level.normal.resize(3 * (size_t)numValid);
+    }
+
+    static Pose fromTform(const double *tform, bool isRowMajor)
+    {
+        Pose pose;
+        for (int r = 0; r < 4; r++)
+        {
+            for (int c = 0; c < 3; c++)
+            {
+                const double v = isRowMajor ? tform[4 * r + c] : tform[r + 4 * c];
+                if (r < 3)
+                    pose.R(c, r) = v;
+                else
+                    pose.T[c] = v;
+            }
+        }
+        return pose;
+    }
+
+    static void toTform(const Pose &pose, bool isRowMajor, double *tform)
+    {
+        for (int r = 0; r < 4; r++)
+        {
+            for (int c = 0; c < 4; c++)
+            {
+                double v;
+                if (c == 3)
+                    v = r == 3 ? 1 : 0;
+                else if (r < 3)
+                    v = pose.R(c, r);
+                else
+                    v = pose.T[c];
+                if (isRowMajor)
+                    tform[4 * r + c] = v;
+                else
+                    tform[r + 4 * c] = v;
+            }
+        }
+    }
+
+    static cv::Vec4d toQuaternion(const cv::Matx33d &R)
+    {
+        cv::Vec4d q;
+        const double trace = R(0, 0) + R(1, 1) + R(2, 2);
+        if (trace > 0)
+        {
+            const double s = 2 * std::sqrt(trace + 1);
+            q = cv::Vec4d(s / 4, (R(2, 1) - R(1, 2)) / s, (R(0, 2) - R(2, 0)) / s,
+                          (R(1, 0) - R(0, 1)) / s);
+        }
+        else if (R(0, 0) > R(1, 1) && R(0, 0) > R(2, 2))
+        {
+            const double s = 2 * std::sqrt(1 + R(0, 0) - R(1, 1) - R(2, 2));
+            q = cv::Vec4d((R(2, 1) - R(1, 2)) / s, s / 4, (R(0, 1) + R(1, 0)) / s,
+                          (R(0, 2) + R(2, 0)) / s);
+        }
+        else if (R(1, 1) > R(2, 2))
+        {
+            const double s = 2 * std::sqrt(1 + R(1, 1) - R(0, 0) - R(2, 2));
+            q = cv::Vec4d((R(0, 2) - R(2, 0)) / s, (R(0, 1) + R(1, 0)) / s, s / 4,
+                          (R(1, 2) + R(2, 1)) / s);
+        }
+        else
+        {
+            const double s = 2 * std::sqrt(1 + R(2, 2) - R(0, 0) - R(1, 1));
+            q = cv::Vec4d((R(1, 0) - R(0, 1)) / s, (R(0, 2) + R(2, 0)) / s,
+                          (R(1, 2) + R(2, 1)) / s, s / 4);
+        }
+        return q;
+    }
+
+    int registerLevel(const Level &level, const std::vector<T> &moving, const IcpParams &params,
+                      Pose &pose, double *rmse, int *numIterations)
+    {
+        const int n = (int)moving.size() / 3;
+        if (n < 3)
+            return ICP_NOT_ENOUGH_POINTS;
+
+        const int upperBound =
+            std::min(n, std::max(1, (int)std::floor(params.inlierRatio * n + 0.5)));
+        if (upperBound < 3)
+            return ICP_NOT_ENOUGH_POINTS;
+        const int numBlocks = (n + ICP_BLOCK_POINTS - 1) / ICP_BLOCK_POINTS;
+
+        std::vector<T> transformed(3 * (size_t)n);
+        std::vector<uint32_T> matches(n), valid(n);
+        std::vector<T> dists(n);
+        std::vector<int> order(n);
+        std::vector<char> isInlier(n);
+        std::vector<BlockSums> sums(numBlocks);
+
+        // rotations and translations of the iterations, for the convergence
+        std::vector<cv::Vec4d> rotations(1, toQuaternion(pose.R));
+        std::vector<cv::Vec3d> translations(1, pose.T);
+
+        for (int iter = 0; iter < params.maxIterations; iter++)
+        {
+            transform(moving, pose, numBlocks, transformed);
+            level.tree.knnSearch(&transformed[0], n, 1, 0, true, &matches[0], &dists[0], &valid[0]);
+
+            // the upperBound matches of smallest distance
+            for (int i = 0; i < n; i++)
+                order[i] = i;
+            std::nth_element(order.begin(), order.begin() + (upperBound - 1), order.end(),
+                             DistanceLess(dists));
+            std::fill(isInlier.begin(), isInlier.end(), (char)0);
+            for (int k = 0; k < upperBound; k++)
+                isInlier[order[k]] = 1;
+
+            Pose delta;
+            const int status = mIsPointToPlane
+                ? estimatePointToPlane(level, transformed, matches, isInlier, numBlocks, sums, delta)
+                : estimatePointToPoint(level, transformed, matches, isInlier, upperBound,
+                                       numBlocks, sums, delta);
+            if (status != ICP_SUCCESS)
+                return status;
+
+            pose.R = delta.R * pose.R;
+            pose.T = delta.R * pose.T + delta.T;
+            *rmse = inlierRmse(level, moving, pose, matches, isInlier, upperBound, numBlocks, sums);
+            *numIterations = iter + 1;
+
+            rotations.push_back(toQuaternion(pose.R));
+            translations.push_back(pose.T);
+            if (hasConverged(rotations, translations, params))
+                break;
+        }
+        return ICP_SUCCESS;
+    }
+
+    static void transform(const std::vector<T> &points, const Pose &pose, int numBlocks,
+                          std::vector<T> &out)
+    {
+#ifdef PARALLEL
+        cgParallelForWorkers(numBlocks, [&](int, int blk) {
+            transformBlock(points, pose, blk, out);
+        });
+#else
+        for (int blk = 0; blk < numBlocks; blk++)
+            transformBlock(points, pose, blk, out);
+#endif
+    }
+
+    // block blk of transform
+    static void transformBlock(const std::vector<T> &points, const Pose &pose, int blk,
+                               std::vector<T> &out)
+    {
+        const int n = (int)points.size() / 3;
+        const int end = std::min(n, (blk + 1) * ICP_BLOCK_POINTS);
+        for (int i = blk * ICP_BLOCK_POINTS; i < end; i++)
+        {
+            const T *p = &points[3 * (size_t)i];
+            for (int d = 0; d < 3; d++)
+                out[3 * (size_t)i + d] = (T)(pose.R(d, 0) * p[0] + pose.R(d, 1) * p[1] +
+                                             pose.R(d, 2) * p[2] + pose.T[d]);
+        }
+    }
+
+    // Kabsch: the rotation and translation mapping the inliers of p onto
+    // their matches with least squares, as rigidTransform3D
+    static int estimatePointToPoint(const Level &level, const std::vector<T> &p,
+                                    const std::vector<uint32_T> &matches,
+                                    const std::vector<char> &isInlier, int numInliers,
+                                    int numBlocks, std::vector<BlockSums> &sums, Pose &delta)
+    {
+#ifdef PARALLEL
+        cgParallelForWorkers(numBlocks, [&](int, int blk) {
+            sumPointToPoint(level, p, matches, isInlier, blk, sums[blk]);
+        });
+#else
+        for (int blk = 0; blk < numBlocks; blk++)
+            sumPointToPoint(level, p, matches, isInlier, blk, sums[blk]);
+#endif
+
+        cv::Vec3d centroidP(0, 0, 0), centroidQ(0, 0, 0);
+        cv::Matx33d H = cv::Matx33d::zeros();
+        for (int blk = 0; blk < numBlocks; blk++)
+        {
+            for (int r = 0; r < 3; r++)
+            {
+                centroidP[r] += sums[blk].sumP[r];
+                centroidQ[r] += sums[blk].sumQ[r];
+                for (int c = 0; c < 3; c++)
+                    H(r, c) += sums[blk].H[3 * r + c];
+            }
+        }
+        centroidP *= 1.0 / numInliers;
+        centroidQ *= 1.0 / numInliers;
+        // cross-covariance of the centered points
+        H -= numInliers * (centroidP * centroidQ.t());
+
+        cv::Matx33d w, u, vt;
+        cv::SVD::compute(H, w, u, vt);
+        const cv::Matx33d V = vt.t(), Ut = u.t();
+        const double d = cv::determinant(V * Ut) < 0 ? -1 : 1;
+        delta.R = V * cv::Matx33d(1, 0, 0, 0, 1, 0, 0, 0, d) * Ut;
+        delta.T = centroidQ - delta.R * centroidP;
+
+        for (int r = 0; r < 3; r++)
+        {
+            if (cvIsNaN(delta.T[r]) || cvIsNaN(delta.R(r, 0)) || cvIsNaN(delta.R(r, 1)) ||
+                cvIsNaN(delta.R(r, 2)))
+                return ICP_SINGULAR_MATRIX;
+        }
+        return ICP_SUCCESS;
+    }
+
+    // sums of the inliers of block blk of estimatePointToPoint
+    static void sumPointToPoint(const Level &level, const std::vector<T> &p,
+                                const std::vector<uint32_T> &matches,
+                                const std::vector<char> &isInlier, int blk, BlockSums &s)
+    {
+        s.clear();
+        const int end = std::min((int)matches.size(), (blk + 1) * ICP_BLOCK_POINTS);
+        for (int i = blk * ICP_BLOCK_POINTS; i < end; i++)
+        {
+            if (!isInlier[i])
+                continue;
+            const T *a = &p[3 * (size_t)i];
+            const T *b = &level.location[3 * (size_t)(matches[i] - 1)];
+            for (int r = 0; r < 3; r++)
+            {
+                s.sumP[r] += a[r];
+                s.sumQ[r] += b[r];
+                for (int c = 0; c < 3; c++)
+                    s.H[3 * r + c] += (double)a[r] * b[c];
+            }
+        }
+    }
+
+    // The rotation, of small angles, and translation minimizing the
+    // distances of the inliers of p to the planes of their matches, as
+    // pointToPlaneMetric
+    static int estimatePointToPlane(const Level &level, const std::vector<T> &p,
+                                    const std::vector<uint32_T> &matches,
+                                    const std::vector<char> &isInlier, int numBlocks,
+                                    std::vector<BlockSums> &sums, Pose &delta)
+    {
+#ifdef PARALLEL
+        cgParallelForWorkers(numBlocks, [&](int, int blk) {
+            sumPointToPlane(level, p, matches, isInlier, blk, sums[blk]);
+        });
+#else
+        for (int blk = 0; blk < numBlocks; blk++)
+            sumPointToPlane(level, p, matches, isInlier, blk, sums[blk]);
+#endif
+
+        cv::Matx66d C = cv::Matx66d::zeros();
+        cv::Vec6d b(0, 0, 0, 0, 0, 0);
+        for (int blk = 0; blk < numBlocks; blk++)
+        {
+            for (int i = 0; i < 6; i++)
+            {
+                for (int j = 0; j < 6; j++)
+                    C(i, j) += sums[blk].C[6 * i + j];
+                b[i] += sums[blk].b[i];
+            }
+        }
+
+        cv::Vec6d X;
+        if (!cv::solve(C, b, X, cv::DECOMP_CHOLESKY) && !cv::solve(C, b, X, cv::DECOMP_LU))
+            return ICP_SINGULAR_MATRIX;
+
+        const double cx = std::cos(X[0]), cy = std::cos(X[1]), cz = std::cos(X[2]);
+        const double sx = std::sin(X[0]), sy = std::sin(X[1]), sz = std::sin(X[2]);
+        delta.R = cv::Matx33d(cy * cz, sx * sy * cz - cx * sz, cx * sy * cz + sx * sz,
+                              cy * sz, cx * cz + sx * sy * sz, cx * sy * sz - sx * cz,
+                              -sy, sx * cy, cx * cy);
+        delta.T = cv::Vec3d(X[3], X[4], X[5]);
+
+        for (int i = 0; i < 6; i++)
+        {
+            if (cvIsNaN(X[i]))
+                return ICP_SINGULAR_MATRIX;
+        }
+        return ICP_SUCCESS;
+    }
+
+    // normal equations of the inliers of block blk of estimatePointToPlane
+    static void sumPointToPlane(const Level &level, const std::vector<T> &p,
+                                const std::vector<uint32_T> &matches,
+                                const std::vector<char> &isInlier, int blk, BlockSums &s)
+    {
+        s.clear();
+        const int end = std::min((int)matches.size(), (blk + 1) * ICP_BLOCK_POINTS);
+        for (int i = blk * ICP_BLOCK_POINTS; i < end; i++)
+        {
+            if (!isInlier[i])
+                continue;
+            const T *a = &p[3 * (size_t)i];
+            const size_t j = 3 * (size_t)(matches[i] - 1);
+            const T *b = &level.location[j];
+            const T *nv = &level.normal[j];
+            // [cross(a, nv), nv] and the distance of a to the plane
+            const double cn[6] = {
+                (double)a[1] * nv[2] - (double)a[2] * nv[1],
+                (double)a[2] * nv[0] - (double)a[0] * nv[2],
+                (double)a[0] * nv[1] - (double)a[1] * nv[0],
+                nv[0], nv[1], nv[2]};
+            const double r = ((double)b[0] - a[0]) * nv[0] + ((double)b[1] - a[1]) * nv[1] +
+                             ((double)b[2] - a[2]) * nv[2];
+            accumulatePointToPlane(cn, r, s.C, s.b);
+        }
+    }
+
+    // Root mean square distance of the inliers of moving, at pose, to
+    // their matches
+    static double inlierRmse(const Level &level, const std::vector<T> &moving, const Pose &pose,
+                             const std::vector<uint32_T> &matches,
+                             const std::vector<char> &isInlier, int numInliers, int numBlocks,
+                             std::vector<BlockSums> &sums)
+    {
+#ifdef PARALLEL
+        cgParallelForWorkers(numBlocks, [&](int, int blk) {
+            sumSquaredErrors(level, moving, pose, matches, isInlier, blk, sums[blk]);
+        });
+#else
+        for (int blk = 0; blk < numBlocks; blk++)
+            sumSquaredErrors(level, moving, pose, matches, isInlier, blk, sums[blk]);
+#endif
+
+        double sumSquares = 0;
+        for (int blk = 0; blk < numBlocks; blk++)
+            sumSquares += sums[blk].sumSquares;
+        return std::sqrt(sumSquares / numInliers);
+    }
+
+    // squared distances of the inliers of block blk of inlierRmse
+    static void sumSquaredErrors(const Level &level, const std::vector<T> &moving,
+                                 const Pose &pose, const std::vector<uint32_T> &matches,
+                                 const std::vector<char> &isInlier, int blk, BlockSums &s)
+    {
+        s.sumSquares = 0;
+        const int end = std::min((int)matches.size(), (blk + 1) * ICP_BLOCK_POINTS);
+        for (int i = blk * ICP_BLOCK_POINTS; i < end; i++)
+        {
+            if (!isInlier[i])
+                continue;
+            const T *a = &moving[3 * (size_t)i];
+            const T *b = &level.location[3 * (size_t)(matches[i] - 1)];
+            for (int d = 0; d < 3; d++)
+            {
+                const double e = pose.R(d, 0) * a[0] + pose.R(d, 1) * a[1] +
+                                 pose.R(d, 2) * a[2] + pose.T[d] - b[d];
+                s.sumSquares += e * e;
+            }
+        }
+    }
+
+    // Whether the average change of rotation and translation over the last
+    // three iterations is within the tolerance, as pcregrigid
+    static bool hasConverged(const std::vector<cv::Vec4d> &rotations,
+                             const std::vector<cv::Vec3d> &translations, const IcpParams &params)
+    {
+        const int last = (int)rotations.size() - 1;
+        double dR = 0, dT = 0;
+        int count = 0;
+        for (int k = std::max(last - 3, 0); k < last; k++)
+        {
+            const double c = rotations[k].dot(rotations[k + 1]) /
+                             (cv::norm(rotations[k]) * cv::norm(rotations[k + 1]));
+            dR += std::acos(std::min(1.0, std::abs(c)));
+            dT += cv::norm(translations[k] - translations[k + 1]);
+            count++;
+        }
+        return dT / count <= params.tolerance[0] && dR / count <= params.tolerance[1];
+    }
+
+    bool mIsPointToPlane;
+
+    // fixed cloud at each grid step of the schedule
+    std::vector<Level *> mLevels;
+
+    // prevent copying
+    RigidIcp(const RigidIcp &);
+    RigidIcp &operator=(const RigidIcp &);
+};
+
+} // namespace icp
+
+#endif
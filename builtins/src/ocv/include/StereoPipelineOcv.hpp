@@ -0,0 +1,231 @@
+//////////////////////////////////////////////////////////////////////////////
+// Stateful stereo pipeline: rectification, disparity and reconstruction.
+//
+// The rectification maps of ImageTransformer (1-based source coordinates
+// of each rectified pixel) are set once and converted to the fixed point
+// tables of cv::remap. Each step remaps the raw frames straight into the
+// padded row major frames of the matcher, so the rectified frames, their
+// transposed copies and the transposed disparity are never stored. A
+// column major frame is the row major transpose of the image, so it is
+// remapped with its x and y maps swapped, without a transposed copy.
+//
+// The disparity is written in the caller's layout, and optionally the
+// M-by-N-by-3 [X, Y, Z] of each pixel, [x, y, disparity, 1] * Q as in
+// reconstructScene, NaN where the disparity is invalid.
+//
+// Copyright 2016 The MathWorks, Inc.
+//
+//////////////////////////////////////////////////////////////////////////////
+#ifndef STEREO_PIPELINE_OCV
+#define STEREO_PIPELINE_OCV
+
+#include <cfloat>
+#include <limits>
+
+#include "stereoPipelineCore_api.hpp"
+#include "DisparityBMOcv.hpp"
+#include "DisparitySGBMOcv.hpp"
+#include "cgThreadPool.hpp"
+#include "cgProfile.hpp"
+
+#include "opencv2/imgproc.hpp"
+
+#ifdef PARALLEL
+// Minimum number of rows reconstructed by one thread
+#define STEREO_MIN_ROWS_PER_BLOCK 32
+#endif
+
+namespace disparity
+{
+
+class StereoPipelineOcv
+{
+public:
+    StereoPipelineOcv() : mRows(0), mCols(0), mInterp(cv::INTER_LINEAR),
+                          mFillValue(0), mTablesRowMajor(false) {}
+
+    // Sets the maps of both cameras, nRows-by-nCols like the rectified
+    // frames and column major unless isRowMajor is true, the interpolation
+    // (0: nearest, 1: linear, 2: cubic), the value of pixels mapped outside
+    // the raw frames and the 4-by-4 Q of the rectification parameters.
+    void setMaps(const real32_T *xMap1, const real32_T *yMap1,
+                 const real32_T *xMap2, const real32_T *yMap2,
+                 int nRows, int nCols, int interp, uint8_T fillValue,
+                 const real64_T *Q, bool isRowMajor)
+    {
+        mRows = nRows;
+        mCols = nCols;
+        mInterp = (interp == 0) ? cv::INTER_NEAREST :
+                  (interp == 2) ? cv::INTER_CUBIC : cv::INTER_LINEAR;
+        mFillValue = fillValue;
+
+        // maps are kept row major with 0-based coordinates
+        toMap(xMap1, nRows, nCols, isRowMajor, mXMap[0]);
+        toMap(yMap1, nRows, nCols, isRowMajor, mYMap[0]);
+        toMap(xMap2, nRows, nCols, isRowMajor, mXMap[1]);
+        toMap(yMap2, nRows, nCols, isRowMajor, mYMap[1]);
+        buildTables(isRowMajor);
+
+        for (int i = 0; i < 4; ++i)
+        {
+            for (int j = 0; j < 4; ++j)
+            {
+                mQ[i][j] = isRowMajor ? Q[4*i + j] : Q[i + 4*j];
+            }
+        }
+    }
+
+    // Rectifies the inRows-by-inCols raw frames image1 and image2, matches
+    // them with params and writes the nRows-by-nCols dis of setMaps and,
+    // when xyz is not NULL, its nRows-by-nCols-by-3 points
+    template <typename Matcher, typename Params>
+    void step(Matcher &matcher, const uint8_T *image1, const uint8_T *image2,
+              int inRows, int inCols, real32_T *dis, real32_T *xyz,
+              const Params *params, bool isRowMajor)
+    {
+        if (mTablesRowMajor != isRowMajor)
+        {
+            buildTables(isRowMajor);
+        }
+
+        matcher.createFrames(mRows, mCols, params);
+        rectify(image1, inRows, inCols, 0, isRowMajor, matcher.frame1());
+        rectify(image2, inRows, inCols, 1, isRowMajor, matcher.frame2());
+
+        matcher.stepFrames(mRows, mCols, dis, params, isRowMajor);
+        if (xyz)
+        {
+            reconstruct(dis, xyz, isRowMajor);
+        }
+    }
+
+    DisparityBMOcv &bm() { return mBm; }
+    DisparitySGBMOcv &sgbm() { return mSgbm; }
+
+private:
+    static void toMap(const real32_T *in, int nRows, int nCols, bool isRowMajor,
+                      cv::Mat &map)
+    {
+        map.create(nRows, nCols, CV_32FC1);
+        for (int r = 0; r < nRows; ++r)
+        {
+            float *out = map.ptr<float>(r);
+            for (int c = 0; c < nCols; ++c)
+            {
+                out[c] = (isRowMajor ? in[(size_t)r*nCols + c]
+                                     : in[r + (size_t)c*nRows]) - 1.0f;
+            }
+        }
+    }
+
+    // Fixed point tables of both cameras for frames of the given layout; a
+    // column major frame is read as its transpose, with swapped maps
+    void buildTables(bool isRowMajor)
+    {
+        for (int k = 0; k < 2; ++k)
+        {
+            const cv::Mat &x = isRowMajor ? mXMap[k] : mYMap[k];
+            const cv::Mat &y = isRowMajor ? mYMap[k] : mXMap[k];
+            cv::convertMaps(x, y, mTable1[k], mTable2[k], CV_16SC2,
+                            mInterp == cv::INTER_NEAREST);
+        }
+        mTablesRowMajor = isRowMajor;
+    }
+
+    // Remaps raw frame k into the first mCols columns of the padded frame,
+    // whose padding columns are zero as in the matcher's own copies
+    void rectify(const uint8_T *image, int inRows, int inCols, int k,
+                 bool isRowMajor, cv::Mat &frame)
+    {
+        const cv::Mat src = isRowMajor
+            ? cv::Mat(inRows, inCols, CV_8UC1, (void *)image)
+            : cv::Mat(inCols, inRows, CV_8UC1, (void *)image);
+
+        cv::Mat dst = frame.colRange(0, mCols);
+        cv::remap(src, dst, mTable1[k], mTable2[k], mInterp,
+                  cv::BORDER_CONSTANT, cv::Scalar(mFillValue));
+        if (frame.cols > mCols)
+        {
+            frame.colRange(mCols, frame.cols).setTo(cv::Scalar(0));
+        }
+    }
+
+    void reconstruct(const real32_T *dis, real32_T *xyz, bool isRowMajor)
+    {
+#ifdef PARALLEL
+        cgParallelForRows(mRows, STEREO_MIN_ROWS_PER_BLOCK, [&](int r0, int r1) {
+            reconstructRows(dis, xyz, r0, r1, isRowMajor);
+        });
+#else
+        reconstructRows(dis, xyz, 0, mRows, isRowMajor);
+#endif
+    }
+
+    // [X, Y, Z] of rows [r0, r1); x and y are 1-based as in MATLAB
+    void reconstructRows(const real32_T *dis, real32_T *xyz, int r0, int r1,
+                         bool isRowMajor)
+    {
+        const size_t numPixels = (size_t)mRows * mCols;
+        const float nan = std::numeric_limits<float>::quiet_NaN();
+        for (int r = r0; r < r1; ++r)
+        {
+            const double y = r + 1;
+            for (int c = 0; c < mCols; ++c)
+            {
+                const size_t idx = isRowMajor ? (size_t)r*mCols + c
+                                              : r + (size_t)c*mRows;
+                real32_T *X = isRowMajor ? xyz + 3*idx : xyz + idx;
+                real32_T *Y = isRowMajor ? X + 1 : X + numPixels;
+                real32_T *Z = isRowMajor ? X + 2 : X + 2*numPixels;
+
+                const real32_T d = dis[idx];
+                if (d == -FLT_MAX)
+                {
+                    *X = nan;
+                    *Y = nan;
+                    *Z = nan;
+                    continue;
+                }
+
+                const double x = c + 1;
+                double p[4];
+                for (int j = 0; j < 4; ++j)
+                {
+                    p[j] = x*mQ[0][j] + y*mQ[1][j] + d*mQ[2][j] + mQ[3][j];
+                }
+                const double w = 1.0 / p[3];
+                *X = (real32_T)(p[0] * w);
+                *Y = (real32_T)(p[1] * w);
+                *Z = (real32_T)(p[2] * w);
+            }
+        }
+    }
+
+    DisparityBMOcv mBm;
+    DisparitySGBMOcv mSgbm;
+
+    // rectified size, interpolation and fill value
+    int mRows;
+    int mCols;
+    int mInterp;
+    uint8_T mFillValue;
+
+    // row major 0-based maps, and the remap tables built from them for
+    // frames of layout mTablesRowMajor
+    cv::Mat mXMap[2];
+    cv::Mat mYMap[2];
+    cv::Mat mTable1[2];
+    cv::Mat mTable2[2];
+    bool mTablesRowMajor;
+
+    // [x, y, disparity, 1] * mQ = [X, Y, Z, 1] * w
+    double mQ[4][4];
+
+    // copying and assignment are disallowed
+    StereoPipelineOcv(const StereoPipelineOcv &);
+    StereoPipelineOcv &operator=(const StereoPipelineOcv &);
+};
+
+} // namespace disparity
+
+#endif
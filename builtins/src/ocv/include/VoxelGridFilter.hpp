@@ -0,0 +1,369 @@
+//////////////////////////////////////////////////////////////////////////////
+// Voxel grid filter of pcdownsample ('gridAverage') and pcmerge.
+//
+// The box rangeLimits, [xmin xmax ymin ymax zmin zmax], is divided into
+// cubic voxels of side gridStep from its lower corner. The points in the box
+// are replaced by one point per occupied voxel, the mean of their
+// locations, colors and normals; the points outside the box, or with a
+// coordinate that is not finite, are kept as they are. The voxels come first, in the order of their linear index with
+// x fastest, then the points outside the box in their order.
+//
+// The points are grouped by sorting their voxel keys with a stable radix
+// sort on the bits the keys use, the keys of blocks of points being counted
+// and scattered in parallel, so the memory is a few words per point
+// whatever the extent of the grid. The voxels are then averaged in parallel,
+// each from its points in input order, so the results do not depend on the
+// number of threads. Grids with more voxels than a 64-bit key can count
+// fall back to a comparison sort.
+//
+// Copyright 2016 The MathWorks, Inc.
+//
+//////////////////////////////////////////////////////////////////////////////
+#ifndef VOXEL_GRID_FILTER
+#define VOXEL_GRID_FILTER
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include "vision_defines.h"
+#include "cgThreadPool.hpp"
+
+// points per block of the pool
+#define VOXEL_MIN_POINTS_PER_BLOCK 4096
+// points per block of a pass of the radix sort
+#define VOXEL_RADIX_BLOCK_POINTS 65536
+// bits sorted by a pass of the radix sort
+#define VOXEL_RADIX_BITS 8
+
+namespace voxelgrid
+{
+
+#ifdef PARALLEL
+template <typename Fcn>
+inline void forRows(int numRows, Fcn fcn)
+{
+    cgParallelForRows(numRows, VOXEL_MIN_POINTS_PER_BLOCK, fcn);
+}
+#endif
+
+// Filtered point cloud, row major numPoints-by-3 arrays. color and normal
+// are empty when the input has none.
+template <typename T>
+struct VoxelGridResult
+{
+    int numPoints;
+    std::vector<T> location;
+    std::vector<uint8_T> color;
+    std::vector<T> normal;
+};
+
+template <typename T>
+class VoxelGridFilter
+{
+public:
+    // Filters numPoints-by-3 location, color and normal, column major
+    // unless isRowMajor. color and normal may be NULL.
+    static void filter(const T *location, const uint8_T *color, const T *normal,
+                       int numPoints, bool isRowMajor, T gridStep, const T *rangeLimits,
+                       VoxelGridResult<T> &result)
+    {
+        VoxelGridFilter<T> filter(location, color, normal, numPoints, isRowMajor);
+        filter.run(gridStep, rangeLimits, result);
+    }
+
+private:
+    typedef unsigned long long Key;
+
+    VoxelGridFilter(const T *location, const uint8_T *color, const T *normal,
+                    int numPoints, bool isRowMajor)
+        : mLocation(location), mColor(color), mNormal(normal),
+          mNumPoints(numPoints), mIsRowMajor(isRowMajor) {}
+
+    template <typename U>
+    U get(const U *a, int i, int d) const
+    {
+        return mIsRowMajor ? a[3 * (size_t)i + d] : a[i + (size_t)d * mNumPoints];
+    }
+
+    void run(T gridStep, const T *rangeLimits, VoxelGridResult<T> &result)
+    {
+        // voxels of the box along each dimension
+        double lower[3], counts[3];
+        for (int d = 0; d < 3; d++)
+        {
+            lower[d] = rangeLimits[2 * d];
+            counts[d] = std::floor((rangeLimits[2 * d + 1] - lower[d]) / gridStep) + 1;
+            if (!(counts[d] >= 1))
+                counts[d] = 0;
+        }
+        const double numVoxels = counts[0] * counts[1] * counts[2];
+        const bool hasKeys = numVoxels > 0 && numVoxels < 1.8e19;
+
+        // voxel of each point, when the keys can count the voxels
+        const Key nx = hasKeys ? (Key)counts[0] : 0, ny = hasKeys ? (Key)counts[1] : 0;
+        std::vector<char> isInBox(mNumPoints);
+        std::vector<Key> pointKeys(hasKeys ? mNumPoints : 0);
+#ifdef PARALLEL
+        forRows(mNumPoints, [&](int begin, int end) {
+            locatePoints(lower, counts, gridStep, nx, ny, isInBox, pointKeys, begin, end);
+        });
+#else
+        locatePoints(lower, counts, gridStep, nx, ny, isInBox, pointKeys, 0, mNumPoints);
+#endif
+
+        // points of the box, with their keys or, without keys, their
+        // voxel by coordinate
+        std::vector<int> inBox;
+        std::vector<Key> keys, cells;
+        for (int i = 0; i < mNumPoints; i++)
+        {
+            if (!isInBox[i])
+                continue;
+            inBox.push_back(i);
+            if (hasKeys)
+            {
+                keys.push_back(pointKeys[i]);
+            }
+            else
+            {
+                Key c[3];
+                getCell(i, lower, counts, gridStep, c);
+                cells.insert(cells.end(), c, c + 3);
+            }
+        }
+        std::vector<Key>().swap(pointKeys);
+        const int numInBox = (int)inBox.size();
+
+        // positions into inBox, sorted by voxel and then position
+        std::vector<int> order(numInBox);
+        for (int i = 0; i < numInBox; i++)
+            order[i] = i;
+
+        if (hasKeys)
+        {
+            int numBits = 0;
+            while (numBits < 64 && (double)(1ULL << numBits) < numVoxels)
+                numBits++;
+            radixSort(keys, order, numBits);
+        }
+        else
+        {
+            std::stable_sort(order.begin(), order.end(), CellLess(cells));
+        }
+
+        // first sorted point of each voxel
+        std::vector<int> starts;
+        for (int i = 0; i < numInBox; i++)
+        {
+            if (i == 0 || !isSameVoxel(cells, keys, order[i - 1], order[i]))
+                starts.push_back(i);
+        }
+        const int numVoxelsOut = (int)starts.size();
+        starts.push_back(numInBox);
+
+        std::vector<int> outside;
+        for (int i = 0; i < mNumPoints; i++)
+        {
+            if (!isInBox[i])
+                outside.push_back(i);
+        }
+
+        const int numOut = numVoxelsOut + (int)outside.size();
+        result.numPoints = numOut;
+        result.location.resize(3 * (size_t)numOut);
+        result.color.resize(mColor ? 3 * (size_t)numOut : 0);
+        result.normal.resize(mNormal ? 3 * (size_t)numOut : 0);
+
+#ifdef PARALLEL
+        forRows(numVoxelsOut, [&](int begin, int end) {
+            averageVoxels(starts, inBox, order, result, begin, end);
+        });
+#else
+        averageVoxels(starts, inBox, order, result, 0, numVoxelsOut);
+#endif
+
+        for (size_t k = 0; k < outside.size(); k++)
+        {
+            const size_t o = numVoxelsOut + k;
+            for (int d = 0; d < 3; d++)
+            {
+                result.location[3 * o + d] = get(mLocation, outside[k], d);
+                if (mColor)
+                    result.color[3 * o + d] = get(mColor, outside[k], d);
+                if (mNormal)
+                    result.normal[3 * o + d] = get(mNormal, outside[k], d);
+            }
+        }
+    }
+
+    // Order of positions by the voxel of cells, z first
+    struct CellLess
+    {
+        explicit CellLess(const std::vector<Key> &c) : cells(c) {}
+
+        bool operator()(int a, int b) const
+        {
+            const Key *ca = &cells[3 * (size_t)a], *cb = &cells[3 * (size_t)b];
+            if (ca[2] != cb[2]) return ca[2] < cb[2];
+            if (ca[1] != cb[1]) return ca[1] < cb[1];
+            return ca[0] < cb[0];
+        }
+
+        const std::vector<Key> &cells;
+    };
+
+    // Whether the points [begin, end) are in the box and, when the keys can
+    // count the voxels (nx > 0), their keys
+    void locatePoints(const double *lower, const double *counts, T gridStep, Key nx, Key ny,
+                      std::vector<char> &isInBox, std::vector<Key> &pointKeys,
+                      int begin, int end) const
+    {
+        for (int i = begin; i < end; i++)
+        {
+            Key c[3];
+            isInBox[i] = getCell(i, lower, counts, gridStep, c);
+            if (isInBox[i] && !pointKeys.empty())
+                pointKeys[i] = c[0] + nx * (c[1] + ny * c[2]);
+        }
+    }
+
+    // Means of the points of the voxels [begin, end), whose sorted points
+    // start at starts
+    void averageVoxels(const std::vector<int> &starts, const std::vector<int> &inBox,
+                       const std::vector<int> &order, VoxelGridResult<T> &result,
+                       int begin, int end) const
+    {
+        for (int v = begin; v < end; v++)
+        {
+            double sumLocation[3] = {0, 0, 0}, sumColor[3] = {0, 0, 0},
+                   sumNormal[3] = {0, 0, 0};
+            for (int k = starts[v]; k < starts[v + 1]; k++)
+            {
+                const int i = inBox[order[k]];
+                for (int d = 0; d < 3; d++)
+                {
+                    sumLocation[d] += get(mLocation, i, d);
+                    if (mColor)
+                        sumColor[d] += get(mColor, i, d);
+                    if (mNormal)
+                        sumNormal[d] += get(mNormal, i, d);
+                }
+            }
+            const double count = starts[v + 1] - starts[v];
+            for (int d = 0; d < 3; d++)
+            {
+                result.location[3 * (size_t)v + d] = (T)(sumLocation[d] / count);
+                if (mColor)
+                    result.color[3 * (size_t)v + d] =
+                        (uint8_T)std::min(255.0, std::floor(sumColor[d] / count + 0.5));
+                if (mNormal)
+                    result.normal[3 * (size_t)v + d] = (T)(sumNormal[d] / count);
+            }
+        }
+    }
+
+    // Voxel of point i along each dimension, false when the point is not
+    // finite or outside the box
+    bool getCell(int i, const double *lower, const double *counts, T gridStep, Key *cell) const
+    {
+        for (int d = 0; d < 3; d++)
+        {
+            const double c = std::floor((get(mLocation, i, d) - lower[d]) / gridStep);
+            // false for NaN
+            if (!(c >= 0 && c < counts[d]))
+                return false;
+            cell[d] = (Key)c;
+        }
+        return true;
+    }
+
+    static bool isSameVoxel(const std::vector<Key> &cells, const std::vector<Key> &keys,
+                            int a, int b)
+    {
+        if (!keys.empty())
+            return keys[a] == keys[b];
+        return cells[3 * (size_t)a] == cells[3 * (size_t)b] &&
+               cells[3 * (size_t)a + 1] == cells[3 * (size_t)b + 1] &&
+               cells[3 * (size_t)a + 2] == cells[3 * (size_t)b + 2];
+    }
+
+    // Stable LSD radix sort of order by keys[order[i]], on the numBits low
+    // bits of the keys. Each pass counts the digits of blocks of points in
+    // parallel and scatters every block from its own offsets.
+    static void radixSort(const std::vector<Key> &keys, std::vector<int> &order, int numBits)
+    {
+        const int n = (int)order.size();
+        const int numDigits = 1 << VOXEL_RADIX_BITS;
+        const int numBlocks = (n + VOXEL_RADIX_BLOCK_POINTS - 1) / VOXEL_RADIX_BLOCK_POINTS;
+        std::vector<int> buffer(n);
+        std::vector<int> offsets((size_t)numBlocks * numDigits);
+
+        for (int shift = 0; shift < numBits; shift += VOXEL_RADIX_BITS)
+        {
+            std::fill(offsets.begin(), offsets.end(), 0);
+#ifdef PARALLEL
+            cgParallelForWorkers(numBlocks, [&](int, int b) {
+                countDigits(keys, order, shift, b, &offsets[(size_t)b * numDigits]);
+            });
+#else
+            for (int b = 0; b < numBlocks; b++)
+                countDigits(keys, order, shift, b, &offsets[(size_t)b * numDigits]);
+#endif
+
+            // offset of digit d of block b: the points of smaller digits,
+            // then those of digit d in the blocks before b
+            int total = 0;
+            for (int d = 0; d < numDigits; d++)
+            {
+                for (int b = 0; b < numBlocks; b++)
+                {
+                    int &offset = offsets[(size_t)b * numDigits + d];
+                    const int count = offset;
+                    offset = total;
+                    total += count;
+                }
+            }
+
+#ifdef PARALLEL
+            cgParallelForWorkers(numBlocks, [&](int, int b) {
+                scatterDigits(keys, order, shift, b, &offsets[(size_t)b * numDigits], buffer);
+            });
+#else
+            for (int b = 0; b < numBlocks; b++)
+                scatterDigits(keys, order, shift, b, &offsets[(size_t)b * numDigits], buffer);
+#endif
+            order.swap(buffer);
+        }
+    }
+
+    // count of the digits at shift of the keys of block b
+    static void countDigits(const std::vector<Key> &keys, const std::vector<int> &order,
+                            int shift, int b, int *count)
+    {
+        const int numDigits = 1 << VOXEL_RADIX_BITS;
+        const int end = std::min((int)order.size(), (b + 1) * VOXEL_RADIX_BLOCK_POINTS);
+        for (int i = b * VOXEL_RADIX_BLOCK_POINTS; i < end; i++)
+            count[(keys[order[i]] >> shift) & (numDigits - 1)]++;
+    }
+
+    // scatter of block b into buffer from the offsets of its digits
+    static void scatterDigits(const std::vector<Key> &keys, const std::vector<int> &order,
+                              int shift, int b, int *offset, std::vector<int> &buffer)
+    {
+        const int numDigits = 1 << VOXEL_RADIX_BITS;
+        const int end = std::min((int)order.size(), (b + 1) * VOXEL_RADIX_BLOCK_POINTS);
+        for (int i = b * VOXEL_RADIX_BLOCK_POINTS; i < end; i++)
+            buffer[offset[(keys[order[i]] >> shift) & (numDigits - 1)]++] = order[i];
+    }
+
+    const T *mLocation;
+    const uint8_T *mColor;
+    const T *mNormal;
+    int mNumPoints;
+    bool mIsRowMajor;
+};
+
+} // namespace voxelgrid
+
+#endif
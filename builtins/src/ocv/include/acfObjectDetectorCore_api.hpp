@@ -0,0 +1,53 @@
+/* Copyright 2016 The MathWorks, Inc. */
+
+#ifndef _ACFOBJECTDETECTOR_
+#define _ACFOBJECTDETECTOR_
+
+#include "vision_defines.h"
+
+/* Aggregate channel features detector of acfObjectDetector and
+   detectPeopleACF, see AcfDetector.hpp. */
+EXTERN_C LIBMWCVSTRT_API void acfObjectDetector_construct(void **ptr2ptrClass);
+
+/* Training options, as in acfObjectDetector.TrainingOptions. modelSize,
+   modelSizePadded and channelPadding are [height width]. lambdas are the
+   power laws of the color, gradient magnitude and histogram channels.
+   interpolateOrientation is true for the 'Orientation' interpolation of
+   the histograms and false for 'None'. */
+EXTERN_C LIBMWCVSTRT_API void acfObjectDetector_setup(void *ptrClass,
+	const double *modelSize, const double *modelSizePadded,
+	const double *channelPadding, int32_T shrink, int32_T numApprox,
+	int32_T numUpscaledOctaves, double smoothChannels,
+	double preSmoothColor, const double *lambdas,
+	boolean_T fullOrientation, double normalizationRadius,
+	double normalizationConstant, int32_T numBins, int32_T cellSize,
+	boolean_T interpolateOrientation);
+
+/* Boosted trees of acfObjectDetector.Classifier. fids, thrs, child and hs
+   are numNodes-by-numTrees, column major. treeDepth is the depth of all
+   the leaves, or 0 if it varies. */
+EXTERN_C LIBMWCVSTRT_API void acfObjectDetector_setClassifier(void *ptrClass,
+	const uint32_T *fids, const real32_T *thrs, const uint32_T *child,
+	const real32_T *hs, int32_T numNodes, int32_T numTrees,
+	int32_T treeDepth);
+
+/* Detection on the nRows-by-nCols single image inImg in [0, 1], RGB or
+   grayscale, column major. minSize and maxSize are [height width]. The
+   boxes are those of vision.internal.acf.detect, before rounding and
+   clipping, and are freed by acfObjectDetector_assignOutputDeleteVectors. */
+EXTERN_C LIBMWCVSTRT_API void acfObjectDetector_detect(void *ptrClass,
+	void **ptr2ptrBBoxes, void **ptr2ptrScores,
+	const real32_T *inImg, int32_T nRows, int32_T nCols, boolean_T isRGB,
+	int32_T numScaleLevels, const int32_T *ptrMinSize,
+	const int32_T *ptrMaxSize, int32_T windowStride, double threshold,
+	int32_T *numDetections);
+
+/* outBBox is numDetections-by-4 [x y width height], column major */
+EXTERN_C LIBMWCVSTRT_API void acfObjectDetector_assignOutputDeleteVectors(void *ptrBBoxes, void *ptrScores,
+	double *outBBox, double *outScore);
+EXTERN_C LIBMWCVSTRT_API void acfObjectDetector_assignOutputDeleteVectorsRM(void *ptrBBoxes, void *ptrScores,
+	double *outBBox, double *outScore);
+
+EXTERN_C LIBMWCVSTRT_API void acfObjectDetector_deleteObj(void *ptrClass);
+
+#endif
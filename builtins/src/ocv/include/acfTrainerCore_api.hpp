@@ -0,0 +1,62 @@
+/* Copyright 2016 The MathWorks, Inc. */
+
+#ifndef _ACFTRAINER_
+#define _ACFTRAINER_
+
+#include "vision_defines.h"
+
+/* Boosted trees of trainACFObjectDetector, see AcfTrainer.hpp */
+EXTERN_C LIBMWCVSTRT_API void acfTrainer_construct(void **ptr2ptrClass);
+
+/* Training options, as in acfObjectDetector_setup */
+EXTERN_C LIBMWCVSTRT_API void acfTrainer_setup(void *ptrClass,
+	const double *modelSize, const double *modelSizePadded,
+	const double *channelPadding, int32_T shrink, int32_T numApprox,
+	int32_T numUpscaledOctaves, double smoothChannels,
+	double preSmoothColor, const double *lambdas,
+	boolean_T fullOrientation, double normalizationRadius,
+	double normalizationConstant, int32_T numBins, int32_T cellSize,
+	boolean_T interpolateOrientation);
+
+/* X is numSamples-by-numFeatures, one instance per row, as returned by
+   computeSingleScaleChannels and reshaped in trainACFObjectDetector */
+EXTERN_C LIBMWCVSTRT_API void acfTrainer_addPositives(void *ptrClass,
+	const real32_T *X, int32_T numSamples, int32_T numFeatures);
+EXTERN_C LIBMWCVSTRT_API void acfTrainer_addPositivesRM(void *ptrClass,
+	const real32_T *X, int32_T numSamples, int32_T numFeatures);
+
+EXTERN_C LIBMWCVSTRT_API void acfTrainer_addNegatives(void *ptrClass,
+	const real32_T *X, int32_T numSamples, int32_T numFeatures);
+EXTERN_C LIBMWCVSTRT_API void acfTrainer_addNegativesRM(void *ptrClass,
+	const real32_T *X, int32_T numSamples, int32_T numFeatures);
+
+/* Adds the maxPerImage highest scoring windows of the last stage on the
+   nRows-by-nCols single image inImg in [0, 1], column major, that overlap
+   none of the numGt-by-4 [x y width height] boxes gtBoxes, column major.
+   Returns the number of negatives added. */
+EXTERN_C LIBMWCVSTRT_API int32_T acfTrainer_mineNegatives(void *ptrClass,
+	const real32_T *inImg, int32_T nRows, int32_T nCols, boolean_T isRGB,
+	const double *gtBoxes, int32_T numGt, int32_T numScaleLevels,
+	int32_T windowStride, double threshold, int32_T maxPerImage);
+EXTERN_C LIBMWCVSTRT_API int32_T acfTrainer_getNumNegatives(void *ptrClass);
+
+/* Trains a stage on the positives and at most numNegatives of the
+   accumulated negatives. Returns the number of trees; numNodes is the
+   number of nodes of the largest tree and treeDepth is as in
+   trainBoostTreeClassifier. */
+EXTERN_C LIBMWCVSTRT_API int32_T acfTrainer_trainStage(void *ptrClass,
+	int32_T numWeak, int32_T maxDepth, double fracFeatures,
+	double minWeight, double calibration, int32_T numNegatives,
+	int32_T *numNodes, int32_T *treeDepth);
+
+/* Trees of the last stage, numNodes-by-numTrees */
+EXTERN_C LIBMWCVSTRT_API void acfTrainer_getClassifier(void *ptrClass,
+	uint32_T *fids, real32_T *thrs, uint32_T *child, real32_T *hs,
+	real32_T *weights, uint32_T *depth);
+EXTERN_C LIBMWCVSTRT_API void acfTrainer_getClassifierRM(void *ptrClass,
+	uint32_T *fids, real32_T *thrs, uint32_T *child, real32_T *hs,
+	real32_T *weights, uint32_T *depth);
+
+EXTERN_C LIBMWCVSTRT_API void acfTrainer_deleteObj(void *ptrClass);
+
+#endif
@@ -63,6 +63,33 @@ void makeAgastOffsets(int pixel[16], int row_stride, int type);
 template<int type>
 int agast_cornerScore(const uchar* ptr, const int pixel[], int threshold);
 
+// TMW edit: same scores as agast_cornerScore, computed by a few short loops
+// over the circle in place of the decision tree
+template<int type>
+int agast_cornerScoreCompact(const uchar* ptr, const int pixel[], int threshold);
+
+// TMW edit: selection of the scores at run time. getAgastScoreFunc returns
+// the score of the given type, of the method last set with
+// setAgastScoreMethod.
+enum
+{
+    AGAST_SCORE_TREE    = 0, // agast_cornerScore
+    AGAST_SCORE_COMPACT = 1  // agast_cornerScoreCompact
+};
+
+// the compact scores are only faster than the trees with SIMD
+#if CV_SSE2 || CV_NEON
+#define AGAST_SCORE_DEFAULT AGAST_SCORE_COMPACT
+#else
+#define AGAST_SCORE_DEFAULT AGAST_SCORE_TREE
+#endif
+
+typedef int (*AgastScoreFunc)(const uchar* ptr, const int pixel[], int threshold);
+
+void setAgastScoreMethod(int method);
+int getAgastScoreMethod();
+AgastScoreFunc getAgastScoreFunc(int type);
+
 
 }
 #endif
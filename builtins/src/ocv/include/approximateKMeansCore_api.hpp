@@ -0,0 +1,37 @@
+/* Copyright 2016 The MathWorks, Inc. */
+
+#ifndef _APPROXIMATEKMEANS_
+#define _APPROXIMATEKMEANS_
+
+#include "vision_defines.h"
+
+/* Errors returned in place of the number of features clustered */
+#define APPROX_KMEANS_ERR_TOO_FEW_FEATURES -1 /* fewer valid features than clusters */
+#define APPROX_KMEANS_ERR_FILE             -2 /* features file missing or too short */
+
+/* Approximate k-means of bagOfFeatures, see ApproxKMeans.hpp. features is
+   numFeatures-by-numelInFeatureVec, row major. centers receives the
+   numClusters-by-numelInFeatureVec centers, row major, and assignments the
+   0-based cluster of each feature, -1 for the features with Inf or NaN
+   values, which are left out. Returns the number of features clustered. */
+EXTERN_C LIBMWCVSTRT_API
+int32_T approximateKMeans_real32(const real32_T * features,
+        const int32_T numFeatures, const int32_T numelInFeatureVec,
+        const int32_T numClusters, const int32_T maxIterations,
+        const real32_T threshold, const int32_T numTrials,
+        const boolean_T useKMeansPlusPlus, const uint32_T seed,
+        real32_T * centers, int32_T * assignments);
+
+/* Same, with the features mapped from filename, which holds them as
+   numFeatures-by-numelInFeatureVec single values, row major, e.g. written
+   with fwrite(fid, features', 'single'). The file is read in chunks, so it
+   may be larger than memory. */
+EXTERN_C LIBMWCVSTRT_API
+int32_T approximateKMeans_file_real32(const char * filename,
+        const int32_T numFeatures, const int32_T numelInFeatureVec,
+        const int32_T numClusters, const int32_T maxIterations,
+        const real32_T threshold, const int32_T numTrials,
+        const boolean_T useKMeansPlusPlus, const uint32_T seed,
+        real32_T * centers, int32_T * assignments);
+
+#endif
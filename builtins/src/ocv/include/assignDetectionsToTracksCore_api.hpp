@@ -0,0 +1,41 @@
+/* Copyright 2016 The MathWorks, Inc. */
+
+#ifndef _ASSIGNDETECTIONSTOTRACKS_
+#define _ASSIGNDETECTIONSTOTRACKS_
+
+#include "vision_defines.h"
+
+/* Assignment of assignDetectionsToTracks, see AssignmentSolver.hpp. cost
+   is numTracks-by-numDetections, column major, with one cost of
+   non-assignment per track and per detection. The number of outputs is
+   returned in numMatches, numUnassignedTracks and numUnassignedDetections,
+   and the assignment is freed by
+   assignDetectionsToTracks_assignOutputDelete. */
+EXTERN_C LIBMWCVSTRT_API
+void assignDetectionsToTracks_solve(const double * cost,
+        int32_T numTracks, int32_T numDetections,
+        const double * costUnassignedTracks, const double * costUnassignedDetections,
+        int32_T * numMatches, int32_T * numUnassignedTracks,
+        int32_T * numUnassignedDetections, void ** ptr2ptrAssignment);
+
+EXTERN_C LIBMWCVSTRT_API
+void assignDetectionsToTracks_solveRM(const double * cost,
+        int32_T numTracks, int32_T numDetections,
+        const double * costUnassignedTracks, const double * costUnassignedDetections,
+        int32_T * numMatches, int32_T * numUnassignedTracks,
+        int32_T * numUnassignedDetections, void ** ptr2ptrAssignment);
+
+/* Outputs of assignDetectionsToTracks, 1-based: matches is
+   numMatches-by-2 [track detection], by detection, and the unassigned
+   tracks and detections are in increasing order. */
+EXTERN_C LIBMWCVSTRT_API
+void assignDetectionsToTracks_assignOutputDelete(void * ptrAssignment,
+        uint32_T * matches, uint32_T * unassignedTracks,
+        uint32_T * unassignedDetections);
+
+EXTERN_C LIBMWCVSTRT_API
+void assignDetectionsToTracks_assignOutputDeleteRM(void * ptrAssignment,
+        uint32_T * matches, uint32_T * unassignedTracks,
+        uint32_T * unassignedDetections);
+
+#endif
@@ -0,0 +1,55 @@
+/* Copyright 2016 The MathWorks, Inc. */
+
+#ifndef _BBOXOVERLAP_
+#define _BBOXOVERLAP_
+
+#include "vision_defines.h"
+
+/* Overlap ratio of bboxOverlapRatio, see BoxOverlap.hpp. bboxA and bboxB
+   are numA-by-4 and numB-by-4 [x y width height], column major, and ratio
+   is numA-by-numB, by union or, when isDivByUnion is false, by the smaller
+   area. */
+EXTERN_C LIBMWCVSTRT_API
+void bboxOverlap_ratio(const double * bboxA, int32_T numA,
+        const double * bboxB, int32_T numB, boolean_T isDivByUnion,
+        double * ratio);
+
+EXTERN_C LIBMWCVSTRT_API
+void bboxOverlap_ratioRM(const double * bboxA, int32_T numA,
+        const double * bboxB, int32_T numB, boolean_T isDivByUnion,
+        double * ratio);
+
+EXTERN_C LIBMWCVSTRT_API
+void bboxOverlap_ratio_single(const float * bboxA, int32_T numA,
+        const float * bboxB, int32_T numB, boolean_T isDivByUnion,
+        float * ratio);
+
+EXTERN_C LIBMWCVSTRT_API
+void bboxOverlap_ratio_singleRM(const float * bboxA, int32_T numA,
+        const float * bboxB, int32_T numB, boolean_T isDivByUnion,
+        float * ratio);
+
+/* Greedy non-maximum suppression of selectStrongestBbox. bbox is
+   numBoxes-by-4, column major, with a score per box; isKept[i] is set
+   when box i survives the suppression. */
+EXTERN_C LIBMWCVSTRT_API
+void bboxOverlap_suppress(const double * bbox, const double * score,
+        int32_T numBoxes, double threshold, boolean_T isDivByUnion,
+        boolean_T * isKept);
+
+EXTERN_C LIBMWCVSTRT_API
+void bboxOverlap_suppressRM(const double * bbox, const double * score,
+        int32_T numBoxes, double threshold, boolean_T isDivByUnion,
+        boolean_T * isKept);
+
+EXTERN_C LIBMWCVSTRT_API
+void bboxOverlap_suppress_single(const float * bbox, const double * score,
+        int32_T numBoxes, double threshold, boolean_T isDivByUnion,
+        boolean_T * isKept);
+
+EXTERN_C LIBMWCVSTRT_API
+void bboxOverlap_suppress_singleRM(const float * bbox, const double * score,
+        int32_T numBoxes, double threshold, boolean_T isDivByUnion,
+        boolean_T * isKept);
+
+#endif
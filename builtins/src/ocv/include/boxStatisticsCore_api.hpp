@@ -0,0 +1,26 @@
+/* Copyright 2016 The MathWorks, Inc. */
+
+#ifndef _BOXSTATISTICS_
+#define _BOXSTATISTICS_
+
+#include "vision_defines.h"
+
+ /* Mean and standard deviation (normalized by n-1) of the winRows-by-winCols
+  * box of each pixel of the nRows-by-nCols image, the box being clipped to
+  * the image. stdDev may be NULL. */
+ EXTERN_C LIBMWCVSTRT_API void boxStatistics_meanStd_uint8(const uint8_T* img,
+	 int nRows, int nCols, int winRows, int winCols,
+	 real32_T* mean, real32_T* stdDev);
+ EXTERN_C LIBMWCVSTRT_API void boxStatistics_meanStd_uint8RM(const uint8_T* img,
+	 int nRows, int nCols, int winRows, int winCols,
+	 real32_T* mean, real32_T* stdDev);
+
+ /* Minimum and maximum of the same boxes; either output may be NULL. */
+ EXTERN_C LIBMWCVSTRT_API void boxStatistics_minMax_uint8(const uint8_T* img,
+	 int nRows, int nCols, int winRows, int winCols,
+	 uint8_T* minImg, uint8_T* maxImg);
+ EXTERN_C LIBMWCVSTRT_API void boxStatistics_minMax_uint8RM(const uint8_T* img,
+	 int nRows, int nCols, int winRows, int winCols,
+	 uint8_T* minImg, uint8_T* maxImg);
+
+#endif
@@ -0,0 +1,37 @@
+/* Copyright 2016 The MathWorks, Inc. */
+
+#ifndef _BUNDLEADJUSTMENT_
+#define _BUNDLEADJUSTMENT_
+
+#include "vision_defines.h"
+
+/* Solvers of the reduced camera system */
+#define BUNDLE_ADJUSTMENT_SOLVER_AUTO     0 /* PCG above 500 refined views */
+#define BUNDLE_ADJUSTMENT_SOLVER_CHOLESKY 1
+#define BUNDLE_ADJUSTMENT_SOLVER_PCG      2
+
+/* Sparse Levenberg-Marquardt of bundleAdjustment, see BundleAdjuster.hpp.
+   xyzPoints is 3-by-numPoints, orientations 3-by-3-by-numViews and
+   locations 3-by-numViews, the Orientation and Location of cameraPose,
+   column major; they are refined in place. The numObservations
+   observations are the 2-by-numObservations [x y] measurements of the
+   0-based points pointIndex in the 0-based views viewIndex, in any order.
+   intrinsics is 10-by-numIntrinsics, [FocalLength PrincipalPoint Skew
+   RadialDistortion (3 coefficients, zero padded) TangentialDistortion] of
+   cameraIntrinsics, for all the views or for each one. isFixedView flags
+   the views of FixedViewIDs. reprojectionErrors receives the mean
+   reprojection error of each point. Returns the stop condition, the status
+   code of bundleAdjustment.m. */
+EXTERN_C LIBMWCVSTRT_API
+int32_T bundleAdjustment_solve(double * xyzPoints, const int32_T numPoints,
+        double * orientations, double * locations, const int32_T numViews,
+        const double * measurements, const int32_T * pointIndex,
+        const int32_T * viewIndex, const int32_T numObservations,
+        const double * intrinsics, const int32_T numIntrinsics,
+        const boolean_T * isFixedView, const int32_T maxIterations,
+        const double absoluteTolerance, const double relativeTolerance,
+        const int32_T solver, const double pcgTolerance,
+        const int32_T maxPCGIterations, double * reprojectionErrors,
+        int32_T * numIterations);
+
+#endif
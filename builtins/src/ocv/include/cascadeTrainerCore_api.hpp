@@ -0,0 +1,52 @@
+/* Copyright 2016 The MathWorks, Inc. */
+
+#ifndef _CASCADETRAINER_
+#define _CASCADETRAINER_
+
+#include "vision_defines.h"
+
+/* Native training of the cascades of trainCascadeObjectDetector, see
+   CascadeTrainer.hpp. featureType is 0 for Haar, 1 for LBP and 2 for HOG.
+   precalcBufSizeMB is the memory of the precalculated feature values.
+   addPositives takes winHeight-by-winWidth-by-numSamples uint8 samples;
+   addNegativeImage a rows-by-cols grayscale image. trainStage returns the
+   number of weak classifiers of the new stage, 0 when there are not enough
+   positives or negatives passing the previous stages. write saves the
+   cascade in the XML format of vision.CascadeObjectDetector. */
+
+EXTERN_C LIBMWCVSTRT_API
+void cascadeTrainer_construct(int32_T featureType, int32_T winWidth,
+        int32_T winHeight, double precalcBufSizeMB, void **ptr2ptrTrainer);
+
+EXTERN_C LIBMWCVSTRT_API
+void cascadeTrainer_addPositives(void *ptrTrainer, const uint8_T * samples,
+        int32_T numSamples);
+
+EXTERN_C LIBMWCVSTRT_API
+void cascadeTrainer_addPositivesRM(void *ptrTrainer, const uint8_T * samples,
+        int32_T numSamples);
+
+EXTERN_C LIBMWCVSTRT_API
+void cascadeTrainer_addNegativeImage(void *ptrTrainer, const uint8_T * image,
+        int32_T rows, int32_T cols);
+
+EXTERN_C LIBMWCVSTRT_API
+void cascadeTrainer_addNegativeImageRM(void *ptrTrainer, const uint8_T * image,
+        int32_T rows, int32_T cols);
+
+EXTERN_C LIBMWCVSTRT_API
+int32_T cascadeTrainer_trainStage(void *ptrTrainer, int32_T numPos,
+        int32_T numNeg, double minHitRate, double maxFalseAlarm,
+        double weightTrimRate, int32_T maxWeakCount,
+        double * acceptanceRatio);
+
+EXTERN_C LIBMWCVSTRT_API
+int32_T cascadeTrainer_getNumStages(void *ptrTrainer);
+
+EXTERN_C LIBMWCVSTRT_API
+boolean_T cascadeTrainer_write(void *ptrTrainer, const char * filename);
+
+EXTERN_C LIBMWCVSTRT_API
+void cascadeTrainer_deleteObj(void *ptrTrainer);
+
+#endif
@@ -0,0 +1,355 @@
+/*
+ * Running statistics over a sliding box, at a cost per pixel that does not
+ * depend on the size of the box
+ *
+ * The box of a pixel is winRows-by-winCols, with (winRows-1)/2 rows above
+ * it and (winCols-1)/2 columns left of it, and is clipped to the image, so
+ * the statistics near the borders are those of the pixels inside it.
+ *
+ * boxMeanStd reads the mean and the standard deviation from the integral
+ * images of computeIntegrals: four reads of the sum and four of the sum of
+ * squares per pixel. The deviation is normalized by n-1, as the Standard
+ * Deviation block and vision.StandardDeviation, and is 0 for one pixel.
+ *
+ * boxMinMax is separable. Along the rows, a monotonic deque of the indices
+ * of the candidates keeps the extremum of the window in front, each pixel
+ * being pushed and popped once. Down the columns, the rows are cut into
+ * blocks of winRows, and the extremum of a window is that of a suffix of
+ * one block and a prefix of the next (van Herk/Gil-Werman), so whole rows
+ * are combined with vector min/max. The rows are split over the pool in
+ * the first pass and the columns in the second.
+ *
+ * Copyright 2016 The MathWorks, Inc.
+ */
+
+#ifndef CGBOXSTATISTICS_HPP
+#define CGBOXSTATISTICS_HPP
+
+#include "cgIntegralImage.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+namespace vision
+{
+
+// rows or columns of the window before and after its center
+inline void boxHalfSizes(int winSize, int &before, int &after)
+{
+    before = (winSize - 1) / 2;
+    after = winSize - 1 - before;
+}
+
+// sums of the rows of the box of one output row: s and q are the integral
+// rows of sum and sqsum at its top (0) and bottom (1)
+struct BoxMeanStdRow
+{
+    const int *s0, *s1;
+    const double *q0, *q1;
+    int numRows;
+    float *m, *sd;
+
+    // one pixel; a and b are the first and one past the last column
+    void pixel(int x, int a, int b) const
+    {
+        const double n = (double)numRows * (b - a);
+        const double s = (double)(s1[b] - s1[a] - s0[b] + s0[a]);
+        m[x] = (float)(s / n);
+        if (sd)
+        {
+            const double q = q1[b] - q1[a] - q0[b] + q0[a];
+            const double var = (n > 1) ? (q - s * s / n) / (n - 1) : 0.0;
+            sd[x] = (float)std::sqrt(std::max(var, 0.0));
+        }
+    }
+};
+
+// mean, and standard deviation when stdDev is not NULL, of rows [y0, y1)
+inline void boxMeanStdRows(const cv::Mat &sum, const cv::Mat &sqsum,
+    int winRows, int winCols, int y0, int y1, cv::Mat &mean, cv::Mat *stdDev)
+{
+    const int width = sum.cols - 1, height = sum.rows - 1;
+    int above, below, left, right;
+    boxHalfSizes(winRows, above, below);
+    boxHalfSizes(winCols, left, right);
+
+    // columns whose window is inside the image
+    const int xIn0 = std::min(left, width);
+    const int xIn1 = std::max(xIn0, width - right);
+
+    for (int y = y0; y < y1; y++)
+    {
+        const int top = std::max(y - above, 0);
+        const int bottom = std::min(y + below + 1, height);
+        const int *s0 = sum.ptr<int>(top);
+        const int *s1 = sum.ptr<int>(bottom);
+        const double *q0 = sqsum.ptr<double>(top);
+        const double *q1 = sqsum.ptr<double>(bottom);
+        float *m = mean.ptr<float>(y);
+        float *sd = stdDev ? stdDev->ptr<float>(y) : NULL;
+        const BoxMeanStdRow row = {s0, s1, q0, q1, bottom - top, m, sd};
+
+        int x = 0;
+        for (; x < xIn0; x++)
+            row.pixel(x, 0, std::min(x + right + 1, width));
+
+#if CV_SIMD128
+        {
+            const double n = (double)(bottom - top) * winCols;
+            const cv::v_float32x4 invN = cv::v_setall_f32((float)(1.0 / n));
+            for (; x <= xIn1 - 4; x += 4)
+            {
+                const int a = x - left, b = x + right + 1;
+                const cv::v_int32x4 s = cv::v_load(s1 + b) - cv::v_load(s1 + a)
+                    - cv::v_load(s0 + b) + cv::v_load(s0 + a);
+                cv::v_store(m + x, cv::v_cvt_f32(s) * invN);
+#if CV_SIMD128_64F
+                if (sd)
+                {
+                    const cv::v_float64x2 vN = cv::v_setall_f64(n);
+                    const cv::v_float64x2 vInvNm1 = cv::v_setall_f64(n > 1 ? 1.0 / (n - 1) : 0.0);
+                    const cv::v_float64x2 zero = cv::v_setzero_f64();
+                    const cv::v_float64x2 sLo = cv::v_cvt_f64(s);
+                    const cv::v_float64x2 sHi = cv::v_cvt_f64(cv::v_extract<2>(s, cv::v_setzero_s32()));
+                    const cv::v_float64x2 qLo = cv::v_load(q1 + b) - cv::v_load(q1 + a)
+                        - cv::v_load(q0 + b) + cv::v_load(q0 + a);
+                    const cv::v_float64x2 qHi = cv::v_load(q1 + b + 2) - cv::v_load(q1 + a + 2)
+                        - cv::v_load(q0 + b + 2) + cv::v_load(q0 + a + 2);
+                    const cv::v_float64x2 vLo = cv::v_max((qLo - sLo * sLo / vN) * vInvNm1, zero);
+                    const cv::v_float64x2 vHi = cv::v_max((qHi - sHi * sHi / vN) * vInvNm1, zero);
+                    cv::v_store(sd + x, cv::v_combine_low(cv::v_cvt_f32(cv::v_sqrt(vLo)),
+                                                          cv::v_cvt_f32(cv::v_sqrt(vHi))));
+                }
+#else
+                if (sd)
+                {
+                    for (int k = 0; k < 4; k++)
+                        row.pixel(x + k, a + k, b + k);
+                }
+#endif
+            }
+        }
+#endif
+        for (; x < xIn1; x++)
+            row.pixel(x, x - left, x + right + 1);
+        for (; x < width; x++)
+            row.pixel(x, std::max(x - left, 0), width);
+    }
+}
+
+// Mean (CV_32F), and standard deviation (CV_32F) when stdDev is not NULL,
+// of the winRows-by-winCols box of each pixel of the 8-bit image src
+inline void boxMeanStd(const cv::Mat &src, int winRows, int winCols,
+    cv::Mat &mean, cv::Mat *stdDev = NULL)
+{
+    CV_Assert(src.type() == CV_8UC1 && winRows > 0 && winCols > 0);
+    cv::Mat sum, sqsum;
+    computeIntegrals(src, sum, &sqsum);
+
+    mean.create(src.rows, src.cols, CV_32F);
+    if (stdDev)
+        stdDev->create(src.rows, src.cols, CV_32F);
+
+#ifdef PARALLEL
+    integralForBlocks(src.rows, INTEGRAL_MIN_ROWS_PER_BLOCK, [&](int y0, int y1) {
+        boxMeanStdRows(sum, sqsum, winRows, winCols, y0, y1, mean, stdDev);
+    });
+#else
+    boxMeanStdRows(sum, sqsum, winRows, winCols, 0, src.rows, mean, stdDev);
+#endif
+}
+
+// the two extrema of boxMinMax
+struct BoxMinOp
+{
+    static uchar identity() { return 255; }
+    static bool before(uchar a, uchar b) { return a < b; }
+    static uchar apply(uchar a, uchar b) { return std::min(a, b); }
+#if CV_SIMD128
+    static cv::v_uint8x16 apply(const cv::v_uint8x16 &a, const cv::v_uint8x16 &b)
+    {
+        return cv::v_min(a, b);
+    }
+#endif
+};
+
+struct BoxMaxOp
+{
+    static uchar identity() { return 0; }
+    static bool before(uchar a, uchar b) { return a > b; }
+    static uchar apply(uchar a, uchar b) { return std::max(a, b); }
+#if CV_SIMD128
+    static cv::v_uint8x16 apply(const cv::v_uint8x16 &a, const cv::v_uint8x16 &b)
+    {
+        return cv::v_max(a, b);
+    }
+#endif
+};
+
+// extremum of the clipped windows of one row; deque holds width indices
+template <typename Op>
+inline void boxExtremumRow(const uchar *src, int width, int left, int right,
+    uchar *dst, int *deque)
+{
+    int head = 0, tail = 0, next = 0;
+    for (int x = 0; x < width; x++)
+    {
+        const int last = std::min(x + right, width - 1);
+        for (; next <= last; next++)
+        {
+            // a candidate that is not better than the new pixel never is
+            while (tail > head && !Op::before(src[deque[tail - 1]], src[next]))
+                tail--;
+            deque[tail++] = next;
+        }
+        while (deque[head] < x - left)
+            head++;
+        dst[x] = src[deque[head]];
+    }
+}
+
+// dst = Op(a, b) over columns [c0, c1)
+template <typename Op>
+inline void boxCombineRows(const uchar *a, const uchar *b, uchar *dst, int c0, int c1)
+{
+    int x = c0;
+#if CV_SIMD128
+    for (; x <= c1 - 16; x += 16)
+        cv::v_store(dst + x, Op::apply(cv::v_load(a + x), cv::v_load(b + x)));
+#endif
+    for (; x < c1; x++)
+        dst[x] = Op::apply(a[x], b[x]);
+}
+
+// row y of rows, or the identity row above and below them
+inline const uchar *boxPaddedRow(const cv::Mat &rows, int y, const uchar *identityRow)
+{
+    return (y >= 0 && y < rows.rows) ? rows.ptr<uchar>(y) : identityRow;
+}
+
+// Extremum down the columns [c0, c1) of rows, over windows of winRows rows
+// clipped to the image. The rows are padded with the identity of Op, so
+// that padded row p is row p - above and every window is whole; prefix and
+// suffix hold the running extrema from the start and to the end of each
+// block of winRows padded rows.
+template <typename Op>
+inline void boxExtremumColumns(const cv::Mat &rows, int winRows, int c0, int c1,
+    cv::Mat &prefix, cv::Mat &suffix, cv::Mat &dst)
+{
+    const int height = rows.rows;
+    const int numPadded = height + winRows - 1;
+    int above, below;
+    boxHalfSizes(winRows, above, below);
+
+    std::vector<uchar> identityRow(rows.cols, Op::identity());
+    for (int p = 0; p < numPadded; p++)
+    {
+        const uchar *padded = boxPaddedRow(rows, p - above, &identityRow[0]);
+        uchar *g = prefix.ptr<uchar>(p);
+        if (p % winRows == 0)
+            std::copy(padded + c0, padded + c1, g + c0);
+        else
+            boxCombineRows<Op>(prefix.ptr<uchar>(p - 1), padded, g, c0, c1);
+    }
+    for (int p = numPadded - 1; p >= 0; p--)
+    {
+        const uchar *padded = boxPaddedRow(rows, p - above, &identityRow[0]);
+        uchar *s = suffix.ptr<uchar>(p);
+        if (p % winRows == winRows - 1 || p == numPadded - 1)
+            std::copy(padded + c0, padded + c1, s + c0);
+        else
+            boxCombineRows<Op>(suffix.ptr<uchar>(p + 1), padded, s, c0, c1);
+    }
+    for (int y = 0; y < height; y++)
+    {
+        boxCombineRows<Op>(suffix.ptr<uchar>(y), prefix.ptr<uchar>(y + winRows - 1),
+                           dst.ptr<uchar>(y), c0, c1);
+    }
+}
+
+// extrema along rows [y0, y1) of src into rowMin and rowMax, either of
+// which may be NULL
+inline void boxMinMaxRows(const cv::Mat &src, int left, int right, int y0, int y1,
+    cv::Mat *rowMin, cv::Mat *rowMax)
+{
+    const int width = src.cols;
+    std::vector<int> deque(std::max(width, 1));
+    for (int y = y0; y < y1; y++)
+    {
+        if (rowMin)
+            boxExtremumRow<BoxMinOp>(src.ptr<uchar>(y), width, left, right,
+                                     rowMin->ptr<uchar>(y), &deque[0]);
+        if (rowMax)
+            boxExtremumRow<BoxMaxOp>(src.ptr<uchar>(y), width, left, right,
+                                     rowMax->ptr<uchar>(y), &deque[0]);
+    }
+}
+
+// Minimum and maximum (CV_8U) of the winRows-by-winCols box of each pixel
+// of the 8-bit image src; either output may be NULL
+inline void boxMinMax(const cv::Mat &src, int winRows, int winCols,
+    cv::Mat *minImg, cv::Mat *maxImg)
+{
+    CV_Assert(src.type() == CV_8UC1 && winRows > 0 && winCols > 0);
+    const int height = src.rows, width = src.cols;
+    int left, right;
+    boxHalfSizes(winCols, left, right);
+
+    cv::Mat rowMin, rowMax;
+    if (minImg)
+    {
+        rowMin.create(height, width, CV_8U);
+        minImg->create(height, width, CV_8U);
+    }
+    if (maxImg)
+    {
+        rowMax.create(height, width, CV_8U);
+        maxImg->create(height, width, CV_8U);
+    }
+
+#ifdef PARALLEL
+    integralForBlocks(height, INTEGRAL_MIN_ROWS_PER_BLOCK, [&](int y0, int y1) {
+        boxMinMaxRows(src, left, right, y0, y1, minImg ? &rowMin : NULL,
+                      maxImg ? &rowMax : NULL);
+    });
+#else
+    boxMinMaxRows(src, left, right, 0, height, minImg ? &rowMin : NULL,
+                  maxImg ? &rowMax : NULL);
+#endif
+
+    const int numPadded = height + winRows - 1;
+    cv::Mat prefixMin, suffixMin, prefixMax, suffixMax;
+    if (minImg)
+    {
+        prefixMin.create(numPadded, width, CV_8U);
+        suffixMin.create(numPadded, width, CV_8U);
+    }
+    if (maxImg)
+    {
+        prefixMax.create(numPadded, width, CV_8U);
+        suffixMax.create(numPadded, width, CV_8U);
+    }
+
+#ifdef PARALLEL
+    integralForBlocks(width, INTEGRAL_MIN_COLS_PER_BLOCK, [&](int c0, int c1) {
+        if (minImg)
+            boxExtremumColumns<BoxMinOp>(rowMin, winRows, c0, c1,
+                                         prefixMin, suffixMin, *minImg);
+        if (maxImg)
+            boxExtremumColumns<BoxMaxOp>(rowMax, winRows, c0, c1,
+                                         prefixMax, suffixMax, *maxImg);
+    });
+#else
+    if (minImg && width > 0)
+        boxExtremumColumns<BoxMinOp>(rowMin, winRows, 0, width,
+                                     prefixMin, suffixMin, *minImg);
+    if (maxImg && width > 0)
+        boxExtremumColumns<BoxMaxOp>(rowMax, winRows, 0, width,
+                                     prefixMax, suffixMax, *maxImg);
+#endif
+}
+
+} // namespace vision
+
+#endif // CGBOXSTATISTICS_HPP
@@ -10,10 +10,15 @@
 #include "vision_defines.h"
 #include "opencv2/opencv.hpp"
 
+#include "cgThreadPool.hpp"
+#include "cgResultPool.hpp"
+#include "cgPipeline.hpp"
+#include "mwtranspose.hpp"
+
 #ifdef PARALLEL
-#define NUM_THREADS 4
-#include <thread>
-#include <vector>
+// Minimum number of rows converted by one thread. Smaller blocks do not
+// amortize the cost of waking up a pool thread.
+#define CG_MIN_ROWS_PER_BLOCK 32
 #endif
 
 using namespace std;
@@ -46,14 +51,8 @@ void copyToMat(ImageDataType *src, ImageDataType *dst, int startRowIdx, int numR
 // src: column major (MATLAB MEX or EXE)
 // dst: row major (OpenCV)
 
-	for (int i = startRowIdx; i < numRowsInBlock; ++i)
-	{
-		/* Copy each row from src (column major) to dst (row major) */
-		for (int j = 0; j < numCols; ++j)
-		{
-			*dst++ = src[i + j*numRows];
-		}
-	}
+	// dst points at row startRowIdx; rows are transposed in cache tiles
+	vision::transposeTiled<ImageDataType>(&src[startRowIdx], numRows, dst, numCols, numRowsInBlock - startRowIdx, numCols);
 }
 
 template <typename ImageDataType>
@@ -74,19 +73,9 @@ void copyToMatBGR(ImageDataType *src, ImageDataType *dst, int startRowIdx, int n
 
 	int rc = numRows*numCols;
 
-	for (int i = startRowIdx; i < numRowsInBlock; ++i)
-	{
-		/* Copy each row (with RGB from 3 planes) from src (column major) to dst (row major) as RGB triplet */
-		for (int j = 0; j < numCols; ++j)
-		{
-			// OpenCV uses BGR ordering so we need to supply the data                                                                                                                                                
-			// in the proper order, by counting backwards                                                                                                                                                            
-			for (int k = (int)(channels - 1); k >= 0; --k)
-			{
-				*dst++ = src[i + j*numRows + k*rc];
-			}
-		}
-	}
+	// dst points at row startRowIdx. OpenCV uses BGR ordering, the planes
+	// are interleaved in reverse order.
+	vision::transposePlanarToInterleaved<ImageDataType>(&src[startRowIdx], numRows, rc, dst, numCols*channels, numRowsInBlock - startRowIdx, numCols, channels);
 }
 
 template <typename ImageDataType>
@@ -132,26 +121,15 @@ void cArrayToMat(const ImageDataType *in, int numRows, int numCols, bool isRGB ,
 
     ImageDataType *dst = reinterpret_cast<ImageDataType *>(out.data);
 
-#ifdef PARALLEL
-    vector<thread> workers;
-    int blocks = numRows / NUM_THREADS;
-    int startRowIdx = 0, numRowsInBlock = blocks;
-#endif
-
     // convert column-major to row-major and interleave pixel data. OpenCV
     // stores multi-channel data in the interleaved format.        
     if (nChannels == 1)        
     {
 #ifdef PARALLEL
-        for( int t = 1; t <= NUM_THREADS; t++ )
-        {
-            if( t == NUM_THREADS )
-                numRowsInBlock += numRows % NUM_THREADS;
-
-            workers.push_back( thread(copyToMat<ImageDataType>, imgData, &dst[startRowIdx*numCols], startRowIdx, numRowsInBlock, numRows, numCols) );
-            startRowIdx = numRowsInBlock;
-            numRowsInBlock = startRowIdx + blocks;
-        }
+        cgParallelForRows(numRows, CG_MIN_ROWS_PER_BLOCK,
+            [=](int startRowIdx, int endRowIdx) {
+                copyToMat<ImageDataType>(imgData, &dst[startRowIdx*numCols], startRowIdx, endRowIdx, numRows, numCols);
+            });
 #else
 		copyToMat<ImageDataType>(imgData, dst, 0, numRows, numRows, numCols);
 		/*
@@ -170,15 +148,10 @@ void cArrayToMat(const ImageDataType *in, int numRows, int numCols, bool isRGB ,
     {
 #ifdef PARALLEL
         // assert that there are 3 color planes                                                                                                                                                                    
-        for( int t = 1; t <= NUM_THREADS; t++ )
-        {
-            if( t == NUM_THREADS )
-                numRowsInBlock += numRows % NUM_THREADS;
-
-            workers.push_back( thread(copyToMatBGR<ImageDataType>, imgData, &dst[startRowIdx*numCols*nChannels],  startRowIdx, numRowsInBlock, numRows, numCols, nChannels) );
-            startRowIdx = numRowsInBlock;
-            numRowsInBlock = startRowIdx + blocks;
-        }
+        cgParallelForRows(numRows, CG_MIN_ROWS_PER_BLOCK,
+            [=](int startRowIdx, int endRowIdx) {
+                copyToMatBGR<ImageDataType>(imgData, &dst[startRowIdx*numCols*nChannels], startRowIdx, endRowIdx, numRows, numCols, nChannels);
+            });
 #else
 		copyToMatBGR<ImageDataType>(imgData, dst, 0, numRows, numRows, numCols, nChannels);
         /*
@@ -198,11 +171,6 @@ void cArrayToMat(const ImageDataType *in, int numRows, int numCols, bool isRGB ,
         */
 #endif
     } 
-
-#ifdef PARALLEL
-    for( thread &th : workers )
-        th.join();
-#endif
 }
 
 template <typename ImageDataType>
@@ -227,26 +195,15 @@ void cArrayToMat_RowMaj(const ImageDataType *in, int numRows, int numCols, bool
 
 	ImageDataType *dst = reinterpret_cast<ImageDataType *>(out.data);
 
-#ifdef PARALLEL
-	vector<thread> workers;
-	int blocks = numRows / NUM_THREADS;
-	int startRowIdx = 0, numRowsInBlock = blocks;
-#endif
-
 	// convert column-major to row-major and interleave pixel data. OpenCV
 	// stores multi-channel data in the interleaved format.        
 	if (nChannels == 1)
 	{
 #ifdef PARALLEL
-		for (int t = 1; t <= NUM_THREADS; t++)
-		{
-			if (t == NUM_THREADS)
-				numRowsInBlock += numRows % NUM_THREADS;
-
-			workers.push_back(thread(copyToMat_RowMaj<ImageDataType>, &imgData[startRowIdx], &dst[startRowIdx], numRowsInBlock, numCols));
-			startRowIdx = numRowsInBlock;
-			numRowsInBlock = startRowIdx + blocks;
-		}
+		cgParallelForRows(numRows, CG_MIN_ROWS_PER_BLOCK,
+			[=](int startRowIdx, int endRowIdx) {
+				copyToMat_RowMaj<ImageDataType>(&imgData[startRowIdx*numCols], &dst[startRowIdx*numCols], endRowIdx - startRowIdx, numCols);
+			});
 #else
 		// making rowMajor grayscale image to rowMajor grayscale image
 		//memcpy(dst, imgData, numRows*numCols*sizeof(ImageDataType));
@@ -257,24 +214,82 @@ void cArrayToMat_RowMaj(const ImageDataType *in, int numRows, int numCols, bool
 	{
 #ifdef PARALLEL
 		// assert that there are 3 color planes                                                                                                                                                                    
-		for (int t = 1; t <= NUM_THREADS; t++)
-		{
-			if (t == NUM_THREADS)
-				numRowsInBlock += numRows % NUM_THREADS;
-
-			workers.push_back(thread(copyToMatBGR_RowMaj<ImageDataType>, &imgData[startRowIdx*nChannels], &dst[startRowIdx*nChannels], numRowsInBlock, numCols, nChannels));
-			startRowIdx = numRowsInBlock;
-			numRowsInBlock = startRowIdx + blocks;
-		}
+		cgParallelForRows(numRows, CG_MIN_ROWS_PER_BLOCK,
+			[=](int startRowIdx, int endRowIdx) {
+				copyToMatBGR_RowMaj<ImageDataType>(&imgData[startRowIdx*numCols*nChannels], &dst[startRowIdx*numCols*nChannels], endRowIdx - startRowIdx, numCols, nChannels);
+			});
 #else
      	copyToMatBGR_RowMaj<ImageDataType>(imgData, dst, numRows, numCols, nChannels);
 #endif
 	}
+}
 
-#ifdef PARALLEL
-	for (thread &th : workers)
-		th.join();
-#endif
+/////////////////////////////////////////////////////////////////////////////////
+// cArrayToMatView_RowMaj:
+//  Same as cArrayToMat_RowMaj, but a single channel array is wrapped by the
+//  cv::Mat header without copying since its layout is already the one used by
+//  OpenCV. Only RGB data are converted, to interleaved BGR.
+//
+//  Note:
+//  ----
+//  - For single channel data, out borrows the memory of in. in must outlive
+//    out and must not be modified by the caller while out is in use.
+//  - For RGB data, out is reused across calls when it already has the
+//    required size and type.
+/////////////////////////////////////////////////////////////////////////////////
+template <typename ImageDataType>
+void cArrayToMatView_RowMaj(const ImageDataType *in, int numRows, int numCols, bool isRGB, cv::Mat &out)
+{
+	if (!isRGB)
+	{
+		out = cv::Mat(numRows, numCols, cv::DataType<ImageDataType>::type,
+			(void *)in);
+	}
+	else
+	{
+		cArrayToMat_RowMaj<ImageDataType>(in, numRows, numCols, isRGB, out);
+	}
+}
+
+/////////////////////////////////////////////////////////////////////////////////
+// cgSetNativeColumnMajor:
+//  Lets the cores whose algorithm does not change under transposition, FAST
+//  and MSER, run on single channel column major arrays without converting
+//  them: the array is read in place as the row major image of the
+//  transpose, and x and y are swapped in the results. The results are the
+//  same points or regions, in column order instead of row order. Off by
+//  default. The Harris and MinEigen and HOG feature cores always process
+//  column major images this way.
+//
+// cgGetNativeColumnMajor:
+//  Returns 1 when the mode is on, 0 otherwise.
+/////////////////////////////////////////////////////////////////////////////////
+EXTERN_C LIBMWCVSTRT_API void cgSetNativeColumnMajor(int32_T enable);
+EXTERN_C LIBMWCVSTRT_API int32_T cgGetNativeColumnMajor(void);
+
+/////////////////////////////////////////////////////////////////////////////////
+// cArrayToMatView_ColMaj:
+//  With cgSetNativeColumnMajor on, wraps a single channel column major
+//  numRows-by-numCols array by a numCols-by-numRows cv::Mat header without
+//  copying, and returns true: out is the transpose of the image. Otherwise
+//  converts in as cArrayToMat and returns false.
+//
+//  Note:
+//  ----
+//  - When true is returned, out borrows the memory of in, as with
+//    cArrayToMatView_RowMaj, and the caller swaps x and y in its results.
+/////////////////////////////////////////////////////////////////////////////////
+template <typename ImageDataType>
+bool cArrayToMatView_ColMaj(const ImageDataType *in, int numRows, int numCols, bool isRGB, cv::Mat &out)
+{
+	if (!isRGB && cgGetNativeColumnMajor())
+	{
+		out = cv::Mat(numCols, numRows, cv::DataType<ImageDataType>::type,
+			(void *)in);
+		return true;
+	}
+	cArrayToMat<ImageDataType>(in, numRows, numCols, isRGB, out);
+	return false;
 }
 
 template <typename ImageDataType>
@@ -283,13 +298,8 @@ void copyToArray(ImageDataType *src, ImageDataType *dst, int startRowIdx, int nu
 	// src: row major (OpenCV output)
 	// dst: column major (MATLAB MEX or EXE)
 
-    for( int i = startRowIdx; i < numRowsInBlock; i++ )
-    {
-        for( int j = 0; j < numCols; j++ )
-        {
-            dst[i+j*numRows] = *src++;
-        }
-    }
+    // src points at row startRowIdx
+    vision::transposeTiled<ImageDataType>(src, numCols, &dst[startRowIdx], numRows, numCols, numRowsInBlock - startRowIdx);
 }
 
 
@@ -306,17 +316,9 @@ void copyToArrayBGR(ImageDataType *src, ImageDataType *dst, int startRowIdx, int
 {
     int rc = numRows*numCols;
 
-    for (int i = startRowIdx; i < numRowsInBlock; ++i)
-    {
-        for (int j = 0; j < numCols; ++j)
-          {
-            // Count backwards since OpenCV uses BGR ordering of color data                                                                                                                                        
-            for (int k = channels-1; k >= 0; --k)
-            {
-                dst[i + j*numRows + k*rc] = *src++;
-            }
-        }
-    }
+    // src points at row startRowIdx. Count backwards since OpenCV uses
+    // BGR ordering of color data.
+    vision::transposeInterleavedToPlanar<ImageDataType>(src, numCols*channels, &dst[startRowIdx], numRows, rc, numRowsInBlock - startRowIdx, numCols, channels);
 }
 
 template <typename ImageDataType>
@@ -362,70 +364,33 @@ void cArrayFromMat(ImageDataType *outFeatures, const cv::Mat &in)
 
     ImageDataType *src = reinterpret_cast<ImageDataType *>(in.data);
 
-#ifdef PARALLEL
-    vector<thread> workers;
-    int blocks = numRows / NUM_THREADS;
-    int startRowIdx = 0, numRowsInBlock = blocks;
-#endif
-
     // convert column-major to row-major and interleave pixel data. OpenCV
     // stores multi-channel data in the interleaved format.        
     if (in.channels() == 1)        
     {
-#if PARALLEL
-        for( int t = 1; t <= NUM_THREADS; t++ )
-        {
-            if( t == NUM_THREADS )
-                numRowsInBlock += numRows % NUM_THREADS;
-
-            workers.push_back( thread(copyToArray<ImageDataType>, &src[startRowIdx*numCols], imgData, startRowIdx, numRowsInBlock, numRows, numCols) );
-            startRowIdx = numRowsInBlock;
-            numRowsInBlock = startRowIdx + blocks;
-        }
+#ifdef PARALLEL
+        cgParallelForRows(numRows, CG_MIN_ROWS_PER_BLOCK,
+            [=](int startRowIdx, int endRowIdx) {
+                copyToArray<ImageDataType>(&src[startRowIdx*numCols], imgData, startRowIdx, endRowIdx, numRows, numCols);
+            });
 #else
         // assert (nDims == 2);
-        for (int i = 0; i < numRows; ++i)       
-        {         
-            for (int j = 0; j < numCols; ++j) 
-            {
-                imgData[i + j*numRows] = *src++;
-            }
-        }
+        copyToArray<ImageDataType>(src, imgData, 0, numRows, numRows, numCols);
 #endif
     }
     else
     {
-#if PARALLEL
+#ifdef PARALLEL
         // assert that there are 3 color planes (i.e., dims[2] == 3); 
-        for( int t = 1; t <= NUM_THREADS; t++ )
-        {
-            if( t == NUM_THREADS )
-                numRowsInBlock += numRows % NUM_THREADS;
-
-            workers.push_back( thread(copyToArrayBGR<ImageDataType>, &src[startRowIdx*numCols*in.channels()], imgData, startRowIdx, numRowsInBlock, numRows, numCols, in.channels()) );
-            startRowIdx = numRowsInBlock;
-            numRowsInBlock = startRowIdx + blocks;
-        }
+        const int nChannels = in.channels();
+        cgParallelForRows(numRows, CG_MIN_ROWS_PER_BLOCK,
+            [=](int startRowIdx, int endRowIdx) {
+                copyToArrayBGR<ImageDataType>(&src[startRowIdx*numCols*nChannels], imgData, startRowIdx, endRowIdx, numRows, numCols, nChannels);
+            });
 #else
-        int rc = numRows*numCols; 
-        for (int i = 0; i < numRows; ++i)                
-        {
-            for (int j = 0; j < numCols; ++j)
-            {
-                // Count backwards since OpenCV uses BGR ordering of color data
-                for (int k = in.channels()-1; k >= 0; --k)
-                {
-                    imgData[i + j*numRows + k*rc] = *src++;
-                }
-            }
-        }
+        copyToArrayBGR<ImageDataType>(src, imgData, 0, numRows, numRows, numCols, in.channels());
 #endif
     }    
-
-#ifdef PARALLEL     
-    for( thread &th : workers )
-        th.join();
-#endif
 }
 
 template <typename ImageDataType>
@@ -445,26 +410,15 @@ void cArrayFromMat_RowMaj(ImageDataType *outFeatures, const cv::Mat &in)
 
 	ImageDataType *src = reinterpret_cast<ImageDataType *>(in.data);
 
-#ifdef PARALLEL
-	vector<thread> workers;
-	int blocks = numRows / NUM_THREADS;
-	int startRowIdx = 0, numRowsInBlock = blocks;
-#endif
-
 	// convert column-major to row-major and interleave pixel data. OpenCV
 	// stores multi-channel data in the interleaved format.        
 	if (in.channels() == 1)
 	{
-#if PARALLEL
-		for (int t = 1; t <= NUM_THREADS; t++)
-		{
-			if (t == NUM_THREADS)
-				numRowsInBlock += numRows % NUM_THREADS;
-
-			workers.push_back(thread(copyToArray_RowMaj<ImageDataType>, &src[startRowIdx*numCols], &imgData[startRowIdx*numCols], numRowsInBlock, numCols));
-			startRowIdx = numRowsInBlock;
-			numRowsInBlock = startRowIdx + blocks;
-		}
+#ifdef PARALLEL
+		cgParallelForRows(numRows, CG_MIN_ROWS_PER_BLOCK,
+			[=](int startRowIdx, int endRowIdx) {
+				copyToArray_RowMaj<ImageDataType>(&src[startRowIdx*numCols], &imgData[startRowIdx*numCols], endRowIdx - startRowIdx, numCols);
+			});
 #else
 		// making rowMajor grayscale image to rowMajor grayscale image
 		copyToArray_RowMaj<ImageDataType>(src, imgData, numRows, numCols);
@@ -472,30 +426,126 @@ void cArrayFromMat_RowMaj(ImageDataType *outFeatures, const cv::Mat &in)
 	}
 	else
 	{
-#if PARALLEL
+#ifdef PARALLEL
 		// assert that there are 3 color planes (i.e., dims[2] == 3); 
-		for (int t = 1; t <= NUM_THREADS; t++)
-		{
-			if (t == NUM_THREADS)
-				numRowsInBlock += numRows % NUM_THREADS;
-
-			workers.push_back(thread(copyToArrayBGR_RowMaj<ImageDataType>, &src[startRowIdx*in.channels()], &imgData[startRowIdx*in.channels()], numRowsInBlock, numCols, in.channels()));
-			startRowIdx = numRowsInBlock;
-			numRowsInBlock = startRowIdx + blocks;
-		}
+		const int nChannels = in.channels();
+		cgParallelForRows(numRows, CG_MIN_ROWS_PER_BLOCK,
+			[=](int startRowIdx, int endRowIdx) {
+				copyToArrayBGR_RowMaj<ImageDataType>(&src[startRowIdx*numCols*nChannels], &imgData[startRowIdx*numCols*nChannels], endRowIdx - startRowIdx, numCols, nChannels);
+			});
 #else
 		copyToArrayBGR_RowMaj<ImageDataType>(src, imgData, numRows, numCols, in.channels());
 #endif
 	}
+}
 
-#ifdef PARALLEL     
-	for (thread &th : workers)
-		th.join();
+/////////////////////////////////////////////////////////////////////////////////
+// FeatureBatch:
+//  Keypoints and descriptors of a batch of images, computed by the batch
+//  entry points of the detector and extractor wrappers.
+//
+// featureBatchToArrays:
+//  Copies the descriptors of all the images, one after the other, into
+//  outFeatures, a numTotal-by-descriptorSize array that is column major, or
+//  row major when isRowMajor. outOffsets, of numImages+1 elements, gets the
+//  zero based index of the first feature of each image and numTotal last.
+//  outLoc, when not NULL, gets the 1-based [x y] location of each feature,
+//  with the same layout. The images are copied in parallel.
+/////////////////////////////////////////////////////////////////////////////////
+struct FeatureBatch
+{
+    std::vector< std::vector<cv::KeyPoint> > keypoints;
+    std::vector<cv::Mat> descriptors;
+};
+
+template <typename FeatureDataType>
+void featureBatchImageToArrays(const FeatureBatch &batch, int i, bool isRowMajor,
+    int32_T numTotal, int descSize, real32_T *outLoc, FeatureDataType *outFeatures,
+    const int32_T *outOffsets)
+{
+    const std::vector<cv::KeyPoint> &kp = batch.keypoints[i];
+    const cv::Mat &desc = batch.descriptors[i];
+    const int32_T offset = outOffsets[i];
+    const int n = (int)kp.size();
+
+    if (outLoc)
+    {
+        for (int k = 0; k < n; k++)
+        {
+            if (isRowMajor)
+            {
+                outLoc[2*(offset+k)]   = kp[k].pt.x+1;
+                outLoc[2*(offset+k)+1] = kp[k].pt.y+1;
+            }
+            else
+            {
+                outLoc[offset+k]          = kp[k].pt.x+1;
+                outLoc[numTotal+offset+k] = kp[k].pt.y+1;
+            }
+        }
+    }
+
+    if (n == 0 || desc.empty())
+        return;
+    if (isRowMajor)
+    {
+        for (int k = 0; k < n; k++)
+            memcpy(&outFeatures[(size_t)(offset+k)*descSize], desc.ptr<FeatureDataType>(k),
+                descSize*sizeof(FeatureDataType));
+    }
+    else
+    {
+        vision::transposeTiled<FeatureDataType>(desc.ptr<FeatureDataType>(0), desc.step1(),
+            &outFeatures[offset], numTotal, descSize, n);
+    }
+}
+
+template <typename FeatureDataType>
+void featureBatchToArrays(const FeatureBatch &batch, bool isRowMajor,
+    real32_T *outLoc, FeatureDataType *outFeatures, int32_T *outOffsets)
+{
+    const int numImages = (int)batch.keypoints.size();
+    int32_T numTotal = 0;
+    int descSize = 0;
+    for (int i = 0; i < numImages; i++)
+    {
+        outOffsets[i] = numTotal;
+        numTotal += (int32_T)batch.keypoints[i].size();
+        if (!batch.descriptors[i].empty())
+            descSize = batch.descriptors[i].cols;
+    }
+    outOffsets[numImages] = numTotal;
+
+#ifdef PARALLEL
+    cgParallelForWorkers(numImages, [&](int, int i) {
+        featureBatchImageToArrays<FeatureDataType>(batch, i, isRowMajor,
+            numTotal, descSize, outLoc, outFeatures, outOffsets);
+    });
+#else
+    for (int i = 0; i < numImages; i++)
+        featureBatchImageToArrays<FeatureDataType>(batch, i, isRowMajor,
+            numTotal, descSize, outLoc, outFeatures, outOffsets);
 #endif
 }
 
 EXTERN_C LIBMWCVSTRT_API void cvRectToBoundingBox(const std::vector<cv::Rect> & rects, int32_T *boundingBoxes);
 EXTERN_C LIBMWCVSTRT_API void cvRectToBoundingBoxRowMajor(const std::vector<cv::Rect> & rects, int32_T *boundingBoxes);
+EXTERN_C LIBMWCVSTRT_API void boundingBoxToCvRect(const int32_T *boundingBoxes, int32_T numBoxes, std::vector<cv::Rect> & rects);
+EXTERN_C LIBMWCVSTRT_API void boundingBoxToCvRectRowMajor(const int32_T *boundingBoxes, int32_T numBoxes, std::vector<cv::Rect> & rects);
+
+// keeps the maxPerCell strongest keypoints of each cellSize x cellSize cell
+void selectStrongestPerCell(std::vector<cv::KeyPoint> & keypoints,
+                            int imgRows, int imgCols, int cellSize, int maxPerCell);
+
+// keeps the maxNum strongest keypoints, and their rows of rows if not NULL
+void selectStrongest(std::vector<cv::KeyPoint> & keypoints, int maxNum,
+                     cv::Mat * rows = NULL);
+
+// swaps x and y of keypoints found on the transpose of an image
+void transposeKeyPoints(std::vector<cv::KeyPoint> & keypoints);
+
+// swaps x and y of the points of regions found on the transpose of an image
+void transposeRegions(std::vector< std::vector<cv::Point> > & regions);
 
 
 #endif //CGCOMMON_HPP
@@ -0,0 +1,225 @@
+/*
+ * Integral images shared by the cascade, SURF and BRISK cores
+ *
+ * computeIntegrals returns the images of cv::integral for an 8-bit single
+ * channel image: the sum (CV_32S), the sum of squares (CV_64F) and the
+ * tilted sum (CV_32S), all (rows+1)-by-(cols+1). The sums take two passes:
+ * the prefix sums of each row, vectorized and split over blocks of rows,
+ * then the running sums down the columns, vectorized and split over blocks
+ * of columns. The tilted sum is accumulated along the diagonals from the
+ * row prefix sums, one row after the other. Other image types are left to
+ * cv::integral.
+ *
+ * Copyright 2016 The MathWorks, Inc.
+ */
+
+#ifndef CGINTEGRALIMAGE_HPP
+#define CGINTEGRALIMAGE_HPP
+
+#include "vision_defines.h"
+#include "cgThreadPool.hpp"
+#include "opencv2/core.hpp"
+#include "opencv2/imgproc.hpp"
+#include "opencv2/core/hal/intrin.hpp"
+
+#include <algorithm>
+#include <vector>
+
+namespace vision
+{
+
+// smallest blocks of the row and column passes given to a thread
+const int INTEGRAL_MIN_ROWS_PER_BLOCK = 32;
+const int INTEGRAL_MIN_COLS_PER_BLOCK = 256;
+
+// fcn(start, end) over blocks of [0, n), on the pool when parallel
+template <typename Fcn>
+inline void integralForBlocks(int n, int minPerBlock, Fcn fcn)
+{
+#ifdef PARALLEL
+    cgParallelForRows(n, minPerBlock, fcn);
+#else
+    (void)minPerBlock;
+    if (n > 0)
+        fcn(0, n);
+#endif
+}
+
+// dst[0] = 0 and dst[x+1] = src[0] + ... + src[x]
+inline void integralRowPrefix(const uchar *src, int width, int *dst)
+{
+    int x = 0, s = 0;
+    dst[0] = 0;
+#if CV_SIMD128
+    // prefix sums of 4 pixels by two shifted adds, plus the sum before them
+    const cv::v_int32x4 zero = cv::v_setzero_s32();
+    for (; x <= width - 4; x += 4)
+    {
+        cv::v_int32x4 v = cv::v_reinterpret_as_s32(cv::v_load_expand_q(src + x));
+        v += cv::v_extract<3>(zero, v);
+        v += cv::v_extract<2>(zero, v);
+        cv::v_store(dst + x + 1, v + cv::v_setall_s32(dst[x]));
+    }
+    s = dst[x];
+#endif
+    for (; x < width; x++)
+    {
+        s += src[x];
+        dst[x + 1] = s;
+    }
+}
+
+// dst[0] = 0 and dst[x+1] = src[0]^2 + ... + src[x]^2
+inline void integralRowPrefixSq(const uchar *src, int width, double *dst)
+{
+    double s = 0;
+    dst[0] = 0;
+    for (int x = 0; x < width; x++)
+    {
+        s += (double)(src[x] * src[x]);
+        dst[x + 1] = s;
+    }
+}
+
+// adds each row to the next one in columns [c0, c1)
+inline void integralColumnPass32s(cv::Mat &sum, int c0, int c1)
+{
+    for (int y = 2; y < sum.rows; y++)
+    {
+        const int *above = sum.ptr<int>(y - 1);
+        int *row = sum.ptr<int>(y);
+        int x = c0;
+#if CV_SIMD128
+        for (; x <= c1 - 4; x += 4)
+            cv::v_store(row + x, cv::v_load(row + x) + cv::v_load(above + x));
+#endif
+        for (; x < c1; x++)
+            row[x] += above[x];
+    }
+}
+
+inline void integralColumnPass64f(cv::Mat &sqsum, int c0, int c1)
+{
+    for (int y = 2; y < sqsum.rows; y++)
+    {
+        const double *above = sqsum.ptr<double>(y - 1);
+        double *row = sqsum.ptr<double>(y);
+        int x = c0;
+#if CV_SIMD128_64F
+        for (; x <= c1 - 2; x += 2)
+            cv::v_store(row + x, cv::v_load(row + x) + cv::v_load(above + x));
+#endif
+        for (; x < c1; x++)
+            row[x] += above[x];
+    }
+}
+
+// row prefix sums of rows [y0, y1) of src into sum and sqsum
+inline void integralRowPass(const cv::Mat &src, cv::Mat &sum, cv::Mat *sqsum, int y0, int y1)
+{
+    for (int y = y0; y < y1; y++)
+    {
+        integralRowPrefix(src.ptr<uchar>(y), src.cols, sum.ptr<int>(y + 1));
+        if (sqsum)
+            integralRowPrefixSq(src.ptr<uchar>(y), src.cols, sqsum->ptr<double>(y + 1));
+    }
+}
+
+// column pass of columns [c0, c1) of sum and sqsum
+inline void integralColumnPass(cv::Mat &sum, cv::Mat *sqsum, int c0, int c1)
+{
+    integralColumnPass32s(sum, c0, c1);
+    if (sqsum)
+        integralColumnPass64f(*sqsum, c0, c1);
+}
+
+// The tilted sum T(X, Y), over the pixels (x, y) with y < Y and
+// |x - X + 1| <= Y - y - 1, from the row prefix sums R_y of rowSums. With
+// the prefixes clamped to [0, width],
+//   T(X, Y) = P(X, Y) - Q(X, Y)
+//   P(X, Y) = sum over y < Y of R_y(X + Y - 1 - y) = P(X+1, Y-1) + R_{Y-1}(X)
+//   Q(X, Y) = sum over y < Y of R_y(X - Y + y)     = Q(X-1, Y-1) + R_{Y-1}(X-1)
+// where P beyond the last column is the sum of the rows above and Q before
+// the first column is 0. The sums wrap as the int sums of cv::integral.
+inline void integralTilted(const cv::Mat &rowSums, cv::Mat &tilted)
+{
+    const int width = rowSums.cols - 1;
+    std::vector<unsigned> buf(4 * (width + 2), 0);
+    unsigned *p = &buf[0], *pNext = p + (width + 2);
+    unsigned *q = pNext + (width + 2), *qNext = q + (width + 2);
+    unsigned above = 0;
+
+    std::fill(tilted.ptr<int>(0), tilted.ptr<int>(0) + width + 1, 0);
+    for (int y = 1; y < rowSums.rows; y++)
+    {
+        const int *r = rowSums.ptr<int>(y);
+        int *t = tilted.ptr<int>(y);
+        p[width + 1] = above;
+        qNext[0] = 0;
+        for (int x = 0; x <= width; x++)
+        {
+            pNext[x] = p[x + 1] + (unsigned)r[x];
+            if (x > 0)
+                qNext[x] = q[x - 1] + (unsigned)r[x - 1];
+            t[x] = (int)(pNext[x] - qNext[x]);
+        }
+        above += (unsigned)r[width];
+        std::swap(p, pNext);
+        std::swap(q, qNext);
+    }
+}
+
+// The integral images of src, as cv::integral(src, sum, *sqsum, *tilted).
+// sqsum and tilted are only computed when not NULL. Outputs of the right
+// size and type are filled in place.
+inline void computeIntegrals(const cv::Mat &src, cv::Mat &sum, cv::Mat *sqsum = NULL,
+    cv::Mat *tilted = NULL)
+{
+    if (src.type() != CV_8UC1)
+    {
+        cv::Mat unusedSqsum;
+        if (tilted)
+            cv::integral(src, sum, sqsum ? *sqsum : unusedSqsum, *tilted);
+        else if (sqsum)
+            cv::integral(src, sum, *sqsum);
+        else
+            cv::integral(src, sum);
+        return;
+    }
+
+    const int width = src.cols, height = src.rows;
+    sum.create(height + 1, width + 1, CV_32S);
+    std::fill(sum.ptr<int>(0), sum.ptr<int>(0) + width + 1, 0);
+    if (sqsum)
+    {
+        sqsum->create(height + 1, width + 1, CV_64F);
+        std::fill(sqsum->ptr<double>(0), sqsum->ptr<double>(0) + width + 1, 0.0);
+    }
+
+#ifdef PARALLEL
+    integralForBlocks(height, INTEGRAL_MIN_ROWS_PER_BLOCK, [&](int y0, int y1) {
+        integralRowPass(src, sum, sqsum, y0, y1);
+    });
+#else
+    integralRowPass(src, sum, sqsum, 0, height);
+#endif
+
+    // the tilted sum reads the row prefix sums before the column pass
+    if (tilted)
+    {
+        tilted->create(height + 1, width + 1, CV_32S);
+        integralTilted(sum, *tilted);
+    }
+
+#ifdef PARALLEL
+    integralForBlocks(width + 1, INTEGRAL_MIN_COLS_PER_BLOCK, [&](int c0, int c1) {
+        integralColumnPass(sum, sqsum, c0, c1);
+    });
+#else
+    integralColumnPass(sum, sqsum, 0, width + 1);
+#endif
+}
+
+} // namespace vision
+
+#endif // CGINTEGRALIMAGE_HPP
@@ -0,0 +1,104 @@
+/*
+ * Frame pipeline for multi-stage per-frame processing
+ *
+ * A generated pipeline such as foreground detection, blob analysis,
+ * detection, tracking and assignment runs its stages one after the other
+ * on each frame. FramePipeline runs them as a pipeline across frames:
+ * while stage k processes frame t, stage k-1 may already process frame
+ * t+1.
+ *
+ * The frames live in maxInFlight slots owned by the caller, which bounds
+ * the number of frames in flight. The source fills a free slot with the
+ * next frame, and each stage reads and writes the frame data of the slot
+ * it is given. A serial stage processes the frames one at a time in frame
+ * order, on a thread of its own, so its state is only ever touched by that
+ * thread and sees the frames as it would in a sequential loop. A parallel
+ * stage may process several frames at once and must not keep state across
+ * frames; its stage state is shared by its threads. A slot is handed back
+ * to the source once the last stage is done with it.
+ *
+ * Without PARALLEL, or with a single slot, run processes each frame
+ * through all the stages before reading the next one.
+ *
+ * Copyright 2016 The MathWorks, Inc.
+ */
+
+#ifndef CGPIPELINE_HPP
+#define CGPIPELINE_HPP
+
+#include "vision_defines.h"
+
+#include <vector>
+
+/////////////////////////////////////////////////////////////////////////////////
+// cgPipelineSourceFcn:
+//  Fills slot with the next frame; returns 0 when there are no more frames.
+//
+// cgPipelineStageFcn:
+//  Processes the frame of slot.
+/////////////////////////////////////////////////////////////////////////////////
+typedef int32_T (*cgPipelineSourceFcn)(void *sourceState, int32_T slot);
+typedef void (*cgPipelineStageFcn)(void *stageState, int32_T slot);
+
+/////////////////////////////////////////////////////////////////////////////////
+// cgPipeline_construct:
+//  Creates a pipeline of no stages with maxInFlight frame slots.
+//
+// cgPipeline_addStage:
+//  Appends a stage. isParallel selects a parallel stage, see above.
+//
+// cgPipeline_run:
+//  Runs the frames of source through the stages and returns once the last
+//  frame has left the last stage. Returns the number of frames.
+//
+// cgPipeline_deleteObj:
+//  Frees the pipeline.
+/////////////////////////////////////////////////////////////////////////////////
+EXTERN_C LIBMWCVSTRT_API void cgPipeline_construct(int32_T maxInFlight, void **ptrPipeline);
+EXTERN_C LIBMWCVSTRT_API void cgPipeline_addStage(void *ptrPipeline,
+    cgPipelineStageFcn fcn, void *stageState, boolean_T isParallel);
+EXTERN_C LIBMWCVSTRT_API int32_T cgPipeline_run(void *ptrPipeline,
+    cgPipelineSourceFcn source, void *sourceState);
+EXTERN_C LIBMWCVSTRT_API void cgPipeline_deleteObj(void *ptrPipeline);
+
+namespace vision
+{
+
+class FramePipeline
+{
+public:
+    explicit FramePipeline(int maxInFlight) : mMaxInFlight(maxInFlight > 0 ? maxInFlight : 1) {}
+
+    void addStage(cgPipelineStageFcn fcn, void *stageState, bool isParallel)
+    {
+        Stage stage = {fcn, stageState, isParallel};
+        mStages.push_back(stage);
+    }
+
+    int getMaxInFlight() const { return mMaxInFlight; }
+
+    // see cgPipeline_run; the first exception of a stage or of the source
+    // stops the source and is rethrown once the frames in flight are done
+    int run(cgPipelineSourceFcn source, void *sourceState);
+
+private:
+    struct Stage
+    {
+        cgPipelineStageFcn fcn;
+        void *state;
+        bool isParallel;
+    };
+
+    int runSequential(cgPipelineSourceFcn source, void *sourceState);
+
+    int mMaxInFlight;
+    std::vector<Stage> mStages;
+
+    // copying and assignment are disallowed
+    FramePipeline(const FramePipeline &);
+    FramePipeline &operator=(const FramePipeline &);
+};
+
+} // namespace vision
+
+#endif // CGPIPELINE_HPP
@@ -0,0 +1,163 @@
+/*
+ * Opt-in timing and allocation instrumentation of the cgwrapper cores
+ *
+ * When CG_PROFILE is defined, each instrumented entry point records one
+ * cgProfileRecord_T per call: the time spent converting its inputs to the
+ * OpenCV layout, running the algorithm and copying to its outputs, and the
+ * cv::Mat buffers it allocated. The records go to a ring buffer owned by
+ * the calling thread, which cgProfileRead drains on that thread. When
+ * CG_PROFILE is not defined, which is the default, the macros expand to
+ * nothing and cgProfileRead returns no records.
+ *
+ * An entry point starts with CG_PROFILE_CALL(), in the input phase, and
+ * moves to the next phase with CG_PROFILE_PHASE(). The time between two
+ * phase marks goes to the earlier phase. Phase marks in code called by an
+ * entry point, e.g. the step() of a matcher class, apply to the call in
+ * progress on the thread, and a call made while another is in progress on
+ * the same thread is counted as part of the outer call.
+ *
+ * Between cgTraceStart and cgTraceStop, the calls, their phases and the
+ * spans opened with CG_TRACE_SPAN() or cgTraceBegin are also kept as
+ * timestamped spans of the thread they ran on, and cgTraceWrite writes
+ * them as a Chrome trace, which chrome://tracing and the Perfetto UI open.
+ * The tasks of the worker pool and the bodies of the parallel loops of the
+ * cores are traced, so idle workers and waits for the slowest task show up
+ * as gaps.
+ *
+ * Copyright 2016 The MathWorks, Inc.
+ */
+
+#ifndef CGPROFILE_HPP
+#define CGPROFILE_HPP
+
+#include "vision_defines.h"
+
+/* phases of a call */
+#define CG_PROFILE_INPUT      0 /* layout conversion of the inputs */
+#define CG_PROFILE_COMPUTE    1 /* the algorithm */
+#define CG_PROFILE_OUTPUT     2 /* copies to the outputs */
+#define CG_PROFILE_NUM_PHASES 3
+
+/* records kept per thread; older records are overwritten */
+#define CG_PROFILE_RING_SIZE 256
+
+typedef struct {
+    const char *name;                         /* entry point */
+    real_T phaseNs[CG_PROFILE_NUM_PHASES];    /* nanoseconds per phase */
+    real_T totalNs;                           /* nanoseconds of the call */
+    real_T allocBytes;                        /* bytes of the cv::Mat allocations */
+    uint32_T numAllocs;                       /* cv::Mat allocations */
+} cgProfileRecord_T;
+
+/////////////////////////////////////////////////////////////////////////////////
+// cgProfileIsEnabled:
+//  Returns true if the cores were compiled with CG_PROFILE.
+//
+// cgProfileRead:
+//  Moves up to maxRecords of the records of the calling thread, oldest
+//  first, to records and returns their number.
+//
+// cgProfileNumDropped:
+//  Returns the number of records of the calling thread overwritten before
+//  they were read.
+//
+// Allocations are counted when a cv::Mat allocates its buffer on the thread
+// of the call, including those of OpenCV; the buffers of std containers and
+// the allocations of worker threads are not counted.
+/////////////////////////////////////////////////////////////////////////////////
+EXTERN_C LIBMWCVSTRT_API boolean_T cgProfileIsEnabled(void);
+EXTERN_C LIBMWCVSTRT_API int32_T cgProfileRead(cgProfileRecord_T *records, int32_T maxRecords);
+EXTERN_C LIBMWCVSTRT_API uint32_T cgProfileNumDropped(void);
+
+/////////////////////////////////////////////////////////////////////////////////
+// cgTraceStart:
+//  Discards the spans recorded so far and starts recording spans on all
+//  threads. Timestamps are relative to this call.
+//
+// cgTraceStop:
+//  Stops recording. The spans are kept until the next cgTraceStart.
+//
+// cgTraceWrite:
+//  Writes the recorded spans to filename in the Chrome trace event format,
+//  one track per thread. Returns the number of spans written, or -1 if the
+//  file cannot be written.
+//
+// cgTraceBegin, cgTraceEnd:
+//  Open and close a span on the calling thread, e.g. around a visionrt
+//  kernel in generated code. name must stay valid until cgTraceWrite,
+//  which a string literal does. Spans nest; cgTraceEnd closes the last
+//  span opened on the thread.
+//
+// cgTraceSetThreadName:
+//  Names the track of the calling thread, also a string literal.
+//
+// Each thread keeps at most CG_TRACE_MAX_SPANS spans; later spans are
+// dropped and counted in the trace metadata. Without CG_PROFILE these
+// functions do nothing and cgTraceWrite returns -1.
+/////////////////////////////////////////////////////////////////////////////////
+#define CG_TRACE_MAX_SPANS (1 << 20)
+
+EXTERN_C LIBMWCVSTRT_API void cgTraceStart(void);
+EXTERN_C LIBMWCVSTRT_API void cgTraceStop(void);
+EXTERN_C LIBMWCVSTRT_API int32_T cgTraceWrite(const char *filename);
+EXTERN_C LIBMWCVSTRT_API void cgTraceBegin(const char *name);
+EXTERN_C LIBMWCVSTRT_API void cgTraceEnd(void);
+EXTERN_C LIBMWCVSTRT_API void cgTraceSetThreadName(const char *name);
+
+#ifdef CG_PROFILE
+
+namespace vision
+{
+
+class ProfileCall
+{
+public:
+    // Starts a call named name, a string literal, unless a call is already
+    // in progress on the thread
+    explicit ProfileCall(const char *name);
+    ~ProfileCall();
+
+    // Ends the current phase of the call in progress on the thread
+    static void setPhase(int phase);
+
+private:
+    bool mIsOuter;
+
+    // copying and assignment are disallowed
+    ProfileCall(const ProfileCall &);
+    ProfileCall &operator=(const ProfileCall &);
+};
+
+// Traces the scope it is declared in as a span named name, a string
+// literal, while tracing is on
+class TraceSpan
+{
+public:
+    explicit TraceSpan(const char *name, const char *category = "span");
+    ~TraceSpan();
+
+private:
+    const char *mName;
+    const char *mCategory;
+    long long mStartNs;
+
+    // copying and assignment are disallowed
+    TraceSpan(const TraceSpan &);
+    TraceSpan &operator=(const TraceSpan &);
+};
+
+} // namespace vision
+
+#define CG_PROFILE_CALL() vision::ProfileCall cgProfileCall_(__func__)
+#define CG_PROFILE_PHASE(phase) vision::ProfileCall::setPhase(phase)
+#define CG_TRACE_SPAN(name) vision::TraceSpan cgTraceSpan_(name)
+
+#else
+
+#define CG_PROFILE_CALL()
+#define CG_PROFILE_PHASE(phase)
+#define CG_TRACE_SPAN(name)
+
+#endif // CG_PROFILE
+
+#endif //CGPROFILE_HPP
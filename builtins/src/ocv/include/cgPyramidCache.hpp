@@ -0,0 +1,235 @@
+/*
+ * Image pyramids shared by the cores that run on the same frame
+ *
+ * The point tracker, the BRISK scale space and the cascade detector each
+ * resample their input image to a set of smaller levels. When a pipeline
+ * runs several of them on the same frame, PyramidCache::acquire returns the
+ * same FramePyramid to all of them, and a level requested by one core is
+ * built once and read by the others.
+ *
+ * A frame is identified by its size, its type and its pixels: a hash of
+ * the pixels selects the cached frame and a comparison confirms it, so the
+ * cores need not share the buffer of the image. The cache keeps the
+ * cgGetPyramidCacheSize() most recently acquired frames, the current and
+ * the previous frame of a tracker by default. A FramePyramid stays valid as
+ * long as a core holds it, even once the cache has dropped it.
+ *
+ * A level is derived from a parent level, the frame being level 0, by
+ * cv::resize to a size with an interpolation, or by cv::pyrDown. Levels are
+ * built on first request, once, and requests from several threads for
+ * different levels build them in parallel. Their images are those the
+ * cores computed themselves, so sharing them does not change any result.
+ *
+ * The integral images of a level, see cgIntegralImage.hpp, are kept with
+ * it: the cascade detectors, SURF and BRISK computing them on the same
+ * frame compute them once.
+ *
+ * Copyright 2016 The MathWorks, Inc.
+ */
+
+#ifndef CGPYRAMIDCACHE_HPP
+#define CGPYRAMIDCACHE_HPP
+
+#include "vision_defines.h"
+#include "cgIntegralImage.hpp"
+#include "opencv2/core.hpp"
+#include "opencv2/imgproc.hpp"
+#include "opencv2/core/utility.hpp"
+
+#include <vector>
+
+#ifdef PARALLEL
+#include <mutex>
+#endif
+
+/////////////////////////////////////////////////////////////////////////////////
+// cgSetPyramidCacheSize:
+//  Sets the number of frames whose pyramids are kept for the cores that
+//  acquire them next. 0 disables the sharing: every core gets a pyramid of
+//  its own.
+//
+// cgGetPyramidCacheSize:
+//  Returns the number of frames whose pyramids are kept.
+//
+// cgReleasePyramidCache:
+//  Frees the pyramids kept for the next cores, e.g. after the last frame of
+//  a pipeline.
+/////////////////////////////////////////////////////////////////////////////////
+#define CG_PYRAMID_CACHE_DEFAULT_SIZE 2
+
+EXTERN_C LIBMWCVSTRT_API void cgSetPyramidCacheSize(int32_T numFrames);
+EXTERN_C LIBMWCVSTRT_API int32_T cgGetPyramidCacheSize(void);
+EXTERN_C LIBMWCVSTRT_API void cgReleasePyramidCache(void);
+
+namespace vision
+{
+
+#ifdef PARALLEL
+typedef std::mutex PyramidMutex;
+typedef std::lock_guard<std::mutex> PyramidLock;
+#else
+// cv::parallel_for_ bodies request levels from several threads in this
+// build too
+typedef cv::Mutex PyramidMutex;
+typedef cv::AutoLock PyramidLock;
+#endif
+
+// interpolation of FramePyramid::getLevel for cv::pyrDown
+const int PYRAMID_PYRDOWN = -1;
+
+class FramePyramid
+{
+public:
+    // the pyramid keeps a copy of frame as level 0
+    explicit FramePyramid(const cv::Mat &frame)
+    {
+        mLevels.push_back(new Level(-1, frame.size(), PYRAMID_PYRDOWN));
+        frame.copyTo(mLevels[0]->image);
+        mLevels[0]->built = true;
+    }
+
+    ~FramePyramid()
+    {
+        for (size_t i = 0; i < mLevels.size(); i++)
+            delete mLevels[i];
+    }
+
+    const cv::Mat &getFrame() const { return getImage(0); }
+
+    // Returns the level made from the parent level by cv::resize to size
+    // with the interpolation, or by cv::pyrDown to size for
+    // PYRAMID_PYRDOWN. The same parent, size and interpolation give the
+    // same level; a resize to the size of the parent gives the parent.
+    int getLevel(int parent, const cv::Size &size, int interpolation)
+    {
+        if (interpolation != PYRAMID_PYRDOWN && getImage(parent).size() == size)
+            return parent;
+
+        Level *level = NULL;
+        int index = 0;
+        {
+            PyramidLock lock(mMutex);
+            const int numLevels = (int)mLevels.size();
+            for (index = 1; index < numLevels; index++)
+            {
+                const Level &l = *mLevels[index];
+                if (l.parent == parent && l.size == size && l.interpolation == interpolation)
+                    break;
+            }
+            if (index == numLevels)
+                mLevels.push_back(new Level(parent, size, interpolation));
+            level = mLevels[index];
+        }
+
+        // the parent was built by the request that returned it
+        PyramidLock lock(level->mutex);
+        if (!level->built)
+        {
+            const cv::Mat &src = getImage(parent);
+            if (interpolation == PYRAMID_PYRDOWN)
+                cv::pyrDown(src, level->image, size);
+            else
+                cv::resize(src, level->image, size, 0, 0, interpolation);
+            level->built = true;
+        }
+        return index;
+    }
+
+    // Level k of the Gaussian pyramid: the frame after k cv::pyrDown, each
+    // one to ((cols+1)/2, (rows+1)/2)
+    int getGaussianLevel(int k)
+    {
+        int index = 0;
+        for (int i = 0; i < k; i++)
+        {
+            const cv::Mat &src = getImage(index);
+            index = getLevel(index, cv::Size((src.cols + 1) / 2, (src.rows + 1) / 2),
+                PYRAMID_PYRDOWN);
+        }
+        return index;
+    }
+
+    // image of a level returned by getLevel
+    const cv::Mat &getImage(int index) const
+    {
+        PyramidLock lock(mMutex);
+        return mLevels[index]->image;
+    }
+
+    // Integral images of a level, see computeIntegrals. sqsum and tilted
+    // are only computed when asked for. The images are shared with the
+    // other cores and must not be written to.
+    void getIntegrals(int index, cv::Mat &sum, cv::Mat *sqsum = NULL, cv::Mat *tilted = NULL)
+    {
+        Level *level = NULL;
+        {
+            PyramidLock lock(mMutex);
+            level = mLevels[index];
+        }
+
+        PyramidLock lock(level->mutex);
+        if (level->sum.empty() || (sqsum && level->sqsum.empty()) ||
+            (tilted && level->tilted.empty()))
+        {
+            // the images held by other cores stay valid
+            const bool withSqsum = sqsum || !level->sqsum.empty();
+            const bool withTilted = tilted || !level->tilted.empty();
+            cv::Mat newSum, newSqsum, newTilted;
+            computeIntegrals(level->image, newSum, withSqsum ? &newSqsum : NULL,
+                withTilted ? &newTilted : NULL);
+            level->sum = newSum;
+            level->sqsum = newSqsum;
+            level->tilted = newTilted;
+        }
+        sum = level->sum;
+        if (sqsum)
+            *sqsum = level->sqsum;
+        if (tilted)
+            *tilted = level->tilted;
+    }
+
+private:
+    struct Level
+    {
+        Level(int p, const cv::Size &s, int i)
+            : parent(p), size(s), interpolation(i), built(false) {}
+
+        int parent;
+        cv::Size size;
+        int interpolation;
+        cv::Mat image;
+        cv::Mat sum, sqsum, tilted;
+        bool built;
+        PyramidMutex mutex;
+    };
+
+    mutable PyramidMutex mMutex;
+
+    // owned, deleted with the pyramid; a Level does not move once returned
+    std::vector<Level *> mLevels;
+
+    // copying and assignment are disallowed
+    FramePyramid(const FramePyramid &);
+    FramePyramid &operator=(const FramePyramid &);
+};
+
+// cv::Ptr counts its references atomically, so cores on several threads
+// can hold the same pyramid
+typedef cv::Ptr<FramePyramid> FramePyramidPtr;
+
+// The frames of the cache, see cgCommon.cpp
+class PyramidCache
+{
+public:
+    // Returns the pyramid of the pixels of frame, shared with the cores
+    // that acquired the same pixels
+    static FramePyramidPtr acquire(const cv::Mat &frame);
+
+    static int getMaxFrames();
+    static void setMaxFrames(int maxFrames);
+    static void release();
+};
+
+} // namespace vision
+
+#endif // CGPYRAMIDCACHE_HPP
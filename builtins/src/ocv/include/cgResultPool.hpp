@@ -0,0 +1,181 @@
+/*
+ * Recycling pool of the result containers returned by the cores
+ *
+ * The cores return their results (keypoints, descriptors, detections,
+ * regions) through a void** as a container that the matching _assignOutput
+ * function frees after copying it to the MATLAB outputs. Taking these
+ * containers from ResultPool<T>::acquire instead of new, and giving them
+ * back with ResultPool<T>::release instead of delete, keeps the container
+ * and the buffer of a std::vector from one frame to the next, so a core
+ * called on every frame stops allocating its results once they have
+ * reached their steady-state size.
+ *
+ * Containers are only recycled within a type, and a pool keeps at most
+ * cgGetResultPoolSize() of them. A container from the pool is a plain
+ * new T, so it may still be freed with delete, and release accepts a
+ * container made with new.
+ *
+ * Copyright 2016 The MathWorks, Inc.
+ */
+
+#ifndef CGRESULTPOOL_HPP
+#define CGRESULTPOOL_HPP
+
+#include "vision_defines.h"
+#include "opencv2/core.hpp"
+
+#include <vector>
+
+#ifdef PARALLEL
+#include <mutex>
+#endif
+
+/////////////////////////////////////////////////////////////////////////////////
+// cgSetResultPoolSize:
+//  Sets the number of released containers of each type kept for reuse.
+//  0 disables the pools: results are allocated with new and freed with
+//  delete. The containers over the new size are freed.
+//
+// cgGetResultPoolSize:
+//  Returns the number of containers of each type kept for reuse.
+//
+// cgReleaseResultPool:
+//  Frees all the containers kept for reuse, e.g. after the last frame of a
+//  pipeline. The pools fill up again as the cores run.
+/////////////////////////////////////////////////////////////////////////////////
+#define CG_RESULT_POOL_DEFAULT_SIZE 4
+
+EXTERN_C LIBMWCVSTRT_API void cgSetResultPoolSize(int32_T maxPerType);
+EXTERN_C LIBMWCVSTRT_API int32_T cgGetResultPoolSize(void);
+EXTERN_C LIBMWCVSTRT_API void cgReleaseResultPool(void);
+
+namespace vision
+{
+
+#ifdef PARALLEL
+typedef std::mutex ResultPoolMutex;
+typedef std::lock_guard<std::mutex> ResultPoolLock;
+#else
+struct ResultPoolMutex {};
+struct ResultPoolLock
+{
+    explicit ResultPoolLock(ResultPoolMutex &) {}
+};
+#endif
+
+// Empties a released container. A std::vector keeps its buffer; the
+// buffer of a cv::Mat is freed, since create() reallocates it for any new
+// number of rows and it may be shared with the caller.
+template <typename T, typename Alloc>
+inline void resetResult(std::vector<T, Alloc> &result)
+{
+    result.clear();
+}
+
+inline void resetResult(cv::Mat &result)
+{
+    result.release();
+}
+
+// Bookkeeping shared by the pools of all types, see cgCommon.cpp
+class ResultPoolRegistry
+{
+public:
+    // trim(maxSize) frees the containers of one pool over maxSize
+    typedef void (*TrimFcn)(int maxSize);
+
+    static void add(TrimFcn trim);
+    static int getMaxSize();
+    static void setMaxSize(int maxSize);
+
+    // frees the containers of all pools over maxSize
+    static void trim(int maxSize);
+};
+
+template <typename T>
+class ResultPool
+{
+public:
+    // Returns an empty container
+    static T *acquire()
+    {
+        ResultPool &pool = instance();
+        {
+            ResultPoolLock lock(pool.mMutex);
+            if (!pool.mFree.empty())
+            {
+                T *result = pool.mFree.back();
+                pool.mFree.pop_back();
+                return result;
+            }
+        }
+        return new T();
+    }
+
+    // Takes back a container returned by acquire or made with new. NULL is
+    // ignored.
+    static void release(T *result)
+    {
+        if (result == NULL)
+            return;
+
+        resetResult(*result);
+
+        ResultPool &pool = instance();
+        {
+            ResultPoolLock lock(pool.mMutex);
+            if ((int)pool.mFree.size() < ResultPoolRegistry::getMaxSize())
+            {
+                pool.mFree.push_back(result);
+                return;
+            }
+        }
+        delete result;
+    }
+
+private:
+    ResultPool()
+    {
+        ResultPoolRegistry::add(&ResultPool::trim);
+    }
+
+    ~ResultPool()
+    {
+        for (size_t i = 0; i < mFree.size(); ++i)
+            delete mFree[i];
+    }
+
+    static ResultPool &instance()
+    {
+        // initialized on first use; thread-safe in C++11
+        static ResultPool pool;
+        return pool;
+    }
+
+    static void trim(int maxSize)
+    {
+        ResultPool &pool = instance();
+        std::vector<T *> freed;
+        {
+            ResultPoolLock lock(pool.mMutex);
+            while ((int)pool.mFree.size() > maxSize)
+            {
+                freed.push_back(pool.mFree.back());
+                pool.mFree.pop_back();
+            }
+        }
+        for (size_t i = 0; i < freed.size(); ++i)
+            delete freed[i];
+    }
+
+    ResultPoolMutex mMutex;
+    std::vector<T *> mFree;
+
+    // copying and assignment are disallowed
+    ResultPool(const ResultPool &);
+    ResultPool &operator=(const ResultPool &);
+};
+
+} // namespace vision
+
+#endif // CGRESULTPOOL_HPP
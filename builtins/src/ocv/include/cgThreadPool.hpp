@@ -0,0 +1,199 @@
+/*
+ * Process-wide worker pool used by the cgwrapper functions
+ *
+ * The pool is created on first use and its threads are kept alive across
+ * calls, so per-frame conversions do not pay for thread creation. When
+ * PARALLEL is not defined the pool is not compiled and all work runs on
+ * the calling thread.
+ *
+ * Copyright 2016 The MathWorks, Inc.
+ */
+
+#ifndef CGTHREADPOOL_HPP
+#define CGTHREADPOOL_HPP
+
+#include "vision_defines.h"
+
+#ifdef PARALLEL
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+#endif
+
+/////////////////////////////////////////////////////////////////////////////////
+// cgSetNumThreads:
+//  Sets the number of threads, including the calling thread, used by the
+//  layout conversion helpers and other users of the pool. A value less than
+//  or equal to 0 selects the number of hardware threads. The pool is resized
+//  on the next parallel call. The value is also passed to cv::setNumThreads,
+//  so that it bounds the cv::parallel_for_ loops of the OpenCV based cores
+//  (SURF, HOG, cascade and Haar detection, ...) and the cores that split
+//  their work by cv::getNumThreads. It does not affect the TBB loops of the
+//  foreground detector, see foregroundDetector_setNumThreads.
+//
+// cgGetNumThreads:
+//  Returns the number of threads used by the pool, 1 when PARALLEL is not
+//  defined.
+/////////////////////////////////////////////////////////////////////////////////
+EXTERN_C LIBMWCVSTRT_API void cgSetNumThreads(int32_T numThreads);
+EXTERN_C LIBMWCVSTRT_API int32_T cgGetNumThreads(void);
+
+/////////////////////////////////////////////////////////////////////////////////
+// cgSetThreadAffinity:
+//  Selects how the workers of the pool are placed on the CPUs the process
+//  may run on:
+//   CG_AFFINITY_NONE    leaves the placement to the OS (default)
+//   CG_AFFINITY_COMPACT pins the workers to consecutive CPUs, filling one
+//                       NUMA node before the next
+//   CG_AFFINITY_SCATTER pins consecutive workers to different NUMA nodes in
+//                       turn, to use the memory bandwidth of all nodes
+//  The calling thread is not pinned. The workers are restarted with the new
+//  placement on the next parallel call. Threads are only pinned on Linux;
+//  elsewhere the policy is recorded and ignored.
+//
+// cgGetThreadAffinity:
+//  Returns the policy set by cgSetThreadAffinity.
+/////////////////////////////////////////////////////////////////////////////////
+#define CG_AFFINITY_NONE    0
+#define CG_AFFINITY_COMPACT 1
+#define CG_AFFINITY_SCATTER 2
+
+EXTERN_C LIBMWCVSTRT_API void cgSetThreadAffinity(int32_T policy);
+EXTERN_C LIBMWCVSTRT_API int32_T cgGetThreadAffinity(void);
+
+#ifdef PARALLEL
+
+namespace vision
+{
+
+class ThreadPool
+{
+public:
+    // Returns the process-wide pool. Threads are started on first use.
+    static ThreadPool &instance();
+
+    // Requested number of threads, see cgSetNumThreads.
+    void setNumThreads(int numThreads);
+    int getNumThreads();
+
+    // Placement of the workers, see cgSetThreadAffinity.
+    void setAffinity(int policy);
+    int getAffinity();
+
+    // Calls task(i) for i = 0, ..., numTasks-1 and returns when all tasks
+    // are done. The calling thread also executes tasks. Calls made from a
+    // pool thread, or while another thread owns the pool, run serially.
+    void run(int numTasks, const std::function<void(int)> &task);
+
+private:
+    ThreadPool();
+    ~ThreadPool();
+
+    void resize(int numThreads);
+    void stopWorkers();
+    void workerLoop(int index);
+    void executeTasks();
+
+    std::vector<std::thread> mWorkers;
+
+    // one caller at a time owns the pool
+    std::mutex mRunMutex;
+
+    // protects the job state below
+    std::mutex mMutex;
+    std::condition_variable mWorkAvailable;
+    std::condition_variable mWorkDone;
+
+    const std::function<void(int)> *mTask;
+    int mNumTasks;
+    int mNextTask;
+    int mNumPending;
+    unsigned int mGeneration;
+    bool mStop;
+
+    int mRequestedThreads;
+    int mAffinity;
+
+    // the running workers were pinned with another policy
+    bool mIsAffinityChanged;
+
+    // copying and assignment are disallowed
+    ThreadPool(const ThreadPool &);
+    ThreadPool &operator=(const ThreadPool &);
+};
+
+} // namespace vision
+
+/////////////////////////////////////////////////////////////////////////////////
+// cgParallelForRows:
+//  Splits rows [0, numRows) into contiguous blocks of at least
+//  minRowsPerBlock rows and calls fcn(startRowIdx, endRowIdx) for each block
+//  on the pool.
+/////////////////////////////////////////////////////////////////////////////////
+template <typename Fcn>
+void cgParallelForRows(int numRows, int minRowsPerBlock, Fcn fcn)
+{
+    vision::ThreadPool &pool = vision::ThreadPool::instance();
+
+    minRowsPerBlock = std::max(minRowsPerBlock, 1);
+    const int numBlocks = std::min(pool.getNumThreads(),
+        (numRows + minRowsPerBlock - 1) / minRowsPerBlock);
+
+    if (numBlocks <= 1)
+    {
+        if (numRows > 0)
+            fcn(0, numRows);
+        return;
+    }
+
+    pool.run(numBlocks, [&](int b) {
+        const int startRowIdx = (int)((long long)numRows * b / numBlocks);
+        const int endRowIdx = (int)((long long)numRows * (b + 1) / numBlocks);
+        fcn(startRowIdx, endRowIdx);
+    });
+}
+
+/////////////////////////////////////////////////////////////////////////////////
+// cgParallelForWorkers:
+//  Calls fcn(workerIdx, i) for i = 0, ..., n-1 on the pool. Items are handed
+//  out one at a time, so items of uneven cost balance across the threads.
+//  workerIdx is below cgGetNumThreads() and a given workerIdx never runs
+//  two items at once, so fcn can keep per-worker state, e.g. a detector
+//  object reused over the items.
+/////////////////////////////////////////////////////////////////////////////////
+template <typename Fcn>
+void cgParallelForWorkers(int n, Fcn fcn)
+{
+    vision::ThreadPool &pool = vision::ThreadPool::instance();
+    const int numWorkers = std::min(pool.getNumThreads(), n);
+
+    if (numWorkers <= 1)
+    {
+        for (int i = 0; i < n; i++)
+            fcn(0, i);
+        return;
+    }
+
+    std::atomic<int> next(0);
+    pool.run(numWorkers, [&](int w) {
+        for (int i = next++; i < n; i = next++)
+            fcn(w, i);
+    });
+}
+
+#else
+
+template <typename Fcn>
+void cgParallelForWorkers(int n, Fcn fcn)
+{
+    for (int i = 0; i < n; i++)
+        fcn(0, i);
+}
+
+#endif // PARALLEL
+
+#endif //CGTHREADPOOL_HPP
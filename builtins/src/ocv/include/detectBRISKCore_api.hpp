@@ -17,6 +17,52 @@ int32_T detectBRISK_detectRM(uint8_T *img,
                            int threshold, int numOctaves,
                            void **outKeypoints);
 
+// keeps the maxPerCell strongest keypoints of each cellSize x cellSize cell
+EXTERN_C LIBMWCVSTRT_API
+int32_T detectBRISK_detectBucketed(uint8_T *img,
+                                   int nRows, int nCols,
+                                   int threshold, int numOctaves,
+                                   int cellSize, int maxPerCell,
+                                   void **outKeypoints);
+
+EXTERN_C LIBMWCVSTRT_API
+int32_T detectBRISK_detectBucketedRM(uint8_T *img,
+                                     int nRows, int nCols,
+                                     int threshold, int numOctaves,
+                                     int cellSize, int maxPerCell,
+                                     void **outKeypoints);
+
+// Corner score of the BRISK layers: BRISK_SCORE_TREE runs the decision
+// trees of AGAST, BRISK_SCORE_COMPACT a few short loops, with SSE2 or NEON
+// when available, that give the same scores in far less code. The default
+// is BRISK_SCORE_COMPACT on SIMD builds. The method applies to the
+// detections that start after the call.
+#define BRISK_SCORE_TREE    0
+#define BRISK_SCORE_COMPACT 1
+
+EXTERN_C LIBMWCVSTRT_API
+void detectBRISK_setScoreMethod(int32_T method);
+
+EXTERN_C LIBMWCVSTRT_API
+int32_T detectBRISK_getScoreMethod(void);
+
+// persistent detector, reused over the frames of a video
+EXTERN_C LIBMWCVSTRT_API
+void detectBRISK_construct(void **ptr2ptrClass, int threshold, int numOctaves);
+
+EXTERN_C LIBMWCVSTRT_API
+int32_T detectBRISK_detectObj(void *ptrClass, uint8_T *img,
+                              int nRows, int nCols,
+                              void **outKeypoints);
+
+EXTERN_C LIBMWCVSTRT_API
+int32_T detectBRISK_detectObjRM(void *ptrClass, uint8_T *img,
+                                int nRows, int nCols,
+                                void **outKeypoints);
+
+EXTERN_C LIBMWCVSTRT_API
+void detectBRISK_deleteObj(void *ptrClass);
+
 EXTERN_C LIBMWCVSTRT_API
 void detectBRISK_assignOutputs(void *ptrKeypoints,
                                real32_T * location,real32_T * metric,
@@ -27,4 +73,32 @@ void detectBRISK_assignOutputsRM(void *ptrKeypoints,
                                real32_T * location,real32_T * metric,
                                real32_T * scale, real32_T * orientation);
 
+// single call: writes the capacity strongest keypoints to the outputs,
+// location being capacity x 2, and returns the number of keypoints found
+EXTERN_C LIBMWCVSTRT_API
+int32_T detectBRISK_detectInto(uint8_T *img,
+                               int nRows, int nCols,
+                               int threshold, int numOctaves, int capacity,
+                               real32_T * location, real32_T * metric,
+                               real32_T * scale, real32_T * orientation);
+
+EXTERN_C LIBMWCVSTRT_API
+int32_T detectBRISK_detectIntoRM(uint8_T *img,
+                                 int nRows, int nCols,
+                                 int threshold, int numOctaves, int capacity,
+                                 real32_T * location, real32_T * metric,
+                                 real32_T * scale, real32_T * orientation);
+
+EXTERN_C LIBMWCVSTRT_API
+int32_T detectBRISK_detectObjInto(void *ptrClass, uint8_T *img,
+                                  int nRows, int nCols, int capacity,
+                                  real32_T * location, real32_T * metric,
+                                  real32_T * scale, real32_T * orientation);
+
+EXTERN_C LIBMWCVSTRT_API
+int32_T detectBRISK_detectObjIntoRM(void *ptrClass, uint8_T *img,
+                                    int nRows, int nCols, int capacity,
+                                    real32_T * location, real32_T * metric,
+                                    real32_T * scale, real32_T * orientation);
+
 #endif
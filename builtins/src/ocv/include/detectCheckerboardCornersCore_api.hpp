@@ -0,0 +1,29 @@
+/* Copyright 2016 The MathWorks, Inc. */
+
+#ifndef _DETECTCHECKERBOARDCORNERS_
+#define _DETECTCHECKERBOARDCORNERS_
+
+#include "vision_defines.h"
+
+/* Checkerboard corner candidates of a set of images, see
+   CheckerboardCornerDetector.hpp. images is nRows-by-nCols-by-numImages,
+   single in [0, 1], column major. sigma and peakThreshold are those of
+   detectCheckerboard. numCandidates receives the number of candidates of
+   each image and metric, 2-by-numImages, cxy then c45. The candidates are
+   freed by detectCheckerboardCorners_assignOutputDeleteBatch. Returns the
+   total number of candidates. */
+EXTERN_C LIBMWCVSTRT_API
+int32_T detectCheckerboardCorners_detect(const real32_T * images,
+        const int32_T nRows, const int32_T nCols, const int32_T numImages,
+        const double sigma, const double peakThreshold,
+        int32_T * numCandidates, void ** ptr2ptrBatch);
+
+/* Candidates in the order of numCandidates, column major: points and
+   subPixelPoints are N-by-2 [x y], 1-based, scores N-by-1, and
+   orientations N-by-4, the [v1 v2] of cornerOrientations. */
+EXTERN_C LIBMWCVSTRT_API
+void detectCheckerboardCorners_assignOutputDeleteBatch(void * ptrBatch,
+        real32_T * points, real32_T * scores, real32_T * orientations,
+        real32_T * subPixelPoints);
+
+#endif
@@ -15,9 +15,32 @@ EXTERN_C LIBMWCVSTRT_API int32_T detectFAST_computeRM(uint8_T *inImg,
 	int threshold,
 	void **outKeypoints);
 
+// keeps the maxPerCell strongest corners of each cellSize x cellSize cell
+EXTERN_C LIBMWCVSTRT_API int32_T detectFAST_computeBucketed(uint8_T *inImg,
+	int32_T nRows, int32_T nCols, int32_T isRGB,
+	int threshold, int32_T cellSize, int32_T maxPerCell,
+	void **outKeypoints);
+
+EXTERN_C LIBMWCVSTRT_API int32_T detectFAST_computeBucketedRM(uint8_T *inImg,
+	int32_T nRows, int32_T nCols, int32_T isRGB,
+	int threshold, int32_T cellSize, int32_T maxPerCell,
+	void **outKeypoints);
+
 EXTERN_C LIBMWCVSTRT_API void detectFAST_assignOutput(void *ptrKeypoints,
 	real32_T *outLoc, real32_T *outMetric);
 
 EXTERN_C LIBMWCVSTRT_API void detectFAST_assignOutputRM(void *ptrKeypoints,
 	real32_T *outLoc, real32_T *outMetric);
+
+// single call: writes the capacity strongest corners to outLoc (capacity x 2)
+// and outMetric, and returns the number of corners found
+EXTERN_C LIBMWCVSTRT_API int32_T detectFAST_computeInto(uint8_T *inImg,
+	int32_T nRows, int32_T nCols, int32_T isRGB,
+	int threshold, int32_T capacity,
+	real32_T *outLoc, real32_T *outMetric);
+
+EXTERN_C LIBMWCVSTRT_API int32_T detectFAST_computeIntoRM(uint8_T *inImg,
+	int32_T nRows, int32_T nCols, int32_T isRGB,
+	int threshold, int32_T capacity,
+	real32_T *outLoc, real32_T *outMetric);
 #endif
@@ -35,6 +35,58 @@ EXTERN_C LIBMWCVSTRT_API void detectMser_computeRM(uint8_T *inImg,
 	int32_T *numRegions,
 	void **outRegions);
 
+// The two passes of each channel run in parallel. With perChannel, each
+// channel of an RGB image is processed as a grayscale image instead of
+// with the color (MSCR) algorithm.
+EXTERN_C LIBMWCVSTRT_API void detectMser_computeParallel(uint8_T *inImg,
+	int32_T nRows, int32_T nCols, int32_T isRGB,
+	int delta,
+	int minArea,
+	int maxArea,
+	float maxVariation,
+	float minDiversity,
+	int maxEvolution,
+	double areaThreshold,
+	double minMargin,
+	int edgeBlurSize,
+	boolean_T perChannel,
+	int32_T *numTotalPts,
+	int32_T *numRegions,
+	void **outRegions);
+
+EXTERN_C LIBMWCVSTRT_API void detectMser_computeParallelRM(uint8_T *inImg,
+	int32_T nRows, int32_T nCols, int32_T isRGB,
+	int delta,
+	int minArea,
+	int maxArea,
+	float maxVariation,
+	float minDiversity,
+	int maxEvolution,
+	double areaThreshold,
+	double minMargin,
+	int edgeBlurSize,
+	boolean_T perChannel,
+	int32_T *numTotalPts,
+	int32_T *numRegions,
+	void **outRegions);
+
+// Regions as horizontal pixel runs: returns the total number of runs
+EXTERN_C LIBMWCVSTRT_API int32_T detectMser_countRuns(void *ptrRegions);
+
+EXTERN_C LIBMWCVSTRT_API void detectMser_assignRuns(void *ptrRegions,
+	int32_T numTotalRuns, int32_T *outRuns, int32_T *outLengths);
+
+EXTERN_C LIBMWCVSTRT_API void detectMser_assignRunsRM(void *ptrRegions,
+	int32_T numTotalRuns, int32_T *outRuns, int32_T *outLengths);
+
+// Region statistics: area, bounding box [x y width height], centroid [x y]
+// and second central moments [mu20 mu11 mu02]. The regions are not freed.
+EXTERN_C LIBMWCVSTRT_API void detectMser_assignStats(void *ptrRegions,
+	int32_T *outArea, int32_T *outBBox, real_T *outCentroid, real_T *outMoments);
+
+EXTERN_C LIBMWCVSTRT_API void detectMser_assignStatsRM(void *ptrRegions,
+	int32_T *outArea, int32_T *outBBox, real_T *outCentroid, real_T *outMoments);
+
 EXTERN_C LIBMWCVSTRT_API void detectMser_assignOutput(void *ptrRegions,
 	int32_T numTotalPts, int32_T *outPts, int32_T *outLengths);
 
@@ -1,6 +1,11 @@
 #ifndef DISPARITYBM
 #define DISPARITYBM
 
+#include <algorithm>
+#include <cfloat>
+
+#include "mwtranspose.hpp"
+
 //////////////////////////////////////////////////////////////////////////////
 // Transpose and copy matrix. The size of input matrix, output matrix, and
 // the region to copy can be different. The other pixels are set to 0.  
@@ -13,28 +18,19 @@ void transposeAndPad(T* in, T* out,
                      mwSize numOutRows,   mwSize numOutCols,
                      mwSize numInRows)
 {
-    mwSize r, c;
-    for(c=0; c<numValidCols; c++)
-    {
-        for(r=0; r<numValidRows; r++)
-        {
-            out[r*numOutCols+c] = in[c*numInRows+r];
-        }
+    // Transpose the valid region in cache tiles
+    vision::transposeTiled<T>(in, numInRows, out, numOutCols,
+                              (int)numValidRows, (int)numValidCols);
 
+    mwSize r;
+    for(r=0; r<numValidRows; r++)
+    {
         // Pad the right border
-        for(; r<numOutRows; r++)
-        {
-            out[r*numOutCols+c] = 0;
-        }
+        std::fill(out + r*numOutCols + numValidCols, out + (r+1)*numOutCols, (T)0);
     }
 
     // Pad the bottom border
-    for(; c<numOutCols; c++)
-    {
-        for(r=0; r<numOutRows; r++) {
-            out[r*numOutCols+c] = 0;
-        }
-    }
+    std::fill(out + r*numOutCols, out + numOutRows*numOutCols, (T)0);
 }
 
 template<class T>
@@ -79,30 +75,31 @@ void transposeAndClip(T* in, T* out,
                       mwSize numOutRows,   mwSize numOutCols,
                       mwSize numInRows,    T invalidValue, mwSize borderWidth)
 {
+    const mwSize numCopyRows = numValidRows-borderWidth;
+
+    // Transpose the valid region in cache tiles, then clip the output rows
+    // which are traversed contiguously
+    vision::transposeTiled<T>(in, numInRows, out, numOutCols,
+                              (int)numCopyRows, (int)numValidCols);
+
     mwSize r, c;
-    for(c=0; c<numValidCols; c++)
+    for(r=0; r<numCopyRows; r++)
     {
-        for(r=0; r<numValidRows-borderWidth; r++)
+        T *outRow = out + r*numOutCols;
+        for(c=0; c<numValidCols; c++)
         {
-            T val = in[c*numInRows+r];
-            out[r*numOutCols+c] = (val != invalidValue ? in[c*numInRows+r] : -FLT_MAX);
+            if (outRow[c] == invalidValue)
+            {
+                outRow[c] = -FLT_MAX;
+            }
         }
 
-        // Overwrite pixels at the right border
-        for(; r<numOutRows; r++)
-        {
-            out[r*numOutCols+c] = -FLT_MAX;
-        }
+        // Overwrite pixels at the bottom border
+        std::fill(outRow + numValidCols, outRow + numOutCols, (T)-FLT_MAX);
     }
 
-    // Overwrite pixels at the bottom border
-    for(; c<numOutCols; c++)
-    {
-        for(r=0; r<numOutRows; r++)
-        {
-            out[r*numOutCols+c] = -FLT_MAX;
-        }
-    }
+    // Overwrite pixels at the right border
+    std::fill(out + r*numOutCols, out + numOutRows*numOutCols, (T)-FLT_MAX);
 }
 
 template<class T>
@@ -136,85 +133,65 @@ void copyAndClipRM(T* in, T* out,
 	}
 }
 
-inline void transposeClipAndCastBM(int16_T* in, real32_T* out,
-                      mwSize numValidRows, mwSize numValidCols,
-                      mwSize numOutRows,   mwSize numOutCols,
-                      mwSize numInRows,    int16_T invalidValue, mwSize borderWidth)
+//////////////////////////////////////////////////////////////////////////////
+// Fixed point disparity with 4 fractional bits to single; -FLT_MAX at or
+// below invalidValue.
+//////////////////////////////////////////////////////////////////////////////
+inline real32_T castBM(int16_T val, int16_T invalidValue)
 {
-    mwSize r, c;
-    for(c=0; c<numValidCols; c++)
+    if (val <= invalidValue)
     {
-        for(r=0; r<numValidRows-borderWidth; r++)
+        return -FLT_MAX;
+    }
+    // Adding back the 4 bit fractional part, *0.0625 to shift it by 2^-4.
+    int16_T fractionalPart = 0x000f & val;
+    return (real32_T)(val >> 4) + (real32_T)(fractionalPart*0.0625);
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// Converts rows [rowBegin, rowEnd) of the fixed point disparity of StereoBM,
+// which has 4 fractional bits, to single. in points at row rowBegin and has
+// inStep elements per row, so it can be a strip of the disparity or a
+// padded buffer. out is the nRows-by-nCols output, column major unless
+// isRowMajor. Pixels at or below invalidValue, and the last borderWidth
+// columns, are set to -FLT_MAX.
+//////////////////////////////////////////////////////////////////////////////
+inline void clipAndCastRowsBM(const int16_T* in, size_t inStep, real32_T* out,
+                              int nRows, int nCols, int rowBegin, int rowEnd,
+                              int16_T invalidValue, int borderWidth, bool isRowMajor)
+{
+    const int numValidCols = std::max(nCols - borderWidth, 0);
+    int r, c;
+
+    if (isRowMajor)
+    {
+        for (r = rowBegin; r < rowEnd; r++, in += inStep)
         {
-            int16_T val = in[c*numInRows+r];
-            int16_T fractionalPart = 0x000f & val;
-            if (val > invalidValue)
-            {
-                out[r*numOutCols+c] = (real32_T)(in[c*numInRows+r] >> 4);
-                // Adding back the 4 bit fractional part, *0.0625 to shift it by 2^-4.
-                out[r*numOutCols+c] += (real32_T)(fractionalPart*0.0625);
-            }
-            else
+            real32_T *outRow = out + (size_t)r*nCols;
+            for (c = 0; c < numValidCols; c++)
             {
-                out[r*numOutCols+c] = -FLT_MAX;
+                outRow[c] = castBM(in[c], invalidValue);
             }
+            std::fill(outRow + numValidCols, outRow + nCols, -FLT_MAX);
         }
-
-        // Overwrite pixels at the right border
-        for(; r<numOutRows; r++)
-        {
-            out[r*numOutCols+c] = -FLT_MAX;
-        }
+        return;
     }
 
-    // Overwrite pixels at the bottom border
-    for(; c<numOutCols; c++)
+    // column major: each output column is written contiguously
+    for (c = 0; c < numValidCols; c++)
     {
-        for(r=0; r<numOutRows; r++)
+        const int16_T *inCol = in + c;
+        real32_T *outCol = out + (size_t)c*nRows;
+        for (r = rowBegin; r < rowEnd; r++, inCol += inStep)
         {
-            out[r*numOutCols+c] = -FLT_MAX;
+            outCol[r] = castBM(*inCol, invalidValue);
         }
     }
-}
-
-inline void copyClipAndCastBMRM(int16_T* in, real32_T* out,
-	mwSize numValidRows, mwSize numValidCols,
-	mwSize numOutRows, mwSize numOutCols,
-	mwSize numInRows, int16_T invalidValue, mwSize borderWidth)
-{
-	mwSize r, c;
-	for (r = 0; r<numValidRows - borderWidth; r++)
-	{
-		for (c = 0; c<numValidCols; c++)
-		{
-			int16_T val = *in++;
-			int16_T fractionalPart = 0x000f & val;
-			if (val > invalidValue)
-			{
-				*out = (real32_T)((*in++) >> 4);
-				// Adding back the 4 bit fractional part, *0.0625 to shift it by 2^-4.
-				*out++ += (real32_T)(fractionalPart*0.0625);
-			}
-			else
-			{
-				*out++ = -FLT_MAX;
-			}
-		}
-
-		// Pad the right border
-		for (; c<numOutCols; c++)
-		{
-			*out++ = -FLT_MAX;
-		}
-	}
-
-	// Pad the bottom border
-	for (; r<numOutRows; r++)
-	{
-		for (c = 0; c<numOutCols; c++) {
-			*out++ = -FLT_MAX;
-		}
-	}
+    for (; c < nCols; c++)
+    {
+        real32_T *outCol = out + (size_t)c*nRows;
+        std::fill(outCol + rowBegin, outCol + rowEnd, -FLT_MAX);
+    }
 }
 
 #endif
@@ -21,6 +21,9 @@
 	int speckleWindowSize; 
 	int speckleRange;
 	int trySmallerWindows;
+	int useGPU;            /* match on a CUDA device when one is present */
+	int numStrips;         /* CPU strips matched in parallel; 0 for one per pool thread */
+	int coarseToFine;      /* restrict the search of each strip by a 1/4 size match */
 } cvstDBMStruct_T;
 
 #endif /*typedef_cvstDBMStruct_T: used by matlab coder*/
@@ -34,4 +37,15 @@
 	 real32_T* dis,
 	 cvstDBMStruct_T *params);
 
+ EXTERN_C LIBMWCVSTRT_API void disparityBM_construct(void **ptr2ptrClass);
+ EXTERN_C LIBMWCVSTRT_API void disparityBM_step(void *ptrClass,
+	 const uint8_T* inImg1, const uint8_T* inImg2, int nRows, int nCols,
+	 real32_T* dis,
+	 cvstDBMStruct_T *params);
+ EXTERN_C LIBMWCVSTRT_API void disparityBM_stepRM(void *ptrClass,
+	 const uint8_T* inImg1, const uint8_T* inImg2, int nRows, int nCols,
+	 real32_T* dis,
+	 cvstDBMStruct_T *params);
+ EXTERN_C LIBMWCVSTRT_API void disparityBM_deleteObj(void *ptrClass);
+
 #endif
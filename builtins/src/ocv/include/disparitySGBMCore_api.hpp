@@ -20,6 +20,11 @@
     int P1;
     int P2;
     bool fullDP;
+    int mode;              /* 0: SGBM, 1: HH (full 8-path DP), 2: SGBM_3WAY */
+    int useStrips;         /* process horizontal strips in parallel */
+    double memoryBudgetMB; /* cap on the matcher buffers, 0 for no cap */
+    int useGPU;            /* match on a CUDA device when one is present */
+    int coarseToFine;      /* restrict the search of each strip by a 1/4 size match */
  } cvstDSGBMStruct_T;
 
 
@@ -35,4 +40,21 @@
 	 real32_T* dis,
 	 cvstDSGBMStruct_T *params);
 
+ EXTERN_C LIBMWCVSTRT_API void disparitySGBM_construct(void **ptr2ptrClass);
+ EXTERN_C LIBMWCVSTRT_API void disparitySGBM_step(void *ptrClass,
+	 const uint8_T* inImg1, const uint8_T* inImg2, int nRows, int nCols,
+	 real32_T* dis,
+	 cvstDSGBMStruct_T *params);
+ EXTERN_C LIBMWCVSTRT_API void disparitySGBM_stepRM(void *ptrClass,
+	 const uint8_T* inImg1, const uint8_T* inImg2, int nRows, int nCols,
+	 real32_T* dis,
+	 cvstDSGBMStruct_T *params);
+ EXTERN_C LIBMWCVSTRT_API void disparitySGBM_deleteObj(void *ptrClass);
+
+ /* Bytes used by a stateful matcher for nRows-by-nCols frames: at the peak
+  * of a step and kept between steps. The memoryBudgetMB of params selects
+  * the strips, as in the step. */
+ EXTERN_C LIBMWCVSTRT_API void disparitySGBM_estimateMemory(int nRows, int nCols,
+	 cvstDSGBMStruct_T *params, double *peakBytes, double *steadyBytes);
+
 #endif
@@ -19,6 +19,67 @@ int32_T extractBRISK_computeRM(const uint8_T * img, const int32_T nRows, const i
                              int32_T * misc, const int32_T numKeyPoints, const boolean_T upright,
                              void ** features, void ** keypoints);
 
+// detection and extraction in one call, on one converted image
+EXTERN_C LIBMWCVSTRT_API
+int32_T extractBRISK_detectAndCompute(const uint8_T * img, const int32_T nRows, const int32_T nCols,
+                             const int32_T threshold, const int32_T numOctaves,
+                             const boolean_T upright,
+                             void ** features, void ** keypoints);
+
+EXTERN_C LIBMWCVSTRT_API
+int32_T extractBRISK_detectAndComputeRM(const uint8_T * img, const int32_T nRows, const int32_T nCols,
+                             const int32_T threshold, const int32_T numOctaves,
+                             const boolean_T upright,
+                             void ** features, void ** keypoints);
+
+// batch of grayscale images, detected and described in parallel; returns
+// the total number of features, outNumFeatures gets the number per image
+EXTERN_C LIBMWCVSTRT_API
+int32_T extractBRISK_detectAndComputeBatch(const uint8_T * const * images,
+                             const int32_T * nRows, const int32_T * nCols, const int32_T numImages,
+                             const int32_T threshold, const int32_T numOctaves,
+                             const boolean_T upright,
+                             int32_T * outNumFeatures, void ** batch);
+
+EXTERN_C LIBMWCVSTRT_API
+int32_T extractBRISK_detectAndComputeBatchRM(const uint8_T * const * images,
+                             const int32_T * nRows, const int32_T * nCols, const int32_T numImages,
+                             const int32_T threshold, const int32_T numOctaves,
+                             const boolean_T upright,
+                             int32_T * outNumFeatures, void ** batch);
+
+// features: numTotal-by-64, offsets: numImages+1; location may be NULL
+EXTERN_C LIBMWCVSTRT_API
+void extractBRISK_assignBatch(void *ptrBatch, real32_T * location,
+                              uint8_T * features, int32_T * offsets);
+
+EXTERN_C LIBMWCVSTRT_API
+void extractBRISK_assignBatchRM(void *ptrBatch, real32_T * location,
+                                uint8_T * features, int32_T * offsets);
+
+// persistent extractor, reused over the frames of a video
+EXTERN_C LIBMWCVSTRT_API
+void extractBRISK_construct(void **ptr2ptrClass);
+
+EXTERN_C LIBMWCVSTRT_API
+int32_T extractBRISK_computeObj(void *ptrClass,
+                             const uint8_T * img, const int32_T nRows, const int32_T nCols,
+                             real32_T * location, real32_T * metric,
+                             real32_T * scale, real32_T * orientation,
+                             int32_T * misc, const int32_T numKeyPoints, const boolean_T upright,
+                             void ** features, void ** keypoints);
+
+EXTERN_C LIBMWCVSTRT_API
+int32_T extractBRISK_computeObjRM(void *ptrClass,
+                             const uint8_T * img, const int32_T nRows, const int32_T nCols,
+                             real32_T * location, real32_T * metric,
+                             real32_T * scale, real32_T * orientation,
+                             int32_T * misc, const int32_T numKeyPoints, const boolean_T upright,
+                             void ** features, void ** keypoints);
+
+EXTERN_C LIBMWCVSTRT_API
+void extractBRISK_deleteObj(void *ptrClass);
+
 EXTERN_C LIBMWCVSTRT_API
 void extractBRISK_assignOutput(void *ptrDescriptors, void *ptrKeyPoints,
                                real32_T * location, real32_T * metric,
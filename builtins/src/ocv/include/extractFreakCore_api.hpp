@@ -17,11 +17,56 @@ EXTERN_C LIBMWCVSTRT_API int32_T extractFreak_computeRM(uint8_T *inImg,
 	int32_T numel, int32_T nbOctave, boolean_T orientationNormalized, boolean_T scaleNormalized, real32_T patternScale,
 	void **outKeypoints, void **outDescriptors);
 
+// persistent extractor, reused over the frames of a video
+EXTERN_C LIBMWCVSTRT_API void extractFreak_construct(void **ptr2ptrClass, int32_T nbOctave,
+	boolean_T orientationNormalized, boolean_T scaleNormalized, real32_T patternScale);
+
+EXTERN_C LIBMWCVSTRT_API int32_T extractFreak_computeObj(void *ptrClass, uint8_T *inImg,
+	int32_T nRows, int32_T nCols, int32_T nDims,
+	real32_T *inLoc, real32_T *inScale, real32_T *inMetric, int32_T *inMiscOrSignOfLap,
+	int32_T numel, void **outKeypoints, void **outDescriptors);
+
+EXTERN_C LIBMWCVSTRT_API int32_T extractFreak_computeObjRM(void *ptrClass, uint8_T *inImg,
+	int32_T nRows, int32_T nCols, int32_T nDims,
+	real32_T *inLoc, real32_T *inScale, real32_T *inMetric, int32_T *inMiscOrSignOfLap,
+	int32_T numel, void **outKeypoints, void **outDescriptors);
+
+EXTERN_C LIBMWCVSTRT_API void extractFreak_deleteObj(void *ptrClass);
+
 EXTERN_C LIBMWCVSTRT_API void extractFreak_assignOutput(void *ptrKeypoints, void *ptrDescriptors,
 	real32_T *outLoc, real32_T *outScale, real32_T *outMetric, int32_T *outMiscOrSignOfLap, real32_T *outOrientation, uint8_T *outFeatures);
 
 EXTERN_C LIBMWCVSTRT_API void extractFreak_assignOutputRM(void *ptrKeypoints, void *ptrDescriptors,
 	real32_T *outLoc, real32_T *outScale, real32_T *outMetric, int32_T *outMiscOrSignOfLap, real32_T *outOrientation, uint8_T *outFeatures);
 
+// single call: writes the capacity strongest valid features to the outputs,
+// outLoc being capacity x 2 and outFeatures capacity x 64, and returns the
+// number of valid features
+EXTERN_C LIBMWCVSTRT_API int32_T extractFreak_computeInto(uint8_T *inImg,
+	int32_T nRows, int32_T nCols, int32_T nDims,
+	real32_T *inLoc, real32_T *inScale, real32_T *inMetric, int32_T *inMiscOrSignOfLap,
+	int32_T numel, int32_T nbOctave, boolean_T orientationNormalized, boolean_T scaleNormalized, real32_T patternScale,
+	int32_T capacity,
+	real32_T *outLoc, real32_T *outScale, real32_T *outMetric, int32_T *outMiscOrSignOfLap, real32_T *outOrientation, uint8_T *outFeatures);
+
+EXTERN_C LIBMWCVSTRT_API int32_T extractFreak_computeIntoRM(uint8_T *inImg,
+	int32_T nRows, int32_T nCols, int32_T nDims,
+	real32_T *inLoc, real32_T *inScale, real32_T *inMetric, int32_T *inMiscOrSignOfLap,
+	int32_T numel, int32_T nbOctave, boolean_T orientationNormalized, boolean_T scaleNormalized, real32_T patternScale,
+	int32_T capacity,
+	real32_T *outLoc, real32_T *outScale, real32_T *outMetric, int32_T *outMiscOrSignOfLap, real32_T *outOrientation, uint8_T *outFeatures);
+
+EXTERN_C LIBMWCVSTRT_API int32_T extractFreak_computeObjInto(void *ptrClass, uint8_T *inImg,
+	int32_T nRows, int32_T nCols, int32_T nDims,
+	real32_T *inLoc, real32_T *inScale, real32_T *inMetric, int32_T *inMiscOrSignOfLap,
+	int32_T numel, int32_T capacity,
+	real32_T *outLoc, real32_T *outScale, real32_T *outMetric, int32_T *outMiscOrSignOfLap, real32_T *outOrientation, uint8_T *outFeatures);
+
+EXTERN_C LIBMWCVSTRT_API int32_T extractFreak_computeObjIntoRM(void *ptrClass, uint8_T *inImg,
+	int32_T nRows, int32_T nCols, int32_T nDims,
+	real32_T *inLoc, real32_T *inScale, real32_T *inMetric, int32_T *inMiscOrSignOfLap,
+	int32_T numel, int32_T capacity,
+	real32_T *outLoc, real32_T *outScale, real32_T *outMetric, int32_T *outMiscOrSignOfLap, real32_T *outOrientation, uint8_T *outFeatures);
+
 
 #endif
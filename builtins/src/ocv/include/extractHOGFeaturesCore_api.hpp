@@ -0,0 +1,41 @@
+/* Copyright 2016 The MathWorks, Inc. */
+
+#ifndef _EXTRACTHOGFEATURES_
+#define _EXTRACTHOGFEATURES_
+
+#include "vision_defines.h"
+
+/* HOG features of a batch of numImages images, each as extractHOGFeatures
+   computes them for the whole image, see HOGFeatureExtractor.hpp. images
+   is nRows-by-nCols-by-nChannels-by-numImages, nChannels 1 or 3.
+   cellSize, blockSize and blockOverlap are [rows cols]. outFeatures is
+   numImages-by-featureSize, see vision.internal.hog.getFeatureSize. */
+EXTERN_C LIBMWCVSTRT_API
+void extractHOGFeatures_uint8(const uint8_T * images, int32_T nRows,
+        int32_T nCols, int32_T nChannels, int32_T numImages,
+        const int32_T * cellSize, const int32_T * blockSize,
+        const int32_T * blockOverlap, int32_T numBins,
+        boolean_T useSignedOrientation, real32_T * outFeatures);
+
+EXTERN_C LIBMWCVSTRT_API
+void extractHOGFeatures_uint8RM(const uint8_T * images, int32_T nRows,
+        int32_T nCols, int32_T nChannels, int32_T numImages,
+        const int32_T * cellSize, const int32_T * blockSize,
+        const int32_T * blockOverlap, int32_T numBins,
+        boolean_T useSignedOrientation, real32_T * outFeatures);
+
+EXTERN_C LIBMWCVSTRT_API
+void extractHOGFeatures_single(const real32_T * images, int32_T nRows,
+        int32_T nCols, int32_T nChannels, int32_T numImages,
+        const int32_T * cellSize, const int32_T * blockSize,
+        const int32_T * blockOverlap, int32_T numBins,
+        boolean_T useSignedOrientation, real32_T * outFeatures);
+
+EXTERN_C LIBMWCVSTRT_API
+void extractHOGFeatures_singleRM(const real32_T * images, int32_T nRows,
+        int32_T nCols, int32_T nChannels, int32_T numImages,
+        const int32_T * cellSize, const int32_T * blockSize,
+        const int32_T * blockOverlap, int32_T numBins,
+        boolean_T useSignedOrientation, real32_T * outFeatures);
+
+#endif
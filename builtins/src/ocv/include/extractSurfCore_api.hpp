@@ -15,6 +15,29 @@ EXTERN_C LIBMWCVSTRT_API void extractSurf_assignOutputRM(void *ptrKeypoints,
 	real32_T *outLoc, real32_T *outScale, real32_T *outMetric,
 	int8_T *outSignOfLap, real32_T *outOrientation, real32_T *outFeatures);
 
+/* As extractSurf_assignOutput, with the descriptors converted to half
+   precision (the bits in uint16) or to int8 scaled by 127, see
+   mwcompactdescriptor.hpp */
+EXTERN_C LIBMWCVSTRT_API void extractSurf_assignOutputHalf(void *ptrKeypoints,
+	void *ptrDescriptors,
+	real32_T *outLoc, real32_T *outScale, real32_T *outMetric,
+	int8_T *outSignOfLap, real32_T *outOrientation, uint16_T *outFeatures);
+
+EXTERN_C LIBMWCVSTRT_API void extractSurf_assignOutputHalfRM(void *ptrKeypoints,
+	void *ptrDescriptors,
+	real32_T *outLoc, real32_T *outScale, real32_T *outMetric,
+	int8_T *outSignOfLap, real32_T *outOrientation, uint16_T *outFeatures);
+
+EXTERN_C LIBMWCVSTRT_API void extractSurf_assignOutputInt8(void *ptrKeypoints,
+	void *ptrDescriptors,
+	real32_T *outLoc, real32_T *outScale, real32_T *outMetric,
+	int8_T *outSignOfLap, real32_T *outOrientation, int8_T *outFeatures);
+
+EXTERN_C LIBMWCVSTRT_API void extractSurf_assignOutputInt8RM(void *ptrKeypoints,
+	void *ptrDescriptors,
+	real32_T *outLoc, real32_T *outScale, real32_T *outMetric,
+	int8_T *outSignOfLap, real32_T *outOrientation, int8_T *outFeatures);
+
 EXTERN_C LIBMWCVSTRT_API int32_T extractSurf_compute(uint8_T *inImg,
 	int32_T nRows, int32_T nCols, int32_T nDims, 
 	real32_T *inLoc, real32_T *inScale, real32_T *inMetric, int8_T *inSignOfLap,
@@ -27,4 +50,11 @@ EXTERN_C LIBMWCVSTRT_API int32_T extractSurf_computeRM(uint8_T *inImg,
 	int32_T numel, boolean_T isExtended, boolean_T isUpright,
 	void **outKeypoints, void **outDescriptors);
 
+// ptrIntegral: integral image of inImg from fastHessianDetector_uint8WithIntegral
+EXTERN_C LIBMWCVSTRT_API int32_T extractSurf_computeWithIntegral(void *ptrIntegral,
+	uint8_T *inImg, int32_T nRows, int32_T nCols, int32_T nDims,
+	real32_T *inLoc, real32_T *inScale, real32_T *inMetric, int8_T *inSignOfLap,
+	int32_T numel, boolean_T isExtended, boolean_T isUpright,
+	void **outKeypoints, void **outDescriptors);
+
 #endif
@@ -10,6 +10,43 @@ EXTERN_C LIBMWCVSTRT_API int32_T fastHessianDetector_uint8(uint8_T *inImg,
 	int32_T nOctaveLayers, int32_T nOctaves, int32_T hessianThreshold,
 	void **dptrKeypoints);
 
+// keeps the maxPerCell strongest keypoints of each cellSize x cellSize cell
+EXTERN_C LIBMWCVSTRT_API int32_T fastHessianDetector_uint8Bucketed(uint8_T *inImg,
+	int32_T nRows, int32_T nCols, int32_T nDims,
+	int32_T nOctaveLayers, int32_T nOctaves, int32_T hessianThreshold,
+	int32_T cellSize, int32_T maxPerCell,
+	void **dptrKeypoints);
+
+// also returns the integral image of inImg, for extractSurf_computeWithIntegral
+EXTERN_C LIBMWCVSTRT_API int32_T fastHessianDetector_uint8WithIntegral(uint8_T *inImg,
+	int32_T nRows, int32_T nCols, int32_T nDims,
+	int32_T nOctaveLayers, int32_T nOctaves, int32_T hessianThreshold,
+	void **dptrKeypoints, void **dptrIntegral);
+
+EXTERN_C LIBMWCVSTRT_API void fastHessianDetector_deleteIntegral(void *ptrIntegral);
+
+// detection and extraction on one integral image; outputs from extractSurf_assignOutput
+EXTERN_C LIBMWCVSTRT_API int32_T fastHessianDetector_detectAndExtract(uint8_T *inImg,
+	int32_T nRows, int32_T nCols, int32_T nDims,
+	int32_T nOctaveLayers, int32_T nOctaves, int32_T hessianThreshold,
+	boolean_T isExtended, boolean_T isUpright,
+	void **outKeypoints, void **outDescriptors);
+
+// batch of images, laid out as for fastHessianDetector_uint8, detected and
+// described in parallel; returns the total number of features
+EXTERN_C LIBMWCVSTRT_API int32_T fastHessianDetector_detectAndExtractBatch(
+	uint8_T * const *images, const int32_T *nRows, const int32_T *nCols, int32_T numImages,
+	int32_T nOctaveLayers, int32_T nOctaves, int32_T hessianThreshold,
+	boolean_T isExtended, boolean_T isUpright,
+	int32_T *outNumFeatures, void **outBatch);
+
+// features: numTotal-by-64 or 128, offsets: numImages+1; location may be NULL
+EXTERN_C LIBMWCVSTRT_API void fastHessianDetector_assignBatch(void *ptrBatch,
+	real32_T *outLoc, real32_T *outFeatures, int32_T *outOffsets);
+
+EXTERN_C LIBMWCVSTRT_API void fastHessianDetector_assignBatchRM(void *ptrBatch,
+	real32_T *outLoc, real32_T *outFeatures, int32_T *outOffsets);
+
 EXTERN_C LIBMWCVSTRT_API void fastHessianDetector_keyPoints2field(void *keypointsV,
 	real32_T *outLoc, real32_T *outScale, real32_T *outMetric, int8_T *outSignOfLap);
 
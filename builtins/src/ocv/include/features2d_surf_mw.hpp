@@ -92,6 +92,12 @@ public:
     // TMW Edit: 
     void detect( const Mat& image, vector<KeyPoint>& keypoints, const Mat& mask=Mat() ) const;
     void compute( const Mat& image, vector<KeyPoint>& keypoints, Mat& descriptors ) const;
+    //! detects the keypoints and computes their descriptors with one integral image
+    void detectAndCompute( const Mat& image, vector<KeyPoint>& keypoints, Mat& descriptors ) const;
+    //! detect that also returns the integral image of image, for computeWithIntegral
+    void detectWithIntegral( const Mat& image, vector<KeyPoint>& keypoints, Mat& sum ) const;
+    //! compute on the integral image returned by detectWithIntegral for the same image
+    void computeWithIntegral( const Mat& image, const Mat& sum, vector<KeyPoint>& keypoints, Mat& descriptors ) const;
     
     CV_PROP_RW double hessianThreshold;
     CV_PROP_RW int nOctaves;
@@ -103,6 +109,8 @@ protected:
 
     void detectImpl( const Mat& image, vector<KeyPoint>& keypoints, const Mat& mask=Mat() ) const;
     void computeImpl( const Mat& image, vector<KeyPoint>& keypoints, Mat& descriptors ) const;
+    void describe( const Mat& img, const Mat& sum, vector<KeyPoint>& keypoints,
+                   OutputArray descriptors ) const;
 };
 
 typedef MWSURF MWSurfFeatureDetector; // MK: should be SurfFeatureDetector
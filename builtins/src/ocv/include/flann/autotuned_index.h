@@ -30,6 +30,8 @@
 #ifndef OPENCV_MWFLANN_AUTOTUNED_INDEX_H_
 #define OPENCV_MWFLANN_AUTOTUNED_INDEX_H_
 
+#include <sstream>
+
 #include "general.h"
 #include "nn_index.h"
 #include "ground_truth.h"
@@ -102,7 +104,7 @@ public:
         bestParams_ = estimateBuildParams();
         Logger::info("----------------------------------------------------\n");
         Logger::info("Autotuned parameters:\n");
-        print_params(bestParams_);
+        log_params(bestParams_);
         Logger::info("----------------------------------------------------\n");
 
         bestIndex_ = create_index_by_type(dataset_, bestParams_, distance_);
@@ -110,7 +112,7 @@ public:
         speedup_ = estimateSearchParams(bestSearchParams_);
         Logger::info("----------------------------------------------------\n");
         Logger::info("Search parameters:\n");
-        print_params(bestSearchParams_);
+        log_params(bestSearchParams_);
         Logger::info("----------------------------------------------------\n");
     }
 
@@ -206,6 +208,19 @@ public:
 
 private:
 
+    /**
+     * Prints the parameters at the info level of the logger, not on
+     * std::cout as print_params does
+     */
+    static void log_params(const IndexParams& params)
+    {
+        for (IndexParams::const_iterator it = params.begin(); it != params.end(); ++it) {
+            std::ostringstream value;
+            value << it->second;
+            Logger::info("%s : %s\n", it->first.c_str(), value.str().c_str());
+        }
+    }
+
     struct CostData
     {
         float searchTimeCost;
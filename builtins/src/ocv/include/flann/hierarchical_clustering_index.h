@@ -47,6 +47,7 @@
 #include "allocator.h"
 #include "random.h"
 #include "saving.h"
+#include "cgThreadPool.hpp"
 
 
 namespace cvmwflann
@@ -87,7 +88,7 @@ public:
 private:
 
 
-    typedef void (HierarchicalClusteringIndex::* centersAlgFunction)(int, int*, int, int*, int&);
+    typedef void (HierarchicalClusteringIndex::* centersAlgFunction)(RandomGenerator&, int, int*, int, int*, int&);
 
     /**
      * The function used for choosing the cluster centers.
@@ -106,9 +107,9 @@ private:
      *     indices_length = length of indices vector
      *
      */
-    void chooseCentersRandom(int k, int* dsindices, int indices_length, int* centers, int& centers_length)
+    void chooseCentersRandom(RandomGenerator& rng, int k, int* dsindices, int indices_length, int* centers, int& centers_length)
     {
-        UniqueRandom r(indices_length);
+        UniqueRandom r(indices_length, rng);
 
         int index;
         for (index=0; index<k; ++index) {
@@ -147,11 +148,11 @@ private:
      *     indices = indices in the dataset
      * Returns:
      */
-    void chooseCentersGonzales(int k, int* dsindices, int indices_length, int* centers, int& centers_length)
+    void chooseCentersGonzales(RandomGenerator& rng, int k, int* dsindices, int indices_length, int* centers, int& centers_length)
     {
         int n = indices_length;
 
-        int rnd = rand_int(n);
+        int rnd = rng.randInt(n);
         assert(rnd >=0 && rnd < n);
 
         centers[0] = dsindices[rnd];
@@ -198,7 +199,7 @@ private:
      *     indices = indices in the dataset
      * Returns:
      */
-    void chooseCentersKMeanspp(int k, int* dsindices, int indices_length, int* centers, int& centers_length)
+    void chooseCentersKMeanspp(RandomGenerator& rng, int k, int* dsindices, int indices_length, int* centers, int& centers_length)
     {
         int n = indices_length;
 
@@ -206,7 +207,7 @@ private:
         DistanceType* closestDistSq = new DistanceType[n];
 
         // Choose one random center and set the closestDistSq values
-        int index = rand_int(n);
+        int index = rng.randInt(n);
         assert(index >=0 && index < n);
         centers[0] = dsindices[index];
 
@@ -229,7 +230,7 @@ private:
 
                 // Choose our center - have to be slightly careful to return a valid answer even accounting
                 // for possible rounding errors
-                double randVal = rand_double(currentPot);
+                double randVal = rng.randDouble(currentPot);
                 for (index = 0; index < n-1; index++) {
                     if (randVal <= closestDistSq[index]) break;
                     else randVal -= closestDistSq[index];
@@ -324,6 +325,8 @@ public:
         if (indices!=NULL) {
             delete[] indices;
         }
+
+        releaseBuildPools();
     }
 
 
@@ -366,7 +369,11 @@ public:
      */
     int usedMemory() const
     {
-        return pool.usedMemory+pool.wastedMemory+memoryCounter;
+        int memory = pool.usedMemory+pool.wastedMemory+memoryCounter;
+        for (size_t w = 0; w < build_pools_.size(); ++w) {
+            memory += build_pools_[w]->usedMemory+build_pools_[w]->wastedMemory;
+        }
+        return memory;
     }
 
     /**
@@ -380,14 +387,38 @@ public:
 
         free_elements();
 
+        const int numWorkers = std::max((int)cgGetNumThreads(), 1);
+        releaseBuildPools();
+        build_pools_.resize(numWorkers);
+        for (int w = 0; w < numWorkers; ++w) {
+            build_pools_[w] = new PooledAllocator();
+        }
+
+        /* The top of each tree, down to PARALLEL_LEVEL, with the points of
+           the large top nodes labelled in parallel. Each tree draws from
+           its own generator. */
+        std::vector<Subtree> subtrees;
         for (int i=0; i<trees_; ++i) {
             indices[i] = new int[size_];
             for (size_t j=0; j<size_; ++j) {
                 indices[i][j] = (int)j;
             }
+            RandomGenerator rng(RandomGenerator::drawSeed());
+            BuildContext ctx = {&pool, &rng};
             root[i] = pool.allocate<Node>();
-            computeClustering(root[i], indices[i], (int)size_, branching_,0);
+            computeClustering(ctx, root[i], indices[i], (int)size_, branching_, 0, &subtrees);
+        }
+
+        /* Then the subtrees below it, of all the trees, one per task */
+#ifdef PARALLEL
+        cgParallelForWorkers((int)subtrees.size(), [&](int w, int k) {
+            clusterSubtree(build_pools_[w], subtrees[k]);
+        });
+#else
+        for (size_t k = 0; k < subtrees.size(); ++k) {
+            clusterSubtree(build_pools_[0], subtrees[k]);
         }
+#endif
     }
 
 
@@ -529,6 +560,59 @@ private:
      */
     typedef BranchStruct<NodePtr, DistanceType> BranchSt;
 
+    /**
+     * State of a task of buildIndex: its allocator and its generator
+     */
+    struct BuildContext
+    {
+        PooledAllocator* pool;
+        RandomGenerator* rng;
+    };
+
+    /**
+     * Subtree left by the first pass of buildIndex: the points
+     * ind[0..count-1] of node, clustered with the generator seeded by seed.
+     */
+    struct Subtree
+    {
+        NodePtr node;
+        int* ind;
+        int count;
+        unsigned long long seed;
+    };
+
+    enum
+    {
+        /**
+         * Level of the subtrees that buildIndex clusters as tasks of their
+         * own, branching^PARALLEL_LEVEL per tree. It does not depend on the
+         * number of threads, so neither does the index.
+         */
+        PARALLEL_LEVEL = 1,
+        /**
+         * Points per block when the points of a node are labelled in parallel
+         */
+        LABEL_POINTS_PER_BLOCK = 4096
+    };
+
+    /**
+     * Task of buildIndex: a subtree below PARALLEL_LEVEL
+     */
+    void clusterSubtree(PooledAllocator* pool, const Subtree& task)
+    {
+        RandomGenerator rng(task.seed);
+        BuildContext ctx = {pool, &rng};
+        computeClustering(ctx, task.node, task.ind, task.count, branching_, PARALLEL_LEVEL, NULL);
+    }
+
+    void releaseBuildPools()
+    {
+        for (size_t w = 0; w < build_pools_.size(); ++w) {
+            delete build_pools_[w];
+        }
+        build_pools_.clear();
+    }
+
 
 
     void save_tree(FILE* stream, NodePtr node, int num)
@@ -584,6 +668,30 @@ private:
         }
     }
 
+    /**
+     * computeLabels on blocks of points in parallel. The cost is summed
+     * over the blocks, so it may differ in the last bits from that of
+     * computeLabels; the labels are the same.
+     */
+    void computeLabelsParallel(int* dsindices, int indices_length,  int* centers, int centers_length, int* labels, DistanceType& cost)
+    {
+#ifdef PARALLEL
+        const int numBlocks = (indices_length + LABEL_POINTS_PER_BLOCK - 1) / LABEL_POINTS_PER_BLOCK;
+        std::vector<DistanceType> costs(numBlocks);
+        cgParallelForWorkers(numBlocks, [&](int, int b) {
+            const int start = b * LABEL_POINTS_PER_BLOCK;
+            const int length = std::min((int)LABEL_POINTS_PER_BLOCK, indices_length - start);
+            computeLabels(dsindices + start, length, centers, centers_length, labels + start, costs[b]);
+        });
+        cost = 0;
+        for (int b = 0; b < numBlocks; ++b) {
+            cost += costs[b];
+        }
+#else
+        computeLabels(dsindices, indices_length, centers, centers_length, labels, cost);
+#endif
+    }
+
     /**
      * The method responsible with actually doing the recursive hierarchical
      * clustering
@@ -595,8 +703,17 @@ private:
      *
      * TODO: for 1-sized clusters don't store a cluster center (it's the same as the single cluster point)
      */
-    void computeClustering(NodePtr node, int* dsindices, int indices_length, int branching, int level)
+    void computeClustering(BuildContext& ctx, NodePtr node, int* dsindices, int indices_length, int branching, int level,
+                           std::vector<Subtree>* subtrees)
     {
+        /* Below PARALLEL_LEVEL, the subtree is left to a task of its own. */
+        if (subtrees != NULL && level == PARALLEL_LEVEL) {
+            Subtree subtree = {node, dsindices, indices_length,
+                               ((unsigned long long)ctx.rng->next() << 32) | ctx.rng->next()};
+            subtrees->push_back(subtree);
+            return;
+        }
+
         node->size = indices_length;
         node->level = level;
 
@@ -611,7 +728,7 @@ private:
         std::vector<int> labels(indices_length);
 
         int centers_length;
-        (this->*chooseCenters)(branching, dsindices, indices_length, &centers[0], centers_length);
+        (this->*chooseCenters)(*ctx.rng, branching, dsindices, indices_length, &centers[0], centers_length);
 
         if (centers_length<branching) {
             node->indices = dsindices;
@@ -623,9 +740,15 @@ private:
 
         //	assign points to clusters
         DistanceType cost;
-        computeLabels(dsindices, indices_length, &centers[0], centers_length, &labels[0], cost);
+        if (subtrees != NULL) {
+            // top of the tree, built before the parallel tasks
+            computeLabelsParallel(dsindices, indices_length, &centers[0], centers_length, &labels[0], cost);
+        }
+        else {
+            computeLabels(dsindices, indices_length, &centers[0], centers_length, &labels[0], cost);
+        }
 
-        node->childs = pool.allocate<NodePtr>(branching);
+        node->childs = ctx.pool->template allocate<NodePtr>(branching);
         int start = 0;
         int end = start;
         for (int i=0; i<branching; ++i) {
@@ -637,10 +760,10 @@ private:
                 }
             }
 
-            node->childs[i] = pool.allocate<Node>();
+            node->childs[i] = ctx.pool->template allocate<Node>();
             node->childs[i]->pivot = centers[i];
             node->childs[i]->indices = NULL;
-            computeClustering(node->childs[i],dsindices+start, end-start, branching, level+1);
+            computeClustering(ctx, node->childs[i],dsindices+start, end-start, branching, level+1, subtrees);
             start=end;
         }
     }
@@ -746,6 +869,11 @@ private:
      */
     PooledAllocator pool;
 
+    /**
+     * Allocators of the workers of buildIndex, one per worker
+     */
+    std::vector<PooledAllocator*> build_pools_;
+
     /**
      * Memory occupied by the index.
      */
@@ -45,6 +45,7 @@
 #include "allocator.h"
 #include "random.h"
 #include "saving.h"
+#include "cgThreadPool.hpp"
 
 
 namespace cvmwflann
@@ -96,9 +97,6 @@ public:
         for (size_t i = 0; i < size_; ++i) {
             vind_[i] = int(i);
         }
-
-        mean_ = new DistanceType[veclen_];
-        var_ = new DistanceType[veclen_];
     }
 
 
@@ -113,8 +111,7 @@ public:
         if (tree_roots_!=NULL) {
             delete[] tree_roots_;
         }
-        delete[] mean_;
-        delete[] var_;
+        releaseBuildPools();
     }
 
     /**
@@ -122,12 +119,49 @@ public:
      */
     void buildIndex()
     {
-        /* Construct the randomized trees. */
+        const int numWorkers = std::max((int)cgGetNumThreads(), 1);
+        releaseBuildPools();
+        build_pools_.resize(numWorkers);
+        for (int w = 0; w < numWorkers; ++w) {
+            build_pools_[w] = new PooledAllocator();
+        }
+        std::vector<std::vector<DistanceType> > buffers(numWorkers, std::vector<DistanceType>(2*veclen_));
+
+        /* Each tree partitions its own permutation of the vectors, drawn
+           from its own generator. */
+        std::vector<std::vector<int> > ind(trees_, vind_);
+        std::vector<RandomGenerator> rngs(trees_);
+        for (int i = 0; i < trees_; i++) {
+            rngs[i].init(RandomGenerator::drawSeed());
+        }
+
+        /* Construct the randomized trees down to PARALLEL_DEPTH, one tree
+           per task. */
+        std::vector<std::vector<Subtree> > subtrees(trees_);
+#ifdef PARALLEL
+        cgParallelForWorkers(trees_, [&](int w, int i) {
+            buildTreeTop(build_pools_[w], &buffers[w][0], rngs[i], ind[i], &tree_roots_[i], &subtrees[i]);
+        });
+#else
         for (int i = 0; i < trees_; i++) {
-            /* Randomize the order of vectors to allow for unbiased sampling. */
-            std::random_shuffle(vind_.begin(), vind_.end());
-            tree_roots_[i] = divideTree(&vind_[0], int(size_) );
+            buildTreeTop(build_pools_[0], &buffers[0][0], rngs[i], ind[i], &tree_roots_[i], &subtrees[i]);
         }
+#endif
+
+        /* Then the subtrees below it, of all the trees */
+        std::vector<Subtree> tasks;
+        for (int i = 0; i < trees_; i++) {
+            tasks.insert(tasks.end(), subtrees[i].begin(), subtrees[i].end());
+        }
+#ifdef PARALLEL
+        cgParallelForWorkers((int)tasks.size(), [&](int w, int k) {
+            buildSubtree(build_pools_[w], &buffers[w][0], tasks[k]);
+        });
+#else
+        for (size_t k = 0; k < tasks.size(); k++) {
+            buildSubtree(build_pools_[0], &buffers[0][0], tasks[k]);
+        }
+#endif
     }
 
 
@@ -184,7 +218,11 @@ public:
      */
     int usedMemory() const
     {
-        return int(pool_.usedMemory+pool_.wastedMemory+dataset_.rows*sizeof(int));  // pool memory and vind array memory
+        int memory = int(pool_.usedMemory+pool_.wastedMemory+dataset_.rows*sizeof(int));  // pool memory and vind array memory
+        for (size_t w = 0; w < build_pools_.size(); ++w) {
+            memory += build_pools_[w]->usedMemory+build_pools_[w]->wastedMemory;
+        }
+        return memory;
     }
 
     /**
@@ -237,6 +275,62 @@ private:
     typedef BranchStruct<NodePtr, DistanceType> BranchSt;
     typedef BranchSt* Branch;
 
+    /**
+     * State of a task of buildIndex: the allocator of its worker, its
+     * generator and the mean and variance buffers of its worker.
+     */
+    struct BuildContext
+    {
+        PooledAllocator* pool;
+        RandomGenerator* rng;
+        DistanceType* mean;
+        DistanceType* var;
+    };
+
+    /**
+     * Subtree left by the first pass of buildIndex: the vectors ind[0..count-1]
+     * go to *node, with the generator seeded by seed.
+     */
+    struct Subtree
+    {
+        NodePtr* node;
+        int* ind;
+        int count;
+        unsigned long long seed;
+    };
+
+    /**
+     * Task of the first pass of buildIndex: the top of a tree, down to
+     * PARALLEL_DEPTH, from its own permutation and generator. buffer holds
+     * 2*veclen_ values of the worker.
+     */
+    void buildTreeTop(PooledAllocator* pool, DistanceType* buffer, RandomGenerator& rng,
+                      std::vector<int>& ind, NodePtr* root, std::vector<Subtree>* subtrees)
+    {
+        /* Randomize the order of vectors to allow for unbiased sampling. */
+        std::random_shuffle(ind.begin(), ind.end(), rng);
+        BuildContext ctx = {pool, &rng, buffer, buffer + veclen_};
+        divideTree(ctx, root, &ind[0], int(size_), 0, subtrees);
+    }
+
+    /**
+     * Task of the second pass of buildIndex: a subtree below PARALLEL_DEPTH
+     */
+    void buildSubtree(PooledAllocator* pool, DistanceType* buffer, const Subtree& task)
+    {
+        RandomGenerator rng(task.seed);
+        BuildContext ctx = {pool, &rng, buffer, buffer + veclen_};
+        divideTree(ctx, task.node, task.ind, task.count, PARALLEL_DEPTH, NULL);
+    }
+
+    void releaseBuildPools()
+    {
+        for (size_t w = 0; w < build_pools_.size(); ++w) {
+            delete build_pools_[w];
+        }
+        build_pools_.clear();
+    }
+
 
 
     void save_tree(FILE* stream, NodePtr tree)
@@ -270,12 +364,24 @@ private:
      * Place a pointer to this new tree node in the location pTree.
      *
      * Params: pTree = the new node to create
-     *                  first = index of the first vector
-     *                  last = index of the last vector
+     *                  ind = indices of the vectors
+     *                  count = number of vectors
+     *                  depth = depth of the node
+     *                  subtrees = receives the subtrees at PARALLEL_DEPTH, or NULL
+     *                             to build the whole subtree
      */
-    NodePtr divideTree(int* ind, int count)
+    void divideTree(BuildContext& ctx, NodePtr* pTree, int* ind, int count, int depth, std::vector<Subtree>* subtrees)
     {
-        NodePtr node = pool_.allocate<Node>(); // allocate memory
+        /* Below PARALLEL_DEPTH, the subtree is left to a task of its own. */
+        if (subtrees != NULL && depth == PARALLEL_DEPTH && count > 1) {
+            Subtree subtree = {pTree, ind, count,
+                               ((unsigned long long)ctx.rng->next() << 32) | ctx.rng->next()};
+            subtrees->push_back(subtree);
+            return;
+        }
+
+        NodePtr node = ctx.pool->template allocate<Node>(); // allocate memory
+        *pTree = node;
 
         /* If too few exemplars remain, then make this a leaf node. */
         if ( count == 1) {
@@ -286,15 +392,13 @@ private:
             int idx;
             int cutfeat;
             DistanceType cutval;
-            meanSplit(ind, count, idx, cutfeat, cutval);
+            meanSplit(ctx, ind, count, idx, cutfeat, cutval);
 
             node->divfeat = cutfeat;
             node->divval = cutval;
-            node->child1 = divideTree(ind, idx);
-            node->child2 = divideTree(ind+idx, count-idx);
+            divideTree(ctx, &node->child1, ind, idx, depth+1, subtrees);
+            divideTree(ctx, &node->child2, ind+idx, count-idx, depth+1, subtrees);
         }
-
-        return node;
     }
 
 
@@ -303,8 +407,10 @@ private:
      * Make a random choice among those with the highest variance, and use
      * its variance as the threshold value.
      */
-    void meanSplit(int* ind, int count, int& index, int& cutfeat, DistanceType& cutval)
+    void meanSplit(BuildContext& ctx, int* ind, int count, int& index, int& cutfeat, DistanceType& cutval)
     {
+        DistanceType* mean_ = ctx.mean;
+        DistanceType* var_ = ctx.var;
         memset(mean_,0,veclen_*sizeof(DistanceType));
         memset(var_,0,veclen_*sizeof(DistanceType));
 
@@ -331,7 +437,7 @@ private:
             }
         }
         /* Select one of the highest variance indices at random. */
-        cutfeat = selectDivision(var_);
+        cutfeat = selectDivision(*ctx.rng, var_);
         cutval = mean_[cutfeat];
 
         int lim1, lim2;
@@ -352,7 +458,7 @@ private:
      * Select the top RAND_DIM largest values from v and return the index of
      * one of these selected at random.
      */
-    int selectDivision(DistanceType* v)
+    int selectDivision(RandomGenerator& rng, DistanceType* v)
     {
         int num = 0;
         size_t topind[RAND_DIM];
@@ -376,7 +482,7 @@ private:
             }
         }
         /* Select a random integer in range [0,num-1], and return that index. */
-        int rnd = rand_int(num);
+        int rnd = rng.randInt(num);
         return (int)topind[rnd];
     }
 
@@ -579,7 +685,13 @@ private:
          * selected at random from among the top RAND_DIM dimensions with the
          * highest variance.  A value of 5 works well.
          */
-        RAND_DIM=5
+        RAND_DIM=5,
+        /**
+         * Depth of the subtrees that buildIndex builds as tasks of their
+         * own, 2^PARALLEL_DEPTH per tree. It does not depend on the number
+         * of threads, so neither does the index.
+         */
+        PARALLEL_DEPTH=4
     };
 
 
@@ -604,9 +716,6 @@ private:
     size_t veclen_;
 
 
-    DistanceType* mean_;
-    DistanceType* var_;
-
 
     /**
      * Array of k-d trees used to find neighbours.
@@ -622,6 +731,11 @@ private:
      */
     PooledAllocator pool_;
 
+    /**
+     * Allocators of the workers of buildIndex, one per worker
+     */
+    std::vector<PooledAllocator*> build_pools_;
+
     Distance distance_;
 
 
@@ -344,6 +344,7 @@ public:
     void set_cb_index( float index)
     {
         cb_index_ = index;
+        index_params_["cb_index"] = index;
     }
 
     /**
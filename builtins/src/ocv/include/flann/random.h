@@ -32,6 +32,7 @@
 #define OPENCV_MWFLANN_RANDOM_H
 
 #include <algorithm>
+#include <cstddef>
 #include <cstdlib>
 #include <vector>
 
@@ -74,6 +75,78 @@ inline int rand_int(int high = RAND_MAX, int low = 0)
     return low + (int) ( double(high-low) * (std::rand() / (RAND_MAX + 1.0)));
 }
 
+/**
+ * Random number generator with its own state, for the index builds that
+ * run on several threads at once: std::rand() is shared by all threads and
+ * the order in which they draw from it would change the index. Each task
+ * of a build gets a generator seeded from std::rand() before the tasks
+ * start, so the index only depends on seed_random().
+ */
+class RandomGenerator
+{
+    unsigned long long state_;
+
+public:
+    explicit RandomGenerator(unsigned long long seed = 0)
+    {
+        init(seed);
+    }
+
+    void init(unsigned long long seed)
+    {
+        // xorshift needs a nonzero state
+        state_ = seed ^ 0x9E3779B97F4A7C15ULL;
+        if (state_ == 0) state_ = 0x9E3779B97F4A7C15ULL;
+    }
+
+    /**
+     * Returns 32 random bits (xorshift64*).
+     */
+    unsigned int next()
+    {
+        state_ ^= state_ >> 12;
+        state_ ^= state_ << 25;
+        state_ ^= state_ >> 27;
+        return (unsigned int)((state_ * 0x2545F4914F6CDD1DULL) >> 32);
+    }
+
+    /**
+     * Random value in [low, high), as rand_double
+     */
+    double randDouble(double high = 1.0, double low = 0)
+    {
+        return low + ((high-low) * (next() / 4294967296.0));
+    }
+
+    /**
+     * Random integer in [low, high), as rand_int
+     */
+    int randInt(int high, int low = 0)
+    {
+        return low + (int) ( double(high-low) * (next() / 4294967296.0));
+    }
+
+    /**
+     * Random index in [0, n), for std::random_shuffle
+     */
+    std::ptrdiff_t operator()(std::ptrdiff_t n)
+    {
+        return (std::ptrdiff_t)randInt((int)n);
+    }
+
+    /**
+     * Seed of a new generator, drawn from std::rand()
+     */
+    static unsigned long long drawSeed()
+    {
+        unsigned long long seed = 0;
+        for (int i = 0; i < 4; ++i) {
+            seed = (seed << 16) ^ (unsigned long long)std::rand();
+        }
+        return seed;
+    }
+};
+
 /**
  * Random number generator that returns a distinct number from
  * the [0,n) interval each time.
@@ -95,6 +168,18 @@ public:
         init(n);
     }
 
+    /**
+     * Constructor shuffling with the generator rng instead of std::rand()
+     */
+    UniqueRandom(int n, RandomGenerator& rng)
+    {
+        vals_.resize(n);
+        size_ = n;
+        for (int i = 0; i < size_; ++i) vals_[i] = i;
+        std::random_shuffle(vals_.begin(), vals_.end(), rng);
+        counter_ = 0;
+    }
+
     /**
      * Initializes the number generator.
      * @param n the size of the interval from which to generate random numbers.
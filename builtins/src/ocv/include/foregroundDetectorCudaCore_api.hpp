@@ -0,0 +1,38 @@
+/* Copyright 2016 The MathWorks, Inc. */
+
+#ifndef _FOREGROUNDDETECTORCUDA_
+#define _FOREGROUNDDETECTORCUDA_
+
+#include "vision_defines.h"
+
+#ifndef typedef_cvstFGDCudaStruct_T
+#define typedef_cvstFGDCudaStruct_T
+
+typedef struct {
+	int numGaussians;
+	double initialVariance; /* in squared uint8 intensity units */
+	double minBGRatio;
+} cvstFGDCudaStruct_T;
+
+#endif /*typedef_cvstFGDCudaStruct_T: used by matlab coder*/
+
+/* Gaussian mixture foreground detector running on a CUDA device, for uint8
+ * images of 1 or 3 channels. device is the index of the CUDA device.
+ * construct sets *ptr2ptrClass to NULL when the device is not available or
+ * OpenCV was built without CUDA background segmentation; the caller then
+ * uses the CPU foregroundDetector. */
+EXTERN_C LIBMWCVSTRT_API boolean_T foregroundDetectorCuda_isAvailable(int32_T device);
+EXTERN_C LIBMWCVSTRT_API void foregroundDetectorCuda_construct(void **ptr2ptrClass, int32_T device);
+EXTERN_C LIBMWCVSTRT_API void foregroundDetectorCuda_initialize(void *ptrClass,
+	int32_T nRows, int32_T nCols, int32_T nChannels,
+	cvstFGDCudaStruct_T *params);
+/* mask has one element per pixel, 1 for foreground, in the layout of the
+ * image. learningRate has the meaning of foregroundDetector's. */
+EXTERN_C LIBMWCVSTRT_API void foregroundDetectorCuda_step(void *ptrClass,
+	const uint8_T *inImg, boolean_T *mask, float learningRate);
+EXTERN_C LIBMWCVSTRT_API void foregroundDetectorCuda_stepRM(void *ptrClass,
+	const uint8_T *inImg, boolean_T *mask, float learningRate);
+EXTERN_C LIBMWCVSTRT_API void foregroundDetectorCuda_reset(void *ptrClass);
+EXTERN_C LIBMWCVSTRT_API void foregroundDetectorCuda_deleteObj(void *ptrClass);
+
+#endif
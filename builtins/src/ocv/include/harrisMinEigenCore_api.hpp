@@ -0,0 +1,28 @@
+/* Copyright 2016 The MathWorks, Inc. */
+
+#ifndef _HARRISMINEIGEN_
+#define _HARRISMINEIGEN_
+
+#include "vision_defines.h"
+
+/* Corners of detectHarrisFeatures (method 0) and detectMinEigenFeatures
+   (method 1), see HarrisMinEigen.hpp. inImg is the nRows-by-nCols single
+   image, cropped to the expanded ROI. Returns the number of corners. */
+EXTERN_C LIBMWCVSTRT_API int32_T harrisMinEigen_compute(const real32_T *inImg,
+	int32_T nRows, int32_T nCols, int32_T method,
+	int32_T filterSize, real32_T minQuality,
+	void **ptrCorners);
+
+EXTERN_C LIBMWCVSTRT_API int32_T harrisMinEigen_computeRM(const real32_T *inImg,
+	int32_T nRows, int32_T nCols, int32_T method,
+	int32_T filterSize, real32_T minQuality,
+	void **ptrCorners);
+
+/* outLoc is numCorners-by-2 [x y], outMetric numCorners-by-1 */
+EXTERN_C LIBMWCVSTRT_API void harrisMinEigen_assignOutputDelete(void *ptrCorners,
+	real32_T *outLoc, real32_T *outMetric);
+
+EXTERN_C LIBMWCVSTRT_API void harrisMinEigen_assignOutputDeleteRM(void *ptrCorners,
+	real32_T *outLoc, real32_T *outMetric);
+
+#endif
@@ -0,0 +1,75 @@
+/* Copyright 2016 The MathWorks, Inc. */
+
+#ifndef _ICPREGISTRATION_
+#define _ICPREGISTRATION_
+
+#include "vision_defines.h"
+
+/* Rigid registration of point clouds with ICP, see RigidIcp.hpp.
+   setFixed keeps the fixed cloud, downsampled at each of the numLevels
+   gridSteps, coarse to fine, 0 for the full cloud, with a kd-tree per
+   level; register then registers moving clouds to it. location and normal
+   are numPoints-by-3, column major; normal is only read when hasNormal,
+   and is computed otherwise for the point to plane metric. tolerance is
+   [translation rotation], rotation in radians. initialTform and tform are
+   the 4-by-4 matrices of affine3d. Both return 0, -1 when there are fewer
+   than 3 points or inliers, or -2 when the transformation could not be
+   estimated. */
+
+EXTERN_C LIBMWCVSTRT_API
+void icpRegistration_construct(void **ptr2ptrIcp);
+
+EXTERN_C LIBMWCVSTRT_API
+int32_T icpRegistration_setFixed(void *ptrIcp, const double * location,
+        const double * normal, int32_T numPoints, boolean_T hasNormal,
+        const double * gridSteps, int32_T numLevels, boolean_T isPointToPlane);
+
+EXTERN_C LIBMWCVSTRT_API
+int32_T icpRegistration_setFixedRM(void *ptrIcp, const double * location,
+        const double * normal, int32_T numPoints, boolean_T hasNormal,
+        const double * gridSteps, int32_T numLevels, boolean_T isPointToPlane);
+
+EXTERN_C LIBMWCVSTRT_API
+int32_T icpRegistration_register(void *ptrIcp, const double * location,
+        int32_T numPoints, double inlierRatio, int32_T maxIterations,
+        const double * tolerance, const double * initialTform, double * tform,
+        double * rmse, int32_T * numIterations);
+
+EXTERN_C LIBMWCVSTRT_API
+int32_T icpRegistration_registerRM(void *ptrIcp, const double * location,
+        int32_T numPoints, double inlierRatio, int32_T maxIterations,
+        const double * tolerance, const double * initialTform, double * tform,
+        double * rmse, int32_T * numIterations);
+
+EXTERN_C LIBMWCVSTRT_API
+void icpRegistration_deleteObj(void *ptrIcp);
+
+EXTERN_C LIBMWCVSTRT_API
+void icpRegistration_construct_single(void **ptr2ptrIcp);
+
+EXTERN_C LIBMWCVSTRT_API
+int32_T icpRegistration_setFixed_single(void *ptrIcp, const float * location,
+        const float * normal, int32_T numPoints, boolean_T hasNormal,
+        const double * gridSteps, int32_T numLevels, boolean_T isPointToPlane);
+
+EXTERN_C LIBMWCVSTRT_API
+int32_T icpRegistration_setFixed_singleRM(void *ptrIcp, const float * location,
+        const float * normal, int32_T numPoints, boolean_T hasNormal,
+        const double * gridSteps, int32_T numLevels, boolean_T isPointToPlane);
+
+EXTERN_C LIBMWCVSTRT_API
+int32_T icpRegistration_register_single(void *ptrIcp, const float * location,
+        int32_T numPoints, double inlierRatio, int32_T maxIterations,
+        const double * tolerance, const double * initialTform, double * tform,
+        double * rmse, int32_T * numIterations);
+
+EXTERN_C LIBMWCVSTRT_API
+int32_T icpRegistration_register_singleRM(void *ptrIcp, const float * location,
+        int32_T numPoints, double inlierRatio, int32_T maxIterations,
+        const double * tolerance, const double * initialTform, double * tform,
+        double * rmse, int32_T * numIterations);
+
+EXTERN_C LIBMWCVSTRT_API
+void icpRegistration_deleteObj_single(void *ptrIcp);
+
+#endif
@@ -0,0 +1,24 @@
+/* Copyright 2016 The MathWorks, Inc. */
+
+#ifndef _IMAGEHANDLE_
+#define _IMAGEHANDLE_
+
+#include "vision_defines.h"
+
+/* uint8 image of 1 or 3 channels shared by the cores of a pipeline. device
+ * is the index of the CUDA device that keeps the device copies of the image,
+ * or -1 for a host only image; without that device the image is host only.
+ * The cores that take an image handle read it on their device when it is
+ * the device of the handle, so a frame fed to several cores is uploaded and
+ * converted once. The layout of the image is given to setImage and applies
+ * to the outputs of the cores that read it. */
+EXTERN_C LIBMWCVSTRT_API void imageHandle_construct(void **ptr2ptrImage, int32_T device);
+EXTERN_C LIBMWCVSTRT_API boolean_T imageHandle_isOnDevice(void *ptrImage);
+EXTERN_C LIBMWCVSTRT_API void imageHandle_setImage(void *ptrImage, const uint8_T *inImg,
+	int32_T nRows, int32_T nCols, int32_T nChannels);
+EXTERN_C LIBMWCVSTRT_API void imageHandle_setImageRM(void *ptrImage, const uint8_T *inImg,
+	int32_T nRows, int32_T nCols, int32_T nChannels);
+EXTERN_C LIBMWCVSTRT_API void imageHandle_getImage(void *ptrImage, uint8_T *outImg);
+EXTERN_C LIBMWCVSTRT_API void imageHandle_deleteObj(void *ptrImage);
+
+#endif
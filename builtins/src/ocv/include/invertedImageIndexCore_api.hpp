@@ -0,0 +1,54 @@
+/* Copyright 2016 The MathWorks, Inc. */
+
+#ifndef _INVERTEDIMAGEINDEX_
+#define _INVERTEDIMAGEINDEX_
+
+#include "vision_defines.h"
+
+/* Compressed inverted file of the word histograms of invertedImageIndex,
+   see InvertedFile.hpp. Images and words are 1-based.
+   addImages appends numImages histograms given as the numEntries
+   (image, word, count) of a sparse numImages-by-numWords matrix, image
+   relative to the first added image. removeImages removes images by index;
+   the following images move down. search scores the images against the
+   query histogram, numQueryWords (word, count) pairs, using the words whose
+   frequency is within freqRange = [lower upper]. It writes at most
+   numResults images and scores, best first, and returns their number. */
+
+EXTERN_C LIBMWCVSTRT_API
+void invertedImageIndex_construct(int32_T numWords, void **ptr2ptrIndex);
+
+EXTERN_C LIBMWCVSTRT_API
+void invertedImageIndex_addImages(void *ptrIndex, const uint32_T * image,
+        const uint32_T * word, const double * count, int32_T numEntries,
+        int32_T numImages);
+
+EXTERN_C LIBMWCVSTRT_API
+void invertedImageIndex_removeImages(void *ptrIndex, const double * indices,
+        int32_T numIndices);
+
+EXTERN_C LIBMWCVSTRT_API
+int32_T invertedImageIndex_search(void *ptrIndex, const uint32_T * queryWords,
+        const double * queryCounts, int32_T numQueryWords,
+        const double * freqRange, double matchThreshold, int32_T numResults,
+        uint32_T * imageIDs, double * scores);
+
+EXTERN_C LIBMWCVSTRT_API
+int32_T invertedImageIndex_getNumImages(void *ptrIndex);
+
+/* Fraction of the images that contain each word, numWords-by-1 */
+EXTERN_C LIBMWCVSTRT_API
+void invertedImageIndex_getWordFrequency(void *ptrIndex, double * frequency);
+
+/* save writes the index to a single file; load maps it read-only. load
+   fails when the file was saved with another number of words. */
+EXTERN_C LIBMWCVSTRT_API
+boolean_T invertedImageIndex_save(void *ptrIndex, const char * filename);
+
+EXTERN_C LIBMWCVSTRT_API
+boolean_T invertedImageIndex_load(void *ptrIndex, const char * filename);
+
+EXTERN_C LIBMWCVSTRT_API
+void invertedImageIndex_deleteObj(void *ptrIndex);
+
+#endif
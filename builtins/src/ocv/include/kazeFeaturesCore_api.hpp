@@ -0,0 +1,104 @@
+/* Copyright 2016 The MathWorks, Inc. */
+
+#ifndef _KAZEFEATURES_
+#define _KAZEFEATURES_
+
+#include "vision_defines.h"
+
+/* KAZE keypoints of the nRows-by-nCols uint8 image, column major, see
+   KazeFeatures.hpp. diffusivity is the code of
+   convertKAZEDiffusionToOCVCode. The keypoints are freed by
+   kazeFeatures_assignOutputDeleteKeypoints. Returns their number. */
+EXTERN_C LIBMWCVSTRT_API
+int32_T kazeFeatures_detect(const uint8_T * inImg,
+        int32_T nRows, int32_T nCols, real32_T threshold,
+        int32_T numOctaves, int32_T numScaleLevels, int32_T diffusivity,
+        void ** ptr2ptrKeypoints);
+
+/* Keypoints as ocvDetectKAZE returns them: outLoc is N-by-2 [x y],
+   1-based, outScale the diameter, outOrientation the angle of OpenCV in
+   radians, and outLayerID the 0-based level. */
+EXTERN_C LIBMWCVSTRT_API
+void kazeFeatures_assignOutputDeleteKeypoints(void * ptrKeypoints,
+        real32_T * outLoc, real32_T * outScale, real32_T * outMetric,
+        real32_T * outOrientation, int32_T * outLayerID);
+
+EXTERN_C LIBMWCVSTRT_API
+void kazeFeatures_assignOutputDeleteKeypointsRM(void * ptrKeypoints,
+        real32_T * outLoc, real32_T * outScale, real32_T * outMetric,
+        real32_T * outOrientation, int32_T * outLayerID);
+
+/* Descriptors of the numPoints points of the image, as ocvExtractKAZE. The
+   points are in the layout of its outputs; a layer ID outside the scale
+   space is replaced by the level closest to the scale. The points and
+   descriptors are freed by kazeFeatures_assignExtractOutputDelete.
+   Returns the number of points. */
+EXTERN_C LIBMWCVSTRT_API
+int32_T kazeFeatures_extract(const uint8_T * inImg,
+        int32_T nRows, int32_T nCols,
+        const real32_T * inLoc, const real32_T * inScale,
+        const real32_T * inMetric, const int32_T * inLayerID, int32_T numPoints,
+        boolean_T isExtended, boolean_T isUpright,
+        int32_T numOctaves, int32_T numScaleLevels, int32_T diffusivity,
+        void ** ptr2ptrKeypoints, void ** ptr2ptrDescriptors);
+
+EXTERN_C LIBMWCVSTRT_API
+int32_T kazeFeatures_extractRM(const uint8_T * inImg,
+        int32_T nRows, int32_T nCols,
+        const real32_T * inLoc, const real32_T * inScale,
+        const real32_T * inMetric, const int32_T * inLayerID, int32_T numPoints,
+        boolean_T isExtended, boolean_T isUpright,
+        int32_T numOctaves, int32_T numScaleLevels, int32_T diffusivity,
+        void ** ptr2ptrKeypoints, void ** ptr2ptrDescriptors);
+
+/* Detection and extraction on one scale space; the outputs are those of
+   kazeFeatures_assignExtractOutputDelete */
+EXTERN_C LIBMWCVSTRT_API
+int32_T kazeFeatures_detectAndExtract(const uint8_T * inImg,
+        int32_T nRows, int32_T nCols, real32_T threshold,
+        boolean_T isExtended, boolean_T isUpright,
+        int32_T numOctaves, int32_T numScaleLevels, int32_T diffusivity,
+        void ** ptr2ptrKeypoints, void ** ptr2ptrDescriptors);
+
+/* Points as kazeFeatures_assignOutputDeleteKeypoints and outFeatures,
+   N-by-64 or N-by-128 */
+EXTERN_C LIBMWCVSTRT_API
+void kazeFeatures_assignExtractOutputDelete(void * ptrKeypoints,
+        void * ptrDescriptors,
+        real32_T * outLoc, real32_T * outScale, real32_T * outMetric,
+        real32_T * outOrientation, int32_T * outLayerID, real32_T * outFeatures);
+
+EXTERN_C LIBMWCVSTRT_API
+void kazeFeatures_assignExtractOutputDeleteRM(void * ptrKeypoints,
+        void * ptrDescriptors,
+        real32_T * outLoc, real32_T * outScale, real32_T * outMetric,
+        real32_T * outOrientation, int32_T * outLayerID, real32_T * outFeatures);
+
+/* As kazeFeatures_assignExtractOutputDelete, with the features converted
+   to half precision (the bits in uint16) or to int8 scaled by 127, see
+   mwcompactdescriptor.hpp */
+EXTERN_C LIBMWCVSTRT_API
+void kazeFeatures_assignExtractOutputDeleteHalf(void * ptrKeypoints,
+        void * ptrDescriptors,
+        real32_T * outLoc, real32_T * outScale, real32_T * outMetric,
+        real32_T * outOrientation, int32_T * outLayerID, uint16_T * outFeatures);
+
+EXTERN_C LIBMWCVSTRT_API
+void kazeFeatures_assignExtractOutputDeleteHalfRM(void * ptrKeypoints,
+        void * ptrDescriptors,
+        real32_T * outLoc, real32_T * outScale, real32_T * outMetric,
+        real32_T * outOrientation, int32_T * outLayerID, uint16_T * outFeatures);
+
+EXTERN_C LIBMWCVSTRT_API
+void kazeFeatures_assignExtractOutputDeleteInt8(void * ptrKeypoints,
+        void * ptrDescriptors,
+        real32_T * outLoc, real32_T * outScale, real32_T * outMetric,
+        real32_T * outOrientation, int32_T * outLayerID, int8_T * outFeatures);
+
+EXTERN_C LIBMWCVSTRT_API
+void kazeFeatures_assignExtractOutputDeleteInt8RM(void * ptrKeypoints,
+        void * ptrDescriptors,
+        real32_T * outLoc, real32_T * outScale, real32_T * outMetric,
+        real32_T * outOrientation, int32_T * outLayerID, int8_T * outFeatures);
+
+#endif
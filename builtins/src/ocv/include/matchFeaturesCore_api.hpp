@@ -19,5 +19,182 @@ void findApproximateNearestNeighbors_uint8(const uint8_T * features1,
         const int32_T numelInFeatureVec, const int32_T knn, 
         int32_T * indexPairs, int32_T * dist);
 
+EXTERN_C LIBMWCVSTRT_API
+void findApproximateNearestNeighborsLsh_uint8(const uint8_T * features1,
+        const uint8_T * features2, const int32_T numFeatures1,
+        const int32_T numFeatures2, const int32_T numelInFeatureVec,
+        const int32_T knn, const int32_T tableNumber, const int32_T keySize,
+        const int32_T multiProbeLevel, int32_T * indexPairs, int32_T * dist);
+
+EXTERN_C LIBMWCVSTRT_API
+void findExactNearestNeighbors_uint8(const uint8_T * features1,
+        const uint8_T * features2, const int32_T numFeatures1,
+        const int32_T numFeatures2, const int32_T numelInFeatureVec,
+        const int32_T knn, int32_T * indexPairs, int32_T * dist);
+
+/* Exhaustive SSD search of SURF and KAZE features in half precision (the
+   bits in uint16) or in int8 scaled by 127, see mwcompactdescriptor.hpp */
+EXTERN_C LIBMWCVSTRT_API
+void findExactNearestNeighbors_half(const uint16_T * features1,
+        const uint16_T * features2, const int32_T numFeatures1,
+        const int32_T numFeatures2, const int32_T numelInFeatureVec,
+        const int32_T knn, int32_T * indexPairs, real32_T * dist);
+
+EXTERN_C LIBMWCVSTRT_API
+void findExactNearestNeighbors_int8(const int8_T * features1,
+        const int8_T * features2, const int32_T numFeatures1,
+        const int32_T numFeatures2, const int32_T numelInFeatureVec,
+        const int32_T knn, int32_T * indexPairs, real32_T * dist);
+
+/* Persistent index over features2: construct, build, query and delete */
+EXTERN_C LIBMWCVSTRT_API
+void matchFeaturesIndex_construct(void **ptr2ptrIndex);
+
+EXTERN_C LIBMWCVSTRT_API
+void matchFeaturesIndex_build_real32(void *ptrIndex, const real32_T * features2,
+        const char * metric, const int32_T numFeatures2,
+        const int32_T numelInFeatureVec);
+
+EXTERN_C LIBMWCVSTRT_API
+void matchFeaturesIndex_build_uint8(void *ptrIndex, const uint8_T * features2,
+        const char * metric, const int32_T numFeatures2,
+        const int32_T numelInFeatureVec);
+
+EXTERN_C LIBMWCVSTRT_API
+void matchFeaturesIndex_buildLsh_uint8(void *ptrIndex, const uint8_T * features2,
+        const int32_T numFeatures2, const int32_T numelInFeatureVec,
+        const int32_T tableNumber, const int32_T keySize,
+        const int32_T multiProbeLevel);
+
+/* Autotuning of the index of real features: the algorithm and parameters
+ * that reach targetPrecision on a sampleFraction of the features are chosen
+ * on the next build. The chosen configuration, 7 values (algorithm, trees,
+ * branching, iterations, centers_init, cb_index, checks), is saved with the
+ * index and can be set on another index to skip the tuning. getTunedConfig
+ * returns false when the index was not tuned. */
+EXTERN_C LIBMWCVSTRT_API
+void matchFeaturesIndex_setAutotuneParams(void *ptrIndex,
+        const real32_T targetPrecision, const real32_T buildWeight,
+        const real32_T memoryWeight, const real32_T sampleFraction);
+
+EXTERN_C LIBMWCVSTRT_API
+boolean_T matchFeaturesIndex_getTunedConfig(void *ptrIndex, real_T * config);
+
+EXTERN_C LIBMWCVSTRT_API
+void matchFeaturesIndex_setTunedConfig(void *ptrIndex, const real_T * config);
+
+EXTERN_C LIBMWCVSTRT_API
+void matchFeaturesIndex_addPoints_real32(void *ptrIndex, const real32_T * features,
+        const int32_T numFeatures, const int32_T numelInFeatureVec);
+
+EXTERN_C LIBMWCVSTRT_API
+void matchFeaturesIndex_addPoints_uint8(void *ptrIndex, const uint8_T * features,
+        const int32_T numFeatures, const int32_T numelInFeatureVec);
+
+EXTERN_C LIBMWCVSTRT_API
+void matchFeaturesIndex_search_real32(void *ptrIndex, const real32_T * features1,
+        const int32_T numFeatures1, const int32_T knn,
+        int32_T * indexPairs, real32_T * dist);
+
+EXTERN_C LIBMWCVSTRT_API
+void matchFeaturesIndex_search_uint8(void *ptrIndex, const uint8_T * features1,
+        const int32_T numFeatures1, const int32_T knn,
+        int32_T * indexPairs, int32_T * dist);
+
+EXTERN_C LIBMWCVSTRT_API
+void matchFeaturesIndex_searchBatch_real32(void *ptrIndex, const real32_T * features1,
+        const int32_T numFeatures1, const int32_T knn,
+        const int32_T checks, const real32_T eps,
+        int32_T * indexPairs, real32_T * dist);
+
+EXTERN_C LIBMWCVSTRT_API
+void matchFeaturesIndex_searchBatch_uint8(void *ptrIndex, const uint8_T * features1,
+        const int32_T numFeatures1, const int32_T knn,
+        const int32_T checks, const real32_T eps,
+        int32_T * indexPairs, int32_T * dist);
+
+EXTERN_C LIBMWCVSTRT_API
+boolean_T matchFeaturesIndex_save(void *ptrIndex, const char * filename);
+
+EXTERN_C LIBMWCVSTRT_API
+boolean_T matchFeaturesIndex_load(void *ptrIndex, const char * filename);
+
+EXTERN_C LIBMWCVSTRT_API
+int32_T matchFeaturesIndex_getNumFeatures(void *ptrIndex);
+
+EXTERN_C LIBMWCVSTRT_API
+void matchFeaturesIndex_deleteObj(void *ptrIndex);
+
+/* Product-quantized index of real features, see ProductQuantizer.hpp:
+ * numSubspaces bytes per feature, and numLists coarse centers, 0 for a
+ * flat index. train learns the centers and codebooks from the training
+ * features and empties the index; it returns 0, -1 when there are fewer
+ * valid features than centers or 256 centroids, or -2 for an invalid
+ * numSubspaces. search visits the lists of the numProbes closest centers;
+ * the distances approximate 'ssd' and missing neighbors have index -1. */
+EXTERN_C LIBMWCVSTRT_API
+void matchFeaturesPQIndex_construct(void **ptr2ptrIndex,
+        const int32_T numSubspaces, const int32_T numLists);
+
+EXTERN_C LIBMWCVSTRT_API
+int32_T matchFeaturesPQIndex_train_real32(void *ptrIndex, const real32_T * features,
+        const int32_T numFeatures, const int32_T numelInFeatureVec,
+        const uint32_T seed);
+
+EXTERN_C LIBMWCVSTRT_API
+void matchFeaturesPQIndex_addPoints_real32(void *ptrIndex, const real32_T * features,
+        const int32_T numFeatures);
+
+EXTERN_C LIBMWCVSTRT_API
+void matchFeaturesPQIndex_search_real32(void *ptrIndex, const real32_T * features1,
+        const int32_T numFeatures1, const int32_T knn, const int32_T numProbes,
+        int32_T * indexPairs, real32_T * dist);
+
+EXTERN_C LIBMWCVSTRT_API
+boolean_T matchFeaturesPQIndex_save(void *ptrIndex, const char * filename);
+
+EXTERN_C LIBMWCVSTRT_API
+boolean_T matchFeaturesPQIndex_load(void *ptrIndex, const char * filename);
+
+EXTERN_C LIBMWCVSTRT_API
+int32_T matchFeaturesPQIndex_getNumFeatures(void *ptrIndex);
+
+EXTERN_C LIBMWCVSTRT_API
+void matchFeaturesPQIndex_deleteObj(void *ptrIndex);
+
+/* Exhaustive matching on a CUDA device: set features2 once, then match
+ * many features1 against it. device is the index of the CUDA device;
+ * construct sets *ptr2ptrMatcher to NULL when the device is not available
+ * or OpenCV was built without CUDA features2d, and the caller then uses the
+ * CPU path. match returns the number of matches and writes their 0-based
+ * indices and metric to outputs of numFeatures1 elements. */
+EXTERN_C LIBMWCVSTRT_API
+void matchFeaturesCuda_construct(void **ptr2ptrMatcher, const int32_T device);
+
+EXTERN_C LIBMWCVSTRT_API
+void matchFeaturesCuda_setFeatures2_real32(void *ptrMatcher, const real32_T * features2,
+        const char * metric, const int32_T numFeatures2,
+        const int32_T numelInFeatureVec);
+
+EXTERN_C LIBMWCVSTRT_API
+void matchFeaturesCuda_setFeatures2_uint8(void *ptrMatcher, const uint8_T * features2,
+        const int32_T numFeatures2, const int32_T numelInFeatureVec);
+
+EXTERN_C LIBMWCVSTRT_API
+int32_T matchFeaturesCuda_match_real32(void *ptrMatcher, const real32_T * features1,
+        const int32_T numFeatures1, const int32_T numelInFeatureVec,
+        const real32_T matchThreshold, const real32_T maxRatio,
+        const boolean_T uniqueMatches,
+        int32_T * queryIdx, int32_T * trainIdx, real32_T * matchMetric);
+
+EXTERN_C LIBMWCVSTRT_API
+int32_T matchFeaturesCuda_match_uint8(void *ptrMatcher, const uint8_T * features1,
+        const int32_T numFeatures1, const int32_T numelInFeatureVec,
+        const real32_T matchThreshold, const real32_T maxRatio,
+        const boolean_T uniqueMatches,
+        int32_T * queryIdx, int32_T * trainIdx, real32_T * matchMetric);
+
+EXTERN_C LIBMWCVSTRT_API
+void matchFeaturesCuda_deleteObj(void *ptrMatcher);
 
 #endif
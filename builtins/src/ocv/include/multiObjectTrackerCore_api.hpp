@@ -0,0 +1,51 @@
+/* Copyright 2016 The MathWorks, Inc. */
+
+#ifndef _MULTIOBJECTTRACKER_
+#define _MULTIOBJECTTRACKER_
+
+#include "vision_defines.h"
+
+/* Kalman filter tracks of configureKalmanFilter assigned with
+   assignDetectionsToTracks, see MultiObjectTracker.hpp */
+EXTERN_C LIBMWCVSTRT_API
+void multiObjectTracker_construct(void ** ptr2ptrTracker);
+
+/* initialEstimateError and motionNoise have 2 elements at constant
+   velocity and 3 at constant acceleration. Drops the tracks. */
+EXTERN_C LIBMWCVSTRT_API
+void multiObjectTracker_setup(void * ptrTracker,
+        boolean_T isConstantAcceleration, int32_T numDims,
+        const double * initialEstimateError, const double * motionNoise,
+        double measurementNoise, double costOfNonAssignment,
+        int32_T invisibleForTooLong, int32_T ageThreshold,
+        double minVisibility);
+
+/* One frame of numDetections detections, numDetections-by-numDims, column
+   major. Returns the number of tracks after it. */
+EXTERN_C LIBMWCVSTRT_API
+int32_T multiObjectTracker_step(void * ptrTracker, const double * detections,
+        int32_T numDetections);
+
+/* Tracks, column major: locations is numTracks-by-numDims, states
+   numTracks-by-(numDims*stateLength) in the order of the State of
+   configureKalmanFilter, and assignedDetections the 1-based detection of
+   the last step, 0 for none. */
+EXTERN_C LIBMWCVSTRT_API
+void multiObjectTracker_getTracks(void * ptrTracker, uint32_T * ids,
+        double * locations, double * states, uint32_T * ages,
+        uint32_T * totalVisibleCounts, uint32_T * consecutiveInvisibleCounts,
+        uint32_T * assignedDetections);
+
+EXTERN_C LIBMWCVSTRT_API
+void multiObjectTracker_getTracksRM(void * ptrTracker, uint32_T * ids,
+        double * locations, double * states, uint32_T * ages,
+        uint32_T * totalVisibleCounts, uint32_T * consecutiveInvisibleCounts,
+        uint32_T * assignedDetections);
+
+EXTERN_C LIBMWCVSTRT_API
+void multiObjectTracker_reset(void * ptrTracker);
+
+EXTERN_C LIBMWCVSTRT_API
+void multiObjectTracker_deleteObj(void * ptrTracker);
+
+#endif
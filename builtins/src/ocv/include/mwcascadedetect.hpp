@@ -72,6 +72,46 @@ namespace cv
 
 #define CALC_SUM(rect,offset) CALC_SUM_((rect)[0], (rect)[1], (rect)[2], (rect)[3], offset)
 
+// CALC_SUM_ of the MWFeatureEvaluator::NUM_LANES windows at offset,
+// offset + dx, offset + 2*dx, ...
+#if CV_SSE2
+// p[0], p[dx], ..., p[7*dx], without reading past p[7*dx]
+inline void loadLanes( const int* p, int dx, __m128i& lo, __m128i& hi )
+{
+    if( dx == 1 )
+    {
+        lo = _mm_loadu_si128((const __m128i*)p);
+        hi = _mm_loadu_si128((const __m128i*)(p + 4));
+    }
+    else if( dx == 2 )
+    {
+        __m128i a = _mm_shuffle_epi32(_mm_loadu_si128((const __m128i*)p), _MM_SHUFFLE(3,1,2,0));
+        __m128i b = _mm_shuffle_epi32(_mm_loadu_si128((const __m128i*)(p + 4)), _MM_SHUFFLE(3,1,2,0));
+        __m128i c = _mm_shuffle_epi32(_mm_loadu_si128((const __m128i*)(p + 8)), _MM_SHUFFLE(3,1,2,0));
+        __m128i d = _mm_shuffle_epi32(_mm_loadu_si128((const __m128i*)(p + 11)), _MM_SHUFFLE(2,0,3,1));
+        lo = _mm_unpacklo_epi64(a, b);
+        hi = _mm_unpacklo_epi64(c, d);
+    }
+    else
+    {
+        lo = _mm_setr_epi32(p[0], p[dx], p[2*dx], p[3*dx]);
+        hi = _mm_setr_epi32(p[4*dx], p[5*dx], p[6*dx], p[7*dx]);
+    }
+}
+
+inline void calcSumLanes( const int* p0, const int* p1, const int* p2, const int* p3,
+                          int offset, int dx, __m128i& lo, __m128i& hi )
+{
+    __m128i lo0, hi0, lo1, hi1, lo2, hi2, lo3, hi3;
+    loadLanes( p0 + offset, dx, lo0, hi0 );
+    loadLanes( p1 + offset, dx, lo1, hi1 );
+    loadLanes( p2 + offset, dx, lo2, hi2 );
+    loadLanes( p3 + offset, dx, lo3, hi3 );
+    lo = _mm_add_epi32(_mm_sub_epi32(_mm_sub_epi32(lo0, lo1), lo2), lo3);
+    hi = _mm_add_epi32(_mm_sub_epi32(_mm_sub_epi32(hi0, hi1), hi2), hi3);
+}
+#endif
+
 
 //----------------------------------------------  HaarEvaluator ---------------------------------------
 class HaarEvaluator : public MWFeatureEvaluator
@@ -82,6 +122,7 @@ public:
         MWFeature();
 
         float calc( int offset ) const;
+        void calcLanes( int offset, int dx, float* val ) const;
         void updatePtrs( const Mat& sum );
         bool read( const FileNode& node );
 
@@ -102,16 +143,31 @@ public:
     virtual ~HaarEvaluator();
 
     virtual bool read( const FileNode& node );
+    virtual bool writeBinary( vector<uchar>& buf ) const;
+    virtual bool readBinary( const uchar* buf, size_t size );
     virtual Ptr<MWFeatureEvaluator> clone() const;
+    virtual Ptr<MWFeatureEvaluator> cloneDetached() const;
     virtual int getFeatureType() const { return MWFeatureEvaluator::HAAR; }
 
     virtual bool setImage(const Mat&, Size origWinSize);
     virtual bool setWindow(Point pt);
+    virtual bool setWindows(Point pt, int dx);
+    virtual bool setIntegrals(const Mat& image, const Mat& sum, const Mat& sqsum,
+                              const Mat& tilted, Size origWinSize);
+    bool hasTilted() const { return hasTiltedFeatures; }
 
     double operator()(int featureIdx) const
     { return featuresPtr[featureIdx].calc(offset) * varianceNormFactor; }
     virtual double calcOrd(int featureIdx) const
     { return (*this)(featureIdx); }
+    // operator() on the windows of setWindows
+    void calcOrdLanes(int featureIdx, double* val) const
+    {
+        float fval[NUM_LANES];
+        featuresPtr[featureIdx].calcLanes(offset, laneStep, fval);
+        for( int k = 0; k < NUM_LANES; k++ )
+            val[k] = fval[k] * laneNormFactor[k];
+    }
 
 protected:
     Size origWinSize;
@@ -128,6 +184,8 @@ protected:
 
     int offset;
     double varianceNormFactor;
+    int laneStep;
+    double laneNormFactor[NUM_LANES];
 };
 
 inline HaarEvaluator::MWFeature :: MWFeature()
@@ -150,6 +208,34 @@ inline float HaarEvaluator::MWFeature :: calc( int _offset ) const
     return ret;
 }
 
+inline void HaarEvaluator::MWFeature :: calcLanes( int _offset, int dx, float* val ) const
+{
+#if CV_SSE2
+    // the float operations of calc, in the same order
+    __m128i lo, hi;
+    calcSumLanes( p[0][0], p[0][1], p[0][2], p[0][3], _offset, dx, lo, hi );
+    __m128 w = _mm_set1_ps(rect[0].weight);
+    __m128 retLo = _mm_mul_ps(w, _mm_cvtepi32_ps(lo));
+    __m128 retHi = _mm_mul_ps(w, _mm_cvtepi32_ps(hi));
+    calcSumLanes( p[1][0], p[1][1], p[1][2], p[1][3], _offset, dx, lo, hi );
+    w = _mm_set1_ps(rect[1].weight);
+    retLo = _mm_add_ps(retLo, _mm_mul_ps(w, _mm_cvtepi32_ps(lo)));
+    retHi = _mm_add_ps(retHi, _mm_mul_ps(w, _mm_cvtepi32_ps(hi)));
+    if( rect[2].weight != 0.0f )
+    {
+        calcSumLanes( p[2][0], p[2][1], p[2][2], p[2][3], _offset, dx, lo, hi );
+        w = _mm_set1_ps(rect[2].weight);
+        retLo = _mm_add_ps(retLo, _mm_mul_ps(w, _mm_cvtepi32_ps(lo)));
+        retHi = _mm_add_ps(retHi, _mm_mul_ps(w, _mm_cvtepi32_ps(hi)));
+    }
+    _mm_storeu_ps(val, retLo);
+    _mm_storeu_ps(val + 4, retHi);
+#else
+    for( int k = 0; k < MWFeatureEvaluator::NUM_LANES; k++ )
+        val[k] = calc( _offset + k*dx );
+#endif
+}
+
 inline void HaarEvaluator::MWFeature :: updatePtrs( const Mat& _sum )
 {
     const int* ptr = (const int*)_sum.data;
@@ -183,6 +269,7 @@ public:
         rect(x, y, _block_w, _block_h) {}
 
         int calc( int offset ) const;
+        void calcLanes( int offset, int dx, int* val ) const;
         void updatePtrs( const Mat& sum );
         bool read(const FileNode& node );
 
@@ -194,16 +281,25 @@ public:
     virtual ~LBPEvaluator();
 
     virtual bool read( const FileNode& node );
+    virtual bool writeBinary( vector<uchar>& buf ) const;
+    virtual bool readBinary( const uchar* buf, size_t size );
     virtual Ptr<MWFeatureEvaluator> clone() const;
+    virtual Ptr<MWFeatureEvaluator> cloneDetached() const;
     virtual int getFeatureType() const { return MWFeatureEvaluator::LBP; }
 
     virtual bool setImage(const Mat& image, Size _origWinSize);
     virtual bool setWindow(Point pt);
+    virtual bool setWindows(Point pt, int dx);
+    virtual bool setIntegrals(const Mat& image, const Mat& sum, const Mat& sqsum,
+                              const Mat& tilted, Size origWinSize);
 
     int operator()(int featureIdx) const
     { return featuresPtr[featureIdx].calc(offset); }
     virtual int calcCat(int featureIdx) const
     { return (*this)(featureIdx); }
+    // operator() on the windows of setWindows
+    void calcCatLanes(int featureIdx, int* val) const
+    { featuresPtr[featureIdx].calcLanes(offset, laneStep, val); }
 protected:
     Size origWinSize;
     Ptr<vector<MWFeature> > features;
@@ -212,6 +308,7 @@ protected:
     Rect normrect;
 
     int offset;
+    int laneStep;
 };
 
 
@@ -236,6 +333,30 @@ inline int LBPEvaluator::MWFeature :: calc( int _offset ) const
            (CALC_SUM_( p[4], p[5], p[8], p[9], _offset ) >= cval ? 1 : 0);
 }
 
+inline void LBPEvaluator::MWFeature :: calcLanes( int _offset, int dx, int* val ) const
+{
+#if CV_SSE2
+    // the blocks of calc, in the order of the bits from 128 to 1
+    static const int blocks[8][4] = { {0, 1, 4, 5}, {1, 2, 5, 6}, {2, 3, 6, 7}, {6, 7, 10, 11},
+                                      {10, 11, 14, 15}, {9, 10, 13, 14}, {8, 9, 12, 13}, {4, 5, 8, 9} };
+    __m128i cLo, cHi, codeLo = _mm_setzero_si128(), codeHi = _mm_setzero_si128();
+    calcSumLanes( p[5], p[6], p[9], p[10], _offset, dx, cLo, cHi );
+    for( int b = 0; b < 8; b++ )
+    {
+        __m128i lo, hi, bit = _mm_set1_epi32(128 >> b);
+        calcSumLanes( p[blocks[b][0]], p[blocks[b][1]], p[blocks[b][2]], p[blocks[b][3]], _offset, dx, lo, hi );
+        // the bit is set where the block sum is not below the center
+        codeLo = _mm_or_si128(codeLo, _mm_andnot_si128(_mm_cmplt_epi32(lo, cLo), bit));
+        codeHi = _mm_or_si128(codeHi, _mm_andnot_si128(_mm_cmplt_epi32(hi, cHi), bit));
+    }
+    _mm_storeu_si128((__m128i*)val, codeLo);
+    _mm_storeu_si128((__m128i*)(val + 4), codeHi);
+#else
+    for( int k = 0; k < MWFeatureEvaluator::NUM_LANES; k++ )
+        val[k] = calc( _offset + k*dx );
+#endif
+}
+
 inline void LBPEvaluator::MWFeature :: updatePtrs( const Mat& _sum )
 {
     const int* ptr = (const int*)_sum.data;
@@ -272,7 +393,10 @@ public:
     HOGEvaluator();
     virtual ~HOGEvaluator();
     virtual bool read( const FileNode& node );
+    virtual bool writeBinary( vector<uchar>& buf ) const;
+    virtual bool readBinary( const uchar* buf, size_t size );
     virtual Ptr<MWFeatureEvaluator> clone() const;
+    virtual Ptr<MWFeatureEvaluator> cloneDetached() const;
     virtual int getFeatureType() const { return MWFeatureEvaluator::HOG; }
     virtual bool setImage( const Mat& image, Size winSize );
     virtual bool setWindow( Point pt );
@@ -291,8 +415,12 @@ private:
     Size origWinSize;
     Ptr<vector<MWFeature> > features;
     MWFeature* featuresPtr;
-    vector<Mat> hist;
-    Mat normSum;
+    // the histograms of a scale level are headers over hist0 and normSum0,
+    // allocated for the largest level
+    vector<Mat> hist0, hist;
+    Mat normSum0, normSum;
+    // scratch of integralHistogram, reused between scale levels
+    mutable Mat grad0, qangle0, rowBuf0;
     int offset;
 };
 
@@ -498,6 +626,129 @@ inline int predictCategoricalStump( MWCascadeClassifier& cascade, Ptr<MWFeatureE
 
     return 1;
 }
+
+//----------------------------------------------  batched predictor functions -------------------------------------
+// predictOrderedStump and predictCategoricalStump on the windows of
+// setWindows, each feature being computed for all of them at once. A lane
+// stops at the stage that rejects it, and the predictor stops when all the
+// lanes are rejected. results and weights are the return value and the
+// weight of the single window predictor, lane by lane.
+
+template<class FEval>
+inline void predictOrderedStumpLanes( MWCascadeClassifier& cascade, Ptr<MWFeatureEvaluator> &_featureEvaluator,
+                                      int* results, double* weights )
+{
+    enum { NUM_LANES = MWFeatureEvaluator::NUM_LANES };
+    int nodeOfs = 0, leafOfs = 0;
+    FEval& featureEvaluator = (FEval&)*_featureEvaluator;
+    float* cascadeLeaves = &cascade.data.leaves[0];
+    MWCascadeClassifier::Data::DTreeNode* cascadeNodes = &cascade.data.nodes[0];
+    MWCascadeClassifier::Data::Stage* cascadeStages = &cascade.data.stages[0];
+    double sum[NUM_LANES], value[NUM_LANES];
+    bool active[NUM_LANES];
+    int k, numActive = NUM_LANES;
+
+    for( k = 0; k < NUM_LANES; k++ )
+    {
+        results[k] = 1;
+        active[k] = true;
+    }
+
+    int nstages = (int)cascade.data.stages.size();
+    for( int stageIdx = 0; stageIdx < nstages; stageIdx++ )
+    {
+        MWCascadeClassifier::Data::Stage& stage = cascadeStages[stageIdx];
+        for( k = 0; k < NUM_LANES; k++ )
+            sum[k] = 0.0;
+
+        int ntrees = stage.ntrees;
+        for( int i = 0; i < ntrees; i++, nodeOfs++, leafOfs+= 2 )
+        {
+            MWCascadeClassifier::Data::DTreeNode& node = cascadeNodes[nodeOfs];
+            featureEvaluator.calcOrdLanes(node.featureIdx, value);
+            for( k = 0; k < NUM_LANES; k++ )
+                sum[k] += cascadeLeaves[ value[k] < node.threshold ? leafOfs : leafOfs + 1 ];
+        }
+
+        for( k = 0; k < NUM_LANES; k++ )
+        {
+            if( active[k] && sum[k] < stage.threshold )
+            {
+                results[k] = -stageIdx;
+                weights[k] = sum[k];
+                active[k] = false;
+                numActive--;
+            }
+        }
+        if( numActive == 0 )
+            return;
+    }
+
+    for( k = 0; k < NUM_LANES; k++ )
+        if( active[k] )
+            weights[k] = sum[k];
+}
+
+template<class FEval>
+inline void predictCategoricalStumpLanes( MWCascadeClassifier& cascade, Ptr<MWFeatureEvaluator> &_featureEvaluator,
+                                          int* results, double* weights )
+{
+    enum { NUM_LANES = MWFeatureEvaluator::NUM_LANES };
+    int nstages = (int)cascade.data.stages.size();
+    int nodeOfs = 0, leafOfs = 0;
+    FEval& featureEvaluator = (FEval&)*_featureEvaluator;
+    size_t subsetSize = (cascade.data.ncategories + 31)/32;
+    int* cascadeSubsets = &cascade.data.subsets[0];
+    float* cascadeLeaves = &cascade.data.leaves[0];
+    MWCascadeClassifier::Data::DTreeNode* cascadeNodes = &cascade.data.nodes[0];
+    MWCascadeClassifier::Data::Stage* cascadeStages = &cascade.data.stages[0];
+    double sum[NUM_LANES];
+    int c[NUM_LANES];
+    bool active[NUM_LANES];
+    int k, numActive = NUM_LANES;
+
+    for( k = 0; k < NUM_LANES; k++ )
+    {
+        results[k] = 1;
+        active[k] = true;
+    }
+
+    for( int si = 0; si < nstages; si++ )
+    {
+        MWCascadeClassifier::Data::Stage& stage = cascadeStages[si];
+        int wi, ntrees = stage.ntrees;
+        for( k = 0; k < NUM_LANES; k++ )
+            sum[k] = 0;
+
+        for( wi = 0; wi < ntrees; wi++ )
+        {
+            MWCascadeClassifier::Data::DTreeNode& node = cascadeNodes[nodeOfs];
+            featureEvaluator.calcCatLanes(node.featureIdx, c);
+            const int* subset = &cascadeSubsets[nodeOfs*subsetSize];
+            for( k = 0; k < NUM_LANES; k++ )
+                sum[k] += cascadeLeaves[ subset[c[k]>>5] & (1 << (c[k] & 31)) ? leafOfs : leafOfs+1];
+            nodeOfs++;
+            leafOfs += 2;
+        }
+
+        for( k = 0; k < NUM_LANES; k++ )
+        {
+            if( active[k] && sum[k] < stage.threshold )
+            {
+                results[k] = -si;
+                weights[k] = sum[k];
+                active[k] = false;
+                numActive--;
+            }
+        }
+        if( numActive == 0 )
+            return;
+    }
+
+    for( k = 0; k < NUM_LANES; k++ )
+        if( active[k] )
+            weights[k] = sum[k];
+}
 }
 
 #endif
\ No newline at end of file
@@ -0,0 +1,71 @@
+//////////////////////////////////////////////////////////////////////////////
+// Compact floating point feature descriptors (SURF, KAZE) and their SSD
+// kernels.
+//
+// A descriptor is stored either as IEEE half precision numbers, held in
+// unsigned short, or as signed char scaled by DESCRIPTOR_INT8_SCALE. SURF
+// and KAZE descriptors have unit length, so every element is in [-1, 1] and
+// the int8 scaling does not saturate. The compact types take half or a
+// quarter of the memory of single descriptors and are matched without
+// converting them back.
+//
+// As in mwhamming.hpp, the kernels are selected once at run time based on
+// the CPU: AVX2 with F16C and FMA, SSE2 for int8, or portable code.
+//
+// Copyright 2016 The MathWorks, Inc.
+//
+//////////////////////////////////////////////////////////////////////////////
+#ifndef MWCOMPACTDESCRIPTOR_HPP
+#define MWCOMPACTDESCRIPTOR_HPP
+
+#include <cstddef>
+
+namespace vision
+{
+
+// Scale of the int8 descriptors: element x is stored as round(127 * x)
+const float DESCRIPTOR_INT8_SCALE = 127.0f;
+
+// Converts the numFeatures-by-numel row-major single descriptors to the
+// compact type, written numFeatures-by-numel column major unless isRowMajor.
+void compactDescriptors(const float *descriptors, int numFeatures, int numel,
+                        bool isRowMajor, unsigned short *outHalf);
+
+void compactDescriptors(const float *descriptors, int numFeatures, int numel,
+                        bool isRowMajor, signed char *outInt8);
+
+// Single value of a half precision number
+float halfToFloat(unsigned short h);
+
+typedef float (*SsdHalfFcn)(const unsigned short *a, const unsigned short *b,
+                            size_t numel);
+typedef int (*SsdInt8Fcn)(const signed char *a, const signed char *b,
+                          size_t numel);
+
+// Return the fastest sum of squared differences kernels supported by this
+// CPU. The int8 distance is in units of 1 / DESCRIPTOR_INT8_SCALE^2.
+SsdHalfFcn getSsdHalfFcn();
+SsdInt8Fcn getSsdInt8Fcn();
+
+// Exhaustive k-nearest neighbor search of compact features with the sum of
+// squared differences.
+//
+//  query:      numQuery-by-numel row-major features
+//  train:      numTrain-by-numel row-major features
+//  indices:    numQuery-by-knn row-major, 0-based indices into train
+//  dists:      numQuery-by-knn row-major, SSD of the single descriptors
+//
+// Neighbors are sorted by increasing distance. When knn exceeds numTrain,
+// the remaining indices are -1 and distances are -1. The blocking and
+// threading are those of hammingKnnMatch.
+void ssdKnnMatch(const unsigned short *query, int numQuery,
+                 const unsigned short *train, int numTrain,
+                 int numel, int knn, int *indices, float *dists);
+
+void ssdKnnMatch(const signed char *query, int numQuery,
+                 const signed char *train, int numTrain,
+                 int numel, int knn, int *indices, float *dists);
+
+} // namespace vision
+
+#endif
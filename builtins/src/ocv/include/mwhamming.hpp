@@ -0,0 +1,49 @@
+//////////////////////////////////////////////////////////////////////////////
+// Hamming distance kernels for binary feature descriptors (BRISK, FREAK).
+//
+// The distance kernel is selected once at run time based on the CPU:
+// AVX2, POPCNT, NEON or a portable table lookup.
+//
+// Copyright 2016 The MathWorks, Inc.
+//
+//////////////////////////////////////////////////////////////////////////////
+#ifndef MWHAMMING_HPP
+#define MWHAMMING_HPP
+
+#include <cstddef>
+
+namespace vision
+{
+
+typedef int (*HammingDistanceFcn)(const unsigned char *a,
+                                  const unsigned char *b, size_t numBytes);
+
+// Returns the fastest Hamming distance kernel supported by this CPU.
+HammingDistanceFcn getHammingDistanceFcn();
+
+// Number of bits that differ between a and b.
+inline int hammingDistance(const unsigned char *a, const unsigned char *b,
+                           size_t numBytes)
+{
+    static const HammingDistanceFcn fcn = getHammingDistanceFcn();
+    return fcn(a, b, numBytes);
+}
+
+// Exhaustive k-nearest neighbor search of binary features.
+//
+//  query:      numQuery-by-numBytes row-major features
+//  train:      numTrain-by-numBytes row-major features
+//  indices:    numQuery-by-knn row-major, 0-based indices into train
+//  dists:      numQuery-by-knn row-major, Hamming distances
+//
+// Neighbors are sorted by increasing distance. When knn exceeds numTrain,
+// the remaining entries are set to -1. Query and train features are
+// processed in blocks that fit in cache, and query blocks are distributed
+// across threads.
+void hammingKnnMatch(const unsigned char *query, int numQuery,
+                     const unsigned char *train, int numTrain,
+                     int numBytes, int knn, int *indices, int *dists);
+
+} // namespace vision
+
+#endif
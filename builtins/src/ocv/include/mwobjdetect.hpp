@@ -357,14 +357,29 @@ class CV_EXPORTS MWFeatureEvaluator
 {
 public:
     enum { HAAR = 0, LBP = 1, HOG = 2 };
+    // windows evaluated together by setWindows
+    enum { NUM_LANES = 8 };
     virtual ~MWFeatureEvaluator();
 
     virtual bool read(const FileNode& node);
+    // the features as the fixed size records of the binary cascade format
+    virtual bool writeBinary(vector<uchar>& buf) const;
+    virtual bool readBinary(const uchar* buf, size_t size);
     virtual Ptr<MWFeatureEvaluator> clone() const;
+    // a clone with its own features and image buffers, which can be set to
+    // another image while this evaluator is in use
+    virtual Ptr<MWFeatureEvaluator> cloneDetached() const;
     virtual int getFeatureType() const;
 
     virtual bool setImage(const Mat& img, Size origWinSize);
     virtual bool setWindow(Point p);
+    // the NUM_LANES windows at p, p + (dx, 0), p + (2*dx, 0), ...; false
+    // when one is outside the image or the evaluator has no batched path
+    virtual bool setWindows(Point p, int dx);
+    // setImage from the integral images of img, computed once for several
+    // evaluators; an evaluator that needs other data computes it from img
+    virtual bool setIntegrals(const Mat& img, const Mat& sum, const Mat& sqsum,
+                              const Mat& tilted, Size origWinSize);
 
     virtual double calcOrd(int featureIdx) const;
     virtual int calcCat(int featureIdx) const;
@@ -384,7 +399,9 @@ enum
     MWCASCADE_DO_CANNY_PRUNING=1,
     MWCASCADE_SCALE_IMAGE=2,
     MWCASCADE_FIND_BIGGEST_OBJECT=4,
-    MWCASCADE_DO_ROUGH_SEARCH=8
+    MWCASCADE_DO_ROUGH_SEARCH=8,
+    // search all the scale levels in one parallel region
+    MWCASCADE_SCALE_PARALLEL=16
 };
 
 class CV_EXPORTS_W MWCascadeClassifier
@@ -397,6 +414,13 @@ public:
     CV_WRAP virtual bool empty() const;
     CV_WRAP bool load( const string& filename );
     virtual bool read( const FileNode& node );
+
+    // The binary cascade format holds the model as the arrays the detector
+    // uses, in native byte order, so it is loaded from a read-only mapping
+    // without parsing. load() recognizes it. Old format Haar cascades keep
+    // their stages, trees and features.
+    bool saveBinary( const string& filename ) const;
+    bool loadBinary( const string& filename );
     CV_WRAP virtual void detectMultiScale( const Mat& image,
                                    CV_OUT vector<Rect>& objects,
                                    double scaleFactor=1.1,
@@ -420,6 +444,25 @@ public:
     int getFeatureType() const;
     bool setImage( const Mat& );
 
+    // detectMultiScale of each classifier on the same image, with one
+    // resize and one set of integral images per scale level for all of
+    // them. objects, minNeighbors, minSize and maxSize hold one element per
+    // classifier. The buffers are kept by the first classifier.
+    static void detectMultiModel( MWCascadeClassifier** classifiers, int numClassifiers,
+                                  const Mat& image, vector<Rect>* objects,
+                                  double scaleFactor, const int* minNeighbors,
+                                  const Size* minSize, const Size* maxSize );
+
+    // detectMultiScale restricted to regions of the image, each with its
+    // own object size range. The regions are scanned at their own scales
+    // and the candidates of all of them are grouped together, so an object
+    // seen by overlapping regions is reported once. Near the border of a
+    // region the image outside it is not seen by the detector.
+    void detectMultiScaleInROIs( const Mat& image, const vector<Rect>& rois,
+                                 const vector<Size>& minSizes, const vector<Size>& maxSizes,
+                                 CV_OUT vector<Rect>& objects, double scaleFactor=1.1,
+                                 int minNeighbors=3, int flags=0 );
+
 protected:
     //virtual bool detectSingleScale( const Mat& image, int stripCount, Size processingRectSize,
     //                                int stripSize, int yStep, double factor, vector<Rect>& candidates );
@@ -427,6 +470,16 @@ protected:
     virtual bool detectSingleScale( const Mat& image, int stripCount, Size processingRectSize,
                                     int stripSize, int yStep, double factor, vector<Rect>& candidates,
                                     vector<int>& rejectLevels, vector<double>& levelWeights, bool outputRejectLevels=false);
+    // detectSingleScale once the feature evaluator is set to image
+    void scanSingleScale( const Mat& image, int stripCount, Size processingRectSize,
+                          int stripSize, int yStep, double factor, vector<Rect>& candidates,
+                          vector<int>& rejectLevels, vector<double>& levelWeights, bool outputRejectLevels );
+
+    // MWCASCADE_SCALE_PARALLEL: the strips of all the scale levels are
+    // scheduled together, the largest first
+    void detectAllScales( const Mat& grayImage, double scaleFactor, Size minObjectSize, Size maxObjectSize,
+                          vector<Rect>& candidates, vector<int>& rejectLevels, vector<double>& levelWeights,
+                          bool outputRejectLevels );
 
 protected:
     enum { BOOST = 0 };
@@ -434,6 +487,8 @@ protected:
            FIND_BIGGEST_OBJECT = 4, DO_ROUGH_SEARCH = 8 };
 
     friend class CascadeClassifierInvoker;
+    friend class CascadeLevelInvoker;
+    friend class CascadePyramidInvoker;
 
     template<class FEval>
     friend int predictOrdered( MWCascadeClassifier& cascade, Ptr<MWFeatureEvaluator> &featureEvaluator, double& weight);
@@ -447,8 +502,17 @@ protected:
     template<class FEval>
     friend int predictCategoricalStump( MWCascadeClassifier& cascade, Ptr<MWFeatureEvaluator> &featureEvaluator, double& weight);
 
+    template<class FEval>
+    friend void predictOrderedStumpLanes( MWCascadeClassifier& cascade, Ptr<MWFeatureEvaluator> &featureEvaluator, int* results, double* weights);
+
+    template<class FEval>
+    friend void predictCategoricalStumpLanes( MWCascadeClassifier& cascade, Ptr<MWFeatureEvaluator> &featureEvaluator, int* results, double* weights);
+
     bool setImage( Ptr<MWFeatureEvaluator>& feval, const Mat& image);
     virtual int runAt( Ptr<MWFeatureEvaluator>& feval, Point pt, double& weight );
+    // runAt on the MWFeatureEvaluator::NUM_LANES windows of setWindows;
+    // false when they cannot be evaluated together
+    bool runAtLanes( Ptr<MWFeatureEvaluator>& feval, Point pt, int dx, int* results, double* weights );
 
     class Data
     {
@@ -508,6 +572,48 @@ public:
 
 protected:
     Ptr<MaskGenerator> maskGenerator;
+
+    // Buffers of detectMultiScale. They are allocated for the first frame
+    // and reused for the next frames of the same size, the scale levels
+    // being headers over the buffers of the largest level.
+    struct DetectionContext
+    {
+        // image, integral images and evaluator of one scale level, kept
+        // for the next frames by detectAllScales
+        struct ScaleLevel
+        {
+            double factor;
+            Size processingRectSize;
+            int yStep;
+            Mat image;
+            Mat mask;
+            Ptr<MWFeatureEvaluator> evaluator;
+        };
+        // rows y1 to y2 of the windows of a scale level
+        struct Strip
+        {
+            int level;
+            int y1, y2;
+            int numWindows;
+            int output;
+        };
+        // candidates found by one strip, merged in strip order after the
+        // parallel loop instead of appended under a lock
+        struct StripOutput
+        {
+            vector<Rect> rects;
+            vector<int> levels;
+            vector<double> weights;
+        };
+
+        Mat grayImage;
+        Mat imageBuffer;
+        vector<Rect> candidates;
+        vector<ScaleLevel> levels;
+        vector<Strip> strips;
+        vector<StripOutput> outputs;
+    };
+    DetectionContext context;
 };
 
 
@@ -524,6 +630,8 @@ struct MWDetectionROI
    vector<double> confidences;
 };
 
+struct MWHOGCache;
+
 struct CV_EXPORTS_W MWHOGDescriptor
 {
 public:
@@ -533,7 +641,7 @@ public:
     CV_WRAP MWHOGDescriptor() : winSize(64,128), blockSize(16,16), blockStride(8,8),
         cellSize(8,8), nbins(9), derivAperture(1), winSigma(-1),
         histogramNormType(MWHOGDescriptor::L2Hys), L2HysThreshold(0.2), gammaCorrection(true),
-        nlevels(MWHOGDescriptor::DEFAULT_NLEVELS)
+        nlevels(MWHOGDescriptor::DEFAULT_NLEVELS), memoryBudget(0)
     {}
 
     CV_WRAP MWHOGDescriptor(Size _winSize, Size _blockSize, Size _blockStride,
@@ -544,10 +652,10 @@ public:
     : winSize(_winSize), blockSize(_blockSize), blockStride(_blockStride), cellSize(_cellSize),
     nbins(_nbins), derivAperture(_derivAperture), winSigma(_winSigma),
     histogramNormType(_histogramNormType), L2HysThreshold(_L2HysThreshold),
-    gammaCorrection(_gammaCorrection), nlevels(_nlevels)
+    gammaCorrection(_gammaCorrection), nlevels(_nlevels), memoryBudget(0)
     {}
 
-    CV_WRAP MWHOGDescriptor(const String& filename)
+    CV_WRAP MWHOGDescriptor(const String& filename) : memoryBudget(0)
     {
         load(filename);
     }
@@ -586,6 +694,10 @@ public:
                         double hitThreshold=0, Size winStride=Size(),
                         Size padding=Size(),
                         const vector<Point>& searchLocations=vector<Point>()) const;
+    //with a cache that is reused over images of the same size
+    void detect(const Mat& img, MWHOGCache& cache, CV_OUT vector<Point>& foundLocations,
+                CV_OUT vector<double>& weights, double hitThreshold, Size winStride,
+                Size padding, const vector<Point>& searchLocations=vector<Point>()) const;
     //with result weights output
     CV_WRAP virtual void detectMultiScale(const Mat& img, CV_OUT vector<Rect>& foundLocations,
                                           CV_OUT vector<double>& foundWeights, double hitThreshold=0,
@@ -633,6 +745,72 @@ public:
    // read/parse Dalal's alt model file
    void readALTModel(std::string modelfile);
    void MWgroupRectangles(vector<cv::Rect>& rectList, vector<double>& weights, int groupThreshold, double eps) const;
+
+   // buffers of one scale level of detectMultiScale, kept from frame to
+   // frame; detectMultiScale is not reentrant on the same descriptor
+   struct DetectionLevel
+   {
+       Mat image;
+       Ptr<MWHOGCache> cache;
+       vector<Point> locations;
+       vector<double> weights;
+       Mat blocks, blockScores;
+   };
+   mutable vector<DetectionLevel> detectionLevels;
+
+   // cap in bytes on the buffers of the scale levels of detectMultiScale, 0
+   // for no cap. When the levels of an image need more, each level frees
+   // its buffers once scanned and fewer levels are scanned at once.
+   double memoryBudget;
+
+   // Bytes of the buffers of detectMultiScale for an image of imgSize with
+   // cn channels: peak, during a call, and steady, kept by the levels
+   // between calls. The scaled images are counted with the levels; the
+   // pyramid cache also holds them while it keeps the frame.
+   void estimateMemory(Size imgSize, int cn, double scale0, Size minSize, Size maxSize,
+                       Size winStride, Size padding,
+                       double& peakBytes, double& steadyBytes) const;
+
+   // how detectMultiScale scans levelScale within memoryBudget: at most
+   // numConcurrent levels at once, and whether the levels keep their buffers
+   void planLevels(Size imgSize, int cn, const vector<double>& levelScale,
+                   Size winStride, Size padding, int& numConcurrent, bool& keepLevels,
+                   double& peakBytes, double& steadyBytes) const;
+
+   // scales of the pyramid levels of detectMultiScale
+   void getLevelScales(Size imgSize, double scale0, Size minSize, Size maxSize,
+                       CV_OUT vector<double>& levelScale) const;
+
+   // number of detection windows in each direction of an image
+   Size getScoreMapSize(Size imgSize, Size winStride=Size(), Size padding=Size()) const;
+
+   // SVM score of every window of the sliding window grid, without a
+   // threshold. scores(r,c) is the window at
+   // (c*winStride.width - padding.width, r*winStride.height - padding.height),
+   // with padding aligned as in detect(). The block histograms are computed
+   // once per block position and scored against all the blocks of the
+   // detector in one matrix product, so the scores match detect() up to
+   // float rounding.
+   void computeScoreMap(const Mat& img, CV_OUT Mat& scores,
+                        Size winStride=Size(), Size padding=Size()) const;
+   void computeScoreMap(const Mat& img, DetectionLevel& level, CV_OUT Mat& scores,
+                        Size winStride, Size padding) const;
+
+   // detectMultiScale restricted to regions of the image, each with its own
+   // object size range; the detections of all regions are merged together
+   void detectMultiScaleInROIs(const Mat& img, const vector<Rect>& rois,
+                               const vector<Size>& minSizes, const vector<Size>& maxSizes,
+                               CV_OUT vector<Rect>& foundLocations, CV_OUT vector<double>& foundWeights,
+                               double hitThreshold=0, Size winStride=Size(), Size padding=Size(),
+                               double scale0=1.05, double finalThreshold=2.0,
+                               bool useMeanshiftGrouping=false) const;
+
+   // score maps of each level of getLevelScales; scoreMaps may hold headers
+   // of external buffers of the right size, which are filled in place
+   void computeScoreMaps(const Mat& img, CV_OUT vector<Mat>& scoreMaps,
+                         CV_OUT vector<double>& scales, Size winStride=Size(),
+                         Size padding=Size(), double scale0=1.05,
+                         Size minSize=Size(), Size maxSize=Size()) const;
 };
 
 
@@ -0,0 +1,337 @@
+//////////////////////////////////////////////////////////////////////////////
+// Cache-blocked transpose used to convert between MATLAB (column major,
+// planar) and OpenCV (row major, interleaved) image layouts.
+//
+// The matrix is processed in tiles that stay in L1 cache. Each tile is
+// transposed with 8x8 (1-byte), 4x4 (4-byte) or 2x2 (8-byte) register
+// kernels using SSE2 on x86 and NEON on ARM. Other element sizes and the
+// tile borders use the scalar code.
+//
+// Copyright 2016 The MathWorks, Inc.
+//
+//////////////////////////////////////////////////////////////////////////////
+#ifndef MWTRANSPOSE_HPP
+#define MWTRANSPOSE_HPP
+
+#include <algorithm>
+#include <cstddef>
+
+#if defined(__ARM_NEON__) || defined(__ARM_NEON)
+#include <arm_neon.h>
+#define MW_TRANSPOSE_NEON 1
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define MW_TRANSPOSE_SSE2 1
+#endif
+
+namespace vision
+{
+
+// Number of elements per side of a cache tile
+const int TRANSPOSE_TILE = 32;
+
+//////////////////////////////////////////////////////////////////////////////
+// Register kernels, selected by element size. run() transposes a
+// SIZE-by-SIZE block: element (a, b) at src[a + b*srcStride] is written to
+// dst[b + a*dstStride].
+//////////////////////////////////////////////////////////////////////////////
+template <int ElemSize>
+struct TransposeKernel
+{
+    enum { SIZE = 1 };
+
+    static void run(const void *src, size_t, void *dst, size_t)
+    {
+        const unsigned char *s = (const unsigned char *)src;
+        unsigned char *d = (unsigned char *)dst;
+        for (int k = 0; k < ElemSize; ++k)
+            d[k] = s[k];
+    }
+};
+
+#if defined(MW_TRANSPOSE_SSE2)
+
+template <>
+struct TransposeKernel<1>
+{
+    enum { SIZE = 8 };
+
+    static void run(const void *src, size_t srcStride, void *dst, size_t dstStride)
+    {
+        const unsigned char *s = (const unsigned char *)src;
+        unsigned char *d = (unsigned char *)dst;
+
+        __m128i c0 = _mm_loadl_epi64((const __m128i *)(s));
+        __m128i c1 = _mm_loadl_epi64((const __m128i *)(s + srcStride));
+        __m128i c2 = _mm_loadl_epi64((const __m128i *)(s + 2*srcStride));
+        __m128i c3 = _mm_loadl_epi64((const __m128i *)(s + 3*srcStride));
+        __m128i c4 = _mm_loadl_epi64((const __m128i *)(s + 4*srcStride));
+        __m128i c5 = _mm_loadl_epi64((const __m128i *)(s + 5*srcStride));
+        __m128i c6 = _mm_loadl_epi64((const __m128i *)(s + 6*srcStride));
+        __m128i c7 = _mm_loadl_epi64((const __m128i *)(s + 7*srcStride));
+
+        __m128i t0 = _mm_unpacklo_epi8(c0, c1);
+        __m128i t1 = _mm_unpacklo_epi8(c2, c3);
+        __m128i t2 = _mm_unpacklo_epi8(c4, c5);
+        __m128i t3 = _mm_unpacklo_epi8(c6, c7);
+
+        __m128i u0 = _mm_unpacklo_epi16(t0, t1);
+        __m128i u1 = _mm_unpackhi_epi16(t0, t1);
+        __m128i u2 = _mm_unpacklo_epi16(t2, t3);
+        __m128i u3 = _mm_unpackhi_epi16(t2, t3);
+
+        // each register holds two rows of the result
+        __m128i r01 = _mm_unpacklo_epi32(u0, u2);
+        __m128i r23 = _mm_unpackhi_epi32(u0, u2);
+        __m128i r45 = _mm_unpacklo_epi32(u1, u3);
+        __m128i r67 = _mm_unpackhi_epi32(u1, u3);
+
+        _mm_storel_epi64((__m128i *)(d),               r01);
+        _mm_storel_epi64((__m128i *)(d + dstStride),   _mm_srli_si128(r01, 8));
+        _mm_storel_epi64((__m128i *)(d + 2*dstStride), r23);
+        _mm_storel_epi64((__m128i *)(d + 3*dstStride), _mm_srli_si128(r23, 8));
+        _mm_storel_epi64((__m128i *)(d + 4*dstStride), r45);
+        _mm_storel_epi64((__m128i *)(d + 5*dstStride), _mm_srli_si128(r45, 8));
+        _mm_storel_epi64((__m128i *)(d + 6*dstStride), r67);
+        _mm_storel_epi64((__m128i *)(d + 7*dstStride), _mm_srli_si128(r67, 8));
+    }
+};
+
+template <>
+struct TransposeKernel<4>
+{
+    enum { SIZE = 4 };
+
+    static void run(const void *src, size_t srcStride, void *dst, size_t dstStride)
+    {
+        const float *s = (const float *)src;
+        float *d = (float *)dst;
+
+        __m128 c0 = _mm_loadu_ps(s);
+        __m128 c1 = _mm_loadu_ps(s + srcStride);
+        __m128 c2 = _mm_loadu_ps(s + 2*srcStride);
+        __m128 c3 = _mm_loadu_ps(s + 3*srcStride);
+
+        _MM_TRANSPOSE4_PS(c0, c1, c2, c3);
+
+        _mm_storeu_ps(d,               c0);
+        _mm_storeu_ps(d + dstStride,   c1);
+        _mm_storeu_ps(d + 2*dstStride, c2);
+        _mm_storeu_ps(d + 3*dstStride, c3);
+    }
+};
+
+template <>
+struct TransposeKernel<8>
+{
+    enum { SIZE = 2 };
+
+    static void run(const void *src, size_t srcStride, void *dst, size_t dstStride)
+    {
+        const double *s = (const double *)src;
+        double *d = (double *)dst;
+
+        __m128d c0 = _mm_loadu_pd(s);
+        __m128d c1 = _mm_loadu_pd(s + srcStride);
+
+        _mm_storeu_pd(d,             _mm_unpacklo_pd(c0, c1));
+        _mm_storeu_pd(d + dstStride, _mm_unpackhi_pd(c0, c1));
+    }
+};
+
+#elif defined(MW_TRANSPOSE_NEON)
+
+template <>
+struct TransposeKernel<1>
+{
+    enum { SIZE = 8 };
+
+    static void run(const void *src, size_t srcStride, void *dst, size_t dstStride)
+    {
+        const uint8_t *s = (const uint8_t *)src;
+        uint8_t *d = (uint8_t *)dst;
+
+        uint8x8x2_t t01 = vtrn_u8(vld1_u8(s),               vld1_u8(s + srcStride));
+        uint8x8x2_t t23 = vtrn_u8(vld1_u8(s + 2*srcStride), vld1_u8(s + 3*srcStride));
+        uint8x8x2_t t45 = vtrn_u8(vld1_u8(s + 4*srcStride), vld1_u8(s + 5*srcStride));
+        uint8x8x2_t t67 = vtrn_u8(vld1_u8(s + 6*srcStride), vld1_u8(s + 7*srcStride));
+
+        uint16x4x2_t x02 = vtrn_u16(vreinterpret_u16_u8(t01.val[0]), vreinterpret_u16_u8(t23.val[0]));
+        uint16x4x2_t x13 = vtrn_u16(vreinterpret_u16_u8(t01.val[1]), vreinterpret_u16_u8(t23.val[1]));
+        uint16x4x2_t x46 = vtrn_u16(vreinterpret_u16_u8(t45.val[0]), vreinterpret_u16_u8(t67.val[0]));
+        uint16x4x2_t x57 = vtrn_u16(vreinterpret_u16_u8(t45.val[1]), vreinterpret_u16_u8(t67.val[1]));
+
+        uint32x2x2_t r04 = vtrn_u32(vreinterpret_u32_u16(x02.val[0]), vreinterpret_u32_u16(x46.val[0]));
+        uint32x2x2_t r15 = vtrn_u32(vreinterpret_u32_u16(x13.val[0]), vreinterpret_u32_u16(x57.val[0]));
+        uint32x2x2_t r26 = vtrn_u32(vreinterpret_u32_u16(x02.val[1]), vreinterpret_u32_u16(x46.val[1]));
+        uint32x2x2_t r37 = vtrn_u32(vreinterpret_u32_u16(x13.val[1]), vreinterpret_u32_u16(x57.val[1]));
+
+        vst1_u8(d,               vreinterpret_u8_u32(r04.val[0]));
+        vst1_u8(d + dstStride,   vreinterpret_u8_u32(r15.val[0]));
+        vst1_u8(d + 2*dstStride, vreinterpret_u8_u32(r26.val[0]));
+        vst1_u8(d + 3*dstStride, vreinterpret_u8_u32(r37.val[0]));
+        vst1_u8(d + 4*dstStride, vreinterpret_u8_u32(r04.val[1]));
+        vst1_u8(d + 5*dstStride, vreinterpret_u8_u32(r15.val[1]));
+        vst1_u8(d + 6*dstStride, vreinterpret_u8_u32(r26.val[1]));
+        vst1_u8(d + 7*dstStride, vreinterpret_u8_u32(r37.val[1]));
+    }
+};
+
+template <>
+struct TransposeKernel<4>
+{
+    enum { SIZE = 4 };
+
+    static void run(const void *src, size_t srcStride, void *dst, size_t dstStride)
+    {
+        const float *s = (const float *)src;
+        float *d = (float *)dst;
+
+        float32x4x2_t t01 = vtrnq_f32(vld1q_f32(s),               vld1q_f32(s + srcStride));
+        float32x4x2_t t23 = vtrnq_f32(vld1q_f32(s + 2*srcStride), vld1q_f32(s + 3*srcStride));
+
+        vst1q_f32(d,               vcombine_f32(vget_low_f32(t01.val[0]),  vget_low_f32(t23.val[0])));
+        vst1q_f32(d + dstStride,   vcombine_f32(vget_low_f32(t01.val[1]),  vget_low_f32(t23.val[1])));
+        vst1q_f32(d + 2*dstStride, vcombine_f32(vget_high_f32(t01.val[0]), vget_high_f32(t23.val[0])));
+        vst1q_f32(d + 3*dstStride, vcombine_f32(vget_high_f32(t01.val[1]), vget_high_f32(t23.val[1])));
+    }
+};
+
+#endif
+
+template <typename T>
+inline void transposeScalar(const T *src, size_t srcStride,
+                            T *dst, size_t dstStride,
+                            int a0, int a1, int b0, int b1)
+{
+    for (int a = a0; a < a1; ++a)
+    {
+        T *d = dst + a*dstStride;
+        for (int b = b0; b < b1; ++b)
+        {
+            d[b] = src[a + b*srcStride];
+        }
+    }
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// transposeTiled:
+//  Transposes a numA-by-numB matrix. Element (a, b) at src[a + b*srcStride]
+//  is written to dst[b + a*dstStride].
+//
+//  Column major to row major:  a = row, b = column
+//  Row major to column major:  a = column, b = row
+//////////////////////////////////////////////////////////////////////////////
+template <typename T>
+void transposeTiled(const T *src, size_t srcStride,
+                    T *dst, size_t dstStride, int numA, int numB)
+{
+    typedef TransposeKernel<sizeof(T)> Kernel;
+    const int K = Kernel::SIZE;
+
+    for (int a0 = 0; a0 < numA; a0 += TRANSPOSE_TILE)
+    {
+        const int a1 = std::min(a0 + TRANSPOSE_TILE, numA);
+        for (int b0 = 0; b0 < numB; b0 += TRANSPOSE_TILE)
+        {
+            const int b1 = std::min(b0 + TRANSPOSE_TILE, numB);
+
+            int a = a0;
+            for (; a + K <= a1; a += K)
+            {
+                int b = b0;
+                for (; b + K <= b1; b += K)
+                {
+                    Kernel::run(src + a + b*srcStride, srcStride,
+                                dst + b + a*dstStride, dstStride);
+                }
+                transposeScalar(src, srcStride, dst, dstStride, a, a + K, b, b1);
+            }
+            transposeScalar(src, srcStride, dst, dstStride, a, a1, b0, b1);
+        }
+    }
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// transposePlanarToInterleaved:
+//  Column major planar (MATLAB RGB) to row major interleaved data in reverse
+//  channel order (OpenCV BGR). Channel k of element (row, col) at
+//  src[row + col*srcStride + k*planeStride] is written to
+//  dst[row*dstStride + col*channels + channels-1-k].
+//////////////////////////////////////////////////////////////////////////////
+template <typename T>
+void transposePlanarToInterleaved(const T *src, size_t srcStride, size_t planeStride,
+                                  T *dst, size_t dstStride,
+                                  int numRows, int numCols, int channels)
+{
+    // each plane of a tile is transposed into tmp, then interleaved
+    T tmp[TRANSPOSE_TILE*TRANSPOSE_TILE];
+
+    for (int r0 = 0; r0 < numRows; r0 += TRANSPOSE_TILE)
+    {
+        const int nr = std::min(TRANSPOSE_TILE, numRows - r0);
+        for (int c0 = 0; c0 < numCols; c0 += TRANSPOSE_TILE)
+        {
+            const int nc = std::min(TRANSPOSE_TILE, numCols - c0);
+            for (int k = 0; k < channels; ++k)
+            {
+                transposeTiled(src + r0 + c0*srcStride + k*planeStride, srcStride,
+                               tmp, TRANSPOSE_TILE, nr, nc);
+
+                for (int r = 0; r < nr; ++r)
+                {
+                    const T *t = tmp + r*TRANSPOSE_TILE;
+                    T *d = dst + (r0 + r)*dstStride + c0*channels + (channels - 1 - k);
+                    for (int c = 0; c < nc; ++c)
+                    {
+                        d[c*channels] = t[c];
+                    }
+                }
+            }
+        }
+    }
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// transposeInterleavedToPlanar:
+//  Inverse of transposePlanarToInterleaved. Channel k of element (row, col)
+//  at src[row*srcStride + col*channels + k] is written to
+//  dst[row + col*dstStride + (channels-1-k)*planeStride].
+//////////////////////////////////////////////////////////////////////////////
+template <typename T>
+void transposeInterleavedToPlanar(const T *src, size_t srcStride,
+                                  T *dst, size_t dstStride, size_t planeStride,
+                                  int numRows, int numCols, int channels)
+{
+    // each channel of a tile is gathered into tmp, then transposed
+    T tmp[TRANSPOSE_TILE*TRANSPOSE_TILE];
+
+    for (int r0 = 0; r0 < numRows; r0 += TRANSPOSE_TILE)
+    {
+        const int nr = std::min(TRANSPOSE_TILE, numRows - r0);
+        for (int c0 = 0; c0 < numCols; c0 += TRANSPOSE_TILE)
+        {
+            const int nc = std::min(TRANSPOSE_TILE, numCols - c0);
+            for (int k = 0; k < channels; ++k)
+            {
+                for (int r = 0; r < nr; ++r)
+                {
+                    const T *s = src + (r0 + r)*srcStride + c0*channels + k;
+                    T *t = tmp + r*TRANSPOSE_TILE;
+                    for (int c = 0; c < nc; ++c)
+                    {
+                        t[c] = s[c*channels];
+                    }
+                }
+
+                transposeTiled(tmp, TRANSPOSE_TILE,
+                               dst + r0 + c0*dstStride + (channels - 1 - k)*planeStride,
+                               dstStride, nc, nr);
+            }
+        }
+    }
+}
+
+} // namespace vision
+
+#endif
@@ -0,0 +1,72 @@
+/* Copyright 2016 The MathWorks, Inc. */
+
+#ifndef _OCRBATCH_
+#define _OCRBATCH_
+
+#include "vision_defines.h"
+
+/* Pool of Tesseract handles of ocr, see OcrHandlePool.hpp. The options
+   are the null terminated strings of OCRBuildable.tesseract. */
+EXTERN_C LIBMWCVSTRT_API
+void ocrBatch_construct(void ** ptr2ptrPool);
+
+EXTERN_C LIBMWCVSTRT_API
+void ocrBatch_setOptions(void * ptrPool, const char * textLayout,
+        const char * characterSet, const char * tessdata, const char * lang);
+
+/* Recognizes the numRois regions [x y width height] of rois, numRois-by-4,
+   column major, in the uint8 or logical image, numRows-by-numCols, column
+   major; numRois = 0 recognizes the whole image. totals receives the
+   number of bytes of text and the numbers of characters, words, text
+   lines, paragraphs and blocks of all regions. Returns 0, or the first
+   negative error code of ocrutils. The result is freed by
+   ocrBatch_assignOutputDelete. */
+EXTERN_C LIBMWCVSTRT_API
+int32_T ocrBatch_recognizeUint8(void * ptrPool, const uint8_T * image,
+        int32_T numRows, int32_T numCols, const int32_T * rois,
+        int32_T numRois, int32_T * totals, void ** ptr2ptrResult);
+
+EXTERN_C LIBMWCVSTRT_API
+int32_T ocrBatch_recognizeUint8RM(void * ptrPool, const uint8_T * image,
+        int32_T numRows, int32_T numCols, const int32_T * rois,
+        int32_T numRois, int32_T * totals, void ** ptr2ptrResult);
+
+EXTERN_C LIBMWCVSTRT_API
+int32_T ocrBatch_recognizeLogical(void * ptrPool, const boolean_T * image,
+        int32_T numRows, int32_T numCols, const int32_T * rois,
+        int32_T numRois, int32_T * totals, void ** ptr2ptrResult);
+
+EXTERN_C LIBMWCVSTRT_API
+int32_T ocrBatch_recognizeLogicalRM(void * ptrPool, const boolean_T * image,
+        int32_T numRows, int32_T numCols, const int32_T * rois,
+        int32_T numRois, int32_T * totals, void ** ptr2ptrResult);
+
+/* Outputs of all regions, in the layout of copyMetadata of ocrutils with
+   the rows of the regions one after the other. regionInfo is
+   numRegions-by-8: the status, the number of bytes of the text and of the
+   metadata text, and the numbers of characters, words, text lines,
+   paragraphs and blocks of each region. text holds the UTF-8 text then
+   the metadata text of each region. */
+EXTERN_C LIBMWCVSTRT_API
+void ocrBatch_assignOutputDelete(void * ptrResult,
+        int32_T * regionInfo, uint8_T * text,
+        double * charBBox, int32_T * charWordIndex, real32_T * charConfidence,
+        double * wordBBox, int32_T * wordTextLineIndex, real32_T * wordConfidence, int32_T * wordCharacterIndex,
+        double * textlineBBox, int32_T * textlineParagraphIndex, real32_T * textlineConfidence, int32_T * textlineCharacterIndex,
+        double * paragraphBBox, int32_T * paragraphBlockIndex, real32_T * paragraphConfidence, int32_T * paragraphCharacterIndex,
+        double * blockBBox, int32_T * blockPageIndex, real32_T * blockConfidence, int32_T * blockCharacterIndex);
+
+EXTERN_C LIBMWCVSTRT_API
+void ocrBatch_assignOutputDeleteRM(void * ptrResult,
+        int32_T * regionInfo, uint8_T * text,
+        double * charBBox, int32_T * charWordIndex, real32_T * charConfidence,
+        double * wordBBox, int32_T * wordTextLineIndex, real32_T * wordConfidence, int32_T * wordCharacterIndex,
+        double * textlineBBox, int32_T * textlineParagraphIndex, real32_T * textlineConfidence, int32_T * textlineCharacterIndex,
+        double * paragraphBBox, int32_T * paragraphBlockIndex, real32_T * paragraphConfidence, int32_T * paragraphCharacterIndex,
+        double * blockBBox, int32_T * blockPageIndex, real32_T * blockConfidence, int32_T * blockCharacterIndex);
+
+/* Cleans up the Tesseract handles */
+EXTERN_C LIBMWCVSTRT_API
+void ocrBatch_deleteObj(void * ptrPool);
+
+#endif
@@ -30,4 +30,32 @@ EXTERN_C LIBMWCVSTRT_API void opticalFlowFarneback_computeRM(uint8_T *inImgPrev,
 	cvstFarnebackStruct_T *params,
 	int32_T nRows, int32_T nCols);
 
+EXTERN_C LIBMWCVSTRT_API void opticalFlowFarneback_construct(void **ptr2ptrClass);
+EXTERN_C LIBMWCVSTRT_API void opticalFlowFarneback_step(void *ptrClass, uint8_T *inImgCurr,
+	float *outFlowXY, cvstFarnebackStruct_T *params,
+	int32_T nRows, int32_T nCols);
+EXTERN_C LIBMWCVSTRT_API void opticalFlowFarneback_stepRM(void *ptrClass, uint8_T *inImgCurr,
+	float *outFlowXY, cvstFarnebackStruct_T *params,
+	int32_T nRows, int32_T nCols);
+/* device is the index of the CUDA device that computes the flow; without
+ * such a device, the object computes the flow on the CPU. submit queues the
+ * flow to inImgCurr and getFlow writes the flow of the oldest frame
+ * submitted, so that the caller can read the next frame while the flow is
+ * computed. getFlow returns false if no frame was submitted. */
+EXTERN_C LIBMWCVSTRT_API void opticalFlowFarneback_constructOnDevice(void **ptr2ptrClass, int32_T device);
+EXTERN_C LIBMWCVSTRT_API boolean_T opticalFlowFarneback_isOnDevice(void *ptrClass);
+EXTERN_C LIBMWCVSTRT_API void opticalFlowFarneback_submit(void *ptrClass, uint8_T *inImgCurr,
+	cvstFarnebackStruct_T *params, int32_T nRows, int32_T nCols);
+EXTERN_C LIBMWCVSTRT_API boolean_T opticalFlowFarneback_getFlow(void *ptrClass, float *outFlowXY);
+EXTERN_C LIBMWCVSTRT_API boolean_T opticalFlowFarneback_getFlowRM(void *ptrClass, float *outFlowXY);
+/* stepImage and submitImage read the frame from an image handle (see
+ * imageHandleCore_api.hpp). stepImage writes the flow in the layout of the
+ * image. */
+EXTERN_C LIBMWCVSTRT_API void opticalFlowFarneback_stepImage(void *ptrClass, void *ptrImage,
+	float *outFlowXY, cvstFarnebackStruct_T *params);
+EXTERN_C LIBMWCVSTRT_API void opticalFlowFarneback_submitImage(void *ptrClass, void *ptrImage,
+	cvstFarnebackStruct_T *params);
+EXTERN_C LIBMWCVSTRT_API void opticalFlowFarneback_reset(void *ptrClass);
+EXTERN_C LIBMWCVSTRT_API void opticalFlowFarneback_deleteObj(void *ptrClass);
+
 #endif
@@ -0,0 +1,98 @@
+/* Copyright 2016 The MathWorks, Inc. */
+
+#ifndef _POINTCLOUDKDTREE_
+#define _POINTCLOUDKDTREE_
+
+#include "vision_defines.h"
+
+/* Exact kd-tree over the points of a point cloud, see PointCloudKdtree.hpp.
+   The tree is built once by index and kept by the object across searches.
+   location and points are numPoints-by-3 and numQueries-by-3, column major.
+   Distances are squared and indices 1-based. maxLeafChecks bounds the
+   leaves visited per query, 0 for an exact search. */
+
+EXTERN_C LIBMWCVSTRT_API
+void pointCloudKdtree_construct(void **ptr2ptrKdtree);
+
+EXTERN_C LIBMWCVSTRT_API
+void pointCloudKdtree_index(void *ptrKdtree, const double * location,
+        int32_T numPoints);
+
+EXTERN_C LIBMWCVSTRT_API
+void pointCloudKdtree_indexRM(void *ptrKdtree, const double * location,
+        int32_T numPoints);
+
+EXTERN_C LIBMWCVSTRT_API
+void pointCloudKdtree_construct_single(void **ptr2ptrKdtree);
+
+EXTERN_C LIBMWCVSTRT_API
+void pointCloudKdtree_index_single(void *ptrKdtree, const float * location,
+        int32_T numPoints);
+
+EXTERN_C LIBMWCVSTRT_API
+void pointCloudKdtree_index_singleRM(void *ptrKdtree, const float * location,
+        int32_T numPoints);
+
+/* K nearest neighbors of each query, nearest first: indices and dists are
+   K-by-numQueries, valid is numQueries-by-1, the number of neighbors found
+   for each query. */
+EXTERN_C LIBMWCVSTRT_API
+void pointCloudKdtree_knnSearch(void *ptrKdtree, const double * points,
+        int32_T numQueries, int32_T K, int32_T maxLeafChecks,
+        uint32_T * indices, double * dists, uint32_T * valid);
+
+EXTERN_C LIBMWCVSTRT_API
+void pointCloudKdtree_knnSearchRM(void *ptrKdtree, const double * points,
+        int32_T numQueries, int32_T K, int32_T maxLeafChecks,
+        uint32_T * indices, double * dists, uint32_T * valid);
+
+EXTERN_C LIBMWCVSTRT_API
+void pointCloudKdtree_knnSearch_single(void *ptrKdtree, const float * points,
+        int32_T numQueries, int32_T K, int32_T maxLeafChecks,
+        uint32_T * indices, float * dists, uint32_T * valid);
+
+EXTERN_C LIBMWCVSTRT_API
+void pointCloudKdtree_knnSearch_singleRM(void *ptrKdtree, const float * points,
+        int32_T numQueries, int32_T K, int32_T maxLeafChecks,
+        uint32_T * indices, float * dists, uint32_T * valid);
+
+/* Neighbors within radius of each query, sorted by distance when doSort.
+   valid is numQueries-by-1, the number of neighbors of each query; the
+   neighbors are returned in *ptr2ptrResult and copied, query after query,
+   by assignRadiusOutputDelete into indices and dists of sum(valid)
+   elements. */
+EXTERN_C LIBMWCVSTRT_API
+void pointCloudKdtree_radiusSearch(void *ptrKdtree, const double * points,
+        int32_T numQueries, double radius, int32_T maxLeafChecks,
+        boolean_T doSort, uint32_T * valid, void **ptr2ptrResult);
+
+EXTERN_C LIBMWCVSTRT_API
+void pointCloudKdtree_radiusSearchRM(void *ptrKdtree, const double * points,
+        int32_T numQueries, double radius, int32_T maxLeafChecks,
+        boolean_T doSort, uint32_T * valid, void **ptr2ptrResult);
+
+EXTERN_C LIBMWCVSTRT_API
+void pointCloudKdtree_radiusSearch_single(void *ptrKdtree, const float * points,
+        int32_T numQueries, float radius, int32_T maxLeafChecks,
+        boolean_T doSort, uint32_T * valid, void **ptr2ptrResult);
+
+EXTERN_C LIBMWCVSTRT_API
+void pointCloudKdtree_radiusSearch_singleRM(void *ptrKdtree, const float * points,
+        int32_T numQueries, float radius, int32_T maxLeafChecks,
+        boolean_T doSort, uint32_T * valid, void **ptr2ptrResult);
+
+EXTERN_C LIBMWCVSTRT_API
+void pointCloudKdtree_assignRadiusOutputDelete(void *ptrResult,
+        uint32_T * indices, double * dists);
+
+EXTERN_C LIBMWCVSTRT_API
+void pointCloudKdtree_assignRadiusOutputDelete_single(void *ptrResult,
+        uint32_T * indices, float * dists);
+
+EXTERN_C LIBMWCVSTRT_API
+void pointCloudKdtree_deleteObj(void *ptrKdtree);
+
+EXTERN_C LIBMWCVSTRT_API
+void pointCloudKdtree_deleteObj_single(void *ptrKdtree);
+
+#endif
@@ -19,6 +19,10 @@
 #endif /*typedef_cvstPTStruct_T: used by matlab coder*/
 
 EXTERN_C LIBMWCVSTRT_API void pointTracker_construct(void **ptr2ptrClass);
+/* device is the index of the CUDA device that tracks the points, or -1 for
+ * the CPU. Without that device, or without CUDA support in OpenCV, the
+ * tracker runs on the CPU. */
+EXTERN_C LIBMWCVSTRT_API void pointTracker_constructOnDevice(void **ptr2ptrClass, int32_T device);
 EXTERN_C LIBMWCVSTRT_API void pointTracker_initialize(void *ptrClass, 
 	uint8_T *inImg, const int nRows, const int nCols,
 	const float *pointData, const int numPoints,
@@ -27,14 +31,40 @@ EXTERN_C LIBMWCVSTRT_API void pointTracker_initializeRM(void *ptrClass,
 	uint8_T *inImg, const int nRows, const int nCols,
 	const float *pointData, const int numPoints,
 	cvstPTStruct_T *params);
+/* initializeImage and stepImage read the frame from an image handle (see
+ * imageHandleCore_api.hpp). The points are in the layout of the image. */
+EXTERN_C LIBMWCVSTRT_API void pointTracker_initializeImage(void *ptrClass, void *ptrImage,
+	const float *pointData, const int numPoints,
+	cvstPTStruct_T *params);
 EXTERN_C LIBMWCVSTRT_API void pointTracker_setPoints(void *ptrClass, const float *pointData, int numPoints, boolean_T *validityData);
 EXTERN_C LIBMWCVSTRT_API void pointTracker_setPointsRM(void *ptrClass, const float *pointData, int numPoints, boolean_T *validityData);
+/* Point buffers keep their capacity. reservePoints pre-allocates them,
+ * replacePoints overwrites the points at the 1-based indices and marks them
+ * valid, appendPoints adds valid points after the current ones. */
+EXTERN_C LIBMWCVSTRT_API void pointTracker_reservePoints(void *ptrClass, int capacity);
+EXTERN_C LIBMWCVSTRT_API void pointTracker_replacePoints(void *ptrClass, const int32_T *indices,
+	const float *pointData, int numPoints);
+EXTERN_C LIBMWCVSTRT_API void pointTracker_replacePointsRM(void *ptrClass, const int32_T *indices,
+	const float *pointData, int numPoints);
+EXTERN_C LIBMWCVSTRT_API void pointTracker_appendPoints(void *ptrClass, const float *pointData, int numPoints);
+EXTERN_C LIBMWCVSTRT_API void pointTracker_appendPointsRM(void *ptrClass, const float *pointData, int numPoints);
 EXTERN_C LIBMWCVSTRT_API void pointTracker_step(void *ptrClass, uint8_T *inImg, 
 	int32_T nRows, int32_T nCols,
 	float *outPoints, boolean_T *outValidity, double *outScores);
 EXTERN_C LIBMWCVSTRT_API void pointTracker_stepRM(void *ptrClass, uint8_T *inImg,
 	int32_T nRows, int32_T nCols,
 	float *outPoints, boolean_T *outValidity, double *outScores);
+EXTERN_C LIBMWCVSTRT_API void pointTracker_stepImage(void *ptrClass, void *ptrImage,
+	float *outPoints, boolean_T *outValidity, double *outScores);
+/* stepRecords writes one record of 4 floats per point: x, y (1-based),
+ * validity (0 or 1) and score.
+ * stepInto lets OpenCV write into caller arrays: 0-based interleaved x, y
+ * points, validity and scores of numPoints elements each. */
+EXTERN_C LIBMWCVSTRT_API void pointTracker_stepRecords(void *ptrClass, uint8_T *inImg,
+	int32_T nRows, int32_T nCols, float *outRecords);
+EXTERN_C LIBMWCVSTRT_API void pointTracker_stepInto(void *ptrClass, uint8_T *inImg,
+	int32_T nRows, int32_T nCols,
+	float *outPoints, uint8_T *outValidity, float *outScores);
 EXTERN_C LIBMWCVSTRT_API void pointTracker_getPreviousFrame(void *ptrClass, uint8_T *outFrame);
 EXTERN_C LIBMWCVSTRT_API void pointTracker_getPreviousFrameRM(void *ptrClass, uint8_T *outFrame);
 
@@ -43,4 +73,32 @@ EXTERN_C LIBMWCVSTRT_API void pointTracker_getPointsAndValidityRM(void *ptrClass
 
 EXTERN_C LIBMWCVSTRT_API void pointTracker_deleteObj(void *ptrClass);
 
+/* Bytes used by a CPU tracker of numPoints points on nRows-by-nCols frames:
+ * at the peak of a step and kept between steps. */
+EXTERN_C LIBMWCVSTRT_API void pointTracker_estimateMemory(int32_T nRows, int32_T nCols,
+	int32_T numPoints, cvstPTStruct_T *params, double *peakBytes, double *steadyBytes);
+
+/* Tracking group: point sets tracked on the same video with a single
+ * pyramid per frame. addPointSet returns the 0-based index of the new set,
+ * tracked from the current frame. Each set keeps its own parameters. */
+EXTERN_C LIBMWCVSTRT_API void pointTrackerGroup_construct(void **ptr2ptrGroup);
+EXTERN_C LIBMWCVSTRT_API void pointTrackerGroup_initialize(void *ptrGroup,
+	uint8_T *inImg, const int nRows, const int nCols);
+EXTERN_C LIBMWCVSTRT_API int32_T pointTrackerGroup_addPointSet(void *ptrGroup,
+	const float *pointData, const int numPoints, cvstPTStruct_T *params);
+EXTERN_C LIBMWCVSTRT_API int32_T pointTrackerGroup_addPointSetRM(void *ptrGroup,
+	const float *pointData, const int numPoints, cvstPTStruct_T *params);
+EXTERN_C LIBMWCVSTRT_API void pointTrackerGroup_setPoints(void *ptrGroup, int32_T setIdx,
+	const float *pointData, int numPoints, boolean_T *validityData);
+EXTERN_C LIBMWCVSTRT_API void pointTrackerGroup_setPointsRM(void *ptrGroup, int32_T setIdx,
+	const float *pointData, int numPoints, boolean_T *validityData);
+EXTERN_C LIBMWCVSTRT_API void pointTrackerGroup_step(void *ptrGroup, uint8_T *inImg,
+	int32_T nRows, int32_T nCols);
+EXTERN_C LIBMWCVSTRT_API int32_T pointTrackerGroup_getNumPoints(void *ptrGroup, int32_T setIdx);
+EXTERN_C LIBMWCVSTRT_API void pointTrackerGroup_getPoints(void *ptrGroup, int32_T setIdx,
+	float *outPoints, boolean_T *outValidity, double *outScores);
+EXTERN_C LIBMWCVSTRT_API void pointTrackerGroup_getPointsRM(void *ptrGroup, int32_T setIdx,
+	float *outPoints, boolean_T *outValidity, double *outScores);
+EXTERN_C LIBMWCVSTRT_API void pointTrackerGroup_deleteObj(void *ptrGroup);
+
 #endif
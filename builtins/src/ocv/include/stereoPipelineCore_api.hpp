@@ -0,0 +1,48 @@
+/* Copyright 2016 The MathWorks, Inc. */
+
+#ifndef _STEREOPIPELINE_
+#define _STEREOPIPELINE_
+
+#include "vision_defines.h"
+#include "disparityBMCore_api.hpp"
+#include "disparitySGBMCore_api.hpp"
+
+ EXTERN_C LIBMWCVSTRT_API void stereoPipeline_construct(void **ptr2ptrClass);
+
+ /* Rectification maps of both cameras, nRows-by-nCols, with 1-based source
+  * coordinates as in ImageTransformer. interp is 0 for nearest, 1 for
+  * linear and 2 for cubic. Q is the 4-by-4 matrix of the rectification
+  * parameters. */
+ EXTERN_C LIBMWCVSTRT_API void stereoPipeline_setMaps(void *ptrClass,
+	 const real32_T* xMap1, const real32_T* yMap1,
+	 const real32_T* xMap2, const real32_T* yMap2,
+	 int nRows, int nCols, int interp, uint8_T fillValue,
+	 const real64_T* Q);
+ EXTERN_C LIBMWCVSTRT_API void stereoPipeline_setMapsRM(void *ptrClass,
+	 const real32_T* xMap1, const real32_T* yMap1,
+	 const real32_T* xMap2, const real32_T* yMap2,
+	 int nRows, int nCols, int interp, uint8_T fillValue,
+	 const real64_T* Q);
+
+ /* Rectifies the inRows-by-inCols raw frames and writes the disparity at
+  * the size of the maps and, when xyz is not NULL, the 3-D points. */
+ EXTERN_C LIBMWCVSTRT_API void stereoPipeline_stepBM(void *ptrClass,
+	 const uint8_T* inImg1, const uint8_T* inImg2, int inRows, int inCols,
+	 real32_T* dis, real32_T* xyz,
+	 cvstDBMStruct_T *params);
+ EXTERN_C LIBMWCVSTRT_API void stereoPipeline_stepBMRM(void *ptrClass,
+	 const uint8_T* inImg1, const uint8_T* inImg2, int inRows, int inCols,
+	 real32_T* dis, real32_T* xyz,
+	 cvstDBMStruct_T *params);
+ EXTERN_C LIBMWCVSTRT_API void stereoPipeline_stepSGBM(void *ptrClass,
+	 const uint8_T* inImg1, const uint8_T* inImg2, int inRows, int inCols,
+	 real32_T* dis, real32_T* xyz,
+	 cvstDSGBMStruct_T *params);
+ EXTERN_C LIBMWCVSTRT_API void stereoPipeline_stepSGBMRM(void *ptrClass,
+	 const uint8_T* inImg1, const uint8_T* inImg2, int inRows, int inCols,
+	 real32_T* dis, real32_T* xyz,
+	 cvstDSGBMStruct_T *params);
+
+ EXTERN_C LIBMWCVSTRT_API void stereoPipeline_deleteObj(void *ptrClass);
+
+#endif
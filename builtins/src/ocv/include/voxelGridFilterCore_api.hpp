@@ -0,0 +1,54 @@
+/* Copyright 2016 The MathWorks, Inc. */
+
+#ifndef _VOXELGRIDFILTER_
+#define _VOXELGRIDFILTER_
+
+#include "vision_defines.h"
+
+/* Voxel grid filter of pcdownsample and pcmerge, see VoxelGridFilter.hpp.
+   location, color and normal are numPoints-by-3, column major; color and
+   normal are only read when hasColor and hasNormal. rangeLimits is
+   [xmin xmax ymin ymax zmin zmax]. Returns the number of output points;
+   the output is kept in *ptr2ptrResult until assignOutputDelete copies it
+   into numOut-by-3 location, color and normal and frees it. */
+EXTERN_C LIBMWCVSTRT_API
+int32_T voxelGridFilter(const double * location, const uint8_T * color,
+        const double * normal, int32_T numPoints, boolean_T hasColor,
+        boolean_T hasNormal, double gridStep, const double * rangeLimits,
+        void **ptr2ptrResult);
+
+EXTERN_C LIBMWCVSTRT_API
+int32_T voxelGridFilterRM(const double * location, const uint8_T * color,
+        const double * normal, int32_T numPoints, boolean_T hasColor,
+        boolean_T hasNormal, double gridStep, const double * rangeLimits,
+        void **ptr2ptrResult);
+
+EXTERN_C LIBMWCVSTRT_API
+int32_T voxelGridFilter_single(const float * location, const uint8_T * color,
+        const float * normal, int32_T numPoints, boolean_T hasColor,
+        boolean_T hasNormal, float gridStep, const float * rangeLimits,
+        void **ptr2ptrResult);
+
+EXTERN_C LIBMWCVSTRT_API
+int32_T voxelGridFilter_singleRM(const float * location, const uint8_T * color,
+        const float * normal, int32_T numPoints, boolean_T hasColor,
+        boolean_T hasNormal, float gridStep, const float * rangeLimits,
+        void **ptr2ptrResult);
+
+EXTERN_C LIBMWCVSTRT_API
+void voxelGridFilter_assignOutputDelete(void *ptrResult,
+        double * location, uint8_T * color, double * normal);
+
+EXTERN_C LIBMWCVSTRT_API
+void voxelGridFilter_assignOutputDeleteRM(void *ptrResult,
+        double * location, uint8_T * color, double * normal);
+
+EXTERN_C LIBMWCVSTRT_API
+void voxelGridFilter_assignOutputDelete_single(void *ptrResult,
+        float * location, uint8_T * color, float * normal);
+
+EXTERN_C LIBMWCVSTRT_API
+void voxelGridFilter_assignOutputDelete_singleRM(void *ptrResult,
+        float * location, uint8_T * color, float * normal);
+
+#endif
@@ -0,0 +1,78 @@
+///////////////////////////////////////////////////////////////////////////////
+// This file contains the shared library function calls used in codegen for
+// the inverted file of invertedImageIndex, see InvertedFile.hpp.
+///////////////////////////////////////////////////////////////////////////////
+#ifndef COMPILE_FOR_VISION_BUILTINS
+#include "invertedImageIndexCore_api.hpp"
+#include "InvertedFile.hpp"
+#include "cgProfile.hpp"
+
+///////////////////////////////////////////////////////////////////////////////
+void invertedImageIndex_construct(int32_T numWords, void **ptr2ptrIndex)
+{
+    invfile::InvertedFile *ptrIndex_ = new invfile::InvertedFile((int)numWords);
+    *ptr2ptrIndex = ptrIndex_;
+}
+
+void invertedImageIndex_addImages(void *ptrIndex, const uint32_T * image,
+        const uint32_T * word, const double * count, int32_T numEntries,
+        int32_T numImages)
+{
+    CG_PROFILE_CALL();
+    CG_PROFILE_PHASE(CG_PROFILE_COMPUTE);
+    invfile::InvertedFile *ptrIndex_ = (invfile::InvertedFile *)ptrIndex;
+    ptrIndex_->addImages(image, word, count, (int)numEntries, (int)numImages);
+}
+
+void invertedImageIndex_removeImages(void *ptrIndex, const double * indices,
+        int32_T numIndices)
+{
+    CG_PROFILE_CALL();
+    CG_PROFILE_PHASE(CG_PROFILE_COMPUTE);
+    invfile::InvertedFile *ptrIndex_ = (invfile::InvertedFile *)ptrIndex;
+    ptrIndex_->removeImages(indices, (int)numIndices);
+}
+
+int32_T invertedImageIndex_search(void *ptrIndex, const uint32_T * queryWords,
+        const double * queryCounts, int32_T numQueryWords,
+        const double * freqRange, double matchThreshold, int32_T numResults,
+        uint32_T * imageIDs, double * scores)
+{
+    CG_PROFILE_CALL();
+    CG_PROFILE_PHASE(CG_PROFILE_COMPUTE);
+    invfile::InvertedFile *ptrIndex_ = (invfile::InvertedFile *)ptrIndex;
+    return (int32_T)ptrIndex_->search(queryWords, queryCounts, (int)numQueryWords,
+        freqRange, matchThreshold, (int)numResults, imageIDs, scores);
+}
+
+int32_T invertedImageIndex_getNumImages(void *ptrIndex)
+{
+    invfile::InvertedFile *ptrIndex_ = (invfile::InvertedFile *)ptrIndex;
+    return (int32_T)ptrIndex_->getNumImages();
+}
+
+void invertedImageIndex_getWordFrequency(void *ptrIndex, double * frequency)
+{
+    CG_PROFILE_CALL();
+    CG_PROFILE_PHASE(CG_PROFILE_OUTPUT);
+    invfile::InvertedFile *ptrIndex_ = (invfile::InvertedFile *)ptrIndex;
+    ptrIndex_->getWordFrequency(frequency);
+}
+
+boolean_T invertedImageIndex_save(void *ptrIndex, const char * filename)
+{
+    invfile::InvertedFile *ptrIndex_ = (invfile::InvertedFile *)ptrIndex;
+    return ptrIndex_->save(filename);
+}
+
+boolean_T invertedImageIndex_load(void *ptrIndex, const char * filename)
+{
+    invfile::InvertedFile *ptrIndex_ = (invfile::InvertedFile *)ptrIndex;
+    return ptrIndex_->load(filename);
+}
+
+void invertedImageIndex_deleteObj(void *ptrIndex)
+{
+    delete((invfile::InvertedFile *)ptrIndex);
+}
+#endif
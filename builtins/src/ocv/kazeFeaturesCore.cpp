@@ -0,0 +1,289 @@
+///////////////////////////////////////////////////////////////////////////////
+// This file contains the shared library function calls used in codegen for
+// detectKAZEFeatures and the KAZE descriptors of extractFeatures, see
+// KazeFeatures.hpp.
+///////////////////////////////////////////////////////////////////////////////
+#ifndef COMPILE_FOR_VISION_BUILTINS
+#include "kazeFeaturesCore_api.hpp"
+#include "KazeFeatures.hpp"
+#include "mwcompactdescriptor.hpp"
+#include "cgProfile.hpp"
+
+typedef std::vector<kaze::KazeKeypoint> KazeKeypoints;
+
+static kaze::KazeParams kazeParams(real32_T threshold, boolean_T isExtended,
+        boolean_T isUpright, int32_T numOctaves, int32_T numScaleLevels,
+        int32_T diffusivity)
+{
+    kaze::KazeParams params;
+    params.numOctaves     = (int)numOctaves;
+    params.numScaleLevels = (int)numScaleLevels;
+    params.diffusivity    = (int)diffusivity;
+    params.threshold      = (float)threshold;
+    params.extended       = isExtended != 0;
+    params.upright        = isUpright != 0;
+    return params;
+}
+
+static void assignKeypoints(const KazeKeypoints &keypoints, bool isRowMajor,
+        real32_T * outLoc, real32_T * outScale, real32_T * outMetric,
+        real32_T * outOrientation, int32_T * outLayerID)
+{
+    const size_t n = keypoints.size();
+    for (size_t i = 0; i < n; i++)
+    {
+        const kaze::KazeKeypoint &kp = keypoints[i];
+        // Convert to MATLAB's 1 based indexing
+        if (isRowMajor)
+        {
+            outLoc[2 * i]     = kp.x + 1;
+            outLoc[2 * i + 1] = kp.y + 1;
+        }
+        else
+        {
+            outLoc[i]     = kp.x + 1;
+            outLoc[i + n] = kp.y + 1;
+        }
+        outScale[i]       = kp.size;
+        outMetric[i]      = kp.response;
+        outOrientation[i] = kp.angle;
+        outLayerID[i]     = (int32_T)kp.classId;
+    }
+}
+
+static int32_T extract(const uint8_T * inImg, int32_T nRows, int32_T nCols,
+        const real32_T * inLoc, const real32_T * inScale,
+        const real32_T * inMetric, const int32_T * inLayerID, int32_T numPoints,
+        bool isRowMajor, const kaze::KazeParams &params,
+        void ** ptr2ptrKeypoints, void ** ptr2ptrDescriptors)
+{
+    KazeKeypoints *keypoints = new KazeKeypoints((size_t)numPoints);
+    std::vector<float> *descriptors = new std::vector<float>();
+    *ptr2ptrKeypoints = keypoints;
+    *ptr2ptrDescriptors = descriptors;
+
+    for (int32_T i = 0; i < numPoints; i++)
+    {
+        kaze::KazeKeypoint &kp = (*keypoints)[i];
+        // Convert to OpenCV's 0 based indexing
+        kp.x = (isRowMajor ? inLoc[2 * i] : inLoc[i]) - 1;
+        kp.y = (isRowMajor ? inLoc[2 * i + 1] : inLoc[i + numPoints]) - 1;
+        kp.size     = inScale[i];
+        kp.response = inMetric[i];
+        kp.angle    = 0;
+        kp.octave   = 0;
+        kp.classId  = (int)inLayerID[i];
+    }
+
+    kaze::KazeFeatures kazeFeatures;
+    kazeFeatures.compute(inImg, (int)nRows, (int)nCols, params, *keypoints, *descriptors);
+    return numPoints;
+}
+
+int32_T kazeFeatures_detect(const uint8_T * inImg,
+        int32_T nRows, int32_T nCols, real32_T threshold,
+        int32_T numOctaves, int32_T numScaleLevels, int32_T diffusivity,
+        void ** ptr2ptrKeypoints)
+{
+    CG_PROFILE_CALL();
+    CG_PROFILE_PHASE(CG_PROFILE_COMPUTE);
+
+    KazeKeypoints *keypoints = new KazeKeypoints();
+    *ptr2ptrKeypoints = keypoints;
+
+    kaze::KazeFeatures kazeFeatures;
+    kazeFeatures.detect(inImg, (int)nRows, (int)nCols,
+        kazeParams(threshold, false, true, numOctaves, numScaleLevels, diffusivity),
+        *keypoints);
+    return (int32_T)keypoints->size();
+}
+
+void kazeFeatures_assignOutputDeleteKeypoints(void * ptrKeypoints,
+        real32_T * outLoc, real32_T * outScale, real32_T * outMetric,
+        real32_T * outOrientation, int32_T * outLayerID)
+{
+    CG_PROFILE_CALL();
+    CG_PROFILE_PHASE(CG_PROFILE_OUTPUT);
+    KazeKeypoints *keypoints = (KazeKeypoints *)ptrKeypoints;
+    assignKeypoints(*keypoints, false, outLoc, outScale, outMetric,
+        outOrientation, outLayerID);
+    delete keypoints;
+}
+
+void kazeFeatures_assignOutputDeleteKeypointsRM(void * ptrKeypoints,
+        real32_T * outLoc, real32_T * outScale, real32_T * outMetric,
+        real32_T * outOrientation, int32_T * outLayerID)
+{
+    CG_PROFILE_CALL();
+    CG_PROFILE_PHASE(CG_PROFILE_OUTPUT);
+    KazeKeypoints *keypoints = (KazeKeypoints *)ptrKeypoints;
+    assignKeypoints(*keypoints, true, outLoc, outScale, outMetric,
+        outOrientation, outLayerID);
+    delete keypoints;
+}
+
+int32_T kazeFeatures_extract(const uint8_T * inImg,
+        int32_T nRows, int32_T nCols,
+        const real32_T * inLoc, const real32_T * inScale,
+        const real32_T * inMetric, const int32_T * inLayerID, int32_T numPoints,
+        boolean_T isExtended, boolean_T isUpright,
+        int32_T numOctaves, int32_T numScaleLevels, int32_T diffusivity,
+        void ** ptr2ptrKeypoints, void ** ptr2ptrDescriptors)
+{
+    CG_PROFILE_CALL();
+    CG_PROFILE_PHASE(CG_PROFILE_COMPUTE);
+    return extract(inImg, nRows, nCols, inLoc, inScale, inMetric, inLayerID,
+        numPoints, false,
+        kazeParams(0, isExtended, isUpright, numOctaves, numScaleLevels, diffusivity),
+        ptr2ptrKeypoints, ptr2ptrDescriptors);
+}
+
+int32_T kazeFeatures_extractRM(const uint8_T * inImg,
+        int32_T nRows, int32_T nCols,
+        const real32_T * inLoc, const real32_T * inScale,
+        const real32_T * inMetric, const int32_T * inLayerID, int32_T numPoints,
+        boolean_T isExtended, boolean_T isUpright,
+        int32_T numOctaves, int32_T numScaleLevels, int32_T diffusivity,
+        void ** ptr2ptrKeypoints, void ** ptr2ptrDescriptors)
+{
+    CG_PROFILE_CALL();
+    CG_PROFILE_PHASE(CG_PROFILE_COMPUTE);
+    return extract(inImg, nRows, nCols, inLoc, inScale, inMetric, inLayerID,
+        numPoints, true,
+        kazeParams(0, isExtended, isUpright, numOctaves, numScaleLevels, diffusivity),
+        ptr2ptrKeypoints, ptr2ptrDescriptors);
+}
+
+int32_T kazeFeatures_detectAndExtract(const uint8_T * inImg,
+        int32_T nRows, int32_T nCols, real32_T threshold,
+        boolean_T isExtended, boolean_T isUpright,
+        int32_T numOctaves, int32_T numScaleLevels, int32_T diffusivity,
+        void ** ptr2ptrKeypoints, void ** ptr2ptrDescriptors)
+{
+    CG_PROFILE_CALL();
+    CG_PROFILE_PHASE(CG_PROFILE_COMPUTE);
+
+    KazeKeypoints *keypoints = new KazeKeypoints();
+    std::vector<float> *descriptors = new std::vector<float>();
+    *ptr2ptrKeypoints = keypoints;
+    *ptr2ptrDescriptors = descriptors;
+
+    kaze::KazeFeatures kazeFeatures;
+    kazeFeatures.detectAndCompute(inImg, (int)nRows, (int)nCols,
+        kazeParams(threshold, isExtended, isUpright, numOctaves, numScaleLevels, diffusivity),
+        *keypoints, *descriptors);
+    return (int32_T)keypoints->size();
+}
+
+static void writeFeatures(const std::vector<float> &descriptors, size_t n,
+        size_t dsize, bool isRowMajor, real32_T * outFeatures)
+{
+    if (isRowMajor)
+    {
+        std::copy(descriptors.begin(), descriptors.end(), outFeatures);
+    }
+    else
+    {
+        for (size_t i = 0; i < n; i++)
+            for (size_t j = 0; j < dsize; j++)
+                outFeatures[i + j * n] = descriptors[i * dsize + j];
+    }
+}
+
+// half precision or scaled int8 features, see mwcompactdescriptor.hpp
+template <typename T>
+static void writeFeatures(const std::vector<float> &descriptors, size_t n,
+        size_t dsize, bool isRowMajor, T * outFeatures)
+{
+    if (n > 0)
+        vision::compactDescriptors(&descriptors[0], (int)n, (int)dsize,
+            isRowMajor, outFeatures);
+}
+
+template <typename T>
+static void assignExtractOutputDelete(void * ptrKeypoints, void * ptrDescriptors,
+        bool isRowMajor,
+        real32_T * outLoc, real32_T * outScale, real32_T * outMetric,
+        real32_T * outOrientation, int32_T * outLayerID, T * outFeatures)
+{
+    KazeKeypoints *keypoints = (KazeKeypoints *)ptrKeypoints;
+    std::vector<float> *descriptors = (std::vector<float> *)ptrDescriptors;
+
+    assignKeypoints(*keypoints, isRowMajor, outLoc, outScale, outMetric,
+        outOrientation, outLayerID);
+
+    const size_t n = keypoints->size();
+    const size_t dsize = (n > 0) ? descriptors->size() / n : 0;
+    writeFeatures(*descriptors, n, dsize, isRowMajor, outFeatures);
+
+    delete keypoints;
+    delete descriptors;
+}
+
+void kazeFeatures_assignExtractOutputDelete(void * ptrKeypoints,
+        void * ptrDescriptors,
+        real32_T * outLoc, real32_T * outScale, real32_T * outMetric,
+        real32_T * outOrientation, int32_T * outLayerID, real32_T * outFeatures)
+{
+    CG_PROFILE_CALL();
+    CG_PROFILE_PHASE(CG_PROFILE_OUTPUT);
+    assignExtractOutputDelete(ptrKeypoints, ptrDescriptors, false, outLoc,
+        outScale, outMetric, outOrientation, outLayerID, outFeatures);
+}
+
+void kazeFeatures_assignExtractOutputDeleteRM(void * ptrKeypoints,
+        void * ptrDescriptors,
+        real32_T * outLoc, real32_T * outScale, real32_T * outMetric,
+        real32_T * outOrientation, int32_T * outLayerID, real32_T * outFeatures)
+{
+    CG_PROFILE_CALL();
+    CG_PROFILE_PHASE(CG_PROFILE_OUTPUT);
+    assignExtractOutputDelete(ptrKeypoints, ptrDescriptors, true, outLoc,
+        outScale, outMetric, outOrientation, outLayerID, outFeatures);
+}
+
+void kazeFeatures_assignExtractOutputDeleteHalf(void * ptrKeypoints,
+        void * ptrDescriptors,
+        real32_T * outLoc, real32_T * outScale, real32_T * outMetric,
+        real32_T * outOrientation, int32_T * outLayerID, uint16_T * outFeatures)
+{
+    CG_PROFILE_CALL();
+    CG_PROFILE_PHASE(CG_PROFILE_OUTPUT);
+    assignExtractOutputDelete(ptrKeypoints, ptrDescriptors, false, outLoc,
+        outScale, outMetric, outOrientation, outLayerID, outFeatures);
+}
+
+void kazeFeatures_assignExtractOutputDeleteHalfRM(void * ptrKeypoints,
+        void * ptrDescriptors,
+        real32_T * outLoc, real32_T * outScale, real32_T * outMetric,
+        real32_T * outOrientation, int32_T * outLayerID, uint16_T * outFeatures)
+{
+    CG_PROFILE_CALL();
+    CG_PROFILE_PHASE(CG_PROFILE_OUTPUT);
+    assignExtractOutputDelete(ptrKeypoints, ptrDescriptors, true, outLoc,
+        outScale, outMetric, outOrientation, outLayerID, outFeatures);
+}
+
+void kazeFeatures_assignExtractOutputDeleteInt8(void * ptrKeypoints,
+        void * ptrDescriptors,
+        real32_T * outLoc, real32_T * outScale, real32_T * outMetric,
+        real32_T * outOrientation, int32_T * outLayerID, int8_T * outFeatures)
+{
+    CG_PROFILE_CALL();
+    CG_PROFILE_PHASE(CG_PROFILE_OUTPUT);
+    assignExtractOutputDelete(ptrKeypoints, ptrDescriptors, false, outLoc,
+        outScale, outMetric, outOrientation, outLayerID, outFeatures);
+}
+
+void kazeFeatures_assignExtractOutputDeleteInt8RM(void * ptrKeypoints,
+        void * ptrDescriptors,
+        real32_T * outLoc, real32_T * outScale, real32_T * outMetric,
+        real32_T * outOrientation, int32_T * outLayerID, int8_T * outFeatures)
+{
+    CG_PROFILE_CALL();
+    CG_PROFILE_PHASE(CG_PROFILE_OUTPUT);
+    assignExtractOutputDelete(ptrKeypoints, ptrDescriptors, true, outLoc,
+        outScale, outMetric, outOrientation, outLayerID, outFeatures);
+}
+
+#endif
@@ -6,6 +6,8 @@
 #include "matchFeaturesCore_api.hpp"
 #include "flann/miniflann.hpp"
 #include "opencv2/opencv.hpp"
+#include "ApproxNNIndex.hpp"
+#include "cgProfile.hpp"
 
 ///////////////////////////////////////////////////////////////////////////////
 // Approximate NN search for floating point (single only) features. 
@@ -15,6 +17,7 @@ void findApproximateNearestNeighbors_real32(const real32_T * features1, const
         const int32_T numFeatures2, const int32_T numelInFeatureVec, const
         int32_T knn, int32_T * indexPairs, real32_T * dist) 
 {
+    CG_PROFILE_CALL();
 
     using namespace cv;
 
@@ -38,9 +41,10 @@ void findApproximateNearestNeighbors_real32(const real32_T * features1, const
     // create Mat wrappers around output data buffers.
     Mat distMat (numFeatures1, knn, CV_32F, (void *)dist);
     Mat indexMat(numFeatures1, knn, CV_32S, (void *)indexPairs);
+    CG_PROFILE_PHASE(CG_PROFILE_COMPUTE);
     // Index and search features
     flann::Index index(f2Mat, cv::flann::KDTreeIndexParams(), distType);
-    index.knnSearch(f1Mat, indexMat, distMat, knn, flann::SearchParams());
+    matchFeatures::approxKnnSearch(index, f1Mat, indexMat, distMat, knn, flann::SearchParams());
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -52,6 +56,7 @@ void findApproximateNearestNeighbors_uint8(const uint8_T * features1,
         numelInFeatureVec, const int32_T knn, int32_T * indexPairs,
         int32_T * dist) 
 {
+    CG_PROFILE_CALL();
 
     using namespace cv;
 	(void)metric;
@@ -63,8 +68,198 @@ void findApproximateNearestNeighbors_uint8(const uint8_T * features1,
     Mat distMat (numFeatures1, knn, CV_32S, (void *)dist);
     Mat indexMat(numFeatures1, knn, CV_32S, (void *)indexPairs);
 
+    CG_PROFILE_PHASE(CG_PROFILE_COMPUTE);
     // Index and search binary features usig hierachical clustering.
     flann::Index index(f2Mat, cv::flann::HierarchicalClusteringIndexParams(), cvflann::FLANN_DIST_HAMMING);
-    index.knnSearch(f1Mat, indexMat, distMat, knn, flann::SearchParams());
+    matchFeatures::approxKnnSearch(index, f1Mat, indexMat, distMat, knn, flann::SearchParams());
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Approximate NN search for binary features (uint8) using locality sensitive
+// hashing. Sublinear in the size of features2 for large databases.
+///////////////////////////////////////////////////////////////////////////////
+void findApproximateNearestNeighborsLsh_uint8(const uint8_T * features1,
+        const uint8_T * features2, const int32_T numFeatures1,
+        const int32_T numFeatures2, const int32_T numelInFeatureVec,
+        const int32_T knn, const int32_T tableNumber, const int32_T keySize,
+        const int32_T multiProbeLevel, int32_T * indexPairs, int32_T * dist)
+{
+    CG_PROFILE_CALL();
+    using namespace cv;
+
+    // create Mat wrappers around input data buffers.
+    Mat f1Mat(numFeatures1, numelInFeatureVec, CV_8U, (void *)features1);
+    Mat f2Mat(numFeatures2, numelInFeatureVec, CV_8U, (void *)features2);
+
+    // create Mat wrappers around output data buffers.
+    Mat distMat (numFeatures1, knn, CV_32S, (void *)dist);
+    Mat indexMat(numFeatures1, knn, CV_32S, (void *)indexPairs);
+
+    CG_PROFILE_PHASE(CG_PROFILE_COMPUTE);
+    flann::Index index(f2Mat, cv::flann::LshIndexParams(tableNumber, keySize, multiProbeLevel),
+        cvflann::FLANN_DIST_HAMMING);
+    matchFeatures::approxKnnSearch(index, f1Mat, indexMat, distMat, knn, flann::SearchParams());
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Persistent index: build once over features2 and query many times.
+///////////////////////////////////////////////////////////////////////////////
+void matchFeaturesIndex_construct(void **ptr2ptrIndex)
+{
+    matchFeatures::ApproxNNIndex *ptrIndex_ = new matchFeatures::ApproxNNIndex();
+    *ptr2ptrIndex = ptrIndex_;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void matchFeaturesIndex_build_real32(void *ptrIndex, const real32_T * features2,
+        const char * metric, const int32_T numFeatures2,
+        const int32_T numelInFeatureVec)
+{
+    CG_PROFILE_CALL();
+    CG_PROFILE_PHASE(CG_PROFILE_COMPUTE);
+    matchFeatures::ApproxNNIndex *ptrIndex_ = (matchFeatures::ApproxNNIndex *)ptrIndex;
+    ptrIndex_->build(features2, metric, numFeatures2, numelInFeatureVec);
+}
+
+void matchFeaturesIndex_build_uint8(void *ptrIndex, const uint8_T * features2,
+        const char * metric, const int32_T numFeatures2,
+        const int32_T numelInFeatureVec)
+{
+    CG_PROFILE_CALL();
+    CG_PROFILE_PHASE(CG_PROFILE_COMPUTE);
+    matchFeatures::ApproxNNIndex *ptrIndex_ = (matchFeatures::ApproxNNIndex *)ptrIndex;
+    ptrIndex_->build(features2, metric, numFeatures2, numelInFeatureVec);
+}
+
+void matchFeaturesIndex_buildLsh_uint8(void *ptrIndex, const uint8_T * features2,
+        const int32_T numFeatures2, const int32_T numelInFeatureVec,
+        const int32_T tableNumber, const int32_T keySize,
+        const int32_T multiProbeLevel)
+{
+    CG_PROFILE_CALL();
+    CG_PROFILE_PHASE(CG_PROFILE_COMPUTE);
+    matchFeatures::ApproxNNIndex *ptrIndex_ = (matchFeatures::ApproxNNIndex *)ptrIndex;
+    ptrIndex_->setLshParams(tableNumber, keySize, multiProbeLevel);
+    ptrIndex_->build(features2, "hamming", numFeatures2, numelInFeatureVec);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Autotuning of the index of real features, and its chosen configuration.
+///////////////////////////////////////////////////////////////////////////////
+void matchFeaturesIndex_setAutotuneParams(void *ptrIndex,
+        const real32_T targetPrecision, const real32_T buildWeight,
+        const real32_T memoryWeight, const real32_T sampleFraction)
+{
+    matchFeatures::ApproxNNIndex *ptrIndex_ = (matchFeatures::ApproxNNIndex *)ptrIndex;
+    ptrIndex_->setAutotuneParams(targetPrecision, buildWeight, memoryWeight,
+        sampleFraction);
+}
+
+boolean_T matchFeaturesIndex_getTunedConfig(void *ptrIndex, real_T * config)
+{
+    matchFeatures::ApproxNNIndex *ptrIndex_ = (matchFeatures::ApproxNNIndex *)ptrIndex;
+    return ptrIndex_->getTunedConfig(config);
+}
+
+void matchFeaturesIndex_setTunedConfig(void *ptrIndex, const real_T * config)
+{
+    matchFeatures::ApproxNNIndex *ptrIndex_ = (matchFeatures::ApproxNNIndex *)ptrIndex;
+    ptrIndex_->setTunedConfig(config);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void matchFeaturesIndex_addPoints_real32(void *ptrIndex, const real32_T * features,
+        const int32_T numFeatures, const int32_T numelInFeatureVec)
+{
+    CG_PROFILE_CALL();
+    CG_PROFILE_PHASE(CG_PROFILE_COMPUTE);
+    matchFeatures::ApproxNNIndex *ptrIndex_ = (matchFeatures::ApproxNNIndex *)ptrIndex;
+    ptrIndex_->addPoints(features, numFeatures, numelInFeatureVec);
+}
+
+void matchFeaturesIndex_addPoints_uint8(void *ptrIndex, const uint8_T * features,
+        const int32_T numFeatures, const int32_T numelInFeatureVec)
+{
+    CG_PROFILE_CALL();
+    CG_PROFILE_PHASE(CG_PROFILE_COMPUTE);
+    matchFeatures::ApproxNNIndex *ptrIndex_ = (matchFeatures::ApproxNNIndex *)ptrIndex;
+    ptrIndex_->addPoints(features, numFeatures, numelInFeatureVec);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void matchFeaturesIndex_search_real32(void *ptrIndex, const real32_T * features1,
+        const int32_T numFeatures1, const int32_T knn,
+        int32_T * indexPairs, real32_T * dist)
+{
+    CG_PROFILE_CALL();
+    CG_PROFILE_PHASE(CG_PROFILE_COMPUTE);
+    matchFeatures::ApproxNNIndex *ptrIndex_ = (matchFeatures::ApproxNNIndex *)ptrIndex;
+    ptrIndex_->knnSearch(features1, numFeatures1, knn, indexPairs, dist);
+}
+
+void matchFeaturesIndex_search_uint8(void *ptrIndex, const uint8_T * features1,
+        const int32_T numFeatures1, const int32_T knn,
+        int32_T * indexPairs, int32_T * dist)
+{
+    CG_PROFILE_CALL();
+    CG_PROFILE_PHASE(CG_PROFILE_COMPUTE);
+    matchFeatures::ApproxNNIndex *ptrIndex_ = (matchFeatures::ApproxNNIndex *)ptrIndex;
+    ptrIndex_->knnSearch(features1, numFeatures1, knn, indexPairs, dist);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Batched search with control over the recall/latency trade-off. checks is
+// the number of leaves to visit (-1 for unlimited), eps the approximation
+// tolerance. Query rows are searched in parallel.
+///////////////////////////////////////////////////////////////////////////////
+void matchFeaturesIndex_searchBatch_real32(void *ptrIndex, const real32_T * features1,
+        const int32_T numFeatures1, const int32_T knn,
+        const int32_T checks, const real32_T eps,
+        int32_T * indexPairs, real32_T * dist)
+{
+    CG_PROFILE_CALL();
+    CG_PROFILE_PHASE(CG_PROFILE_COMPUTE);
+    matchFeatures::ApproxNNIndex *ptrIndex_ = (matchFeatures::ApproxNNIndex *)ptrIndex;
+    ptrIndex_->knnSearch(features1, numFeatures1, knn, indexPairs, dist, checks, eps);
+}
+
+void matchFeaturesIndex_searchBatch_uint8(void *ptrIndex, const uint8_T * features1,
+        const int32_T numFeatures1, const int32_T knn,
+        const int32_T checks, const real32_T eps,
+        int32_T * indexPairs, int32_T * dist)
+{
+    CG_PROFILE_CALL();
+    CG_PROFILE_PHASE(CG_PROFILE_COMPUTE);
+    matchFeatures::ApproxNNIndex *ptrIndex_ = (matchFeatures::ApproxNNIndex *)ptrIndex;
+    ptrIndex_->knnSearch(features1, numFeatures1, knn, indexPairs, dist, checks, eps);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Save the index to disk and load it back. Loaded features are memory-mapped
+// read-only and shared between processes.
+///////////////////////////////////////////////////////////////////////////////
+boolean_T matchFeaturesIndex_save(void *ptrIndex, const char * filename)
+{
+    matchFeatures::ApproxNNIndex *ptrIndex_ = (matchFeatures::ApproxNNIndex *)ptrIndex;
+    return ptrIndex_->save(filename);
+}
+
+boolean_T matchFeaturesIndex_load(void *ptrIndex, const char * filename)
+{
+    matchFeatures::ApproxNNIndex *ptrIndex_ = (matchFeatures::ApproxNNIndex *)ptrIndex;
+    return ptrIndex_->load(filename);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+int32_T matchFeaturesIndex_getNumFeatures(void *ptrIndex)
+{
+    matchFeatures::ApproxNNIndex *ptrIndex_ = (matchFeatures::ApproxNNIndex *)ptrIndex;
+    return (int32_T)ptrIndex_->getNumFeatures();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void matchFeaturesIndex_deleteObj(void *ptrIndex)
+{
+    delete((matchFeatures::ApproxNNIndex *)ptrIndex);
 }
 #endif
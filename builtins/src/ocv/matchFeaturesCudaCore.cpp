@@ -0,0 +1,102 @@
+///////////////////////////////////////////////////////////////////////////////
+// This file contains the shared library function calls used in codegen for
+// matchFeatures's Exhaustive method on a CUDA device.
+///////////////////////////////////////////////////////////////////////////////
+#ifndef COMPILE_FOR_VISION_BUILTINS
+#include "matchFeaturesCore_api.hpp"
+#include "FeatureMatcherCuda.hpp"
+#include "cgProfile.hpp"
+
+using namespace matchFeatures;
+
+///////////////////////////////////////////////////////////////////////////////
+// Without CUDA support, construct returns NULL and the other functions are
+// never called.
+///////////////////////////////////////////////////////////////////////////////
+void matchFeaturesCuda_construct(void **ptr2ptrMatcher, const int32_T device)
+{
+    *ptr2ptrMatcher = NULL;
+#if defined(FEATURE_MATCHER_HAVE_CUDA)
+    if (isCudaDevice((int)device))
+    {
+        *ptr2ptrMatcher = new FeatureMatcherCuda((int)device);
+    }
+#endif
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void matchFeaturesCuda_setFeatures2_real32(void *ptrMatcher, const real32_T * features2,
+        const char * metric, const int32_T numFeatures2,
+        const int32_T numelInFeatureVec)
+{
+    CG_PROFILE_CALL();
+#if defined(FEATURE_MATCHER_HAVE_CUDA)
+    cv::Mat f2Mat(numFeatures2, numelInFeatureVec, CV_32F, (void *)features2);
+    ((FeatureMatcherCuda *)ptrMatcher)->setFeatures2(f2Mat, metric);
+#else
+    (void)ptrMatcher; (void)features2; (void)metric;
+    (void)numFeatures2; (void)numelInFeatureVec;
+#endif
+}
+
+void matchFeaturesCuda_setFeatures2_uint8(void *ptrMatcher, const uint8_T * features2,
+        const int32_T numFeatures2, const int32_T numelInFeatureVec)
+{
+    CG_PROFILE_CALL();
+#if defined(FEATURE_MATCHER_HAVE_CUDA)
+    cv::Mat f2Mat(numFeatures2, numelInFeatureVec, CV_8U, (void *)features2);
+    ((FeatureMatcherCuda *)ptrMatcher)->setFeatures2(f2Mat, "hamming");
+#else
+    (void)ptrMatcher; (void)features2; (void)numFeatures2; (void)numelInFeatureVec;
+#endif
+}
+
+///////////////////////////////////////////////////////////////////////////////
+int32_T matchFeaturesCuda_match_real32(void *ptrMatcher, const real32_T * features1,
+        const int32_T numFeatures1, const int32_T numelInFeatureVec,
+        const real32_T matchThreshold, const real32_T maxRatio,
+        const boolean_T uniqueMatches,
+        int32_T * queryIdx, int32_T * trainIdx, real32_T * matchMetric)
+{
+    CG_PROFILE_CALL();
+#if defined(FEATURE_MATCHER_HAVE_CUDA)
+    cv::Mat f1Mat(numFeatures1, numelInFeatureVec, CV_32F, (void *)features1);
+    return (int32_T)((FeatureMatcherCuda *)ptrMatcher)->match(f1Mat,
+        matchThreshold, maxRatio, uniqueMatches != 0, queryIdx, trainIdx, matchMetric);
+#else
+    (void)ptrMatcher; (void)features1; (void)numFeatures1; (void)numelInFeatureVec;
+    (void)matchThreshold; (void)maxRatio; (void)uniqueMatches;
+    (void)queryIdx; (void)trainIdx; (void)matchMetric;
+    return 0;
+#endif
+}
+
+int32_T matchFeaturesCuda_match_uint8(void *ptrMatcher, const uint8_T * features1,
+        const int32_T numFeatures1, const int32_T numelInFeatureVec,
+        const real32_T matchThreshold, const real32_T maxRatio,
+        const boolean_T uniqueMatches,
+        int32_T * queryIdx, int32_T * trainIdx, real32_T * matchMetric)
+{
+    CG_PROFILE_CALL();
+#if defined(FEATURE_MATCHER_HAVE_CUDA)
+    cv::Mat f1Mat(numFeatures1, numelInFeatureVec, CV_8U, (void *)features1);
+    return (int32_T)((FeatureMatcherCuda *)ptrMatcher)->match(f1Mat,
+        matchThreshold, maxRatio, uniqueMatches != 0, queryIdx, trainIdx, matchMetric);
+#else
+    (void)ptrMatcher; (void)features1; (void)numFeatures1; (void)numelInFeatureVec;
+    (void)matchThreshold; (void)maxRatio; (void)uniqueMatches;
+    (void)queryIdx; (void)trainIdx; (void)matchMetric;
+    return 0;
+#endif
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void matchFeaturesCuda_deleteObj(void *ptrMatcher)
+{
+#if defined(FEATURE_MATCHER_HAVE_CUDA)
+    delete ((FeatureMatcherCuda *)ptrMatcher);
+#else
+    (void)ptrMatcher;
+#endif
+}
+#endif
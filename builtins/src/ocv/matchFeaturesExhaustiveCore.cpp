@@ -0,0 +1,52 @@
+///////////////////////////////////////////////////////////////////////////////
+// This file contains the shared library function calls used in codegen for
+// matchFeatures's Exhaustive method with binary and compact features.
+///////////////////////////////////////////////////////////////////////////////
+#ifndef COMPILE_FOR_VISION_BUILTINS
+#include "matchFeaturesCore_api.hpp"
+#include "mwhamming.hpp"
+#include "mwcompactdescriptor.hpp"
+#include "cgProfile.hpp"
+
+///////////////////////////////////////////////////////////////////////////////
+// Exact NN search for binary features (uint8) using the Hamming distance.
+// All pairs are compared in cache-sized blocks of features1 x features2.
+///////////////////////////////////////////////////////////////////////////////
+void findExactNearestNeighbors_uint8(const uint8_T * features1,
+        const uint8_T * features2, const int32_T numFeatures1,
+        const int32_T numFeatures2, const int32_T numelInFeatureVec,
+        const int32_T knn, int32_T * indexPairs, int32_T * dist)
+{
+    CG_PROFILE_CALL();
+    CG_PROFILE_PHASE(CG_PROFILE_COMPUTE);
+    vision::hammingKnnMatch(features1, numFeatures1, features2, numFeatures2,
+        numelInFeatureVec, knn, indexPairs, dist);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Exact NN search for half precision (uint16 bits) or int8 SURF and KAZE
+// features using the SSD, computed on the compact types. dist is the SSD of
+// the single features the compact ones approximate.
+///////////////////////////////////////////////////////////////////////////////
+void findExactNearestNeighbors_half(const uint16_T * features1,
+        const uint16_T * features2, const int32_T numFeatures1,
+        const int32_T numFeatures2, const int32_T numelInFeatureVec,
+        const int32_T knn, int32_T * indexPairs, real32_T * dist)
+{
+    CG_PROFILE_CALL();
+    CG_PROFILE_PHASE(CG_PROFILE_COMPUTE);
+    vision::ssdKnnMatch(features1, numFeatures1, features2, numFeatures2,
+        numelInFeatureVec, knn, indexPairs, dist);
+}
+
+void findExactNearestNeighbors_int8(const int8_T * features1,
+        const int8_T * features2, const int32_T numFeatures1,
+        const int32_T numFeatures2, const int32_T numelInFeatureVec,
+        const int32_T knn, int32_T * indexPairs, real32_T * dist)
+{
+    CG_PROFILE_CALL();
+    CG_PROFILE_PHASE(CG_PROFILE_COMPUTE);
+    vision::ssdKnnMatch(features1, numFeatures1, features2, numFeatures2,
+        numelInFeatureVec, knn, indexPairs, dist);
+}
+#endif
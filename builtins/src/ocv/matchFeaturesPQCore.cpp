@@ -0,0 +1,71 @@
+///////////////////////////////////////////////////////////////////////////////
+// This file contains the shared library function calls used in codegen for
+// the product-quantized index of matchFeatures, see ProductQuantizer.hpp.
+///////////////////////////////////////////////////////////////////////////////
+#ifndef COMPILE_FOR_VISION_BUILTINS
+#include "matchFeaturesCore_api.hpp"
+#include "ProductQuantizer.hpp"
+#include "cgProfile.hpp"
+
+///////////////////////////////////////////////////////////////////////////////
+void matchFeaturesPQIndex_construct(void **ptr2ptrIndex,
+        const int32_T numSubspaces, const int32_T numLists)
+{
+    matchFeatures::PQIndex *ptrIndex_ = new matchFeatures::PQIndex((int)numSubspaces, (int)numLists);
+    *ptr2ptrIndex = ptrIndex_;
+}
+
+int32_T matchFeaturesPQIndex_train_real32(void *ptrIndex, const real32_T * features,
+        const int32_T numFeatures, const int32_T numelInFeatureVec,
+        const uint32_T seed)
+{
+    CG_PROFILE_CALL();
+    CG_PROFILE_PHASE(CG_PROFILE_COMPUTE);
+    matchFeatures::PQIndex *ptrIndex_ = (matchFeatures::PQIndex *)ptrIndex;
+    return (int32_T)ptrIndex_->train(features, (int)numFeatures,
+        (int)numelInFeatureVec, (unsigned int)seed);
+}
+
+void matchFeaturesPQIndex_addPoints_real32(void *ptrIndex, const real32_T * features,
+        const int32_T numFeatures)
+{
+    CG_PROFILE_CALL();
+    CG_PROFILE_PHASE(CG_PROFILE_COMPUTE);
+    matchFeatures::PQIndex *ptrIndex_ = (matchFeatures::PQIndex *)ptrIndex;
+    ptrIndex_->addPoints(features, (int)numFeatures);
+}
+
+void matchFeaturesPQIndex_search_real32(void *ptrIndex, const real32_T * features1,
+        const int32_T numFeatures1, const int32_T knn, const int32_T numProbes,
+        int32_T * indexPairs, real32_T * dist)
+{
+    CG_PROFILE_CALL();
+    CG_PROFILE_PHASE(CG_PROFILE_COMPUTE);
+    matchFeatures::PQIndex *ptrIndex_ = (matchFeatures::PQIndex *)ptrIndex;
+    ptrIndex_->search(features1, (int)numFeatures1, (int)knn, (int)numProbes,
+        indexPairs, dist);
+}
+
+boolean_T matchFeaturesPQIndex_save(void *ptrIndex, const char * filename)
+{
+    matchFeatures::PQIndex *ptrIndex_ = (matchFeatures::PQIndex *)ptrIndex;
+    return ptrIndex_->save(filename);
+}
+
+boolean_T matchFeaturesPQIndex_load(void *ptrIndex, const char * filename)
+{
+    matchFeatures::PQIndex *ptrIndex_ = (matchFeatures::PQIndex *)ptrIndex;
+    return ptrIndex_->load(filename);
+}
+
+int32_T matchFeaturesPQIndex_getNumFeatures(void *ptrIndex)
+{
+    matchFeatures::PQIndex *ptrIndex_ = (matchFeatures::PQIndex *)ptrIndex;
+    return (int32_T)ptrIndex_->getNumFeatures();
+}
+
+void matchFeaturesPQIndex_deleteObj(void *ptrIndex)
+{
+    delete((matchFeatures::PQIndex *)ptrIndex);
+}
+#endif
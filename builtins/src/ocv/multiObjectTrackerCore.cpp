@@ -0,0 +1,118 @@
+///////////////////////////////////////////////////////////////////////////////
+// This file contains the shared library function calls used in codegen for
+// multiple object tracking with Kalman filters, see MultiObjectTracker.hpp.
+///////////////////////////////////////////////////////////////////////////////
+#ifndef COMPILE_FOR_VISION_BUILTINS
+#include "multiObjectTrackerCore_api.hpp"
+#include "MultiObjectTracker.hpp"
+#include "cgProfile.hpp"
+
+void multiObjectTracker_construct(void ** ptr2ptrTracker)
+{
+    *ptr2ptrTracker = new tracking::MultiObjectTracker();
+}
+
+void multiObjectTracker_setup(void * ptrTracker,
+        boolean_T isConstantAcceleration, int32_T numDims,
+        const double * initialEstimateError, const double * motionNoise,
+        double measurementNoise, double costOfNonAssignment,
+        int32_T invisibleForTooLong, int32_T ageThreshold,
+        double minVisibility)
+{
+    tracking::TrackerParams params;
+    params.isConstantAcceleration = isConstantAcceleration != 0;
+    params.numDims = (int)numDims;
+    const int stateLength = params.isConstantAcceleration ? 3 : 2;
+    for (int k = 0; k < 3; k++)
+    {
+        params.initialEstimateError[k] = (k < stateLength) ? initialEstimateError[k] : 0;
+        params.motionNoise[k] = (k < stateLength) ? motionNoise[k] : 0;
+    }
+    params.measurementNoise    = measurementNoise;
+    params.costOfNonAssignment = costOfNonAssignment;
+    params.invisibleForTooLong = (int)invisibleForTooLong;
+    params.ageThreshold        = (int)ageThreshold;
+    params.minVisibility       = minVisibility;
+
+    ((tracking::MultiObjectTracker *)ptrTracker)->setParams(params);
+}
+
+int32_T multiObjectTracker_step(void * ptrTracker, const double * detections,
+        int32_T numDetections)
+{
+    CG_PROFILE_CALL();
+    CG_PROFILE_PHASE(CG_PROFILE_COMPUTE);
+    tracking::MultiObjectTracker *tracker = (tracking::MultiObjectTracker *)ptrTracker;
+    tracker->step(detections, (int)numDetections);
+    return (int32_T)tracker->numTracks();
+}
+
+static void getTracks(const tracking::MultiObjectTracker &tracker, bool isRowMajor,
+        uint32_T * ids, double * locations, double * states, uint32_T * ages,
+        uint32_T * totalVisibleCounts, uint32_T * consecutiveInvisibleCounts,
+        uint32_T * assignedDetections)
+{
+    const int n = tracker.numTracks();
+    const int numDims = tracker.params().numDims;
+    const int L = tracker.stateLength();
+    const int numStates = numDims * L;
+    for (int t = 0; t < n; t++)
+    {
+        ids[t]                        = (uint32_T)tracker.id(t);
+        ages[t]                       = (uint32_T)tracker.age(t);
+        totalVisibleCounts[t]         = (uint32_T)tracker.totalVisibleCount(t);
+        consecutiveInvisibleCounts[t] = (uint32_T)tracker.consecutiveInvisibleCount(t);
+        assignedDetections[t]         = (uint32_T)(tracker.assignedDetection(t) + 1);
+        for (int d = 0; d < numDims; d++)
+        {
+            if (isRowMajor)
+                locations[(size_t)t * numDims + d] = tracker.state(t, d, 0);
+            else
+                locations[t + (size_t)d * n] = tracker.state(t, d, 0);
+            for (int k = 0; k < L; k++)
+            {
+                const int s = d * L + k;
+                if (isRowMajor)
+                    states[(size_t)t * numStates + s] = tracker.state(t, d, k);
+                else
+                    states[t + (size_t)s * n] = tracker.state(t, d, k);
+            }
+        }
+    }
+}
+
+void multiObjectTracker_getTracks(void * ptrTracker, uint32_T * ids,
+        double * locations, double * states, uint32_T * ages,
+        uint32_T * totalVisibleCounts, uint32_T * consecutiveInvisibleCounts,
+        uint32_T * assignedDetections)
+{
+    CG_PROFILE_CALL();
+    CG_PROFILE_PHASE(CG_PROFILE_OUTPUT);
+    getTracks(*(tracking::MultiObjectTracker *)ptrTracker, false, ids, locations,
+        states, ages, totalVisibleCounts, consecutiveInvisibleCounts,
+        assignedDetections);
+}
+
+void multiObjectTracker_getTracksRM(void * ptrTracker, uint32_T * ids,
+        double * locations, double * states, uint32_T * ages,
+        uint32_T * totalVisibleCounts, uint32_T * consecutiveInvisibleCounts,
+        uint32_T * assignedDetections)
+{
+    CG_PROFILE_CALL();
+    CG_PROFILE_PHASE(CG_PROFILE_OUTPUT);
+    getTracks(*(tracking::MultiObjectTracker *)ptrTracker, true, ids, locations,
+        states, ages, totalVisibleCounts, consecutiveInvisibleCounts,
+        assignedDetections);
+}
+
+void multiObjectTracker_reset(void * ptrTracker)
+{
+    ((tracking::MultiObjectTracker *)ptrTracker)->reset();
+}
+
+void multiObjectTracker_deleteObj(void * ptrTracker)
+{
+    delete ((tracking::MultiObjectTracker *)ptrTracker);
+}
+
+#endif
@@ -52,10 +52,14 @@
 #include <stdlib.h>
 
 #include "fast_score_mw.hpp" // for FastFeatureDetector2MW
+#include "agast_score_mw.hpp" // for getAgastScoreFunc
+#include "cgPyramidCache.hpp"
 
 namespace cv
 {
 
+class MWBriskScaleSpace;
+
 class MWBRISK_Impl : public MWBRISK
 {
 public:
@@ -68,6 +72,7 @@ public:
 
     int descriptorSize() const
     {
+        buildKernel();
         return strings_;
     }
 
@@ -91,6 +96,8 @@ public:
     // call this to generate the kernel:
     // circle of radius r (pixels), with n points;
     // short pairings with dMax, long pairings with dMin
+    // TMW edit: only the parameters are kept here; the look-up tables are
+    // built by buildKernel on first use, as detection does not need them
     void generateKernel(const std::vector<float> &radiusList,
         const std::vector<int> &numberList, float dMax=5.85f, float dMin=8.2f,
         const std::vector<int> &indexChange=std::vector<int>());
@@ -105,6 +112,10 @@ public:
 
 protected:
 
+    // builds the look-up tables of the pattern, once
+    void buildKernel() const;
+    void releaseKernel();
+
     void computeKeypointsNoOrientation(InputArray image, InputArray mask, std::vector<KeyPoint>& keypoints) const;
     void computeDescriptorsAndOrOrientation(InputArray image, InputArray mask, std::vector<KeyPoint>& keypoints,
                                        OutputArray descriptors, bool doDescriptors, bool doOrientation,
@@ -137,26 +148,35 @@ protected:
                 const cv::Mat& integral,const float key_x,
                 const float key_y, const unsigned int scale,
                 const unsigned int rot, const unsigned int point) const;
-    // pattern properties
-    MWBriskPatternPoint* patternPoints_;     //[i][rotation][scale]
-    unsigned int points_;                 // total number of collocation points
-    float* scaleList_;                     // lists the scaling per scale index [scale]
-    unsigned int* sizeList_;             // lists the total pattern size per scale index [scale]
+    // pattern parameters of generateKernel
+    std::vector<float> radiusList_;
+    std::vector<int> numberList_;
+    std::vector<int> indexChange_;
+
+    // pattern properties, built by buildKernel; NULL until then
+    mutable MWBriskPatternPoint* patternPoints_;     //[i][rotation][scale]
+    mutable unsigned int points_;                 // total number of collocation points
+    mutable float* scaleList_;                     // lists the scaling per scale index [scale]
+    mutable unsigned int* sizeList_;             // lists the total pattern size per scale index [scale]
     static const unsigned int scales_;    // scales discretization
     static const float scalerange_;     // span of sizes 40->4 Octaves - else, this needs to be adjusted...
     static const unsigned int n_rot_;    // discretization of the rotation look-up
 
     // pairs
-    int strings_;                        // number of uchars the descriptor consists of
+    mutable int strings_;                        // number of uchars the descriptor consists of
     float dMax_;                         // short pair maximum distance
     float dMin_;                         // long pair maximum distance
-    MWBriskShortPair* shortPairs_;         // d<_dMax
-    MWBriskLongPair* longPairs_;             // d>_dMin
-    unsigned int noShortPairs_;         // number of shortParis
-    unsigned int noLongPairs_;             // number of longParis
+    mutable MWBriskShortPair* shortPairs_;         // d<_dMax
+    mutable MWBriskLongPair* longPairs_;             // d>_dMin
+    mutable unsigned int noShortPairs_;         // number of shortParis
+    mutable unsigned int noLongPairs_;             // number of longParis
 
     // general
     static const float basicSize_;
+
+    // the pyramid of the last image, whose layer buffers are reused while
+    // the image size does not change; detection is not reentrant
+    mutable Ptr<MWBriskScaleSpace> scaleSpace_;
 };
 
 
@@ -175,6 +195,9 @@ public:
   // derive a layer
   MWBriskLayer(const MWBriskLayer& layer, int mode);
 
+  // refill a layer of the same size, in its own buffers
+  void setImage(const cv::Mat& img);
+
   // Agast without non-max suppression
   void
   getAgastPoints(int threshold, std::vector<cv::KeyPoint>& keypoints);
@@ -220,6 +243,9 @@ private:
   // access gray values (smoothed/interpolated)
   inline int
   value(const cv::Mat& mat, float xf, float yf, float scale) const;
+  // TMW edit: scores of the method of getAgastScoreMethod
+  void
+  selectScores();
   // the image
   cv::Mat img_;
   // its Agast scores
@@ -231,6 +257,8 @@ private:
   cv::Ptr<cv::AgastFeatureDetector> oast_9_16_;
   int pixel_5_8_[25];
   int pixel_9_16_[25];
+  cv::AgastScoreFunc score_5_8_;
+  cv::AgastScoreFunc score_9_16_;
 };
 
 class CV_EXPORTS MWBriskScaleSpace
@@ -300,6 +328,8 @@ const float MWBriskScaleSpace::basicSize_ = 12.0f;
 
 // constructors
 MWBRISK_Impl::MWBRISK_Impl(int thresh, int octaves_in, float patternScale)
+  : patternPoints_(0), points_(0), scaleList_(0), sizeList_(0), strings_(0),
+    shortPairs_(0), longPairs_(0), noShortPairs_(0), noLongPairs_(0)
 {
   threshold = thresh;
   octaves = octaves_in;
@@ -334,6 +364,8 @@ MWBRISK_Impl::MWBRISK_Impl(const std::vector<float> &radiusList,
                        const std::vector<int> &numberList,
                        float dMax, float dMin,
                        const std::vector<int> indexChange)
+  : patternPoints_(0), points_(0), scaleList_(0), sizeList_(0), strings_(0),
+    shortPairs_(0), longPairs_(0), noShortPairs_(0), noLongPairs_(0)
 {
   generateKernel(radiusList, numberList, dMax, dMin, indexChange);
   threshold = 20;
@@ -350,13 +382,45 @@ MWBRISK_Impl::generateKernel(const std::vector<float> &radiusList,
                            float dMax, float dMin,
                            const std::vector<int>& _indexChange)
 {
-  std::vector<int> indexChange = _indexChange;
+  CV_Assert(radiusList.size() != 0 && radiusList.size() == numberList.size());
+  releaseKernel();
+  radiusList_ = radiusList;
+  numberList_ = numberList;
+  indexChange_ = _indexChange;
   dMax_ = dMax;
   dMin_ = dMin;
+}
+
+void
+MWBRISK_Impl::releaseKernel()
+{
+  delete[] patternPoints_;
+  delete[] shortPairs_;
+  delete[] longPairs_;
+  delete[] scaleList_;
+  delete[] sizeList_;
+  patternPoints_ = 0;
+  shortPairs_ = 0;
+  longPairs_ = 0;
+  scaleList_ = 0;
+  sizeList_ = 0;
+}
+
+// TMW edit: the body of the original generateKernel. The pattern takes
+// points * 64 scales * 1024 rotations points, with a sine and a cosine
+// each, which is most of the cost of constructing a detector.
+void
+MWBRISK_Impl::buildKernel() const
+{
+  if (patternPoints_)
+    return;
+
+  const std::vector<float> &radiusList = radiusList_;
+  const std::vector<int> &numberList = numberList_;
+  std::vector<int> indexChange = indexChange_;
 
   // get the total number of points
   const int rings = (int)radiusList.size();
-  CV_Assert(radiusList.size() != 0 && radiusList.size() == numberList.size());
   points_ = 0; // remember the total number of points
   for (int ring = 0; ring < rings; ring++)
   {
@@ -671,14 +735,22 @@ MWBRISK_Impl::computeDescriptorsAndOrOrientation(InputArray _image, InputArray _
                                      OutputArray _descriptors, bool doDescriptors, bool doOrientation,
                                      bool useProvidedKeypoints) const
 {
+  buildKernel();
+
   Mat image = _image.getMat(), mask = _mask.getMat();
   if( image.type() != CV_8UC1 )
       cvtColor(image, image, COLOR_BGR2GRAY);
 
   if (!useProvidedKeypoints)
   {
-    doOrientation = true;
     computeKeypointsNoOrientation(_image, _mask, keypoints);
+    // TMW Edit: when upright, describe the detected keypoints at 0 degree, as
+    // the keypoints of detect are when they are passed back to compute.
+    if (!doOrientation)
+    {
+      for (size_t k = 0; k < keypoints.size(); k++)
+        keypoints[k].angle = 0;
+    }
   }
 
   //Remove keypoints very close to the border
@@ -717,8 +789,8 @@ MWBRISK_Impl::computeDescriptorsAndOrOrientation(InputArray _image, InputArray _
 
   // first, calculate the integral image over the whole image:
   // current integral image
-  cv::Mat _integral; // the integral image
-  cv::integral(image, _integral);
+  cv::Mat _integral; // the integral image, shared with the other cores
+  vision::PyramidCache::acquire(image)->getIntegrals(0, _integral);
 
   int* _values = new int[points_]; // for temporary use
 
@@ -855,11 +927,7 @@ MWBRISK_Impl::computeDescriptorsAndOrOrientation(InputArray _image, InputArray _
 
 MWBRISK_Impl::~MWBRISK_Impl()
 {
-  delete[] patternPoints_;
-  delete[] shortPairs_;
-  delete[] longPairs_;
-  delete[] scaleList_;
-  delete[] sizeList_;
+  releaseKernel();
 }
 
 void
@@ -869,7 +937,9 @@ MWBRISK_Impl::computeKeypointsNoOrientation(InputArray _image, InputArray _mask,
   if( image.type() != CV_8UC1 )
       cvtColor(_image, image, COLOR_BGR2GRAY);
 
-  MWBriskScaleSpace mwbriskScaleSpace(octaves);
+  if (scaleSpace_.empty())
+    scaleSpace_ = makePtr<MWBriskScaleSpace>(octaves);
+  MWBriskScaleSpace& mwbriskScaleSpace = *scaleSpace_;
   mwbriskScaleSpace.constructPyramid(image);
   mwbriskScaleSpace.getKeypoints(threshold, keypoints);
 
@@ -893,22 +963,40 @@ MWBriskScaleSpace::~MWBriskScaleSpace()
 void
 MWBriskScaleSpace::constructPyramid(const cv::Mat& image)
 {
+  const int octaves2 = layers_;
 
-  // set correct size:
-  pyramid_.clear();
+  // the layers are levels of the pyramid of the frame shared with the other
+  // cores: layer 1 is two thirds of layer 0, layer i half of layer i-2
+  vision::FramePyramidPtr frame = vision::PyramidCache::acquire(image);
+  std::vector<int> levels(octaves2, 0);
+  if (octaves2 > 1)
+  {
+    levels[1] = frame->getLevel(0, cv::Size(2 * (image.cols / 3), 2 * (image.rows / 3)), INTER_AREA);
+  }
+  for (int i = 2; i < octaves2; i++)
+  {
+    const cv::Mat& src = frame->getImage(levels[i - 2]);
+    levels[i] = frame->getLevel(levels[i - 2], cv::Size(src.cols / 2, src.rows / 2), INTER_AREA);
+  }
 
-  // fill the pyramid:
-  pyramid_.push_back(MWBriskLayer(image.clone()));
-  if (layers_ > 1)
+  // same size as the previous image: refill the layers in place
+  if (!pyramid_.empty() && (int)pyramid_.size() == layers_ && pyramid_[0].img().size() == image.size())
   {
-    pyramid_.push_back(MWBriskLayer(pyramid_.back(), MWBriskLayer::CommonParams::TWOTHIRDSAMPLE));
+    for (int i = 0; i < octaves2; i++)
+    {
+      pyramid_[i].setImage(frame->getImage(levels[i]));
+    }
+    return;
   }
-  const int octaves2 = layers_;
 
-  for (uchar i = 2; i < octaves2; i += 2)
+  // set correct size:
+  pyramid_.clear();
+
+  // fill the pyramid, with the scales and offsets of derived layers:
+  for (int i = 0; i < octaves2; i++)
   {
-    pyramid_.push_back(MWBriskLayer(pyramid_[i - 2], MWBriskLayer::CommonParams::HALFSAMPLE));
-    pyramid_.push_back(MWBriskLayer(pyramid_[i - 1], MWBriskLayer::CommonParams::HALFSAMPLE));
+    const float scale = (i % 2 ? 1.5f : 1.0f) * (float)(1 << (i / 2));
+    pyramid_.push_back(MWBriskLayer(frame->getImage(levels[i]).clone(), scale, 0.5f * scale - 0.5f));
   }
 }
 
@@ -2127,6 +2215,7 @@ MWBriskLayer::MWBriskLayer(const cv::Mat& img_in, float scale_in, float offset_i
   oast_9_16_ = AgastFeatureDetector::create(1, false, AgastFeatureDetector::OAST_9_16);
   makeAgastOffsets(pixel_5_8_, (int)img_.step, AgastFeatureDetector::AGAST_5_8);
   makeAgastOffsets(pixel_9_16_, (int)img_.step, AgastFeatureDetector::OAST_9_16);
+  selectScores();
 }
 // derive a layer
 MWBriskLayer::MWBriskLayer(const MWBriskLayer& layer, int mode)
@@ -2149,6 +2238,23 @@ MWBriskLayer::MWBriskLayer(const MWBriskLayer& layer, int mode)
   oast_9_16_ = AgastFeatureDetector::create(1, false, AgastFeatureDetector::OAST_9_16);
   makeAgastOffsets(pixel_5_8_, (int)img_.step, AgastFeatureDetector::AGAST_5_8);
   makeAgastOffsets(pixel_9_16_, (int)img_.step, AgastFeatureDetector::OAST_9_16);
+  selectScores();
+}
+
+void
+MWBriskLayer::setImage(const cv::Mat& img_in)
+{
+  CV_Assert(img_in.size() == img_.size());
+  img_in.copyTo(img_);
+  scores_ = (uchar)0;
+  selectScores();
+}
+
+void
+MWBriskLayer::selectScores()
+{
+  score_5_8_ = getAgastScoreFunc(AgastFeatureDetector::AGAST_5_8);
+  score_9_16_ = getAgastScoreFunc(AgastFeatureDetector::OAST_9_16);
 }
 
 // Agast
@@ -2178,7 +2284,7 @@ MWBriskLayer::getAgastScore(int x, int y, int threshold) const
   {
     return score;
   }
-  score = (uchar)agast_cornerScore<AgastFeatureDetector::OAST_9_16>(&img_.at<uchar>(y, x), pixel_9_16_, threshold - 1);
+  score = (uchar)score_9_16_(&img_.at<uchar>(y, x), pixel_9_16_, threshold - 1);
   if (score < threshold)
     score = 0;
   return score;
@@ -2191,7 +2297,7 @@ MWBriskLayer::getAgastScore_5_8(int x, int y, int threshold) const
     return 0;
   if (x >= img_.cols - 2 || y >= img_.rows - 2)
     return 0;
-  int score = agast_cornerScore<AgastFeatureDetector::AGAST_5_8>(&img_.at<uchar>(y, x), pixel_5_8_, threshold - 1);
+  int score = score_5_8_(&img_.at<uchar>(y, x), pixel_5_8_, threshold - 1);
   if (score < threshold)
     score = 0;
   return score;
@@ -45,7 +45,11 @@
 
 #include "mwobjdetect.hpp" // for MWFeatureEvaluator, MWCascadeClassifier
 #include "mwcascadedetect.hpp"
+#include "MappedFile.hpp"
 #include "opencv2/core.hpp" // for contents of persistence.cpp.
+#include "cgProfile.hpp"
+#include "cgThreadPool.hpp"
+#include "cgPyramidCache.hpp"
 
 #if defined (LOG_CASCADE_STATISTIC)
 struct Logger
@@ -232,12 +236,29 @@ public:
         iterMax = maxIter;
         modeEps = eps;
 
-        for (unsigned i = 0; i<positionsV.size(); i++)
+        // the kernel of each position does not depend on the point it is
+        // evaluated at
+        kernelV.resize(positionsCount);
+        scaledPositionsV.resize(positionsCount);
+        kernelNormV.resize(positionsCount);
+        for (int i = 0; i < positionsCount; i++)
         {
-            meanshiftV[i] = getNewValue(positionsV[i]);
-            distanceV[i] = moveToMode(meanshiftV[i]);
-            meanshiftV[i] -= positionsV[i];
+            Point3d sPt = densityKernel;
+            sPt.x *= exp(positionsV[i].z);
+            sPt.y *= exp(positionsV[i].z);
+            kernelV[i] = sPt;
+            scaledPositionsV[i] = Point3d(positionsV[i].x / sPt.x,
+                positionsV[i].y / sPt.y, positionsV[i].z / sPt.z);
+            kernelNormV[i] = std::sqrt(sPt.dot(Point3d(1,1,1)));
         }
+
+        // each position climbs to its mode on its own
+#ifdef PARALLEL
+        cgParallelForWorkers(positionsCount, [&](int, int i) { climbToMode(i); });
+#else
+        for (int i = 0; i < positionsCount; i++)
+            climbToMode(i);
+#endif
     }
 
     void getModes(vector<Point3d>& modesV, vector<double>& resWeightsV, const double eps)
@@ -268,6 +289,13 @@ public:
     }
 
 protected:
+    void climbToMode(int i)
+    {
+        meanshiftV[i] = getNewValue(positionsV[i]);
+        distanceV[i] = moveToMode(meanshiftV[i]);
+        meanshiftV[i] -= positionsV[i];
+    }
+
     vector<Point3d> positionsV;
     vector<double> weightsV;
 
@@ -276,6 +304,9 @@ protected:
 
     vector<Point3d> meanshiftV;
     vector<Point3d> distanceV;
+    vector<Point3d> kernelV;
+    vector<Point3d> scaledPositionsV;
+    vector<double> kernelNormV;
     int iterMax;
     double modeEps;
 
@@ -285,22 +316,15 @@ protected:
         Point3d ratPoint(.0);
         for (size_t i=0; i<positionsV.size(); i++)
         {
-            Point3d aPt= positionsV[i];
+            const Point3d& aPt = scaledPositionsV[i];
             Point3d bPt = inPt;
-            Point3d sPt = densityKernel;
-
-            sPt.x *= exp(aPt.z);
-            sPt.y *= exp(aPt.z);
-
-            aPt.x /= sPt.x;
-            aPt.y /= sPt.y;
-            aPt.z /= sPt.z;
+            const Point3d& sPt = kernelV[i];
 
             bPt.x /= sPt.x;
             bPt.y /= sPt.y;
             bPt.z /= sPt.z;
 
-            double w = (weightsV[i])*std::exp(-((aPt-bPt).dot(aPt-bPt))/2)/std::sqrt(sPt.dot(Point3d(1,1,1)));
+            double w = (weightsV[i])*std::exp(-((aPt-bPt).dot(aPt-bPt))/2)/kernelNormV[i];
 
             resPoint += w*aPt;
 
@@ -320,10 +344,7 @@ protected:
         for (size_t i=0; i<positionsV.size(); i++)
         {
             Point3d aPt = positionsV[i];
-            Point3d sPt = densityKernel;
-
-            sPt.x *= exp(aPt.z);
-            sPt.y *= exp(aPt.z);
+            const Point3d& sPt = kernelV[i];
 
             aPt -= inPt;
 
@@ -331,7 +352,7 @@ protected:
 	    aPt.y /= sPt.y;
 	    aPt.z /= sPt.z;
     		
-	    sumW+=(weightsV[i])*std::exp(-(aPt.dot(aPt))/2)/std::sqrt(sPt.dot(Point3d(1,1,1)));
+	    sumW+=(weightsV[i])*std::exp(-(aPt.dot(aPt))/2)/kernelNormV[i];
 	    }
             // tmw edit: normalize by number of points as should be done when evaluating the density estimate
             if (positionsV.empty())
@@ -441,10 +462,25 @@ void MWgroupRectangles_meanshift(vector<Rect>& rectList, vector<double>& foundWe
 
 MWFeatureEvaluator::~MWFeatureEvaluator() {}
 bool MWFeatureEvaluator::read(const FileNode&) {return true;}
+bool MWFeatureEvaluator::writeBinary(vector<uchar>&) const { return false; }
+bool MWFeatureEvaluator::readBinary(const uchar*, size_t) { return false; }
+
+// appends count elements to the records of the binary cascade format
+template<typename T> static void appendBinary( vector<uchar>& buf, const T* elems, size_t count )
+{
+    size_t pos = buf.size();
+    buf.resize( pos + count*sizeof(T) );
+    if( count > 0 )
+        memcpy( &buf[pos], elems, count*sizeof(T) );
+}
 Ptr<MWFeatureEvaluator> MWFeatureEvaluator::clone() const { return Ptr<MWFeatureEvaluator>(); }
+Ptr<MWFeatureEvaluator> MWFeatureEvaluator::cloneDetached() const { return Ptr<MWFeatureEvaluator>(); }
 int MWFeatureEvaluator::getFeatureType() const {return -1;}
 bool MWFeatureEvaluator::setImage(const Mat&, Size) {return true;}
 bool MWFeatureEvaluator::setWindow(Point) { return true; }
+bool MWFeatureEvaluator::setWindows(Point, int) { return false; }
+bool MWFeatureEvaluator::setIntegrals(const Mat& img, const Mat&, const Mat&, const Mat&, Size origWinSize)
+{ return setImage(img, origWinSize); }
 double MWFeatureEvaluator::calcOrd(int) const { return 0.; }
 int MWFeatureEvaluator::calcCat(int) const { return 0; }
 
@@ -498,6 +534,60 @@ bool HaarEvaluator::read(const FileNode& node)
     return true;
 }
 
+// binary cascade record of a Haar feature
+struct HaarFeatureRecord
+{
+    int tilted;
+    int rect[HaarEvaluator::MWFeature::RECT_NUM][4];
+    float weight[HaarEvaluator::MWFeature::RECT_NUM];
+};
+
+bool HaarEvaluator::writeBinary( vector<uchar>& buf ) const
+{
+    for( size_t i = 0; i < features->size(); i++ )
+    {
+        const MWFeature& f = (*features)[i];
+        HaarFeatureRecord rec;
+        rec.tilted = f.tilted ? 1 : 0;
+        for( int ri = 0; ri < MWFeature::RECT_NUM; ri++ )
+        {
+            rec.rect[ri][0] = f.rect[ri].r.x;
+            rec.rect[ri][1] = f.rect[ri].r.y;
+            rec.rect[ri][2] = f.rect[ri].r.width;
+            rec.rect[ri][3] = f.rect[ri].r.height;
+            rec.weight[ri] = f.rect[ri].weight;
+        }
+        appendBinary( buf, &rec, 1 );
+    }
+    return true;
+}
+
+bool HaarEvaluator::readBinary( const uchar* buf, size_t size )
+{
+    size_t n = size/sizeof(HaarFeatureRecord);
+    if( n == 0 || size % sizeof(HaarFeatureRecord) != 0 )
+        return false;
+    features->resize(n);
+    featuresPtr = &(*features)[0];
+    hasTiltedFeatures = false;
+
+    for( size_t i = 0; i < n; i++ )
+    {
+        HaarFeatureRecord rec;
+        memcpy( &rec, buf + i*sizeof(rec), sizeof(rec) );
+        MWFeature& f = featuresPtr[i];
+        f.tilted = rec.tilted != 0;
+        for( int ri = 0; ri < MWFeature::RECT_NUM; ri++ )
+        {
+            f.rect[ri].r = Rect(rec.rect[ri][0], rec.rect[ri][1], rec.rect[ri][2], rec.rect[ri][3]);
+            f.rect[ri].weight = rec.weight[ri];
+        }
+        if( f.tilted )
+            hasTiltedFeatures = true;
+    }
+    return true;
+}
+
 Ptr<MWFeatureEvaluator> HaarEvaluator::clone() const
 {
     HaarEvaluator* ret = new HaarEvaluator;
@@ -515,6 +605,17 @@ Ptr<MWFeatureEvaluator> HaarEvaluator::clone() const
     return ret;
 }
 
+Ptr<MWFeatureEvaluator> HaarEvaluator::cloneDetached() const
+{
+    // setImage updates the pointers of the features, so they are copied
+    HaarEvaluator* ret = new HaarEvaluator;
+    ret->origWinSize = origWinSize;
+    ret->features = new vector<MWFeature>(*features);
+    ret->featuresPtr = &(*ret->features)[0];
+    ret->hasTiltedFeatures = hasTiltedFeatures;
+    return ret;
+}
+
 bool HaarEvaluator::setImage( const Mat &image, Size _origWinSize )
 {
     int rn = image.rows+1, cn = image.cols+1;
@@ -537,10 +638,30 @@ bool HaarEvaluator::setImage( const Mat &image, Size _origWinSize )
     if( hasTiltedFeatures )
     {
         tilted = Mat(rn, cn, CV_32S, tilted0.data);
-        integral(image, sum, sqsum, tilted);
+        vision::computeIntegrals(image, sum, &sqsum, &tilted);
     }
     else
-        integral(image, sum, sqsum);
+        vision::computeIntegrals(image, sum, &sqsum);
+    return setIntegrals( image, sum, sqsum, tilted, origWinSize );
+}
+
+bool HaarEvaluator::setIntegrals( const Mat& image, const Mat& _sum, const Mat& _sqsum,
+                                  const Mat& _tilted, Size _origWinSize )
+{
+    origWinSize = _origWinSize;
+    normrect = Rect(1, 1, origWinSize.width-2, origWinSize.height-2);
+
+    if (image.cols < origWinSize.width || image.rows < origWinSize.height)
+        return false;
+    if( _sum.type() != CV_32S || _sqsum.type() != CV_64F ||
+        (hasTiltedFeatures && (_tilted.type() != CV_32S || _tilted.size() != _sum.size())) ||
+        _sum.rows != image.rows+1 || _sum.cols != image.cols+1 || _sqsum.size() != _sum.size() )
+        return setImage( image, _origWinSize );
+
+    sum = _sum;
+    sqsum = _sqsum;
+    tilted = hasTiltedFeatures ? _tilted : Mat();
+
     const int* sdata = (const int*)sum.data;
     const double* sqdata = (const double*)sqsum.data;
     size_t sumStep = sum.step/sizeof(sdata[0]);
@@ -579,6 +700,19 @@ bool  HaarEvaluator::setWindow( Point pt )
     return true;
 }
 
+bool HaarEvaluator::setWindows( Point pt, int dx )
+{
+    // the last window is the rightmost one
+    for( int k = NUM_LANES - 1; k >= 0; k-- )
+    {
+        if( !setWindow( Point(pt.x + k*dx, pt.y) ) )
+            return false;
+        laneNormFactor[k] = varianceNormFactor;
+    }
+    laneStep = dx;
+    return true;
+}
+
 //----------------------------------------------  LBPEvaluator -------------------------------------
 bool LBPEvaluator::MWFeature :: read(const FileNode& node )
 {
@@ -609,6 +743,40 @@ bool LBPEvaluator::read( const FileNode& node )
     return true;
 }
 
+// binary cascade record of an LBP feature: the block rectangle
+struct LBPFeatureRecord
+{
+    int rect[4];
+};
+
+bool LBPEvaluator::writeBinary( vector<uchar>& buf ) const
+{
+    for( size_t i = 0; i < features->size(); i++ )
+    {
+        const Rect& r = (*features)[i].rect;
+        LBPFeatureRecord rec = { { r.x, r.y, r.width, r.height } };
+        appendBinary( buf, &rec, 1 );
+    }
+    return true;
+}
+
+bool LBPEvaluator::readBinary( const uchar* buf, size_t size )
+{
+    size_t n = size/sizeof(LBPFeatureRecord);
+    if( n == 0 || size % sizeof(LBPFeatureRecord) != 0 )
+        return false;
+    features->resize(n);
+    featuresPtr = &(*features)[0];
+
+    for( size_t i = 0; i < n; i++ )
+    {
+        LBPFeatureRecord rec;
+        memcpy( &rec, buf + i*sizeof(rec), sizeof(rec) );
+        featuresPtr[i].rect = Rect(rec.rect[0], rec.rect[1], rec.rect[2], rec.rect[3]);
+    }
+    return true;
+}
+
 Ptr<MWFeatureEvaluator> LBPEvaluator::clone() const
 {
     LBPEvaluator* ret = new LBPEvaluator;
@@ -621,6 +789,15 @@ Ptr<MWFeatureEvaluator> LBPEvaluator::clone() const
     return ret;
 }
 
+Ptr<MWFeatureEvaluator> LBPEvaluator::cloneDetached() const
+{
+    LBPEvaluator* ret = new LBPEvaluator;
+    ret->origWinSize = origWinSize;
+    ret->features = new vector<MWFeature>(*features);
+    ret->featuresPtr = &(*ret->features)[0];
+    return ret;
+}
+
 bool LBPEvaluator::setImage( const Mat& image, Size _origWinSize )
 {
     int rn = image.rows+1, cn = image.cols+1;
@@ -632,7 +809,20 @@ bool LBPEvaluator::setImage( const Mat& image, Size _origWinSize )
     if( sum0.rows < rn || sum0.cols < cn )
         sum0.create(rn, cn, CV_32S);
     sum = Mat(rn, cn, CV_32S, sum0.data);
-    integral(image, sum);
+    vision::computeIntegrals(image, sum);
+    return setIntegrals( image, sum, Mat(), Mat(), origWinSize );
+}
+
+bool LBPEvaluator::setIntegrals( const Mat& image, const Mat& _sum, const Mat&, const Mat&,
+                                 Size _origWinSize )
+{
+    origWinSize = _origWinSize;
+
+    if( image.cols < origWinSize.width || image.rows < origWinSize.height )
+        return false;
+    if( _sum.type() != CV_32S || _sum.rows != image.rows+1 || _sum.cols != image.cols+1 )
+        return setImage( image, _origWinSize );
+    sum = _sum;
 
     size_t fi, nfeatures = features->size();
 
@@ -651,6 +841,14 @@ bool LBPEvaluator::setWindow( Point pt )
     return true;
 }
 
+bool LBPEvaluator::setWindows( Point pt, int dx )
+{
+    if( !setWindow( Point(pt.x + (NUM_LANES - 1)*dx, pt.y) ) || !setWindow( pt ) )
+        return false;
+    laneStep = dx;
+    return true;
+}
+
 //----------------------------------------------  HOGEvaluator ---------------------------------------
 bool HOGEvaluator::MWFeature :: read( const FileNode& node )
 {
@@ -690,6 +888,49 @@ bool HOGEvaluator::read( const FileNode& node )
     return true;
 }
 
+// binary cascade record of a HOG feature: the first cell and the component
+struct HOGFeatureRecord
+{
+    int rect[4];
+    int featComponent;
+};
+
+bool HOGEvaluator::writeBinary( vector<uchar>& buf ) const
+{
+    for( size_t i = 0; i < features->size(); i++ )
+    {
+        const MWFeature& f = (*features)[i];
+        HOGFeatureRecord rec = { { f.rect[0].x, f.rect[0].y, f.rect[0].width, f.rect[0].height },
+                                 f.featComponent };
+        appendBinary( buf, &rec, 1 );
+    }
+    return true;
+}
+
+bool HOGEvaluator::readBinary( const uchar* buf, size_t size )
+{
+    size_t n = size/sizeof(HOGFeatureRecord);
+    if( n == 0 || size % sizeof(HOGFeatureRecord) != 0 )
+        return false;
+    features->resize(n);
+    featuresPtr = &(*features)[0];
+
+    for( size_t i = 0; i < n; i++ )
+    {
+        HOGFeatureRecord rec;
+        memcpy( &rec, buf + i*sizeof(rec), sizeof(rec) );
+        MWFeature& f = featuresPtr[i];
+        // the 4 cells of MWFeature::read
+        Rect r(rec.rect[0], rec.rect[1], rec.rect[2], rec.rect[3]);
+        f.rect[0] = r;
+        f.rect[1] = Rect(r.x + r.width, r.y, r.width, r.height);
+        f.rect[2] = Rect(r.x, r.y + r.height, r.width, r.height);
+        f.rect[3] = Rect(r.x + r.width, r.y + r.height, r.width, r.height);
+        f.featComponent = rec.featComponent;
+    }
+    return true;
+}
+
 Ptr<MWFeatureEvaluator> HOGEvaluator::clone() const
 {
     HOGEvaluator* ret = new HOGEvaluator;
@@ -702,6 +943,15 @@ Ptr<MWFeatureEvaluator> HOGEvaluator::clone() const
     return ret;
 }
 
+Ptr<MWFeatureEvaluator> HOGEvaluator::cloneDetached() const
+{
+    HOGEvaluator* ret = new HOGEvaluator;
+    ret->origWinSize = origWinSize;
+    ret->features = new vector<MWFeature>(*features);
+    ret->featuresPtr = &(*ret->features)[0];
+    return ret;
+}
+
 bool HOGEvaluator::setImage( const Mat& image, Size winSize )
 {
     int rows = image.rows + 1;
@@ -709,12 +959,18 @@ bool HOGEvaluator::setImage( const Mat& image, Size winSize )
     origWinSize = winSize;
     if( image.cols < origWinSize.width || image.rows < origWinSize.height )
         return false;
-    hist.clear();
-    for( int bin = 0; bin < MWFeature::BIN_NUM; bin++ )
+    if( hist0.size() != (size_t)MWFeature::BIN_NUM ||
+        normSum0.rows < rows || normSum0.cols < cols )
     {
-        hist.push_back( Mat(rows, cols, CV_32FC1) );
+        hist0.resize( MWFeature::BIN_NUM );
+        for( int bin = 0; bin < MWFeature::BIN_NUM; bin++ )
+            hist0[bin].create( rows, cols, CV_32FC1 );
+        normSum0.create( rows, cols, CV_32FC1 );
     }
-    normSum.create( rows, cols, CV_32FC1 );
+    hist.resize( MWFeature::BIN_NUM );
+    for( int bin = 0; bin < MWFeature::BIN_NUM; bin++ )
+        hist[bin] = Mat( rows, cols, CV_32FC1, hist0[bin].data );
+    normSum = Mat( rows, cols, CV_32FC1, normSum0.data );
 
     integralHistogram( image, hist, normSum, MWFeature::BIN_NUM );
 
@@ -744,11 +1000,19 @@ void HOGEvaluator::integralHistogram(const Mat &img, vector<Mat> &histogram, Mat
 
     Size gradSize(img.size());
     Size histSize(histogram[0].size());
-    Mat grad(gradSize, CV_32F);
-    Mat qangle(gradSize, CV_8U);
+    int width = gradSize.width;
 
-    AutoBuffer<int> mapbuf(gradSize.width + gradSize.height + 4);
-    int* xmap = (int*)mapbuf + 1;
+    // the scratch is allocated for the largest scale level only
+    if( grad0.rows < gradSize.height || grad0.cols < gradSize.width )
+    {
+        grad0.create(gradSize, CV_32F);
+        qangle0.create(gradSize, CV_8U);
+        rowBuf0.create(1, width*5 + gradSize.height + 4, CV_32S);
+    }
+    Mat grad(gradSize, CV_32F, grad0.data);
+    Mat qangle(gradSize, CV_8U, qangle0.data);
+
+    int* xmap = (int*)rowBuf0.data + 1;
     int* ymap = xmap + gradSize.width + 2;
 
     const int borderType = (int)BORDER_REPLICATE;
@@ -758,9 +1022,7 @@ void HOGEvaluator::integralHistogram(const Mat &img, vector<Mat> &histogram, Mat
     for( y = -1; y < gradSize.height + 1; y++ )
         ymap[y] = borderInterpolate(y, gradSize.height, borderType);
 
-    int width = gradSize.width;
-    AutoBuffer<float> _dbuf(width*4);
-    float* dbuf = _dbuf;
+    float* dbuf = (float*)(ymap + gradSize.height + 1);
     Mat Dx(1, width, CV_32F, dbuf);
     Mat Dy(1, width, CV_32F, dbuf + width);
     Mat Mag(1, width, CV_32F, dbuf + width*2);
@@ -1425,6 +1687,96 @@ bool MWCascadeClassifier::empty() const
     return oldCascade.empty() && data.stages.empty();
 }
 
+//----------------------------------------------  binary cascade format ---------------------------------------
+// A header, then the arrays of the model, in native byte order. For a new
+// format cascade: the stages, trees, nodes, leaves and subsets of Data,
+// then the records of the feature evaluator. For an old format Haar
+// cascade: HaarStageRecord per stage, the node count of each tree in stage
+// order, HaarNodeRecord per node and the values of the leaves, tree by tree.
+
+struct CascadeBinaryHeader
+{
+    char magic[8];
+    int version;
+    int byteOrder;
+    int kind;
+    int featureType;
+    int stageType;
+    int ncategories;
+    int isStumpBased;
+    int winWidth, winHeight;
+    int numStages;
+    int numClassifiers;
+    int numNodes;
+    int numLeaves;
+    int numSubsets;
+    int featureBytes;
+};
+
+enum { CASCADE_BINARY_VERSION = 1, CASCADE_BINARY_BYTE_ORDER = 0x01020304,
+       CASCADE_BINARY_NEW = 0, CASCADE_BINARY_OLD_HAAR = 1 };
+
+static const char cascadeBinaryMagic[8] = { 'M', 'W', 'C', 'A', 'S', 'C', 'A', 'D' };
+
+struct HaarStageRecord
+{
+    int count;
+    float threshold;
+    int parent;
+    int next;
+};
+
+struct HaarNodeRecord
+{
+    int tilted;
+    int rect[CV_HAAR_FEATURE_MAX][4];
+    float weight[CV_HAAR_FEATURE_MAX];
+    float threshold;
+    int left;
+    int right;
+};
+
+// reads the arrays that follow the header, in order
+class CascadeBinaryReader
+{
+public:
+    CascadeBinaryReader( const uchar* _ptr, size_t _size ) : ptr(_ptr), size(_size) {}
+
+    template<typename T> bool read( vector<T>& elems, int count )
+    {
+        if( count < 0 || (size_t)count > size/sizeof(T) )
+            return false;
+        elems.resize( count );
+        if( count > 0 )
+            memcpy( &elems[0], ptr, count*sizeof(T) );
+        return skip( count*sizeof(T) );
+    }
+
+    bool skip( size_t n )
+    {
+        if( n > size )
+            return false;
+        ptr += n;
+        size -= n;
+        return true;
+    }
+
+    const uchar* ptr;
+    size_t size;
+};
+
+static bool isBinaryCascade( const string& filename )
+{
+    char magic[sizeof(cascadeBinaryMagic)];
+    FILE* file = fopen( filename.c_str(), "rb" );
+    if( !file )
+        return false;
+    bool ok = fread( magic, 1, sizeof(magic), file ) == sizeof(magic) &&
+              memcmp( magic, cascadeBinaryMagic, sizeof(magic) ) == 0;
+    fclose( file );
+    return ok;
+}
+
 bool MWCascadeClassifier::load(const string& filename)
 {
     
@@ -1437,6 +1789,9 @@ bool MWCascadeClassifier::load(const string& filename)
 	data = Data();
 	featureEvaluator.release();
 
+	if (isBinaryCascade(filename))
+		return loadBinary(filename);
+
 	FileStorage fs(filename, FileStorage::READ);
 	if (!fs.isOpened())
 		return false;
@@ -1449,6 +1804,272 @@ bool MWCascadeClassifier::load(const string& filename)
 	return !oldCascade.empty();
 }
 
+bool MWCascadeClassifier::saveBinary( const string& filename ) const
+{
+    if( empty() )
+        return false;
+
+    CascadeBinaryHeader header;
+    memset( &header, 0, sizeof(header) );
+    memcpy( header.magic, cascadeBinaryMagic, sizeof(header.magic) );
+    header.version = CASCADE_BINARY_VERSION;
+    header.byteOrder = CASCADE_BINARY_BYTE_ORDER;
+    vector<uchar> buf;
+
+    if( isOldFormatCascade() )
+    {
+        const MWCvHaarClassifierCascade* cascade = oldCascade;
+        vector<int> nodeCounts;
+        vector<HaarNodeRecord> nodeRecords;
+        vector<float> alphas;
+
+        header.kind = CASCADE_BINARY_OLD_HAAR;
+        header.featureType = MWFeatureEvaluator::HAAR;
+        header.winWidth = cascade->orig_window_size.width;
+        header.winHeight = cascade->orig_window_size.height;
+        header.numStages = cascade->count;
+        for( int i = 0; i < cascade->count; i++ )
+        {
+            const MWCvHaarStageClassifier& stage = cascade->stage_classifier[i];
+            HaarStageRecord rec = { stage.count, stage.threshold, stage.parent, stage.next };
+            appendBinary( buf, &rec, 1 );
+            for( int j = 0; j < stage.count; j++ )
+            {
+                const MWCvHaarClassifier& tree = stage.classifier[j];
+                nodeCounts.push_back( tree.count );
+                for( int k = 0; k < tree.count; k++ )
+                {
+                    const MWCvHaarFeature& f = tree.haar_feature[k];
+                    HaarNodeRecord node;
+                    node.tilted = f.tilted;
+                    for( int l = 0; l < CV_HAAR_FEATURE_MAX; l++ )
+                    {
+                        node.rect[l][0] = f.rect[l].r.x;
+                        node.rect[l][1] = f.rect[l].r.y;
+                        node.rect[l][2] = f.rect[l].r.width;
+                        node.rect[l][3] = f.rect[l].r.height;
+                        node.weight[l] = f.rect[l].weight;
+                    }
+                    node.threshold = tree.threshold[k];
+                    node.left = tree.left[k];
+                    node.right = tree.right[k];
+                    nodeRecords.push_back( node );
+                }
+                alphas.insert( alphas.end(), tree.alpha, tree.alpha + tree.count + 1 );
+            }
+        }
+        header.numClassifiers = (int)nodeCounts.size();
+        header.numNodes = (int)nodeRecords.size();
+        header.numLeaves = (int)alphas.size();
+        appendBinary( buf, &nodeCounts[0], nodeCounts.size() );
+        appendBinary( buf, &nodeRecords[0], nodeRecords.size() );
+        appendBinary( buf, &alphas[0], alphas.size() );
+    }
+    else
+    {
+        header.kind = CASCADE_BINARY_NEW;
+        header.featureType = data.featureType;
+        header.stageType = data.stageType;
+        header.ncategories = data.ncategories;
+        header.isStumpBased = data.isStumpBased ? 1 : 0;
+        header.winWidth = data.origWinSize.width;
+        header.winHeight = data.origWinSize.height;
+        header.numStages = (int)data.stages.size();
+        header.numClassifiers = (int)data.classifiers.size();
+        header.numNodes = (int)data.nodes.size();
+        header.numLeaves = (int)data.leaves.size();
+        header.numSubsets = (int)data.subsets.size();
+        appendBinary( buf, &data.stages[0], data.stages.size() );
+        appendBinary( buf, &data.classifiers[0], data.classifiers.size() );
+        appendBinary( buf, &data.nodes[0], data.nodes.size() );
+        appendBinary( buf, &data.leaves[0], data.leaves.size() );
+        if( !data.subsets.empty() )
+            appendBinary( buf, &data.subsets[0], data.subsets.size() );
+
+        size_t modelBytes = buf.size();
+        if( !featureEvaluator->writeBinary( buf ) )
+            return false;
+        header.featureBytes = (int)(buf.size() - modelBytes);
+    }
+
+    FILE* file = fopen( filename.c_str(), "wb" );
+    if( !file )
+        return false;
+    bool ok = fwrite( &header, sizeof(header), 1, file ) == 1 &&
+              fwrite( &buf[0], 1, buf.size(), file ) == buf.size();
+    ok = (fclose( file ) == 0) && ok;
+    return ok;
+}
+
+bool MWCascadeClassifier::loadBinary( const string& filename )
+{
+    oldCascade.release();
+    data = Data();
+    featureEvaluator.release();
+    context.levels.clear();
+
+    // the arrays are copied out of the mapping, as the features hold
+    // pointers to the integral images of each detection
+    vision::MappedFile mapping;
+    if( !mapping.open( filename.c_str() ) || mapping.size() < sizeof(CascadeBinaryHeader) )
+        return false;
+
+    CascadeBinaryHeader header;
+    memcpy( &header, mapping.data(), sizeof(header) );
+    if( memcmp( header.magic, cascadeBinaryMagic, sizeof(header.magic) ) != 0 ||
+        header.version != CASCADE_BINARY_VERSION || header.byteOrder != CASCADE_BINARY_BYTE_ORDER ||
+        header.winWidth <= 0 || header.winHeight <= 0 || header.numStages <= 0 )
+        return false;
+    CascadeBinaryReader reader( mapping.data() + sizeof(header), mapping.size() - sizeof(header) );
+
+    if( header.kind == CASCADE_BINARY_OLD_HAAR )
+    {
+        vector<HaarStageRecord> stageRecords;
+        vector<int> nodeCounts;
+        vector<HaarNodeRecord> nodeRecords;
+        vector<float> alphas;
+        if( !reader.read( stageRecords, header.numStages ) ||
+            !reader.read( nodeCounts, header.numClassifiers ) ||
+            !reader.read( nodeRecords, header.numNodes ) ||
+            !reader.read( alphas, header.numLeaves ) )
+            return false;
+
+        MWCvHaarClassifierCascade* cascade = icvCreateHaarClassifierCascade( header.numStages );
+        cascade->orig_window_size = cvSize( header.winWidth, header.winHeight );
+        int treeIdx = 0, nodeIdx = 0, alphaIdx = 0;
+        bool ok = true;
+
+        // allocated as in icvReadHaarClassifier, for MWcvReleaseHaarClassifierCascade
+        for( int i = 0; ok && i < header.numStages; i++ )
+        {
+            const HaarStageRecord& rec = stageRecords[i];
+            MWCvHaarStageClassifier& stage = cascade->stage_classifier[i];
+            if( rec.count <= 0 || treeIdx + rec.count > header.numClassifiers ||
+                rec.parent < -1 || rec.parent >= i || rec.next < -1 || rec.next >= header.numStages )
+            {
+                ok = false;
+                break;
+            }
+            stage.classifier = (MWCvHaarClassifier*)cvAlloc( rec.count*sizeof(stage.classifier[0]) );
+            for( int j = 0; j < rec.count; j++ )
+                stage.classifier[j].haar_feature = NULL;
+            stage.count = rec.count;
+            stage.threshold = rec.threshold;
+            stage.parent = rec.parent;
+            stage.next = rec.next;
+            stage.child = -1;
+            if( rec.parent != -1 && cascade->stage_classifier[rec.parent].child == -1 )
+                cascade->stage_classifier[rec.parent].child = i;
+
+            for( int j = 0; j < rec.count; j++, treeIdx++ )
+            {
+                MWCvHaarClassifier* tree = &stage.classifier[j];
+                int count = nodeCounts[treeIdx];
+                if( count <= 0 || nodeIdx + count > header.numNodes || alphaIdx + count + 1 > header.numLeaves )
+                {
+                    ok = false;
+                    break;
+                }
+                tree->count = count;
+                tree->haar_feature = (MWCvHaarFeature*) cvAlloc(
+                    count * ( sizeof( *tree->haar_feature ) + sizeof( *tree->threshold ) +
+                              sizeof( *tree->left ) + sizeof( *tree->right ) ) +
+                    (count + 1) * sizeof( *tree->alpha ) );
+                tree->threshold = (float*) (tree->haar_feature + count);
+                tree->left = (int*) (tree->threshold + count);
+                tree->right = (int*) (tree->left + count);
+                tree->alpha = (float*) (tree->right + count);
+
+                for( int k = 0; k < count; k++, nodeIdx++ )
+                {
+                    const HaarNodeRecord& node = nodeRecords[nodeIdx];
+                    // node numbers follow k, values are at most count
+                    if( node.left >= count || node.right >= count ||
+                        (node.left > 0 && node.left <= k) || (node.right > 0 && node.right <= k) ||
+                        node.left < -count || node.right < -count )
+                        ok = false;
+                    MWCvHaarFeature& f = tree->haar_feature[k];
+                    f.tilted = node.tilted;
+                    for( int l = 0; l < CV_HAAR_FEATURE_MAX; l++ )
+                    {
+                        f.rect[l].r = cvRect( node.rect[l][0], node.rect[l][1], node.rect[l][2], node.rect[l][3] );
+                        f.rect[l].weight = node.weight[l];
+                    }
+                    tree->threshold[k] = node.threshold;
+                    tree->left[k] = node.left;
+                    tree->right[k] = node.right;
+                }
+                memcpy( tree->alpha, &alphas[alphaIdx], (count + 1)*sizeof(float) );
+                alphaIdx += count + 1;
+            }
+        }
+
+        if( !ok || treeIdx != header.numClassifiers || nodeIdx != header.numNodes || alphaIdx != header.numLeaves )
+        {
+            MWcvReleaseHaarClassifierCascade( &cascade );
+            return false;
+        }
+        oldCascade = Ptr<MWCvHaarClassifierCascade>( cascade );
+        return true;
+    }
+
+    if( header.kind != CASCADE_BINARY_NEW || header.stageType != BOOST ||
+        (header.featureType != MWFeatureEvaluator::HAAR && header.featureType != MWFeatureEvaluator::LBP &&
+         header.featureType != MWFeatureEvaluator::HOG) )
+        return false;
+
+    Data model;
+    model.stageType = header.stageType;
+    model.featureType = header.featureType;
+    model.ncategories = header.ncategories;
+    model.isStumpBased = header.isStumpBased != 0;
+    model.origWinSize = Size( header.winWidth, header.winHeight );
+    if( !reader.read( model.stages, header.numStages ) ||
+        !reader.read( model.classifiers, header.numClassifiers ) ||
+        !reader.read( model.nodes, header.numNodes ) ||
+        !reader.read( model.leaves, header.numLeaves ) ||
+        !reader.read( model.subsets, header.numSubsets ) ||
+        header.featureBytes < 0 || (size_t)header.featureBytes != reader.size )
+        return false;
+
+    // the predictors index the arrays without checks
+    int subsetSize = (model.ncategories + 31)/32;
+    int numTrees = 0, numNodes = 0;
+    for( size_t i = 0; i < model.stages.size(); i++ )
+    {
+        if( model.stages[i].first != numTrees || model.stages[i].ntrees <= 0 )
+            return false;
+        numTrees += model.stages[i].ntrees;
+    }
+    if( numTrees != header.numClassifiers )
+        return false;
+    for( size_t i = 0; i < model.classifiers.size(); i++ )
+    {
+        if( model.classifiers[i].nodeCount <= 0 )
+            return false;
+        numNodes += model.classifiers[i].nodeCount;
+    }
+    if( numNodes != header.numNodes || header.numLeaves != numNodes + numTrees ||
+        header.numSubsets != (model.ncategories > 0 ? numNodes*subsetSize : 0) )
+        return false;
+
+    Ptr<MWFeatureEvaluator> evaluator = MWFeatureEvaluator::create( model.featureType );
+    if( evaluator.empty() || !evaluator->readBinary( reader.ptr, reader.size ) )
+        return false;
+    int numFeatures = (int)(reader.size/(model.featureType == MWFeatureEvaluator::HAAR ? sizeof(HaarFeatureRecord) :
+                                         model.featureType == MWFeatureEvaluator::LBP ? sizeof(LBPFeatureRecord) :
+                                         sizeof(HOGFeatureRecord)));
+    for( size_t i = 0; i < model.nodes.size(); i++ )
+    {
+        if( model.nodes[i].featureIdx < 0 || model.nodes[i].featureIdx >= numFeatures )
+            return false;
+    }
+
+    data = model;
+    featureEvaluator = evaluator;
+    return true;
+}
+
 int MWCascadeClassifier::runAt( Ptr<MWFeatureEvaluator>& evaluator, Point pt, double& weight )
 {
     CV_Assert( oldCascade.empty() );
@@ -1483,6 +2104,30 @@ int MWCascadeClassifier::runAt( Ptr<MWFeatureEvaluator>& evaluator, Point pt, do
     }
 }
 
+bool MWCascadeClassifier::runAtLanes( Ptr<MWFeatureEvaluator>& evaluator, Point pt, int dx, int* results, double* weights )
+{
+    CV_Assert( oldCascade.empty() );
+
+    // the trees of more than one node branch differently from lane to lane
+    if( !data.isStumpBased )
+        return false;
+#ifdef HAVE_TEGRA_OPTIMIZATION
+    // predictCategoricalStump accumulates in float there
+    if( data.featureType == MWFeatureEvaluator::LBP )
+        return false;
+#endif
+    if( !evaluator->setWindows(pt, dx) )
+        return false;
+
+    if( data.featureType == MWFeatureEvaluator::HAAR )
+        predictOrderedStumpLanes<HaarEvaluator>( *this, evaluator, results, weights );
+    else if( data.featureType == MWFeatureEvaluator::LBP )
+        predictCategoricalStumpLanes<LBPEvaluator>( *this, evaluator, results, weights );
+    else
+        return false;
+    return true;
+}
+
 bool MWCascadeClassifier::setImage( Ptr<MWFeatureEvaluator>& evaluator, const Mat& image )
 {
     return empty() ? false : evaluator->setImage(image, data.origWinSize);
@@ -1509,31 +2154,50 @@ void MWCascadeClassifier::setFaceDetectionMaskGenerator()
 class CascadeClassifierInvoker : public ParallelLoopBody
 {
 public:
+    typedef MWCascadeClassifier::DetectionContext::StripOutput StripOutput;
+
+    // the ranges write to the outputs of their first strip, which must be
+    // empty
     CascadeClassifierInvoker( MWCascadeClassifier& _cc, Size _sz1, int _stripSize, int _yStep, double _factor,
-        vector<Rect>& _vec, vector<int>& _levels, vector<double>& _weights, bool outputLevels, const Mat& _mask, Mutex* _mtx)
+        vector<StripOutput>& _outputs, bool _outputLevels, const Mat& _mask)
     {
         classifier = &_cc;
         processingRectSize = _sz1;
         stripSize = _stripSize;
         yStep = _yStep;
         scalingFactor = _factor;
-        rectangles = &_vec;
-        rejectLevels = outputLevels ? &_levels : 0;
-        levelWeights = outputLevels ? &_weights : 0;
+        outputs = &_outputs;
+        outputLevels = _outputLevels;
         mask = _mask;
-        mtx = _mtx;
     }
 
     void operator()(const Range& range) const
     {
+        CG_TRACE_SPAN("CascadeClassifierInvoker");
         Ptr<MWFeatureEvaluator> evaluator = classifier->featureEvaluator->clone();
 
-        Size winSize(cvRound(classifier->data.origWinSize.width * scalingFactor), cvRound(classifier->data.origWinSize.height * scalingFactor));
-
         int y1 = range.start * stripSize;
         int y2 = min(range.end * stripSize, processingRectSize.height);
+        scanStrip( *classifier, evaluator, processingRectSize, y1, y2, yStep, scalingFactor, mask,
+                   (*outputs)[range.start], outputLevels );
+    }
+
+    // runs the cascade on the windows of rows y1 to y2 of one scale level;
+    // only the calling thread writes to out, so no lock is needed
+    static void scanStrip( MWCascadeClassifier& classifier, Ptr<MWFeatureEvaluator>& evaluator,
+                           Size processingRectSize, int y1, int y2, int yStep, double scalingFactor,
+                           const Mat& mask, StripOutput& out, bool outputLevels )
+    {
+        Size winSize(cvRound(classifier.data.origWinSize.width * scalingFactor), cvRound(classifier.data.origWinSize.height * scalingFactor));
+        const int numLanes = MWFeatureEvaluator::NUM_LANES;
+        int laneResults[numLanes];
+        double laneWeights[numLanes];
+
         for( int y = y1; y < y2; y += yStep )
         {
+            // the windows x0, x0 + yStep, ... were evaluated together; the
+            // ones skipped below are computed but not used
+            int x0 = -numLanes*yStep;
             for( int x = 0; x < processingRectSize.width; x += yStep )
             {
                 if ( (!mask.empty()) && (mask.at<uchar>(Point(x,y))==0)) {
@@ -1541,31 +2205,37 @@ public:
                 }
 
                 double gypWeight;
-                int result = classifier->runAt(evaluator, Point(x, y), gypWeight);
+                int result;
+                if( x >= x0 + numLanes*yStep && x + (numLanes - 1)*yStep < processingRectSize.width &&
+                    classifier.runAtLanes(evaluator, Point(x, y), yStep, laneResults, laneWeights) )
+                    x0 = x;
+                if( x < x0 + numLanes*yStep )
+                {
+                    result = laneResults[(x - x0)/yStep];
+                    gypWeight = laneWeights[(x - x0)/yStep];
+                }
+                else
+                    result = classifier.runAt(evaluator, Point(x, y), gypWeight);
 
 #if defined (LOG_CASCADE_STATISTIC)
 
                 logger.setPoint(Point(x, y), result);
 #endif
-                if( rejectLevels )
+                if( outputLevels )
                 {
                     if( result == 1 )
-                        result =  -(int)classifier->data.stages.size();
-                    if( classifier->data.stages.size() + result < 4 )
+                        result =  -(int)classifier.data.stages.size();
+                    if( classifier.data.stages.size() + result < 4 )
                     {
-                        mtx->lock();
-                        rectangles->push_back(Rect(cvRound(x*scalingFactor), cvRound(y*scalingFactor), winSize.width, winSize.height));
-                        rejectLevels->push_back(-result);
-                        levelWeights->push_back(gypWeight);
-                        mtx->unlock();
+                        out.rects.push_back(Rect(cvRound(x*scalingFactor), cvRound(y*scalingFactor), winSize.width, winSize.height));
+                        out.levels.push_back(-result);
+                        out.weights.push_back(gypWeight);
                     }
                 }
                 else if( result > 0 )
                 {
-                    mtx->lock();
-                    rectangles->push_back(Rect(cvRound(x*scalingFactor), cvRound(y*scalingFactor),
-                                               winSize.width, winSize.height));
-                    mtx->unlock();
+                    out.rects.push_back(Rect(cvRound(x*scalingFactor), cvRound(y*scalingFactor),
+                                             winSize.width, winSize.height));
                 }
                 if( result == 0 )
                     x += yStep;
@@ -1573,15 +2243,113 @@ public:
         }
     }
 
+    // appends the outputs in strip order, so the candidates do not depend
+    // on the scheduling, and empties them for the next parallel loop
+    static void mergeOutputs( vector<StripOutput>& outputs, size_t count, vector<Rect>& candidates,
+                              vector<int>& levels, vector<double>& weights )
+    {
+        for( size_t i = 0; i < count; i++ )
+        {
+            StripOutput& out = outputs[i];
+            candidates.insert( candidates.end(), out.rects.begin(), out.rects.end() );
+            levels.insert( levels.end(), out.levels.begin(), out.levels.end() );
+            weights.insert( weights.end(), out.weights.begin(), out.weights.end() );
+            out.rects.clear();
+            out.levels.clear();
+            out.weights.clear();
+        }
+    }
+
     MWCascadeClassifier* classifier;
-    vector<Rect>* rectangles;
+    vector<StripOutput>* outputs;
     Size processingRectSize;
     int stripSize, yStep;
     double scalingFactor;
-    vector<int> *rejectLevels;
-    vector<double> *levelWeights;
+    bool outputLevels;
     Mat mask;
-    Mutex* mtx;
+};
+
+// takes the image of each scale level and its integral images from the
+// shared pyramid of the frame
+class CascadeLevelInvoker : public ParallelLoopBody
+{
+public:
+    CascadeLevelInvoker( MWCascadeClassifier& _cc, const Mat& _image, vector<uchar>& _valid )
+        : classifier(&_cc), frame(vision::PyramidCache::acquire(_image)), valid(&_valid)
+    {
+    }
+
+    void operator()(const Range& range) const
+    {
+        CG_TRACE_SPAN("CascadeLevelInvoker");
+        const Mat& image = frame->getFrame();
+        for( int i = range.start; i < range.end; i++ )
+        {
+            MWCascadeClassifier::DetectionContext::ScaleLevel& level = classifier->context.levels[i];
+            Size scaledImageSize( cvRound( image.cols/level.factor ), cvRound( image.rows/level.factor ) );
+            int index = frame->getLevel( 0, scaledImageSize, INTER_LINEAR );
+            level.image = frame->getImage( index );
+            (*valid)[i] = setLevelImage( *level.evaluator, index );
+        }
+    }
+
+    // Haar and LBP evaluators take the shared integral images of the level
+    bool setLevelImage( MWFeatureEvaluator& evaluator, int index ) const
+    {
+        const Mat& image = frame->getImage( index );
+        Size origWinSize = classifier->data.origWinSize;
+        Mat sum, sqsum, tilted;
+        switch( evaluator.getFeatureType() )
+        {
+        case MWFeatureEvaluator::HAAR:
+            frame->getIntegrals( index, sum, &sqsum,
+                ((HaarEvaluator&)evaluator).hasTilted() ? &tilted : NULL );
+            return evaluator.setIntegrals( image, sum, sqsum, tilted, origWinSize );
+        case MWFeatureEvaluator::LBP:
+            frame->getIntegrals( index, sum );
+            return evaluator.setIntegrals( image, sum, sqsum, tilted, origWinSize );
+        default:
+            return evaluator.setImage( image, origWinSize );
+        }
+    }
+
+    MWCascadeClassifier* classifier;
+    vision::FramePyramidPtr frame;
+    vector<uchar>* valid;
+};
+
+// runs the strips of all the scale levels
+class CascadePyramidInvoker : public ParallelLoopBody
+{
+public:
+    CascadePyramidInvoker( MWCascadeClassifier& _cc, bool _outputLevels )
+    {
+        classifier = &_cc;
+        outputLevels = _outputLevels;
+    }
+
+    void operator()(const Range& range) const
+    {
+        CG_TRACE_SPAN("CascadePyramidInvoker");
+        for( int i = range.start; i < range.end; i++ )
+        {
+            const MWCascadeClassifier::DetectionContext::Strip& strip = classifier->context.strips[i];
+            const MWCascadeClassifier::DetectionContext::ScaleLevel& level = classifier->context.levels[strip.level];
+            Ptr<MWFeatureEvaluator> evaluator = level.evaluator->clone();
+            CascadeClassifierInvoker::scanStrip( *classifier, evaluator, level.processingRectSize,
+                strip.y1, strip.y2, level.yStep, level.factor, level.mask,
+                classifier->context.outputs[strip.output], outputLevels );
+        }
+    }
+
+    static bool largerStrip( const MWCascadeClassifier::DetectionContext::Strip& a,
+                             const MWCascadeClassifier::DetectionContext::Strip& b )
+    {
+        return a.numWindows > b.numWindows;
+    }
+
+    MWCascadeClassifier* classifier;
+    bool outputLevels;
 };
 
 struct getRect { Rect operator ()(const MWCvAvgComp& e) const { return e.rect; } };
@@ -1594,6 +2362,15 @@ bool MWCascadeClassifier::detectSingleScale( const Mat& image, int stripCount, S
     if( !featureEvaluator->setImage( image, data.origWinSize ) )
         return false;
 
+    scanSingleScale( image, stripCount, processingRectSize, stripSize, yStep, factor, candidates,
+                     levels, weights, outputRejectLevels );
+    return true;
+}
+
+void MWCascadeClassifier::scanSingleScale( const Mat& image, int stripCount, Size processingRectSize,
+                                           int stripSize, int yStep, double factor, vector<Rect>& candidates,
+                                           vector<int>& levels, vector<double>& weights, bool outputRejectLevels )
+{
 #if defined (LOG_CASCADE_STATISTIC)
     logger.setImage(image);
 #endif
@@ -1603,29 +2380,16 @@ bool MWCascadeClassifier::detectSingleScale( const Mat& image, int stripCount, S
         currentMask=maskGenerator->generateMask(image);
     }
 
-    vector<Rect> candidatesVector;
-    vector<int> rejectLevels;
-    vector<double> levelWeights;
-    Mutex mtx;
-    if( outputRejectLevels )
-    {
-        parallel_for_(Range(0, stripCount), CascadeClassifierInvoker( *this, processingRectSize, stripSize, yStep, factor,
-            candidatesVector, rejectLevels, levelWeights, true, currentMask, &mtx));
-        levels.insert( levels.end(), rejectLevels.begin(), rejectLevels.end() );
-        weights.insert( weights.end(), levelWeights.begin(), levelWeights.end() );
-    }
-    else
-    {
-         parallel_for_(Range(0, stripCount), CascadeClassifierInvoker( *this, processingRectSize, stripSize, yStep, factor,
-            candidatesVector, rejectLevels, levelWeights, false, currentMask, &mtx));
-    }
-    candidates.insert( candidates.end(), candidatesVector.begin(), candidatesVector.end() );
+    // the strips append to the outputs of the previous scale levels
+    if( context.outputs.size() < (size_t)stripCount )
+        context.outputs.resize( stripCount );
+    parallel_for_(Range(0, stripCount), CascadeClassifierInvoker( *this, processingRectSize, stripSize, yStep, factor,
+        context.outputs, outputRejectLevels, currentMask));
+    CascadeClassifierInvoker::mergeOutputs( context.outputs, stripCount, candidates, levels, weights );
 
 #if defined (LOG_CASCADE_STATISTIC)
     logger.write();
 #endif
-
-    return true;
 }
 
 bool MWCascadeClassifier::isOldFormatCascade() const
@@ -1656,6 +2420,90 @@ bool MWCascadeClassifier::setImage(const Mat& image)
     return featureEvaluator->setImage(image, data.origWinSize);
 }
 
+void MWCascadeClassifier::detectAllScales( const Mat& grayImage, double scaleFactor,
+                                          Size minObjectSize, Size maxObjectSize,
+                                          vector<Rect>& candidates, vector<int>& rejectLevels,
+                                          vector<double>& levelWeights, bool outputRejectLevels )
+{
+    // windows per strip, as in detectMultiScale
+    const int PTS_PER_THREAD = 1000;
+    Size originalWindowSize = getOriginalWindowSize();
+    vector<DetectionContext::ScaleLevel>& levels = context.levels;
+    vector<DetectionContext::Strip>& strips = context.strips;
+    size_t numLevels = 0;
+
+    // the levels and their evaluators are kept from the previous frame when
+    // the sizes do not change
+    for( double factor = 1; ; factor *= scaleFactor )
+    {
+        Size windowSize( cvRound(originalWindowSize.width*factor), cvRound(originalWindowSize.height*factor) );
+        Size scaledImageSize( cvRound( grayImage.cols/factor ), cvRound( grayImage.rows/factor ) );
+        Size processingRectSize( scaledImageSize.width - originalWindowSize.width, scaledImageSize.height - originalWindowSize.height );
+
+        if( processingRectSize.width <= 0 || processingRectSize.height <= 0 )
+            break;
+        if( windowSize.width > maxObjectSize.width || windowSize.height > maxObjectSize.height )
+            break;
+        if( windowSize.width < minObjectSize.width || windowSize.height < minObjectSize.height )
+            continue;
+
+        if( levels.size() <= numLevels )
+            levels.resize( numLevels + 1 );
+        DetectionContext::ScaleLevel& level = levels[numLevels++];
+        level.factor = factor;
+        level.processingRectSize = processingRectSize;
+        if( getFeatureType() == cv::MWFeatureEvaluator::HOG )
+            level.yStep = 4;
+        else
+            level.yStep = factor > 2. ? 1 : 2;
+        if( level.evaluator.empty() )
+            level.evaluator = featureEvaluator->cloneDetached();
+    }
+    levels.resize( numLevels );
+
+    // one byte per level: the levels are set from several threads
+    vector<uchar> valid( numLevels, (uchar)0 );
+    parallel_for_(Range(0, (int)numLevels), CascadeLevelInvoker( *this, grayImage, valid ));
+
+    // the strips of all levels hold about the same number of windows, and
+    // run the largest first so that the small ones fill the last threads
+    strips.clear();
+    for( size_t i = 0; i < numLevels && valid[i]; i++ )
+    {
+        DetectionContext::ScaleLevel& level = levels[i];
+        int yStep = level.yStep;
+        int numCols = (level.processingRectSize.width + yStep - 1)/yStep;
+        int numRows = (level.processingRectSize.height + yStep - 1)/yStep;
+        int stripCount = (numCols*numRows + PTS_PER_THREAD/2)/PTS_PER_THREAD;
+        stripCount = std::min(std::max(stripCount, 1), numRows);
+        int rowsPerStrip = (numRows + stripCount - 1)/stripCount;
+
+        if( !maskGenerator.empty() )
+            level.mask = maskGenerator->generateMask(level.image);
+        else
+            level.mask.release();
+
+        for( int r = 0; r < numRows; r += rowsPerStrip )
+        {
+            DetectionContext::Strip strip;
+            strip.level = (int)i;
+            strip.y1 = r*yStep;
+            strip.y2 = std::min((r + rowsPerStrip)*yStep, level.processingRectSize.height);
+            strip.numWindows = numCols*std::min(rowsPerStrip, numRows - r);
+            strip.output = (int)strips.size();
+            strips.push_back(strip);
+        }
+    }
+    std::stable_sort( strips.begin(), strips.end(), CascadePyramidInvoker::largerStrip );
+
+    if( context.outputs.size() < strips.size() )
+        context.outputs.resize( strips.size() );
+    parallel_for_(Range(0, (int)strips.size()), CascadePyramidInvoker( *this, outputRejectLevels ));
+    // in the order of the levels, whatever the order the strips ran in
+    CascadeClassifierInvoker::mergeOutputs( context.outputs, strips.size(), candidates,
+                                            rejectLevels, levelWeights );
+}
+
 void MWCascadeClassifier::detectMultiScale( const Mat& image, vector<Rect>& objects,
                                           vector<int>& rejectLevels,
                                           vector<double>& levelWeights,
@@ -1696,55 +2544,64 @@ void MWCascadeClassifier::detectMultiScale( const Mat& image, vector<Rect>& obje
     Mat grayImage = image;
     if( grayImage.channels() > 1 )
     {
-        Mat temp;
-        cvtColor(grayImage, temp, CV_BGR2GRAY);
-        grayImage = temp;
+        cvtColor(grayImage, context.grayImage, CV_BGR2GRAY);
+        grayImage = context.grayImage;
     }
 
-    Mat imageBuffer(image.rows + 1, image.cols + 1, CV_8U);
-    vector<Rect> candidates;
+    // no allocation while the frame size does not change
+    context.imageBuffer.create(image.rows + 1, image.cols + 1, CV_8U);
+    Mat& imageBuffer = context.imageBuffer;
+    vector<Rect>& candidates = context.candidates;
+    candidates.clear();
 
-    for( double factor = 1; ; factor *= scaleFactor )
+    if( flags & MWCASCADE_SCALE_PARALLEL )
     {
-        Size originalWindowSize = getOriginalWindowSize();
+        detectAllScales( grayImage, scaleFactor, minObjectSize, maxObjectSize, candidates,
+                         rejectLevels, levelWeights, outputRejectLevels );
+    }
+    else
+    {
+    for( double factor = 1; ; factor *= scaleFactor )
+        {
+            Size originalWindowSize = getOriginalWindowSize();
 
-        Size windowSize( cvRound(originalWindowSize.width*factor), cvRound(originalWindowSize.height*factor) );
-        Size scaledImageSize( cvRound( grayImage.cols/factor ), cvRound( grayImage.rows/factor ) );
-        Size processingRectSize( scaledImageSize.width - originalWindowSize.width, scaledImageSize.height - originalWindowSize.height );
+            Size windowSize( cvRound(originalWindowSize.width*factor), cvRound(originalWindowSize.height*factor) );
+            Size scaledImageSize( cvRound( grayImage.cols/factor ), cvRound( grayImage.rows/factor ) );
+            Size processingRectSize( scaledImageSize.width - originalWindowSize.width, scaledImageSize.height - originalWindowSize.height );
 
-        if( processingRectSize.width <= 0 || processingRectSize.height <= 0 )
-            break;
-        if( windowSize.width > maxObjectSize.width || windowSize.height > maxObjectSize.height )
-            break;
-        if( windowSize.width < minObjectSize.width || windowSize.height < minObjectSize.height )
-            continue;
+            if( processingRectSize.width <= 0 || processingRectSize.height <= 0 )
+                break;
+            if( windowSize.width > maxObjectSize.width || windowSize.height > maxObjectSize.height )
+                break;
+            if( windowSize.width < minObjectSize.width || windowSize.height < minObjectSize.height )
+                continue;
 
-        Mat scaledImage( scaledImageSize, CV_8U, imageBuffer.data );
-        resize( grayImage, scaledImage, scaledImageSize, 0, 0, CV_INTER_LINEAR );
+            Mat scaledImage( scaledImageSize, CV_8U, imageBuffer.data );
+            resize( grayImage, scaledImage, scaledImageSize, 0, 0, CV_INTER_LINEAR );
 
-        int yStep;
-        if( getFeatureType() == cv::MWFeatureEvaluator::HOG )
-        {
-            yStep = 4;
-        }
-        else
-        {
-            yStep = factor > 2. ? 1 : 2;
-        }
+            int yStep;
+            if( getFeatureType() == cv::MWFeatureEvaluator::HOG )
+            {
+                yStep = 4;
+            }
+            else
+            {
+                yStep = factor > 2. ? 1 : 2;
+            }
 
-        int stripCount, stripSize;
+            int stripCount, stripSize;
 
-        const int PTS_PER_THREAD = 1000;
-        stripCount = ((processingRectSize.width/yStep)*(processingRectSize.height + yStep-1)/yStep + PTS_PER_THREAD/2)/PTS_PER_THREAD;
-        stripCount = std::min(std::max(stripCount, 1), 100);
-        stripSize = (((processingRectSize.height + stripCount - 1)/stripCount + yStep-1)/yStep)*yStep;
+            const int PTS_PER_THREAD = 1000;
+            stripCount = ((processingRectSize.width/yStep)*(processingRectSize.height + yStep-1)/yStep + PTS_PER_THREAD/2)/PTS_PER_THREAD;
+            stripCount = std::min(std::max(stripCount, 1), 100);
+            stripSize = (((processingRectSize.height + stripCount - 1)/stripCount + yStep-1)/yStep)*yStep;
 
-        if( !detectSingleScale( scaledImage, stripCount, processingRectSize, stripSize, yStep, factor, candidates,
-            rejectLevels, levelWeights, outputRejectLevels ) )
-            break;
+            if( !detectSingleScale( scaledImage, stripCount, processingRectSize, stripSize, yStep, factor, candidates,
+                rejectLevels, levelWeights, outputRejectLevels ) )
+                break;
+        }
     }
 
-
     objects.resize(candidates.size());
     std::copy(candidates.begin(), candidates.end(), objects.begin());
 
@@ -1768,6 +2625,172 @@ void MWCascadeClassifier::detectMultiScale( const Mat& image, vector<Rect>& obje
         minNeighbors, flags, minObjectSize, maxObjectSize, false );
 }
 
+void MWCascadeClassifier::detectMultiScaleInROIs( const Mat& image, const vector<Rect>& rois,
+                                                const vector<Size>& minSizes, const vector<Size>& maxSizes,
+                                                vector<Rect>& objects, double scaleFactor,
+                                                int minNeighbors, int flags )
+{
+    const double GROUP_EPS = 0.2;
+
+    CV_Assert( minSizes.size() == rois.size() && maxSizes.size() == rois.size() );
+
+    objects.clear();
+    if( empty() )
+        return;
+
+    Size origWinSize = getOriginalWindowSize();
+    Rect imageRect( 0, 0, image.cols, image.rows );
+    vector<Rect> roiObjects;
+
+    // ungrouped candidates of each region, in image coordinates
+    for( size_t i = 0; i < rois.size(); i++ )
+    {
+        Rect roi = rois[i] & imageRect;
+        if( roi.width <= origWinSize.width || roi.height <= origWinSize.height )
+            continue;
+        detectMultiScale( image(roi), roiObjects, scaleFactor, 0, flags, minSizes[i], maxSizes[i] );
+        for( size_t j = 0; j < roiObjects.size(); j++ )
+            objects.push_back( roiObjects[j] + roi.tl() );
+    }
+
+    MWgroupRectangles( objects, minNeighbors, GROUP_EPS );
+}
+
+void MWCascadeClassifier::detectMultiModel( MWCascadeClassifier** classifiers, int numClassifiers,
+                                          const Mat& image, vector<Rect>* objects,
+                                          double scaleFactor, const int* minNeighbors,
+                                          const Size* minObjectSize, const Size* maxObjectSize )
+{
+    const double GROUP_EPS = 0.2;
+    const int PTS_PER_THREAD = 1000;
+
+    CV_Assert( scaleFactor > 1 && image.depth() == CV_8U );
+
+    if( numClassifiers <= 0 )
+        return;
+
+    // the old format cascades have their own pyramid
+    vector<int> shared;
+    for( int i = 0; i < numClassifiers; i++ )
+    {
+        MWCascadeClassifier& cc = *classifiers[i];
+        objects[i].clear();
+        if( cc.empty() )
+            continue;
+        if( cc.isOldFormatCascade() )
+            cc.detectMultiScale( image, objects[i], scaleFactor, minNeighbors[i], MWCASCADE_SCALE_IMAGE,
+                                 minObjectSize[i], maxObjectSize[i] );
+        else
+        {
+            shared.push_back(i);
+            if( !cc.maskGenerator.empty() )
+                cc.maskGenerator->initializeMask(image);
+            cc.context.candidates.clear();
+        }
+    }
+    if( shared.empty() )
+        return;
+
+    DetectionContext& context = classifiers[0]->context;
+    Mat grayImage = image;
+    if( grayImage.channels() > 1 )
+    {
+        cvtColor(grayImage, context.grayImage, CV_BGR2GRAY);
+        grayImage = context.grayImage;
+    }
+
+    bool anyHaar = false, anyTilted = false;
+    for( size_t j = 0; j < shared.size(); j++ )
+    {
+        MWCascadeClassifier& cc = *classifiers[shared[j]];
+        if( cc.getFeatureType() == MWFeatureEvaluator::HAAR )
+        {
+            anyHaar = true;
+            anyTilted |= ((HaarEvaluator&)*cc.featureEvaluator).hasTilted();
+        }
+    }
+    // the scale levels and their integral images are shared by the
+    // classifiers, and with the other cores that run on the frame
+    vision::FramePyramidPtr frame = vision::PyramidCache::acquire(grayImage);
+
+    vector<bool> done( shared.size(), false );
+    vector<int> fakeLevels;
+    vector<double> fakeWeights;
+    size_t numDone = 0;
+
+    for( double factor = 1; numDone < shared.size(); factor *= scaleFactor )
+    {
+        Size scaledImageSize( cvRound( grayImage.cols/factor ), cvRound( grayImage.rows/factor ) );
+        Mat scaledImage, sum, sqsum, tilted;
+
+        for( size_t j = 0; j < shared.size(); j++ )
+        {
+            if( done[j] )
+                continue;
+            int i = shared[j];
+            MWCascadeClassifier& cc = *classifiers[i];
+            Size originalWindowSize = cc.getOriginalWindowSize();
+            Size maxSize = maxObjectSize[i];
+            if( maxSize.height == 0 || maxSize.width == 0 )
+                maxSize = image.size();
+
+            Size windowSize( cvRound(originalWindowSize.width*factor), cvRound(originalWindowSize.height*factor) );
+            Size processingRectSize( scaledImageSize.width - originalWindowSize.width, scaledImageSize.height - originalWindowSize.height );
+
+            if( processingRectSize.width <= 0 || processingRectSize.height <= 0 ||
+                windowSize.width > maxSize.width || windowSize.height > maxSize.height )
+            {
+                done[j] = true;
+                numDone++;
+                continue;
+            }
+            if( windowSize.width < minObjectSize[i].width || windowSize.height < minObjectSize[i].height )
+                continue;
+
+            // the level is computed for the first classifier that uses it
+            if( scaledImage.empty() )
+            {
+                int index = frame->getLevel( 0, scaledImageSize, INTER_LINEAR );
+                scaledImage = frame->getImage( index );
+                frame->getIntegrals( index, sum, anyHaar ? &sqsum : NULL, anyTilted ? &tilted : NULL );
+            }
+
+            if( !cc.featureEvaluator->setIntegrals( scaledImage, sum, sqsum, tilted, cc.data.origWinSize ) )
+            {
+                done[j] = true;
+                numDone++;
+                continue;
+            }
+
+            int yStep;
+            if( cc.getFeatureType() == cv::MWFeatureEvaluator::HOG )
+            {
+                yStep = 4;
+            }
+            else
+            {
+                yStep = factor > 2. ? 1 : 2;
+            }
+
+            int stripCount, stripSize;
+            stripCount = ((processingRectSize.width/yStep)*(processingRectSize.height + yStep-1)/yStep + PTS_PER_THREAD/2)/PTS_PER_THREAD;
+            stripCount = std::min(std::max(stripCount, 1), 100);
+            stripSize = (((processingRectSize.height + stripCount - 1)/stripCount + yStep-1)/yStep)*yStep;
+
+            cc.scanSingleScale( scaledImage, stripCount, processingRectSize, stripSize, yStep, factor,
+                                cc.context.candidates, fakeLevels, fakeWeights, false );
+        }
+    }
+
+    for( size_t j = 0; j < shared.size(); j++ )
+    {
+        int i = shared[j];
+        vector<Rect>& candidates = classifiers[i]->context.candidates;
+        objects[i].assign( candidates.begin(), candidates.end() );
+        MWgroupRectangles( objects[i], minNeighbors[i], GROUP_EPS );
+    }
+}
+
 bool MWCascadeClassifier::Data::read(const FileNode &root)
 {
     static const float THRESHOLD_EPS = 1e-5f;
@@ -1882,6 +2905,9 @@ bool MWCascadeClassifier::Data::read(const FileNode &root)
 
 bool MWCascadeClassifier::read(const FileNode& root)
 {
+    // the scale levels hold clones of the previous evaluator
+    context.levels.clear();
+
     if( !data.read(root) )
         return false;
 
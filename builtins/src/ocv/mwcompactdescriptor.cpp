@@ -0,0 +1,485 @@
+//////////////////////////////////////////////////////////////////////////////
+// Compact floating point feature descriptors and their SSD kernels.
+//
+// Copyright 2016 The MathWorks, Inc.
+//
+//////////////////////////////////////////////////////////////////////////////
+
+#include "mwcompactdescriptor.hpp"
+
+#include <algorithm>
+#include <cfloat>
+#include <climits>
+#include <cmath>
+#include <cstring>
+#include <vector>
+
+#include "opencv2/core.hpp"
+#include "cgProfile.hpp"
+
+#if defined(__ARM_NEON__) || defined(__ARM_NEON)
+#include <arm_neon.h>
+#define MW_COMPACT_NEON 1
+#elif defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#include <immintrin.h>
+#define MW_COMPACT_X86 1
+#endif
+
+// As in mwhamming.cpp, the x86 kernels are compiled for their instruction
+// set whatever the global flags and only called after a run-time CPU check.
+// OpenCV does not report F16C, but every CPU with AVX2 and FMA3 has it.
+#if defined(MW_COMPACT_X86) && (defined(__GNUC__) || defined(__clang__))
+#define MW_TARGET_SSE2 __attribute__((target("sse2")))
+#define MW_TARGET_AVX2 __attribute__((target("avx2,f16c,fma")))
+#else
+#define MW_TARGET_SSE2
+#define MW_TARGET_AVX2
+#endif
+
+namespace vision
+{
+
+///////////////////////////////////////////////////////////////////////////////
+// Conversions
+///////////////////////////////////////////////////////////////////////////////
+
+// Half precision number nearest to f, ties to even
+static unsigned short floatToHalf(float f)
+{
+    unsigned int x;
+    memcpy(&x, &f, 4);
+    const unsigned int sign = (x >> 16) & 0x8000;
+    const unsigned int absx = x & 0x7fffffff;
+
+    // infinity and NaN
+    if (absx >= 0x7f800000)
+        return (unsigned short)(sign | 0x7c00 | (absx > 0x7f800000 ? 0x200 : 0));
+    // rounds to 65520 or more
+    if (absx >= 0x477ff000)
+        return (unsigned short)(sign | 0x7c00);
+    // subnormal half, in units of 2^-24, cvRound rounding half to even
+    if (absx < 0x38800000)
+    {
+        float a;
+        memcpy(&a, &absx, 4);
+        return (unsigned short)(sign | (unsigned int)cvRound(a * 16777216.0f));
+    }
+
+    // rebias the exponent and round the mantissa to 10 bits, a carry
+    // increments the exponent
+    unsigned int h = (absx - 0x38000000) >> 13;
+    const unsigned int rest = absx & 0x1fff;
+    if (rest > 0x1000 || (rest == 0x1000 && (h & 1)))
+        h++;
+    return (unsigned short)(sign | h);
+}
+
+float halfToFloat(unsigned short h)
+{
+    const unsigned int sign = (unsigned int)(h & 0x8000) << 16;
+    const unsigned int exponent = (h >> 10) & 0x1f;
+    const unsigned int mantissa = h & 0x3ff;
+
+    unsigned int x;
+    if (exponent == 0)
+    {
+        const float f = (float)mantissa * (1.0f / 16777216.0f);
+        memcpy(&x, &f, 4);
+        x |= sign;
+    }
+    else if (exponent == 31)
+    {
+        x = sign | 0x7f800000 | (mantissa << 13);
+    }
+    else
+    {
+        x = sign | ((exponent + 112) << 23) | (mantissa << 13);
+    }
+
+    float f;
+    memcpy(&f, &x, 4);
+    return f;
+}
+
+typedef void (*FloatToHalfFcn)(const float *src, size_t n, unsigned short *dst);
+
+static void floatToHalfC(const float *src, size_t n, unsigned short *dst)
+{
+    for (size_t i = 0; i < n; ++i)
+        dst[i] = floatToHalf(src[i]);
+}
+
+#ifdef MW_COMPACT_X86
+MW_TARGET_AVX2
+static void floatToHalfF16C(const float *src, size_t n, unsigned short *dst)
+{
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8)
+    {
+        __m128i h = _mm256_cvtps_ph(_mm256_loadu_ps(src + i), _MM_FROUND_TO_NEAREST_INT);
+        _mm_storeu_si128((__m128i *)(dst + i), h);
+    }
+    floatToHalfC(src + i, n - i, dst + i);
+}
+#endif
+
+static FloatToHalfFcn getFloatToHalfFcn()
+{
+#ifdef MW_COMPACT_X86
+    if (cv::checkHardwareSupport(CV_CPU_AVX2) && cv::checkHardwareSupport(CV_CPU_FMA3))
+        return floatToHalfF16C;
+#endif
+    return floatToHalfC;
+}
+
+static inline signed char floatToInt8(float f)
+{
+    const float s = std::floor(f * DESCRIPTOR_INT8_SCALE + 0.5f);
+    // false for NaN
+    if (!(s > -127.0f))
+        return s < 0 ? -127 : 0;
+    return (signed char)std::min(s, 127.0f);
+}
+
+static void floatToInt8C(const float *src, size_t n, signed char *dst)
+{
+    for (size_t i = 0; i < n; ++i)
+        dst[i] = floatToInt8(src[i]);
+}
+
+// Converts each row of descriptors with convert, then transposes to column
+// major unless isRowMajor
+template <typename T, typename Fcn>
+static void compact(const float *descriptors, int numFeatures, int numel,
+                    bool isRowMajor, T *out, Fcn convert)
+{
+    const size_t n = (size_t)numFeatures, m = (size_t)numel;
+    if (isRowMajor)
+    {
+        convert(descriptors, n * m, out);
+        return;
+    }
+
+    std::vector<T> row(m);
+    for (size_t i = 0; i < n; ++i)
+    {
+        convert(descriptors + i * m, m, &row[0]);
+        for (size_t j = 0; j < m; ++j)
+            out[i + j * n] = row[j];
+    }
+}
+
+void compactDescriptors(const float *descriptors, int numFeatures, int numel,
+                        bool isRowMajor, unsigned short *outHalf)
+{
+    if (numFeatures <= 0 || numel <= 0)
+        return;
+    static const FloatToHalfFcn convert = getFloatToHalfFcn();
+    compact(descriptors, numFeatures, numel, isRowMajor, outHalf, convert);
+}
+
+void compactDescriptors(const float *descriptors, int numFeatures, int numel,
+                        bool isRowMajor, signed char *outInt8)
+{
+    if (numFeatures <= 0 || numel <= 0)
+        return;
+    compact(descriptors, numFeatures, numel, isRowMajor, outInt8, floatToInt8C);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Portable kernels
+///////////////////////////////////////////////////////////////////////////////
+static float ssdHalfC(const unsigned short *a, const unsigned short *b,
+                      size_t numel)
+{
+    float result = 0;
+    for (size_t i = 0; i < numel; ++i)
+    {
+        const float d = halfToFloat(a[i]) - halfToFloat(b[i]);
+        result += d * d;
+    }
+    return result;
+}
+
+static int ssdInt8C(const signed char *a, const signed char *b, size_t numel)
+{
+    int result = 0;
+    for (size_t i = 0; i < numel; ++i)
+    {
+        const int d = (int)a[i] - (int)b[i];
+        result += d * d;
+    }
+    return result;
+}
+
+#ifdef MW_COMPACT_NEON
+///////////////////////////////////////////////////////////////////////////////
+// NEON: widening subtract and multiply-accumulate of 8 elements at a time
+///////////////////////////////////////////////////////////////////////////////
+static int ssdInt8NEON(const signed char *a, const signed char *b, size_t numel)
+{
+    int32x4_t acc = vdupq_n_s32(0);
+    size_t i = 0;
+    for (; i + 8 <= numel; i += 8)
+    {
+        int16x8_t d = vsubl_s8(vld1_s8(a + i), vld1_s8(b + i));
+        acc = vmlal_s16(acc, vget_low_s16(d), vget_low_s16(d));
+        acc = vmlal_s16(acc, vget_high_s16(d), vget_high_s16(d));
+    }
+    int result = vgetq_lane_s32(acc, 0) + vgetq_lane_s32(acc, 1) +
+                 vgetq_lane_s32(acc, 2) + vgetq_lane_s32(acc, 3);
+    return result + ssdInt8C(a + i, b + i, numel - i);
+}
+#endif
+
+#ifdef MW_COMPACT_X86
+///////////////////////////////////////////////////////////////////////////////
+// SSE2: sign extension by unpacking, pmaddwd squares and adds pairs of the
+// 16-bit differences
+///////////////////////////////////////////////////////////////////////////////
+MW_TARGET_SSE2
+static int ssdInt8SSE2(const signed char *a, const signed char *b, size_t numel)
+{
+    __m128i acc = _mm_setzero_si128();
+    size_t i = 0;
+    for (; i + 16 <= numel; i += 16)
+    {
+        __m128i va = _mm_loadu_si128((const __m128i *)(a + i));
+        __m128i vb = _mm_loadu_si128((const __m128i *)(b + i));
+        __m128i dlo = _mm_sub_epi16(_mm_srai_epi16(_mm_unpacklo_epi8(va, va), 8),
+                                    _mm_srai_epi16(_mm_unpacklo_epi8(vb, vb), 8));
+        __m128i dhi = _mm_sub_epi16(_mm_srai_epi16(_mm_unpackhi_epi8(va, va), 8),
+                                    _mm_srai_epi16(_mm_unpackhi_epi8(vb, vb), 8));
+        acc = _mm_add_epi32(acc, _mm_madd_epi16(dlo, dlo));
+        acc = _mm_add_epi32(acc, _mm_madd_epi16(dhi, dhi));
+    }
+    int sums[4];
+    _mm_storeu_si128((__m128i *)sums, acc);
+    return sums[0] + sums[1] + sums[2] + sums[3] +
+           ssdInt8C(a + i, b + i, numel - i);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// AVX2: 16 elements at a time, widened with vpmovsxbw and accumulated with
+// vpmaddwd. The differences of int8 values fit in 16 bits, and the sum of
+// two squares in 32 bits.
+///////////////////////////////////////////////////////////////////////////////
+MW_TARGET_AVX2
+static int ssdInt8AVX2(const signed char *a, const signed char *b, size_t numel)
+{
+    __m256i acc = _mm256_setzero_si256();
+    size_t i = 0;
+    for (; i + 16 <= numel; i += 16)
+    {
+        __m256i va = _mm256_cvtepi8_epi16(_mm_loadu_si128((const __m128i *)(a + i)));
+        __m256i vb = _mm256_cvtepi8_epi16(_mm_loadu_si128((const __m128i *)(b + i)));
+        __m256i d  = _mm256_sub_epi16(va, vb);
+        acc = _mm256_add_epi32(acc, _mm256_madd_epi16(d, d));
+    }
+    __m128i s = _mm_add_epi32(_mm256_castsi256_si128(acc),
+                              _mm256_extracti128_si256(acc, 1));
+    int sums[4];
+    _mm_storeu_si128((__m128i *)sums, s);
+    return sums[0] + sums[1] + sums[2] + sums[3] +
+           ssdInt8C(a + i, b + i, numel - i);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// AVX2: vcvtph2ps widens 8 halves at a time, accumulated with FMA in two
+// chains. KAZE and SURF descriptors are 64 or 128 elements.
+///////////////////////////////////////////////////////////////////////////////
+MW_TARGET_AVX2
+static float ssdHalfAVX2(const unsigned short *a, const unsigned short *b,
+                         size_t numel)
+{
+    __m256 acc0 = _mm256_setzero_ps();
+    __m256 acc1 = _mm256_setzero_ps();
+    size_t i = 0;
+    for (; i + 16 <= numel; i += 16)
+    {
+        __m256 d0 = _mm256_sub_ps(
+            _mm256_cvtph_ps(_mm_loadu_si128((const __m128i *)(a + i))),
+            _mm256_cvtph_ps(_mm_loadu_si128((const __m128i *)(b + i))));
+        __m256 d1 = _mm256_sub_ps(
+            _mm256_cvtph_ps(_mm_loadu_si128((const __m128i *)(a + i + 8))),
+            _mm256_cvtph_ps(_mm_loadu_si128((const __m128i *)(b + i + 8))));
+        acc0 = _mm256_fmadd_ps(d0, d0, acc0);
+        acc1 = _mm256_fmadd_ps(d1, d1, acc1);
+    }
+    for (; i + 8 <= numel; i += 8)
+    {
+        __m256 d = _mm256_sub_ps(
+            _mm256_cvtph_ps(_mm_loadu_si128((const __m128i *)(a + i))),
+            _mm256_cvtph_ps(_mm_loadu_si128((const __m128i *)(b + i))));
+        acc0 = _mm256_fmadd_ps(d, d, acc0);
+    }
+    __m256 acc = _mm256_add_ps(acc0, acc1);
+    __m128 s = _mm_add_ps(_mm256_castps256_ps128(acc), _mm256_extractf128_ps(acc, 1));
+    s = _mm_hadd_ps(s, s);
+    s = _mm_hadd_ps(s, s);
+    return _mm_cvtss_f32(s) + ssdHalfC(a + i, b + i, numel - i);
+}
+#endif
+
+///////////////////////////////////////////////////////////////////////////////
+SsdHalfFcn getSsdHalfFcn()
+{
+#ifdef MW_COMPACT_X86
+    if (cv::checkHardwareSupport(CV_CPU_AVX2) && cv::checkHardwareSupport(CV_CPU_FMA3))
+        return ssdHalfAVX2;
+#endif
+    return ssdHalfC;
+}
+
+SsdInt8Fcn getSsdInt8Fcn()
+{
+#if defined(MW_COMPACT_NEON)
+    return ssdInt8NEON;
+#elif defined(MW_COMPACT_X86)
+    if (cv::checkHardwareSupport(CV_CPU_AVX2))
+        return ssdInt8AVX2;
+    if (cv::checkHardwareSupport(CV_CPU_SSE2))
+        return ssdInt8SSE2;
+    return ssdInt8C;
+#else
+    return ssdInt8C;
+#endif
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Exhaustive kNN search
+///////////////////////////////////////////////////////////////////////////////
+
+// Block sizes of hammingKnnMatch: 32 query and 256 train descriptors of 128
+// halves occupy 72 KB and stay in L2 while all pairs are compared.
+const int SSD_QUERY_BLOCK = 32;
+const int SSD_TRAIN_BLOCK = 256;
+
+// Inserts (index, dist) into the sorted list of the k best neighbors.
+template <typename D>
+static inline void insertNeighbor(int *indices, D *dists, int knn,
+                                  int index, D dist)
+{
+    int j = knn - 1;
+    if (!(dist < dists[j]))
+        return;
+    while (j > 0 && dists[j-1] > dist)
+    {
+        dists[j]   = dists[j-1];
+        indices[j] = indices[j-1];
+        --j;
+    }
+    dists[j]   = dist;
+    indices[j] = index;
+}
+
+// D is the type of the kernel distance, converted to the SSD of the single
+// descriptors by multiplying with scale
+template <typename T, typename D>
+struct SsdKnnInvoker : cv::ParallelLoopBody
+{
+    typedef D (*DistanceFcn)(const T *a, const T *b, size_t numel);
+
+    SsdKnnInvoker(const T *_query, int _numQuery, const T *_train, int _numTrain,
+                  int _numel, int _knn, DistanceFcn _distance, D _maxDist,
+                  float _scale, int *_indices, float *_dists)
+    {
+        query = _query;
+        numQuery = _numQuery;
+        train = _train;
+        numTrain = _numTrain;
+        numel = _numel;
+        knn = _knn;
+        distance = _distance;
+        maxDist = _maxDist;
+        scale = _scale;
+        indices = _indices;
+        dists = _dists;
+    }
+
+    void operator()(const cv::Range& range) const
+    {
+        CG_TRACE_SPAN("SsdKnnInvoker");
+        std::vector<D> blockDists((size_t)SSD_QUERY_BLOCK * knn);
+
+        for (int qb = range.start; qb < range.end; ++qb)
+        {
+            const int q0 = qb * SSD_QUERY_BLOCK;
+            const int q1 = std::min(q0 + SSD_QUERY_BLOCK, numQuery);
+
+            std::fill(indices + q0*knn, indices + q1*knn, -1);
+            std::fill(blockDists.begin(), blockDists.end(), maxDist);
+
+            for (int t0 = 0; t0 < numTrain; t0 += SSD_TRAIN_BLOCK)
+            {
+                const int t1 = std::min(t0 + SSD_TRAIN_BLOCK, numTrain);
+                for (int q = q0; q < q1; ++q)
+                {
+                    const T *qPtr = query + (size_t)q * numel;
+                    int *qIndices = indices + q*knn;
+                    D *qDists = &blockDists[(size_t)(q - q0) * knn];
+                    for (int t = t0; t < t1; ++t)
+                    {
+                        D d = distance(qPtr, train + (size_t)t * numel, numel);
+                        insertNeighbor(qIndices, qDists, knn, t, d);
+                    }
+                }
+            }
+
+            // unused neighbor slots are -1
+            const int numFound = std::min(knn, numTrain);
+            for (int q = q0; q < q1; ++q)
+            {
+                const D *qDists = &blockDists[(size_t)(q - q0) * knn];
+                for (int k = 0; k < knn; ++k)
+                    dists[q*knn + k] = k < numFound ? (float)qDists[k] * scale : -1.0f;
+            }
+        }
+    }
+
+    const T *query;
+    int numQuery;
+    const T *train;
+    int numTrain;
+    int numel;
+    int knn;
+    DistanceFcn distance;
+    D maxDist;
+    float scale;
+    int *indices;
+    float *dists;
+};
+
+template <typename T, typename D>
+static void ssdKnnMatch(const T *query, int numQuery, const T *train,
+                        int numTrain, int numel, int knn,
+                        D (*distance)(const T *, const T *, size_t), D maxDist,
+                        float scale, int *indices, float *dists)
+{
+    const int numQueryBlocks = (numQuery + SSD_QUERY_BLOCK - 1) / SSD_QUERY_BLOCK;
+
+    cv::parallel_for_(cv::Range(0, numQueryBlocks),
+        SsdKnnInvoker<T, D>(query, numQuery, train, numTrain, numel, knn,
+                            distance, maxDist, scale, indices, dists));
+}
+
+void ssdKnnMatch(const unsigned short *query, int numQuery,
+                 const unsigned short *train, int numTrain,
+                 int numel, int knn, int *indices, float *dists)
+{
+    static const SsdHalfFcn distance = getSsdHalfFcn();
+    ssdKnnMatch(query, numQuery, train, numTrain, numel, knn, distance,
+                FLT_MAX, 1.0f, indices, dists);
+}
+
+void ssdKnnMatch(const signed char *query, int numQuery,
+                 const signed char *train, int numTrain,
+                 int numel, int knn, int *indices, float *dists)
+{
+    static const SsdInt8Fcn distance = getSsdInt8Fcn();
+    ssdKnnMatch(query, numQuery, train, numTrain, numel, knn, distance,
+                INT_MAX, 1.0f / (DESCRIPTOR_INT8_SCALE * DESCRIPTOR_INT8_SCALE),
+                indices, dists);
+}
+
+} // namespace vision
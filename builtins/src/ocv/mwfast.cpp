@@ -48,17 +48,104 @@ The references are:
 # pragma warning( disable : 4127)
 #endif
 
+// GCC and Clang compile the AVX2 segment test for its instruction set
+// regardless of the global compiler flags, as the Hamming kernels do; it is
+// only called after a run-time CPU check.
+#if CV_SSE2 && (defined(__GNUC__) || defined(__clang__))
+#include <immintrin.h>
+#define MW_FAST_AVX2 1
+#define MW_TARGET_AVX2 __attribute__((target("avx2")))
+#elif CV_SSE2 && defined(_MSC_VER)
+#include <immintrin.h>
+#define MW_FAST_AVX2 1
+#define MW_TARGET_AVX2
+#endif
+
 namespace cv
 {
 
+#if MW_FAST_AVX2
+// FAST 9_16 segment test of the columns j..jEnd-1 of a row, 32 pixels at a
+// time, as the SSE2 loop of FAST_t does 16. Returns the first column left to
+// the SSE2 and scalar loops.
+MW_TARGET_AVX2
+static int FAST16Row_AVX2(const uchar* row, int j, int jEnd, const int pixel[], int threshold,
+                          bool nonmax_suppression, uchar* curr, int* cornerpos, int& ncorners)
+{
+    const int K = 8, N = 16 + K + 1;
+    const __m256i delta = _mm256_set1_epi8(-128), t = _mm256_set1_epi8((char)threshold),
+                  K32 = _mm256_set1_epi8((char)K);
+
+    for( ; j < jEnd; j += 32 )
+    {
+        const uchar* ptr = row + j;
+        __m256i m0, m1;
+        __m256i v0 = _mm256_loadu_si256((const __m256i*)ptr);
+        __m256i v1 = _mm256_xor_si256(_mm256_subs_epu8(v0, t), delta);
+        v0 = _mm256_xor_si256(_mm256_adds_epu8(v0, t), delta);
+
+        __m256i x0 = _mm256_sub_epi8(_mm256_loadu_si256((const __m256i*)(ptr + pixel[0])), delta);
+        __m256i x1 = _mm256_sub_epi8(_mm256_loadu_si256((const __m256i*)(ptr + pixel[4])), delta);
+        __m256i x2 = _mm256_sub_epi8(_mm256_loadu_si256((const __m256i*)(ptr + pixel[8])), delta);
+        __m256i x3 = _mm256_sub_epi8(_mm256_loadu_si256((const __m256i*)(ptr + pixel[12])), delta);
+        m0 = _mm256_and_si256(_mm256_cmpgt_epi8(x0, v0), _mm256_cmpgt_epi8(x1, v0));
+        m1 = _mm256_and_si256(_mm256_cmpgt_epi8(v1, x0), _mm256_cmpgt_epi8(v1, x1));
+        m0 = _mm256_or_si256(m0, _mm256_and_si256(_mm256_cmpgt_epi8(x1, v0), _mm256_cmpgt_epi8(x2, v0)));
+        m1 = _mm256_or_si256(m1, _mm256_and_si256(_mm256_cmpgt_epi8(v1, x1), _mm256_cmpgt_epi8(v1, x2)));
+        m0 = _mm256_or_si256(m0, _mm256_and_si256(_mm256_cmpgt_epi8(x2, v0), _mm256_cmpgt_epi8(x3, v0)));
+        m1 = _mm256_or_si256(m1, _mm256_and_si256(_mm256_cmpgt_epi8(v1, x2), _mm256_cmpgt_epi8(v1, x3)));
+        m0 = _mm256_or_si256(m0, _mm256_and_si256(_mm256_cmpgt_epi8(x3, v0), _mm256_cmpgt_epi8(x0, v0)));
+        m1 = _mm256_or_si256(m1, _mm256_and_si256(_mm256_cmpgt_epi8(v1, x3), _mm256_cmpgt_epi8(v1, x0)));
+        m0 = _mm256_or_si256(m0, m1);
+        unsigned mask = (unsigned)_mm256_movemask_epi8(m0);
+        if( mask == 0 )
+            continue;
+        if( (mask & 0xFFFF) == 0 )
+        {
+            j -= 16;
+            continue;
+        }
+
+        __m256i c0 = _mm256_setzero_si256(), c1 = c0, max0 = c0, max1 = c0;
+        for( int k = 0; k < N; k++ )
+        {
+            __m256i x = _mm256_xor_si256(_mm256_loadu_si256((const __m256i*)(ptr + pixel[k])), delta);
+            m0 = _mm256_cmpgt_epi8(x, v0);
+            m1 = _mm256_cmpgt_epi8(v1, x);
+
+            c0 = _mm256_and_si256(_mm256_sub_epi8(c0, m0), m0);
+            c1 = _mm256_and_si256(_mm256_sub_epi8(c1, m1), m1);
+
+            max0 = _mm256_max_epu8(max0, c0);
+            max1 = _mm256_max_epu8(max1, c1);
+        }
+
+        max0 = _mm256_max_epu8(max0, max1);
+        unsigned m = (unsigned)_mm256_movemask_epi8(_mm256_cmpgt_epi8(max0, K32));
+
+        for( int k = 0; m != 0 && k < 32; k++, m >>= 1 )
+            if( m & 1 )
+            {
+                cornerpos[ncorners++] = j+k;
+                if( nonmax_suppression )
+                    curr[j+k] = (uchar)cornerScore<16>(ptr+k, pixel, threshold);
+            }
+    }
+    return j;
+}
+#endif
+
 template<int patternSize>
 void FAST_t(InputArray _img, std::vector<KeyPoint>& keypoints, int threshold, bool nonmax_suppression)
 {
     Mat img = _img.getMat();
     const int K = patternSize/2, N = patternSize + K + 1;
-#if CV_SSE2
+#if CV_SSE2 || CV_NEON
     const int quarterPatternSize = patternSize/4;
     (void)quarterPatternSize;
+#endif
+#if MW_FAST_AVX2
+    const bool useAVX2 = patternSize == 16 && checkHardwareSupport(CV_CPU_AVX2);
 #endif
     int i, j, k, pixel[25];
     makeOffsets(pixel, (int)img.step, patternSize);
@@ -72,6 +159,10 @@ void FAST_t(InputArray _img, std::vector<KeyPoint>& keypoints, int threshold, bo
     (void)K16;
     (void)delta;
     (void)t;
+#elif CV_NEON
+    uint8x16_t t = vdupq_n_u8((uchar)threshold), K16 = vdupq_n_u8((uchar)K);
+    (void)K16;
+    (void)t;
 #endif
     uchar threshold_tab[512];
     for( i = -255; i <= 255; i++ )
@@ -97,6 +188,14 @@ void FAST_t(InputArray _img, std::vector<KeyPoint>& keypoints, int threshold, bo
         if( i < img.rows - 3 )
         {
             j = 3;
+    #if MW_FAST_AVX2
+            if( useAVX2 )
+            {
+                j = FAST16Row_AVX2(img.ptr<uchar>(i), j, img.cols - 32 - 3, pixel, threshold,
+                                   nonmax_suppression, curr, cornerpos, ncorners);
+                ptr = img.ptr<uchar>(i) + j;
+            }
+    #endif
     #if CV_SSE2
             if( patternSize == 16 )
             {
@@ -156,6 +255,67 @@ void FAST_t(InputArray _img, std::vector<KeyPoint>& keypoints, int threshold, bo
                         }
                 }
             }
+    #elif CV_NEON
+            if( patternSize == 16 )
+            {
+                for(; j < img.cols - 16 - 3; j += 16, ptr += 16)
+                {
+                    // the comparisons are unsigned, with no bias as in SSE2
+                    uint8x16_t m0, m1;
+                    uint8x16_t v = vld1q_u8(ptr);
+                    uint8x16_t v0 = vqaddq_u8(v, t);
+                    uint8x16_t v1 = vqsubq_u8(v, t);
+
+                    uint8x16_t x0 = vld1q_u8(ptr + pixel[0]);
+                    uint8x16_t x1 = vld1q_u8(ptr + pixel[quarterPatternSize]);
+                    uint8x16_t x2 = vld1q_u8(ptr + pixel[2*quarterPatternSize]);
+                    uint8x16_t x3 = vld1q_u8(ptr + pixel[3*quarterPatternSize]);
+                    m0 = vandq_u8(vcgtq_u8(x0, v0), vcgtq_u8(x1, v0));
+                    m1 = vandq_u8(vcltq_u8(x0, v1), vcltq_u8(x1, v1));
+                    m0 = vorrq_u8(m0, vandq_u8(vcgtq_u8(x1, v0), vcgtq_u8(x2, v0)));
+                    m1 = vorrq_u8(m1, vandq_u8(vcltq_u8(x1, v1), vcltq_u8(x2, v1)));
+                    m0 = vorrq_u8(m0, vandq_u8(vcgtq_u8(x2, v0), vcgtq_u8(x3, v0)));
+                    m1 = vorrq_u8(m1, vandq_u8(vcltq_u8(x2, v1), vcltq_u8(x3, v1)));
+                    m0 = vorrq_u8(m0, vandq_u8(vcgtq_u8(x3, v0), vcgtq_u8(x0, v0)));
+                    m1 = vorrq_u8(m1, vandq_u8(vcltq_u8(x3, v1), vcltq_u8(x0, v1)));
+                    m0 = vorrq_u8(m0, m1);
+                    uint64x2_t mask = vreinterpretq_u64_u8(m0);
+                    uint64_t maskLo = vgetq_lane_u64(mask, 0);
+                    if( (maskLo | vgetq_lane_u64(mask, 1)) == 0 )
+                        continue;
+                    if( maskLo == 0 )
+                    {
+                        j -= 8;
+                        ptr -= 8;
+                        continue;
+                    }
+
+                    uint8x16_t c0 = vdupq_n_u8(0), c1 = c0, max0 = c0, max1 = c0;
+                    for( k = 0; k < N; k++ )
+                    {
+                        uint8x16_t x = vld1q_u8(ptr + pixel[k]);
+                        m0 = vcgtq_u8(x, v0);
+                        m1 = vcltq_u8(x, v1);
+
+                        c0 = vandq_u8(vsubq_u8(c0, m0), m0);
+                        c1 = vandq_u8(vsubq_u8(c1, m1), m1);
+
+                        max0 = vmaxq_u8(max0, c0);
+                        max1 = vmaxq_u8(max1, c1);
+                    }
+
+                    uchar isCorner[16];
+                    vst1q_u8(isCorner, vcgtq_u8(vmaxq_u8(max0, max1), K16));
+
+                    for( k = 0; k < 16; k++ )
+                        if( isCorner[k] )
+                        {
+                            cornerpos[ncorners++] = j+k;
+                            if(nonmax_suppression)
+                                curr[j+k] = (uchar)cornerScore<patternSize>(ptr+k, pixel, threshold);
+                        }
+                }
+            }
     #endif
             for( ; j < img.cols - 3; j++, ptr++ )
             {
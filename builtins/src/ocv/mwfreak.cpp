@@ -41,6 +41,7 @@
 #include <algorithm>
 #include <iomanip>
 #include <string.h>
+#include "cgProfile.hpp"
 
 namespace cv
 {
@@ -100,6 +101,14 @@ protected:
     template <typename srcMatType>
     void extractDescriptor(srcMatType *pointsValue, void ** ptr);
 
+    template <typename srcMatType, typename iiMatType>
+    void describeKeypoint( const Mat& image, const Mat& imgIntegral, KeyPoint& keypoint,
+                           int scaleIdx, uchar* descriptor );
+
+    // computes the descriptors of a range of keypoints, each row on its own
+    template <typename srcMatType, typename iiMatType>
+    class DescriptorInvoker;
+
     bool orientationNormalized; //true if the orientation is normalized, false otherwise
     bool scaleNormalized; //true if the scale is normalized, false otherwise
     double patternScale; //scaling of the pattern
@@ -443,6 +452,85 @@ void FREAK_Impl::extractDescriptor(uchar *pointsValue, void ** ptr)
 }
 #endif
 
+template <typename srcMatType, typename iiMatType>
+void FREAK_Impl::describeKeypoint( const Mat& image, const Mat& imgIntegral, KeyPoint& keypoint,
+                                   int scaleIdx, uchar* descriptor )
+{
+    srcMatType pointsValue[FREAK_NB_POINTS];
+    int thetaIdx = 0;
+
+    // estimate orientation (gradient)
+    if( !orientationNormalized )
+    {
+        keypoint.angle = 0.0; // assign 0 degree to all keypoints
+    }
+    else
+    {
+        // get the points intensity value in the un-rotated pattern
+        for( int i = FREAK_NB_POINTS; i--; ) {
+            pointsValue[i] = meanIntensity<srcMatType, iiMatType>(image, imgIntegral,
+                                                                  keypoint.pt.x, keypoint.pt.y,
+                                                                  scaleIdx, 0, i);
+        }
+        int direction0 = 0;
+        int direction1 = 0;
+        for( int m = 45; m--; )
+        {
+            //iterate through the orientation pairs
+            const int delta = (pointsValue[ orientationPairs[m].i ]-pointsValue[ orientationPairs[m].j ]);
+            direction0 += delta*(orientationPairs[m].weight_dx)/2048;
+            direction1 += delta*(orientationPairs[m].weight_dy)/2048;
+        }
+
+        keypoint.angle = static_cast<float>(atan2((float)direction1,(float)direction0)*(180.0/CV_PI));//estimate orientation
+        thetaIdx = int(FREAK_NB_ORIENTATION*keypoint.angle*(1/360.0)+0.5);
+        if( thetaIdx < 0 )
+            thetaIdx += FREAK_NB_ORIENTATION;
+
+        if( thetaIdx >= FREAK_NB_ORIENTATION )
+            thetaIdx -= FREAK_NB_ORIENTATION;
+    }
+    // extract descriptor at the computed orientation
+    for( int i = FREAK_NB_POINTS; i--; ) {
+        pointsValue[i] = meanIntensity<srcMatType, iiMatType>(image, imgIntegral,
+                                                              keypoint.pt.x, keypoint.pt.y,
+                                                              scaleIdx, thetaIdx, i);
+    }
+
+    // extractDescriptor moves the pointer off the row, which is not used again
+    void *ptr = descriptor;
+    extractDescriptor<srcMatType>(pointsValue, &ptr);
+}
+
+template <typename srcMatType, typename iiMatType>
+class FREAK_Impl::DescriptorInvoker : public ParallelLoopBody
+{
+public:
+    DescriptorInvoker( FREAK_Impl& _freak, const Mat& _image, const Mat& _imgIntegral,
+                       std::vector<KeyPoint>& _keypoints, const std::vector<int>& _kpScaleIdx,
+                       Mat& _descriptors )
+        : freak(&_freak), image(_image), imgIntegral(_imgIntegral),
+          keypoints(&_keypoints), kpScaleIdx(&_kpScaleIdx), descriptors(_descriptors)
+    {
+    }
+
+    void operator()( const Range& range ) const
+    {
+        CG_TRACE_SPAN("FREAK_Impl::DescriptorInvoker");
+        for( int k = range.start; k < range.end; k++ )
+            freak->template describeKeypoint<srcMatType, iiMatType>(image, imgIntegral, (*keypoints)[k],
+                                                                    (*kpScaleIdx)[k], descriptors.data + k*descriptors.step[0]);
+    }
+
+private:
+    FREAK_Impl* freak;
+    Mat image;
+    Mat imgIntegral;
+    std::vector<KeyPoint>* keypoints;
+    const std::vector<int>* kpScaleIdx;
+    Mat descriptors;
+};
+
 template <typename srcMatType, typename iiMatType>
 void FREAK_Impl::computeDescriptors( InputArray _image, std::vector<KeyPoint>& keypoints, OutputArray _descriptors ){
 
@@ -509,51 +597,11 @@ void FREAK_Impl::computeDescriptors( InputArray _image, std::vector<KeyPoint>& k
         _descriptors.setTo(Scalar::all(0));
         Mat descriptors = _descriptors.getMat();
 
-        void *ptr = descriptors.data+(keypoints.size()-1)*descriptors.step[0];
-
-        for( size_t k = keypoints.size(); k--; ) {
-            // estimate orientation (gradient)
-            if( !orientationNormalized )
-            {
-                thetaIdx = 0; // assign 0 to all keypoints
-                keypoints[k].angle = 0.0;
-            }
-            else
-            {
-                // get the points intensity value in the un-rotated pattern
-                for( int i = FREAK_NB_POINTS; i--; ) {
-                    pointsValue[i] = meanIntensity<srcMatType, iiMatType>(image, imgIntegral,
-                                                                          keypoints[k].pt.x, keypoints[k].pt.y,
-                                                                          kpScaleIdx[k], 0, i);
-                }
-                direction0 = 0;
-                direction1 = 0;
-                for( int m = 45; m--; )
-                {
-                    //iterate through the orientation pairs
-                    const int delta = (pointsValue[ orientationPairs[m].i ]-pointsValue[ orientationPairs[m].j ]);
-                    direction0 += delta*(orientationPairs[m].weight_dx)/2048;
-                    direction1 += delta*(orientationPairs[m].weight_dy)/2048;
-                }
-
-                keypoints[k].angle = static_cast<float>(atan2((float)direction1,(float)direction0)*(180.0/CV_PI));//estimate orientation
-                thetaIdx = int(FREAK_NB_ORIENTATION*keypoints[k].angle*(1/360.0)+0.5);
-                if( thetaIdx < 0 )
-                    thetaIdx += FREAK_NB_ORIENTATION;
-
-                if( thetaIdx >= FREAK_NB_ORIENTATION )
-                    thetaIdx -= FREAK_NB_ORIENTATION;
-            }
-            // extract descriptor at the computed orientation
-            for( int i = FREAK_NB_POINTS; i--; ) {
-                pointsValue[i] = meanIntensity<srcMatType, iiMatType>(image, imgIntegral,
-                                                                      keypoints[k].pt.x, keypoints[k].pt.y,
-                                                                      kpScaleIdx[k], thetaIdx, i);
-            }
-
-            // Extract descriptor
-            extractDescriptor<srcMatType>(pointsValue, &ptr);
-        }
+        // the pattern lookup table is read only here, so the keypoints are
+        // described in parallel, each into its own descriptor row
+        parallel_for_(Range(0, (int)keypoints.size()),
+                      DescriptorInvoker<srcMatType, iiMatType>(*this, image, imgIntegral,
+                                                               keypoints, kpScaleIdx, descriptors));
     }
     else // extract all possible comparisons for selection
     {
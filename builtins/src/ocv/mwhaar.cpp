@@ -45,6 +45,7 @@
 #include "mwobjdetect.hpp"
 #include <stdio.h>
 #include "opencv2/core.hpp"
+#include "cgProfile.hpp"
 
 #if CV_SSE2
 #   if 1 /*!CV_SSE4_1 && !CV_SSE4_2*/
@@ -1318,6 +1319,7 @@ public:
 
     void operator()( const Range& range ) const
     {
+        CG_TRACE_SPAN("HaarDetectObjects_ScaleImage_Invoker");
         Size winSize0 = cascade->orig_window_size;
         Size winSize(cvRound(winSize0.width*factor), cvRound(winSize0.height*factor));
         int y1 = range.start*stripSize, y2 = min(range.end*stripSize, sum1.rows - 1 - winSize0.height);
@@ -1450,6 +1452,7 @@ public:
 
     void operator()( const Range& range ) const
     {
+        CG_TRACE_SPAN("HaarDetectObjects_ScaleCascade_Invoker");
         int iy, startY = range.start, endY = range.end;
         const int *p0 = p[0], *p1 = p[1], *p2 = p[2], *p3 = p[3];
         const int *pq0 = pq[0], *pq1 = pq[1], *pq2 = pq[2], *pq3 = pq[3];
@@ -0,0 +1,278 @@
+//////////////////////////////////////////////////////////////////////////////
+// Hamming distance kernels for binary feature descriptors.
+//
+// Copyright 2016 The MathWorks, Inc.
+//
+//////////////////////////////////////////////////////////////////////////////
+
+#include "mwhamming.hpp"
+
+#include <algorithm>
+#include <climits>
+#include <cstring>
+#include <vector>
+
+#include "opencv2/core.hpp"
+#include "cgProfile.hpp"
+
+#if defined(__ARM_NEON__) || defined(__ARM_NEON)
+#include <arm_neon.h>
+#define MW_HAMMING_NEON 1
+#elif defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#include <immintrin.h>
+#define MW_HAMMING_X86 1
+#endif
+
+// GCC and Clang compile the x86 kernels for their target instruction set
+// regardless of the global compiler flags. MSVC always accepts the
+// intrinsics. The kernels are only called after a run-time CPU check.
+#if defined(MW_HAMMING_X86) && (defined(__GNUC__) || defined(__clang__))
+#define MW_TARGET_POPCNT __attribute__((target("popcnt")))
+#define MW_TARGET_AVX2   __attribute__((target("avx2,popcnt")))
+#else
+#define MW_TARGET_POPCNT
+#define MW_TARGET_AVX2
+#endif
+
+// 64-bit POPCNT is not available on 32-bit x86
+#if defined(__x86_64__) || defined(_M_X64)
+#define MW_HAMMING_POPCNT64 1
+#endif
+
+namespace vision
+{
+
+static const unsigned char popCountTable[] =
+{
+    0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4, 1, 2, 2, 3, 2, 3, 3, 4, 2, 3, 3, 4, 3, 4, 4, 5,
+    1, 2, 2, 3, 2, 3, 3, 4, 2, 3, 3, 4, 3, 4, 4, 5, 2, 3, 3, 4, 3, 4, 4, 5, 3, 4, 4, 5, 4, 5, 5, 6,
+    1, 2, 2, 3, 2, 3, 3, 4, 2, 3, 3, 4, 3, 4, 4, 5, 2, 3, 3, 4, 3, 4, 4, 5, 3, 4, 4, 5, 4, 5, 5, 6,
+    2, 3, 3, 4, 3, 4, 4, 5, 3, 4, 4, 5, 4, 5, 5, 6, 3, 4, 4, 5, 4, 5, 5, 6, 4, 5, 5, 6, 5, 6, 6, 7,
+    1, 2, 2, 3, 2, 3, 3, 4, 2, 3, 3, 4, 3, 4, 4, 5, 2, 3, 3, 4, 3, 4, 4, 5, 3, 4, 4, 5, 4, 5, 5, 6,
+    2, 3, 3, 4, 3, 4, 4, 5, 3, 4, 4, 5, 4, 5, 5, 6, 3, 4, 4, 5, 4, 5, 5, 6, 4, 5, 5, 6, 5, 6, 6, 7,
+    2, 3, 3, 4, 3, 4, 4, 5, 3, 4, 4, 5, 4, 5, 5, 6, 3, 4, 4, 5, 4, 5, 5, 6, 4, 5, 5, 6, 5, 6, 6, 7,
+    3, 4, 4, 5, 4, 5, 5, 6, 4, 5, 5, 6, 5, 6, 6, 7, 4, 5, 5, 6, 5, 6, 6, 7, 5, 6, 6, 7, 6, 7, 7, 8
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// Portable table lookup
+///////////////////////////////////////////////////////////////////////////////
+static int hammingLUT(const unsigned char *a, const unsigned char *b,
+                      size_t numBytes)
+{
+    int result = 0;
+    for (size_t i = 0; i < numBytes; ++i)
+    {
+        result += popCountTable[a[i] ^ b[i]];
+    }
+    return result;
+}
+
+#ifdef MW_HAMMING_NEON
+///////////////////////////////////////////////////////////////////////////////
+// NEON: vcnt counts the bits of 16 bytes at a time
+///////////////////////////////////////////////////////////////////////////////
+static int hammingNEON(const unsigned char *a, const unsigned char *b,
+                       size_t numBytes)
+{
+    uint32x4_t bits = vmovq_n_u32(0);
+    size_t i = 0;
+    for (; i + 16 <= numBytes; i += 16)
+    {
+        uint8x16_t AxorB   = veorq_u8(vld1q_u8(a + i), vld1q_u8(b + i));
+        uint8x16_t bitsSet = vcntq_u8(AxorB);
+        uint16x8_t bitSet8 = vpaddlq_u8(bitsSet);
+        bits = vaddq_u32(bits, vpaddlq_u16(bitSet8));
+    }
+    uint64x2_t bitSet2 = vpaddlq_u32(bits);
+    int result = (int)(vgetq_lane_u64(bitSet2, 0) + vgetq_lane_u64(bitSet2, 1));
+    return result + hammingLUT(a + i, b + i, numBytes - i);
+}
+#endif
+
+#ifdef MW_HAMMING_X86
+///////////////////////////////////////////////////////////////////////////////
+// POPCNT: one instruction per 8 (or 4) bytes
+///////////////////////////////////////////////////////////////////////////////
+MW_TARGET_POPCNT
+static int hammingPOPCNT(const unsigned char *a, const unsigned char *b,
+                         size_t numBytes)
+{
+    int result = 0;
+    size_t i = 0;
+#ifdef MW_HAMMING_POPCNT64
+    for (; i + 8 <= numBytes; i += 8)
+    {
+        unsigned long long va, vb;
+        memcpy(&va, a + i, 8);
+        memcpy(&vb, b + i, 8);
+        result += (int)_mm_popcnt_u64(va ^ vb);
+    }
+#endif
+    for (; i + 4 <= numBytes; i += 4)
+    {
+        unsigned int va, vb;
+        memcpy(&va, a + i, 4);
+        memcpy(&vb, b + i, 4);
+        result += _mm_popcnt_u32(va ^ vb);
+    }
+    return result + hammingLUT(a + i, b + i, numBytes - i);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// AVX2: nibble lookup with vpshufb on 32 bytes at a time, accumulated with
+// vpsadbw. FREAK and BRISK descriptors are 64 bytes, i.e. two iterations.
+///////////////////////////////////////////////////////////////////////////////
+MW_TARGET_AVX2
+static int hammingAVX2(const unsigned char *a, const unsigned char *b,
+                       size_t numBytes)
+{
+    const __m256i lookup = _mm256_setr_epi8(
+        0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4,
+        0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+    const __m256i lowMask = _mm256_set1_epi8(0x0f);
+
+    __m256i acc = _mm256_setzero_si256();
+    size_t i = 0;
+    for (; i + 32 <= numBytes; i += 32)
+    {
+        __m256i va = _mm256_loadu_si256((const __m256i *)(a + i));
+        __m256i vb = _mm256_loadu_si256((const __m256i *)(b + i));
+        __m256i x  = _mm256_xor_si256(va, vb);
+        __m256i lo = _mm256_and_si256(x, lowMask);
+        __m256i hi = _mm256_and_si256(_mm256_srli_epi16(x, 4), lowMask);
+        __m256i cnt = _mm256_add_epi8(_mm256_shuffle_epi8(lookup, lo),
+                                      _mm256_shuffle_epi8(lookup, hi));
+        acc = _mm256_add_epi64(acc, _mm256_sad_epu8(cnt, _mm256_setzero_si256()));
+    }
+
+    int result = _mm256_extract_epi32(acc, 0) + _mm256_extract_epi32(acc, 2) +
+                 _mm256_extract_epi32(acc, 4) + _mm256_extract_epi32(acc, 6);
+
+    return result + hammingPOPCNT(a + i, b + i, numBytes - i);
+}
+#endif
+
+///////////////////////////////////////////////////////////////////////////////
+HammingDistanceFcn getHammingDistanceFcn()
+{
+#if defined(MW_HAMMING_NEON)
+    return hammingNEON;
+#elif defined(MW_HAMMING_X86)
+    if (cv::checkHardwareSupport(CV_CPU_AVX2))
+        return hammingAVX2;
+    if (cv::checkHardwareSupport(CV_CPU_POPCNT))
+        return hammingPOPCNT;
+    return hammingLUT;
+#else
+    return hammingLUT;
+#endif
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Exhaustive kNN search
+///////////////////////////////////////////////////////////////////////////////
+
+// Block sizes: a block of 32 query and 256 train descriptors of 64 bytes
+// occupies 18 KB and stays in L1/L2 while all pairs are compared.
+const int HAMMING_QUERY_BLOCK = 32;
+const int HAMMING_TRAIN_BLOCK = 256;
+
+// Inserts (index, dist) into the sorted list of the k best neighbors.
+static inline void insertNeighbor(int *indices, int *dists, int knn,
+                                  int index, int dist)
+{
+    int j = knn - 1;
+    if (dist >= dists[j])
+        return;
+    while (j > 0 && dists[j-1] > dist)
+    {
+        dists[j]   = dists[j-1];
+        indices[j] = indices[j-1];
+        --j;
+    }
+    dists[j]   = dist;
+    indices[j] = index;
+}
+
+struct HammingKnnInvoker : cv::ParallelLoopBody
+{
+    HammingKnnInvoker(const unsigned char *_query, int _numQuery,
+                      const unsigned char *_train, int _numTrain,
+                      int _numBytes, int _knn, int *_indices, int *_dists)
+    {
+        query = _query;
+        numQuery = _numQuery;
+        train = _train;
+        numTrain = _numTrain;
+        numBytes = _numBytes;
+        knn = _knn;
+        indices = _indices;
+        dists = _dists;
+    }
+
+    void operator()(const cv::Range& range) const
+    {
+        CG_TRACE_SPAN("HammingKnnInvoker");
+        const HammingDistanceFcn distance = getHammingDistanceFcn();
+
+        for (int qb = range.start; qb < range.end; ++qb)
+        {
+            const int q0 = qb * HAMMING_QUERY_BLOCK;
+            const int q1 = std::min(q0 + HAMMING_QUERY_BLOCK, numQuery);
+
+            for (int q = q0; q < q1; ++q)
+            {
+                std::fill(indices + q*knn, indices + (q+1)*knn, -1);
+                std::fill(dists + q*knn, dists + (q+1)*knn, INT_MAX);
+            }
+
+            for (int t0 = 0; t0 < numTrain; t0 += HAMMING_TRAIN_BLOCK)
+            {
+                const int t1 = std::min(t0 + HAMMING_TRAIN_BLOCK, numTrain);
+                for (int q = q0; q < q1; ++q)
+                {
+                    const unsigned char *qPtr = query + (size_t)q * numBytes;
+                    int *qIndices = indices + q*knn;
+                    int *qDists   = dists + q*knn;
+                    for (int t = t0; t < t1; ++t)
+                    {
+                        int d = distance(qPtr, train + (size_t)t * numBytes,
+                                         numBytes);
+                        insertNeighbor(qIndices, qDists, knn, t, d);
+                    }
+                }
+            }
+
+            // unused neighbor slots
+            for (int q = q0; q < q1; ++q)
+            {
+                for (int k = std::min(knn, numTrain); k < knn; ++k)
+                    dists[q*knn + k] = -1;
+            }
+        }
+    }
+
+    const unsigned char *query;
+    int numQuery;
+    const unsigned char *train;
+    int numTrain;
+    int numBytes;
+    int knn;
+    int *indices;
+    int *dists;
+};
+
+void hammingKnnMatch(const unsigned char *query, int numQuery,
+                     const unsigned char *train, int numTrain,
+                     int numBytes, int knn, int *indices, int *dists)
+{
+    const int numQueryBlocks =
+        (numQuery + HAMMING_QUERY_BLOCK - 1) / HAMMING_QUERY_BLOCK;
+
+    cv::parallel_for_(cv::Range(0, numQueryBlocks),
+        HammingKnnInvoker(query, numQuery, train, numTrain, numBytes, knn,
+                          indices, dists));
+}
+
+} // namespace vision
@@ -47,6 +47,8 @@
 #ifdef HAVE_IPP
 #include "ipp.h"
 #endif
+#include "cgProfile.hpp"
+#include "cgPyramidCache.hpp"
 /****************************************************************************************\
       The code below is implementation of HOG (Histogram-of-Oriented Gradients)
       descriptor and object detection, introduced by Navneet Dalal and Bill Triggs.
@@ -174,8 +176,11 @@ void MWHOGDescriptor::setSVMDetector(InputArray _svmDetector)
 }
 #define MWCV_TYPE_NAME_HOG_DESCRIPTOR "opencv-object-detector-hog"
 
+static void registerHOGType();
+
 bool MWHOGDescriptor::read(FileNode& obj)
 {
+    registerHOGType();
     if( !obj.isMap() )
         return false;
     FileNodeIterator it = obj["winSize"].begin();
@@ -205,6 +210,7 @@ bool MWHOGDescriptor::read(FileNode& obj)
 
 void MWHOGDescriptor::write(FileStorage& fs, const String& objName) const
 {
+    registerHOGType();
     if( !objName.empty() )
         fs << objName;
 
@@ -252,7 +258,28 @@ void MWHOGDescriptor::copyTo(MWHOGDescriptor& c) const
     c.gammaCorrection = gammaCorrection;
     c.svmDetector = svmDetector;
     c.nlevels = nlevels;
+    c.memoryBudget = memoryBudget;
+}
+
+#if CV_SSE2 && !defined(HAVE_IPP)
+// derivatives along x and y of channel c of 4 pixels of 3 channel rows,
+// xm the map of their columns
+static inline void gradient4C3(const uchar* imgPtr, const uchar* prevPtr,
+                               const uchar* nextPtr, const int* xm, const float* lut,
+                               int c, __m128& _dx, __m128& _dy)
+{
+    _dx = _mm_sub_ps(
+        _mm_setr_ps(lut[imgPtr[xm[1]*3+c]], lut[imgPtr[xm[2]*3+c]],
+                    lut[imgPtr[xm[3]*3+c]], lut[imgPtr[xm[4]*3+c]]),
+        _mm_setr_ps(lut[imgPtr[xm[-1]*3+c]], lut[imgPtr[xm[0]*3+c]],
+                    lut[imgPtr[xm[1]*3+c]], lut[imgPtr[xm[2]*3+c]]));
+    _dy = _mm_sub_ps(
+        _mm_setr_ps(lut[nextPtr[xm[0]*3+c]], lut[nextPtr[xm[1]*3+c]],
+                    lut[nextPtr[xm[2]*3+c]], lut[nextPtr[xm[3]*3+c]]),
+        _mm_setr_ps(lut[prevPtr[xm[0]*3+c]], lut[prevPtr[xm[1]*3+c]],
+                    lut[prevPtr[xm[2]*3+c]], lut[prevPtr[xm[3]*3+c]]));
 }
+#endif
 
 void MWHOGDescriptor::computeGradient(const Mat& img, Mat& grad, Mat& qangle,
                                     Size paddingTL, Size paddingBR) const
@@ -342,7 +369,22 @@ void MWHOGDescriptor::computeGradient(const Mat& img, Mat& grad, Mat& qangle,
 
         if( cn == 1 )
         {
-            for( x = 0; x < width; x++ )
+            x = 0;
+#if CV_SSE2 && !defined(HAVE_IPP)
+            for( ; x <= width - 4; x += 4 )
+            {
+                const int* xm = xmap + x;
+                __m128 _dx = _mm_sub_ps(
+                    _mm_setr_ps(lut[imgPtr[xm[1]]], lut[imgPtr[xm[2]]], lut[imgPtr[xm[3]]], lut[imgPtr[xm[4]]]),
+                    _mm_setr_ps(lut[imgPtr[xm[-1]]], lut[imgPtr[xm[0]]], lut[imgPtr[xm[1]]], lut[imgPtr[xm[2]]]));
+                __m128 _dy = _mm_sub_ps(
+                    _mm_setr_ps(lut[nextPtr[xm[0]]], lut[nextPtr[xm[1]]], lut[nextPtr[xm[2]]], lut[nextPtr[xm[3]]]),
+                    _mm_setr_ps(lut[prevPtr[xm[0]]], lut[prevPtr[xm[1]]], lut[prevPtr[xm[2]]], lut[prevPtr[xm[3]]]));
+                _mm_storeu_ps(dbuf + x, _dx);
+                _mm_storeu_ps(dbuf + width + x, _dy);
+            }
+#endif
+            for( ; x < width; x++ )
             {
                 int x1 = xmap[x];
 #ifdef HAVE_IPP
@@ -356,7 +398,31 @@ void MWHOGDescriptor::computeGradient(const Mat& img, Mat& grad, Mat& qangle,
         }
         else
         {
-            for( x = 0; x < width; x++ )
+            x = 0;
+#if CV_SSE2 && !defined(HAVE_IPP)
+            // the channel of largest magnitude, chosen in the order of the
+            // scalar loop, 2 then 1 then 0
+            for( ; x <= width - 4; x += 4 )
+            {
+                const int* xm = xmap + x;
+                __m128 _dx0, _dy0;
+                gradient4C3(imgPtr, prevPtr, nextPtr, xm, lut, 2, _dx0, _dy0);
+                __m128 _mag0 = _mm_add_ps(_mm_mul_ps(_dx0, _dx0), _mm_mul_ps(_dy0, _dy0));
+                for( int c = 1; c >= 0; c-- )
+                {
+                    __m128 _dx, _dy;
+                    gradient4C3(imgPtr, prevPtr, nextPtr, xm, lut, c, _dx, _dy);
+                    __m128 _mag = _mm_add_ps(_mm_mul_ps(_dx, _dx), _mm_mul_ps(_dy, _dy));
+                    __m128 mask = _mm_cmplt_ps(_mag0, _mag);
+                    _dx0 = _mm_or_ps(_mm_and_ps(mask, _dx), _mm_andnot_ps(mask, _dx0));
+                    _dy0 = _mm_or_ps(_mm_and_ps(mask, _dy), _mm_andnot_ps(mask, _dy0));
+                    _mag0 = _mm_max_ps(_mag0, _mag);
+                }
+                _mm_storeu_ps(dbuf + x, _dx0);
+                _mm_storeu_ps(dbuf + width + x, _dy0);
+            }
+#endif
+            for( ; x < width; x++ )
             {
                 int x1 = xmap[x]*3;
                 float dx0, dy0, dx, dy, mag0, mag;
@@ -434,7 +500,40 @@ void MWHOGDescriptor::computeGradient(const Mat& img, Mat& grad, Mat& qangle,
 #else
         cartToPolar( Dx, Dy, Mag, Angle, false );
 #endif
-        for( x = 0; x < width; x++ )
+        x = 0;
+#if CV_SSE2 && !defined(HAVE_IPP)
+        // bin assignment of 4 pixels; the floor and the wrap around of the
+        // bins give the same values as the scalar loop
+        {
+            __m128 _angleScale = _mm_set1_ps(angleScale), _half = _mm_set1_ps(0.5f);
+            __m128 _one = _mm_set1_ps(1.f);
+            __m128i _nbinsi = _mm_set1_epi32(_nbins), _zero = _mm_setzero_si128();
+            __m128i _lastBin = _mm_set1_epi32(_nbins - 1);
+            for( ; x <= width - 4; x += 4 )
+            {
+                __m128 _mag = _mm_loadu_ps(dbuf + width*2 + x);
+                __m128 _angle = _mm_sub_ps(_mm_mul_ps(_mm_loadu_ps(dbuf + width*3 + x), _angleScale), _half);
+                __m128i _hidx = _mm_cvttps_epi32(_angle);
+                // truncation rounds negative values up
+                _hidx = _mm_add_epi32(_hidx, _mm_castps_si128(_mm_cmplt_ps(_angle, _mm_cvtepi32_ps(_hidx))));
+                _angle = _mm_sub_ps(_angle, _mm_cvtepi32_ps(_hidx));
+
+                __m128 _g0 = _mm_mul_ps(_mag, _mm_sub_ps(_one, _angle));
+                __m128 _g1 = _mm_mul_ps(_mag, _angle);
+                _mm_storeu_ps(gradPtr + x*2, _mm_unpacklo_ps(_g0, _g1));
+                _mm_storeu_ps(gradPtr + x*2 + 4, _mm_unpackhi_ps(_g0, _g1));
+
+                _hidx = _mm_add_epi32(_hidx, _mm_and_si128(_mm_cmplt_epi32(_hidx, _zero), _nbinsi));
+                _hidx = _mm_sub_epi32(_hidx, _mm_and_si128(_mm_cmpgt_epi32(_hidx, _lastBin), _nbinsi));
+                __m128i _hidx1 = _mm_add_epi32(_hidx, _mm_set1_epi32(1));
+                _hidx1 = _mm_andnot_si128(_mm_cmpgt_epi32(_hidx1, _lastBin), _hidx1);
+
+                __m128i q = _mm_unpacklo_epi16(_mm_packs_epi32(_hidx, _zero), _mm_packs_epi32(_hidx1, _zero));
+                _mm_storel_epi64((__m128i*)(qanglePtr + x*2), _mm_packus_epi16(q, _zero));
+            }
+        }
+#endif
+        for( ; x < width; x++ )
         {
 #ifdef HAVE_IPP
             int hidx = (int)pHidxs[x];
@@ -485,6 +584,8 @@ struct MWHOGCache
     virtual void init(const MWHOGDescriptor* descriptor,
         const Mat& img, Size paddingTL, Size paddingBR,
         bool useCache, Size cacheStride);
+    bool hasLayout(const MWHOGDescriptor* descriptor, Size gradSize,
+        bool useCache, Size cacheStride) const;
 
     Size windowsInImage(Size imageSize, Size winStride) const;
     Rect getWindow(Size imageSize, Size winStride, int idx) const;
@@ -504,9 +605,15 @@ struct MWHOGCache
     Point imgoffset;
     Mat_<float> blockCache;
     Mat_<uchar> blockCacheFlags;
+    std::vector<float> blockHist;
 
     Mat grad, qangle;
     const MWHOGDescriptor* descriptor;
+
+    // parameters the lookup tables were built for
+    Size layoutGradSize, layoutBlockSize, layoutBlockStride, layoutCellSize;
+    int layoutNbins;
+    double layoutWinSigma;
 };
 
 
@@ -515,19 +622,38 @@ MWHOGCache::MWHOGCache()
     useCache = false;
     blockHistogramSize = count1 = count2 = count4 = 0;
     descriptor = 0;
+    layoutNbins = 0;
+    layoutWinSigma = 0;
 }
 
 MWHOGCache::MWHOGCache(const MWHOGDescriptor* _descriptor,
         const Mat& _img, Size _paddingTL, Size _paddingBR,
         bool _useCache, Size _cacheStride)
 {
+    descriptor = 0;
     init(_descriptor, _img, _paddingTL, _paddingBR, _useCache, _cacheStride);
 }
 
+bool MWHOGCache::hasLayout(const MWHOGDescriptor* _descriptor, Size _gradSize,
+        bool _useCache, Size _cacheStride) const
+{
+    return descriptor != 0 && layoutGradSize == _gradSize &&
+           useCache == _useCache && cacheStride == _cacheStride &&
+           winSize == _descriptor->winSize && layoutBlockSize == _descriptor->blockSize &&
+           layoutBlockStride == _descriptor->blockStride && layoutCellSize == _descriptor->cellSize &&
+           layoutNbins == _descriptor->nbins && layoutWinSigma == _descriptor->getWinSigma();
+}
+
 void MWHOGCache::init(const MWHOGDescriptor* _descriptor,
         const Mat& _img, Size _paddingTL, Size _paddingBR,
         bool _useCache, Size _cacheStride)
 {
+    // the tables depend only on the padded image size and the parameters,
+    // so a cache reused for same sized images only recomputes the gradients
+    Size gradSize(_img.cols + _paddingTL.width + _paddingBR.width,
+                  _img.rows + _paddingTL.height + _paddingBR.height);
+    bool sameLayout = hasLayout(_descriptor, gradSize, _useCache, _cacheStride);
+
     descriptor = _descriptor;
     cacheStride = _cacheStride;
     useCache = _useCache;
@@ -535,6 +661,19 @@ void MWHOGCache::init(const MWHOGDescriptor* _descriptor,
     descriptor->computeGradient(_img, grad, qangle, _paddingTL, _paddingBR);
     imgoffset = _paddingTL;
 
+    if( sameLayout )
+    {
+        for( size_t ii = 0; ii < ymaxCached.size(); ii++ )
+            ymaxCached[ii] = -1;
+        return;
+    }
+    layoutGradSize = gradSize;
+    layoutBlockSize = descriptor->blockSize;
+    layoutBlockStride = descriptor->blockStride;
+    layoutCellSize = descriptor->cellSize;
+    layoutNbins = descriptor->nbins;
+    layoutWinSigma = descriptor->getWinSigma();
+
     winSize = descriptor->winSize;
     Size blockSize = descriptor->blockSize;
     Size blockStride = descriptor->blockStride;
@@ -939,6 +1078,14 @@ void MWHOGDescriptor::compute(const Mat& img, std::vector<float>& descriptors,
 void MWHOGDescriptor::detect(const Mat& img,
     std::vector<Point>& hits, std::vector<double>& weights, double hitThreshold,
     Size winStride, Size padding, const std::vector<Point>& locations) const
+{
+    MWHOGCache cache;
+    detect(img, cache, hits, weights, hitThreshold, winStride, padding, locations);
+}
+
+void MWHOGDescriptor::detect(const Mat& img, MWHOGCache& cache,
+    std::vector<Point>& hits, std::vector<double>& weights, double hitThreshold,
+    Size winStride, Size padding, const std::vector<Point>& locations) const
 {
     hits.clear();
     weights.clear(); // tmw edit - clear weights to work correctly with TBB
@@ -954,7 +1101,7 @@ void MWHOGDescriptor::detect(const Mat& img,
     padding.height = (int)alignSize(std::max(padding.height, 0), cacheStride.height);
     Size paddedImgSize(img.cols + padding.width*2, img.rows + padding.height*2);
 
-    MWHOGCache cache(this, img, padding, padding, nwindows == 0, cacheStride);
+    cache.init(this, img, padding, padding, nwindows == 0, cacheStride);
 
     if( !nwindows )
         nwindows = cache.windowsInImage(paddedImgSize, winStride).area();
@@ -966,7 +1113,8 @@ void MWHOGDescriptor::detect(const Mat& img,
     size_t dsize = getDescriptorSize();
 
     double rho = svmDetector.size() > dsize ? svmDetector[dsize] : 0;
-    std::vector<float> blockHist(blockHistogramSize);
+    std::vector<float>& blockHist = cache.blockHist;
+    blockHist.resize(blockHistogramSize);
     for( size_t i = 0; i < nwindows; i++ )
     {
         Point pt0;
@@ -1039,15 +1187,26 @@ typedef std::vector<MWHOGDetectionResult> ConcurrentResultVector;
 
 // end TMW edit
 
+// the image of one pyramid level, from the shared pyramid of the frame
+static Mat scaleLevelImage(vision::FramePyramid& frame, double scale, MWHOGDescriptor::DetectionLevel& level)
+{
+    const Mat& img = frame.getFrame();
+    Size sz(cvRound(img.cols/scale), cvRound(img.rows/scale));
+    level.image = frame.getImage(frame.getLevel(0, sz, INTER_LINEAR));
+    return level.image;
+}
+
 class MWHOGInvoker : public ParallelLoopBody
 {
 public:
     MWHOGInvoker( const MWHOGDescriptor* _hog, const Mat& _img,
                 double _hitThreshold, Size _winStride, Size _padding,
-                const double* _levelScale, ConcurrentResultVector* _vec, Mutex* _mtx) 
+                const double* _levelScale, ConcurrentResultVector* _vec, Mutex* _mtx,
+                bool _keepLevels = true)
     {
         hog = _hog;
-        img = _img;
+        keepLevels = _keepLevels;
+        frame = vision::PyramidCache::acquire(_img);
         hitThreshold = _hitThreshold;
         winStride = _winStride;
         padding = _padding;
@@ -1058,27 +1217,21 @@ public:
 
     void operator()( const Range& range ) const
     {
+        CG_TRACE_SPAN("MWHOGInvoker");
         int i, i1 = range.start, i2 = range.end;
-        // TMW edit - modification to support minSize/maxSize
-        // allocate an image buffer to use over scale range i1 to i2.
-        // the scales will be increasing from i1 to i2, so i1 is the 
-        // smallest scale.
-        double minScale = levelScale[i1];
-        Size maxSz(cvCeil(img.cols/minScale), cvCeil(img.rows/minScale));
-        Mat smallerImgBuf(maxSz, img.type());
-        std::vector<Point> locations;
-        std::vector<double> hitsWeights;
 
+        // each scale level keeps its scaled image and MWHOGCache in the
+        // descriptor, so that the next frame of the same size reuses them
         for( i = i1; i < i2; i++ )
         {
             double scale = levelScale[i];
-            Size sz(cvRound(img.cols/scale), cvRound(img.rows/scale));
-            Mat smallerImg(sz, img.type(), smallerImgBuf.data);
-            if( sz == img.size() )
-                smallerImg = Mat(sz, img.type(), img.data, img.step);
-            else
-                resize(img, smallerImg, sz);
-            hog->detect(smallerImg, locations, hitsWeights, hitThreshold, winStride, padding);
+            MWHOGDescriptor::DetectionLevel& level = hog->detectionLevels[i];
+            if( level.cache.empty() )
+                level.cache = makePtr<MWHOGCache>();
+            std::vector<Point>& locations = level.locations;
+            std::vector<double>& hitsWeights = level.weights;
+            Mat smallerImg = scaleLevelImage(*frame, scale, level);
+            hog->detect(smallerImg, *level.cache, locations, hitsWeights, hitThreshold, winStride, padding);
             Size scaledWinSize = Size(cvRound(hog->winSize.width*scale), cvRound(hog->winSize.height*scale));
             
             mtx->lock();
@@ -1095,11 +1248,18 @@ public:
                 vec->push_back(result);
             }
             mtx->unlock();
+
+            if( !keepLevels )
+            {
+                level.cache.release();
+                level.image.release();
+            }
         }
     }
 
     const MWHOGDescriptor* hog;
-    Mat img;
+    bool keepLevels;
+    vision::FramePyramidPtr frame;
     double hitThreshold;
     Size winStride;
     Size padding;
@@ -1108,22 +1268,48 @@ public:
     ConcurrentResultVector* vec; //TMW edit
 };
 
-// TMW edit: detectMultiScale has been enhanced to handle min/max size parameters.  It also uses
-// one concurrent data struct to hold results in order to perserve ordering in TBB.
-void MWHOGDescriptor::detectMultiScale(
-    const Mat& img, std::vector<Rect>& foundLocations, std::vector<double>& foundWeights,
-    double hitThreshold, Size winStride, Size padding,
-    double scale0, double finalThreshold, bool useMeanshiftGrouping,
-    Size minSize, Size maxSize) const  // TMW edit: add min/max size
+class MWHOGScoreMapInvoker : public ParallelLoopBody
 {
-    double scale = 1.;
-    int levels = 0;
+public:
+    MWHOGScoreMapInvoker( const MWHOGDescriptor* _hog, const Mat& _img,
+                Size _winStride, Size _padding, const double* _levelScale, Mat* _scoreMaps )
+    {
+        hog = _hog;
+        frame = vision::PyramidCache::acquire(_img);
+        winStride = _winStride;
+        padding = _padding;
+        levelScale = _levelScale;
+        scoreMaps = _scoreMaps;
+    }
 
-    std::vector<double> levelScale;
+    void operator()( const Range& range ) const
+    {
+        CG_TRACE_SPAN("MWHOGScoreMapInvoker");
+        for( int i = range.start; i < range.end; i++ )
+        {
+            MWHOGDescriptor::DetectionLevel& level = hog->detectionLevels[i];
+            Mat smallerImg = scaleLevelImage(*frame, levelScale[i], level);
+            hog->computeScoreMap(smallerImg, level, scoreMaps[i], winStride, padding);
+        }
+    }
 
+    const MWHOGDescriptor* hog;
+    vision::FramePyramidPtr frame;
+    Size winStride;
+    Size padding;
+    const double* levelScale;
+    Mat* scoreMaps;
+};
+
+void MWHOGDescriptor::getLevelScales(Size imgSize, double scale0, Size minSize, Size maxSize,
+                                     std::vector<double>& levelScale) const
+{
+    double scale = 1.;
+
+    levelScale.clear();
     // TMW edit: add min/max size
-    if ( minSize.height <= img.size().height &&
-         minSize.width  <= img.size().width)
+    if ( minSize.height <= imgSize.height &&
+         minSize.width  <= imgSize.width)
     {
         // set min size to window size if it's smaller
         if (( minSize.height < winSize.height ||
@@ -1132,8 +1318,8 @@ void MWHOGDescriptor::detectMultiScale(
     
         // limit maxSize to size of image if it's undefined or greater than image size
         if (( maxSize.height == 0 || maxSize.width == 0 ) || 
-            (maxSize.height > img.size().height || maxSize.width > img.size().width))
-                maxSize = img.size();          
+            (maxSize.height > imgSize.height || maxSize.width > imgSize.width))
+                maxSize = imgSize;          
     
         for (scale = 1; ; scale *= scale0) {        
          
@@ -1153,22 +1339,217 @@ void MWHOGDescriptor::detectMultiScale(
             }
       
             // add current scale list
-            levelScale.push_back(scale); 
-            levels++;    
+            levelScale.push_back(scale);
+        }
+    }
+
+}
+
+Size MWHOGDescriptor::getScoreMapSize(Size imgSize, Size winStride, Size padding) const
+{
+    if( winStride == Size() )
+        winStride = cellSize;
+    Size cacheStride(gcd(winStride.width, blockStride.width),
+                     gcd(winStride.height, blockStride.height));
+    padding.width = (int)alignSize(std::max(padding.width, 0), cacheStride.width);
+    padding.height = (int)alignSize(std::max(padding.height, 0), cacheStride.height);
+    Size paddedImgSize(imgSize.width + padding.width*2, imgSize.height + padding.height*2);
+    if( paddedImgSize.width < winSize.width || paddedImgSize.height < winSize.height )
+        return Size();
+    return Size((paddedImgSize.width - winSize.width)/winStride.width + 1,
+                (paddedImgSize.height - winSize.height)/winStride.height + 1);
+}
+
+void MWHOGDescriptor::computeScoreMap(const Mat& img, Mat& scores,
+                                      Size winStride, Size padding) const
+{
+    DetectionLevel level;
+    computeScoreMap(img, level, scores, winStride, padding);
+}
+
+void MWHOGDescriptor::computeScoreMap(const Mat& img, DetectionLevel& level, Mat& scores,
+                                      Size winStride, Size padding) const
+{
+    Size mapSize = getScoreMapSize(img.size(), winStride, padding);
+    scores.create(mapSize, CV_64F);
+    if( svmDetector.empty() || mapSize.area() == 0 )
+        return;
+
+    if( winStride == Size() )
+        winStride = cellSize;
+    Size cacheStride(gcd(winStride.width, blockStride.width),
+                     gcd(winStride.height, blockStride.height));
+    padding.width = (int)alignSize(std::max(padding.width, 0), cacheStride.width);
+    padding.height = (int)alignSize(std::max(padding.height, 0), cacheStride.height);
+    Size paddedImgSize(img.cols + padding.width*2, img.rows + padding.height*2);
+
+    if( level.cache.empty() )
+        level.cache = makePtr<MWHOGCache>();
+    MWHOGCache& cache = *level.cache;
+    cache.init(this, img, padding, padding, false, cacheStride);
+
+    int nblocks = cache.nblocks.area();
+    int blockHistogramSize = cache.blockHistogramSize;
+    size_t dsize = getDescriptorSize();
+    double rho = svmDetector.size() > dsize ? svmDetector[dsize] : 0;
+
+    // the normalized histogram of every block position of the cacheStride
+    // grid, each computed once although it is shared by several windows
+    Size gridSize((paddedImgSize.width - blockSize.width)/cacheStride.width + 1,
+                  (paddedImgSize.height - blockSize.height)/cacheStride.height + 1);
+    level.blocks.create(gridSize.area(), blockHistogramSize, CV_32F);
+    for( int gy = 0; gy < gridSize.height; gy++ )
+        for( int gx = 0; gx < gridSize.width; gx++ )
+        {
+            float* dst = level.blocks.ptr<float>(gy*gridSize.width + gx);
+            Point pt(gx*cacheStride.width - padding.width, gy*cacheStride.height - padding.height);
+            const float* vec = cache.getBlock(pt, dst);
+            if( vec != dst )
+                memcpy(dst, vec, blockHistogramSize*sizeof(float));
         }
+
+    // blockScores(p,j) is the dot product of the block at grid position p
+    // with the weights of block j of the window
+    Mat detectorWeights(nblocks, blockHistogramSize, CV_32F, (void*)&svmDetector[0]);
+    gemm(level.blocks, detectorWeights, 1, noArray(), 0, level.blockScores, GEMM_2_T);
+
+    AutoBuffer<int> blockOfs(nblocks);
+    for( int j = 0; j < nblocks; j++ )
+    {
+        Point ofs = cache.blockData[j].imgOffset;
+        blockOfs[j] = ((ofs.y/cacheStride.height)*gridSize.width + ofs.x/cacheStride.width)*nblocks + j;
     }
+    int xStep = winStride.width/cacheStride.width, yStep = winStride.height/cacheStride.height;
+    const float* blockScores = level.blockScores.ptr<float>();
+
+    for( int r = 0; r < mapSize.height; r++ )
+    {
+        double* scoresRow = scores.ptr<double>(r);
+        for( int c = 0; c < mapSize.width; c++ )
+        {
+            const float* windowScores = blockScores + (r*yStep*gridSize.width + c*xStep)*nblocks;
+            double s = rho;
+            for( int j = 0; j < nblocks; j++ )
+                s += windowScores[blockOfs[j]];
+            scoresRow[c] = s;
+        }
+    }
+}
+
+void MWHOGDescriptor::computeScoreMaps(const Mat& img, std::vector<Mat>& scoreMaps,
+                                       std::vector<double>& scales, Size winStride,
+                                       Size padding, double scale0,
+                                       Size minSize, Size maxSize) const
+{
+    getLevelScales(img.size(), scale0, minSize, maxSize, scales);
+    scoreMaps.resize(scales.size());
+    if( scales.empty() )
+        return;
+    if( detectionLevels.size() < scales.size() )
+        detectionLevels.resize(scales.size());
+
+    parallel_for_(Range(0, (int)scales.size()),
+        MWHOGScoreMapInvoker(this, img, winStride, padding, &scales[0], &scoreMaps[0]));
+}
+
+// bytes of the scaled image and of the MWHOGCache of a level of size sz,
+// as allocated by MWHOGCache::init
+static void estimateLevelBytes(const MWHOGDescriptor& hog, Size sz, int cn,
+                               Size winStride, Size padding,
+                               double& imageBytes, double& cacheBytes)
+{
+    if( winStride == Size() )
+        winStride = hog.cellSize;
+    Size cacheStride(gcd(winStride.width, hog.blockStride.width),
+                     gcd(winStride.height, hog.blockStride.height));
+    padding.width = (int)alignSize(std::max(padding.width, 0), cacheStride.width);
+    padding.height = (int)alignSize(std::max(padding.height, 0), cacheStride.height);
+    Size gradSize(sz.width + padding.width*2, sz.height + padding.height*2);
+
+    int blockHistogramSize = (hog.blockSize.width/hog.cellSize.width)*
+        (hog.blockSize.height/hog.cellSize.height)*hog.nbins;
+    Size cacheSize((gradSize.width - hog.blockSize.width)/cacheStride.width + 1,
+                   hog.winSize.height/cacheStride.height + 1);
+
+    imageBytes = (double)sz.area()*cn;
+    // CV_32FC2 gradient, CV_8UC2 angles, block histograms and their flags
+    cacheBytes = (double)gradSize.area()*(2*sizeof(float) + 2) +
+        (double)cacheSize.area()*(blockHistogramSize*sizeof(float) + 1);
+}
+
+void MWHOGDescriptor::planLevels(Size imgSize, int cn, const std::vector<double>& levelScale,
+                                 Size winStride, Size padding, int& numConcurrent,
+                                 bool& keepLevels, double& peakBytes, double& steadyBytes) const
+{
+    double levelsBytes = 0, maxLevelBytes = 0;
+    for( size_t i = 0; i < levelScale.size(); i++ )
+    {
+        Size sz(cvRound(imgSize.width/levelScale[i]), cvRound(imgSize.height/levelScale[i]));
+        double imageBytes, cacheBytes;
+        estimateLevelBytes(*this, sz, cn, winStride, padding, imageBytes, cacheBytes);
+        levelsBytes += imageBytes + cacheBytes;
+        maxLevelBytes = std::max(maxLevelBytes, imageBytes + cacheBytes);
+    }
+
+    numConcurrent = std::max((int)levelScale.size(), 1);
+    keepLevels = true;
+    peakBytes = levelsBytes;
+    steadyBytes = levelsBytes;
+    if( memoryBudget <= 0 || levelsBytes <= memoryBudget )
+        return;
+
+    // the largest levels may still be scanned at once
+    keepLevels = false;
+    numConcurrent = std::max(std::min((int)(memoryBudget/maxLevelBytes), numConcurrent), 1);
+    peakBytes = numConcurrent*maxLevelBytes;
+    steadyBytes = 0;
+}
+
+void MWHOGDescriptor::estimateMemory(Size imgSize, int cn, double scale0,
+                                     Size minSize, Size maxSize, Size winStride, Size padding,
+                                     double& peakBytes, double& steadyBytes) const
+{
+    std::vector<double> levelScale;
+    getLevelScales(imgSize, scale0, minSize, maxSize, levelScale);
+    int numConcurrent;
+    bool keepLevels;
+    planLevels(imgSize, cn, levelScale, winStride, padding, numConcurrent, keepLevels,
+               peakBytes, steadyBytes);
+}
+
+// TMW edit: detectMultiScale has been enhanced to handle min/max size parameters.  It also uses
+// one concurrent data struct to hold results in order to perserve ordering in TBB.
+void MWHOGDescriptor::detectMultiScale(
+    const Mat& img, std::vector<Rect>& foundLocations, std::vector<double>& foundWeights,
+    double hitThreshold, Size winStride, Size padding,
+    double scale0, double finalThreshold, bool useMeanshiftGrouping,
+    Size minSize, Size maxSize) const  // TMW edit: add min/max size
+{
+    std::vector<double> levelScale;
+    getLevelScales(img.size(), scale0, minSize, maxSize, levelScale);
+    int levels = (int)levelScale.size();
 
     if (!levelScale.empty())
     {
 	    levels = std::max(levels, 1);
 	    levelScale.resize(levels);
+	    if( detectionLevels.size() < levelScale.size() )
+	        detectionLevels.resize(levelScale.size());
       
 	    ConcurrentResultVector results;
 	    std::vector<double> foundScales;
         Mutex mtx;
+
+        int numConcurrent;
+        bool keepLevels;
+        double peakBytes, steadyBytes;
+        planLevels(img.size(), img.channels(), levelScale, winStride, padding,
+                   numConcurrent, keepLevels, peakBytes, steadyBytes);
     
  	    parallel_for_(Range(0, (int)levelScale.size()),
-        MWHOGInvoker(this, img, hitThreshold, winStride, padding, &levelScale[0], &results, &mtx));
+        MWHOGInvoker(this, img, hitThreshold, winStride, padding, &levelScale[0], &results, &mtx,
+                     keepLevels),
+        keepLevels ? -1. : (double)numConcurrent);
 	
 	    // copy data out of concurrect vector
 	    foundWeights.clear();
@@ -1201,6 +1582,64 @@ void MWHOGDescriptor::detectMultiScale(
    }
 }
 
+void MWHOGDescriptor::detectMultiScaleInROIs(const Mat& img, const std::vector<Rect>& rois,
+    const std::vector<Size>& minSizes, const std::vector<Size>& maxSizes,
+    std::vector<Rect>& foundLocations, std::vector<double>& foundWeights,
+    double hitThreshold, Size winStride, Size padding,
+    double scale0, double finalThreshold, bool useMeanshiftGrouping) const
+{
+    CV_Assert( minSizes.size() == rois.size() && maxSizes.size() == rois.size() );
+
+    ConcurrentResultVector results;
+    std::vector<double> levelScale;
+    Mutex mtx;
+    Rect imageRect(0, 0, img.cols, img.rows);
+
+    // each region is scanned over its own scale range, as an image of its
+    // own, and its detections are moved back to image coordinates
+    for( size_t i = 0; i < rois.size(); i++ )
+    {
+        Rect roi = rois[i] & imageRect;
+        if( roi.area() == 0 )
+            continue;
+        Mat roiImg = img(roi);
+        getLevelScales(roi.size(), scale0, minSizes[i], maxSizes[i], levelScale);
+        if( levelScale.empty() )
+            continue;
+        if( detectionLevels.size() < levelScale.size() )
+            detectionLevels.resize(levelScale.size());
+
+        int numConcurrent;
+        bool keepLevels;
+        double peakBytes, steadyBytes;
+        planLevels(roi.size(), img.channels(), levelScale, winStride, padding,
+                   numConcurrent, keepLevels, peakBytes, steadyBytes);
+
+        size_t first = results.size();
+        parallel_for_(Range(0, (int)levelScale.size()),
+            MWHOGInvoker(this, roiImg, hitThreshold, winStride, padding, &levelScale[0], &results, &mtx,
+                         keepLevels),
+            keepLevels ? -1. : (double)numConcurrent);
+        for( size_t j = first; j < results.size(); j++ )
+            results[j].rectangle += roi.tl();
+    }
+
+    std::vector<double> foundScales;
+    foundWeights.clear();
+    foundLocations.clear();
+    for( size_t j = 0; j < results.size(); j++ )
+    {
+        foundScales.push_back(results[j].scale);
+        foundLocations.push_back(results[j].rectangle);
+        foundWeights.push_back(results[j].weight);
+    }
+
+    // objects seen by overlapping regions are merged like the detections
+    // of neighboring scales
+    if( useMeanshiftGrouping )
+        MWgroupRectangles_meanshift(foundLocations, foundWeights, foundScales, finalThreshold, winSize);
+}
+
 void MWHOGDescriptor::detectMultiScale(const Mat& img, std::vector<Rect>& foundLocations,
                                      double hitThreshold, Size winStride, Size padding,
                                      double scale0, double finalThreshold, bool useMeanshiftGrouping) const
@@ -1265,8 +1704,14 @@ public:
 
 typedef RTTIImpl<MWHOGDescriptor> MWHOGRTTI;
 
-CvType mwhog_type( MWCV_TYPE_NAME_HOG_DESCRIPTOR, MWHOGRTTI::isInstance,
-                 MWHOGRTTI::release, MWHOGRTTI::read, MWHOGRTTI::write, MWHOGRTTI::clone);
+// TMW edit: the type is registered by the first read or write of a
+// descriptor, which is when its name is used, rather than at load
+static void registerHOGType()
+{
+    static CvType mwhog_type( MWCV_TYPE_NAME_HOG_DESCRIPTOR, MWHOGRTTI::isInstance,
+                     MWHOGRTTI::release, MWHOGRTTI::read, MWHOGRTTI::write, MWHOGRTTI::clone);
+    (void)mwhog_type;
+}
 
 std::vector<float> MWHOGDescriptor::getDefaultPeopleDetector()
 {
@@ -2601,6 +3046,7 @@ public:
 
        void operator()( const Range& range ) const
        {
+               CG_TRACE_SPAN("MWHOGConfInvoker");
                int i, i1 = range.start, i2 = range.end;
 
                Size maxSz(cvCeil(img.cols/(*locations)[0].scale), cvCeil(img.rows/(*locations)[0].scale));
@@ -0,0 +1,1324 @@
+/*M///////////////////////////////////////////////////////////////////////////////////////
+//
+//  IMPORTANT: READ BEFORE DOWNLOADING, COPYING, INSTALLING OR USING.
+//
+//  By downloading, copying, installing or using the software you agree to this license.
+//  If you do not agree to this license, do not download, install,
+//  copy or use the software.
+//
+//
+//                           License Agreement
+//                For Open Source Computer Vision Library
+//
+// Copyright (C) 2000-2008, Intel Corporation, all rights reserved.
+// Copyright (C) 2009, Willow Garage Inc., all rights reserved.
+// Third party copyrights are property of their respective owners.
+//
+// Redistribution and use in source and binary forms, with or without modification,
+// are permitted provided that the following conditions are met:
+//
+//   * Redistribution's of source code must retain the above copyright notice,
+//     this list of conditions and the following disclaimer.
+//
+//   * Redistribution's in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and/or other materials provided with the distribution.
+//
+//   * The name of the copyright holders may not be used to endorse or promote products
+//     derived from this software without specific prior written permission.
+//
+// This software is provided by the copyright holders and contributors "as is" and
+// any express or implied warranties, including, but not limited to, the implied
+// warranties of merchantability and fitness for a particular purpose are disclaimed.
+// In no event shall the Intel Corporation or contributors be liable for any direct,
+// indirect, incidental, special, exemplary, or consequential damages
+// (including, but not limited to, procurement of substitute goods or services;
+// loss of use, data, or profits; or business interruption) however caused
+// and on any theory of liability, whether in contract, strict liability,
+// or tort (including negligence or otherwise) arising in any way out of
+// the use of this software, even if advised of the possibility of such damage.
+//
+//M*/
+#include "precomp_objdetect.hpp"
+#include "mwobjdetect.hpp" // for MWLatentSvmDetector
+#include "cgProfile.hpp"
+#include "cgThreadPool.hpp"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+/****************************************************************************************\
+      The code below is an implementation of object detection with deformable part
+      models, introduced by P. Felzenszwalb, R. Girshick, D. McAllester and D. Ramanan,
+      for the models and the features of the OpenCV latent SVM detector.
+
+      The filter responses are computed with the FFT. The levels of the feature
+      pyramid are packed into a few planes, each level with a zero border as wide as
+      the borders of all the models, and the spectra of the planes are computed once
+      per image and shared by all the filters of all the models. A filter is then
+      correlated with a plane by one product of spectra per feature and one inverse
+      transform, and the responses of the levels are read from the result.
+
+      The scales of the pyramid, the spectra of the planes, the filters of all the
+      models and the root positions of the components and levels are processed in
+      parallel; the distance transforms of the part responses split their passes
+      over blocks of rows and of columns.
+\****************************************************************************************/
+
+namespace
+{
+
+const int LSVM_NUM_SECTOR = 9;
+// levels per octave; the parts of a root filter at level l are at level l - LSVM_LAMBDA
+const int LSVM_LAMBDA = 10;
+const int LSVM_SIDE_LENGTH = 8;
+const float LSVM_TRUNCATE = 0.2f;
+const int LSVM_NUM_FEATURES = 3 * LSVM_NUM_SECTOR + 4;
+
+// smallest blocks of a distance transform pass given to a thread
+const int LSVM_MIN_ROWS_PER_BLOCK = 16;
+const int LSVM_MIN_COLS_PER_BLOCK = 16;
+
+// sizeY x sizeX cells of numFeatures features, row major
+struct FeatureMap
+{
+    FeatureMap() : sizeX(0), sizeY(0), numFeatures(0) {}
+
+    int sizeX;
+    int sizeY;
+    int numFeatures;
+    std::vector<float> map;
+};
+
+struct Detection
+{
+    cv::Rect rect;
+    float score;
+};
+
+/////////////////////////////////////////////////////////////////////////////////
+// Features
+/////////////////////////////////////////////////////////////////////////////////
+
+// Histograms of the gradient orientations over the cells of k x k pixels of
+// image: 9 contrast insensitive then 18 contrast sensitive bins, each pixel
+// voting for the 4 nearest cells. The gradient of a pixel is that of its
+// channel of largest magnitude, the channels visited as R, G, B.
+void computeCellHistograms(const cv::Mat &image, int k, FeatureMap &result)
+{
+    const int height = image.rows, width = image.cols;
+    const int numChannels = image.channels();
+    const int sizeX = width / k, sizeY = height / k;
+    const int p = 3 * LSVM_NUM_SECTOR;
+    const int stringSize = sizeX * p;
+
+    result.sizeX = sizeX;
+    result.sizeY = sizeY;
+    result.numFeatures = p;
+    result.map.assign((size_t)sizeX * sizeY * p, 0.0f);
+
+    float boundaryX[LSVM_NUM_SECTOR + 1];
+    float boundaryY[LSVM_NUM_SECTOR + 1];
+    for (int i = 0; i <= LSVM_NUM_SECTOR; i++)
+    {
+        const float arg = (float)i * ((float)CV_PI / (float)LSVM_NUM_SECTOR);
+        boundaryX[i] = cosf(arg);
+        boundaryY[i] = sinf(arg);
+    }
+
+    std::vector<float> r((size_t)width * height);
+    std::vector<int> alfa((size_t)width * height * 2);
+    for (int j = 1; j < height - 1; j++)
+    {
+        const float *above = image.ptr<float>(j - 1);
+        const float *row = image.ptr<float>(j);
+        const float *below = image.ptr<float>(j + 1);
+        for (int i = 1; i < width - 1; i++)
+        {
+            int ch = numChannels - 1;
+            float x = row[(i + 1) * numChannels + ch] - row[(i - 1) * numChannels + ch];
+            float y = below[i * numChannels + ch] - above[i * numChannels + ch];
+            float magnitude = sqrtf(x * x + y * y);
+            for (ch = numChannels - 2; ch >= 0; ch--)
+            {
+                const float tx = row[(i + 1) * numChannels + ch] - row[(i - 1) * numChannels + ch];
+                const float ty = below[i * numChannels + ch] - above[i * numChannels + ch];
+                const float m = sqrtf(tx * tx + ty * ty);
+                if (m > magnitude)
+                {
+                    magnitude = m;
+                    x = tx;
+                    y = ty;
+                }
+            }
+            r[j * width + i] = magnitude;
+
+            float maxProd = boundaryX[0] * x + boundaryY[0] * y;
+            int maxi = 0;
+            for (int kk = 0; kk < LSVM_NUM_SECTOR; kk++)
+            {
+                const float dotProd = boundaryX[kk] * x + boundaryY[kk] * y;
+                if (dotProd > maxProd)
+                {
+                    maxProd = dotProd;
+                    maxi = kk;
+                }
+                else if (-dotProd > maxProd)
+                {
+                    maxProd = -dotProd;
+                    maxi = kk + LSVM_NUM_SECTOR;
+                }
+            }
+            alfa[(j * width + i) * 2] = maxi % LSVM_NUM_SECTOR;
+            alfa[(j * width + i) * 2 + 1] = maxi;
+        }
+    }
+
+    // nearest neighbouring cell and bilinear weights of the pixels of a cell
+    std::vector<int> nearest(k);
+    std::vector<float> w(k * 2);
+    for (int i = 0; i < k; i++)
+        nearest[i] = i < k / 2 ? -1 : 1;
+    for (int j = 0; j < k; j++)
+    {
+        float a, b;
+        if (j < k / 2)
+        {
+            b = k / 2 + j + 0.5f;
+            a = k / 2 - j - 0.5f;
+        }
+        else
+        {
+            a = j - k / 2 + 0.5f;
+            b = -j + k / 2 - 0.5f + k;
+        }
+        w[j * 2] = 1.0f / a * ((a * b) / (a + b));
+        w[j * 2 + 1] = 1.0f / b * ((a * b) / (a + b));
+    }
+
+    float *map = result.map.empty() ? NULL : &result.map[0];
+    for (int i = 0; i < sizeY; i++)
+    {
+        for (int j = 0; j < sizeX; j++)
+        {
+            for (int ii = 0; ii < k; ii++)
+            {
+                for (int jj = 0; jj < k; jj++)
+                {
+                    if (i * k + ii <= 0 || i * k + ii >= height - 1 ||
+                        j * k + jj <= 0 || j * k + jj >= width - 1)
+                        continue;
+
+                    const int d = (k * i + ii) * width + (j * k + jj);
+                    const int bin0 = alfa[d * 2], bin1 = alfa[d * 2 + 1] + LSVM_NUM_SECTOR;
+                    const int ni = i + nearest[ii], nj = j + nearest[jj];
+                    const bool rowIn = ni >= 0 && ni <= sizeY - 1;
+                    const bool colIn = nj >= 0 && nj <= sizeX - 1;
+
+                    float *cell = map + i * stringSize + j * p;
+                    cell[bin0] += r[d] * w[ii * 2] * w[jj * 2];
+                    cell[bin1] += r[d] * w[ii * 2] * w[jj * 2];
+                    if (rowIn)
+                    {
+                        cell = map + ni * stringSize + j * p;
+                        cell[bin0] += r[d] * w[ii * 2 + 1] * w[jj * 2];
+                        cell[bin1] += r[d] * w[ii * 2 + 1] * w[jj * 2];
+                    }
+                    if (colIn)
+                    {
+                        cell = map + i * stringSize + nj * p;
+                        cell[bin0] += r[d] * w[ii * 2] * w[jj * 2 + 1];
+                        cell[bin1] += r[d] * w[ii * 2] * w[jj * 2 + 1];
+                    }
+                    if (rowIn && colIn)
+                    {
+                        cell = map + ni * stringSize + nj * p;
+                        cell[bin0] += r[d] * w[ii * 2 + 1] * w[jj * 2 + 1];
+                        cell[bin1] += r[d] * w[ii * 2 + 1] * w[jj * 2 + 1];
+                    }
+                }
+            }
+        }
+    }
+}
+
+// Normalizes each inner cell by the energies of the 4 blocks of 2 x 2 cells
+// around it and truncates: 4 x 27 features per cell. The border cells are
+// dropped.
+void normalizeAndTruncate(FeatureMap &fmap)
+{
+    const int p = LSVM_NUM_SECTOR;
+    const int xp = LSVM_NUM_SECTOR * 3;
+    const int pp = LSVM_NUM_SECTOR * 12;
+    const int stride = fmap.sizeX;
+    const int sizeX = fmap.sizeX - 2, sizeY = fmap.sizeY - 2;
+    if (sizeX <= 0 || sizeY <= 0)
+    {
+        fmap = FeatureMap();
+        return;
+    }
+
+    std::vector<float> partOfNorm((size_t)fmap.sizeX * fmap.sizeY);
+    for (size_t i = 0; i < partOfNorm.size(); i++)
+    {
+        float valOfNorm = 0.0f;
+        const float *cell = &fmap.map[i * fmap.numFeatures];
+        for (int j = 0; j < p; j++)
+            valOfNorm += cell[j] * cell[j];
+        partOfNorm[i] = valOfNorm;
+    }
+
+    // the blocks below right, above right, below left and above left
+    const int dy[4] = {1, -1, 1, -1};
+    const int dx[4] = {1, 1, -1, -1};
+    std::vector<float> newData((size_t)sizeX * sizeY * pp);
+    for (int i = 1; i <= sizeY; i++)
+    {
+        for (int j = 1; j <= sizeX; j++)
+        {
+            const float *src = &fmap.map[((size_t)i * stride + j) * xp];
+            float *dst = &newData[((size_t)(i - 1) * sizeX + (j - 1)) * pp];
+            for (int b = 0; b < 4; b++)
+            {
+                const float valOfNorm = sqrtf(
+                    partOfNorm[i * stride + j] +
+                    partOfNorm[i * stride + (j + dx[b])] +
+                    partOfNorm[(i + dy[b]) * stride + j] +
+                    partOfNorm[(i + dy[b]) * stride + (j + dx[b])]) + FLT_EPSILON;
+                for (int ii = 0; ii < p; ii++)
+                    dst[ii + p * b] = src[ii] / valOfNorm;
+                for (int ii = 0; ii < 2 * p; ii++)
+                    dst[ii + p * 4 + 2 * p * b] = src[ii + p] / valOfNorm;
+            }
+        }
+    }
+    for (size_t i = 0; i < newData.size(); i++)
+    {
+        if (newData[i] > LSVM_TRUNCATE)
+            newData[i] = LSVM_TRUNCATE;
+    }
+
+    fmap.sizeX = sizeX;
+    fmap.sizeY = sizeY;
+    fmap.numFeatures = pp;
+    fmap.map.swap(newData);
+}
+
+// Reduces the 108 normalized features of each cell to the 31 of the models:
+// the 18 contrast sensitive and the 9 insensitive bins summed over the
+// normalizations, and the 4 sums of the sensitive bins of a normalization.
+void projectFeatures(FeatureMap &fmap)
+{
+    const int p = fmap.numFeatures;
+    const int pp = LSVM_NUM_FEATURES;
+    const int yp = 4;
+    const int xp = LSVM_NUM_SECTOR;
+    const float nx = 1.0f / sqrtf((float)(xp * 2));
+    const float ny = 1.0f / sqrtf((float)yp);
+
+    const size_t numCells = (size_t)fmap.sizeX * fmap.sizeY;
+    std::vector<float> newData(numCells * pp);
+    for (size_t c = 0; c < numCells; c++)
+    {
+        const float *src = &fmap.map[c * p];
+        float *dst = &newData[c * pp];
+        int k = 0;
+        for (int jj = 0; jj < xp * 2; jj++)
+        {
+            float val = 0;
+            for (int ii = 0; ii < yp; ii++)
+                val += src[yp * xp + ii * xp * 2 + jj];
+            dst[k++] = val * ny;
+        }
+        for (int jj = 0; jj < xp; jj++)
+        {
+            float val = 0;
+            for (int ii = 0; ii < yp; ii++)
+                val += src[ii * xp + jj];
+            dst[k++] = val * ny;
+        }
+        for (int ii = 0; ii < yp; ii++)
+        {
+            float val = 0;
+            for (int jj = 0; jj < 2 * xp; jj++)
+                val += src[yp * xp + ii * xp * 2 + jj];
+            dst[k++] = val * nx;
+        }
+    }
+
+    fmap.numFeatures = pp;
+    fmap.map.swap(newData);
+}
+
+// The 31 features of the cells of k x k pixels of a float image
+void computeFeatureMap(const cv::Mat &image, int k, FeatureMap &fmap)
+{
+    computeCellHistograms(image, k, fmap);
+    normalizeAndTruncate(fmap);
+    if (fmap.sizeX > 0)
+        projectFeatures(fmap);
+}
+
+// The levels of the pyramid at scale step^(-i): level i when i < LSVM_LAMBDA
+// and level LSVM_LAMBDA + i when i < numStep
+void computeScaleLevels(const cv::Mat &base, float step, int numStep, int i,
+    std::vector<FeatureMap> &levels)
+{
+    const float scale = 1.0f / powf(step, (float)i);
+    const cv::Size size((int)((float)base.cols * scale + 0.5f),
+        (int)((float)base.rows * scale + 0.5f));
+    cv::Mat scaled;
+    cv::resize(base, scaled, size, 0, 0, cv::INTER_AREA);
+    if (i < LSVM_LAMBDA)
+        computeFeatureMap(scaled, LSVM_SIDE_LENGTH / 2, levels[i]);
+    if (i < numStep)
+        computeFeatureMap(scaled, LSVM_SIDE_LENGTH, levels[LSVM_LAMBDA + i]);
+}
+
+// The levels of the pyramid of image: level i < LSVM_LAMBDA has cells of
+// LSVM_SIDE_LENGTH/2 pixels of the image scaled by 2^(-i/LSVM_LAMBDA), and
+// level LSVM_LAMBDA + i cells of LSVM_SIDE_LENGTH pixels of the same image,
+// which is resized once for both. The scales are built in parallel.
+void buildFeaturePyramid(const cv::Mat &image, std::vector<FeatureMap> &levels)
+{
+    CG_TRACE_SPAN("LatentSvmPyramid");
+    levels.clear();
+
+    const float step = powf(2.0f, 1.0f / (float)LSVM_LAMBDA);
+    const int maxNumCells = std::min(image.cols, image.rows) / LSVM_SIDE_LENGTH;
+    if (maxNumCells < 5)
+        return;
+    const int numStep = (int)(logf((float)maxNumCells / 5.0f) / logf(step)) + 1;
+    levels.resize(numStep + LSVM_LAMBDA);
+
+    cv::Mat base;
+    image.convertTo(base, CV_MAKETYPE(CV_32F, image.channels()));
+
+#ifdef PARALLEL
+    cgParallelForWorkers(std::max(numStep, LSVM_LAMBDA), [&](int, int i) {
+        computeScaleLevels(base, step, numStep, i, levels);
+    });
+#else
+    for (int i = 0; i < std::max(numStep, LSVM_LAMBDA); i++)
+        computeScaleLevels(base, step, numStep, i, levels);
+#endif
+}
+
+/////////////////////////////////////////////////////////////////////////////////
+// Spectra of the pyramid
+/////////////////////////////////////////////////////////////////////////////////
+
+// The levels packed into planes of size, each level at (x, y) of its plane
+// followed by borderX zero columns and borderY zero rows. A correlation that
+// reads up to borderX columns and borderY rows around a level, wrapping
+// around the plane, reads zeros there, as the zero border of the OpenCV
+// detector. spectra[plane * LSVM_NUM_FEATURES + k] is the spectrum of
+// feature k of a plane, CCS packed.
+struct PyramidSpectra
+{
+    struct Placement
+    {
+        int plane;
+        int x;
+        int y;
+    };
+
+    cv::Size size;
+    int numPlanes;
+    std::vector<Placement> placements;
+    std::vector<cv::Mat> spectra;
+};
+
+// Orders level indices by decreasing height
+struct HeightGreater
+{
+    const std::vector<FeatureMap> &levels;
+    explicit HeightGreater(const std::vector<FeatureMap> &l) : levels(l) {}
+    bool operator()(int a, int b) const
+    {
+        return levels[a].sizeY > levels[b].sizeY;
+    }
+};
+
+// The spectrum of feature item % LSVM_NUM_FEATURES of plane
+// item / LSVM_NUM_FEATURES, into s.spectra[item]
+void computePlaneSpectrum(const std::vector<FeatureMap> &levels, int item, PyramidSpectra &s)
+{
+    const int numLevels = (int)levels.size();
+    const int p = item / LSVM_NUM_FEATURES, k = item % LSVM_NUM_FEATURES;
+    cv::Mat planeImage(s.size, CV_32F, cv::Scalar::all(0));
+    for (int l = 0; l < numLevels; l++)
+    {
+        const PyramidSpectra::Placement &at = s.placements[l];
+        if (at.plane != p)
+            continue;
+        const FeatureMap &fmap = levels[l];
+        for (int i = 0; i < fmap.sizeY; i++)
+        {
+            const float *src = &fmap.map[(size_t)i * fmap.sizeX * LSVM_NUM_FEATURES + k];
+            float *dst = planeImage.ptr<float>(at.y + i) + at.x;
+            for (int j = 0; j < fmap.sizeX; j++)
+                dst[j] = src[j * LSVM_NUM_FEATURES];
+        }
+    }
+    cv::dft(planeImage, s.spectra[item]);
+}
+
+// Packs the levels in rows of levels of decreasing height and computes the
+// spectra of the planes, in parallel. maxFilterSize bounds the filters the
+// planes are correlated with.
+void computePyramidSpectra(const std::vector<FeatureMap> &levels, int borderX, int borderY,
+    const cv::Size &maxFilterSize, PyramidSpectra &s)
+{
+    CG_TRACE_SPAN("LatentSvmSpectra");
+    const int numLevels = (int)levels.size();
+    PyramidSpectra::Placement none = {-1, 0, 0};
+    s.placements.assign(numLevels, none);
+    s.numPlanes = 0;
+
+    std::vector<int> order;
+    int maxW = maxFilterSize.width, maxH = maxFilterSize.height;
+    for (int l = 0; l < numLevels; l++)
+    {
+        if (levels[l].sizeX <= 0)
+            continue;
+        order.push_back(l);
+        maxW = std::max(maxW, levels[l].sizeX + borderX);
+        maxH = std::max(maxH, levels[l].sizeY + borderY);
+    }
+    if (order.empty())
+        return;
+    std::stable_sort(order.begin(), order.end(), HeightGreater(levels));
+
+    s.size = cv::Size(cv::getOptimalDFTSize(maxW), cv::getOptimalDFTSize(maxH));
+    int plane = 0, x = 0, y = 0, rowHeight = 0;
+    for (size_t i = 0; i < order.size(); i++)
+    {
+        const FeatureMap &fmap = levels[order[i]];
+        const int w = fmap.sizeX + borderX, h = fmap.sizeY + borderY;
+        if (x + w > s.size.width)
+        {
+            y += rowHeight;
+            x = 0;
+            rowHeight = 0;
+        }
+        if (y + h > s.size.height)
+        {
+            plane++;
+            x = y = rowHeight = 0;
+        }
+        PyramidSpectra::Placement placement = {plane, x, y};
+        s.placements[order[i]] = placement;
+        x += w;
+        rowHeight = std::max(rowHeight, h);
+    }
+    s.numPlanes = plane + 1;
+
+    s.spectra.resize(s.numPlanes * LSVM_NUM_FEATURES);
+#ifdef PARALLEL
+    cgParallelForWorkers(s.numPlanes * LSVM_NUM_FEATURES, [&](int, int item) {
+        computePlaneSpectrum(levels, item, s);
+    });
+#else
+    for (int item = 0; item < s.numPlanes * LSVM_NUM_FEATURES; item++)
+        computePlaneSpectrum(levels, item, s);
+#endif
+}
+
+// The responses of filter at levels [l0, l1) with a zero border of (bx, by)
+// cells: responses[l](i, j) is the correlation of the filter placed at
+// (j - bx, i - by) of level l, as the convolution of the OpenCV detector,
+// negated when negate is set. Levels the filter does not fit get no
+// response. The spectra of the filter are computed once, for all planes.
+void correlateFilter(const WMCvLSVMFilterObject &filter, bool negate,
+    const std::vector<FeatureMap> &levels, const PyramidSpectra &s,
+    int l0, int l1, int bx, int by, cv::Mat *responses)
+{
+    CV_Assert(filter.numFeatures == LSVM_NUM_FEATURES);
+    const int h = filter.sizeY, w = filter.sizeX;
+
+    std::vector<cv::Mat> filterSpectra;
+    cv::Mat sum, product, response;
+    for (int p = 0; p < s.numPlanes; p++)
+    {
+        bool isUsed = false;
+        for (int l = l0; l < l1 && !isUsed; l++)
+        {
+            isUsed = s.placements[l].plane == p &&
+                levels[l].sizeY + 2 * by - h + 1 > 0 && levels[l].sizeX + 2 * bx - w + 1 > 0;
+        }
+        if (!isUsed)
+            continue;
+
+        if (filterSpectra.empty())
+        {
+            filterSpectra.resize(LSVM_NUM_FEATURES);
+            cv::Mat planeImage(s.size, CV_32F);
+            for (int k = 0; k < LSVM_NUM_FEATURES; k++)
+            {
+                planeImage.setTo(cv::Scalar::all(0));
+                for (int i = 0; i < h; i++)
+                {
+                    float *dst = planeImage.ptr<float>(i);
+                    for (int j = 0; j < w; j++)
+                        dst[j] = filter.H[(i * w + j) * LSVM_NUM_FEATURES + k];
+                }
+                cv::dft(planeImage, filterSpectra[k], 0, h);
+            }
+        }
+
+        cv::mulSpectrums(s.spectra[p * LSVM_NUM_FEATURES], filterSpectra[0], sum, 0, true);
+        for (int k = 1; k < LSVM_NUM_FEATURES; k++)
+        {
+            cv::mulSpectrums(s.spectra[p * LSVM_NUM_FEATURES + k], filterSpectra[k], product,
+                0, true);
+            cv::add(sum, product, sum);
+        }
+        cv::dft(sum, response, cv::DFT_INVERSE | cv::DFT_REAL_OUTPUT | cv::DFT_SCALE);
+
+        const int N1 = s.size.height, N2 = s.size.width;
+        for (int l = l0; l < l1; l++)
+        {
+            const PyramidSpectra::Placement &at = s.placements[l];
+            const int rows = levels[l].sizeY + 2 * by - h + 1;
+            const int cols = levels[l].sizeX + 2 * bx - w + 1;
+            if (at.plane != p || rows <= 0 || cols <= 0)
+                continue;
+
+            cv::Mat &out = responses[l];
+            out.create(rows, cols, CV_32F);
+            for (int i = 0; i < rows; i++)
+            {
+                const float *src = response.ptr<float>((at.y + i - by + N1) % N1);
+                float *dst = out.ptr<float>(i);
+                for (int j = 0; j < cols; j++)
+                {
+                    const float v = src[(at.x + j - bx + N2) % N2];
+                    dst[j] = negate ? -v : v;
+                }
+            }
+        }
+    }
+}
+
+/////////////////////////////////////////////////////////////////////////////////
+// Distance transform
+/////////////////////////////////////////////////////////////////////////////////
+
+// d[i] = min over q of f[q] + a (i - q) + b (i - q)^2, b > 0, from the lower
+// envelope of the parabolas; v and z hold n and n + 1 elements
+void distanceTransform1D(const float *f, int n, float a, float b, float *d, int *v, float *z)
+{
+    int k = 0;
+    v[0] = 0;
+    z[0] = -FLT_MAX;
+    z[1] = FLT_MAX;
+    for (int q = 1; q < n; q++)
+    {
+        float s;
+        for (;;)
+        {
+            const int r = v[k];
+            s = ((f[q] - a * q + b * q * q) - (f[r] - a * r + b * r * r)) / (2.0f * b * (q - r));
+            if (s > z[k] || k == 0)
+                break;
+            k--;
+        }
+        // the first parabola is never dropped: z[0] is -FLT_MAX
+        k++;
+        v[k] = q;
+        z[k] = s;
+        z[k + 1] = FLT_MAX;
+    }
+
+    k = 0;
+    for (int i = 0; i < n; i++)
+    {
+        while (z[k + 1] < i)
+            k++;
+        const int diff = i - v[k];
+        d[i] = a * diff + b * diff * diff + f[v[k]];
+    }
+}
+
+// The pass along rows [r0, r1) of the distance transform
+void distanceTransformRows(const cv::Mat &cost, const float pf[4], int r0, int r1,
+    cv::Mat &rowPass)
+{
+    const int cols = cost.cols;
+    std::vector<int> v(cols);
+    std::vector<float> z(cols + 1);
+    for (int i = r0; i < r1; i++)
+        distanceTransform1D(cost.ptr<float>(i), cols, pf[0], pf[2], rowPass.ptr<float>(i),
+            &v[0], &z[0]);
+}
+
+// The pass along columns [c0, c1) of the distance transform
+void distanceTransformCols(const cv::Mat &rowPass, const float pf[4], int c0, int c1,
+    cv::Mat &cost)
+{
+    const int rows = cost.rows;
+    std::vector<int> v(rows);
+    std::vector<float> f(rows), d(rows), z(rows + 1);
+    for (int j = c0; j < c1; j++)
+    {
+        for (int i = 0; i < rows; i++)
+            f[i] = rowPass.at<float>(i, j);
+        distanceTransform1D(&f[0], rows, pf[1], pf[3], &d[0], &v[0], &z[0]);
+        for (int i = 0; i < rows; i++)
+            cost.at<float>(i, j) = d[i];
+    }
+}
+
+// The generalized distance transform of the costs of placing a part, in
+// place, with the penalty pf[0] dx + pf[1] dy + pf[2] dx^2 + pf[3] dy^2 of
+// the displacement (dx, dy). The pass along the rows is split over blocks of
+// rows, the pass along the columns over blocks of columns.
+void distanceTransform(cv::Mat &cost, const float pf[4])
+{
+    const int rows = cost.rows, cols = cost.cols;
+    cv::Mat rowPass(rows, cols, CV_32F);
+
+#ifdef PARALLEL
+    cgParallelForRows(rows, LSVM_MIN_ROWS_PER_BLOCK, [&](int r0, int r1) {
+        distanceTransformRows(cost, pf, r0, r1, rowPass);
+    });
+    cgParallelForRows(cols, LSVM_MIN_COLS_PER_BLOCK, [&](int c0, int c1) {
+        distanceTransformCols(rowPass, pf, c0, c1, cost);
+    });
+#else
+    if (rows > 0)
+        distanceTransformRows(cost, pf, 0, rows, rowPass);
+    if (cols > 0)
+        distanceTransformCols(rowPass, pf, 0, cols, cost);
+#endif
+}
+
+/////////////////////////////////////////////////////////////////////////////////
+// Detection
+/////////////////////////////////////////////////////////////////////////////////
+
+// zero border of the levels for a model, from its largest root filter
+void getModelBorder(const MWCvLatentSvmDetector &model, int &bx, int &by)
+{
+    int maxX = 0, maxY = 0;
+    for (int c = 0, f = 0; c < model.num_components; f += model.num_part_filters[c] + 1, c++)
+    {
+        maxX = std::max(maxX, model.filters[f]->sizeX);
+        maxY = std::max(maxY, model.filters[f]->sizeY);
+    }
+    bx = (int)ceilf((float)maxX / 2.0f + 1.0f);
+    by = (int)ceilf((float)maxY / 2.0f + 1.0f);
+}
+
+struct Candidate
+{
+    int x;
+    int y;
+    float score;
+};
+
+// Orders box indices by decreasing score
+struct ScoreGreater
+{
+    const std::vector<float> &scores;
+    explicit ScoreGreater(const std::vector<float> &s) : scores(s) {}
+    bool operator()(int a, int b) const
+    {
+        return scores[a] > scores[b];
+    }
+};
+
+// Keeps the boxes, by decreasing score, that do not overlap a kept box by
+// more than overlapThreshold of their area
+void suppressNonMaxima(const std::vector<cv::Point> &points,
+    const std::vector<cv::Point> &oppositePoints, const std::vector<float> &scores,
+    float overlapThreshold, std::vector<Detection> &detections)
+{
+    const int numBoxes = (int)scores.size();
+    std::vector<int> indices(numBoxes);
+    std::vector<float> area(numBoxes);
+    std::vector<char> isSuppressed(numBoxes, 0);
+    for (int i = 0; i < numBoxes; i++)
+    {
+        indices[i] = i;
+        area[i] = (float)((oppositePoints[i].x - points[i].x + 1) *
+            (oppositePoints[i].y - points[i].y + 1));
+    }
+    std::stable_sort(indices.begin(), indices.end(), ScoreGreater(scores));
+
+    for (int i = 0; i < numBoxes; i++)
+    {
+        const int a = indices[i];
+        if (isSuppressed[a])
+            continue;
+        for (int j = i + 1; j < numBoxes; j++)
+        {
+            const int b = indices[j];
+            if (isSuppressed[b])
+                continue;
+            const int overlapWidth = std::min(oppositePoints[a].x, oppositePoints[b].x) -
+                std::max(points[a].x, points[b].x) + 1;
+            const int overlapHeight = std::min(oppositePoints[a].y, oppositePoints[b].y) -
+                std::max(points[a].y, points[b].y) + 1;
+            if (overlapWidth > 0 && overlapHeight > 0 &&
+                (overlapWidth * overlapHeight) / area[b] > overlapThreshold)
+                isSuppressed[b] = 1;
+        }
+    }
+
+    for (int i = 0; i < numBoxes; i++)
+    {
+        const int a = indices[i];
+        if (isSuppressed[a])
+            continue;
+        Detection detection;
+        detection.rect = cv::Rect(points[a], oppositePoints[a]);
+        detection.score = scores[a];
+        detections.push_back(detection);
+    }
+}
+
+// The responses of filter f of model at its levels into responses, the
+// root filters at levels [LSVM_LAMBDA, numLevels) and the negated part
+// filters at the part levels [0, numLevels - LSVM_LAMBDA)
+void correlateModelFilter(const MWCvLatentSvmDetector &model, int f, bool root,
+    const std::vector<FeatureMap> &levels, const PyramidSpectra &spectra, int bx, int by,
+    std::vector<cv::Mat> &responses)
+{
+    CG_TRACE_SPAN("LatentSvmFilter");
+    const int numLevels = (int)levels.size();
+    correlateFilter(*model.filters[f], !root, levels, spectra,
+        root ? LSVM_LAMBDA : 0, root ? numLevels : numLevels - LSVM_LAMBDA,
+        bx, by, &responses[(size_t)f * numLevels]);
+}
+
+// The root positions of component c of model at level scoring above its
+// threshold, from the responses of the model
+void scoreRootPositions(const MWCvLatentSvmDetector &model, int c, int level, int numLevels,
+    const std::vector<cv::Mat> &responses, std::vector<Candidate> &candidates)
+{
+    int rootIdx = 0;
+    for (int i = 0; i < c; i++)
+        rootIdx += model.num_part_filters[i] + 1;
+    const int numParts = model.num_part_filters[c];
+    const cv::Mat &root = responses[(size_t)rootIdx * numLevels + level];
+    if (root.empty())
+        return;
+
+    for (int i = 0; i < root.rows; i++)
+    {
+        const float *rootRow = root.ptr<float>(i);
+        for (int j = 0; j < root.cols; j++)
+        {
+            float sumOfParts = 0.0f;
+            for (int k = 1; k <= numParts; k++)
+            {
+                const WMCvLSVMFilterObject &part = *model.filters[rootIdx + k];
+                const cv::Mat &cost = responses[(size_t)(rootIdx + k) * numLevels +
+                    level - LSVM_LAMBDA];
+                const int py = 2 * i + part.V.y, px = 2 * j + part.V.x;
+                if (!cost.empty() && py >= 0 && px >= 0 && py < cost.rows && px < cost.cols)
+                    sumOfParts += cost.at<float>(py, px);
+            }
+            const float score = rootRow[j] - sumOfParts + model.b[c];
+            if (score > model.score_threshold)
+            {
+                Candidate candidate = {j, i, score};
+                candidates.push_back(candidate);
+            }
+        }
+    }
+}
+
+// The detections of each model in image, as cvLatentSvmDetectObjects of
+// OpenCV. The models share the pyramid and its spectra, which are built for
+// the largest border; the filters of all the models are correlated in
+// parallel, then the root positions of all the components and levels are
+// scored in parallel.
+void detectModels(const cv::Mat &image, MWCvLatentSvmDetector *const *models, int numModels,
+    float overlapThreshold, std::vector<std::vector<Detection> > &detections)
+{
+    CV_Assert(image.depth() == CV_8U || image.depth() == CV_32F);
+    CV_Assert(image.channels() == 1 || image.channels() == 3);
+    detections.assign(numModels, std::vector<Detection>());
+
+    std::vector<FeatureMap> levels;
+    buildFeaturePyramid(image, levels);
+    const int numLevels = (int)levels.size();
+    if (numLevels <= LSVM_LAMBDA || numModels == 0)
+        return;
+
+    std::vector<int> bx(numModels), by(numModels);
+    int borderX = 0, borderY = 0;
+    cv::Size maxFilterSize(0, 0);
+    std::vector<std::pair<int, int> > filters;
+    for (int m = 0; m < numModels; m++)
+    {
+        getModelBorder(*models[m], bx[m], by[m]);
+        borderX = std::max(borderX, bx[m]);
+        borderY = std::max(borderY, by[m]);
+        for (int f = 0; f < models[m]->num_filters; f++)
+        {
+            maxFilterSize.width = std::max(maxFilterSize.width, models[m]->filters[f]->sizeX);
+            maxFilterSize.height = std::max(maxFilterSize.height, models[m]->filters[f]->sizeY);
+            filters.push_back(std::make_pair(m, f));
+        }
+    }
+
+    PyramidSpectra spectra;
+    computePyramidSpectra(levels, borderX, borderY, maxFilterSize, spectra);
+
+    // responses of the root filters at levels [LSVM_LAMBDA, numLevels), and
+    // the negated responses of the part filters at the part levels
+    // [0, numLevels - LSVM_LAMBDA)
+    std::vector<std::vector<char> > isRoot(numModels);
+    std::vector<std::vector<cv::Mat> > responses(numModels);
+    for (int m = 0; m < numModels; m++)
+    {
+        const MWCvLatentSvmDetector &model = *models[m];
+        isRoot[m].assign(model.num_filters, 0);
+        for (int c = 0, f = 0; c < model.num_components; f += model.num_part_filters[c] + 1, c++)
+            isRoot[m][f] = 1;
+        responses[m].resize((size_t)model.num_filters * numLevels);
+    }
+
+#ifdef PARALLEL
+    cgParallelForWorkers((int)filters.size(), [&](int, int item) {
+        const int m = filters[item].first, f = filters[item].second;
+        correlateModelFilter(*models[m], f, isRoot[m][f] != 0, levels, spectra, bx[m], by[m],
+            responses[m]);
+    });
+#else
+    for (size_t item = 0; item < filters.size(); item++)
+    {
+        const int m = filters[item].first, f = filters[item].second;
+        correlateModelFilter(*models[m], f, isRoot[m][f] != 0, levels, spectra, bx[m], by[m],
+            responses[m]);
+    }
+#endif
+
+    for (size_t item = 0; item < filters.size(); item++)
+    {
+        const int m = filters[item].first, f = filters[item].second;
+        if (isRoot[m][f])
+            continue;
+        for (int l = 0; l < numLevels - LSVM_LAMBDA; l++)
+        {
+            cv::Mat &cost = responses[m][(size_t)f * numLevels + l];
+            if (!cost.empty())
+                distanceTransform(cost, models[m]->filters[f]->fineFunction);
+        }
+    }
+
+    // root positions of the components and levels scoring above the threshold
+    const int numRootLevels = numLevels - LSVM_LAMBDA;
+    std::vector<std::pair<int, int> > components;
+    for (int m = 0; m < numModels; m++)
+    {
+        for (int c = 0; c < models[m]->num_components; c++)
+            components.push_back(std::make_pair(m, c));
+    }
+    std::vector<std::vector<Candidate> > candidates(components.size() * numRootLevels);
+
+#ifdef PARALLEL
+    cgParallelForWorkers((int)candidates.size(), [&](int, int item) {
+        const int m = components[item / numRootLevels].first;
+        scoreRootPositions(*models[m], components[item / numRootLevels].second,
+            LSVM_LAMBDA + item % numRootLevels, numLevels, responses[m], candidates[item]);
+    });
+#else
+    for (int item = 0; item < (int)candidates.size(); item++)
+    {
+        const int m = components[item / numRootLevels].first;
+        scoreRootPositions(*models[m], components[item / numRootLevels].second,
+            LSVM_LAMBDA + item % numRootLevels, numLevels, responses[m], candidates[item]);
+    }
+#endif
+
+    // boxes in the image, clipped to it, and the non maxima suppression
+    const float step = powf(2.0f, 1.0f / (float)LSVM_LAMBDA);
+    std::vector<cv::Point> points, oppositePoints;
+    std::vector<float> scores;
+    for (int m = 0, item = 0; m < numModels; m++)
+    {
+        points.clear();
+        oppositePoints.clear();
+        scores.clear();
+        for (int c = 0, rootIdx = 0; c < models[m]->num_components; c++)
+        {
+            const WMCvLSVMFilterObject &root = *models[m]->filters[rootIdx];
+            for (int l = 0; l < numRootLevels; l++, item++)
+            {
+                const float scale = LSVM_SIDE_LENGTH * powf(step, (float)l);
+                for (size_t i = 0; i < candidates[item].size(); i++)
+                {
+                    const Candidate &candidate = candidates[item][i];
+                    const cv::Point point((int)((candidate.x - bx[m] + 1) * scale),
+                        (int)((candidate.y - by[m] + 1) * scale));
+                    const cv::Point opposite((int)(point.x + root.sizeX * scale),
+                        (int)(point.y + root.sizeY * scale));
+                    points.push_back(point);
+                    oppositePoints.push_back(opposite);
+                    scores.push_back(candidate.score);
+                }
+            }
+            rootIdx += models[m]->num_part_filters[c] + 1;
+        }
+
+        for (size_t i = 0; i < points.size(); i++)
+        {
+            points[i].x = std::min(std::max(points[i].x, 0), image.cols - 1);
+            points[i].y = std::min(std::max(points[i].y, 0), image.rows - 1);
+            oppositePoints[i].x = std::min(std::max(oppositePoints[i].x, 0), image.cols - 1);
+            oppositePoints[i].y = std::min(std::max(oppositePoints[i].y, 0), image.rows - 1);
+        }
+        suppressNonMaxima(points, oppositePoints, scores, overlapThreshold, detections[m]);
+    }
+}
+
+/////////////////////////////////////////////////////////////////////////////////
+// Model file
+/////////////////////////////////////////////////////////////////////////////////
+
+struct ModelFilter
+{
+    ModelFilter() : sizeX(0), sizeY(0), vx(0), vy(0)
+    {
+        penalty[0] = penalty[1] = penalty[2] = penalty[3] = 0.0f;
+    }
+
+    int sizeX;
+    int sizeY;
+    std::vector<float> H;
+    int vx;
+    int vy;
+    float penalty[4];
+};
+
+struct ModelComponent
+{
+    ModelComponent() : b(0.0f) {}
+
+    ModelFilter root;
+    std::vector<ModelFilter> parts;
+    float b;
+};
+
+WMCvLSVMFilterObject *newFilterObject(const ModelFilter &filter)
+{
+    WMCvLSVMFilterObject *obj = (WMCvLSVMFilterObject *)malloc(sizeof(WMCvLSVMFilterObject));
+    obj->V.x = filter.vx;
+    obj->V.y = filter.vy;
+    obj->V.l = LSVM_LAMBDA;
+    for (int i = 0; i < 4; i++)
+        obj->fineFunction[i] = filter.penalty[i];
+    obj->sizeX = filter.sizeX;
+    obj->sizeY = filter.sizeY;
+    obj->numFeatures = LSVM_NUM_FEATURES;
+    obj->H = (float *)malloc(sizeof(float) * filter.H.size());
+    std::copy(filter.H.begin(), filter.H.end(), obj->H);
+    return obj;
+}
+
+// Reads a model of the OpenCV latent SVM detector: an XML file whose filter
+// weights are the binary doubles that follow the <Weights> tags. Returns NULL
+// when the file cannot be read or is not a model of 31 features.
+MWCvLatentSvmDetector *loadModel(const char *filename)
+{
+    FILE *file = fopen(filename, "rb");
+    if (!file)
+        return NULL;
+    std::vector<char> buf;
+    char chunk[4096];
+    size_t n = 0;
+    while ((n = fread(chunk, 1, sizeof(chunk), file)) > 0)
+        buf.insert(buf.end(), chunk, chunk + n);
+    fclose(file);
+    buf.push_back('\0');
+    const char *text = &buf[0];
+    const size_t size = buf.size() - 1;
+
+    int p = 0;
+    float scoreThreshold = 0.0f;
+    std::vector<ModelComponent> components;
+    // current component, and current filter: -1 for the root, -2 for none
+    int component = -1, part = -2;
+    bool isValid = true;
+
+    size_t pos = 0;
+    while (isValid && (pos = std::find(text + pos, text + size, '<') - text) < size)
+    {
+        if (strncmp(text + pos, "<!--", 4) == 0)
+        {
+            const char *end = strstr(text + pos, "-->");
+            pos = end ? (size_t)(end - text) + 3 : size;
+            continue;
+        }
+        const size_t end = std::find(text + pos, text + size, '>') - text;
+        if (end >= size)
+            break;
+        const std::string tag(text + pos + 1, end - pos - 1);
+        pos = end + 1;
+
+        if (tag == "/Component")
+            component = -1;
+        if (tag == "/RootFilter" || tag == "/PartFilter")
+            part = -2;
+        if (tag.empty() || tag[0] == '/')
+            continue;
+
+        ModelFilter *filter = NULL;
+        if (component >= 0 && part >= -1)
+            filter = part == -1 ? &components[component].root : &components[component].parts[part];
+        const double value = atof(text + pos);
+
+        if (tag == "P")
+            p = (int)value;
+        else if (tag == "ScoreThreshold")
+            scoreThreshold = (float)value;
+        else if (tag == "Component")
+        {
+            components.push_back(ModelComponent());
+            component = (int)components.size() - 1;
+            part = -2;
+        }
+        else if (component < 0)
+            continue;
+        else if (tag == "RootFilter")
+            part = -1;
+        else if (tag == "PartFilter")
+        {
+            components[component].parts.push_back(ModelFilter());
+            part = (int)components[component].parts.size() - 1;
+        }
+        else if (tag == "LinearTerm")
+            components[component].b = (float)value;
+        else if (!filter)
+            continue;
+        else if (tag == "sizeX")
+            filter->sizeX = (int)value;
+        else if (tag == "sizeY")
+            filter->sizeY = (int)value;
+        else if (tag == "Vx")
+            filter->vx = (int)value;
+        else if (tag == "Vy")
+            filter->vy = (int)value;
+        else if (tag == "dx")
+            filter->penalty[0] = (float)value;
+        else if (tag == "dy")
+            filter->penalty[1] = (float)value;
+        else if (tag == "dxx")
+            filter->penalty[2] = (float)value;
+        else if (tag == "dyy")
+            filter->penalty[3] = (float)value;
+        else if (tag == "Weights")
+        {
+            const size_t numWeights = (size_t)std::max(p, 0) * std::max(filter->sizeX, 0) *
+                std::max(filter->sizeY, 0);
+            isValid = numWeights > 0 && pos + numWeights * sizeof(double) <= size;
+            if (!isValid)
+                break;
+            filter->H.resize(numWeights);
+            for (size_t i = 0; i < numWeights; i++)
+            {
+                double weight;
+                memcpy(&weight, text + pos + i * sizeof(double), sizeof(double));
+                filter->H[i] = (float)weight;
+            }
+            pos += numWeights * sizeof(double);
+        }
+    }
+
+    isValid = isValid && p == LSVM_NUM_FEATURES && !components.empty();
+    int numFilters = 0;
+    for (size_t c = 0; isValid && c < components.size(); c++)
+    {
+        isValid = !components[c].root.H.empty();
+        for (size_t k = 0; isValid && k < components[c].parts.size(); k++)
+            isValid = !components[c].parts[k].H.empty();
+        numFilters += 1 + (int)components[c].parts.size();
+    }
+    if (!isValid)
+        return NULL;
+
+    const int numComponents = (int)components.size();
+    MWCvLatentSvmDetector *detector = (MWCvLatentSvmDetector *)malloc(sizeof(MWCvLatentSvmDetector));
+    detector->num_filters = numFilters;
+    detector->num_components = numComponents;
+    detector->num_part_filters = (int *)malloc(sizeof(int) * numComponents);
+    detector->filters = (WMCvLSVMFilterObject **)malloc(sizeof(WMCvLSVMFilterObject *) * numFilters);
+    detector->b = (float *)malloc(sizeof(float) * numComponents);
+    detector->score_threshold = scoreThreshold;
+    for (int c = 0, f = 0; c < numComponents; c++)
+    {
+        const ModelComponent &comp = components[c];
+        detector->num_part_filters[c] = (int)comp.parts.size();
+        detector->b[c] = comp.b;
+        detector->filters[f++] = newFilterObject(comp.root);
+        for (size_t k = 0; k < comp.parts.size(); k++)
+            detector->filters[f++] = newFilterObject(comp.parts[k]);
+    }
+    return detector;
+}
+
+std::string extractModelName(const std::string &filename)
+{
+    size_t startPos = filename.rfind('/');
+    if (startPos == std::string::npos)
+        startPos = filename.rfind('\\');
+    startPos = startPos == std::string::npos ? 0 : startPos + 1;
+    // without the .xml extension
+    return filename.substr(startPos, filename.size() - startPos - 4);
+}
+
+} // namespace
+
+/////////////////////////////////////////////////////////////////////////////////
+// C API
+/////////////////////////////////////////////////////////////////////////////////
+
+CV_IMPL MWCvLatentSvmDetector *MWcvLoadLatentSvmDetector(const char *filename)
+{
+    return loadModel(filename);
+}
+
+CV_IMPL void MWcvReleaseLatentSvmDetector(MWCvLatentSvmDetector **detector)
+{
+    if (!detector || !*detector)
+        return;
+    MWCvLatentSvmDetector *d = *detector;
+    for (int f = 0; f < d->num_filters; f++)
+    {
+        free(d->filters[f]->H);
+        free(d->filters[f]);
+    }
+    free(d->filters);
+    free(d->num_part_filters);
+    free(d->b);
+    free(d);
+    *detector = NULL;
+}
+
+// numThreads is not used: the work runs on the pool, see cgSetNumThreads
+CV_IMPL CvSeq *MWcvLatentSvmDetectObjects(IplImage *image, MWCvLatentSvmDetector *detector,
+    CvMemStorage *storage, float overlap_threshold, int numThreads)
+{
+    CG_PROFILE_CALL();
+    (void)numThreads;
+
+    std::vector<std::vector<Detection> > detections;
+    detectModels(cv::cvarrToMat(image), &detector, 1, overlap_threshold, detections);
+
+    CvSeq *resultSeq = cvCreateSeq(0, sizeof(CvSeq), sizeof(MWCvObjectDetection), storage);
+    for (size_t i = 0; i < detections[0].size(); i++)
+    {
+        MWCvObjectDetection detection;
+        detection.rect = detections[0][i].rect;
+        detection.score = detections[0][i].score;
+        cvSeqPush(resultSeq, &detection);
+    }
+    return resultSeq;
+}
+
+namespace cv
+{
+
+MWLatentSvmDetector::ObjectDetection::ObjectDetection() : score(0.f), classID(-1)
+{
+}
+
+MWLatentSvmDetector::ObjectDetection::ObjectDetection(const Rect &_rect, float _score, int _classID)
+    : rect(_rect), score(_score), classID(_classID)
+{
+}
+
+MWLatentSvmDetector::MWLatentSvmDetector()
+{
+}
+
+MWLatentSvmDetector::MWLatentSvmDetector(const vector<string> &filenames,
+    const vector<string> &_classNames)
+{
+    load(filenames, _classNames);
+}
+
+MWLatentSvmDetector::~MWLatentSvmDetector()
+{
+    clear();
+}
+
+void MWLatentSvmDetector::clear()
+{
+    for (size_t i = 0; i < detectors.size(); i++)
+        MWcvReleaseLatentSvmDetector(&detectors[i]);
+    detectors.clear();
+    classNames.clear();
+}
+
+bool MWLatentSvmDetector::empty() const
+{
+    return detectors.empty();
+}
+
+const vector<string> &MWLatentSvmDetector::getClassNames() const
+{
+    return classNames;
+}
+
+size_t MWLatentSvmDetector::getClassCount() const
+{
+    return classNames.size();
+}
+
+bool MWLatentSvmDetector::load(const vector<string> &filenames, const vector<string> &_classNames)
+{
+    clear();
+
+    CV_Assert(_classNames.empty() || _classNames.size() == filenames.size());
+
+    for (size_t i = 0; i < filenames.size(); i++)
+    {
+        const string &filename = filenames[i];
+        if (filename.length() < 5 || filename.substr(filename.length() - 4, 4) != ".xml")
+            continue;
+
+        MWCvLatentSvmDetector *detector = MWcvLoadLatentSvmDetector(filename.c_str());
+        if (detector)
+        {
+            detectors.push_back(detector);
+            classNames.push_back(_classNames.empty() ? extractModelName(filename) : _classNames[i]);
+        }
+    }
+
+    return !empty();
+}
+
+// All the models run on one pyramid; numThreads is not used, see
+// MWcvLatentSvmDetectObjects
+void MWLatentSvmDetector::detect(const Mat &image, vector<ObjectDetection> &objectDetections,
+    float overlapThreshold, int numThreads)
+{
+    CG_PROFILE_CALL();
+    (void)numThreads;
+    objectDetections.clear();
+    if (detectors.empty())
+        return;
+
+    std::vector<std::vector<Detection> > detections;
+    detectModels(image, &detectors[0], (int)detectors.size(), overlapThreshold, detections);
+    for (size_t classID = 0; classID < detections.size(); classID++)
+    {
+        for (size_t i = 0; i < detections[classID].size(); i++)
+        {
+            objectDetections.push_back(ObjectDetection(detections[classID][i].rect,
+                detections[classID][i].score, (int)classID));
+        }
+    }
+}
+
+} // namespace cv
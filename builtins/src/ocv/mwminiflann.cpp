@@ -1,4 +1,5 @@
 #include "precomp_flann.hpp"
+#include "mwhamming.hpp"
 
 #define MINIFLANN_SUPPORT_EXOTIC_DISTANCE_TYPES 0
 
@@ -331,7 +332,23 @@ buildIndex(void*& index, const Mat& data, const IndexParams& params, const Dista
 #if CV_NEON
 typedef ::cvmwflann::Hamming<uchar> HammingDistance;
 #else
-typedef ::cvmwflann::HammingLUT2 HammingDistance;
+// Hamming distance using the fastest kernel available on this CPU
+// (AVX2, POPCNT or table lookup).
+struct HammingDistance
+{
+    typedef ::cvmwflann::False is_kdtree_distance;
+    typedef ::cvmwflann::False is_vector_space_distance;
+
+    typedef uchar ElementType;
+    typedef int ResultType;
+
+    template<typename Iterator1, typename Iterator2>
+    ResultType operator()(Iterator1 a, Iterator2 b, size_t size, ResultType /*worst_dist*/ = -1) const
+    {
+        return vision::hammingDistance(reinterpret_cast<const uchar*>(a),
+                                       reinterpret_cast<const uchar*>(b), size);
+    }
+};
 #endif
 
 Index::Index()
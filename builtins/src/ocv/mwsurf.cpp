@@ -109,6 +109,8 @@ Modifications by Ian Mahon
 */
 #include "precomp_mw.hpp"
 #include "features2d_surf_mw.hpp"//MK added for class definition of MWSURF
+#include "cgProfile.hpp"
+#include "cgPyramidCache.hpp"
 namespace cv
 {
 
@@ -276,6 +278,7 @@ struct MWSURFBuildInvoker : ParallelLoopBody
 
     void operator()(const Range& range) const
     {
+        CG_TRACE_SPAN("MWSURFBuildInvoker");
         for( int i=range.start; i<range.end; i++ )
             calcLayerDetAndTrace( *sum, (*sizes)[i], (*sampleSteps)[i], (*dets)[i], (*traces)[i] );
     }
@@ -306,6 +309,9 @@ struct MWSURFFindInvoker : ParallelLoopBody
         keypoints = &_keypoints;
         nOctaveLayers = _nOctaveLayers;
         hessianThreshold = _hessianThreshold;
+
+        // construct the lock before the search threads take it
+        findMaximaInLayerMutex();
     }
 
     static void findMaximaInLayer( const Mat& sum, const Mat& mask_sum,
@@ -315,6 +321,7 @@ struct MWSURFFindInvoker : ParallelLoopBody
 
     void operator()(const Range& range) const
     {
+        CG_TRACE_SPAN("MWSURFFindInvoker");
         for( int i=range.start; i<range.end; i++ )
         {
             int layer = (*middleIndices)[i];
@@ -336,11 +343,14 @@ struct MWSURFFindInvoker : ParallelLoopBody
     int nOctaveLayers;
     float hessianThreshold;
 
-    static Mutex findMaximaInLayer_m;
+    // TMW edit: constructed by the first detection rather than at load
+    static Mutex& findMaximaInLayerMutex()
+    {
+        static Mutex findMaximaInLayer_m;
+        return findMaximaInLayer_m;
+    }
 };
 
-Mutex MWSURFFindInvoker::findMaximaInLayer_m;
-
 
 /*
  * Find the maxima in the determinant of the Hessian in a layer of the
@@ -436,7 +446,7 @@ void MWSURFFindInvoker::findMaximaInLayer( const Mat& sum, const Mat& mask_sum,
                     if( interp_ok  )
                     {
                         /*printf( "KeyPoint %f %f %d\n", point.pt.x, point.pt.y, point.size );*/
-                        cv::AutoLock lock(findMaximaInLayer_m);
+                        cv::AutoLock lock(findMaximaInLayerMutex());
                         keypoints.push_back(kpt);
                     }
                 }
@@ -565,6 +575,7 @@ struct MWSURFInvoker : ParallelLoopBody
 
     void operator()(const Range& range) const
     {
+        CG_TRACE_SPAN("MWSURFInvoker");
         /* X and Y gradient wavelet data */
         const int NX=2, NY=2;
         const int dx_s[NX][5] = {{0, 0, 2, 4, -1}, {2, 0, 4, 4, 1}};
@@ -575,6 +586,7 @@ struct MWSURFInvoker : ParallelLoopBody
         const int nOriSampleBound =(2*ORI_RADIUS+1)*(2*ORI_RADIUS+1);
 
         float X[nOriSampleBound], Y[nOriSampleBound], angle[nOriSampleBound];
+        int iangle[nOriSampleBound];
         uchar PATCH[PATCH_SZ+1][PATCH_SZ+1];
         float DX[PATCH_SZ][PATCH_SZ], DY[PATCH_SZ][PATCH_SZ];
         CvMat matX = cvMat(1, nOriSampleBound, CV_32F, X);
@@ -648,13 +660,71 @@ struct MWSURFInvoker : ParallelLoopBody
                 matX.cols = matY.cols = _angle.cols = nangle;
                 cvCartToPolar( &matX, &matY, 0, &_angle, 1 );
 
+                // the angles are rounded once instead of once per window
+                for( j = 0; j < nangle; j++ )
+                    iangle[j] = cvRound(angle[j]);
+
                 float bestx = 0, besty = 0, descriptor_mod = 0;
-                for( i = 0; i < 360; i += MWSURF_ORI_SEARCH_INC )
+                i = 0;
+#if CV_SSE2 || CV_NEON
+                // 4 windows at a time. Each lane sums the samples in the
+                // order of the scalar loop, so the sums are the same.
+                for( ; i <= 360 - 4*MWSURF_ORI_SEARCH_INC; i += 4*MWSURF_ORI_SEARCH_INC )
+                {
+                    float sumx4[4], sumy4[4];
+#if CV_SSE2
+                    __m128i c4 = _mm_setr_epi32(i, i + MWSURF_ORI_SEARCH_INC,
+                        i + 2*MWSURF_ORI_SEARCH_INC, i + 3*MWSURF_ORI_SEARCH_INC);
+                    __m128i lo = _mm_set1_epi32(ORI_WIN/2), hi = _mm_set1_epi32(360-ORI_WIN/2);
+                    __m128 sx = _mm_setzero_ps(), sy = _mm_setzero_ps();
+                    for( j = 0; j < nangle; j++ )
+                    {
+                        __m128i d = _mm_sub_epi32(_mm_set1_epi32(iangle[j]), c4);
+                        __m128i sgn = _mm_srai_epi32(d, 31);
+                        d = _mm_sub_epi32(_mm_xor_si128(d, sgn), sgn);
+                        __m128 inWin = _mm_castsi128_ps(_mm_or_si128(
+                            _mm_cmplt_epi32(d, lo), _mm_cmpgt_epi32(d, hi)));
+                        sx = _mm_add_ps(sx, _mm_and_ps(inWin, _mm_set1_ps(X[j])));
+                        sy = _mm_add_ps(sy, _mm_and_ps(inWin, _mm_set1_ps(Y[j])));
+                    }
+                    _mm_storeu_ps(sumx4, sx);
+                    _mm_storeu_ps(sumy4, sy);
+#else
+                    const int c[4] = { i, i + MWSURF_ORI_SEARCH_INC,
+                        i + 2*MWSURF_ORI_SEARCH_INC, i + 3*MWSURF_ORI_SEARCH_INC };
+                    int32x4_t c4 = vld1q_s32(c);
+                    int32x4_t lo = vdupq_n_s32(ORI_WIN/2), hi = vdupq_n_s32(360-ORI_WIN/2);
+                    float32x4_t sx = vdupq_n_f32(0.f), sy = vdupq_n_f32(0.f);
+                    for( j = 0; j < nangle; j++ )
+                    {
+                        int32x4_t d = vabdq_s32(vdupq_n_s32(iangle[j]), c4);
+                        uint32x4_t inWin = vorrq_u32(vcltq_s32(d, lo), vcgtq_s32(d, hi));
+                        sx = vaddq_f32(sx, vreinterpretq_f32_u32(vandq_u32(inWin,
+                            vreinterpretq_u32_f32(vdupq_n_f32(X[j])))));
+                        sy = vaddq_f32(sy, vreinterpretq_f32_u32(vandq_u32(inWin,
+                            vreinterpretq_u32_f32(vdupq_n_f32(Y[j])))));
+                    }
+                    vst1q_f32(sumx4, sx);
+                    vst1q_f32(sumy4, sy);
+#endif
+                    for( kk = 0; kk < 4; kk++ )
+                    {
+                        float temp_mod = sumx4[kk]*sumx4[kk] + sumy4[kk]*sumy4[kk];
+                        if( temp_mod > descriptor_mod )
+                        {
+                            descriptor_mod = temp_mod;
+                            bestx = sumx4[kk];
+                            besty = sumy4[kk];
+                        }
+                    }
+                }
+#endif
+                for( ; i < 360; i += MWSURF_ORI_SEARCH_INC )
                 {
                     float sumx = 0, sumy = 0, temp_mod;
                     for( j = 0; j < nangle; j++ )
                     {
-                        int d = std::abs(cvRound(angle[j]) - i);
+                        int d = std::abs(iangle[j] - i);
                         if( d < ORI_WIN/2 || d > 360-ORI_WIN/2 )
                         {
                             sumx += X[j];
@@ -927,7 +997,6 @@ void MWSURF::operator()(InputArray _img, InputArray _mask,
                       bool useProvidedKeypoints) const
 {
     Mat img = _img.getMat(), mask = _mask.getMat(), mask1, sum, msum;
-    bool doDescriptors = _descriptors.needed();
 
     if (img.empty())
         return; // this handles the case of (0,0) pixels: no keypoints are returned.
@@ -941,7 +1010,7 @@ void MWSURF::operator()(InputArray _img, InputArray _mask,
     CV_Assert(nOctaves > 0);
     CV_Assert(nOctaveLayers > 0);
 
-    integral(img, sum, CV_32S);
+    vision::PyramidCache::acquire(img)->getIntegrals(0, sum);
 
     // Compute keypoints only if we are not asked for evaluating the descriptors are some given locations:
     if( !useProvidedKeypoints )
@@ -949,11 +1018,21 @@ void MWSURF::operator()(InputArray _img, InputArray _mask,
         if( !mask.empty() )
         {
             cv::min(mask, 1, mask1);
-            integral(mask1, msum, CV_32S);
+            vision::computeIntegrals(mask1, msum);
         }
         fastHessianDetector( sum, msum, keypoints, nOctaves, nOctaveLayers, (float)hessianThreshold );
     }
 
+    describe(img, sum, keypoints, _descriptors);
+}
+
+// TMW Edit: computes the orientation and, when needed, the descriptors of the
+// keypoints from the integral image of img. Keypoints too close to the
+// border are removed.
+void MWSURF::describe(const Mat& img, const Mat& sum, vector<KeyPoint>& keypoints,
+                      OutputArray _descriptors) const
+{
+    bool doDescriptors = _descriptors.needed();
     int i, j, N = (int)keypoints.size();
     if( N > 0 )
     {
@@ -1004,12 +1083,94 @@ void MWSURF::operator()(InputArray _img, InputArray _mask,
                 Mat d = descriptors.rowRange(0, N);
                 if( _1d )
                     d = d.reshape(1, N*dcols);
-                d.copyTo(_descriptors);
+                // a Mat output keeps its single allocation: its header is
+                // narrowed to the kept rows instead of copying them
+                if( _descriptors.kind() == _InputArray::MAT )
+                    _descriptors.getMatRef() = d;
+                else
+                    d.copyTo(_descriptors);
             }
         }
     }
 }
 
+// TMW Edit: detects the keypoints and extracts their descriptors from a
+// single integral image. Before the extraction, the keypoint sizes are
+// rounded as they are when the keypoints of detect come back through
+// MATLAB, so the descriptors match those of detect followed by compute.
+void MWSURF::detectAndCompute( const Mat& _img, vector<KeyPoint>& keypoints, Mat& descriptors ) const
+{
+    Mat img = _img, sum, msum;
+    keypoints.clear();
+
+    if (img.empty())
+        return;
+
+    CV_Assert(img.depth() == CV_8U);
+    if( img.channels() > 1 )
+        cvtColor(img, img, COLOR_BGR2GRAY);
+
+    CV_Assert(hessianThreshold >= 0);
+    CV_Assert(nOctaves > 0);
+    CV_Assert(nOctaveLayers > 0);
+
+    vision::PyramidCache::acquire(img)->getIntegrals(0, sum);
+    fastHessianDetector( sum, msum, keypoints, nOctaves, nOctaveLayers, (float)hessianThreshold );
+
+    const float sizeToScale = 1.2f/9.0f;
+    for( size_t k = 0; k < keypoints.size(); k++ )
+    {
+        keypoints[k].size = (float)cvRound((keypoints[k].size*sizeToScale)/sizeToScale);
+        keypoints[k].angle = 0;
+        keypoints[k].octave = 0;
+    }
+
+    describe(img, sum, keypoints, descriptors);
+}
+
+// TMW Edit: detect and compute split around one integral image. The integral
+// image computed by detectWithIntegral is handed back to computeWithIntegral
+// for the same image, which then skips its own full-frame pass.
+void MWSURF::detectWithIntegral( const Mat& _img, vector<KeyPoint>& keypoints, Mat& sum ) const
+{
+    Mat img = _img, msum;
+
+    if (img.empty())
+    {
+        sum.release();
+        return;
+    }
+
+    CV_Assert(img.depth() == CV_8U);
+    if( img.channels() > 1 )
+        cvtColor(img, img, COLOR_BGR2GRAY);
+
+    CV_Assert(hessianThreshold >= 0);
+    CV_Assert(nOctaves > 0);
+    CV_Assert(nOctaveLayers > 0);
+
+    vision::PyramidCache::acquire(img)->getIntegrals(0, sum);
+    fastHessianDetector( sum, msum, keypoints, nOctaves, nOctaveLayers, (float)hessianThreshold );
+
+    // as detect, drop the keypoints whose orientation cannot be sampled
+    describe(img, sum, keypoints, noArray());
+}
+
+void MWSURF::computeWithIntegral( const Mat& _img, const Mat& sum, vector<KeyPoint>& keypoints, Mat& descriptors ) const
+{
+    Mat img = _img;
+
+    if (img.empty())
+        return;
+
+    CV_Assert(img.depth() == CV_8U);
+    CV_Assert(sum.type() == CV_32S && sum.rows == img.rows+1 && sum.cols == img.cols+1);
+    if( img.channels() > 1 )
+        cvtColor(img, img, COLOR_BGR2GRAY);
+
+    describe(img, sum, keypoints, descriptors);
+}
+
 // TMW Edit: public methods to run the private Impl methods.
 // Used in detectSURFFeatures.
 void MWSURF::detect( const Mat& image, vector<KeyPoint>& keypoints, const Mat& mask ) const
@@ -0,0 +1,210 @@
+///////////////////////////////////////////////////////////////////////////////
+// This file contains the shared library function calls used in codegen for
+// recognizing many regions of ocr with a pool of Tesseract handles, see
+// OcrHandlePool.hpp.
+///////////////////////////////////////////////////////////////////////////////
+#ifndef COMPILE_FOR_VISION_BUILTINS
+#include "ocrBatchCore_api.hpp"
+#include "OcrHandlePool.hpp"
+#include "cgProfile.hpp"
+
+#define NUM_REGION_INFO 8
+
+void ocrBatch_construct(void ** ptr2ptrPool)
+{
+    *ptr2ptrPool = new ocr::OcrHandlePool();
+}
+
+void ocrBatch_setOptions(void * ptrPool, const char * textLayout,
+        const char * characterSet, const char * tessdata, const char * lang)
+{
+    ocr::OcrOptions options;
+    options.textLayout = textLayout;
+    options.characterSet = characterSet;
+    options.tessdata = tessdata;
+    options.lang = lang;
+    ((ocr::OcrHandlePool *)ptrPool)->setOptions(options);
+}
+
+static int32_T recognize(void * ptrPool, const void * image, bool isLogical,
+        bool isRowMajor, int32_T numRows, int32_T numCols, const int32_T * rois,
+        int32_T numRois, int32_T * totals, void ** ptr2ptrResult)
+{
+    std::vector<ocr::OcrRegion> *regions = new std::vector<ocr::OcrRegion>();
+    *ptr2ptrResult = regions;
+
+    ((ocr::OcrHandlePool *)ptrPool)->recognize(image, numRows, numCols,
+        isLogical, isRowMajor, rois, numRois, *regions);
+
+    int32_T status = 0;
+    std::fill(totals, totals + 1 + ocr::NUM_LEVELS, 0);
+    for (size_t r = 0; r < regions->size(); r++)
+    {
+        const ocr::OcrRegion &region = (*regions)[r];
+        if (region.status < 0 && status == 0)
+            status = region.status;
+        totals[0] += (int32_T)(region.text.size() + region.metadataText.size());
+        for (int l = 0; l < ocr::NUM_LEVELS; l++)
+            totals[1 + l] += region.levels[l].count;
+    }
+    return status;
+}
+
+int32_T ocrBatch_recognizeUint8(void * ptrPool, const uint8_T * image,
+        int32_T numRows, int32_T numCols, const int32_T * rois,
+        int32_T numRois, int32_T * totals, void ** ptr2ptrResult)
+{
+    CG_PROFILE_CALL();
+    CG_PROFILE_PHASE(CG_PROFILE_COMPUTE);
+    return recognize(ptrPool, image, false, false, numRows, numCols, rois,
+        numRois, totals, ptr2ptrResult);
+}
+
+int32_T ocrBatch_recognizeUint8RM(void * ptrPool, const uint8_T * image,
+        int32_T numRows, int32_T numCols, const int32_T * rois,
+        int32_T numRois, int32_T * totals, void ** ptr2ptrResult)
+{
+    CG_PROFILE_CALL();
+    CG_PROFILE_PHASE(CG_PROFILE_COMPUTE);
+    return recognize(ptrPool, image, false, true, numRows, numCols, rois,
+        numRois, totals, ptr2ptrResult);
+}
+
+int32_T ocrBatch_recognizeLogical(void * ptrPool, const boolean_T * image,
+        int32_T numRows, int32_T numCols, const int32_T * rois,
+        int32_T numRois, int32_T * totals, void ** ptr2ptrResult)
+{
+    CG_PROFILE_CALL();
+    CG_PROFILE_PHASE(CG_PROFILE_COMPUTE);
+    return recognize(ptrPool, image, true, false, numRows, numCols, rois,
+        numRois, totals, ptr2ptrResult);
+}
+
+int32_T ocrBatch_recognizeLogicalRM(void * ptrPool, const boolean_T * image,
+        int32_T numRows, int32_T numCols, const int32_T * rois,
+        int32_T numRois, int32_T * totals, void ** ptr2ptrResult)
+{
+    CG_PROFILE_CALL();
+    CG_PROFILE_PHASE(CG_PROFILE_COMPUTE);
+    return recognize(ptrPool, image, true, true, numRows, numCols, rois,
+        numRois, totals, ptr2ptrResult);
+}
+
+// Copies the n-by-numCols column major src to rows [offset, offset+n) of
+// dst, total-by-numCols
+template <typename T>
+static void copyRows(const std::vector<T> & src, size_t n, size_t numCols,
+        T * dst, size_t offset, size_t total, bool isRowMajor)
+{
+    for (size_t i = 0; i < n; i++)
+    {
+        for (size_t k = 0; k < numCols; k++)
+        {
+            if (isRowMajor)
+                dst[(offset + i) * numCols + k] = src[i + k * n];
+            else
+                dst[offset + i + k * total] = src[i + k * n];
+        }
+    }
+}
+
+static void assignOutputDelete(void * ptrResult, bool isRowMajor,
+        int32_T * regionInfo, uint8_T * text, double * bbox[], int32_T * parentIndex[],
+        real32_T * confidence[], int32_T * characterIndex[])
+{
+    std::vector<ocr::OcrRegion> *regions = (std::vector<ocr::OcrRegion> *)ptrResult;
+    const size_t numRegions = regions->size();
+
+    size_t totals[ocr::NUM_LEVELS] = {0};
+    for (size_t r = 0; r < numRegions; r++)
+    {
+        for (int l = 0; l < ocr::NUM_LEVELS; l++)
+            totals[l] += (*regions)[r].levels[l].count;
+    }
+
+    size_t offsets[ocr::NUM_LEVELS] = {0};
+    for (size_t r = 0; r < numRegions; r++)
+    {
+        const ocr::OcrRegion &region = (*regions)[r];
+
+        int32_T info[NUM_REGION_INFO];
+        info[0] = region.status;
+        info[1] = (int32_T)region.text.size();
+        info[2] = (int32_T)region.metadataText.size();
+        for (int l = 0; l < ocr::NUM_LEVELS; l++)
+            info[3 + l] = region.levels[l].count;
+        for (int k = 0; k < NUM_REGION_INFO; k++)
+        {
+            if (isRowMajor)
+                regionInfo[r * NUM_REGION_INFO + k] = info[k];
+            else
+                regionInfo[r + k * numRegions] = info[k];
+        }
+
+        text = std::copy(region.text.begin(), region.text.end(), text);
+        text = std::copy(region.metadataText.begin(), region.metadataText.end(), text);
+
+        for (int l = 0; l < ocr::NUM_LEVELS; l++)
+        {
+            const ocr::OcrLevel &level = region.levels[l];
+            const size_t n = level.count;
+            copyRows(level.bbox, n, 4, bbox[l], offsets[l], totals[l], isRowMajor);
+            std::copy(level.parentIndex.begin(), level.parentIndex.end(), parentIndex[l] + offsets[l]);
+            std::copy(level.confidence.begin(), level.confidence.end(), confidence[l] + offsets[l]);
+            if (characterIndex[l])
+                copyRows(level.characterIndex, n, 2, characterIndex[l], offsets[l], totals[l], isRowMajor);
+            offsets[l] += n;
+        }
+    }
+
+    delete regions;
+}
+
+void ocrBatch_assignOutputDelete(void * ptrResult,
+        int32_T * regionInfo, uint8_T * text,
+        double * charBBox, int32_T * charWordIndex, real32_T * charConfidence,
+        double * wordBBox, int32_T * wordTextLineIndex, real32_T * wordConfidence, int32_T * wordCharacterIndex,
+        double * textlineBBox, int32_T * textlineParagraphIndex, real32_T * textlineConfidence, int32_T * textlineCharacterIndex,
+        double * paragraphBBox, int32_T * paragraphBlockIndex, real32_T * paragraphConfidence, int32_T * paragraphCharacterIndex,
+        double * blockBBox, int32_T * blockPageIndex, real32_T * blockConfidence, int32_T * blockCharacterIndex)
+{
+    CG_PROFILE_CALL();
+    CG_PROFILE_PHASE(CG_PROFILE_OUTPUT);
+    double * bbox[] = {charBBox, wordBBox, textlineBBox, paragraphBBox, blockBBox};
+    int32_T * parentIndex[] = {charWordIndex, wordTextLineIndex, textlineParagraphIndex,
+        paragraphBlockIndex, blockPageIndex};
+    real32_T * confidence[] = {charConfidence, wordConfidence, textlineConfidence,
+        paragraphConfidence, blockConfidence};
+    int32_T * characterIndex[] = {NULL, wordCharacterIndex, textlineCharacterIndex,
+        paragraphCharacterIndex, blockCharacterIndex};
+    assignOutputDelete(ptrResult, false, regionInfo, text, bbox, parentIndex,
+        confidence, characterIndex);
+}
+
+void ocrBatch_assignOutputDeleteRM(void * ptrResult,
+        int32_T * regionInfo, uint8_T * text,
+        double * charBBox, int32_T * charWordIndex, real32_T * charConfidence,
+        double * wordBBox, int32_T * wordTextLineIndex, real32_T * wordConfidence, int32_T * wordCharacterIndex,
+        double * textlineBBox, int32_T * textlineParagraphIndex, real32_T * textlineConfidence, int32_T * textlineCharacterIndex,
+        double * paragraphBBox, int32_T * paragraphBlockIndex, real32_T * paragraphConfidence, int32_T * paragraphCharacterIndex,
+        double * blockBBox, int32_T * blockPageIndex, real32_T * blockConfidence, int32_T * blockCharacterIndex)
+{
+    CG_PROFILE_CALL();
+    CG_PROFILE_PHASE(CG_PROFILE_OUTPUT);
+    double * bbox[] = {charBBox, wordBBox, textlineBBox, paragraphBBox, blockBBox};
+    int32_T * parentIndex[] = {charWordIndex, wordTextLineIndex, textlineParagraphIndex,
+        paragraphBlockIndex, blockPageIndex};
+    real32_T * confidence[] = {charConfidence, wordConfidence, textlineConfidence,
+        paragraphConfidence, blockConfidence};
+    int32_T * characterIndex[] = {NULL, wordCharacterIndex, textlineCharacterIndex,
+        paragraphCharacterIndex, blockCharacterIndex};
+    assignOutputDelete(ptrResult, true, regionInfo, text, bbox, parentIndex,
+        confidence, characterIndex);
+}
+
+void ocrBatch_deleteObj(void * ptrPool)
+{
+    delete ((ocr::OcrHandlePool *)ptrPool);
+}
+
+#endif
@@ -10,9 +10,12 @@
 
 #include "opticalFlowFarnebackCore_api.hpp"
 #include "cgCommon.hpp"
+#include "OpticalFlowFarnebackOcv.hpp"
+#include "cgProfile.hpp"
 
 using namespace cv;
 using namespace std;
+using namespace opticalFlow;
 
 
 //////////////////////////////////////////////////////////////////////////////
@@ -24,10 +27,17 @@ void opticalFlowFarneback_compute(uint8_T *inImgPrev, uint8_T *inImgCurr,
     cvstFarnebackStruct_T *params,
     int32_T nRows, int32_T nCols)
 {
+    CG_PROFILE_CALL();
     cv::Mat imgPrev = cv::Mat(nRows, (int)nCols, CV_8UC1, inImgPrev);
     cv::Mat imgCurr = cv::Mat(nRows, (int)nCols, CV_8UC1, inImgCurr);
 
-    cv::Mat inflowXYmat = cv::Mat(nRows, (int)nCols, CV_32FC2);
+    // the initial flow is only read by OpenCV with OPTFLOW_USE_INITIAL_FLOW
+    cv::Mat inflowXYmat;
+    if ((params->flags & cv::OPTFLOW_USE_INITIAL_FLOW) && inFlowXY)
+        flowToMat(inFlowXY, nRows, nCols, inflowXYmat);
+    else
+        inflowXYmat.create(nRows, (int)nCols, CV_32FC2);
+    CG_PROFILE_PHASE(CG_PROFILE_COMPUTE);
 
     // Call OpenCV Farneback algorithm
     cv::calcOpticalFlowFarneback(imgPrev, imgCurr, inflowXYmat,
@@ -36,6 +46,7 @@ void opticalFlowFarneback_compute(uint8_T *inImgPrev, uint8_T *inImgCurr,
         params->flags);
 
     // copy to output
+    CG_PROFILE_PHASE(CG_PROFILE_OUTPUT);
     cArrayFromMat<real32_T>(outFlowXY, inflowXYmat);
 }
 
@@ -44,10 +55,17 @@ void opticalFlowFarneback_computeRM(uint8_T *inImgPrev, uint8_T *inImgCurr,
 	cvstFarnebackStruct_T *params,
 	int32_T nRows, int32_T nCols)
 {
+	CG_PROFILE_CALL();
 	cv::Mat imgPrev = cv::Mat(nRows, (int)nCols, CV_8UC1, inImgPrev);
 	cv::Mat imgCurr = cv::Mat(nRows, (int)nCols, CV_8UC1, inImgCurr);
 
-	cv::Mat inflowXYmat = cv::Mat(nRows, (int)nCols, CV_32FC2);
+	// the initial flow is only read by OpenCV with OPTFLOW_USE_INITIAL_FLOW
+	cv::Mat inflowXYmat;
+	if ((params->flags & cv::OPTFLOW_USE_INITIAL_FLOW) && inFlowXY)
+		flowToMat_RowMaj(inFlowXY, nRows, nCols, inflowXYmat);
+	else
+		inflowXYmat.create(nRows, (int)nCols, CV_32FC2);
+	CG_PROFILE_PHASE(CG_PROFILE_COMPUTE);
 
 	// Call OpenCV Farneback algorithm
 	cv::calcOpticalFlowFarneback(imgPrev, imgCurr, inflowXYmat,
@@ -56,7 +74,97 @@ void opticalFlowFarneback_computeRM(uint8_T *inImgPrev, uint8_T *inImgCurr,
 		params->flags);
 
 	// copy to output
+	CG_PROFILE_PHASE(CG_PROFILE_OUTPUT);
 	cArrayFromMat_RowMaj<real32_T>(outFlowXY, inflowXYmat);
 }
 
+//////////////////////////////////////////////////////////////////////////////
+// Stateful flow: the previous frame and the last flow are kept across frames
+//////////////////////////////////////////////////////////////////////////////
+
+void opticalFlowFarneback_construct(void **ptr2ptrClass)
+{
+    OpticalFlowFarnebackOcv *ptrClass_ = new OpticalFlowFarnebackOcv();
+    *ptr2ptrClass = ptrClass_;
+}
+
+void opticalFlowFarneback_constructOnDevice(void **ptr2ptrClass, int32_T device)
+{
+    OpticalFlowFarnebackOcv *ptrClass_ = new OpticalFlowFarnebackOcv((int)device);
+    *ptr2ptrClass = ptrClass_;
+}
+
+boolean_T opticalFlowFarneback_isOnDevice(void *ptrClass)
+{
+    return ((OpticalFlowFarnebackOcv *)ptrClass)->isOnDevice();
+}
+
+void opticalFlowFarneback_step(void *ptrClass, uint8_T *inImgCurr,
+    float *outFlowXY, cvstFarnebackStruct_T *params,
+    int32_T nRows, int32_T nCols)
+{
+    CG_PROFILE_CALL();
+    OpticalFlowFarnebackOcv *ptrClass_ = (OpticalFlowFarnebackOcv *)ptrClass;
+    ptrClass_->step(inImgCurr, nRows, nCols, params, outFlowXY, false);
+}
+
+void opticalFlowFarneback_stepRM(void *ptrClass, uint8_T *inImgCurr,
+    float *outFlowXY, cvstFarnebackStruct_T *params,
+    int32_T nRows, int32_T nCols)
+{
+    CG_PROFILE_CALL();
+    OpticalFlowFarnebackOcv *ptrClass_ = (OpticalFlowFarnebackOcv *)ptrClass;
+    ptrClass_->step(inImgCurr, nRows, nCols, params, outFlowXY, true);
+}
+
+void opticalFlowFarneback_submit(void *ptrClass, uint8_T *inImgCurr,
+    cvstFarnebackStruct_T *params, int32_T nRows, int32_T nCols)
+{
+    CG_PROFILE_CALL();
+    OpticalFlowFarnebackOcv *ptrClass_ = (OpticalFlowFarnebackOcv *)ptrClass;
+    ptrClass_->submit(inImgCurr, nRows, nCols, params);
+}
+
+boolean_T opticalFlowFarneback_getFlow(void *ptrClass, float *outFlowXY)
+{
+    CG_PROFILE_CALL();
+    CG_PROFILE_PHASE(CG_PROFILE_OUTPUT);
+    OpticalFlowFarnebackOcv *ptrClass_ = (OpticalFlowFarnebackOcv *)ptrClass;
+    return ptrClass_->getFlow(outFlowXY, false);
+}
+
+boolean_T opticalFlowFarneback_getFlowRM(void *ptrClass, float *outFlowXY)
+{
+    CG_PROFILE_CALL();
+    CG_PROFILE_PHASE(CG_PROFILE_OUTPUT);
+    OpticalFlowFarnebackOcv *ptrClass_ = (OpticalFlowFarnebackOcv *)ptrClass;
+    return ptrClass_->getFlow(outFlowXY, true);
+}
+
+void opticalFlowFarneback_stepImage(void *ptrClass, void *ptrImage,
+    float *outFlowXY, cvstFarnebackStruct_T *params)
+{
+    CG_PROFILE_CALL();
+    OpticalFlowFarnebackOcv *ptrClass_ = (OpticalFlowFarnebackOcv *)ptrClass;
+    ptrClass_->step(*(vision::ImageHandle *)ptrImage, params, outFlowXY);
+}
+
+void opticalFlowFarneback_submitImage(void *ptrClass, void *ptrImage,
+    cvstFarnebackStruct_T *params)
+{
+    CG_PROFILE_CALL();
+    OpticalFlowFarnebackOcv *ptrClass_ = (OpticalFlowFarnebackOcv *)ptrClass;
+    ptrClass_->submit(*(vision::ImageHandle *)ptrImage, params);
+}
+
+void opticalFlowFarneback_reset(void *ptrClass)
+{
+    ((OpticalFlowFarnebackOcv *)ptrClass)->reset();
+}
+
+void opticalFlowFarneback_deleteObj(void *ptrClass)
+{
+    delete ((OpticalFlowFarnebackOcv *)ptrClass);
+}
+
 #endif
\ No newline at end of file
@@ -0,0 +1,200 @@
+///////////////////////////////////////////////////////////////////////////////
+// This file contains the shared library function calls used in codegen for
+// the nearest neighbor and radius searches of pointCloud, see
+// PointCloudKdtree.hpp.
+///////////////////////////////////////////////////////////////////////////////
+#ifndef COMPILE_FOR_VISION_BUILTINS
+#include "pointCloudKdtreeCore_api.hpp"
+#include "PointCloudKdtree.hpp"
+#include "cgProfile.hpp"
+
+template <typename T>
+static void radiusSearch(void *ptrKdtree, const T * points, int32_T numQueries,
+        T radius, int32_T maxLeafChecks, boolean_T doSort, bool isRowMajor,
+        uint32_T * valid, void **ptr2ptrResult)
+{
+    pckdtree::PointCloudKdtree<T> *ptrKdtree_ = (pckdtree::PointCloudKdtree<T> *)ptrKdtree;
+    pckdtree::RadiusResult<T> *ptrResult_ = new pckdtree::RadiusResult<T>();
+    ptrKdtree_->radiusSearch(points, (int)numQueries, radius, (int)maxLeafChecks,
+        doSort != 0, isRowMajor, *ptrResult_);
+    for (int32_T i = 0; i < numQueries; i++)
+        valid[i] = (uint32_T)ptrResult_->neighbors[i].size();
+    *ptr2ptrResult = ptrResult_;
+}
+
+template <typename T>
+static void assignRadiusOutputDelete(void *ptrResult, uint32_T * indices, T * dists)
+{
+    pckdtree::RadiusResult<T> *ptrResult_ = (pckdtree::RadiusResult<T> *)ptrResult;
+    size_t k = 0;
+    for (size_t i = 0; i < ptrResult_->neighbors.size(); i++)
+    {
+        for (size_t j = 0; j < ptrResult_->neighbors[i].size(); j++, k++)
+        {
+            dists[k] = ptrResult_->neighbors[i][j].first;
+            indices[k] = ptrResult_->neighbors[i][j].second;
+        }
+    }
+    delete ptrResult_;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void pointCloudKdtree_construct(void **ptr2ptrKdtree)
+{
+    pckdtree::PointCloudKdtree<double> *ptrKdtree_ = new pckdtree::PointCloudKdtree<double>();
+    *ptr2ptrKdtree = ptrKdtree_;
+}
+
+void pointCloudKdtree_index(void *ptrKdtree, const double * location,
+        int32_T numPoints)
+{
+    CG_PROFILE_CALL();
+    CG_PROFILE_PHASE(CG_PROFILE_COMPUTE);
+    pckdtree::PointCloudKdtree<double> *ptrKdtree_ = (pckdtree::PointCloudKdtree<double> *)ptrKdtree;
+    ptrKdtree_->index(location, (int)numPoints, false);
+}
+
+void pointCloudKdtree_indexRM(void *ptrKdtree, const double * location,
+        int32_T numPoints)
+{
+    CG_PROFILE_CALL();
+    CG_PROFILE_PHASE(CG_PROFILE_COMPUTE);
+    pckdtree::PointCloudKdtree<double> *ptrKdtree_ = (pckdtree::PointCloudKdtree<double> *)ptrKdtree;
+    ptrKdtree_->index(location, (int)numPoints, true);
+}
+
+void pointCloudKdtree_knnSearch(void *ptrKdtree, const double * points,
+        int32_T numQueries, int32_T K, int32_T maxLeafChecks,
+        uint32_T * indices, double * dists, uint32_T * valid)
+{
+    CG_PROFILE_CALL();
+    CG_PROFILE_PHASE(CG_PROFILE_COMPUTE);
+    pckdtree::PointCloudKdtree<double> *ptrKdtree_ = (pckdtree::PointCloudKdtree<double> *)ptrKdtree;
+    ptrKdtree_->knnSearch(points, (int)numQueries, (int)K, (int)maxLeafChecks,
+        false, indices, dists, valid);
+}
+
+void pointCloudKdtree_knnSearchRM(void *ptrKdtree, const double * points,
+        int32_T numQueries, int32_T K, int32_T maxLeafChecks,
+        uint32_T * indices, double * dists, uint32_T * valid)
+{
+    CG_PROFILE_CALL();
+    CG_PROFILE_PHASE(CG_PROFILE_COMPUTE);
+    pckdtree::PointCloudKdtree<double> *ptrKdtree_ = (pckdtree::PointCloudKdtree<double> *)ptrKdtree;
+    ptrKdtree_->knnSearch(points, (int)numQueries, (int)K, (int)maxLeafChecks,
+        true, indices, dists, valid);
+}
+
+void pointCloudKdtree_radiusSearch(void *ptrKdtree, const double * points,
+        int32_T numQueries, double radius, int32_T maxLeafChecks,
+        boolean_T doSort, uint32_T * valid, void **ptr2ptrResult)
+{
+    CG_PROFILE_CALL();
+    CG_PROFILE_PHASE(CG_PROFILE_COMPUTE);
+    radiusSearch(ptrKdtree, points, numQueries, radius, maxLeafChecks, doSort,
+        false, valid, ptr2ptrResult);
+}
+
+void pointCloudKdtree_radiusSearchRM(void *ptrKdtree, const double * points,
+        int32_T numQueries, double radius, int32_T maxLeafChecks,
+        boolean_T doSort, uint32_T * valid, void **ptr2ptrResult)
+{
+    CG_PROFILE_CALL();
+    CG_PROFILE_PHASE(CG_PROFILE_COMPUTE);
+    radiusSearch(ptrKdtree, points, numQueries, radius, maxLeafChecks, doSort,
+        true, valid, ptr2ptrResult);
+}
+
+void pointCloudKdtree_assignRadiusOutputDelete(void *ptrResult,
+        uint32_T * indices, double * dists)
+{
+    CG_PROFILE_CALL();
+    CG_PROFILE_PHASE(CG_PROFILE_OUTPUT);
+    assignRadiusOutputDelete(ptrResult, indices, dists);
+}
+
+void pointCloudKdtree_deleteObj(void *ptrKdtree)
+{
+    delete((pckdtree::PointCloudKdtree<double> *)ptrKdtree);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void pointCloudKdtree_construct_single(void **ptr2ptrKdtree)
+{
+    pckdtree::PointCloudKdtree<float> *ptrKdtree_ = new pckdtree::PointCloudKdtree<float>();
+    *ptr2ptrKdtree = ptrKdtree_;
+}
+
+void pointCloudKdtree_index_single(void *ptrKdtree, const float * location,
+        int32_T numPoints)
+{
+    CG_PROFILE_CALL();
+    CG_PROFILE_PHASE(CG_PROFILE_COMPUTE);
+    pckdtree::PointCloudKdtree<float> *ptrKdtree_ = (pckdtree::PointCloudKdtree<float> *)ptrKdtree;
+    ptrKdtree_->index(location, (int)numPoints, false);
+}
+
+void pointCloudKdtree_index_singleRM(void *ptrKdtree, const float * location,
+        int32_T numPoints)
+{
+    CG_PROFILE_CALL();
+    CG_PROFILE_PHASE(CG_PROFILE_COMPUTE);
+    pckdtree::PointCloudKdtree<float> *ptrKdtree_ = (pckdtree::PointCloudKdtree<float> *)ptrKdtree;
+    ptrKdtree_->index(location, (int)numPoints, true);
+}
+
+void pointCloudKdtree_knnSearch_single(void *ptrKdtree, const float * points,
+        int32_T numQueries, int32_T K, int32_T maxLeafChecks,
+        uint32_T * indices, float * dists, uint32_T * valid)
+{
+    CG_PROFILE_CALL();
+    CG_PROFILE_PHASE(CG_PROFILE_COMPUTE);
+    pckdtree::PointCloudKdtree<float> *ptrKdtree_ = (pckdtree::PointCloudKdtree<float> *)ptrKdtree;
+    ptrKdtree_->knnSearch(points, (int)numQueries, (int)K, (int)maxLeafChecks,
+        false, indices, dists, valid);
+}
+
+void pointCloudKdtree_knnSearch_singleRM(void *ptrKdtree, const float * points,
+        int32_T numQueries, int32_T K, int32_T maxLeafChecks,
+        uint32_T * indices, float * dists, uint32_T * valid)
+{
+    CG_PROFILE_CALL();
+    CG_PROFILE_PHASE(CG_PROFILE_COMPUTE);
+    pckdtree::PointCloudKdtree<float> *ptrKdtree_ = (pckdtree::PointCloudKdtree<float> *)ptrKdtree;
+    ptrKdtree_->knnSearch(points, (int)numQueries, (int)K, (int)maxLeafChecks,
+        true, indices, dists, valid);
+}
+
+void pointCloudKdtree_radiusSearch_single(void *ptrKdtree, const float * points,
+        int32_T numQueries, float radius, int32_T maxLeafChecks,
+        boolean_T doSort, uint32_T * valid, void **ptr2ptrResult)
+{
+    CG_PROFILE_CALL();
+    CG_PROFILE_PHASE(CG_PROFILE_COMPUTE);
+    radiusSearch(ptrKdtree, points, numQueries, radius, maxLeafChecks, doSort,
+        false, valid, ptr2ptrResult);
+}
+
+void pointCloudKdtree_radiusSearch_singleRM(void *ptrKdtree, const float * points,
+        int32_T numQueries, float radius, int32_T maxLeafChecks,
+        boolean_T doSort, uint32_T * valid, void **ptr2ptrResult)
+{
+    CG_PROFILE_CALL();
+    CG_PROFILE_PHASE(CG_PROFILE_COMPUTE);
+    radiusSearch(ptrKdtree, points, numQueries, radius, maxLeafChecks, doSort,
+        true, valid, ptr2ptrResult);
+}
+
+void pointCloudKdtree_assignRadiusOutputDelete_single(void *ptrResult,
+        uint32_T * indices, float * dists)
+{
+    CG_PROFILE_CALL();
+    CG_PROFILE_PHASE(CG_PROFILE_OUTPUT);
+    assignRadiusOutputDelete(ptrResult, indices, dists);
+}
+
+void pointCloudKdtree_deleteObj_single(void *ptrKdtree)
+{
+    delete((pckdtree::PointCloudKdtree<float> *)ptrKdtree);
+}
+#endif
@@ -11,27 +11,21 @@
 #include "PointBuffers.hpp"
 #include "ImageBuffers.hpp"
 #include "PointTrackerOcv.hpp"
+#include "PointTrackerGroupOcv.hpp"
+#include "ImageHandle.hpp"
 
 #include "opencv2/opencv.hpp"
 #include "cgCommon.hpp"
+#include "cgProfile.hpp"
 
 using namespace cv;
 using namespace std;
 using namespace pointTracker;
 
 ///////////////////////////////////////////////////////////////////////////////
-void getPoints(void *ptrClass, float *pointData)
+void copyPoints(const std::vector<PointBuffers::Point> &cvPoints, int numPoints,
+    float *pointData)
 {
-    pointTracker::PointTrackerOcv *ptrClass_ = (pointTracker::PointTrackerOcv *)ptrClass;
-
-    mwSize pointDims[2];
-    int numPoints = ptrClass_->getNumPoints();
-    pointDims[0] = numPoints;
-    pointDims[1] = 2;
-
-    const std::vector<PointBuffers::Point> &cvPoints = 
-        ptrClass_->getPoints();
-
     for(int i = 0; i < numPoints; ++i)
     {
         // convert to 1-based MATLAB coordinates
@@ -40,18 +34,9 @@ void getPoints(void *ptrClass, float *pointData)
     }
 }
 
-void getPointsRM(void *ptrClass, float *pointData)
+void copyPointsRM(const std::vector<PointBuffers::Point> &cvPoints, int numPoints,
+    float *pointData)
 {
-	pointTracker::PointTrackerOcv *ptrClass_ = (pointTracker::PointTrackerOcv *)ptrClass;
-
-	mwSize pointDims[2];
-	int numPoints = ptrClass_->getNumPoints();
-	pointDims[0] = numPoints;
-	pointDims[1] = 2;
-
-	const std::vector<PointBuffers::Point> &cvPoints =
-		ptrClass_->getPoints();
-
 	int k = 0; 
 	for (int i = 0; i < numPoints; ++i)
 	{
@@ -61,19 +46,35 @@ void getPointsRM(void *ptrClass, float *pointData)
 	}
 }
 
-///////////////////////////////////////////////////////////////////////////////
-void getValidity(void *ptrClass, boolean_T *logicalData)
+void copyValidity(const std::vector<uchar> &status, int numPoints,
+    boolean_T *logicalData)
 {
-    pointTracker::PointTrackerOcv *ptrClass_ = (pointTracker::PointTrackerOcv *)ptrClass;
-    int numPoints = ptrClass_->getNumPoints();
-
-    const std::vector<uchar> &status = ptrClass_->getStatus();
     for(mwSize i = 0; i < (mwSize)numPoints; ++i)
     {
         logicalData[i] = (status[i] != 0);
     }
 }
 
+///////////////////////////////////////////////////////////////////////////////
+void getPoints(void *ptrClass, float *pointData)
+{
+    pointTracker::PointTrackerOcv *ptrClass_ = (pointTracker::PointTrackerOcv *)ptrClass;
+    copyPoints(ptrClass_->getPoints(), ptrClass_->getNumPoints(), pointData);
+}
+
+void getPointsRM(void *ptrClass, float *pointData)
+{
+	pointTracker::PointTrackerOcv *ptrClass_ = (pointTracker::PointTrackerOcv *)ptrClass;
+	copyPointsRM(ptrClass_->getPoints(), ptrClass_->getNumPoints(), pointData);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void getValidity(void *ptrClass, boolean_T *logicalData)
+{
+    pointTracker::PointTrackerOcv *ptrClass_ = (pointTracker::PointTrackerOcv *)ptrClass;
+    copyValidity(ptrClass_->getStatus(), ptrClass_->getNumPoints(), logicalData);
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 void getScores(void *ptrClass, double *errorsData)
 {
@@ -121,11 +122,18 @@ void pointTracker_construct(void **ptr2ptrClass)
     *ptr2ptrClass = ptrClass_;
 }
 
+void pointTracker_constructOnDevice(void **ptr2ptrClass, int32_T device)
+{
+    pointTracker::PointTrackerOcv *ptrClass_ = new PointTrackerOcv((int)device);
+    *ptr2ptrClass = ptrClass_;
+}
+
 void pointTracker_initialize(void *ptrClass, 
     uint8_T *inImg, const int nRows, const int nCols,
     const float *pointData, const int numPoints,
     cvstPTStruct_T *paramsIn)
 {
+    CG_PROFILE_CALL();
     pointTracker::PointTrackerOcv *ptrClass_ = (pointTracker::PointTrackerOcv *)ptrClass;
     pointTracker::PointTrackerParams params = PointTrackerParams_build(paramsIn);
 
@@ -134,6 +142,7 @@ void pointTracker_initialize(void *ptrClass,
     // https://code.ros.org/trac/opencv/ticket/1090
     // cv::transpose(img, img);
 
+    CG_PROFILE_PHASE(CG_PROFILE_COMPUTE);
     ptrClass_->initialize(params, img, numPoints, pointData);
 }
 
@@ -142,6 +151,7 @@ void pointTracker_initializeRM(void *ptrClass,
 	const float *pointData, const int numPoints,
 	cvstPTStruct_T *paramsIn)
 {
+	CG_PROFILE_CALL();
 	pointTracker::PointTrackerOcv *ptrClass_ = (pointTracker::PointTrackerOcv *)ptrClass;
 	pointTracker::PointTrackerParams params = PointTrackerParams_build(paramsIn);
 
@@ -150,9 +160,22 @@ void pointTracker_initializeRM(void *ptrClass,
 	// https://code.ros.org/trac/opencv/ticket/1090
 	// cv::transpose(img, img);
 
+	CG_PROFILE_PHASE(CG_PROFILE_COMPUTE);
 	ptrClass_->initializeRM(params, img, numPoints, pointData);
 }
 
+void pointTracker_initializeImage(void *ptrClass, void *ptrImage,
+    const float *pointData, const int numPoints,
+    cvstPTStruct_T *paramsIn)
+{
+    CG_PROFILE_CALL();
+    pointTracker::PointTrackerOcv *ptrClass_ = (pointTracker::PointTrackerOcv *)ptrClass;
+    pointTracker::PointTrackerParams params = PointTrackerParams_build(paramsIn);
+
+    CG_PROFILE_PHASE(CG_PROFILE_COMPUTE);
+    ptrClass_->initialize(params, *(vision::ImageHandle *)ptrImage, numPoints, pointData);
+}
+
 void pointTracker_setPoints(void *ptrClass, const float *pointData, int numPoints,
     boolean_T *validityData)
 {
@@ -168,16 +191,52 @@ void pointTracker_setPointsRM(void *ptrClass, const float *pointData, int numPoi
 	ptrClass_->setPointsRM(numPoints, pointData, validityData);
 }
 
+///////////////////////////////////////////////////////////////////////////////
+void pointTracker_reservePoints(void *ptrClass, int capacity)
+{
+    pointTracker::PointTrackerOcv *ptrClass_ = (pointTracker::PointTrackerOcv *)ptrClass;
+    ptrClass_->reservePoints(capacity);
+}
+
+void pointTracker_replacePoints(void *ptrClass, const int32_T *indices,
+    const float *pointData, int numPoints)
+{
+    pointTracker::PointTrackerOcv *ptrClass_ = (pointTracker::PointTrackerOcv *)ptrClass;
+    ptrClass_->replacePoints(numPoints, indices, pointData, false);
+}
+
+void pointTracker_replacePointsRM(void *ptrClass, const int32_T *indices,
+    const float *pointData, int numPoints)
+{
+    pointTracker::PointTrackerOcv *ptrClass_ = (pointTracker::PointTrackerOcv *)ptrClass;
+    ptrClass_->replacePoints(numPoints, indices, pointData, true);
+}
+
+void pointTracker_appendPoints(void *ptrClass, const float *pointData, int numPoints)
+{
+    pointTracker::PointTrackerOcv *ptrClass_ = (pointTracker::PointTrackerOcv *)ptrClass;
+    ptrClass_->appendPoints(numPoints, pointData, false);
+}
+
+void pointTracker_appendPointsRM(void *ptrClass, const float *pointData, int numPoints)
+{
+    pointTracker::PointTrackerOcv *ptrClass_ = (pointTracker::PointTrackerOcv *)ptrClass;
+    ptrClass_->appendPoints(numPoints, pointData, true);
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 void pointTracker_step(void *ptrClass, uint8_T *inImg, 
     int32_T nRows, int32_T nCols,
     float *outPoints, boolean_T *outValidity, double *outScores)
 {
+    CG_PROFILE_CALL();
     pointTracker::PointTrackerOcv *ptrClass_ = (pointTracker::PointTrackerOcv *)ptrClass;
     cv::Mat frame = cv::Mat(nRows, (int)nCols, CV_8UC1, inImg);
 
+    CG_PROFILE_PHASE(CG_PROFILE_COMPUTE);
     ptrClass_->step(frame);
 
+    CG_PROFILE_PHASE(CG_PROFILE_OUTPUT);
     getPoints(ptrClass, outPoints);
     getValidity(ptrClass, outValidity);
     getScores(ptrClass, outScores);
@@ -187,19 +246,83 @@ void pointTracker_stepRM(void *ptrClass, uint8_T *inImg,
 	int32_T nRows, int32_T nCols,
 	float *outPoints, boolean_T *outValidity, double *outScores)
 {
+	CG_PROFILE_CALL();
 	pointTracker::PointTrackerOcv *ptrClass_ = (pointTracker::PointTrackerOcv *)ptrClass;
 	cv::Mat frame = cv::Mat(nRows, (int)nCols, CV_8UC1, inImg);
 
+	CG_PROFILE_PHASE(CG_PROFILE_COMPUTE);
 	ptrClass_->step(frame);
 
+	CG_PROFILE_PHASE(CG_PROFILE_OUTPUT);
 	getPointsRM(ptrClass, outPoints);
 	getValidity(ptrClass, outValidity);
 	getScores(ptrClass, outScores);
 }
 
+void pointTracker_stepImage(void *ptrClass, void *ptrImage,
+    float *outPoints, boolean_T *outValidity, double *outScores)
+{
+    CG_PROFILE_CALL();
+    pointTracker::PointTrackerOcv *ptrClass_ = (pointTracker::PointTrackerOcv *)ptrClass;
+    vision::ImageHandle *ptrImage_ = (vision::ImageHandle *)ptrImage;
+
+    CG_PROFILE_PHASE(CG_PROFILE_COMPUTE);
+    ptrClass_->step(*ptrImage_);
+
+    CG_PROFILE_PHASE(CG_PROFILE_OUTPUT);
+    if (ptrImage_->isRowMajor())
+        getPointsRM(ptrClass, outPoints);
+    else
+        getPoints(ptrClass, outPoints);
+    getValidity(ptrClass, outValidity);
+    getScores(ptrClass, outScores);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void pointTracker_stepRecords(void *ptrClass, uint8_T *inImg,
+    int32_T nRows, int32_T nCols, float *outRecords)
+{
+    CG_PROFILE_CALL();
+    pointTracker::PointTrackerOcv *ptrClass_ = (pointTracker::PointTrackerOcv *)ptrClass;
+    cv::Mat frame = cv::Mat(nRows, (int)nCols, CV_8UC1, inImg);
+
+    CG_PROFILE_PHASE(CG_PROFILE_COMPUTE);
+    ptrClass_->step(frame);
+
+    CG_PROFILE_PHASE(CG_PROFILE_OUTPUT);
+    const int numPoints = ptrClass_->getNumPoints();
+    const std::vector<PointBuffers::Point> &cvPoints = ptrClass_->getPoints();
+    const std::vector<uchar> &status = ptrClass_->getStatus();
+    const std::vector<float> &cvErrors = ptrClass_->getErr();
+    for (int i = 0; i < numPoints; ++i)
+    {
+        // convert to 1-based MATLAB coordinates
+        float *record = outRecords + 4*i;
+        record[0] = cvPoints[i].x + 1;
+        record[1] = cvPoints[i].y + 1;
+        record[2] = (status[i] != 0) ? 1.0f : 0.0f;
+        record[3] = cvErrors[i];
+    }
+}
+
+void pointTracker_stepInto(void *ptrClass, uint8_T *inImg,
+    int32_T nRows, int32_T nCols,
+    float *outPoints, uint8_T *outValidity, float *outScores)
+{
+    CG_PROFILE_CALL();
+    pointTracker::PointTrackerOcv *ptrClass_ = (pointTracker::PointTrackerOcv *)ptrClass;
+    cv::Mat frame = cv::Mat(nRows, (int)nCols, CV_8UC1, inImg);
+
+    CG_PROFILE_PHASE(CG_PROFILE_COMPUTE);
+    ptrClass_->stepInto(frame, (PointBuffers::Point *)outPoints, outValidity,
+        outScores);
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 void pointTracker_getPreviousFrame(void *ptrClass, uint8_T *outFrame)
 {
+    CG_PROFILE_CALL();
+    CG_PROFILE_PHASE(CG_PROFILE_OUTPUT);
     pointTracker::PointTrackerOcv *ptrClass_ = (pointTracker::PointTrackerOcv *)ptrClass;
     cArrayFromMat<uint8_T>(outFrame, ptrClass_->getPreviousFrame());
 
@@ -207,6 +330,8 @@ void pointTracker_getPreviousFrame(void *ptrClass, uint8_T *outFrame)
 
 void pointTracker_getPreviousFrameRM(void *ptrClass, uint8_T *outFrame)
 {
+	CG_PROFILE_CALL();
+	CG_PROFILE_PHASE(CG_PROFILE_OUTPUT);
 	pointTracker::PointTrackerOcv *ptrClass_ = (pointTracker::PointTrackerOcv *)ptrClass;
 	cArrayFromMat_RowMaj<uint8_T>(outFrame, ptrClass_->getPreviousFrame());
 
@@ -215,12 +340,16 @@ void pointTracker_getPreviousFrameRM(void *ptrClass, uint8_T *outFrame)
 ///////////////////////////////////////////////////////////////////////////////
 void pointTracker_getPointsAndValidity(void *ptrClass, float *outPoints, boolean_T *outValidity)
 {
+    CG_PROFILE_CALL();
+    CG_PROFILE_PHASE(CG_PROFILE_OUTPUT);
     getPoints(ptrClass, outPoints);
     getValidity(ptrClass, outValidity);
 }
 
 void pointTracker_getPointsAndValidityRM(void *ptrClass, float *outPoints, boolean_T *outValidity)
 {
+	CG_PROFILE_CALL();
+	CG_PROFILE_PHASE(CG_PROFILE_OUTPUT);
 	getPointsRM(ptrClass, outPoints);
 	getValidity(ptrClass, outValidity);
 }
@@ -229,4 +358,114 @@ void pointTracker_getPointsAndValidityRM(void *ptrClass, float *outPoints, boole
 void pointTracker_deleteObj(void *ptrClass)
 {
     delete((pointTracker::PointTrackerOcv *)ptrClass);    
-}
\ No newline at end of file
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void pointTracker_estimateMemory(int32_T nRows, int32_T nCols, int32_T numPoints,
+    cvstPTStruct_T *params, double *peakBytes, double *steadyBytes)
+{
+    double peak, steady;
+    pointTracker::ImageBuffers::estimateMemory(cv::Size(nCols, nRows),
+        cv::Size(params->blockSize[0], params->blockSize[1]),
+        params->numPyramidLevels, peak, steady);
+
+    const double pointBytes = pointTracker::PointBuffers::estimateMemory(numPoints);
+    *peakBytes = peak + pointBytes;
+    *steadyBytes = steady + pointBytes;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// Tracking group
+//////////////////////////////////////////////////////////////////////////////
+void pointTrackerGroup_construct(void **ptr2ptrGroup)
+{
+    pointTracker::PointTrackerGroupOcv *ptrGroup_ = new PointTrackerGroupOcv();
+    *ptr2ptrGroup = ptrGroup_;
+}
+
+void pointTrackerGroup_initialize(void *ptrGroup,
+    uint8_T *inImg, const int nRows, const int nCols)
+{
+    pointTracker::PointTrackerGroupOcv *ptrGroup_ = (pointTracker::PointTrackerGroupOcv *)ptrGroup;
+    cv::Mat img = cv::Mat(nRows, (int)nCols, CV_8UC1, inImg);
+    ptrGroup_->initialize(img);
+}
+
+int32_T pointTrackerGroup_addPointSet(void *ptrGroup,
+    const float *pointData, const int numPoints, cvstPTStruct_T *paramsIn)
+{
+    pointTracker::PointTrackerGroupOcv *ptrGroup_ = (pointTracker::PointTrackerGroupOcv *)ptrGroup;
+    return (int32_T)ptrGroup_->addPointSet(PointTrackerParams_build(paramsIn),
+        numPoints, pointData, false);
+}
+
+int32_T pointTrackerGroup_addPointSetRM(void *ptrGroup,
+    const float *pointData, const int numPoints, cvstPTStruct_T *paramsIn)
+{
+    pointTracker::PointTrackerGroupOcv *ptrGroup_ = (pointTracker::PointTrackerGroupOcv *)ptrGroup;
+    return (int32_T)ptrGroup_->addPointSet(PointTrackerParams_build(paramsIn),
+        numPoints, pointData, true);
+}
+
+void pointTrackerGroup_setPoints(void *ptrGroup, int32_T setIdx,
+    const float *pointData, int numPoints, boolean_T *validityData)
+{
+    pointTracker::PointTrackerGroupOcv *ptrGroup_ = (pointTracker::PointTrackerGroupOcv *)ptrGroup;
+    ptrGroup_->setPoints(setIdx, numPoints, pointData, validityData, false);
+}
+
+void pointTrackerGroup_setPointsRM(void *ptrGroup, int32_T setIdx,
+    const float *pointData, int numPoints, boolean_T *validityData)
+{
+    pointTracker::PointTrackerGroupOcv *ptrGroup_ = (pointTracker::PointTrackerGroupOcv *)ptrGroup;
+    ptrGroup_->setPoints(setIdx, numPoints, pointData, validityData, true);
+}
+
+void pointTrackerGroup_step(void *ptrGroup, uint8_T *inImg,
+    int32_T nRows, int32_T nCols)
+{
+    CG_PROFILE_CALL();
+    pointTracker::PointTrackerGroupOcv *ptrGroup_ = (pointTracker::PointTrackerGroupOcv *)ptrGroup;
+    cv::Mat frame = cv::Mat(nRows, (int)nCols, CV_8UC1, inImg);
+    CG_PROFILE_PHASE(CG_PROFILE_COMPUTE);
+    ptrGroup_->step(frame);
+}
+
+int32_T pointTrackerGroup_getNumPoints(void *ptrGroup, int32_T setIdx)
+{
+    pointTracker::PointTrackerGroupOcv *ptrGroup_ = (pointTracker::PointTrackerGroupOcv *)ptrGroup;
+    return (int32_T)ptrGroup_->getNumPoints(setIdx);
+}
+
+void pointTrackerGroup_getPoints(void *ptrGroup, int32_T setIdx,
+    float *outPoints, boolean_T *outValidity, double *outScores)
+{
+    CG_PROFILE_CALL();
+    CG_PROFILE_PHASE(CG_PROFILE_OUTPUT);
+    pointTracker::PointTrackerGroupOcv *ptrGroup_ = (pointTracker::PointTrackerGroupOcv *)ptrGroup;
+    const int numPoints = ptrGroup_->getNumPoints(setIdx);
+    const std::vector<float> &cvErrors = ptrGroup_->getErr(setIdx);
+
+    copyPoints(ptrGroup_->getPoints(setIdx), numPoints, outPoints);
+    copyValidity(ptrGroup_->getStatus(setIdx), numPoints, outValidity);
+    std::copy(cvErrors.begin(), cvErrors.end(), outScores);
+}
+
+void pointTrackerGroup_getPointsRM(void *ptrGroup, int32_T setIdx,
+    float *outPoints, boolean_T *outValidity, double *outScores)
+{
+    CG_PROFILE_CALL();
+    CG_PROFILE_PHASE(CG_PROFILE_OUTPUT);
+    pointTracker::PointTrackerGroupOcv *ptrGroup_ = (pointTracker::PointTrackerGroupOcv *)ptrGroup;
+    const int numPoints = ptrGroup_->getNumPoints(setIdx);
+    const std::vector<float> &cvErrors = ptrGroup_->getErr(setIdx);
+
+    copyPointsRM(ptrGroup_->getPoints(setIdx), numPoints, outPoints);
+    copyValidity(ptrGroup_->getStatus(setIdx), numPoints, outValidity);
+    std::copy(cvErrors.begin(), cvErrors.end(), outScores);
+}
+
+void pointTrackerGroup_deleteObj(void *ptrGroup)
+{
+    delete((pointTracker::PointTrackerGroupOcv *)ptrGroup);
+}
@@ -0,0 +1,85 @@
+//////////////////////////////////////////////////////////////////////////////
+// Rectification, OpenCV stereo matching and reconstruction in one call
+//
+// Copyright 2016 The MathWorks, Inc.
+//  
+//////////////////////////////////////////////////////////////////////////////
+
+#ifndef COMPILE_FOR_VISION_BUILTINS
+#include "stereoPipelineCore_api.hpp"
+
+#include "opencv2/opencv.hpp"
+
+#include "StereoPipelineOcv.hpp"
+#include "cgProfile.hpp"
+
+using namespace disparity;
+
+void stereoPipeline_construct(void **ptr2ptrClass)
+{
+    StereoPipelineOcv *ptrClass_ = new StereoPipelineOcv();
+    *ptr2ptrClass = ptrClass_;
+}
+
+void stereoPipeline_setMaps(void *ptrClass,
+    const real32_T* xMap1, const real32_T* yMap1,
+    const real32_T* xMap2, const real32_T* yMap2,
+    int nRows, int nCols, int interp, uint8_T fillValue, const real64_T* Q)
+{
+    StereoPipelineOcv *ptrClass_ = (StereoPipelineOcv *)ptrClass;
+    ptrClass_->setMaps(xMap1, yMap1, xMap2, yMap2, nRows, nCols, interp,
+                       fillValue, Q, false);
+}
+
+void stereoPipeline_setMapsRM(void *ptrClass,
+    const real32_T* xMap1, const real32_T* yMap1,
+    const real32_T* xMap2, const real32_T* yMap2,
+    int nRows, int nCols, int interp, uint8_T fillValue, const real64_T* Q)
+{
+    StereoPipelineOcv *ptrClass_ = (StereoPipelineOcv *)ptrClass;
+    ptrClass_->setMaps(xMap1, yMap1, xMap2, yMap2, nRows, nCols, interp,
+                       fillValue, Q, true);
+}
+
+void stereoPipeline_stepBM(void *ptrClass, const uint8_T* inImg1, const uint8_T* inImg2,
+    int inRows, int inCols, real32_T* dis, real32_T* xyz, cvstDBMStruct_T *params)
+{
+    CG_PROFILE_CALL();
+    StereoPipelineOcv *ptrClass_ = (StereoPipelineOcv *)ptrClass;
+    ptrClass_->step(ptrClass_->bm(), inImg1, inImg2, inRows, inCols, dis, xyz,
+                    params, false);
+}
+
+void stereoPipeline_stepBMRM(void *ptrClass, const uint8_T* inImg1, const uint8_T* inImg2,
+    int inRows, int inCols, real32_T* dis, real32_T* xyz, cvstDBMStruct_T *params)
+{
+    CG_PROFILE_CALL();
+    StereoPipelineOcv *ptrClass_ = (StereoPipelineOcv *)ptrClass;
+    ptrClass_->step(ptrClass_->bm(), inImg1, inImg2, inRows, inCols, dis, xyz,
+                    params, true);
+}
+
+void stereoPipeline_stepSGBM(void *ptrClass, const uint8_T* inImg1, const uint8_T* inImg2,
+    int inRows, int inCols, real32_T* dis, real32_T* xyz, cvstDSGBMStruct_T *params)
+{
+    CG_PROFILE_CALL();
+    StereoPipelineOcv *ptrClass_ = (StereoPipelineOcv *)ptrClass;
+    ptrClass_->step(ptrClass_->sgbm(), inImg1, inImg2, inRows, inCols, dis, xyz,
+                    params, false);
+}
+
+void stereoPipeline_stepSGBMRM(void *ptrClass, const uint8_T* inImg1, const uint8_T* inImg2,
+    int inRows, int inCols, real32_T* dis, real32_T* xyz, cvstDSGBMStruct_T *params)
+{
+    CG_PROFILE_CALL();
+    StereoPipelineOcv *ptrClass_ = (StereoPipelineOcv *)ptrClass;
+    ptrClass_->step(ptrClass_->sgbm(), inImg1, inImg2, inRows, inCols, dis, xyz,
+                    params, true);
+}
+
+void stereoPipeline_deleteObj(void *ptrClass)
+{
+    delete ((StereoPipelineOcv *)ptrClass);
+}
+
+#endif
@@ -0,0 +1,135 @@
+///////////////////////////////////////////////////////////////////////////////
+// This file contains the shared library function calls used in codegen for
+// the 'gridAverage' method of pcdownsample and for pcmerge, see
+// VoxelGridFilter.hpp.
+///////////////////////////////////////////////////////////////////////////////
+#ifndef COMPILE_FOR_VISION_BUILTINS
+#include "voxelGridFilterCore_api.hpp"
+#include "VoxelGridFilter.hpp"
+#include "cgProfile.hpp"
+
+template <typename T>
+static int32_T filter(const T * location, const uint8_T * color,
+        const T * normal, int32_T numPoints, boolean_T hasColor,
+        boolean_T hasNormal, T gridStep, const T * rangeLimits, bool isRowMajor,
+        void **ptr2ptrResult)
+{
+    voxelgrid::VoxelGridResult<T> *ptrResult_ = new voxelgrid::VoxelGridResult<T>();
+    voxelgrid::VoxelGridFilter<T>::filter(location, hasColor ? color : NULL,
+        hasNormal ? normal : NULL, (int)numPoints, isRowMajor, gridStep,
+        rangeLimits, *ptrResult_);
+    *ptr2ptrResult = ptrResult_;
+    return (int32_T)ptrResult_->numPoints;
+}
+
+// Copies the row major numOut-by-3 src into dst, column major unless
+// isRowMajor
+template <typename T>
+static void copyOutput(const std::vector<T> &src, int numOut, bool isRowMajor, T * dst)
+{
+    if (src.empty())
+        return;
+    if (isRowMajor)
+    {
+        std::copy(src.begin(), src.end(), dst);
+        return;
+    }
+    for (int i = 0; i < numOut; i++)
+    {
+        for (int d = 0; d < 3; d++)
+            dst[i + (size_t)d * numOut] = src[3 * (size_t)i + d];
+    }
+}
+
+template <typename T>
+static void assignOutputDelete(void *ptrResult, T * location, uint8_T * color,
+        T * normal, bool isRowMajor)
+{
+    voxelgrid::VoxelGridResult<T> *ptrResult_ = (voxelgrid::VoxelGridResult<T> *)ptrResult;
+    const int numOut = ptrResult_->numPoints;
+    copyOutput(ptrResult_->location, numOut, isRowMajor, location);
+    copyOutput(ptrResult_->color, numOut, isRowMajor, color);
+    copyOutput(ptrResult_->normal, numOut, isRowMajor, normal);
+    delete ptrResult_;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+int32_T voxelGridFilter(const double * location, const uint8_T * color,
+        const double * normal, int32_T numPoints, boolean_T hasColor,
+        boolean_T hasNormal, double gridStep, const double * rangeLimits,
+        void **ptr2ptrResult)
+{
+    CG_PROFILE_CALL();
+    CG_PROFILE_PHASE(CG_PROFILE_COMPUTE);
+    return filter(location, color, normal, numPoints, hasColor, hasNormal,
+        gridStep, rangeLimits, false, ptr2ptrResult);
+}
+
+void voxelGridFilter_assignOutputDelete(void *ptrResult,
+        double * location, uint8_T * color, double * normal)
+{
+    CG_PROFILE_CALL();
+    CG_PROFILE_PHASE(CG_PROFILE_OUTPUT);
+    assignOutputDelete(ptrResult, location, color, normal, false);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+int32_T voxelGridFilterRM(const double * location, const uint8_T * color,
+        const double * normal, int32_T numPoints, boolean_T hasColor,
+        boolean_T hasNormal, double gridStep, const double * rangeLimits,
+        void **ptr2ptrResult)
+{
+    CG_PROFILE_CALL();
+    CG_PROFILE_PHASE(CG_PROFILE_COMPUTE);
+    return filter(location, color, normal, numPoints, hasColor, hasNormal,
+        gridStep, rangeLimits, true, ptr2ptrResult);
+}
+
+void voxelGridFilter_assignOutputDeleteRM(void *ptrResult,
+        double * location, uint8_T * color, double * normal)
+{
+    CG_PROFILE_CALL();
+    CG_PROFILE_PHASE(CG_PROFILE_OUTPUT);
+    assignOutputDelete(ptrResult, location, color, normal, true);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+int32_T voxelGridFilter_single(const float * location, const uint8_T * color,
+        const float * normal, int32_T numPoints, boolean_T hasColor,
+        boolean_T hasNormal, float gridStep, const float * rangeLimits,
+        void **ptr2ptrResult)
+{
+    CG_PROFILE_CALL();
+    CG_PROFILE_PHASE(CG_PROFILE_COMPUTE);
+    return filter(location, color, normal, numPoints, hasColor, hasNormal,
+        gridStep, rangeLimits, false, ptr2ptrResult);
+}
+
+void voxelGridFilter_assignOutputDelete_single(void *ptrResult,
+        float * location, uint8_T * color, float * normal)
+{
+    CG_PROFILE_CALL();
+    CG_PROFILE_PHASE(CG_PROFILE_OUTPUT);
+    assignOutputDelete(ptrResult, location, color, normal, false);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+int32_T voxelGridFilter_singleRM(const float * location, const uint8_T * color,
+        const float * normal, int32_T numPoints, boolean_T hasColor,
+        boolean_T hasNormal, float gridStep, const float * rangeLimits,
+        void **ptr2ptrResult)
+{
+    CG_PROFILE_CALL();
+    CG_PROFILE_PHASE(CG_PROFILE_COMPUTE);
+    return filter(location, color, normal, numPoints, hasColor, hasNormal,
+        gridStep, rangeLimits, true, ptr2ptrResult);
+}
+
+void voxelGridFilter_assignOutputDelete_singleRM(void *ptrResult,
+        float * location, uint8_T * color, float * normal)
+{
+    CG_PROFILE_CALL();
+    CG_PROFILE_PHASE(CG_PROFILE_OUTPUT);
+    assignOutputDelete(ptrResult, location, color, normal, true);
+}
+#endif
@@ -8,14 +8,217 @@
 
 // module includes
 #ifdef __arm__
+#include "vision_defines.h"
+#include "foregroundDetector_published_c_api.hpp"
 #include "ForegroundDetectorImpl.hpp"
 #else
+#include <foregroundDetector/vision_defines.h>
+#include <foregroundDetector/foregroundDetector_published_c_api.hpp>
 #include <foregroundDetector/ForegroundDetectorImpl.hpp>
+// task arenas bound to a NUMA node need oneTBB
+#if TBB_INTERFACE_VERSION >= 12010
+#include <tbb/info.h>
+#define FOREGROUND_DETECTOR_HAVE_NODE_ARENAS
 #endif
+#endif
+
+#include <mutex>
+
+namespace
+{
+    std::mutex numaMutex;
+    int32_T numaPolicy = FOREGROUND_DETECTOR_NUMA_FIRST_TOUCH;
+#ifdef FOREGROUND_DETECTOR_HAVE_NODE_ARENAS
+    // one arena per NUMA node, created on first use and never destroyed,
+    // so that detectors released at exit do not outlive their arena
+    std::vector<tbb::task_arena *> nodeArenas;
+    size_t nextNodeArena = 0;
+#endif
+}
 
 namespace vision
 {
+
+    ///////////////////////////////////////////////////////////////////////
+    //
+    // NUMA placement policy
+    //
+    ///////////////////////////////////////////////////////////////////////
+    void setForegroundDetectorNumaPolicy(int32_T policy)
+    {
+        std::lock_guard<std::mutex> lock(numaMutex);
+        numaPolicy = policy;
+    }
+
+    int32_T getForegroundDetectorNumaPolicy()
+    {
+        std::lock_guard<std::mutex> lock(numaMutex);
+        return numaPolicy;
+    }
+
+#ifndef __arm__
+    ///////////////////////////////////////////////////////////////////////
+    //
+    // acquireNodeArena: arena of the next NUMA node in turn with the
+    // FOREGROUND_DETECTOR_NUMA_NODE_ARENAS policy, NULL otherwise or when
+    // the nodes are not known.
+    //
+    ///////////////////////////////////////////////////////////////////////
+    static tbb::task_arena * acquireNodeArena()
+    {
+        std::lock_guard<std::mutex> lock(numaMutex);
+        if (numaPolicy != FOREGROUND_DETECTOR_NUMA_NODE_ARENAS)
+            return NULL;
+
+#ifdef FOREGROUND_DETECTOR_HAVE_NODE_ARENAS
+        if (nodeArenas.empty())
+        {
+            // a single node, or an unknown topology (-1), gains nothing
+            std::vector<tbb::numa_node_id> nodes = tbb::info::numa_nodes();
+            if (nodes.size() < 2)
+                return NULL;
+            for (size_t n = 0; n < nodes.size(); ++n)
+                nodeArenas.push_back(new tbb::task_arena(
+                    tbb::task_arena::constraints(nodes[n])));
+        }
+        return nodeArenas[nextNodeArena++ % nodeArenas.size()];
+#else
+        return NULL;
+#endif
+    }
+
+    ///////////////////////////////////////////////////////////////////////
+    //
+    // ForegroundDetectorClearBody: loop body clearing the states of a range
+    // of tiles, so that their pages are first touched by the thread that
+    // the affinity partitioner gives the tiles to.
+    //
+    ///////////////////////////////////////////////////////////////////////
+    template <typename stat_type>
+    struct ForegroundDetectorClearBody
+    {
+        ForegroundDetectorClearBody(GaussianMixtureStore<stat_type> * store,
+                                    mwSize tileSize)
+            : mStore(store), mTileSize(tileSize)
+        {
+        }
+
+        void operator()(const tbb::blocked_range<mwSize> & range) const
+        {
+            const mwSize numPixels = mStore->getNumPixels();
+            mStore->clear(std::min(range.begin() * mTileSize, numPixels),
+                          std::min(range.end() * mTileSize, numPixels));
+        }
+
+        GaussianMixtureStore<stat_type> * mStore;
+        mwSize mTileSize;
+    };
+
+    ///////////////////////////////////////////////////////////////////////
+    //
+    // ForegroundDetectorTileLoop: parallel loop over numTiles tiles, as a
+    // functor that a task arena can execute.
+    //
+    ///////////////////////////////////////////////////////////////////////
+    template <typename Body>
+    struct ForegroundDetectorTileLoop
+    {
+        ForegroundDetectorTileLoop(mwSize numTiles, const Body & body,
+                                   tbb::affinity_partitioner & partitioner)
+            : mNumTiles(numTiles), mBody(body), mPartitioner(&partitioner)
+        {
+        }
+
+        void operator()() const
+        {
+            tbb::blocked_range<mwSize> range(0, mNumTiles, 1);
+            tbb::parallel_for(range, mBody, *mPartitioner);
+        }
+
+        mwSize mNumTiles;
+        const Body & mBody;
+        tbb::affinity_partitioner * mPartitioner;
+    };
+#endif
+
+    ///////////////////////////////////////////////////////////////////////
+    //
+    // ForegroundDetectorBatchBody: loop body over the tiles of a batch of
+    // detectors. Tiles [tileOffsets[s], tileOffsets[s+1]) belong to the
+    // functor of stream s.
+    //
+    ///////////////////////////////////////////////////////////////////////
+    template <typename image_type, typename stat_type>
+    struct ForegroundDetectorBatchBody
+    {
+        typedef typename ForegroundDetectorImpl<image_type, stat_type>::Functor Functor;
+
+        ForegroundDetectorBatchBody(const Functor * const * ftors,
+                                    const mwSize * tileOffsets,
+                                    mwSize numStreams)
+            : mFtors(ftors), mTileOffsets(tileOffsets), mNumStreams(numStreams)
+        {
+        }
+
+        void run(mwSize begin, mwSize end) const
+        {
+            // last stream whose first tile is not after begin
+            mwSize s = static_cast<mwSize>(
+                std::upper_bound(mTileOffsets, mTileOffsets + mNumStreams + 1, begin)
+                - mTileOffsets) - 1;
+
+            for ( ; begin < end; ++s)
+            {
+                const mwSize stop = std::min(end, mTileOffsets[s+1]);
+                if (stop > begin)
+                {
+#ifdef __arm__
+                    (*mFtors[s])(begin - mTileOffsets[s], stop - mTileOffsets[s]);
+#else
+                    (*mFtors[s])(tbb::blocked_range<mwSize>(begin - mTileOffsets[s],
+                                                            stop - mTileOffsets[s]));
+#endif
+                    begin = stop;
+                }
+            }
+        }
+
+#ifndef __arm__
+        void operator()(const tbb::blocked_range<mwSize> & range) const
+        {
+            run(range.begin(), range.end());
+        }
+#endif
+
+        const Functor * const * mFtors;
+        const mwSize * mTileOffsets;
+        mwSize mNumStreams;
+    };
     
+    ///////////////////////////////////////////////////////////////////////
+    //
+    // ForegroundDetectorAsyncBody: task running the pending asynchronous
+    // step of a detector.
+    //
+    ///////////////////////////////////////////////////////////////////////
+    template <typename image_type, typename stat_type>
+    struct ForegroundDetectorAsyncBody
+    {
+        explicit ForegroundDetectorAsyncBody(ForegroundDetectorImpl<image_type, stat_type> * detector)
+            : mDetector(detector)
+        {
+        }
+
+        void operator()() const
+        {
+            mDetector->runStep(mDetector->mAsyncImage.empty() ? NULL : &mDetector->mAsyncImage[0],
+                               mDetector->mAsyncLearningRate,
+                               mDetector->mIsAsyncRowMajor);
+        }
+
+        ForegroundDetectorImpl<image_type, stat_type> * mDetector;
+    };
+
     ///////////////////////////////////////////////////////////////////////
     //
     // Constructor 
@@ -24,8 +227,38 @@ namespace vision
     template <typename image_type, typename stat_type>
     ForegroundDetectorImpl<image_type,stat_type>::ForegroundDetectorImpl()
     {                       
-        mFtor = ForegroundDetectorFunctor<image_type, stat_type>();            
+        mFtor = Functor();            
+        mUseModelMap = false;
+        mImageRows   = 0;
+        mImageCols   = 0;
+        mFgMask      = NULL;
+        mPackedMask  = NULL;
+        mAsyncIndex  = 0;
+        mIsAsyncPending    = false;
+        mAsyncLearningRate = 0;
+        mIsAsyncRowMajor   = false;
+#ifndef __arm__
+        mArena = NULL;
+#endif
     }
+
+#ifndef __arm__
+    ///////////////////////////////////////////////////////////////////////
+    //
+    // runTiles: runs body over the tiles of the functor
+    //
+    ///////////////////////////////////////////////////////////////////////
+    template <typename image_type, typename stat_type>
+    template <typename Body>
+    void ForegroundDetectorImpl<image_type,stat_type>::runTiles(const Body & body)
+    {
+        ForegroundDetectorTileLoop<Body> loop(mFtor.getNumTiles(), body, mPartitioner);
+        if (mArena != NULL)
+            mArena->execute(loop);
+        else
+            loop();
+    }
+#endif
 		
     ///////////////////////////////////////////////////////////////////////
     //
@@ -35,31 +268,121 @@ namespace vision
     template <typename image_type, typename stat_type>
     void ForegroundDetectorImpl<image_type,stat_type>::initializeImpl(Dims dims,
                                                                       mwSize numGaussians, 
-                                                                      stat_type initialVariance,
-                                                                      stat_type initialWeight, 
-                                                                      stat_type varianceThreshold,
-                                                                      stat_type minBGRatio)
+                                                                      param_type initialVariance,
+                                                                      param_type initialWeight, 
+                                                                      param_type varianceThreshold,
+                                                                      param_type minBGRatio)
     {
-            
+        initializeImpl(dims, numGaussians, initialVariance, initialWeight,
+                       varianceThreshold, minBGRatio, NULL, false, 1);
+    }
+
+    ///////////////////////////////////////////////////////////////////////
+    //
+    // initializeImpl with a region of interest and a downsample factor
+    // 
+    /////////////////////////////////////////////////////////////////////// 
+    template <typename image_type, typename stat_type>
+    void ForegroundDetectorImpl<image_type,stat_type>::initializeImpl(Dims dims,
+                                                                      mwSize numGaussians, 
+                                                                      param_type initialVariance,
+                                                                      param_type initialWeight, 
+                                                                      param_type varianceThreshold,
+                                                                      param_type minBGRatio,
+                                                                      const boolean_T * roiMask,
+                                                                      bool isRoiRowMajor,
+                                                                      mwSize downsampleFactor)
+    {
+        waitAsyncImpl();
+
+        VISION_ASSERT(dims.size() >= 2);
+        mImageRows = dims[0];
+        mImageCols = dims[1];
+        const mwSize numChannels = dims.size() > 2 ? dims[2] : 1;
+
+        releaseModelMap();
+        mUseModelMap = roiMask != NULL || downsampleFactor > 1;
+
+        Dims modelDims(dims);
+        if (mUseModelMap)
+        {
+            const mwSize factor = std::max(downsampleFactor, static_cast<mwSize>(1));
+            mOutputMap.assign(mImageRows * mImageCols, -1);
+
+            // model one pixel of each cell that overlaps the ROI, the first
+            // ROI pixel of the cell in column major order, in column major
+            // order of the cells. It decides the ROI pixels of its cell.
+            for (mwSize c = 0; c < mImageCols; c += factor)
+            {
+                for (mwSize r = 0; r < mImageRows; r += factor)
+                {
+                    const mwSize lastCol = std::min(c + factor, mImageCols);
+                    const mwSize lastRow = std::min(r + factor, mImageRows);
+                    int32_T modelID = -1;
+                    for (mwSize cc = c; cc < lastCol; ++cc)
+                    {
+                        for (mwSize rr = r; rr < lastRow; ++rr)
+                        {
+                            const mwSize cellIdx = rr + cc*mImageRows;
+                            const mwSize cellIdxRM = rr*mImageCols + cc;
+                            if (roiMask != NULL &&
+                                !roiMask[isRoiRowMajor ? cellIdxRM : cellIdx])
+                                continue;
+
+                            if (modelID < 0)
+                            {
+                                modelID = static_cast<int32_T>(mColMajorOffsets.size());
+                                mColMajorOffsets.push_back(cellIdx);
+                                mRowMajorOffsets.push_back(cellIdxRM * numChannels);
+                            }
+                            mOutputMap[cellIdx] = modelID;
+                        }
+                    }
+                }
+            }
+
+            // the functor runs on a column of modeled pixels
+            const mwSize numModelPixels = mColMajorOffsets.size();
+            modelDims.resize(2);
+            modelDims[0] = numModelPixels;
+            modelDims[1] = 1;
+            if (numChannels > 1)
+                modelDims.push_back(numChannels);
+
+            mModelImage.resize(numModelPixels * numChannels);
+            mModelMask.resize(numModelPixels);
+        }
+
         // setup functor dims and properties            
-        mFtor.setup(dims);
+        mFtor.setup(modelDims);
         mFtor.setProperties(numGaussians, initialVariance, initialWeight,
                             varianceThreshold, minBGRatio);
     
         // pre-allocate during setup to avoid dynamic allocation
-        // while processing           
-        mGMMVec = GMMVector(mFtor.getNumPixels(), 
-                            std::pair<GaussianMixtureModel, mwSize>());
-
-        // initialize pixel index and reserve numGaussians for GMM
-        for (mwSize i = 0; i < mFtor.getNumPixels(); ++i)
+        // while processing
+#ifdef __arm__
+        mStore.allocate(mFtor.getNumPixels(), mFtor.getNumChannels(),
+                        numGaussians);
+#else
+        const int32_T policy = getForegroundDetectorNumaPolicy();
+        mArena = acquireNodeArena();
+        if (policy == FOREGROUND_DETECTOR_NUMA_NONE)
         {
-            mGMMVec[i].first.reserve(numGaussians);
-            mGMMVec[i].second = i;
+            mStore.allocate(mFtor.getNumPixels(), mFtor.getNumChannels(),
+                            numGaussians);
         }
-            
-        // set pointer to GMMVec model for the implementation 
-        mFtor.setGMMVec(&mGMMVec);
+        else
+        {
+            // the tiles are cleared by the loop the steps run, so each one
+            // is first touched on the node of the thread that updates it
+            mStore.allocateUninitialized(mFtor.getNumPixels(), mFtor.getNumChannels(),
+                                         numGaussians);
+            runTiles(ForegroundDetectorClearBody<stat_type>(&mStore, mFtor.getTileSize()));
+        }
+#endif
+
+        // set pointer to the model store for the implementation
+        mFtor.setStore(&mStore);
             
     }       
 
@@ -72,9 +395,31 @@ namespace vision
     template <typename image_type, typename stat_type>
     void ForegroundDetectorImpl<image_type,stat_type>::setOutputBuffer(boolean_T * fgMask)
     { 	
+        waitAsyncImpl();
+
         // setup buffer for the output mask
+        mFgMask = fgMask;
+        mPackedMask = NULL;
         mFtor.setStepOutput(fgMask);				
     }
+
+    ////////////////////////////////////////////////////////////////////////
+    //
+    // setPackedOutputBuffer 
+    //     - sets up a bit-packed output buffer for step. The algorithm
+    //       writes an internal mask which is packed at the end of the step.
+    //
+    ////////////////////////////////////////////////////////////////////////  
+    template <typename image_type, typename stat_type>
+    void ForegroundDetectorImpl<image_type,stat_type>::setPackedOutputBuffer(uint32_T * packedMask)
+    {
+        waitAsyncImpl();
+
+        mUnpackedMask.resize(mImageRows * mImageCols);
+        mFgMask = mUnpackedMask.empty() ? NULL : &mUnpackedMask[0];
+        mPackedMask = packedMask;
+        mFtor.setStepOutput(mFgMask);
+    }
 		
     ////////////////////////////////////////////////////////////////////////
     //
@@ -85,18 +430,10 @@ namespace vision
     ////////////////////////////////////////////////////////////////////////  
     template <typename image_type, typename stat_type>
     void ForegroundDetectorImpl<image_type,stat_type>::stepImpl(const image_type * image, 
-                                                                      stat_type    learningRate)
+                                                                      param_type    learningRate)
     {
-        mFtor.setStepInput(image,learningRate);
-		
-#ifdef __arm__
-        mFtor(0,mFtor.getNumPixels());
-#else
-        tbb::blocked_range<mwSize> range(0,mFtor.getNumPixels(),1);
-        tbb::auto_partitioner ap;
-        tbb::parallel_for(range, mFtor, ap );
-#endif
-            
+        waitAsyncImpl();
+        runStep(image,learningRate,false);
     }
 
     ////////////////////////////////////////////////////////////////////////
@@ -108,92 +445,284 @@ namespace vision
     ////////////////////////////////////////////////////////////////////////  
     template <typename image_type, typename stat_type>
     void ForegroundDetectorImpl<image_type,stat_type>::stepImplRowMajor(const image_type * image, 
-                                                                      stat_type    learningRate)
+                                                                      param_type    learningRate)
     {
-        mFtor.setStepInput(image,learningRate);
+        waitAsyncImpl();
+        runStep(image,learningRate,true);
+    }
+
+    ////////////////////////////////////////////////////////////////////////
+    //
+    //  runStep - invokes the algorithm functor on multiple cores using TBB
+    //
+    ////////////////////////////////////////////////////////////////////////
+    template <typename image_type, typename stat_type>
+    void ForegroundDetectorImpl<image_type,stat_type>::runStep(const image_type * image,
+                                                               param_type learningRate,
+                                                               bool isRowMajor)
+    {
+        beginStep(image,learningRate,isRowMajor);
 		
 #ifdef __arm__
-        mFtor(static_cast<unsigned long>(0),static_cast<unsigned long>(mFtor.getNumPixels()));
+        mFtor(0,mFtor.getNumTiles());
 #else
-        //typename GMMVector::range_type range = mGMMVec.range(1);
-        tbb::blocked_range<unsigned int> range(0,mFtor.getNumPixels(),1);
-        tbb::auto_partitioner ap;
-        tbb::parallel_for(range, mFtor, ap );
+        runTiles(mFtor);
 #endif
-            
+
+        endStep(isRowMajor);
+
+        if (mPackedMask != NULL)
+            packMask(isRowMajor);
     }
-    
+
     ////////////////////////////////////////////////////////////////////////
     //
-    //  getStates implementation 
-    //     - Implemenation of getStates
-    //       
+    //  Asynchronous step implementation
     //
-    ////////////////////////////////////////////////////////////////////////  	
+    ////////////////////////////////////////////////////////////////////////
     template <typename image_type, typename stat_type>
-    void ForegroundDetectorImpl<image_type,stat_type>::getStatesImpl(stat_type* weights, 
-                                                                     stat_type* means,
-                                                                     stat_type* variances, 
-                                                                     int *      numActive)
+    const boolean_T * ForegroundDetectorImpl<image_type,stat_type>::stepAsyncImpl(const image_type * image,
+                                                                                  param_type learningRate,
+                                                                                  bool isRowMajor)
     {
-        typename GMMVector::iterator currentIter,endIter;
-        currentIter = mGMMVec.begin();
-        endIter     = mGMMVec.end();              
-            
-        // loop over all pixels model
-        for ( ;currentIter != endIter; ++currentIter)
+        const boolean_T * previousMask = waitAsyncImpl();
+
+        // the frame is copied so that the caller can reuse its buffer
+        const mwSize numPixels = mImageRows * mImageCols;
+        mAsyncImage.assign(image, image + numPixels * mFtor.getNumChannels());
+
+        mAsyncIndex = 1 - mAsyncIndex;
+        mAsyncMasks[mAsyncIndex].resize(numPixels);
+        mFgMask = numPixels > 0 ? &mAsyncMasks[mAsyncIndex][0] : NULL;
+        mPackedMask = NULL;
+        mFtor.setStepOutput(mFgMask);
+
+        mAsyncLearningRate = learningRate;
+        mIsAsyncRowMajor   = isRowMajor;
+        mIsAsyncPending    = true;
+
+        ForegroundDetectorAsyncBody<image_type, stat_type> body(this);
+#ifdef __arm__
+        body();
+#else
+        mAsyncTasks.run(body);
+#endif
+        return previousMask;
+    }
+
+    template <typename image_type, typename stat_type>
+    const boolean_T * ForegroundDetectorImpl<image_type,stat_type>::waitAsyncImpl()
+    {
+        if (!mIsAsyncPending)
+            return NULL;
+
+#ifndef __arm__
+        mAsyncTasks.wait();
+#endif
+        mIsAsyncPending = false;
+        return mFgMask;
+    }
+
+    ////////////////////////////////////////////////////////////////////////
+    //
+    //  Batch step implementation
+    //     - steps numStreams detectors in a single parallel loop over the
+    //       tiles of all detectors.
+    //
+    ////////////////////////////////////////////////////////////////////////
+    template <typename image_type, typename stat_type>
+    void ForegroundDetectorImpl<image_type,stat_type>::stepBatchImpl(ForegroundDetectorImpl ** detectors,
+                                                                     mwSize numStreams,
+                                                                     const image_type ** images,
+                                                                     boolean_T ** fgMasks,
+                                                                     const param_type * learningRates,
+                                                                     bool isRowMajor)
+    {
+        std::vector<const Functor *> ftors(numStreams);
+        std::vector<mwSize> tileOffsets(numStreams + 1, 0);
+        for (mwSize s = 0; s < numStreams; ++s)
         {
-            getGMMStates(currentIter->first, weights++, means++, variances++, numActive++);
+            detectors[s]->setOutputBuffer(fgMasks[s]);  // waits for async steps
+            detectors[s]->beginStep(images[s], learningRates[s], isRowMajor);
+
+            Functor & ftor = detectors[s]->mFtor;
+            ftors[s] = &ftor;
+            tileOffsets[s+1] = tileOffsets[s] + ftor.getNumTiles();
+        }
+
+        if (numStreams == 0)
+            return;
+
+        ForegroundDetectorBatchBody<image_type, stat_type> body(&ftors[0], &tileOffsets[0],
+                                                                 numStreams);
+#ifdef __arm__
+        body.run(0, tileOffsets[numStreams]);
+#else
+        tbb::blocked_range<mwSize> range(0, tileOffsets[numStreams], 1);
+        tbb::auto_partitioner ap;
+        tbb::parallel_for(range, body, ap);
+#endif
+
+        for (mwSize s = 0; s < numStreams; ++s)
+        {
+            detectors[s]->endStep(isRowMajor);
         }
     }
-	
-    ///////////////////////////////////////////////////////////////////////
+
+    ////////////////////////////////////////////////////////////////////////
     //
-    // getGMMStates: Extracts the state information from a specific gaussian  
-    // mixture model.
-    // 
-    ///////////////////////////////////////////////////////////////////////  
-    template <typename image_type, typename stat_type>		
-    void ForegroundDetectorImpl<image_type,stat_type>::getGMMStates(GaussianMixtureModel & gmm, 
-                                                                    stat_type * weights, 
-                                                                    stat_type * means,
-                                                                    stat_type * variances,
-                                                                    int *       numActive)
+    //  beginStep - gathers the modeled pixels when a model map is used and
+    //              sets the functor input and output.
+    //
+    ////////////////////////////////////////////////////////////////////////
+    template <typename image_type, typename stat_type>
+    void ForegroundDetectorImpl<image_type,stat_type>::beginStep(const image_type * image,
+                                                                 param_type learningRate,
+                                                                 bool isRowMajor)
     {
+        if (!mUseModelMap)
+        {
+            mFtor.setStepInput(image, learningRate, isRowMajor);
+            return;
+        }
 
-        // This is expected to be called only after initialize!!!
+        const mwSize numModelPixels = mColMajorOffsets.size();
+        const mwSize numChannels    = mFtor.getNumChannels();
+        const mwSize numPixels      = mImageRows * mImageCols;
+        image_type * modelImage     = mModelImage.empty() ? NULL : &mModelImage[0];
 
-        // Copy model information into weights, means, variances and numActive
-            
-        *numActive = static_cast<int>(gmm.size());
-            
-        // Copy weights
-            
-        mwSize weight_offset = 0;
-        mwSize stat_offset   = 0;
+        // compact column major image of the modeled pixels
+        for (mwSize ch = 0; ch < numChannels; ++ch)
+        {
+            image_type * dst = modelImage + ch*numModelPixels;
+            if (isRowMajor)
+            {
+                const image_type * src = image + ch;
+                for (mwSize i = 0; i < numModelPixels; ++i)
+                    dst[i] = src[mRowMajorOffsets[i]];
+            }
+            else
+            {
+                const image_type * src = image + ch*numPixels;
+                for (mwSize i = 0; i < numModelPixels; ++i)
+                    dst[i] = src[mColMajorOffsets[i]];
+            }
+        }
 
-        GaussianIterator currentGaussian,endGaussian;     
+        mFtor.setStepInput(modelImage, learningRate, false);
+        mFtor.setStepOutput(mModelMask.empty() ? NULL : &mModelMask[0]);
+    }
 
-        currentGaussian = gmm.begin();
-        endGaussian     = gmm.end();
-            
-        mwSize numPixels   = mFtor.getNumPixels();
-        mwSize numChannels = mFtor.getNumChannels();
-        mwSize statOffset  = numPixels * numChannels;
-        for ( ; currentGaussian != endGaussian; 
-              ++currentGaussian, weight_offset += numPixels)
+    ////////////////////////////////////////////////////////////////////////
+    //
+    //  endStep - expands the mask of the modeled pixels to the image size
+    //            when a model map is used.
+    //
+    ////////////////////////////////////////////////////////////////////////
+    template <typename image_type, typename stat_type>
+    void ForegroundDetectorImpl<image_type,stat_type>::endStep(bool isRowMajor)
+    {
+        if (!mUseModelMap)
+            return;
+
+        for (mwSize c = 0; c < mImageCols; ++c)
         {
-            weights[weight_offset] = currentGaussian->getWeight();
+            for (mwSize r = 0; r < mImageRows; ++r)
+            {
+                const int32_T modelID = mOutputMap[r + c*mImageRows];
+                const boolean_T isForeground = modelID >= 0 && mModelMask[modelID];
+                mFgMask[isRowMajor ? r*mImageCols + c : r + c*mImageRows] = isForeground;
+            }
+        }
+    }
+
+    ////////////////////////////////////////////////////////////////////////
+    //
+    //  packMask - packs the rows of the mask of the last step in 32-bit words
+    //
+    ////////////////////////////////////////////////////////////////////////
+    template <typename image_type, typename stat_type>
+    void ForegroundDetectorImpl<image_type,stat_type>::packMask(bool isRowMajor)
+    {
+        const mwSize wordsPerRow = getPackedWordsPerRow(mImageCols);
 
-            currentGaussian->copyMeanInto(means, numPixels);
-            currentGaussian->copyVarianceInto(variances, numPixels);
+        // distance between two pixels of a row in the unpacked mask
+        const mwSize colStride = isRowMajor ? 1 : mImageRows;
+        const mwSize rowStride = isRowMajor ? mImageCols : 1;
 
-            // increment to for next gaussian
-            means     += statOffset;
-            variances += statOffset;
+        for (mwSize r = 0; r < mImageRows; ++r)
+        {
+            const boolean_T * row = mFgMask + r*rowStride;
+            uint32_T * packedRow  = mPackedMask + r*wordsPerRow;
+            for (mwSize w = 0; w < wordsPerRow; ++w)
+            {
+                const mwSize c0 = w*32;
+                const mwSize numBits = std::min(mImageCols - c0, static_cast<mwSize>(32));
+
+                uint32_T word = 0;
+                for (mwSize b = 0; b < numBits; ++b)
+                {
+                    word |= static_cast<uint32_T>(row[(c0 + b)*colStride] != 0) << b;
+                }
+                packedRow[w] = word;
+            }
         }
     }
-		
+
+    ////////////////////////////////////////////////////////////////////////
+    //
+    //  releaseModelMap - frees the model map
+    //
+    ////////////////////////////////////////////////////////////////////////
+    template <typename image_type, typename stat_type>
+    void ForegroundDetectorImpl<image_type,stat_type>::releaseModelMap()
+    {
+        std::vector<mwSize>().swap(mColMajorOffsets);
+        std::vector<mwSize>().swap(mRowMajorOffsets);
+        std::vector<int32_T>().swap(mOutputMap);
+        std::vector<image_type>().swap(mModelImage);
+        std::vector<boolean_T>().swap(mModelMask);
+    }
+
+    ////////////////////////////////////////////////////////////////////////
+    //
+    //  setGrainSizeImpl
+    //     - sets the number of pixels processed by a task.
+    //
+    ////////////////////////////////////////////////////////////////////////
+    template <typename image_type, typename stat_type>
+    void ForegroundDetectorImpl<image_type,stat_type>::setGrainSizeImpl(mwSize grainSize)
+    {
+        waitAsyncImpl();
+
+        if (grainSize == 0)
+            grainSize = FOREGROUND_DETECTOR_DEFAULT_GRAIN_SIZE;
+
+        mFtor.setTileSize(grainSize);
+    }
+    
+    ////////////////////////////////////////////////////////////////////////
+    //
+    //  getStates implementation 
+    //     - Implemenation of getStates
+    //       
+    //
+    ////////////////////////////////////////////////////////////////////////  	
+    template <typename image_type, typename stat_type>
+    void ForegroundDetectorImpl<image_type,stat_type>::getStatesImpl(stat_type* weights, 
+                                                                     stat_type* means,
+                                                                     stat_type* variances, 
+                                                                     int *      numActive)
+    {
+        // This is expected to be called only after initialize!!!
+        waitAsyncImpl();
+
+        // weights is pointer to [M N numGaussian] matrix, means and variances
+        // are pointers to [M N numChannels numGaussians] matrices, which is
+        // the layout of the model store
+        mStore.copyTo(weights, means, variances, numActive);
+    }
+	
     ///////////////////////////////////////////////////////////////////////       
     // 
     // setStatesImpl: 
@@ -206,59 +735,68 @@ namespace vision
                                                                      stat_type* variances,
                                                                      int *      numActive)
     {
-        // We need to copy the saved state information from 
-        // mxArrays into the model format used in the implementation.
-        typename GMMVector::iterator currentIter,endIter;
-        currentIter = mGMMVec.begin();
-        endIter     = mGMMVec.end();              
-            
-        // loop over all pixels in image
-        for (int i = 0 ; currentIter != endIter; ++currentIter, ++i)
-        {
-            setGMMStates(currentIter->first, numActive[i], 
-                         weights++, means++, variances++);           
-        }
+        // setStates is used during de-serialization and only should
+        // be called if the system object was saved in an locked state
+        waitAsyncImpl();
+        mStore.copyFrom(weights, means, variances, numActive);
     }
-		
-    ///////////////////////////////////////////////////////////////////////       
-    // 
-    // setGMMStates: used to set internal detector states for a specific 
-    // gaussian mixture model. Used for save/load/clone.
+	
+    ////////////////////////////////////////////////////////////////////////
     //
-    ///////////////////////////////////////////////////////////////////////    
+    //  Snapshot implementation
+    //     - binary copy of the model store, see GaussianMixtureStore.
+    //
+    ////////////////////////////////////////////////////////////////////////
     template <typename image_type, typename stat_type>
-    void ForegroundDetectorImpl<image_type,stat_type>::setGMMStates(GaussianMixtureModel & gmm, 
-                                                                    int numActiveGaussians,
-                                                                    const stat_type * weights, 
-                                                                    const stat_type * means,
-                                                                    const stat_type * vars)
+    mwSize ForegroundDetectorImpl<image_type,stat_type>::getSnapshotSizeImpl() const
     {
-                               
-        // setGMM is used during de-serialization and only should 
-        // be called if the system object was saved in an locked state
+        return mStore.getSnapshotSize();
+    }
 
-        // weights is pointer to [M N numGaussian] matrix
-        // means and vars is a pointer to [M N numChannels numGaussians] matrix
-            
-        // weights should already be pointing to the starting pixel
+    template <typename image_type, typename stat_type>
+    void ForegroundDetectorImpl<image_type,stat_type>::saveSnapshotImpl(void * buffer)
+    {
+        waitAsyncImpl();
+        mStore.saveSnapshot(buffer, sizeof(image_type));
+    }
 
-        mwSize numPixels     = mFtor.getNumPixels();
-        mwSize numChannels   = mFtor.getNumChannels();
-        mwSize weight_offset = numPixels;
-        mwSize stat_offset   = numPixels * numChannels;
-        for (int n = 0; n < numActiveGaussians; ++n)
-        {
-            // add WeightedGaussian
-            gmm.push_back(WeightedGaussian<stat_type>(numChannels, 
-                                                      numPixels, 
-                                                      weights, 
-                                                      means, vars ));
-            weights += weight_offset;
-            means   += stat_offset;
-            vars    += stat_offset;
-        }
+    template <typename image_type, typename stat_type>
+    bool ForegroundDetectorImpl<image_type,stat_type>::loadSnapshotImpl(const void * buffer,
+                                                                        mwSize size)
+    {
+        waitAsyncImpl();
+        return mStore.loadSnapshot(buffer, size, sizeof(image_type));
     }
-	
+
+    template <typename image_type, typename stat_type>
+    bool ForegroundDetectorImpl<image_type,stat_type>::saveSnapshotFileImpl(const char * filename)
+    {
+        std::vector<char> buffer(getSnapshotSizeImpl());
+        saveSnapshotImpl(&buffer[0]);
+
+        FILE * fid = fopen(filename, "wb");
+        if (fid == NULL)
+            return false;
+
+        const bool isWritten = fwrite(&buffer[0], 1, buffer.size(), fid) == buffer.size();
+        return (fclose(fid) == 0) && isWritten;
+    }
+
+    template <typename image_type, typename stat_type>
+    bool ForegroundDetectorImpl<image_type,stat_type>::loadSnapshotFileImpl(const char * filename)
+    {
+        FILE * fid = fopen(filename, "rb");
+        if (fid == NULL)
+            return false;
+
+        // read one byte more than expected to detect larger files
+        std::vector<char> buffer(getSnapshotSizeImpl() + 1);
+        const mwSize size = fread(&buffer[0], 1, buffer.size(), fid);
+        fclose(fid);
+
+        return loadSnapshotImpl(&buffer[0], size);
+    }
+
     ////////////////////////////////////////////////////////////////////////
     //
     //  Reset implementation - resets the internal gaussian mixture model back
@@ -269,20 +807,15 @@ namespace vision
     void ForegroundDetectorImpl<image_type,stat_type>::resetImpl()
     {
         //set or reset states to initial value
-        typename GMMVector::iterator currentIter, endIter;
-			
-        currentIter = mGMMVec.begin();
-        endIter = mGMMVec.end();
-        for(; currentIter != endIter; ++currentIter)
-        {
-            currentIter->first.clear();
-        }
+        waitAsyncImpl();
+        mStore.reset();
     } 
 	
     // instantiate templates <image_type, stat_type>
     template class  ForegroundDetectorImpl<float,float>;
     template class  ForegroundDetectorImpl<double,double>;	
     template class  ForegroundDetectorImpl<uint8_T,float>;
+    template class  ForegroundDetectorImpl<uint8_T,uint16_T>; // fixed point
     //template class  ForegroundDetectorImpl<double,float>; //this is not supported
     //template class  ForegroundDetectorImpl<uint8_T,double>; //this is not supported
     //template class  ForegroundDetectorImpl<float,double>; //this is not supported
@@ -0,0 +1,476 @@
+////////////////////////////////////////////////////////////////////////////////
+//  This header contains the ForegroundDetectorFixedPointFunctor class, which
+//  implements the Stauffer-Grimson background subtraction algorithm with
+//  16-bit fixed point statistics for uint8 images. It halves the memory of
+//  the model compared to single precision statistics and only uses integer
+//  arithmetic.
+//
+//  The states are stored in the GaussianMixtureStore with the Q formats:
+//
+//      weights     Q1.15 (32768 is 1.0)
+//      means       Q8.8  (gray level * 256)
+//      variances   Q12.4 (gray level^2 * 16), saturating at 4095.9375
+//
+//  The learning rate is rounded to Q0.16. Updates use round to nearest, so
+//  an update is lost once it is smaller than half a unit of the state. With
+//  a learning rate lr, while both variants match the same gaussians, this
+//  bounds the steady state error with respect to the single precision
+//  variant by:
+//
+//      means       1/(512*lr) gray levels     (0.39 for lr = 0.005)
+//      variances   1/(32*lr) gray levels^2    (6.25 for lr = 0.005)
+//      weights     1/(65536*lr)               (0.003 for lr = 0.005)
+//
+//  plus the quantization of the properties (initial weight and variance,
+//  variance threshold and minimum background ratio). Learning rates below
+//  1/131072 round to 0 and freeze the model. Weights are normalized by
+//  their sum after every update instead of the scale factors of the floating
+//  point algorithm, which keeps the rounding errors from accumulating. A
+//  pixel close to the match threshold may pick a different gaussian than
+//  the single precision variant, after which their models differ by more
+//  than the bounds above until they converge again.
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef FOREGROUND_DETECTOR_FIXED_POINT_FTOR
+#define FOREGROUND_DETECTOR_FIXED_POINT_FTOR
+
+// local includes
+#include "ForegroundDetectorTraits.hpp"
+#include "ForegroundDetectorUtil.hpp"
+#include "GaussianMixtureStore.hpp"
+#include "ForegroundDetectorFunctor.hpp"
+
+#ifndef __arm__
+// 3rd party includes
+#include <tbb/blocked_range.h>
+#endif
+
+// system includes
+#include <vector>
+#include <algorithm>
+
+namespace vision
+{
+
+    class ForegroundDetectorFixedPointFunctor
+    {
+      public:
+
+        typedef uint8_T  image_type;
+        typedef uint16_T stat_type;
+        typedef ForegroundDetectorTraits<float>::Dims Dims;
+
+        // Q formats of the states and of the properties
+        enum
+        {
+            WEIGHT_FRAC_BITS    = 15,
+            MEAN_FRAC_BITS      = 8,
+            VARIANCE_FRAC_BITS  = 4,
+            RATE_FRAC_BITS      = 16,
+            THRESHOLD_FRAC_BITS = 8
+        };
+
+        ///////////////////////////////////////////////////////////////////////
+        //
+        // Constructor
+        //
+        ///////////////////////////////////////////////////////////////////////
+        ForegroundDetectorFixedPointFunctor()
+        {
+            mStorePtr  = NULL; // this gets initialized in setupImpl
+            mWeights   = NULL;
+            mMeans     = NULL;
+            mVariances = NULL;
+            mNumActive = NULL;
+            mIsRowMajor = false;
+            setTileSize(FOREGROUND_DETECTOR_DEFAULT_GRAIN_SIZE);
+        }
+
+        ///////////////////////////////////////////////////////////////////////
+        //
+        // Setup dimension info.
+        //
+        ///////////////////////////////////////////////////////////////////////
+        void setup(Dims dims)
+        {
+            // should always have at least 2 dims
+            VISION_ASSERT(dims.size() >= 2);
+            mNumPixels = dims[0] * dims[1];
+
+            if (dims.size() > 2)
+                mNumChannels = dims[2];
+            else
+                mNumChannels = 1;
+
+            mDims = dims;
+        }
+
+        ////////////////////////////////////////////////////////////////////////
+        //
+        // TBB loop body operator() executes the foreground detection algorithm
+        // on a range of tiles.
+        //
+        ////////////////////////////////////////////////////////////////////////
+#ifdef __arm__
+        void operator()(mwSize rangeBegin, mwSize rangeEnd) const
+#else
+        void operator()(const tbb::blocked_range<mwSize> & range) const
+#endif
+        {
+            VISION_ASSERT_MSG(mStorePtr != NULL,
+                              "model pointer is NULL, you forgot to call setStore first");
+#ifdef __arm__
+            mwSize id  = rangeBegin * mTileSize;
+            mwSize end = std::min(rangeEnd * mTileSize, mNumPixels);
+#else
+            mwSize id  = range.begin() * mTileSize;
+            mwSize end = std::min(range.end() * mTileSize, mNumPixels);
+#endif
+
+            if (mIsRowMajor)
+            {
+                for (; id != end; ++id)
+                    mForegroundMask[id] = detectForeground(id, mImage + id*mNumChannels, 1);
+            }
+            else
+            {
+                for (; id != end; ++id)
+                    mForegroundMask[id] = detectForeground(id, mImage + id, mNumPixels);
+            }
+        }
+
+        ////////////////////////////////////////////////////////////////////////
+        //
+        // detectForeground implements the Stauffer-Grimson algorithm for pixel
+        // pixelID. It returns true if the input pixel is part of the
+        // foreground.
+        //
+        ////////////////////////////////////////////////////////////////////////
+        bool detectForeground(mwSize pixelID,
+                              const image_type * pixel,
+                              mwSize channelStride) const
+        {
+            stat_type * weights   = mWeights + pixelID;
+            stat_type * means     = mMeans + pixelID;
+            stat_type * variances = mVariances + pixelID;
+            mwSize numActive      = static_cast<mwSize>(mNumActive[pixelID]);
+
+            mwSize matchID = findMatch(pixelID, pixel, channelStride);
+            if (matchID != numActive)
+            {
+                // update matching gaussian parameters
+                stat_type * mean     = means + matchID*mGaussianStride;
+                stat_type * variance = variances + matchID*mGaussianStride;
+                for (mwSize c = 0; c < mNumChannels; ++c)
+                {
+                    stat_type & mu  = mean[c*mNumPixels];
+                    stat_type & var = variance[c*mNumPixels];
+                    const long long d = toMean(pixel[c*channelStride]) - static_cast<long long>(mu);
+                    const long long dd = roundShift(d*d, 2*MEAN_FRAC_BITS - VARIANCE_FRAC_BITS);
+
+                    mu  = saturate(mu + roundShift(mLearningRate * d, RATE_FRAC_BITS));
+                    var = saturate(var + roundShift(mLearningRate * (dd - var), RATE_FRAC_BITS));
+                }
+                stat_type & w = weights[matchID*mNumPixels];
+                w = saturate(w + roundShift(mLearningRate * (ONE - w), RATE_FRAC_BITS));
+
+                // sort gaussians in mixture model from highest to lowest
+                matchID = sortGaussians(pixelID, matchID);
+            }
+            else // No match found for pixel.
+            {
+                // replace the lowest ranked gaussian once the model is full
+                if (numActive == mNumGaussians)
+                    --numActive;
+
+                matchID = numActive++;
+                weights[matchID*mNumPixels] = mInitialWeight;
+                stat_type * mean     = means + matchID*mGaussianStride;
+                stat_type * variance = variances + matchID*mGaussianStride;
+                for (mwSize c = 0; c < mNumChannels; ++c)
+                {
+                    mean[c*mNumPixels]     = saturate(toMean(pixel[c*channelStride]));
+                    variance[c*mNumPixels] = mInitialVariance;
+                }
+                mNumActive[pixelID] = static_cast<int32_T>(numActive);
+            }
+
+            normalizeWeights(pixelID);
+            return isForeground(pixelID, matchID);
+        }
+
+        ///////////////////////////////////////////////////////////////////////
+        //
+        // findMatch returns the index of the first gaussian for which the
+        // squared distance to the pixel is below varianceThreshold times the
+        // sum of the variances, or the number of active gaussians.
+        //
+        ///////////////////////////////////////////////////////////////////////
+        mwSize findMatch(mwSize pixelID,
+                         const image_type * pixel,
+                         mwSize channelStride) const
+        {
+            const stat_type * means     = mMeans + pixelID;
+            const stat_type * variances = mVariances + pixelID;
+            const mwSize numActive      = static_cast<mwSize>(mNumActive[pixelID]);
+
+            // scale of the threshold times the variance relative to the
+            // squared distance
+            const int shift = 2*MEAN_FRAC_BITS - THRESHOLD_FRAC_BITS - VARIANCE_FRAC_BITS;
+
+            mwSize k = 0;
+            for ( ; k < numActive; ++k)
+            {
+                const stat_type * mean     = means + k*mGaussianStride;
+                const stat_type * variance = variances + k*mGaussianStride;
+
+                unsigned long long sumDistance = 0, sumV = 0;
+                for (mwSize c = 0; c < mNumChannels; ++c)
+                {
+                    const long long d = toMean(pixel[c*channelStride]) -
+                        static_cast<long long>(mean[c*mNumPixels]);
+                    sumDistance += static_cast<unsigned long long>(d*d);
+                    sumV        += variance[c*mNumPixels];
+                }
+
+                if (sumDistance < ((mVarianceThreshold * sumV) << shift))
+                {
+                    break; // first to match wins
+                }
+            }
+            return k;
+        }
+
+        ///////////////////////////////////////////////////////////////////////
+        //
+        // sortGaussians moves the matching gaussian up while its rank
+        // weight/sqrt(sum of variances) is higher than the one above. The
+        // ranks are compared as w1^2*sumV2 > w2^2*sumV1, which is exact.
+        //
+        ///////////////////////////////////////////////////////////////////////
+        mwSize sortGaussians(mwSize pixelID, mwSize matchID) const
+        {
+            while (matchID > 0)
+            {
+                const unsigned long long w1 = mWeights[pixelID + matchID*mNumPixels];
+                const unsigned long long w2 = mWeights[pixelID + (matchID-1)*mNumPixels];
+                if (w1*w1*sumVariances(pixelID, matchID-1) >
+                    w2*w2*sumVariances(pixelID, matchID))
+                {
+                    swapGaussians(pixelID, matchID, matchID-1);
+                    matchID--;
+                }
+                else // in correct position
+                {
+                    break;
+                }
+            }
+            return matchID;
+        }
+
+        ///////////////////////////////////////////////////////////////////////
+        //
+        // normalizeWeights scales the weights so that they sum to one
+        //
+        ///////////////////////////////////////////////////////////////////////
+        void normalizeWeights(mwSize pixelID) const
+        {
+            stat_type * weights = mWeights + pixelID;
+            const mwSize numActive = static_cast<mwSize>(mNumActive[pixelID]);
+
+            unsigned long long wSum = 0;
+            for (mwSize k = 0; k < numActive; ++k)
+                wSum += weights[k*mNumPixels];
+
+            if (wSum == 0)
+                return;
+
+            for (mwSize k = 0; k < numActive; ++k)
+            {
+                unsigned long long w = weights[k*mNumPixels];
+                weights[k*mNumPixels] = saturate(
+                    static_cast<long long>((w*ONE + wSum/2) / wSum));
+            }
+        }
+
+        ///////////////////////////////////////////////////////////////////////
+        //
+        // isForeground return true if the pixel is found to be part of the
+        // foreground.
+        //
+        ///////////////////////////////////////////////////////////////////////
+        bool isForeground(mwSize pixelID, mwSize matchID) const
+        {
+            // quick exit if matchingGaussian is highest rank
+            if (matchID == 0)
+                return false;
+
+            const stat_type * weights = mWeights + pixelID;
+            const mwSize numActive = static_cast<mwSize>(mNumActive[pixelID]);
+
+            unsigned long long wSum = 0;
+            for (mwSize k = 0; k < numActive; ++k)
+            {
+                wSum += weights[k*mNumPixels];
+                if (wSum >= mMinimumBackgroundRatio)
+                    return matchID != k;
+                if (matchID == k)
+                    return false;
+            }
+            return false; // must be background
+        }
+
+        ///////////////////////////////////////////////////////////////////////
+        void setStore(GaussianMixtureStore<stat_type> * store)
+        {
+            VISION_ASSERT(store->getNumPixels() == mNumPixels &&
+                          store->getNumChannels() == mNumChannels);
+            mStorePtr       = store;
+            mWeights        = store->weights();
+            mMeans          = store->means();
+            mVariances      = store->variances();
+            mNumActive      = store->numActive();
+            mGaussianStride = store->getGaussianStride();
+        }
+
+        ///////////////////////////////////////////////////////////////////////
+        //
+        // Set input data for functor. The learning rate is rounded to Q0.16.
+        //
+        ///////////////////////////////////////////////////////////////////////
+        inline void setStepInput(const image_type * image, float learningRate,
+                                 bool isRowMajor)
+        {
+            mImage = image;
+            mLearningRate = toFixed(learningRate, RATE_FRAC_BITS, 1 << RATE_FRAC_BITS);
+            mIsRowMajor = isRowMajor;
+        }
+
+        inline void setStepOutput(boolean_T * output)
+        {
+            mForegroundMask = output;
+        }
+
+        ///////////////////////////////////////////////////////////////////////
+        //
+        // Set runtime properties, rounded to their Q formats.
+        //
+        ///////////////////////////////////////////////////////////////////////
+        void setProperties(mwSize numGaussians,
+                           float initialVariance,
+                           float initialWeight,
+                           float varianceThreshold,
+                           float minBGRatio)
+        {
+            mNumGaussians      = numGaussians;
+            mInitialVariance   = static_cast<stat_type>(
+                toFixed(initialVariance, VARIANCE_FRAC_BITS, MAX_STAT));
+            mInitialWeight     = static_cast<stat_type>(
+                std::max(toFixed(initialWeight, WEIGHT_FRAC_BITS, ONE), 1LL));
+            mVarianceThreshold = static_cast<unsigned long long>(
+                toFixed(varianceThreshold, THRESHOLD_FRAC_BITS, 1LL << 32));
+            mMinimumBackgroundRatio = static_cast<unsigned long long>(
+                toFixed(minBGRatio, WEIGHT_FRAC_BITS, ONE));
+        }
+
+        ///////////////////////////////////////////////////////////////////////
+        void setTileSize(mwSize tileSize)
+        {
+            const mwSize alignment = FOREGROUND_DETECTOR_TILE_ALIGNMENT;
+            tileSize  = std::max(tileSize, static_cast<mwSize>(1));
+            mTileSize = (tileSize + alignment - 1) / alignment * alignment;
+        }
+
+        mwSize getTileSize()     { return mTileSize; }
+        mwSize getNumTiles()     { return (mNumPixels + mTileSize - 1) / mTileSize; }
+        Dims getDims()           { return mDims; }
+        mwSize getNumGaussians() { return mNumGaussians; }
+        mwSize getNumChannels()  { return mNumChannels; }
+        mwSize getNumPixels()    { return mNumPixels; }
+
+      private:
+
+        enum { ONE = 1 << WEIGHT_FRAC_BITS, MAX_STAT = 65535 };
+
+        static inline long long toMean(image_type value)
+        {
+            return static_cast<long long>(value) << MEAN_FRAC_BITS;
+        }
+
+        // rounds value * 2^fracBits to the nearest integer in [0, maxValue]
+        static inline long long toFixed(double value, int fracBits, long long maxValue)
+        {
+            double scaled = value * static_cast<double>(1LL << fracBits) + 0.5;
+            if (!(scaled > 0.0))
+                return 0;
+            if (scaled >= static_cast<double>(maxValue))
+                return maxValue;
+            return static_cast<long long>(scaled);
+        }
+
+        // value / 2^bits rounded to nearest, ties away from zero
+        static inline long long roundShift(long long value, int bits)
+        {
+            const long long half = 1LL << (bits - 1);
+            return value >= 0 ? (value + half) >> bits : -((half - value) >> bits);
+        }
+
+        static inline stat_type saturate(long long value)
+        {
+            return static_cast<stat_type>(std::min(std::max(value, 0LL),
+                                                   static_cast<long long>(MAX_STAT)));
+        }
+
+        inline unsigned long long sumVariances(mwSize pixelID, mwSize k) const
+        {
+            const stat_type * variance = mVariances + pixelID + k*mGaussianStride;
+            unsigned long long sumV = 0;
+            for (mwSize c = 0; c < mNumChannels; ++c)
+                sumV += variance[c*mNumPixels];
+            return sumV;
+        }
+
+        inline void swapGaussians(mwSize pixelID, mwSize i, mwSize j) const
+        {
+            std::swap(mWeights[pixelID + i*mNumPixels],
+                      mWeights[pixelID + j*mNumPixels]);
+
+            stat_type * means     = mMeans + pixelID;
+            stat_type * variances = mVariances + pixelID;
+            for (mwSize c = 0; c < mNumChannels; ++c)
+            {
+                const mwSize offset = c*mNumPixels;
+                std::swap(means[i*mGaussianStride + offset],
+                          means[j*mGaussianStride + offset]);
+                std::swap(variances[i*mGaussianStride + offset],
+                          variances[j*mGaussianStride + offset]);
+            }
+        }
+
+      private: // data members
+
+        GaussianMixtureStore<stat_type> * mStorePtr; // holds every mixture model
+        stat_type * mWeights;      // flat state arrays of mStorePtr
+        stat_type * mMeans;
+        stat_type * mVariances;
+        int32_T   * mNumActive;
+        mwSize mGaussianStride;    // distance between two gaussians of a pixel
+        mwSize mTileSize;          // number of pixels per tile
+        bool mIsRowMajor;          // layout of the input image
+        Dims mDims;                // dimension info
+        const image_type * mImage; // pointer to input image
+        long long mLearningRate;   // Q0.16
+        boolean_T * mForegroundMask; // pointer to output mask
+        mwSize mNumGaussians;
+        mwSize mNumPixels;
+        mwSize mNumChannels;
+        stat_type mInitialWeight;               // Q1.15
+        stat_type mInitialVariance;             // Q12.4
+        unsigned long long mVarianceThreshold;  // Q8.8
+        unsigned long long mMinimumBackgroundRatio; // Q1.15
+    };
+
+} // end vision namespace
+
+#endif
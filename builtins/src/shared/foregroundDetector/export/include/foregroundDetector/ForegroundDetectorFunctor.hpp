@@ -23,13 +23,17 @@
 
 // local includes
 #include "ForegroundDetectorTraits.hpp"
+#include "GaussianMixtureStore.hpp"
+#include "ForegroundDetectorSIMD.hpp"
 #include "ForegroundDetectorUtil.hpp"
 
 #ifdef __arm__
+#include <cmath>
 #include <limits>
 #else
 // export includes
 #include <mfl_scalar/exp.hpp>
+#include <mfl_scalar/basic_math.hpp>
 
 // 3rd party includes
 #include <tbb/tbb.h>
@@ -46,35 +50,40 @@
 #include <algorithm>
 #include <numeric>
 
+// Number of pixels whose single precision states fill a 64 byte cache line.
+// Tiles are a multiple of this size.
+#define FOREGROUND_DETECTOR_TILE_ALIGNMENT 16
+
+// Default number of pixels processed by a task
+#define FOREGROUND_DETECTOR_DEFAULT_GRAIN_SIZE 1024
+
 namespace vision
 {
-    
+
     template <typename image_type, typename stat_type>
-    class ForegroundDetectorFunctor 
+    class ForegroundDetectorFunctor
     {
-      public:      
-        
+      public:
+
         typedef typename ForegroundDetectorTraits<stat_type>::Dims Dims;
-        
-        typedef typename ForegroundDetectorTraits<stat_type>::GaussianMixtureModel GaussianMixtureModel;
-        
-        typedef typename ForegroundDetectorTraits<stat_type>::GaussianIterator GaussianIterator;
-        
-        typedef typename ForegroundDetectorTraits<stat_type>::ConstGaussianIterator ConstGaussianIterator;
-        
-        typedef typename ForegroundDetectorTraits<stat_type>::GMMVector GMMVector;
-        
-        ///////////////////////////////////////////////////////////////////////
-        // 
+
+        ///////////////////////////////////////////////////////////////////////
+        //
         // Constructor
         //
         ///////////////////////////////////////////////////////////////////////
         ForegroundDetectorFunctor()
         {
-            mGMMPtr = NULL; // this gets initialized in setupImpl
+            mStorePtr = NULL; // this gets initialized in setupImpl
+            mWeights   = NULL;
+            mMeans     = NULL;
+            mVariances = NULL;
+            mNumActive = NULL;
+            mIsRowMajor = false;
+            setTileSize(FOREGROUND_DETECTOR_DEFAULT_GRAIN_SIZE);
         }
-                    
-                
+
+
         ///////////////////////////////////////////////////////////////////////
         //
         // Setup dimension info.
@@ -82,329 +91,217 @@ namespace vision
         ///////////////////////////////////////////////////////////////////////
         void setup(Dims dims)
         {
-            
+
             // should always have at least 2 dims
             VISION_ASSERT(dims.size() >= 2);
             mNumPixels   = dims[0] * dims[1];
-            
-            if (dims.size() > 2)                
+
+            if (dims.size() > 2)
                 mNumChannels = dims[2];
             else
                 mNumChannels = 1;
 
             mDims = dims;
-                                    
-        }     
-     
-        ////////////////////////////////////////////////////////////////////////
-        //
-        // TBB loop body operator() executes the foreground detection algorithm
-        // on a range of pixels. 
-        //
-        ////////////////////////////////////////////////////////////////////////
-#ifdef __arm__
-        void operator()(mwSize rangeBegin, mwSize rangeEnd) const
-#else
-        void operator()(tbb::blocked_range<mwSize> & range) const
-#endif
-        {
 
-            VISION_ASSERT_MSG(mGMMPtr != NULL,
-                              "model pointer is NULL, you forgot to call setGMMVec first");
-#ifdef __arm__            
-            mwSize id = rangeBegin;
-            mwSize end = rangeEnd;  
-#else
-            mwSize id  = range.begin();
-            mwSize end = range.end();
-#endif
-            
-            runAlgorithm(id, end);
         }
 
         ////////////////////////////////////////////////////////////////////////
         //
         // TBB loop body operator() executes the foreground detection algorithm
-        // on a range of pixels.
+        // on a range of tiles. A tile holds mTileSize consecutive pixels, so
+        // each tile except the last one starts on a cache line of the model
+        // store, and no two threads update the same cache line.
         //
         ////////////////////////////////////////////////////////////////////////
 #ifdef __arm__
-        void operator()(unsigned long rangeBegin, unsigned long rangeEnd) const
+        void operator()(mwSize rangeBegin, mwSize rangeEnd) const
 #else
-        void operator()(tbb::blocked_range<unsigned int> & range) const
+        void operator()(const tbb::blocked_range<mwSize> & range) const
 #endif
         {
-            
-            VISION_ASSERT_MSG(mGMMPtr != NULL,
-                              "model pointer is NULL, you forgot to call setGMMVec first");
+
+            VISION_ASSERT_MSG(mStorePtr != NULL,
+                              "model pointer is NULL, you forgot to call setStore first");
 #ifdef __arm__
-            unsigned int id = rangeBegin;
-            unsigned int end = rangeEnd;
+            mwSize id  = rangeBegin * mTileSize;
+            mwSize end = std::min(rangeEnd * mTileSize, mNumPixels);
 #else
-            unsigned int id  = range.begin();
-            unsigned int end = range.end();
+            mwSize id  = range.begin() * mTileSize;
+            mwSize end = std::min(range.end() * mTileSize, mNumPixels);
 #endif
 
-            runAlgorithmRowMajor(id, end);
+            if (mIsRowMajor)
+                runAlgorithmRowMajor(id, end);
+            else
+                runAlgorithm(id, end);
         }
-        
+
         ////////////////////////////////////////////////////////////////////////
         //
         // runAlgorithm and runAlgorithmRowMajor functions implement the loop to
         // run the foreground detector algorithm in row major or column major format.
+        // The channels of a pixel are mNumPixels apart in column major format
+        // and adjacent in row major format. Blocks of pixels are processed by
+        // the SIMD kernel when one is available for stat_type, and the
+        // remaining pixels one at a time.
         //
-        ////////////////////////////////////////////////////////////////////////        
+        ////////////////////////////////////////////////////////////////////////
         void runAlgorithm(mwSize id, mwSize end) const
         {
+            id = ForegroundDetectorBlockKernel<image_type, stat_type>::run(
+                getKernelArgs(), id, end, mImage, mNumPixels, 1, mForegroundMask);
+
             // loop over each pixel in the range
-            for (; id != end; ++id)            
+            for (; id != end; ++id)
             {
-                // extract gaussian mixture model and pixel
-                const image_type * pixel = mImage+id;                
-                GaussianMixtureModel & gmm = (mGMMPtr->at(id)).first;
-                                               
-                // run the algorithm 
-                mForegroundMask[id] = detectForeground(gmm, pixel);
+                // run the algorithm
+                mForegroundMask[id] = detectForeground(id, mImage+id, mNumPixels);
             }
         }
 
         void runAlgorithmRowMajor(mwSize id, mwSize end) const
         {
-            // loop over each pixel in the range
+            id = ForegroundDetectorBlockKernel<image_type, stat_type>::run(
+                getKernelArgs(), id, end, mImage, 1, mNumChannels, mForegroundMask);
 
-            for (id = (id * mNumChannels); id < (end * mNumChannels); id = id + mNumChannels)
+            // loop over each pixel in the range
+            for (; id != end; ++id)
             {
-                // extract gaussian mixture model and pixel
-                const image_type * pixel = mImage+id;   
-                mwSize indexValue = (id/mNumChannels);
-                
-                GaussianMixtureModel & gmm = (mGMMPtr->at(indexValue)).first;
-                                               
-                // run the algorithm 
-                mForegroundMask[indexValue] = detectForegroundRowMajor(gmm, pixel);
+                // run the algorithm
+                mForegroundMask[id] = detectForeground(id, mImage+id*mNumChannels, 1);
             }
         }
 
         ////////////////////////////////////////////////////////////////////////
         //
-        // detectForeground  and detectForegroundRowMajor implements the
-        // Stauffer-Grimson algorithm.  It returns true if the input pixel is
-        // part of the foreground.
+        // detectForeground implements the Stauffer-Grimson algorithm for pixel
+        // pixelID. It returns true if the input pixel is part of the
+        // foreground.
         //
         ////////////////////////////////////////////////////////////////////////
-        bool detectForeground(GaussianMixtureModel & gmm,
-                              const image_type * pixel) const
+        bool detectForeground(mwSize pixelID,
+                              const image_type * pixel,
+                              mwSize channelStride) const
         {
 
-            GaussianIterator matchingGaussian;
-            
             // scan gaussian mixture model and return matching gaussian
-            matchingGaussian = findMatchAndUpdate(gmm, pixel);
-                
-            // determine if current pixel is foreground or background
-            return isForeground(gmm, matchingGaussian); 
-                
-        }
+            mwSize matchID = findMatchAndUpdate(pixelID, pixel, channelStride);
 
-        bool detectForegroundRowMajor(GaussianMixtureModel & gmm,
-                              const image_type * pixel) const
-        {
-            
-            GaussianIterator matchingGaussian;
-            
-            // scan gaussian mixture model and return matching gaussian
-            matchingGaussian = findMatchAndUpdateRowMajor(gmm, pixel);
-            
             // determine if current pixel is foreground or background
-            return isForeground(gmm, matchingGaussian);
-            
-        }
-        
-        ////////////////////////////////////////////////////////////////////////
-        //
-        // findMatchAndUpdate and findMatchAndUpdateRowMajor returns an iterator
-        // to the gaussian to which the pixel belongs. The matching gaussian
-        // statistics are updated based on the Stauffer-Grimsom update equations.
-        // If the pixel does not belong to any existing gaussian then a
-        // new gaussian is created for the pixel.
-        //
-        ////////////////////////////////////////////////////////////////////////
-        GaussianIterator findMatchAndUpdate(GaussianMixtureModel & gmm, 
-                                            const image_type * pixel) const
-        {
-            GaussianIterator matchingGaussian;
-
-            // find a match for the pixel
-            matchingGaussian = findMatch(gmm, pixel);
-            stat_type scaleFactor;
-            const stat_type one(1.0);
-            const bool foundMatch = matchingGaussian != gmm.end();
-            if (foundMatch)
-            {                
-
-                // optimization - instead of summing weights to calculate the
-                // scale factor, use the fact that the sum of the weights is
-                // always 1 and just use the weight update rule to figure out
-                // what the scale factor should be after the weight is updated.
-                stat_type weight = matchingGaussian->getWeight();               
-                scaleFactor = one/(one + mLearningRate * (one - weight));
+            return isForeground(pixelID, matchID);
 
-                // update matching gaussian parameters
-                matchingGaussian->update(pixel, mLearningRate,
-                                         mNumChannels, mNumPixels);
-                
-                // sort gaussians in mixture model from highest to lowest
-                matchingGaussian = sortGaussians(gmm, matchingGaussian);
-            }
-            else // No match found for pixel.
-            {
-                stat_type weight = mInitialWeight;
-                // When there is no match we need to add a new gaussian or
-                // remove the lowest rank gaussian and replace it with a new
-                // one.                                          
-                if (!gmm.empty())
-                {                    
-                    // remove the lowest ranked gaussian if not yet reached
-                    // mNumGaussians
-                    if (gmm.size() == mNumGaussians)
-                    {
-                        weight -= gmm.back().getWeight(); // adjust for the popped weight
-                        gmm.pop_back();                         
-                    }
-                }                                               
-                                            
-                // set pixel value as initial gaussian mean
-                mwSize offset(0);
-                typename WeightedGaussian<stat_type>::stat_vec mean(mNumChannels);
-                for(mwSize i = 0; i < mNumChannels; ++i, offset += mNumPixels)
-                {
-                    mean[i] = static_cast<stat_type>(pixel[offset]);
-                }
-                gmm.push_back(WeightedGaussian<stat_type>(mNumChannels,mInitialWeight,
-                                                              mean,mInitialVariance));
-
-                // set the matchingGaussian to the end;  
-                matchingGaussian = --(gmm.end());
-
-                VISION_ASSERT(matchingGaussian->getWeight() == mInitialWeight);
-                // optimization - compute scale factor without having to sum weights
-                if (gmm.size() == 1)
-                    scaleFactor = one/weight ;
-                else
-                    scaleFactor = one/(one + weight);
-               
-            }
-                
-            normalizeWeights(gmm, scaleFactor);
-            return matchingGaussian;
         }
 
         ////////////////////////////////////////////////////////////////////////
         //
-        // findMatchAndUpdate returns an iterator to the gaussian to which the
+        // findMatchAndUpdate returns the index of the gaussian to which the
         // pixel belongs. The matching gaussian statistics are updated based on
-        // the Stauffer-Grimsom update equations.  If the pixel does not belong
+        // the Stauffer-Grimsom update equations. If the pixel does not belong
         // to any existing gaussian then a new gaussian is created for the
         // pixel.
         //
         ////////////////////////////////////////////////////////////////////////
-        GaussianIterator findMatchAndUpdateRowMajor(GaussianMixtureModel & gmm,
-                                            const image_type * pixel) const
+        mwSize findMatchAndUpdate(mwSize pixelID,
+                                  const image_type * pixel,
+                                  mwSize channelStride) const
         {
-            GaussianIterator matchingGaussian;
-            
+            stat_type * weights   = mWeights + pixelID;
+            stat_type * means     = mMeans + pixelID;
+            stat_type * variances = mVariances + pixelID;
+            mwSize numActive      = static_cast<mwSize>(mNumActive[pixelID]);
+
             // find a match for the pixel
-            matchingGaussian = findMatchRowMajor(gmm, pixel);
-            
+            mwSize matchID = findMatch(pixelID, pixel, channelStride);
             stat_type scaleFactor;
             const stat_type one(1.0);
-            const bool foundMatch = matchingGaussian != gmm.end();
+            const bool foundMatch = matchID != numActive;
             if (foundMatch)
             {
-                
+
                 // optimization - instead of summing weights to calculate the
                 // scale factor, use the fact that the sum of the weights is
                 // always 1 and just use the weight update rule to figure out
                 // what the scale factor should be after the weight is updated.
-                stat_type weight = matchingGaussian->getWeight();
+                stat_type weight = weights[matchID*mNumPixels];
                 scaleFactor = one/(one + mLearningRate * (one - weight));
-                
+
                 // update matching gaussian parameters
-                matchingGaussian->updateRowMajor(pixel, mLearningRate,
-                                         mNumChannels, mNumPixels);
+                stat_type * mean     = means + matchID*mGaussianStride;
+                stat_type * variance = variances + matchID*mGaussianStride;
+                for (mwSize c = 0; c < mNumChannels; ++c)
+                {
+                    stat_type & mu  = mean[c*mNumPixels];
+                    stat_type & var = variance[c*mNumPixels];
+                    stat_type d = static_cast<stat_type>(pixel[c*channelStride]) - mu;
+                    mu  = mu + mLearningRate * d;
+                    var = var + mLearningRate * (d*d - var);
+                }
+                weights[matchID*mNumPixels] = weight + mLearningRate * (one - weight);
+
                 // sort gaussians in mixture model from highest to lowest
-                matchingGaussian = sortGaussians(gmm, matchingGaussian);
+                matchID = sortGaussians(pixelID, matchID);
             }
             else // No match found for pixel.
             {
                 stat_type weight = mInitialWeight;
                 // When there is no match we need to add a new gaussian or
                 // remove the lowest rank gaussian and replace it with a new
-                // one.
-                if (!gmm.empty())
+                // one. The slot of the lowest ranked gaussian is reused.
+                if (numActive == mNumGaussians)
                 {
-                    // remove the lowest ranked gaussian if not yet reached
-                    // mNumGaussians
-                    if (gmm.size() == mNumGaussians)
-                    {
-                        weight -= gmm.back().getWeight(); // adjust for the popped weight
-                        gmm.pop_back();
-                    }
+                    --numActive;
+                    weight -= weights[numActive*mNumPixels]; // adjust for the popped weight
                 }
-                
-                // set pixel value as initial gaussian mean
-                typename WeightedGaussian<stat_type>::stat_vec mean(mNumChannels);
 
-                for(mwSize i = 0; i < mNumChannels; ++i)
+                // set pixel value as initial gaussian mean
+                matchID = numActive++;
+                weights[matchID*mNumPixels] = mInitialWeight;
+                stat_type * mean     = means + matchID*mGaussianStride;
+                stat_type * variance = variances + matchID*mGaussianStride;
+                for (mwSize c = 0; c < mNumChannels; ++c)
                 {
-                    mean[i] = static_cast<stat_type>(pixel[i]);
+                    mean[c*mNumPixels]     = static_cast<stat_type>(pixel[c*channelStride]);
+                    variance[c*mNumPixels] = mInitialVariance;
                 }
-                
-                gmm.push_back(WeightedGaussian<stat_type>(mNumChannels,mInitialWeight,
-                                                          mean,mInitialVariance));
-                
-                // set the matchingGaussian to the end;
-                matchingGaussian = --(gmm.end());
-                
-                VISION_ASSERT(matchingGaussian->getWeight() == mInitialWeight);
+                mNumActive[pixelID] = static_cast<int32_T>(numActive);
+
                 // optimization - compute scale factor without having to sum weights
-                if (gmm.size() == 1)
+                if (numActive == 1)
                     scaleFactor = one/weight ;
                 else
                     scaleFactor = one/(one + weight);
-                
+
             }
-            
-            normalizeWeights(gmm, scaleFactor);
-            return matchingGaussian;
+
+            normalizeWeights(pixelID, scaleFactor);
+            return matchID;
         }
 
         ///////////////////////////////////////////////////////////////////////
         //
-        // isForeground return true if the pixel is found to be part of the 
+        // isForeground return true if the pixel is found to be part of the
         // foreground.
         //
         ///////////////////////////////////////////////////////////////////////
-        bool isForeground(const GaussianMixtureModel & gmm, 
-                          const GaussianIterator matchingGaussian) const
+        bool isForeground(mwSize pixelID, mwSize matchID) const
         {
-           
+
             bool isForeground = true;
-            ConstGaussianIterator start = gmm.begin();
 
             // quick exit if matchingGaussian is highest rank
-            if (matchingGaussian == start) 
+            if (matchID == 0)
                 return !isForeground;
 
-            ConstGaussianIterator stop = gmm.end();
-            
+            const stat_type * weights = mWeights + pixelID;
+            const mwSize numActive = static_cast<mwSize>(mNumActive[pixelID]);
+
             // there should always be gaussians in the model
-            VISION_ASSERT(start != stop);
-            // Sum up the weights and compare against threshold                       
+            VISION_ASSERT(numActive > 0);
+            // Sum up the weights and compare against threshold
             stat_type wSum(0.0);
-            for( ; start != stop; ++start)
+            for (mwSize k = 0; k < numActive; ++k)
             {
-                wSum += start->getWeight();
+                wSum += weights[k*mNumPixels];
                 // we must meet the minimum background ratio to decide whether
 		// or not pixel is foreground
 #ifdef __arm__
@@ -415,14 +312,14 @@ namespace vision
                     mfl_scalar::Eps<stat_type>(1.0))
 #endif
                 {
-                    if (matchingGaussian == start)
+                    if (matchID == k)
                         return !isForeground;
                     else
                         return isForeground;
                     // this means matchingGaussian has to be foreground
-                    
+
                 }
-                if (matchingGaussian == start)
+                if (matchID == k)
                 {
                     // reached matching gaussian but did not reach min
                     // means this has to be part of background because
@@ -436,134 +333,197 @@ namespace vision
             // part of background model if we've reached the end of the list.
             VISION_ASSERT(false);
             return !isForeground; // must be background
-            
-        }               
+
+        }
 
         ///////////////////////////////////////////////////////////////////////
         //
-        // sortGaussians sorts the gaussians in a mixture model from the
-        // matching gaussian to the highest ranked gaussian and returns a
-        // pointer to the same element that the input matchingGaussian pointed
-        // to prior to sorting.
+        // rank returns weight/sqrt(sum of variances) of gaussian k of a pixel.
         //
         ///////////////////////////////////////////////////////////////////////
-        GaussianIterator sortGaussians(GaussianMixtureModel & gmm, 
-                                       GaussianIterator matchingGaussian) const
+        inline stat_type rank(mwSize pixelID, mwSize k) const
         {
-            // get the index of the matching gaussian            
-            typename GaussianIterator::difference_type matchID;
-
-            matchID = matchingGaussian - gmm.begin();
+            const stat_type * variance = mVariances + pixelID + k*mGaussianStride;
+            stat_type sumV(0.0);
+            for (mwSize c = 0; c < mNumChannels; ++c)
+            {
+                sumV += variance[c*mNumPixels];
+            }
+#ifdef __arm__
+            return mWeights[pixelID + k*mNumPixels]/(std::sqrt(sumV));
+#else
+            return mWeights[pixelID + k*mNumPixels]/(mfl_scalar::Sqrt(sumV));
+#endif
+        }
 
-            // move the matching gaussian up the model vector if it has higher rank
+        ///////////////////////////////////////////////////////////////////////
+        //
+        // sortGaussians sorts the gaussians in a mixture model from the
+        // matching gaussian to the highest ranked gaussian and returns the
+        // new index of the matching gaussian.
+        //
+        ///////////////////////////////////////////////////////////////////////
+        mwSize sortGaussians(mwSize pixelID, mwSize matchID) const
+        {
+            // move the matching gaussian up the model if it has higher rank
             while (matchID > 0)
             {
                 // percolate up if ranked higher
-                if( gmm[matchID] > gmm[matchID-1])
+                if (rank(pixelID, matchID) > rank(pixelID, matchID-1))
                 {
-                    std::swap(gmm[matchID],gmm[matchID-1]);
+                    swapGaussians(pixelID, matchID, matchID-1);
                     matchID--; // update match index
                 }
                 else // in correct position
-                {                    
+                {
                     break;
                 }
             }
-            return gmm.begin() + matchID;
-            
+            return matchID;
+
         }
-        
+
         ///////////////////////////////////////////////////////////////////////
         //
-        // findMatch and findMatchRowMajor returns an iterator to the gaussian
-        // which is closest to the pixel. If there is no match, the returned
-        // iterator will equal last.
+        // swapGaussians exchanges the statistics of gaussians i and j of a
+        // pixel.
         //
         ///////////////////////////////////////////////////////////////////////
-        GaussianIterator findMatch(GaussianMixtureModel & gmm, 
-                                   const image_type * pixel ) const
+        inline void swapGaussians(mwSize pixelID, mwSize i, mwSize j) const
         {
-         
-            GaussianIterator first = gmm.begin();
-            GaussianIterator last  = gmm.end();
-
-            // follow same semantics as std::find: returns the one-past-the-last
-            // iterator when there is no match.
+            std::swap(mWeights[pixelID + i*mNumPixels],
+                      mWeights[pixelID + j*mNumPixels]);
 
-            // loop over gaussians in mixture model
-            for( ; first != last; ++first)
+            stat_type * means     = mMeans + pixelID;
+            stat_type * variances = mVariances + pixelID;
+            for (mwSize c = 0; c < mNumChannels; ++c)
             {
-                
-                if (first->isMatch(pixel, mVarianceThreshold,
-                                   mNumPixels))
-                {
-                    break; // first to match wins
-                }                
-                
+                const mwSize offset = c*mNumPixels;
+                std::swap(means[i*mGaussianStride + offset],
+                          means[j*mGaussianStride + offset]);
+                std::swap(variances[i*mGaussianStride + offset],
+                          variances[j*mGaussianStride + offset]);
             }
-            return first;
         }
 
-        GaussianIterator findMatchRowMajor(GaussianMixtureModel & gmm, 
-                                   const image_type * pixel ) const
+        ///////////////////////////////////////////////////////////////////////
+        //
+        // findMatch returns the index of the first gaussian which is close
+        // enough to the pixel. If there is no match, the returned index will
+        // equal the number of active gaussians.
+        //
+        ///////////////////////////////////////////////////////////////////////
+        mwSize findMatch(mwSize pixelID,
+                         const image_type * pixel,
+                         mwSize channelStride) const
         {
-         
-            GaussianIterator first = gmm.begin();
-            GaussianIterator last  = gmm.end();
+            const stat_type * means     = mMeans + pixelID;
+            const stat_type * variances = mVariances + pixelID;
+            const mwSize numActive      = static_cast<mwSize>(mNumActive[pixelID]);
 
-            // follow same semantics as std::find: returns the one-past-the-last
-            // iterator when there is no match.
-    
             // loop over gaussians in mixture model
-            for( ; first != last; ++first)
+            mwSize k = 0;
+            for ( ; k < numActive; ++k)
             {
-                if (first->isMatchRowMajor(pixel, mVarianceThreshold,
-                                   mNumPixels))
+                const stat_type * mean     = means + k*mGaussianStride;
+                const stat_type * variance = variances + k*mGaussianStride;
+
+                // compute the distance to gaussian, it is a match when the
+                // distance < threshold
+                stat_type distance, sumDistance(0), sumV(0);
+                for (mwSize c = 0; c < mNumChannels; ++c)
+                {
+                    distance = static_cast<stat_type>(pixel[c*channelStride]) - mean[c*mNumPixels];
+                    sumDistance += distance * distance;
+                }
+                for (mwSize c = 0; c < mNumChannels; ++c)
+                {
+                    sumV += variance[c*mNumPixels];
+                }
+
+                if (sumDistance < (mVarianceThreshold * sumV))
                 {
                     break; // first to match wins
-                }                
-                
+                }
             }
-            return first;
-        }        
-             
+            return k;
+        }
+
         ///////////////////////////////////////////////////////////////////////
-        // 
+        //
         // normalizeWeights - normalizes the weights of the gaussians in the
         // mixture model
-        ///////////////////////////////////////////////////////////////////////        
-        void normalizeWeights(GaussianMixtureModel & gmm, 
-                              stat_type scaleFactor) const
+        ///////////////////////////////////////////////////////////////////////
+        void normalizeWeights(mwSize pixelID, stat_type scaleFactor) const
         {
+            stat_type * weights = mWeights + pixelID;
+            const mwSize numActive = static_cast<mwSize>(mNumActive[pixelID]);
 
-            GaussianIterator start = gmm.begin();
-            GaussianIterator stop  = gmm.end();
-                        
-            for( ; start != stop; ++start)
+            for (mwSize k = 0; k < numActive; ++k)
             {
-                start->scaleWeight(scaleFactor);    
+                weights[k*mNumPixels] *= scaleFactor;
             }
         }
-      
+
+        ///////////////////////////////////////////////////////////////////////
+        //
+        // getKernelArgs returns the model store and properties used by the
+        // SIMD kernel.
+        //
+        ///////////////////////////////////////////////////////////////////////
+        GMMKernelArgs<stat_type> getKernelArgs() const
+        {
+            GMMKernelArgs<stat_type> args;
+            args.weights           = mWeights;
+            args.means             = mMeans;
+            args.variances         = mVariances;
+            args.numActive         = mNumActive;
+            args.numPixels         = mNumPixels;
+            args.numChannels       = mNumChannels;
+            args.numGaussians      = mNumGaussians;
+            args.gaussianStride    = mGaussianStride;
+            args.learningRate      = mLearningRate;
+            args.initialWeight     = mInitialWeight;
+            args.initialVariance   = mInitialVariance;
+            args.varianceThreshold = mVarianceThreshold;
+            args.minBGRatio        = mMinimumBackgroundRatio;
+#ifdef __arm__
+            args.eps               = std::numeric_limits<stat_type>::epsilon();
+#else
+            args.eps               = mfl_scalar::Eps<stat_type>(1.0);
+#endif
+            return args;
+        }
+
         ///////////////////////////////////////////////////////////////////////
         //
-        // set mGMMPtr to the gaussian mixture model vector. 
+        // set mStorePtr to the store holding the gaussian mixture models of
+        // all pixels. The store must be allocated for the current dims.
         //
         ///////////////////////////////////////////////////////////////////////
-        void setGMMVec(GMMVector * gmm)
+        void setStore(GaussianMixtureStore<stat_type> * store)
         {
-            mGMMPtr = gmm;
+            VISION_ASSERT(store->getNumPixels() == mNumPixels &&
+                          store->getNumChannels() == mNumChannels);
+            mStorePtr       = store;
+            mWeights        = store->weights();
+            mMeans          = store->means();
+            mVariances      = store->variances();
+            mNumActive      = store->numActive();
+            mGaussianStride = store->getGaussianStride();
         }
 
         ///////////////////////////////////////////////////////////////////////
-        // 
-        // Set input data for functor. 
+        //
+        // Set input data for functor.
         //
         ///////////////////////////////////////////////////////////////////////
-        inline void setStepInput(const image_type * image, stat_type learningRate)
+        inline void setStepInput(const image_type * image, stat_type learningRate,
+                                 bool isRowMajor)
         {
             mImage = image;
             mLearningRate = learningRate;
+            mIsRowMajor = isRowMajor;
         }
 
         ///////////////////////////////////////////////////////////////////////
@@ -575,14 +535,14 @@ namespace vision
         {
             mForegroundMask = output;
         }
-        
+
         ///////////////////////////////////////////////////////////////////////
         //
         // Set runtime properties. These properties need to be set right before
         // the algorithm is run (stepped).
         //
-        ///////////////////////////////////////////////////////////////////////        
-        void setProperties(mwSize numGaussians, 
+        ///////////////////////////////////////////////////////////////////////
+        void setProperties(mwSize numGaussians,
                            stat_type initialVariance,
                            stat_type initialWeight,
                            stat_type varianceThreshold,
@@ -592,15 +552,40 @@ namespace vision
             mInitialVariance = initialVariance;
             mInitialWeight   = initialWeight;
             mVarianceThreshold = varianceThreshold;
-            mMinimumBackgroundRatio = minBGRatio;            
+            mMinimumBackgroundRatio = minBGRatio;
         }
-        
+
+        ///////////////////////////////////////////////////////////////////////
+        //
+        // Set the number of pixels per tile. The tile size is rounded up to a
+        // multiple of FOREGROUND_DETECTOR_TILE_ALIGNMENT pixels.
+        //
+        ///////////////////////////////////////////////////////////////////////
+        void setTileSize(mwSize tileSize)
+        {
+            const mwSize alignment = FOREGROUND_DETECTOR_TILE_ALIGNMENT;
+            tileSize  = std::max(tileSize, static_cast<mwSize>(1));
+            mTileSize = (tileSize + alignment - 1) / alignment * alignment;
+        }
+
+        ///////////////////////////////////////////////////////////////////////
+        mwSize getTileSize()
+        {
+            return mTileSize;
+        }
+
+        ///////////////////////////////////////////////////////////////////////
+        mwSize getNumTiles()
+        {
+            return (mNumPixels + mTileSize - 1) / mTileSize;
+        }
+
         ///////////////////////////////////////////////////////////////////////
         Dims getDims()
         {
             return mDims;
         }
-        
+
         ///////////////////////////////////////////////////////////////////////
         mwSize getNumGaussians()
         {
@@ -618,15 +603,22 @@ namespace vision
         {
             return mNumPixels;
         }
-        
-        
+
+
       private: // data members
-     
-        GMMVector * mGMMPtr; // pointer to contain holding every mixture model
-        Dims mDims;          // dimension info 
+
+        GaussianMixtureStore<stat_type> * mStorePtr; // holds every mixture model
+        stat_type * mWeights;      // flat state arrays of mStorePtr
+        stat_type * mMeans;
+        stat_type * mVariances;
+        int32_T   * mNumActive;
+        mwSize mGaussianStride;    // distance between two gaussians of a pixel
+        mwSize mTileSize;          // number of pixels per tile
+        bool mIsRowMajor;          // layout of the input image
+        Dims mDims;          // dimension info
         const image_type * mImage; // pointer to input image
         stat_type mLearningRate;   // learning rate
-        boolean_T * mForegroundMask;     // pointer to output mask        
+        boolean_T * mForegroundMask;     // pointer to output mask
         mwSize mNumGaussians;
         mwSize mNumPixels;
         mwSize mNumChannels;
@@ -11,6 +11,8 @@
 #include "vision_defines.h"
 #include "ForegroundDetectorTraits.hpp"
 #include "ForegroundDetectorFunctor.hpp"
+#include "ForegroundDetectorFixedPointFunctor.hpp"
+#include "GaussianMixtureStore.hpp"
 
 
 #ifndef __arm__
@@ -22,6 +24,8 @@
 #include <tbb/cache_aligned_allocator.h>
 #include <tbb/scalable_allocator.h>
 #include <tbb/blocked_range.h>
+#include <tbb/task_group.h>
+#include <tbb/task_arena.h>
 #endif
 
 // system includes
@@ -31,25 +35,55 @@
 
 namespace vision
 {
+
+    ///////////////////////////////////////////////////////////////////////////
+    //
+    //  ForegroundDetectorFunctorTraits selects the algorithm functor and the
+    //  type of the properties and learning rate for <image_type, stat_type>.
+    //  uint16 statistics use the fixed point functor with single precision
+    //  properties.
+    //
+    ///////////////////////////////////////////////////////////////////////////
+    template <typename image_type, typename stat_type>
+    struct ForegroundDetectorFunctorTraits
+    {
+        typedef ForegroundDetectorFunctor<image_type, stat_type> Functor;
+        typedef stat_type param_type;
+    };
+
+    template <>
+    struct ForegroundDetectorFunctorTraits<uint8_T, uint16_T>
+    {
+        typedef ForegroundDetectorFixedPointFunctor Functor;
+        typedef float param_type;
+    };
     
+    ///////////////////////////////////////////////////////////////////////////
+    //
+    //  NUMA placement of the detectors initialized afterwards, see
+    //  foregroundDetector_setNumaPolicy
+    //
+    ///////////////////////////////////////////////////////////////////////////
+    LIBMWFOREGROUNDDETECTOR_API void setForegroundDetectorNumaPolicy(int32_T policy);
+    LIBMWFOREGROUNDDETECTOR_API int32_T getForegroundDetectorNumaPolicy();
+
     ///////////////////////////////////////////////////////////////////////////
     //
     //  ForegroundDetectorImpl contains the templatized implementation.  This
     //  class's methods are called through the ForegroundDetectorMImpl. 
     //
     ///////////////////////////////////////////////////////////////////////////    
+    template <typename image_type, typename stat_type>
+    struct ForegroundDetectorAsyncBody;
+
     template <typename image_type, typename stat_type>
     class LIBMWFOREGROUNDDETECTOR_API ForegroundDetectorImpl
     {
       public:
         
         typedef typename ForegroundDetectorTraits<stat_type>::Dims Dims;
-        
-        typedef typename ForegroundDetectorTraits<stat_type>::GaussianMixtureModel GaussianMixtureModel;
-        
-        typedef typename ForegroundDetectorTraits<stat_type>::GaussianIterator GaussianIterator;
-        
-        typedef typename ForegroundDetectorTraits<stat_type>::GMMVector GMMVector;
+        typedef typename ForegroundDetectorFunctorTraits<image_type, stat_type>::Functor Functor;
+        typedef typename ForegroundDetectorFunctorTraits<image_type, stat_type>::param_type param_type;
 		
 
         ///////////////////////////////////////////////////////////////////////
@@ -64,7 +98,10 @@ namespace vision
         // Destructor
         //
         ///////////////////////////////////////////////////////////////////////
-        ~ForegroundDetectorImpl(){}
+        ~ForegroundDetectorImpl()
+        {
+            waitAsyncImpl();
+        }
         
         
         ///////////////////////////////////////////////////////////////////////
@@ -74,10 +111,32 @@ namespace vision
         /////////////////////////////////////////////////////////////////////// 
         void initializeImpl(Dims dims,
                             mwSize numGaussians, 
-                            stat_type initialVariance,
-                            stat_type initialWeight, 
-                            stat_type varianceThreshold,
-                            stat_type minBGRatio);
+                            param_type initialVariance,
+                            param_type initialWeight, 
+                            param_type varianceThreshold,
+                            param_type minBGRatio);
+
+        ///////////////////////////////////////////////////////////////////////
+        //
+        // initializeImpl with a region of interest and a downsample factor:
+        // the image is cut into downsampleFactor by downsampleFactor cells
+        // and one pixel of each cell that overlaps the [M N] roiMask (column
+        // major unless isRoiRowMajor) is modeled, the first pixel of the
+        // cell inside the ROI in column major order. Each pixel of the ROI
+        // takes the decision of the modeled pixel of its cell, and pixels
+        // outside the ROI are background. A NULL roiMask selects the whole
+        // image, whose cells are modeled at their top left pixel.
+        //
+        ///////////////////////////////////////////////////////////////////////
+        void initializeImpl(Dims dims,
+                            mwSize numGaussians,
+                            param_type initialVariance,
+                            param_type initialWeight,
+                            param_type varianceThreshold,
+                            param_type minBGRatio,
+                            const boolean_T * roiMask,
+                            bool isRoiRowMajor,
+                            mwSize downsampleFactor);
 							
         
         ////////////////////////////////////////////////////////////////////////
@@ -87,6 +146,65 @@ namespace vision
         //
         ////////////////////////////////////////////////////////////////////////  
         void setOutputBuffer(boolean_T * fgMask);
+
+        ////////////////////////////////////////////////////////////////////////
+        //
+        // setPackedOutputBuffer
+        //     - sets up a bit-packed output buffer for step. Each image row
+        //       is packed in getPackedWordsPerRow(N) words, pixel (r, c) is
+        //       bit c%32 of word r*wordsPerRow + c/32 and the unused bits of
+        //       the last word of a row are 0. The layout does not depend on
+        //       the layout of the input image. setOutputBuffer switches back
+        //       to one boolean_T per pixel.
+        //
+        ////////////////////////////////////////////////////////////////////////
+        void setPackedOutputBuffer(uint32_T * packedMask);
+
+        static mwSize getPackedWordsPerRow(mwSize numCols)
+        {
+            return (numCols + 31) / 32;
+        }
+
+        ////////////////////////////////////////////////////////////////////////
+        //
+        // estimateMemory: bytes used by a detector initialized with dims,
+        //     numGaussians and downsampleFactor, at the peak of a step and
+        //     kept between steps. Both are the models of the store, allocated
+        //     by initializeImpl, plus, with a ROI or a downsample factor, the
+        //     model map and the gathered image and mask, counting every grid
+        //     pixel as modeled. useAsync adds the frame copy and the two
+        //     masks of the asynchronous steps.
+        //
+        ////////////////////////////////////////////////////////////////////////
+        static void estimateMemory(const Dims & dims, mwSize numGaussians,
+                                   mwSize downsampleFactor, bool useROI, bool useAsync,
+                                   double & peakBytes, double & steadyBytes)
+        {
+            const mwSize numRows = dims.size() > 0 ? dims[0] : 0;
+            const mwSize numCols = dims.size() > 1 ? dims[1] : 1;
+            const mwSize numChannels = dims.size() > 2 ? dims[2] : 1;
+            const mwSize factor = downsampleFactor > 1 ? downsampleFactor : 1;
+            const double numImagePixels = (double)numRows * numCols;
+
+            mwSize numPixels = numRows * numCols;
+            double bytes = 0;
+            if (useROI || factor > 1)
+            {
+                numPixels = ((numRows + factor - 1) / factor) * ((numCols + factor - 1) / factor);
+                bytes += numImagePixels * sizeof(int32_T) +
+                    (double)numPixels * (2 * sizeof(mwSize) +
+                                         numChannels * sizeof(image_type) + sizeof(boolean_T));
+            }
+            bytes += (double)GaussianMixtureStore<stat_type>::getArenaSize(numPixels, numChannels,
+                                                                          numGaussians);
+            if (useAsync)
+            {
+                bytes += numImagePixels * (numChannels * sizeof(image_type) + 2 * sizeof(boolean_T));
+            }
+
+            peakBytes = bytes;
+            steadyBytes = bytes;
+        }
       
 		
         ////////////////////////////////////////////////////////////////////////
@@ -97,11 +215,58 @@ namespace vision
         //
         ////////////////////////////////////////////////////////////////////////  
         void stepImpl(const image_type * image, 
-                      stat_type learningRate);
+                      param_type learningRate);
        
 
         void stepImplRowMajor(const image_type * image, 
-                      stat_type learningRate);        
+                      param_type learningRate);        
+
+        ////////////////////////////////////////////////////////////////////////
+        //
+        //  Asynchronous step implementation
+        //     - stepAsyncImpl copies the frame, waits for the previous
+        //       asynchronous step and starts the current one in the
+        //       background. It returns the mask of the previous frame, or NULL
+        //       for the first frame, which stays valid until the next call.
+        //       The masks are double buffered inside the detector and replace
+        //       the buffer set by setOutputBuffer or setPackedOutputBuffer.
+        //     - waitAsyncImpl blocks until the pending step completes and
+        //       returns its mask, or NULL if no step is pending.
+        //     On __arm__ builds the step runs before stepAsyncImpl returns.
+        //     The other methods wait for the pending step first.
+        //
+        ////////////////////////////////////////////////////////////////////////
+        const boolean_T * stepAsyncImpl(const image_type * image,
+                                        param_type learningRate,
+                                        bool isRowMajor);
+
+        const boolean_T * waitAsyncImpl();
+
+        ////////////////////////////////////////////////////////////////////////
+        //
+        //  Batch step implementation
+        //     - steps numStreams detectors on their own frame in a single
+        //       parallel loop. The tiles of all detectors form one iteration
+        //       space, so a task processes consecutive tiles of one detector
+        //       and the load is balanced over the whole batch.
+        //
+        ////////////////////////////////////////////////////////////////////////
+        static void stepBatchImpl(ForegroundDetectorImpl ** detectors,
+                                  mwSize numStreams,
+                                  const image_type ** images,
+                                  boolean_T ** fgMasks,
+                                  const param_type * learningRates,
+                                  bool isRowMajor);
+
+        ////////////////////////////////////////////////////////////////////////
+        //
+        //  setGrainSizeImpl
+        //     - sets the number of pixels processed by a task. It is rounded
+        //       up to a multiple of the cache line size; 0 selects the default.
+        //
+        ////////////////////////////////////////////////////////////////////////
+        void setGrainSizeImpl(mwSize grainSize);
+
         ////////////////////////////////////////////////////////////////////////
         //
         //  getStates implementation 
@@ -112,19 +277,6 @@ namespace vision
         void getStatesImpl(stat_type* weights, stat_type* means, stat_type* variances, int * numActive);
 
 	
-        ///////////////////////////////////////////////////////////////////////
-        //
-        // getGMMStates: Extracts the state information from a specific gaussian  
-        // mixture model.
-        // 
-        ///////////////////////////////////////////////////////////////////////        
-
-        void getGMMStates(GaussianMixtureModel & gmm, 
-                          stat_type * weights, 
-                          stat_type * means,
-                          stat_type * variances,
-                          int * numActive);					  
-		
         ///////////////////////////////////////////////////////////////////////       
         // 
         // setStatesImpl: 
@@ -134,20 +286,23 @@ namespace vision
         void setStatesImpl(stat_type* weights, stat_type* means, stat_type* variances, int * numActive);
 
 		
-        ///////////////////////////////////////////////////////////////////////       
-        // 
-        // setGMMStates: used to set internal detector states for a specific 
-        // gaussian mixture model. Used for save/load/clone.
+        ////////////////////////////////////////////////////////////////////////
         //
-        ///////////////////////////////////////////////////////////////////////    
-        void setGMMStates(GaussianMixtureModel & gmm, 
-                          int numActiveGaussians,
-                          const stat_type * weights, 
-                          const stat_type * means,
-                          const stat_type * vars);
-						  
+        //  Snapshot implementation
+        //     - saves the mixture models of all pixels to a binary buffer of
+        //       getSnapshotSizeImpl() bytes, or to a file, and restores them
+        //       into a detector initialized with the same image size, number
+        //       of gaussians and region of interest. The load functions
+        //       return false, and leave the states unchanged, when the
+        //       snapshot does not match the detector.
+        //
+        ////////////////////////////////////////////////////////////////////////
+        mwSize getSnapshotSizeImpl() const;
+        void saveSnapshotImpl(void * buffer);
+        bool loadSnapshotImpl(const void * buffer, mwSize size);
+        bool saveSnapshotFileImpl(const char * filename);
+        bool loadSnapshotFileImpl(const char * filename);
 
-		
         ////////////////////////////////////////////////////////////////////////
         //
         //  Reset implementation - resets the internal gaussian mixture model back
@@ -164,7 +319,14 @@ namespace vision
         //////////////////////////////////////////////////////////////////////// 
         void releaseImpl()        
         {
-            mGMMVec.clear();
+            waitAsyncImpl();
+            mStore.release();
+            releaseModelMap();
+            std::vector<image_type>().swap(mAsyncImage);
+            std::vector<boolean_T>().swap(mAsyncMasks[0]);
+            std::vector<boolean_T>().swap(mAsyncMasks[1]);
+            std::vector<boolean_T>().swap(mUnpackedMask);
+            mPackedMask = NULL;
         }
   
 
@@ -180,21 +342,104 @@ namespace vision
             return mFtor.getNumChannels();
         }
 
+      private:
+        ////////////////////////////////////////////////////////////////////////
+        //
+        // beginStep/endStep: set up the functor input and output before the
+        // parallel loop. With a model map, the modeled pixels are gathered in
+        // a compact image before, and the mask is expanded to the image size
+        // after.
+        //
+        ////////////////////////////////////////////////////////////////////////
+        void beginStep(const image_type * image, param_type learningRate,
+                       bool isRowMajor);
+        void endStep(bool isRowMajor);
+
+        void releaseModelMap();
+
+        // packs the mask of the last step into mPackedMask
+        void packMask(bool isRowMajor);
+
+        // runs the algorithm on a frame with the current output buffer
+        void runStep(const image_type * image, param_type learningRate,
+                     bool isRowMajor);
+
+#ifndef __arm__
+        // runs body over the tiles of the functor with mPartitioner, in
+        // mArena if the detector has one
+        template <typename Body>
+        void runTiles(const Body & body);
+#endif
+
+        friend struct ForegroundDetectorAsyncBody<image_type, stat_type>;
+
       private:// data members
         ////////////////////////////////////////////////////////////////////////        
         //
         // mFtor: a functor that contains the actual algorithm implementation
         //
         ////////////////////////////////////////////////////////////////////////
-        ForegroundDetectorFunctor<image_type, stat_type> mFtor;
+        Functor mFtor;
 
         ////////////////////////////////////////////////////////////////////////
         //
-        // mGMMVec: A vector of gaussian mixture models.  Holds the GMM models
-        // for all pixels.
+        // mStore: Holds the gaussian mixture models for all pixels in flat
+        // contiguous arrays with numGaussians slots per pixel.
         //
         ////////////////////////////////////////////////////////////////////////
-        GMMVector mGMMVec;              
+        GaussianMixtureStore<stat_type> mStore;
+
+        ////////////////////////////////////////////////////////////////////////
+        //
+        // Model map used with a region of interest or a downsample factor.
+        // mColMajorOffsets and mRowMajorOffsets hold the image offset of each
+        // modeled pixel in both layouts, and mOutputMap the modeled pixel that
+        // decides each image pixel, column major, or -1 for background.
+        //
+        ////////////////////////////////////////////////////////////////////////
+        bool mUseModelMap;
+        mwSize mImageRows;
+        mwSize mImageCols;
+        std::vector<mwSize>     mColMajorOffsets;
+        std::vector<mwSize>     mRowMajorOffsets;
+        std::vector<int32_T>    mOutputMap;
+        std::vector<image_type> mModelImage;
+        std::vector<boolean_T>  mModelMask;
+        boolean_T * mFgMask;    // output mask of the current step
+        uint32_T  * mPackedMask;             // bit-packed output, or NULL
+        std::vector<boolean_T> mUnpackedMask; // mask packed into mPackedMask
+
+        ////////////////////////////////////////////////////////////////////////
+        //
+        // Asynchronous step: copy of the pending frame, double buffered masks
+        // with mAsyncIndex the buffer of the last started step.
+        //
+        ////////////////////////////////////////////////////////////////////////
+        std::vector<image_type> mAsyncImage;
+        std::vector<boolean_T>  mAsyncMasks[2];
+        int        mAsyncIndex;
+        bool       mIsAsyncPending;
+        param_type mAsyncLearningRate;
+        bool       mIsAsyncRowMajor;
+
+#ifndef __arm__
+        ////////////////////////////////////////////////////////////////////////
+        //
+        // mPartitioner: retained across steps so that each tile is processed
+        // by the same thread from one frame to the next, and its states stay
+        // in that thread's cache.
+        //
+        ////////////////////////////////////////////////////////////////////////
+        tbb::affinity_partitioner mPartitioner;
+
+        // runs the asynchronous steps
+        tbb::task_group mAsyncTasks;
+
+        // arena of the NUMA node of the detector, or NULL to run in the
+        // arena of the caller. Owned by the process, see
+        // FOREGROUND_DETECTOR_NUMA_NODE_ARENAS.
+        tbb::task_arena * mArena;
+#endif
        
     };  
 
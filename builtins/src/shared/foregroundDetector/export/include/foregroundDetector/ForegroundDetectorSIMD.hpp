@@ -0,0 +1,570 @@
+////////////////////////////////////////////////////////////////////////////////
+//  This header contains the ForegroundDetectorBlockKernel class which runs the
+//  Stauffer-Grimson update on a block of adjacent pixels with SIMD
+//  instructions. It is used by the ForegroundDetectorFunctor for single
+//  precision statistics.
+//
+//  A block holds one pixel per SIMD lane: 8 with AVX, 4 with SSE2 or NEON.
+//  Since slot k of adjacent pixels is contiguous in the GaussianMixtureStore,
+//  the statistics of a block are loaded and stored directly. The per-pixel
+//  branches of the scalar algorithm become lane masks:
+//
+//      - every active gaussian is tested and the first match of each lane is
+//        recorded,
+//      - the matching or the new gaussian is written with masked stores,
+//      - the sort percolates the matching gaussian up one slot per step,
+//        from the last slot to the first,
+//      - the background ratio test accumulates the weights of all lanes and
+//        records the decision of each lane as soon as it is known.
+//
+//  All lanes apply the same floating point operations, in the same order, as
+//  the scalar algorithm, so both produce identical results.
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef FOREGROUND_DETECTOR_SIMD_HPP
+#define FOREGROUND_DETECTOR_SIMD_HPP
+
+// local includes
+#include "ForegroundDetectorUtil.hpp"
+
+// system includes
+#include <cmath>
+
+#if defined(__ARM_NEON__) || defined(__ARM_NEON)
+#include <arm_neon.h>
+#define FOREGROUND_DETECTOR_NEON 1
+#elif defined(__AVX__)
+#include <immintrin.h>
+#define FOREGROUND_DETECTOR_AVX 1
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define FOREGROUND_DETECTOR_SSE2 1
+#endif
+
+#if defined(FOREGROUND_DETECTOR_NEON) || defined(FOREGROUND_DETECTOR_AVX) || \
+    defined(FOREGROUND_DETECTOR_SSE2)
+#define FOREGROUND_DETECTOR_SIMD 1
+#endif
+
+// Images with more channels are processed by the scalar algorithm
+#define FOREGROUND_DETECTOR_SIMD_MAX_CHANNELS 4
+
+namespace vision
+{
+
+    ////////////////////////////////////////////////////////////////////////////
+    //
+    // GMMKernelArgs: model store and algorithm properties used by the kernel
+    //
+    ////////////////////////////////////////////////////////////////////////////
+    template <typename stat_type>
+    struct GMMKernelArgs
+    {
+        stat_type * weights;
+        stat_type * means;
+        stat_type * variances;
+        int32_T   * numActive;
+        mwSize numPixels;
+        mwSize numChannels;
+        mwSize numGaussians;
+        mwSize gaussianStride;
+        stat_type learningRate;
+        stat_type initialWeight;
+        stat_type initialVariance;
+        stat_type varianceThreshold;
+        stat_type minBGRatio;
+        stat_type eps;
+    };
+
+    ////////////////////////////////////////////////////////////////////////////
+    //
+    // ForegroundDetectorBlockKernel: the generic version processes no pixel
+    // and leaves the whole range to the scalar algorithm.
+    //
+    ////////////////////////////////////////////////////////////////////////////
+    template <typename image_type, typename stat_type>
+    struct ForegroundDetectorBlockKernel
+    {
+        // Returns the first pixel of [begin, end) that was not processed
+        static mwSize run(const GMMKernelArgs<stat_type> &,
+                          mwSize begin, mwSize,
+                          const image_type *, mwSize, mwSize,
+                          boolean_T *)
+        {
+            return begin;
+        }
+    };
+
+#ifdef FOREGROUND_DETECTOR_SIMD
+
+    ////////////////////////////////////////////////////////////////////////////
+    //
+    // FloatPack: single precision lanes and the lane masks used by the kernel
+    //
+    ////////////////////////////////////////////////////////////////////////////
+#if defined(FOREGROUND_DETECTOR_AVX)
+
+    struct FloatPack
+    {
+        typedef __m256 type;
+        typedef __m256 mask_type;
+        enum { width = 8 };
+
+        static inline type load(const float * p)     { return _mm256_loadu_ps(p); }
+        static inline void store(float * p, type a)  { _mm256_storeu_ps(p, a); }
+        static inline type set1(float a)             { return _mm256_set1_ps(a); }
+        static inline type loadInt(const int32_T * p)
+        {
+            return _mm256_cvtepi32_ps(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(p)));
+        }
+        static inline void storeInt(int32_T * p, type a)
+        {
+            _mm256_storeu_si256(reinterpret_cast<__m256i *>(p), _mm256_cvtps_epi32(a));
+        }
+
+        static inline type add(type a, type b)  { return _mm256_add_ps(a, b); }
+        static inline type sub(type a, type b)  { return _mm256_sub_ps(a, b); }
+        static inline type mul(type a, type b)  { return _mm256_mul_ps(a, b); }
+        static inline type div(type a, type b)  { return _mm256_div_ps(a, b); }
+        static inline type sqrt(type a)         { return _mm256_sqrt_ps(a); }
+
+        static inline mask_type lt(type a, type b) { return _mm256_cmp_ps(a, b, _CMP_LT_OQ); }
+        static inline mask_type le(type a, type b) { return _mm256_cmp_ps(a, b, _CMP_LE_OQ); }
+        static inline mask_type gt(type a, type b) { return _mm256_cmp_ps(a, b, _CMP_GT_OQ); }
+        static inline mask_type eq(type a, type b) { return _mm256_cmp_ps(a, b, _CMP_EQ_OQ); }
+
+        static inline mask_type none()                           { return _mm256_setzero_ps(); }
+        static inline mask_type both(mask_type a, mask_type b)   { return _mm256_and_ps(a, b); }
+        static inline mask_type either(mask_type a, mask_type b) { return _mm256_or_ps(a, b); }
+        // a and not b
+        static inline mask_type butNot(mask_type a, mask_type b) { return _mm256_andnot_ps(b, a); }
+        // a where m is set, b elsewhere
+        static inline type select(mask_type m, type a, type b)   { return _mm256_blendv_ps(b, a, m); }
+        static inline int bits(mask_type m)                      { return _mm256_movemask_ps(m); }
+    };
+
+#elif defined(FOREGROUND_DETECTOR_SSE2)
+
+    struct FloatPack
+    {
+        typedef __m128 type;
+        typedef __m128 mask_type;
+        enum { width = 4 };
+
+        static inline type load(const float * p)     { return _mm_loadu_ps(p); }
+        static inline void store(float * p, type a)  { _mm_storeu_ps(p, a); }
+        static inline type set1(float a)             { return _mm_set1_ps(a); }
+        static inline type loadInt(const int32_T * p)
+        {
+            return _mm_cvtepi32_ps(_mm_loadu_si128(reinterpret_cast<const __m128i *>(p)));
+        }
+        static inline void storeInt(int32_T * p, type a)
+        {
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(p), _mm_cvtps_epi32(a));
+        }
+
+        static inline type add(type a, type b)  { return _mm_add_ps(a, b); }
+        static inline type sub(type a, type b)  { return _mm_sub_ps(a, b); }
+        static inline type mul(type a, type b)  { return _mm_mul_ps(a, b); }
+        static inline type div(type a, type b)  { return _mm_div_ps(a, b); }
+        static inline type sqrt(type a)         { return _mm_sqrt_ps(a); }
+
+        static inline mask_type lt(type a, type b) { return _mm_cmplt_ps(a, b); }
+        static inline mask_type le(type a, type b) { return _mm_cmple_ps(a, b); }
+        static inline mask_type gt(type a, type b) { return _mm_cmpgt_ps(a, b); }
+        static inline mask_type eq(type a, type b) { return _mm_cmpeq_ps(a, b); }
+
+        static inline mask_type none()                           { return _mm_setzero_ps(); }
+        static inline mask_type both(mask_type a, mask_type b)   { return _mm_and_ps(a, b); }
+        static inline mask_type either(mask_type a, mask_type b) { return _mm_or_ps(a, b); }
+        // a and not b
+        static inline mask_type butNot(mask_type a, mask_type b) { return _mm_andnot_ps(b, a); }
+        // a where m is set, b elsewhere
+        static inline type select(mask_type m, type a, type b)
+        {
+            return _mm_or_ps(_mm_and_ps(m, a), _mm_andnot_ps(m, b));
+        }
+        static inline int bits(mask_type m)                      { return _mm_movemask_ps(m); }
+    };
+
+#elif defined(FOREGROUND_DETECTOR_NEON)
+
+    struct FloatPack
+    {
+        typedef float32x4_t type;
+        typedef uint32x4_t  mask_type;
+        enum { width = 4 };
+
+        static inline type load(const float * p)     { return vld1q_f32(p); }
+        static inline void store(float * p, type a)  { vst1q_f32(p, a); }
+        static inline type set1(float a)             { return vdupq_n_f32(a); }
+        static inline type loadInt(const int32_T * p)
+        {
+            return vcvtq_f32_s32(vld1q_s32(reinterpret_cast<const int32_t *>(p)));
+        }
+        static inline void storeInt(int32_T * p, type a)
+        {
+            vst1q_s32(reinterpret_cast<int32_t *>(p), vcvtq_s32_f32(a));
+        }
+
+        static inline type add(type a, type b)  { return vaddq_f32(a, b); }
+        static inline type sub(type a, type b)  { return vsubq_f32(a, b); }
+        static inline type mul(type a, type b)  { return vmulq_f32(a, b); }
+#ifdef __aarch64__
+        static inline type div(type a, type b)  { return vdivq_f32(a, b); }
+        static inline type sqrt(type a)         { return vsqrtq_f32(a); }
+#else
+        // ARMv7 NEON only has estimates, compute each lane exactly instead
+        static inline type div(type a, type b)
+        {
+            float x[4], y[4];
+            vst1q_f32(x, a);
+            vst1q_f32(y, b);
+            for (int i = 0; i < 4; ++i)
+                x[i] = x[i] / y[i];
+            return vld1q_f32(x);
+        }
+        static inline type sqrt(type a)
+        {
+            float x[4];
+            vst1q_f32(x, a);
+            for (int i = 0; i < 4; ++i)
+                x[i] = std::sqrt(x[i]);
+            return vld1q_f32(x);
+        }
+#endif
+
+        static inline mask_type lt(type a, type b) { return vcltq_f32(a, b); }
+        static inline mask_type le(type a, type b) { return vcleq_f32(a, b); }
+        static inline mask_type gt(type a, type b) { return vcgtq_f32(a, b); }
+        static inline mask_type eq(type a, type b) { return vceqq_f32(a, b); }
+
+        static inline mask_type none()                           { return vdupq_n_u32(0); }
+        static inline mask_type both(mask_type a, mask_type b)   { return vandq_u32(a, b); }
+        static inline mask_type either(mask_type a, mask_type b) { return vorrq_u32(a, b); }
+        // a and not b
+        static inline mask_type butNot(mask_type a, mask_type b) { return vbicq_u32(a, b); }
+        // a where m is set, b elsewhere
+        static inline type select(mask_type m, type a, type b)   { return vbslq_f32(m, a, b); }
+        static inline int bits(mask_type m)
+        {
+            return static_cast<int>((vgetq_lane_u32(m, 0) & 1) |
+                                    (vgetq_lane_u32(m, 1) & 2) |
+                                    (vgetq_lane_u32(m, 2) & 4) |
+                                    (vgetq_lane_u32(m, 3) & 8));
+        }
+    };
+
+#endif
+
+    ////////////////////////////////////////////////////////////////////////////
+    //
+    // ForegroundDetectorBlockKernel: single precision version
+    //
+    ////////////////////////////////////////////////////////////////////////////
+    template <typename image_type>
+    struct ForegroundDetectorBlockKernel<image_type, float>
+    {
+        typedef FloatPack P;
+        typedef P::type V;
+        typedef P::mask_type M;
+
+        ////////////////////////////////////////////////////////////////////////
+        //
+        // run: processes the pixels of [begin, end) in blocks of P::width
+        // pixels and returns the first pixel that was not processed. Channel
+        // c of pixel p is image[p*pixelStride + c*channelStride].
+        //
+        ////////////////////////////////////////////////////////////////////////
+        static mwSize run(const GMMKernelArgs<float> & args,
+                          mwSize begin, mwSize end,
+                          const image_type * image,
+                          mwSize channelStride, mwSize pixelStride,
+                          boolean_T * fgMask)
+        {
+            const mwSize width = P::width;
+            if (args.numChannels > FOREGROUND_DETECTOR_SIMD_MAX_CHANNELS)
+            {
+                return begin;
+            }
+
+            float pixels[FOREGROUND_DETECTOR_SIMD_MAX_CHANNELS * P::width];
+            for ( ; end - begin >= width; begin += width)
+            {
+                // gather the channels of the block
+                for (mwSize c = 0; c < args.numChannels; ++c)
+                {
+                    const image_type * src = image + begin*pixelStride + c*channelStride;
+                    for (mwSize i = 0; i < width; ++i)
+                    {
+                        pixels[c*width + i] = static_cast<float>(src[i*pixelStride]);
+                    }
+                }
+
+                detectForegroundBlock(args, begin, pixels, fgMask + begin);
+            }
+            return begin;
+        }
+
+        ////////////////////////////////////////////////////////////////////////
+        //
+        // detectForegroundBlock: runs the algorithm on pixels [p0, p0+width).
+        // pixels holds the channels of the block, one channel after another.
+        //
+        ////////////////////////////////////////////////////////////////////////
+        static void detectForegroundBlock(const GMMKernelArgs<float> & args,
+                                          mwSize p0,
+                                          const float * pixels,
+                                          boolean_T * fgMask)
+        {
+            const mwSize numPixels      = args.numPixels;
+            const mwSize numChannels    = args.numChannels;
+            const mwSize numGaussians   = args.numGaussians;
+            const mwSize gaussianStride = args.gaussianStride;
+
+            float * weights   = args.weights + p0;
+            float * means     = args.means + p0;
+            float * variances = args.variances + p0;
+
+            const V zero = P::set1(0.0f);
+            const V one  = P::set1(1.0f);
+            const M all  = P::eq(zero, zero);
+            const V learningRate = P::set1(args.learningRate);
+
+            V x[FOREGROUND_DETECTOR_SIMD_MAX_CHANNELS];
+            for (mwSize c = 0; c < numChannels; ++c)
+            {
+                x[c] = P::load(pixels + c*P::width);
+            }
+
+            V numActive = P::loadInt(args.numActive + p0);
+
+            // find the first matching gaussian of each lane
+            const V threshold = P::set1(args.varianceThreshold);
+            V matchID = numActive;
+            M found   = P::none();
+            for (mwSize k = 0; k < numGaussians; ++k)
+            {
+                const V kv = P::set1(static_cast<float>(k));
+                const M active = P::butNot(P::lt(kv, numActive), found);
+                if (!P::bits(active))
+                {
+                    break;
+                }
+
+                const float * mean     = means + k*gaussianStride;
+                const float * variance = variances + k*gaussianStride;
+                V sumDistance = zero;
+                V sumV = zero;
+                for (mwSize c = 0; c < numChannels; ++c)
+                {
+                    V distance = P::sub(x[c], P::load(mean + c*numPixels));
+                    sumDistance = P::add(sumDistance, P::mul(distance, distance));
+                }
+                for (mwSize c = 0; c < numChannels; ++c)
+                {
+                    sumV = P::add(sumV, P::load(variance + c*numPixels));
+                }
+
+                const M isMatch = P::both(active, P::lt(sumDistance, P::mul(threshold, sumV)));
+                matchID = P::select(isMatch, kv, matchID);
+                found   = P::either(found, isMatch);
+            }
+            const M notFound = P::butNot(all, found);
+
+            V scaleFactor = one;
+
+            // update the matching gaussians
+            if (P::bits(found))
+            {
+                V weight = zero;
+                for (mwSize k = 0; k < numGaussians; ++k)
+                {
+                    const M sel = P::both(found, P::eq(matchID, P::set1(static_cast<float>(k))));
+                    if (!P::bits(sel))
+                    {
+                        continue;
+                    }
+
+                    float * mean     = means + k*gaussianStride;
+                    float * variance = variances + k*gaussianStride;
+                    for (mwSize c = 0; c < numChannels; ++c)
+                    {
+                        V mu  = P::load(mean + c*numPixels);
+                        V var = P::load(variance + c*numPixels);
+                        V d   = P::sub(x[c], mu);
+                        V newMu  = P::add(mu, P::mul(learningRate, d));
+                        V newVar = P::add(var, P::mul(learningRate, P::sub(P::mul(d, d), var)));
+                        P::store(mean + c*numPixels, P::select(sel, newMu, mu));
+                        P::store(variance + c*numPixels, P::select(sel, newVar, var));
+                    }
+
+                    V w = P::load(weights + k*numPixels);
+                    weight = P::select(sel, w, weight);
+                    V newW = P::add(w, P::mul(learningRate, P::sub(one, w)));
+                    P::store(weights + k*numPixels, P::select(sel, newW, w));
+                }
+
+                scaleFactor = P::div(one, P::add(one, P::mul(learningRate, P::sub(one, weight))));
+            }
+
+            // replace the lowest ranked gaussian, or add a new one
+            if (P::bits(notFound))
+            {
+                const V initialWeight   = P::set1(args.initialWeight);
+                const V initialVariance = P::set1(args.initialVariance);
+
+                V weight = initialWeight;
+                const M full = P::both(notFound,
+                    P::eq(numActive, P::set1(static_cast<float>(numGaussians))));
+                if (P::bits(full))
+                {
+                    V lastWeight = P::load(weights + (numGaussians-1)*numPixels);
+                    weight    = P::select(full, P::sub(weight, lastWeight), weight);
+                    numActive = P::select(full, P::sub(numActive, one), numActive);
+                }
+
+                for (mwSize k = 0; k < numGaussians; ++k)
+                {
+                    const M sel = P::both(notFound, P::eq(numActive, P::set1(static_cast<float>(k))));
+                    if (!P::bits(sel))
+                    {
+                        continue;
+                    }
+
+                    float * mean     = means + k*gaussianStride;
+                    float * variance = variances + k*gaussianStride;
+                    for (mwSize c = 0; c < numChannels; ++c)
+                    {
+                        P::store(mean + c*numPixels,
+                                 P::select(sel, x[c], P::load(mean + c*numPixels)));
+                        P::store(variance + c*numPixels,
+                                 P::select(sel, initialVariance, P::load(variance + c*numPixels)));
+                    }
+                    P::store(weights + k*numPixels,
+                             P::select(sel, initialWeight, P::load(weights + k*numPixels)));
+                }
+
+                matchID   = P::select(notFound, numActive, matchID);
+                numActive = P::select(notFound, P::add(numActive, one), numActive);
+
+                V newScale = P::select(P::eq(numActive, one),
+                                       P::div(one, weight),
+                                       P::div(one, P::add(one, weight)));
+                scaleFactor = P::select(notFound, newScale, scaleFactor);
+            }
+            P::storeInt(args.numActive + p0, numActive);
+
+            // sort gaussians in mixture model from highest to lowest
+            for (mwSize k = numGaussians-1; k > 0 && P::bits(found); --k)
+            {
+                const V kv = P::set1(static_cast<float>(k));
+                const M sel = P::both(found, P::eq(matchID, kv));
+                if (!P::bits(sel))
+                {
+                    continue;
+                }
+
+                const M higher = P::both(sel, P::gt(rank(args, weights, variances, k),
+                                                    rank(args, weights, variances, k-1)));
+                if (!P::bits(higher))
+                {
+                    continue;
+                }
+
+                swapGaussians(weights + k*numPixels, weights + (k-1)*numPixels, higher);
+                for (mwSize c = 0; c < numChannels; ++c)
+                {
+                    mwSize offset = c*numPixels;
+                    swapGaussians(means + k*gaussianStride + offset,
+                                  means + (k-1)*gaussianStride + offset, higher);
+                    swapGaussians(variances + k*gaussianStride + offset,
+                                  variances + (k-1)*gaussianStride + offset, higher);
+                }
+                matchID = P::select(higher, P::sub(kv, one), matchID);
+            }
+
+            // normalize the weights
+            for (mwSize k = 0; k < numGaussians; ++k)
+            {
+                const M active = P::lt(P::set1(static_cast<float>(k)), numActive);
+                if (!P::bits(active))
+                {
+                    break;
+                }
+                V w = P::load(weights + k*numPixels);
+                P::store(weights + k*numPixels, P::select(active, P::mul(w, scaleFactor), w));
+            }
+
+            // determine if the pixels are foreground or background. The
+            // highest ranked gaussian is always background.
+            const V minBGRatio = P::set1(args.minBGRatio);
+            const V eps        = P::set1(args.eps);
+            M decided      = P::eq(matchID, zero);
+            M isForeground = P::none();
+            V wSum = zero;
+            for (mwSize k = 0; k < numGaussians; ++k)
+            {
+                const V kv = P::set1(static_cast<float>(k));
+                const M active = P::butNot(P::lt(kv, numActive), decided);
+                if (!P::bits(active))
+                {
+                    break;
+                }
+
+                wSum = P::add(wSum, P::load(weights + k*numPixels));
+                const M reached = P::both(active, P::le(P::sub(minBGRatio, wSum), eps));
+                const M isMatch = P::both(active, P::eq(matchID, kv));
+
+                // reaching the minimum background ratio before the matching
+                // gaussian means foreground; reaching the matching gaussian
+                // first means background
+                isForeground = P::either(isForeground, P::butNot(reached, isMatch));
+                decided      = P::either(decided, P::either(reached, isMatch));
+            }
+
+            const int fgBits = P::bits(isForeground);
+            for (int i = 0; i < P::width; ++i)
+            {
+                fgMask[i] = ((fgBits >> i) & 1) != 0;
+            }
+        }
+
+        ////////////////////////////////////////////////////////////////////////
+        //
+        // rank returns weight/sqrt(sum of variances) of gaussian k of each lane
+        //
+        ////////////////////////////////////////////////////////////////////////
+        static inline V rank(const GMMKernelArgs<float> & args,
+                             const float * weights, const float * variances,
+                             mwSize k)
+        {
+            const float * variance = variances + k*args.gaussianStride;
+            V sumV = P::set1(0.0f);
+            for (mwSize c = 0; c < args.numChannels; ++c)
+            {
+                sumV = P::add(sumV, P::load(variance + c*args.numPixels));
+            }
+            return P::div(P::load(weights + k*args.numPixels), P::sqrt(sumV));
+        }
+
+        ////////////////////////////////////////////////////////////////////////
+        //
+        // swapGaussians exchanges a and b in the lanes selected by sel
+        //
+        ////////////////////////////////////////////////////////////////////////
+        static inline void swapGaussians(float * a, float * b, M sel)
+        {
+            V va = P::load(a);
+            V vb = P::load(b);
+            P::store(a, P::select(sel, vb, va));
+            P::store(b, P::select(sel, va, vb));
+        }
+    };
+
+#endif // FOREGROUND_DETECTOR_SIMD
+
+} // end vision namespace
+
+#endif
@@ -0,0 +1,443 @@
+////////////////////////////////////////////////////////////////////////////////
+//  This header contains the GaussianMixtureStore class which holds the
+//  gaussian mixture models of all pixels in flat structure-of-arrays form.
+//
+//  Every pixel owns numGaussians slots. Slot k of all pixels is contiguous:
+//
+//      weight(k, p)      weights  [k*numPixels + p]
+//      mean(k, c, p)     means    [(k*numChannels + c)*numPixels + p]
+//      variance(k, c, p) variances[(k*numChannels + c)*numPixels + p]
+//
+//  which is the [M N numChannels numGaussians] layout of the saved states.
+//  Slots 0..numActive(p)-1 of a pixel are in use and sorted by decreasing
+//  rank. Consecutive pixels touch consecutive memory, so a range of pixels is
+//  updated with linear memory accesses and can be processed with SIMD.
+//
+//  All arrays live in a single arena allocation, each one starting on a
+//  cache line, so that setting up a detector allocates once and releasing
+//  it frees once.
+//
+//  Allocating the arena does not write to it. The pages of the arena are
+//  placed on the NUMA node of the thread that first writes them, so a
+//  detector whose pixels are cleared by the threads that update them, see
+//  allocateUninitialized and clear, keeps each tile on the node of its
+//  thread.
+//
+//  A snapshot is a binary copy of the store, a header followed by the
+//  numActive, weights, means and variances arrays in native byte order. It
+//  is restored into a store of the same size and statistics type.
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef GAUSSIAN_MIXTURE_STORE_HPP
+#define GAUSSIAN_MIXTURE_STORE_HPP
+
+// local includes
+#include "ForegroundDetectorUtil.hpp"
+
+#ifndef __arm__
+#include <tbb/cache_aligned_allocator.h>
+#endif
+
+// system includes
+#include <vector>
+#include <algorithm>
+#include <cstring>
+
+namespace vision
+{
+
+    ///////////////////////////////////////////////////////////////////////
+    //
+    // GaussianMixtureSnapshotHeader: first bytes of a snapshot
+    //
+    ///////////////////////////////////////////////////////////////////////
+    struct GaussianMixtureSnapshotHeader
+    {
+        uint32_T magic;        // FOREGROUND_DETECTOR_SNAPSHOT_MAGIC
+        uint32_T version;      // FOREGROUND_DETECTOR_SNAPSHOT_VERSION
+        uint32_T imageSize;    // sizeof(image_type) of the detector
+        uint32_T statSize;     // sizeof(stat_type)
+        uint32_T numPixels;
+        uint32_T numChannels;
+        uint32_T numGaussians;
+        uint32_T reserved;
+    };
+
+#define FOREGROUND_DETECTOR_SNAPSHOT_MAGIC   0x44474d46 /* "FMGD" */
+#define FOREGROUND_DETECTOR_SNAPSHOT_VERSION 1
+
+#ifndef __arm__
+    ///////////////////////////////////////////////////////////////////////
+    //
+    // UninitializedCacheAlignedAllocator: cache aligned allocator whose
+    // containers leave new elements default-initialized, i.e. unwritten
+    //
+    ///////////////////////////////////////////////////////////////////////
+    template <typename T>
+    class UninitializedCacheAlignedAllocator : public tbb::cache_aligned_allocator<T>
+    {
+      public:
+        template <typename U> struct rebind
+        {
+            typedef UninitializedCacheAlignedAllocator<U> other;
+        };
+
+        UninitializedCacheAlignedAllocator() {}
+
+        template <typename U>
+        UninitializedCacheAlignedAllocator(const UninitializedCacheAlignedAllocator<U> & other)
+            : tbb::cache_aligned_allocator<T>(other)
+        {
+        }
+
+        template <typename U>
+        void construct(U * p)
+        {
+            ::new (static_cast<void *>(p)) U;
+        }
+
+        template <typename U, typename V>
+        void construct(U * p, const V & value)
+        {
+            ::new (static_cast<void *>(p)) U(value);
+        }
+    };
+#endif
+
+    template <typename stat_type>
+    class GaussianMixtureStore
+    {
+      public:
+
+#ifdef __arm__
+        typedef std::vector<char> Arena;
+#else
+        typedef std::vector<char, UninitializedCacheAlignedAllocator<char> > Arena;
+#endif
+
+        GaussianMixtureStore()
+            : mNumPixels(0), mNumChannels(0), mNumGaussians(0),
+              mWeights(NULL), mMeans(NULL), mVariances(NULL), mNumActive(NULL)
+        {
+        }
+
+        // copies point to their own arena
+        GaussianMixtureStore(const GaussianMixtureStore & other)
+            : mNumPixels(0), mNumChannels(0), mNumGaussians(0),
+              mWeights(NULL), mMeans(NULL), mVariances(NULL), mNumActive(NULL)
+        {
+            *this = other;
+        }
+
+        GaussianMixtureStore & operator=(const GaussianMixtureStore & other)
+        {
+            if (this != &other)
+            {
+                mArena = other.mArena;
+                layout(other.mNumPixels, other.mNumChannels, other.mNumGaussians);
+            }
+            return *this;
+        }
+
+        ///////////////////////////////////////////////////////////////////////
+        //
+        // allocate: pre-allocates the slots of all pixels. All mixture models
+        // are empty afterwards.
+        //
+        ///////////////////////////////////////////////////////////////////////
+        void allocate(mwSize numPixels, mwSize numChannels, mwSize numGaussians)
+        {
+            allocateUninitialized(numPixels, numChannels, numGaussians);
+            clear(0, numPixels);
+        }
+
+        ///////////////////////////////////////////////////////////////////////
+        //
+        // allocateUninitialized: pre-allocates the slots of all pixels
+        // without writing them. The states of a pixel are undefined until
+        // clear has been called on it.
+        //
+        ///////////////////////////////////////////////////////////////////////
+        void allocateUninitialized(mwSize numPixels, mwSize numChannels, mwSize numGaussians)
+        {
+            // the arena is reused when it is large enough
+            const mwSize arenaSize = getArenaSize(numPixels, numChannels, numGaussians);
+            if (mArena.size() < arenaSize)
+                Arena(arenaSize).swap(mArena);
+
+            layout(numPixels, numChannels, numGaussians);
+        }
+
+        ///////////////////////////////////////////////////////////////////////
+        //
+        // clear: empties the mixture models of pixels [begin, end) and zeros
+        // all of their slots
+        //
+        ///////////////////////////////////////////////////////////////////////
+        void clear(mwSize begin, mwSize end)
+        {
+            if (begin >= end)
+                return;
+
+            for (mwSize k = 0; k < mNumGaussians; ++k)
+            {
+                stat_type * weights = mWeights + k*mNumPixels;
+                std::fill(weights + begin, weights + end, stat_type(0));
+            }
+            for (mwSize i = 0; i < mNumGaussians*mNumChannels; ++i)
+            {
+                stat_type * means     = mMeans + i*mNumPixels;
+                stat_type * variances = mVariances + i*mNumPixels;
+                std::fill(means + begin, means + end, stat_type(0));
+                std::fill(variances + begin, variances + end, stat_type(0));
+            }
+            std::fill(mNumActive + begin, mNumActive + end, 0);
+        }
+
+        ///////////////////////////////////////////////////////////////////////
+        //
+        // reset: empties the mixture models of all pixels
+        //
+        ///////////////////////////////////////////////////////////////////////
+        void reset()
+        {
+            std::fill(mNumActive, mNumActive + mNumPixels, 0);
+        }
+
+        ///////////////////////////////////////////////////////////////////////
+        //
+        // release: frees the memory of all mixture models
+        //
+        ///////////////////////////////////////////////////////////////////////
+        void release()
+        {
+            Arena().swap(mArena);
+            layout(0, 0, 0);
+        }
+
+        ///////////////////////////////////////////////////////////////////////
+        //
+        // copyTo/copyFrom: exchange the states with [M N numGaussians] weights,
+        // [M N numChannels numGaussians] means and variances, and [M N]
+        // number of active gaussians. Unused slots are zero. Used for
+        // save/load/clone.
+        //
+        ///////////////////////////////////////////////////////////////////////
+        void copyTo(stat_type * weights, stat_type * means,
+                    stat_type * variances, int * numActive) const
+        {
+            std::copy(mWeights, mWeights + getNumWeights(), weights);
+            std::copy(mMeans, mMeans + getNumMeans(), means);
+            std::copy(mVariances, mVariances + getNumMeans(), variances);
+
+            // clear the slots that are not in use
+            for (mwSize p = 0; p < mNumPixels; ++p)
+            {
+                numActive[p] = static_cast<int>(mNumActive[p]);
+                for (mwSize k = mNumActive[p]; k < mNumGaussians; ++k)
+                {
+                    weights[k*mNumPixels + p] = 0;
+                    for (mwSize c = 0; c < mNumChannels; ++c)
+                    {
+                        means[(k*mNumChannels + c)*mNumPixels + p]     = 0;
+                        variances[(k*mNumChannels + c)*mNumPixels + p] = 0;
+                    }
+                }
+            }
+        }
+
+        void copyFrom(const stat_type * weights, const stat_type * means,
+                      const stat_type * variances, const int * numActive)
+        {
+            std::copy(weights, weights + getNumWeights(), mWeights);
+            std::copy(means, means + getNumMeans(), mMeans);
+            std::copy(variances, variances + getNumMeans(), mVariances);
+            for (mwSize p = 0; p < mNumPixels; ++p)
+            {
+                VISION_ASSERT(numActive[p] >= 0 &&
+                              static_cast<mwSize>(numActive[p]) <= mNumGaussians);
+                mNumActive[p] = static_cast<int32_T>(numActive[p]);
+            }
+        }
+
+        ///////////////////////////////////////////////////////////////////////
+        //
+        // getSnapshotSize: number of bytes written by saveSnapshot
+        //
+        ///////////////////////////////////////////////////////////////////////
+        mwSize getSnapshotSize() const
+        {
+            return sizeof(GaussianMixtureSnapshotHeader) +
+                mNumPixels * sizeof(int32_T) +
+                (getNumWeights() + 2 * getNumMeans()) * sizeof(stat_type);
+        }
+
+        ///////////////////////////////////////////////////////////////////////
+        //
+        // saveSnapshot: writes getSnapshotSize() bytes to buffer, which does
+        // not need to be aligned.
+        //
+        ///////////////////////////////////////////////////////////////////////
+        void saveSnapshot(void * buffer, mwSize imageSize) const
+        {
+            GaussianMixtureSnapshotHeader header;
+            header.magic        = FOREGROUND_DETECTOR_SNAPSHOT_MAGIC;
+            header.version      = FOREGROUND_DETECTOR_SNAPSHOT_VERSION;
+            header.imageSize    = static_cast<uint32_T>(imageSize);
+            header.statSize     = static_cast<uint32_T>(sizeof(stat_type));
+            header.numPixels    = static_cast<uint32_T>(mNumPixels);
+            header.numChannels  = static_cast<uint32_T>(mNumChannels);
+            header.numGaussians = static_cast<uint32_T>(mNumGaussians);
+            header.reserved     = 0;
+
+            char * dst = static_cast<char *>(buffer);
+            std::memcpy(dst, &header, sizeof(header));
+            dst += sizeof(header);
+            dst = writeArray(dst, mNumActive, mNumPixels);
+            dst = writeArray(dst, mWeights, getNumWeights());
+            dst = writeArray(dst, mMeans, getNumMeans());
+            writeArray(dst, mVariances, getNumMeans());
+        }
+
+        ///////////////////////////////////////////////////////////////////////
+        //
+        // loadSnapshot: restores a snapshot of size bytes. Returns false, and
+        // leaves the states unchanged, if the snapshot does not match the
+        // size and types of the store or is corrupted.
+        //
+        ///////////////////////////////////////////////////////////////////////
+        bool loadSnapshot(const void * buffer, mwSize size, mwSize imageSize)
+        {
+            GaussianMixtureSnapshotHeader header;
+            if (buffer == NULL || size != getSnapshotSize())
+                return false;
+
+            const char * src = static_cast<const char *>(buffer);
+            std::memcpy(&header, src, sizeof(header));
+            if (header.magic        != FOREGROUND_DETECTOR_SNAPSHOT_MAGIC   ||
+                header.version      != FOREGROUND_DETECTOR_SNAPSHOT_VERSION ||
+                header.imageSize    != imageSize                            ||
+                header.statSize     != sizeof(stat_type)                    ||
+                header.numPixels    != mNumPixels                           ||
+                header.numChannels  != mNumChannels                         ||
+                header.numGaussians != mNumGaussians)
+            {
+                return false;
+            }
+            src += sizeof(header);
+
+            // validate the number of active gaussians before touching the states
+            for (mwSize p = 0; p < mNumPixels; ++p)
+            {
+                int32_T numActive;
+                std::memcpy(&numActive, src + p*sizeof(int32_T), sizeof(int32_T));
+                if (numActive < 0 || static_cast<mwSize>(numActive) > mNumGaussians)
+                    return false;
+            }
+
+            src = readArray(src, mNumActive, mNumPixels);
+            src = readArray(src, mWeights, getNumWeights());
+            src = readArray(src, mMeans, getNumMeans());
+            readArray(src, mVariances, getNumMeans());
+            return true;
+        }
+
+      public: // accessors
+
+        inline stat_type * weights()   { return mWeights; }
+        inline stat_type * means()     { return mMeans; }
+        inline stat_type * variances() { return mVariances; }
+        inline int32_T   * numActive() { return mNumActive; }
+
+        // distance between two channels, or two slots, of one pixel
+        inline mwSize getChannelStride() const  { return mNumPixels; }
+        inline mwSize getGaussianStride() const { return mNumPixels * mNumChannels; }
+
+        mwSize getNumPixels() const    { return mNumPixels; }
+        mwSize getNumChannels() const  { return mNumChannels; }
+        mwSize getNumGaussians() const { return mNumGaussians; }
+
+        // bytes of the arena of a store of numPixels pixels
+        static mwSize getArenaSize(mwSize numPixels, mwSize numChannels, mwSize numGaussians)
+        {
+            const mwSize numMeans = numGaussians * numChannels * numPixels;
+            return alignSize(numGaussians * numPixels * sizeof(stat_type)) +
+                2 * alignSize(numMeans * sizeof(stat_type)) +
+                alignSize(numPixels * sizeof(int32_T));
+        }
+
+      private:
+
+        // bytes between the start of two arrays of the arena
+        enum { ARENA_ALIGNMENT = 64 };
+
+        static inline mwSize alignSize(mwSize numBytes)
+        {
+            return (numBytes + ARENA_ALIGNMENT - 1) / ARENA_ALIGNMENT * ARENA_ALIGNMENT;
+        }
+
+        ///////////////////////////////////////////////////////////////////////
+        //
+        // layout: points the arrays into the arena
+        //
+        ///////////////////////////////////////////////////////////////////////
+        void layout(mwSize numPixels, mwSize numChannels, mwSize numGaussians)
+        {
+            mNumPixels    = numPixels;
+            mNumChannels  = numChannels;
+            mNumGaussians = numGaussians;
+
+            if (mArena.empty())
+            {
+                mWeights = mMeans = mVariances = NULL;
+                mNumActive = NULL;
+                return;
+            }
+
+            char * ptr = &mArena[0];
+            mWeights   = reinterpret_cast<stat_type *>(ptr);
+            ptr       += alignSize(getNumWeights() * sizeof(stat_type));
+            mMeans     = reinterpret_cast<stat_type *>(ptr);
+            ptr       += alignSize(getNumMeans() * sizeof(stat_type));
+            mVariances = reinterpret_cast<stat_type *>(ptr);
+            ptr       += alignSize(getNumMeans() * sizeof(stat_type));
+            mNumActive = reinterpret_cast<int32_T *>(ptr);
+        }
+
+        inline mwSize getNumWeights() const { return mNumGaussians * mNumPixels; }
+        inline mwSize getNumMeans() const   { return mNumGaussians * mNumChannels * mNumPixels; }
+
+        template <typename T>
+        static char * writeArray(char * dst, const T * src, mwSize numElements)
+        {
+            const mwSize numBytes = numElements * sizeof(T);
+            if (numBytes > 0)
+                std::memcpy(dst, src, numBytes);
+            return dst + numBytes;
+        }
+
+        template <typename T>
+        static const char * readArray(const char * src, T * dst, mwSize numElements)
+        {
+            const mwSize numBytes = numElements * sizeof(T);
+            if (numBytes > 0)
+                std::memcpy(dst, src, numBytes);
+            return src + numBytes;
+        }
+
+      private: // data members
+        mwSize mNumPixels;
+        mwSize mNumChannels;
+        mwSize mNumGaussians;
+
+        Arena mArena;           // single allocation holding all arrays
+        stat_type * mWeights;   // arrays in mArena
+        stat_type * mMeans;
+        stat_type * mVariances;
+        int32_T   * mNumActive;
+    };
+
+} // end vision namespace
+
+#endif
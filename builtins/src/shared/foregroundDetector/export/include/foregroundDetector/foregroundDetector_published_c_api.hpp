@@ -26,6 +26,13 @@ EXTERN_C LIBMWFOREGROUNDDETECTOR_API
 void foregroundDetector_construct_double_double(void **ptr2ptrObj);
 EXTERN_C LIBMWFOREGROUNDDETECTOR_API 
 void foregroundDetector_construct_uint8_float(void **ptr2ptrObj);
+/*
+ * uint8_uint16: uint8 images with 16-bit fixed point statistics. The
+ * properties and learning rates are single precision and the states are
+ * Q1.15 weights, Q8.8 means and Q12.4 variances.
+ */
+EXTERN_C LIBMWFOREGROUNDDETECTOR_API 
+void foregroundDetector_construct_uint8_uint16(void **ptr2ptrObj);
 EXTERN_C LIBMWFOREGROUNDDETECTOR_API
 void foregroundDetector_construct_float_float(void **ptr2ptrObj);
 
@@ -40,6 +47,11 @@ void foregroundDetector_step_uint8_float(void *ptrClass,
                                          const uint8_T * inImage, 
                                          boolean_T *mask, 
                                          float learningRate);
+EXTERN_C LIBMWFOREGROUNDDETECTOR_API
+void foregroundDetector_step_uint8_uint16(void *ptrClass, 
+                                         const uint8_T * inImage, 
+                                         boolean_T *mask, 
+                                         float learningRate);
  
 EXTERN_C LIBMWFOREGROUNDDETECTOR_API 
 void foregroundDetector_step_float_float(void *ptrClass, 
@@ -59,6 +71,11 @@ void foregroundDetector_step_rowMaj_uint8_float(void *ptrClass,
                                          const uint8_T * inImage, 
                                          boolean_T *mask, 
                                          float learningRate);
+EXTERN_C LIBMWFOREGROUNDDETECTOR_API
+void foregroundDetector_step_rowMaj_uint8_uint16(void *ptrClass, 
+                                         const uint8_T * inImage, 
+                                         boolean_T *mask, 
+                                         float learningRate);
  
 EXTERN_C LIBMWFOREGROUNDDETECTOR_API 
 void foregroundDetector_step_rowMaj_float_float(void *ptrClass, 
@@ -66,6 +83,207 @@ void foregroundDetector_step_rowMaj_float_float(void *ptrClass,
                                          boolean_T *mask, 
                                          float learningRate);
 
+/*
+ * Bytes used by a detector initialized with the dims, numGaussians and
+ * downsampleFactor of initializeROI, useROI when it has a roiMask: at the
+ * peak of a step and kept between steps. useAsync counts the buffers of
+ * the asynchronous steps. The models of every pixel are always held, so
+ * only the downsample factor reduces them.
+ */
+EXTERN_C LIBMWFOREGROUNDDETECTOR_API
+void foregroundDetector_estimateMemory_double_double(int32_T numberOfDims,
+    int32_T *dims,
+    int32_T numGaussians,
+    int32_T downsampleFactor,
+    boolean_T useROI,
+    boolean_T useAsync,
+    double *peakBytes,
+    double *steadyBytes);
+EXTERN_C LIBMWFOREGROUNDDETECTOR_API
+void foregroundDetector_estimateMemory_uint8_float(int32_T numberOfDims,
+    int32_T *dims,
+    int32_T numGaussians,
+    int32_T downsampleFactor,
+    boolean_T useROI,
+    boolean_T useAsync,
+    double *peakBytes,
+    double *steadyBytes);
+EXTERN_C LIBMWFOREGROUNDDETECTOR_API
+void foregroundDetector_estimateMemory_uint8_uint16(int32_T numberOfDims,
+    int32_T *dims,
+    int32_T numGaussians,
+    int32_T downsampleFactor,
+    boolean_T useROI,
+    boolean_T useAsync,
+    double *peakBytes,
+    double *steadyBytes);
+EXTERN_C LIBMWFOREGROUNDDETECTOR_API
+void foregroundDetector_estimateMemory_float_float(int32_T numberOfDims,
+    int32_T *dims,
+    int32_T numGaussians,
+    int32_T downsampleFactor,
+    boolean_T useROI,
+    boolean_T useAsync,
+    double *peakBytes,
+    double *steadyBytes);
+/*
+ * Step with a bit-packed output mask: each of the M rows is packed in
+ * foregroundDetector_getPackedWordsPerRow(N) words, pixel (r, c) is bit c%32
+ * of word r*wordsPerRow + c/32. The layout is the same for the column major
+ * and row major versions.
+ */
+EXTERN_C LIBMWFOREGROUNDDETECTOR_API
+int32_T foregroundDetector_getPackedWordsPerRow(int32_T numCols);
+
+EXTERN_C LIBMWFOREGROUNDDETECTOR_API
+void foregroundDetector_stepPacked_double_double(void *ptrClass,
+    const double *inImage,
+    uint32_T *packedMask,
+    double learningRate);
+EXTERN_C LIBMWFOREGROUNDDETECTOR_API
+void foregroundDetector_stepPacked_uint8_float(void *ptrClass,
+    const uint8_T *inImage,
+    uint32_T *packedMask,
+    float learningRate);
+EXTERN_C LIBMWFOREGROUNDDETECTOR_API
+void foregroundDetector_stepPacked_uint8_uint16(void *ptrClass,
+    const uint8_T *inImage,
+    uint32_T *packedMask,
+    float learningRate);
+EXTERN_C LIBMWFOREGROUNDDETECTOR_API
+void foregroundDetector_stepPacked_float_float(void *ptrClass,
+    const float *inImage,
+    uint32_T *packedMask,
+    float learningRate);
+EXTERN_C LIBMWFOREGROUNDDETECTOR_API
+void foregroundDetector_stepPacked_rowMaj_double_double(void *ptrClass,
+    const double *inImage,
+    uint32_T *packedMask,
+    double learningRate);
+EXTERN_C LIBMWFOREGROUNDDETECTOR_API
+void foregroundDetector_stepPacked_rowMaj_uint8_float(void *ptrClass,
+    const uint8_T *inImage,
+    uint32_T *packedMask,
+    float learningRate);
+EXTERN_C LIBMWFOREGROUNDDETECTOR_API
+void foregroundDetector_stepPacked_rowMaj_uint8_uint16(void *ptrClass,
+    const uint8_T *inImage,
+    uint32_T *packedMask,
+    float learningRate);
+EXTERN_C LIBMWFOREGROUNDDETECTOR_API
+void foregroundDetector_stepPacked_rowMaj_float_float(void *ptrClass,
+    const float *inImage,
+    uint32_T *packedMask,
+    float learningRate);
+
+/*
+ * Batch step: steps numStreams detectors of the same type, detector i on
+ * inImages[i] with output masks[i] and learningRates[i], in one parallel
+ * region.
+ */
+EXTERN_C LIBMWFOREGROUNDDETECTOR_API
+void foregroundDetector_stepBatch_double_double(void **ptrClasses,
+                                                int32_T numStreams,
+                                                const double **inImages,
+                                                boolean_T **masks,
+                                                const double *learningRates);
+
+EXTERN_C LIBMWFOREGROUNDDETECTOR_API
+void foregroundDetector_stepBatch_uint8_float(void **ptrClasses,
+                                              int32_T numStreams,
+                                              const uint8_T **inImages,
+                                              boolean_T **masks,
+                                              const float *learningRates);
+EXTERN_C LIBMWFOREGROUNDDETECTOR_API
+void foregroundDetector_stepBatch_uint8_uint16(void **ptrClasses,
+                                              int32_T numStreams,
+                                              const uint8_T **inImages,
+                                              boolean_T **masks,
+                                              const float *learningRates);
+
+EXTERN_C LIBMWFOREGROUNDDETECTOR_API
+void foregroundDetector_stepBatch_float_float(void **ptrClasses,
+                                              int32_T numStreams,
+                                              const float **inImages,
+                                              boolean_T **masks,
+                                              const float *learningRates);
+
+EXTERN_C LIBMWFOREGROUNDDETECTOR_API
+void foregroundDetector_stepBatch_rowMaj_double_double(void **ptrClasses,
+                                                       int32_T numStreams,
+                                                       const double **inImages,
+                                                       boolean_T **masks,
+                                                       const double *learningRates);
+
+EXTERN_C LIBMWFOREGROUNDDETECTOR_API
+void foregroundDetector_stepBatch_rowMaj_uint8_float(void **ptrClasses,
+                                                     int32_T numStreams,
+                                                     const uint8_T **inImages,
+                                                     boolean_T **masks,
+                                                     const float *learningRates);
+EXTERN_C LIBMWFOREGROUNDDETECTOR_API
+void foregroundDetector_stepBatch_rowMaj_uint8_uint16(void **ptrClasses,
+                                                     int32_T numStreams,
+                                                     const uint8_T **inImages,
+                                                     boolean_T **masks,
+                                                     const float *learningRates);
+
+EXTERN_C LIBMWFOREGROUNDDETECTOR_API
+void foregroundDetector_stepBatch_rowMaj_float_float(void **ptrClasses,
+                                                     int32_T numStreams,
+                                                     const float **inImages,
+                                                     boolean_T **masks,
+                                                     const float *learningRates);
+
+/*
+ * Asynchronous step: copies inImage, starts its step in the background and
+ * returns the mask of the previous asynchronous step, or NULL for the first
+ * one. The returned mask is owned by the detector and stays valid until the
+ * next call. waitAsync blocks until the pending step completes and returns
+ * its mask, or NULL if no step is pending. Every other function waits for
+ * the pending step first.
+ */
+EXTERN_C LIBMWFOREGROUNDDETECTOR_API
+const boolean_T *foregroundDetector_stepAsync_double_double(void *ptrClass,
+    const double *inImage,
+    double learningRate);
+EXTERN_C LIBMWFOREGROUNDDETECTOR_API
+const boolean_T *foregroundDetector_stepAsync_uint8_float(void *ptrClass,
+    const uint8_T *inImage,
+    float learningRate);
+EXTERN_C LIBMWFOREGROUNDDETECTOR_API
+const boolean_T *foregroundDetector_stepAsync_uint8_uint16(void *ptrClass,
+    const uint8_T *inImage,
+    float learningRate);
+EXTERN_C LIBMWFOREGROUNDDETECTOR_API
+const boolean_T *foregroundDetector_stepAsync_float_float(void *ptrClass,
+    const float *inImage,
+    float learningRate);
+EXTERN_C LIBMWFOREGROUNDDETECTOR_API
+const boolean_T *foregroundDetector_stepAsync_rowMaj_double_double(void *ptrClass,
+    const double *inImage,
+    double learningRate);
+EXTERN_C LIBMWFOREGROUNDDETECTOR_API
+const boolean_T *foregroundDetector_stepAsync_rowMaj_uint8_float(void *ptrClass,
+    const uint8_T *inImage,
+    float learningRate);
+EXTERN_C LIBMWFOREGROUNDDETECTOR_API
+const boolean_T *foregroundDetector_stepAsync_rowMaj_uint8_uint16(void *ptrClass,
+    const uint8_T *inImage,
+    float learningRate);
+EXTERN_C LIBMWFOREGROUNDDETECTOR_API
+const boolean_T *foregroundDetector_stepAsync_rowMaj_float_float(void *ptrClass,
+    const float *inImage,
+    float learningRate);
+EXTERN_C LIBMWFOREGROUNDDETECTOR_API
+const boolean_T *foregroundDetector_waitAsync_double_double(void *ptrClass);
+EXTERN_C LIBMWFOREGROUNDDETECTOR_API
+const boolean_T *foregroundDetector_waitAsync_uint8_float(void *ptrClass);
+EXTERN_C LIBMWFOREGROUNDDETECTOR_API
+const boolean_T *foregroundDetector_waitAsync_uint8_uint16(void *ptrClass);
+EXTERN_C LIBMWFOREGROUNDDETECTOR_API
+const boolean_T *foregroundDetector_waitAsync_float_float(void *ptrClass);
+
 EXTERN_C LIBMWFOREGROUNDDETECTOR_API
 void foregroundDetector_initialize_double_double(
     void *ptrClass,
@@ -87,6 +305,16 @@ void foregroundDetector_initialize_uint8_float(
     float initialWeight, 
     float varianceThreshold,
     float minBGRatio);
+EXTERN_C LIBMWFOREGROUNDDETECTOR_API
+void foregroundDetector_initialize_uint8_uint16(
+    void *ptrClass,
+    int32_T numberOfDims,	
+    int32_T *dims,
+    int32_T numGaussians, 
+    float initialVariance,
+    float initialWeight, 
+    float varianceThreshold,
+    float minBGRatio);
 							
 EXTERN_C LIBMWFOREGROUNDDETECTOR_API
 void foregroundDetector_initialize_float_float(
@@ -100,10 +328,124 @@ void foregroundDetector_initialize_float_float(
     float minBGRatio);							
 
 
+/*
+ * Initialize with a region of interest: one pixel of each downsampleFactor
+ * by downsampleFactor cell that overlaps the [M N] roiMask is modeled, its
+ * first ROI pixel in column major order. The output mask keeps the image
+ * size: each ROI pixel takes the decision of the modeled pixel of its cell,
+ * other pixels are background.
+ * roiMask may be NULL to model the whole image. The _rowMaj_ versions take
+ * a row major roiMask.
+ */
+EXTERN_C LIBMWFOREGROUNDDETECTOR_API
+void foregroundDetector_initializeROI_double_double(
+    void *ptrClass,
+    int32_T numberOfDims,
+    int32_T *dims,
+    int32_T numGaussians,
+    double initialVariance,
+    double initialWeight,
+    double varianceThreshold,
+    double minBGRatio,
+    const boolean_T *roiMask,
+    int32_T downsampleFactor);
+
+EXTERN_C LIBMWFOREGROUNDDETECTOR_API
+void foregroundDetector_initializeROI_uint8_float(
+    void *ptrClass,
+    int32_T numberOfDims,
+    int32_T *dims,
+    int32_T numGaussians,
+    float initialVariance,
+    float initialWeight,
+    float varianceThreshold,
+    float minBGRatio,
+    const boolean_T *roiMask,
+    int32_T downsampleFactor);
+EXTERN_C LIBMWFOREGROUNDDETECTOR_API
+void foregroundDetector_initializeROI_uint8_uint16(
+    void *ptrClass,
+    int32_T numberOfDims,
+    int32_T *dims,
+    int32_T numGaussians,
+    float initialVariance,
+    float initialWeight,
+    float varianceThreshold,
+    float minBGRatio,
+    const boolean_T *roiMask,
+    int32_T downsampleFactor);
+
+EXTERN_C LIBMWFOREGROUNDDETECTOR_API
+void foregroundDetector_initializeROI_float_float(
+    void *ptrClass,
+    int32_T numberOfDims,
+    int32_T *dims,
+    int32_T numGaussians,
+    float initialVariance,
+    float initialWeight,
+    float varianceThreshold,
+    float minBGRatio,
+    const boolean_T *roiMask,
+    int32_T downsampleFactor);
+
+EXTERN_C LIBMWFOREGROUNDDETECTOR_API
+void foregroundDetector_initializeROI_rowMaj_double_double(
+    void *ptrClass,
+    int32_T numberOfDims,
+    int32_T *dims,
+    int32_T numGaussians,
+    double initialVariance,
+    double initialWeight,
+    double varianceThreshold,
+    double minBGRatio,
+    const boolean_T *roiMask,
+    int32_T downsampleFactor);
+
+EXTERN_C LIBMWFOREGROUNDDETECTOR_API
+void foregroundDetector_initializeROI_rowMaj_uint8_float(
+    void *ptrClass,
+    int32_T numberOfDims,
+    int32_T *dims,
+    int32_T numGaussians,
+    float initialVariance,
+    float initialWeight,
+    float varianceThreshold,
+    float minBGRatio,
+    const boolean_T *roiMask,
+    int32_T downsampleFactor);
+EXTERN_C LIBMWFOREGROUNDDETECTOR_API
+void foregroundDetector_initializeROI_rowMaj_uint8_uint16(
+    void *ptrClass,
+    int32_T numberOfDims,
+    int32_T *dims,
+    int32_T numGaussians,
+    float initialVariance,
+    float initialWeight,
+    float varianceThreshold,
+    float minBGRatio,
+    const boolean_T *roiMask,
+    int32_T downsampleFactor);
+
+EXTERN_C LIBMWFOREGROUNDDETECTOR_API
+void foregroundDetector_initializeROI_rowMaj_float_float(
+    void *ptrClass,
+    int32_T numberOfDims,
+    int32_T *dims,
+    int32_T numGaussians,
+    float initialVariance,
+    float initialWeight,
+    float varianceThreshold,
+    float minBGRatio,
+    const boolean_T *roiMask,
+    int32_T downsampleFactor);
+
+
 EXTERN_C LIBMWFOREGROUNDDETECTOR_API
 void foregroundDetector_reset_double_double(void *ptrClass);
 EXTERN_C LIBMWFOREGROUNDDETECTOR_API
 void foregroundDetector_reset_uint8_float(void *ptrClass);
+EXTERN_C LIBMWFOREGROUNDDETECTOR_API
+void foregroundDetector_reset_uint8_uint16(void *ptrClass);
 EXTERN_C LIBMWFOREGROUNDDETECTOR_API 
 void foregroundDetector_reset_float_float(void *ptrClass);
 
@@ -112,13 +454,115 @@ EXTERN_C LIBMWFOREGROUNDDETECTOR_API
 void foregroundDetector_release_double_double(void *ptrClass);
 EXTERN_C LIBMWFOREGROUNDDETECTOR_API 
 void foregroundDetector_release_uint8_float(void *ptrClass);
+EXTERN_C LIBMWFOREGROUNDDETECTOR_API 
+void foregroundDetector_release_uint8_uint16(void *ptrClass);
 EXTERN_C LIBMWFOREGROUNDDETECTOR_API
 void foregroundDetector_release_float_float(void *ptrClass);
 
+/*
+ * Maximum number of threads of the parallel loops of all the detectors of
+ * the process, including the calling thread. 0 or less removes the limit.
+ * The limit applies to the whole TBB scheduler of the process, so it also
+ * bounds the other TBB users of the process. getNumThreads returns the
+ * limit, or the number of threads TBB uses by default without one.
+ */
+EXTERN_C LIBMWFOREGROUNDDETECTOR_API
+void foregroundDetector_setNumThreads(int32_T numThreads);
+EXTERN_C LIBMWFOREGROUNDDETECTOR_API
+int32_T foregroundDetector_getNumThreads(void);
+
+/*
+ * NUMA placement of the mixture models of the detectors initialized
+ * afterwards:
+ *  FOREGROUND_DETECTOR_NUMA_NONE        the initializing thread clears all
+ *                                       the states, so they all land on its
+ *                                       node
+ *  FOREGROUND_DETECTOR_NUMA_FIRST_TOUCH each tile is cleared by the thread
+ *                                       that updates it in the steps, so it
+ *                                       lands on that thread's node (default)
+ *  FOREGROUND_DETECTOR_NUMA_NODE_ARENAS the detectors are assigned to the
+ *                                       NUMA nodes in turn, and their
+ *                                       initialization and steps run on TBB
+ *                                       threads bound to that node. Batch
+ *                                       steps run on the threads of the
+ *                                       caller. Requires oneTBB with NUMA
+ *                                       support and more than one node;
+ *                                       otherwise the same as FIRST_TOUCH.
+ * getNumaPolicy returns the policy set.
+ */
+#define FOREGROUND_DETECTOR_NUMA_NONE        0
+#define FOREGROUND_DETECTOR_NUMA_FIRST_TOUCH 1
+#define FOREGROUND_DETECTOR_NUMA_NODE_ARENAS 2
+
+EXTERN_C LIBMWFOREGROUNDDETECTOR_API
+void foregroundDetector_setNumaPolicy(int32_T policy);
+EXTERN_C LIBMWFOREGROUNDDETECTOR_API
+int32_T foregroundDetector_getNumaPolicy(void);
+
+/* grainSize: number of pixels processed by a task, 0 selects the default */
+EXTERN_C LIBMWFOREGROUNDDETECTOR_API
+void foregroundDetector_setGrainSize_double_double(void *ptrClass, int32_T grainSize);
+EXTERN_C LIBMWFOREGROUNDDETECTOR_API
+void foregroundDetector_setGrainSize_uint8_float(void *ptrClass, int32_T grainSize);
+EXTERN_C LIBMWFOREGROUNDDETECTOR_API
+void foregroundDetector_setGrainSize_uint8_uint16(void *ptrClass, int32_T grainSize);
+EXTERN_C LIBMWFOREGROUNDDETECTOR_API
+void foregroundDetector_setGrainSize_float_float(void *ptrClass, int32_T grainSize);
+
+/*
+ * Snapshot: binary copy of the mixture models of all pixels, restored into a
+ * detector initialized with the same image size, number of gaussians and
+ * region of interest. saveSnapshot writes getSnapshotSize bytes to buffer.
+ * The load functions return false, and leave the detector unchanged, when
+ * the snapshot does not match it.
+ */
+EXTERN_C LIBMWFOREGROUNDDETECTOR_API
+uint32_T foregroundDetector_getSnapshotSize_double_double(void *ptrClass);
+EXTERN_C LIBMWFOREGROUNDDETECTOR_API
+uint32_T foregroundDetector_getSnapshotSize_uint8_float(void *ptrClass);
+EXTERN_C LIBMWFOREGROUNDDETECTOR_API
+uint32_T foregroundDetector_getSnapshotSize_uint8_uint16(void *ptrClass);
+EXTERN_C LIBMWFOREGROUNDDETECTOR_API
+uint32_T foregroundDetector_getSnapshotSize_float_float(void *ptrClass);
+EXTERN_C LIBMWFOREGROUNDDETECTOR_API
+void foregroundDetector_saveSnapshot_double_double(void *ptrClass, void *buffer);
+EXTERN_C LIBMWFOREGROUNDDETECTOR_API
+void foregroundDetector_saveSnapshot_uint8_float(void *ptrClass, void *buffer);
+EXTERN_C LIBMWFOREGROUNDDETECTOR_API
+void foregroundDetector_saveSnapshot_uint8_uint16(void *ptrClass, void *buffer);
+EXTERN_C LIBMWFOREGROUNDDETECTOR_API
+void foregroundDetector_saveSnapshot_float_float(void *ptrClass, void *buffer);
+EXTERN_C LIBMWFOREGROUNDDETECTOR_API
+boolean_T foregroundDetector_loadSnapshot_double_double(void *ptrClass, const void *buffer, uint32_T size);
+EXTERN_C LIBMWFOREGROUNDDETECTOR_API
+boolean_T foregroundDetector_loadSnapshot_uint8_float(void *ptrClass, const void *buffer, uint32_T size);
+EXTERN_C LIBMWFOREGROUNDDETECTOR_API
+boolean_T foregroundDetector_loadSnapshot_uint8_uint16(void *ptrClass, const void *buffer, uint32_T size);
+EXTERN_C LIBMWFOREGROUNDDETECTOR_API
+boolean_T foregroundDetector_loadSnapshot_float_float(void *ptrClass, const void *buffer, uint32_T size);
+EXTERN_C LIBMWFOREGROUNDDETECTOR_API
+boolean_T foregroundDetector_saveSnapshotFile_double_double(void *ptrClass, const char *filename);
+EXTERN_C LIBMWFOREGROUNDDETECTOR_API
+boolean_T foregroundDetector_saveSnapshotFile_uint8_float(void *ptrClass, const char *filename);
+EXTERN_C LIBMWFOREGROUNDDETECTOR_API
+boolean_T foregroundDetector_saveSnapshotFile_uint8_uint16(void *ptrClass, const char *filename);
+EXTERN_C LIBMWFOREGROUNDDETECTOR_API
+boolean_T foregroundDetector_saveSnapshotFile_float_float(void *ptrClass, const char *filename);
+EXTERN_C LIBMWFOREGROUNDDETECTOR_API
+boolean_T foregroundDetector_loadSnapshotFile_double_double(void *ptrClass, const char *filename);
+EXTERN_C LIBMWFOREGROUNDDETECTOR_API
+boolean_T foregroundDetector_loadSnapshotFile_uint8_float(void *ptrClass, const char *filename);
+EXTERN_C LIBMWFOREGROUNDDETECTOR_API
+boolean_T foregroundDetector_loadSnapshotFile_uint8_uint16(void *ptrClass, const char *filename);
+EXTERN_C LIBMWFOREGROUNDDETECTOR_API
+boolean_T foregroundDetector_loadSnapshotFile_float_float(void *ptrClass, const char *filename);
+
 EXTERN_C LIBMWFOREGROUNDDETECTOR_API
 void foregroundDetector_deleteObj_float_float(void *ptrClass);
 EXTERN_C LIBMWFOREGROUNDDETECTOR_API 
 void foregroundDetector_deleteObj_uint8_float(void *ptrClass);
+EXTERN_C LIBMWFOREGROUNDDETECTOR_API 
+void foregroundDetector_deleteObj_uint8_uint16(void *ptrClass);
 EXTERN_C LIBMWFOREGROUNDDETECTOR_API
 void foregroundDetector_deleteObj_double_double(void *ptrClass);
 
@@ -9,10 +9,19 @@
 #include "foregroundDetector_published_c_api.hpp"
 #include "ForegroundDetectorImpl.hpp"
 #else
+// tbb::global_control is a preview feature before TBB 2019
+#define TBB_PREVIEW_GLOBAL_CONTROL 1
 #include <foregroundDetector/vision_defines.h>
 #include <foregroundDetector/foregroundDetector_published_c_api.hpp>
 #include <foregroundDetector/ForegroundDetectorImpl.hpp>
+#if TBB_INTERFACE_VERSION >= 9100
+#include <tbb/global_control.h>
+#define FOREGROUND_DETECTOR_HAVE_GLOBAL_CONTROL
 #endif
+#endif
+
+#include <memory>
+#include <mutex>
 
 ///////////////////////////////////////////////////////////////////////////    
 //Constructor for different classes
@@ -31,6 +40,13 @@ void foregroundDetector_construct_uint8_float(void **ptr2fgObjPtr)
     *ptr2fgObjPtr = fgObjPtr;
 }
 
+void foregroundDetector_construct_uint8_uint16(void **ptr2fgObjPtr)
+{
+    vision::ForegroundDetectorImpl<uint8_T,uint16_T>  *fgObjPtr =
+        (vision::ForegroundDetectorImpl<uint8_T,uint16_T> *)new vision::ForegroundDetectorImpl<uint8_T,uint16_T>;
+    *ptr2fgObjPtr = fgObjPtr;
+}
+
 void foregroundDetector_construct_float_float(void **ptr2fgObjPtr)
 {
     vision::ForegroundDetectorImpl<float,float>  *fgObjPtr = 
@@ -69,6 +85,20 @@ void foregroundDetector_step_uint8_float(void *fgObjPtr,
 		
 }
 
+void foregroundDetector_step_uint8_uint16(void *fgObjPtr, 
+                                         const uint8_T * inImage, 
+                                         boolean_T *mask, 
+                                         float learningRate)
+{
+
+    vision::ForegroundDetectorImpl<uint8_T,uint16_T> *fgObj =
+        (vision::ForegroundDetectorImpl<uint8_T,uint16_T> *)fgObjPtr;
+    // call shared library functions
+    fgObj->setOutputBuffer(mask);
+    fgObj->stepImpl(inImage,learningRate);
+		
+}
+
 void foregroundDetector_step_float_float(void *fgObjPtr, 
                                          const float * inImage, 
                                          boolean_T *mask, 
@@ -114,6 +144,20 @@ void foregroundDetector_step_rowMaj_uint8_float(void *fgObjPtr,
 		
 }
 
+void foregroundDetector_step_rowMaj_uint8_uint16(void *fgObjPtr, 
+                                         const uint8_T * inImage, 
+                                         boolean_T *mask, 
+                                         float learningRate)
+{
+
+    vision::ForegroundDetectorImpl<uint8_T,uint16_T> *fgObj =
+        (vision::ForegroundDetectorImpl<uint8_T,uint16_T> *)fgObjPtr;
+    // call shared library functions
+    fgObj->setOutputBuffer(mask);
+    fgObj->stepImplRowMajor(inImage,learningRate);
+		
+}
+
 void foregroundDetector_step_rowMaj_float_float(void *fgObjPtr, 
                                          const float * inImage, 
                                          boolean_T *mask, 
@@ -127,6 +171,371 @@ void foregroundDetector_step_rowMaj_float_float(void *fgObjPtr,
 		
 }
 
+///////////////////////////////////////////////////////////////////////////    
+//Memory estimate for different classes
+///////////////////////////////////////////////////////////////////////////    
+void foregroundDetector_estimateMemory_double_double(int32_T numberOfDims,
+    int32_T *dims,
+    int32_T numGaussians,
+    int32_T downsampleFactor,
+    boolean_T useROI,
+    boolean_T useAsync,
+    double *peakBytes,
+    double *steadyBytes)
+{
+    std::vector<mwSize> dVec((mwSize)numberOfDims);
+    std::copy(dims, dims+numberOfDims, dVec.begin());
+    vision::ForegroundDetectorImpl<double,double>::estimateMemory(dVec,
+        (mwSize)numGaussians, (mwSize)std::max(downsampleFactor, 1),
+        useROI != 0, useAsync != 0, *peakBytes, *steadyBytes);
+}
+
+void foregroundDetector_estimateMemory_uint8_float(int32_T numberOfDims,
+    int32_T *dims,
+    int32_T numGaussians,
+    int32_T downsampleFactor,
+    boolean_T useROI,
+    boolean_T useAsync,
+    double *peakBytes,
+    double *steadyBytes)
+{
+    std::vector<mwSize> dVec((mwSize)numberOfDims);
+    std::copy(dims, dims+numberOfDims, dVec.begin());
+    vision::ForegroundDetectorImpl<uint8_T,float>::estimateMemory(dVec,
+        (mwSize)numGaussians, (mwSize)std::max(downsampleFactor, 1),
+        useROI != 0, useAsync != 0, *peakBytes, *steadyBytes);
+}
+
+void foregroundDetector_estimateMemory_uint8_uint16(int32_T numberOfDims,
+    int32_T *dims,
+    int32_T numGaussians,
+    int32_T downsampleFactor,
+    boolean_T useROI,
+    boolean_T useAsync,
+    double *peakBytes,
+    double *steadyBytes)
+{
+    std::vector<mwSize> dVec((mwSize)numberOfDims);
+    std::copy(dims, dims+numberOfDims, dVec.begin());
+    vision::ForegroundDetectorImpl<uint8_T,uint16_T>::estimateMemory(dVec,
+        (mwSize)numGaussians, (mwSize)std::max(downsampleFactor, 1),
+        useROI != 0, useAsync != 0, *peakBytes, *steadyBytes);
+}
+
+void foregroundDetector_estimateMemory_float_float(int32_T numberOfDims,
+    int32_T *dims,
+    int32_T numGaussians,
+    int32_T downsampleFactor,
+    boolean_T useROI,
+    boolean_T useAsync,
+    double *peakBytes,
+    double *steadyBytes)
+{
+    std::vector<mwSize> dVec((mwSize)numberOfDims);
+    std::copy(dims, dims+numberOfDims, dVec.begin());
+    vision::ForegroundDetectorImpl<float,float>::estimateMemory(dVec,
+        (mwSize)numGaussians, (mwSize)std::max(downsampleFactor, 1),
+        useROI != 0, useAsync != 0, *peakBytes, *steadyBytes);
+}
+
+///////////////////////////////////////////////////////////////////////////    
+//Step with a bit-packed mask for different classes
+///////////////////////////////////////////////////////////////////////////    
+int32_T foregroundDetector_getPackedWordsPerRow(int32_T numCols)
+{
+    return numCols > 0 ? (int32_T)vision::ForegroundDetectorImpl<float,float>::getPackedWordsPerRow((mwSize)numCols) : 0;
+}
+
+void foregroundDetector_stepPacked_double_double(void *fgObjPtr,
+    const double *inImage,
+    uint32_T *packedMask,
+    double learningRate)
+{
+    vision::ForegroundDetectorImpl<double,double> *fgObj =
+        (vision::ForegroundDetectorImpl<double,double> *)fgObjPtr;
+    fgObj->setPackedOutputBuffer(packedMask);
+    fgObj->stepImpl(inImage, learningRate);
+}
+
+void foregroundDetector_stepPacked_uint8_float(void *fgObjPtr,
+    const uint8_T *inImage,
+    uint32_T *packedMask,
+    float learningRate)
+{
+    vision::ForegroundDetectorImpl<uint8_T,float> *fgObj =
+        (vision::ForegroundDetectorImpl<uint8_T,float> *)fgObjPtr;
+    fgObj->setPackedOutputBuffer(packedMask);
+    fgObj->stepImpl(inImage, learningRate);
+}
+
+void foregroundDetector_stepPacked_uint8_uint16(void *fgObjPtr,
+    const uint8_T *inImage,
+    uint32_T *packedMask,
+    float learningRate)
+{
+    vision::ForegroundDetectorImpl<uint8_T,uint16_T> *fgObj =
+        (vision::ForegroundDetectorImpl<uint8_T,uint16_T> *)fgObjPtr;
+    fgObj->setPackedOutputBuffer(packedMask);
+    fgObj->stepImpl(inImage, learningRate);
+}
+
+void foregroundDetector_stepPacked_float_float(void *fgObjPtr,
+    const float *inImage,
+    uint32_T *packedMask,
+    float learningRate)
+{
+    vision::ForegroundDetectorImpl<float,float> *fgObj =
+        (vision::ForegroundDetectorImpl<float,float> *)fgObjPtr;
+    fgObj->setPackedOutputBuffer(packedMask);
+    fgObj->stepImpl(inImage, learningRate);
+}
+
+void foregroundDetector_stepPacked_rowMaj_double_double(void *fgObjPtr,
+    const double *inImage,
+    uint32_T *packedMask,
+    double learningRate)
+{
+    vision::ForegroundDetectorImpl<double,double> *fgObj =
+        (vision::ForegroundDetectorImpl<double,double> *)fgObjPtr;
+    fgObj->setPackedOutputBuffer(packedMask);
+    fgObj->stepImplRowMajor(inImage, learningRate);
+}
+
+void foregroundDetector_stepPacked_rowMaj_uint8_float(void *fgObjPtr,
+    const uint8_T *inImage,
+    uint32_T *packedMask,
+    float learningRate)
+{
+    vision::ForegroundDetectorImpl<uint8_T,float> *fgObj =
+        (vision::ForegroundDetectorImpl<uint8_T,float> *)fgObjPtr;
+    fgObj->setPackedOutputBuffer(packedMask);
+    fgObj->stepImplRowMajor(inImage, learningRate);
+}
+
+void foregroundDetector_stepPacked_rowMaj_uint8_uint16(void *fgObjPtr,
+    const uint8_T *inImage,
+    uint32_T *packedMask,
+    float learningRate)
+{
+    vision::ForegroundDetectorImpl<uint8_T,uint16_T> *fgObj =
+        (vision::ForegroundDetectorImpl<uint8_T,uint16_T> *)fgObjPtr;
+    fgObj->setPackedOutputBuffer(packedMask);
+    fgObj->stepImplRowMajor(inImage, learningRate);
+}
+
+void foregroundDetector_stepPacked_rowMaj_float_float(void *fgObjPtr,
+    const float *inImage,
+    uint32_T *packedMask,
+    float learningRate)
+{
+    vision::ForegroundDetectorImpl<float,float> *fgObj =
+        (vision::ForegroundDetectorImpl<float,float> *)fgObjPtr;
+    fgObj->setPackedOutputBuffer(packedMask);
+    fgObj->stepImplRowMajor(inImage, learningRate);
+}
+
+///////////////////////////////////////////////////////////////////////////    
+//Batch step for different classes
+///////////////////////////////////////////////////////////////////////////    
+void foregroundDetector_stepBatch_double_double(void **fgObjPtrs,
+    int32_T numStreams,
+    const double **inImages,
+    boolean_T **masks,
+    const double *learningRates)
+{
+    vision::ForegroundDetectorImpl<double,double>::stepBatchImpl(
+        (vision::ForegroundDetectorImpl<double,double> **)fgObjPtrs,
+        numStreams > 0 ? (mwSize)numStreams : 0,
+        inImages, masks, learningRates, false);
+}
+
+void foregroundDetector_stepBatch_rowMaj_double_double(void **fgObjPtrs,
+    int32_T numStreams,
+    const double **inImages,
+    boolean_T **masks,
+    const double *learningRates)
+{
+    vision::ForegroundDetectorImpl<double,double>::stepBatchImpl(
+        (vision::ForegroundDetectorImpl<double,double> **)fgObjPtrs,
+        numStreams > 0 ? (mwSize)numStreams : 0,
+        inImages, masks, learningRates, true);
+}
+
+void foregroundDetector_stepBatch_uint8_float(void **fgObjPtrs,
+    int32_T numStreams,
+    const uint8_T **inImages,
+    boolean_T **masks,
+    const float *learningRates)
+{
+    vision::ForegroundDetectorImpl<uint8_T,float>::stepBatchImpl(
+        (vision::ForegroundDetectorImpl<uint8_T,float> **)fgObjPtrs,
+        numStreams > 0 ? (mwSize)numStreams : 0,
+        inImages, masks, learningRates, false);
+}
+
+void foregroundDetector_stepBatch_uint8_uint16(void **fgObjPtrs,
+    int32_T numStreams,
+    const uint8_T **inImages,
+    boolean_T **masks,
+    const float *learningRates)
+{
+    vision::ForegroundDetectorImpl<uint8_T,uint16_T>::stepBatchImpl(
+        (vision::ForegroundDetectorImpl<uint8_T,uint16_T> **)fgObjPtrs,
+        numStreams > 0 ? (mwSize)numStreams : 0,
+        inImages, masks, learningRates, false);
+}
+
+void foregroundDetector_stepBatch_rowMaj_uint8_float(void **fgObjPtrs,
+    int32_T numStreams,
+    const uint8_T **inImages,
+    boolean_T **masks,
+    const float *learningRates)
+{
+    vision::ForegroundDetectorImpl<uint8_T,float>::stepBatchImpl(
+        (vision::ForegroundDetectorImpl<uint8_T,float> **)fgObjPtrs,
+        numStreams > 0 ? (mwSize)numStreams : 0,
+        inImages, masks, learningRates, true);
+}
+
+void foregroundDetector_stepBatch_rowMaj_uint8_uint16(void **fgObjPtrs,
+    int32_T numStreams,
+    const uint8_T **inImages,
+    boolean_T **masks,
+    const float *learningRates)
+{
+    vision::ForegroundDetectorImpl<uint8_T,uint16_T>::stepBatchImpl(
+        (vision::ForegroundDetectorImpl<uint8_T,uint16_T> **)fgObjPtrs,
+        numStreams > 0 ? (mwSize)numStreams : 0,
+        inImages, masks, learningRates, true);
+}
+
+void foregroundDetector_stepBatch_float_float(void **fgObjPtrs,
+    int32_T numStreams,
+    const float **inImages,
+    boolean_T **masks,
+    const float *learningRates)
+{
+    vision::ForegroundDetectorImpl<float,float>::stepBatchImpl(
+        (vision::ForegroundDetectorImpl<float,float> **)fgObjPtrs,
+        numStreams > 0 ? (mwSize)numStreams : 0,
+        inImages, masks, learningRates, false);
+}
+
+void foregroundDetector_stepBatch_rowMaj_float_float(void **fgObjPtrs,
+    int32_T numStreams,
+    const float **inImages,
+    boolean_T **masks,
+    const float *learningRates)
+{
+    vision::ForegroundDetectorImpl<float,float>::stepBatchImpl(
+        (vision::ForegroundDetectorImpl<float,float> **)fgObjPtrs,
+        numStreams > 0 ? (mwSize)numStreams : 0,
+        inImages, masks, learningRates, true);
+}
+
+///////////////////////////////////////////////////////////////////////////    
+//Asynchronous step for different classes
+///////////////////////////////////////////////////////////////////////////    
+const boolean_T *foregroundDetector_stepAsync_double_double(void *fgObjPtr,
+    const double *inImage,
+    double learningRate)
+{
+    vision::ForegroundDetectorImpl<double,double> *fgObj =
+        (vision::ForegroundDetectorImpl<double,double> *)fgObjPtr;
+    return fgObj->stepAsyncImpl(inImage, learningRate, false);
+}
+
+const boolean_T *foregroundDetector_stepAsync_rowMaj_double_double(void *fgObjPtr,
+    const double *inImage,
+    double learningRate)
+{
+    vision::ForegroundDetectorImpl<double,double> *fgObj =
+        (vision::ForegroundDetectorImpl<double,double> *)fgObjPtr;
+    return fgObj->stepAsyncImpl(inImage, learningRate, true);
+}
+
+const boolean_T *foregroundDetector_waitAsync_double_double(void *fgObjPtr)
+{
+    vision::ForegroundDetectorImpl<double,double> *fgObj =
+        (vision::ForegroundDetectorImpl<double,double> *)fgObjPtr;
+    return fgObj->waitAsyncImpl();
+}
+
+const boolean_T *foregroundDetector_stepAsync_uint8_float(void *fgObjPtr,
+    const uint8_T *inImage,
+    float learningRate)
+{
+    vision::ForegroundDetectorImpl<uint8_T,float> *fgObj =
+        (vision::ForegroundDetectorImpl<uint8_T,float> *)fgObjPtr;
+    return fgObj->stepAsyncImpl(inImage, learningRate, false);
+}
+
+const boolean_T *foregroundDetector_stepAsync_rowMaj_uint8_float(void *fgObjPtr,
+    const uint8_T *inImage,
+    float learningRate)
+{
+    vision::ForegroundDetectorImpl<uint8_T,float> *fgObj =
+        (vision::ForegroundDetectorImpl<uint8_T,float> *)fgObjPtr;
+    return fgObj->stepAsyncImpl(inImage, learningRate, true);
+}
+
+const boolean_T *foregroundDetector_waitAsync_uint8_float(void *fgObjPtr)
+{
+    vision::ForegroundDetectorImpl<uint8_T,float> *fgObj =
+        (vision::ForegroundDetectorImpl<uint8_T,float> *)fgObjPtr;
+    return fgObj->waitAsyncImpl();
+}
+
+const boolean_T *foregroundDetector_stepAsync_uint8_uint16(void *fgObjPtr,
+    const uint8_T *inImage,
+    float learningRate)
+{
+    vision::ForegroundDetectorImpl<uint8_T,uint16_T> *fgObj =
+        (vision::ForegroundDetectorImpl<uint8_T,uint16_T> *)fgObjPtr;
+    return fgObj->stepAsyncImpl(inImage, learningRate, false);
+}
+
+const boolean_T *foregroundDetector_stepAsync_rowMaj_uint8_uint16(void *fgObjPtr,
+    const uint8_T *inImage,
+    float learningRate)
+{
+    vision::ForegroundDetectorImpl<uint8_T,uint16_T> *fgObj =
+        (vision::ForegroundDetectorImpl<uint8_T,uint16_T> *)fgObjPtr;
+    return fgObj->stepAsyncImpl(inImage, learningRate, true);
+}
+
+const boolean_T *foregroundDetector_waitAsync_uint8_uint16(void *fgObjPtr)
+{
+    vision::ForegroundDetectorImpl<uint8_T,uint16_T> *fgObj =
+        (vision::ForegroundDetectorImpl<uint8_T,uint16_T> *)fgObjPtr;
+    return fgObj->waitAsyncImpl();
+}
+
+const boolean_T *foregroundDetector_stepAsync_float_float(void *fgObjPtr,
+    const float *inImage,
+    float learningRate)
+{
+    vision::ForegroundDetectorImpl<float,float> *fgObj =
+        (vision::ForegroundDetectorImpl<float,float> *)fgObjPtr;
+    return fgObj->stepAsyncImpl(inImage, learningRate, false);
+}
+
+const boolean_T *foregroundDetector_stepAsync_rowMaj_float_float(void *fgObjPtr,
+    const float *inImage,
+    float learningRate)
+{
+    vision::ForegroundDetectorImpl<float,float> *fgObj =
+        (vision::ForegroundDetectorImpl<float,float> *)fgObjPtr;
+    return fgObj->stepAsyncImpl(inImage, learningRate, true);
+}
+
+const boolean_T *foregroundDetector_waitAsync_float_float(void *fgObjPtr)
+{
+    vision::ForegroundDetectorImpl<float,float> *fgObj =
+        (vision::ForegroundDetectorImpl<float,float> *)fgObjPtr;
+    return fgObj->waitAsyncImpl();
+}
+
 ///////////////////////////////////////////////////////////////////////////    
 //Initialize for different classes
 ///////////////////////////////////////////////////////////////////////////    
@@ -178,6 +587,30 @@ void foregroundDetector_initialize_uint8_float(
                           minBGRatio);								
 							
 }
+
+void foregroundDetector_initialize_uint8_uint16(
+    void *fgObjPtr,
+    int32_T numberOfDims,	
+    int32_T *dims,
+    int32_T numGaussians, 
+    float initialVariance,
+    float initialWeight, 
+    float varianceThreshold,
+    float minBGRatio)
+{
+							
+    std::vector<mwSize> dVec((mwSize)numberOfDims);
+    std::copy(dims, dims+numberOfDims, dVec.begin());							
+    vision::ForegroundDetectorImpl<uint8_T,uint16_T> *fgObj =
+        (vision::ForegroundDetectorImpl<uint8_T,uint16_T> *)fgObjPtr;
+    fgObj->initializeImpl(dVec,
+                          (mwSize)numGaussians,
+                          initialVariance,
+                          initialWeight,
+                          varianceThreshold,
+                          minBGRatio);								
+							
+}
 							
 void foregroundDetector_initialize_float_float(
     void *fgObjPtr,
@@ -202,6 +635,226 @@ void foregroundDetector_initialize_float_float(
                           minBGRatio);
 }		
 
+///////////////////////////////////////////////////////////////////////////    
+//Initialize with a region of interest for different classes
+///////////////////////////////////////////////////////////////////////////    
+
+void foregroundDetector_initializeROI_double_double(
+    void *fgObjPtr,
+    int32_T numberOfDims,
+    int32_T *dims,
+    int32_T numGaussians,
+    double initialVariance,
+    double initialWeight,
+    double varianceThreshold,
+    double minBGRatio,
+    const boolean_T *roiMask,
+    int32_T downsampleFactor)
+{
+    std::vector<mwSize> dVec((mwSize)numberOfDims);
+    std::copy(dims, dims+numberOfDims, dVec.begin());
+    vision::ForegroundDetectorImpl<double,double> *fgObj =
+        (vision::ForegroundDetectorImpl<double,double> *)fgObjPtr;
+    fgObj->initializeImpl(dVec,
+                          (mwSize)numGaussians,
+                          initialVariance,
+                          initialWeight,
+                          varianceThreshold,
+                          minBGRatio,
+                          roiMask,
+                          false,
+                          downsampleFactor > 1 ? (mwSize)downsampleFactor : 1);
+}
+
+void foregroundDetector_initializeROI_uint8_float(
+    void *fgObjPtr,
+    int32_T numberOfDims,
+    int32_T *dims,
+    int32_T numGaussians,
+    float initialVariance,
+    float initialWeight,
+    float varianceThreshold,
+    float minBGRatio,
+    const boolean_T *roiMask,
+    int32_T downsampleFactor)
+{
+    std::vector<mwSize> dVec((mwSize)numberOfDims);
+    std::copy(dims, dims+numberOfDims, dVec.begin());
+    vision::ForegroundDetectorImpl<uint8_T,float> *fgObj =
+        (vision::ForegroundDetectorImpl<uint8_T,float> *)fgObjPtr;
+    fgObj->initializeImpl(dVec,
+                          (mwSize)numGaussians,
+                          initialVariance,
+                          initialWeight,
+                          varianceThreshold,
+                          minBGRatio,
+                          roiMask,
+                          false,
+                          downsampleFactor > 1 ? (mwSize)downsampleFactor : 1);
+}
+
+void foregroundDetector_initializeROI_uint8_uint16(
+    void *fgObjPtr,
+    int32_T numberOfDims,
+    int32_T *dims,
+    int32_T numGaussians,
+    float initialVariance,
+    float initialWeight,
+    float varianceThreshold,
+    float minBGRatio,
+    const boolean_T *roiMask,
+    int32_T downsampleFactor)
+{
+    std::vector<mwSize> dVec((mwSize)numberOfDims);
+    std::copy(dims, dims+numberOfDims, dVec.begin());
+    vision::ForegroundDetectorImpl<uint8_T,uint16_T> *fgObj =
+        (vision::ForegroundDetectorImpl<uint8_T,uint16_T> *)fgObjPtr;
+    fgObj->initializeImpl(dVec,
+                          (mwSize)numGaussians,
+                          initialVariance,
+                          initialWeight,
+                          varianceThreshold,
+                          minBGRatio,
+                          roiMask,
+                          false,
+                          downsampleFactor > 1 ? (mwSize)downsampleFactor : 1);
+}
+
+void foregroundDetector_initializeROI_float_float(
+    void *fgObjPtr,
+    int32_T numberOfDims,
+    int32_T *dims,
+    int32_T numGaussians,
+    float initialVariance,
+    float initialWeight,
+    float varianceThreshold,
+    float minBGRatio,
+    const boolean_T *roiMask,
+    int32_T downsampleFactor)
+{
+    std::vector<mwSize> dVec((mwSize)numberOfDims);
+    std::copy(dims, dims+numberOfDims, dVec.begin());
+    vision::ForegroundDetectorImpl<float,float> *fgObj =
+        (vision::ForegroundDetectorImpl<float,float> *)fgObjPtr;
+    fgObj->initializeImpl(dVec,
+                          (mwSize)numGaussians,
+                          initialVariance,
+                          initialWeight,
+                          varianceThreshold,
+                          minBGRatio,
+                          roiMask,
+                          false,
+                          downsampleFactor > 1 ? (mwSize)downsampleFactor : 1);
+}
+
+void foregroundDetector_initializeROI_rowMaj_double_double(
+    void *fgObjPtr,
+    int32_T numberOfDims,
+    int32_T *dims,
+    int32_T numGaussians,
+    double initialVariance,
+    double initialWeight,
+    double varianceThreshold,
+    double minBGRatio,
+    const boolean_T *roiMask,
+    int32_T downsampleFactor)
+{
+    std::vector<mwSize> dVec((mwSize)numberOfDims);
+    std::copy(dims, dims+numberOfDims, dVec.begin());
+    vision::ForegroundDetectorImpl<double,double> *fgObj =
+        (vision::ForegroundDetectorImpl<double,double> *)fgObjPtr;
+    fgObj->initializeImpl(dVec,
+                          (mwSize)numGaussians,
+                          initialVariance,
+                          initialWeight,
+                          varianceThreshold,
+                          minBGRatio,
+                          roiMask,
+                          true,
+                          downsampleFactor > 1 ? (mwSize)downsampleFactor : 1);
+}
+
+void foregroundDetector_initializeROI_rowMaj_uint8_float(
+    void *fgObjPtr,
+    int32_T numberOfDims,
+    int32_T *dims,
+    int32_T numGaussians,
+    float initialVariance,
+    float initialWeight,
+    float varianceThreshold,
+    float minBGRatio,
+    const boolean_T *roiMask,
+    int32_T downsampleFactor)
+{
+    std::vector<mwSize> dVec((mwSize)numberOfDims);
+    std::copy(dims, dims+numberOfDims, dVec.begin());
+    vision::ForegroundDetectorImpl<uint8_T,float> *fgObj =
+        (vision::ForegroundDetectorImpl<uint8_T,float> *)fgObjPtr;
+    fgObj->initializeImpl(dVec,
+                          (mwSize)numGaussians,
+                          initialVariance,
+                          initialWeight,
+                          varianceThreshold,
+                          minBGRatio,
+                          roiMask,
+                          true,
+                          downsampleFactor > 1 ? (mwSize)downsampleFactor : 1);
+}
+
+void foregroundDetector_initializeROI_rowMaj_uint8_uint16(
+    void *fgObjPtr,
+    int32_T numberOfDims,
+    int32_T *dims,
+    int32_T numGaussians,
+    float initialVariance,
+    float initialWeight,
+    float varianceThreshold,
+    float minBGRatio,
+    const boolean_T *roiMask,
+    int32_T downsampleFactor)
+{
+    std::vector<mwSize> dVec((mwSize)numberOfDims);
+    std::copy(dims, dims+numberOfDims, dVec.begin());
+    vision::ForegroundDetectorImpl<uint8_T,uint16_T> *fgObj =
+        (vision::ForegroundDetectorImpl<uint8_T,uint16_T> *)fgObjPtr;
+    fgObj->initializeImpl(dVec,
+                          (mwSize)numGaussians,
+                          initialVariance,
+                          initialWeight,
+                          varianceThreshold,
+                          minBGRatio,
+                          roiMask,
+                          true,
+                          downsampleFactor > 1 ? (mwSize)downsampleFactor : 1);
+}
+
+void foregroundDetector_initializeROI_rowMaj_float_float(
+    void *fgObjPtr,
+    int32_T numberOfDims,
+    int32_T *dims,
+    int32_T numGaussians,
+    float initialVariance,
+    float initialWeight,
+    float varianceThreshold,
+    float minBGRatio,
+    const boolean_T *roiMask,
+    int32_T downsampleFactor)
+{
+    std::vector<mwSize> dVec((mwSize)numberOfDims);
+    std::copy(dims, dims+numberOfDims, dVec.begin());
+    vision::ForegroundDetectorImpl<float,float> *fgObj =
+        (vision::ForegroundDetectorImpl<float,float> *)fgObjPtr;
+    fgObj->initializeImpl(dVec,
+                          (mwSize)numGaussians,
+                          initialVariance,
+                          initialWeight,
+                          varianceThreshold,
+                          minBGRatio,
+                          roiMask,
+                          true,
+                          downsampleFactor > 1 ? (mwSize)downsampleFactor : 1);
+}
+
 ///////////////////////////////////////////////////////////////////////////    
 //Reset for different classes
 ///////////////////////////////////////////////////////////////////////////    
@@ -217,6 +870,13 @@ void foregroundDetector_reset_uint8_float(void *fgObjPtr){
         (vision::ForegroundDetectorImpl<uint8_T,float> *)fgObjPtr;
     fgObj->resetImpl();
  
+}
+
+void foregroundDetector_reset_uint8_uint16(void *fgObjPtr){
+    vision::ForegroundDetectorImpl<uint8_T,uint16_T> *fgObj = 
+        (vision::ForegroundDetectorImpl<uint8_T,uint16_T> *)fgObjPtr;
+    fgObj->resetImpl();
+ 
 }
 void foregroundDetector_reset_float_float(void *fgObjPtr){
     vision::ForegroundDetectorImpl<float,float> *fgObj =
@@ -246,6 +906,14 @@ void foregroundDetector_release_uint8_float(void *fgObjPtr){
 
 }
 
+void foregroundDetector_release_uint8_uint16(void *fgObjPtr){
+
+    vision::ForegroundDetectorImpl<uint8_T,uint16_T> *fgObj = 
+        (vision::ForegroundDetectorImpl<uint8_T,uint16_T> *)fgObjPtr;
+    fgObj->releaseImpl();
+
+}
+
 void foregroundDetector_release_float_float(void *fgObjPtr){
  
     vision::ForegroundDetectorImpl<float,float> *fgObj =
@@ -253,6 +921,210 @@ void foregroundDetector_release_float_float(void *fgObjPtr){
     fgObj->releaseImpl();
 }
  
+///////////////////////////////////////////////////////////////////////////    
+//Number of threads of all the detectors
+///////////////////////////////////////////////////////////////////////////    
+namespace
+{
+    std::mutex numThreadsMutex;
+    int32_T numThreadsLimit = 0;
+#ifdef FOREGROUND_DETECTOR_HAVE_GLOBAL_CONTROL
+    std::unique_ptr<tbb::global_control> numThreadsControl;
+#endif
+}
+
+void foregroundDetector_setNumThreads(int32_T numThreads){
+    std::lock_guard<std::mutex> lock(numThreadsMutex);
+    numThreadsLimit = (numThreads > 0) ? numThreads : 0;
+#ifdef FOREGROUND_DETECTOR_HAVE_GLOBAL_CONTROL
+    // the previous limit is lifted before the new one is set
+    numThreadsControl.reset();
+    if (numThreadsLimit > 0)
+    {
+        numThreadsControl.reset(new tbb::global_control(
+            tbb::global_control::max_allowed_parallelism, (size_t)numThreadsLimit));
+    }
+#endif
+}
+
+int32_T foregroundDetector_getNumThreads(void){
+    std::lock_guard<std::mutex> lock(numThreadsMutex);
+    if (numThreadsLimit > 0)
+    {
+        return numThreadsLimit;
+    }
+#if defined(__arm__)
+    return 1;
+#elif defined(FOREGROUND_DETECTOR_HAVE_GLOBAL_CONTROL)
+    // task_scheduler_init is gone from oneTBB
+    return (int32_T)tbb::global_control::active_value(
+        tbb::global_control::max_allowed_parallelism);
+#else
+    return (int32_T)tbb::task_scheduler_init::default_num_threads();
+#endif
+}
+
+///////////////////////////////////////////////////////////////////////////    
+//NUMA placement of the detectors
+///////////////////////////////////////////////////////////////////////////    
+void foregroundDetector_setNumaPolicy(int32_T policy){
+    vision::setForegroundDetectorNumaPolicy(policy);
+}
+
+int32_T foregroundDetector_getNumaPolicy(void){
+    return vision::getForegroundDetectorNumaPolicy();
+}
+
+///////////////////////////////////////////////////////////////////////////    
+//Grain size for different classes
+///////////////////////////////////////////////////////////////////////////    
+void foregroundDetector_setGrainSize_double_double(void *fgObjPtr, int32_T grainSize){
+    vision::ForegroundDetectorImpl<double,double> *fgObj = 
+        (vision::ForegroundDetectorImpl<double,double> *)fgObjPtr;
+    fgObj->setGrainSizeImpl(grainSize > 0 ? (mwSize)grainSize : 0);
+}
+
+void foregroundDetector_setGrainSize_uint8_float(void *fgObjPtr, int32_T grainSize){
+    vision::ForegroundDetectorImpl<uint8_T,float> *fgObj = 
+        (vision::ForegroundDetectorImpl<uint8_T,float> *)fgObjPtr;
+    fgObj->setGrainSizeImpl(grainSize > 0 ? (mwSize)grainSize : 0);
+}
+
+void foregroundDetector_setGrainSize_uint8_uint16(void *fgObjPtr, int32_T grainSize){
+    vision::ForegroundDetectorImpl<uint8_T,uint16_T> *fgObj = 
+        (vision::ForegroundDetectorImpl<uint8_T,uint16_T> *)fgObjPtr;
+    fgObj->setGrainSizeImpl(grainSize > 0 ? (mwSize)grainSize : 0);
+}
+
+void foregroundDetector_setGrainSize_float_float(void *fgObjPtr, int32_T grainSize){
+    vision::ForegroundDetectorImpl<float,float> *fgObj =
+        (vision::ForegroundDetectorImpl<float,float> *)fgObjPtr;
+    fgObj->setGrainSizeImpl(grainSize > 0 ? (mwSize)grainSize : 0);
+}
+
+///////////////////////////////////////////////////////////////////////////    
+//Snapshot for different classes
+///////////////////////////////////////////////////////////////////////////    
+uint32_T foregroundDetector_getSnapshotSize_double_double(void *fgObjPtr){
+    vision::ForegroundDetectorImpl<double,double> *fgObj = 
+        (vision::ForegroundDetectorImpl<double,double> *)fgObjPtr;
+    return (uint32_T)fgObj->getSnapshotSizeImpl();
+}
+
+void foregroundDetector_saveSnapshot_double_double(void *fgObjPtr, void *buffer){
+    vision::ForegroundDetectorImpl<double,double> *fgObj = 
+        (vision::ForegroundDetectorImpl<double,double> *)fgObjPtr;
+    fgObj->saveSnapshotImpl(buffer);
+}
+
+boolean_T foregroundDetector_loadSnapshot_double_double(void *fgObjPtr, const void *buffer, uint32_T size){
+    vision::ForegroundDetectorImpl<double,double> *fgObj = 
+        (vision::ForegroundDetectorImpl<double,double> *)fgObjPtr;
+    return fgObj->loadSnapshotImpl(buffer, (mwSize)size);
+}
+
+boolean_T foregroundDetector_saveSnapshotFile_double_double(void *fgObjPtr, const char *filename){
+    vision::ForegroundDetectorImpl<double,double> *fgObj = 
+        (vision::ForegroundDetectorImpl<double,double> *)fgObjPtr;
+    return fgObj->saveSnapshotFileImpl(filename);
+}
+
+boolean_T foregroundDetector_loadSnapshotFile_double_double(void *fgObjPtr, const char *filename){
+    vision::ForegroundDetectorImpl<double,double> *fgObj = 
+        (vision::ForegroundDetectorImpl<double,double> *)fgObjPtr;
+    return fgObj->loadSnapshotFileImpl(filename);
+}
+
+uint32_T foregroundDetector_getSnapshotSize_uint8_float(void *fgObjPtr){
+    vision::ForegroundDetectorImpl<uint8_T,float> *fgObj = 
+        (vision::ForegroundDetectorImpl<uint8_T,float> *)fgObjPtr;
+    return (uint32_T)fgObj->getSnapshotSizeImpl();
+}
+
+void foregroundDetector_saveSnapshot_uint8_float(void *fgObjPtr, void *buffer){
+    vision::ForegroundDetectorImpl<uint8_T,float> *fgObj = 
+        (vision::ForegroundDetectorImpl<uint8_T,float> *)fgObjPtr;
+    fgObj->saveSnapshotImpl(buffer);
+}
+
+boolean_T foregroundDetector_loadSnapshot_uint8_float(void *fgObjPtr, const void *buffer, uint32_T size){
+    vision::ForegroundDetectorImpl<uint8_T,float> *fgObj = 
+        (vision::ForegroundDetectorImpl<uint8_T,float> *)fgObjPtr;
+    return fgObj->loadSnapshotImpl(buffer, (mwSize)size);
+}
+
+boolean_T foregroundDetector_saveSnapshotFile_uint8_float(void *fgObjPtr, const char *filename){
+    vision::ForegroundDetectorImpl<uint8_T,float> *fgObj = 
+        (vision::ForegroundDetectorImpl<uint8_T,float> *)fgObjPtr;
+    return fgObj->saveSnapshotFileImpl(filename);
+}
+
+boolean_T foregroundDetector_loadSnapshotFile_uint8_float(void *fgObjPtr, const char *filename){
+    vision::ForegroundDetectorImpl<uint8_T,float> *fgObj = 
+        (vision::ForegroundDetectorImpl<uint8_T,float> *)fgObjPtr;
+    return fgObj->loadSnapshotFileImpl(filename);
+}
+
+uint32_T foregroundDetector_getSnapshotSize_uint8_uint16(void *fgObjPtr){
+    vision::ForegroundDetectorImpl<uint8_T,uint16_T> *fgObj = 
+        (vision::ForegroundDetectorImpl<uint8_T,uint16_T> *)fgObjPtr;
+    return (uint32_T)fgObj->getSnapshotSizeImpl();
+}
+
+void foregroundDetector_saveSnapshot_uint8_uint16(void *fgObjPtr, void *buffer){
+    vision::ForegroundDetectorImpl<uint8_T,uint16_T> *fgObj = 
+        (vision::ForegroundDetectorImpl<uint8_T,uint16_T> *)fgObjPtr;
+    fgObj->saveSnapshotImpl(buffer);
+}
+
+boolean_T foregroundDetector_loadSnapshot_uint8_uint16(void *fgObjPtr, const void *buffer, uint32_T size){
+    vision::ForegroundDetectorImpl<uint8_T,uint16_T> *fgObj = 
+        (vision::ForegroundDetectorImpl<uint8_T,uint16_T> *)fgObjPtr;
+    return fgObj->loadSnapshotImpl(buffer, (mwSize)size);
+}
+
+boolean_T foregroundDetector_saveSnapshotFile_uint8_uint16(void *fgObjPtr, const char *filename){
+    vision::ForegroundDetectorImpl<uint8_T,uint16_T> *fgObj = 
+        (vision::ForegroundDetectorImpl<uint8_T,uint16_T> *)fgObjPtr;
+    return fgObj->saveSnapshotFileImpl(filename);
+}
+
+boolean_T foregroundDetector_loadSnapshotFile_uint8_uint16(void *fgObjPtr, const char *filename){
+    vision::ForegroundDetectorImpl<uint8_T,uint16_T> *fgObj = 
+        (vision::ForegroundDetectorImpl<uint8_T,uint16_T> *)fgObjPtr;
+    return fgObj->loadSnapshotFileImpl(filename);
+}
+
+uint32_T foregroundDetector_getSnapshotSize_float_float(void *fgObjPtr){
+    vision::ForegroundDetectorImpl<float,float> *fgObj = 
+        (vision::ForegroundDetectorImpl<float,float> *)fgObjPtr;
+    return (uint32_T)fgObj->getSnapshotSizeImpl();
+}
+
+void foregroundDetector_saveSnapshot_float_float(void *fgObjPtr, void *buffer){
+    vision::ForegroundDetectorImpl<float,float> *fgObj = 
+        (vision::ForegroundDetectorImpl<float,float> *)fgObjPtr;
+    fgObj->saveSnapshotImpl(buffer);
+}
+
+boolean_T foregroundDetector_loadSnapshot_float_float(void *fgObjPtr, const void *buffer, uint32_T size){
+    vision::ForegroundDetectorImpl<float,float> *fgObj = 
+        (vision::ForegroundDetectorImpl<float,float> *)fgObjPtr;
+    return fgObj->loadSnapshotImpl(buffer, (mwSize)size);
+}
+
+boolean_T foregroundDetector_saveSnapshotFile_float_float(void *fgObjPtr, const char *filename){
+    vision::ForegroundDetectorImpl<float,float> *fgObj = 
+        (vision::ForegroundDetectorImpl<float,float> *)fgObjPtr;
+    return fgObj->saveSnapshotFileImpl(filename);
+}
+
+boolean_T foregroundDetector_loadSnapshotFile_float_float(void *fgObjPtr, const char *filename){
+    vision::ForegroundDetectorImpl<float,float> *fgObj = 
+        (vision::ForegroundDetectorImpl<float,float> *)fgObjPtr;
+    return fgObj->loadSnapshotFileImpl(filename);
+}
+
 ///////////////////////////////////////////////////////////////////////////    
 //Delete for different classes
 ///////////////////////////////////////////////////////////////////////////   
@@ -263,6 +1135,11 @@ void foregroundDetector_deleteObj_float_float(void *fgObjPtr){
 void foregroundDetector_deleteObj_uint8_float(void *fgObjPtr){ 
     delete((vision::ForegroundDetectorImpl<uint8_T,float> *)fgObjPtr);
 
+}
+
+void foregroundDetector_deleteObj_uint8_uint16(void *fgObjPtr){ 
+    delete((vision::ForegroundDetectorImpl<uint8_T,uint16_T> *)fgObjPtr);
+
 }
 void foregroundDetector_deleteObj_double_double(void *fgObjPtr){ 
     delete((vision::ForegroundDetectorImpl<double,double> *)fgObjPtr);
@@ -0,0 +1,264 @@
+/*
+ * This file contains the optical flow Horn-Schunck algorithm in fixed-point
+ * arithmetic, for uint8 video on targets without a fast floating point
+ * unit.
+ *
+ * The gradients are the integer Sobel sums of
+ * MWCV_SobelDerivative_HS_Fixpt and the velocities are int32 with
+ * MWCV_OF_FIXPT_FRAC_BITS fractional bits. The iteration is the one of
+ * MWCV_OpticalFlow_HS_DTypes: each pixel moves from the average velocity
+ * of its four neighbors by
+ *
+ *   num   = gradC*avgVelC + gradR*avgVelR + gradT
+ *   velC  = avgVelC - num*alphaC
+ *   velR  = avgVelR - num*alphaR
+ *
+ * where num*alpha is (num*alpha) >> 31 with alpha in Q31. That is the
+ * doubling high half multiply of NEON (vqdmulhq_s32), which never
+ * saturates here since |alpha| < 1/2, so the NEON and the scalar code give
+ * the same velocities bit for bit. num fits in int32 for velocities below
+ * 256 pixels per frame.
+ *
+ *  Copyright 2016 The MathWorks, Inc.
+ */
+
+#ifndef _OPTICALFLOWHS_FIXPT_H_
+#define _OPTICALFLOWHS_FIXPT_H_
+
+#include <string.h>
+#include "opticalFlowHS_Sobel.hpp"
+
+#if defined(__ARM_NEON__) || defined(__ARM_NEON)
+#include <arm_neon.h>
+#define MWCV_HS_FIXPT_NEON 1
+#endif
+
+/* fractional bits of the fixed-point velocities */
+#ifndef MWCV_OF_FIXPT_FRAC_BITS
+#define MWCV_OF_FIXPT_FRAC_BITS 12
+#endif
+
+/* (num * alpha) >> 31, as vqdmulhq_s32 */
+inline int32_T MWCV_HS_Fixpt_MulQ31(int32_T num, int32_T alpha)
+{
+    return (int32_T)(((long long)num * alpha) >> 31);
+}
+
+/*
+ * Updates the velocity of rows [i0, i1) of one column into velC and velR
+ * from the previous iteration's velocity of the column (curC, curR) and of
+ * its left and right neighbors. Returns the largest change of either
+ * component, or 0 when it is not needed.
+ */
+inline int32_T MWCV_HS_Fixpt_UpdateRows(const int32_T *curC, const int32_T *curR,
+                                        const int32_T *leftC, const int32_T *leftR,
+                                        const int32_T *rightC, const int32_T *rightR,
+                                        const int16_T *gradC, const int16_T *gradR,
+                                        const int32_T *gradT,
+                                        const int32_T *alphaC, const int32_T *alphaR,
+                                        int32_T *velC, int32_T *velR,
+                                        boolean_T useAbsVelDiff,
+                                        int_T i0, int_T i1, int_T inRows)
+{
+    int32_T maxAbsVelDiff = 0;
+    int_T i;
+    for( i = i0; i < i1; i++ )
+    {
+        const int_T im1 = (i==0)          ? i : i-1;
+        const int_T ip1 = (i==(inRows-1)) ? i : i+1;
+
+        const int32_T avgVelC = (curC[im1] + curC[ip1] + leftC[i] + rightC[i]) >> 2;
+        const int32_T avgVelR = (curR[im1] + curR[ip1] + leftR[i] + rightR[i]) >> 2;
+        const int32_T num = gradC[i] * avgVelC + gradR[i] * avgVelR +
+                            gradT[i] * (1 << MWCV_OF_FIXPT_FRAC_BITS);
+
+        velC[i] = avgVelC - MWCV_HS_Fixpt_MulQ31(num, alphaC[i]);
+        velR[i] = avgVelR - MWCV_HS_Fixpt_MulQ31(num, alphaR[i]);
+
+        if(useAbsVelDiff)
+        {
+            const int32_T absVelDiffC = (curC[i] > velC[i]) ? curC[i] - velC[i] : velC[i] - curC[i];
+            const int32_T absVelDiffR = (curR[i] > velR[i]) ? curR[i] - velR[i] : velR[i] - curR[i];
+            maxAbsVelDiff = MAX( MAX(absVelDiffC, absVelDiffR), maxAbsVelDiff );
+        }
+    }
+    return maxAbsVelDiff;
+}
+
+#ifdef MWCV_HS_FIXPT_NEON
+/* MWCV_HS_Fixpt_UpdateRows for interior rows, four at a time */
+inline int32_T MWCV_HS_Fixpt_UpdateRowsNeon(const int32_T *curC, const int32_T *curR,
+                                            const int32_T *leftC, const int32_T *leftR,
+                                            const int32_T *rightC, const int32_T *rightR,
+                                            const int16_T *gradC, const int16_T *gradR,
+                                            const int32_T *gradT,
+                                            const int32_T *alphaC, const int32_T *alphaR,
+                                            int32_T *velC, int32_T *velR,
+                                            boolean_T useAbsVelDiff,
+                                            int_T i0, int_T i1)
+{
+    int32x4_t maxDiff = vdupq_n_s32(0);
+    int32_T maxArr[4];
+    int_T i;
+    for( i = i0; i < i1; i += 4 )
+    {
+        const int32x4_t vC = vld1q_s32(curC + i);
+        const int32x4_t vR = vld1q_s32(curR + i);
+        const int32x4_t avgVelC = vshrq_n_s32(
+            vaddq_s32(vaddq_s32(vld1q_s32(curC + i - 1), vld1q_s32(curC + i + 1)),
+                      vaddq_s32(vld1q_s32(leftC + i), vld1q_s32(rightC + i))), 2);
+        const int32x4_t avgVelR = vshrq_n_s32(
+            vaddq_s32(vaddq_s32(vld1q_s32(curR + i - 1), vld1q_s32(curR + i + 1)),
+                      vaddq_s32(vld1q_s32(leftR + i), vld1q_s32(rightR + i))), 2);
+
+        int32x4_t num = vshlq_n_s32(vld1q_s32(gradT + i), MWCV_OF_FIXPT_FRAC_BITS);
+        num = vmlaq_s32(num, vmovl_s16(vld1_s16(gradC + i)), avgVelC);
+        num = vmlaq_s32(num, vmovl_s16(vld1_s16(gradR + i)), avgVelR);
+
+        const int32x4_t newC = vsubq_s32(avgVelC, vqdmulhq_s32(num, vld1q_s32(alphaC + i)));
+        const int32x4_t newR = vsubq_s32(avgVelR, vqdmulhq_s32(num, vld1q_s32(alphaR + i)));
+        vst1q_s32(velC + i, newC);
+        vst1q_s32(velR + i, newR);
+
+        if(useAbsVelDiff)
+        {
+            maxDiff = vmaxq_s32(maxDiff, vmaxq_s32(vabdq_s32(vC, newC), vabdq_s32(vR, newR)));
+        }
+    }
+    vst1q_s32(maxArr, maxDiff);
+    return MAX( MAX(maxArr[0], maxArr[1]), MAX(maxArr[2], maxArr[3]) );
+}
+#endif
+
+/*
+ * Fixed-point Horn-Schunck for uint8 frames. outVelC and outVelR are in
+ * Q(MWCV_OF_FIXPT_FRAC_BITS) pixels, lambda is in the units of
+ * MWCV_OF_HS_FIXPT_LAMBDA and maxAllowableAbsDiffVel in Q(FRAC_BITS)
+ * pixels. The buffers are those of MWCV_OpticalFlow_HS_DTypes, with int16
+ * gradients and the two Q31 factors alphaC and alphaR in place of the five
+ * gradient products and alpha.
+ */
+template <typename ImT>
+void MWCV_OpticalFlow_HS_Fixpt( const ImT  *inImgA, //input image A
+                                const ImT  *inImgB, //input image B
+                                int32_T  *outVelC, // output velocity - component along column
+                                int32_T  *outVelR, // output velocity - component along row
+                                int32_T  *buffCprev,
+                                int32_T  *buffCnext,
+                                int32_T  *buffRprev,
+                                int32_T  *buffRnext,
+                                int16_T  *gradC,
+                                int16_T  *gradR,
+                                int32_T  *gradT,
+                                int32_T  *alphaC,
+                                int32_T  *alphaR,
+                                int32_T  *velBufCcurr,
+                                int32_T  *velBufCprev,
+                                int32_T  *velBufRcurr,
+                                int32_T  *velBufRprev,
+                                const int32_T  *lambda,
+                                boolean_T useMaxIter,
+                                boolean_T useAbsVelDiff,
+                                const int32_T *maxIter,
+                                const int32_T  *maxAllowableAbsDiffVel,
+                                int_T  inRows, // num rows of inImgA
+                                int_T  inCols) // num cols of inImgA
+{
+    const int_T inSize  = inRows*inCols;
+    const int_T bytesPerInpCol = inRows * sizeof( int32_T );
+    const int_T endCol = (inCols-1)*inRows;
+
+    int_T j;
+    int_T numIter;
+    int32_T maxAbsVelDiff = 0;
+
+    MWCV_SobelDerivative_HS_Fixpt<ImT>( inImgA,
+                                inImgB,
+                                buffCprev,
+                                buffCnext,
+                                buffRprev,
+                                buffRnext,
+                                gradC,
+                                gradR,
+                                gradT,
+                                alphaC,
+                                alphaR,
+                                lambda[0],
+                                inRows,
+                                inCols);
+
+    /* set initial motion vector to zero */
+    memset(outVelC, 0, sizeof(int32_T)*inSize);
+    memset(outVelR, 0, sizeof(int32_T)*inSize);
+
+    /* same column order and line buffers as MWCV_OpticalFlow_HS_DTypes */
+    numIter = 1;
+    do
+    {
+        int32_T *velBufCcurrT = velBufCcurr;
+        int32_T *velBufCprevT = velBufCprev;
+        int32_T *velBufRcurrT = velBufRcurr;
+        int32_T *velBufRprevT = velBufRprev;
+
+        maxAbsVelDiff = 0;
+
+        for( j = 0; j < inCols; j++ )
+        {
+            const int_T col = j*inRows;
+            const int32_T *curC   = outVelC + col;
+            const int32_T *curR   = outVelR + col;
+            const int32_T *leftC  = (j==0)          ? curC : curC - inRows;
+            const int32_T *leftR  = (j==0)          ? curR : curR - inRows;
+            const int32_T *rightC = (j==(inCols-1)) ? curC : curC + inRows;
+            const int32_T *rightR = (j==(inCols-1)) ? curR : curR + inRows;
+            int32_T diff;
+
+#ifdef MWCV_HS_FIXPT_NEON
+            /* the first and last rows and the remainder are scalar */
+            const int_T numVec = (inRows > 2) ? ((inRows-2) & ~3) : 0;
+            diff = MWCV_HS_Fixpt_UpdateRows(curC, curR, leftC, leftR, rightC, rightR,
+                    gradC + col, gradR + col, gradT + col, alphaC + col, alphaR + col,
+                    velBufCcurrT, velBufRcurrT, useAbsVelDiff, 0, 1, inRows);
+            maxAbsVelDiff = MAX(diff, maxAbsVelDiff);
+            diff = MWCV_HS_Fixpt_UpdateRowsNeon(curC, curR, leftC, leftR, rightC, rightR,
+                    gradC + col, gradR + col, gradT + col, alphaC + col, alphaR + col,
+                    velBufCcurrT, velBufRcurrT, useAbsVelDiff, 1, 1 + numVec);
+            maxAbsVelDiff = MAX(diff, maxAbsVelDiff);
+            diff = MWCV_HS_Fixpt_UpdateRows(curC, curR, leftC, leftR, rightC, rightR,
+                    gradC + col, gradR + col, gradT + col, alphaC + col, alphaR + col,
+                    velBufCcurrT, velBufRcurrT, useAbsVelDiff, 1 + numVec, inRows, inRows);
+#else
+            diff = MWCV_HS_Fixpt_UpdateRows(curC, curR, leftC, leftR, rightC, rightR,
+                    gradC + col, gradR + col, gradT + col, alphaC + col, alphaR + col,
+                    velBufCcurrT, velBufRcurrT, useAbsVelDiff, 0, inRows, inRows);
+#endif
+            maxAbsVelDiff = MAX(diff, maxAbsVelDiff);
+
+            /* the previous column is no longer read; save its new velocity */
+            if( j > 0 )
+            {
+                memcpy( &outVelC[col-inRows], velBufCprevT, bytesPerInpCol);
+                memcpy( &outVelR[col-inRows], velBufRprevT, bytesPerInpCol);
+            }
+
+            /* switch the next and prev velocity buffers */
+            {
+                int32_T *tmpBuff;
+                tmpBuff      = velBufCcurrT;
+                velBufCcurrT = velBufCprevT;
+                velBufCprevT = tmpBuff;
+                tmpBuff      = velBufRcurrT;
+                velBufRcurrT = velBufRprevT;
+                velBufRprevT = tmpBuff;
+            }
+        }
+
+        /* copy the last column of velocity (j=inCols) to output */
+        memcpy( &outVelC[endCol], velBufCprevT, bytesPerInpCol);
+        memcpy( &outVelR[endCol], velBufRprevT, bytesPerInpCol);
+    }
+    while (!(  ( useMaxIter && (numIter++ == maxIter[0]) )
+          ||   ( useAbsVelDiff && (maxAbsVelDiff < maxAllowableAbsDiffVel[0]) )));
+}
+
+#endif /* _OPTICALFLOWHS_FIXPT_H_ */
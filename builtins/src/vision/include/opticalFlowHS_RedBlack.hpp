@@ -0,0 +1,356 @@
+/*
+ * This file contains the optical flow Horn-Schunck algorithm solved with a
+ * red-black Gauss-Seidel iteration.
+ *
+ * Pixel (i,j) is red when i+j is even and black otherwise. The four
+ * neighbors of a red pixel are black, and vice versa, so each half sweep
+ * updates the velocity in place and every column can be updated at the
+ * same time. When PARALLEL is defined, the columns are split among threads
+ * that are started once per call and synchronized with a barrier after each
+ * half sweep. Boundary rows and columns are handled outside the inner loop.
+ *
+ * The iteration order differs from MWCV_OpticalFlow_HS_DTypes, so the
+ * velocity after a fixed number of iterations differs as well. Both
+ * converge to the same solution.
+ *
+ *  Copyright 2016 The MathWorks, Inc.
+ */
+
+#ifndef _OPTICALFLOWHS_REDBLACK_H_
+#define _OPTICALFLOWHS_REDBLACK_H_
+
+#include <string.h>
+#include <math.h>
+#include "opticalFlowHS_Sobel.hpp"
+#include "opticalFlowPyramid.hpp"
+
+#ifdef PARALLEL
+#include <algorithm>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+#endif
+
+/* minimum number of columns updated by each thread */
+#define HS_RB_MIN_COLS_PER_THREAD 64
+
+/* updates pixel ij from its up, down, left and right neighbors */
+template <typename T>
+inline T MWCV_HS_RB_UpdatePixel(T *outVelC, T *outVelR,
+                                const T *gradCC, const T *gradRC,
+                                const T *gradRR, const T *gradCT,
+                                const T *gradRT, const T *alpha,
+                                int_T ij, int_T ijM1, int_T ijP1,
+                                int_T ijMinRows, int_T ijPinRows)
+{
+    const T avgVelC = (outVelC[ijM1]      +
+                       outVelC[ijP1]      +
+                       outVelC[ijMinRows] +
+                       outVelC[ijPinRows]) / 4;
+    const T avgVelR = (outVelR[ijM1]      +
+                       outVelR[ijP1]      +
+                       outVelR[ijMinRows] +
+                       outVelR[ijPinRows]) / 4;
+
+    const T velC = avgVelC -
+        (gradCC[ij] * avgVelC + gradRC[ij] * avgVelR + gradCT[ij]) * alpha[ij];
+    const T velR = avgVelR -
+        (gradRC[ij] * avgVelC + gradRR[ij] * avgVelR + gradRT[ij]) * alpha[ij];
+
+    const T absVelDiffC = (T)fabs(outVelC[ij] - velC);
+    const T absVelDiffR = (T)fabs(outVelR[ij] - velR);
+
+    outVelC[ij] = velC;
+    outVelR[ij] = velR;
+
+    return MAX(absVelDiffC, absVelDiffR);
+}
+
+/*
+ * Updates the pixels of one color (0: red, 1: black) in columns
+ * [startCol, endCol) and returns the largest velocity change.
+ */
+template <typename T>
+T MWCV_HS_RB_HalfSweep(T *outVelC, T *outVelR,
+                       const T *gradCC, const T *gradRC, const T *gradRR,
+                       const T *gradCT, const T *gradRT, const T *alpha,
+                       int_T color, int_T startCol, int_T endCol,
+                       int_T inRows, int_T inCols)
+{
+    T maxAbsVelDiff = 0;
+    const int_T lastRow = inRows - 1;
+
+    for (int_T j = startCol; j < endCol; j++)
+    {
+        const int_T col = j*inRows;
+        const int_T leftOffset  = (j == 0)          ? 0 : -inRows;
+        const int_T rightOffset = (j == (inCols-1)) ? 0 : inRows;
+
+        /* first row of this color in column j */
+        int_T i = (color + j) & 1;
+
+        if (i == 0)
+        {
+            /* top row: the pixel itself replaces its upper neighbor */
+            const int_T ij = col;
+            const int_T ijP1 = (lastRow == 0) ? ij : ij + 1;
+            T d = MWCV_HS_RB_UpdatePixel<T>(outVelC, outVelR, gradCC, gradRC,
+                gradRR, gradCT, gradRT, alpha,
+                ij, ij, ijP1, ij + leftOffset, ij + rightOffset);
+            maxAbsVelDiff = MAX(d, maxAbsVelDiff);
+            i = 2;
+        }
+
+        /* interior rows, without boundary checks */
+        for (; i < lastRow; i += 2)
+        {
+            const int_T ij = col + i;
+            T d = MWCV_HS_RB_UpdatePixel<T>(outVelC, outVelR, gradCC, gradRC,
+                gradRR, gradCT, gradRT, alpha,
+                ij, ij - 1, ij + 1, ij + leftOffset, ij + rightOffset);
+            maxAbsVelDiff = MAX(d, maxAbsVelDiff);
+        }
+
+        if (i == lastRow && lastRow > 0)
+        {
+            /* bottom row: the pixel itself replaces its lower neighbor */
+            const int_T ij = col + lastRow;
+            T d = MWCV_HS_RB_UpdatePixel<T>(outVelC, outVelR, gradCC, gradRC,
+                gradRR, gradCT, gradRT, alpha,
+                ij, ij - 1, ij, ij + leftOffset, ij + rightOffset);
+            maxAbsVelDiff = MAX(d, maxAbsVelDiff);
+        }
+    }
+
+    return maxAbsVelDiff;
+}
+
+#ifdef PARALLEL
+/* reusable barrier for a fixed number of threads */
+class MWCV_HS_RB_Barrier
+{
+public:
+    explicit MWCV_HS_RB_Barrier(int numThreads)
+        : mNumThreads(numThreads), mNumWaiting(0), mGeneration(0) {}
+
+    void wait()
+    {
+        std::unique_lock<std::mutex> lock(mMutex);
+        const unsigned generation = mGeneration;
+        if (++mNumWaiting == mNumThreads)
+        {
+            mNumWaiting = 0;
+            ++mGeneration;
+            mCondition.notify_all();
+        }
+        else
+        {
+            mCondition.wait(lock, [&]{ return generation != mGeneration; });
+        }
+    }
+
+private:
+    std::mutex mMutex;
+    std::condition_variable mCondition;
+    const int mNumThreads;
+    int mNumWaiting;
+    unsigned mGeneration;
+};
+#endif
+
+template <typename ImT, typename T>
+void MWCV_OpticalFlow_HS_RB_DTypes( const ImT  *inImgA, //input image A
+                                    const ImT  *inImgB, //input image B
+                                    T  *outVelC, // output velocity - component along column
+                                    T  *outVelR, // output velocity - component along row
+                                    T  *buffCprev,
+                                    T  *buffCnext,
+                                    T  *buffRprev,
+                                    T  *buffRnext,
+                                    T  *gradCC,
+                                    T  *gradRC,
+                                    T  *gradRR,
+                                    T  *gradCT,
+                                    T  *gradRT,
+                                    T  *alpha,
+                                    const T  *lambda,
+                                    boolean_T useMaxIter,
+                                    boolean_T useAbsVelDiff,
+                                    const int32_T *maxIter,
+                                    const T  *maxAllowableAbsDiffVel,
+                                    int_T  inRows, // num rows of inImgA
+                                    int_T  inCols) // num cols of inImgA
+{
+    const int_T inSize = inRows*inCols;
+
+    MWCV_SobelDerivative_HS_DTypes<ImT, T>( inImgA,
+                                inImgB,
+                                outVelC,/* tmpGradC */
+                                outVelR,/* tmpGradR */
+                                buffCprev,
+                                buffCnext,
+                                buffRprev,
+                                buffRnext,
+                                gradCC,
+                                gradRC,
+                                gradRR,
+                                gradCT,
+                                gradRT,
+                                alpha,
+                                lambda,
+                                inRows,
+                                inCols);
+
+    /* set initial motion vector to zero */
+    memset(outVelC, 0, sizeof(T)*inSize);
+    memset(outVelR, 0, sizeof(T)*inSize);
+
+    int numThreads = 1;
+#ifdef PARALLEL
+    numThreads = (int)std::thread::hardware_concurrency();
+    numThreads = std::max(1, std::min(numThreads,
+                                      (int)(inCols / HS_RB_MIN_COLS_PER_THREAD)));
+#endif
+
+    if (numThreads == 1)
+    {
+        int_T numIter = 1;
+        T maxAbsVelDiff;
+        do
+        {
+            T d0 = MWCV_HS_RB_HalfSweep<T>(outVelC, outVelR, gradCC, gradRC,
+                gradRR, gradCT, gradRT, alpha, 0, 0, inCols, inRows, inCols);
+            T d1 = MWCV_HS_RB_HalfSweep<T>(outVelC, outVelR, gradCC, gradRC,
+                gradRR, gradCT, gradRT, alpha, 1, 0, inCols, inRows, inCols);
+            maxAbsVelDiff = MAX(d0, d1);
+        }
+        while (!(  ( useMaxIter && (numIter++ == maxIter[0]) )
+              ||   ( useAbsVelDiff && (maxAbsVelDiff < maxAllowableAbsDiffVel[0]) )));
+        return;
+    }
+
+#ifdef PARALLEL
+    /* largest velocity change of each thread in the last iteration */
+    std::vector<T> threadMaxAbsVelDiff(numThreads);
+    MWCV_HS_RB_Barrier barrier(numThreads);
+
+    auto solve = [&](int t)
+    {
+        const int_T startCol = (int_T)((long long)inCols * t / numThreads);
+        const int_T endCol   = (int_T)((long long)inCols * (t + 1) / numThreads);
+
+        int_T numIter = 1;
+        T maxAbsVelDiff;
+        do
+        {
+            T d0 = MWCV_HS_RB_HalfSweep<T>(outVelC, outVelR, gradCC, gradRC,
+                gradRR, gradCT, gradRT, alpha, 0, startCol, endCol, inRows, inCols);
+            barrier.wait();
+
+            /* all threads have read the previous maxima at this point */
+            T d1 = MWCV_HS_RB_HalfSweep<T>(outVelC, outVelR, gradCC, gradRC,
+                gradRR, gradCT, gradRT, alpha, 1, startCol, endCol, inRows, inCols);
+            threadMaxAbsVelDiff[t] = MAX(d0, d1);
+            barrier.wait();
+
+            /* every thread takes the same decision */
+            maxAbsVelDiff = 0;
+            for (int k = 0; k < numThreads; ++k)
+            {
+                maxAbsVelDiff = MAX(threadMaxAbsVelDiff[k], maxAbsVelDiff);
+            }
+        }
+        while (!(  ( useMaxIter && (numIter++ == maxIter[0]) )
+              ||   ( useAbsVelDiff && (maxAbsVelDiff < maxAllowableAbsDiffVel[0]) )));
+    };
+
+    std::vector<std::thread> threads;
+    for (int t = 1; t < numThreads; ++t)
+    {
+        threads.push_back(std::thread(solve, t));
+    }
+    solve(0);
+    for (size_t t = 0; t < threads.size(); ++t)
+    {
+        threads[t].join();
+    }
+#endif
+}
+
+/*
+ * Coarse-to-fine Horn-Schunck. The flow of each level of the pyramid is
+ * doubled and resampled to the next finer level, the previous frame is
+ * warped with it and the red-black solver estimates the remaining motion
+ * with the given stopping criteria. numLevels is reduced so that the
+ * coarsest level is at least OF_PYR_MIN_SIZE pixels in each direction.
+ */
+template <typename ImT, typename T>
+void MWCV_OpticalFlow_HS_Pyr_DTypes( const ImT  *inImgA, //input image A
+                                     const ImT  *inImgB, //input image B
+                                     T  *outVelC, // output velocity - component along column
+                                     T  *outVelR, // output velocity - component along row
+                                     const T  *lambda,
+                                     boolean_T useMaxIter,
+                                     boolean_T useAbsVelDiff,
+                                     const int32_T *maxIter,
+                                     const T  *maxAllowableAbsDiffVel,
+                                     int32_T numLevels,
+                                     int_T  inRows, // num rows of inImgA
+                                     int_T  inCols) // num cols of inImgA
+{
+    const int_T inSize = inRows*inCols;
+    if (inSize == 0) return;
+
+    MWCV_OFPyramid<T> pyr(inImgA, inImgB,
+                          MWCV_OFPyr_NumLevels(numLevels, inRows, inCols),
+                          inRows, inCols);
+
+    /* buffers of the finest level are reused by the coarser levels */
+    std::vector<T> velC(inSize), velR(inSize), upVelC(inSize), upVelR(inSize);
+    std::vector<T> dVelC(inSize), dVelR(inSize), warpedB(inSize);
+    std::vector<T> grad(6*inSize);
+    std::vector<T> buffC(2*inRows), buffR(2*inCols);
+
+    for (int_T L = pyr.getNumLevels()-1; L >= 0; L--)
+    {
+        const int_T rows = pyr.getRows(L);
+        const int_T cols = pyr.getCols(L);
+        const int_T size = rows*cols;
+
+        if (L == pyr.getNumLevels()-1)
+        {
+            memset(&velC[0], 0, sizeof(T)*size);
+            memset(&velR[0], 0, sizeof(T)*size);
+        }
+        else
+        {
+            MWCV_OFPyr_UpsampleFlow<T>(&velC[0], &velR[0],
+                pyr.getRows(L+1), pyr.getCols(L+1),
+                &upVelC[0], &upVelR[0], rows, cols);
+            velC.swap(upVelC);
+            velR.swap(upVelR);
+        }
+        MWCV_OFPyr_Warp<T>(pyr.getImageB(L), &velC[0], &velR[0],
+                           rows, cols, &warpedB[0]);
+
+        MWCV_OpticalFlow_HS_RB_DTypes<T, T>(pyr.getImageA(L), &warpedB[0],
+            &dVelC[0], &dVelR[0],
+            &buffC[0], &buffC[rows], &buffR[0], &buffR[cols],
+            &grad[0], &grad[size], &grad[2*size], &grad[3*size],
+            &grad[4*size], &grad[5*size],
+            lambda, useMaxIter, useAbsVelDiff, maxIter,
+            maxAllowableAbsDiffVel, rows, cols);
+
+        for (int_T k = 0; k < size; k++)
+        {
+            velC[k] += dVelC[k];
+            velR[k] += dVelR[k];
+        }
+    }
+
+    memcpy(outVelC, &velC[0], sizeof(T)*inSize);
+    memcpy(outVelR, &velR[0], sizeof(T)*inSize);
+}
+
+#endif /* _OPTICALFLOWHS_REDBLACK_H_ */
@@ -151,6 +151,119 @@ void MWCV_SobelDerivative_HS_DTypes( const ImT  *inImgA,
         alpha[ij] = 1 / (lambda[0] + gradCC[ij] + gradRR[ij]);
     }
 }
+
+/*
+ * Integer Sobel derivatives of uint8 frames for the fixed-point
+ * Horn-Schunck solver. The scans are those of
+ * MWCV_SobelDerivative_HS_DTypes without the 1/(8*255) scaling: gradC and
+ * gradR are 8*255 times the floating point gradients (|g| <= 1020) and
+ * gradT = 8*(B - A) is in the same units. lambda is in the squared units,
+ * see MWCV_OF_HS_FIXPT_LAMBDA. Instead of alpha, the per pixel factors
+ * alphaC = gradC/(lambda + gradC^2 + gradR^2) and alphaR (likewise) are
+ * stored in Q31, below 1/2 in magnitude since lambda is at least 1.
+ */
+template <typename ImT>
+void MWCV_SobelDerivative_HS_Fixpt( const ImT  *inImgA,
+                                    const ImT  *inImgB,
+                                    int32_T  *buffCprev,/* nRows */
+                                    int32_T  *buffCnext,
+                                    int32_T  *buffRprev,/* nCols */
+                                    int32_T  *buffRnext,
+                                    int16_T  *gradC,
+                                    int16_T  *gradR,
+                                    int32_T  *gradT,
+                                    int32_T  *alphaC,
+                                    int32_T  *alphaR,
+                                    int32_T  lambda,
+                                    int_T  inRows,
+                                    int_T  inCols)
+{
+    int_T i, j, ij;
+    int_T im1, ip1, jm1, jp1, jp1TimesR;
+    int32_T tmp;
+    int32_T *buffCprevT = buffCprev;
+    int32_T *buffCnextT = buffCnext;
+    int32_T *buffRprevT = buffRprev;
+    int32_T *buffRnextT = buffRnext;
+    const ImT *inImgAt;
+
+    if (lambda < 1) lambda = 1;
+
+  /********************* Scanning along row *************************/
+    for( i = 0; i < inRows; i++ )
+    {
+       im1 = (i==0)          ? 0 : i-1;
+       ip1 = (i==(inRows-1)) ? i : i+1;
+       buffCprevT[i] = (int32_T)SUM_A_2B_C(inImgA[im1], inImgA[i], inImgA[ip1]);
+    }
+    for( i = 0; i < inRows; i++ )   buffCnextT[i] = buffCprevT[i];
+
+    for( j = 0; j < inCols; j++ )
+    {
+        jp1 = (j==(inCols-1)) ? j : j+1;
+        jp1TimesR = jp1*inRows;
+        for( i = 0; i < inRows; i++ )
+        {
+            im1 = (i==0) ? 0 : i-1;
+            ip1 = (i==(inRows-1)) ? i : i+1;
+            tmp = (int32_T)SUM_A_2B_C(inImgA[im1 + jp1TimesR],
+                                      inImgA[i   + jp1TimesR],
+                                      inImgA[ip1 + jp1TimesR]);
+            gradC[i+j*inRows] = (int16_T)(buffCprevT[i] - tmp);
+            buffCprevT[i] = tmp;
+        }
+        {
+            int32_T *tmpBuff = buffCprevT;
+            buffCprevT = buffCnextT;
+            buffCnextT = tmpBuff;
+        }
+    }
+  /********************* Scanning along column *************************/
+    inImgAt = inImgA;
+    for( j = 0; j < inCols; j++ )
+    {
+        int_T negInRows  = (j==0)          ? 0 : -inRows;
+        int_T plusInRows = (j==(inCols-1)) ? 0 : inRows;
+        buffRprevT[j] = (int32_T)SUM_A_2B_C(inImgAt[negInRows],
+                                            inImgAt[0],
+                                            inImgAt[plusInRows]);
+        inImgAt += inRows;
+    }
+    for( j = 0; j < inCols; j++ )   buffRnextT[j] = buffRprevT[j];
+
+    for( i = 0; i < inRows; i++ )
+    {
+        ip1 = (i==(inRows-1)) ? i : i+1;
+        for( j = 0; j < inCols; j++ )
+        {
+            jm1  = (j==0) ? 0 : j-1;
+            jp1  = (j==(inCols-1)) ? j : j+1;
+            tmp = (int32_T)SUM_A_2B_C(inImgA[ip1 + jm1*inRows],
+                                      inImgA[ip1 + j*inRows],
+                                      inImgA[ip1 + jp1*inRows]);
+            gradR[i+j*inRows] = (int16_T)(buffRprevT[j] - tmp);
+            buffRprevT[j] = tmp;
+        }
+        {
+            int32_T *tmpBuff = buffRprevT;
+            buffRprevT = buffRnextT;
+            buffRnextT = tmpBuff;
+        }
+    }
+  /*******************COMPUTE OTHER GRADIENT VALUES*******************/
+
+    for( ij = 0; ij < inRows*inCols; ij++ )
+    {
+        const int32_T gC = gradC[ij];
+        const int32_T gR = gradR[ij];
+        const long long denom = (long long)lambda + gC*gC + gR*gR;
+
+        gradT[ij]  = 8 * ((int32_T)inImgB[ij] - (int32_T)inImgA[ij]);
+        alphaC[ij] = (int32_T)((gC * 2147483648LL) / denom);
+        alphaR[ij] = (int32_T)((gR * 2147483648LL) / denom);
+    }
+}
+
 /* [EOF] sobelderivative_hs_d_rt.c */
 
 #endif /* _OPTICALFLOWHS_H_SOBEL_ */
\ No newline at end of file
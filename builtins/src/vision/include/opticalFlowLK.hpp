@@ -9,6 +9,61 @@
 
 #include <string.h>
 #include <math.h>
+#include "opticalFlowPyramid.hpp"
+
+/* solves the 2x2 system of one pixel from the weighted gradient products */
+template <typename T>
+inline void MWCV_LK_SolvePixel(T WWGradRR, T WWGradCC, T WWGradRC,
+                               T WWGradRT, T WWGradCT,
+                               T threshEigen, T THRESH_ABS_DELTA, T THRESH_NORM,
+                               T &velC, T &velR)
+{
+    T delta = (WWGradRC * WWGradRC - WWGradCC * WWGradRR);
+    T A = (WWGradCC+WWGradRR)/2.0F;
+    T tmp  = WWGradCC-WWGradRR;
+    T B = 4.0F*WWGradRC*WWGradRC + tmp*tmp;
+    T sqrtBby2 = (T)sqrt(B)/(T)2.0;
+    T eig1=A+sqrtBby2;   /* Largest eigenvalue first  */
+    T eig2=A-sqrtBby2;
+    if ((eig1 >= threshEigen) && (eig2 >= threshEigen) && (fabs(delta)>=THRESH_ABS_DELTA))
+    {
+        /* Solving by Cramer's rule */
+        T deltaC = -(WWGradRT * WWGradRC - WWGradCT * WWGradRR);
+        T deltaR = -(WWGradRC * WWGradCT - WWGradCC * WWGradRT);
+        T Idelta = 1.0F / delta;
+
+        velC = deltaC * Idelta;
+        velR = deltaR * Idelta;
+    }
+    else if ((eig1 >= threshEigen) && (eig2 < threshEigen))
+    {
+        /* singular system - find optical flow in gradient direction */
+        /* singular system, determinant is non-invertible */
+        /* gradient flow is normalized */
+
+        T tmpRC_CC = WWGradRC + WWGradCC;
+        T tmpRR_RC = WWGradRR + WWGradRC;
+        T norm = tmpRC_CC*tmpRC_CC + tmpRR_RC*tmpRR_RC;
+
+        if( norm >= THRESH_NORM )
+        {
+            T invNorm = 1.0F / norm;
+            T temp = -(WWGradRT + WWGradCT) * invNorm;
+            velC = tmpRC_CC * temp;
+            velR = tmpRR_RC * temp;
+        }
+        else
+        {
+            velC = 0;
+            velR = 0;
+        }
+    }
+    else
+    {
+        velC = 0;
+        velR = 0;
+    }
+}
 
 template <typename ImT, typename T> 
 void MWCV_OpticalFlow_LK_DTypes( const ImT  *inImgA, //input image A
@@ -323,61 +378,80 @@ void MWCV_OpticalFlow_LK_DTypes( const ImT  *inImgA, //input image A
             /************************************************************************/
             /********************** Solve Linear System *****************************/
             /************************************************************************/
-            {
-                T delta = (WWGradRC * WWGradRC - WWGradCC * WWGradRR);
-                T A = (WWGradCC+WWGradRR)/2.0F;
-                T tmp  = WWGradCC-WWGradRR;
-                T B = 4.0F*WWGradRC*WWGradRC + tmp*tmp;
-                T sqrtBby2 = (T)sqrt(B)/(T)2.0;
-                T eig1=A+sqrtBby2;   /* Largest eigenvalue first  */
-                T eig2=A-sqrtBby2;
-                if ((eig1 >= threshEigen) && (eig2 >= threshEigen) && (fabs(delta)>=THRESH_ABS_DELTA))
-                {
-                    /* Solving by Cramer's rule */
-                    T deltaC = -(WWGradRT * WWGradRC - WWGradCT * WWGradRR);
-                    T deltaR = -(WWGradRC * WWGradCT - WWGradCC * WWGradRT);
-                    T Idelta = 1.0F / delta;
-
-                    outVelC[mn] = deltaC * Idelta;
-                    outVelR[mn] = deltaR * Idelta;
-                    mn++;
-                }
-                else if ((eig1 >= threshEigen) && (eig2 < threshEigen))
-                {
-                    /* singular system - find optical flow in gradient direction */
-                    /* singular system, determinant is non-invertible */
-                    /* gradient flow is normalized */
-
-                    T tmpRC_CC = WWGradRC + WWGradCC;
-                    T tmpRR_RC = WWGradRR + WWGradRC;
-                    T norm = tmpRC_CC*tmpRC_CC + tmpRR_RC*tmpRR_RC;
-
-                    if( norm >= THRESH_NORM )
-                    {
-                        T invNorm = 1.0F / norm;
-                        T temp = -(WWGradRT + WWGradCT) * invNorm;
-                        outVelC[mn] = tmpRC_CC * temp;
-                        outVelR[mn] = tmpRR_RC * temp;
-
-                        mn++;
-                    }
-                    else
-                    {
-                        outVelC[mn] = 0;
-                        outVelR[mn] = 0;
-                        mn++;
-                    }
-                }
-                else
-                {
-                    outVelC[mn] = 0;
-                    outVelR[mn] = 0;
-                    mn++;
-                }
-            }
+            MWCV_LK_SolvePixel<T>(WWGradRR, WWGradCC, WWGradRC, WWGradRT, WWGradCT,
+                                  threshEigen, THRESH_ABS_DELTA, THRESH_NORM,
+                                  outVelC[mn], outVelR[mn]);
+            mn++;
+        }
+    }
+
+}
+
+/*
+ * Coarse-to-fine Lucas-Kanade. The flow of each level of the pyramid is
+ * doubled and resampled to the next finer level, the previous frame is
+ * warped with it and only the remaining motion is estimated. numLevels is
+ * reduced so that the coarsest level is at least OF_PYR_MIN_SIZE pixels in
+ * each direction.
+ */
+template <typename ImT, typename T>
+void MWCV_OpticalFlow_LK_Pyr_DTypes( const ImT  *inImgA, //input image A
+                                     const ImT  *inImgB, //input image B
+                                     T  *outVelC, // output velocity - component along column
+                                     T  *outVelR, // output velocity - component along row
+                                     const T  *eigTh,
+                                     int32_T numLevels,
+                                     int_T  inRows,
+                                     int_T  inCols)
+{
+    const int_T inSize = inRows*inCols;
+    if (inSize == 0) return;
+
+    MWCV_OFPyramid<T> pyr(inImgA, inImgB,
+                          MWCV_OFPyr_NumLevels(numLevels, inRows, inCols),
+                          inRows, inCols);
+
+    /* buffers of the finest level are reused by the coarser levels */
+    std::vector<T> velC(inSize), velR(inSize), upVelC(inSize), upVelR(inSize);
+    std::vector<T> dVelC(inSize), dVelR(inSize), warpedB(inSize);
+    std::vector<T> grad(5*inSize);
+
+    for (int_T L = pyr.getNumLevels()-1; L >= 0; L--)
+    {
+        const int_T rows = pyr.getRows(L);
+        const int_T cols = pyr.getCols(L);
+        const int_T size = rows*cols;
+
+        if (L == pyr.getNumLevels()-1)
+        {
+            memset(&velC[0], 0, sizeof(T)*size);
+            memset(&velR[0], 0, sizeof(T)*size);
+        }
+        else
+        {
+            MWCV_OFPyr_UpsampleFlow<T>(&velC[0], &velR[0],
+                pyr.getRows(L+1), pyr.getCols(L+1),
+                &upVelC[0], &upVelR[0], rows, cols);
+            velC.swap(upVelC);
+            velR.swap(upVelR);
+        }
+        MWCV_OFPyr_Warp<T>(pyr.getImageB(L), &velC[0], &velR[0],
+                           rows, cols, &warpedB[0]);
+
+        MWCV_OpticalFlow_LK_DTypes<T, T>(pyr.getImageA(L), &warpedB[0],
+            &dVelC[0], &dVelR[0],
+            &grad[0], &grad[size], &grad[2*size], &grad[3*size],
+            &grad[4*size], eigTh, rows, cols);
+
+        for (int_T k = 0; k < size; k++)
+        {
+            velC[k] += dVelC[k];
+            velR[k] += dVelR[k];
         }
     }
 
+    memcpy(outVelC, &velC[0], sizeof(T)*inSize);
+    memcpy(outVelR, &velR[0], sizeof(T)*inSize);
 }
 
 #endif /* _OPTICALFLOWLK_H_ */
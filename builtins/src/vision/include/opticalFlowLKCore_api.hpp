@@ -5,6 +5,14 @@
 
 #include "vision_defines.h"
 
+/* fractional bits of the velocities of the fixed-point solvers */
+#ifndef MWCV_OF_FIXPT_FRAC_BITS
+#define MWCV_OF_FIXPT_FRAC_BITS 12
+#endif
+
+/* eigTh of MWCV_OpticalFlow_LK_uint8 in the units of the fixed-point solver */
+#define MWCV_OF_LK_FIXPT_EIGTH(eigTh) ((int32_T)((eigTh) * 9363600.0 + 0.5))
+
 EXTERN_C LIBMWCVSTRT_API void MWCV_OpticalFlow_LK_double(const real_T  *inImgA,
                                         const real_T  *inImgB, 
                                         real_T  *outVelC, 
@@ -43,4 +51,75 @@ EXTERN_C LIBMWCVSTRT_API void MWCV_OpticalFlow_LK_uint8(const uint8_T  *inImgA,
                                         const real32_T  *eigTh,
                                         int_T  inRows,
                                         int_T  inCols);
+
+/* Fixed-point solver; velocities are in Q(MWCV_OF_FIXPT_FRAC_BITS) pixels
+ * and eigTh in MWCV_OF_LK_FIXPT_EIGTH units */
+EXTERN_C LIBMWCVSTRT_API void MWCV_OpticalFlow_LK_uint8_fixpt(const uint8_T  *inImgA,
+                                        const uint8_T  *inImgB, 
+                                        int32_T  *outVelC, 
+                                        int32_T  *outVelR, 
+                                        int32_T  *gradCC,
+                                        int32_T  *gradRC,
+                                        int32_T  *gradRR,
+                                        int32_T  *gradCT,
+                                        int32_T  *gradRT,
+                                        const int32_T  *eigTh,
+                                        int_T  inRows,
+                                        int_T  inCols);
+
+/* Coarse-to-fine solver on an image pyramid of at most numLevels levels */
+EXTERN_C LIBMWCVSTRT_API void MWCV_OpticalFlow_LK_Pyr_double( const real_T  *inImgA, 
+                                        const real_T  *inImgB, 
+                                        real_T  *outVelC, 
+                                        real_T  *outVelR, 
+                                        const real_T  *eigTh, 
+                                        int32_T numLevels, 
+                                        int_T  inRows, 
+                                        int_T  inCols);
+
+EXTERN_C LIBMWCVSTRT_API void MWCV_OpticalFlow_LK_Pyr_single( const real32_T  *inImgA, 
+                                        const real32_T  *inImgB, 
+                                        real32_T  *outVelC, 
+                                        real32_T  *outVelR, 
+                                        const real32_T  *eigTh, 
+                                        int32_T numLevels, 
+                                        int_T  inRows, 
+                                        int_T  inCols);
+
+EXTERN_C LIBMWCVSTRT_API void MWCV_OpticalFlow_LK_Pyr_uint8( const uint8_T  *inImgA, 
+                                        const uint8_T  *inImgB, 
+                                        real32_T  *outVelC, 
+                                        real32_T  *outVelR, 
+                                        const real32_T  *eigTh, 
+                                        int32_T numLevels, 
+                                        int_T  inRows, 
+                                        int_T  inCols);
+
+/* Single pass solver; lineBuffer holds 30*inRows elements */
+EXTERN_C LIBMWCVSTRT_API void MWCV_OpticalFlow_LK_Fused_double( const real_T  *inImgA, 
+                                        const real_T  *inImgB, 
+                                        real_T  *outVelC, 
+                                        real_T  *outVelR, 
+                                        real_T  *lineBuffer, 
+                                        const real_T  *eigTh, 
+                                        int_T  inRows, 
+                                        int_T  inCols);
+
+EXTERN_C LIBMWCVSTRT_API void MWCV_OpticalFlow_LK_Fused_single( const real32_T  *inImgA, 
+                                        const real32_T  *inImgB, 
+                                        real32_T  *outVelC, 
+                                        real32_T  *outVelR, 
+                                        real32_T  *lineBuffer, 
+                                        const real32_T  *eigTh, 
+                                        int_T  inRows, 
+                                        int_T  inCols);
+
+EXTERN_C LIBMWCVSTRT_API void MWCV_OpticalFlow_LK_Fused_uint8( const uint8_T  *inImgA, 
+                                        const uint8_T  *inImgB, 
+                                        real32_T  *outVelC, 
+                                        real32_T  *outVelR, 
+                                        real32_T  *lineBuffer, 
+                                        const real32_T  *eigTh, 
+                                        int_T  inRows, 
+                                        int_T  inCols);
 #endif
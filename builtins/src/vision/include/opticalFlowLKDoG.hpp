@@ -87,36 +87,29 @@ void MWCV_populateAddressBuffer(const ImT  *inImgA,
         portAddressBuffer[k++] = &delayBuffer[(allIdx[i]-1)*frameWidth];//allIdx[ii] is 1 based;
 }
 
-template <typename ImT, typename T> 
-void MWCV_OpticalFlow_LKDoG_DTypes( const ImT **portAddressBuffer,   
-                                            T  *outVelC, // output velocity - component along column
-                                            T  *outVelR, // output velocity - component along row
-                                            T  *dx, /* xx => gradCC */
-                                            T  *dy, /* yy => gradRC */
-                                            T  *dt, /* xy => gradRR */
-                                            T  *xt, /* gradCT */
-                                            T  *yt, /* gradRT */
-                                            const T *eigTh,
-                                            const T *tGradKernel,
-                                            const T *sGradKernel,
-                                            const T *tKernel,
-                                            const T *sKernel,
-                                            const T *wKernel,
-                                            int_T   inRows,
-                                            int_T   inCols,
-                                            int_T tGradKernelLen,
-                                            int_T sGradKernelLen,
-                                            int_T tKernelLen,
-                                            int_T sKernelLen,
-                                            int_T wKernelLen,
-                                            boolean_T includeNormalFlow)
+/*
+ * Computes the velocity from the spatio-temporal derivatives dx, dy and dt:
+ * forms their products, weights them with wKernel and solves the 2x2
+ * system of each pixel. dx, dy and dt are overwritten; outVelC is used as
+ * a temporary buffer before it receives the velocity.
+ */
+template <typename T>
+void MWCV_OpticalFlow_LKDoG_Solve(T  *outVelC, // output velocity - component along column
+                                  T  *outVelR, // output velocity - component along row
+                                  T  *dx, /* xx => gradCC */
+                                  T  *dy, /* yy => gradRC */
+                                  T  *dt, /* xy => gradRR */
+                                  T  *xt, /* gradCT */
+                                  T  *yt, /* gradRT */
+                                  const T *eigTh,
+                                  const T *wKernel,
+                                  int_T   inRows,
+                                  int_T   inCols,
+                                  int_T wKernelLen,
+                                  boolean_T includeNormalFlow)
 {
     T threshEigen = eigTh[0]; 
     int_T i, j, idx;
-    int_T numInFrames;
-    const int_T inWidth = inRows*inCols;
-    int_T startPortIdx_tKer=0;
-    int_T startPortIdx_tGker=0;
     int_T halfwKernelLen = wKernelLen >>1; 
     T *tempBuf = (T *)outVelC;
     T *xx;
@@ -125,43 +118,6 @@ void MWCV_OpticalFlow_LKDoG_DTypes( const ImT **portAddressBuffer,
     T tmp_dx, tmp_dy, tmp_dt;
     T velRe, velIm;
 
-    if (tGradKernelLen > tKernelLen)
-    {
-        startPortIdx_tKer = (tGradKernelLen - tKernelLen)>>1;/* divide by 2 */
-        numInFrames = tGradKernelLen;
-    }
-    else
-    {
-        startPortIdx_tGker = (tKernelLen - tGradKernelLen)>>1; 
-        numInFrames = tKernelLen;
-    } 
-
-    /* Temporal convolution */
-    /* dx = convolvet(im, tKernel); */
-    MWCV_OFLK_ConvT_T<ImT, T>((const ImT **)&portAddressBuffer[startPortIdx_tKer], 
-                       dx, tKernel, inWidth, tKernelLen);
-    /* dy = dx; */
-    memcpy(dy, dx, inWidth*sizeof(T));
-    /* dt = convolvet(im, tGradKernel); */
-    MWCV_OFLK_ConvT_T<ImT, T>((const ImT **)&portAddressBuffer[startPortIdx_tGker], 
-                       dt, tGradKernel, inWidth, tGradKernelLen);
-
-    /* Spatial convolution */
-    /* tempBuf = convolvex(dx, sGradKernel); */
-    MWCV_OFLK_ConvX_T<T>(dx, tempBuf, sGradKernel, inRows, inCols, sGradKernelLen);
-    /* dx = convolvey(tempBuf, sKernel'); */
-    MWCV_OFLK_ConvY_T<T>(tempBuf, dx, sKernel, inRows, inCols, sKernelLen);
-
-    /* tempBuf = convolvex(dy, sKernel); */
-    MWCV_OFLK_ConvX_T<T>(dy, tempBuf, sKernel, inRows, inCols, sKernelLen);
-    /* dy = convolvey(tempBuf, sGradKernel'); */
-    MWCV_OFLK_ConvY_T<T>(tempBuf, dy, sGradKernel, inRows, inCols, sGradKernelLen);
-
-    /* tempBuf = convolvex(dt, sKernel); */
-    MWCV_OFLK_ConvX_T<T>(dt, tempBuf, sKernel, inRows, inCols, sKernelLen);
-    /* dt = convolvey(tempBuf, sKernel'); */
-    MWCV_OFLK_ConvY_T<T>(tempBuf, dt, sKernel, inRows, inCols, sKernelLen);
-
     /* xx = dx.*dx; */
     /* yy = dy.*dy; */
     /* xy = dx.*dy; */
@@ -264,4 +220,76 @@ void MWCV_OpticalFlow_LKDoG_DTypes( const ImT **portAddressBuffer,
     }
 }
 
+template <typename ImT, typename T> 
+void MWCV_OpticalFlow_LKDoG_DTypes( const ImT **portAddressBuffer,   
+                                            T  *outVelC, // output velocity - component along column
+                                            T  *outVelR, // output velocity - component along row
+                                            T  *dx, /* xx => gradCC */
+                                            T  *dy, /* yy => gradRC */
+                                            T  *dt, /* xy => gradRR */
+                                            T  *xt, /* gradCT */
+                                            T  *yt, /* gradRT */
+                                            const T *eigTh,
+                                            const T *tGradKernel,
+                                            const T *sGradKernel,
+                                            const T *tKernel,
+                                            const T *sKernel,
+                                            const T *wKernel,
+                                            int_T   inRows,
+                                            int_T   inCols,
+                                            int_T tGradKernelLen,
+                                            int_T sGradKernelLen,
+                                            int_T tKernelLen,
+                                            int_T sKernelLen,
+                                            int_T wKernelLen,
+                                            boolean_T includeNormalFlow)
+{
+    int_T numInFrames;
+    const int_T inWidth = inRows*inCols;
+    int_T startPortIdx_tKer=0;
+    int_T startPortIdx_tGker=0;
+    T *tempBuf = (T *)outVelC;
+
+    if (tGradKernelLen > tKernelLen)
+    {
+        startPortIdx_tKer = (tGradKernelLen - tKernelLen)>>1;/* divide by 2 */
+        numInFrames = tGradKernelLen;
+    }
+    else
+    {
+        startPortIdx_tGker = (tKernelLen - tGradKernelLen)>>1; 
+        numInFrames = tKernelLen;
+    } 
+
+    /* Temporal convolution */
+    /* dx = convolvet(im, tKernel); */
+    MWCV_OFLK_ConvT_T<ImT, T>((const ImT **)&portAddressBuffer[startPortIdx_tKer], 
+                       dx, tKernel, inWidth, tKernelLen);
+    /* dy = dx; */
+    memcpy(dy, dx, inWidth*sizeof(T));
+    /* dt = convolvet(im, tGradKernel); */
+    MWCV_OFLK_ConvT_T<ImT, T>((const ImT **)&portAddressBuffer[startPortIdx_tGker], 
+                       dt, tGradKernel, inWidth, tGradKernelLen);
+
+    /* Spatial convolution */
+    /* tempBuf = convolvex(dx, sGradKernel); */
+    MWCV_OFLK_ConvX_T<T>(dx, tempBuf, sGradKernel, inRows, inCols, sGradKernelLen);
+    /* dx = convolvey(tempBuf, sKernel'); */
+    MWCV_OFLK_ConvY_T<T>(tempBuf, dx, sKernel, inRows, inCols, sKernelLen);
+
+    /* tempBuf = convolvex(dy, sKernel); */
+    MWCV_OFLK_ConvX_T<T>(dy, tempBuf, sKernel, inRows, inCols, sKernelLen);
+    /* dy = convolvey(tempBuf, sGradKernel'); */
+    MWCV_OFLK_ConvY_T<T>(tempBuf, dy, sGradKernel, inRows, inCols, sGradKernelLen);
+
+    /* tempBuf = convolvex(dt, sKernel); */
+    MWCV_OFLK_ConvX_T<T>(dt, tempBuf, sKernel, inRows, inCols, sKernelLen);
+    /* dt = convolvey(tempBuf, sKernel'); */
+    MWCV_OFLK_ConvY_T<T>(tempBuf, dt, sKernel, inRows, inCols, sKernelLen);
+
+    MWCV_OpticalFlow_LKDoG_Solve<T>(outVelC, outVelR, dx, dy, dt, xt, yt,
+                                    eigTh, wKernel, inRows, inCols,
+                                    wKernelLen, includeNormalFlow);
+}
+
 #endif /* _OPTICALFLOWLKDOG_H_ */
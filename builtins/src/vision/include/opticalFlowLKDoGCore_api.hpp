@@ -82,4 +82,72 @@ EXTERN_C LIBMWCVSTRT_API void MWCV_OpticalFlow_LKDoG_uint8( const uint8_T  *inIm
                                             int_T sKernelLen,
                                             int_T wKernelLen,
                                             boolean_T includeNormalFlow);
+
+/* Streaming mode: the filtered frames are kept between steps */
+EXTERN_C LIBMWCVSTRT_API void MWCV_OpticalFlow_LKDoG_Stream_construct_double( void **ptr2ptrClass,
+                                            const real_T *tGradKernel,
+                                            const real_T *sGradKernel,
+                                            const real_T *tKernel,
+                                            const real_T *sKernel,
+                                            const real_T *wKernel,
+                                            int_T   inRows,
+                                            int_T   inCols,
+                                            int_T tGradKernelLen,
+                                            int_T sGradKernelLen,
+                                            int_T tKernelLen,
+                                            int_T sKernelLen,
+                                            int_T wKernelLen);
+EXTERN_C LIBMWCVSTRT_API void MWCV_OpticalFlow_LKDoG_Stream_step_double( void *ptrClass,
+                                            const real_T  *inImgA,
+                                            real_T  *outVelC, /* output velocity - component along column */
+                                            real_T  *outVelR, /* output velocity - component along row */
+                                            const real_T *eigTh,
+                                            boolean_T includeNormalFlow);
+EXTERN_C LIBMWCVSTRT_API void MWCV_OpticalFlow_LKDoG_Stream_reset_double(void *ptrClass);
+EXTERN_C LIBMWCVSTRT_API void MWCV_OpticalFlow_LKDoG_Stream_deleteObj_double(void *ptrClass);
+
+EXTERN_C LIBMWCVSTRT_API void MWCV_OpticalFlow_LKDoG_Stream_construct_single( void **ptr2ptrClass,
+                                            const real32_T *tGradKernel,
+                                            const real32_T *sGradKernel,
+                                            const real32_T *tKernel,
+                                            const real32_T *sKernel,
+                                            const real32_T *wKernel,
+                                            int_T   inRows,
+                                            int_T   inCols,
+                                            int_T tGradKernelLen,
+                                            int_T sGradKernelLen,
+                                            int_T tKernelLen,
+                                            int_T sKernelLen,
+                                            int_T wKernelLen);
+EXTERN_C LIBMWCVSTRT_API void MWCV_OpticalFlow_LKDoG_Stream_step_single( void *ptrClass,
+                                            const real32_T  *inImgA,
+                                            real32_T  *outVelC, /* output velocity - component along column */
+                                            real32_T  *outVelR, /* output velocity - component along row */
+                                            const real32_T *eigTh,
+                                            boolean_T includeNormalFlow);
+EXTERN_C LIBMWCVSTRT_API void MWCV_OpticalFlow_LKDoG_Stream_reset_single(void *ptrClass);
+EXTERN_C LIBMWCVSTRT_API void MWCV_OpticalFlow_LKDoG_Stream_deleteObj_single(void *ptrClass);
+
+EXTERN_C LIBMWCVSTRT_API void MWCV_OpticalFlow_LKDoG_Stream_construct_uint8( void **ptr2ptrClass,
+                                            const real32_T *tGradKernel,
+                                            const real32_T *sGradKernel,
+                                            const real32_T *tKernel,
+                                            const real32_T *sKernel,
+                                            const real32_T *wKernel,
+                                            int_T   inRows,
+                                            int_T   inCols,
+                                            int_T tGradKernelLen,
+                                            int_T sGradKernelLen,
+                                            int_T tKernelLen,
+                                            int_T sKernelLen,
+                                            int_T wKernelLen);
+EXTERN_C LIBMWCVSTRT_API void MWCV_OpticalFlow_LKDoG_Stream_step_uint8( void *ptrClass,
+                                            const uint8_T  *inImgA,
+                                            real32_T  *outVelC, /* output velocity - component along column */
+                                            real32_T  *outVelR, /* output velocity - component along row */
+                                            const real32_T *eigTh,
+                                            boolean_T includeNormalFlow);
+EXTERN_C LIBMWCVSTRT_API void MWCV_OpticalFlow_LKDoG_Stream_reset_uint8(void *ptrClass);
+EXTERN_C LIBMWCVSTRT_API void MWCV_OpticalFlow_LKDoG_Stream_deleteObj_uint8(void *ptrClass);
+
 #endif
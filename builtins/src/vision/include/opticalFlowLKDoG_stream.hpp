@@ -0,0 +1,189 @@
+/*
+ *  Function for Optical Flow
+ *  (Lucas & Kanade method - Gaussian derivative).
+ *  Streaming mode
+ *
+ *  The spatial and temporal filters are separable and linear, so they can
+ *  be applied in either order. MWCV_OpticalFlow_LKDoG_DTypes filters the
+ *  whole frame history temporally and then filters the result spatially.
+ *  The stream instead filters each frame spatially once, when it arrives,
+ *  and keeps the three filtered planes of the last numInFrames frames in a
+ *  ring buffer:
+ *
+ *     P1 = convolvey(convolvex(im, sGradKernel), sKernel')   -> dx
+ *     P2 = convolvey(convolvex(im, sKernel), sGradKernel')   -> dy
+ *     P3 = convolvey(convolvex(im, sKernel), sKernel')       -> dt
+ *
+ *  Each step only filters the newest frame spatially; dx, dy and dt are
+ *  then weighted sums of the stored planes. Before numInFrames frames have
+ *  been seen, the missing frames are zero, as in the delay buffer of
+ *  opticalFlowLKDoG.
+ *
+ *  Copyright 2016 The MathWorks, Inc.
+ */
+#ifndef OPTICALFLOWLKDOG_STREAM_H
+#define OPTICALFLOWLKDOG_STREAM_H
+
+#include <algorithm>
+#include <vector>
+#include "opticalFlowLKDoG.hpp"
+
+template <typename ImT, typename T>
+class MWCV_OFLKDoG_Stream
+{
+public:
+    MWCV_OFLKDoG_Stream(const T *tGradKernel,
+                        const T *sGradKernel,
+                        const T *tKernel,
+                        const T *sKernel,
+                        const T *wKernel,
+                        int_T   inRows,
+                        int_T   inCols,
+                        int_T tGradKernelLen,
+                        int_T sGradKernelLen,
+                        int_T tKernelLen,
+                        int_T sKernelLen,
+                        int_T wKernelLen)
+        : mTGradKernel(tGradKernel, tGradKernel + tGradKernelLen),
+          mSGradKernel(sGradKernel, sGradKernel + sGradKernelLen),
+          mTKernel(tKernel, tKernel + tKernelLen),
+          mSKernel(sKernel, sKernel + sKernelLen),
+          mWKernel(wKernel, wKernel + wKernelLen),
+          mInRows(inRows), mInCols(inCols),
+          mStartPortIdx_tKer(0), mStartPortIdx_tGker(0),
+          mNewestSlot(0)
+    {
+        if (tGradKernelLen > tKernelLen)
+        {
+            mStartPortIdx_tKer = (tGradKernelLen - tKernelLen)>>1;/* divide by 2 */
+            mNumInFrames = tGradKernelLen;
+        }
+        else
+        {
+            mStartPortIdx_tGker = (tKernelLen - tGradKernelLen)>>1;
+            mNumInFrames = tKernelLen;
+        }
+
+        const int_T inWidth = inRows*inCols;
+        mFrame.resize(inWidth);
+        mTempBuf.resize(inWidth);
+        mPlanes.resize(3*mNumInFrames*inWidth);
+        mDx.resize(inWidth);
+        mDy.resize(inWidth);
+        mDt.resize(inWidth);
+        mXt.resize(inWidth);
+        mYt.resize(inWidth);
+    }
+
+    /* forgets all frames */
+    void reset()
+    {
+        std::fill(mPlanes.begin(), mPlanes.end(), (T)0);
+        mNewestSlot = 0;
+    }
+
+    /* adds the newest frame and computes the velocity of the center frame */
+    void step(const ImT *inImg,
+              T  *outVelC, // output velocity - component along column
+              T  *outVelR, // output velocity - component along row
+              const T *eigTh,
+              boolean_T includeNormalFlow)
+    {
+        const int_T inWidth = mInRows*mInCols;
+
+        boolean_T usingUint8 = (sizeof(ImT) != sizeof(T));
+        T ONE_BY_RANGE  = usingUint8 ?  (T)(1.0/255.0) : (T)(1.0);
+        for (int_T i = 0; i < inWidth; i++)
+        {
+            mFrame[i] = (T)inImg[i]*ONE_BY_RANGE;
+        }
+
+        /* the oldest slot receives the newest frame */
+        mNewestSlot = (mNewestSlot + 1) % mNumInFrames;
+        T *p1 = getPlane(0, mNewestSlot);
+        T *p2 = getPlane(1, mNewestSlot);
+        T *p3 = getPlane(2, mNewestSlot);
+
+        /* Spatial convolution of the newest frame only */
+        MWCV_OFLK_ConvX_T<T, T>(&mFrame[0], &mTempBuf[0], &mSGradKernel[0],
+                                mInRows, mInCols, (int_T)mSGradKernel.size());
+        MWCV_OFLK_ConvY_T<T>(&mTempBuf[0], p1, &mSKernel[0],
+                             mInRows, mInCols, (int_T)mSKernel.size());
+
+        MWCV_OFLK_ConvX_T<T, T>(&mFrame[0], &mTempBuf[0], &mSKernel[0],
+                                mInRows, mInCols, (int_T)mSKernel.size());
+        MWCV_OFLK_ConvY_T<T>(&mTempBuf[0], p2, &mSGradKernel[0],
+                             mInRows, mInCols, (int_T)mSGradKernel.size());
+        /* P3 shares the horizontal pass of P2 */
+        MWCV_OFLK_ConvY_T<T>(&mTempBuf[0], p3, &mSKernel[0],
+                             mInRows, mInCols, (int_T)mSKernel.size());
+
+        /* Temporal convolution of the stored planes */
+        convolveT(0, &mDx[0], mTKernel, mStartPortIdx_tKer);
+        convolveT(1, &mDy[0], mTKernel, mStartPortIdx_tKer);
+        convolveT(2, &mDt[0], mTGradKernel, mStartPortIdx_tGker);
+
+        MWCV_OpticalFlow_LKDoG_Solve<T>(outVelC, outVelR,
+                                        &mDx[0], &mDy[0], &mDt[0],
+                                        &mXt[0], &mYt[0], eigTh,
+                                        &mWKernel[0], mInRows, mInCols,
+                                        (int_T)mWKernel.size(),
+                                        includeNormalFlow);
+    }
+
+private:
+    /* filtered plane of the frame in slot */
+    T *getPlane(int_T plane, int_T slot)
+    {
+        return &mPlanes[(plane*mNumInFrames + slot)*mInRows*mInCols];
+    }
+
+    /* out = sum of kernel[k] times the plane of port
+     * startPortIdx + kernelLen-1-k; port 0 is the newest frame */
+    void convolveT(int_T plane, T *out, const std::vector<T> &kernel,
+                   int_T startPortIdx)
+    {
+        const int_T inWidth = mInRows*mInCols;
+        const int_T kernelLen = (int_T)kernel.size();
+
+        memset(out, 0, inWidth*sizeof(T));
+        for (int_T k = 0; k < kernelLen; k++)
+        {
+            const int_T port = startPortIdx + kernelLen-1-k;
+            const int_T slot = (mNewestSlot - port + mNumInFrames) % mNumInFrames;
+            const T *in = getPlane(plane, slot);
+            const T c = kernel[k];
+            for (int_T i = 0; i < inWidth; i++)
+            {
+                out[i] += in[i]*c;
+            }
+        }
+    }
+
+    std::vector<T> mTGradKernel;
+    std::vector<T> mSGradKernel;
+    std::vector<T> mTKernel;
+    std::vector<T> mSKernel;
+    std::vector<T> mWKernel;
+
+    int_T mInRows;
+    int_T mInCols;
+    int_T mNumInFrames;
+    int_T mStartPortIdx_tKer;
+    int_T mStartPortIdx_tGker;
+
+    /* ring buffer: 3 planes of mNumInFrames frames */
+    std::vector<T> mPlanes;
+    int_T mNewestSlot;
+
+    /* newest frame converted to T, and work buffers */
+    std::vector<T> mFrame;
+    std::vector<T> mTempBuf;
+    std::vector<T> mDx;
+    std::vector<T> mDy;
+    std::vector<T> mDt;
+    std::vector<T> mXt;
+    std::vector<T> mYt;
+};
+
+#endif
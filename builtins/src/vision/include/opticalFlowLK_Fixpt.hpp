@@ -0,0 +1,303 @@
+/*
+ * This file contains the optical flow Lucas-Kanade (difference filter)
+ * algorithm in fixed-point arithmetic, for uint8 video on targets without
+ * a fast floating point unit.
+ *
+ * The filters and their boundary handling are those of
+ * MWCV_OpticalFlow_LK_DTypes with integer taps: the derivative kernel is
+ * {-1,8,0,-8,1} and gradT = 12*(B - A), so all gradients are 12*255 times
+ * the floating point ones (at most 2295 and 3060 in magnitude) and their
+ * products fit in int32.
+ * Each pass of the Gaussian {1,4,6,4,1} is divided by 16 with rounding.
+ * The 2x2 system is solved in 64-bit integers, the eigenvalue tests are
+ * done on squares so that no square root is needed, and the velocities
+ * are int32 with MWCV_OF_FIXPT_FRAC_BITS fractional bits.
+ *
+ *  Copyright 2016 The MathWorks, Inc.
+ */
+
+#ifndef _OPTICALFLOWLK_FIXPT_H_
+#define _OPTICALFLOWLK_FIXPT_H_
+
+#include <string.h>
+
+#if defined(__ARM_NEON__) || defined(__ARM_NEON)
+#include <arm_neon.h>
+#define MWCV_LK_FIXPT_NEON 1
+#endif
+
+/* fractional bits of the fixed-point velocities */
+#ifndef MWCV_OF_FIXPT_FRAC_BITS
+#define MWCV_OF_FIXPT_FRAC_BITS 12
+#endif
+
+/* largest eigenvalue threshold, so that its squares fit in 64 bits */
+#define MWCV_LK_FIXPT_MAX_EIGTH (1 << 28)
+
+/* {1,4,6,4,1}/16 of 1 to 5 taps, rounded */
+#define MWCV_LK_FIXPT_ROUND16(sum) (((sum) + 8) >> 4)
+
+/*
+ * Solves the 2x2 system of one pixel from the weighted gradient products,
+ * as MWCV_LK_SolvePixel with THRESH_ABS_DELTA and THRESH_NORM of 0. With
+ * S = CC + RR - 2*threshEigen and B = (CC - RR)^2 + 4*RC^2, the smaller
+ * eigenvalue is at least threshEigen when S >= sqrt(B), and the larger one
+ * when S >= -sqrt(B).
+ */
+inline void MWCV_LK_SolvePixel_Fixpt(int32_T WWGradRR, int32_T WWGradCC, int32_T WWGradRC,
+                                     int32_T WWGradRT, int32_T WWGradCT,
+                                     int32_T threshEigen,
+                                     int32_T &velC, int32_T &velR)
+{
+    const long long RR = WWGradRR, CC = WWGradCC, RC = WWGradRC;
+    const long long RT = WWGradRT, CT = WWGradCT;
+    const long long S = CC + RR - 2*(long long)threshEigen;
+    const long long tmp = CC - RR;
+    const long long B = 4*RC*RC + tmp*tmp;
+    const long long SS = S*S;
+    const boolean_T eig1Ok = (S >= 0) || (SS <= B);
+    const boolean_T eig2Ok = (S >= 0) && (SS >= B);
+    const long long delta = RC*RC - CC*RR;
+
+    velC = 0;
+    velR = 0;
+    if (eig1Ok && eig2Ok)
+    {
+        if (delta != 0)
+        {
+            /* Solving by Cramer's rule */
+            const long long deltaC = -(RT*RC - CT*RR);
+            const long long deltaR = -(RC*CT - CC*RT);
+            velC = (int32_T)((deltaC * (1 << MWCV_OF_FIXPT_FRAC_BITS)) / delta);
+            velR = (int32_T)((deltaR * (1 << MWCV_OF_FIXPT_FRAC_BITS)) / delta);
+        }
+    }
+    else if (eig1Ok)
+    {
+        /* singular system - find optical flow in gradient direction */
+        const long long tmpRC_CC = RC + CC;
+        const long long tmpRR_RC = RR + RC;
+        const long long norm = tmpRC_CC*tmpRC_CC + tmpRR_RC*tmpRR_RC;
+        if (norm > 0)
+        {
+            const long long temp = -(RT + CT) * (1 << MWCV_OF_FIXPT_FRAC_BITS);
+            velC = (int32_T)((tmpRC_CC * temp) / norm);
+            velR = (int32_T)((tmpRR_RC * temp) / norm);
+        }
+    }
+}
+
+/*
+ * Gradient products of n pixels: gradCC and gradRR hold the column and
+ * row derivatives on entry and their squares on exit.
+ */
+template <typename ImT>
+inline void MWCV_LK_Fixpt_Products(const ImT *inImgA, const ImT *inImgB,
+                                   int32_T *gradCC, int32_T *gradRC, int32_T *gradRR,
+                                   int32_T *gradCT, int32_T *gradRT, int_T n)
+{
+    int_T j = 0;
+#ifdef MWCV_LK_FIXPT_NEON
+    if (sizeof(ImT) == 1)
+    {
+        const uint8_T *a = (const uint8_T *)inImgA;
+        const uint8_T *b = (const uint8_T *)inImgB;
+        for( ; j + 8 <= n; j += 8 )
+        {
+            /* 12*(B - A) fits in int16 */
+            const int16x8_t t16 = vmulq_n_s16(
+                vreinterpretq_s16_u16(vsubl_u8(vld1_u8(b + j), vld1_u8(a + j))), 12);
+            int_T k;
+            for( k = 0; k < 8; k += 4 )
+            {
+                const int32x4_t t  = vmovl_s16(k == 0 ? vget_low_s16(t16) : vget_high_s16(t16));
+                const int32x4_t gR = vld1q_s32(gradRR + j + k);
+                const int32x4_t gC = vld1q_s32(gradCC + j + k);
+                vst1q_s32(gradRR + j + k, vmulq_s32(gR, gR));
+                vst1q_s32(gradCC + j + k, vmulq_s32(gC, gC));
+                vst1q_s32(gradRC + j + k, vmulq_s32(gR, gC));
+                vst1q_s32(gradRT + j + k, vmulq_s32(gR, t));
+                vst1q_s32(gradCT + j + k, vmulq_s32(gC, t));
+            }
+        }
+    }
+#endif
+    for( ; j < n; j++ )
+    {
+        const int32_T tmpGradR = gradRR[j];
+        const int32_T tmpGradC = gradCC[j];
+        const int32_T tmpGradT = 12 * ((int32_T)inImgB[j] - (int32_T)inImgA[j]);
+
+        gradRR[j] = tmpGradR*tmpGradR;
+        gradCC[j] = tmpGradC*tmpGradC;
+        gradRC[j] = tmpGradR*tmpGradC;
+        gradRT[j] = tmpGradR*tmpGradT;
+        gradCT[j] = tmpGradC*tmpGradT;
+    }
+}
+
+/*
+ * Fixed-point Lucas-Kanade for uint8 frames. outVelC and outVelR are in
+ * Q(MWCV_OF_FIXPT_FRAC_BITS) pixels and eigTh is in the units of
+ * MWCV_OF_LK_FIXPT_EIGTH. As in MWCV_OpticalFlow_LK_DTypes, outVelC holds
+ * five columns of temporaries while the products are smoothed, so it must
+ * have at least 5*inRows elements.
+ */
+template <typename ImT>
+void MWCV_OpticalFlow_LK_Fixpt( const ImT  *inImgA, //input image A
+                                const ImT  *inImgB, //input image B
+                                int32_T  *outVelC, // output velocity - component along column
+                                int32_T  *outVelR, // output velocity - component along row
+                                int32_T  *gradCC,
+                                int32_T  *gradRC,
+                                int32_T  *gradRR,
+                                int32_T  *gradCT,
+                                int32_T  *gradRT,
+                                const int32_T  *eigTh,
+                                int_T  inRows,
+                                int_T  inCols)
+{
+    int_T i, j, ij, mn;
+    const int_T halfLen = 2;
+    const int_T BytesPerInCol = sizeof(int32_T)*inRows;
+
+    /* taps at offsets -2..2 */
+    const int32_T gradKernel[5] = {-1, 8, 0, -8, 1};
+    const int32_T gauss1DFilt[5] = {1, 4, 6, 4, 1};
+    const int32_T *dFilter = &gradKernel[halfLen];
+    const int32_T *gFilter = &gauss1DFilt[halfLen];
+
+    int32_T threshEigen = eigTh[0];
+    int_T colIdx;
+    int_T pixelIdx;
+
+    if (threshEigen > MWCV_LK_FIXPT_MAX_EIGTH) threshEigen = MWCV_LK_FIXPT_MAX_EIGTH;
+    if (threshEigen < -MWCV_LK_FIXPT_MAX_EIGTH) threshEigen = -MWCV_LK_FIXPT_MAX_EIGTH;
+
+    /******************** DERIVATIVES ALONG COLUMN AND ROW DIRECTIONS ********************/
+    ij = 0;
+    mn = 0;
+    for( colIdx = 0; colIdx < inCols; colIdx++ )
+    {
+        const int_T leftSpace  = (colIdx < halfLen) ? colIdx : halfLen;
+        const int_T rightSpace = (colIdx >= inCols - halfLen) ? inCols - colIdx - 1 : halfLen;
+
+        pixelIdx = (colIdx - leftSpace) * inRows;
+        if( leftSpace == halfLen && rightSpace == halfLen ) /* middle part */
+        {
+            for( j = 0; j < inRows; j++ )
+            {
+                const int_T addr = pixelIdx + j;
+                gradCC[ij++] = (-(int32_T)inImgA[addr] + (int32_T)inImgA[addr+4*inRows])
+                    + ((int32_T)inImgA[addr+inRows] - (int32_T)inImgA[addr+3*inRows]) * 8;
+            }
+        }
+        else
+        {
+            for( j = 0; j < inRows; j++ )
+            {
+                int_T addr = pixelIdx;
+                int32_T sum = 0;
+                for( i = -leftSpace; i <= rightSpace; i++ )
+                {
+                    sum += (int32_T)inImgA[addr + j] * dFilter[i];
+                    addr += inRows;
+                }
+                gradCC[ij++] = sum;
+            }
+        }
+
+        for( j = 0; j < inRows; j++ )
+        {
+            const int_T up   = (j < halfLen) ? j : halfLen;
+            const int_T down = (j >= inRows - halfLen) ? inRows - j - 1 : halfLen;
+            int32_T sum = 0;
+            int_T jj;
+            for( jj = -up; jj <= down; jj++ )
+            {
+                sum += (int32_T)inImgA[mn + jj] * dFilter[jj];
+            }
+            gradRR[mn++] = sum;
+        }
+    }
+    MWCV_LK_Fixpt_Products<ImT>(inImgA, inImgB, gradCC, gradRC, gradRR,
+                                gradCT, gradRT, inRows*inCols);
+
+    /******************** GAUSSIAN FILTERING ALONG ROW DIRECTION ********************/
+    for( colIdx = 0; colIdx < inCols; colIdx++ )
+    {
+        int32_T *tmpWGrad[5];
+        int32_T *grad[5];
+        const int_T colIdxTimesInRows = colIdx*inRows;
+        int_T k;
+
+        grad[0] = gradRR + colIdxTimesInRows;
+        grad[1] = gradCC + colIdxTimesInRows;
+        grad[2] = gradRC + colIdxTimesInRows;
+        grad[3] = gradRT + colIdxTimesInRows;
+        grad[4] = gradCT + colIdxTimesInRows;
+        for( k = 0; k < 5; k++ )
+        {
+            tmpWGrad[k] = outVelC + k*inRows;
+        }
+
+        for( j = 0; j < inRows; j++ )
+        {
+            const int_T up   = (j < halfLen) ? j : halfLen;
+            const int_T down = (j >= inRows - halfLen) ? inRows - j - 1 : halfLen;
+            for( k = 0; k < 5; k++ )
+            {
+                const int32_T *g = grad[k] + j;
+                int32_T sum = 0;
+                int_T jj;
+                for( jj = -up; jj <= down; jj++ )
+                {
+                    sum += g[jj] * gFilter[jj];
+                }
+                tmpWGrad[k][j] = MWCV_LK_FIXPT_ROUND16(sum);
+            }
+        }
+        for( k = 0; k < 5; k++ )
+        {
+            memcpy(grad[k], tmpWGrad[k], BytesPerInCol);
+        }
+    }
+
+    /************ GAUSSIAN FILTERING ALONG COLUMN DIRECTION AND LINEAR SYSTEM ************/
+    mn = 0;
+    for( colIdx = 0; colIdx < inCols; colIdx++ )
+    {
+        const int_T leftSpace  = (colIdx < halfLen) ? colIdx : halfLen;
+        const int_T rightSpace = (colIdx >= inCols - halfLen) ? inCols - colIdx - 1 : halfLen;
+
+        pixelIdx = (colIdx - leftSpace) * inRows;
+        for( j = 0; j < inRows; j++ )
+        {
+            int_T addr = pixelIdx + j;
+            int32_T WWGradRR = 0;
+            int32_T WWGradCC = 0;
+            int32_T WWGradRC = 0;
+            int32_T WWGradRT = 0;
+            int32_T WWGradCT = 0;
+
+            for( i = -leftSpace; i <= rightSpace; i++ )
+            {
+                WWGradRR += gradRR[addr] * gFilter[i];
+                WWGradCC += gradCC[addr] * gFilter[i];
+                WWGradRC += gradRC[addr] * gFilter[i];
+                WWGradRT += gradRT[addr] * gFilter[i];
+                WWGradCT += gradCT[addr] * gFilter[i];
+                addr += inRows;
+            }
+            MWCV_LK_SolvePixel_Fixpt(MWCV_LK_FIXPT_ROUND16(WWGradRR),
+                                     MWCV_LK_FIXPT_ROUND16(WWGradCC),
+                                     MWCV_LK_FIXPT_ROUND16(WWGradRC),
+                                     MWCV_LK_FIXPT_ROUND16(WWGradRT),
+                                     MWCV_LK_FIXPT_ROUND16(WWGradCT),
+                                     threshEigen, outVelC[mn], outVelR[mn]);
+            mn++;
+        }
+    }
+}
+
+#endif /* _OPTICALFLOWLK_FIXPT_H_ */
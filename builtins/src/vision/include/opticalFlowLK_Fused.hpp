@@ -0,0 +1,232 @@
+/*
+ * This file contains the optical flow Lucas-Kanade (difference filter)
+ * algorithm computed in a single pass over the columns of the image.
+ *
+ * MWCV_OpticalFlow_LK_DTypes writes the five gradient products to full
+ * size buffers and reads them back for each of the two Gaussian passes.
+ * Here, each column is differentiated, multiplied and smoothed along the
+ * column as soon as it is reached. The smoothed products of the last five
+ * columns are kept in a ring of line buffers, from which the velocity of
+ * the column two positions behind is solved. The working set is a small
+ * multiple of the number of rows, so it stays in cache.
+ *
+ * The filters, their boundary handling and the order of the operations
+ * are those of MWCV_OpticalFlow_LK_DTypes, so both give the same velocity.
+ *
+ *  Copyright 2016 The MathWorks, Inc.
+ */
+
+#ifndef _OPTICALFLOWLK_FUSED_H_
+#define _OPTICALFLOWLK_FUSED_H_
+
+#include "opticalFlowLK.hpp"
+
+/* number of products and of columns in the ring of line buffers */
+#define LK_FUSED_NUM_PRODUCTS 5
+#define LK_FUSED_NUM_COLUMNS  5
+
+/* number of elements of the line buffer, per row of the image */
+#define LK_FUSED_LINE_BUFFER_ROWS \
+    ((LK_FUSED_NUM_COLUMNS + 1) * LK_FUSED_NUM_PRODUCTS)
+
+template <typename ImT, typename T>
+void MWCV_OpticalFlow_LK_Fused_DTypes( const ImT  *inImgA, //input image A
+                                       const ImT  *inImgB, //input image B
+                                       T  *outVelC, // output velocity - component along column
+                                       T  *outVelR, // output velocity - component along row
+                                       T  *lineBuffer, // LK_FUSED_LINE_BUFFER_ROWS*inRows
+                                       const T  *eigTh,
+                                       int_T  inRows,
+                                       int_T  inCols)
+{
+    int_T i, j, jj, colIdx;
+    const int_T cFilterHalfLen = 2;
+    const int_T rFilterHalfLen = 2;
+
+    T threshEigen      = eigTh[0];
+    T THRESH_ABS_DELTA = 0; /* delta is the determinant of the 2x2 matrix */
+    T THRESH_NORM      = 0;
+
+    // for uint8 image, ImT = uint8, T = single
+    // for double image, ImT = double, T = double
+    // for single image, ImT = single, T = single
+    boolean_T usingUint8 = (sizeof(ImT) != sizeof(T));
+    T ONE_BY_RANGE  = usingUint8 ?  (T)(1.0/255.0) : (T)(1.0);
+    T RANGE  = usingUint8 ?  (T)255.0 : (T)1.0;
+
+    T gradKernelRange[5] = {-1/(12.0F*RANGE),8/(12.0F*RANGE),0,-8/(12.0F*RANGE),1/(12.0F*RANGE)};
+
+    /* Gaussian separable kernels {1/16,4/16,6/16,4/16,1/16} */
+    T gauss1DFilt[5] = {0.0625,0.25,0.375,0.25,0.0625};
+
+    const T *cFilterRange = &gradKernelRange[cFilterHalfLen];
+    const T *rFilterRange = &gradKernelRange[rFilterHalfLen];
+    const T *cFilter = &gauss1DFilt[cFilterHalfLen];
+    const T *rFilter = &gauss1DFilt[rFilterHalfLen];
+
+    /* products of the current column: RR, CC, RC, RT, CT */
+    T *prod = lineBuffer;
+    /* ring of products smoothed along the column */
+    T *ring = lineBuffer + LK_FUSED_NUM_PRODUCTS*inRows;
+
+    for (colIdx = 0; colIdx < inCols; colIdx++)
+    {
+        const ImT *colA = &inImgA[colIdx*inRows];
+        const ImT *colB = &inImgB[colIdx*inRows];
+        T *prodRR = prod;
+        T *prodCC = prodRR + inRows;
+        T *prodRC = prodCC + inRows;
+        T *prodRT = prodRC + inRows;
+        T *prodCT = prodRT + inRows;
+
+        /*************** DERIVATIVES AND THEIR PRODUCTS ***********************/
+        int_T leftSpace  = (colIdx < cFilterHalfLen) ? colIdx : cFilterHalfLen;
+        int_T rightSpace = (colIdx >= inCols - cFilterHalfLen) ?
+                           inCols - colIdx - 1 : cFilterHalfLen;
+        boolean_T isMiddle = (colIdx >= cFilterHalfLen) &&
+                             (colIdx < inCols - cFilterHalfLen);
+
+        /* GradR is written to prodRR, GradC to prodCC */
+        if (isMiddle)
+        {
+            const ImT *aM2 = colA - 2*inRows;
+            const ImT *aM1 = colA - inRows;
+            const ImT *aP1 = colA + inRows;
+            const ImT *aP2 = colA + 2*inRows;
+            for (j = 0; j < inRows; j++)
+            {
+                prodCC[j] = (-aM2[j] + aP2[j])*cFilterRange[2]
+                    +(aM1[j] - aP1[j])*cFilterRange[-1];
+            }
+        }
+        else
+        {
+            for (j = 0; j < inRows; j++)
+            {
+                int_T addr = (colIdx - leftSpace) * inRows;
+                T sum = 0;
+                for (i = -leftSpace; i <= rightSpace; i++)
+                {
+                    sum += inImgA[addr + j] * cFilterRange[i];
+                    addr += inRows;
+                }
+                prodCC[j] = sum;
+            }
+        }
+        for (j = 0; j < rFilterHalfLen; j++)
+        {
+            T sum = 0;
+            for (jj = -j; jj <= rFilterHalfLen; jj++)
+            {
+                sum += colA[j + jj] * rFilterRange[jj];
+            }
+            prodRR[j] = sum;
+        }
+        for (j = rFilterHalfLen; j < inRows - rFilterHalfLen; j++)
+        {
+            prodRR[j] = (colA[j - 1] - colA[j + 1])* rFilterRange[-1]  /* 8/12 */
+            + (-colA[j - 2] + colA[j + 2])* rFilterRange[2]; /* 1/12 */
+        }
+        for (j = inRows - rFilterHalfLen; j < inRows; j++)
+        {
+            T sum = 0;
+            for (jj = -rFilterHalfLen; jj < inRows - j; jj++)
+            {
+                sum += colA[j + jj] * rFilterRange[jj];
+            }
+            prodRR[j] = sum;
+        }
+        for (j = 0; j < inRows; j++)
+        {
+            T tmpGradR = prodRR[j];
+            T tmpGradC = prodCC[j];
+            T tmpGradT = ((T)colB[j] - (T)colA[j])*ONE_BY_RANGE; /* GradT */
+
+            prodRR[j] = tmpGradR*tmpGradR;
+            prodCC[j] = tmpGradC*tmpGradC;
+            prodRC[j] = tmpGradR*tmpGradC;
+            prodRT[j] = tmpGradR*tmpGradT;
+            prodCT[j] = tmpGradC*tmpGradT;
+        }
+
+        /*************** GAUSSIAN FILTERING ALONG THE COLUMN ******************/
+        T *smoothed = &ring[(colIdx % LK_FUSED_NUM_COLUMNS)*LK_FUSED_NUM_PRODUCTS*inRows];
+        for (int_T p = 0; p < LK_FUSED_NUM_PRODUCTS; p++)
+        {
+            const T *g = &prod[p*inRows];
+            T *w = &smoothed[p*inRows];
+
+            for (j = 0; j < rFilterHalfLen; j++)
+            {
+                w[j] = 0;
+                for (jj = -j; jj <= rFilterHalfLen; jj++)
+                {
+                    w[j] += g[j + jj] * rFilter[jj];
+                }
+            }
+            for (j = rFilterHalfLen; j < inRows - rFilterHalfLen; j++)
+            {
+                w[j] = 0;
+                for (jj = 1; jj <= rFilterHalfLen; jj++)
+                {
+                    w[j] += (g[j - jj] + g[j + jj]) * rFilter[jj];
+                }
+                w[j] += g[j] * rFilter[0];
+            }
+            for (j = inRows - rFilterHalfLen; j < inRows; j++)
+            {
+                w[j] = 0;
+                for (jj = -rFilterHalfLen; jj < inRows - j; jj++)
+                {
+                    w[j] += g[j + jj] * rFilter[jj];
+                }
+            }
+        }
+
+        /*************** GAUSSIAN FILTERING ACROSS COLUMNS AND SOLVE **********/
+        /* column c is solved once column c+2, or the last one, is smoothed */
+        int_T firstOutCol = colIdx - cFilterHalfLen;
+        int_T lastOutCol  = (colIdx == inCols - 1) ? colIdx : firstOutCol;
+        if (firstOutCol < 0) firstOutCol = 0;
+
+        for (int_T c = firstOutCol; c <= lastOutCol; c++)
+        {
+            int_T cLeft  = (c < cFilterHalfLen) ? c : cFilterHalfLen;
+            int_T cRight = (c >= inCols - cFilterHalfLen) ? inCols - c - 1 : cFilterHalfLen;
+            T *velC = &outVelC[c*inRows];
+            T *velR = &outVelR[c*inRows];
+
+            /* smoothed products of columns c-cLeft, ..., c+cRight */
+            const T *cols[2*cFilterHalfLen + 1];
+            for (i = -cLeft; i <= cRight; i++)
+            {
+                cols[i + cFilterHalfLen] = &ring[((c + i) % LK_FUSED_NUM_COLUMNS)*LK_FUSED_NUM_PRODUCTS*inRows];
+            }
+
+            for (j = 0; j < inRows; j++)
+            {
+                T WWGradRR = 0;
+                T WWGradCC = 0;
+                T WWGradRC = 0;
+                T WWGradRT = 0;
+                T WWGradCT = 0;
+
+                for (i = -cLeft; i <= cRight; i++)
+                {
+                    const T *w = cols[i + cFilterHalfLen];
+                    WWGradRR += w[j]            * cFilter[i];
+                    WWGradCC += w[j +   inRows] * cFilter[i];
+                    WWGradRC += w[j + 2*inRows] * cFilter[i];
+                    WWGradRT += w[j + 3*inRows] * cFilter[i];
+                    WWGradCT += w[j + 4*inRows] * cFilter[i];
+                }
+
+                MWCV_LK_SolvePixel<T>(WWGradRR, WWGradCC, WWGradRC, WWGradRT, WWGradCT,
+                                      threshEigen, THRESH_ABS_DELTA, THRESH_NORM,
+                                      velC[j], velR[j]);
+            }
+        }
+    }
+}
+
+#endif /* _OPTICALFLOWLK_FUSED_H_ */
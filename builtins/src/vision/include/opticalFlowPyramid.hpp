@@ -0,0 +1,204 @@
+/*
+ * This file contains the image pyramid used by the coarse-to-fine
+ * Horn-Schunck and Lucas-Kanade optical flow.
+ *
+ * All images are column major. Level 0 is the input image; each level is
+ * the previous one smoothed with the separable {1,4,6,4,1}/16 kernel and
+ * subsampled by 2, with replicated borders. At each level, the previous
+ * frame is warped with the flow of the coarser level and only the remaining
+ * motion is estimated.
+ *
+ *  Copyright 2016 The MathWorks, Inc.
+ */
+
+#ifndef _OPTICALFLOWPYRAMID_H_
+#define _OPTICALFLOWPYRAMID_H_
+
+#include <math.h>
+#include <vector>
+
+/* smallest number of rows or columns of the coarsest level */
+#define OF_PYR_MIN_SIZE 8
+
+/* returns the number of levels, at most numLevels, whose size is not less
+ * than OF_PYR_MIN_SIZE */
+inline int_T MWCV_OFPyr_NumLevels(int_T numLevels, int_T inRows, int_T inCols)
+{
+    int_T n = 1;
+    while (n < numLevels &&
+           (inRows+1)/2 >= OF_PYR_MIN_SIZE && (inCols+1)/2 >= OF_PYR_MIN_SIZE)
+    {
+        inRows = (inRows+1)/2;
+        inCols = (inCols+1)/2;
+        n++;
+    }
+    return n;
+}
+
+/* converts the input image to T; uint8 images are scaled to [0 1] */
+template <typename ImT, typename T>
+void MWCV_OFPyr_ToReal(const ImT *inImg, T *outImg, int_T inSize)
+{
+    const boolean_T usingUint8 = (sizeof(ImT) != sizeof(T));
+    const T ONE_BY_RANGE = usingUint8 ? (T)(1.0/255.0) : (T)(1.0);
+    for (int_T k = 0; k < inSize; k++)
+    {
+        outImg[k] = (T)inImg[k] * ONE_BY_RANGE;
+    }
+}
+
+/* smooths and subsamples src (inRows x inCols) into dst
+ * ((inRows+1)/2 x (inCols+1)/2); tmp holds (inRows+1)/2 x inCols elements */
+template <typename T>
+void MWCV_OFPyr_Downsample(const T *src, int_T inRows, int_T inCols,
+                           T *tmp, T *dst)
+{
+    const int_T outRows = (inRows+1)/2;
+    const int_T outCols = (inCols+1)/2;
+    const int_T lastRow = inRows-1;
+    const int_T lastCol = inCols-1;
+
+    /* along each column: even rows only */
+    for (int_T j = 0; j < inCols; j++)
+    {
+        const T *s = src + j*inRows;
+        T *t = tmp + j*outRows;
+        for (int_T i = 0; i < outRows; i++)
+        {
+            const int_T r  = 2*i;
+            const int_T m2 = (r < 2) ? 0 : r-2;
+            const int_T m1 = (r < 1) ? 0 : r-1;
+            const int_T p1 = (r+1 > lastRow) ? lastRow : r+1;
+            const int_T p2 = (r+2 > lastRow) ? lastRow : r+2;
+            t[i] = (s[m2] + s[p2] + 4*(s[m1] + s[p1]) + 6*s[r]) / 16;
+        }
+    }
+
+    /* along each row: even columns only */
+    for (int_T j = 0; j < outCols; j++)
+    {
+        const int_T c  = 2*j;
+        const T *m2 = tmp + ((c < 2) ? 0 : c-2)*outRows;
+        const T *m1 = tmp + ((c < 1) ? 0 : c-1)*outRows;
+        const T *c0 = tmp + c*outRows;
+        const T *p1 = tmp + ((c+1 > lastCol) ? lastCol : c+1)*outRows;
+        const T *p2 = tmp + ((c+2 > lastCol) ? lastCol : c+2)*outRows;
+        T *d = dst + j*outRows;
+        for (int_T i = 0; i < outRows; i++)
+        {
+            d[i] = (m2[i] + p2[i] + 4*(m1[i] + p1[i]) + 6*c0[i]) / 16;
+        }
+    }
+}
+
+/* bilinear sample of img at (r, c); coordinates are clamped to the image */
+template <typename T>
+inline T MWCV_OFPyr_Sample(const T *img, int_T inRows, int_T inCols, T r, T c)
+{
+    r = (r < 0) ? 0 : ((r > (T)(inRows-1)) ? (T)(inRows-1) : r);
+    c = (c < 0) ? 0 : ((c > (T)(inCols-1)) ? (T)(inCols-1) : c);
+
+    int_T r0 = (int_T)r;
+    int_T c0 = (int_T)c;
+    if (r0 > inRows-2) r0 = (inRows > 1) ? inRows-2 : 0;
+    if (c0 > inCols-2) c0 = (inCols > 1) ? inCols-2 : 0;
+    const int_T r1 = (inRows > 1) ? r0+1 : r0;
+    const int_T c1 = (inCols > 1) ? c0+1 : c0;
+    const T fr = r - r0;
+    const T fc = c - c0;
+
+    const T top    = img[r0 + c0*inRows] + (img[r0 + c1*inRows] - img[r0 + c0*inRows])*fc;
+    const T bottom = img[r1 + c0*inRows] + (img[r1 + c1*inRows] - img[r1 + c0*inRows])*fc;
+    return top + (bottom - top)*fr;
+}
+
+/* resamples the velocity of the coarser level (srcRows x srcCols) to
+ * inRows x inCols and doubles it. Pixel k of the coarser level is at pixel
+ * 2k of this level. */
+template <typename T>
+void MWCV_OFPyr_UpsampleFlow(const T *srcVelC, const T *srcVelR,
+                             int_T srcRows, int_T srcCols,
+                             T *velC, T *velR, int_T inRows, int_T inCols)
+{
+    for (int_T j = 0; j < inCols; j++)
+    {
+        const T c = (T)j / 2;
+        for (int_T i = 0; i < inRows; i++)
+        {
+            const T r = (T)i / 2;
+            velC[i + j*inRows] = 2*MWCV_OFPyr_Sample<T>(srcVelC, srcRows, srcCols, r, c);
+            velR[i + j*inRows] = 2*MWCV_OFPyr_Sample<T>(srcVelR, srcRows, srcCols, r, c);
+        }
+    }
+}
+
+/* warps the previous frame with the velocity, so that it matches the
+ * current frame: outImg(i,j) = img(i - velR(i,j), j - velC(i,j)) */
+template <typename T>
+void MWCV_OFPyr_Warp(const T *img, const T *velC, const T *velR,
+                     int_T inRows, int_T inCols, T *outImg)
+{
+    for (int_T j = 0; j < inCols; j++)
+    {
+        for (int_T i = 0; i < inRows; i++)
+        {
+            const int_T ij = i + j*inRows;
+            outImg[ij] = MWCV_OFPyr_Sample<T>(img, inRows, inCols,
+                                              (T)i - velR[ij], (T)j - velC[ij]);
+        }
+    }
+}
+
+/*
+ * Pyramids of the current and previous frames. The images of level L are
+ * getRows(L) x getCols(L).
+ */
+template <typename T>
+class MWCV_OFPyramid
+{
+public:
+    template <typename ImT>
+    MWCV_OFPyramid(const ImT *inImgA, const ImT *inImgB,
+                   int_T numLevels, int_T inRows, int_T inCols)
+        : mRows(numLevels), mCols(numLevels),
+          mImgA(numLevels), mImgB(numLevels)
+    {
+        mRows[0] = inRows;
+        mCols[0] = inCols;
+        for (int_T L = 1; L < numLevels; L++)
+        {
+            mRows[L] = (mRows[L-1]+1)/2;
+            mCols[L] = (mCols[L-1]+1)/2;
+        }
+
+        mImgA[0].resize(inRows*inCols);
+        mImgB[0].resize(inRows*inCols);
+        MWCV_OFPyr_ToReal<ImT, T>(inImgA, &mImgA[0][0], inRows*inCols);
+        MWCV_OFPyr_ToReal<ImT, T>(inImgB, &mImgB[0][0], inRows*inCols);
+
+        std::vector<T> tmp(numLevels > 1 ? mRows[1]*inCols : 0);
+        for (int_T L = 1; L < numLevels; L++)
+        {
+            mImgA[L].resize(mRows[L]*mCols[L]);
+            mImgB[L].resize(mRows[L]*mCols[L]);
+            MWCV_OFPyr_Downsample<T>(&mImgA[L-1][0], mRows[L-1], mCols[L-1],
+                                     &tmp[0], &mImgA[L][0]);
+            MWCV_OFPyr_Downsample<T>(&mImgB[L-1][0], mRows[L-1], mCols[L-1],
+                                     &tmp[0], &mImgB[L][0]);
+        }
+    }
+
+    int_T getNumLevels() const { return (int_T)mRows.size(); }
+    int_T getRows(int_T L) const { return mRows[L]; }
+    int_T getCols(int_T L) const { return mCols[L]; }
+    const T *getImageA(int_T L) const { return &mImgA[L][0]; }
+    const T *getImageB(int_T L) const { return &mImgB[L][0]; }
+
+private:
+    std::vector<int_T> mRows;
+    std::vector<int_T> mCols;
+    std::vector<std::vector<T> > mImgA;
+    std::vector<std::vector<T> > mImgB;
+};
+
+#endif /* _OPTICALFLOWPYRAMID_H_ */
@@ -0,0 +1,783 @@
+/*
+ * This file contains the template matching engine of the Template Matching
+ * block and vision.TemplateMatcher.
+ *
+ * The metric matrix has one value per offset of the template inside the
+ * image, (inRows-tmplRows+1) x (inCols-tmplCols+1), column major as the
+ * images. Four metrics are supported:
+ *
+ *   SAD    sum of absolute differences
+ *   SSD    sum of squared differences
+ *   MaxAD  maximum absolute difference
+ *   NCC    normalized cross correlation of the zero mean template with the
+ *          image window, in [-1 1], 0 on flat windows
+ *
+ * SAD and MaxAD are always evaluated directly. Unlike SSD, SAD does not
+ * split into sums of the window, so it cannot be read from integral images.
+ * For uint8 images each SIMD register instead holds the SAD of 16 vertically
+ * adjacent offsets, which share every image column segment they load, with
+ * unsigned saturating differences (as psadbw) accumulated in 16 bits and
+ * flushed to 32 bits; the sums are exact. SSD and NCC are built from
+ * the correlation of the image with the template and from the sums of the
+ * window and of its squares, read from integral images:
+ *
+ *   SSD = sum(I.^2) - 2*corr(I,T) + sum(T.^2)
+ *   NCC = corr(I,T-mean(T)) / sqrt((sum(I.^2)-sum(I)^2/n) * sum((T-mean(T)).^2))
+ *
+ * The correlation is computed directly for small templates and with the FFT
+ * of the zero padded image for large ones, whichever takes fewer operations.
+ * The spectrum of the template is kept by the matcher and reused as long as
+ * the template, its metric and the size of the image do not change, which
+ * is the case from frame to frame of a video. The direct path splits the
+ * output columns among threads when PARALLEL is defined, as do the FFT
+ * passes over the rows and columns.
+ *
+ *  Copyright 2016 The MathWorks, Inc.
+ */
+
+#ifndef _TEMPLATEMATCHING_H_
+#define _TEMPLATEMATCHING_H_
+
+#include <math.h>
+#include <string.h>
+#include <algorithm>
+#include <complex>
+#include <limits>
+#include <vector>
+
+#ifdef PARALLEL
+#include <thread>
+#endif
+
+#if defined(__ARM_NEON__) || defined(__ARM_NEON)
+#include <arm_neon.h>
+#define TM_SAD_NEON 1
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define TM_SAD_SSE2 1
+#endif
+
+/* metrics */
+#define TM_METRIC_SAD   0
+#define TM_METRIC_SSD   1
+#define TM_METRIC_MAXAD 2
+#define TM_METRIC_NCC   3
+
+/* methods of the correlation */
+#define TM_METHOD_AUTO   0
+#define TM_METHOD_DIRECT 1
+#define TM_METHOD_FFT    2
+
+/* minimum number of output columns, or of FFTs, of each thread */
+#define TM_MIN_COLS_PER_THREAD 16
+
+/* offsets of one SIMD SAD accumulator, and template pixels added to its
+ * 16-bit sums before they are flushed (256*255 < 65536) */
+#define TM_SAD_ROWS  16
+#define TM_SAD_FLUSH 256
+
+/* operations of a radix-2 butterfly relative to a multiply-add of the
+ * direct correlation */
+#define TM_FFT_COST 4.0
+
+#ifdef PARALLEL
+/* runs fcn(begin, end) over [0, n) split among threads */
+template <typename Fcn>
+void MWCV_TM_ParallelFor(int_T n, Fcn fcn)
+{
+    int numThreads = (int)std::thread::hardware_concurrency();
+    numThreads = std::max(1, std::min(numThreads, (int)(n / TM_MIN_COLS_PER_THREAD)));
+    if (numThreads == 1)
+    {
+        fcn(0, n);
+        return;
+    }
+
+    std::vector<std::thread> threads;
+    for (int t = 1; t < numThreads; ++t)
+    {
+        const int_T begin = (int_T)((long long)n * t / numThreads);
+        const int_T end   = (int_T)((long long)n * (t + 1) / numThreads);
+        threads.push_back(std::thread(fcn, begin, end));
+    }
+    fcn(0, (int_T)((long long)n / numThreads));
+    for (size_t t = 0; t < threads.size(); ++t)
+    {
+        threads[t].join();
+    }
+}
+#endif
+
+/* smallest power of 2 not less than n */
+inline int_T MWCV_TM_NextPow2(int_T n)
+{
+    int_T p = 1;
+    while (p < n)
+    {
+        p *= 2;
+    }
+    return p;
+}
+
+inline int_T MWCV_TM_Log2(int_T p)
+{
+    int_T k = 0;
+    while ((1 << k) < p)
+    {
+        k++;
+    }
+    return k;
+}
+
+/* in place radix-2 FFT of the n = 2^k elements of x;
+ * twiddles holds exp(-2*pi*i*j/n), j < n/2, and inverse conjugates them
+ * without scaling */
+inline void MWCV_TM_FFT(std::complex<double> *x, int_T n,
+                        const std::complex<double> *twiddles, bool inverse)
+{
+    /* bit reversal */
+    for (int_T i = 1, j = 0; i < n; i++)
+    {
+        int_T bit = n >> 1;
+        for (; j & bit; bit >>= 1)
+        {
+            j ^= bit;
+        }
+        j ^= bit;
+        if (i < j)
+        {
+            std::swap(x[i], x[j]);
+        }
+    }
+
+    for (int_T len = 2; len <= n; len <<= 1)
+    {
+        const int_T half = len >> 1;
+        const int_T step = n / len;
+        for (int_T i = 0; i < n; i += len)
+        {
+            for (int_T j = 0; j < half; j++)
+            {
+                const std::complex<double> w = inverse ?
+                    std::conj(twiddles[j * step]) : twiddles[j * step];
+                const std::complex<double> u = x[i + j];
+                const std::complex<double> v = x[i + j + half] * w;
+                x[i + j] = u + v;
+                x[i + j + half] = u - v;
+            }
+        }
+    }
+}
+
+class MWCV_TemplateMatcher
+{
+public:
+    MWCV_TemplateMatcher()
+        : mTmplRows(0), mTmplCols(0), mMetric(-1),
+          mFFTRows(0), mFFTCols(0), mTmplSum(0), mTmplSqSum(0) {}
+
+    /* metric matrix of the inRows x inCols image and the tmplRows x
+     * tmplCols template, outMetric is (inRows-tmplRows+1) x
+     * (inCols-tmplCols+1) */
+    template <typename ImT, typename T>
+    void match(const ImT *inImg, int_T inRows, int_T inCols,
+               const ImT *inTmpl, int_T tmplRows, int_T tmplCols,
+               int_T metric, int_T method, T *outMetric)
+    {
+        const int_T outRows = inRows - tmplRows + 1;
+        const int_T outCols = inCols - tmplCols + 1;
+        if (outRows <= 0 || outCols <= 0 || tmplRows <= 0 || tmplCols <= 0)
+        {
+            return;
+        }
+
+#if defined(TM_SAD_SSE2) || defined(TM_SAD_NEON)
+        if (metric == TM_METRIC_SAD && sizeof(ImT) == 1 &&
+            !std::numeric_limits<ImT>::is_signed &&
+            (double)tmplRows * tmplCols * 255 < 4294967296.0)
+        {
+            matchSADUint8<T>((const uint8_T *)inImg, inRows,
+                             (const uint8_T *)inTmpl, tmplRows, tmplCols,
+                             outRows, outCols, outMetric);
+            return;
+        }
+#endif
+        if (metric == TM_METRIC_SAD || metric == TM_METRIC_MAXAD)
+        {
+            matchDirect<ImT, T>(inImg, inRows, inTmpl, tmplRows, tmplCols,
+                                outRows, outCols, metric, outMetric);
+            return;
+        }
+
+        if (method == TM_METHOD_AUTO)
+        {
+            method = useFFT(inRows, inCols, tmplRows, tmplCols) ?
+                TM_METHOD_FFT : TM_METHOD_DIRECT;
+        }
+
+        if (method == TM_METHOD_DIRECT && metric == TM_METRIC_SSD)
+        {
+            matchDirect<ImT, T>(inImg, inRows, inTmpl, tmplRows, tmplCols,
+                                outRows, outCols, metric, outMetric);
+            return;
+        }
+
+        setTemplate<ImT>(inTmpl, tmplRows, tmplCols, metric);
+        mCorr.resize((size_t)outRows * outCols);
+        if (method == TM_METHOD_FFT)
+        {
+            correlateFFT<ImT>(inImg, inRows, inCols, outRows, outCols);
+        }
+        else
+        {
+            correlateDirect<ImT>(inImg, inRows, outRows, outCols);
+        }
+        integrate<ImT>(inImg, inRows, inCols);
+        combine<T>(inRows, tmplRows, tmplCols, outRows, outCols, metric,
+                   std::numeric_limits<ImT>::is_integer, outMetric);
+    }
+
+private:
+    /* true when the FFT takes fewer operations than the direct correlation,
+     * the spectrum of the template being known */
+    static bool useFFT(int_T inRows, int_T inCols, int_T tmplRows, int_T tmplCols)
+    {
+        const double outRows = (double)(inRows - tmplRows + 1);
+        const double outCols = (double)(inCols - tmplCols + 1);
+        const double direct = outRows * outCols * tmplRows * tmplCols;
+
+        const double P = (double)MWCV_TM_NextPow2(inRows);
+        const double Q = (double)MWCV_TM_NextPow2(inCols);
+        const double logP = (double)MWCV_TM_Log2((int_T)P);
+        const double logQ = (double)MWCV_TM_Log2((int_T)Q);
+        const double fft = TM_FFT_COST * 0.5 *
+            ((inCols + outCols) * P * logP + 2 * P * Q * logQ);
+
+        return direct > fft;
+    }
+
+    /* SAD, SSD or MaxAD of every offset, accumulated in T */
+    template <typename ImT, typename T>
+    static void matchDirect(const ImT *inImg, int_T inRows,
+                            const ImT *inTmpl, int_T tmplRows, int_T tmplCols,
+                            int_T outRows, int_T outCols, int_T metric,
+                            T *outMetric)
+    {
+#ifdef PARALLEL
+        MWCV_TM_ParallelFor(outCols, [&](int_T begin, int_T end)
+        {
+            matchDirectCols<ImT, T>(inImg, inRows, inTmpl, tmplRows, tmplCols,
+                                    outRows, metric, outMetric, begin, end);
+        });
+#else
+        matchDirectCols<ImT, T>(inImg, inRows, inTmpl, tmplRows, tmplCols,
+                                outRows, metric, outMetric, 0, outCols);
+#endif
+    }
+
+    /* output columns [begin, end) of matchDirect */
+    template <typename ImT, typename T>
+    static void matchDirectCols(const ImT *inImg, int_T inRows,
+                                const ImT *inTmpl, int_T tmplRows, int_T tmplCols,
+                                int_T outRows, int_T metric, T *outMetric,
+                                int_T begin, int_T end)
+    {
+        for (int_T c = begin; c < end; c++)
+        {
+            T *acc = outMetric + (size_t)c * outRows;
+            memset(acc, 0, sizeof(T) * outRows);
+            for (int_T j = 0; j < tmplCols; j++)
+            {
+                const ImT *col = inImg + (size_t)(c + j) * inRows;
+                const ImT *tcol = inTmpl + (size_t)j * tmplRows;
+                for (int_T i = 0; i < tmplRows; i++)
+                {
+                    const T t = (T)tcol[i];
+                    const ImT *x = col + i;
+                    if (metric == TM_METRIC_SAD)
+                    {
+                        for (int_T r = 0; r < outRows; r++)
+                        {
+                            const T d = (T)x[r] - t;
+                            acc[r] += (d < 0) ? -d : d;
+                        }
+                    }
+                    else if (metric == TM_METRIC_SSD)
+                    {
+                        for (int_T r = 0; r < outRows; r++)
+                        {
+                            const T d = (T)x[r] - t;
+                            acc[r] += d * d;
+                        }
+                    }
+                    else
+                    {
+                        for (int_T r = 0; r < outRows; r++)
+                        {
+                            const T d = (T)x[r] - t;
+                            acc[r] = std::max(acc[r], (d < 0) ? -d : d);
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+#if defined(TM_SAD_SSE2) || defined(TM_SAD_NEON)
+    /* SAD of uint8 images, TM_SAD_ROWS offsets of a column at a time; the
+     * groups of offsets of all columns are split among threads, so narrow
+     * outputs are parallel as well */
+    template <typename T>
+    static void matchSADUint8(const uint8_T *inImg, int_T inRows,
+                              const uint8_T *inTmpl, int_T tmplRows, int_T tmplCols,
+                              int_T outRows, int_T outCols, T *outMetric)
+    {
+        const int_T numGroups = (outRows + TM_SAD_ROWS - 1) / TM_SAD_ROWS;
+#ifdef PARALLEL
+        MWCV_TM_ParallelFor(outCols * numGroups, [&](int_T begin, int_T end)
+        {
+            sadGroups<T>(inImg, inRows, inTmpl, tmplRows, tmplCols, outRows,
+                         outMetric, begin, end);
+        });
+#else
+        sadGroups<T>(inImg, inRows, inTmpl, tmplRows, tmplCols, outRows,
+                     outMetric, 0, outCols * numGroups);
+#endif
+    }
+
+    /* groups of offsets [begin, end) of matchSADUint8, column by column */
+    template <typename T>
+    static void sadGroups(const uint8_T *inImg, int_T inRows,
+                          const uint8_T *inTmpl, int_T tmplRows, int_T tmplCols,
+                          int_T outRows, T *outMetric, int_T begin, int_T end)
+    {
+        const int_T numGroups = (outRows + TM_SAD_ROWS - 1) / TM_SAD_ROWS;
+        const int_T numVecGroups = outRows / TM_SAD_ROWS;
+        for (int_T k = begin; k < end; k++)
+        {
+            const int_T c = k / numGroups;
+            const int_T g = k - c * numGroups;
+            const int_T r0 = g * TM_SAD_ROWS;
+            T *out = outMetric + (size_t)c * outRows + r0;
+            if (g < numVecGroups)
+            {
+                uint32_T sums[TM_SAD_ROWS];
+                sadRows16(inImg + (size_t)c * inRows + r0, inRows,
+                          inTmpl, tmplRows, tmplCols, sums);
+                for (int_T r = 0; r < TM_SAD_ROWS; r++)
+                {
+                    out[r] = (T)sums[r];
+                }
+                continue;
+            }
+            /* last rows of the column */
+            for (int_T r = r0; r < outRows; r++)
+            {
+                uint32_T sum = 0;
+                for (int_T j = 0; j < tmplCols; j++)
+                {
+                    const uint8_T *x = inImg + (size_t)(c + j) * inRows + r;
+                    const uint8_T *t = inTmpl + (size_t)j * tmplRows;
+                    for (int_T i = 0; i < tmplRows; i++)
+                    {
+                        sum += (x[i] > t[i]) ? (uint32_T)(x[i] - t[i])
+                                             : (uint32_T)(t[i] - x[i]);
+                    }
+                }
+                out[r - r0] = (T)sum;
+            }
+        }
+    }
+
+    /* sums[r] = SAD of the template at offset img + r, r < TM_SAD_ROWS */
+    static void sadRows16(const uint8_T *img, int_T inRows,
+                          const uint8_T *inTmpl, int_T tmplRows, int_T tmplCols,
+                          uint32_T *sums)
+    {
+        int_T count = 0;
+#if defined(TM_SAD_SSE2)
+        const __m128i zero = _mm_setzero_si128();
+        __m128i lo = zero, hi = zero;
+        __m128i acc[4] = {zero, zero, zero, zero};
+#else
+        uint16x8_t lo = vdupq_n_u16(0), hi = vdupq_n_u16(0);
+        uint32x4_t acc[4] = {vdupq_n_u32(0), vdupq_n_u32(0),
+                             vdupq_n_u32(0), vdupq_n_u32(0)};
+#endif
+        for (int_T j = 0; j < tmplCols; j++)
+        {
+            const uint8_T *x = img + (size_t)j * inRows;
+            const uint8_T *t = inTmpl + (size_t)j * tmplRows;
+            for (int_T i = 0; i < tmplRows; i++)
+            {
+#if defined(TM_SAD_SSE2)
+                const __m128i a = _mm_loadu_si128((const __m128i *)(x + i));
+                const __m128i b = _mm_set1_epi8((char)t[i]);
+                const __m128i d = _mm_or_si128(_mm_subs_epu8(a, b), _mm_subs_epu8(b, a));
+                lo = _mm_add_epi16(lo, _mm_unpacklo_epi8(d, zero));
+                hi = _mm_add_epi16(hi, _mm_unpackhi_epi8(d, zero));
+#else
+                const uint8x16_t d = vabdq_u8(vld1q_u8(x + i), vdupq_n_u8(t[i]));
+                lo = vaddw_u8(lo, vget_low_u8(d));
+                hi = vaddw_u8(hi, vget_high_u8(d));
+#endif
+                if (++count == TM_SAD_FLUSH)
+                {
+                    flushSAD(lo, hi, acc);
+                    count = 0;
+                }
+            }
+        }
+        flushSAD(lo, hi, acc);
+#if defined(TM_SAD_SSE2)
+        for (int k = 0; k < 4; k++)
+        {
+            _mm_storeu_si128((__m128i *)(sums + 4 * k), acc[k]);
+        }
+#else
+        for (int k = 0; k < 4; k++)
+        {
+            vst1q_u32(sums + 4 * k, acc[k]);
+        }
+#endif
+    }
+
+    /* adds the 16-bit sums to the 32-bit ones and clears them */
+#if defined(TM_SAD_SSE2)
+    static void flushSAD(__m128i &lo, __m128i &hi, __m128i *acc)
+    {
+        const __m128i zero = _mm_setzero_si128();
+        acc[0] = _mm_add_epi32(acc[0], _mm_unpacklo_epi16(lo, zero));
+        acc[1] = _mm_add_epi32(acc[1], _mm_unpackhi_epi16(lo, zero));
+        acc[2] = _mm_add_epi32(acc[2], _mm_unpacklo_epi16(hi, zero));
+        acc[3] = _mm_add_epi32(acc[3], _mm_unpackhi_epi16(hi, zero));
+        lo = zero;
+        hi = zero;
+    }
+#else
+    static void flushSAD(uint16x8_t &lo, uint16x8_t &hi, uint32x4_t *acc)
+    {
+        acc[0] = vaddw_u16(acc[0], vget_low_u16(lo));
+        acc[1] = vaddw_u16(acc[1], vget_high_u16(lo));
+        acc[2] = vaddw_u16(acc[2], vget_low_u16(hi));
+        acc[3] = vaddw_u16(acc[3], vget_high_u16(hi));
+        lo = vdupq_n_u16(0);
+        hi = vdupq_n_u16(0);
+    }
+#endif
+#endif
+
+    /* keeps the template, zero mean for NCC, and forgets its spectrum when
+     * it changes */
+    template <typename ImT>
+    void setTemplate(const ImT *inTmpl, int_T tmplRows, int_T tmplCols,
+                     int_T metric)
+    {
+        const size_t n = (size_t)tmplRows * tmplCols;
+        std::vector<double> tmpl(n);
+        double sum = 0;
+        for (size_t k = 0; k < n; k++)
+        {
+            tmpl[k] = (double)inTmpl[k];
+            sum += tmpl[k];
+        }
+        if (metric == TM_METRIC_NCC)
+        {
+            const double mean = sum / n;
+            for (size_t k = 0; k < n; k++)
+            {
+                tmpl[k] -= mean;
+            }
+        }
+
+        if (tmplRows == mTmplRows && tmplCols == mTmplCols && metric == mMetric &&
+            tmpl == mTmpl)
+        {
+            return;
+        }
+
+        mTmpl.swap(tmpl);
+        mTmplRows = tmplRows;
+        mTmplCols = tmplCols;
+        mMetric = metric;
+        mTmplSum = 0;
+        mTmplSqSum = 0;
+        for (size_t k = 0; k < n; k++)
+        {
+            mTmplSum += mTmpl[k];
+            mTmplSqSum += mTmpl[k] * mTmpl[k];
+        }
+        mSpectrum.clear();
+    }
+
+    /* corr(I,T) of every offset from the products of the columns */
+    template <typename ImT>
+    void correlateDirect(const ImT *inImg, int_T inRows, int_T outRows, int_T outCols)
+    {
+#ifdef PARALLEL
+        MWCV_TM_ParallelFor(outCols, [&](int_T begin, int_T end)
+        {
+            correlateCols<ImT>(inImg, inRows, outRows, begin, end);
+        });
+#else
+        correlateCols<ImT>(inImg, inRows, outRows, 0, outCols);
+#endif
+    }
+
+    /* output columns [begin, end) of correlateDirect */
+    template <typename ImT>
+    void correlateCols(const ImT *inImg, int_T inRows, int_T outRows,
+                       int_T begin, int_T end)
+    {
+        const int_T tmplRows = mTmplRows, tmplCols = mTmplCols;
+        for (int_T c = begin; c < end; c++)
+        {
+            double *acc = &mCorr[(size_t)c * outRows];
+            memset(acc, 0, sizeof(double) * outRows);
+            for (int_T j = 0; j < tmplCols; j++)
+            {
+                const ImT *col = inImg + (size_t)(c + j) * inRows;
+                const double *tcol = &mTmpl[(size_t)j * tmplRows];
+                for (int_T i = 0; i < tmplRows; i++)
+                {
+                    const double t = tcol[i];
+                    const ImT *x = col + i;
+                    for (int_T r = 0; r < outRows; r++)
+                    {
+                        acc[r] += (double)x[r] * t;
+                    }
+                }
+            }
+        }
+    }
+
+    /* FFTs of the columns [0, numCols) of the P x Q buffer */
+    void columnFFTs(int_T numCols, bool inverse)
+    {
+#ifdef PARALLEL
+        MWCV_TM_ParallelFor(numCols, [&](int_T begin, int_T end)
+        {
+            columnFFTRange(begin, end, inverse);
+        });
+#else
+        columnFFTRange(0, numCols, inverse);
+#endif
+    }
+
+    /* FFTs of the columns [begin, end) */
+    void columnFFTRange(int_T begin, int_T end, bool inverse)
+    {
+        const int_T P = mFFTRows;
+        for (int_T c = begin; c < end; c++)
+        {
+            MWCV_TM_FFT(&mBuffer[(size_t)c * P], P, &mTwiddlesRows[0], inverse);
+        }
+    }
+
+    /* FFTs of the rows [0, numRows) of the P x Q buffer */
+    void rowFFTs(int_T numRows, bool inverse)
+    {
+#ifdef PARALLEL
+        MWCV_TM_ParallelFor(numRows, [&](int_T begin, int_T end)
+        {
+            rowFFTRange(begin, end, inverse);
+        });
+#else
+        rowFFTRange(0, numRows, inverse);
+#endif
+    }
+
+    /* FFTs of the rows [begin, end) */
+    void rowFFTRange(int_T begin, int_T end, bool inverse)
+    {
+        const int_T P = mFFTRows, Q = mFFTCols;
+        std::vector<std::complex<double> > row(Q);
+        for (int_T r = begin; r < end; r++)
+        {
+            for (int_T c = 0; c < Q; c++)
+            {
+                row[c] = mBuffer[(size_t)c * P + r];
+            }
+            MWCV_TM_FFT(&row[0], Q, &mTwiddlesCols[0], inverse);
+            for (int_T c = 0; c < Q; c++)
+            {
+                mBuffer[(size_t)c * P + r] = row[c];
+            }
+        }
+    }
+
+    static void setTwiddles(int_T n, std::vector<std::complex<double> > &twiddles)
+    {
+        const double pi = 3.14159265358979323846;
+        twiddles.resize(std::max(n / 2, (int_T)1));
+        for (int_T j = 0; j < n / 2; j++)
+        {
+            twiddles[j] = std::polar(1.0, -2 * pi * j / n);
+        }
+    }
+
+    /* corr(I,T) as the inverse FFT of fft(I).*conj(fft(T)), both zero
+     * padded to P x Q powers of 2 not less than the image, so that the
+     * circular correlation of the valid offsets does not wrap */
+    template <typename ImT>
+    void correlateFFT(const ImT *inImg, int_T inRows, int_T inCols,
+                      int_T outRows, int_T outCols)
+    {
+        const int_T P = MWCV_TM_NextPow2(inRows);
+        const int_T Q = MWCV_TM_NextPow2(inCols);
+        if (P != mFFTRows || Q != mFFTCols)
+        {
+            mFFTRows = P;
+            mFFTCols = Q;
+            setTwiddles(P, mTwiddlesRows);
+            setTwiddles(Q, mTwiddlesCols);
+            mSpectrum.clear();
+        }
+        const size_t size = (size_t)P * Q;
+
+        if (mSpectrum.empty())
+        {
+            mBuffer.assign(size, std::complex<double>(0, 0));
+            for (int_T c = 0; c < mTmplCols; c++)
+            {
+                for (int_T r = 0; r < mTmplRows; r++)
+                {
+                    mBuffer[(size_t)c * P + r] = mTmpl[(size_t)c * mTmplRows + r];
+                }
+            }
+            /* the columns past the template stay zero */
+            columnFFTs(mTmplCols, false);
+            rowFFTs(P, false);
+            mSpectrum.resize(size);
+            for (size_t k = 0; k < size; k++)
+            {
+                mSpectrum[k] = std::conj(mBuffer[k]);
+            }
+        }
+
+        mBuffer.assign(size, std::complex<double>(0, 0));
+        for (int_T c = 0; c < inCols; c++)
+        {
+            const ImT *col = inImg + (size_t)c * inRows;
+            std::complex<double> *dst = &mBuffer[(size_t)c * P];
+            for (int_T r = 0; r < inRows; r++)
+            {
+                dst[r] = (double)col[r];
+            }
+        }
+        columnFFTs(inCols, false);
+        rowFFTs(P, false);
+        for (size_t k = 0; k < size; k++)
+        {
+            mBuffer[k] *= mSpectrum[k];
+        }
+        rowFFTs(P, true);
+        /* only the valid offsets are needed */
+        columnFFTs(outCols, true);
+
+        const double scale = 1.0 / ((double)P * Q);
+        for (int_T c = 0; c < outCols; c++)
+        {
+            for (int_T r = 0; r < outRows; r++)
+            {
+                mCorr[(size_t)c * outRows + r] = mBuffer[(size_t)c * P + r].real() * scale;
+            }
+        }
+    }
+
+    /* (inRows+1) x (inCols+1) integral images of the image and of its
+     * squares */
+    template <typename ImT>
+    void integrate(const ImT *inImg, int_T inRows, int_T inCols)
+    {
+        const int_T R = inRows + 1;
+        const size_t size = (size_t)R * (inCols + 1);
+        mSum.assign(size, 0.0);
+        mSqSum.assign(size, 0.0);
+        for (int_T c = 0; c < inCols; c++)
+        {
+            const ImT *col = inImg + (size_t)c * inRows;
+            double s = 0, s2 = 0;
+            for (int_T r = 0; r < inRows; r++)
+            {
+                const double x = (double)col[r];
+                s += x;
+                s2 += x * x;
+                const size_t k = (size_t)(c + 1) * R + r + 1;
+                mSum[k] = mSum[k - R] + s;
+                mSqSum[k] = mSqSum[k - R] + s2;
+            }
+        }
+    }
+
+    /* SSD or NCC from the correlation and the sums of the windows; integer
+     * images have integer SSD, which the FFT only approximates */
+    template <typename T>
+    void combine(int_T inRows, int_T tmplRows, int_T tmplCols,
+                 int_T outRows, int_T outCols, int_T metric,
+                 bool isInteger, T *outMetric) const
+    {
+        const int_T R = inRows + 1;
+        const double n = (double)tmplRows * tmplCols;
+        for (int_T c = 0; c < outCols; c++)
+        {
+            for (int_T r = 0; r < outRows; r++)
+            {
+                const size_t a = (size_t)c * R + r;
+                const size_t b = a + tmplRows;
+                const size_t d = a + (size_t)tmplCols * R;
+                const size_t e = d + tmplRows;
+                const double sum = mSum[e] - mSum[d] - mSum[b] + mSum[a];
+                const double sqSum = mSqSum[e] - mSqSum[d] - mSqSum[b] + mSqSum[a];
+                const double corr = mCorr[(size_t)c * outRows + r];
+
+                double value;
+                if (metric == TM_METRIC_SSD)
+                {
+                    value = std::max(sqSum - 2 * corr + mTmplSqSum, 0.0);
+                    if (isInteger)
+                    {
+                        value = floor(value + 0.5);
+                    }
+                }
+                else
+                {
+                    const double var = sqSum - sum * sum / n;
+                    const double den = var * mTmplSqSum;
+                    value = (var > 1e-12 * std::max(sqSum, 1.0) && den > 0) ?
+                        corr / sqrt(den) : 0.0;
+                    value = std::max(-1.0, std::min(1.0, value));
+                }
+                outMetric[(size_t)c * outRows + r] = (T)value;
+            }
+        }
+    }
+
+    /* template of the cached spectrum */
+    int_T mTmplRows;
+    int_T mTmplCols;
+    int_T mMetric;
+    std::vector<double> mTmpl;
+
+    /* FFT of the zero padded template, conjugated */
+    int_T mFFTRows;
+    int_T mFFTCols;
+    std::vector<std::complex<double> > mTwiddlesRows;
+    std::vector<std::complex<double> > mTwiddlesCols;
+    std::vector<std::complex<double> > mSpectrum;
+    std::vector<std::complex<double> > mBuffer;
+
+    double mTmplSum;
+    double mTmplSqSum;
+
+    /* correlation and integral images of the last image */
+    std::vector<double> mCorr;
+    std::vector<double> mSum;
+    std::vector<double> mSqSum;
+
+    /* copying and assignment are disallowed */
+    MWCV_TemplateMatcher(const MWCV_TemplateMatcher &);
+    MWCV_TemplateMatcher &operator=(const MWCV_TemplateMatcher &);
+};
+
+#endif
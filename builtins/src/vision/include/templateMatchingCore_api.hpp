@@ -0,0 +1,51 @@
+/* Copyright 2016 The MathWorks, Inc. */
+
+#ifndef _TEMPLATEMATCHINGCORE_
+#define _TEMPLATEMATCHINGCORE_
+
+#include "vision_defines.h"
+
+/* The matcher keeps the spectrum of the template between calls, see
+ * templateMatching.hpp */
+EXTERN_C LIBMWCVSTRT_API void MWCV_TemplateMatching_construct(void **ptr2ptrMatcher);
+
+/* outMetric is (inRows-tmplRows+1) x (inCols-tmplCols+1). metric is 0 for
+ * SAD, 1 for SSD, 2 for MaxAD and 3 for NCC; method is 0 to choose between
+ * the direct and the FFT correlation, 1 for the direct one and 2 for the
+ * FFT */
+EXTERN_C LIBMWCVSTRT_API void MWCV_TemplateMatching_double(void *ptrMatcher,
+                                        const real_T  *inImg,
+                                        int_T  inRows,
+                                        int_T  inCols,
+                                        const real_T  *inTmpl,
+                                        int_T  tmplRows,
+                                        int_T  tmplCols,
+                                        int32_T metric,
+                                        int32_T method,
+                                        real_T  *outMetric);
+
+EXTERN_C LIBMWCVSTRT_API void MWCV_TemplateMatching_single(void *ptrMatcher,
+                                        const real32_T  *inImg,
+                                        int_T  inRows,
+                                        int_T  inCols,
+                                        const real32_T  *inTmpl,
+                                        int_T  tmplRows,
+                                        int_T  tmplCols,
+                                        int32_T metric,
+                                        int32_T method,
+                                        real32_T  *outMetric);
+
+EXTERN_C LIBMWCVSTRT_API void MWCV_TemplateMatching_uint8(void *ptrMatcher,
+                                        const uint8_T  *inImg,
+                                        int_T  inRows,
+                                        int_T  inCols,
+                                        const uint8_T  *inTmpl,
+                                        int_T  tmplRows,
+                                        int_T  tmplCols,
+                                        int32_T metric,
+                                        int32_T method,
+                                        real_T  *outMetric);
+
+EXTERN_C LIBMWCVSTRT_API void MWCV_TemplateMatching_deleteObj(void *ptrMatcher);
+
+#endif
@@ -6,6 +6,8 @@
 
 #include "opticalFlowHSCore_api.hpp"
 #include "opticalFlowHS.hpp"
+#include "opticalFlowHS_RedBlack.hpp"
+#include "opticalFlowHS_Fixpt.hpp"
 
 void MWCV_OpticalFlow_HS_double( const real_T  *inImgA, 
                                         const real_T  *inImgB,
@@ -165,4 +167,270 @@ void MWCV_OpticalFlow_HS_uint8( const uint8_T  *inImgA,
                                  inRows, 
                                  inCols); 
 }
- 
+
+void MWCV_OpticalFlow_HS_uint8_fixpt( const uint8_T  *inImgA, 
+                                        const uint8_T  *inImgB, 
+                                        int32_T  *outVelC, 
+                                        int32_T  *outVelR, 
+                                        int32_T  *buffCprev, 
+                                        int32_T  *buffCnext, 
+                                        int32_T  *buffRprev, 
+                                        int32_T  *buffRnext, 
+                                        int16_T  *gradC, 
+                                        int16_T  *gradR, 
+                                        int32_T  *gradT, 
+                                        int32_T  *alphaC, 
+                                        int32_T  *alphaR, 
+                                        int32_T  *velBufCcurr, 
+                                        int32_T  *velBufCprev, 
+                                        int32_T  *velBufRcurr, 
+                                        int32_T  *velBufRprev, 
+                                        const int32_T  *lambda, 
+                                        boolean_T useMaxIter, 
+                                        boolean_T useAbsVelDiff, 
+                                        const int32_T *maxIter, 
+                                        const int32_T  *maxAllowableAbsDiffVel, 
+                                        int_T  inRows, 
+                                        int_T  inCols) 
+{
+ MWCV_OpticalFlow_HS_Fixpt<uint8_T>( inImgA, 
+                                 inImgB, 
+                                 outVelC, 
+                                 outVelR, 
+                                 buffCprev, 
+                                 buffCnext, 
+                                 buffRprev, 
+                                 buffRnext, 
+                                 gradC, 
+                                 gradR, 
+                                 gradT, 
+                                 alphaC, 
+                                 alphaR, 
+                                 velBufCcurr, 
+                                 velBufCprev, 
+                                 velBufRcurr, 
+                                 velBufRprev, 
+                                 lambda, 
+                                 useMaxIter, 
+                                 useAbsVelDiff, 
+                                 maxIter, 
+                                 maxAllowableAbsDiffVel, 
+                                 inRows, 
+                                 inCols);
+}
+
+void MWCV_OpticalFlow_HS_RB_double( const real_T  *inImgA, 
+                                        const real_T  *inImgB, 
+                                        real_T  *outVelC, 
+                                        real_T  *outVelR, 
+                                        real_T  *buffCprev, 
+                                        real_T  *buffCnext, 
+                                        real_T  *buffRprev, 
+                                        real_T  *buffRnext, 
+                                        real_T  *gradCC, 
+                                        real_T  *gradRC, 
+                                        real_T  *gradRR, 
+                                        real_T  *gradCT, 
+                                        real_T  *gradRT, 
+                                        real_T  *alpha, 
+                                        const real_T  *lambda, 
+                                        boolean_T useMaxIter, 
+                                        boolean_T useAbsVelDiff, 
+                                        const int32_T *maxIter, 
+                                        const real_T  *maxAllowableAbsDiffVel, 
+                                        int_T  inRows, 
+                                        int_T  inCols) 
+{
+ MWCV_OpticalFlow_HS_RB_DTypes<real_T, real_T>( inImgA, 
+                                 inImgB, 
+                                 outVelC, 
+                                 outVelR, 
+                                 buffCprev, 
+                                 buffCnext, 
+                                 buffRprev, 
+                                 buffRnext, 
+                                 gradCC, 
+                                 gradRC, 
+                                 gradRR, 
+                                 gradCT, 
+                                 gradRT, 
+                                 alpha, 
+                                 lambda, 
+                                 useMaxIter, 
+                                 useAbsVelDiff, 
+                                 maxIter, 
+                                 maxAllowableAbsDiffVel, 
+                                 inRows, 
+                                 inCols);
+}
+
+void MWCV_OpticalFlow_HS_RB_single( const real32_T  *inImgA, 
+                                        const real32_T  *inImgB, 
+                                        real32_T  *outVelC, 
+                                        real32_T  *outVelR, 
+                                        real32_T  *buffCprev, 
+                                        real32_T  *buffCnext, 
+                                        real32_T  *buffRprev, 
+                                        real32_T  *buffRnext, 
+                                        real32_T  *gradCC, 
+                                        real32_T  *gradRC, 
+                                        real32_T  *gradRR, 
+                                        real32_T  *gradCT, 
+                                        real32_T  *gradRT, 
+                                        real32_T  *alpha, 
+                                        const real32_T  *lambda, 
+                                        boolean_T useMaxIter, 
+                                        boolean_T useAbsVelDiff, 
+                                        const int32_T *maxIter, 
+                                        const real32_T  *maxAllowableAbsDiffVel, 
+                                        int_T  inRows, 
+                                        int_T  inCols) 
+{
+ MWCV_OpticalFlow_HS_RB_DTypes<real32_T, real32_T>( inImgA, 
+                                 inImgB, 
+                                 outVelC, 
+                                 outVelR, 
+                                 buffCprev, 
+                                 buffCnext, 
+                                 buffRprev, 
+                                 buffRnext, 
+                                 gradCC, 
+                                 gradRC, 
+                                 gradRR, 
+                                 gradCT, 
+                                 gradRT, 
+                                 alpha, 
+                                 lambda, 
+                                 useMaxIter, 
+                                 useAbsVelDiff, 
+                                 maxIter, 
+                                 maxAllowableAbsDiffVel, 
+                                 inRows, 
+                                 inCols);
+}
+
+void MWCV_OpticalFlow_HS_RB_uint8( const uint8_T  *inImgA, 
+                                        const uint8_T  *inImgB, 
+                                        real32_T  *outVelC, 
+                                        real32_T  *outVelR, 
+                                        real32_T  *buffCprev, 
+                                        real32_T  *buffCnext, 
+                                        real32_T  *buffRprev, 
+                                        real32_T  *buffRnext, 
+                                        real32_T  *gradCC, 
+                                        real32_T  *gradRC, 
+                                        real32_T  *gradRR, 
+                                        real32_T  *gradCT, 
+                                        real32_T  *gradRT, 
+                                        real32_T  *alpha, 
+                                        const real32_T  *lambda, 
+                                        boolean_T useMaxIter, 
+                                        boolean_T useAbsVelDiff, 
+                                        const int32_T *maxIter, 
+                                        const real32_T  *maxAllowableAbsDiffVel, 
+                                        int_T  inRows, 
+                                        int_T  inCols) 
+{
+ MWCV_OpticalFlow_HS_RB_DTypes<uint8_T, real32_T>( inImgA, 
+                                 inImgB, 
+                                 outVelC, 
+                                 outVelR, 
+                                 buffCprev, 
+                                 buffCnext, 
+                                 buffRprev, 
+                                 buffRnext, 
+                                 gradCC, 
+                                 gradRC, 
+                                 gradRR, 
+                                 gradCT, 
+                                 gradRT, 
+                                 alpha, 
+                                 lambda, 
+                                 useMaxIter, 
+                                 useAbsVelDiff, 
+                                 maxIter, 
+                                 maxAllowableAbsDiffVel, 
+                                 inRows, 
+                                 inCols);
+}
+
+void MWCV_OpticalFlow_HS_Pyr_double( const real_T  *inImgA, 
+                                        const real_T  *inImgB, 
+                                        real_T  *outVelC, 
+                                        real_T  *outVelR, 
+                                        const real_T  *lambda, 
+                                        boolean_T useMaxIter, 
+                                        boolean_T useAbsVelDiff, 
+                                        const int32_T *maxIter, 
+                                        const real_T  *maxAllowableAbsDiffVel, 
+                                        int32_T numLevels, 
+                                        int_T  inRows, 
+                                        int_T  inCols) 
+{
+ MWCV_OpticalFlow_HS_Pyr_DTypes<real_T, real_T>( inImgA, 
+                                 inImgB, 
+                                 outVelC, 
+                                 outVelR, 
+                                 lambda, 
+                                 useMaxIter, 
+                                 useAbsVelDiff, 
+                                 maxIter, 
+                                 maxAllowableAbsDiffVel, 
+                                 numLevels, 
+                                 inRows, 
+                                 inCols);
+}
+
+void MWCV_OpticalFlow_HS_Pyr_single( const real32_T  *inImgA, 
+                                        const real32_T  *inImgB, 
+                                        real32_T  *outVelC, 
+                                        real32_T  *outVelR, 
+                                        const real32_T  *lambda, 
+                                        boolean_T useMaxIter, 
+                                        boolean_T useAbsVelDiff, 
+                                        const int32_T *maxIter, 
+                                        const real32_T  *maxAllowableAbsDiffVel, 
+                                        int32_T numLevels, 
+                                        int_T  inRows, 
+                                        int_T  inCols) 
+{
+ MWCV_OpticalFlow_HS_Pyr_DTypes<real32_T, real32_T>( inImgA, 
+                                 inImgB, 
+                                 outVelC, 
+                                 outVelR, 
+                                 lambda, 
+                                 useMaxIter, 
+                                 useAbsVelDiff, 
+                                 maxIter, 
+                                 maxAllowableAbsDiffVel, 
+                                 numLevels, 
+                                 inRows, 
+                                 inCols);
+}
+
+void MWCV_OpticalFlow_HS_Pyr_uint8( const uint8_T  *inImgA, 
+                                        const uint8_T  *inImgB, 
+                                        real32_T  *outVelC, 
+                                        real32_T  *outVelR, 
+                                        const real32_T  *lambda, 
+                                        boolean_T useMaxIter, 
+                                        boolean_T useAbsVelDiff, 
+                                        const int32_T *maxIter, 
+                                        const real32_T  *maxAllowableAbsDiffVel, 
+                                        int32_T numLevels, 
+                                        int_T  inRows, 
+                                        int_T  inCols) 
+{
+ MWCV_OpticalFlow_HS_Pyr_DTypes<uint8_T, real32_T>( inImgA, 
+                                 inImgB, 
+                                 outVelC, 
+                                 outVelR, 
+                                 lambda, 
+                                 useMaxIter, 
+                                 useAbsVelDiff, 
+                                 maxIter, 
+                                 maxAllowableAbsDiffVel, 
+                                 numLevels, 
+                                 inRows, 
+                                 inCols);
+}
@@ -6,6 +6,8 @@
 
 #include "opticalFlowLKCore_api.hpp"
 #include "opticalFlowLK.hpp"
+#include "opticalFlowLK_Fused.hpp"
+#include "opticalFlowLK_Fixpt.hpp"
 
 void MWCV_OpticalFlow_LK_double( const real_T  *inImgA, 
                                         const real_T  *inImgB,
@@ -88,3 +90,143 @@ void MWCV_OpticalFlow_LK_uint8( const uint8_T  *inImgA,
                                  inCols);
 }
 
+void MWCV_OpticalFlow_LK_uint8_fixpt( const uint8_T  *inImgA, 
+                                        const uint8_T  *inImgB,
+                                        int32_T  *outVelC, 
+                                        int32_T  *outVelR,
+                                        int32_T  *gradCC,
+                                        int32_T  *gradRC,
+                                        int32_T  *gradRR,
+                                        int32_T  *gradCT,
+                                        int32_T  *gradRT,
+                                        const int32_T  *eigTh,
+                                        int_T  inRows,
+                                        int_T  inCols) 
+{
+ MWCV_OpticalFlow_LK_Fixpt<uint8_T>( inImgA, 
+                                 inImgB,
+                                 outVelC, 
+                                 outVelR,
+                                 gradCC, 
+                                 gradRC, 
+                                 gradRR, 
+                                 gradCT, 
+                                 gradRT, 
+                                 eigTh,
+                                 inRows, 
+                                 inCols);
+}
+
+void MWCV_OpticalFlow_LK_Pyr_double( const real_T  *inImgA, 
+                                        const real_T  *inImgB, 
+                                        real_T  *outVelC, 
+                                        real_T  *outVelR, 
+                                        const real_T  *eigTh, 
+                                        int32_T numLevels, 
+                                        int_T  inRows, 
+                                        int_T  inCols) 
+{
+ MWCV_OpticalFlow_LK_Pyr_DTypes<real_T, real_T>( inImgA, 
+                                 inImgB, 
+                                 outVelC, 
+                                 outVelR, 
+                                 eigTh, 
+                                 numLevels, 
+                                 inRows, 
+                                 inCols);
+}
+
+void MWCV_OpticalFlow_LK_Pyr_single( const real32_T  *inImgA, 
+                                        const real32_T  *inImgB, 
+                                        real32_T  *outVelC, 
+                                        real32_T  *outVelR, 
+                                        const real32_T  *eigTh, 
+                                        int32_T numLevels, 
+                                        int_T  inRows, 
+                                        int_T  inCols) 
+{
+ MWCV_OpticalFlow_LK_Pyr_DTypes<real32_T, real32_T>( inImgA, 
+                                 inImgB, 
+                                 outVelC, 
+                                 outVelR, 
+                                 eigTh, 
+                                 numLevels, 
+                                 inRows, 
+                                 inCols);
+}
+
+void MWCV_OpticalFlow_LK_Pyr_uint8( const uint8_T  *inImgA, 
+                                        const uint8_T  *inImgB, 
+                                        real32_T  *outVelC, 
+                                        real32_T  *outVelR, 
+                                        const real32_T  *eigTh, 
+                                        int32_T numLevels, 
+                                        int_T  inRows, 
+                                        int_T  inCols) 
+{
+ MWCV_OpticalFlow_LK_Pyr_DTypes<uint8_T, real32_T>( inImgA, 
+                                 inImgB, 
+                                 outVelC, 
+                                 outVelR, 
+                                 eigTh, 
+                                 numLevels, 
+                                 inRows, 
+                                 inCols);
+}
+
+void MWCV_OpticalFlow_LK_Fused_double( const real_T  *inImgA, 
+                                        const real_T  *inImgB, 
+                                        real_T  *outVelC, 
+                                        real_T  *outVelR, 
+                                        real_T  *lineBuffer, 
+                                        const real_T  *eigTh, 
+                                        int_T  inRows, 
+                                        int_T  inCols) 
+{
+ MWCV_OpticalFlow_LK_Fused_DTypes<real_T, real_T>( inImgA, 
+                                 inImgB, 
+                                 outVelC, 
+                                 outVelR, 
+                                 lineBuffer, 
+                                 eigTh, 
+                                 inRows, 
+                                 inCols);
+}
+
+void MWCV_OpticalFlow_LK_Fused_single( const real32_T  *inImgA, 
+                                        const real32_T  *inImgB, 
+                                        real32_T  *outVelC, 
+                                        real32_T  *outVelR, 
+                                        real32_T  *lineBuffer, 
+                                        const real32_T  *eigTh, 
+                                        int_T  inRows, 
+                                        int_T  inCols) 
+{
+ MWCV_OpticalFlow_LK_Fused_DTypes<real32_T, real32_T>( inImgA, 
+                                 inImgB, 
+                                 outVelC, 
+                                 outVelR, 
+                                 lineBuffer, 
+                                 eigTh, 
+                                 inRows, 
+                                 inCols);
+}
+
+void MWCV_OpticalFlow_LK_Fused_uint8( const uint8_T  *inImgA, 
+                                        const uint8_T  *inImgB, 
+                                        real32_T  *outVelC, 
+                                        real32_T  *outVelR, 
+                                        real32_T  *lineBuffer, 
+                                        const real32_T  *eigTh, 
+                                        int_T  inRows, 
+                                        int_T  inCols) 
+{
+ MWCV_OpticalFlow_LK_Fused_DTypes<uint8_T, real32_T>( inImgA, 
+                                 inImgB, 
+                                 outVelC, 
+                                 outVelR, 
+                                 lineBuffer, 
+                                 eigTh, 
+                                 inRows, 
+                                 inCols);
+}
@@ -7,6 +7,7 @@
 
 #include "opticalFlowLKDoGCore_api.hpp"
 #include "opticalFlowLKDoG.hpp"
+#include "opticalFlowLKDoG_stream.hpp"
 #include <stdlib.h>     // for malloc
 
 void MWCV_OpticalFlow_LKDoG_double( const real_T  *inImgA, 
@@ -193,3 +194,158 @@ void MWCV_OpticalFlow_LKDoG_uint8( const uint8_T  *inImgA,
                                             includeNormalFlow);
 free(portAddressBuffer);
 }
+
+//////////////////////////////////////////////////////////////////////////////
+// Streaming mode: each frame is filtered spatially once and kept in a ring
+// buffer of filtered planes
+//////////////////////////////////////////////////////////////////////////////
+
+void MWCV_OpticalFlow_LKDoG_Stream_construct_double( void **ptr2ptrClass,
+                                            const real_T *tGradKernel,
+                                            const real_T *sGradKernel,
+                                            const real_T *tKernel,
+                                            const real_T *sKernel,
+                                            const real_T *wKernel,
+                                            int_T   inRows,
+                                            int_T   inCols,
+                                            int_T tGradKernelLen,
+                                            int_T sGradKernelLen,
+                                            int_T tKernelLen,
+                                            int_T sKernelLen,
+                                            int_T wKernelLen)
+{
+ MWCV_OFLKDoG_Stream<real_T, real_T> *ptrClass_ = new MWCV_OFLKDoG_Stream<real_T, real_T>(tGradKernel,
+                                            sGradKernel,
+                                            tKernel,
+                                            sKernel,
+                                            wKernel,
+                                            inRows,
+                                            inCols,
+                                            tGradKernelLen,
+                                            sGradKernelLen,
+                                            tKernelLen,
+                                            sKernelLen,
+                                            wKernelLen);
+ *ptr2ptrClass = ptrClass_;
+}
+
+void MWCV_OpticalFlow_LKDoG_Stream_step_double( void *ptrClass,
+                                            const real_T  *inImgA,
+                                            real_T  *outVelC, /* output velocity - component along column */
+                                            real_T  *outVelR, /* output velocity - component along row */
+                                            const real_T *eigTh,
+                                            boolean_T includeNormalFlow)
+{
+ MWCV_OFLKDoG_Stream<real_T, real_T> *ptrClass_ = (MWCV_OFLKDoG_Stream<real_T, real_T> *)ptrClass;
+ ptrClass_->step(inImgA, outVelC, outVelR, eigTh, includeNormalFlow);
+}
+
+void MWCV_OpticalFlow_LKDoG_Stream_reset_double(void *ptrClass)
+{
+ ((MWCV_OFLKDoG_Stream<real_T, real_T> *)ptrClass)->reset();
+}
+
+void MWCV_OpticalFlow_LKDoG_Stream_deleteObj_double(void *ptrClass)
+{
+ delete ((MWCV_OFLKDoG_Stream<real_T, real_T> *)ptrClass);
+}
+
+void MWCV_OpticalFlow_LKDoG_Stream_construct_single( void **ptr2ptrClass,
+                                            const real32_T *tGradKernel,
+                                            const real32_T *sGradKernel,
+                                            const real32_T *tKernel,
+                                            const real32_T *sKernel,
+                                            const real32_T *wKernel,
+                                            int_T   inRows,
+                                            int_T   inCols,
+                                            int_T tGradKernelLen,
+                                            int_T sGradKernelLen,
+                                            int_T tKernelLen,
+                                            int_T sKernelLen,
+                                            int_T wKernelLen)
+{
+ MWCV_OFLKDoG_Stream<real32_T, real32_T> *ptrClass_ = new MWCV_OFLKDoG_Stream<real32_T, real32_T>(tGradKernel,
+                                            sGradKernel,
+                                            tKernel,
+                                            sKernel,
+                                            wKernel,
+                                            inRows,
+                                            inCols,
+                                            tGradKernelLen,
+                                            sGradKernelLen,
+                                            tKernelLen,
+                                            sKernelLen,
+                                            wKernelLen);
+ *ptr2ptrClass = ptrClass_;
+}
+
+void MWCV_OpticalFlow_LKDoG_Stream_step_single( void *ptrClass,
+                                            const real32_T  *inImgA,
+                                            real32_T  *outVelC, /* output velocity - component along column */
+                                            real32_T  *outVelR, /* output velocity - component along row */
+                                            const real32_T *eigTh,
+                                            boolean_T includeNormalFlow)
+{
+ MWCV_OFLKDoG_Stream<real32_T, real32_T> *ptrClass_ = (MWCV_OFLKDoG_Stream<real32_T, real32_T> *)ptrClass;
+ ptrClass_->step(inImgA, outVelC, outVelR, eigTh, includeNormalFlow);
+}
+
+void MWCV_OpticalFlow_LKDoG_Stream_reset_single(void *ptrClass)
+{
+ ((MWCV_OFLKDoG_Stream<real32_T, real32_T> *)ptrClass)->reset();
+}
+
+void MWCV_OpticalFlow_LKDoG_Stream_deleteObj_single(void *ptrClass)
+{
+ delete ((MWCV_OFLKDoG_Stream<real32_T, real32_T> *)ptrClass);
+}
+
+void MWCV_OpticalFlow_LKDoG_Stream_construct_uint8( void **ptr2ptrClass,
+                                            const real32_T *tGradKernel,
+                                            const real32_T *sGradKernel,
+                                            const real32_T *tKernel,
+                                            const real32_T *sKernel,
+                                            const real32_T *wKernel,
+                                            int_T   inRows,
+                                            int_T   inCols,
+                                            int_T tGradKernelLen,
+                                            int_T sGradKernelLen,
+                                            int_T tKernelLen,
+                                            int_T sKernelLen,
+                                            int_T wKernelLen)
+{
+ MWCV_OFLKDoG_Stream<uint8_T, real32_T> *ptrClass_ = new MWCV_OFLKDoG_Stream<uint8_T, real32_T>(tGradKernel,
+                                            sGradKernel,
+                                            tKernel,
+                                            sKernel,
+                                            wKernel,
+                                            inRows,
+                                            inCols,
+                                            tGradKernelLen,
+                                            sGradKernelLen,
+                                            tKernelLen,
+                                            sKernelLen,
+                                            wKernelLen);
+ *ptr2ptrClass = ptrClass_;
+}
+
+void MWCV_OpticalFlow_LKDoG_Stream_step_uint8( void *ptrClass,
+                                            const uint8_T  *inImgA,
+                                            real32_T  *outVelC, /* output velocity - component along column */
+                                            real32_T  *outVelR, /* output velocity - component along row */
+                                            const real32_T *eigTh,
+                                            boolean_T includeNormalFlow)
+{
+ MWCV_OFLKDoG_Stream<uint8_T, real32_T> *ptrClass_ = (MWCV_OFLKDoG_Stream<uint8_T, real32_T> *)ptrClass;
+ ptrClass_->step(inImgA, outVelC, outVelR, eigTh, includeNormalFlow);
+}
+
+void MWCV_OpticalFlow_LKDoG_Stream_reset_uint8(void *ptrClass)
+{
+ ((MWCV_OFLKDoG_Stream<uint8_T, real32_T> *)ptrClass)->reset();
+}
+
+void MWCV_OpticalFlow_LKDoG_Stream_deleteObj_uint8(void *ptrClass)
+{
+ delete ((MWCV_OFLKDoG_Stream<uint8_T, real32_T> *)ptrClass);
+}
@@ -0,0 +1,84 @@
+///////////////////////////////////////////////////////////////////////////
+//
+//  APIs for template matching with SAD, SSD, MaxAD and NCC metrics
+//
+///////////////////////////////////////////////////////////////////////////    
+
+#include "templateMatchingCore_api.hpp"
+#include "templateMatching.hpp"
+
+void MWCV_TemplateMatching_construct(void **ptr2ptrMatcher)
+{
+    *ptr2ptrMatcher = new MWCV_TemplateMatcher();
+}
+
+void MWCV_TemplateMatching_double(void *ptrMatcher,
+                                        const real_T  *inImg,
+                                        int_T  inRows,
+                                        int_T  inCols,
+                                        const real_T  *inTmpl,
+                                        int_T  tmplRows,
+                                        int_T  tmplCols,
+                                        int32_T metric,
+                                        int32_T method,
+                                        real_T  *outMetric)
+{
+ ((MWCV_TemplateMatcher *)ptrMatcher)->match<real_T, real_T>(inImg,
+                                 inRows,
+                                 inCols,
+                                 inTmpl,
+                                 tmplRows,
+                                 tmplCols,
+                                 metric,
+                                 method,
+                                 outMetric);
+}
+
+void MWCV_TemplateMatching_single(void *ptrMatcher,
+                                        const real32_T  *inImg,
+                                        int_T  inRows,
+                                        int_T  inCols,
+                                        const real32_T  *inTmpl,
+                                        int_T  tmplRows,
+                                        int_T  tmplCols,
+                                        int32_T metric,
+                                        int32_T method,
+                                        real32_T  *outMetric)
+{
+ ((MWCV_TemplateMatcher *)ptrMatcher)->match<real32_T, real32_T>(inImg,
+                                 inRows,
+                                 inCols,
+                                 inTmpl,
+                                 tmplRows,
+                                 tmplCols,
+                                 metric,
+                                 method,
+                                 outMetric);
+}
+
+void MWCV_TemplateMatching_uint8(void *ptrMatcher,
+                                        const uint8_T  *inImg,
+                                        int_T  inRows,
+                                        int_T  inCols,
+                                        const uint8_T  *inTmpl,
+                                        int_T  tmplRows,
+                                        int_T  tmplCols,
+                                        int32_T metric,
+                                        int32_T method,
+                                        real_T  *outMetric)
+{
+ ((MWCV_TemplateMatcher *)ptrMatcher)->match<uint8_T, real_T>(inImg,
+                                 inRows,
+                                 inCols,
+                                 inTmpl,
+                                 tmplRows,
+                                 tmplCols,
+                                 metric,
+                                 method,
+                                 outMetric);
+}
+
+void MWCV_TemplateMatching_deleteObj(void *ptrMatcher)
+{
+    delete ((MWCV_TemplateMatcher *)ptrMatcher);
+}
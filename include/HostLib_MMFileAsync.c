@@ -0,0 +1,235 @@
+/**
+ * @file HostLib_MMFileAsync.c
+ * @brief Background frame writer for C clients of the multimedia file HostLib library.
+ * Copyright 2007-2010 The MathWorks, Inc.
+ */
+
+#include "HostLib_MMFileAsync.h"
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#if defined(_WIN32)
+   typedef CRITICAL_SECTION   HostLibFileMutex;
+   typedef CONDITION_VARIABLE HostLibFileCond;
+   #define FILE_MUTEX_INIT(m)       InitializeCriticalSection(&(m))
+   #define FILE_MUTEX_DESTROY(m)    DeleteCriticalSection(&(m))
+   #define FILE_LOCK(m)             EnterCriticalSection(&(m))
+   #define FILE_UNLOCK(m)           LeaveCriticalSection(&(m))
+   #define FILE_COND_INIT(c)        InitializeConditionVariable(&(c))
+   #define FILE_COND_DESTROY(c)
+   #define FILE_WAIT(c,m)           SleepConditionVariableCS(&(c), &(m), INFINITE)
+   #define FILE_SIGNAL(c)           WakeConditionVariable(&(c))
+   #define FILE_BROADCAST(c)        WakeAllConditionVariable(&(c))
+#else
+   #include <pthread.h>
+   typedef pthread_mutex_t HostLibFileMutex;
+   typedef pthread_cond_t  HostLibFileCond;
+   #define FILE_MUTEX_INIT(m)       pthread_mutex_init(&(m), NULL)
+   #define FILE_MUTEX_DESTROY(m)    pthread_mutex_destroy(&(m))
+   #define FILE_LOCK(m)             pthread_mutex_lock(&(m))
+   #define FILE_UNLOCK(m)           pthread_mutex_unlock(&(m))
+   #define FILE_COND_INIT(c)        pthread_cond_init(&(c), NULL)
+   #define FILE_COND_DESTROY(c)     pthread_cond_destroy(&(c))
+   #define FILE_WAIT(c,m)           pthread_cond_wait(&(c), &(m))
+   #define FILE_SIGNAL(c)           pthread_cond_signal(&(c))
+   #define FILE_BROADCAST(c)        pthread_cond_broadcast(&(c))
+#endif
+
+typedef struct {
+    HostLibrary   *hostLib;
+    pFnWriteFrame_MMFile writeFrame;
+    void          *ctx;
+    unsigned char *buffers;     /* numBuffers frames, then the spare one */
+    size_t         frameBytes;
+    int            numBuffers;
+    int            dropWhenFull;
+    int            writeIdx;    /* buffer the model fills next */
+    int            readIdx;     /* buffer the writer thread writes next */
+    int            numQueued;   /* submitted, not yet being written */
+    int            numInUse;    /* submitted or being written */
+    int            dropping;    /* the model fills the spare buffer */
+    int            numDropped;
+    int            stop;
+    char           errorMessage[MAX_ERR_MSG_LEN];
+    HostLibFileMutex lock;
+    HostLibFileCond  frameQueued;
+    HostLibFileCond  bufferFree;
+#if defined(_WIN32)
+    HANDLE         thread;
+#else
+    pthread_t      thread;
+#endif
+} HostLibFileAsync;
+
+#if defined(_WIN32)
+static DWORD WINAPI fileWriterThread(LPVOID arg)
+#else
+static void *fileWriterThread(void *arg)
+#endif
+{
+    HostLibFileAsync *a = (HostLibFileAsync*)arg;
+    char err[MAX_ERR_MSG_LEN];
+    FILE_LOCK(a->lock);
+    for (;;) {
+        int idx, failed;
+        while (a->numQueued == 0 && !a->stop)
+            FILE_WAIT(a->frameQueued, a->lock);
+        if (a->numQueued == 0)
+            break;
+        idx = a->readIdx;
+        a->numQueued--;
+        failed = (a->errorMessage[0] != '\0');
+        FILE_UNLOCK(a->lock);
+
+        /* the model reads errorMessage under the lock */
+        err[0] = '\0';
+        if (!failed)
+            a->writeFrame(a->ctx, err, a->buffers + (size_t)idx*a->frameBytes,
+                          (int)a->frameBytes);
+
+        FILE_LOCK(a->lock);
+        if (err[0] != '\0') {
+            strncpy(a->errorMessage, err, MAX_ERR_MSG_LEN-1);
+            a->errorMessage[MAX_ERR_MSG_LEN-1] = '\0';
+        }
+        a->readIdx = (idx + 1) % a->numBuffers;
+        a->numInUse--;
+        /* both an acquire and a flush may be waiting */
+        FILE_BROADCAST(a->bufferFree);
+    }
+    FILE_UNLOCK(a->lock);
+    return 0;
+}
+
+/* copy an error of the writer thread to the HostLibrary error buffer; lock held */
+static void fileAsyncReportError(HostLibFileAsync *a)
+{
+    if (a->errorMessage[0] != '\0' && a->hostLib->errorMessage[0] == '\0') {
+        strncpy(a->hostLib->errorMessage, a->errorMessage, MAX_ERR_MSG_LEN-1);
+        a->hostLib->errorMessage[MAX_ERR_MSG_LEN-1] = '\0';
+    }
+}
+
+void *LibCreateAsync_MMFile(void *hl, int queueLength, int frameBytes,
+                            unsigned char dropWhenFull,
+                            pFnWriteFrame_MMFile writeFrame, void *ctx)
+{
+    HostLibrary *hostLib = (HostLibrary*)hl;
+    HostLibFileAsync *a = (HostLibFileAsync*)calloc(1, sizeof(HostLibFileAsync));
+    int ok;
+    if (queueLength < 1) queueLength = 1;
+    if (a) {
+        a->hostLib      = hostLib;
+        a->writeFrame   = writeFrame;
+        a->ctx          = ctx;
+        a->numBuffers   = queueLength;
+        a->dropWhenFull = (dropWhenFull != 0);
+        a->frameBytes   = (size_t)frameBytes;
+        a->buffers      = (unsigned char*)malloc((size_t)(queueLength + 1)*a->frameBytes);
+    }
+    if (!a || !a->buffers) {
+        if (a) free(a);
+        sprintf(hostLib->errorMessage, "Unable to allocate the video file frame buffers.");
+        return NULL;
+    }
+    FILE_MUTEX_INIT(a->lock);
+    FILE_COND_INIT(a->frameQueued);
+    FILE_COND_INIT(a->bufferFree);
+#if defined(_WIN32)
+    a->thread = CreateThread(NULL, 0, fileWriterThread, a, 0, NULL);
+    ok = (a->thread != NULL);
+#else
+    ok = (pthread_create(&a->thread, NULL, fileWriterThread, a) == 0);
+#endif
+    if (!ok) {
+        FILE_COND_DESTROY(a->bufferFree);
+        FILE_COND_DESTROY(a->frameQueued);
+        FILE_MUTEX_DESTROY(a->lock);
+        free(a->buffers);
+        free(a);
+        sprintf(hostLib->errorMessage, "Unable to start the video file writer thread.");
+        return NULL;
+    }
+    return a;
+}
+
+void *LibAcquireFrame_MMFile(void *async)
+{
+    HostLibFileAsync *a = (HostLibFileAsync*)async;
+    unsigned char *frame;
+    FILE_LOCK(a->lock);
+    a->dropping = 0;
+    if (a->numInUse == a->numBuffers && a->dropWhenFull) {
+        a->dropping = 1;
+        frame = a->buffers + (size_t)a->numBuffers*a->frameBytes;
+    } else {
+        while (a->numInUse == a->numBuffers)
+            FILE_WAIT(a->bufferFree, a->lock);
+        frame = a->buffers + (size_t)a->writeIdx*a->frameBytes;
+    }
+    fileAsyncReportError(a);
+    FILE_UNLOCK(a->lock);
+    return frame;
+}
+
+void LibSubmitFrame_MMFile(void *async)
+{
+    HostLibFileAsync *a = (HostLibFileAsync*)async;
+    FILE_LOCK(a->lock);
+    if (a->dropping) {
+        a->dropping = 0;
+        a->numDropped++;
+    } else {
+        a->writeIdx = (a->writeIdx + 1) % a->numBuffers;
+        a->numQueued++;
+        a->numInUse++;
+        FILE_SIGNAL(a->frameQueued);
+    }
+    fileAsyncReportError(a);
+    FILE_UNLOCK(a->lock);
+}
+
+void LibFlush_MMFile(void *async)
+{
+    HostLibFileAsync *a = (HostLibFileAsync*)async;
+    if (!a) return;
+    FILE_LOCK(a->lock);
+    while (a->numInUse > 0)
+        FILE_WAIT(a->bufferFree, a->lock);
+    fileAsyncReportError(a);
+    FILE_UNLOCK(a->lock);
+}
+
+int LibDroppedFrames_MMFile(void *async)
+{
+    HostLibFileAsync *a = (HostLibFileAsync*)async;
+    int n;
+    if (!a) return 0;
+    FILE_LOCK(a->lock);
+    n = a->numDropped;
+    FILE_UNLOCK(a->lock);
+    return n;
+}
+
+void LibDestroyAsync_MMFile(void *async)
+{
+    HostLibFileAsync *a = (HostLibFileAsync*)async;
+    if (!a) return;
+    FILE_LOCK(a->lock);
+    a->stop = 1;
+    FILE_SIGNAL(a->frameQueued);
+    FILE_UNLOCK(a->lock);
+#if defined(_WIN32)
+    WaitForSingleObject(a->thread, INFINITE);
+    CloseHandle(a->thread);
+#else
+    pthread_join(a->thread, NULL);
+#endif
+    fileAsyncReportError(a);
+    FILE_COND_DESTROY(a->bufferFree);
+    FILE_COND_DESTROY(a->frameQueued);
+    FILE_MUTEX_DESTROY(a->lock);
+    free(a->buffers);
+    free(a);
+}
@@ -0,0 +1,52 @@
+/**
+ * @file HostLib_MMFileAsync.h
+ * @brief Background frame writer for the VideoFileWriter and To Multimedia File code
+ * Copyright 2007-2010 The MathWorks, Inc.
+ */
+
+#include "HostLib_rtw.h"
+
+/* Wrap everything in extern C */
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*******************************
+ * Writes one frame of frameBytes bytes; called on the writer thread, in
+ * the order the frames were submitted. An error message written to err
+ * stops the writing of the frames after it.
+ *******************************/
+typedef void (*pFnWriteFrame_MMFile)(void *ctx, char *err, const void *frame, int frameBytes);
+
+/*******************************
+ * Asynchronous frame writing. The frames go through a bounded queue of
+ * queueLength frame buffers of frameBytes bytes each, allocated once and
+ * reused. The model packs a frame, in whatever layout writeFrame expects,
+ * directly into the buffer returned by LibAcquireFrame_MMFile and hands it
+ * off with LibSubmitFrame_MMFile; a writer thread then passes it to
+ * writeFrame, which encodes it, while the model goes on.
+ *
+ * When every buffer is queued, LibAcquireFrame_MMFile waits for the writer
+ * if dropWhenFull is 0. Otherwise it returns a spare buffer at once, and
+ * the frame packed into it is dropped on submit and counted by
+ * LibDroppedFrames_MMFile: a real-time model then never waits on the
+ * disk.
+ *
+ * Errors of the writer thread are reported in the HostLibrary error
+ * buffer on the next acquire or submit. LibFlush_MMFile waits until every
+ * submitted frame is written; LibDestroyAsync_MMFile also writes every
+ * frame submitted before it returns, so that releasing the writer never
+ * loses a queued frame.
+ *******************************/
+void *LibCreateAsync_MMFile(void *hostLib, int queueLength, int frameBytes,
+                            unsigned char dropWhenFull,
+                            pFnWriteFrame_MMFile writeFrame, void *ctx);
+void *LibAcquireFrame_MMFile(void *async);
+void LibSubmitFrame_MMFile(void *async);
+void LibFlush_MMFile(void *async);
+int LibDroppedFrames_MMFile(void *async);
+void LibDestroyAsync_MMFile(void *async);
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
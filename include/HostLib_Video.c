@@ -7,6 +7,7 @@
 #include "HostLib_Video.h"
 #include <string.h>
 #include <stdio.h>
+#include <stdlib.h>
 
 #if defined(_WIN32)
    const char *libName_Video = "tovideodevice.dll";
@@ -41,3 +42,200 @@ void LibUpdate_Video(void *hl, const void *R, const void *G, const void *B,
         (MAKE_FCN_PTR(pFnLibUpdate_Video,hostLib->libUpdate))(hostLib->instance, hostLib->errorMessage, R, G, B, 
                                                               curWidth, curHeight);
 }
+
+/*******************************
+ * Asynchronous frame submission
+ *******************************/
+#if defined(_WIN32)
+   typedef CRITICAL_SECTION   HostLibVideoMutex;
+   typedef CONDITION_VARIABLE HostLibVideoCond;
+   #define VIDEO_MUTEX_INIT(m)      InitializeCriticalSection(&(m))
+   #define VIDEO_MUTEX_DESTROY(m)   DeleteCriticalSection(&(m))
+   #define VIDEO_LOCK(m)            EnterCriticalSection(&(m))
+   #define VIDEO_UNLOCK(m)          LeaveCriticalSection(&(m))
+   #define VIDEO_COND_INIT(c)       InitializeConditionVariable(&(c))
+   #define VIDEO_COND_DESTROY(c)
+   #define VIDEO_WAIT(c,m)          SleepConditionVariableCS(&(c), &(m), INFINITE)
+   #define VIDEO_SIGNAL(c)          WakeConditionVariable(&(c))
+#else
+   #include <pthread.h>
+   typedef pthread_mutex_t HostLibVideoMutex;
+   typedef pthread_cond_t  HostLibVideoCond;
+   #define VIDEO_MUTEX_INIT(m)      pthread_mutex_init(&(m), NULL)
+   #define VIDEO_MUTEX_DESTROY(m)   pthread_mutex_destroy(&(m))
+   #define VIDEO_LOCK(m)            pthread_mutex_lock(&(m))
+   #define VIDEO_UNLOCK(m)          pthread_mutex_unlock(&(m))
+   #define VIDEO_COND_INIT(c)       pthread_cond_init(&(c), NULL)
+   #define VIDEO_COND_DESTROY(c)    pthread_cond_destroy(&(c))
+   #define VIDEO_WAIT(c,m)          pthread_cond_wait(&(c), &(m))
+   #define VIDEO_SIGNAL(c)          pthread_cond_signal(&(c))
+#endif
+
+typedef struct {
+    HostLibrary   *hostLib;
+    unsigned char *buffers;     /* numBuffers frames of 3 planes */
+    size_t         planeBytes;
+    int           *widths;
+    int           *heights;
+    int            numBuffers;
+    int            writeIdx;    /* buffer the model fills next */
+    int            readIdx;     /* buffer the display thread shows next */
+    int            numQueued;   /* submitted, not yet being displayed */
+    int            numInUse;    /* submitted or being displayed */
+    int            stop;
+    char           errorMessage[MAX_ERR_MSG_LEN];
+    HostLibVideoMutex lock;
+    HostLibVideoCond  frameQueued;
+    HostLibVideoCond  bufferFree;
+#if defined(_WIN32)
+    HANDLE         thread;
+#else
+    pthread_t      thread;
+#endif
+} HostLibVideoAsync;
+
+#if defined(_WIN32)
+static DWORD WINAPI videoDisplayThread(LPVOID arg)
+#else
+static void *videoDisplayThread(void *arg)
+#endif
+{
+    HostLibVideoAsync *a = (HostLibVideoAsync*)arg;
+    HostLibrary *hostLib = a->hostLib;
+    VIDEO_LOCK(a->lock);
+    for (;;) {
+        unsigned char *frame;
+        int idx;
+        while (a->numQueued == 0 && !a->stop)
+            VIDEO_WAIT(a->frameQueued, a->lock);
+        if (a->numQueued == 0)
+            break;
+        idx = a->readIdx;
+        a->numQueued--;
+        VIDEO_UNLOCK(a->lock);
+
+        frame = a->buffers + (size_t)idx*3*a->planeBytes;
+        if (hostLib->instance && a->errorMessage[0] == '\0')
+            (MAKE_FCN_PTR(pFnLibUpdate_Video,hostLib->libUpdate))(hostLib->instance, a->errorMessage,
+                                                                  frame, frame + a->planeBytes,
+                                                                  frame + 2*a->planeBytes,
+                                                                  a->widths[idx], a->heights[idx]);
+
+        VIDEO_LOCK(a->lock);
+        a->readIdx = (idx + 1) % a->numBuffers;
+        a->numInUse--;
+        VIDEO_SIGNAL(a->bufferFree);
+    }
+    VIDEO_UNLOCK(a->lock);
+    return 0;
+}
+
+/* copy an error of the display thread to the HostLibrary error buffer; lock held */
+static void videoAsyncReportError(HostLibVideoAsync *a)
+{
+    if (a->errorMessage[0] != '\0' && a->hostLib->errorMessage[0] == '\0') {
+        strncpy(a->hostLib->errorMessage, a->errorMessage, MAX_ERR_MSG_LEN-1);
+        a->hostLib->errorMessage[MAX_ERR_MSG_LEN-1] = '\0';
+    }
+}
+
+void *LibCreateAsync_Video(void *hl, int numBuffers, int maxWidth, int maxHeight,
+                           int bytesPerElement)
+{
+    HostLibrary *hostLib = (HostLibrary*)hl;
+    HostLibVideoAsync *a = (HostLibVideoAsync*)calloc(1, sizeof(HostLibVideoAsync));
+    int ok;
+    if (numBuffers < 2) numBuffers = 2;
+    if (a) {
+        a->hostLib    = hostLib;
+        a->numBuffers = numBuffers;
+        a->planeBytes = (size_t)maxWidth*maxHeight*bytesPerElement;
+        a->buffers    = (unsigned char*)malloc((size_t)numBuffers*3*a->planeBytes);
+        a->widths     = (int*)calloc(numBuffers, sizeof(int));
+        a->heights    = (int*)calloc(numBuffers, sizeof(int));
+    }
+    if (!a || !a->buffers || !a->widths || !a->heights) {
+        if (a) {
+            free(a->buffers);
+            free(a->widths);
+            free(a->heights);
+            free(a);
+        }
+        sprintf(hostLib->errorMessage, "Unable to allocate the video frame buffers.");
+        return NULL;
+    }
+    VIDEO_MUTEX_INIT(a->lock);
+    VIDEO_COND_INIT(a->frameQueued);
+    VIDEO_COND_INIT(a->bufferFree);
+#if defined(_WIN32)
+    a->thread = CreateThread(NULL, 0, videoDisplayThread, a, 0, NULL);
+    ok = (a->thread != NULL);
+#else
+    ok = (pthread_create(&a->thread, NULL, videoDisplayThread, a) == 0);
+#endif
+    if (!ok) {
+        VIDEO_COND_DESTROY(a->bufferFree);
+        VIDEO_COND_DESTROY(a->frameQueued);
+        VIDEO_MUTEX_DESTROY(a->lock);
+        free(a->buffers);
+        free(a->widths);
+        free(a->heights);
+        free(a);
+        sprintf(hostLib->errorMessage, "Unable to start the video display thread.");
+        return NULL;
+    }
+    return a;
+}
+
+void LibAcquireFrame_Video(void *async, void **R, void **G, void **B)
+{
+    HostLibVideoAsync *a = (HostLibVideoAsync*)async;
+    unsigned char *frame;
+    VIDEO_LOCK(a->lock);
+    while (a->numInUse == a->numBuffers)
+        VIDEO_WAIT(a->bufferFree, a->lock);
+    videoAsyncReportError(a);
+    frame = a->buffers + (size_t)a->writeIdx*3*a->planeBytes;
+    VIDEO_UNLOCK(a->lock);
+    *R = frame;
+    *G = frame + a->planeBytes;
+    *B = frame + 2*a->planeBytes;
+}
+
+void LibSubmitFrame_Video(void *async, int curWidth, int curHeight)
+{
+    HostLibVideoAsync *a = (HostLibVideoAsync*)async;
+    VIDEO_LOCK(a->lock);
+    a->widths[a->writeIdx]  = curWidth;
+    a->heights[a->writeIdx] = curHeight;
+    a->writeIdx = (a->writeIdx + 1) % a->numBuffers;
+    a->numQueued++;
+    a->numInUse++;
+    videoAsyncReportError(a);
+    VIDEO_SIGNAL(a->frameQueued);
+    VIDEO_UNLOCK(a->lock);
+}
+
+void LibDestroyAsync_Video(void *async)
+{
+    HostLibVideoAsync *a = (HostLibVideoAsync*)async;
+    if (!a) return;
+    VIDEO_LOCK(a->lock);
+    a->stop = 1;
+    VIDEO_SIGNAL(a->frameQueued);
+    VIDEO_UNLOCK(a->lock);
+#if defined(_WIN32)
+    WaitForSingleObject(a->thread, INFINITE);
+    CloseHandle(a->thread);
+#else
+    pthread_join(a->thread, NULL);
+#endif
+    videoAsyncReportError(a);
+    VIDEO_COND_DESTROY(a->bufferFree);
+    VIDEO_COND_DESTROY(a->frameQueued);
+    VIDEO_MUTEX_DESTROY(a->lock);
+    free(a->buffers);
+    free(a->widths);
+    free(a->heights);
+    free(a);
+}
@@ -36,6 +36,25 @@ void LibCreate_Video(void *hostLib, char *warning, const char *id, const char *w
 void LibUpdate_Video(void *hostLib, const void *R, const void *G, const void *B,
                      int curWidth, int curHeight);
 
+/*******************************
+ * Asynchronous frame submission. The frames go through a ring of
+ * numBuffers frame buffers (2 or 3 for double or triple buffering), each
+ * holding the three planes of a maxWidth x maxHeight frame with elements
+ * of bytesPerElement bytes, one plane after the other. The model writes a
+ * frame directly into the planes returned by LibAcquireFrame_Video and
+ * hands it off with LibSubmitFrame_Video; a display thread then passes it
+ * to the library's update routine while the model goes on.
+ * LibAcquireFrame_Video waits only when all the buffers are in use.
+ * Errors of the display thread are reported in the HostLibrary error
+ * buffer on the next acquire or submit. LibDestroyAsync_Video displays
+ * the frames still queued before returning.
+ *******************************/
+void *LibCreateAsync_Video(void *hostLib, int numBuffers, int maxWidth, int maxHeight,
+                           int bytesPerElement);
+void LibAcquireFrame_Video(void *async, void **R, void **G, void **B);
+void LibSubmitFrame_Video(void *async, int curWidth, int curHeight);
+void LibDestroyAsync_Video(void *async);
+
 /* Include HostLib for declarations of LibStart, LibTerminate, CreateHostLibrary, and DestroyHostLibrary. */
 #include "HostLib_rtw.h"
 
@@ -41,5 +41,27 @@ int lexi_compare_int64(const void *, const void *);
 int lexi_compare_single(const void *, const void *);
 int lexi_compare_double(const void *, const void *);
 
+/*
+ * Stable lexicographic sort of the rows of a column major numRows x numCols
+ * matrix, without sort_item indirection. perm receives the 0 based row
+ * indices in sorted order; ties keep their original order. The integer
+ * types are sorted with an LSD radix sort, one column at a time from the
+ * last one, each column being extracted into contiguous keys. The floating
+ * point types are sorted with a merge sort, on several threads when
+ * compiled with OpenMP, with NaN's equal to each other and greater than
+ * all other values, as in compare_fcn.h with DO_NAN_CHECK.
+ * Return 0, or -1 if the work memory could not be allocated.
+ */
+int lexi_sort_rows_uint8(const uint8_T *, int numRows, int numCols, int *perm);
+int lexi_sort_rows_uint16(const uint16_T *, int numRows, int numCols, int *perm);
+int lexi_sort_rows_uint32(const uint32_T *, int numRows, int numCols, int *perm);
+int lexi_sort_rows_uint64(const uint64_T *, int numRows, int numCols, int *perm);
+int lexi_sort_rows_int8(const int8_T *, int numRows, int numCols, int *perm);
+int lexi_sort_rows_int16(const int16_T *, int numRows, int numCols, int *perm);
+int lexi_sort_rows_int32(const int32_T *, int numRows, int numCols, int *perm);
+int lexi_sort_rows_int64(const int64_T *, int numRows, int numCols, int *perm);
+int lexi_sort_rows_single(const real32_T *, int numRows, int numCols, int *perm);
+int lexi_sort_rows_double(const real_T *, int numRows, int numCols, int *perm);
+
 #endif
 
@@ -0,0 +1,72 @@
+/*
+ * Copyright 2016 The MathWorks, Inc.
+ *
+ * Instantiations of the lexicographic row sorts declared in lexicmp.h.
+ */
+
+#include <string.h>
+#include "lexicmp.h"
+
+/* rows sorted by insertion before the merge passes */
+#define LEXISORT_RUN 32
+/* fewest rows sorted on several threads */
+#define LEXISORT_MIN_PARALLEL 65536
+
+/* signed integers map to unsigned keys by flipping the sign bit */
+#define SIGNED_KEY(KEY_TYPE, BITS, x) ((KEY_TYPE)(x) ^ ((KEY_TYPE)1 << ((BITS)-1)))
+
+int lexi_sort_rows_uint8
+#define TYPE     uint8_T
+#define KEY_TYPE uint8_T
+#define TO_KEY(x) (x)
+#include "lexisort_radix_fcn.h"
+
+int lexi_sort_rows_uint16
+#define TYPE     uint16_T
+#define KEY_TYPE uint16_T
+#define TO_KEY(x) (x)
+#include "lexisort_radix_fcn.h"
+
+int lexi_sort_rows_uint32
+#define TYPE     uint32_T
+#define KEY_TYPE uint32_T
+#define TO_KEY(x) (x)
+#include "lexisort_radix_fcn.h"
+
+int lexi_sort_rows_uint64
+#define TYPE     uint64_T
+#define KEY_TYPE uint64_T
+#define TO_KEY(x) (x)
+#include "lexisort_radix_fcn.h"
+
+int lexi_sort_rows_int8
+#define TYPE     int8_T
+#define KEY_TYPE uint8_T
+#define TO_KEY(x) SIGNED_KEY(uint8_T, 8, x)
+#include "lexisort_radix_fcn.h"
+
+int lexi_sort_rows_int16
+#define TYPE     int16_T
+#define KEY_TYPE uint16_T
+#define TO_KEY(x) SIGNED_KEY(uint16_T, 16, x)
+#include "lexisort_radix_fcn.h"
+
+int lexi_sort_rows_int32
+#define TYPE     int32_T
+#define KEY_TYPE uint32_T
+#define TO_KEY(x) SIGNED_KEY(uint32_T, 32, x)
+#include "lexisort_radix_fcn.h"
+
+int lexi_sort_rows_int64
+#define TYPE     int64_T
+#define KEY_TYPE uint64_T
+#define TO_KEY(x) SIGNED_KEY(uint64_T, 64, x)
+#include "lexisort_radix_fcn.h"
+
+int lexi_sort_rows_single
+#define TYPE real32_T
+#include "lexisort_merge_fcn.h"
+
+int lexi_sort_rows_double
+#define TYPE real_T
+#include "lexisort_merge_fcn.h"
@@ -0,0 +1,125 @@
+/*
+ * Copyright 2016 The MathWorks, Inc.
+ */
+
+/*
+ * This file contains the function body for a stable merge sort of the rows
+ * of a column major floating point matrix. To instantiate it, define TYPE
+ * to be the element type, then #include this file after the function name.
+ * NaN's are equal to each other and greater than all other values,
+ * including +Inf.
+ *
+ * Runs of LEXISORT_RUN rows are sorted by insertion, then merged in passes
+ * of doubling width. The runs of a pass are independent, and are done on
+ * several threads when compiled with OpenMP. Elements are compared inline,
+ * without a call through a function pointer.
+ *
+ * See lexisort.c for instantiations of this function.
+ */
+(const TYPE *data, int numRows, int numCols, int *perm)
+{
+    int *permTmp;
+    int *cur;
+    int *alt;
+    int width;
+    int numRuns;
+    int r, i;
+
+    for (i = 0; i < numRows; i++)
+    {
+        perm[i] = i;
+    }
+    if (numRows < 2 || numCols < 1)
+    {
+        return(0);
+    }
+    permTmp = (int *) malloc((size_t)numRows*sizeof(int));
+    if (permTmp == NULL)
+    {
+        return(-1);
+    }
+
+/* order of rows a and b: < 0, 0 or > 0 */
+#define LEXISORT_CMP(result, a, b)                                          \
+    {                                                                       \
+        const TYPE *x_ = data + (a);                                        \
+        const TYPE *y_ = data + (b);                                        \
+        int c_;                                                             \
+        result = 0;                                                         \
+        for (c_ = 0; c_ < numCols; c_++, x_ += numRows, y_ += numRows)     \
+        {                                                                   \
+            if (*x_ < *y_) { result = S2_IS_GREATER; break; }               \
+            if (*x_ > *y_) { result = S1_IS_GREATER; break; }               \
+            if (*x_ != *y_)                                                 \
+            {                                                               \
+                /* at least one NaN; two NaN's are equal */                 \
+                if (*y_ == *y_) { result = S1_IS_GREATER; break; }          \
+                if (*x_ == *x_) { result = S2_IS_GREATER; break; }          \
+            }                                                               \
+        }                                                                   \
+    }
+
+    numRuns = (numRows + LEXISORT_RUN - 1)/LEXISORT_RUN;
+#if defined(_OPENMP)
+    #pragma omp parallel for schedule(static) private(i) if (numRows >= LEXISORT_MIN_PARALLEL)
+#endif
+    for (r = 0; r < numRuns; r++)
+    {
+        const int start = r*LEXISORT_RUN;
+        const int end   = (start + LEXISORT_RUN < numRows) ? start + LEXISORT_RUN : numRows;
+        for (i = start+1; i < end; i++)
+        {
+            const int row = perm[i];
+            int j = i;
+            while (j > start)
+            {
+                int order;
+                LEXISORT_CMP(order, perm[j-1], row);
+                if (order <= 0)
+                {
+                    break;
+                }
+                perm[j] = perm[j-1];
+                j--;
+            }
+            perm[j] = row;
+        }
+    }
+
+    cur = perm;
+    alt = permTmp;
+    for (width = LEXISORT_RUN; width < numRows; width *= 2)
+    {
+        int *p;
+        numRuns = (numRows + 2*width - 1)/(2*width);
+#if defined(_OPENMP)
+        #pragma omp parallel for schedule(static) if (numRows >= LEXISORT_MIN_PARALLEL)
+#endif
+        for (r = 0; r < numRuns; r++)
+        {
+            const int start = r*2*width;
+            const int mid   = (start + width < numRows) ? start + width : numRows;
+            const int end   = (start + 2*width < numRows) ? start + 2*width : numRows;
+            int a = start, b = mid, k = start;
+            while (a < mid && b < end)
+            {
+                int order;
+                LEXISORT_CMP(order, cur[a], cur[b]);
+                alt[k++] = (order <= 0) ? cur[a++] : cur[b++];
+            }
+            while (a < mid) alt[k++] = cur[a++];
+            while (b < end) alt[k++] = cur[b++];
+        }
+        p = cur; cur = alt; alt = p;
+    }
+    if (cur != perm)
+    {
+        memcpy(perm, cur, (size_t)numRows*sizeof(int));
+    }
+
+#undef LEXISORT_CMP
+    free(permTmp);
+    return(0);
+}
+
+#undef TYPE
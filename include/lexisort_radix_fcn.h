@@ -0,0 +1,102 @@
+/*
+ * Copyright 2016 The MathWorks, Inc.
+ */
+
+/*
+ * This file contains the function body for a stable LSD radix sort of the
+ * rows of a column major integer matrix. To instantiate it, define TYPE to
+ * be the element type, KEY_TYPE to be the unsigned type of the same size
+ * and TO_KEY(x) to map an element to a KEY_TYPE that sorts in the same
+ * order, then #include this file after the function name.
+ *
+ * The columns are sorted from the last to the first. The elements of a
+ * column are first gathered in the current row order into a contiguous
+ * array of keys, which the byte passes then sort along with the row
+ * indices. A pass whose byte is the same for all the keys is skipped.
+ *
+ * See lexisort.c for instantiations of this function.
+ */
+(const TYPE *data, int numRows, int numCols, int *perm)
+{
+    int *permTmp;
+    int *cur;
+    int *alt;
+    KEY_TYPE *keys;
+    KEY_TYPE *keysTmp;
+    int count[256];
+    int c, i, b;
+
+    for (i = 0; i < numRows; i++)
+    {
+        perm[i] = i;
+    }
+    if (numRows < 2 || numCols < 1)
+    {
+        return(0);
+    }
+
+    permTmp = (int *) malloc((size_t)numRows*sizeof(int));
+    keys    = (KEY_TYPE *) malloc((size_t)numRows*sizeof(KEY_TYPE));
+    keysTmp = (KEY_TYPE *) malloc((size_t)numRows*sizeof(KEY_TYPE));
+    if (permTmp == NULL || keys == NULL || keysTmp == NULL)
+    {
+        free(permTmp);
+        free(keys);
+        free(keysTmp);
+        return(-1);
+    }
+
+    cur = perm;
+    alt = permTmp;
+    for (c = numCols-1; c >= 0; c--)
+    {
+        const TYPE *col = data + (size_t)c*numRows;
+        for (i = 0; i < numRows; i++)
+        {
+            keys[i] = TO_KEY(col[cur[i]]);
+        }
+        for (b = 0; b < (int)sizeof(KEY_TYPE); b++)
+        {
+            const int shift = 8*b;
+            int sum = 0;
+            int *p;
+            KEY_TYPE *k;
+            memset(count, 0, sizeof(count));
+            for (i = 0; i < numRows; i++)
+            {
+                count[(keys[i] >> shift) & 0xFF]++;
+            }
+            if (count[(keys[0] >> shift) & 0xFF] == numRows)
+            {
+                continue;
+            }
+            for (i = 0; i < 256; i++)
+            {
+                const int n = count[i];
+                count[i] = sum;
+                sum += n;
+            }
+            for (i = 0; i < numRows; i++)
+            {
+                const int dst = count[(keys[i] >> shift) & 0xFF]++;
+                keysTmp[dst] = keys[i];
+                alt[dst]     = cur[i];
+            }
+            k = keys; keys = keysTmp; keysTmp = k;
+            p = cur;  cur  = alt;     alt     = p;
+        }
+    }
+    if (cur != perm)
+    {
+        memcpy(perm, cur, (size_t)numRows*sizeof(int));
+    }
+
+    free(permTmp);
+    free(keys);
+    free(keysTmp);
+    return(0);
+}
+
+#undef TYPE
+#undef KEY_TYPE
+#undef TO_KEY
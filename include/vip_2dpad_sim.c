@@ -0,0 +1,86 @@
+/*
+ *  VIP_2DPAD_SIM.C - index tables and table driven copy for 2D padding
+ *
+ *  Copyright 2016 The MathWorks, Inc.
+ */
+
+#include <string.h>
+#include "vip_2dpad_sim.h"
+
+/* input position read by output position k, or VIPSIM_PAD2D_PADVALUE */
+static int_T padIndex(VIPSIM_Pad2dMode mode, int_T numIn, int_T k)
+{
+    int_T period;
+    if (k >= 0 && k < numIn) return k;
+    if (numIn <= 0) return VIPSIM_PAD2D_PADVALUE;
+    switch (mode) {
+    case VIPSIM_PAD2D_REPLICATE:
+        return (k < 0) ? 0 : numIn-1;
+    case VIPSIM_PAD2D_SYMMETRIC:
+        /* mirror about the boundary, the edge element included */
+        period = 2*numIn;
+        k %= period;
+        if (k < 0) k += period;
+        return (k < numIn) ? k : period-1-k;
+    case VIPSIM_PAD2D_CIRCULAR:
+        k %= numIn;
+        return (k < 0) ? k+numIn : k;
+    default:
+        return VIPSIM_PAD2D_PADVALUE;
+    }
+}
+
+void VIPSIM_Pad2dIndexTable(VIPSIM_Pad2dMode mode, int_T numIn, int_T padBefore,
+                            int_T numOut, int_T *idx,
+                            int_T *firstInterior, int_T *endInterior)
+{
+    int_T k;
+    int_T first = padBefore < 0 ? 0 : padBefore;
+    int_T end   = padBefore + numIn;
+    if (end > numOut) end = numOut;
+    if (end < first)  end = first;
+    for (k = 0; k < numOut; k++) {
+        idx[k] = padIndex(mode, numIn, k - padBefore);
+    }
+    *firstInterior = first;
+    *endInterior   = end;
+}
+
+void VIPSIM_Pad2dFromTables(VIPSIM_2dPadArgsCache *args,
+                            const int_T *rowIdx, const int_T *colIdx,
+                            int_T firstInteriorRow, int_T endInteriorRow)
+{
+    const int_T bpe     = args->bytesPerInpElmt;
+    const int_T bpc     = args->bytesPerInpCol;
+    const int_T numRows = args->numOutRows;
+    const byte_T *u     = (const byte_T *)args->u;
+    byte_T       *y     = (byte_T *)args->y;
+    const byte_T *pad   = (const byte_T *)args->padValue;
+    int_T c, r;
+
+    for (c = 0; c < args->numOutCols; c++) {
+        byte_T *yc = y + (size_t)c*numRows*bpe;
+        const byte_T *uc;
+        if (colIdx[c] == VIPSIM_PAD2D_PADVALUE) {
+            for (r = 0; r < numRows; r++) {
+                memcpy(yc + (size_t)r*bpe, pad, bpe);
+            }
+            continue;
+        }
+        uc = u + (size_t)colIdx[c]*bpc;
+        for (r = 0; r < firstInteriorRow; r++) {
+            memcpy(yc + (size_t)r*bpe,
+                   rowIdx[r] == VIPSIM_PAD2D_PADVALUE ? pad : uc + (size_t)rowIdx[r]*bpe, bpe);
+        }
+        if (endInteriorRow > firstInteriorRow) {
+            memcpy(yc + (size_t)firstInteriorRow*bpe, uc + (size_t)rowIdx[firstInteriorRow]*bpe,
+                   (size_t)(endInteriorRow - firstInteriorRow)*bpe);
+        }
+        for (r = endInteriorRow; r < numRows; r++) {
+            memcpy(yc + (size_t)r*bpe,
+                   rowIdx[r] == VIPSIM_PAD2D_PADVALUE ? pad : uc + (size_t)rowIdx[r]*bpe, bpe);
+        }
+    }
+}
+
+/* [EOF] vip_2dpad_sim.c */
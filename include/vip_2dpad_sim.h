@@ -61,6 +61,39 @@ extern void VIPSIM_Pad2dSymmetric_RC(VIPSIM_2dPadArgsCache *args);
 /* Pad circularly about the boundary of the input matrix. */
 extern void VIPSIM_Pad2dCircular_RC(VIPSIM_2dPadArgsCache *args);
 
+/* Padding without a padded copy.
+ *
+ * VIPSIM_Pad2dIndexTable maps each of the numOut output positions along one
+ * dimension (rows or columns) to the input position it reads, for an input
+ * of numIn elements with padBefore pad elements before it; positions set
+ * to VIPSIM_PAD2D_PADVALUE read the constant pad value. A filter can look
+ * its border pixels up in the row and column tables and read the input
+ * directly elsewhere: the output positions firstInterior..endInterior-1
+ * map to consecutive input positions.
+ */
+#define VIPSIM_PAD2D_PADVALUE (-1)
+
+typedef enum {
+    VIPSIM_PAD2D_CONSTANT = 0,
+    VIPSIM_PAD2D_REPLICATE,
+    VIPSIM_PAD2D_SYMMETRIC,
+    VIPSIM_PAD2D_CIRCULAR
+} VIPSIM_Pad2dMode;
+
+extern void VIPSIM_Pad2dIndexTable(VIPSIM_Pad2dMode mode, int_T numIn, int_T padBefore,
+                                   int_T numOut, int_T *idx,
+                                   int_T *firstInterior, int_T *endInterior);
+
+/* Padded copy from row and column tables made by VIPSIM_Pad2dIndexTable,
+ * for when the client needs the padded matrix itself. Only u, y, padValue,
+ * bytesPerInpElmt, bytesPerInpCol, numOutRows and numOutCols of args are
+ * used. The interior of each column is copied with one memcpy. Input,
+ * output and pad value must have the same complexity.
+ */
+extern void VIPSIM_Pad2dFromTables(VIPSIM_2dPadArgsCache *args,
+                                   const int_T *rowIdx, const int_T *colIdx,
+                                   int_T firstInteriorRow, int_T endInteriorRow);
+
 #endif /* vip_2dpad_sim_h */
 
 /* [EOF] vip_2dpad_sim.h */
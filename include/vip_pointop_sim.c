@@ -0,0 +1,118 @@
+/*
+ *  VIP_POINTOP_SIM.C - chained point operations on image planes
+ *
+ *  Copyright 2016 The MathWorks, Inc.
+ */
+
+#include <math.h>
+#include <string.h>
+#include "vip_pointop_sim.h"
+
+/* elements of a plane that go through the whole chain at a time */
+#define POINTOP_BLOCK 1024
+
+void VIPSIM_PointOpTable_U8(const VIPSIM_PointOp *ops, int_T numOps, uint8_T *lut)
+{
+    int_T i, k;
+    for (i = 0; i < 256; i++) {
+        lut[i] = (uint8_T)i;
+    }
+    for (k = 0; k < numOps; k++) {
+        const VIPSIM_PointOp *op = &ops[k];
+        for (i = 0; i < 256; i++) {
+            const real_T x = (real_T)lut[i];
+            real_T y;
+            switch (op->type) {
+            case VIPSIM_POINTOP_COMPLEMENT:
+                lut[i] = (uint8_T)(255 - lut[i]);
+                continue;
+            case VIPSIM_POINTOP_LUT:
+                lut[i] = op->lut[lut[i]];
+                continue;
+            case VIPSIM_POINTOP_THRESHOLD:
+                lut[i] = (x > op->a) ? 255 : 0;
+                continue;
+            case VIPSIM_POINTOP_GAMMA:
+                y = 255.0*pow(x/255.0, op->a);
+                break;
+            case VIPSIM_POINTOP_SCALE:
+            default:
+                y = op->a*x + op->b;
+                break;
+            }
+            lut[i] = (y >= 255.0) ? 255 : (y > 0.0) ? (uint8_T)(y + 0.5) : 0;
+        }
+    }
+}
+
+void VIPSIM_PointOps_U8(const uint8_T * const *in, uint8_T **out, const int_T *numElems,
+                        int_T numPlanes, const VIPSIM_PointOp *ops, int_T numOps)
+{
+    uint8_T lut[256];
+    int_T p, i;
+    VIPSIM_PointOpTable_U8(ops, numOps, lut);
+    for (p = 0; p < numPlanes; p++) {
+        const uint8_T *u = in[p];
+        uint8_T       *y = out[p];
+        const int_T    n = numElems[p];
+        /* unrolled so that the loads of the table overlap */
+        for (i = 0; i + 4 <= n; i += 4) {
+            const uint8_T y0 = lut[u[i]];
+            const uint8_T y1 = lut[u[i+1]];
+            const uint8_T y2 = lut[u[i+2]];
+            const uint8_T y3 = lut[u[i+3]];
+            y[i]   = y0;
+            y[i+1] = y1;
+            y[i+2] = y2;
+            y[i+3] = y3;
+        }
+        for (; i < n; i++) {
+            y[i] = lut[u[i]];
+        }
+    }
+}
+
+#define POINTOP_FLOAT(TYPE, SUFFIX)                                                 \
+void VIPSIM_PointOps_##SUFFIX(const TYPE * const *in, TYPE **out, const int_T *numElems, \
+                              int_T numPlanes, const VIPSIM_PointOp *ops, int_T numOps) \
+{                                                                                   \
+    int_T p, start, i, k;                                                           \
+    for (p = 0; p < numPlanes; p++) {                                               \
+        const int_T n = numElems[p];                                                \
+        for (start = 0; start < n; start += POINTOP_BLOCK) {                        \
+            const int_T len = (n - start < POINTOP_BLOCK) ? n - start : POINTOP_BLOCK; \
+            const TYPE *u = in[p] + start;                                          \
+            TYPE       *y = out[p] + start;                                         \
+            if (u != y) memcpy(y, u, (size_t)len*sizeof(TYPE));                     \
+            for (k = 0; k < numOps; k++) {                                          \
+                const TYPE a = (TYPE)ops[k].a;                                      \
+                const TYPE b = (TYPE)ops[k].b;                                      \
+                switch (ops[k].type) {                                              \
+                case VIPSIM_POINTOP_COMPLEMENT:                                     \
+                    for (i = 0; i < len; i++) y[i] = (TYPE)1 - y[i];                \
+                    break;                                                          \
+                case VIPSIM_POINTOP_SCALE:                                          \
+                    for (i = 0; i < len; i++) y[i] = a*y[i] + b;                    \
+                    break;                                                          \
+                case VIPSIM_POINTOP_THRESHOLD:                                      \
+                    for (i = 0; i < len; i++) y[i] = (y[i] > a) ? (TYPE)1 : (TYPE)0; \
+                    break;                                                          \
+                case VIPSIM_POINTOP_GAMMA:                                          \
+                    for (i = 0; i < len; i++) {                                     \
+                        const TYPE x = (y[i] > (TYPE)1) ? (TYPE)1                   \
+                                     : (y[i] > (TYPE)0) ? y[i] : (TYPE)0;           \
+                        y[i] = (TYPE)pow((real_T)x, ops[k].a);                      \
+                    }                                                               \
+                    break;                                                          \
+                default: /* lookup tables are for uint8 only */                     \
+                    break;                                                          \
+                }                                                                   \
+            }                                                                       \
+        }                                                                           \
+    }                                                                               \
+}
+
+POINTOP_FLOAT(real_T,   D)
+POINTOP_FLOAT(real32_T, R)
+
+/* [EOF] vip_pointop_sim.c */
@@ -0,0 +1,62 @@
+/*
+ *  VIP_POINTOP_SIM.H - simulation helper functions for chained point
+ *  operations (complement, gamma, scale, threshold, lookup table)
+ *
+ *  Copyright 2016 The MathWorks, Inc.
+ */
+
+#ifndef vip_pointop_sim_h
+#define vip_pointop_sim_h
+
+#include "dsp_rt.h"
+
+/* Point operations on a value x of an image whose full scale is M
+ * (1 for single and double, 255 for uint8):
+ *
+ *   VIPSIM_POINTOP_COMPLEMENT  M - x
+ *   VIPSIM_POINTOP_GAMMA       M*(x/M)^a, x clipped to [0, M]
+ *   VIPSIM_POINTOP_SCALE       a*x + b
+ *   VIPSIM_POINTOP_THRESHOLD   M if x > a, else 0
+ *   VIPSIM_POINTOP_LUT         lut[x], uint8 only
+ *
+ * The uint8 results are rounded to nearest and saturated after each
+ * operation.
+ */
+typedef enum {
+    VIPSIM_POINTOP_COMPLEMENT = 0,
+    VIPSIM_POINTOP_GAMMA,
+    VIPSIM_POINTOP_SCALE,
+    VIPSIM_POINTOP_THRESHOLD,
+    VIPSIM_POINTOP_LUT
+} VIPSIM_PointOpType;
+
+typedef struct {
+    VIPSIM_PointOpType type;
+    real_T             a;
+    real_T             b;
+    const uint8_T     *lut;   /* 256 entries, for VIPSIM_POINTOP_LUT */
+} VIPSIM_PointOp;
+
+/* Simulation helper functions to apply numOps operations, in order, to
+ * numPlanes planes (ports or color planes) of numElems[p] elements in one
+ * pass per plane. out[p] may be in[p].
+ *
+ * For uint8 the chain is first folded into one 256 entry table, so each
+ * pixel costs one lookup however many operations are chained. For single
+ * and double, blocks of elements go through the whole chain while they
+ * are in the cache, each operation being a loop the compiler vectorizes.
+ */
+extern void VIPSIM_PointOpTable_U8(const VIPSIM_PointOp *ops, int_T numOps, uint8_T *lut);
+
+extern void VIPSIM_PointOps_U8(const uint8_T * const *in, uint8_T **out, const int_T *numElems,
+                               int_T numPlanes, const VIPSIM_PointOp *ops, int_T numOps);
+
+extern void VIPSIM_PointOps_D(const real_T * const *in, real_T **out, const int_T *numElems,
+                              int_T numPlanes, const VIPSIM_PointOp *ops, int_T numOps);
+
+extern void VIPSIM_PointOps_R(const real32_T * const *in, real32_T **out, const int_T *numElems,
+                              int_T numPlanes, const VIPSIM_PointOp *ops, int_T numOps);
+
+#endif /* vip_pointop_sim_h */
+
+/* [EOF] vip_pointop_sim.h */
@@ -62,6 +62,62 @@ classdef ForegroundDetectorBuildable < coder.ExternalDependency %#codegen
             
         end
 
+        function ForegroundDetector_initializeROI(...
+            ptrObj, ...
+            imageType, ...
+            statType, ...
+            I, ...
+            numGaussians, initialVariance, initialWeight, varianceThreshold, minBGRatio, ...
+            roiMask, downsampleFactor)
+            coder.inline('always');
+            coder.cinclude('cvstCG_foregroundDetector.h');
+
+            numDim = int32(ndims(I));
+            dims = int32(size(I));
+
+            if coder.isColumnMajor
+                fcnName = ['foregroundDetector_initializeROI_' imageType '_'  statType];
+            else
+                fcnName = ['foregroundDetector_initializeROI_rowMaj_' imageType '_'  statType];
+            end
+            coder.ceval('-layout:any',fcnName,...
+                        ptrObj, ...
+                        numDim, ...
+                        dims, ...
+                        int32(numGaussians), ...
+                        initialVariance, ...
+                        initialWeight, ...
+                        varianceThreshold, ...
+                        minBGRatio, ...
+                        coder.rref(logical(roiMask)), ...
+                        int32(downsampleFactor));
+
+        end
+
+        % bytes used by a detector initialized for images of imageSize, at
+        % the peak of a step and kept between steps
+        function [peakBytes, steadyBytes] = ForegroundDetector_estimateMemory( ...
+            imageType, statType, imageSize, numGaussians, downsampleFactor, useROI)
+            coder.inline('always');
+            coder.cinclude('cvstCG_foregroundDetector.h');
+
+            numDim = int32(numel(imageSize));
+            dims = int32(imageSize);
+
+            peakBytes = 0;
+            steadyBytes = 0;
+            fcnName = ['foregroundDetector_estimateMemory_' imageType '_'  statType];
+            coder.ceval(fcnName, ...
+                        numDim, ...
+                        dims, ...
+                        int32(numGaussians), ...
+                        int32(downsampleFactor), ...
+                        logical(useROI), ...
+                        false, ...
+                        coder.ref(peakBytes), ...
+                        coder.ref(steadyBytes));
+        end
+
         function outMask = ForegroundDetector_step(ptrObj, imageType, statType, I, learningRate) 
             
             coder.inline('always');
@@ -105,6 +161,38 @@ classdef ForegroundDetectorBuildable < coder.ExternalDependency %#codegen
                         ptrObj);
         end
 
+        function ForegroundDetector_setGrainSize(ptrObj, imageType, statType, grainSize)
+
+            coder.inline('always');
+            coder.cinclude('cvstCG_foregroundDetector.h');
+
+            fcnName = ['foregroundDetector_setGrainSize_' imageType '_'  statType];
+            coder.ceval('-layout:any',fcnName, ...
+                        ptrObj, ...
+                        int32(grainSize));
+        end
+
+        % maximum number of threads of all the detectors, 0 for no limit
+        function ForegroundDetector_setNumThreads(numThreads)
+
+            coder.inline('always');
+            coder.cinclude('cvstCG_foregroundDetector.h');
+
+            coder.ceval('-layout:any','foregroundDetector_setNumThreads', ...
+                        int32(numThreads));
+        end
+
+        % NUMA placement of the detectors initialized afterwards: 0 (none),
+        % 1 (first touch, default) or 2 (one task arena per node)
+        function ForegroundDetector_setNumaPolicy(policy)
+
+            coder.inline('always');
+            coder.cinclude('cvstCG_foregroundDetector.h');
+
+            coder.ceval('-layout:any','foregroundDetector_setNumaPolicy', ...
+                        int32(policy));
+        end
+
         function ForegroundDetector_delete(ptrObj, imageType, statType)           
 
             coder.inline('always');
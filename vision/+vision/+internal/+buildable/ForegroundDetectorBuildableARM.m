@@ -23,9 +23,12 @@ classdef ForegroundDetectorBuildableARM < coder.ExternalDependency %#codegen
 
                 buildInfo.addIncludeFiles({'foregroundDetector_published_c_api.hpp',...
                     'ForegroundDetectorFunctor.hpp', ...
+                    'ForegroundDetectorFixedPointFunctor.hpp', ...
                     'ForegroundDetectorImpl.hpp',...
                     'ForegroundDetectorTraits.hpp', ...
                     'ForegroundDetectorUtil.hpp', ...
+                    'ForegroundDetectorSIMD.hpp', ...
+                    'GaussianMixtureStore.hpp', ...
                     'WeightedGaussian.hpp',...
                     'vision_defines.h'
                     });
@@ -79,6 +82,38 @@ classdef ForegroundDetectorBuildableARM < coder.ExternalDependency %#codegen
             
         end
 
+        function ForegroundDetector_initializeROI(...
+            ptrObj, ...
+            imageType, ...
+            statType, ...
+            I, ...
+            numGaussians, initialVariance, initialWeight, varianceThreshold, minBGRatio, ...
+            roiMask, downsampleFactor)
+            coder.inline('always');
+            coder.cinclude('foregroundDetector_published_c_api.hpp');
+
+            numDim = int32(ndims(I));
+            dims = int32(size(I));
+
+            if coder.isColumnMajor
+                fcnName = ['foregroundDetector_initializeROI_' imageType '_'  statType];
+            else
+                fcnName = ['foregroundDetector_initializeROI_rowMaj_' imageType '_'  statType];
+            end
+            coder.ceval('-layout:any',fcnName,...
+                        ptrObj, ...
+                        numDim, ...
+                        dims, ...
+                        int32(numGaussians), ...
+                        initialVariance, ...
+                        initialWeight, ...
+                        varianceThreshold, ...
+                        minBGRatio, ...
+                        coder.rref(logical(roiMask)), ...
+                        int32(downsampleFactor));
+
+        end
+
         function outMask = ForegroundDetector_step(ptrObj, imageType, statType, I, learningRate) 
             
             coder.inline('always');
@@ -122,6 +157,17 @@ classdef ForegroundDetectorBuildableARM < coder.ExternalDependency %#codegen
                         ptrObj);
         end
 
+        function ForegroundDetector_setGrainSize(ptrObj, imageType, statType, grainSize)
+
+            coder.inline('always');
+            coder.cinclude('foregroundDetector_published_c_api.hpp');
+
+            fcnName = ['foregroundDetector_setGrainSize_' imageType '_'  statType];
+            coder.ceval('-layout:any',fcnName, ...
+                        ptrObj, ...
+                        int32(grainSize));
+        end
+
         function ForegroundDetector_delete(ptrObj, imageType, statType)           
 
             coder.inline('always');
@@ -31,8 +31,16 @@ classdef HOGDescriptorBuildable < coder.ExternalDependency  %#codegen
             buildInfo.addIncludeFiles({'vision_defines.h', ...
                                        'HOGDescriptorCore_api.hpp', ...
                                        'cgCommon.hpp', ...                                       
+                                       'cgThreadPool.hpp', ...
+                                       'cgResultPool.hpp', ...
+                                       'cgPyramidCache.hpp', ...
+                                       'cgIntegralImage.hpp', ...
+                                       'cgPipeline.hpp', ...
+                                       'mwtranspose.hpp', ...
                                        'mwobjdetect.hpp', ...
                                        'mwcascadedetect.hpp', ...
+                                       'ObjectDetectorCuda.hpp', ...
+                                       'ImageHandle.hpp', ...
                                        'precomp_objdetect.hpp'}); % no need 'rtwtypes.h'           
                                  
             vision.internal.buildable.portableOpenCVBuildInfo(buildInfo, context, ...
@@ -61,6 +69,37 @@ classdef HOGDescriptorBuildable < coder.ExternalDependency  %#codegen
             % call function from shared library
             coder.ceval('HOGDescriptor_setup', ptrObj, int32(whichModel));
         end 
+
+        %------------------------------------------------------------------
+        % memory cap of detectMultiScale in megabytes, 0 for none
+        function HOGDescriptor_setMemoryBudget(ptrObj, budgetMB)
+            coder.inline('always');
+            coder.cinclude('HOGDescriptorCore_api.hpp');
+
+            coder.ceval('HOGDescriptor_setMemoryBudget', ptrObj, double(budgetMB));
+        end
+
+        %------------------------------------------------------------------
+        % bytes used by detectMultiScale on images of imageSize, at the
+        % peak of a call and kept between calls
+        function [peakBytes, steadyBytes] = HOGDescriptor_estimateMemory(ptrObj, imageSize, ...
+                ScaleFactor, MinSize, MaxSize, WindowStride)
+            coder.inline('always');
+            coder.cinclude('HOGDescriptorCore_api.hpp');
+
+            isRGB = (numel(imageSize) > 2 && imageSize(3) == 3);
+            MinSize_ = cCast2('int32_T', MinSize);
+            MaxSize_ = cCast2('int32_T', MaxSize);
+            WindowStride_ = cCast2('int32_T', WindowStride);
+
+            peakBytes = 0;
+            steadyBytes = 0;
+            coder.ceval('HOGDescriptor_estimateMemory', ptrObj, ...
+                int32(imageSize(1)), int32(imageSize(2)), isRGB, ...
+                cCast1('double', ScaleFactor), ...
+                coder.ref(MinSize_), coder.ref(MaxSize_), coder.ref(WindowStride_), ...
+                coder.ref(peakBytes), coder.ref(steadyBytes));
+        end
         
         %------------------------------------------------------------------
         % write all supported data-type specific function calls       
@@ -163,6 +202,154 @@ end
             % call function from shared library
             coder.ceval('HOGDescriptor_deleteObj', ptrObj);
         end         
+
+        %------------------------------------------------------------------
+        % returns a NULL pointer when the device is not available, in which
+        % case the CPU descriptor must be used
+        function ptrObj = HOGDescriptorCuda_construct(device)
+
+            coder.inline('always');
+            coder.cinclude('HOGDescriptorCore_api.hpp');
+
+            ptrObj = coder.opaque('void *', 'NULL');
+
+            % call function from shared library
+            coder.ceval('HOGDescriptorCuda_construct', coder.ref(ptrObj), ...
+                int32(device));
+        end
+
+        %------------------------------------------------------------------
+        function HOGDescriptorCuda_setup(ptrObj, whichModel)
+            coder.inline('always');
+            coder.cinclude('HOGDescriptorCore_api.hpp');
+
+            coder.ceval('HOGDescriptorCuda_setup', ptrObj, int32(whichModel));
+        end
+
+        %------------------------------------------------------------------
+        % same outputs as HOGDescriptor_detectMultiScale
+        function [bbox, scores] = HOGDescriptorCuda_detectMultiScale(ptrObj, I, ScaleFactor, ...
+                ClassificationThreshold, ...
+                postMergeThreshold, ...
+                MinSize, MaxSize, WindowStride, ...
+                MergeDetections)
+
+            coder.inline('always');
+            coder.cinclude('HOGDescriptorCore_api.hpp');
+
+            nRows = int32(size(I, 1));
+            nCols = int32(size(I, 2));
+            isRGB = (size(I, 3) == 3);
+            ScaleFactor_ = cCast1('double', ScaleFactor);
+            ClassificationThreshold_ = cCast1('double', ClassificationThreshold);
+            postMergeThreshold_ = cCast1('double', postMergeThreshold);
+            MinSize_ = cCast2('int32_T', MinSize);
+            MaxSize_ = cCast2('int32_T', MaxSize);
+            WindowStride_ = cCast2('int32_T', WindowStride);
+            MergeDetections_ = (MergeDetections==true);% output always logical
+
+            ptrDetectedObj     = coder.opaque('void *', 'NULL');
+            ptrDetectionScores = coder.opaque('void *', 'NULL');
+
+            numDetectedObj = int32(0);
+            numDetectionScores = int32(0);
+
+            if coder.isColumnMajor
+                coder.ceval('-col', 'HOGDescriptorCuda_detectMultiScale', ...
+                    ptrObj, coder.ref(ptrDetectedObj), coder.ref(ptrDetectionScores), ...
+                    I, nRows, nCols, isRGB, ...
+                    ScaleFactor_, ClassificationThreshold_, postMergeThreshold_, ...
+                    coder.ref(MinSize_), coder.ref(MaxSize_), coder.ref(WindowStride_), ...
+                    MergeDetections_, ...
+                    coder.ref(numDetectedObj), coder.ref(numDetectionScores));
+            else
+                coder.ceval('-row', 'HOGDescriptorCuda_detectMultiScaleRM', ...
+                    ptrObj, coder.ref(ptrDetectedObj), coder.ref(ptrDetectionScores), ...
+                    I, nRows, nCols, isRGB, ...
+                    ScaleFactor_, ClassificationThreshold_, postMergeThreshold_, ...
+                    coder.ref(MinSize_), coder.ref(MaxSize_), coder.ref(WindowStride_), ...
+                    MergeDetections_, ...
+                    coder.ref(numDetectedObj), coder.ref(numDetectionScores));
+            end
+
+            coder.varsize('bboxes_', [inf, 4]);
+            bbox_ = coder.nullcopy(zeros(double(numDetectedObj),4,'int32'));
+            coder.varsize('scores_', [inf, 1]);
+            scores_ = coder.nullcopy(zeros(double(numDetectionScores),1,'double'));
+
+            % the outputs are freed as those of the CPU descriptor
+            if coder.isColumnMajor
+                coder.ceval('-col', 'HOGDescriptor_assignOutputDeleteVectors', ...
+                    ptrDetectedObj, ptrDetectionScores, ...
+                    coder.ref(bbox_), coder.ref(scores_));
+            else
+                coder.ceval('-row', 'HOGDescriptor_assignOutputDeleteVectorsRM', ...
+                    ptrDetectedObj, ptrDetectionScores, ...
+                    coder.ref(bbox_), coder.ref(scores_));
+            end
+            bbox   = double(bbox_);
+            scores = double(scores_);
+        end
+
+        %------------------------------------------------------------------
+        % detectMultiScale on the image of an imageHandleBuildable handle
+        function [bbox, scores] = HOGDescriptorCuda_detectMultiScaleImage(ptrObj, ptrImage, ...
+                ScaleFactor, ClassificationThreshold, ...
+                postMergeThreshold, ...
+                MinSize, MaxSize, WindowStride, ...
+                MergeDetections)
+
+            coder.inline('always');
+            coder.cinclude('HOGDescriptorCore_api.hpp');
+
+            ScaleFactor_ = cCast1('double', ScaleFactor);
+            ClassificationThreshold_ = cCast1('double', ClassificationThreshold);
+            postMergeThreshold_ = cCast1('double', postMergeThreshold);
+            MinSize_ = cCast2('int32_T', MinSize);
+            MaxSize_ = cCast2('int32_T', MaxSize);
+            WindowStride_ = cCast2('int32_T', WindowStride);
+            MergeDetections_ = (MergeDetections==true);% output always logical
+
+            ptrDetectedObj     = coder.opaque('void *', 'NULL');
+            ptrDetectionScores = coder.opaque('void *', 'NULL');
+
+            numDetectedObj = int32(0);
+            numDetectionScores = int32(0);
+
+            coder.ceval('HOGDescriptorCuda_detectMultiScaleImage', ...
+                ptrObj, coder.ref(ptrDetectedObj), coder.ref(ptrDetectionScores), ...
+                ptrImage, ...
+                ScaleFactor_, ClassificationThreshold_, postMergeThreshold_, ...
+                coder.ref(MinSize_), coder.ref(MaxSize_), coder.ref(WindowStride_), ...
+                MergeDetections_, ...
+                coder.ref(numDetectedObj), coder.ref(numDetectionScores));
+
+            coder.varsize('bboxes_', [inf, 4]);
+            bbox_ = coder.nullcopy(zeros(double(numDetectedObj),4,'int32'));
+            coder.varsize('scores_', [inf, 1]);
+            scores_ = coder.nullcopy(zeros(double(numDetectionScores),1,'double'));
+
+            if coder.isColumnMajor
+                coder.ceval('-col', 'HOGDescriptor_assignOutputDeleteVectors', ...
+                    ptrDetectedObj, ptrDetectionScores, ...
+                    coder.ref(bbox_), coder.ref(scores_));
+            else
+                coder.ceval('-row', 'HOGDescriptor_assignOutputDeleteVectorsRM', ...
+                    ptrDetectedObj, ptrDetectionScores, ...
+                    coder.ref(bbox_), coder.ref(scores_));
+            end
+            bbox   = double(bbox_);
+            scores = double(scores_);
+        end
+
+        %------------------------------------------------------------------
+        function HOGDescriptorCuda_deleteObj(ptrObj)
+
+            coder.inline('always');
+            coder.cinclude('HOGDescriptorCore_api.hpp');
+
+            coder.ceval('HOGDescriptorCuda_deleteObj', ptrObj);
+        end
         
     end   
 end
@@ -0,0 +1,154 @@
+classdef acfObjectDetectorBuildable < coder.ExternalDependency %#codegen
+    % acfObjectDetectorBuildable - aggregate channel features detector of
+    % acfObjectDetector and detectPeopleACF, see
+    % vision.internal.acf.computePyramid and vision.internal.acf.detect
+
+    % Copyright 2016 The MathWorks, Inc.
+
+    methods (Static)
+
+        function name = getDescriptiveName(~)
+            name = 'acfObjectDetectorBuildable';
+        end
+
+        function b = isSupportedContext(~)
+            b = true; % supports non-host target
+        end
+
+        function updateBuildInfo(buildInfo, context)
+            buildInfo.addIncludePaths({fullfile(matlabroot,'toolbox', ...
+                'vision','builtins','src','ocv','include'), ...
+                fullfile(matlabroot,'toolbox', ...
+                'vision','builtins','src','ocvcg', 'opencv', 'include')} );
+            buildInfo.addSourcePaths({fullfile(matlabroot,'toolbox', ...
+                'vision','builtins','src','ocv')});
+            buildInfo.addSourceFiles({'acfObjectDetectorCore.cpp', ...
+                'cgCommon.cpp'});
+            buildInfo.addIncludeFiles({'vision_defines.h', ...
+                                       'acfObjectDetectorCore_api.hpp', ...
+                                       'AcfDetector.hpp', ...
+                                       'cgCommon.hpp', ...
+                                       'cgThreadPool.hpp', ...
+                                       'cgResultPool.hpp', ...
+                                       'cgPyramidCache.hpp', ...
+                                       'cgIntegralImage.hpp', ...
+                                       'cgPipeline.hpp', ...
+                                       'mwtranspose.hpp'}); % no need 'rtwtypes.h'
+
+            vision.internal.buildable.portableOpenCVBuildInfo(buildInfo, context, ...
+                'acfObjectDetector');
+        end
+
+        %------------------------------------------------------------------
+        function ptrObj = acfObjectDetector_construct()
+
+            coder.inline('always');
+            coder.cinclude('acfObjectDetectorCore_api.hpp');
+
+            ptrObj = coder.opaque('void *', 'NULL');
+
+            coder.ceval('acfObjectDetector_construct', coder.ref(ptrObj));
+        end
+
+        %------------------------------------------------------------------
+        % params is acfObjectDetector.TrainingOptions. Only the 'Orientation'
+        % and 'None' interpolations of the histograms are supported.
+        function acfObjectDetector_setup(ptrObj, params)
+
+            coder.inline('always');
+            coder.cinclude('acfObjectDetectorCore_api.hpp');
+
+            modelSize       = double(params.ModelSize);
+            modelSizePadded = double(params.ModelSizePadded);
+            channelPadding  = double(params.ChannelPadding);
+            lambdas         = double(params.Lambdas);
+            interpolate     = strcmpi(params.hog.Interpolation, 'Orientation');
+
+            coder.ceval('acfObjectDetector_setup', ptrObj, ...
+                coder.rref(modelSize), coder.rref(modelSizePadded), ...
+                coder.rref(channelPadding), int32(params.Shrink), ...
+                int32(params.NumApprox), int32(params.NumUpscaledOctaves), ...
+                double(params.SmoothChannels), double(params.PreSmoothColor), ...
+                coder.rref(lambdas), logical(params.gradient.FullOrientation), ...
+                double(params.gradient.NormalizationRadius), ...
+                double(params.gradient.NormalizationConstant), ...
+                int32(params.hog.NumBins), int32(params.hog.CellSize), ...
+                interpolate);
+        end
+
+        %------------------------------------------------------------------
+        % classifier is acfObjectDetector.Classifier
+        function acfObjectDetector_setClassifier(ptrObj, classifier)
+
+            coder.inline('always');
+            coder.cinclude('acfObjectDetectorCore_api.hpp');
+
+            fids  = uint32(classifier.fids);
+            thrs  = single(classifier.thrs);
+            child = uint32(classifier.child);
+            hs    = single(classifier.hs);
+
+            coder.ceval('-col', 'acfObjectDetector_setClassifier', ptrObj, ...
+                coder.rref(fids), coder.rref(thrs), coder.rref(child), ...
+                coder.rref(hs), int32(size(fids,1)), int32(size(fids,2)), ...
+                int32(classifier.treeDepth));
+        end
+
+        %------------------------------------------------------------------
+        % bboxes are those of vision.internal.acf.detect, before rounding
+        % and clipping to the image
+        function [bboxes, scores] = acfObjectDetector_detect(ptrObj, I, ...
+                numScaleLevels, minSize, maxSize, windowStride, threshold)
+
+            coder.inline('always');
+            coder.cinclude('acfObjectDetectorCore_api.hpp');
+
+            % same scaling to [0 1] as computePyramid
+            if isfloat(I)
+                Is = single(mat2gray(I));
+            else
+                Is = im2single(I);
+            end
+
+            nRows = int32(size(Is, 1));
+            nCols = int32(size(Is, 2));
+            isRGB = (size(Is, 3) == 3);
+            minSize_ = int32(minSize);
+            maxSize_ = int32(maxSize);
+
+            ptrBBoxes = coder.opaque('void *', 'NULL');
+            ptrScores = coder.opaque('void *', 'NULL');
+            numDetections = int32(0);
+
+            % the channels are column major, as in MATLAB
+            coder.ceval('-col', 'acfObjectDetector_detect', ptrObj, ...
+                coder.ref(ptrBBoxes), coder.ref(ptrScores), ...
+                coder.rref(Is), nRows, nCols, isRGB, ...
+                int32(numScaleLevels), coder.rref(minSize_), ...
+                coder.rref(maxSize_), int32(windowStride), ...
+                double(threshold), coder.ref(numDetections));
+
+            coder.varsize('bboxes', [inf, 4]);
+            bboxes = coder.nullcopy(zeros(double(numDetections), 4, 'double'));
+            coder.varsize('scores', [inf, 1]);
+            scores = coder.nullcopy(zeros(double(numDetections), 1, 'double'));
+
+            if coder.isColumnMajor
+                coder.ceval('-col', 'acfObjectDetector_assignOutputDeleteVectors', ...
+                    ptrBBoxes, ptrScores, coder.ref(bboxes), coder.ref(scores));
+            else
+                coder.ceval('-row', 'acfObjectDetector_assignOutputDeleteVectorsRM', ...
+                    ptrBBoxes, ptrScores, coder.ref(bboxes), coder.ref(scores));
+            end
+        end
+
+        %------------------------------------------------------------------
+        function acfObjectDetector_deleteObj(ptrObj)
+
+            coder.inline('always');
+            coder.cinclude('acfObjectDetectorCore_api.hpp');
+
+            coder.ceval('acfObjectDetector_deleteObj', ptrObj);
+        end
+    end
+end
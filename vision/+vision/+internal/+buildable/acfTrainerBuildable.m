@@ -0,0 +1,194 @@
+classdef acfTrainerBuildable < coder.ExternalDependency %#codegen
+    % acfTrainerBuildable - boosted tree training and hard negative mining
+    % of trainACFObjectDetector, see
+    % vision.internal.acf.trainBoostTreeClassifier
+
+    % Copyright 2016 The MathWorks, Inc.
+
+    methods (Static)
+
+        function name = getDescriptiveName(~)
+            name = 'acfTrainerBuildable';
+        end
+
+        function b = isSupportedContext(~)
+            b = true; % supports non-host target
+        end
+
+        function updateBuildInfo(buildInfo, context)
+            buildInfo.addIncludePaths({fullfile(matlabroot,'toolbox', ...
+                'vision','builtins','src','ocv','include'), ...
+                fullfile(matlabroot,'toolbox', ...
+                'vision','builtins','src','ocvcg', 'opencv', 'include')} );
+            buildInfo.addSourcePaths({fullfile(matlabroot,'toolbox', ...
+                'vision','builtins','src','ocv')});
+            buildInfo.addSourceFiles({'acfTrainerCore.cpp', ...
+                'cgCommon.cpp'});
+            buildInfo.addIncludeFiles({'vision_defines.h', ...
+                                       'acfTrainerCore_api.hpp', ...
+                                       'AcfTrainer.hpp', ...
+                                       'AcfDetector.hpp', ...
+                                       'cgCommon.hpp', ...
+                                       'cgThreadPool.hpp'}); % no need 'rtwtypes.h'
+
+            vision.internal.buildable.portableOpenCVBuildInfo(buildInfo, context, ...
+                'acfTrainer');
+        end
+
+        %------------------------------------------------------------------
+        function ptrObj = acfTrainer_construct()
+
+            coder.inline('always');
+            coder.cinclude('acfTrainerCore_api.hpp');
+
+            ptrObj = coder.opaque('void *', 'NULL');
+
+            coder.ceval('acfTrainer_construct', coder.ref(ptrObj));
+        end
+
+        %------------------------------------------------------------------
+        % params are the training parameters of trainACFObjectDetector
+        function acfTrainer_setup(ptrObj, params)
+
+            coder.inline('always');
+            coder.cinclude('acfTrainerCore_api.hpp');
+
+            modelSize       = double(params.ModelSize);
+            modelSizePadded = double(params.ModelSizePadded);
+            channelPadding  = double(params.ChannelPadding);
+            lambdas         = double(params.Lambdas);
+            interpolate     = strcmpi(params.hog.Interpolation, 'Orientation');
+
+            coder.ceval('acfTrainer_setup', ptrObj, ...
+                coder.rref(modelSize), coder.rref(modelSizePadded), ...
+                coder.rref(channelPadding), int32(params.Shrink), ...
+                int32(params.NumApprox), int32(params.NumUpscaledOctaves), ...
+                double(params.SmoothChannels), double(params.PreSmoothColor), ...
+                coder.rref(lambdas), logical(params.gradient.FullOrientation), ...
+                double(params.gradient.NormalizationRadius), ...
+                double(params.gradient.NormalizationConstant), ...
+                int32(params.hog.NumBins), int32(params.hog.CellSize), ...
+                interpolate);
+        end
+
+        %------------------------------------------------------------------
+        % X is numSamples-by-numFeatures, one instance per row
+        function acfTrainer_addPositives(ptrObj, X)
+
+            coder.inline('always');
+            coder.cinclude('acfTrainerCore_api.hpp');
+
+            Xs = single(X);
+            if coder.isColumnMajor
+                coder.ceval('-col', 'acfTrainer_addPositives', ptrObj, ...
+                    coder.rref(Xs), int32(size(Xs,1)), int32(size(Xs,2)));
+            else
+                coder.ceval('-row', 'acfTrainer_addPositivesRM', ptrObj, ...
+                    coder.rref(Xs), int32(size(Xs,1)), int32(size(Xs,2)));
+            end
+        end
+
+        %------------------------------------------------------------------
+        function acfTrainer_addNegatives(ptrObj, X)
+
+            coder.inline('always');
+            coder.cinclude('acfTrainerCore_api.hpp');
+
+            Xs = single(X);
+            if coder.isColumnMajor
+                coder.ceval('-col', 'acfTrainer_addNegatives', ptrObj, ...
+                    coder.rref(Xs), int32(size(Xs,1)), int32(size(Xs,2)));
+            else
+                coder.ceval('-row', 'acfTrainer_addNegativesRM', ptrObj, ...
+                    coder.rref(Xs), int32(size(Xs,1)), int32(size(Xs,2)));
+            end
+        end
+
+        %------------------------------------------------------------------
+        % Mines the hard negatives of I with the trees of the last stage,
+        % as sampleWindows does with the detector. gt are the M-by-4
+        % ground truth boxes of I.
+        function numAdded = acfTrainer_mineNegatives(ptrObj, I, gt, params)
+
+            coder.inline('always');
+            coder.cinclude('acfTrainerCore_api.hpp');
+
+            % same scaling to [0 1] as computePyramid
+            if isfloat(I)
+                Is = single(mat2gray(I));
+            else
+                Is = im2single(I);
+            end
+            gtBoxes = double(gt);
+
+            numAdded = int32(0);
+
+            % the channels are column major, as in MATLAB
+            numAdded = coder.ceval('-col', 'acfTrainer_mineNegatives', ptrObj, ...
+                coder.rref(Is), int32(size(Is,1)), int32(size(Is,2)), ...
+                size(Is,3) == 3, coder.rref(gtBoxes), int32(size(gtBoxes,1)), ...
+                int32(params.NumScaleLevels), int32(params.WindowStride), ...
+                double(params.Threshold), int32(params.NumNegativePerImage));
+        end
+
+        %------------------------------------------------------------------
+        function n = acfTrainer_getNumNegatives(ptrObj)
+
+            coder.inline('always');
+            coder.cinclude('acfTrainerCore_api.hpp');
+
+            n = int32(0);
+            n = coder.ceval('acfTrainer_getNumNegatives', ptrObj);
+        end
+
+        %------------------------------------------------------------------
+        % Trains the trees of a stage and returns them as the classifier of
+        % trainBoostTreeClassifier, with the calibration added to hs
+        function classifier = acfTrainer_trainStage(ptrObj, params, stage)
+
+            coder.inline('always');
+            coder.cinclude('acfTrainerCore_api.hpp');
+
+            numNodes  = int32(0);
+            treeDepth = int32(0);
+            numTrees  = int32(0);
+            numTrees = coder.ceval('acfTrainer_trainStage', ptrObj, ...
+                int32(params.MaxWeakLearners(stage)), int32(params.MaxTreeDepth), ...
+                double(params.FracFeatures), double(params.MinWeight), ...
+                double(params.CalibrationValue), int32(params.NumNegativeSamples), ...
+                coder.ref(numNodes), coder.ref(treeDepth));
+
+            K = double(numNodes);
+            T = double(numTrees);
+            fids    = coder.nullcopy(zeros(K, T, 'uint32'));
+            thrs    = coder.nullcopy(zeros(K, T, 'single'));
+            child   = coder.nullcopy(zeros(K, T, 'uint32'));
+            hs      = coder.nullcopy(zeros(K, T, 'single'));
+            weights = coder.nullcopy(zeros(K, T, 'single'));
+            depth   = coder.nullcopy(zeros(K, T, 'uint32'));
+
+            if coder.isColumnMajor
+                coder.ceval('-col', 'acfTrainer_getClassifier', ptrObj, ...
+                    coder.ref(fids), coder.ref(thrs), coder.ref(child), ...
+                    coder.ref(hs), coder.ref(weights), coder.ref(depth));
+            else
+                coder.ceval('-row', 'acfTrainer_getClassifierRM', ptrObj, ...
+                    coder.ref(fids), coder.ref(thrs), coder.ref(child), ...
+                    coder.ref(hs), coder.ref(weights), coder.ref(depth));
+            end
+
+            classifier = struct('fids', fids, 'thrs', thrs, 'child', child, ...
+                'hs', hs, 'weights', weights, 'depth', depth, ...
+                'treeDepth', uint32(treeDepth));
+        end
+
+        %------------------------------------------------------------------
+        function acfTrainer_deleteObj(ptrObj)
+
+            coder.inline('always');
+            coder.cinclude('acfTrainerCore_api.hpp');
+
+            coder.ceval('acfTrainer_deleteObj', ptrObj);
+        end
+    end
+end
@@ -0,0 +1,121 @@
+classdef approximateKMeansBuildable < coder.ExternalDependency %#codegen
+    % approximateKMeansBuildable - approximate k-means of bagOfFeatures,
+    % see vision.internal.approximateKMeans
+
+    % Copyright 2016 The MathWorks, Inc.
+
+    methods (Static)
+
+        function name = getDescriptiveName(~)
+            name = 'approximateKMeansBuildable';
+        end
+
+        function b = isSupportedContext(~)
+            b = true; % supports non-host target
+        end
+
+        function updateBuildInfo(buildInfo, context)
+            buildInfo.addIncludePaths({fullfile(matlabroot,'toolbox', ...
+                'vision','builtins','src','ocv','include'), ...
+                fullfile(matlabroot,'toolbox', ...
+                'vision','builtins','src','ocvcg', 'opencv', 'include')} );
+            buildInfo.addSourcePaths({fullfile(matlabroot,'toolbox', ...
+                'vision','builtins','src','ocv')});
+            buildInfo.addSourceFiles({'approximateKMeansCore.cpp', ...
+                'cgCommon.cpp'});
+            buildInfo.addIncludeFiles({'vision_defines.h', ...
+                                       'approximateKMeansCore_api.hpp', ...
+                                       'ApproxKMeans.hpp', ...
+                                       'MappedFile.hpp', ...
+                                       'cgCommon.hpp', ...
+                                       'cgThreadPool.hpp', ...
+                                       'cgResultPool.hpp', ...
+                                       'cgPyramidCache.hpp', ...
+                                       'cgIntegralImage.hpp', ...
+                                       'cgPipeline.hpp', ...
+                                       'mwtranspose.hpp'}); % no need 'rtwtypes.h'
+
+            vision.internal.buildable.portableOpenCVBuildInfo(buildInfo, context, ...
+                'approximateKMeans');
+        end
+
+        %------------------------------------------------------------------
+        % features is M-by-N single. centers is K-by-N and assignments is
+        % 1-by-M with the 1-based cluster of each feature, 0 for the
+        % features with Inf or NaN values, which are left out. numClustered
+        % is the number of features clustered, or -1 if there are fewer
+        % than K.
+        function [centers, assignments, numClustered] = approximateKMeans_real32( ...
+                features, K, maxIterations, threshold, numTrials, ...
+                useKMeansPlusPlus, seed)
+
+            coder.inline('always');
+            coder.cinclude('approximateKMeansCore_api.hpp');
+
+            M = cast(size(features,1),'int32');
+            N = cast(size(features,2),'int32');
+            K = cast(K,'int32');
+
+            assignments0 = coder.nullcopy(zeros(1, M, 'int32'));
+            numClustered = int32(0);
+
+            if coder.isColumnMajor
+                centersT = coder.nullcopy(zeros(N, K, 'single'));
+                numClustered = coder.ceval('-col', 'approximateKMeans_real32', ...
+                    features', M, N, K, int32(maxIterations), ...
+                    single(threshold), int32(numTrials), ...
+                    logical(useKMeansPlusPlus), uint32(seed), ...
+                    coder.ref(centersT), coder.ref(assignments0));
+                centers = centersT';
+            else
+                centers = coder.nullcopy(zeros(K, N, 'single'));
+                numClustered = coder.ceval('-row', 'approximateKMeans_real32', ...
+                    coder.ref(features), M, N, K, int32(maxIterations), ...
+                    single(threshold), int32(numTrials), ...
+                    logical(useKMeansPlusPlus), uint32(seed), ...
+                    coder.ref(centers), coder.ref(assignments0));
+            end
+
+            assignments = uint32(assignments0 + 1);
+        end
+
+        %------------------------------------------------------------------
+        % Same, with the M-by-N single features read from filename, as
+        % written by fwrite(fid, features', 'single'). The file may be
+        % larger than memory. numClustered is -2 if the file cannot be
+        % read.
+        function [centers, assignments, numClustered] = approximateKMeansFile_real32( ...
+                filename, M, N, K, maxIterations, threshold, numTrials, ...
+                useKMeansPlusPlus, seed)
+
+            coder.inline('always');
+            coder.cinclude('approximateKMeansCore_api.hpp');
+
+            M = cast(M,'int32');
+            N = cast(N,'int32');
+            K = cast(K,'int32');
+
+            assignments0 = coder.nullcopy(zeros(1, M, 'int32'));
+            numClustered = int32(0);
+
+            if coder.isColumnMajor
+                centersT = coder.nullcopy(zeros(N, K, 'single'));
+                numClustered = coder.ceval('-col', 'approximateKMeans_file_real32', ...
+                    coder.ref([filename char(0)]), M, N, K, int32(maxIterations), ...
+                    single(threshold), int32(numTrials), ...
+                    logical(useKMeansPlusPlus), uint32(seed), ...
+                    coder.ref(centersT), coder.ref(assignments0));
+                centers = centersT';
+            else
+                centers = coder.nullcopy(zeros(K, N, 'single'));
+                numClustered = coder.ceval('-row', 'approximateKMeans_file_real32', ...
+                    coder.ref([filename char(0)]), M, N, K, int32(maxIterations), ...
+                    single(threshold), int32(numTrials), ...
+                    logical(useKMeansPlusPlus), uint32(seed), ...
+                    coder.ref(centers), coder.ref(assignments0));
+            end
+
+            assignments = uint32(assignments0 + 1);
+        end
+    end
+end
@@ -0,0 +1,90 @@
+classdef assignDetectionsToTracksBuildable < coder.ExternalDependency %#codegen
+    % assignDetectionsToTracksBuildable - assignment of
+    % assignDetectionsToTracks with gated shortest augmenting paths
+
+    % Copyright 2016 The MathWorks, Inc.
+
+    methods (Static)
+
+        function name = getDescriptiveName(~)
+            name = 'assignDetectionsToTracksBuildable';
+        end
+
+        function b = isSupportedContext(~)
+            b = true; % supports non-host target
+        end
+
+        function updateBuildInfo(buildInfo, context)
+            buildInfo.addIncludePaths({fullfile(matlabroot,'toolbox', ...
+                'vision','builtins','src','ocv','include'), ...
+                fullfile(matlabroot,'toolbox', ...
+                'vision','builtins','src','ocvcg', 'opencv', 'include')} );
+            buildInfo.addSourcePaths({fullfile(matlabroot,'toolbox', ...
+                'vision','builtins','src','ocv')});
+            buildInfo.addSourceFiles({'assignDetectionsToTracksCore.cpp', ...
+                'cgCommon.cpp'});
+            buildInfo.addIncludeFiles({'vision_defines.h', ...
+                                       'assignDetectionsToTracksCore_api.hpp', ...
+                                       'AssignmentSolver.hpp', ...
+                                       'cgCommon.hpp'}); % no need 'rtwtypes.h'
+
+            vision.internal.buildable.portableOpenCVBuildInfo(buildInfo, context, ...
+                'assignDetectionsToTracks');
+        end
+
+        %------------------------------------------------------------------
+        % costMatrix is numTracks-by-numDetections; costUnmatchedTracks
+        % and costUnmatchedDetections are the vectors of
+        % cvalgAssignDetectionsToTracks. The outputs are those of
+        % assignDetectionsToTracks.
+        function [matches, unassignedTracks, unassignedDetections] = ...
+                assignDetectionsToTracks_solve(costMatrix, ...
+                costUnmatchedTracks, costUnmatchedDetections)
+
+            coder.inline('always');
+            coder.cinclude('assignDetectionsToTracksCore_api.hpp');
+
+            cost = double(costMatrix);
+            costTracks = double(costUnmatchedTracks);
+            costDetections = double(costUnmatchedDetections);
+            numTracks = int32(size(cost, 1));
+            numDetections = int32(size(cost, 2));
+
+            ptrAssignment = coder.opaque('void *', 'NULL');
+            numMatches = int32(0);
+            numUnassignedTracks = int32(0);
+            numUnassignedDetections = int32(0);
+
+            if coder.isColumnMajor
+                coder.ceval('-col', 'assignDetectionsToTracks_solve', ...
+                    coder.rref(cost), numTracks, numDetections, ...
+                    coder.rref(costTracks), coder.rref(costDetections), ...
+                    coder.ref(numMatches), coder.ref(numUnassignedTracks), ...
+                    coder.ref(numUnassignedDetections), coder.ref(ptrAssignment));
+            else
+                coder.ceval('-row', 'assignDetectionsToTracks_solveRM', ...
+                    coder.rref(cost), numTracks, numDetections, ...
+                    coder.rref(costTracks), coder.rref(costDetections), ...
+                    coder.ref(numMatches), coder.ref(numUnassignedTracks), ...
+                    coder.ref(numUnassignedDetections), coder.ref(ptrAssignment));
+            end
+
+            coder.varsize('matches', [inf, 2]);
+            matches = coder.nullcopy(zeros(double(numMatches), 2, 'uint32'));
+            coder.varsize('unassignedTracks', [inf, 1]);
+            unassignedTracks = coder.nullcopy(zeros(double(numUnassignedTracks), 1, 'uint32'));
+            coder.varsize('unassignedDetections', [inf, 1]);
+            unassignedDetections = coder.nullcopy(zeros(double(numUnassignedDetections), 1, 'uint32'));
+
+            if coder.isColumnMajor
+                coder.ceval('-col', 'assignDetectionsToTracks_assignOutputDelete', ...
+                    ptrAssignment, coder.ref(matches), ...
+                    coder.ref(unassignedTracks), coder.ref(unassignedDetections));
+            else
+                coder.ceval('-row', 'assignDetectionsToTracks_assignOutputDeleteRM', ...
+                    ptrAssignment, coder.ref(matches), ...
+                    coder.ref(unassignedTracks), coder.ref(unassignedDetections));
+            end
+        end
+    end
+end
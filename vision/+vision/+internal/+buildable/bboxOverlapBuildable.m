@@ -0,0 +1,97 @@
+classdef bboxOverlapBuildable < coder.ExternalDependency %#codegen
+    % bboxOverlapBuildable - overlap ratio of bboxOverlapRatio and
+    % suppression of selectStrongestBbox
+
+    % Copyright 2016 The MathWorks, Inc.
+
+    methods (Static)
+
+        function name = getDescriptiveName(~)
+            name = 'bboxOverlapBuildable';
+        end
+
+        function b = isSupportedContext(~)
+            b = true; % supports non-host target
+        end
+
+        function updateBuildInfo(buildInfo, context)
+            buildInfo.addIncludePaths({fullfile(matlabroot,'toolbox', ...
+                'vision','builtins','src','ocv','include'), ...
+                fullfile(matlabroot,'toolbox', ...
+                'vision','builtins','src','ocvcg', 'opencv', 'include')} );
+            buildInfo.addSourcePaths({fullfile(matlabroot,'toolbox', ...
+                'vision','builtins','src','ocv')});
+            buildInfo.addSourceFiles({'bboxOverlapCore.cpp', ...
+                'cgCommon.cpp'});
+            buildInfo.addIncludeFiles({'vision_defines.h', ...
+                                       'bboxOverlapCore_api.hpp', ...
+                                       'BoxOverlap.hpp', ...
+                                       'cgCommon.hpp', ...
+                                       'cgThreadPool.hpp'}); % no need 'rtwtypes.h'
+
+            vision.internal.buildable.portableOpenCVBuildInfo(buildInfo, context, ...
+                'bboxOverlap');
+        end
+
+        %------------------------------------------------------------------
+        % bboxA and bboxB are M-by-4 and N-by-4 single or double boxes of
+        % the same class; overlapRatio is M-by-N of that class.
+        function overlapRatio = bboxOverlap_ratio(bboxA, bboxB, isDivByUnion)
+
+            coder.inline('always');
+            coder.cinclude('bboxOverlapCore_api.hpp');
+
+            numA = int32(size(bboxA, 1));
+            numB = int32(size(bboxB, 1));
+            overlapRatio = coder.nullcopy(zeros(size(bboxA, 1), size(bboxB, 1), 'like', bboxA));
+
+            if isa(bboxA, 'double')
+                fcnName = 'bboxOverlap_ratio';
+            else
+                fcnName = 'bboxOverlap_ratio_single';
+            end
+
+            if coder.isColumnMajor
+                coder.ceval('-col', fcnName, ...
+                    coder.rref(bboxA), numA, coder.rref(bboxB), numB, ...
+                    logical(isDivByUnion), coder.ref(overlapRatio));
+            else
+                coder.ceval('-row', [fcnName 'RM'], ...
+                    coder.rref(bboxA), numA, coder.rref(bboxB), numB, ...
+                    logical(isDivByUnion), coder.ref(overlapRatio));
+            end
+        end
+
+        %------------------------------------------------------------------
+        % bbox is N-by-4 single or double, score is N-by-1. isKept is
+        % N-by-1 logical, true for the boxes selectStrongestBbox selects.
+        function isKept = bboxOverlap_suppress(bbox, score, ...
+                overlapThreshold, isDivByUnion)
+
+            coder.inline('always');
+            coder.cinclude('bboxOverlapCore_api.hpp');
+
+            scoreDouble = double(score);
+            numBoxes = int32(size(bbox, 1));
+            isKept = coder.nullcopy(false(size(bbox, 1), 1));
+
+            if isa(bbox, 'double')
+                fcnName = 'bboxOverlap_suppress';
+            else
+                fcnName = 'bboxOverlap_suppress_single';
+            end
+
+            if coder.isColumnMajor
+                coder.ceval('-col', fcnName, ...
+                    coder.rref(bbox), coder.rref(scoreDouble), numBoxes, ...
+                    double(overlapThreshold), logical(isDivByUnion), ...
+                    coder.ref(isKept));
+            else
+                coder.ceval('-row', [fcnName 'RM'], ...
+                    coder.rref(bbox), coder.rref(scoreDouble), numBoxes, ...
+                    double(overlapThreshold), logical(isDivByUnion), ...
+                    coder.ref(isKept));
+            end
+        end
+    end
+end
@@ -0,0 +1,101 @@
+classdef boxStatisticsBuildable < coder.ExternalDependency %#codegen
+    % boxStatisticsBuildable - encapsulate the sliding box mean, standard
+    % deviation, minimum and maximum implementation library
+
+    % Copyright 2016 The MathWorks, Inc.
+
+
+    methods (Static)
+
+        function name = getDescriptiveName(~)
+            name = 'boxStatisticsBuildable';
+        end
+
+        function b = isSupportedContext(~)
+            b = true; % supports non-host target
+        end
+
+        function updateBuildInfo(buildInfo, context)
+            buildInfo.addIncludePaths({fullfile(matlabroot,'toolbox', ...
+                'vision','builtins','src','ocv','include'), ...
+                fullfile(matlabroot,'toolbox', ...
+                'vision','builtins','src','ocvcg', 'opencv', 'include')} );
+            buildInfo.addSourcePaths({fullfile(matlabroot,'toolbox', ...
+                'vision','builtins','src','ocv')});
+            buildInfo.addSourceFiles({'boxStatisticsCore.cpp', 'cgCommon.cpp'});
+            buildInfo.addIncludeFiles({'vision_defines.h', ...
+                                       'cgCommon.hpp', ...
+                                       'cgThreadPool.hpp', ...
+                                       'cgProfile.hpp', ...
+                                       'cgIntegralImage.hpp', ...
+                                       'cgBoxStatistics.hpp', ...
+                                       'boxStatisticsCore_api.hpp'}); % no need 'rtwtypes.h'
+
+            vision.internal.buildable.portableOpenCVBuildInfo(buildInfo, context, ...
+                'boxStatistics');
+        end
+
+        %------------------------------------------------------------------
+        % mean and, when requested, standard deviation of the
+        % winSize = [winRows winCols] box of each pixel of a uint8 image
+        function [outMean, outStd] = boxStatistics_meanStd(img_u8, winSize)
+
+            coder.inline('always');
+            coder.cinclude('boxStatisticsCore_api.hpp');
+
+            nRows = int32(size(img_u8, 1));
+            nCols = int32(size(img_u8, 2));
+            outMean = coder.nullcopy(zeros(size(img_u8),'single'));
+
+            if nargout > 1
+                outStd = coder.nullcopy(zeros(size(img_u8),'single'));
+                stdRef = coder.ref(outStd);
+            else
+                stdRef = coder.opaque('real32_T *', 'NULL');
+            end
+
+            if coder.isColumnMajor
+                coder.ceval('-col', 'boxStatistics_meanStd_uint8', ...
+                    coder.rref(img_u8), nRows, nCols, ...
+                    int32(winSize(1)), int32(winSize(2)), ...
+                    coder.ref(outMean), stdRef);
+            else
+                coder.ceval('-row', 'boxStatistics_meanStd_uint8RM', ...
+                    coder.rref(img_u8), nRows, nCols, ...
+                    int32(winSize(1)), int32(winSize(2)), ...
+                    coder.ref(outMean), stdRef);
+            end
+        end
+
+        %------------------------------------------------------------------
+        % minimum and, when requested, maximum of the same boxes
+        function [outMin, outMax] = boxStatistics_minMax(img_u8, winSize)
+
+            coder.inline('always');
+            coder.cinclude('boxStatisticsCore_api.hpp');
+
+            nRows = int32(size(img_u8, 1));
+            nCols = int32(size(img_u8, 2));
+            outMin = coder.nullcopy(zeros(size(img_u8),'uint8'));
+
+            if nargout > 1
+                outMax = coder.nullcopy(zeros(size(img_u8),'uint8'));
+                maxRef = coder.ref(outMax);
+            else
+                maxRef = coder.opaque('uint8_T *', 'NULL');
+            end
+
+            if coder.isColumnMajor
+                coder.ceval('-col', 'boxStatistics_minMax_uint8', ...
+                    coder.rref(img_u8), nRows, nCols, ...
+                    int32(winSize(1)), int32(winSize(2)), ...
+                    coder.ref(outMin), maxRef);
+            else
+                coder.ceval('-row', 'boxStatistics_minMax_uint8RM', ...
+                    coder.rref(img_u8), nRows, nCols, ...
+                    int32(winSize(1)), int32(winSize(2)), ...
+                    coder.ref(outMin), maxRef);
+            end
+        end
+    end
+end
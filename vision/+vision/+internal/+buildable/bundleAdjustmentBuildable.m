@@ -0,0 +1,98 @@
+classdef bundleAdjustmentBuildable < coder.ExternalDependency %#codegen
+    % bundleAdjustmentBuildable - sparse Levenberg-Marquardt of
+    % bundleAdjustment, with the Schur complement on the camera blocks
+
+    % Copyright 2016 The MathWorks, Inc.
+
+    methods (Static)
+
+        function name = getDescriptiveName(~)
+            name = 'bundleAdjustmentBuildable';
+        end
+
+        function b = isSupportedContext(~)
+            b = true; % supports non-host target
+        end
+
+        function updateBuildInfo(buildInfo, context)
+            buildInfo.addIncludePaths({fullfile(matlabroot,'toolbox', ...
+                'vision','builtins','src','ocv','include'), ...
+                fullfile(matlabroot,'toolbox', ...
+                'vision','builtins','src','ocvcg', 'opencv', 'include')} );
+            buildInfo.addSourcePaths({fullfile(matlabroot,'toolbox', ...
+                'vision','builtins','src','ocv')});
+            buildInfo.addSourceFiles({'bundleAdjustmentCore.cpp', ...
+                'cgCommon.cpp'});
+            buildInfo.addIncludeFiles({'vision_defines.h', ...
+                                       'bundleAdjustmentCore_api.hpp', ...
+                                       'BundleAdjuster.hpp', ...
+                                       'cgCommon.hpp', ...
+                                       'cgThreadPool.hpp'}); % no need 'rtwtypes.h'
+
+            vision.internal.buildable.portableOpenCVBuildInfo(buildInfo, context, ...
+                'bundleAdjustment');
+        end
+
+        %------------------------------------------------------------------
+        % xyzPoints is M-by-3. orientations is 3-by-3-by-V and locations
+        % V-by-3, the Orientation and Location of the camera poses. The
+        % observations are the [x y] rows of measurements, of the points
+        % pointIndex in the views viewIndex (1-based). intrinsics is
+        % 10-by-1 or 10-by-V, [FocalLength PrincipalPoint Skew
+        % RadialDistortion TangentialDistortion] of cameraIntrinsics with 3
+        % radial coefficients, zeros for undistorted points. isFixedView
+        % flags the views of FixedViewIDs. params has the MaxIterations,
+        % AbsoluteTolerance and RelativeTolerance of bundleAdjustment, and
+        % Solver, 'auto', 'cholesky' or 'pcg', with PCGTolerance and
+        % MaxPCGIterations (0 for the size of the reduced system).
+        function [xyzRefinedPoints, refinedOrientations, refinedLocations, ...
+                reprojectionErrors, statusCode, numIterations] = ...
+                bundleAdjustment_solve(xyzPoints, orientations, locations, ...
+                measurements, pointIndex, viewIndex, intrinsics, ...
+                isFixedView, params)
+
+            coder.inline('always');
+            coder.cinclude('bundleAdjustmentCore_api.hpp');
+
+            numPoints = int32(size(xyzPoints, 1));
+            numViews  = int32(size(locations, 1));
+            numObservations = int32(size(measurements, 1));
+            numIntrinsics = int32(size(intrinsics, 2));
+
+            points  = double(xyzPoints');
+            rotations = double(orientations);
+            centers = double(locations');
+            xy      = double(measurements');
+            pointIdx = int32(pointIndex(:)) - 1;
+            viewIdx  = int32(viewIndex(:)) - 1;
+            K       = double(intrinsics);
+            isFixed = logical(isFixedView(:));
+
+            if strcmpi(params.Solver, 'cholesky')
+                solver = int32(1);
+            elseif strcmpi(params.Solver, 'pcg')
+                solver = int32(2);
+            else
+                solver = int32(0);
+            end
+
+            reprojectionErrors = coder.nullcopy(zeros(double(numPoints), 1));
+            numIterations = int32(0);
+            statusCode = int32(0);
+
+            statusCode = coder.ceval('-col', 'bundleAdjustment_solve', ...
+                coder.ref(points), numPoints, coder.ref(rotations), ...
+                coder.ref(centers), numViews, coder.rref(xy), ...
+                coder.rref(pointIdx), coder.rref(viewIdx), numObservations, ...
+                coder.rref(K), numIntrinsics, coder.rref(isFixed), ...
+                int32(params.MaxIterations), double(params.AbsoluteTolerance), ...
+                double(params.RelativeTolerance), solver, ...
+                double(params.PCGTolerance), int32(params.MaxPCGIterations), ...
+                coder.ref(reprojectionErrors), coder.ref(numIterations));
+
+            xyzRefinedPoints    = points';
+            refinedOrientations = rotations;
+            refinedLocations    = centers';
+        end
+    end
+end
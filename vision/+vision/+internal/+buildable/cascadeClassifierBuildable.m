@@ -29,8 +29,16 @@ classdef cascadeClassifierBuildable < coder.ExternalDependency %#codegen
             buildInfo.addIncludeFiles({'vision_defines.h', ...
                                        'CascadeClassifierCore_api.hpp', ...
                                        'cgCommon.hpp', ...                                       
+                                       'cgThreadPool.hpp', ...
+                                       'cgResultPool.hpp', ...
+                                       'cgPyramidCache.hpp', ...
+                                       'cgIntegralImage.hpp', ...
+                                       'cgPipeline.hpp', ...
+                                       'mwtranspose.hpp', ...
                                        'mwobjdetect.hpp', ...
                                        'mwcascadedetect.hpp', ...
+                                       'ObjectDetectorCuda.hpp', ...
+                                       'ImageHandle.hpp', ...
                                        'precomp_objdetect.hpp'}); % no need 'rtwtypes.h'           
                                  
             vision.internal.buildable.portableOpenCVBuildInfo(buildInfo, context, ...
@@ -138,6 +146,126 @@ classdef cascadeClassifierBuildable < coder.ExternalDependency %#codegen
             % call function from shared library
             coder.ceval('cascadeClassifier_deleteObj', ptrObj);
         end         
+
+        %------------------------------------------------------------------
+        % returns a NULL pointer when the device is not available, in which
+        % case the CPU classifier must be used
+        function ptrObj = cascadeClassifierCuda_construct(device)
+
+            coder.inline('always');
+            coder.cinclude('CascadeClassifierCore_api.hpp');
+
+            ptrObj = coder.opaque('void *', 'NULL');
+
+            % call function from shared library
+            coder.ceval('cascadeClassifierCuda_construct', coder.ref(ptrObj), ...
+                int32(device));
+        end
+
+        %------------------------------------------------------------------
+        % returns false when the CUDA classifier cannot read the model
+        function isLoaded = cascadeClassifierCuda_load(ptrObj, ClassificationModel)
+            coder.inline('always');
+            coder.cinclude('CascadeClassifierCore_api.hpp');
+
+            isLoaded = false;
+            isLoaded = coder.ceval('cascadeClassifierCuda_load', ptrObj, ...
+                coder.ref(ClassificationModel));
+        end
+
+        %------------------------------------------------------------------
+        % same outputs as cascadeClassifier_detectMultiScale
+        function bboxes = cascadeClassifierCuda_detectMultiScale(ptrObj, I, ScaleFactor, ...
+                MergeThreshold, MinSize, MaxSize)
+
+            coder.inline('always');
+            coder.cinclude('CascadeClassifierCore_api.hpp');
+
+            coder.varsize('bboxes_', [inf, 4]);
+            if isempty(I)
+                % no-op
+                bboxes = zeros(0,4);
+            else
+                nRows = int32(size(I, 1));
+                nCols = int32(size(I, 2));
+                ScaleFactor_ = double(ScaleFactor);
+                MergeThreshold_ = uint32(MergeThreshold);
+                MinSize_ = int32(MinSize);
+                MaxSize_ = int32(MaxSize);
+
+                ptrDetectedObj = coder.opaque('void *', 'NULL');
+
+                num_bboxes = int32(0);
+
+                if coder.isColumnMajor
+                    num_bboxes(:) = coder.ceval('-col','cascadeClassifierCuda_detectMultiScale', ...
+                        ptrObj, coder.ref(ptrDetectedObj), ...
+                        I', nRows, nCols, ScaleFactor_, ...
+                        MergeThreshold_, coder.ref(MinSize_), coder.ref(MaxSize_));
+                else
+                    num_bboxes(:) = coder.ceval('-row','cascadeClassifierCuda_detectMultiScale', ...
+                        ptrObj, coder.ref(ptrDetectedObj), ...
+                        I, nRows, nCols, ScaleFactor_, ...
+                        MergeThreshold_, coder.ref(MinSize_), coder.ref(MaxSize_));
+                end
+
+                bboxes_ = coder.nullcopy(zeros(double(num_bboxes),4,'int32'));
+
+                if coder.isColumnMajor
+                    coder.ceval('-col','cascadeClassifier_assignOutputDeleteBbox', ...
+                        ptrDetectedObj, coder.ref(bboxes_));
+                else
+                    coder.ceval('-row','cascadeClassifier_assignOutputDeleteBboxRM', ...
+                        ptrDetectedObj, coder.ref(bboxes_));
+                end
+
+                bboxes = double(bboxes_);
+            end
+        end
+
+        %------------------------------------------------------------------
+        % detectMultiScale on the image of an imageHandleBuildable handle,
+        % which the generated code does not transpose
+        function bboxes = cascadeClassifierCuda_detectMultiScaleImage(ptrObj, ptrImage, ...
+                ScaleFactor, MergeThreshold, MinSize, MaxSize)
+
+            coder.inline('always');
+            coder.cinclude('CascadeClassifierCore_api.hpp');
+
+            coder.varsize('bboxes_', [inf, 4]);
+            ScaleFactor_ = double(ScaleFactor);
+            MergeThreshold_ = uint32(MergeThreshold);
+            MinSize_ = int32(MinSize);
+            MaxSize_ = int32(MaxSize);
+
+            ptrDetectedObj = coder.opaque('void *', 'NULL');
+
+            num_bboxes = int32(0);
+            num_bboxes(:) = coder.ceval('cascadeClassifierCuda_detectMultiScaleImage', ...
+                ptrObj, coder.ref(ptrDetectedObj), ptrImage, ScaleFactor_, ...
+                MergeThreshold_, coder.ref(MinSize_), coder.ref(MaxSize_));
+
+            bboxes_ = coder.nullcopy(zeros(double(num_bboxes),4,'int32'));
+
+            if coder.isColumnMajor
+                coder.ceval('-col','cascadeClassifier_assignOutputDeleteBbox', ...
+                    ptrDetectedObj, coder.ref(bboxes_));
+            else
+                coder.ceval('-row','cascadeClassifier_assignOutputDeleteBboxRM', ...
+                    ptrDetectedObj, coder.ref(bboxes_));
+            end
+
+            bboxes = double(bboxes_);
+        end
+
+        %------------------------------------------------------------------
+        function cascadeClassifierCuda_deleteObj(ptrObj)
+
+            coder.inline('always');
+            coder.cinclude('CascadeClassifierCore_api.hpp');
+
+            coder.ceval('cascadeClassifierCuda_deleteObj', ptrObj);
+        end
         
     end   
 end
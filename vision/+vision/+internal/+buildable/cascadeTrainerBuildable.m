@@ -0,0 +1,150 @@
+classdef cascadeTrainerBuildable < coder.ExternalDependency %#codegen
+    % cascadeTrainerBuildable - native training of the boosted cascades of
+    % trainCascadeObjectDetector
+
+    % Copyright 2016 The MathWorks, Inc.
+
+    methods (Static)
+
+        function name = getDescriptiveName(~)
+            name = 'cascadeTrainerBuildable';
+        end
+
+        function b = isSupportedContext(~)
+            b = true; % supports non-host target
+        end
+
+        function updateBuildInfo(buildInfo, context)
+            buildInfo.addIncludePaths({fullfile(matlabroot,'toolbox', ...
+                'vision','builtins','src','ocv','include'), ...
+                fullfile(matlabroot,'toolbox', ...
+                'vision','builtins','src','ocvcg', 'opencv', 'include')} );
+            buildInfo.addSourcePaths({fullfile(matlabroot,'toolbox', ...
+                'vision','builtins','src','ocv')});
+            buildInfo.addSourceFiles({'cascadeTrainerCore.cpp', ...
+                'cgCommon.cpp'});
+            buildInfo.addIncludeFiles({'vision_defines.h', ...
+                                       'cascadeTrainerCore_api.hpp', ...
+                                       'CascadeTrainer.hpp', ...
+                                       'cgCommon.hpp', ...
+                                       'cgThreadPool.hpp'}); % no need 'rtwtypes.h'
+
+            vision.internal.buildable.portableOpenCVBuildInfo(buildInfo, context, ...
+                'cascadeTrainer');
+        end
+
+        %------------------------------------------------------------------
+        % featureType is 'haar', 'LBP' or 'HOG' and objectTrainingSize
+        % [width height], as populateTrainCascadeParams sets them.
+        % precalcBufSize is in MB.
+        function ptrTrainer = cascadeTrainer_construct(featureType, ...
+                objectTrainingSize, precalcBufSize)
+
+            coder.inline('always');
+            coder.cinclude('cascadeTrainerCore_api.hpp');
+
+            ptrTrainer = coder.opaque('void *', 'NULL');
+
+            if strcmpi(featureType, 'haar')
+                typeId = int32(0);
+            elseif strcmpi(featureType, 'LBP')
+                typeId = int32(1);
+            else
+                typeId = int32(2);
+            end
+
+            coder.ceval('cascadeTrainer_construct', typeId, ...
+                int32(objectTrainingSize(1)), int32(objectTrainingSize(2)), ...
+                double(precalcBufSize), coder.ref(ptrTrainer));
+        end
+
+        %------------------------------------------------------------------
+        % samples is height-by-width-by-numSamples uint8, the positive
+        % instances resized to the object training size
+        function cascadeTrainer_addPositives(ptrTrainer, samples)
+
+            coder.inline('always');
+            coder.cinclude('cascadeTrainerCore_api.hpp');
+
+            numSamples = int32(size(samples, 3));
+            if coder.isColumnMajor
+                coder.ceval('-col', 'cascadeTrainer_addPositives', ptrTrainer, ...
+                    coder.rref(samples), numSamples);
+            else
+                coder.ceval('-row', 'cascadeTrainer_addPositivesRM', ptrTrainer, ...
+                    coder.rref(samples), numSamples);
+            end
+        end
+
+        %------------------------------------------------------------------
+        % I is a uint8 grayscale negative image
+        function cascadeTrainer_addNegativeImage(ptrTrainer, I)
+
+            coder.inline('always');
+            coder.cinclude('cascadeTrainerCore_api.hpp');
+
+            rows = int32(size(I, 1));
+            cols = int32(size(I, 2));
+            if coder.isColumnMajor
+                coder.ceval('-col', 'cascadeTrainer_addNegativeImage', ptrTrainer, ...
+                    coder.rref(I), rows, cols);
+            else
+                coder.ceval('-row', 'cascadeTrainer_addNegativeImageRM', ptrTrainer, ...
+                    coder.rref(I), rows, cols);
+            end
+        end
+
+        %------------------------------------------------------------------
+        % Trains the next stage with the fields of trainerParams and
+        % boostParams of populateTrainCascadeParams. numWeak is 0 when not
+        % enough samples pass the previous stages.
+        function [numWeak, acceptanceRatio] = cascadeTrainer_trainStage( ...
+                ptrTrainer, trainerParams, boostParams)
+
+            coder.inline('always');
+            coder.cinclude('cascadeTrainerCore_api.hpp');
+
+            acceptanceRatio = 0;
+            numWeak = int32(0);
+            numWeak = coder.ceval('cascadeTrainer_trainStage', ptrTrainer, ...
+                int32(trainerParams.numPositiveSamples), ...
+                int32(trainerParams.numNegativeSamples), ...
+                double(boostParams.minHitRate), ...
+                double(boostParams.falseAlarmRate), ...
+                double(boostParams.weightTrimRate), ...
+                int32(boostParams.maxWeakCount), ...
+                coder.ref(acceptanceRatio));
+        end
+
+        %------------------------------------------------------------------
+        function n = cascadeTrainer_getNumStages(ptrTrainer)
+
+            coder.inline('always');
+            coder.cinclude('cascadeTrainerCore_api.hpp');
+
+            n = int32(0);
+            n = coder.ceval('cascadeTrainer_getNumStages', ptrTrainer);
+        end
+
+        %------------------------------------------------------------------
+        % writes the cascade XML file read by vision.CascadeObjectDetector
+        function success = cascadeTrainer_write(ptrTrainer, filename)
+
+            coder.inline('always');
+            coder.cinclude('cascadeTrainerCore_api.hpp');
+
+            success = false;
+            success = coder.ceval('cascadeTrainer_write', ptrTrainer, ...
+                coder.ref([filename char(0)]));
+        end
+
+        %------------------------------------------------------------------
+        function cascadeTrainer_deleteObj(ptrTrainer)
+
+            coder.inline('always');
+            coder.cinclude('cascadeTrainerCore_api.hpp');
+
+            coder.ceval('cascadeTrainer_deleteObj', ptrTrainer);
+        end
+    end
+end
@@ -33,6 +33,12 @@ classdef detectBRISKBuildable < coder.ExternalDependency %#codegen
             buildInfo.addIncludeFiles({'vision_defines.h', ...
                                        'detectBRISKCore_api.hpp', ...
                                        'cgCommon.hpp', ...                                       
+                                       'cgThreadPool.hpp', ...
+                                       'cgResultPool.hpp', ...
+                                       'cgPyramidCache.hpp', ...
+                                       'cgIntegralImage.hpp', ...
+                                       'cgPipeline.hpp', ...
+                                       'mwtranspose.hpp', ...
                                        'agast_score_mw.hpp', ...
                                        'features2d_other_mw.hpp', ...
                                        'precomp_f2d_mw.hpp'});
@@ -101,6 +107,58 @@ classdef detectBRISKBuildable < coder.ExternalDependency %#codegen
             points.Scale    = scale;
             points.Orientation = orientation;                      
 
-        end       
+        end
+
+        %------------------------------------------------------------------
+        % single call: the maxNumPoints strongest keypoints are written
+        % straight into the outputs
+        function points = detectBRISKInto(Iu8, threshold, numOctaves, maxNumPoints)
+
+            coder.inline('always');
+            coder.cinclude('detectBRISKCore_api.hpp');
+
+            capacity = int32(maxNumPoints);
+            coder.varsize('location',[inf 2]);
+            coder.varsize('metric',[inf 1]);
+            coder.varsize('scale',[inf 1]);
+            coder.varsize('orientation',[inf 1]);
+
+            location = coder.nullcopy(zeros(capacity,2,'single'));
+            metric   = coder.nullcopy(zeros(capacity,1,'single'));
+            scale    = coder.nullcopy(zeros(capacity,1,'single'));
+            orientation = coder.nullcopy(zeros(capacity,1,'single'));
+
+            numOut = int32(0);
+            nRows = int32(size(Iu8,1));
+            nCols = int32(size(Iu8,2));
+
+            if coder.isColumnMajor
+                numOut(1) = coder.ceval('-col', 'detectBRISK_detectInto',...
+                    coder.ref(Iu8), ...
+                    nRows, nCols,...
+                    threshold, numOctaves, capacity,...
+                    coder.ref(location),...
+                    coder.ref(metric),...
+                    coder.ref(scale),...
+                    coder.ref(orientation));
+            else
+                numOut(1) = coder.ceval('-row', 'detectBRISK_detectIntoRM',...
+                    coder.ref(Iu8), ...
+                    nRows, nCols,...
+                    threshold, numOctaves, capacity,...
+                    coder.ref(location),...
+                    coder.ref(metric),...
+                    coder.ref(scale),...
+                    coder.ref(orientation));
+            end
+
+            % numOut is the number of keypoints found, which may exceed the
+            % capacity
+            numWritten = min(numOut, capacity);
+            points.Location = location(1:numWritten, :);
+            points.Metric   = metric(1:numWritten);
+            points.Scale    = scale(1:numWritten);
+            points.Orientation = orientation(1:numWritten);
+        end
     end   
 end
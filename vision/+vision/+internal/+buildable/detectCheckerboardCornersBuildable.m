@@ -0,0 +1,80 @@
+classdef detectCheckerboardCornersBuildable < coder.ExternalDependency %#codegen
+    % detectCheckerboardCornersBuildable - corner candidates of
+    % vision.internal.calibration.checkerboard.detectCheckerboard for a
+    % set of images
+
+    % Copyright 2016 The MathWorks, Inc.
+
+    methods (Static)
+
+        function name = getDescriptiveName(~)
+            name = 'detectCheckerboardCornersBuildable';
+        end
+
+        function b = isSupportedContext(~)
+            b = true; % supports non-host target
+        end
+
+        function updateBuildInfo(buildInfo, context)
+            buildInfo.addIncludePaths({fullfile(matlabroot,'toolbox', ...
+                'vision','builtins','src','ocv','include'), ...
+                fullfile(matlabroot,'toolbox', ...
+                'vision','builtins','src','ocvcg', 'opencv', 'include')} );
+            buildInfo.addSourcePaths({fullfile(matlabroot,'toolbox', ...
+                'vision','builtins','src','ocv')});
+            buildInfo.addSourceFiles({'detectCheckerboardCornersCore.cpp', ...
+                'cgCommon.cpp'});
+            buildInfo.addIncludeFiles({'vision_defines.h', ...
+                                       'detectCheckerboardCornersCore_api.hpp', ...
+                                       'CheckerboardCornerDetector.hpp', ...
+                                       'cgCommon.hpp', ...
+                                       'cgThreadPool.hpp'}); % no need 'rtwtypes.h'
+
+            vision.internal.buildable.portableOpenCVBuildInfo(buildInfo, context, ...
+                'detectCheckerboardCorners');
+        end
+
+        %------------------------------------------------------------------
+        % images is M-by-N-by-numImages, single in [0 1], as im2single of
+        % the grayscale images of detectCheckerboardPoints. sigma and
+        % peakThreshold are those of detectCheckerboard. The candidates of
+        % image i for cxy are those numCandidates(1,i) after the previous
+        % ones, followed by numCandidates(2,i) for c45. points are the
+        % peaks of find_peaks, orientations the [v1 v2] of
+        % cornerOrientations at them and subPixelPoints their refined
+        % locations of subPixelLocation.
+        function [points, scores, orientations, subPixelPoints, numCandidates] = ...
+                detectCheckerboardCorners_detect(images, sigma, peakThreshold)
+
+            coder.inline('always');
+            coder.cinclude('detectCheckerboardCornersCore_api.hpp');
+
+            Is = single(images);
+            nRows = int32(size(Is, 1));
+            nCols = int32(size(Is, 2));
+            numImages = int32(size(Is, 3));
+
+            ptrBatch = coder.opaque('void *', 'NULL');
+            numCandidates = coder.nullcopy(zeros(2, double(numImages), 'int32'));
+            numTotal = int32(0);
+
+            numTotal = coder.ceval('-col', 'detectCheckerboardCorners_detect', ...
+                coder.rref(Is), nRows, nCols, numImages, double(sigma), ...
+                double(peakThreshold), coder.ref(numCandidates), ...
+                coder.ref(ptrBatch));
+
+            coder.varsize('points', [inf, 2]);
+            points = coder.nullcopy(zeros(double(numTotal), 2, 'single'));
+            coder.varsize('scores', [inf, 1]);
+            scores = coder.nullcopy(zeros(double(numTotal), 1, 'single'));
+            coder.varsize('orientations', [inf, 4]);
+            orientations = coder.nullcopy(zeros(double(numTotal), 4, 'single'));
+            coder.varsize('subPixelPoints', [inf, 2]);
+            subPixelPoints = coder.nullcopy(zeros(double(numTotal), 2, 'single'));
+
+            coder.ceval('-col', 'detectCheckerboardCorners_assignOutputDeleteBatch', ...
+                ptrBatch, coder.ref(points), coder.ref(scores), ...
+                coder.ref(orientations), coder.ref(subPixelPoints));
+        end
+    end
+end
@@ -25,7 +25,13 @@ classdef detectFASTBuildable < coder.ExternalDependency %#codegen
                 'cgCommon.cpp'});
             buildInfo.addIncludeFiles({'vision_defines.h', ...
                                        'detectFASTCore_api.hpp', ...
-                                       'cgCommon.hpp'}); % no need 'rtwtypes.h'   
+                                       'cgCommon.hpp', ...
+                                       'cgThreadPool.hpp', ...
+                                       'cgResultPool.hpp', ...
+                                       'cgPyramidCache.hpp', ...
+                                       'cgIntegralImage.hpp', ...
+                                       'cgPipeline.hpp', ...
+                                       'mwtranspose.hpp'}); % no need 'rtwtypes.h'   
                                    
             vision.internal.buildable.portableOpenCVBuildInfo(buildInfo, context, ...
                 'detectFAST');            
@@ -82,6 +88,47 @@ classdef detectFASTBuildable < coder.ExternalDependency %#codegen
                   coder.ref(outMetric));                
             end
 
-        end       
+        end
+
+        %------------------------------------------------------------------
+        % single call: the maxNumPoints strongest corners are written
+        % straight into the outputs
+        function [outLocation, outMetric] = detectFAST_uint8Into(Iu8, minContrast, maxNumPoints)
+
+            coder.inline('always');
+            coder.cinclude('detectFASTCore_api.hpp');
+
+            capacity = int32(maxNumPoints);
+            coder.varsize('outLocation',        [inf, 2]);
+            coder.varsize('outMetric',          [inf, 1]);
+            outLocation = coder.nullcopy(zeros(capacity,2,'single'));
+            outMetric   = coder.nullcopy(zeros(capacity,1,'single'));
+
+            out_numel = int32(0);
+            nRows = int32(size(Iu8, 1));
+            nCols = int32(size(Iu8, 2));
+            isRGB = ~ismatrix(Iu8);
+            if coder.isColumnMajor
+                out_numel(1)=coder.ceval('-col', 'detectFAST_computeInto',...
+                  coder.ref(Iu8), ...
+                  nRows, nCols, isRGB, ...
+                  minContrast, capacity, ...
+                  coder.ref(outLocation), ...
+                  coder.ref(outMetric));
+            else
+                out_numel(1)=coder.ceval('-row', 'detectFAST_computeIntoRM',...
+                  coder.ref(Iu8), ...
+                  nRows, nCols, isRGB, ...
+                  minContrast, capacity, ...
+                  coder.ref(outLocation), ...
+                  coder.ref(outMetric));
+            end
+
+            % out_numel is the number of corners found, which may exceed
+            % the capacity
+            numWritten = min(out_numel, capacity);
+            outLocation = outLocation(1:numWritten, :);
+            outMetric   = outMetric(1:numWritten);
+        end
     end   
-end
\ No newline at end of file
+end
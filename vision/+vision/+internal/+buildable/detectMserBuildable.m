@@ -24,6 +24,12 @@ classdef detectMserBuildable < coder.ExternalDependency %#codegen
             buildInfo.addSourceFiles({'detectMserCore.cpp', 'cgCommon.cpp'});
             buildInfo.addIncludeFiles({'vision_defines.h', ...
                                        'cgCommon.hpp', ...
+                                       'cgThreadPool.hpp', ...
+                                       'cgResultPool.hpp', ...
+                                       'cgPyramidCache.hpp', ...
+                                       'cgIntegralImage.hpp', ...
+                                       'cgPipeline.hpp', ...
+                                       'mwtranspose.hpp', ...
                                        'detectMserCore_api.hpp'}); % no need 'rtwtypes.h'   
                                    
             vision.internal.buildable.portableOpenCVBuildInfo(buildInfo, context, ...
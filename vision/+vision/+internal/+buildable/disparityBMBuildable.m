@@ -21,9 +21,19 @@ classdef disparityBMBuildable < coder.ExternalDependency %#codegen
                 'vision','builtins','src','ocvcg', 'opencv', 'include')} );
             buildInfo.addSourcePaths({fullfile(matlabroot,'toolbox', ...
                 'vision','builtins','src','ocv')});
-            buildInfo.addSourceFiles({'disparityBMCore.cpp'});
+            buildInfo.addSourceFiles({'disparityBMCore.cpp', 'cgCommon.cpp'});
             buildInfo.addIncludeFiles({'vision_defines.h', ...
+                                       'cgCommon.hpp', ...
+                                       'cgThreadPool.hpp', ...
+                                       'cgResultPool.hpp', ...
+                                       'cgPyramidCache.hpp', ...
+                                       'cgIntegralImage.hpp', ...
+                                       'cgPipeline.hpp', ...
                                        'disparityBM.hpp', ...
+                                       'mwtranspose.hpp', ...
+                                       'DisparityBMOcv.hpp', ...
+                                       'DisparityCuda.hpp', ...
+                                       'DisparityCoarse.hpp', ...
                                        'disparityBMCore_api.hpp'}); % no need 'rtwtypes.h'   
                                    
             vision.internal.buildable.portableOpenCVBuildInfo(buildInfo, context, ...
@@ -42,21 +52,7 @@ classdef disparityBMBuildable < coder.ExternalDependency %#codegen
             outSize = [nRows nCols];
             outDisparity = coder.nullcopy(zeros(outSize,'single'));
             
-            paramStruct = struct( ...
-                'preFilterCap', int32(opt.preFilterCap), ...
-                'SADWindowSize', int32(opt.SADWindowSize), ...
-                'minDisparity', int32(opt.minDisparity), ...
-                'numberOfDisparities', int32(opt.numberOfDisparities), ...
-                'textureThreshold', int32(opt.textureThreshold), ...
-                'uniquenessRatio', int32(opt.uniquenessRatio), ...
-                'disp12MaxDiff', int32(opt.disp12MaxDiff), ...
-                'preFilterType', int32(opt.preFilterType), ...
-                'preFilterSize', int32(opt.preFilterSize), ...
-                'speckleWindowSize', int32(opt.speckleWindowSize), ...
-                'speckleRange', int32(opt.speckleRange), ...                
-                'trySmallerWindows', int32(opt.trySmallerWindows));   
-            
-            coder.cstructname(paramStruct,'cvstDBMStruct_T');
+            paramStruct = vision.internal.buildable.disparityBMBuildable.getParamStruct(opt);
             
             if coder.isColumnMajor
                 coder.ceval('-col', 'disparityBM_compute',...
@@ -75,5 +71,107 @@ classdef disparityBMBuildable < coder.ExternalDependency %#codegen
             end                
             
         end       
+
+        %------------------------------------------------------------------
+        % stateful matcher: the OpenCV matcher and its buffers are kept
+        % alive across frames
+        function ptrObj = disparityBM_construct()
+
+            coder.inline('always');
+            coder.cinclude('disparityBMCore_api.hpp');
+
+            ptrObj = coder.opaque('void *', 'NULL');
+
+            % call function from shared library
+            coder.ceval('disparityBM_construct', coder.ref(ptrObj));
+        end
+
+        %------------------------------------------------------------------
+        function outDisparity = disparityBM_step(ptrObj, image1_u8, image2_u8, opt)
+
+            coder.inline('always');
+            coder.cinclude('disparityBMCore_api.hpp');
+
+            nRows = int32(size(image1_u8, 1)); % original (before transpose)
+            nCols = int32(size(image1_u8, 2)); % original (before transpose)
+            outSize = [nRows nCols];
+            outDisparity = coder.nullcopy(zeros(outSize,'single'));
+
+            paramStruct = vision.internal.buildable.disparityBMBuildable.getParamStruct(opt);
+
+            if coder.isColumnMajor
+                coder.ceval('-col', 'disparityBM_step', ptrObj, ...
+                    coder.ref(image1_u8), ...
+                    coder.ref(image2_u8), ...
+                    nRows, nCols, ...
+                    coder.ref(outDisparity), ...
+                    coder.ref(paramStruct));
+            else
+                coder.ceval('-row', 'disparityBM_stepRM', ptrObj, ...
+                    coder.ref(image1_u8), ...
+                    coder.ref(image2_u8), ...
+                    nRows, nCols, ...
+                    coder.ref(outDisparity), ...
+                    coder.ref(paramStruct));
+            end
+        end
+
+        %------------------------------------------------------------------
+        function disparityBM_deleteObj(ptrObj)
+
+            coder.inline('always');
+            coder.cinclude('disparityBMCore_api.hpp');
+
+            coder.ceval('disparityBM_deleteObj', ptrObj);
+        end
+
+        %------------------------------------------------------------------
+        % parameter structure shared by compute and step
+        function paramStruct = getParamStruct(opt)
+
+            coder.inline('always');
+
+            % Optional field: match on a CUDA device when one is present
+            if isfield(opt, 'useGPU')
+                useGPU = int32(opt.useGPU);
+            else
+                useGPU = int32(0);
+            end
+
+            % Optional field: number of CPU strips matched in parallel, 0
+            % for one per worker thread
+            if isfield(opt, 'numStrips')
+                numStrips = int32(opt.numStrips);
+            else
+                numStrips = int32(0);
+            end
+
+            % Optional field: restrict the search of each strip by a match
+            % at 1/4 of the size
+            if isfield(opt, 'coarseToFine')
+                coarseToFine = int32(opt.coarseToFine);
+            else
+                coarseToFine = int32(0);
+            end
+
+            paramStruct = struct( ...
+                'preFilterCap', int32(opt.preFilterCap), ...
+                'SADWindowSize', int32(opt.SADWindowSize), ...
+                'minDisparity', int32(opt.minDisparity), ...
+                'numberOfDisparities', int32(opt.numberOfDisparities), ...
+                'textureThreshold', int32(opt.textureThreshold), ...
+                'uniquenessRatio', int32(opt.uniquenessRatio), ...
+                'disp12MaxDiff', int32(opt.disp12MaxDiff), ...
+                'preFilterType', int32(opt.preFilterType), ...
+                'preFilterSize', int32(opt.preFilterSize), ...
+                'speckleWindowSize', int32(opt.speckleWindowSize), ...
+                'speckleRange', int32(opt.speckleRange), ...                
+                'trySmallerWindows', int32(opt.trySmallerWindows), ...
+                'useGPU', useGPU, ...
+                'numStrips', numStrips, ...
+                'coarseToFine', coarseToFine);   
+            
+            coder.cstructname(paramStruct,'cvstDBMStruct_T');
+        end
     end   
 end
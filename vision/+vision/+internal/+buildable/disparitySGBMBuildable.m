@@ -25,6 +25,10 @@ classdef disparitySGBMBuildable < coder.ExternalDependency %#codegen
             buildInfo.addSourceFiles({'disparitySGBMCore.cpp'});
             buildInfo.addIncludeFiles({'vision_defines.h', ...
                                        'disparityBM.hpp', ...
+                                       'mwtranspose.hpp', ...
+                                       'DisparitySGBMOcv.hpp', ...
+                                       'DisparityCuda.hpp', ...
+                                       'DisparityCoarse.hpp', ...
                                        'disparitySGBMCore_api.hpp'}); % no need 'rtwtypes.h'   
                                    
             vision.internal.buildable.portableOpenCVBuildInfo(buildInfo, context, ...
@@ -43,21 +47,7 @@ classdef disparitySGBMBuildable < coder.ExternalDependency %#codegen
             outSize = [nRows nCols];
             outDisparity = coder.nullcopy(zeros(outSize,'single'));
             
-            paramStruct = struct( ...
-                'preFilterCap', int32(opt.preFilterCap), ...
-                'SADWindowSize', int32(opt.SADWindowSize), ...
-                'minDisparity', int32(opt.minDisparity), ...
-                'numberOfDisparities', int32(opt.numberOfDisparities), ...
-                'uniquenessRatio', int32(opt.uniquenessRatio), ...
-                'disp12MaxDiff', int32(opt.disp12MaxDiff), ...
-                'speckleWindowSize', int32(opt.speckleWindowSize), ...
-                'speckleRange', int32(opt.speckleRange), ...                
-                'P1',int32(opt.P1),...
-                'P2',int32(opt.P2),...
-                'fullDP',int32(opt.fullDP)...
-                );   
-            
-            coder.cstructname(paramStruct,'cvstDSGBMStruct_T');
+            paramStruct = vision.internal.buildable.disparitySGBMBuildable.getParamStruct(opt);
             
             if coder.isColumnMajor
                 coder.ceval('-col', 'disparitySGBM_compute',...
@@ -76,5 +66,140 @@ classdef disparitySGBMBuildable < coder.ExternalDependency %#codegen
             end                
             
         end       
+
+        %------------------------------------------------------------------
+        % stateful matcher: the OpenCV matcher and its buffers are kept
+        % alive across frames
+        function ptrObj = disparitySGBM_construct()
+
+            coder.inline('always');
+            coder.cinclude('disparitySGBMCore_api.hpp');
+
+            ptrObj = coder.opaque('void *', 'NULL');
+
+            % call function from shared library
+            coder.ceval('disparitySGBM_construct', coder.ref(ptrObj));
+        end
+
+        %------------------------------------------------------------------
+        function outDisparity = disparitySGBM_step(ptrObj, image1_u8, image2_u8, opt)
+
+            coder.inline('always');
+            coder.cinclude('disparitySGBMCore_api.hpp');
+
+            nRows = int32(size(image1_u8, 1)); % original (before transpose)
+            nCols = int32(size(image1_u8, 2)); % original (before transpose)
+            outSize = [nRows nCols];
+            outDisparity = coder.nullcopy(zeros(outSize,'single'));
+
+            paramStruct = vision.internal.buildable.disparitySGBMBuildable.getParamStruct(opt);
+
+            if coder.isColumnMajor
+                coder.ceval('-col', 'disparitySGBM_step', ptrObj, ...
+                    coder.ref(image1_u8), ...
+                    coder.ref(image2_u8), ...
+                    nRows, nCols, ...
+                    coder.ref(outDisparity), ...
+                    coder.ref(paramStruct));
+            else
+                coder.ceval('-row', 'disparitySGBM_stepRM', ptrObj, ...
+                    coder.ref(image1_u8), ...
+                    coder.ref(image2_u8), ...
+                    nRows, nCols, ...
+                    coder.ref(outDisparity), ...
+                    coder.ref(paramStruct));
+            end
+        end
+
+        %------------------------------------------------------------------
+        function disparitySGBM_deleteObj(ptrObj)
+
+            coder.inline('always');
+            coder.cinclude('disparitySGBMCore_api.hpp');
+
+            coder.ceval('disparitySGBM_deleteObj', ptrObj);
+        end
+
+        %------------------------------------------------------------------
+        % bytes used by a stateful matcher on frames of frameSize, at the
+        % peak of a step and kept between steps
+        function [peakBytes, steadyBytes] = disparitySGBM_estimateMemory(frameSize, opt)
+
+            coder.inline('always');
+            coder.cinclude('disparitySGBMCore_api.hpp');
+
+            paramStruct = vision.internal.buildable.disparitySGBMBuildable.getParamStruct(opt);
+
+            peakBytes = 0;
+            steadyBytes = 0;
+            coder.ceval('disparitySGBM_estimateMemory', ...
+                int32(frameSize(1)), int32(frameSize(2)), ...
+                coder.ref(paramStruct), ...
+                coder.ref(peakBytes), coder.ref(steadyBytes));
+        end
+
+        %------------------------------------------------------------------
+        % parameter structure shared by compute and step
+        function paramStruct = getParamStruct(opt)
+
+            coder.inline('always');
+
+            % Optional fields: SGBM mode (0: SGBM, 1: HH, 2: SGBM_3WAY),
+            % parallel strips, a memory budget in megabytes (0 for no
+            % budget) and matching on a CUDA device. Without a mode, fullDP
+            % selects the HH mode.
+            if isfield(opt, 'mode')
+                mode = int32(opt.mode);
+            elseif opt.fullDP
+                mode = int32(1);
+            else
+                mode = int32(0);
+            end
+
+            if isfield(opt, 'useStrips')
+                useStrips = int32(opt.useStrips);
+            else
+                useStrips = int32(0);
+            end
+
+            if isfield(opt, 'memoryBudgetMB')
+                memoryBudgetMB = double(opt.memoryBudgetMB);
+            else
+                memoryBudgetMB = 0;
+            end
+
+            if isfield(opt, 'useGPU')
+                useGPU = int32(opt.useGPU);
+            else
+                useGPU = int32(0);
+            end
+
+            if isfield(opt, 'coarseToFine')
+                coarseToFine = int32(opt.coarseToFine);
+            else
+                coarseToFine = int32(0);
+            end
+
+            paramStruct = struct( ...
+                'preFilterCap', int32(opt.preFilterCap), ...
+                'SADWindowSize', int32(opt.SADWindowSize), ...
+                'minDisparity', int32(opt.minDisparity), ...
+                'numberOfDisparities', int32(opt.numberOfDisparities), ...
+                'uniquenessRatio', int32(opt.uniquenessRatio), ...
+                'disp12MaxDiff', int32(opt.disp12MaxDiff), ...
+                'speckleWindowSize', int32(opt.speckleWindowSize), ...
+                'speckleRange', int32(opt.speckleRange), ...                
+                'P1',int32(opt.P1),...
+                'P2',int32(opt.P2),...
+                'fullDP',int32(opt.fullDP),...
+                'mode',mode,...
+                'useStrips',useStrips,...
+                'memoryBudgetMB',memoryBudgetMB,...
+                'useGPU',useGPU,...
+                'coarseToFine',coarseToFine...
+                );   
+            
+            coder.cstructname(paramStruct,'cvstDSGBMStruct_T');
+        end
     end   
 end
@@ -33,6 +33,12 @@ classdef extractBRISKBuildable < coder.ExternalDependency %#codegen
             buildInfo.addIncludeFiles({'vision_defines.h', ...
                                        'extractBRISKCore_api.hpp', ...
                                        'cgCommon.hpp', ...                                       
+                                       'cgThreadPool.hpp', ...
+                                       'cgResultPool.hpp', ...
+                                       'cgPyramidCache.hpp', ...
+                                       'cgIntegralImage.hpp', ...
+                                       'cgPipeline.hpp', ...
+                                       'mwtranspose.hpp', ...
                                        'agast_score_mw.hpp', ...
                                        'features2d_other_mw.hpp', ... 
                                        'precomp_f2d_mw.hpp'}); % no need 'rtwtypes.h'           
@@ -27,6 +27,12 @@ classdef extractFreakBuildable < coder.ExternalDependency %#codegen
             buildInfo.addIncludeFiles({'vision_defines.h', ...
                                        'mwfreak.hpp', ...
                                        'cgCommon.hpp', ...
+                                       'cgThreadPool.hpp', ...
+                                       'cgResultPool.hpp', ...
+                                       'cgPyramidCache.hpp', ...
+                                       'cgIntegralImage.hpp', ...
+                                       'cgPipeline.hpp', ...
+                                       'mwtranspose.hpp', ...
                                        'extractFreakCore_api.hpp'}); % no need 'rtwtypes.h'   
                                    
             vision.internal.buildable.portableOpenCVBuildInfo(buildInfo, context, ...
@@ -106,6 +112,72 @@ classdef extractFreakBuildable < coder.ExternalDependency %#codegen
               coder.ref(outOrientation), coder.ref(outFeatures));                
             end
 
-        end       
+        end
+
+        %------------------------------------------------------------------
+        % single call: the features are written straight into outputs of
+        % one row per input point, which always has room for all of them
+        function [outLocation, outScale, outMetric, outMisc, ...
+                  outOrientation, outFeatures] = ...
+                 extractFreak_uint8Into(Iu8T, inLocation, inScale, inMetric, ...
+                 inMisc, nbOctave, orientationNormalized, scaleNormalized, patternScale)
+
+            coder.inline('always');
+            coder.cinclude('extractFreakCore_api.hpp');
+
+            numel = int32(size(inLocation, 1));
+            numInDims = int32(ndims(Iu8T));
+            featureWidth = 64;
+
+            coder.varsize('outLocation',        [inf, 2]);
+            coder.varsize('outScale',           [inf, 1]);
+            coder.varsize('outMetric',          [inf, 1]);
+            coder.varsize('outMisc',            [inf, 1]);
+            coder.varsize('outOrientation',     [inf, 1]);
+            coder.varsize('outFeatures',        [inf, 128],[1 1]);
+
+            outLocation = coder.nullcopy(zeros(numel,2,'single'));
+            outScale    = coder.nullcopy(zeros(numel,1,'single'));
+            outMetric   = coder.nullcopy(zeros(numel,1,'single'));
+            outMisc = coder.nullcopy(zeros(numel,1,'int32'));
+            outOrientation = coder.nullcopy(zeros(numel,1,'single'));
+            outFeatures = coder.nullcopy(zeros(numel,featureWidth,'uint8'));
+
+            out_numel = int32(0);
+            if coder.isColumnMajor
+            nRows = int32(size(Iu8T, 2)); % original (before transpose)
+            nCols = int32(size(Iu8T, 1)); % original (before transpose)
+
+            out_numel(1)=coder.ceval('-col','extractFreak_computeInto',...
+              coder.ref(Iu8T), ...
+              nRows, nCols, numInDims, ...
+              coder.ref(inLocation), coder.ref(inScale), coder.ref(inMetric), coder.ref(inMisc), ...
+              int32(numel), int32(nbOctave), logical(orientationNormalized), logical(scaleNormalized), single(patternScale), ...
+              numel, ...
+              coder.ref(outLocation), coder.ref(outScale), ...
+              coder.ref(outMetric), coder.ref(outMisc), ...
+              coder.ref(outOrientation), coder.ref(outFeatures));
+            else
+            nRows = int32(size(Iu8T, 1)); % original (before transpose)
+            nCols = int32(size(Iu8T, 2)); % original (before transpose)
+
+            out_numel(1)=coder.ceval('-row','extractFreak_computeIntoRM',...
+              coder.ref(Iu8T), ...
+              nRows, nCols, numInDims, ...
+              coder.ref(inLocation), coder.ref(inScale), coder.ref(inMetric), coder.ref(inMisc), ...
+              int32(numel), int32(nbOctave), logical(orientationNormalized), logical(scaleNormalized), single(patternScale), ...
+              numel, ...
+              coder.ref(outLocation), coder.ref(outScale), ...
+              coder.ref(outMetric), coder.ref(outMisc), ...
+              coder.ref(outOrientation), coder.ref(outFeatures));
+            end
+
+            outLocation = outLocation(1:out_numel, :);
+            outScale    = outScale(1:out_numel);
+            outMetric   = outMetric(1:out_numel);
+            outMisc     = outMisc(1:out_numel);
+            outOrientation = outOrientation(1:out_numel);
+            outFeatures = outFeatures(1:out_numel, :);
+        end
     end   
-end
\ No newline at end of file
+end
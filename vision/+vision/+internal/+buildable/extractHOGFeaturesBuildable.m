@@ -0,0 +1,86 @@
+classdef extractHOGFeaturesBuildable < coder.ExternalDependency %#codegen
+    % extractHOGFeaturesBuildable - HOG features of batches of same sized
+    % images, as extractHOGFeatures computes them for a whole image
+
+    % Copyright 2016 The MathWorks, Inc.
+
+    methods (Static)
+
+        function name = getDescriptiveName(~)
+            name = 'extractHOGFeaturesBuildable';
+        end
+
+        function b = isSupportedContext(~)
+            b = true; % supports non-host target
+        end
+
+        function updateBuildInfo(buildInfo, context)
+            buildInfo.addIncludePaths({fullfile(matlabroot,'toolbox', ...
+                'vision','builtins','src','ocv','include'), ...
+                fullfile(matlabroot,'toolbox', ...
+                'vision','builtins','src','ocvcg', 'opencv', 'include')} );
+            buildInfo.addSourcePaths({fullfile(matlabroot,'toolbox', ...
+                'vision','builtins','src','ocv')});
+            buildInfo.addSourceFiles({'extractHOGFeaturesCore.cpp', ...
+                'cgCommon.cpp'});
+            buildInfo.addIncludeFiles({'vision_defines.h', ...
+                                       'extractHOGFeaturesCore_api.hpp', ...
+                                       'HOGFeatureExtractor.hpp', ...
+                                       'cgCommon.hpp', ...
+                                       'cgThreadPool.hpp'}); % no need 'rtwtypes.h'
+
+            vision.internal.buildable.portableOpenCVBuildInfo(buildInfo, context, ...
+                'extractHOGFeatures');
+        end
+
+        %------------------------------------------------------------------
+        % images is M-by-N-by-P-by-K, P 1 or 3, of any class
+        % extractHOGFeatures accepts; the images other than uint8 are
+        % converted to single. params has the fields of extractHOGFeatures.
+        % features is K-by-featureSize single, the features of each image.
+        function features = extractHOGFeatures(images, params)
+
+            coder.inline('always');
+            coder.cinclude('extractHOGFeaturesCore_api.hpp');
+
+            nRows     = int32(size(images, 1));
+            nCols     = int32(size(images, 2));
+            nChannels = int32(size(images, 3));
+            numImages = int32(size(images, 4));
+
+            cellSize     = int32(params.CellSize);
+            blockSize    = int32(params.BlockSize);
+            blockOverlap = int32(params.BlockOverlap);
+            numBins      = int32(params.NumBins);
+            isSigned     = logical(params.UseSignedOrientation);
+
+            hogParams = params;
+            hogParams.WindowSize = [nRows nCols];
+            featureSize = vision.internal.hog.getFeatureSize(hogParams);
+            features = coder.nullcopy(zeros(double(numImages), ...
+                double(featureSize), 'single'));
+
+            if isa(images, 'uint8')
+                img = images;
+                suffix = '_uint8';
+            else
+                img = single(images);
+                suffix = '_single';
+            end
+
+            if coder.isColumnMajor
+                coder.ceval('-col', ['extractHOGFeatures' suffix], ...
+                    coder.rref(img), nRows, nCols, nChannels, numImages, ...
+                    coder.rref(cellSize), coder.rref(blockSize), ...
+                    coder.rref(blockOverlap), numBins, isSigned, ...
+                    coder.ref(features));
+            else
+                coder.ceval('-row', ['extractHOGFeatures' suffix 'RM'], ...
+                    coder.rref(img), nRows, nCols, nChannels, numImages, ...
+                    coder.rref(cellSize), coder.rref(blockSize), ...
+                    coder.rref(blockOverlap), numBins, isSigned, ...
+                    coder.ref(features));
+            end
+        end
+    end
+end
@@ -24,13 +24,21 @@ classdef extractSurfBuildable < coder.ExternalDependency %#codegen
             buildInfo.addSourceFiles({'extractSurfCore.cpp', ...
                 'surfCommon.cpp', ...              
                 'cgCommon.cpp', ...
-                'mwsurf.cpp'});
+                'mwsurf.cpp', ...
+                'mwcompactdescriptor.cpp'});
             buildInfo.addIncludeFiles({'vision_defines.h', ...
                                        'extractSurfCore_api.hpp', ...
                                        'surfCommon.hpp', ...
                                        'precomp_mw.hpp', ...
                                        'features2d_surf_mw.hpp', ...
-                                       'cgCommon.hpp'}); % no need 'rtwtypes.h'
+                                       'cgCommon.hpp', ...
+                                       'cgThreadPool.hpp', ...
+                                       'cgResultPool.hpp', ...
+                                       'cgPyramidCache.hpp', ...
+                                       'cgIntegralImage.hpp', ...
+                                       'cgPipeline.hpp', ...
+                                       'mwtranspose.hpp', ...
+                                       'mwcompactdescriptor.hpp'}); % no need 'rtwtypes.h'
                                    
             vision.internal.buildable.portableOpenCVBuildInfo(buildInfo, context, ...
                 'extractSurf');
@@ -46,34 +54,9 @@ classdef extractSurfBuildable < coder.ExternalDependency %#codegen
             coder.inline('always');
             coder.cinclude('extractSurfCore_api.hpp');
             
-            ptrKeypoints = coder.opaque('void *', 'NULL');
-            ptrDescriptors = coder.opaque('void *', 'NULL');
-    
-            % call function
-            out_numel = int32(0);
-            numel = int32(size(inLocation, 1));
-            numInDims = int32(ndims(Iu8T));
-            if coder.isColumnMajor
-            nRows = int32(size(Iu8T, 2)); % original (before transpose)
-            nCols = int32(size(Iu8T, 1)); % original (before transpose)
-                
-            out_numel(1)=coder.ceval('-col','extractSurf_compute',...
-              coder.ref(Iu8T), ...
-              nRows, nCols, numInDims, ...   
-              inLocation, inScale, inMetric, inSignOfLaplacian, ...
-              numel, isExtended, isUpright, ...
-              coder.ref(ptrKeypoints), coder.ref(ptrDescriptors));
-            else
-            nRows = int32(size(Iu8T, 1)); % original (before transpose)
-            nCols = int32(size(Iu8T, 2)); % original (before transpose)
-                
-            out_numel(1)=coder.ceval('-row','extractSurf_computeRM',...
-              coder.ref(Iu8T), ...
-              nRows, nCols, numInDims, ...   
-              inLocation, inScale, inMetric, inSignOfLaplacian, ...
-              numel, isExtended, isUpright, ...
-              coder.ref(ptrKeypoints), coder.ref(ptrDescriptors));
-            end
+            [ptrKeypoints, ptrDescriptors, out_numel] = computeSurf(Iu8T, ...
+                inLocation, inScale, inMetric, inSignOfLaplacian, ...
+                isExtended, isUpright);
             
             % copy output to mxArray
             % declare output as variable sized so that _mex file can return differet sized output.
@@ -109,5 +92,94 @@ classdef extractSurfBuildable < coder.ExternalDependency %#codegen
             end
 
         end       
+
+        %------------------------------------------------------------------
+        % extractSurf_uint8 with the features in half precision, their bits
+        % in uint16, when featureClass is 'uint16', or in int8 scaled by
+        % 127 when it is 'int8'. The features are matched with
+        % matchFeaturesApproxNN.findExactNearestNeighborsCompact.
+        function [outLocation, outScale, outMetric, outSignOfLaplacian, ...
+                  outOrientation, outFeatures] = ...
+                 extractSurfCompact_uint8(Iu8T, inLocation, inScale, inMetric, ...
+                 inSignOfLaplacian, featureWidth, isExtended, isUpright, featureClass)
+
+            coder.inline('always');
+            coder.cinclude('extractSurfCore_api.hpp');
+            coder.internal.prefer_const(featureClass);
+
+            [ptrKeypoints, ptrDescriptors, out_numel] = computeSurf(Iu8T, ...
+                inLocation, inScale, inMetric, inSignOfLaplacian, ...
+                isExtended, isUpright);
+
+            coder.internal.prefer_const(featureWidth);
+            coder.varsize('outLocation',        [inf, 2]);
+            coder.varsize('outScale',           [inf, 1]);
+            coder.varsize('outMetric',          [inf, 1]);
+            coder.varsize('outSignOfLaplacian', [inf, 1]);
+            coder.varsize('outOrientation',     [inf, 1]);
+            coder.varsize('outFeatures',        [inf, 128],[1 1]);
+
+            outLocation = coder.nullcopy(zeros(out_numel,2,'single'));
+            outScale    = coder.nullcopy(zeros(out_numel,1,'single'));
+            outMetric   = coder.nullcopy(zeros(out_numel,1,'single'));
+            outSignOfLaplacian = coder.nullcopy(zeros(out_numel,1,'int8'));
+            outOrientation = coder.nullcopy(zeros(out_numel,1,'single'));
+            outFeatures = coder.nullcopy(zeros(out_numel,featureWidth,featureClass));
+
+            if strcmp(featureClass, 'int8')
+                fcnName = 'extractSurf_assignOutputInt8';
+            else
+                fcnName = 'extractSurf_assignOutputHalf';
+            end
+
+            if coder.isColumnMajor
+            coder.ceval('-col',fcnName,...
+              ptrKeypoints, ptrDescriptors, ...
+              coder.ref(outLocation), coder.ref(outScale), ...
+              coder.ref(outMetric), coder.ref(outSignOfLaplacian), ...
+              coder.ref(outOrientation), coder.ref(outFeatures));
+            else
+            coder.ceval('-row',[fcnName 'RM'],...
+              ptrKeypoints, ptrDescriptors, ...
+              coder.ref(outLocation), coder.ref(outScale), ...
+              coder.ref(outMetric), coder.ref(outSignOfLaplacian), ...
+              coder.ref(outOrientation), coder.ref(outFeatures));
+            end
+        end
     end   
 end
+
+%--------------------------------------------------------------------------
+% Descriptors of the points, freed by the extractSurf_assignOutput functions
+function [ptrKeypoints, ptrDescriptors, out_numel] = computeSurf(Iu8T, ...
+    inLocation, inScale, inMetric, inSignOfLaplacian, isExtended, isUpright)
+
+coder.inline('always');
+ptrKeypoints = coder.opaque('void *', 'NULL');
+ptrDescriptors = coder.opaque('void *', 'NULL');
+
+out_numel = int32(0);
+numel = int32(size(inLocation, 1));
+numInDims = int32(ndims(Iu8T));
+if coder.isColumnMajor
+    nRows = int32(size(Iu8T, 2)); % original (before transpose)
+    nCols = int32(size(Iu8T, 1)); % original (before transpose)
+
+    out_numel(1)=coder.ceval('-col','extractSurf_compute',...
+      coder.ref(Iu8T), ...
+      nRows, nCols, numInDims, ...
+      inLocation, inScale, inMetric, inSignOfLaplacian, ...
+      numel, isExtended, isUpright, ...
+      coder.ref(ptrKeypoints), coder.ref(ptrDescriptors));
+else
+    nRows = int32(size(Iu8T, 1)); % original (before transpose)
+    nCols = int32(size(Iu8T, 2)); % original (before transpose)
+
+    out_numel(1)=coder.ceval('-row','extractSurf_computeRM',...
+      coder.ref(Iu8T), ...
+      nRows, nCols, numInDims, ...
+      inLocation, inScale, inMetric, inSignOfLaplacian, ...
+      numel, isExtended, isUpright, ...
+      coder.ref(ptrKeypoints), coder.ref(ptrDescriptors));
+end
+end
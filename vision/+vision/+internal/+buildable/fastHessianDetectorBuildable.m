@@ -22,9 +22,17 @@ classdef fastHessianDetectorBuildable < coder.ExternalDependency %#codegen
                 'vision','builtins','src','ocv')});
             buildInfo.addSourceFiles({'fastHessianDetectorCore.cpp', ...
                 'surfCommon.cpp', ...                
-                'mwsurf.cpp'});
+                'mwsurf.cpp', ...
+                'cgCommon.cpp'});
             buildInfo.addIncludeFiles({'vision_defines.h', ...
                                        'fastHessianDetectorCore_api.hpp', ...
+                                       'cgCommon.hpp', ...
+                                       'cgThreadPool.hpp', ...
+                                       'cgResultPool.hpp', ...
+                                       'cgPyramidCache.hpp', ...
+                                       'cgIntegralImage.hpp', ...
+                                       'cgPipeline.hpp', ...
+                                       'mwtranspose.hpp', ...
                                        'precomp_mw.hpp', ...
                                        'features2d_surf_mw.hpp', ...
                                        'surfCommon.hpp'}); % no need 'rtwtypes.h'
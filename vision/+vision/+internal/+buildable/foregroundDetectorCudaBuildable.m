@@ -0,0 +1,120 @@
+classdef foregroundDetectorCudaBuildable < coder.ExternalDependency %#codegen
+    % foregroundDetectorCudaBuildable - encapsulate the CUDA foreground
+    % detector implementation library
+
+    % Copyright 2016 The MathWorks, Inc.
+
+
+    methods (Static)
+
+        function name = getDescriptiveName(~)
+            name = 'foregroundDetectorCudaBuildable';
+        end
+
+        function b = isSupportedContext(~)
+            b = true; % supports non-host target
+        end
+
+        function updateBuildInfo(buildInfo, context)
+            buildInfo.addIncludePaths({fullfile(matlabroot,'toolbox', ...
+                'vision','builtins','src','ocv','include'), ...
+                fullfile(matlabroot,'toolbox', ...
+                'vision','builtins','src','ocvcg', 'opencv', 'include')} );
+            buildInfo.addSourcePaths({fullfile(matlabroot,'toolbox', ...
+                'vision','builtins','src','ocv')});
+            buildInfo.addSourceFiles({'foregroundDetectorCudaCore.cpp'});
+            buildInfo.addIncludeFiles({'vision_defines.h', ...
+                                       'ForegroundDetectorCudaOcv.hpp', ...
+                                       'foregroundDetectorCudaCore_api.hpp'}); % no need 'rtwtypes.h'
+
+            vision.internal.buildable.portableOpenCVBuildInfo(buildInfo, context, ...
+                'foregroundDetectorCuda');
+        end
+
+        %------------------------------------------------------------------
+        % returns a NULL pointer when the device is not available, in which
+        % case the CPU foreground detector must be used
+        function ptrObj = foregroundDetectorCuda_construct(device)
+
+            coder.inline('always');
+            coder.cinclude('foregroundDetectorCudaCore_api.hpp');
+
+            ptrObj = coder.opaque('void *', 'NULL');
+
+            % call function from shared library
+            coder.ceval('foregroundDetectorCuda_construct', coder.ref(ptrObj), ...
+                int32(device));
+        end
+
+        %------------------------------------------------------------------
+        function isAvailable = foregroundDetectorCuda_isAvailable(device)
+
+            coder.inline('always');
+            coder.cinclude('foregroundDetectorCudaCore_api.hpp');
+
+            isAvailable = false;
+            isAvailable = coder.ceval('foregroundDetectorCuda_isAvailable', ...
+                int32(device));
+        end
+
+        %------------------------------------------------------------------
+        function foregroundDetectorCuda_initialize(ptrObj, imageSize, ...
+                numGaussians, initialVariance, minBGRatio)
+
+            coder.inline('always');
+            coder.cinclude('foregroundDetectorCudaCore_api.hpp');
+
+            paramStruct = struct( ...
+                'numGaussians',    int32(numGaussians), ...
+                'initialVariance', double(initialVariance), ...
+                'minBGRatio',      double(minBGRatio));
+
+            coder.cstructname(paramStruct,'cvstFGDCudaStruct_T');
+
+            if numel(imageSize) > 2
+                nChannels = imageSize(3);
+            else
+                nChannels = 1;
+            end
+
+            coder.ceval('foregroundDetectorCuda_initialize', ptrObj, ...
+                int32(imageSize(1)), int32(imageSize(2)), int32(nChannels), ...
+                coder.ref(paramStruct));
+        end
+
+        %------------------------------------------------------------------
+        function mask = foregroundDetectorCuda_step(ptrObj, I, learningRate)
+
+            coder.inline('always');
+            coder.cinclude('foregroundDetectorCudaCore_api.hpp');
+
+            mask = coder.nullcopy(false(size(I,1), size(I,2)));
+
+            if coder.isColumnMajor
+                coder.ceval('-col', 'foregroundDetectorCuda_step', ptrObj, ...
+                    coder.rref(I), coder.wref(mask), single(learningRate));
+            else
+                coder.ceval('-row', 'foregroundDetectorCuda_stepRM', ptrObj, ...
+                    coder.rref(I), coder.wref(mask), single(learningRate));
+            end
+        end
+
+        %------------------------------------------------------------------
+        function foregroundDetectorCuda_reset(ptrObj)
+
+            coder.inline('always');
+            coder.cinclude('foregroundDetectorCudaCore_api.hpp');
+
+            coder.ceval('foregroundDetectorCuda_reset', ptrObj);
+        end
+
+        %------------------------------------------------------------------
+        function foregroundDetectorCuda_deleteObj(ptrObj)
+
+            coder.inline('always');
+            coder.cinclude('foregroundDetectorCudaCore_api.hpp');
+
+            coder.ceval('foregroundDetectorCuda_deleteObj', ptrObj);
+        end
+    end
+end
@@ -0,0 +1,89 @@
+classdef harrisMinEigenBuildable < coder.ExternalDependency %#codegen
+    % harrisMinEigenBuildable - corner metric and peaks of
+    % detectHarrisFeatures and detectMinEigenFeatures
+
+    % Copyright 2016 The MathWorks, Inc.
+
+    methods (Static)
+
+        function name = getDescriptiveName(~)
+            name = 'harrisMinEigenBuildable';
+        end
+
+        function b = isSupportedContext(~)
+            b = true; % supports non-host target
+        end
+
+        function updateBuildInfo(buildInfo, context)
+            buildInfo.addIncludePaths({fullfile(matlabroot,'toolbox', ...
+                'vision','builtins','src','ocv','include'), ...
+                fullfile(matlabroot,'toolbox', ...
+                'vision','builtins','src','ocvcg', 'opencv', 'include')} );
+            buildInfo.addSourcePaths({fullfile(matlabroot,'toolbox', ...
+                'vision','builtins','src','ocv')});
+            buildInfo.addSourceFiles({'harrisMinEigenCore.cpp', ...
+                'cgCommon.cpp'});
+            buildInfo.addIncludeFiles({'vision_defines.h', ...
+                                       'harrisMinEigenCore_api.hpp', ...
+                                       'HarrisMinEigen.hpp', ...
+                                       'cgCommon.hpp', ...
+                                       'cgThreadPool.hpp', ...
+                                       'cgResultPool.hpp', ...
+                                       'cgPyramidCache.hpp', ...
+                                       'cgIntegralImage.hpp', ...
+                                       'cgPipeline.hpp'}); % no need 'rtwtypes.h'
+
+            vision.internal.buildable.portableOpenCVBuildInfo(buildInfo, context, ...
+                'harrisMinEigen');
+        end
+
+        %------------------------------------------------------------------
+        % I is the single image cropped to the expanded ROI. method is
+        % 'Harris' or 'MinimumEigenvalue'. location is M-by-2 [x y] in the
+        % coordinates of I and metric M-by-1, as harrisMinEigen computes
+        % them before excluding the corners outside the ROI.
+        function [location, metric] = harrisMinEigen(method, I, filterSize, minQuality)
+
+            coder.inline('always');
+            coder.cinclude('harrisMinEigenCore_api.hpp');
+
+            ptrCorners = coder.opaque('void *', 'NULL');
+
+            if strcmpi(method, 'Harris')
+                methodId = int32(0);
+            else
+                methodId = int32(1);
+            end
+
+            Is = single(I);
+            nRows = int32(size(Is, 1));
+            nCols = int32(size(Is, 2));
+            fSize = int32(filterSize);
+            quality = single(minQuality);
+
+            numCorners = int32(0);
+            if coder.isColumnMajor
+                numCorners(1) = coder.ceval('-col', 'harrisMinEigen_compute', ...
+                    coder.rref(Is), nRows, nCols, methodId, fSize, quality, ...
+                    coder.ref(ptrCorners));
+            else
+                numCorners(1) = coder.ceval('-row', 'harrisMinEigen_computeRM', ...
+                    coder.rref(Is), nRows, nCols, methodId, fSize, quality, ...
+                    coder.ref(ptrCorners));
+            end
+
+            coder.varsize('location', [inf, 2]);
+            coder.varsize('metric',   [inf, 1]);
+            location = coder.nullcopy(zeros(numCorners, 2, 'single'));
+            metric   = coder.nullcopy(zeros(numCorners, 1, 'single'));
+
+            if coder.isColumnMajor
+                coder.ceval('-col', 'harrisMinEigen_assignOutputDelete', ...
+                    ptrCorners, coder.ref(location), coder.ref(metric));
+            else
+                coder.ceval('-row', 'harrisMinEigen_assignOutputDeleteRM', ...
+                    ptrCorners, coder.ref(location), coder.ref(metric));
+            end
+        end
+    end
+end
@@ -0,0 +1,150 @@
+classdef icpRegistrationBuildable < coder.ExternalDependency %#codegen
+    % icpRegistrationBuildable - rigid registration of point clouds with
+    % ICP, as pcregrigid, coarse to fine over voxel grid steps
+
+    % Copyright 2016 The MathWorks, Inc.
+
+    methods (Static)
+
+        function name = getDescriptiveName(~)
+            name = 'icpRegistrationBuildable';
+        end
+
+        function b = isSupportedContext(~)
+            b = true; % supports non-host target
+        end
+
+        function updateBuildInfo(buildInfo, context)
+            buildInfo.addIncludePaths({fullfile(matlabroot,'toolbox', ...
+                'vision','builtins','src','ocv','include'), ...
+                fullfile(matlabroot,'toolbox', ...
+                'vision','builtins','src','ocvcg', 'opencv', 'include')} );
+            buildInfo.addSourcePaths({fullfile(matlabroot,'toolbox', ...
+                'vision','builtins','src','ocv')});
+            buildInfo.addSourceFiles({'icpRegistrationCore.cpp', ...
+                'cgCommon.cpp'});
+            buildInfo.addIncludeFiles({'vision_defines.h', ...
+                                       'icpRegistrationCore_api.hpp', ...
+                                       'RigidIcp.hpp', ...
+                                       'PointCloudKdtree.hpp', ...
+                                       'VoxelGridFilter.hpp', ...
+                                       'cgCommon.hpp', ...
+                                       'cgThreadPool.hpp'}); % no need 'rtwtypes.h'
+
+            vision.internal.buildable.portableOpenCVBuildInfo(buildInfo, context, ...
+                'icpRegistration');
+        end
+
+        %------------------------------------------------------------------
+        % the fixed cloud is kept by the object, so that several moving
+        % clouds can be registered to it
+        function ptrIcp = icpRegistration_construct(location)
+
+            coder.inline('always');
+            coder.cinclude('icpRegistrationCore_api.hpp');
+
+            ptrIcp = coder.opaque('void *', 'NULL');
+
+            coder.ceval(['icpRegistration_construct' typeSuffix(location)], ...
+                coder.ref(ptrIcp));
+        end
+
+        %------------------------------------------------------------------
+        % location is M-by-3 single or double, normal M-by-3 of its class
+        % or empty. gridSteps are the grid steps of the schedule, coarse to
+        % fine, 0 for the full cloud.
+        function icpRegistration_setFixed(ptrIcp, location, normal, ...
+                gridSteps, isPointToPlane)
+
+            coder.inline('always');
+            coder.cinclude('icpRegistrationCore_api.hpp');
+
+            numPoints = int32(size(location, 1));
+            hasNormal = ~isempty(normal);
+            steps = double(gridSteps);
+            numLevels = int32(numel(steps));
+            fcnName = ['icpRegistration_setFixed' typeSuffix(location)];
+
+            status = int32(0);
+            if coder.isColumnMajor
+                status = coder.ceval('-col', fcnName, ptrIcp, ...
+                    coder.rref(location), coder.rref(normal), numPoints, ...
+                    hasNormal, coder.rref(steps), numLevels, ...
+                    logical(isPointToPlane));
+            else
+                status = coder.ceval('-row', [fcnName 'RM'], ptrIcp, ...
+                    coder.rref(location), coder.rref(normal), numPoints, ...
+                    hasNormal, coder.rref(steps), numLevels, ...
+                    logical(isPointToPlane));
+            end
+
+            checkStatus(status);
+        end
+
+        %------------------------------------------------------------------
+        % location is M-by-3 of the class of the fixed cloud. initialTform
+        % and tform are the 4-by-4 T of affine3d, tolerance is
+        % [translation rotation], rotation in radians.
+        function [tform, rmse, numIterations] = icpRegistration_register( ...
+                ptrIcp, location, inlierRatio, maxIterations, tolerance, ...
+                initialTform)
+
+            coder.inline('always');
+            coder.cinclude('icpRegistrationCore_api.hpp');
+
+            numPoints = int32(size(location, 1));
+            tol = double(tolerance);
+            initT = double(initialTform);
+            tform = coder.nullcopy(zeros(4, 4));
+            rmse = 0;
+            numIterations = int32(0);
+            fcnName = ['icpRegistration_register' typeSuffix(location)];
+
+            status = int32(0);
+            if coder.isColumnMajor
+                status = coder.ceval('-col', fcnName, ptrIcp, ...
+                    coder.rref(location), numPoints, double(inlierRatio), ...
+                    int32(maxIterations), coder.rref(tol), coder.rref(initT), ...
+                    coder.ref(tform), coder.ref(rmse), coder.ref(numIterations));
+            else
+                status = coder.ceval('-row', [fcnName 'RM'], ptrIcp, ...
+                    coder.rref(location), numPoints, double(inlierRatio), ...
+                    int32(maxIterations), coder.rref(tol), coder.rref(initT), ...
+                    coder.ref(tform), coder.ref(rmse), coder.ref(numIterations));
+            end
+
+            checkStatus(status);
+        end
+
+        %------------------------------------------------------------------
+        % location is only used for its class
+        function icpRegistration_deleteObj(ptrIcp, location)
+
+            coder.inline('always');
+            coder.cinclude('icpRegistrationCore_api.hpp');
+
+            coder.ceval(['icpRegistration_deleteObj' typeSuffix(location)], ...
+                ptrIcp);
+        end
+    end
+end
+
+% -------------------------------------------------------------------------
+function suffix = typeSuffix(x)
+coder.inline('always');
+if isa(x, 'double')
+    suffix = '';
+else
+    suffix = '_single';
+end
+end
+
+% -------------------------------------------------------------------------
+function checkStatus(status)
+coder.inline('always');
+if status == -1
+    error(message('vision:pointcloud:notEnoughPoints'));
+elseif status == -2
+    error(message('vision:pointcloud:singularMatrix'));
+end
+end
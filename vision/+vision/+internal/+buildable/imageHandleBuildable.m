@@ -0,0 +1,110 @@
+classdef imageHandleBuildable < coder.ExternalDependency %#codegen
+    % imageHandleBuildable - encapsulate the image handle shared by the
+    % pointTracker, opticalFlowFarneback, HOGDescriptor and
+    % cascadeClassifier libraries
+
+    % Copyright 2016 The MathWorks, Inc.
+
+
+    methods (Static)
+
+        function name = getDescriptiveName(~)
+            name = 'imageHandleBuildable';
+        end
+
+        function b = isSupportedContext(~)
+            b = true; % supports non-host target
+        end
+
+        function updateBuildInfo(buildInfo, context)
+            buildInfo.addIncludePaths({fullfile(matlabroot,'toolbox', ...
+                'vision','builtins','src','ocv','include'), ...
+                fullfile(matlabroot,'toolbox', ...
+                'vision','builtins','src','ocvcg', 'opencv', 'include')} );
+            buildInfo.addSourcePaths({fullfile(matlabroot,'toolbox', ...
+                'vision','builtins','src','ocv')});
+            buildInfo.addSourceFiles({'imageHandleCore.cpp', 'cgCommon.cpp'});
+            buildInfo.addIncludeFiles({'vision_defines.h', ...
+                                       'cgCommon.hpp', ...
+                                       'cgThreadPool.hpp', ...
+                                       'cgResultPool.hpp', ...
+                                       'cgPyramidCache.hpp', ...
+                                       'cgIntegralImage.hpp', ...
+                                       'cgPipeline.hpp', ...
+                                       'mwtranspose.hpp', ...
+                                       'ImageHandle.hpp', ...
+                                       'imageHandleCore_api.hpp'}); % no need 'rtwtypes.h'
+
+            vision.internal.buildable.portableOpenCVBuildInfo(buildInfo, context, ...
+                'imageHandle');
+        end
+
+        %------------------------------------------------------------------
+        % keeps device copies of the image on the given CUDA device when it
+        % is available; the image is host only otherwise
+        function ptrImage = imageHandle_construct(device)
+
+            coder.inline('always');
+            coder.cinclude('imageHandleCore_api.hpp');
+
+            ptrImage = coder.opaque('void *', 'NULL');
+
+            coder.ceval('imageHandle_construct', coder.ref(ptrImage), ...
+                int32(device));
+        end
+
+        %------------------------------------------------------------------
+        function isOnDevice = imageHandle_isOnDevice(ptrImage)
+
+            coder.inline('always');
+            coder.cinclude('imageHandleCore_api.hpp');
+
+            isOnDevice = false;
+            isOnDevice = coder.ceval('imageHandle_isOnDevice', ptrImage);
+        end
+
+        %------------------------------------------------------------------
+        % I is a uint8 grayscale or RGB image, passed without transposing
+        function imageHandle_setImage(ptrImage, I)
+
+            coder.inline('always');
+            coder.cinclude('imageHandleCore_api.hpp');
+
+            nRows = int32(size(I, 1));
+            nCols = int32(size(I, 2));
+            nChannels = int32(size(I, 3));
+
+            if coder.isColumnMajor
+                coder.ceval('-col', 'imageHandle_setImage', ptrImage, ...
+                    coder.ref(I), nRows, nCols, nChannels);
+            else
+                coder.ceval('-row', 'imageHandle_setImageRM', ptrImage, ...
+                    coder.ref(I), nRows, nCols, nChannels);
+            end
+        end
+
+        %------------------------------------------------------------------
+        function I = imageHandle_getImage(ptrImage, imageSize)
+
+            coder.inline('always');
+            coder.cinclude('imageHandleCore_api.hpp');
+
+            I = coder.nullcopy(zeros(imageSize, 'uint8'));
+
+            if coder.isColumnMajor
+                coder.ceval('-col', 'imageHandle_getImage', ptrImage, coder.ref(I));
+            else
+                coder.ceval('-row', 'imageHandle_getImage', ptrImage, coder.ref(I));
+            end
+        end
+
+        %------------------------------------------------------------------
+        function imageHandle_deleteObj(ptrImage)
+
+            coder.inline('always');
+            coder.cinclude('imageHandleCore_api.hpp');
+
+            coder.ceval('imageHandle_deleteObj', ptrImage);
+        end
+    end
+end
@@ -0,0 +1,163 @@
+classdef invertedImageIndexBuildable < coder.ExternalDependency %#codegen
+    % invertedImageIndexBuildable - compressed inverted file of the word
+    % histograms of invertedImageIndex, for indexImages and retrieveImages
+
+    % Copyright 2016 The MathWorks, Inc.
+
+    methods (Static)
+
+        function name = getDescriptiveName(~)
+            name = 'invertedImageIndexBuildable';
+        end
+
+        function b = isSupportedContext(~)
+            b = true; % supports non-host target
+        end
+
+        function updateBuildInfo(buildInfo, context)
+            buildInfo.addIncludePaths({fullfile(matlabroot,'toolbox', ...
+                'vision','builtins','src','ocv','include'), ...
+                fullfile(matlabroot,'toolbox', ...
+                'vision','builtins','src','ocvcg', 'opencv', 'include')} );
+            buildInfo.addSourcePaths({fullfile(matlabroot,'toolbox', ...
+                'vision','builtins','src','ocv')});
+            buildInfo.addSourceFiles({'invertedImageIndexCore.cpp', ...
+                'cgCommon.cpp'});
+            buildInfo.addIncludeFiles({'vision_defines.h', ...
+                                       'invertedImageIndexCore_api.hpp', ...
+                                       'InvertedFile.hpp', ...
+                                       'MappedFile.hpp', ...
+                                       'cgCommon.hpp', ...
+                                       'cgThreadPool.hpp'}); % no need 'rtwtypes.h'
+
+            vision.internal.buildable.portableOpenCVBuildInfo(buildInfo, context, ...
+                'invertedImageIndex');
+        end
+
+        %------------------------------------------------------------------
+        function ptrIndex = invertedImageIndex_construct(numWords)
+
+            coder.inline('always');
+            coder.cinclude('invertedImageIndexCore_api.hpp');
+
+            ptrIndex = coder.opaque('void *', 'NULL');
+
+            coder.ceval('invertedImageIndex_construct', int32(numWords), ...
+                coder.ref(ptrIndex));
+        end
+
+        %------------------------------------------------------------------
+        % wordHistograms is the sparse numImages-by-numWords matrix of
+        % bagOfFeatures/encode with 'Normalization' 'none'
+        function invertedImageIndex_addImages(ptrIndex, wordHistograms)
+
+            coder.inline('always');
+            coder.cinclude('invertedImageIndexCore_api.hpp');
+
+            [image, word, count] = find(wordHistograms);
+            image = uint32(image);
+            word = uint32(word);
+            count = double(full(count));
+            numImages = int32(size(wordHistograms, 1));
+
+            coder.ceval('invertedImageIndex_addImages', ptrIndex, ...
+                coder.rref(image), coder.rref(word), coder.rref(count), ...
+                int32(numel(count)), numImages);
+        end
+
+        %------------------------------------------------------------------
+        function invertedImageIndex_removeImages(ptrIndex, indices)
+
+            coder.inline('always');
+            coder.cinclude('invertedImageIndexCore_api.hpp');
+
+            indices = double(indices);
+
+            coder.ceval('invertedImageIndex_removeImages', ptrIndex, ...
+                coder.rref(indices), int32(numel(indices)));
+        end
+
+        %------------------------------------------------------------------
+        % queryHist is the 1-by-numWords histogram of the query image.
+        % imageIDs and scores are column vectors, best first.
+        function [imageIDs, scores] = invertedImageIndex_search(ptrIndex, ...
+                queryHist, wordFrequencyRange, matchThreshold, numResults)
+
+            coder.inline('always');
+            coder.cinclude('invertedImageIndexCore_api.hpp');
+
+            [~, word, count] = find(queryHist);
+            word = uint32(word);
+            count = double(full(count));
+            freqRange = double(wordFrequencyRange);
+
+            K = int32(numResults);
+            ids = coder.nullcopy(zeros(K, 1, 'uint32'));
+            s = coder.nullcopy(zeros(K, 1));
+
+            numOut = int32(0);
+            numOut = coder.ceval('invertedImageIndex_search', ptrIndex, ...
+                coder.rref(word), coder.rref(count), int32(numel(count)), ...
+                coder.rref(freqRange), double(matchThreshold), K, ...
+                coder.ref(ids), coder.ref(s));
+
+            imageIDs = double(ids(1:numOut));
+            scores = s(1:numOut);
+        end
+
+        %------------------------------------------------------------------
+        function n = invertedImageIndex_getNumImages(ptrIndex)
+
+            coder.inline('always');
+            coder.cinclude('invertedImageIndexCore_api.hpp');
+
+            n = int32(0);
+            n = coder.ceval('invertedImageIndex_getNumImages', ptrIndex);
+        end
+
+        %------------------------------------------------------------------
+        function frequency = invertedImageIndex_getWordFrequency(ptrIndex, numWords)
+
+            coder.inline('always');
+            coder.cinclude('invertedImageIndexCore_api.hpp');
+
+            frequency = coder.nullcopy(zeros(1, numWords));
+
+            coder.ceval('invertedImageIndex_getWordFrequency', ptrIndex, ...
+                coder.ref(frequency));
+        end
+
+        %------------------------------------------------------------------
+        % save the index to a single file that
+        % invertedImageIndex_load memory-maps
+        function success = invertedImageIndex_save(ptrIndex, filename)
+
+            coder.inline('always');
+            coder.cinclude('invertedImageIndexCore_api.hpp');
+
+            success = false;
+            success = coder.ceval('invertedImageIndex_save', ptrIndex, ...
+                coder.ref([filename char(0)]));
+        end
+
+        %------------------------------------------------------------------
+        function success = invertedImageIndex_load(ptrIndex, filename)
+
+            coder.inline('always');
+            coder.cinclude('invertedImageIndexCore_api.hpp');
+
+            success = false;
+            success = coder.ceval('invertedImageIndex_load', ptrIndex, ...
+                coder.ref([filename char(0)]));
+        end
+
+        %------------------------------------------------------------------
+        function invertedImageIndex_deleteObj(ptrIndex)
+
+            coder.inline('always');
+            coder.cinclude('invertedImageIndexCore_api.hpp');
+
+            coder.ceval('invertedImageIndex_deleteObj', ptrIndex);
+        end
+    end
+end
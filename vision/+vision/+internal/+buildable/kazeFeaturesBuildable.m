@@ -0,0 +1,202 @@
+classdef kazeFeaturesBuildable < coder.ExternalDependency %#codegen
+    % kazeFeaturesBuildable - KAZE keypoints and descriptors, the codegen
+    % counterparts of ocvDetectKAZE and ocvExtractKAZE
+
+    % Copyright 2016 The MathWorks, Inc.
+
+    methods (Static)
+
+        function name = getDescriptiveName(~)
+            name = 'kazeFeaturesBuildable';
+        end
+
+        function b = isSupportedContext(~)
+            b = true; % supports non-host target
+        end
+
+        function updateBuildInfo(buildInfo, context)
+            buildInfo.addIncludePaths({fullfile(matlabroot,'toolbox', ...
+                'vision','builtins','src','ocv','include'), ...
+                fullfile(matlabroot,'toolbox', ...
+                'vision','builtins','src','ocvcg', 'opencv', 'include')} );
+            buildInfo.addSourcePaths({fullfile(matlabroot,'toolbox', ...
+                'vision','builtins','src','ocv')});
+            buildInfo.addSourceFiles({'kazeFeaturesCore.cpp', ...
+                'mwcompactdescriptor.cpp', ...
+                'cgCommon.cpp'});
+            buildInfo.addIncludeFiles({'vision_defines.h', ...
+                                       'kazeFeaturesCore_api.hpp', ...
+                                       'KazeFeatures.hpp', ...
+                                       'mwcompactdescriptor.hpp', ...
+                                       'cgCommon.hpp', ...
+                                       'cgThreadPool.hpp'}); % no need 'rtwtypes.h'
+
+            vision.internal.buildable.portableOpenCVBuildInfo(buildInfo, context, ...
+                'kazeFeatures');
+        end
+
+        %------------------------------------------------------------------
+        % Iu8 is the uint8 grayscale image and diffusivity the code of
+        % convertKAZEDiffusionToOCVCode. The outputs are the fields of
+        % ocvDetectKAZE: Scale is a diameter and Misc the LayerID.
+        function rawPts = kazeFeatures_detect(Iu8, threshold, numOctaves, ...
+                numScaleLevels, diffusivity)
+
+            coder.inline('always');
+            coder.cinclude('kazeFeaturesCore_api.hpp');
+
+            nRows = int32(size(Iu8, 1));
+            nCols = int32(size(Iu8, 2));
+
+            ptrKeypoints = coder.opaque('void *', 'NULL');
+            numOut = int32(0);
+            numOut = coder.ceval('-col', 'kazeFeatures_detect', ...
+                coder.rref(Iu8), nRows, nCols, single(threshold), ...
+                int32(numOctaves), int32(numScaleLevels), int32(diffusivity), ...
+                coder.ref(ptrKeypoints));
+
+            rawPts = allocatePoints(numOut);
+            if coder.isColumnMajor
+                coder.ceval('-col', 'kazeFeatures_assignOutputDeleteKeypoints', ...
+                    ptrKeypoints, coder.ref(rawPts.Location), ...
+                    coder.ref(rawPts.Scale), coder.ref(rawPts.Metric), ...
+                    coder.ref(rawPts.Orientation), coder.ref(rawPts.Misc));
+            else
+                coder.ceval('-row', 'kazeFeatures_assignOutputDeleteKeypointsRM', ...
+                    ptrKeypoints, coder.ref(rawPts.Location), ...
+                    coder.ref(rawPts.Scale), coder.ref(rawPts.Metric), ...
+                    coder.ref(rawPts.Orientation), coder.ref(rawPts.Misc));
+            end
+        end
+
+        %------------------------------------------------------------------
+        % ptsStruct is that of ocvExtractKAZE, Scale a diameter. features
+        % is M-by-64, or M-by-128 when extended, and vPts has the fields
+        % of ptsStruct, with the orientations unless upright. The optional
+        % featureClass is 'single' (default), 'uint16' for the bits of half
+        % precision features or 'int8' for features scaled by 127.
+        function [features, vPts] = kazeFeatures_extract(Iu8, ptsStruct, ...
+                extended, upright, numOctaves, numScaleLevels, diffusivity, ...
+                featureClass)
+
+            coder.inline('always');
+            coder.cinclude('kazeFeaturesCore_api.hpp');
+            if nargin < 8
+                featureClass = 'single';
+            end
+
+            nRows = int32(size(Iu8, 1));
+            nCols = int32(size(Iu8, 2));
+            inLoc    = single(ptsStruct.Location);
+            inScale  = single(ptsStruct.Scale);
+            inMetric = single(ptsStruct.Metric);
+            inLayer  = int32(ptsStruct.Misc);
+            numPoints = int32(size(inLoc, 1));
+
+            ptrKeypoints = coder.opaque('void *', 'NULL');
+            ptrDescriptors = coder.opaque('void *', 'NULL');
+            numOut = int32(0);
+            if coder.isColumnMajor
+                numOut = coder.ceval('-col', 'kazeFeatures_extract', ...
+                    coder.rref(Iu8), nRows, nCols, coder.rref(inLoc), ...
+                    coder.rref(inScale), coder.rref(inMetric), ...
+                    coder.rref(inLayer), numPoints, logical(extended), ...
+                    logical(upright), int32(numOctaves), ...
+                    int32(numScaleLevels), int32(diffusivity), ...
+                    coder.ref(ptrKeypoints), coder.ref(ptrDescriptors));
+            else
+                numOut = coder.ceval('-row', 'kazeFeatures_extractRM', ...
+                    coder.rref(Iu8), nRows, nCols, coder.rref(inLoc), ...
+                    coder.rref(inScale), coder.rref(inMetric), ...
+                    coder.rref(inLayer), numPoints, logical(extended), ...
+                    logical(upright), int32(numOctaves), ...
+                    int32(numScaleLevels), int32(diffusivity), ...
+                    coder.ref(ptrKeypoints), coder.ref(ptrDescriptors));
+            end
+
+            [features, vPts] = assignFeatures(numOut, extended, ...
+                ptrKeypoints, ptrDescriptors, featureClass);
+        end
+
+        %------------------------------------------------------------------
+        % Detection and extraction on one scale space, the outputs of
+        % kazeFeatures_extract
+        function [features, vPts] = kazeFeatures_detectAndExtract(Iu8, ...
+                threshold, extended, upright, numOctaves, numScaleLevels, ...
+                diffusivity, featureClass)
+
+            coder.inline('always');
+            coder.cinclude('kazeFeaturesCore_api.hpp');
+            if nargin < 8
+                featureClass = 'single';
+            end
+
+            nRows = int32(size(Iu8, 1));
+            nCols = int32(size(Iu8, 2));
+
+            ptrKeypoints = coder.opaque('void *', 'NULL');
+            ptrDescriptors = coder.opaque('void *', 'NULL');
+            numOut = int32(0);
+            numOut = coder.ceval('-col', 'kazeFeatures_detectAndExtract', ...
+                coder.rref(Iu8), nRows, nCols, single(threshold), ...
+                logical(extended), logical(upright), int32(numOctaves), ...
+                int32(numScaleLevels), int32(diffusivity), ...
+                coder.ref(ptrKeypoints), coder.ref(ptrDescriptors));
+
+            [features, vPts] = assignFeatures(numOut, extended, ...
+                ptrKeypoints, ptrDescriptors, featureClass);
+        end
+    end
+end
+
+%--------------------------------------------------------------------------
+function pts = allocatePoints(numOut)
+coder.inline('always');
+coder.varsize('pts.Location', [inf, 2]);
+pts.Location = coder.nullcopy(zeros(double(numOut), 2, 'single'));
+coder.varsize('pts.Scale', [inf, 1]);
+pts.Scale = coder.nullcopy(zeros(double(numOut), 1, 'single'));
+coder.varsize('pts.Metric', [inf, 1]);
+pts.Metric = coder.nullcopy(zeros(double(numOut), 1, 'single'));
+coder.varsize('pts.Orientation', [inf, 1]);
+pts.Orientation = coder.nullcopy(zeros(double(numOut), 1, 'single'));
+coder.varsize('pts.Misc', [inf, 1]);
+pts.Misc = coder.nullcopy(zeros(double(numOut), 1, 'int32'));
+end
+
+%--------------------------------------------------------------------------
+function [features, vPts] = assignFeatures(numOut, extended, ...
+    ptrKeypoints, ptrDescriptors, featureClass)
+coder.inline('always');
+coder.internal.prefer_const(featureClass);
+if extended
+    featureSize = 128;
+else
+    featureSize = 64;
+end
+vPts = allocatePoints(numOut);
+coder.varsize('features', [inf, 128]);
+features = coder.nullcopy(zeros(double(numOut), featureSize, featureClass));
+
+if strcmp(featureClass, 'int8')
+    fcnName = 'kazeFeatures_assignExtractOutputDeleteInt8';
+elseif strcmp(featureClass, 'uint16')
+    fcnName = 'kazeFeatures_assignExtractOutputDeleteHalf';
+else
+    fcnName = 'kazeFeatures_assignExtractOutputDelete';
+end
+
+if coder.isColumnMajor
+    coder.ceval('-col', fcnName, ...
+        ptrKeypoints, ptrDescriptors, coder.ref(vPts.Location), ...
+        coder.ref(vPts.Scale), coder.ref(vPts.Metric), ...
+        coder.ref(vPts.Orientation), coder.ref(vPts.Misc), ...
+        coder.ref(features));
+else
+    coder.ceval('-row', [fcnName 'RM'], ...
+        ptrKeypoints, ptrDescriptors, coder.ref(vPts.Location), ...
+        coder.ref(vPts.Scale), coder.ref(vPts.Metric), ...
+        coder.ref(vPts.Orientation), coder.ref(vPts.Misc), ...
+        coder.ref(features));
+end
+end
@@ -21,11 +21,26 @@ classdef matchFeaturesApproxNN < coder.ExternalDependency %#codegen
             buildInfo.addSourcePaths({fullfile(matlabroot,'toolbox', ...
                 'vision','builtins','src','ocv')});
             buildInfo.addSourceFiles({'matchFeaturesApproxNNCore.cpp', ...
+                'matchFeaturesExhaustiveCore.cpp', ...
+                'matchFeaturesPQCore.cpp', ...
+                'matchFeaturesCudaCore.cpp', ...
                 'mwflann.cpp', ...  
-                'mwminiflann.cpp'});
+                'mwminiflann.cpp', ...
+                'mwhamming.cpp', ...
+                'mwcompactdescriptor.cpp', ...
+                'cgCommon.cpp'});
 
             buildInfo.addIncludeFiles({'vision_defines.h', ...
-                                       'precomp_flann.hpp'});
+                                       'precomp_flann.hpp', ...
+                                       'ApproxNNIndex.hpp', ...
+                                       'ProductQuantizer.hpp', ...
+                                       'ApproxKMeans.hpp', ...
+                                       'MappedFile.hpp', ...
+                                       'FeatureMatcherCuda.hpp', ...
+                                       'mwhamming.hpp', ...
+                                       'mwcompactdescriptor.hpp', ...
+                                       'cgCommon.hpp', ...
+                                       'cgThreadPool.hpp'});
             
             % add flann directory with all header files (using hack)
             fileLists = coder.internal.const('../../../../builtins/src/ocv/include/flann/*');
@@ -103,5 +118,487 @@ classdef matchFeaturesApproxNN < coder.ExternalDependency %#codegen
                 end
             end
         end
+
+        %------------------------------------------------------------------
+        % exhaustive search for binary features using the Hamming distance
+        function [indexPairs, matchMetric] = ...
+                findExactNearestNeighbors(features1, features2, knn)
+
+            coder.inline('always');
+            coder.cinclude('matchFeaturesCore_api.hpp');
+
+            M   = cast(size(features1,2),'int32');
+            N1  = cast(size(features1,1),'int32');
+            N2  = cast(size(features2,1),'int32');
+            knn = cast(knn,'int32');
+
+            if coder.isColumnMajor
+                indexPairs  = coder.nullcopy(zeros(knn, N1, 'int32'));
+                matchMetric = coder.nullcopy(zeros(knn, N1, 'int32'));
+                coder.ceval('-col','findExactNearestNeighbors_uint8',...
+                    features1', features2', N1, N2, M, knn, ...
+                    coder.ref(indexPairs), coder.ref(matchMetric));
+            else
+                indexPairs  = coder.nullcopy(zeros(N1, knn, 'int32'));
+                matchMetric = coder.nullcopy(zeros(N1, knn, 'int32'));
+                coder.ceval('-row','findExactNearestNeighbors_uint8',...
+                    coder.ref(features1), coder.ref(features2), N1, N2, M, knn, ...
+                    coder.ref(indexPairs), coder.ref(matchMetric));
+            end
+        end
+
+        %------------------------------------------------------------------
+        % exhaustive SSD search for the uint16 (half precision bits) or int8
+        % features of extractSurfBuildable.extractSurfCompact_uint8 and
+        % kazeFeaturesBuildable. matchMetric is the SSD of the single
+        % features.
+        function [indexPairs, matchMetric] = ...
+                findExactNearestNeighborsCompact(features1, features2, knn)
+
+            coder.inline('always');
+            coder.cinclude('matchFeaturesCore_api.hpp');
+
+            M   = cast(size(features1,2),'int32');
+            N1  = cast(size(features1,1),'int32');
+            N2  = cast(size(features2,1),'int32');
+            knn = cast(knn,'int32');
+
+            if isa(features1, 'int8')
+                fcnName = 'findExactNearestNeighbors_int8';
+            else
+                fcnName = 'findExactNearestNeighbors_half';
+            end
+
+            if coder.isColumnMajor
+                indexPairs  = coder.nullcopy(zeros(knn, N1, 'int32'));
+                matchMetric = coder.nullcopy(zeros(knn, N1, 'single'));
+                coder.ceval('-col',fcnName,...
+                    features1', features2', N1, N2, M, knn, ...
+                    coder.ref(indexPairs), coder.ref(matchMetric));
+            else
+                indexPairs  = coder.nullcopy(zeros(N1, knn, 'int32'));
+                matchMetric = coder.nullcopy(zeros(N1, knn, 'single'));
+                coder.ceval('-row',fcnName,...
+                    coder.ref(features1), coder.ref(features2), N1, N2, M, knn, ...
+                    coder.ref(indexPairs), coder.ref(matchMetric));
+            end
+        end
+
+        %------------------------------------------------------------------
+        % LSH search for binary features. lshParams is a struct with
+        % TableNumber, KeySize and MultiProbeLevel fields.
+        function [indexPairs, matchMetric] = ...
+                findApproximateNearestNeighborsLsh(features1, features2, lshParams)
+
+            coder.inline('always');
+            coder.cinclude('matchFeaturesCore_api.hpp');
+
+            M  = cast(size(features1,2),'int32');
+            N1 = cast(size(features1,1),'int32');
+            N2 = cast(size(features2,1),'int32');
+
+            if N2 > 1
+                knn = int32(2);
+            else
+                knn = int32(1);
+            end
+
+            tableNumber     = cast(lshParams.TableNumber,'int32');
+            keySize         = cast(lshParams.KeySize,'int32');
+            multiProbeLevel = cast(lshParams.MultiProbeLevel,'int32');
+
+            if coder.isColumnMajor
+                indexPairs  = coder.nullcopy(zeros(knn, N1, 'int32'));
+                matchMetric = coder.nullcopy(zeros(knn, N1, 'int32'));
+                coder.ceval('-col','findApproximateNearestNeighborsLsh_uint8',...
+                    features1', features2', N1, N2, M, knn, ...
+                    tableNumber, keySize, multiProbeLevel, ...
+                    coder.ref(indexPairs), coder.ref(matchMetric));
+            else
+                indexPairs  = coder.nullcopy(zeros(N1, knn, 'int32'));
+                matchMetric = coder.nullcopy(zeros(N1, knn, 'int32'));
+                coder.ceval('-row','findApproximateNearestNeighborsLsh_uint8',...
+                    coder.ref(features1), coder.ref(features2), N1, N2, M, knn, ...
+                    tableNumber, keySize, multiProbeLevel, ...
+                    coder.ref(indexPairs), coder.ref(matchMetric));
+            end
+        end
+
+        %------------------------------------------------------------------
+        % persistent index: build once over features2, query many times
+        function ptrObj = matchFeaturesIndex_construct()
+
+            coder.inline('always');
+            coder.cinclude('matchFeaturesCore_api.hpp');
+
+            ptrObj = coder.opaque('void *', 'NULL');
+
+            coder.ceval('matchFeaturesIndex_construct', coder.ref(ptrObj));
+        end
+
+        %------------------------------------------------------------------
+        function matchFeaturesIndex_build(ptrObj, features2, metric)
+
+            coder.inline('always');
+            coder.cinclude('matchFeaturesCore_api.hpp');
+
+            M  = cast(size(features2,2),'int32');
+            N2 = cast(size(features2,1),'int32');
+
+            if strcmpi(metric, 'hamming')
+                fcnName = 'matchFeaturesIndex_build_uint8';
+            else
+                fcnName = 'matchFeaturesIndex_build_real32';
+            end
+
+            if coder.isColumnMajor
+                coder.ceval('-col', fcnName, ptrObj, features2', metric, ...
+                    N2, M);
+            else
+                coder.ceval('-row', fcnName, ptrObj, ...
+                    coder.ref(features2), metric, N2, M);
+            end
+        end
+
+        %------------------------------------------------------------------
+        % autotune the index of real features on the next build. The
+        % chosen configuration is saved with the index; set it on another
+        % index to skip the tuning.
+        function matchFeaturesIndex_setAutotuneParams(ptrObj, ...
+                targetPrecision, buildWeight, memoryWeight, sampleFraction)
+
+            coder.inline('always');
+            coder.cinclude('matchFeaturesCore_api.hpp');
+
+            coder.ceval('matchFeaturesIndex_setAutotuneParams', ptrObj, ...
+                single(targetPrecision), single(buildWeight), ...
+                single(memoryWeight), single(sampleFraction));
+        end
+
+        %------------------------------------------------------------------
+        % config is 1-by-7: algorithm, trees, branching, iterations,
+        % centers_init, cb_index and checks. isTuned is false when the
+        % index was not tuned.
+        function [config, isTuned] = matchFeaturesIndex_getTunedConfig(ptrObj)
+
+            coder.inline('always');
+            coder.cinclude('matchFeaturesCore_api.hpp');
+
+            config = zeros(1, 7);
+            isTuned = false;
+            isTuned = coder.ceval('matchFeaturesIndex_getTunedConfig', ...
+                ptrObj, coder.ref(config));
+        end
+
+        %------------------------------------------------------------------
+        function matchFeaturesIndex_setTunedConfig(ptrObj, config)
+
+            coder.inline('always');
+            coder.cinclude('matchFeaturesCore_api.hpp');
+
+            coder.ceval('matchFeaturesIndex_setTunedConfig', ptrObj, ...
+                coder.rref(double(config)));
+        end
+
+        %------------------------------------------------------------------
+        function matchFeaturesIndex_addPoints(ptrObj, features, metric)
+
+            coder.inline('always');
+            coder.cinclude('matchFeaturesCore_api.hpp');
+
+            M = cast(size(features,2),'int32');
+            N = cast(size(features,1),'int32');
+
+            if strcmpi(metric, 'hamming')
+                fcnName = 'matchFeaturesIndex_addPoints_uint8';
+            else
+                fcnName = 'matchFeaturesIndex_addPoints_real32';
+            end
+
+            if coder.isColumnMajor
+                coder.ceval('-col', fcnName, ptrObj, features', N, M);
+            else
+                coder.ceval('-row', fcnName, ptrObj, coder.ref(features), N, M);
+            end
+        end
+
+        %------------------------------------------------------------------
+        function [indexPairs, matchMetric] = ...
+                matchFeaturesIndex_search(ptrObj, features1, metric, knn)
+
+            coder.inline('always');
+            coder.cinclude('matchFeaturesCore_api.hpp');
+
+            N1  = cast(size(features1,1),'int32');
+            knn = cast(knn,'int32');
+
+            if strcmpi(metric, 'hamming')
+                fcnName = 'matchFeaturesIndex_search_uint8';
+                metricClass = 'int32';
+            else
+                fcnName = 'matchFeaturesIndex_search_real32';
+                metricClass = 'single';
+            end
+
+            if coder.isColumnMajor
+                indexPairs  = coder.nullcopy(zeros(knn, N1, 'int32'));
+                matchMetric = coder.nullcopy(zeros(knn, N1, metricClass));
+                coder.ceval('-col', fcnName, ptrObj, features1', N1, knn, ...
+                    coder.ref(indexPairs), coder.ref(matchMetric));
+            else
+                indexPairs  = coder.nullcopy(zeros(N1, knn, 'int32'));
+                matchMetric = coder.nullcopy(zeros(N1, knn, metricClass));
+                coder.ceval('-row', fcnName, ptrObj, coder.ref(features1), ...
+                    N1, knn, coder.ref(indexPairs), coder.ref(matchMetric));
+            end
+        end
+
+        %------------------------------------------------------------------
+        % save the index to disk; the features are stored so that they
+        % can be memory-mapped by matchFeaturesIndex_load
+        function success = matchFeaturesIndex_save(ptrObj, filename)
+
+            coder.inline('always');
+            coder.cinclude('matchFeaturesCore_api.hpp');
+
+            success = false;
+            success = coder.ceval('matchFeaturesIndex_save', ptrObj, ...
+                coder.ref([filename char(0)]));
+        end
+
+        %------------------------------------------------------------------
+        function success = matchFeaturesIndex_load(ptrObj, filename)
+
+            coder.inline('always');
+            coder.cinclude('matchFeaturesCore_api.hpp');
+
+            success = false;
+            success = coder.ceval('matchFeaturesIndex_load', ptrObj, ...
+                coder.ref([filename char(0)]));
+        end
+
+        %------------------------------------------------------------------
+        function matchFeaturesIndex_deleteObj(ptrObj)
+
+            coder.inline('always');
+            coder.cinclude('matchFeaturesCore_api.hpp');
+
+            coder.ceval('matchFeaturesIndex_deleteObj', ptrObj);
+        end
+
+        %------------------------------------------------------------------
+        % product-quantized index of single features: numSubspaces bytes
+        % per feature and numLists coarse centers, 0 for a flat index
+        function ptrObj = matchFeaturesPQIndex_construct(numSubspaces, numLists)
+
+            coder.inline('always');
+            coder.cinclude('matchFeaturesCore_api.hpp');
+
+            ptrObj = coder.opaque('void *', 'NULL');
+
+            coder.ceval('matchFeaturesPQIndex_construct', coder.ref(ptrObj), ...
+                int32(numSubspaces), int32(numLists));
+        end
+
+        %------------------------------------------------------------------
+        % train the coarse centers and codebooks on features, e.g. a
+        % sample of the database; the index is emptied
+        function status = matchFeaturesPQIndex_train(ptrObj, features, seed)
+
+            coder.inline('always');
+            coder.cinclude('matchFeaturesCore_api.hpp');
+
+            M = cast(size(features,2),'int32');
+            N = cast(size(features,1),'int32');
+
+            status = int32(0);
+            if coder.isColumnMajor
+                status = coder.ceval('-col', 'matchFeaturesPQIndex_train_real32', ...
+                    ptrObj, features', N, M, uint32(seed));
+            else
+                status = coder.ceval('-row', 'matchFeaturesPQIndex_train_real32', ...
+                    ptrObj, coder.ref(features), N, M, uint32(seed));
+            end
+        end
+
+        %------------------------------------------------------------------
+        function matchFeaturesPQIndex_addPoints(ptrObj, features)
+
+            coder.inline('always');
+            coder.cinclude('matchFeaturesCore_api.hpp');
+
+            N = cast(size(features,1),'int32');
+
+            if coder.isColumnMajor
+                coder.ceval('-col', 'matchFeaturesPQIndex_addPoints_real32', ...
+                    ptrObj, features', N);
+            else
+                coder.ceval('-row', 'matchFeaturesPQIndex_addPoints_real32', ...
+                    ptrObj, coder.ref(features), N);
+            end
+        end
+
+        %------------------------------------------------------------------
+        % indexPairs are 0-based, -1 when the visited lists hold fewer than
+        % knn features; matchMetric approximates 'ssd'
+        function [indexPairs, matchMetric] = ...
+                matchFeaturesPQIndex_search(ptrObj, features1, knn, numProbes)
+
+            coder.inline('always');
+            coder.cinclude('matchFeaturesCore_api.hpp');
+
+            N1  = cast(size(features1,1),'int32');
+            knn = cast(knn,'int32');
+
+            if coder.isColumnMajor
+                indexPairs  = coder.nullcopy(zeros(knn, N1, 'int32'));
+                matchMetric = coder.nullcopy(zeros(knn, N1, 'single'));
+                coder.ceval('-col', 'matchFeaturesPQIndex_search_real32', ...
+                    ptrObj, features1', N1, knn, int32(numProbes), ...
+                    coder.ref(indexPairs), coder.ref(matchMetric));
+            else
+                indexPairs  = coder.nullcopy(zeros(N1, knn, 'int32'));
+                matchMetric = coder.nullcopy(zeros(N1, knn, 'single'));
+                coder.ceval('-row', 'matchFeaturesPQIndex_search_real32', ...
+                    ptrObj, coder.ref(features1), N1, knn, int32(numProbes), ...
+                    coder.ref(indexPairs), coder.ref(matchMetric));
+            end
+        end
+
+        %------------------------------------------------------------------
+        function success = matchFeaturesPQIndex_save(ptrObj, filename)
+
+            coder.inline('always');
+            coder.cinclude('matchFeaturesCore_api.hpp');
+
+            success = false;
+            success = coder.ceval('matchFeaturesPQIndex_save', ptrObj, ...
+                coder.ref([filename char(0)]));
+        end
+
+        %------------------------------------------------------------------
+        function success = matchFeaturesPQIndex_load(ptrObj, filename)
+
+            coder.inline('always');
+            coder.cinclude('matchFeaturesCore_api.hpp');
+
+            success = false;
+            success = coder.ceval('matchFeaturesPQIndex_load', ptrObj, ...
+                coder.ref([filename char(0)]));
+        end
+
+        %------------------------------------------------------------------
+        function n = matchFeaturesPQIndex_getNumFeatures(ptrObj)
+
+            coder.inline('always');
+            coder.cinclude('matchFeaturesCore_api.hpp');
+
+            n = int32(0);
+            n = coder.ceval('matchFeaturesPQIndex_getNumFeatures', ptrObj);
+        end
+
+        %------------------------------------------------------------------
+        function matchFeaturesPQIndex_deleteObj(ptrObj)
+
+            coder.inline('always');
+            coder.cinclude('matchFeaturesCore_api.hpp');
+
+            coder.ceval('matchFeaturesPQIndex_deleteObj', ptrObj);
+        end
+
+        %------------------------------------------------------------------
+        % exhaustive matcher on a CUDA device. Returns a NULL pointer when
+        % the device is not available, in which case the CPU path must be
+        % used
+        function ptrObj = matchFeaturesCuda_construct(device)
+
+            coder.inline('always');
+            coder.cinclude('matchFeaturesCore_api.hpp');
+
+            ptrObj = coder.opaque('void *', 'NULL');
+
+            coder.ceval('matchFeaturesCuda_construct', coder.ref(ptrObj), ...
+                int32(device));
+        end
+
+        %------------------------------------------------------------------
+        % features2 is N2-by-M, single for 'ssd' and 'sad' or uint8 for
+        % 'hamming'
+        function matchFeaturesCuda_setFeatures2(ptrObj, features2, metric)
+
+            coder.inline('always');
+            coder.cinclude('matchFeaturesCore_api.hpp');
+
+            M  = cast(size(features2,2),'int32');
+            N2 = cast(size(features2,1),'int32');
+
+            if strcmpi(metric, 'hamming')
+                if coder.isColumnMajor
+                    coder.ceval('-col', 'matchFeaturesCuda_setFeatures2_uint8', ...
+                        ptrObj, features2', N2, M);
+                else
+                    coder.ceval('-row', 'matchFeaturesCuda_setFeatures2_uint8', ...
+                        ptrObj, coder.ref(features2), N2, M);
+                end
+            else
+                if coder.isColumnMajor
+                    coder.ceval('-col', 'matchFeaturesCuda_setFeatures2_real32', ...
+                        ptrObj, features2', coder.ref([metric char(0)]), N2, M);
+                else
+                    coder.ceval('-row', 'matchFeaturesCuda_setFeatures2_real32', ...
+                        ptrObj, coder.ref(features2), coder.ref([metric char(0)]), N2, M);
+                end
+            end
+        end
+
+        %------------------------------------------------------------------
+        % matches the N1-by-M features1 against features2. indexPairs is
+        % 2-by-numMatches and 1-based, and matchMetric is 1-by-numMatches,
+        % as returned by cvalgMatchFeatures
+        function [indexPairs, matchMetric] = matchFeaturesCuda_match(ptrObj, ...
+                features1, metric, matchThreshold, maxRatio, uniqueMatches)
+
+            coder.inline('always');
+            coder.cinclude('matchFeaturesCore_api.hpp');
+
+            M  = cast(size(features1,2),'int32');
+            N1 = cast(size(features1,1),'int32');
+
+            if strcmpi(metric, 'hamming')
+                fcnName = 'matchFeaturesCuda_match_uint8';
+            else
+                fcnName = 'matchFeaturesCuda_match_real32';
+            end
+
+            queryIdx = coder.nullcopy(zeros(1, N1, 'int32'));
+            trainIdx = coder.nullcopy(zeros(1, N1, 'int32'));
+            metrics  = coder.nullcopy(zeros(1, N1, 'single'));
+            numMatches = int32(0);
+
+            if coder.isColumnMajor
+                numMatches = coder.ceval('-col', fcnName, ptrObj, features1', ...
+                    N1, M, single(matchThreshold), single(maxRatio), ...
+                    logical(uniqueMatches), coder.ref(queryIdx), ...
+                    coder.ref(trainIdx), coder.ref(metrics));
+            else
+                numMatches = coder.ceval('-row', fcnName, ptrObj, ...
+                    coder.ref(features1), N1, M, single(matchThreshold), ...
+                    single(maxRatio), logical(uniqueMatches), coder.ref(queryIdx), ...
+                    coder.ref(trainIdx), coder.ref(metrics));
+            end
+
+            n = double(numMatches);
+            indexPairs  = vertcat(uint32(queryIdx(1:n)) + 1, uint32(trainIdx(1:n)) + 1);
+            matchMetric = metrics(1:n);
+        end
+
+        %------------------------------------------------------------------
+        function matchFeaturesCuda_deleteObj(ptrObj)
+
+            coder.inline('always');
+            coder.cinclude('matchFeaturesCore_api.hpp');
+
+            coder.ceval('matchFeaturesCuda_deleteObj', ptrObj);
+        end
     end
 end
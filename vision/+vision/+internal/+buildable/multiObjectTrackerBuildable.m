@@ -0,0 +1,146 @@
+classdef multiObjectTrackerBuildable < coder.ExternalDependency %#codegen
+    % multiObjectTrackerBuildable - batched Kalman filter tracks of
+    % configureKalmanFilter, assigned with assignDetectionsToTracks
+
+    % Copyright 2016 The MathWorks, Inc.
+
+    methods (Static)
+
+        function name = getDescriptiveName(~)
+            name = 'multiObjectTrackerBuildable';
+        end
+
+        function b = isSupportedContext(~)
+            b = true; % supports non-host target
+        end
+
+        function updateBuildInfo(buildInfo, context)
+            buildInfo.addIncludePaths({fullfile(matlabroot,'toolbox', ...
+                'vision','builtins','src','ocv','include'), ...
+                fullfile(matlabroot,'toolbox', ...
+                'vision','builtins','src','ocvcg', 'opencv', 'include')} );
+            buildInfo.addSourcePaths({fullfile(matlabroot,'toolbox', ...
+                'vision','builtins','src','ocv')});
+            buildInfo.addSourceFiles({'multiObjectTrackerCore.cpp', ...
+                'cgCommon.cpp'});
+            buildInfo.addIncludeFiles({'vision_defines.h', ...
+                                       'multiObjectTrackerCore_api.hpp', ...
+                                       'MultiObjectTracker.hpp', ...
+                                       'AssignmentSolver.hpp', ...
+                                       'cgCommon.hpp'}); % no need 'rtwtypes.h'
+
+            vision.internal.buildable.portableOpenCVBuildInfo(buildInfo, context, ...
+                'multiObjectTracker');
+        end
+
+        %------------------------------------------------------------------
+        function ptrObj = multiObjectTracker_construct()
+
+            coder.inline('always');
+            coder.cinclude('multiObjectTrackerCore_api.hpp');
+
+            ptrObj = coder.opaque('void *', 'NULL');
+
+            coder.ceval('multiObjectTracker_construct', coder.ref(ptrObj));
+        end
+
+        %------------------------------------------------------------------
+        % motionModel, initialEstimateError, motionNoise and
+        % measurementNoise are those of configureKalmanFilter, for
+        % locations of numDims elements. costOfNonAssignment is that of
+        % assignDetectionsToTracks. A track is deleted once invisible for
+        % invisibleForTooLong frames, or when younger than ageThreshold
+        % frames and visible in less than minVisibility of them.
+        function multiObjectTracker_setup(ptrObj, motionModel, numDims, ...
+                initialEstimateError, motionNoise, measurementNoise, ...
+                costOfNonAssignment, invisibleForTooLong, ageThreshold, ...
+                minVisibility)
+
+            coder.inline('always');
+            coder.cinclude('multiObjectTrackerCore_api.hpp');
+
+            isConstantAcceleration = strcmpi(motionModel, 'ConstantAcceleration');
+            estimateError = double(initialEstimateError);
+            noise = double(motionNoise);
+
+            coder.ceval('multiObjectTracker_setup', ptrObj, ...
+                isConstantAcceleration, int32(numDims), ...
+                coder.rref(estimateError), coder.rref(noise), ...
+                double(measurementNoise), double(costOfNonAssignment), ...
+                int32(invisibleForTooLong), int32(ageThreshold), ...
+                double(minVisibility));
+        end
+
+        %------------------------------------------------------------------
+        % detections is M-by-numDims, motionModel and numDims those of
+        % multiObjectTracker_setup. tracks has one row per track: its id,
+        % location, State as that of configureKalmanFilter, age,
+        % visibility counts and the detection of this frame, 0 for none.
+        function tracks = multiObjectTracker_step(ptrObj, detections, ...
+                motionModel, numDims)
+
+            coder.inline('always');
+            coder.cinclude('multiObjectTrackerCore_api.hpp');
+
+            dets = double(detections);
+            numTracks = int32(0);
+            numTracks = coder.ceval('-col', 'multiObjectTracker_step', ptrObj, ...
+                coder.rref(dets), int32(size(dets, 1)));
+
+            n = double(numTracks);
+            if strcmpi(motionModel, 'ConstantAcceleration')
+                lenState = 3*numDims;
+            else
+                lenState = 2*numDims;
+            end
+            coder.varsize('tracks.Id', [inf, 1]);
+            tracks.Id = coder.nullcopy(zeros(n, 1, 'uint32'));
+            coder.varsize('tracks.Location', [inf, inf]);
+            tracks.Location = coder.nullcopy(zeros(n, numDims));
+            coder.varsize('tracks.State', [inf, inf]);
+            tracks.State = coder.nullcopy(zeros(n, lenState));
+            coder.varsize('tracks.Age', [inf, 1]);
+            tracks.Age = coder.nullcopy(zeros(n, 1, 'uint32'));
+            coder.varsize('tracks.TotalVisibleCount', [inf, 1]);
+            tracks.TotalVisibleCount = coder.nullcopy(zeros(n, 1, 'uint32'));
+            coder.varsize('tracks.ConsecutiveInvisibleCount', [inf, 1]);
+            tracks.ConsecutiveInvisibleCount = coder.nullcopy(zeros(n, 1, 'uint32'));
+            coder.varsize('tracks.AssignedDetection', [inf, 1]);
+            tracks.AssignedDetection = coder.nullcopy(zeros(n, 1, 'uint32'));
+
+            if coder.isColumnMajor
+                coder.ceval('-col', 'multiObjectTracker_getTracks', ptrObj, ...
+                    coder.ref(tracks.Id), coder.ref(tracks.Location), ...
+                    coder.ref(tracks.State), coder.ref(tracks.Age), ...
+                    coder.ref(tracks.TotalVisibleCount), ...
+                    coder.ref(tracks.ConsecutiveInvisibleCount), ...
+                    coder.ref(tracks.AssignedDetection));
+            else
+                coder.ceval('-row', 'multiObjectTracker_getTracksRM', ptrObj, ...
+                    coder.ref(tracks.Id), coder.ref(tracks.Location), ...
+                    coder.ref(tracks.State), coder.ref(tracks.Age), ...
+                    coder.ref(tracks.TotalVisibleCount), ...
+                    coder.ref(tracks.ConsecutiveInvisibleCount), ...
+                    coder.ref(tracks.AssignedDetection));
+            end
+        end
+
+        %------------------------------------------------------------------
+        function multiObjectTracker_reset(ptrObj)
+
+            coder.inline('always');
+            coder.cinclude('multiObjectTrackerCore_api.hpp');
+
+            coder.ceval('multiObjectTracker_reset', ptrObj);
+        end
+
+        %------------------------------------------------------------------
+        function multiObjectTracker_deleteObj(ptrObj)
+
+            coder.inline('always');
+            coder.cinclude('multiObjectTrackerCore_api.hpp');
+
+            coder.ceval('multiObjectTracker_deleteObj', ptrObj);
+        end
+    end
+end
@@ -0,0 +1,201 @@
+%#codegen
+%#ok<*EMCA>
+classdef ocrBatchBuildable < coder.ExternalDependency
+    % ocrBatchBuildable - recognition of many regions of ocr with a pool
+    % of Tesseract handles kept across calls
+
+    % Copyright 2016 The MathWorks, Inc.
+
+    methods (Static)
+
+        function name = getDescriptiveName(~)
+            name = 'ocrBatchBuildable';
+        end
+
+        function b = isSupportedContext(context)
+            b = context.isMatlabHostTarget();
+        end
+
+        function updateBuildInfo(buildInfo, context)
+            usesDefaultModname = true;
+            vision.internal.buildable.cvstBuildInfo(buildInfo, context, ...
+                'ocrutils', ...
+                {'use_tesseract','use_leptonica','use_cpp11compat'},...
+                usesDefaultModname);
+
+            buildInfo.addIncludePaths({fullfile(matlabroot,'toolbox', ...
+                'vision','builtins','src','ocv','include')});
+            buildInfo.addSourcePaths({fullfile(matlabroot,'toolbox', ...
+                'vision','builtins','src','ocv')});
+            buildInfo.addSourceFiles({'ocrBatchCore.cpp', ...
+                'cgCommon.cpp'});
+            buildInfo.addIncludeFiles({'vision_defines.h', ...
+                                       'ocrBatchCore_api.hpp', ...
+                                       'OcrHandlePool.hpp', ...
+                                       'cgCommon.hpp', ...
+                                       'cgThreadPool.hpp'}); % no need 'rtwtypes.h'
+        end
+
+        %------------------------------------------------------------------
+        function ptrPool = ocrBatch_construct()
+            coder.inline('always');
+            coder.cinclude('ocrBatchCore_api.hpp');
+
+            ptrPool = coder.opaque('void *', 'NULL');
+            coder.ceval('ocrBatch_construct', coder.ref(ptrPool));
+        end
+
+        %------------------------------------------------------------------
+        % tessOpts are the options of OCRBuildable.tesseract
+        function ocrBatch_setOptions(ptrPool, tessOpts)
+            coder.inline('always');
+            coder.cinclude('ocrBatchCore_api.hpp');
+
+            textLayout   = nullTerminateString(tessOpts.textLayout);
+            characterSet = nullTerminateString(tessOpts.characterSet);
+            tessdata     = nullTerminateString(tessOpts.tessdata);
+            lang         = nullTerminateString(tessOpts.lang);
+
+            coder.ceval('ocrBatch_setOptions', ptrPool, ...
+                coder.rref(textLayout), coder.rref(characterSet), ...
+                coder.rref(tessdata), coder.rref(lang));
+        end
+
+        %------------------------------------------------------------------
+        % I is a uint8 or logical image and roi an M-by-4 matrix of
+        % regions, empty for the whole image. regionInfo is M-by-8, see
+        % ocrBatchCore_api.hpp: the UTF-8 text and the metadata text of
+        % region i are the regionInfo(i,2) and regionInfo(i,3) bytes of
+        % utf8Text after those of the regions before it, and the rows of
+        % each field of ocrMetadata are those of the regions in turn.
+        function [regionInfo, utf8Text, ocrMetadata] = ocrBatch_recognize(ptrPool, I, roi)
+            coder.inline('always');
+            coder.cinclude('ocrBatchCore_api.hpp');
+
+            numRows = int32(size(I, 1));
+            numCols = int32(size(I, 2));
+            rois = int32(roi);
+            numRois = int32(size(rois, 1));
+
+            totals = zeros(1, 6, 'int32');
+            ptrResult = coder.opaque('void *', 'NULL');
+            status = int32(0);
+
+            if islogical(I)
+                fcnName = 'ocrBatch_recognizeLogical';
+            else
+                fcnName = 'ocrBatch_recognizeUint8';
+            end
+
+            if coder.isColumnMajor
+                status = coder.ceval('-col', fcnName, ptrPool, ...
+                    coder.rref(I), numRows, numCols, coder.rref(rois), ...
+                    numRois, coder.ref(totals), coder.ref(ptrResult));
+            else
+                status = coder.ceval('-row', [fcnName 'RM'], ptrPool, ...
+                    coder.rref(I), numRows, numCols, coder.rref(rois), ...
+                    numRois, coder.ref(totals), coder.ref(ptrResult));
+            end
+
+            numRegions = max(double(numRois), 1);
+            numChars      = double(totals(2));
+            numWords      = double(totals(3));
+            numTextlines  = double(totals(4));
+            numParagraphs = double(totals(5));
+            numBlocks     = double(totals(6));
+
+            coder.varsize('regionInfo', [inf, 8]);
+            regionInfo = coder.nullcopy(zeros(numRegions, 8, 'int32'));
+            coder.varsize('utf8Text', [1, inf]);
+            utf8Text = coder.nullcopy(zeros(1, double(totals(1)), 'uint8'));
+
+            charBBox       = coder.nullcopy(zeros(numChars, 4));
+            charWordIndex  = coder.nullcopy(zeros(numChars, 1,'int32'));
+            charConfidence = coder.nullcopy(zeros(numChars, 1,'single'));
+
+            wordBBox           = coder.nullcopy(zeros(numWords, 4));
+            wordTextLineIndex  = coder.nullcopy(zeros(numWords, 1,'int32'));
+            wordConfidence     = coder.nullcopy(zeros(numWords, 1,'single'));
+            wordCharacterIndex = coder.nullcopy(zeros(numWords, 2,'int32'));
+
+            textlineBBox           = coder.nullcopy(zeros(numTextlines, 4));
+            textlineParagraphIndex = coder.nullcopy(zeros(numTextlines, 1,'int32'));
+            textlineConfidence     = coder.nullcopy(zeros(numTextlines, 1,'single'));
+            textlineCharacterIndex = coder.nullcopy(zeros(numTextlines, 2,'int32'));
+
+            paragraphBBox           = coder.nullcopy(zeros(numParagraphs, 4));
+            paragraphBlockIndex     = coder.nullcopy(zeros(numParagraphs, 1,'int32'));
+            paragraphConfidence     = coder.nullcopy(zeros(numParagraphs, 1,'single'));
+            paragraphCharacterIndex = coder.nullcopy(zeros(numParagraphs, 2,'int32'));
+
+            blockBBox           = coder.nullcopy(zeros(numBlocks, 4));
+            blockPageIndex      = coder.nullcopy(zeros(numBlocks, 1,'int32'));
+            blockConfidence     = coder.nullcopy(zeros(numBlocks, 1,'single'));
+            blockCharacterIndex = coder.nullcopy(zeros(numBlocks, 2,'int32'));
+
+            if coder.isColumnMajor
+                coder.ceval('-col', 'ocrBatch_assignOutputDelete', ptrResult, ...
+                    coder.ref(regionInfo), coder.ref(utf8Text), ...
+                    coder.ref(charBBox), coder.ref(charWordIndex),  coder.ref(charConfidence),...
+                    coder.ref(wordBBox), coder.ref(wordTextLineIndex), coder.ref(wordConfidence), coder.ref(wordCharacterIndex),...
+                    coder.ref(textlineBBox), coder.ref(textlineParagraphIndex), coder.ref(textlineConfidence), coder.ref(textlineCharacterIndex),...
+                    coder.ref(paragraphBBox), coder.ref(paragraphBlockIndex), coder.ref(paragraphConfidence), coder.ref(paragraphCharacterIndex),...
+                    coder.ref(blockBBox), coder.ref(blockPageIndex), coder.ref(blockConfidence), coder.ref(blockCharacterIndex));
+            else
+                coder.ceval('-row', 'ocrBatch_assignOutputDeleteRM', ptrResult, ...
+                    coder.ref(regionInfo), coder.ref(utf8Text), ...
+                    coder.ref(charBBox), coder.ref(charWordIndex),  coder.ref(charConfidence),...
+                    coder.ref(wordBBox), coder.ref(wordTextLineIndex), coder.ref(wordConfidence), coder.ref(wordCharacterIndex),...
+                    coder.ref(textlineBBox), coder.ref(textlineParagraphIndex), coder.ref(textlineConfidence), coder.ref(textlineCharacterIndex),...
+                    coder.ref(paragraphBBox), coder.ref(paragraphBlockIndex), coder.ref(paragraphConfidence), coder.ref(paragraphCharacterIndex),...
+                    coder.ref(blockBBox), coder.ref(blockPageIndex), coder.ref(blockConfidence), coder.ref(blockCharacterIndex));
+            end
+
+            % same errors as OCRBuildable.tesseract
+            coder.internal.errorIf(status == int32(-1),...
+                'vision:ocr:codegenInitFailure');
+            coder.internal.errorIf(status == int32(-2), ...
+                'vision:ocr:codegenMemAllocFailure');
+            coder.internal.errorIf(status == int32(-3), ...
+                'vision:ocr:codegenInternalError');
+
+            ocrMetadata.CharacterBBox = charBBox;
+            ocrMetadata.CharacterWordIndex = charWordIndex;
+            ocrMetadata.CharacterConfidence = charConfidence;
+
+            ocrMetadata.WordBBox = wordBBox;
+            ocrMetadata.WordTextLineIndex = wordTextLineIndex;
+            ocrMetadata.WordConfidence = wordConfidence;
+            ocrMetadata.WordCharacterIndex = wordCharacterIndex;
+
+            ocrMetadata.TextLineBBox = textlineBBox;
+            ocrMetadata.TextLineParagraphIndex = textlineParagraphIndex;
+            ocrMetadata.TextLineConfidence = textlineConfidence;
+            ocrMetadata.TextLineCharacterIndex = textlineCharacterIndex;
+
+            ocrMetadata.ParagraphBBox = paragraphBBox;
+            ocrMetadata.ParagraphBlockIndex = paragraphBlockIndex;
+            ocrMetadata.ParagraphConfidence = paragraphConfidence;
+            ocrMetadata.ParagraphCharacterIndex = paragraphCharacterIndex;
+
+            ocrMetadata.BlockBBox = blockBBox;
+            ocrMetadata.BlockPageIndex = blockPageIndex;
+            ocrMetadata.BlockConfidence = blockConfidence;
+            ocrMetadata.BlockCharacterIndex = blockCharacterIndex;
+        end
+
+        %------------------------------------------------------------------
+        function ocrBatch_deleteObj(ptrPool)
+            coder.inline('always');
+            coder.cinclude('ocrBatchCore_api.hpp');
+
+            coder.ceval('ocrBatch_deleteObj', ptrPool);
+        end
+    end
+end
+
+% -------------------------------------------------------------------------
+function strout = nullTerminateString(strin)
+coder.inline('always');
+strout = [strin uint8(0)];
+end
@@ -25,6 +25,15 @@ classdef opticalFlowFarnebackBuildable < coder.ExternalDependency %#codegen
             buildInfo.addSourceFiles({'opticalFlowFarnebackCore.cpp', 'cgCommon.cpp'});
             buildInfo.addIncludeFiles({'vision_defines.h', ...
                                        'cgCommon.hpp', ...
+                                       'cgThreadPool.hpp', ...
+                                       'cgResultPool.hpp', ...
+                                       'cgPyramidCache.hpp', ...
+                                       'cgIntegralImage.hpp', ...
+                                       'cgPipeline.hpp', ...
+                                       'mwtranspose.hpp', ...
+                                       'OpticalFlowFarnebackOcv.hpp', ...
+                                       'OpticalFlowFarnebackCuda.hpp', ...
+                                       'ImageHandle.hpp', ...
                                        'opticalFlowFarnebackCore_api.hpp'}); % no need 'rtwtypes.h'
 
             vision.internal.buildable.portableOpenCVBuildInfo(buildInfo, context, ...
@@ -87,5 +96,208 @@ classdef opticalFlowFarnebackBuildable < coder.ExternalDependency %#codegen
                       );                
             end
         end
+
+        %------------------------------------------------------------------
+        % stateful flow: the previous frame and the last flow are kept
+        % across frames, and the last flow is the initial estimate
+        function ptrObj = opticalFlowFarneback_construct()
+
+            coder.inline('always');
+            coder.cinclude('opticalFlowFarnebackCore_api.hpp');
+
+            ptrObj = coder.opaque('void *', 'NULL');
+
+            % call function from shared library
+            coder.ceval('opticalFlowFarneback_construct', coder.ref(ptrObj));
+        end
+
+        %------------------------------------------------------------------
+        % ImageCurr is transposed for column major code, as in compute
+        function outFlowXY = opticalFlowFarneback_step(ptrObj, ImageCurr, params)
+
+            coder.inline('always');
+            coder.cinclude('opticalFlowFarnebackCore_api.hpp');
+
+            paramStruct = struct( ...
+                'pyr_scale', double(params.pyr_scale), ...
+                'poly_sigma',double(params.poly_sigma), ...
+                'levels',    int32(params.levels), ...
+                'winsize',   int32(params.winsize), ...
+                'iterations',int32(params.iterations), ...
+                'poly_n',    int32(params.poly_n), ...
+                'flags',     int32(params.flags));
+
+            coder.cstructname(paramStruct,'cvstFarnebackStruct_T');
+
+            if coder.isColumnMajor
+                nRows = size(ImageCurr, 2);
+                nCols = size(ImageCurr, 1);
+
+                outFlowXY = coder.nullcopy(zeros([nRows nCols 2],'single'));
+
+                coder.ceval('-col', 'opticalFlowFarneback_step', ptrObj, ...
+                  coder.ref(ImageCurr), ...
+                  coder.ref(outFlowXY), ...
+                  coder.ref(paramStruct), ...
+                        int32(nRows), ...
+                        int32(nCols) ...
+                      );
+            else
+                nRows = size(ImageCurr, 1);
+                nCols = size(ImageCurr, 2);
+
+                outFlowXY = coder.nullcopy(zeros([nRows nCols 2],'single'));
+
+                coder.ceval('-row', 'opticalFlowFarneback_stepRM', ptrObj, ...
+                  coder.ref(ImageCurr), ...
+                  coder.ref(outFlowXY), ...
+                  coder.ref(paramStruct), ...
+                        int32(nRows), ...
+                        int32(nCols) ...
+                      );
+            end
+        end
+
+        %------------------------------------------------------------------
+        % computes the flow on the given CUDA device when it is available,
+        % and on the CPU otherwise
+        function ptrObj = opticalFlowFarneback_constructOnDevice(device)
+
+            coder.inline('always');
+            coder.cinclude('opticalFlowFarnebackCore_api.hpp');
+
+            ptrObj = coder.opaque('void *', 'NULL');
+
+            coder.ceval('opticalFlowFarneback_constructOnDevice', ...
+                coder.ref(ptrObj), int32(device));
+        end
+
+        %------------------------------------------------------------------
+        function isOnDevice = opticalFlowFarneback_isOnDevice(ptrObj)
+
+            coder.inline('always');
+            coder.cinclude('opticalFlowFarnebackCore_api.hpp');
+
+            isOnDevice = false;
+            isOnDevice = coder.ceval('opticalFlowFarneback_isOnDevice', ptrObj);
+        end
+
+        %------------------------------------------------------------------
+        % queues the flow to ImageCurr, transposed for column major code as
+        % in step; opticalFlowFarneback_getFlow returns it
+        function opticalFlowFarneback_submit(ptrObj, ImageCurr, params)
+
+            coder.inline('always');
+            coder.cinclude('opticalFlowFarnebackCore_api.hpp');
+
+            paramStruct = struct( ...
+                'pyr_scale', double(params.pyr_scale), ...
+                'poly_sigma',double(params.poly_sigma), ...
+                'levels',    int32(params.levels), ...
+                'winsize',   int32(params.winsize), ...
+                'iterations',int32(params.iterations), ...
+                'poly_n',    int32(params.poly_n), ...
+                'flags',     int32(params.flags));
+
+            coder.cstructname(paramStruct,'cvstFarnebackStruct_T');
+
+            if coder.isColumnMajor
+                nRows = size(ImageCurr, 2);
+                nCols = size(ImageCurr, 1);
+            else
+                nRows = size(ImageCurr, 1);
+                nCols = size(ImageCurr, 2);
+            end
+
+            coder.ceval('opticalFlowFarneback_submit', ptrObj, ...
+                coder.ref(ImageCurr), coder.ref(paramStruct), ...
+                int32(nRows), int32(nCols));
+        end
+
+        %------------------------------------------------------------------
+        % flow of the oldest frame submitted; imageSize is the [rows cols]
+        % of the flow, as returned by step
+        function [outFlowXY, isValid] = opticalFlowFarneback_getFlow(ptrObj, imageSize)
+
+            coder.inline('always');
+            coder.cinclude('opticalFlowFarnebackCore_api.hpp');
+
+            outFlowXY = coder.nullcopy(zeros([imageSize(1) imageSize(2) 2],'single'));
+            isValid = false;
+
+            if coder.isColumnMajor
+                isValid = coder.ceval('-col', 'opticalFlowFarneback_getFlow', ...
+                    ptrObj, coder.ref(outFlowXY));
+            else
+                isValid = coder.ceval('-row', 'opticalFlowFarneback_getFlowRM', ...
+                    ptrObj, coder.ref(outFlowXY));
+            end
+        end
+
+        %------------------------------------------------------------------
+        % step and submit on the image of an imageHandleBuildable handle;
+        % imageSize is the size of the image and the flow is laid out as
+        % that of step
+        function outFlowXY = opticalFlowFarneback_stepImage(ptrObj, ptrImage, imageSize, params)
+
+            coder.inline('always');
+            coder.cinclude('opticalFlowFarnebackCore_api.hpp');
+
+            paramStruct = farnebackParamStruct(params);
+
+            if coder.isColumnMajor
+                outFlowXY = coder.nullcopy(zeros([imageSize(2) imageSize(1) 2],'single'));
+            else
+                outFlowXY = coder.nullcopy(zeros([imageSize(1) imageSize(2) 2],'single'));
+            end
+
+            coder.ceval('opticalFlowFarneback_stepImage', ptrObj, ptrImage, ...
+                coder.ref(outFlowXY), coder.ref(paramStruct));
+        end
+
+        %------------------------------------------------------------------
+        function opticalFlowFarneback_submitImage(ptrObj, ptrImage, params)
+
+            coder.inline('always');
+            coder.cinclude('opticalFlowFarnebackCore_api.hpp');
+
+            paramStruct = farnebackParamStruct(params);
+
+            coder.ceval('opticalFlowFarneback_submitImage', ptrObj, ptrImage, ...
+                coder.ref(paramStruct));
+        end
+
+        %------------------------------------------------------------------
+        function opticalFlowFarneback_reset(ptrObj)
+
+            coder.inline('always');
+            coder.cinclude('opticalFlowFarnebackCore_api.hpp');
+
+            coder.ceval('opticalFlowFarneback_reset', ptrObj);
+        end
+
+        %------------------------------------------------------------------
+        function opticalFlowFarneback_deleteObj(ptrObj)
+
+            coder.inline('always');
+            coder.cinclude('opticalFlowFarnebackCore_api.hpp');
+
+            coder.ceval('opticalFlowFarneback_deleteObj', ptrObj);
+        end
     end
 end
+
+%--------------------------------------------------------------------------
+function paramStruct = farnebackParamStruct(params)
+
+paramStruct = struct( ...
+    'pyr_scale', double(params.pyr_scale), ...
+    'poly_sigma',double(params.poly_sigma), ...
+    'levels',    int32(params.levels), ...
+    'winsize',   int32(params.winsize), ...
+    'iterations',int32(params.iterations), ...
+    'poly_n',    int32(params.poly_n), ...
+    'flags',     int32(params.flags));
+
+coder.cstructname(paramStruct,'cvstFarnebackStruct_T');
+end
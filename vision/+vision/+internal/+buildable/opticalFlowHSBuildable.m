@@ -23,6 +23,9 @@ classdef opticalFlowHSBuildable < coder.ExternalDependency %#codegen
             buildInfo.addIncludeFiles({'vision_defines.h', ...
                                        'opticalFlowHSCore_api.hpp', ...
                                        'opticalFlowHS.hpp', ...
+                                       'opticalFlowHS_RedBlack.hpp', ...
+                                       'opticalFlowHS_Fixpt.hpp', ...
+                                       'opticalFlowPyramid.hpp', ...
                                        'opticalFlowHS_Sobel.hpp'});
         end
 
@@ -68,5 +71,85 @@ classdef opticalFlowHSBuildable < coder.ExternalDependency %#codegen
                   );
 
         end       
+
+        %------------------------------------------------------------------
+        % red-black Gauss-Seidel solver: the columns are updated in
+        % parallel and no velocity line buffers are needed
+        function [outVelReal, outVelImag] = ...
+                 opticalFlowHS_computeRB( ...
+         			tmpImageA, ImageB, ...
+					pBuffCprev, pBuffCnext, pBuffRprev, pBuffRnext, ...
+					pGradCC, pGradRC, pGradRR, pGradCT, pGradRT, ...
+					pAlpha, ...
+					Smoothness, ... % Smoothness is Lambda
+					useMaxIter, useMaxAllowableAbsDiffVel, ... 
+					MaxIter, MaxAllowableAbsDiffVel ...
+                  )    
+            
+            coder.cinclude('opticalFlowHSCore_api.hpp');
+            
+            coder.inline('always');
+    
+            % call function
+            outVelReal = zeros(size(tmpImageA), 'like', pBuffCprev);
+            outVelImag = zeros(size(tmpImageA), 'like', pBuffCprev);
+            
+            pInRows = int32(size(tmpImageA,1));
+            pInCols = int32(size(tmpImageA,2));
+            fcnName = ['MWCV_OpticalFlow_HS_RB_' class(tmpImageA)];
+            coder.ceval(fcnName,...
+              coder.ref(tmpImageA), ...
+              coder.ref(ImageB), ...
+              coder.ref(outVelReal), ...
+              coder.ref(outVelImag), ...
+              coder.ref(pBuffCprev), coder.ref(pBuffCnext), coder.ref(pBuffRprev), coder.ref(pBuffRnext), ...
+			  coder.ref(pGradCC), coder.ref(pGradRC), coder.ref(pGradRR), coder.ref(pGradCT), coder.ref(pGradRT), ...
+			  coder.ref(pAlpha), ...
+					coder.ref(Smoothness), ... % Smoothness is Lambda
+					useMaxIter, useMaxAllowableAbsDiffVel, ...
+					coder.ref(MaxIter), coder.ref(MaxAllowableAbsDiffVel), ...
+                    pInRows, pInCols ...
+                  );
+
+        end       
+
+        %------------------------------------------------------------------
+        % coarse-to-fine flow on a pyramid of at most NumPyramidLevels
+        % levels; each level runs the red-black solver with the given
+        % stopping criteria and the temporary buffers are allocated by the
+        % library
+        function [outVelReal, outVelImag] = ...
+                 opticalFlowHS_computePyr( ...
+         			tmpImageA, ImageB, ...
+					Smoothness, ... % Smoothness is Lambda
+					useMaxIter, useMaxAllowableAbsDiffVel, ... 
+					MaxIter, MaxAllowableAbsDiffVel, ...
+                    NumPyramidLevels ...
+                  )    
+            
+            coder.cinclude('opticalFlowHSCore_api.hpp');
+            
+            coder.inline('always');
+    
+            % call function
+            outVelReal = zeros(size(tmpImageA), 'like', Smoothness);
+            outVelImag = zeros(size(tmpImageA), 'like', Smoothness);
+            
+            pInRows = int32(size(tmpImageA,1));
+            pInCols = int32(size(tmpImageA,2));
+            fcnName = ['MWCV_OpticalFlow_HS_Pyr_' class(tmpImageA)];
+            coder.ceval(fcnName,...
+              coder.ref(tmpImageA), ...
+              coder.ref(ImageB), ...
+              coder.ref(outVelReal), ...
+              coder.ref(outVelImag), ...
+					coder.ref(Smoothness), ... % Smoothness is Lambda
+					useMaxIter, useMaxAllowableAbsDiffVel, ...
+					coder.ref(MaxIter), coder.ref(MaxAllowableAbsDiffVel), ...
+                    int32(NumPyramidLevels), ...
+                    pInRows, pInCols ...
+                  );
+
+        end       
     end   
 end
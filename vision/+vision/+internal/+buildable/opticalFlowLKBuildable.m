@@ -22,7 +22,10 @@ classdef opticalFlowLKBuildable < coder.ExternalDependency %#codegen
             buildInfo.addSourceFiles({'opticalFlowLKCore.cpp'});
             buildInfo.addIncludeFiles({'vision_defines.h', ...
                                        'opticalFlowLKCore_api.hpp', ...
-                                       'opticalFlowLK.hpp'});                                      
+                                       'opticalFlowLK.hpp', ...
+                                       'opticalFlowPyramid.hpp', ...
+                                       'opticalFlowLK_Fused.hpp', ...
+                                       'opticalFlowLK_Fixpt.hpp'});                                      
         end
 
         %------------------------------------------------------------------
@@ -55,5 +58,66 @@ classdef opticalFlowLKBuildable < coder.ExternalDependency %#codegen
               pInRows, pInCols ...
                   );
         end       
+
+        %------------------------------------------------------------------
+        % coarse-to-fine flow on a pyramid of at most NumPyramidLevels
+        % levels; the temporary buffers are allocated by the library
+        function [outVelReal, outVelImag] = ...
+                 opticalFlowLK_computePyr( ...
+         			tmpImageA, ImageB, ...
+				    NoiseThreshold, NumPyramidLevels ...
+                  )        
+            
+            coder.inline('always');
+            coder.cinclude('opticalFlowLKCore_api.hpp');
+    
+            % call function
+            outVelReal = zeros(size(tmpImageA), 'like', NoiseThreshold);
+            outVelImag = zeros(size(tmpImageA), 'like', NoiseThreshold);
+            
+            pInRows = int32(size(tmpImageA,1));
+            pInCols = int32(size(tmpImageA,2));
+            fcnName = ['MWCV_OpticalFlow_LK_Pyr_' class(tmpImageA)];
+            coder.ceval(fcnName,...
+              coder.ref(tmpImageA), ...
+              coder.ref(ImageB), ...
+              coder.ref(outVelReal), ...
+              coder.ref(outVelImag), ...
+			  coder.ref(NoiseThreshold), ...
+              int32(NumPyramidLevels), ...
+              pInRows, pInCols ...
+                  );
+        end       
+
+        %------------------------------------------------------------------
+        % single pass over the columns; only a line buffer of 30 columns
+        % of the image height is needed instead of the gradient buffers
+        function [outVelReal, outVelImag] = ...
+                 opticalFlowLK_computeFused( ...
+         			tmpImageA, ImageB, ...
+				    NoiseThreshold ...
+                  )        
+            
+            coder.inline('always');
+            coder.cinclude('opticalFlowLKCore_api.hpp');
+    
+            % call function
+            outVelReal = zeros(size(tmpImageA), 'like', NoiseThreshold);
+            outVelImag = zeros(size(tmpImageA), 'like', NoiseThreshold);
+            lineBuffer = zeros(30*size(tmpImageA,1), 1, 'like', NoiseThreshold);
+            
+            pInRows = int32(size(tmpImageA,1));
+            pInCols = int32(size(tmpImageA,2));
+            fcnName = ['MWCV_OpticalFlow_LK_Fused_' class(tmpImageA)];
+            coder.ceval(fcnName,...
+              coder.ref(tmpImageA), ...
+              coder.ref(ImageB), ...
+              coder.ref(outVelReal), ...
+              coder.ref(outVelImag), ...
+              coder.ref(lineBuffer), ...
+			  coder.ref(NoiseThreshold), ...
+              pInRows, pInCols ...
+                  );
+        end       
     end   
-end
\ No newline at end of file
+end
@@ -23,6 +23,7 @@ classdef opticalFlowLKDoGBuildable < coder.ExternalDependency %#codegen
             buildInfo.addIncludeFiles({'vision_defines.h', ...
                                        'opticalFlowLKDoGCore_api.hpp', ...
                                        'opticalFlowLKDoG.hpp', ...
+                                       'opticalFlowLKDoG_stream.hpp', ...
                                        'opticalFlowLKDoG_convt.hpp', ...
                                        'opticalFlowLKDoG_convx.hpp', ...
                                        'opticalFlowLKDoG_convy.hpp'});                                      
@@ -72,5 +73,75 @@ classdef opticalFlowLKDoGBuildable < coder.ExternalDependency %#codegen
               includeNormalFlow);
 
         end       
+
+        %------------------------------------------------------------------
+        % streaming mode: each frame is filtered spatially once and the
+        % filtered frames are kept by the library, so no delay buffer is
+        % passed
+        function ptrObj = opticalFlowLKDoG_construct( ...
+                    tmpImageA, ...
+					tGradKernel, sGradKernel, tKernel, sKernel, wKernel)
+
+            coder.inline('always');
+            coder.cinclude('opticalFlowLKDoGCore_api.hpp');
+
+            ptrObj = coder.opaque('void *', 'NULL');
+
+            pInRows = int32(size(tmpImageA,1));
+            pInCols = int32(size(tmpImageA,2));
+            tGradKernelLen = int32(length(tGradKernel));
+            sGradKernelLen = int32(length(sGradKernel));
+            tKernelLen = int32(length(tKernel));
+            sKernelLen = int32(length(sKernel));
+            wKernelLen = int32(length(wKernel));
+
+            fcnName = ['MWCV_OpticalFlow_LKDoG_Stream_construct_' class(tmpImageA)];
+            coder.ceval(fcnName, coder.ref(ptrObj), ...
+              coder.ref(tGradKernel),coder.ref(sGradKernel),coder.ref(tKernel),coder.ref(sKernel), coder.ref(wKernel), ...
+              pInRows, pInCols, ...
+			  tGradKernelLen, sGradKernelLen, tKernelLen, sKernelLen, wKernelLen);
+        end
+
+        %------------------------------------------------------------------
+        function [outVelReal, outVelImag] = ...
+                 opticalFlowLKDoG_step(ptrObj, tmpImageA, ...
+					NoiseThreshold, discardIllConditionedEstimates)
+
+            coder.inline('always');
+            coder.cinclude('opticalFlowLKDoGCore_api.hpp');
+
+            outVelReal = zeros(size(tmpImageA), 'like', NoiseThreshold);
+            outVelImag = zeros(size(tmpImageA), 'like', NoiseThreshold);
+            includeNormalFlow = ~discardIllConditionedEstimates;
+
+            fcnName = ['MWCV_OpticalFlow_LKDoG_Stream_step_' class(tmpImageA)];
+            coder.ceval(fcnName, ptrObj, ...
+              coder.ref(tmpImageA), ...
+              coder.ref(outVelReal), ...
+              coder.ref(outVelImag), ...
+			  coder.ref(NoiseThreshold), ... %eigTh
+              includeNormalFlow);
+        end
+
+        %------------------------------------------------------------------
+        function opticalFlowLKDoG_reset(ptrObj, tmpImageA)
+
+            coder.inline('always');
+            coder.cinclude('opticalFlowLKDoGCore_api.hpp');
+
+            fcnName = ['MWCV_OpticalFlow_LKDoG_Stream_reset_' class(tmpImageA)];
+            coder.ceval(fcnName, ptrObj);
+        end
+
+        %------------------------------------------------------------------
+        % tmpImageA selects the data type of the object
+        function opticalFlowLKDoG_deleteObj(ptrObj, tmpImageA)
+
+            coder.inline('always');
+            coder.cinclude('opticalFlowLKDoGCore_api.hpp');
+
+            fcnName = ['MWCV_OpticalFlow_LKDoG_Stream_deleteObj_' class(tmpImageA)];
+            coder.ceval(fcnName, ptrObj);
+        end       
     end   
 end
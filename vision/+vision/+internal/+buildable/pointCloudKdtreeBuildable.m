@@ -0,0 +1,157 @@
+classdef pointCloudKdtreeBuildable < coder.ExternalDependency %#codegen
+    % pointCloudKdtreeBuildable - exact kd-tree over the points of a point
+    % cloud, for the nearest neighbor and radius searches of pointCloud
+
+    % Copyright 2016 The MathWorks, Inc.
+
+    methods (Static)
+
+        function name = getDescriptiveName(~)
+            name = 'pointCloudKdtreeBuildable';
+        end
+
+        function b = isSupportedContext(~)
+            b = true; % supports non-host target
+        end
+
+        function updateBuildInfo(buildInfo, context)
+            buildInfo.addIncludePaths({fullfile(matlabroot,'toolbox', ...
+                'vision','builtins','src','ocv','include'), ...
+                fullfile(matlabroot,'toolbox', ...
+                'vision','builtins','src','ocvcg', 'opencv', 'include')} );
+            buildInfo.addSourcePaths({fullfile(matlabroot,'toolbox', ...
+                'vision','builtins','src','ocv')});
+            buildInfo.addSourceFiles({'pointCloudKdtreeCore.cpp', ...
+                'cgCommon.cpp'});
+            buildInfo.addIncludeFiles({'vision_defines.h', ...
+                                       'pointCloudKdtreeCore_api.hpp', ...
+                                       'PointCloudKdtree.hpp', ...
+                                       'cgCommon.hpp', ...
+                                       'cgThreadPool.hpp'}); % no need 'rtwtypes.h'
+
+            vision.internal.buildable.portableOpenCVBuildInfo(buildInfo, context, ...
+                'pointCloudKdtree');
+        end
+
+        %------------------------------------------------------------------
+        % the tree is kept by the point cloud and rebuilt by
+        % pointCloudKdtree_index when its Location changes
+        function ptrKdtree = pointCloudKdtree_construct(location)
+
+            coder.inline('always');
+            coder.cinclude('pointCloudKdtreeCore_api.hpp');
+
+            ptrKdtree = coder.opaque('void *', 'NULL');
+
+            coder.ceval(['pointCloudKdtree_construct' typeSuffix(location)], ...
+                coder.ref(ptrKdtree));
+        end
+
+        %------------------------------------------------------------------
+        % location is M-by-3 single or double
+        function pointCloudKdtree_index(ptrKdtree, location)
+
+            coder.inline('always');
+            coder.cinclude('pointCloudKdtreeCore_api.hpp');
+
+            numPoints = int32(size(location, 1));
+            fcnName = ['pointCloudKdtree_index' typeSuffix(location)];
+
+            if coder.isColumnMajor
+                coder.ceval('-col', fcnName, ptrKdtree, ...
+                    coder.rref(location), numPoints);
+            else
+                coder.ceval('-row', [fcnName 'RM'], ptrKdtree, ...
+                    coder.rref(location), numPoints);
+            end
+        end
+
+        %------------------------------------------------------------------
+        % points is N-by-3 of the class of the location. indices and dists
+        % are K-by-N, dists squared; only the first valid(n) rows of column
+        % n are neighbors.
+        function [indices, dists, valid] = pointCloudKdtree_knnSearch( ...
+                ptrKdtree, points, K, maxLeafChecks)
+
+            coder.inline('always');
+            coder.cinclude('pointCloudKdtreeCore_api.hpp');
+
+            numQueries = int32(size(points, 1));
+            K = int32(K);
+            indices = coder.nullcopy(zeros(K, numQueries, 'uint32'));
+            dists = coder.nullcopy(zeros(K, numQueries, 'like', points));
+            valid = coder.nullcopy(zeros(numQueries, 1, 'uint32'));
+
+            fcnName = ['pointCloudKdtree_knnSearch' typeSuffix(points)];
+
+            if coder.isColumnMajor
+                coder.ceval('-col', fcnName, ptrKdtree, ...
+                    coder.rref(points), numQueries, K, int32(maxLeafChecks), ...
+                    coder.ref(indices), coder.ref(dists), coder.ref(valid));
+            else
+                coder.ceval('-row', [fcnName 'RM'], ptrKdtree, ...
+                    coder.rref(points), numQueries, K, int32(maxLeafChecks), ...
+                    coder.ref(indices), coder.ref(dists), coder.ref(valid));
+            end
+        end
+
+        %------------------------------------------------------------------
+        % indices and dists are column vectors of the neighbors of each
+        % query in turn, valid(n) of them for query n; dists squared
+        function [indices, dists, valid] = pointCloudKdtree_radiusSearch( ...
+                ptrKdtree, points, radius, maxLeafChecks, doSort)
+
+            coder.inline('always');
+            coder.cinclude('pointCloudKdtreeCore_api.hpp');
+
+            numQueries = int32(size(points, 1));
+            valid = coder.nullcopy(zeros(numQueries, 1, 'uint32'));
+            ptrResult = coder.opaque('void *', 'NULL');
+
+            suffix = typeSuffix(points);
+            fcnName = ['pointCloudKdtree_radiusSearch' suffix];
+
+            if coder.isColumnMajor
+                coder.ceval('-col', fcnName, ptrKdtree, ...
+                    coder.rref(points), numQueries, cast(radius, 'like', points), ...
+                    int32(maxLeafChecks), logical(doSort), coder.ref(valid), ...
+                    coder.ref(ptrResult));
+            else
+                coder.ceval('-row', [fcnName 'RM'], ptrKdtree, ...
+                    coder.rref(points), numQueries, cast(radius, 'like', points), ...
+                    int32(maxLeafChecks), logical(doSort), coder.ref(valid), ...
+                    coder.ref(ptrResult));
+            end
+
+            numNeighbors = sum(double(valid));
+            coder.varsize('indices', [inf, 1]);
+            coder.varsize('dists', [inf, 1]);
+            indices = coder.nullcopy(zeros(numNeighbors, 1, 'uint32'));
+            dists = coder.nullcopy(zeros(numNeighbors, 1, 'like', points));
+
+            coder.ceval(['pointCloudKdtree_assignRadiusOutputDelete' suffix], ...
+                ptrResult, coder.ref(indices), coder.ref(dists));
+        end
+
+        %------------------------------------------------------------------
+        % location is only used for its class
+        function pointCloudKdtree_deleteObj(ptrKdtree, location)
+
+            coder.inline('always');
+            coder.cinclude('pointCloudKdtreeCore_api.hpp');
+
+            coder.ceval(['pointCloudKdtree_deleteObj' typeSuffix(location)], ...
+                ptrKdtree);
+        end
+    end
+end
+
+% -------------------------------------------------------------------------
+function suffix = typeSuffix(x)
+coder.inline('always');
+if isa(x, 'double')
+    suffix = '';
+else
+    suffix = '_single';
+end
+end
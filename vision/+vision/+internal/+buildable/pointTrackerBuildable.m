@@ -27,9 +27,17 @@ classdef pointTrackerBuildable < coder.ExternalDependency %#codegen
             buildInfo.addIncludeFiles({'vision_defines.h', ...
                                        'pointTrackerCore_api.hpp', ...
                                        'cgCommon.hpp', ...
+                                       'cgThreadPool.hpp', ...
+                                       'cgResultPool.hpp', ...
+                                       'cgPyramidCache.hpp', ...
+                                       'cgIntegralImage.hpp', ...
+                                       'cgPipeline.hpp', ...
+                                       'mwtranspose.hpp', ...
                                        'PointTrackerParams.hpp', ...
                                        'PointBuffers.hpp', ...
                                        'ImageBuffers.hpp', ...
+                                       'PointTrackerCuda.hpp', ...
+                                       'ImageHandle.hpp', ...
                                        'PointTrackerOcv.hpp'}); % no need of 'rtwtypes.h'
 
             vision.internal.buildable.portableOpenCVBuildInfo(buildInfo, context, ...
@@ -49,6 +57,21 @@ classdef pointTrackerBuildable < coder.ExternalDependency %#codegen
             coder.ceval('pointTracker_construct', coder.ref(ptrObj));
         end
 
+        %------------------------------------------------------------------
+        % tracker on a CUDA device, or on the CPU if device is -1 or the
+        % device is not available
+        function ptrObj = pointTracker_constructOnDevice(device)
+
+            coder.inline('always');
+            coder.cinclude('pointTrackerCore_api.hpp');
+
+            ptrObj = coder.opaque('void *', 'NULL');
+
+            % call function from shared library
+            coder.ceval('pointTracker_constructOnDevice', coder.ref(ptrObj), ...
+                int32(device));
+        end
+
         %------------------------------------------------------------------
         % call shared library function
         function pointTracker_initialize(ptrObj, params, Iu8_gray, points)
@@ -197,6 +220,95 @@ classdef pointTrackerBuildable < coder.ExternalDependency %#codegen
             end
         end
 
+        %------------------------------------------------------------------
+        % initialize and step on the image of an imageHandleBuildable
+        % handle, which the generated code does not transpose
+        function pointTracker_initializeImage(ptrObj, params, ptrImage, points)
+
+            coder.inline('always');
+            coder.cinclude('pointTrackerCore_api.hpp');
+
+            numPoints = int32(size(points, 1));
+
+            blockH = cCast('int32_T',params.BlockSize(1));
+            blockW = cCast('int32_T',params.BlockSize(2));
+            blockSize = [blockH blockW];
+            paramStruct = struct( ...
+                'blockSize', blockSize, ...
+                'numPyramidLevels', cCast('int32_T',params.NumPyramidLevels), ...
+                'maxIterations', cCast('double',params.MaxIterations), ...
+                'epsilon', double(params.Epsilon), ...
+                'maxBidirectionalError', double(params.MaxBidirectionalError));
+
+            coder.cstructname(paramStruct,'cvstPTStruct_T', 'extern');
+
+            if coder.isColumnMajor
+                coder.ceval('-col','pointTracker_initializeImage', ...
+                            ptrObj, ptrImage, ...
+                            coder.ref(points), numPoints, ...
+                            coder.ref(paramStruct));
+            else
+                coder.ceval('-row','pointTracker_initializeImage', ...
+                            ptrObj, ptrImage, ...
+                            coder.ref(points), numPoints, ...
+                            coder.ref(paramStruct));
+            end
+        end
+
+        %------------------------------------------------------------------
+        function [points, pointValidity, scores] = ...
+                pointTracker_stepImage(ptrObj, ptrImage, num_points)
+
+            coder.inline('always');
+            coder.cinclude('pointTrackerCore_api.hpp');
+
+            numPoints = int32(num_points);
+
+            coder.varsize('points', [inf, 2]);
+            coder.varsize('pointValidity', [inf, 1]);
+            coder.varsize('scores', [inf, 1]);
+
+            points = coder.nullcopy(zeros(double(numPoints),2,'single'));
+            pointValidity = coder.nullcopy(false(double(numPoints),1));
+            scores = coder.nullcopy(zeros(double(numPoints),1));
+
+            if coder.isColumnMajor
+                coder.ceval('-col', 'pointTracker_stepImage', ptrObj, ptrImage, ...
+                    coder.ref(points),coder.ref(pointValidity),coder.ref(scores));
+            else
+                coder.ceval('-row', 'pointTracker_stepImage', ptrObj, ptrImage, ...
+                    coder.ref(points),coder.ref(pointValidity),coder.ref(scores));
+            end
+        end
+
+        %------------------------------------------------------------------
+        % bytes used by a tracker of numPoints points on frames of
+        % frameSize, at the peak of a step and kept between steps
+        function [peakBytes, steadyBytes] = pointTracker_estimateMemory(params, frameSize, numPoints)
+
+            coder.inline('always');
+            coder.cinclude('pointTrackerCore_api.hpp');
+
+            blockH = cCast('int32_T',params.BlockSize(1));
+            blockW = cCast('int32_T',params.BlockSize(2));
+            blockSize = [blockH blockW];
+            paramStruct = struct( ...
+                'blockSize', blockSize, ...
+                'numPyramidLevels', cCast('int32_T',params.NumPyramidLevels), ...
+                'maxIterations', cCast('double',params.MaxIterations), ...
+                'epsilon', double(params.Epsilon), ...
+                'maxBidirectionalError', double(params.MaxBidirectionalError));
+
+            coder.cstructname(paramStruct,'cvstPTStruct_T', 'extern');
+
+            peakBytes = 0;
+            steadyBytes = 0;
+            coder.ceval('pointTracker_estimateMemory', ...
+                int32(frameSize(1)), int32(frameSize(2)), int32(numPoints), ...
+                coder.ref(paramStruct), ...
+                coder.ref(peakBytes), coder.ref(steadyBytes));
+        end
+
         %------------------------------------------------------------------
         % call shared library function
         function pointTracker_deleteObj(ptrObj)
@@ -25,6 +25,11 @@ ocv_version = '3.1.0';
 warnIfNotCPPCompiler();
 errorIfNotHierachicalPackType(buildInfo);
 
+% Per-call instrumentation of the cores, compiled out unless CG_PROFILE is
+% defined (see cgProfile.hpp)
+buildInfo.addSourceFiles({'cgProfile.cpp'});
+buildInfo.addIncludeFiles({'cgProfile.hpp'});
+
 if isProdHWDeviceTypeARM(buildInfo)
     % no need to include libraries in the buildInfo. These libraries are
     % for MATLAB host only
@@ -52,6 +57,7 @@ switch arch
         ocvNonBuildFilesNoExt = AddVideoIOLibIfNeeded(ocvNonBuildFilesNoExt, fcnName, ocv_ver_no_dots);
         ocvNonBuildFilesNoExt = AddMLLibIfNeeded(ocvNonBuildFilesNoExt, fcnName, ocv_ver_no_dots);
         ocvNonBuildFilesNoExt = AddImgCodecsLibIfNeeded(ocvNonBuildFilesNoExt, fcnName, ocv_ver_no_dots);
+        ocvNonBuildFilesNoExt = AddCudaLibsIfNeeded(ocvNonBuildFilesNoExt, fcnName, ocv_ver_no_dots);
 
         ocvLinkFilesNoExt = ocvNonBuildFilesNoExt;
         nonBuildFilesNoExt = [ocvNonBuildFilesNoExt, 'tbb'];
@@ -240,6 +246,7 @@ if strcmp(fcnName, 'detectFAST') || ...
         strcmp(fcnName, 'extractFreak') || ...
         strcmp(fcnName, 'disparityBM') || ...
         strcmp(fcnName, 'disparitySGBM') || ...
+        strcmp(fcnName, 'stereoPipeline') || ...
         strcmp(fcnName, 'extractSurf') || ...
         strcmp(fcnName, 'fastHessianDetector') || ...
         strcmp(fcnName, 'detectBRISK') || ...
@@ -255,11 +262,13 @@ if strcmp(fcnName, 'detectFAST') || ...
         strcmp(fcnName, 'extractFreak') || ...
         strcmp(fcnName, 'disparityBM') || ...
         strcmp(fcnName, 'disparitySGBM') || ...
+        strcmp(fcnName, 'stereoPipeline') || ...
         strcmp(fcnName, 'extractSurf') || ...
         strcmp(fcnName, 'fastHessianDetector') || ...
         strcmp(fcnName, 'detectBRISK') || ...
         strcmp(fcnName, 'extractBRISK') || ...
-        strcmp(fcnName, 'matchFeatures')
+        strcmp(fcnName, 'matchFeatures') || ...
+        strcmp(fcnName, 'approximateKMeans')
     nonBuildFilesNoExt{end+1} = strcat('opencv_flann', ocv_ver_no_dots);
 end
 
@@ -268,6 +277,7 @@ function nonBuildFilesNoExt = AddCalib3DLibIfNeeded(nonBuildFilesNoExt, fcnName,
 
 if strcmp(fcnName, 'disparityBM') || ...
         strcmp(fcnName, 'disparitySGBM') || ...
+        strcmp(fcnName, 'stereoPipeline') || ...
         strcmp(fcnName, 'extractSurf') || ...  % dependency via nonfree
         strcmp(fcnName, 'fastHessianDetector') % dependency via nonfree
     nonBuildFilesNoExt{end+1} = strcat('opencv_calib3d', ocv_ver_no_dots);
@@ -294,6 +304,55 @@ if strcmp(fcnName, 'HOGDescriptor')
     nonBuildFilesNoExt{end+1} = strcat('opencv_imgcodecs', ocv_ver_no_dots);
 end
 
+%==========================================================================
+function nonBuildFilesNoExt = AddCudaLibsIfNeeded(nonBuildFilesNoExt, fcnName, ocv_ver_no_dots)
+
+if strcmp(fcnName, 'disparityBM') || ...
+        strcmp(fcnName, 'disparitySGBM') || ...
+        strcmp(fcnName, 'stereoPipeline')
+    nonBuildFilesNoExt{end+1} = strcat('opencv_cudastereo', ocv_ver_no_dots);
+end
+
+if strcmp(fcnName, 'pointTracker') || ...
+        strcmp(fcnName, 'opticalFlowFarneback')
+    % cudaoptflow and the modules it depends on
+    nonBuildFilesNoExt{end+1} = strcat('opencv_cudaoptflow', ocv_ver_no_dots);
+    nonBuildFilesNoExt{end+1} = strcat('opencv_cudaarithm', ocv_ver_no_dots);
+    nonBuildFilesNoExt{end+1} = strcat('opencv_cudawarping', ocv_ver_no_dots);
+    nonBuildFilesNoExt{end+1} = strcat('opencv_cudaimgproc', ocv_ver_no_dots);
+    nonBuildFilesNoExt{end+1} = strcat('opencv_cudalegacy', ocv_ver_no_dots);
+end
+
+if strcmp(fcnName, 'foregroundDetectorCuda')
+    nonBuildFilesNoExt{end+1} = strcat('opencv_cudabgsegm', ocv_ver_no_dots);
+    nonBuildFilesNoExt{end+1} = strcat('opencv_cudaarithm', ocv_ver_no_dots);
+    nonBuildFilesNoExt{end+1} = strcat('opencv_video', ocv_ver_no_dots);
+end
+
+if strcmp(fcnName, 'matchFeatures')
+    % cudafeatures2d and the modules it depends on
+    nonBuildFilesNoExt{end+1} = strcat('opencv_cudafeatures2d', ocv_ver_no_dots);
+    nonBuildFilesNoExt{end+1} = strcat('opencv_cudaarithm', ocv_ver_no_dots);
+    nonBuildFilesNoExt{end+1} = strcat('opencv_cudafilters', ocv_ver_no_dots);
+    nonBuildFilesNoExt{end+1} = strcat('opencv_cudawarping', ocv_ver_no_dots);
+    nonBuildFilesNoExt{end+1} = strcat('opencv_features2d', ocv_ver_no_dots);
+end
+
+if strcmp(fcnName, 'HOGDescriptor') || ...
+        strcmp(fcnName, 'cascadeClassifier')
+    % cudaobjdetect and the modules it depends on
+    nonBuildFilesNoExt{end+1} = strcat('opencv_cudaobjdetect', ocv_ver_no_dots);
+    nonBuildFilesNoExt{end+1} = strcat('opencv_cudaarithm', ocv_ver_no_dots);
+    nonBuildFilesNoExt{end+1} = strcat('opencv_cudawarping', ocv_ver_no_dots);
+    nonBuildFilesNoExt{end+1} = strcat('opencv_cudaimgproc', ocv_ver_no_dots);
+    nonBuildFilesNoExt{end+1} = strcat('opencv_cudalegacy', ocv_ver_no_dots);
+end
+
+if strcmp(fcnName, 'imageHandle')
+    % device transposes of column major images
+    nonBuildFilesNoExt{end+1} = strcat('opencv_cudaarithm', ocv_ver_no_dots);
+end
+
 %==========================================================================
 function nonBuildFilesNoExt = AddVideoLibIfNeeded(nonBuildFilesNoExt, fcnName, ocv_ver_no_dots)
 
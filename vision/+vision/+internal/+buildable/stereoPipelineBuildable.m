@@ -0,0 +1,154 @@
+classdef stereoPipelineBuildable < coder.ExternalDependency %#codegen
+    % stereoPipelineBuildable - encapsulate the fused rectification,
+    % disparity and reconstruction implementation library
+
+    % Copyright 2016 The MathWorks, Inc.
+
+
+    methods (Static)
+
+        function name = getDescriptiveName(~)
+            name = 'stereoPipelineBuildable';
+        end
+
+        function b = isSupportedContext(~)
+            b = true; % supports non-host target
+        end
+
+        function updateBuildInfo(buildInfo, context)
+            buildInfo.addIncludePaths({fullfile(matlabroot,'toolbox', ...
+                'vision','builtins','src','ocv','include'), ...
+                fullfile(matlabroot,'toolbox', ...
+                'vision','builtins','src','ocvcg', 'opencv', 'include')} );
+            buildInfo.addSourcePaths({fullfile(matlabroot,'toolbox', ...
+                'vision','builtins','src','ocv')});
+            buildInfo.addSourceFiles({'stereoPipelineCore.cpp', 'cgCommon.cpp'});
+            buildInfo.addIncludeFiles({'vision_defines.h', ...
+                                       'cgCommon.hpp', ...
+                                       'cgThreadPool.hpp', ...
+                                       'cgResultPool.hpp', ...
+                                       'cgPyramidCache.hpp', ...
+                                       'cgIntegralImage.hpp', ...
+                                       'cgPipeline.hpp', ...
+                                       'disparityBM.hpp', ...
+                                       'mwtranspose.hpp', ...
+                                       'DisparityBMOcv.hpp', ...
+                                       'DisparitySGBMOcv.hpp', ...
+                                       'DisparityCoarse.hpp', ...
+                                       'DisparityCuda.hpp', ...
+                                       'StereoPipelineOcv.hpp', ...
+                                       'disparityBMCore_api.hpp', ...
+                                       'disparitySGBMCore_api.hpp', ...
+                                       'stereoPipelineCore_api.hpp'}); % no need 'rtwtypes.h'
+
+            vision.internal.buildable.portableOpenCVBuildInfo(buildInfo, context, ...
+                'stereoPipeline');
+        end
+
+        %------------------------------------------------------------------
+        % the rectification maps, the matchers and their buffers are kept
+        % alive across frames
+        function ptrObj = stereoPipeline_construct()
+
+            coder.inline('always');
+            coder.cinclude('stereoPipelineCore_api.hpp');
+
+            ptrObj = coder.opaque('void *', 'NULL');
+
+            % call function from shared library
+            coder.ceval('stereoPipeline_construct', coder.ref(ptrObj));
+        end
+
+        %------------------------------------------------------------------
+        % maps are the XmapSingle and YmapSingle of the ImageTransformer of
+        % each camera; interp is 'nearest', 'linear' or 'cubic'
+        function stereoPipeline_setMaps(ptrObj, xMap1, yMap1, xMap2, yMap2, ...
+                interp, fillValue, Q)
+
+            coder.inline('always');
+            coder.cinclude('stereoPipelineCore_api.hpp');
+
+            nRows = int32(size(xMap1, 1));
+            nCols = int32(size(xMap1, 2));
+
+            switch interp
+                case 'nearest'
+                    interpCode = int32(0);
+                case 'cubic'
+                    interpCode = int32(2);
+                otherwise
+                    interpCode = int32(1);
+            end
+
+            if coder.isColumnMajor
+                coder.ceval('-col', 'stereoPipeline_setMaps', ptrObj, ...
+                    coder.ref(xMap1), coder.ref(yMap1), ...
+                    coder.ref(xMap2), coder.ref(yMap2), ...
+                    nRows, nCols, interpCode, uint8(fillValue), ...
+                    coder.ref(double(Q)));
+            else
+                coder.ceval('-row', 'stereoPipeline_setMapsRM', ptrObj, ...
+                    coder.ref(xMap1), coder.ref(yMap1), ...
+                    coder.ref(xMap2), coder.ref(yMap2), ...
+                    nRows, nCols, interpCode, uint8(fillValue), ...
+                    coder.ref(double(Q)));
+            end
+        end
+
+        %------------------------------------------------------------------
+        % rectifies and matches the raw frames; outSize is the size of the
+        % maps. xyzPoints is only computed when it is requested.
+        function [outDisparity, xyzPoints] = stereoPipeline_step(ptrObj, ...
+                image1_u8, image2_u8, outSize, method, opt)
+
+            coder.inline('always');
+            coder.cinclude('stereoPipelineCore_api.hpp');
+
+            inRows = int32(size(image1_u8, 1));
+            inCols = int32(size(image1_u8, 2));
+            outDisparity = coder.nullcopy(zeros(outSize,'single'));
+
+            if nargout > 1
+                xyzPoints = coder.nullcopy(zeros([outSize 3],'single'));
+                xyzRef = coder.ref(xyzPoints);
+            else
+                xyzRef = coder.opaque('real32_T *', 'NULL');
+            end
+
+            if strcmp(method, 'BlockMatching')
+                paramStruct = vision.internal.buildable.disparityBMBuildable.getParamStruct(opt);
+                fcnName = 'stereoPipeline_stepBM';
+            else
+                paramStruct = vision.internal.buildable.disparitySGBMBuildable.getParamStruct(opt);
+                fcnName = 'stereoPipeline_stepSGBM';
+            end
+
+            if coder.isColumnMajor
+                coder.ceval('-col', fcnName, ptrObj, ...
+                    coder.ref(image1_u8), ...
+                    coder.ref(image2_u8), ...
+                    inRows, inCols, ...
+                    coder.ref(outDisparity), ...
+                    xyzRef, ...
+                    coder.ref(paramStruct));
+            else
+                coder.ceval('-row', [fcnName 'RM'], ptrObj, ...
+                    coder.ref(image1_u8), ...
+                    coder.ref(image2_u8), ...
+                    inRows, inCols, ...
+                    coder.ref(outDisparity), ...
+                    xyzRef, ...
+                    coder.ref(paramStruct));
+            end
+        end
+
+        %------------------------------------------------------------------
+        function stereoPipeline_deleteObj(ptrObj)
+
+            coder.inline('always');
+            coder.cinclude('stereoPipelineCore_api.hpp');
+
+            coder.ceval('stereoPipeline_deleteObj', ptrObj);
+        end
+    end
+end
@@ -0,0 +1,92 @@
+classdef templateMatchingBuildable < coder.ExternalDependency %#codegen
+    % templateMatchingBuildable - encapsulate template matching implementation library
+    
+    % Copyright 2016 The MathWorks, Inc.
+    
+    
+    methods (Static)
+        
+        function name = getDescriptiveName(~)
+            name = 'templateMatchingBuildable';
+        end
+        
+        function b = isSupportedContext(context)
+            b = context.isMatlabHostTarget();
+        end
+        
+        function updateBuildInfo(buildInfo, ~)
+            buildInfo.addIncludePaths({fullfile(matlabroot,'toolbox', ...
+                'vision','builtins','src','vision','include')} );
+            buildInfo.addSourcePaths({fullfile(matlabroot,'toolbox', ...
+                'vision','builtins','src','vision')});
+            buildInfo.addSourceFiles({'templateMatchingCore.cpp'});
+            buildInfo.addIncludeFiles({'vision_defines.h', ...
+                                       'templateMatchingCore_api.hpp', ...
+                                       'templateMatching.hpp'});
+        end
+
+        %------------------------------------------------------------------
+        function ptrMatcher = templateMatching_construct()
+            
+            coder.inline('always');
+            coder.cinclude('templateMatchingCore_api.hpp');
+            
+            ptrMatcher = coder.opaque('void *', 'NULL');
+            coder.ceval('MWCV_TemplateMatching_construct', coder.ref(ptrMatcher));
+        end
+
+        %------------------------------------------------------------------
+        % metric is 'Sum of absolute differences', 'Sum of squared
+        % differences', 'Maximum absolute difference' or 'Normalized cross
+        % correlation'. method is 'Auto', 'Direct' or 'FFT'.
+        function metricMatrix = templateMatching_compute(ptrMatcher, I, T, ...
+                metric, method)
+            
+            coder.inline('always');
+            coder.cinclude('templateMatchingCore_api.hpp');
+            
+            switch metric
+                case 'Sum of absolute differences'
+                    metricId = int32(0);
+                case 'Sum of squared differences'
+                    metricId = int32(1);
+                case 'Maximum absolute difference'
+                    metricId = int32(2);
+                otherwise
+                    metricId = int32(3);
+            end
+            
+            switch method
+                case 'Direct'
+                    methodId = int32(1);
+                case 'FFT'
+                    methodId = int32(2);
+                otherwise
+                    methodId = int32(0);
+            end
+            
+            outRows = max(size(I,1) - size(T,1) + 1, 0);
+            outCols = max(size(I,2) - size(T,2) + 1, 0);
+            if isa(I, 'single')
+                metricMatrix = zeros(outRows, outCols, 'single');
+            else
+                metricMatrix = zeros(outRows, outCols);
+            end
+            
+            fcnName = ['MWCV_TemplateMatching_' class(I)];
+            coder.ceval('-col', fcnName, ptrMatcher, ...
+                coder.rref(I), int32(size(I,1)), int32(size(I,2)), ...
+                coder.rref(T), int32(size(T,1)), int32(size(T,2)), ...
+                metricId, methodId, coder.ref(metricMatrix));
+        end
+
+        %------------------------------------------------------------------
+        function templateMatching_deleteObj(ptrMatcher)
+            
+            coder.inline('always');
+            coder.cinclude('templateMatchingCore_api.hpp');
+            
+            coder.ceval('MWCV_TemplateMatching_deleteObj', ptrMatcher);
+        end
+    end
+end
@@ -0,0 +1,174 @@
+classdef threadPoolBuildable < coder.ExternalDependency %#codegen
+    % threadPoolBuildable - encapsulate the number of threads used by the
+    % OpenCV based libraries: the worker pool of cgCommon and the
+    % cv::parallel_for_ loops of OpenCV, the placement of the pool workers
+    % on the CPUs, the pools of result containers of the cores, the image
+    % pyramids they share and their native column major processing, and
+    % the frame pipeline running the stages of generated code across frames
+
+    % Copyright 2016 The MathWorks, Inc.
+
+
+    methods (Static)
+
+        function name = getDescriptiveName(~)
+            name = 'threadPoolBuildable';
+        end
+
+        function b = isSupportedContext(~)
+            b = true; % supports non-host target
+        end
+
+        function updateBuildInfo(buildInfo, context)
+            buildInfo.addIncludePaths({fullfile(matlabroot,'toolbox', ...
+                'vision','builtins','src','ocv','include'), ...
+                fullfile(matlabroot,'toolbox', ...
+                'vision','builtins','src','ocvcg', 'opencv', 'include')} );
+            buildInfo.addSourcePaths({fullfile(matlabroot,'toolbox', ...
+                'vision','builtins','src','ocv')});
+            buildInfo.addSourceFiles({'cgCommon.cpp'});
+            buildInfo.addIncludeFiles({'vision_defines.h', ...
+                                       'cgCommon.hpp', ...
+                                       'cgThreadPool.hpp', ...
+                                       'cgResultPool.hpp', ...
+                                       'cgPyramidCache.hpp', ...
+                                       'cgIntegralImage.hpp', ...
+                                       'cgPipeline.hpp', ...
+                                       'mwtranspose.hpp'}); % no need 'rtwtypes.h'
+
+            vision.internal.buildable.portableOpenCVBuildInfo(buildInfo, context, ...
+                'threadPool');
+        end
+
+        %------------------------------------------------------------------
+        % numThreads of 0 selects the number of hardware threads
+        function setNumThreads(numThreads)
+
+            coder.inline('always');
+            coder.cinclude('cgThreadPool.hpp');
+
+            coder.ceval('cgSetNumThreads', int32(numThreads));
+        end
+
+        %------------------------------------------------------------------
+        function numThreads = getNumThreads()
+
+            coder.inline('always');
+            coder.cinclude('cgThreadPool.hpp');
+
+            numThreads = int32(0);
+            numThreads = coder.ceval('cgGetNumThreads');
+        end
+
+        %------------------------------------------------------------------
+        % policy is 0 (none), 1 (compact) or 2 (scatter over the NUMA
+        % nodes), see cgSetThreadAffinity
+        function setThreadAffinity(policy)
+
+            coder.inline('always');
+            coder.cinclude('cgThreadPool.hpp');
+
+            coder.ceval('cgSetThreadAffinity', int32(policy));
+        end
+
+        %------------------------------------------------------------------
+        % number of result containers of each type the cores keep for
+        % reuse, 0 to allocate every result, see cgSetResultPoolSize
+        function setResultPoolSize(maxPerType)
+
+            coder.inline('always');
+            coder.cinclude('cgResultPool.hpp');
+
+            coder.ceval('cgSetResultPoolSize', int32(maxPerType));
+        end
+
+        %------------------------------------------------------------------
+        % frees the result containers kept for reuse
+        function releaseResultPool()
+
+            coder.inline('always');
+            coder.cinclude('cgResultPool.hpp');
+
+            coder.ceval('cgReleaseResultPool');
+        end
+
+        %------------------------------------------------------------------
+        % number of frames whose image pyramids the cores share, 0 to
+        % build a pyramid per core, see cgSetPyramidCacheSize
+        function setPyramidCacheSize(numFrames)
+
+            coder.inline('always');
+            coder.cinclude('cgPyramidCache.hpp');
+
+            coder.ceval('cgSetPyramidCacheSize', int32(numFrames));
+        end
+
+        %------------------------------------------------------------------
+        % frees the image pyramids kept for the next cores
+        function releasePyramidCache()
+
+            coder.inline('always');
+            coder.cinclude('cgPyramidCache.hpp');
+
+            coder.ceval('cgReleasePyramidCache');
+        end
+
+        %------------------------------------------------------------------
+        % true lets FAST and MSER read grayscale column major images in
+        % place, as their transpose, see cgSetNativeColumnMajor
+        function setNativeColumnMajor(enable)
+
+            coder.inline('always');
+            coder.cinclude('cgCommon.hpp');
+
+            coder.ceval('cgSetNativeColumnMajor', int32(enable));
+        end
+
+        %------------------------------------------------------------------
+        % pipeline of maxInFlight frame slots, see cgPipeline_construct
+        function ptrObj = pipeline_construct(maxInFlight)
+
+            coder.inline('always');
+            coder.cinclude('cgPipeline.hpp');
+
+            ptrObj = coder.opaque('void *', 'NULL');
+
+            coder.ceval('cgPipeline_construct', int32(maxInFlight), coder.ref(ptrObj));
+        end
+
+        %------------------------------------------------------------------
+        % fcnName names a C function of type cgPipelineStageFcn, given
+        % stageState and the slot of a frame
+        function pipeline_addStage(ptrObj, fcnName, stageState, isParallel)
+
+            coder.inline('always');
+            coder.cinclude('cgPipeline.hpp');
+
+            fcn = coder.opaque('cgPipelineStageFcn', fcnName);
+            coder.ceval('cgPipeline_addStage', ptrObj, fcn, stageState, ...
+                logical(isParallel));
+        end
+
+        %------------------------------------------------------------------
+        % fcnName names a C function of type cgPipelineSourceFcn; returns
+        % the number of frames
+        function numFrames = pipeline_run(ptrObj, fcnName, sourceState)
+
+            coder.inline('always');
+            coder.cinclude('cgPipeline.hpp');
+
+            source = coder.opaque('cgPipelineSourceFcn', fcnName);
+            numFrames = int32(0);
+            numFrames = coder.ceval('cgPipeline_run', ptrObj, source, sourceState);
+        end
+
+        %------------------------------------------------------------------
+        function pipeline_deleteObj(ptrObj)
+
+            coder.inline('always');
+            coder.cinclude('cgPipeline.hpp');
+
+            coder.ceval('cgPipeline_deleteObj', ptrObj);
+        end
+    end
+end
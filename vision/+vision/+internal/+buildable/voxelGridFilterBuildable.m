@@ -0,0 +1,99 @@
+classdef voxelGridFilterBuildable < coder.ExternalDependency %#codegen
+    % voxelGridFilterBuildable - voxel grid filter of the 'gridAverage'
+    % method of pcdownsample and of pcmerge
+
+    % Copyright 2016 The MathWorks, Inc.
+
+    methods (Static)
+
+        function name = getDescriptiveName(~)
+            name = 'voxelGridFilterBuildable';
+        end
+
+        function b = isSupportedContext(~)
+            b = true; % supports non-host target
+        end
+
+        function updateBuildInfo(buildInfo, context)
+            buildInfo.addIncludePaths({fullfile(matlabroot,'toolbox', ...
+                'vision','builtins','src','ocv','include'), ...
+                fullfile(matlabroot,'toolbox', ...
+                'vision','builtins','src','ocvcg', 'opencv', 'include')} );
+            buildInfo.addSourcePaths({fullfile(matlabroot,'toolbox', ...
+                'vision','builtins','src','ocv')});
+            buildInfo.addSourceFiles({'voxelGridFilterCore.cpp', ...
+                'cgCommon.cpp'});
+            buildInfo.addIncludeFiles({'vision_defines.h', ...
+                                       'voxelGridFilterCore_api.hpp', ...
+                                       'VoxelGridFilter.hpp', ...
+                                       'cgCommon.hpp', ...
+                                       'cgThreadPool.hpp'}); % no need 'rtwtypes.h'
+
+            vision.internal.buildable.portableOpenCVBuildInfo(buildInfo, context, ...
+                'voxelGridFilter');
+        end
+
+        %------------------------------------------------------------------
+        % points is M-by-3 single or double, color M-by-3 uint8 or empty,
+        % normal M-by-3 of the class of points or empty. The outputs are
+        % empty when the inputs are.
+        function [pointsOut, colorOut, normalOut] = voxelGridFilter( ...
+                points, color, normal, gridStep, rangeLimits)
+
+            coder.inline('always');
+            coder.cinclude('voxelGridFilterCore_api.hpp');
+
+            numPoints = int32(size(points, 1));
+            hasColor = ~isempty(color);
+            hasNormal = ~isempty(normal);
+            limits = cast(rangeLimits, 'like', points);
+            step = cast(gridStep, 'like', points);
+
+            ptrResult = coder.opaque('void *', 'NULL');
+            numOut = int32(0);
+
+            if isa(points, 'double')
+                suffix = '';
+            else
+                suffix = '_single';
+            end
+
+            if coder.isColumnMajor
+                numOut = coder.ceval('-col', ['voxelGridFilter' suffix], ...
+                    coder.rref(points), coder.rref(color), coder.rref(normal), ...
+                    numPoints, hasColor, hasNormal, step, coder.rref(limits), ...
+                    coder.ref(ptrResult));
+            else
+                numOut = coder.ceval('-row', ['voxelGridFilter' suffix 'RM'], ...
+                    coder.rref(points), coder.rref(color), coder.rref(normal), ...
+                    numPoints, hasColor, hasNormal, step, coder.rref(limits), ...
+                    coder.ref(ptrResult));
+            end
+
+            coder.varsize('pointsOut', [inf, 3]);
+            coder.varsize('colorOut', [inf, 3]);
+            coder.varsize('normalOut', [inf, 3]);
+            pointsOut = coder.nullcopy(zeros(double(numOut), 3, 'like', points));
+            if hasColor
+                colorOut = coder.nullcopy(zeros(double(numOut), 3, 'uint8'));
+            else
+                colorOut = zeros(0, 3, 'uint8');
+            end
+            if hasNormal
+                normalOut = coder.nullcopy(zeros(double(numOut), 3, 'like', points));
+            else
+                normalOut = zeros(0, 3, 'like', points);
+            end
+
+            if coder.isColumnMajor
+                coder.ceval('-col', ['voxelGridFilter_assignOutputDelete' suffix], ...
+                    ptrResult, coder.ref(pointsOut), coder.ref(colorOut), ...
+                    coder.ref(normalOut));
+            else
+                coder.ceval('-row', ['voxelGridFilter_assignOutputDelete' suffix 'RM'], ...
+                    ptrResult, coder.ref(pointsOut), coder.ref(colorOut), ...
+                    coder.ref(normalOut));
+            end
+        end
+    end
+end
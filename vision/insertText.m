@@ -772,9 +772,10 @@ if isempty(infoStructArray)
     infoStructArray = [];
 end
 
-% create unique key from font name and font size
+% create unique key from font name and font size; the separator keeps
+% e.g. ('Font1', 2) and ('Font', 12) apart
 fontLower = lower(font);
-thisKey = [fontLower num2str(fontSize)];
+thisKey = [fontLower '|' num2str(fontSize)];
 
 if isKey(fontHashTable, thisKey)
     % retrieve glyph and font info from table
@@ -91,19 +91,21 @@ else
     inputBbox = bbox;
 end
 
-% sort the bbox according to the score
-[~, ind] = sort(score, 'descend'); 
-inputBbox = inputBbox(ind, :);
-
 if isUsingCodeGeneration,
-    selectedIndex = bboxOverlapSuppressionCodegen(inputBbox, ...
-                                    overlapThreshold, isDivByUnion);
+    % the shared suppression core sorts by score itself, stably as sort
+    isKept = vision.internal.buildable.bboxOverlapBuildable.bboxOverlap_suppress( ...
+        inputBbox, score, overlapThreshold, isDivByUnion);
+    index = find(isKept);
 else
+    % sort the bbox according to the score
+    [~, ind] = sort(score, 'descend'); 
+    inputBbox = inputBbox(ind, :);
+
     [~, selectedIndex] = visionBboxOverlapSuppression(inputBbox, ...
                                     overlapThreshold, isDivByUnion);
+    index = sort(ind(selectedIndex), 'ascend');
 end
 
-index = sort(ind(selectedIndex), 'ascend');
 selectedBbox = bbox(index, :);
 selectedScore = score(index);
 
@@ -223,52 +225,3 @@ else
     overlapThreshold = defaults.OverlapThreshold;
 end
 end
-
-%==========================================================================
-function selectedIndex = bboxOverlapSuppressionCodegen(inputBbox, ...
-                                    overlapThreshold, isDivByUnion)
-isKept = true(size(inputBbox,1), 1); 
-area = inputBbox(:,3).*inputBbox(:,4);
-x1 = inputBbox(:,1); 
-x2 = inputBbox(:,1)+inputBbox(:,3); 
-y1 = inputBbox(:,2); 
-y2 = inputBbox(:,2)+inputBbox(:,4);
-
-% for each bbox i, suppress all surrounded bbox j where j>i and overlap
-% ratio is larger than overlapThreshold
-numOfBbox = size(inputBbox,1);
-for i = 1:numOfBbox 
-    if ~isKept(i) 
-        continue; 
-    end
-    for j = (i+1):numOfBbox 
-        if ~isKept(j)
-            continue; 
-        end
-
-        % compute the intersect box
-        width = min(x2(i), x2(j)) - max(x1(i), x1(j)); 
-        if width <= 0 
-            continue; 
-        end
-
-        height = min(y2(i), y2(j)) - max(y1(i), y1(j)); 
-        if height <= 0 
-            continue; 
-        end
-
-        areaOfIntersect = width * height; 
-        if isDivByUnion 
-            overlapRatio = areaOfIntersect/(area(i)+area(j)-areaOfIntersect); 
-        else
-            overlapRatio = areaOfIntersect/min(area(i), area(j)); 
-        end
-
-        if overlapRatio > overlapThreshold 
-            isKept(j) = false; 
-        end
-    end
-end
-
-selectedIndex = find(isKept); 
-end
\ No newline at end of file
@@ -8,4 +8,15 @@
       #define LIBMWVISIONRT_API
   #endif
 
+  /* Small helpers of the run-time kernels; inline is not C89. */
+  #if defined(_MSC_VER) && !defined(__cplusplus)
+      #define MWVIP_INLINE static __inline
+  #elif defined(__cplusplus) || (defined(__STDC_VERSION__) && __STDC_VERSION__ >= 199901L)
+      #define MWVIP_INLINE static inline
+  #elif defined(__GNUC__)
+      #define MWVIP_INLINE static __inline__
+  #else
+      #define MWVIP_INLINE static
+  #endif
+
 #endif
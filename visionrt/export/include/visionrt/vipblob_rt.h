@@ -39,6 +39,56 @@
  *       for double precision inputs. 
  */ 
 
+/* When compiled with OpenMP, the batched functions process the blobs on
+ * several threads, for at least MWVIP_BLOB_MIN_PARALLEL pixels or blobs.
+ * Define MWVIP_BLOB_SERIAL to use one thread. */
+#if defined(_OPENMP) && !defined(MWVIP_BLOB_SERIAL)
+  #define MWVIP_BLOB_PARALLEL 1
+#endif
+#ifndef MWVIP_BLOB_MIN_PARALLEL
+  #define MWVIP_BLOB_MIN_PARALLEL 65536
+#endif
+
+/*
+ * Moments of one blob up to the second order, and its bounding box. The
+ * sums are taken over the pixels of the blob, with the coordinates (n, m)
+ * relative to the first pixel found, (originN, originM), so that they stay
+ * small and exact. A blob with area 0 has not been seen yet.
+ */
+typedef struct {
+    int32_T area;
+    int32_T originN;
+    int32_T originM;
+    int32_T minN;
+    int32_T maxN;
+    int32_T minM;
+    int32_T maxM;
+    real_T  sumN;
+    real_T  sumM;
+    real_T  sumNN;
+    real_T  sumMM;
+    real_T  sumNM;
+} MWVIP_BLOB_MOMENTS;
+
+/*
+ * Ellipse features
+ * ----------------
+ *
+ * The ellipse has the same normalized second central moments as the blob,
+ * each pixel counting as a unit square (1/12 is added to uNN and uMM):
+ *
+ *    common       = sqrt((uNN-uMM)^2 + 4*uNM^2)
+ *    major axis   = 2*sqrt(2)*sqrt(uNN+uMM+common)
+ *    minor axis   = 2*sqrt(2)*sqrt(uNN+uMM-common)
+ *    eccentricity = sqrt(1 - (minor/major)^2)
+ *    orientation  = atan2(2*uNM, uNN-uMM)/2, from the N axis towards the
+ *                   M axis, in radians
+ *
+ * The batched functions compute these for numBlobs blobs at once. The
+ * pixels of blob b are pixList[pixListStart[b]] to
+ * pixList[pixListStart[b+1]-1], and its centroid is (c0[b], c1[b]).
+ */
+
 /* datatype double */
 #ifdef __cplusplus
 extern "C" {
@@ -66,6 +116,167 @@ LIBMWVISIONRT_API void MWVIP_Blob_Ellipse_R(
     real32_T          *eccentricityptr,
     real32_T          *orientationptr  );
 
+LIBMWVISIONRT_API void MWVIP_Blob_EllipseBatch_D(
+    const int16_T    *pixListN,
+    const int16_T    *pixListM,
+    const int32_T    *pixListStart, /* numBlobs+1 offsets */
+    const real_T     *c0,           /* centroids */
+    const real_T     *c1,
+    int32_T           numBlobs,
+    real_T           *majoraxis,
+    real_T           *minoraxis,
+    real_T           *eccentricity,
+    real_T           *orientation  );
+
+LIBMWVISIONRT_API void MWVIP_Blob_EllipseBatch_R(
+    const int16_T    *pixListN,
+    const int16_T    *pixListM,
+    const int32_T    *pixListStart, /* numBlobs+1 offsets */
+    const real32_T   *c0,           /* centroids */
+    const real32_T   *c1,
+    int32_T           numBlobs,
+    real32_T         *majoraxis,
+    real32_T         *minoraxis,
+    real32_T         *eccentricity,
+    real32_T         *orientation  );
+
+/*
+ * Accumulates the moments of blobs 1..numBlobs of a column major label
+ * matrix (0 is the background) in one pass, without pixel lists. n is the
+ * zero based column and m the zero based row of a pixel.
+ */
+LIBMWVISIONRT_API void MWVIP_Blob_Moments(
+    const uint32_T     *labels,
+    int_T               numRows,
+    int_T               numCols,
+    int32_T             numBlobs,
+    MWVIP_BLOB_MOMENTS *moments  );
+
+/*
+ * Streaming moments from run-length encoded labels, for images too large
+ * for int16_T coordinates or for pixel lists. MWVIP_Blob_MomentsReset
+ * clears the moments of numBlobs blobs; each call of
+ * MWVIP_Blob_MomentsAddRuns then adds numRuns vertical runs, run r
+ * covering rows runMStart[r] to runMEnd[r] of column runN[r] and
+ * belonging to blob runLabel[r] (1..numBlobs, other labels are ignored).
+ * The runs of a blob can be split over any number of calls, e.g. one per
+ * strip of a mosaic, and memory grows with the number of blobs only.
+ */
+LIBMWVISIONRT_API void MWVIP_Blob_MomentsReset(
+    int32_T             numBlobs,
+    MWVIP_BLOB_MOMENTS *moments  );
+
+LIBMWVISIONRT_API void MWVIP_Blob_MomentsAddRuns(
+    const int32_T      *runN,
+    const int32_T      *runMStart,
+    const int32_T      *runMEnd,
+    const uint32_T     *runLabel,
+    int32_T             numRuns,
+    int32_T             numBlobs,
+    MWVIP_BLOB_MOMENTS *moments  );
+
+/*
+ * Area, centroid, bounding box and second central moments (normalized by
+ * the area) from accumulated moments. bbox is numBlobs x 4, column major,
+ * with the columns [minN minM widthN heightM]. The centroids are in the
+ * coordinates of the pixels that were added.
+ */
+LIBMWVISIONRT_API void MWVIP_Blob_Stats_D(
+    const MWVIP_BLOB_MOMENTS *moments,
+    int32_T           numBlobs,
+    int32_T          *area,
+    real_T           *centroidN,
+    real_T           *centroidM,
+    int32_T          *bbox,
+    real_T           *uNN,
+    real_T           *uMM,
+    real_T           *uNM  );
+
+LIBMWVISIONRT_API void MWVIP_Blob_Stats_R(
+    const MWVIP_BLOB_MOMENTS *moments,
+    int32_T           numBlobs,
+    int32_T          *area,
+    real32_T         *centroidN,
+    real32_T         *centroidM,
+    int32_T          *bbox,
+    real32_T         *uNN,
+    real32_T         *uMM,
+    real32_T         *uNM  );
+
+/*
+ * Connected component labeling of a column major binary image with 4 or 8
+ * connectivity. The vertical runs of each column are found and linked to
+ * the overlapping runs of the previous column in parallel over strips of
+ * MWVIP_BLOB_LABEL_STRIP_COLS columns, with a union-find that keeps the
+ * first run of each component as its root; the strips are then joined
+ * along their borders. The blobs are numbered 1, 2, ... in the order of
+ * their first pixel in a column-wise scan, as bwlabel numbers them.
+ *
+ * labels, when not NULL, receives the uint32 label matrix. moments, when
+ * not NULL, receives the moments of blobs 1..maxBlobs straight from the
+ * runs, for MWVIP_Blob_Stats_* and MWVIP_Blob_EllipseMoments_*, without
+ * building pixel lists. Returns the number of blobs, which may exceed
+ * maxBlobs, or -1 when the runs cannot be allocated.
+ */
+#ifndef MWVIP_BLOB_LABEL_STRIP_COLS
+  #define MWVIP_BLOB_LABEL_STRIP_COLS 64
+#endif
+
+LIBMWVISIONRT_API int32_T MWVIP_Blob_Label(
+    const boolean_T    *bw,
+    int_T               numRows,
+    int_T               numCols,
+    int_T               connectivity,   /* 4 or 8 */
+    uint32_T           *labels,
+    int32_T             maxBlobs,
+    MWVIP_BLOB_MOMENTS *moments  );
+
+/*
+ * Outer boundaries of blobs 1..numBlobs of a column major label matrix,
+ * traced in parallel with 4 or 8 connectivity as bwboundaries traces them:
+ * clockwise from the first pixel of the blob in a column-wise scan, closed
+ * by repeating that pixel. moments, from MWVIP_Blob_Label or the run
+ * functions, locates the first pixels without scanning the image; pass
+ * NULL to scan it.
+ *
+ * The points of blob b are (pointM[k], pointN[k]), zero based, for k from
+ * pointStart[b] to pointStart[b+1]-1; pointStart has numBlobs+1 entries
+ * and is always filled. Only the boundaries that fit in maxPoints points
+ * are written. Returns the total number of points, which may exceed
+ * maxPoints, or -1 when the work memory cannot be allocated.
+ */
+LIBMWVISIONRT_API int32_T MWVIP_Blob_TraceBoundaries(
+    const uint32_T           *labels,
+    int_T                     numRows,
+    int_T                     numCols,
+    int_T                     connectivity,   /* 4 or 8 */
+    int32_T                   numBlobs,
+    const MWVIP_BLOB_MOMENTS *moments,
+    int32_T                  *pointM,
+    int32_T                  *pointN,
+    int32_T                   maxPoints,
+    int32_T                  *pointStart  );
+
+/* ellipse features and centroids (zero based) from accumulated moments */
+LIBMWVISIONRT_API void MWVIP_Blob_EllipseMoments_D(
+    const MWVIP_BLOB_MOMENTS *moments,
+    int32_T           numBlobs,
+    real_T           *centroidN,
+    real_T           *centroidM,
+    real_T           *majoraxis,
+    real_T           *minoraxis,
+    real_T           *eccentricity,
+    real_T           *orientation  );
+
+LIBMWVISIONRT_API void MWVIP_Blob_EllipseMoments_R(
+    const MWVIP_BLOB_MOMENTS *moments,
+    int32_T           numBlobs,
+    real32_T         *centroidN,
+    real32_T         *centroidM,
+    real32_T         *majoraxis,
+    real32_T         *minoraxis,
+    real32_T         *eccentricity,
+    real32_T         *orientation  );
 
 #ifdef __cplusplus
 } /*  close brace for extern C from above */
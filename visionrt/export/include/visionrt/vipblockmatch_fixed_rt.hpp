@@ -0,0 +1,382 @@
+/*
+ *  vipblockmatch_fixed_rt.hpp
+ *
+ *  Exhaustive block matching for a block size and a maximum displacement
+ *  known at compile time, for C++ code generated with constant parameters.
+ *
+ *  searchFull<Metric, BH, BW, DY, DX>(...) is MWVIP_SearchMethod_Full_* for
+ *  BH-by-BW blocks and displacements of at most DY rows and DX columns, and
+ *  blockMatchFull<Metric, BH, BW, DY, DX>(...) is the matching
+ *  MWVIP_BlockMatching_Full_* driver. With the sizes fixed, the loops over
+ *  the block have constant bounds and are unrolled, and the 2*DY+1
+ *  candidates of a search column are accumulated together: for a given
+ *  pixel of the block, the candidates read consecutive elements of the
+ *  search region, so this innermost loop vectorizes. Each candidate still
+ *  sums its block column by column and row by row, as the C search methods
+ *  do, so the sums, the selected motion vectors and the tie-breaking (the
+ *  first candidate in column order wins) are those of the C functions.
+ *  uint8 and uint16 blocks keep the SIMD kernels of the C search methods.
+ *
+ *  blockMatchFullMAD<BH, BW, DY, DX> and blockMatchFullMSE<BH, BW, DY, DX>
+ *  take the arguments of the C drivers, blockSize and maxDisplSize
+ *  included, and run the specialized search when these match the template
+ *  arguments and the C driver otherwise, so a call site generated with
+ *  constant sizes can use them in place of the C API.
+ *
+ *  Metric is BlockMatchMAD, for real_T, real32_T, uint8_T and uint16_T
+ *  data, or BlockMatchMSE, for real_T and real32_T data.
+ *
+ *  Copyright 2016 The MathWorks, Inc.
+ */
+
+#ifndef vipblockmatch_fixed_rt_hpp
+#define vipblockmatch_fixed_rt_hpp
+
+#include "vipblockmatch_rt.h"
+
+namespace mwvip
+{
+
+/* sum type and motion vector output type of each data type */
+template <typename T> struct BlockMatchTraits;
+
+template <> struct BlockMatchTraits<real_T>
+{
+    typedef real_T SumType;
+    typedef real_T OutType;
+    static SumType maxSum() { return MAX_real_T; }
+};
+
+template <> struct BlockMatchTraits<real32_T>
+{
+    typedef real32_T SumType;
+    typedef real32_T OutType;
+    static SumType maxSum() { return MAX_real32_T; }
+};
+
+template <> struct BlockMatchTraits<uint8_T>
+{
+    typedef uint32_T SumType;
+    typedef real32_T OutType;
+    static SumType maxSum() { return MAX_uint32_T; }
+};
+
+template <> struct BlockMatchTraits<uint16_T>
+{
+    typedef uint32_T SumType;
+    typedef real32_T OutType;
+    static SumType maxSum() { return MAX_uint32_T; }
+};
+
+/* |a-b|, computed as in the MAD search methods */
+inline real_T blockMatchAbsDiff(real_T a, real_T b)     { return fabs(a - b); }
+inline real32_T blockMatchAbsDiff(real32_T a, real32_T b)
+{
+    return (real32_T)fabs((double)(real32_T)(a - b));
+}
+inline uint32_T blockMatchAbsDiff(uint8_T a, uint8_T b)
+{
+    return (a > b) ? (uint32_T)(a - b) : (uint32_T)(b - a);
+}
+inline uint32_T blockMatchAbsDiff(uint16_T a, uint16_T b)
+{
+    return (a > b) ? (uint32_T)(a - b) : (uint32_T)(b - a);
+}
+
+struct BlockMatchMAD
+{
+    template <typename T>
+    static typename BlockMatchTraits<T>::SumType term(T a, T b)
+    {
+        return blockMatchAbsDiff(a, b);
+    }
+};
+
+struct BlockMatchMSE
+{
+    template <typename T>
+    static T term(T a, T b)
+    {
+        const T dist = a - b;
+        return dist*dist;
+    }
+};
+
+/* the candidates of a search column are accumulated together */
+template <typename Metric, int BH, int BW, int DY, int DX, typename T>
+struct BlockMatchFullSearch
+{
+    static void run(const T *blkCS, const T *blkPB,
+                    int_T rowsImgCS, int_T rowsImgPB,
+                    int_T *xIdx, int_T *yIdx)
+    {
+        typedef typename BlockMatchTraits<T>::SumType SumType;
+        enum { numY = 2*DY + 1, numX = 2*DX + 1 };
+
+        SumType minVal = BlockMatchTraits<T>::maxSum();
+        int_T x, y, c1, r1;
+
+        xIdx[0] = 0;
+        yIdx[0] = 0;
+
+        for (x = 0; x < numX; x++)
+        {
+            SumType mysum[numY];
+            const T *region = &blkPB[x*rowsImgPB];
+
+            for (y = 0; y < numY; y++)
+            {
+                mysum[y] = 0;
+            }
+
+            for (c1 = 0; c1 < BW; c1++)
+            {
+                const T *cs = &blkCS[c1*rowsImgCS];
+                const T *pb = &region[c1*rowsImgPB];
+                for (r1 = 0; r1 < BH; r1++)
+                {
+                    /* candidate y reads pb[r1+y] */
+                    const T c = cs[r1];
+                    const T *p = &pb[r1];
+                    for (y = 0; y < numY; y++)
+                    {
+                        mysum[y] += Metric::term(c, p[y]);
+                    }
+                }
+            }
+
+            for (y = 0; y < numY; y++)
+            {
+                if (mysum[y] < minVal)
+                {
+                    minVal = mysum[y];
+                    xIdx[0] = x;
+                    yIdx[0] = y;
+                }
+            }
+        }
+    }
+};
+
+/* The integer search methods take the SIMD sum of absolute differences of
+ * one candidate, which is faster than the vectorized loop over candidates
+ * with 32-bit sums; only the driver is specialized. */
+template <int BH, int BW, int DY, int DX>
+struct BlockMatchFullSearch<BlockMatchMAD, BH, BW, DY, DX, uint8_T>
+{
+    static void run(const uint8_T *blkCS, const uint8_T *blkPB,
+                    int_T rowsImgCS, int_T rowsImgPB,
+                    int_T *xIdx, int_T *yIdx)
+    {
+        MWVIP_SearchMethod_Full_MAD_U8(blkCS, blkPB, rowsImgCS, rowsImgPB,
+                                       BW, BH, BW + 2*DX, BH + 2*DY, xIdx, yIdx);
+    }
+};
+
+template <int BH, int BW, int DY, int DX>
+struct BlockMatchFullSearch<BlockMatchMAD, BH, BW, DY, DX, uint16_T>
+{
+    static void run(const uint16_T *blkCS, const uint16_T *blkPB,
+                    int_T rowsImgCS, int_T rowsImgPB,
+                    int_T *xIdx, int_T *yIdx)
+    {
+        MWVIP_SearchMethod_Full_MAD_U16(blkCS, blkPB, rowsImgCS, rowsImgPB,
+                                        BW, BH, BW + 2*DX, BH + 2*DY, xIdx, yIdx);
+    }
+};
+
+/* MWVIP_SearchMethod_Full_* for a (BH+2*DY)-by-(BW+2*DX) search region */
+template <typename Metric, int BH, int BW, int DY, int DX, typename T>
+inline void searchFull(const T *blkCS, const T *blkPB,
+                       int_T rowsImgCS, int_T rowsImgPB,
+                       int_T *xIdx, int_T *yIdx)
+{
+    BlockMatchFullSearch<Metric, BH, BW, DY, DX, T>::run(blkCS, blkPB,
+        rowsImgCS, rowsImgPB, xIdx, yIdx);
+}
+
+/* MWVIP_BlockMatching_Full_* for BH-by-BW blocks and a maximum
+ * displacement of [DY DX] */
+template <typename Metric, int BH, int BW, int DY, int DX, typename T>
+void blockMatchFull(const T *uImgCurr,
+                    const T *uImgPrev,
+                    T *paddedImgC,
+                    T *paddedImgP,
+                    typename BlockMatchTraits<T>::OutType *yMVsqmag,
+                    const int32_T *overlapSize,
+                    const int_T inRows,
+                    const int_T inCols,
+                    const int_T rowsPadImgC,
+                    const int_T colsPadImgC,
+                    const int_T rowsPadImgP,
+                    const int_T colsPadImgP)
+{
+    typedef typename BlockMatchTraits<T>::OutType OutType;
+
+    int_T i;
+    int_T blkCol, numBlkCols, numBlkRows;
+    T *tmpC, *tmpP;
+    const T *tmpU;
+
+    const int_T yOverlap = overlapSize[0];
+    const int_T xOverlap = overlapSize[1];
+
+    const int_T xPadLside = xOverlap/2; /* padding at left */
+    const int_T yPadTside = yOverlap/2; /* padding at top  */
+
+    const int_T xIncr = BW - xOverlap;
+    const int_T yIncr = BH - yOverlap;
+
+    const int_T bytesPerInputCol = inRows*sizeof(T);
+
+    const int_T startXpadImgP = DX + xPadLside;
+    const int_T startYpadImgP = DY + yPadTside;
+
+    if (paddedImgC != uImgCurr)
+    {
+        /* copy input (uImgCurr) to dwork (paddedImgC) and pad in all sides */
+        memset(paddedImgC, 0, (rowsPadImgC*colsPadImgC*sizeof(T)));
+        tmpC = &paddedImgC[xPadLside*rowsPadImgC + yPadTside];
+        tmpU = uImgCurr;
+        for (i = 0; i < inCols; i++)
+        {
+            memcpy(tmpC, tmpU, bytesPerInputCol);
+            tmpC += rowsPadImgC;
+            tmpU += inRows;
+        }
+    }
+
+    /* copy input (uImgPrev) to dwork (paddedImgP) and pad in all sides */
+    memset(paddedImgP, 0, (rowsPadImgP*colsPadImgP*sizeof(T)));
+    tmpP = &paddedImgP[startXpadImgP*rowsPadImgP + startYpadImgP];
+    tmpU = uImgPrev;
+    for (i = 0; i < inCols; i++)
+    {
+        memcpy(tmpP, tmpU, bytesPerInputCol);
+        tmpP += rowsPadImgP;
+        tmpU += inRows;
+    }
+
+    numBlkCols = MWVIP_BLOCKMATCH_NUM_BLOCKS(colsPadImgP, startXpadImgP, xIncr);
+    numBlkRows = MWVIP_BLOCKMATCH_NUM_BLOCKS(rowsPadImgP, startYpadImgP, yIncr);
+
+#ifdef MWVIP_BLOCKMATCH_PARALLEL
+#pragma omp parallel for schedule(dynamic) if (numBlkCols*numBlkRows >= MWVIP_BLOCKMATCH_MIN_PARALLEL_BLOCKS)
+#endif
+    for (blkCol = 0; blkCol < numBlkCols; blkCol++)
+    {
+        int_T colIdx = blkCol*xIncr;
+        int_T offsetIdxImgC = colIdx*rowsPadImgC;
+        int_T offsetIdxImgP = colIdx*rowsPadImgP;
+        int_T outIdx = blkCol*numBlkRows;
+        int_T blkRow;
+
+        for (blkRow = 0; blkRow < numBlkRows; blkRow++)
+        {
+            int_T rowIdx = blkRow*yIncr;
+            int_T dx, dy, xIdx = 0, yIdx = 0;
+
+            searchFull<Metric, BH, BW, DY, DX>(&paddedImgC[offsetIdxImgC + rowIdx],
+                                               &paddedImgP[offsetIdxImgP + rowIdx],
+                                               rowsPadImgC, rowsPadImgP,
+                                               &xIdx, &yIdx);
+
+            dx = xIdx - DX;
+            dy = yIdx - DY;
+            yMVsqmag[outIdx++] = (OutType)(dx*dx + dy*dy);
+        }
+    }
+}
+
+/* the C drivers, by metric and data type */
+#define MWVIP_BLOCKMATCH_GENERIC(METRIC, T, OUT_T, FCN)                        \
+    inline void blockMatchFullGeneric(METRIC, const T *uImgCurr,               \
+        const T *uImgPrev, T *paddedImgC, T *paddedImgP, OUT_T *yMVsqmag,      \
+        int32_T *blockSize, int32_T *overlapSize, int32_T *maxDisplSize,       \
+        const int_T inRows, const int_T inCols,                                \
+        const int_T rowsPadImgC, const int_T colsPadImgC,                      \
+        const int_T rowsPadImgP, const int_T colsPadImgP)                      \
+    {                                                                          \
+        FCN(uImgCurr, uImgPrev, paddedImgC, paddedImgP, yMVsqmag,              \
+            blockSize, overlapSize, maxDisplSize, inRows, inCols,              \
+            rowsPadImgC, colsPadImgC, rowsPadImgP, colsPadImgP);               \
+    }
+
+MWVIP_BLOCKMATCH_GENERIC(BlockMatchMAD, real_T,   real_T,   MWVIP_BlockMatching_Full_MAD_D)
+MWVIP_BLOCKMATCH_GENERIC(BlockMatchMAD, real32_T, real32_T, MWVIP_BlockMatching_Full_MAD_R)
+MWVIP_BLOCKMATCH_GENERIC(BlockMatchMAD, uint8_T,  real32_T, MWVIP_BlockMatching_Full_MAD_U8)
+MWVIP_BLOCKMATCH_GENERIC(BlockMatchMAD, uint16_T, real32_T, MWVIP_BlockMatching_Full_MAD_U16)
+MWVIP_BLOCKMATCH_GENERIC(BlockMatchMSE, real_T,   real_T,   MWVIP_BlockMatching_Full_MSE_D)
+MWVIP_BLOCKMATCH_GENERIC(BlockMatchMSE, real32_T, real32_T, MWVIP_BlockMatching_Full_MSE_R)
+
+#undef MWVIP_BLOCKMATCH_GENERIC
+
+/* the C driver arguments; specialized when blockSize is [BH BW] and
+ * maxDisplSize is [DY DX] */
+template <typename Metric, int BH, int BW, int DY, int DX, typename T>
+inline void blockMatchFullDispatch(const T *uImgCurr,
+                                   const T *uImgPrev,
+                                   T *paddedImgC,
+                                   T *paddedImgP,
+                                   typename BlockMatchTraits<T>::OutType *yMVsqmag,
+                                   int32_T *blockSize,
+                                   int32_T *overlapSize,
+                                   int32_T *maxDisplSize,
+                                   const int_T inRows,
+                                   const int_T inCols,
+                                   const int_T rowsPadImgC,
+                                   const int_T colsPadImgC,
+                                   const int_T rowsPadImgP,
+                                   const int_T colsPadImgP)
+{
+    if (blockSize[0] == BH && blockSize[1] == BW &&
+        maxDisplSize[0] == DY && maxDisplSize[1] == DX)
+    {
+        blockMatchFull<Metric, BH, BW, DY, DX>(uImgCurr, uImgPrev,
+            paddedImgC, paddedImgP, yMVsqmag, overlapSize, inRows, inCols,
+            rowsPadImgC, colsPadImgC, rowsPadImgP, colsPadImgP);
+    }
+    else
+    {
+        blockMatchFullGeneric(Metric(), uImgCurr, uImgPrev,
+            paddedImgC, paddedImgP, yMVsqmag, blockSize, overlapSize,
+            maxDisplSize, inRows, inCols,
+            rowsPadImgC, colsPadImgC, rowsPadImgP, colsPadImgP);
+    }
+}
+
+template <int BH, int BW, int DY, int DX, typename T>
+inline void blockMatchFullMAD(const T *uImgCurr, const T *uImgPrev,
+                              T *paddedImgC, T *paddedImgP,
+                              typename BlockMatchTraits<T>::OutType *yMVsqmag,
+                              int32_T *blockSize, int32_T *overlapSize,
+                              int32_T *maxDisplSize,
+                              const int_T inRows, const int_T inCols,
+                              const int_T rowsPadImgC, const int_T colsPadImgC,
+                              const int_T rowsPadImgP, const int_T colsPadImgP)
+{
+    blockMatchFullDispatch<BlockMatchMAD, BH, BW, DY, DX>(uImgCurr, uImgPrev,
+        paddedImgC, paddedImgP, yMVsqmag, blockSize, overlapSize, maxDisplSize,
+        inRows, inCols, rowsPadImgC, colsPadImgC, rowsPadImgP, colsPadImgP);
+}
+
+template <int BH, int BW, int DY, int DX, typename T>
+inline void blockMatchFullMSE(const T *uImgCurr, const T *uImgPrev,
+                              T *paddedImgC, T *paddedImgP,
+                              typename BlockMatchTraits<T>::OutType *yMVsqmag,
+                              int32_T *blockSize, int32_T *overlapSize,
+                              int32_T *maxDisplSize,
+                              const int_T inRows, const int_T inCols,
+                              const int_T rowsPadImgC, const int_T colsPadImgC,
+                              const int_T rowsPadImgP, const int_T colsPadImgP)
+{
+    blockMatchFullDispatch<BlockMatchMSE, BH, BW, DY, DX>(uImgCurr, uImgPrev,
+        paddedImgC, paddedImgP, yMVsqmag, blockSize, overlapSize, maxDisplSize,
+        inRows, inCols, rowsPadImgC, colsPadImgC, rowsPadImgP, colsPadImgP);
+}
+
+} /* namespace mwvip */
+
+#endif /* vipblockmatch_fixed_rt_hpp */
+
+/* [EOF] vipblockmatch_fixed_rt.hpp */
@@ -32,6 +32,33 @@
   #define MAX_real32_T FLT_MAX
 #endif
 
+#ifndef MAX_uint32_T
+  #define MAX_uint32_T ((uint32_T)(0xFFFFFFFFU))
+#endif
+
+/* number of blocks along a padded dimension: the block starts are start,
+ * start+incr, ... below padSize-start-incr+1 */
+#define MWVIP_BLOCKMATCH_NUM_BLOCKS(padSize, start, incr) \
+    (((padSize)-(start)-(incr)+1 > (start)) ? ((padSize)-2*(start))/(incr) : 0)
+
+/* When compiled with OpenMP, the block columns of MWVIP_BlockMatching_* are
+ * searched by several threads. Each block writes its own output element, so
+ * the output does not depend on the number of threads. Define
+ * MWVIP_BLOCKMATCH_SERIAL to search the blocks in order on one thread. */
+#if defined(_OPENMP) && !defined(MWVIP_BLOCKMATCH_SERIAL)
+  #define MWVIP_BLOCKMATCH_PARALLEL 1
+#endif
+
+/* smallest number of blocks for which threads are started */
+#ifndef MWVIP_BLOCKMATCH_MIN_PARALLEL_BLOCKS
+  #define MWVIP_BLOCKMATCH_MIN_PARALLEL_BLOCKS 64
+#endif
+
+/* largest number of pyramid levels of the hierarchical search */
+#ifndef MWVIP_BLOCKMATCH_MAX_LEVELS
+  #define MWVIP_BLOCKMATCH_MAX_LEVELS 8
+#endif
+
 #ifndef fabsf
   #define fabsf(X)      (float)( fabs( (double)(X)) )
 #endif
@@ -45,6 +72,8 @@
  * Data types - (describe inputs to functions, not outputs) 
  * R = real single-precision 
  * D = real double-precision 
+ * U8  = uint8  (MAD only; motion vector magnitudes are single-precision)
+ * U16 = uint16 (MAD only; motion vector magnitudes are single-precision)
  */ 
  
 /* Function naming convention 
@@ -56,7 +85,8 @@
  *       functions. 
  *    2) The second field indicates that this function is implementing the 
  *       Block Matching algorithm
- *    3) The third field indicates the searching method (exhaustive, 3-step etc)
+ *    3) The third field indicates the searching method (exhaustive, 3-step,
+ *       hierarchical etc)
  *    4) The fourth field indicates the matching criteria (MSE, MAD etc)
  *    4) The last field enumerates the data type of the output ports
  * 
@@ -66,6 +96,29 @@
  *       search method and MSE as searching criteria
  */ 
 
+/* signature of the MWVIP_SearchMethod_* functions of each data type, so
+ * that the streaming driver can take any search method */
+typedef void (*MWVIP_SEARCH_METHOD_FUNC_D)(const real_T *blkCS, const real_T *blkPB,
+                                            int_T rowsImgCS,   int_T rowsImgPB,
+                                            int_T blkCSWidthX, int_T blkCSHeightY,
+                                            int_T blkPBWidthX, int_T blkPBHeightY,
+                                            int_T *xIdx,       int_T *yIdx);
+typedef void (*MWVIP_SEARCH_METHOD_FUNC_R)(const real32_T *blkCS, const real32_T *blkPB,
+                                            int_T rowsImgCS,   int_T rowsImgPB,
+                                            int_T blkCSWidthX, int_T blkCSHeightY,
+                                            int_T blkPBWidthX, int_T blkPBHeightY,
+                                            int_T *xIdx,       int_T *yIdx);
+typedef void (*MWVIP_SEARCH_METHOD_FUNC_U8)(const uint8_T *blkCS, const uint8_T *blkPB,
+                                            int_T rowsImgCS,   int_T rowsImgPB,
+                                            int_T blkCSWidthX, int_T blkCSHeightY,
+                                            int_T blkPBWidthX, int_T blkPBHeightY,
+                                            int_T *xIdx,       int_T *yIdx);
+typedef void (*MWVIP_SEARCH_METHOD_FUNC_U16)(const uint16_T *blkCS, const uint16_T *blkPB,
+                                            int_T rowsImgCS,   int_T rowsImgPB,
+                                            int_T blkCSWidthX, int_T blkCSHeightY,
+                                            int_T blkPBWidthX, int_T blkPBHeightY,
+                                            int_T *xIdx,       int_T *yIdx);
+
 /* datatype double */
 #ifdef __cplusplus
 extern "C" {
@@ -268,6 +321,72 @@ LIBMWVISIONRT_API void MWVIP_BlockMatching_3Step_MAD_Z(
                                 const int_T rowsPadImgP,
                                 const int_T colsPadImgP);
 
+/* uint8; the sum of absolute differences is exact */
+LIBMWVISIONRT_API void MWVIP_BlockMatching_Full_MAD_U8(
+                                const uint8_T *uImgCurr,
+                                const uint8_T *uImgPrev,
+                                uint8_T *paddedImgC,
+                                uint8_T *paddedImgP,
+                                real32_T *yMVsqmag,
+                                int32_T *blockSize,
+                                int32_T *overlapSize,
+                                int32_T *maxDisplSize,
+                                const int_T inRows,
+                                const int_T inCols,
+                                const int_T rowsPadImgC,
+                                const int_T colsPadImgC,
+                                const int_T rowsPadImgP,
+                                const int_T colsPadImgP);
+
+LIBMWVISIONRT_API void MWVIP_BlockMatching_3Step_MAD_U8(
+                                const uint8_T *uImgCurr,
+                                const uint8_T *uImgPrev,
+                                uint8_T *paddedImgC,
+                                uint8_T *paddedImgP,
+                                real32_T *yMVsqmag,
+                                int32_T *blockSize,
+                                int32_T *overlapSize,
+                                int32_T *maxDisplSize,
+                                const int_T inRows,
+                                const int_T inCols,
+                                const int_T rowsPadImgC,
+                                const int_T colsPadImgC,
+                                const int_T rowsPadImgP,
+                                const int_T colsPadImgP);
+
+/* uint16; the sum of absolute differences is exact */
+LIBMWVISIONRT_API void MWVIP_BlockMatching_Full_MAD_U16(
+                                const uint16_T *uImgCurr,
+                                const uint16_T *uImgPrev,
+                                uint16_T *paddedImgC,
+                                uint16_T *paddedImgP,
+                                real32_T *yMVsqmag,
+                                int32_T *blockSize,
+                                int32_T *overlapSize,
+                                int32_T *maxDisplSize,
+                                const int_T inRows,
+                                const int_T inCols,
+                                const int_T rowsPadImgC,
+                                const int_T colsPadImgC,
+                                const int_T rowsPadImgP,
+                                const int_T colsPadImgP);
+
+LIBMWVISIONRT_API void MWVIP_BlockMatching_3Step_MAD_U16(
+                                const uint16_T *uImgCurr,
+                                const uint16_T *uImgPrev,
+                                uint16_T *paddedImgC,
+                                uint16_T *paddedImgP,
+                                real32_T *yMVsqmag,
+                                int32_T *blockSize,
+                                int32_T *overlapSize,
+                                int32_T *maxDisplSize,
+                                const int_T inRows,
+                                const int_T inCols,
+                                const int_T rowsPadImgC,
+                                const int_T colsPadImgC,
+                                const int_T rowsPadImgP,
+                                const int_T colsPadImgP);
+
 /* single complex output */
 LIBMWVISIONRT_API void MWVIP_BlockMatching_Full_MSE_C(
                                 const real32_T *uImgCurr,
@@ -383,6 +502,153 @@ LIBMWVISIONRT_API void MWVIP_SearchMethod_3Step_MAD_R(const real32_T *blkCS, con
                                              int_T blkPBWidthX, int_T blkPBHeightY,  
                                              int_T *xIdx,         int_T *yIdx);
 
+LIBMWVISIONRT_API void MWVIP_SearchMethod_Full_MAD_U8(const uint8_T *blkCS, const uint8_T *blkPB,
+                                             int_T rowsImgCS,   int_T rowsImgPB,  
+                                             int_T blkCSWidthX, int_T blkCSHeightY,  
+                                             int_T blkPBWidthX, int_T blkPBHeightY,  
+                                             int_T *xIdx,         int_T *yIdx);
+
+LIBMWVISIONRT_API void MWVIP_SearchMethod_3Step_MAD_U8(const uint8_T *blkCS, const uint8_T *blkPB,
+                                             int_T rowsImgCS,   int_T rowsImgPB,  
+                                             int_T blkCSWidthX, int_T blkCSHeightY,  
+                                             int_T blkPBWidthX, int_T blkPBHeightY,  
+                                             int_T *xIdx,         int_T *yIdx);
+
+LIBMWVISIONRT_API void MWVIP_SearchMethod_Full_MAD_U16(const uint16_T *blkCS, const uint16_T *blkPB,
+                                             int_T rowsImgCS,   int_T rowsImgPB,  
+                                             int_T blkCSWidthX, int_T blkCSHeightY,  
+                                             int_T blkPBWidthX, int_T blkPBHeightY,  
+                                             int_T *xIdx,         int_T *yIdx);
+
+LIBMWVISIONRT_API void MWVIP_SearchMethod_3Step_MAD_U16(const uint16_T *blkCS, const uint16_T *blkPB,
+                                             int_T rowsImgCS,   int_T rowsImgPB,  
+                                             int_T blkCSWidthX, int_T blkCSHeightY,  
+                                             int_T blkPBWidthX, int_T blkPBHeightY,  
+                                             int_T *xIdx,         int_T *yIdx);
+
+/* streaming mode: the frames are padded once and the buffers swap roles */
+LIBMWVISIONRT_API void MWVIP_BlockMatching_Stream_D(
+                                const real_T *uImgCurr,
+                                real_T *paddedImg0,
+                                real_T *paddedImg1,
+                                int32_T *prevSlot,
+                                MWVIP_SEARCH_METHOD_FUNC_D searchFcn,
+                                real_T *yMVsqmag,
+                                creal_T *yMVcplx,
+                                int32_T *blockSize,
+                                int32_T *overlapSize,
+                                int32_T *maxDisplSize,
+                                const int_T inRows,
+                                const int_T inCols,
+                                const int_T rowsPadImgP,
+                                const int_T colsPadImgP);
+
+LIBMWVISIONRT_API void MWVIP_BlockMatching_Stream_R(
+                                const real32_T *uImgCurr,
+                                real32_T *paddedImg0,
+                                real32_T *paddedImg1,
+                                int32_T *prevSlot,
+                                MWVIP_SEARCH_METHOD_FUNC_R searchFcn,
+                                real32_T *yMVsqmag,
+                                creal32_T *yMVcplx,
+                                int32_T *blockSize,
+                                int32_T *overlapSize,
+                                int32_T *maxDisplSize,
+                                const int_T inRows,
+                                const int_T inCols,
+                                const int_T rowsPadImgP,
+                                const int_T colsPadImgP);
+
+LIBMWVISIONRT_API void MWVIP_BlockMatching_Stream_U8(
+                                const uint8_T *uImgCurr,
+                                uint8_T *paddedImg0,
+                                uint8_T *paddedImg1,
+                                int32_T *prevSlot,
+                                MWVIP_SEARCH_METHOD_FUNC_U8 searchFcn,
+                                real32_T *yMVsqmag,
+                                creal32_T *yMVcplx,
+                                int32_T *blockSize,
+                                int32_T *overlapSize,
+                                int32_T *maxDisplSize,
+                                const int_T inRows,
+                                const int_T inCols,
+                                const int_T rowsPadImgP,
+                                const int_T colsPadImgP);
+
+LIBMWVISIONRT_API void MWVIP_BlockMatching_Stream_U16(
+                                const uint16_T *uImgCurr,
+                                uint16_T *paddedImg0,
+                                uint16_T *paddedImg1,
+                                int32_T *prevSlot,
+                                MWVIP_SEARCH_METHOD_FUNC_U16 searchFcn,
+                                real32_T *yMVsqmag,
+                                creal32_T *yMVcplx,
+                                int32_T *blockSize,
+                                int32_T *overlapSize,
+                                int32_T *maxDisplSize,
+                                const int_T inRows,
+                                const int_T inCols,
+                                const int_T rowsPadImgP,
+                                const int_T colsPadImgP);
+
+/* hierarchical search: pyramid vector and spatio-temporal predictors */
+LIBMWVISIONRT_API void MWVIP_BlockMatching_Hier_MAD_D(
+                                const real_T *uImgCurr,
+                                const real_T *uImgPrev,
+                                real_T *paddedImgC,
+                                real_T *paddedImgP,
+                                real_T *pyrC,
+                                real_T *pyrP,
+                                const int32_T *prevMV,
+                                int32_T *yMV,
+                                real_T *yMVsqmag,
+                                int32_T *blockSize,
+                                int32_T *overlapSize,
+                                int32_T *maxDisplSize,
+                                int32_T numLevels,
+                                const int_T inRows,
+                                const int_T inCols,
+                                const int_T rowsPadImgP,
+                                const int_T colsPadImgP);
+
+LIBMWVISIONRT_API void MWVIP_BlockMatching_Hier_MAD_R(
+                                const real32_T *uImgCurr,
+                                const real32_T *uImgPrev,
+                                real32_T *paddedImgC,
+                                real32_T *paddedImgP,
+                                real32_T *pyrC,
+                                real32_T *pyrP,
+                                const int32_T *prevMV,
+                                int32_T *yMV,
+                                real32_T *yMVsqmag,
+                                int32_T *blockSize,
+                                int32_T *overlapSize,
+                                int32_T *maxDisplSize,
+                                int32_T numLevels,
+                                const int_T inRows,
+                                const int_T inCols,
+                                const int_T rowsPadImgP,
+                                const int_T colsPadImgP);
+
+LIBMWVISIONRT_API void MWVIP_BlockMatching_Hier_MAD_U8(
+                                const uint8_T *uImgCurr,
+                                const uint8_T *uImgPrev,
+                                uint8_T *paddedImgC,
+                                uint8_T *paddedImgP,
+                                uint8_T *pyrC,
+                                uint8_T *pyrP,
+                                const int32_T *prevMV,
+                                int32_T *yMV,
+                                real32_T *yMVsqmag,
+                                int32_T *blockSize,
+                                int32_T *overlapSize,
+                                int32_T *maxDisplSize,
+                                int32_T numLevels,
+                                const int_T inRows,
+                                const int_T inCols,
+                                const int_T rowsPadImgP,
+                                const int_T colsPadImgP);
+
 #ifdef __cplusplus
 } /*  close brace for extern C from above */
 #endif
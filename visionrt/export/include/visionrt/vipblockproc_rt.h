@@ -0,0 +1,93 @@
+/*
+ *  vipblockproc_rt.h
+ *
+ *  Copyright 2016 The MathWorks, Inc.
+ */
+
+#ifndef vipblockproc_rt_h
+#define vipblockproc_rt_h
+
+#include "dsp_rt.h"
+#include "libmwvisionrt_util.h"
+
+/*
+ * Tile table and parallel iteration for the Block Processing block.
+ *
+ * A rows-by-cols input is cut into blkRows-by-blkCols blocks, adjacent
+ * blocks sharing ovlRows rows and ovlCols columns, so that the blocks start
+ * every blkRows - ovlRows rows and blkCols - ovlCols columns, or every row
+ * and column when the overlap is the whole block; the blocks
+ * cover the whole input, and the part of the last ones past its edge is
+ * read as zeros. MWVIP_BlockProc_Tiles lists the blocks once, in the
+ * iteration order of the block, row-wise (along the rows of blocks first)
+ * or column-wise, with their place in the input, the part of them inside
+ * it and their place in the grid of blocks, so that no iteration computes
+ * its borders.
+ *
+ * MWVIP_BlockProc_Run calls fcn for each iteration. When the sub-block
+ * process has no states and no side effects, the iterations are
+ * independent and, with parallel set and compiled with OpenMP, run on
+ * several threads, each taking the next block as soon as it is done with
+ * one, so that blocks of uneven cost balance. thread is the index of the
+ * calling thread, below MWVIP_BlockProc_MaxThreads(), for the scratch
+ * memory of the sub-block process. MWVIP_BlockProc_Extract copies a block,
+ * zero padded, out of an input; MWVIP_BlockProc_Insert copies the output
+ * of an iteration to its place in the grid of output blocks. Both work on
+ * column-major data of any elemSize bytes, and the outputs of different
+ * iterations never overlap. They copy one plane; multichannel data take
+ * one call per plane.
+ */
+
+typedef struct {
+    int32_T iter;             /* iteration, zero based */
+    int32_T gridRow, gridCol; /* place in the grid of blocks */
+    int32_T row, col;         /* top left in the input */
+    int32_T rows, cols;       /* of the block inside the input */
+} MWVIP_BLOCKPROC_TILE;
+
+typedef void (*MWVIP_BlockProc_Fcn)(void *ctx, const MWVIP_BLOCKPROC_TILE *tile,
+                                    int_T thread);
+
+/* Define MWVIP_BLOCKPROC_SERIAL to iterate on one thread. */
+#if defined(_OPENMP) && !defined(MWVIP_BLOCKPROC_SERIAL)
+  #define MWVIP_BLOCKPROC_PARALLEL 1
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* number of blocks of each dimension */
+LIBMWVISIONRT_API void MWVIP_BlockProc_GridSize(int_T rows, int_T cols,
+                                                int_T blkRows, int_T blkCols,
+                                                int_T ovlRows, int_T ovlCols,
+                                                int32_T *gridRows, int32_T *gridCols);
+/* tiles holds gridRows*gridCols entries */
+LIBMWVISIONRT_API void MWVIP_BlockProc_Tiles(int_T rows, int_T cols,
+                                             int_T blkRows, int_T blkCols,
+                                             int_T ovlRows, int_T ovlCols,
+                                             boolean_T rowWise,
+                                             MWVIP_BLOCKPROC_TILE *tiles);
+
+LIBMWVISIONRT_API int_T MWVIP_BlockProc_MaxThreads(void);
+LIBMWVISIONRT_API void MWVIP_BlockProc_Run(const MWVIP_BLOCKPROC_TILE *tiles,
+                                           int32_T numTiles,
+                                           MWVIP_BlockProc_Fcn fcn, void *ctx,
+                                           boolean_T parallel);
+
+LIBMWVISIONRT_API void MWVIP_BlockProc_Extract(const void *in, int_T rows,
+                                               int_T elemSize,
+                                               const MWVIP_BLOCKPROC_TILE *tile,
+                                               int_T blkRows, int_T blkCols,
+                                               void *blk);
+LIBMWVISIONRT_API void MWVIP_BlockProc_Insert(void *out, int_T outRows,
+                                              int_T elemSize,
+                                              const MWVIP_BLOCKPROC_TILE *tile,
+                                              int_T outBlkRows, int_T outBlkCols,
+                                              const void *blk);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* vipblockproc_rt_h */
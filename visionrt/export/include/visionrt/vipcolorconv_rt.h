@@ -0,0 +1,96 @@
+/*
+ *  vipcolorconv_rt.h
+ *
+ *  Copyright 2016 The MathWorks, Inc.
+ */
+#ifndef vipcolorconv_rt_h
+#define vipcolorconv_rt_h
+
+#include "dsp_rt.h"
+#include "libmwvisionrt_util.h"
+
+/*
+ * Whole plane color space conversions of the Color Space Conversion block.
+ * The planes are column major, rows-by-cols, and are converted 16 (uint8)
+ * or 4 (single) pixels at a time with SSE2 or NEON; the single precision
+ * kernels are plain C loops on NEON.
+ *
+ * R'G'B' <-> Y'CbCr follows Rec. 601 or Rec. 709 (1125/60/2:1), selected by
+ * standard; Rec. 709 1250/50/2:1 uses the Rec. 601 matrix. Y' spans
+ * [16, 235] and Cb, Cr [16, 240] in uint8, the same divided by 255 in
+ * single, where R'G'B' spans [0, 1]. The uint8 kernels compute in fixed
+ * point, Q15 for R'G'B' -> Y'CbCr and Q13 for Y'CbCr -> R'G'B', rounded to
+ * nearest and saturated; they give the same results with and without SIMD.
+ * Y'CbCr -> R'G'B' saturates to [0, 255] or [0, 1].
+ *
+ * chroma selects the size of the Cb and Cr planes:
+ *  MWVIP_CSC_CHROMA_444  rows-by-cols
+ *  MWVIP_CSC_CHROMA_422  rows-by-(cols+1)/2; column k of the chroma is the
+ *                        mean of the chroma of columns 2k and 2k+1, and is
+ *                        used for both of them on the way back
+ * With cb and cr both NULL, MWVIP_RGB2YCbCr_* computes the luma only.
+ *
+ * R'G'B' <-> HSV follows rgb2hsv and hsv2rgb: H, S and V in [0, 1], H is 0
+ * for grays.
+ *
+ * MWVIP_Packed422ToRGB_U8 and MWVIP_Packed422ToLuma_U8 convert a packed
+ * 4:2:2 Rec. 601 frame of rows lines of cols macropixels, as read into the
+ * staging buffer by the MWVIP_*_ReadFrame functions of vipfileread_rt.h
+ * called with a NULL Y port, into rows-by-2*cols planes, transposing the
+ * lines as they go: the frame is read once, without the planar Y'CbCr
+ * copy.
+ */
+#define MWVIP_CSC_REC601 0
+#define MWVIP_CSC_REC709 1
+
+#define MWVIP_CSC_CHROMA_444 0
+#define MWVIP_CSC_CHROMA_422 1
+
+/* byte order of the packed 4:2:2 macropixels */
+#define MWVIP_CSC_YUY2 0
+#define MWVIP_CSC_UYVY 1
+#define MWVIP_CSC_YVYU 2
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+LIBMWVISIONRT_API void MWVIP_RGB2YCbCr_U8(const uint8_T *r, const uint8_T *g,
+                                          const uint8_T *b, uint8_T *y,
+                                          uint8_T *cb, uint8_T *cr,
+                                          int_T rows, int_T cols,
+                                          int_T standard, int_T chroma);
+LIBMWVISIONRT_API void MWVIP_YCbCr2RGB_U8(const uint8_T *y, const uint8_T *cb,
+                                          const uint8_T *cr, uint8_T *r,
+                                          uint8_T *g, uint8_T *b,
+                                          int_T rows, int_T cols,
+                                          int_T standard, int_T chroma);
+LIBMWVISIONRT_API void MWVIP_RGB2YCbCr_R(const real32_T *r, const real32_T *g,
+                                         const real32_T *b, real32_T *y,
+                                         real32_T *cb, real32_T *cr,
+                                         int_T rows, int_T cols,
+                                         int_T standard, int_T chroma);
+LIBMWVISIONRT_API void MWVIP_YCbCr2RGB_R(const real32_T *y, const real32_T *cb,
+                                         const real32_T *cr, real32_T *r,
+                                         real32_T *g, real32_T *b,
+                                         int_T rows, int_T cols,
+                                         int_T standard, int_T chroma);
+LIBMWVISIONRT_API void MWVIP_RGB2HSV_R(const real32_T *r, const real32_T *g,
+                                       const real32_T *b, real32_T *h,
+                                       real32_T *s, real32_T *v,
+                                       int_T numPixels);
+LIBMWVISIONRT_API void MWVIP_HSV2RGB_R(const real32_T *h, const real32_T *s,
+                                       const real32_T *v, real32_T *r,
+                                       real32_T *g, real32_T *b,
+                                       int_T numPixels);
+LIBMWVISIONRT_API void MWVIP_Packed422ToRGB_U8(const uint8_T *frame, int_T layout,
+                                               uint8_T *r, uint8_T *g, uint8_T *b,
+                                               int_T rows, int_T cols);
+LIBMWVISIONRT_API void MWVIP_Packed422ToLuma_U8(const uint8_T *frame, int_T layout,
+                                                uint8_T *y, int_T rows, int_T cols);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  /* vipcolorconv_rt_h */
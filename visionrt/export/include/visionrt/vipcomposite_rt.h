@@ -0,0 +1,92 @@
+/*
+ *  vipcomposite_rt.h
+ *
+ *  Copyright 2016 The MathWorks, Inc.
+ */
+
+#ifndef vipcomposite_rt_h
+#define vipcomposite_rt_h
+
+#include "dsp_rt.h"
+#include "libmwvisionrt_util.h"
+
+/*
+ * Fixed point blending of an overlay onto an image for the Compositing
+ * block and vision.AlphaBlender.
+ *
+ * dst is the dRows-by-dCols image, src the sRows-by-sCols overlay, both
+ * column major with nChans planes; the top left pixel of src lands on
+ * (row0, col0) of dst, and the part of src outside dst is ignored. Each
+ * pixel of src under the mask becomes
+ *     out = dst + alpha*(src - dst)
+ * with alpha in fixed point, MWVIP_COMPOSITE_ALPHA_BITS_<DataType>
+ * fraction bits, rounded to nearest: (dst*(one - a) + src*a + one/2) >> bits.
+ * MWVIP_Composite_AlphaQ converts the opacity of the block, one value or
+ * one per overlay pixel, once for all frames. alphaQ is NULL for the
+ * Binary mask operation, which copies the overlay pixels; with
+ * alphaPerPixel 0 it holds one alpha for the whole overlay.
+ *
+ * runs, when not NULL, restricts the blending to the numRuns runs of
+ * MWVIP_Composite_MaskRuns, built once from the mask of a small overlay
+ * or of a sparse mask, so that neither the mask nor the pixels outside it
+ * are read for each frame; with runs NULL the whole overlay is blended.
+ *
+ * The runs are blended 8 or 16 pixels at a time with SSE2 or NEON, on
+ * several threads when compiled with OpenMP; the results are the same on
+ * every path.
+ */
+#define MWVIP_COMPOSITE_ALPHA_BITS_U8  8
+#define MWVIP_COMPOSITE_ALPHA_BITS_U16 15
+
+/* one column segment of a mask */
+typedef struct {
+    int32_T col;
+    int32_T row;
+    int32_T len;
+} MWVIP_COMPOSITE_RUN;
+
+/* most runs of a rows-by-cols mask */
+#define MWVIP_COMPOSITE_MAX_RUNS(rows, cols) ((((rows) + 1)/2)*(cols))
+
+/* Define MWVIP_COMPOSITE_SERIAL to blend on one thread. */
+#if defined(_OPENMP) && !defined(MWVIP_COMPOSITE_SERIAL)
+  #define MWVIP_COMPOSITE_PARALLEL 1
+#endif
+
+/* smallest number of pixels worth the threads */
+#ifndef MWVIP_COMPOSITE_MIN_PARALLEL
+  #define MWVIP_COMPOSITE_MIN_PARALLEL 65536
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+LIBMWVISIONRT_API void MWVIP_Composite_AlphaQ(const real_T *alpha, int_T n,
+                                              int_T fracBits, uint16_T *alphaQ);
+LIBMWVISIONRT_API int32_T MWVIP_Composite_MaskRuns(const boolean_T *mask,
+                                                   int_T rows, int_T cols,
+                                                   MWVIP_COMPOSITE_RUN *runs);
+
+LIBMWVISIONRT_API void MWVIP_Composite_Blend_U8(uint8_T *dst, int_T dRows, int_T dCols,
+                                                const uint8_T *src, int_T sRows,
+                                                int_T sCols, int_T nChans,
+                                                int_T row0, int_T col0,
+                                                const uint16_T *alphaQ,
+                                                boolean_T alphaPerPixel,
+                                                const MWVIP_COMPOSITE_RUN *runs,
+                                                int32_T numRuns);
+LIBMWVISIONRT_API void MWVIP_Composite_Blend_U16(uint16_T *dst, int_T dRows, int_T dCols,
+                                                 const uint16_T *src, int_T sRows,
+                                                 int_T sCols, int_T nChans,
+                                                 int_T row0, int_T col0,
+                                                 const uint16_T *alphaQ,
+                                                 boolean_T alphaPerPixel,
+                                                 const MWVIP_COMPOSITE_RUN *runs,
+                                                 int32_T numRuns);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* vipcomposite_rt_h */
@@ -0,0 +1,94 @@
+/*
+ *  vipconv2d_rt.h
+ *
+ *  Copyright 2016 The MathWorks, Inc.
+ */
+
+#ifndef vipconv2d_rt_h
+#define vipconv2d_rt_h
+
+#include "dsp_rt.h"
+#include "libmwvisionrt_util.h"
+
+/*
+ * Two-dimensional convolution of a column major image for the 2-D FIR
+ * Filter block and vision.Convolver, with three strategies:
+ *
+ *  MWVIP_CONV2D_DIRECT     each tap of the kernel adds a shifted input
+ *                          column to the output column, a SIMD
+ *                          multiply-add along the contiguous rows.
+ *  MWVIP_CONV2D_SEPARABLE  the kernel is split by its SVD into rank
+ *                          column-times-row terms, rank its numerical rank,
+ *                          each applied as a column and a row filter:
+ *                          rank*(kRows + kCols) instead of kRows*kCols
+ *                          multiply-adds per pixel.
+ *  MWVIP_CONV2D_FFT        overlap-save on tiles of fftRows-by-fftCols
+ *                          points, powers of two: each tile gives
+ *                          (fftRows-kRows+1)-by-(fftCols-kCols+1) outputs.
+ *                          Two tiles share one complex FFT, one in the real
+ *                          and one in the imaginary part.
+ *
+ * MWVIP_CONV2D_AUTO picks the cheapest of them with MWVIP_Conv2D_Plan,
+ * which counts the multiply-adds of each strategy, the FFT butterflies
+ * weighted by MWVIP_CONV2D_FFT_WEIGHT, over every FFT size. Any other
+ * strategy overrides the choice.
+ *
+ * shape is MWVIP_CONV2D_FULL, SAME (the central part, of the size of the
+ * input, as conv2) or VALID; the image is padded with zeros. With
+ * correlate, the kernel is rotated by 180 degrees first. The outputs of
+ * the strategies differ only by rounding.
+ *
+ * MWVIP_Conv2D_<DataType> returns the strategy used, or -1 when it cannot
+ * allocate its buffers. The strips of output columns, the columns of the
+ * separable passes and the pairs of FFT tiles run on several threads when
+ * compiled with OpenMP.
+ */
+#define MWVIP_CONV2D_AUTO      0
+#define MWVIP_CONV2D_DIRECT    1
+#define MWVIP_CONV2D_SEPARABLE 2
+#define MWVIP_CONV2D_FFT       3
+
+#define MWVIP_CONV2D_FULL  0
+#define MWVIP_CONV2D_SAME  1
+#define MWVIP_CONV2D_VALID 2
+
+/* multiply-adds of the direct path one FFT butterfly is worth */
+#ifndef MWVIP_CONV2D_FFT_WEIGHT
+  #define MWVIP_CONV2D_FFT_WEIGHT 8
+#endif
+
+/* Define MWVIP_CONV2D_SERIAL to convolve on one thread. The output does
+ * not depend on the number of threads. */
+#if defined(_OPENMP) && !defined(MWVIP_CONV2D_SERIAL)
+  #define MWVIP_CONV2D_PARALLEL 1
+#endif
+
+/* smallest number of multiply-adds worth the threads */
+#ifndef MWVIP_CONV2D_MIN_PARALLEL
+  #define MWVIP_CONV2D_MIN_PARALLEL 262144
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* rank is the numerical rank of the kernel, 0 when unknown */
+LIBMWVISIONRT_API int_T MWVIP_Conv2D_Plan(int_T inRows, int_T inCols,
+                                          int_T kRows, int_T kCols,
+                                          int_T shape, int_T rank, int_T strategy,
+                                          int_T *fftRows, int_T *fftCols);
+
+LIBMWVISIONRT_API int_T MWVIP_Conv2D_D(const real_T *in, int_T inRows, int_T inCols,
+                                       const real_T *kernel, int_T kRows, int_T kCols,
+                                       real_T *out, int_T shape, boolean_T correlate,
+                                       int_T strategy);
+LIBMWVISIONRT_API int_T MWVIP_Conv2D_R(const real32_T *in, int_T inRows, int_T inCols,
+                                       const real32_T *kernel, int_T kRows, int_T kCols,
+                                       real32_T *out, int_T shape, boolean_T correlate,
+                                       int_T strategy);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* vipconv2d_rt_h */
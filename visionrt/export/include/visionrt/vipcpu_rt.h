@@ -0,0 +1,44 @@
+/*
+ *  vipcpu_rt.h
+ *
+ *  Copyright 2016 The MathWorks, Inc.
+ */
+#ifndef vipcpu_rt_h
+#define vipcpu_rt_h
+
+#include "dsp_rt.h"
+#include "libmwvisionrt_util.h"
+
+/*
+ * Instruction sets available at run time, as reported by
+ * MWVIP_CpuFeatures. The x86 vector extensions are only reported when the
+ * operating system also saves the registers they use. Kernels compiled for
+ * one of these sets call MWVIP_CpuFeatures once and fall back to their
+ * baseline (SSE2 or NEON at compile time, or C) otherwise, so that a
+ * single library binary runs on any CPU of its architecture.
+ *
+ * Define MWVIP_CPU_DISPATCH_OFF to report no features and always run the
+ * baseline kernels.
+ */
+#define MWVIP_CPU_SSE2     0x0001U
+#define MWVIP_CPU_SSE42    0x0002U
+#define MWVIP_CPU_POPCNT   0x0004U
+#define MWVIP_CPU_AVX      0x0008U
+#define MWVIP_CPU_AVX2     0x0010U
+#define MWVIP_CPU_FMA      0x0020U
+#define MWVIP_CPU_AVX512F  0x0040U
+#define MWVIP_CPU_AVX512BW 0x0080U
+#define MWVIP_CPU_NEON     0x0100U
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* bitwise OR of the MWVIP_CPU_* flags; detected on the first call */
+LIBMWVISIONRT_API uint32_T MWVIP_CpuFeatures(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  /* vipcpu_rt_h */
@@ -0,0 +1,58 @@
+/*
+ *  vipdct_rt.h
+ *
+ *  Copyright 2016 The MathWorks, Inc.
+ */
+
+#ifndef vipdct_rt_h
+#define vipdct_rt_h
+
+#include "dsp_rt.h"
+#include "libmwvisionrt_util.h"
+
+/*
+ * Integer 2-D DCT and IDCT of the 8-by-8 blocks of a frame, for the 2-D
+ * DCT and 2-D IDCT blocks and vision.DCT/vision.IDCT on block transform
+ * data.
+ *
+ * The frame is rows-by-cols, column major; the blocks tile it from the top
+ * left, and the rows and columns past the last whole block are left as
+ * they are. The coefficients of a block are those of the orthonormal DCT
+ *     Y(u,v) = 1/4 C(u) C(v) sum X(x,y) cos((2x+1)u pi/16) cos((2y+1)v pi/16)
+ * with C(0) = 1/sqrt(2), C(k) = 1 otherwise, rounded to integers, in the
+ * place of the pixels of the block. MWVIP_IDCT8x8_S16 rounds and saturates
+ * its output to uint8, and saturates its coefficients to those a uint8
+ * block can have, [-1024, 1023] about the level shift of 1024 of the DC
+ * coefficient.
+ *
+ * The 1-D transforms are those of Loeffler, Ligtenberg and Moschytz with
+ * 13 bit constants and 2 extra bits between the passes, as in the JPEG
+ * library. With SSE2 or NEON each pass transforms 8 lines of a block at
+ * once in 16 bit lanes, multiplying in pairs into 32 bits; the results are
+ * the same as those of the C code.
+ */
+
+/* Define MWVIP_DCT_SERIAL to transform on one thread. */
+#if defined(_OPENMP) && !defined(MWVIP_DCT_SERIAL)
+  #define MWVIP_DCT_PARALLEL 1
+#endif
+
+/* smallest number of pixels worth the threads */
+#ifndef MWVIP_DCT_MIN_PARALLEL
+  #define MWVIP_DCT_MIN_PARALLEL 65536
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+LIBMWVISIONRT_API void MWVIP_DCT8x8_U8(const uint8_T *in, int_T rows, int_T cols,
+                                       int16_T *out);
+LIBMWVISIONRT_API void MWVIP_IDCT8x8_S16(const int16_T *in, int_T rows, int_T cols,
+                                         uint8_T *out);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* vipdct_rt_h */
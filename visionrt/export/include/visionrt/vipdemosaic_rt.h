@@ -0,0 +1,84 @@
+/*
+ *  vipdemosaic_rt.h
+ *
+ *  Copyright 2016 The MathWorks, Inc.
+ */
+
+#ifndef vipdemosaic_rt_h
+#define vipdemosaic_rt_h
+
+#include "dsp_rt.h"
+#include "libmwvisionrt_util.h"
+
+/*
+ * Demosaicing of a whole Bayer image for the Demosaic block.
+ *
+ * in is the rows-by-cols column major Bayer image, with the sensor
+ * alignment given by the top left 2x2 pixels in row-wise order. rgb, when
+ * not NULL, receives the R, G and B planes after each other; gray, when not
+ * NULL, receives the rgb2gray luminance of the interpolated pixels,
+ * 0.2989 R + 0.5870 G + 0.1140 B rounded to nearest.
+ *
+ * Every missing color of a pixel is one of four filters of its 5x5
+ * neighborhood, picked by the Bayer phase of the pixel:
+ *  G at R or B         bilinear: the 4 nearest G
+ *                      gradient-corrected: (4C + 2(N+S+E+W) - (NN+SS+EE+WW))/8
+ *  color of the row    bilinear: (W+E)/2
+ *  neighbors at G      gradient-corrected:
+ *                      (5C + 4(W+E) - (WW+EE) - (NW+NE+SW+SE) + (NN+SS)/2)/8
+ *  color of the column the same transposed
+ *  neighbors at G
+ *  B at R or R at B    bilinear: the 4 diagonal neighbors
+ *                      gradient-corrected:
+ *                      (6C + 2(NW+NE+SW+SE) - 3(NN+SS+EE+WW)/2)/8
+ * where C is the pixel itself. The results are rounded to nearest and
+ * saturated to the range of the data type. Beyond the image border the
+ * rows and columns are mirrored about the border pixel, which keeps the
+ * Bayer phase.
+ *
+ * The pixels of a column are processed 8 at a time with SSE2 or NEON: all
+ * filters are computed for both phases of the column, and the lanes of the
+ * even and of the odd rows are picked from them with masks.
+ */
+#define MWVIP_DEMOSAIC_BILINEAR  0
+#define MWVIP_DEMOSAIC_GRADIENT  1
+
+#define MWVIP_DEMOSAIC_GBRG 0
+#define MWVIP_DEMOSAIC_GRBG 1
+#define MWVIP_DEMOSAIC_BGGR 2
+#define MWVIP_DEMOSAIC_RGGB 3
+
+/* When compiled with OpenMP, strips of columns, the contiguous lines of
+ * the column major image, are demosaiced on several threads. The output
+ * does not depend on the number of threads. Define MWVIP_DEMOSAIC_SERIAL
+ * to demosaic on one thread. */
+#if defined(_OPENMP) && !defined(MWVIP_DEMOSAIC_SERIAL)
+  #define MWVIP_DEMOSAIC_PARALLEL 1
+#endif
+
+/* smallest number of pixels worth the threads */
+#ifndef MWVIP_DEMOSAIC_MIN_PARALLEL
+  #define MWVIP_DEMOSAIC_MIN_PARALLEL 65536
+#endif
+
+/* columns per strip given to a thread */
+#ifndef MWVIP_DEMOSAIC_STRIP_COLS
+  #define MWVIP_DEMOSAIC_STRIP_COLS 16
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+LIBMWVISIONRT_API void MWVIP_Demosaic_U8(const uint8_T *in, uint8_T *rgb,
+                                         uint8_T *gray, int_T rows, int_T cols,
+                                         int_T alignment, int_T method);
+LIBMWVISIONRT_API void MWVIP_Demosaic_U16(const uint16_T *in, uint16_T *rgb,
+                                          uint16_T *gray, int_T rows, int_T cols,
+                                          int_T alignment, int_T method);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* vipdemosaic_rt_h */
@@ -0,0 +1,76 @@
+/*
+ *  vipdrawshapes_rt.h
+ *
+ *  Copyright 2016 The MathWorks, Inc.
+ */
+
+#ifndef vipdrawshapes_rt_h
+#define vipdrawshapes_rt_h
+
+#include "dsp_rt.h"
+#include "libmwvisionrt_util.h"
+
+/*
+ * Batched filling of polygons for the Draw Shapes and Draw Markers blocks,
+ * vision.ShapeInserter and vision.MarkerInserter, when a frame carries many
+ * filled shapes: boxes are polygons of 4 vertices.
+ *
+ * pts holds the zero-based [row col] vertices of all the polygons one
+ * after the other, numVertices[p] of them for polygon p. The edges of all
+ * the polygons go to one edge table, bucketed once by their first column.
+ * The image, rows-by-cols with nChans planes, is then scanned column by
+ * column, the columns being the contiguous scanlines: the active edges
+ * cross each column at their rounded row, and the crossings of each
+ * polygon delimit its spans with the even-odd rule. A column is covered by
+ * the edges that start at or before it and end after it, and by those that
+ * end on the last column of their polygon, so that a box of vertices
+ * (r, c), (r, c+w-1), (r+h-1, c+w-1), (r+h-1, c) fills exactly h-by-w
+ * pixels. The vertices may lie outside the image.
+ *
+ * The spans are drawn in the order of the polygons with the nChans values
+ * of color of each, blended as out = in + opacity*(color - in); opacity is
+ * NULL for opaque polygons. The uint8 spans are blended 16 pixels at a time
+ * with SSE2 or NEON, with the opacity rounded to a multiple of 1/256.
+ *
+ * The functions return 0 when they cannot allocate the edge table.
+ */
+
+/* When compiled with OpenMP, bands of MWVIP_DRAWSHAPES_BAND_COLS columns
+ * are filled on several threads; every band walks the same edge table.
+ * The output does not depend on the number of threads. Define
+ * MWVIP_DRAWSHAPES_SERIAL to fill on one thread. */
+#if defined(_OPENMP) && !defined(MWVIP_DRAWSHAPES_SERIAL)
+  #define MWVIP_DRAWSHAPES_PARALLEL 1
+#endif
+
+/* smallest number of edges worth the threads */
+#ifndef MWVIP_DRAWSHAPES_MIN_PARALLEL
+  #define MWVIP_DRAWSHAPES_MIN_PARALLEL 256
+#endif
+
+#ifndef MWVIP_DRAWSHAPES_BAND_COLS
+  #define MWVIP_DRAWSHAPES_BAND_COLS 64
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+LIBMWVISIONRT_API boolean_T MWVIP_FillPolygons_U8(uint8_T *img, int_T rows, int_T cols,
+                                                  int_T nChans, const int32_T *pts,
+                                                  const int32_T *numVertices,
+                                                  int_T numPolygons,
+                                                  const uint8_T *color,
+                                                  const real32_T *opacity);
+LIBMWVISIONRT_API boolean_T MWVIP_FillPolygons_R(real32_T *img, int_T rows, int_T cols,
+                                                 int_T nChans, const int32_T *pts,
+                                                 const int32_T *numVertices,
+                                                 int_T numPolygons,
+                                                 const real32_T *color,
+                                                 const real32_T *opacity);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* vipdrawshapes_rt_h */
@@ -34,10 +34,83 @@ extern "C" {
                                            uint16_T,uint16_T,uint32_T,uint32_T,void*,void*,void*,
                                            const void*,const void*,boolean_T);
 
+	/* one glyph of a glyph run, with the arguments of a DRAW_TEXT_FUNC_* call */
+	typedef struct {
+		const uint8_T* bitmap;
+		int32_T pen_x;
+		int32_T pen_y;
+		int32_T left_bearing;
+		int32_T top_bearing;
+		uint16_T bitmapWidth;
+		uint16_T bitmapHeight;
+	} MWVIP_DRAWTEXT_GLYPH;
+
 	LIBMWVISIONRT_API DRAW_TEXT_FUNC_RGB MWVIP_GetDrawTextFcn_RGB(int_T dataTypeID, boolean_T isAntiAliased);
 
 	LIBMWVISIONRT_API DRAW_TEXT_FUNC_I MWVIP_GetDrawTextFcn_I(int_T dataTypeID, boolean_T isAntiAliased);
 
+	/*
+	 * Glyph atlas of one font face and size, as built by
+	 * visionPopulateGlyphBuffer. The bitmaps of all the glyphs are packed in
+	 * glyphBitmapArray; glyph 0 is the missing glyph. The atlas only points
+	 * at the buffers, so it can be built once per font and kept across
+	 * frames and calls.
+	 */
+	typedef struct {
+		const uint8_T*  glyphBitmapArray;
+		const uint16_T* glyphIdxFromCharcode; /* numCharcodes entries */
+		const uint32_T* glyphBitmapStartIdx;
+		const uint16_T* glyphWidths;
+		const uint16_T* glyphHeights;
+		const int16_T*  glyphXAdvances;
+		const int16_T*  glyphLeftBearings;
+		const int16_T*  glyphTopBearings;
+		uint32_T numCharcodes;
+		int32_T  fontAscend;
+		int32_T  fontLinespace;
+		int32_T  spaceCharWidth; /* pen advance for missing glyphs */
+	} MWVIP_DRAWTEXT_ATLAS;
+
+	/*
+	 * Lay out numChars character codes starting at the top left corner
+	 * (textLocX, textLocY) and write one glyph per visible character to
+	 * glyphs, which must hold numChars entries. Newlines (10) start a new
+	 * line. Returns the number of glyphs written.
+	 */
+	LIBMWVISIONRT_API int32_T MWVIP_DrawText_LayoutGlyphs(const MWVIP_DRAWTEXT_ATLAS* atlas,
+		const uint16_T* text,
+		int32_T numChars,
+		int32_T textLocX,
+		int32_T textLocY,
+		MWVIP_DRAWTEXT_GLYPH* glyphs);
+
+	/*
+	 * Draw numGlyphs glyphs with drawTextFcn, as returned by
+	 * MWVIP_GetDrawTextFcn_*. Glyphs without a bitmap or outside the image
+	 * are skipped.
+	 */
+	LIBMWVISIONRT_API void MWVIP_DrawTextRun_RGB(DRAW_TEXT_FUNC_RGB drawTextFcn,
+		const MWVIP_DRAWTEXT_GLYPH* glyphs,
+		int32_T numGlyphs,
+		uint32_T imageWidth,
+		uint32_T imageHeight,
+		void* outputImageR,
+		void* outputImageG,
+		void* outputImageB,
+		const void* colorVector,
+		const void* opacityPtr,
+		boolean_T isImageTransposed);
+
+	LIBMWVISIONRT_API void MWVIP_DrawTextRun_I(DRAW_TEXT_FUNC_I drawTextFcn,
+		const MWVIP_DRAWTEXT_GLYPH* glyphs,
+		int32_T numGlyphs,
+		uint32_T imageWidth,
+		uint32_T imageHeight,
+		void* outputImageR,
+		const void* colorVector,
+		const void* opacityPtr,
+		boolean_T isImageTransposed);
+
 	LIBMWVISIONRT_API void MWVIP_snprintf(char_T* outbuf, char_T* formatString,
 		void* items, int_T numItems,
 		int_T itemDataType, boolean_T isString, int_T size);
@@ -170,6 +243,137 @@ extern "C" {
         boolean_T isImageTransposed);
 
 
+	/*
+	 * uint8 and uint16: the color vector has the data type of the image and
+	 * opacityPtr points to a real_T opacity. The opacity and the coverage of
+	 * the glyph bitmap are combined into one Q16 weight per pixel, and the
+	 * pixels are blended in integer arithmetic, rounded to nearest.
+	 */
+
+	/* uint8 */
+	LIBMWVISIONRT_API void MWVIP_DrawText_RGB_uint8_AA(const uint8_T* fontBitmap,
+		int32_T pen_x,
+		int32_T pen_y,
+		int32_T left_bearing,
+		int32_T top_bearing,
+		uint16_T bitmapWidth,
+		uint16_T bitmapHeight,
+		uint32_T imageWidth,
+		uint32_T imageHeight,
+		void* outputImageR,
+		void* outputImageG,
+		void* outputImageB,
+		const void* colorVector,
+		const void* opacityPtr,
+        boolean_T isImageTransposed);
+
+	LIBMWVISIONRT_API void MWVIP_DrawText_RGB_uint8(const uint8_T* fontBitmap,
+		int32_T pen_x,
+		int32_T pen_y,
+		int32_T left_bearing,
+		int32_T top_bearing,
+		uint16_T bitmapWidth,
+		uint16_T bitmapHeight,
+		uint32_T imageWidth,
+		uint32_T imageHeight,
+		void* outputImageR,
+		void* outputImageG,
+		void* outputImageB,
+		const void* colorVector,
+		const void* opacityPtr,
+        boolean_T isImageTransposed);
+
+	LIBMWVISIONRT_API void MWVIP_DrawText_I_uint8_AA(const uint8_T* fontBitmap,
+		int32_T pen_x,
+		int32_T pen_y,
+		int32_T left_bearing,
+		int32_T top_bearing,
+		uint16_T bitmapWidth,
+		uint16_T bitmapHeight,
+		uint32_T imageWidth,
+		uint32_T imageHeight,
+		void* outputImageR,
+		const void* colorVector,
+		const void* opacityPtr,
+        boolean_T isImageTransposed);
+
+	LIBMWVISIONRT_API void MWVIP_DrawText_I_uint8(const uint8_T* fontBitmap,
+		int32_T pen_x,
+		int32_T pen_y,
+		int32_T left_bearing,
+		int32_T top_bearing,
+		uint16_T bitmapWidth,
+		uint16_T bitmapHeight,
+		uint32_T imageWidth,
+		uint32_T imageHeight,
+		void* outputImageR,
+		const void* colorVector,
+		const void* opacityPtr,
+        boolean_T isImageTransposed);
+
+
+	/* uint16 */
+	LIBMWVISIONRT_API void MWVIP_DrawText_RGB_uint16_AA(const uint8_T* fontBitmap,
+		int32_T pen_x,
+		int32_T pen_y,
+		int32_T left_bearing,
+		int32_T top_bearing,
+		uint16_T bitmapWidth,
+		uint16_T bitmapHeight,
+		uint32_T imageWidth,
+		uint32_T imageHeight,
+		void* outputImageR,
+		void* outputImageG,
+		void* outputImageB,
+		const void* colorVector,
+		const void* opacityPtr,
+        boolean_T isImageTransposed);
+
+	LIBMWVISIONRT_API void MWVIP_DrawText_RGB_uint16(const uint8_T* fontBitmap,
+		int32_T pen_x,
+		int32_T pen_y,
+		int32_T left_bearing,
+		int32_T top_bearing,
+		uint16_T bitmapWidth,
+		uint16_T bitmapHeight,
+		uint32_T imageWidth,
+		uint32_T imageHeight,
+		void* outputImageR,
+		void* outputImageG,
+		void* outputImageB,
+		const void* colorVector,
+		const void* opacityPtr,
+        boolean_T isImageTransposed);
+
+	LIBMWVISIONRT_API void MWVIP_DrawText_I_uint16_AA(const uint8_T* fontBitmap,
+		int32_T pen_x,
+		int32_T pen_y,
+		int32_T left_bearing,
+		int32_T top_bearing,
+		uint16_T bitmapWidth,
+		uint16_T bitmapHeight,
+		uint32_T imageWidth,
+		uint32_T imageHeight,
+		void* outputImageR,
+		const void* colorVector,
+		const void* opacityPtr,
+        boolean_T isImageTransposed);
+
+	LIBMWVISIONRT_API void MWVIP_DrawText_I_uint16(const uint8_T* fontBitmap,
+		int32_T pen_x,
+		int32_T pen_y,
+		int32_T left_bearing,
+		int32_T top_bearing,
+		uint16_T bitmapWidth,
+		uint16_T bitmapHeight,
+		uint32_T imageWidth,
+		uint32_T imageHeight,
+		void* outputImageR,
+		const void* colorVector,
+		const void* opacityPtr,
+        boolean_T isImageTransposed);
+
+
 	/* stuff for converting amongst data types... */
 	LIBMWVISIONRT_API void MWVIP_DrawText_copyDT1ToUint32(int32_T dataType1, uint32_T numElements, const void* input, void* uint32Output, int32_T dummy);
 
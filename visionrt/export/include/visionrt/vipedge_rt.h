@@ -45,6 +45,23 @@
 extern "C" {
 #endif
 
+/* number of rows of the strips of MWVIP_RC_Gaussian_Smoothing_* */
+#ifndef MWVIP_EDGE_STRIP_ROWS
+  #define MWVIP_EDGE_STRIP_ROWS 512
+#endif
+
+/* When compiled with OpenMP, MWVIP_Hysteresis_Thresholding_* tracks tiles
+ * of MWVIP_EDGE_TILE_COLS columns on several threads before joining them.
+ * The edges do not depend on the tiles. Define MWVIP_EDGE_SERIAL to track
+ * the whole image on one thread. */
+#if defined(_OPENMP) && !defined(MWVIP_EDGE_SERIAL)
+  #define MWVIP_EDGE_PARALLEL 1
+#endif
+
+#ifndef MWVIP_EDGE_TILE_COLS
+  #define MWVIP_EDGE_TILE_COLS 64
+#endif
+
 #define N_BINS       256
 #define N_BINS_MIN1  255
 #define MAG_SCALE 20
@@ -109,6 +126,22 @@ LIBMWVISIONRT_API void MWVIP_NonMaximum_Suppression_R(real32_T *dc,
                                   int_T inpRows,
                                   int_T inpCols);
 
+LIBMWVISIONRT_API void MWVIP_Hysteresis_Thresholding_D(boolean_T *edge,
+                                                   const real_T *mag,
+                                                   uint32_T  *worklist,
+                                                   real_T      highTh,
+                                                   real_T      lowTh,
+                                                   int_T      inpRows,
+                                                   int_T      inpCols);
+
+LIBMWVISIONRT_API void MWVIP_Hysteresis_Thresholding_R(boolean_T *edge,
+                                                   const real32_T *mag,
+                                                   uint32_T  *worklist,
+                                                   real32_T      highTh,
+                                                   real32_T      lowTh,
+                                                   int_T      inpRows,
+                                                   int_T      inpCols);
+
 LIBMWVISIONRT_API void MWVIP_EdgeCanny_userTh_D(
     const real_T  *inpImg,
     const real_T  *gauss1D,
@@ -165,6 +198,82 @@ LIBMWVISIONRT_API void MWVIP_EdgeCanny_autoTh_R(
           int_T  halfFiltLen
                                 );
 
+/* fused Canny: the intermediate images are replaced by line buffers */
+LIBMWVISIONRT_API void MWVIP_Canny_Fused_Magnitude_D(const real_T *inpImg,
+                                                 const real_T *gauss1D,
+                                                 const real_T *dgauss1D,
+                                                 real_T *lineBuffer,
+                                                 real_T *tmpOrMag,
+                                                 int_T inpRows,
+                                                 int_T inpCols,
+                                                 int_T halfFiltLen);
+
+LIBMWVISIONRT_API void MWVIP_Canny_Fused_Magnitude_R(const real32_T *inpImg,
+                                                 const real32_T *gauss1D,
+                                                 const real32_T *dgauss1D,
+                                                 real32_T *lineBuffer,
+                                                 real32_T *tmpOrMag,
+                                                 int_T inpRows,
+                                                 int_T inpCols,
+                                                 int_T halfFiltLen);
+
+LIBMWVISIONRT_API void MWVIP_EdgeCanny_Fused_userTh_D(
+    const real_T  *inpImg,
+    const real_T  *gauss1D,
+    const real_T  *dgauss1D,
+          real_T  *lineBuffer, /* DWork (2*halfFiltLen+6) columns */
+       boolean_T  *outEdge,
+          real_T  *tmpOrMag,   /* DWork same size as image */
+        uint32_T  *worklist,   /* DWork same size as image */
+    const real_T  *ThreshCanny,
+          int_T  inpRows,
+          int_T  inpCols,
+          int_T  halfFiltLen
+                                );
+
+LIBMWVISIONRT_API void MWVIP_EdgeCanny_Fused_userTh_R(
+    const real32_T  *inpImg,
+    const real32_T  *gauss1D,
+    const real32_T  *dgauss1D,
+          real32_T  *lineBuffer, /* DWork (2*halfFiltLen+6) columns */
+       boolean_T  *outEdge,
+          real32_T  *tmpOrMag,   /* DWork same size as image */
+          uint32_T  *worklist,   /* DWork same size as image */
+    const real32_T  *ThreshCanny,
+          int_T  inpRows,
+          int_T  inpCols,
+          int_T  halfFiltLen
+                                );
+
+LIBMWVISIONRT_API void MWVIP_EdgeCanny_Fused_autoTh_D(
+    const real_T  *inpImg,
+    const real_T  *gauss1D,
+    const real_T  *dgauss1D,
+          real_T  *lineBuffer, /* DWork (2*halfFiltLen+6) columns */
+       boolean_T  *outEdge,
+          real_T  *tmpOrMag,   /* DWork same size as image */
+        uint32_T  *worklist,   /* DWork same size as image */
+    const real_T  *autoPercent,
+          int_T  inpRows,
+          int_T  inpCols,
+          int_T  halfFiltLen
+                                );
+
+LIBMWVISIONRT_API void MWVIP_EdgeCanny_Fused_autoTh_R(
+    const real32_T  *inpImg,
+    const real32_T  *gauss1D,
+    const real32_T  *dgauss1D,
+          real32_T  *lineBuffer, /* DWork (2*halfFiltLen+6) columns */
+       boolean_T  *outEdge,
+          real32_T  *tmpOrMag,   /* DWork same size as image */
+          uint32_T  *worklist,   /* DWork same size as image */
+    const real32_T  *autoPercent,
+          int_T  inpRows,
+          int_T  inpCols,
+          int_T  halfFiltLen
+                                );
+
+
 #ifdef __cplusplus
 } /*  close brace for extern C from above */
 #endif
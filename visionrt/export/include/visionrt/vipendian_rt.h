@@ -14,6 +14,8 @@ extern "C" {
 #endif
 
 LIBMWVISIONRT_API int_T isLittleEndian(void);
+LIBMWVISIONRT_API void MWVIP_ByteSwapFrame(const void *src, void *dst,
+                                           int_T numElems, int_T bpe);
 
 #ifdef __cplusplus
 }
@@ -9,6 +9,23 @@
 
 #include "dsp_rt.h"
 #include "libmwvisionrt_util.h"
+#include <stddef.h>
+
+/*
+ * Memory mapped source of the Read Binary File block. The whole file is
+ * mapped read only and frame k starts at k*frameBytes, so seeking is O(1)
+ * and frames are returned as pointers into the mapping, without a copy.
+ * A partial frame at the end of the file is not returned.
+ */
+typedef struct {
+    const uint8_T *base;       /* start of the mapping, NULL if empty */
+    size_t         fileBytes;
+    size_t         frameBytes;
+    int32_T        numFrames;
+    int32_T        curFrame;   /* frame returned by the next read */
+    void          *fileHandle; /* Windows handles, unused elsewhere */
+    void          *mapHandle;
+} MWVIP_FILEMAP;
 
 /* datatype double */
 #ifdef __cplusplus
@@ -284,6 +301,49 @@ LIBMWVISIONRT_API boolean_T MWVIP_bitsRead_PACKED_BLF(void *fptrDW,
 								           int_T iDecr,
 										   byte_T   currentChar,
                                            int32_T  leftoverBits);
+/* whole frame readers; stageBuf holds 4*rows*cols bytes. A NULL portAddr0
+ * leaves the packed frame in stageBuf, see vipcolorconv_rt.h */
+LIBMWVISIONRT_API boolean_T MWVIP_UYVY_ReadFrame(void *fptrDW,
+							 uint8_T *stageBuf,
+							 uint8_T *portAddr0,
+							 uint8_T *portAddr1,
+							 uint8_T *portAddr2,
+							 int32_T   *numLoops,
+							 boolean_T *eofflag, 
+							 int_T rows, 
+							 int_T cols);
+
+LIBMWVISIONRT_API boolean_T MWVIP_YUY2_ReadFrame(void *fptrDW,
+							 uint8_T *stageBuf,
+							 uint8_T *portAddr0,
+							 uint8_T *portAddr1,
+							 uint8_T *portAddr2,
+							 int32_T   *numLoops,
+							 boolean_T *eofflag, 
+							 int_T rows, 
+							 int_T cols);
+
+LIBMWVISIONRT_API boolean_T MWVIP_YVYU_ReadFrame(void *fptrDW,
+							 uint8_T *stageBuf,
+							 uint8_T *portAddr0,
+							 uint8_T *portAddr1,
+							 uint8_T *portAddr2,
+							 int32_T   *numLoops,
+							 boolean_T *eofflag, 
+							 int_T rows, 
+							 int_T cols);
+
+LIBMWVISIONRT_API boolean_T MWVIP_Y42T_ReadFrame(void *fptrDW,
+							 uint8_T *stageBuf,
+							 uint8_T *portAddr0,
+							 uint8_T *portAddr1,
+							 uint8_T *portAddr2,
+							 uint8_T *portAddr3,
+							 int32_T   *numLoops,
+							 boolean_T *eofflag, 
+							 int_T rows, 
+							 int_T cols);
+
 LIBMWVISIONRT_API boolean_T MWVIP_handleFilePtr(void *fptrDW,
 							  int32_T   *numLoops,
 							  boolean_T *eofflag, 
@@ -294,6 +354,31 @@ LIBMWVISIONRT_API void MWVIP_handleFilePtr2(void *fptrDW,
 LIBMWVISIONRT_API boolean_T MWVIP_OpenAndCheckIfFileExists(void *fptrDW, const char *FileName);
 LIBMWVISIONRT_API void MWVIP_FileReadRewind(void *fptrDW);
 LIBMWVISIONRT_API void MWVIP_FileReadFclose(void *fptrDW);
+LIBMWVISIONRT_API int_T MWVIP_FourCC_FrameBytes(int_T fourcc, int_T rows, int_T cols);
+LIBMWVISIONRT_API int_T MWVIP_FourCC_PlaneOffsets(int_T fourcc, int_T rows, int_T cols,
+                                                  int_T *planeOffsets);
+LIBMWVISIONRT_API boolean_T MWVIP_FileMapOpen(void *mapDW, const char *FileName,
+                                              int_T frameBytes);
+LIBMWVISIONRT_API void MWVIP_FileMapSeek(void *mapDW, int32_T frameIdx);
+LIBMWVISIONRT_API const uint8_T *MWVIP_FileMapNextFrame(void *mapDW,
+							  int32_T   *numLoops,
+							  boolean_T *eofflag);
+LIBMWVISIONRT_API void MWVIP_FileMapClose(void *mapDW);
+LIBMWVISIONRT_API boolean_T MWVIP_FilePrefetchOpen(void *prefetchDW, const char *FileName,
+                                                   int_T frameBytes, int_T numBuffers);
+LIBMWVISIONRT_API const uint8_T *MWVIP_FilePrefetchNextFrame(void *prefetchDW,
+							  int32_T   *numLoops,
+							  boolean_T *eofflag);
+LIBMWVISIONRT_API void MWVIP_FilePrefetchRewind(void *prefetchDW);
+LIBMWVISIONRT_API void MWVIP_FilePrefetchClose(void *prefetchDW);
+LIBMWVISIONRT_API void MWVIP_V210_UnpackFrame(const uint8_T *src,
+							 void *portAddr0,
+							 void *portAddr1,
+							 void *portAddr2,
+							 int_T rows,
+							 int_T cols);
+LIBMWVISIONRT_API void MWVIP_BitsUnpack(const uint8_T *src, uint16_T *dst,
+                                        int_T numValues, int_T numBits);
 LIBMWVISIONRT_API void MWVIP_castIntToFloat(real_T *yfloat, int_T N, int_T inc, int_T dtIdx);
 
 LIBMWVISIONRT_API void MWVIP_set4thBytefor24Bits_BE(void *yO, int_T N, boolean_T signedData, int_T inc);
@@ -289,6 +289,49 @@ LIBMWVISIONRT_API void MWVIP_WriteFclose(void *fptrDW);
 LIBMWVISIONRT_API void MWVIP_castDoubleToFix(const real_T *uin, void *dworkPtrO, int_T inWidth, int_T dtIdx);
 
 
+/* whole frame writers; stageBuf holds 4*rows*cols bytes */
+LIBMWVISIONRT_API void MWVIP_UYVY_WriteFrame(void *fptrDW,
+							 uint8_T *stageBuf,
+							 const byte_T *portAddr0,
+							 const byte_T *portAddr1,
+							 const byte_T *portAddr2,
+							 int_T rows, 
+							 int_T cols);
+
+LIBMWVISIONRT_API void MWVIP_YUY2_WriteFrame(void *fptrDW,
+							 uint8_T *stageBuf,
+							 const byte_T *portAddr0,
+							 const byte_T *portAddr1,
+							 const byte_T *portAddr2,
+							 int_T rows, 
+							 int_T cols);
+
+LIBMWVISIONRT_API void MWVIP_YVYU_WriteFrame(void *fptrDW,
+							 uint8_T *stageBuf,
+							 const byte_T *portAddr0,
+							 const byte_T *portAddr1,
+							 const byte_T *portAddr2,
+							 int_T rows, 
+							 int_T cols);
+
+LIBMWVISIONRT_API void MWVIP_Y42T_WriteFrame(void *fptrDW,
+							 uint8_T *stageBuf,
+							 const byte_T *portAddr0,
+							 const byte_T *portAddr1,
+							 const byte_T *portAddr2,
+							 const byte_T *portAddr3,
+							 int_T rows, 
+							 int_T cols);
+
+LIBMWVISIONRT_API void MWVIP_V210_PackFrame(uint8_T *dst,
+							 const void *portAddr0,
+							 const void *portAddr1,
+							 const void *portAddr2,
+							 int_T rows,
+							 int_T cols);
+LIBMWVISIONRT_API void MWVIP_BitsPack(uint8_T *dst, const uint16_T *src,
+                                      int_T numValues, int_T numBits);
+
 #ifdef __cplusplus
 } /*  close brace for extern C from above */
 #endif
@@ -0,0 +1,80 @@
+/*
+ *  viphisteq_rt.h
+ *
+ *  Copyright 2016 The MathWorks, Inc.
+ */
+
+#ifndef viphisteq_rt_h
+#define viphisteq_rt_h
+
+#include "dsp_rt.h"
+#include "libmwvisionrt_util.h"
+
+/*
+ * Histogram Equalization and Autothreshold of one uint8 frame from a
+ * single histogram, for models that run both blocks on the same image.
+ *
+ * MWVIP_Histogram_U8 counts the 256 levels of numel pixels in one pass;
+ * each thread counts its blocks of MWVIP_HISTEQ_BLOCK pixels into its own
+ * sub-histograms, merged once at the end. From the histogram,
+ * MWVIP_HistEq_LUT_U8 builds the lookup table of histeq for a target
+ * histogram of numBins bins (hgram, or a flat one when hgram is NULL) and
+ * MWVIP_Otsu_U8 finds the threshold of graythresh: it returns the cut,
+ * the pixels above which are foreground, and level, in [0, 1], and
+ * effectiveness when they are not NULL.
+ *
+ * MWVIP_HistEqThresh_Apply_U8 then maps the frame through the table into
+ * eq and thresholds it into bw in a second pass, 16 pixels at a time with
+ * SSE2 or NEON (the table lookup itself with the 64 byte tables of
+ * AArch64); either output may be NULL. MWVIP_HistEqThresh_U8 runs the
+ * whole sequence, two passes over the image instead of four.
+ */
+#ifndef MWVIP_HISTEQ_BLOCK
+  #define MWVIP_HISTEQ_BLOCK 16384
+#endif
+
+/* Define MWVIP_HISTEQ_SERIAL to use one thread. */
+#if defined(_OPENMP) && !defined(MWVIP_HISTEQ_SERIAL)
+  #define MWVIP_HISTEQ_PARALLEL 1
+#endif
+
+/* smallest number of pixels worth the threads */
+#ifndef MWVIP_HISTEQ_MIN_PARALLEL
+  #define MWVIP_HISTEQ_MIN_PARALLEL 65536
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+LIBMWVISIONRT_API void MWVIP_Histogram_U8(const uint8_T *in, size_t numel,
+                                          uint32_T *hist);
+
+LIBMWVISIONRT_API void MWVIP_HistEq_LUT_U8(const uint32_T *hist,
+                                           const real_T *hgram,
+                                           int_T numBins,
+                                           uint8_T *lut);
+
+LIBMWVISIONRT_API uint8_T MWVIP_Otsu_U8(const uint32_T *hist,
+                                        real_T *level,
+                                        real_T *effectiveness);
+
+LIBMWVISIONRT_API void MWVIP_HistEqThresh_Apply_U8(const uint8_T *in, size_t numel,
+                                                   const uint8_T *lut,
+                                                   uint8_T cut,
+                                                   uint8_T *eq,
+                                                   boolean_T *bw);
+
+LIBMWVISIONRT_API void MWVIP_HistEqThresh_U8(const uint8_T *in, size_t numel,
+                                             const real_T *hgram,
+                                             int_T numBins,
+                                             uint8_T *eq,
+                                             boolean_T *bw,
+                                             real_T *level,
+                                             real_T *effectiveness);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* viphisteq_rt_h */
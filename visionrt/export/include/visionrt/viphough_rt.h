@@ -9,7 +9,56 @@
 
 #include "dsp_rt.h"
 #include "libmwvisionrt_util.h"
+#include <math.h>
 
+#ifndef MAX_uint16_T
+  #define MAX_uint16_T ((uint16_T)(0xFFFFU))
+#endif
+
+/* When compiled with OpenMP, MWVIP_Hough_Sparse_* accumulates the thetas
+ * (rows of the accumulator) on several threads. Each thread writes its own
+ * rows, so the output does not depend on the number of threads. Define
+ * MWVIP_HOUGH_SERIAL to accumulate on one thread. */
+#if defined(_OPENMP) && !defined(MWVIP_HOUGH_SERIAL)
+  #define MWVIP_HOUGH_PARALLEL 1
+#endif
+
+/* smallest number of votes (points times thetas) for which threads are
+ * started */
+#ifndef MWVIP_HOUGH_MIN_PARALLEL_VOTES
+  #define MWVIP_HOUGH_MIN_PARALLEL_VOTES 65536
+#endif
+
+/* number of points whose rho bins are computed before they are added */
+#define MWVIP_HOUGH_CHUNK_LEN 256
+
+/* largest number of fraction bits of the fixed point sine table of the
+ * integer accumulators */
+#ifndef MWVIP_HOUGH_MAX_FRAC_BITS
+  #define MWVIP_HOUGH_MAX_FRAC_BITS 24
+#endif
+
+/*
+ * MWVIP_HoughLines_<DataType> fuses the Hough Transform, Find Local Maxima
+ * and Hough Lines blocks. The accumulator yH is computed as by
+ * MWVIP_Hough_Sparse_<DataType>, and each thread also records the largest
+ * vote of the theta rows it owns while they are in cache. The peaks are
+ * then taken from one sweep over the rows whose largest vote reaches the
+ * threshold, max(threshold, thresholdRatio*(largest vote)): their bins of
+ * at least the threshold are sorted by decreasing votes, and are kept in
+ * that order unless they lie in the nhoodRows-by-nhoodCols (rho by theta,
+ * odd sizes) neighborhood of a peak kept before, until maxLines peaks are
+ * found. This is the greedy search of houghpeaks, ties going to the first
+ * bin in column major order; the neighborhoods wrap around the ends of
+ * theta with rho mirrored, as the matrix is antisymmetric there.
+ *
+ * For each line, peakIdx receives the zero-based rho and theta indices,
+ * lineRho and lineTheta the rho and the theta in radians, and linePts the
+ * zero-based [x1 y1 x2 y2] where the line enters and leaves the image
+ * (x the column, y the row, as for rho), or zeros when it misses the
+ * image. The functions return the number of lines, or -1 when they cannot
+ * allocate their buffers.
+ */
 /* 
  * Function naming glossary 
  * --------------------------- 
@@ -19,6 +68,8 @@
  * Data types - (describe inputs to functions, not outputs) 
  * R = real single-precision 
  * D = real double-precision 
+ * U16 = uint16 accumulator (integer arithmetic) 
+ * U32 = uint32 accumulator (integer arithmetic) 
  */ 
  
 /* Function naming convention 
@@ -34,6 +85,8 @@
  * 
  *    Examples: 
  *       MWVIP_Hough_D is the Hough Transform for double precision outputs. 
+ *       MWVIP_Hough_Sparse_D computes the same transform from the list of
+ *       on pixels. 
  */ 
 
 /* datatype double */
@@ -63,6 +116,103 @@ LIBMWVISIONRT_API void MWVIP_Hough_R(
                                     int_T Ceil90ByThResPlus1
                                    );
 
+LIBMWVISIONRT_API void MWVIP_Hough_Sparse_D(
+                                const boolean_T  *uBW,
+                                real_T           *yH,
+                                const real_T     *sineTablePtr, 
+                                const real_T     *rho,
+                                real_T           *ptCol,
+                                real_T           *ptRow,
+                                int_T inRows,
+                                int_T inCols,
+                                int_T rhoLen,
+                                int_T Ceil90ByThResPlus1
+                                );
+
+LIBMWVISIONRT_API void MWVIP_Hough_Sparse_R(
+                                const boolean_T  *uBW,
+                                real32_T           *yH,
+                                const real32_T     *sineTablePtr, 
+                                const real32_T     *rho,
+                                real32_T           *ptCol,
+                                real32_T           *ptRow,
+                                int_T inRows,
+                                int_T inCols,
+                                int_T rhoLen,
+                                int_T Ceil90ByThResPlus1
+                                );
+
+LIBMWVISIONRT_API void MWVIP_Hough_U16(
+                                const boolean_T  *uBW,
+                                uint16_T         *yH,
+                                const real_T     *sineTablePtr, 
+                                const real_T     *rho,
+                                int32_T          *trigQ,
+                                int32_T          *ptCol,
+                                int32_T          *ptRow,
+                                int_T inRows,
+                                int_T inCols,
+                                int_T rhoLen,
+                                int_T Ceil90ByThResPlus1
+                                );
+
+LIBMWVISIONRT_API void MWVIP_Hough_U32(
+                                const boolean_T  *uBW,
+                                uint32_T         *yH,
+                                const real_T     *sineTablePtr, 
+                                const real_T     *rho,
+                                int32_T          *trigQ,
+                                int32_T          *ptCol,
+                                int32_T          *ptRow,
+                                int_T inRows,
+                                int_T inCols,
+                                int_T rhoLen,
+                                int_T Ceil90ByThResPlus1
+                                );
+
+LIBMWVISIONRT_API int_T MWVIP_HoughLines_D(
+                                const boolean_T  *uBW,
+                                real_T           *yH,
+                                const real_T     *sineTablePtr,
+                                const real_T     *rho,
+                                real_T           *ptCol,
+                                real_T           *ptRow,
+                                int_T inRows,
+                                int_T inCols,
+                                int_T rhoLen,
+                                int_T Ceil90ByThResPlus1,
+                                real_T threshold,
+                                real_T thresholdRatio,
+                                int_T nhoodRows,
+                                int_T nhoodCols,
+                                int_T maxLines,
+                                int32_T          *peakIdx,
+                                real_T           *lineRho,
+                                real_T           *lineTheta,
+                                real_T           *linePts
+                                );
+
+LIBMWVISIONRT_API int_T MWVIP_HoughLines_R(
+                                const boolean_T  *uBW,
+                                real32_T         *yH,
+                                const real32_T   *sineTablePtr,
+                                const real32_T   *rho,
+                                real32_T         *ptCol,
+                                real32_T         *ptRow,
+                                int_T inRows,
+                                int_T inCols,
+                                int_T rhoLen,
+                                int_T Ceil90ByThResPlus1,
+                                real32_T threshold,
+                                real32_T thresholdRatio,
+                                int_T nhoodRows,
+                                int_T nhoodCols,
+                                int_T maxLines,
+                                int32_T          *peakIdx,
+                                real32_T         *lineRho,
+                                real32_T         *lineTheta,
+                                real32_T         *linePts
+                                );
 
 #ifdef __cplusplus
 } /*  close brace for extern C from above */
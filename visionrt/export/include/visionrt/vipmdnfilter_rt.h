@@ -24,6 +24,53 @@ extern "C" {
 #define s2ui16(a,b) {if (b < a) {uint16_T tmp = a; a = b; b = tmp;}}
 #define s2ui32(a,b) {if (b < a) {uint32_T tmp = a; a = b; b = tmp;}}
 
+/*
+ * Whole image uint8 median filters. src is the column major input already
+ * padded by the caller, (nRows+kRows-1)-by-(nCols+kCols-1) for a kRows-by-
+ * kCols neighborhood, and dst the nRows-by-nCols output; they must not
+ * overlap. Both neighborhood sizes are odd.
+ *
+ * The 3x3 and 5x5 filters run a median network over 16 (SSE2, NEON) or
+ * 32 (AVX2) output rows at a time. MWVIP_MedianFilterHist_U8 keeps
+ * histograms of the neighborhood and costs the same per pixel for any
+ * size, with kRows*kCols at most 65535; its work buffer holds
+ * MWVIP_MDNHIST_WORK_SIZE(nRows, kRows) elements. MWVIP_MedianFilter_U8
+ * selects between them.
+ *
+ * The MWVIP_MedianFilterSorted_* filters keep the neighborhood sorted in a
+ * work buffer of kRows*kCols elements, replacing the elements that move in
+ * and out at each step instead of sorting each neighborhood again. NaN
+ * orders after every number.
+ */
+#define MWVIP_MDNHIST_BINS 272
+#define MWVIP_MDNHIST_WORK_SIZE(nRows, kRows) \
+    (((nRows) + (kRows)) * MWVIP_MDNHIST_BINS)
+
+LIBMWVISIONRT_API void MWVIP_MedianFilter3x3_U8(const uint8_T *src, uint8_T *dst,
+                                                int_T nRows, int_T nCols);
+LIBMWVISIONRT_API void MWVIP_MedianFilter5x5_U8(const uint8_T *src, uint8_T *dst,
+                                                int_T nRows, int_T nCols);
+LIBMWVISIONRT_API void MWVIP_MedianFilterHist_U8(const uint8_T *src, uint8_T *dst,
+                                                 int_T nRows, int_T nCols,
+                                                 int_T kRows, int_T kCols,
+                                                 uint16_T *work);
+LIBMWVISIONRT_API void MWVIP_MedianFilterSorted_D(const real_T *src, real_T *dst,
+                                                   int_T nRows, int_T nCols,
+                                                   int_T kRows, int_T kCols,
+                                                   real_T *work);
+LIBMWVISIONRT_API void MWVIP_MedianFilterSorted_R(const real32_T *src, real32_T *dst,
+                                                   int_T nRows, int_T nCols,
+                                                   int_T kRows, int_T kCols,
+                                                   real32_T *work);
+LIBMWVISIONRT_API void MWVIP_MedianFilterSorted_U16(const uint16_T *src, uint16_T *dst,
+                                                     int_T nRows, int_T nCols,
+                                                     int_T kRows, int_T kCols,
+                                                     uint16_T *work);
+LIBMWVISIONRT_API void MWVIP_MedianFilter_U8(const uint8_T *src, uint8_T *dst,
+                                             int_T nRows, int_T nCols,
+                                             int_T kRows, int_T kCols,
+                                             uint16_T *work);
+
 #ifdef __cplusplus
 } /*  close brace for extern C from above */
 #endif
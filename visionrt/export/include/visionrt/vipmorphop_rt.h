@@ -0,0 +1,91 @@
+/*
+ *  vipmorphop_rt.h
+ *
+ *  Copyright 2016 The MathWorks, Inc.
+ */
+
+#ifndef vipmorphop_rt_h
+#define vipmorphop_rt_h
+
+#include "dsp_rt.h"
+#include "libmwvisionrt_util.h"
+
+/*
+ * Erosion and dilation by line structuring elements, at a cost that does
+ * not grow with their length, for the Erosion, Dilation, Opening and
+ * Closing blocks.
+ *
+ * A line of length points along the integer step (dr, dc) holds the
+ * offsets (k - (length-1)/2)*(dr, dc), k = 0 .. length-1, rounded down as
+ * the center of strel. (1, 0) is vertical, (0, 1) horizontal, (1, 1) and
+ * (1, -1) the diagonals, and steps longer than one give the periodic lines
+ * of strel('periodicline') and of the decomposition of strel('disk'). The
+ * pixels outside the image are ignored, as imerode and imdilate do.
+ *
+ * The uint8 images are column major, rows-by-cols. Each line of pixels
+ * along the step is filtered with the van Herk/Gil-Werman algorithm: three
+ * min or max per pixel for any length. Horizontal lines filter strips of
+ * rows across the columns a whole column segment at a time.
+ *
+ * Binary images are packed 32 rows per word, the columns starting on a
+ * new word: MWVIP_MORPH_PACKED_WORDS(rows) words per column, bit b of word
+ * w holding row 32w+b. A line takes 2*log2(length) passes of word-wide AND
+ * or OR, each on 32 pixels at a time.
+ *
+ * MWVIP_MorphRect_* and MWVIP_MorphOctagon_* apply the line decompositions
+ * of strel('rectangle', [h w]) and strel('octagon', r), r a multiple of
+ * 3; the octagon is filtered on the image padded by r, as imerode and
+ * imdilate pad for a decomposed strel. out may be in; the functions return
+ * 0 when they cannot allocate their buffers.
+ */
+#define MWVIP_MORPH_ERODE  0
+#define MWVIP_MORPH_DILATE 1
+
+#define MWVIP_MORPH_PACKED_WORDS(rows) (((rows) + 31) >> 5)
+
+/* When compiled with OpenMP, the lines of pixels, the strips of rows and
+ * the columns of the binary passes are spread over several threads. The
+ * output does not depend on the number of threads. Define
+ * MWVIP_MORPH_SERIAL to filter on one thread. */
+#if defined(_OPENMP) && !defined(MWVIP_MORPH_SERIAL)
+  #define MWVIP_MORPH_PARALLEL 1
+#endif
+
+/* smallest number of pixels worth the threads */
+#ifndef MWVIP_MORPH_MIN_PARALLEL
+  #define MWVIP_MORPH_MIN_PARALLEL 65536
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+LIBMWVISIONRT_API boolean_T MWVIP_MorphLine_U8(const uint8_T *in, uint8_T *out,
+                                               int_T rows, int_T cols, int_T op,
+                                               int_T dr, int_T dc, int_T length);
+LIBMWVISIONRT_API boolean_T MWVIP_MorphRect_U8(const uint8_T *in, uint8_T *out,
+                                               int_T rows, int_T cols, int_T op,
+                                               int_T height, int_T width);
+LIBMWVISIONRT_API boolean_T MWVIP_MorphOctagon_U8(const uint8_T *in, uint8_T *out,
+                                                  int_T rows, int_T cols, int_T op,
+                                                  int_T radius);
+
+LIBMWVISIONRT_API void MWVIP_MorphPack_B(const boolean_T *in, uint32_T *packed,
+                                         int_T rows, int_T cols);
+LIBMWVISIONRT_API void MWVIP_MorphUnpack_B(const uint32_T *packed, boolean_T *out,
+                                           int_T rows, int_T cols);
+LIBMWVISIONRT_API boolean_T MWVIP_MorphLine_B32(const uint32_T *in, uint32_T *out,
+                                                int_T rows, int_T cols, int_T op,
+                                                int_T dr, int_T dc, int_T length);
+LIBMWVISIONRT_API boolean_T MWVIP_MorphRect_B32(const uint32_T *in, uint32_T *out,
+                                                int_T rows, int_T cols, int_T op,
+                                                int_T height, int_T width);
+LIBMWVISIONRT_API boolean_T MWVIP_MorphOctagon_B32(const uint32_T *in, uint32_T *out,
+                                                   int_T rows, int_T cols, int_T op,
+                                                   int_T radius);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* vipmorphop_rt_h */
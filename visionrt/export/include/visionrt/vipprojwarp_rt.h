@@ -0,0 +1,268 @@
+/*
+ *  vipprojwarp_rt.h
+ *
+ *  Copyright 2016 The MathWorks, Inc.
+ */
+
+#ifndef vipprojwarp_rt_h
+#define vipprojwarp_rt_h
+
+#include "dsp_rt.h"
+#include "libmwvisionrt_util.h"
+
+/*
+ * Function naming glossary
+ * ---------------------------
+ *
+ * MWVIP = MathWorks VIP Blockset
+ *
+ * Data types - (describe inputs to functions, not outputs)
+ * R  = real single-precision
+ * D  = real double-precision
+ * U8 = uint8 (remap tables only)
+ */
+
+/* Function naming convention
+ * --------------------------
+ *
+ * MWVIP_ProjWarp_<Interpolation>_<DataType>
+ *
+ *    1) MWVIP_ is a prefix used with all Mathworks DSP runtime library
+ *       functions.
+ *    2) The second field indicates that this function warps a whole image
+ *       with a projective transformation
+ *    3) The third field is the interpolation method, 'Bilinear' or
+ *       'Bicubic', computed as in mwvip_posval_bl_interp_tplt.c and
+ *       mwvip_posval_bc_interp_tplt.c
+ *    4) The last field enumerates the data type of the input and output
+ *
+ *    Examples:
+ *       MWVIP_ProjWarp_Bilinear_R warps a single precision image with
+ *       bilinear interpolation.
+ *
+ * MWVIP_ProjWarp_BuildMap_<DataType> and MWVIP_Remap_Bilinear_<DataType>
+ *    split the bilinear warp for a transform that does not change between
+ *    frames: the map is built once from A, and each frame is then a gather
+ *    through the map, with no coordinate computation.
+ *
+ * MWVIP_Undistort_BuildMap_D builds the same table for the lens distortion
+ *    of a camera, with the rectification of a stereo camera if any, and
+ *    MWVIP_UndistortMap_Update_D keeps one such table, rebuilt only when
+ *    its parameters change.
+ */
+
+/*
+ * The 3x3 column major matrix A maps the zero based output pixel (r, c) to
+ * the input point (u/w, v/w), where [u v w]' = A*[r c 1]'. Each output
+ * column is a scan-line along which u, v and w are linear. Output pixels
+ * whose input point falls outside the input image, or with w == 0, take
+ * the fill value of their channel (fillVal[0] for all channels when
+ * isScalarFillVal). The channels are stacked after each other in the
+ * input and in the output.
+ *
+ * The scan-lines are processed MWVIP_PROJWARP_BLOCK pixels at a time.
+ * A block whose pixels all have their interpolation neighborhood inside
+ * the input is interpolated without any clamping, in a form the compiler
+ * vectorizes; the other blocks, on the border of the warped image, are
+ * interpolated pixel by pixel with the clamping of the templates.
+ */
+#define MWVIP_PROJWARP_BLOCK 8
+
+/* When compiled with OpenMP, the output columns are warped on several
+ * threads. The output does not depend on the number of threads. Define
+ * MWVIP_PROJWARP_SERIAL to warp on one thread. */
+#if defined(_OPENMP) && !defined(MWVIP_PROJWARP_SERIAL)
+  #define MWVIP_PROJWARP_PARALLEL 1
+#endif
+
+/* smallest number of output pixels worth the threads */
+#ifndef MWVIP_PROJWARP_MIN_PARALLEL
+  #define MWVIP_PROJWARP_MIN_PARALLEL 65536
+#endif
+
+/*
+ * Remap table entry of one output pixel. idx is the zero based index of
+ * the top left pixel of the 2x2 input neighborhood, or -1 when the pixel
+ * takes the fill value. wRow and wCol are the weights of the next row and
+ * of the next column, in fixed point with MWVIP_REMAP_FRAC_BITS fraction
+ * bits. On the last row or column of the input the neighborhood is moved
+ * back by one with a weight of one, so the gather never clamps; the input
+ * must have at least 2 rows and 2 columns.
+ */
+#define MWVIP_REMAP_FRAC_BITS 14
+#define MWVIP_REMAP_ONE       (1 << MWVIP_REMAP_FRAC_BITS)
+
+typedef struct {
+    int32_T  idx;
+    uint16_T wRow;
+    uint16_T wCol;
+} MWVIP_REMAP_ENTRY;
+
+/*
+ * Undistortion and rectification, as the maps of ImageTransformer. The
+ * output pixel (r, c), zero based, is the point (x, y) = (xOrigin + c,
+ * yOrigin + r) of the undistorted image, in the one based pixel coordinates
+ * of MATLAB. When Tinv is not NULL, the point is first taken back through
+ * the rectification, [u v w] = [x y 1]*Tinv as transformPointsInverse of
+ * projective2d, with Tinv the 3x3 column major inverse of its T. The point
+ * is then distorted as vision.internal.calibration.distortPoints does, with
+ * the 3x3 column major IntrinsicMatrix K of cameraParameters, numRadial (2
+ * or 3) radial coefficients and 2 tangential ones, and sampled in the
+ * input image. The parameters are double for all the image types: they
+ * only set the table.
+ */
+typedef struct {
+    real_T K[9];
+    real_T radial[3];
+    real_T tangential[2];
+    real_T Tinv[9];
+    boolean_T hasTinv;
+    real_T xOrigin;
+    real_T yOrigin;
+    int_T nRowsIn;
+    int_T nColsIn;
+    int_T nRowsOut;
+    int_T nColsOut;
+    MWVIP_REMAP_ENTRY *map;  /* nRowsOut*nColsOut entries, NULL until built */
+    size_t capacity;         /* entries allocated for map */
+} MWVIP_UNDISTORT_MAP;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* datatype single */
+LIBMWVISIONRT_API void MWVIP_ProjWarp_Bilinear_R(const real32_T *in,
+                                                 real32_T       *out,
+                                                 const real32_T *A,
+                                                 const real32_T *fillVal,
+                                                 boolean_T       isScalarFillVal,
+                                                 int_T nRowsIn,
+                                                 int_T nColsIn,
+                                                 int_T nRowsOut,
+                                                 int_T nColsOut,
+                                                 int_T nChans);
+
+LIBMWVISIONRT_API void MWVIP_ProjWarp_Bicubic_R(const real32_T *in,
+                                                real32_T       *out,
+                                                const real32_T *A,
+                                                const real32_T *fillVal,
+                                                boolean_T       isScalarFillVal,
+                                                int_T nRowsIn,
+                                                int_T nColsIn,
+                                                int_T nRowsOut,
+                                                int_T nColsOut,
+                                                int_T nChans);
+
+/* datatype double */
+LIBMWVISIONRT_API void MWVIP_ProjWarp_Bilinear_D(const real_T *in,
+                                                 real_T       *out,
+                                                 const real_T *A,
+                                                 const real_T *fillVal,
+                                                 boolean_T     isScalarFillVal,
+                                                 int_T nRowsIn,
+                                                 int_T nColsIn,
+                                                 int_T nRowsOut,
+                                                 int_T nColsOut,
+                                                 int_T nChans);
+
+LIBMWVISIONRT_API void MWVIP_ProjWarp_Bicubic_D(const real_T *in,
+                                                real_T       *out,
+                                                const real_T *A,
+                                                const real_T *fillVal,
+                                                boolean_T     isScalarFillVal,
+                                                int_T nRowsIn,
+                                                int_T nColsIn,
+                                                int_T nRowsOut,
+                                                int_T nColsOut,
+                                                int_T nChans);
+
+/* remap tables; map holds nRowsOut*nColsOut entries */
+LIBMWVISIONRT_API void MWVIP_ProjWarp_BuildMap_R(const real32_T    *A,
+                                                 MWVIP_REMAP_ENTRY *map,
+                                                 int_T nRowsIn,
+                                                 int_T nColsIn,
+                                                 int_T nRowsOut,
+                                                 int_T nColsOut);
+
+LIBMWVISIONRT_API void MWVIP_ProjWarp_BuildMap_D(const real_T      *A,
+                                                 MWVIP_REMAP_ENTRY *map,
+                                                 int_T nRowsIn,
+                                                 int_T nColsIn,
+                                                 int_T nRowsOut,
+                                                 int_T nColsOut);
+
+LIBMWVISIONRT_API void MWVIP_Remap_Bilinear_R(const real32_T          *in,
+                                              real32_T                *out,
+                                              const MWVIP_REMAP_ENTRY *map,
+                                              const real32_T          *fillVal,
+                                              boolean_T                isScalarFillVal,
+                                              int_T nRowsIn,
+                                              int_T nColsIn,
+                                              int_T nRowsOut,
+                                              int_T nColsOut,
+                                              int_T nChans);
+
+LIBMWVISIONRT_API void MWVIP_Remap_Bilinear_D(const real_T            *in,
+                                              real_T                  *out,
+                                              const MWVIP_REMAP_ENTRY *map,
+                                              const real_T            *fillVal,
+                                              boolean_T                isScalarFillVal,
+                                              int_T nRowsIn,
+                                              int_T nColsIn,
+                                              int_T nRowsOut,
+                                              int_T nColsOut,
+                                              int_T nChans);
+
+LIBMWVISIONRT_API void MWVIP_Remap_Bilinear_U8(const uint8_T           *in,
+                                               uint8_T                 *out,
+                                               const MWVIP_REMAP_ENTRY *map,
+                                               const uint8_T           *fillVal,
+                                               boolean_T                isScalarFillVal,
+                                               int_T nRowsIn,
+                                               int_T nColsIn,
+                                               int_T nRowsOut,
+                                               int_T nColsOut,
+                                               int_T nChans);
+
+LIBMWVISIONRT_API void MWVIP_Undistort_BuildMap_D(const real_T      *K,
+                                                  const real_T      *radial,
+                                                  int_T              numRadial,
+                                                  const real_T      *tangential,
+                                                  const real_T      *Tinv,
+                                                  real_T             xOrigin,
+                                                  real_T             yOrigin,
+                                                  MWVIP_REMAP_ENTRY *map,
+                                                  int_T nRowsIn,
+                                                  int_T nColsIn,
+                                                  int_T nRowsOut,
+                                                  int_T nColsOut);
+
+/* cached undistortion table: Init before the first Update, Free when done.
+ * Update rebuilds the table when any parameter or size differs from those
+ * it was built with, and returns whether it did; map is NULL if the table
+ * could not be allocated. */
+LIBMWVISIONRT_API void MWVIP_UndistortMap_Init(MWVIP_UNDISTORT_MAP *cache);
+
+LIBMWVISIONRT_API boolean_T MWVIP_UndistortMap_Update_D(MWVIP_UNDISTORT_MAP *cache,
+                                                        const real_T *K,
+                                                        const real_T *radial,
+                                                        int_T         numRadial,
+                                                        const real_T *tangential,
+                                                        const real_T *Tinv,
+                                                        real_T        xOrigin,
+                                                        real_T        yOrigin,
+                                                        int_T nRowsIn,
+                                                        int_T nColsIn,
+                                                        int_T nRowsOut,
+                                                        int_T nColsOut);
+
+LIBMWVISIONRT_API void MWVIP_UndistortMap_Free(MWVIP_UNDISTORT_MAP *cache);
+
+#ifdef __cplusplus
+} /*  close brace for extern C from above */
+#endif
+
+#endif /* vipprojwarp_rt_h */
+
+/* [EOF] vipprojwarp_rt.h */
@@ -0,0 +1,234 @@
+/*
+ *  vipransac_rt.h
+ *
+ *  Copyright 2016 The MathWorks, Inc.
+ */
+
+#ifndef vipransac_rt_h
+#define vipransac_rt_h
+
+#include "dsp_rt.h"
+#include "libmwvisionrt_util.h"
+
+/*
+ * Function naming glossary
+ * ---------------------------
+ *
+ * MWVIP = MathWorks VIP Blockset
+ *
+ * Data types - (describe inputs to functions, not outputs)
+ * R = real single-precision
+ * D = real double-precision
+ */
+
+/* Function naming convention
+ * --------------------------
+ *
+ * MWVIP_RANSAC_<Model>_<DataType>
+ *
+ *    1) MWVIP_ is a prefix used with all Mathworks DSP runtime library
+ *       functions.
+ *    2) The second field indicates that this function estimates a model
+ *       from point correspondences with RANSAC
+ *    3) The third field is the model, 'Homography' or 'Fundamental'
+ *    4) The last field enumerates the data type of the points and of the
+ *       model
+ *
+ *    Examples:
+ *       MWVIP_RANSAC_Homography_R estimates a homography from single
+ *       precision correspondences.
+ *
+ * MWVIP_MSAC_<DataType>
+ *
+ *    M-estimator sample consensus of vision.internal.ransac.msac with a
+ *    caller supplied minimal solver. MWVIP_MSAC_<Model>Solver_<DataType>
+ *    fills in the solver of a 'Homography' or a 'Fundamental' matrix.
+ */
+
+/*
+ * pts1 and pts2 are numPts x 2 column major matrices of matched points
+ * ([x y], as returned for matchFeatures). numHyp hypotheses are drawn
+ * from minimal samples, 4 correspondences for a homography and 8 for a
+ * fundamental matrix, each solved with the normalized DLT (Hartley) on
+ * MWVIP_SVD_JacobiBatch_<DataType>, MWVIP_SVD_BATCH_LANES hypotheses at
+ * a time. Each hypothesis is scored by counting the correspondences whose
+ * error is at most threshold pixels: the transfer distance from H*p1 to p2,
+ * or the Sampson distance for F. The model with the most inliers is
+ * returned in the 3x3 column major matrix model, with
+ * [x2 y2 1]' ~ H*[x1 y1 1]' or [x2 y2 1]*F*[x1 y1 1]' = 0, its inliers are
+ * flagged in inliers (numPts elements) and their number is returned;
+ * 0 when there are fewer correspondences than a minimal sample.
+ *
+ * The samples of hypothesis i are drawn from a generator seeded with seed
+ * and i, and ties go to the first hypothesis, so the result does not
+ * depend on the number of threads.
+ */
+
+/* When compiled with OpenMP, the hypotheses are solved and scored on
+ * several threads, for at least MWVIP_RANSAC_MIN_PARALLEL point
+ * evaluations. Define MWVIP_RANSAC_SERIAL to use one thread. */
+#if defined(_OPENMP) && !defined(MWVIP_RANSAC_SERIAL)
+  #define MWVIP_RANSAC_PARALLEL 1
+#endif
+#ifndef MWVIP_RANSAC_MIN_PARALLEL
+  #define MWVIP_RANSAC_MIN_PARALLEL 65536
+#endif
+
+/*
+ * MWVIP_MSAC_<DataType> follows msac.m: hypotheses are drawn from minimal
+ * samples and scored with the sum of their distances truncated at
+ * maxDistance, the best one lowers the number of trials to that of
+ * computeLoopNumber for the given confidence (in percent), and up to
+ * maxSkipTrials invalid hypotheses are skipped (0 for 10*maxNumTrials).
+ * With recomputeModelFromInliers, the model is refit to its inliers with
+ * the fit function of the solver when it has one.
+ *
+ * The hypotheses are drawn, solved and scored MWVIP_SVD_BATCH_LANES at a
+ * time, on several threads with OpenMP as above, and the best model is
+ * then updated in their order, so the result does not depend on the
+ * number of threads. Scoring stops once the truncated sum reaches that of
+ * the best model when the round started.
+ *
+ * pts1 and pts2 are passed to the solver as given; the built-in solvers
+ * take the numPts x 2 matched points of MWVIP_RANSAC_<Model>_<DataType>,
+ * with the transfer distance of H or the Sampson distance of F (squared,
+ * as by estimateFundamentalMatrix), each sample normalized on its own.
+ * When matchMetric is not NULL, the samples are drawn with PROSAC: from the
+ * correspondences of smallest matchMetric first (as the distances returned
+ * by matchFeatures), then from more and more of them.
+ *
+ * The best model (modelSize elements) is returned in model, its inliers,
+ * of distance below maxDistance, are flagged in inliers and their number
+ * is returned; 0 when no model was found. numTrials and numSkipTrials
+ * return the number of valid and of skipped hypotheses.
+ */
+
+typedef struct MWVIP_MSAC_Params {
+    real_T    maxDistance;
+    real_T    confidence;
+    int_T     maxNumTrials;
+    int_T     maxSkipTrials;
+    uint32_T  seed;
+    boolean_T recomputeModelFromInliers;
+} MWVIP_MSAC_Params;
+
+/*
+ * Minimal solver. solve fits the numSamples samples of sampleSize indices
+ * in samples, writing up to maxModels models of modelSize elements each
+ * at models + s*maxModels*modelSize and their number at numModels[s].
+ * distances writes the distances of correspondences first..first+count-1
+ * to model into dist. isValid rejects degenerate models (NULL accepts them
+ * all) and fit fits the numSel correspondences sel (NULL to keep the model
+ * of the best sample). solve, distances and isValid are called from
+ * several threads at once.
+ */
+typedef struct MWVIP_MSAC_Solver_D {
+    int_T sampleSize;
+    int_T modelSize;
+    int_T maxModels;
+    void (*solve)(void *data, const real_T *pts1, const real_T *pts2,
+                  int_T numPts, const int_T *samples, int_T numSamples,
+                  real_T *models, int_T *numModels);
+    void (*distances)(void *data, const real_T *model, const real_T *pts1,
+                      const real_T *pts2, int_T numPts, int_T first,
+                      int_T count, real_T *dist);
+    boolean_T (*isValid)(void *data, const real_T *model);
+    boolean_T (*fit)(void *data, const real_T *pts1, const real_T *pts2,
+                     int_T numPts, const int_T *sel, int_T numSel,
+                     real_T *model);
+    void *data;
+} MWVIP_MSAC_Solver_D;
+
+typedef struct MWVIP_MSAC_Solver_R {
+    int_T sampleSize;
+    int_T modelSize;
+    int_T maxModels;
+    void (*solve)(void *data, const real32_T *pts1, const real32_T *pts2,
+                  int_T numPts, const int_T *samples, int_T numSamples,
+                  real32_T *models, int_T *numModels);
+    void (*distances)(void *data, const real32_T *model, const real32_T *pts1,
+                      const real32_T *pts2, int_T numPts, int_T first,
+                      int_T count, real32_T *dist);
+    boolean_T (*isValid)(void *data, const real32_T *model);
+    boolean_T (*fit)(void *data, const real32_T *pts1, const real32_T *pts2,
+                     int_T numPts, const int_T *sel, int_T numSel,
+                     real32_T *model);
+    void *data;
+} MWVIP_MSAC_Solver_R;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* datatype double */
+LIBMWVISIONRT_API int_T MWVIP_RANSAC_Homography_D(const real_T *pts1,
+                                                  const real_T *pts2,
+                                                  int_T         numPts,
+                                                  int_T         numHyp,
+                                                  uint32_T      seed,
+                                                  real_T        threshold,
+                                                  real_T       *model,
+                                                  boolean_T    *inliers);
+
+LIBMWVISIONRT_API int_T MWVIP_RANSAC_Fundamental_D(const real_T *pts1,
+                                                   const real_T *pts2,
+                                                   int_T         numPts,
+                                                   int_T         numHyp,
+                                                   uint32_T      seed,
+                                                   real_T        threshold,
+                                                   real_T       *model,
+                                                   boolean_T    *inliers);
+
+/* datatype single */
+LIBMWVISIONRT_API int_T MWVIP_RANSAC_Homography_R(const real32_T *pts1,
+                                                  const real32_T *pts2,
+                                                  int_T           numPts,
+                                                  int_T           numHyp,
+                                                  uint32_T        seed,
+                                                  real32_T        threshold,
+                                                  real32_T       *model,
+                                                  boolean_T      *inliers);
+
+LIBMWVISIONRT_API int_T MWVIP_RANSAC_Fundamental_R(const real32_T *pts1,
+                                                   const real32_T *pts2,
+                                                   int_T           numPts,
+                                                   int_T           numHyp,
+                                                   uint32_T        seed,
+                                                   real32_T        threshold,
+                                                   real32_T       *model,
+                                                   boolean_T      *inliers);
+
+LIBMWVISIONRT_API int_T MWVIP_MSAC_D(const MWVIP_MSAC_Solver_D *solver,
+                                     const real_T              *pts1,
+                                     const real_T              *pts2,
+                                     int_T                      numPts,
+                                     const real_T              *matchMetric,
+                                     const MWVIP_MSAC_Params   *params,
+                                     real_T                    *model,
+                                     boolean_T                 *inliers,
+                                     int_T                     *numTrials,
+                                     int_T                     *numSkipTrials);
+
+LIBMWVISIONRT_API int_T MWVIP_MSAC_R(const MWVIP_MSAC_Solver_R *solver,
+                                     const real32_T            *pts1,
+                                     const real32_T            *pts2,
+                                     int_T                      numPts,
+                                     const real32_T            *matchMetric,
+                                     const MWVIP_MSAC_Params   *params,
+                                     real32_T                  *model,
+                                     boolean_T                 *inliers,
+                                     int_T                     *numTrials,
+                                     int_T                     *numSkipTrials);
+
+LIBMWVISIONRT_API void MWVIP_MSAC_HomographySolver_D(MWVIP_MSAC_Solver_D *solver);
+LIBMWVISIONRT_API void MWVIP_MSAC_FundamentalSolver_D(MWVIP_MSAC_Solver_D *solver);
+LIBMWVISIONRT_API void MWVIP_MSAC_HomographySolver_R(MWVIP_MSAC_Solver_R *solver);
+LIBMWVISIONRT_API void MWVIP_MSAC_FundamentalSolver_R(MWVIP_MSAC_Solver_R *solver);
+
+#ifdef __cplusplus
+} /*  close brace for extern C from above */
+#endif
+
+#endif /* vipransac_rt_h */
+
+/* [EOF] vipransac_rt.h */
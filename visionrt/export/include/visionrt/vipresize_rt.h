@@ -0,0 +1,104 @@
+/*
+ *  vipresize_rt.h
+ *
+ *  Copyright 2016 The MathWorks, Inc.
+ */
+
+#ifndef vipresize_rt_h
+#define vipresize_rt_h
+
+#include "dsp_rt.h"
+#include "libmwvisionrt_util.h"
+
+/*
+ * Separable polyphase resampling for the Resize and Pyramid blocks.
+ *
+ * The weights of the output pixels along one dimension depend only on the
+ * input size, the output size and the kernel, so they are computed once
+ * into a tap table: output k of the dimension is
+ *     sum over t < numTaps of weight[k*numTaps + t] * in[index[k*numTaps + t]]
+ * with the indices already mirrored about the borders. The caller keeps
+ * the tables of the row and of the column dimension across frames and
+ * passes them to MWVIP_Resize_<DataType>.
+ *
+ * MWVIP_Resize_BuildTable follows imresize: output k (0-based) maps to
+ * (k + 0.5)/scale - 0.5 in the input, scale = outSize/inSize; when
+ * shrinking with antialias, the kernel is stretched by 1/scale. The
+ * weights of an output sum to one, the input is padded symmetrically, and
+ * the leading and trailing taps that are zero for every output are dropped.
+ * MWVIP_Resize_PyramidTable holds the Gaussian pyramid filter
+ * [1/4 - a/2, 1/4, a, 1/4, 1/4 - a/2]: reduce filters and keeps every other
+ * pixel, (inSize+1)/2 of them, and expand doubles the size, each output
+ * interpolating the 2 or 3 inputs of its phase with the weights doubled.
+ *
+ * The buffers of a table hold outSize*MWVIP_Resize_MaxTaps(...) entries,
+ * and 5 and 3 per output for the pyramid; weightQ14 may be NULL when the
+ * table is used with single data only. The build functions return the
+ * number of taps, also kept in the table.
+ *
+ * The column major image is first resampled along its columns, the
+ * contiguous dimension, into a ring buffer of numTaps resampled input
+ * columns, and each output column then combines the columns of its taps
+ * from the ring, every input column being resampled once. The uint8 data
+ * is resampled with Q14 weights and a Q6 intermediate, rounded to nearest
+ * and saturated, 8 rows at a time with SSE2 or NEON; the results do not
+ * depend on the SIMD path. The single data is not saturated. The functions
+ * return 0 when they cannot allocate their ring buffers.
+ */
+#define MWVIP_RESIZE_NEAREST  0
+#define MWVIP_RESIZE_BILINEAR 1
+#define MWVIP_RESIZE_BICUBIC  2
+
+#define MWVIP_RESIZE_Q14_ONE 16384
+
+typedef struct {
+    int32_T   inSize;
+    int32_T   outSize;
+    int32_T   numTaps;
+    int32_T  *index;
+    real32_T *weight;
+    int16_T  *weightQ14;
+} MWVIP_RESIZE_TABLE;
+
+/* When compiled with OpenMP, strips of output columns, each with its own
+ * ring buffer, are resampled on several threads. The output does not
+ * depend on the number of threads. Define MWVIP_RESIZE_SERIAL to resample
+ * on one thread. */
+#if defined(_OPENMP) && !defined(MWVIP_RESIZE_SERIAL)
+  #define MWVIP_RESIZE_PARALLEL 1
+#endif
+
+/* smallest number of output pixels worth the threads */
+#ifndef MWVIP_RESIZE_MIN_PARALLEL
+  #define MWVIP_RESIZE_MIN_PARALLEL 65536
+#endif
+
+/* output columns per strip given to a thread */
+#ifndef MWVIP_RESIZE_STRIP_COLS
+  #define MWVIP_RESIZE_STRIP_COLS 32
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+LIBMWVISIONRT_API int32_T MWVIP_Resize_MaxTaps(int32_T inSize, int32_T outSize,
+                                               int_T kernel, boolean_T antialias);
+LIBMWVISIONRT_API int32_T MWVIP_Resize_BuildTable(int32_T inSize, int32_T outSize,
+                                                  int_T kernel, boolean_T antialias,
+                                                  MWVIP_RESIZE_TABLE *table);
+LIBMWVISIONRT_API int32_T MWVIP_Resize_PyramidTable(int32_T inSize, boolean_T expand,
+                                                    real_T a, MWVIP_RESIZE_TABLE *table);
+
+LIBMWVISIONRT_API boolean_T MWVIP_Resize_U8(const uint8_T *in, uint8_T *out,
+                                            const MWVIP_RESIZE_TABLE *rowTable,
+                                            const MWVIP_RESIZE_TABLE *colTable);
+LIBMWVISIONRT_API boolean_T MWVIP_Resize_R(const real32_T *in, real32_T *out,
+                                           const MWVIP_RESIZE_TABLE *rowTable,
+                                           const MWVIP_RESIZE_TABLE *colTable);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* vipresize_rt_h */
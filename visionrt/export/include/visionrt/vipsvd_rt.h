@@ -16,6 +16,37 @@
 /* Maximum number of iterations */
 #define MAXIT 75
 
+/* Maximum number of sweeps of the one-sided Jacobi SVD */
+#define MWVIP_SVD_JACOBI_MAXSWEEP 30
+
+/* Number of matrices of a batch rotated together by
+ * MWVIP_SVD_JacobiBatch_<DataType>, one per SIMD lane */
+#define MWVIP_SVD_BATCH_LANES 8
+
+/* When compiled with OpenMP, the column pairs of a round of
+ * MWVIP_SVD_Jacobi_<DataType> are rotated on several threads, for
+ * matrices of at least MWVIP_SVD_MIN_PARALLEL elements. Define
+ * MWVIP_SVD_SERIAL to rotate them on one thread. */
+#if defined(_OPENMP) && !defined(MWVIP_SVD_SERIAL)
+  #define MWVIP_SVD_PARALLEL 1
+#endif
+#ifndef MWVIP_SVD_MIN_PARALLEL
+  #define MWVIP_SVD_MIN_PARALLEL 16384
+#endif
+
+/* Rows of x multiplied together by MWVIP_SVD_Randomized_<DataType> */
+#ifndef MWVIP_SVD_RAND_BLOCK
+  #define MWVIP_SVD_RAND_BLOCK 256
+#endif
+
+/* Number of test vectors of MWVIP_SVD_Randomized_<DataType> for an n x p
+ * matrix, rank k and oversampling, and the elements of its work buffer */
+#define MWVIP_SVD_RANDOMIZED_RANK(n, p, k, oversample) \
+    MIN((k) + (oversample), MIN((n), (p)))
+#define MWVIP_SVD_RANDOMIZED_WORK(n, p, k, oversample) \
+    (MWVIP_SVD_RANDOMIZED_RANK(n, p, k, oversample) * \
+     ((n) + 2*(p) + MWVIP_SVD_RANDOMIZED_RANK(n, p, k, oversample) + 1))
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -51,6 +82,37 @@ extern "C" {
  *
  * 3) The third field is a string indicating the nature of the data type
  *
+ * MWVIP_SVD_Jacobi_<DataType> and MWVIP_SVD_JacobiBatch_<DataType> use
+ * one-sided (Hestenes) Jacobi rotations instead of the LINPACK
+ * bidiagonalization. The input is n x p with n >= p; s, U (n x p) and
+ * V (p x p) are returned as by MWVIP_SVD_<DataType>, with the singular
+ * values in decreasing order. Columns i and j are taken as orthogonal
+ * when |xi'*xj| <= n*eps*||xi||*||xj||, or when one of them is below
+ * n*eps times the largest column, as in rank deficient matrices; the
+ * columns of U of such singular values are zero. The functions return
+ * zero when every matrix converged.
+ *
+ * MWVIP_SVD_Jacobi_<DataType> is meant for large matrices: x is
+ * overwritten with U, and the rotations of a round are applied to
+ * disjoint column pairs (round-robin ordering), in parallel.
+ *
+ * MWVIP_SVD_JacobiBatch_<DataType> is meant for many small matrices, as in
+ * homography or fundamental matrix estimation: numMats matrices stored
+ * one after the other are decomposed MWVIP_SVD_BATCH_LANES at a time, with
+ * the elements of the matrices interleaved in work, so that the same
+ * rotation step of all the matrices vectorizes. work holds
+ * MWVIP_SVD_BATCH_LANES*(n*p + p*p + p) elements. It returns the number of
+ * matrices that did not converge.
+ *
+ * MWVIP_SVD_Randomized_<DataType> computes the top k singular values of
+ * an n x p matrix (any shape) and, with wantv, their n x k U and p x k V,
+ * for PCA or low-rank approximations of large matrices. The range of x is
+ * sampled with k + oversample Gaussian test vectors drawn from seed
+ * (typically oversample = 10), refined by numPowerIter power iterations
+ * (1 or 2 for slowly decaying spectra), and the projection of x on it is
+ * decomposed by MWVIP_SVD_Jacobi_<DataType>. x is not modified; work
+ * holds MWVIP_SVD_RANDOMIZED_WORK(n, p, k, oversample) elements. k is
+ * clipped to min(n, p). It returns zero when the Jacobi SVD converged.
  */
 
 LIBMWVISIONRT_API int_T MWVIP_SVD_D(real_T *x,             /*Input matrix*/
@@ -97,6 +159,66 @@ LIBMWVISIONRT_API int_T MWVIP_SVD_C(creal32_T *x,
                                  int_T wantv);
 #endif /* CREAL_T */
 
+LIBMWVISIONRT_API int_T MWVIP_SVD_Jacobi_D(real_T *x,
+                                        int_T n,
+                                        int_T p,
+                                        real_T *s,
+                                        real_T *v,
+                                        int_T wantv);
+
+LIBMWVISIONRT_API int_T MWVIP_SVD_Jacobi_R(real32_T *x,
+                                        int_T n,
+                                        int_T p,
+                                        real32_T *s,
+                                        real32_T *v,
+                                        int_T wantv);
+
+LIBMWVISIONRT_API int_T MWVIP_SVD_JacobiBatch_D(const real_T *x,
+                                             int_T n,
+                                             int_T p,
+                                             int_T numMats,
+                                             real_T *s,
+                                             real_T *u,
+                                             real_T *v,
+                                             int_T wantv,
+                                             real_T *work);
+
+LIBMWVISIONRT_API int_T MWVIP_SVD_JacobiBatch_R(const real32_T *x,
+                                             int_T n,
+                                             int_T p,
+                                             int_T numMats,
+                                             real32_T *s,
+                                             real32_T *u,
+                                             real32_T *v,
+                                             int_T wantv,
+                                             real32_T *work);
+
+LIBMWVISIONRT_API int_T MWVIP_SVD_Randomized_D(const real_T *x,
+                                            int_T n,
+                                            int_T p,
+                                            int_T k,
+                                            int_T oversample,
+                                            int_T numPowerIter,
+                                            uint32_T seed,
+                                            real_T *s,
+                                            real_T *u,
+                                            real_T *v,
+                                            int_T wantv,
+                                            real_T *work);
+
+LIBMWVISIONRT_API int_T MWVIP_SVD_Randomized_R(const real32_T *x,
+                                            int_T n,
+                                            int_T p,
+                                            int_T k,
+                                            int_T oversample,
+                                            int_T numPowerIter,
+                                            uint32_T seed,
+                                            real32_T *s,
+                                            real32_T *u,
+                                            real32_T *v,
+                                            int_T wantv,
+                                            real32_T *work);
+
 /* isFinite */
 LIBMWVISIONRT_API int_T svd_IsFinite(double x);
 LIBMWVISIONRT_API int_T svd_IsFinite32(float x);
@@ -0,0 +1,37 @@
+/*
+ *  BLOB_ELLIPSE_RT Ellipse features from second central moments, shared by
+ *  the MWVIP_Blob_Ellipse*_<DataType> functions.
+ *
+ *  Copyright 2016 The MathWorks, Inc.
+ */
+
+#ifndef blob_ellipse_rt_h
+#define blob_ellipse_rt_h
+
+#include <math.h>
+#include "vipblob_rt.h"
+
+/*
+ * uNN, uMM and uNM are the second central moments divided by the area,
+ * without the 1/12 of the pixel size; out receives the major axis, minor
+ * axis, eccentricity and orientation
+ */
+MWVIP_INLINE void MWVIP_Blob_EllipseFeatures(real_T uNN, real_T uMM,
+                                             real_T uNM, real_T *out)
+{
+    real_T common, major, minor;
+    uNN += 1.0/12.0;
+    uMM += 1.0/12.0;
+    common = sqrt((uNN-uMM)*(uNN-uMM) + 4.0*uNM*uNM);
+    major  = 2.0*sqrt(2.0)*sqrt(uNN+uMM+common);
+    minor  = uNN+uMM-common;
+    minor  = (minor > 0.0) ? 2.0*sqrt(2.0)*sqrt(minor) : 0.0;
+    out[0] = major;
+    out[1] = minor;
+    out[2] = (major > 0.0) ? sqrt(1.0 - (minor/major)*(minor/major)) : 0.0;
+    out[3] = 0.5*atan2(2.0*uNM, uNN-uMM);
+}
+
+#endif /* blob_ellipse_rt_h */
+
+/* [EOF] blob_ellipse_rt.h */
@@ -0,0 +1,56 @@
+/*
+ *  BLOB_ELLIPSEBATCH_D_RT Ellipse features of many blobs from their
+ *  pixel lists, double precision.
+ *
+ *  The blobs are independent and are spread over the threads; the
+ *  central moments of a blob are summed in real_T.
+ *
+ *  Copyright 2016 The MathWorks, Inc.
+ */
+
+#include "blob_ellipse_rt.h"
+
+LIBMWVISIONRT_API void MWVIP_Blob_EllipseBatch_D(
+    const int16_T    *pixListN,
+    const int16_T    *pixListM,
+    const int32_T    *pixListStart,
+    const real_T   *c0,
+    const real_T   *c1,
+    int32_T           numBlobs,
+    real_T         *majoraxis,
+    real_T         *minoraxis,
+    real_T         *eccentricity,
+    real_T         *orientation  )
+{
+    int32_T b;
+#if defined(MWVIP_BLOB_PARALLEL)
+    #pragma omp parallel for schedule(dynamic, 16) \
+        if (pixListStart[numBlobs] - pixListStart[0] >= MWVIP_BLOB_MIN_PARALLEL)
+#endif
+    for (b = 0; b < numBlobs; b++) {
+        const int32_T start = pixListStart[b];
+        const int32_T end   = pixListStart[b+1];
+        const real_T  cN = (real_T)c0[b];
+        const real_T  cM = (real_T)c1[b];
+        real_T sNN = 0.0, sMM = 0.0, sNM = 0.0;
+        real_T features[4] = {0.0, 0.0, 0.0, 0.0};
+        int32_T k;
+        for (k = start; k < end; k++) {
+            const real_T dN = (real_T)pixListN[k] - cN;
+            const real_T dM = (real_T)pixListM[k] - cM;
+            sNN += dN*dN;
+            sMM += dM*dM;
+            sNM += dN*dM;
+        }
+        if (end > start) {
+            const real_T a = (real_T)(end - start);
+            MWVIP_Blob_EllipseFeatures(sNN/a, sMM/a, sNM/a, features);
+        }
+        majoraxis[b]    = (real_T)features[0];
+        minoraxis[b]    = (real_T)features[1];
+        eccentricity[b] = (real_T)features[2];
+        orientation[b]  = (real_T)features[3];
+    }
+}
+
+/* [EOF] blob_ellipsebatch_d_rt.c */
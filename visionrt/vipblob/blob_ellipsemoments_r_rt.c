@@ -0,0 +1,45 @@
+/*
+ *  BLOB_ELLIPSEMOMENTS_R_RT Centroids and ellipse features of many blobs
+ *  from the moments accumulated by MWVIP_Blob_Moments, single precision.
+ *
+ *  Copyright 2016 The MathWorks, Inc.
+ */
+
+#include "blob_ellipse_rt.h"
+
+LIBMWVISIONRT_API void MWVIP_Blob_EllipseMoments_R(
+    const MWVIP_BLOB_MOMENTS *moments,
+    int32_T           numBlobs,
+    real32_T         *centroidN,
+    real32_T         *centroidM,
+    real32_T         *majoraxis,
+    real32_T         *minoraxis,
+    real32_T         *eccentricity,
+    real32_T         *orientation  )
+{
+    int32_T b;
+#if defined(MWVIP_BLOB_PARALLEL)
+    #pragma omp parallel for schedule(static) if (numBlobs >= MWVIP_BLOB_MIN_PARALLEL)
+#endif
+    for (b = 0; b < numBlobs; b++) {
+        const MWVIP_BLOB_MOMENTS *mb = &moments[b];
+        real_T features[4] = {0.0, 0.0, 0.0, 0.0};
+        real_T meanN = 0.0, meanM = 0.0;
+        if (mb->area > 0) {
+            const real_T a = (real_T)mb->area;
+            meanN = mb->sumN/a;
+            meanM = mb->sumM/a;
+            MWVIP_Blob_EllipseFeatures(mb->sumNN/a - meanN*meanN,
+                                       mb->sumMM/a - meanM*meanM,
+                                       mb->sumNM/a - meanN*meanM, features);
+        }
+        centroidN[b]    = (real32_T)(mb->originN + meanN);
+        centroidM[b]    = (real32_T)(mb->originM + meanM);
+        majoraxis[b]    = (real32_T)features[0];
+        minoraxis[b]    = (real32_T)features[1];
+        eccentricity[b] = (real32_T)features[2];
+        orientation[b]  = (real32_T)features[3];
+    }
+}
+
+/* [EOF] blob_ellipsemoments_r_rt.c */
@@ -0,0 +1,175 @@
+/*
+ *  BLOB_LABEL_RT Connected component labeling from vertical runs.
+ *
+ *  Three passes over strips of columns, the first two in parallel:
+ *   1) count the runs of each column, to place the runs of every column
+ *      in one array by a prefix sum;
+ *   2) find the runs and union each with the overlapping runs of the
+ *      previous column of the strip;
+ *   3) union the runs across the borders of the strips, in order.
+ *  The union-find links the larger root to the smaller one, so a root is
+ *  the first run of its component and every parent precedes its child:
+ *  one pass in run order then numbers the components as bwlabel does.
+ *
+ *  Copyright 2016 The MathWorks, Inc.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include "vipblob_rt.h"
+
+static int32_T FindRoot(int32_T *parent, int32_T r)
+{
+    while (parent[r] != r) {
+        parent[r] = parent[parent[r]];
+        r = parent[r];
+    }
+    return r;
+}
+
+static void Union(int32_T *parent, int32_T a, int32_T b)
+{
+    a = FindRoot(parent, a);
+    b = FindRoot(parent, b);
+    if (a < b) {
+        parent[b] = a;
+    } else if (b < a) {
+        parent[a] = b;
+    }
+}
+
+/* unions the runs [p0, p1) of a column with the runs [c0, c1) of the next
+ * one; reach is 0 for 4 and 1 for 8 connectivity */
+static void UnionColumns(const int32_T *start, const int32_T *end, int32_T *parent,
+                         int32_T p0, int32_T p1, int32_T c0, int32_T c1, int32_T reach)
+{
+    while (p0 < p1 && c0 < c1) {
+        if (start[p0] <= end[c0] + reach && start[c0] <= end[p0] + reach) {
+            Union(parent, p0, c0);
+        }
+        /* the run that ends first cannot touch any later run */
+        if (end[p0] < end[c0]) p0++; else c0++;
+    }
+}
+
+LIBMWVISIONRT_API int32_T MWVIP_Blob_Label(
+    const boolean_T    *bw,
+    int_T               numRows,
+    int_T               numCols,
+    int_T               connectivity,
+    uint32_T           *labels,
+    int32_T             maxBlobs,
+    MWVIP_BLOB_MOMENTS *moments  )
+{
+    const int32_T reach = (connectivity == 8) ? 1 : 0;
+    const int_T numStrips = (numCols + MWVIP_BLOB_LABEL_STRIP_COLS - 1)/MWVIP_BLOB_LABEL_STRIP_COLS;
+    int32_T *colStart, *runN, *start, *end, *parent;
+    uint32_T *runLabel;
+    int32_T numRuns = 0, numBlobs = 0, r;
+    int_T n, s;
+
+    if (moments != NULL) MWVIP_Blob_MomentsReset(maxBlobs, moments);
+    if (numRows <= 0 || numCols <= 0) return 0;
+
+    colStart = (int32_T *)malloc(((size_t)numCols + 1)*sizeof(int32_T));
+    if (colStart == NULL) return -1;
+
+    /* 1) runs per column */
+#if defined(MWVIP_BLOB_PARALLEL)
+    #pragma omp parallel for schedule(static) \
+        if (numRows*numCols >= MWVIP_BLOB_MIN_PARALLEL)
+#endif
+    for (n = 0; n < numCols; n++) {
+        const boolean_T *col = &bw[(size_t)n*numRows];
+        int32_T count = 0;
+        int_T m;
+        for (m = 0; m < numRows; m++) {
+            count += (col[m] && (m == 0 || !col[m-1]));
+        }
+        colStart[n+1] = count;
+    }
+    colStart[0] = 0;
+    for (n = 0; n < numCols; n++) colStart[n+1] += colStart[n];
+    numRuns = colStart[numCols];
+
+    runN     = (int32_T *)malloc(((size_t)numRuns + 1)*4*sizeof(int32_T));
+    runLabel = (uint32_T *)malloc(((size_t)numRuns + 1)*sizeof(uint32_T));
+    if (runN == NULL || runLabel == NULL) {
+        free(colStart);
+        free(runN);
+        free(runLabel);
+        return -1;
+    }
+    start  = runN + numRuns + 1;
+    end    = start + numRuns + 1;
+    parent = end + numRuns + 1;
+
+    /* 2) runs and unions within the strips */
+#if defined(MWVIP_BLOB_PARALLEL)
+    #pragma omp parallel for schedule(dynamic, 1) \
+        if (numRows*numCols >= MWVIP_BLOB_MIN_PARALLEL)
+#endif
+    for (s = 0; s < numStrips; s++) {
+        const int_T n0 = s*MWVIP_BLOB_LABEL_STRIP_COLS;
+        const int_T n1 = (n0 + MWVIP_BLOB_LABEL_STRIP_COLS < numCols) ?
+                         n0 + MWVIP_BLOB_LABEL_STRIP_COLS : numCols;
+        int_T c;
+        for (c = n0; c < n1; c++) {
+            const boolean_T *col = &bw[(size_t)c*numRows];
+            int32_T k = colStart[c];
+            int_T m = 0;
+            while (m < numRows) {
+                if (!col[m]) { m++; continue; }
+                runN[k] = (int32_T)c;
+                start[k] = (int32_T)m;
+                while (m < numRows && col[m]) m++;
+                end[k] = (int32_T)m - 1;
+                parent[k] = k;
+                k++;
+            }
+            if (c > n0) {
+                UnionColumns(start, end, parent, colStart[c-1], colStart[c],
+                             colStart[c], colStart[c+1], reach);
+            }
+        }
+    }
+
+    /* 3) unions across the strip borders */
+    for (s = 1; s < numStrips; s++) {
+        const int_T c = s*MWVIP_BLOB_LABEL_STRIP_COLS;
+        UnionColumns(start, end, parent, colStart[c-1], colStart[c],
+                     colStart[c], colStart[c+1], reach);
+    }
+
+    /* labels in run order; a parent precedes its child and has its label */
+    for (r = 0; r < numRuns; r++) {
+        runLabel[r] = (parent[r] == r) ? (uint32_T)(++numBlobs) : runLabel[parent[r]];
+    }
+
+    if (labels != NULL) {
+#if defined(MWVIP_BLOB_PARALLEL)
+        #pragma omp parallel for schedule(static) \
+            if (numRows*numCols >= MWVIP_BLOB_MIN_PARALLEL)
+#endif
+        for (n = 0; n < numCols; n++) {
+            uint32_T *col = &labels[(size_t)n*numRows];
+            int32_T k;
+            memset(col, 0, (size_t)numRows*sizeof(uint32_T));
+            for (k = colStart[n]; k < colStart[n+1]; k++) {
+                int32_T m;
+                for (m = start[k]; m <= end[k]; m++) col[m] = runLabel[k];
+            }
+        }
+    }
+
+    if (moments != NULL) {
+        MWVIP_Blob_MomentsAddRuns(runN, start, end, runLabel, numRuns, maxBlobs, moments);
+    }
+
+    free(colStart);
+    free(runN);
+    free(runLabel);
+    return numBlobs;
+}
+
+/* [EOF] blob_label_rt.c */
@@ -0,0 +1,50 @@
+/*
+ *  BLOB_MOMENTS_RT Moments of all the blobs of a label matrix in one pass.
+ *
+ *  The label matrix is read once, column by column; only the
+ *  MWVIP_BLOB_MOMENTS of each blob is written, so no pixel list is built.
+ *  Labels outside 1..numBlobs are ignored.
+ *
+ *  Copyright 2016 The MathWorks, Inc.
+ */
+
+#include "vipblob_rt.h"
+
+LIBMWVISIONRT_API void MWVIP_Blob_Moments(
+    const uint32_T     *labels,
+    int_T               numRows,
+    int_T               numCols,
+    int32_T             numBlobs,
+    MWVIP_BLOB_MOMENTS *moments  )
+{
+    int_T n, m;
+    MWVIP_Blob_MomentsReset(numBlobs, moments);
+    for (n = 0; n < numCols; n++) {
+        const uint32_T *col = &labels[(size_t)n*numRows];
+        for (m = 0; m < numRows; m++) {
+            const uint32_T label = col[m];
+            MWVIP_BLOB_MOMENTS *mb;
+            real_T dN, dM;
+            if (label == 0U || label > (uint32_T)numBlobs) continue;
+            mb = &moments[label-1U];
+            if (mb->area == 0) {
+                mb->originN = mb->minN = mb->maxN = (int32_T)n;
+                mb->originM = mb->minM = mb->maxM = (int32_T)m;
+            }
+            /* columns are visited in order, rows in order within a column */
+            mb->maxN = (int32_T)n;
+            if ((int32_T)m < mb->minM) mb->minM = (int32_T)m;
+            if ((int32_T)m > mb->maxM) mb->maxM = (int32_T)m;
+            dN = (real_T)((int32_T)n - mb->originN);
+            dM = (real_T)((int32_T)m - mb->originM);
+            mb->area++;
+            mb->sumN  += dN;
+            mb->sumM  += dM;
+            mb->sumNN += dN*dN;
+            mb->sumMM += dM*dM;
+            mb->sumNM += dN*dM;
+        }
+    }
+}
+
+/* [EOF] blob_moments_rt.c */
@@ -0,0 +1,61 @@
+/*
+ *  BLOB_MOMENTSADDRUNS_RT Adds vertical runs of labeled pixels to the
+ *  moments of their blobs.
+ *
+ *  A run of L pixels of column n starting at row m0 adds, with dN and d0
+ *  its offsets from the origin of the blob,
+ *
+ *     sumN  += L*dN            sumM  += L*d0 + L*(L-1)/2
+ *     sumNN += L*dN^2          sumMM += sum of (d0+k)^2, k = 0..L-1
+ *     sumNM += dN*(sum of (d0+k), k = 0..L-1)
+ *
+ *  so the cost is per run, not per pixel. All the terms are integers, exact
+ *  in real_T for sums below 2^53.
+ *
+ *  Copyright 2016 The MathWorks, Inc.
+ */
+
+#include "vipblob_rt.h"
+
+LIBMWVISIONRT_API void MWVIP_Blob_MomentsAddRuns(
+    const int32_T      *runN,
+    const int32_T      *runMStart,
+    const int32_T      *runMEnd,
+    const uint32_T     *runLabel,
+    int32_T             numRuns,
+    int32_T             numBlobs,
+    MWVIP_BLOB_MOMENTS *moments  )
+{
+    int32_T r;
+    for (r = 0; r < numRuns; r++) {
+        const uint32_T label = runLabel[r];
+        const int32_T  n  = runN[r];
+        const int32_T  m0 = runMStart[r];
+        const int32_T  m1 = runMEnd[r];
+        MWVIP_BLOB_MOMENTS *mb;
+        real_T L, dN, d0, sumD;
+        if (label == 0U || label > (uint32_T)numBlobs || m1 < m0) continue;
+        mb = &moments[label-1U];
+        if (mb->area == 0) {
+            mb->originN = mb->minN = mb->maxN = n;
+            mb->originM = mb->minM = mb->maxM = m0;
+        }
+        if (n  < mb->minN) mb->minN = n;
+        if (n  > mb->maxN) mb->maxN = n;
+        if (m0 < mb->minM) mb->minM = m0;
+        if (m1 > mb->maxM) mb->maxM = m1;
+
+        L    = (real_T)m1 - (real_T)m0 + 1.0;
+        dN   = (real_T)n  - (real_T)mb->originN;
+        d0   = (real_T)m0 - (real_T)mb->originM;
+        sumD = L*d0 + 0.5*L*(L-1.0);
+        mb->area  += (int32_T)L;
+        mb->sumN  += L*dN;
+        mb->sumM  += sumD;
+        mb->sumNN += L*dN*dN;
+        mb->sumMM += L*d0*d0 + d0*L*(L-1.0) + (L-1.0)*L*(2.0*L-1.0)/6.0;
+        mb->sumNM += dN*sumD;
+    }
+}
+
+/* [EOF] blob_momentsaddruns_rt.c */
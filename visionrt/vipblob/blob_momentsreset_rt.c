@@ -0,0 +1,19 @@
+/*
+ *  BLOB_MOMENTSRESET_RT Clears the moments of numBlobs blobs.
+ *
+ *  Copyright 2016 The MathWorks, Inc.
+ */
+
+#include <string.h>
+#include "vipblob_rt.h"
+
+LIBMWVISIONRT_API void MWVIP_Blob_MomentsReset(
+    int32_T             numBlobs,
+    MWVIP_BLOB_MOMENTS *moments  )
+{
+    if (numBlobs > 0) {
+        memset(moments, 0, (size_t)numBlobs*sizeof(MWVIP_BLOB_MOMENTS));
+    }
+}
+
+/* [EOF] blob_momentsreset_rt.c */
@@ -0,0 +1,46 @@
+/*
+ *  BLOB_STATS_D_RT Area, centroid, bounding box and second central
+ *  moments of many blobs from accumulated moments, double precision.
+ *
+ *  Copyright 2016 The MathWorks, Inc.
+ */
+
+#include "vipblob_rt.h"
+
+LIBMWVISIONRT_API void MWVIP_Blob_Stats_D(
+    const MWVIP_BLOB_MOMENTS *moments,
+    int32_T           numBlobs,
+    int32_T          *area,
+    real_T         *centroidN,
+    real_T         *centroidM,
+    int32_T          *bbox,
+    real_T         *uNN,
+    real_T         *uMM,
+    real_T         *uNM  )
+{
+    int32_T b;
+    for (b = 0; b < numBlobs; b++) {
+        const MWVIP_BLOB_MOMENTS *mb = &moments[b];
+        real_T meanN = 0.0, meanM = 0.0, cNN = 0.0, cMM = 0.0, cNM = 0.0;
+        if (mb->area > 0) {
+            const real_T a = (real_T)mb->area;
+            meanN = mb->sumN/a;
+            meanM = mb->sumM/a;
+            cNN = mb->sumNN/a - meanN*meanN;
+            cMM = mb->sumMM/a - meanM*meanM;
+            cNM = mb->sumNM/a - meanN*meanM;
+        }
+        area[b]      = mb->area;
+        centroidN[b] = (real_T)(mb->originN + meanN);
+        centroidM[b] = (real_T)(mb->originM + meanM);
+        bbox[b]              = mb->minN;
+        bbox[b +   numBlobs] = mb->minM;
+        bbox[b + 2*numBlobs] = (mb->area > 0) ? mb->maxN - mb->minN + 1 : 0;
+        bbox[b + 3*numBlobs] = (mb->area > 0) ? mb->maxM - mb->minM + 1 : 0;
+        uNN[b] = (real_T)cNN;
+        uMM[b] = (real_T)cMM;
+        uNM[b] = (real_T)cNM;
+    }
+}
+
+/* [EOF] blob_stats_d_rt.c */
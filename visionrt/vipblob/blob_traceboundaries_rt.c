@@ -0,0 +1,173 @@
+/*
+ *  BLOB_TRACEBOUNDARIES_RT Traces the outer boundaries of all the blobs of
+ *  a label matrix.
+ *
+ *  Each blob is traced independently by Moore neighbor tracing, from its
+ *  first pixel in a column-wise scan, clockwise with the background on the
+ *  left. The neighbors are searched clockwise starting after the backtrack
+ *  pixel, the last background pixel seen, which starts to the west of the
+ *  first pixel. Tracing stops at the first pixel when the next step
+ *  repeats the first one.
+ *
+ *  Two passes over the blobs, both in parallel: the first counts the
+ *  points of every boundary, to place all of them in one buffer by a
+ *  prefix sum, and the second traces again to write them.
+ *
+ *  Copyright 2016 The MathWorks, Inc.
+ */
+
+#include <stdlib.h>
+#include "vipblob_rt.h"
+
+/* E, SE, S, SW, W, NW, N, NE: clockwise, rows growing downwards */
+static const int32_T dirM[8] = { 0,  1,  1,  1,  0, -1, -1, -1 };
+static const int32_T dirN[8] = { 1,  1,  0, -1, -1, -1,  0,  1 };
+
+/* direction of the offset (dM, dN), indexed by (dM+1)*3 + dN+1 */
+static const int32_T offsetDir[9] = { 5, 6, 7, 4, -1, 0, 3, 2, 1 };
+
+static boolean_T IsBlob(const uint32_T *labels, int_T numRows, int_T numCols,
+                        int32_T m, int32_T n, uint32_T label)
+{
+    return (boolean_T)(m >= 0 && m < numRows && n >= 0 && n < numCols &&
+                       labels[(size_t)n*numRows + m] == label);
+}
+
+/* next boundary pixel clockwise around (m, n) from the backtrack
+ * direction *back, which is updated for the next pixel; -1 for a blob of
+ * one pixel. step is 1 for 8 and 2 for 4 connectivity. */
+static int32_T NextDir(const uint32_T *labels, int_T numRows, int_T numCols,
+                       int32_T m, int32_T n, uint32_T label, int32_T step,
+                       int32_T *back)
+{
+    int32_T last = *back, i;
+    for (i = 1; i <= 8; i++) {
+        const int32_T d = (*back + i) & 7;
+        if (step == 2 && (d & 1)) continue;
+        if (IsBlob(labels, numRows, numCols, m + dirM[d], n + dirN[d], label)) {
+            /* the last background pixel, seen from the new pixel */
+            *back = offsetDir[(dirM[last] - dirM[d] + 1)*3 + dirN[last] - dirN[d] + 1];
+            return d;
+        }
+        last = d;
+    }
+    return -1;
+}
+
+/* traces the blob from (m0, n0) and returns the number of points of the
+ * closed boundary, the first point being repeated at the end; the points
+ * are written when pointM is not NULL */
+static int32_T TraceBlob(const uint32_T *labels, int_T numRows, int_T numCols,
+                         uint32_T label, int32_T step, int32_T m0, int32_T n0,
+                         int32_T *pointM, int32_T *pointN)
+{
+    int32_T back = 4, first, d, m, n, count = 1;
+    if (pointM != NULL) { pointM[0] = m0; pointN[0] = n0; }
+
+    first = NextDir(labels, numRows, numCols, m0, n0, label, step, &back);
+    if (first < 0) {
+        if (pointM != NULL) { pointM[1] = m0; pointN[1] = n0; }
+        return 2;
+    }
+    d = first;
+    m = m0;
+    n = n0;
+    for (;;) {
+        m += dirM[d];
+        n += dirN[d];
+        if (pointM != NULL) { pointM[count] = m; pointN[count] = n; }
+        count++;
+        d = NextDir(labels, numRows, numCols, m, n, label, step, &back);
+        if (m == m0 && n == n0 && d == first) break;
+    }
+    return count;
+}
+
+LIBMWVISIONRT_API int32_T MWVIP_Blob_TraceBoundaries(
+    const uint32_T           *labels,
+    int_T                     numRows,
+    int_T                     numCols,
+    int_T                     connectivity,
+    int32_T                   numBlobs,
+    const MWVIP_BLOB_MOMENTS *moments,
+    int32_T                  *pointM,
+    int32_T                  *pointN,
+    int32_T                   maxPoints,
+    int32_T                  *pointStart  )
+{
+    const int32_T step = (connectivity == 8) ? 1 : 2;
+    int32_T *startM, *startN;
+    int32_T b, total = 0;
+
+    pointStart[0] = 0;
+    if (numBlobs <= 0) return 0;
+
+    startM = (int32_T *)malloc(2*(size_t)numBlobs*sizeof(int32_T));
+    if (startM == NULL) return -1;
+    startN = startM + numBlobs;
+    for (b = 0; b < numBlobs; b++) startM[b] = -1;
+
+    /* the first pixel of each blob is the top one of its first column */
+    if (moments != NULL) {
+#if defined(MWVIP_BLOB_PARALLEL)
+        #pragma omp parallel for schedule(static) \
+            if (numBlobs >= MWVIP_BLOB_MIN_PARALLEL)
+#endif
+        for (b = 0; b < numBlobs; b++) {
+            const int32_T n = moments[b].minN;
+            int32_T m;
+            if (moments[b].area == 0) continue;
+            for (m = moments[b].minM; m <= moments[b].maxM; m++) {
+                if (labels[(size_t)n*numRows + m] == (uint32_T)(b+1)) {
+                    startM[b] = m;
+                    startN[b] = n;
+                    break;
+                }
+            }
+        }
+    } else {
+        const size_t numPixels = (size_t)numRows*numCols;
+        int32_T numFound = 0;
+        size_t k;
+        for (k = 0; k < numPixels && numFound < numBlobs; k++) {
+            const uint32_T label = labels[k];
+            if (label != 0U && label <= (uint32_T)numBlobs && startM[label-1U] < 0) {
+                startM[label-1U] = (int32_T)(k % numRows);
+                startN[label-1U] = (int32_T)(k / numRows);
+                numFound++;
+            }
+        }
+    }
+
+    /* 1) points per boundary; blobs that are absent get none */
+#if defined(MWVIP_BLOB_PARALLEL)
+    #pragma omp parallel for schedule(dynamic, 16) \
+        if (numRows*numCols >= MWVIP_BLOB_MIN_PARALLEL)
+#endif
+    for (b = 0; b < numBlobs; b++) {
+        pointStart[b+1] = (startM[b] < 0) ? 0 :
+            TraceBlob(labels, numRows, numCols, (uint32_T)(b+1), step,
+                      startM[b], startN[b], NULL, NULL);
+    }
+    for (b = 0; b < numBlobs; b++) {
+        total += pointStart[b+1];
+        pointStart[b+1] = total;
+    }
+
+    /* 2) the boundaries that fit in the buffer */
+#if defined(MWVIP_BLOB_PARALLEL)
+    #pragma omp parallel for schedule(dynamic, 16) \
+        if (numRows*numCols >= MWVIP_BLOB_MIN_PARALLEL)
+#endif
+    for (b = 0; b < numBlobs; b++) {
+        const int32_T p0 = pointStart[b];
+        if (startM[b] < 0 || pointStart[b+1] > maxPoints) continue;
+        TraceBlob(labels, numRows, numCols, (uint32_T)(b+1), step,
+                  startM[b], startN[b], pointM + p0, pointN + p0);
+    }
+
+    free(startM);
+    return total;
+}
+
+/* [EOF] blob_traceboundaries_rt.c */
@@ -22,7 +22,7 @@ LIBMWVISIONRT_API void MWVIP_BlockMatching_3Step_MAD_D(
                                 const int_T colsPadImgP)
 { 
     int_T i;
-    int_T  c1, r1, dx, dy, xIdx=0, yIdx=0;
+    int_T  blkCol, numBlkCols, numBlkRows;
     real_T *tmpC, *tmpP;
     const real_T *tmpU;
 
@@ -85,22 +85,32 @@ LIBMWVISIONRT_API void MWVIP_BlockMatching_3Step_MAD_D(
        tmpU += inRows;
     }
 
-    i=0; 
-    for (c1 = startXpadImgP; c1 < colsPadImgP-startXpadImgP-xIncr+1; c1 += xIncr) 
+    numBlkCols = MWVIP_BLOCKMATCH_NUM_BLOCKS(colsPadImgP, startXpadImgP, xIncr);
+    numBlkRows = MWVIP_BLOCKMATCH_NUM_BLOCKS(rowsPadImgP, startYpadImgP, yIncr);
+
+    /* the blocks are independent and block column blkCol writes outputs
+     * blkCol*numBlkRows onwards, so the columns may be searched in parallel */
+#ifdef MWVIP_BLOCKMATCH_PARALLEL
+#pragma omp parallel for schedule(dynamic) if (numBlkCols*numBlkRows >= MWVIP_BLOCKMATCH_MIN_PARALLEL_BLOCKS)
+#endif
+    for (blkCol = 0; blkCol < numBlkCols; blkCol++) 
     {
-        int_T colIdx = c1-startXpadImgP;
+        int_T colIdx = blkCol*xIncr;
         int_T offsetIdxImgC = colIdx*rowsPadImgC;
         int_T offsetIdxImgP = colIdx*rowsPadImgP;
+        int_T outIdx = blkCol*numBlkRows;
+        int_T blkRow;
 
-        for (r1 = startYpadImgP; r1 < rowsPadImgP-startYpadImgP-yIncr+1; r1 += yIncr)
+        for (blkRow = 0; blkRow < numBlkRows; blkRow++)
         {
-            int_T rowIdx = r1-startYpadImgP;
+            int_T rowIdx = blkRow*yIncr;
+            int_T  dx, dy, xIdx=0, yIdx=0;
             
-            /* tmpC is pointer to this_block and tmpP is pointer to search_region */
-            tmpC = &paddedImgC[offsetIdxImgC + rowIdx];
-            tmpP = &paddedImgP[offsetIdxImgP + rowIdx];
+            /* blkC is pointer to this_block and blkP is pointer to search_region */
+            real_T *blkC = &paddedImgC[offsetIdxImgC + rowIdx];
+            real_T *blkP = &paddedImgP[offsetIdxImgP + rowIdx];
 
-            MWVIP_SearchMethod_3Step_MAD_D(tmpC,tmpP,
+            MWVIP_SearchMethod_3Step_MAD_D(blkC,blkP,
                                           rowsPadImgC,rowsPadImgP,
                                           blkWidthX,blkHeightY,
                                           searchRegionWidthX, searchRegionHeightY,
@@ -108,7 +118,7 @@ LIBMWVISIONRT_API void MWVIP_BlockMatching_3Step_MAD_D(
 
             dx = xIdx-maxDX;
             dy = yIdx-maxDY;
-            yMVsqmag[i++] = dx*dx + dy*dy; 
+            yMVsqmag[outIdx++] = dx*dx + dy*dy; 
         }
     }
 }
@@ -22,7 +22,7 @@ LIBMWVISIONRT_API void MWVIP_BlockMatching_Full_MAD_C(
                                 const int_T colsPadImgP)
 { 
     int_T i;
-    int_T  c1, r1, xIdx=0, yIdx=0;
+    int_T  blkCol, numBlkCols, numBlkRows;
     real32_T *tmpC, *tmpP;
     const real32_T *tmpU;
 
@@ -85,29 +85,39 @@ LIBMWVISIONRT_API void MWVIP_BlockMatching_Full_MAD_C(
        tmpU += inRows;
     }
 
-    i=0; 
-    for (c1 = startXpadImgP; c1 < colsPadImgP-startXpadImgP-xIncr+1; c1 += xIncr) 
+    numBlkCols = MWVIP_BLOCKMATCH_NUM_BLOCKS(colsPadImgP, startXpadImgP, xIncr);
+    numBlkRows = MWVIP_BLOCKMATCH_NUM_BLOCKS(rowsPadImgP, startYpadImgP, yIncr);
+
+    /* the blocks are independent and block column blkCol writes outputs
+     * blkCol*numBlkRows onwards, so the columns may be searched in parallel */
+#ifdef MWVIP_BLOCKMATCH_PARALLEL
+#pragma omp parallel for schedule(dynamic) if (numBlkCols*numBlkRows >= MWVIP_BLOCKMATCH_MIN_PARALLEL_BLOCKS)
+#endif
+    for (blkCol = 0; blkCol < numBlkCols; blkCol++) 
     {
-        int_T colIdx = c1-startXpadImgP;
+        int_T colIdx = blkCol*xIncr;
         int_T offsetIdxImgC = colIdx*rowsPadImgC;
         int_T offsetIdxImgP = colIdx*rowsPadImgP;
+        int_T outIdx = blkCol*numBlkRows;
+        int_T blkRow;
 
-        for (r1 = startYpadImgP; r1 < rowsPadImgP-startYpadImgP-yIncr+1; r1 += yIncr)
+        for (blkRow = 0; blkRow < numBlkRows; blkRow++)
         {
-            int_T rowIdx = r1-startYpadImgP;
+            int_T rowIdx = blkRow*yIncr;
+            int_T  xIdx=0, yIdx=0;
             
-            /* tmpC is pointer to this_block and tmpP is pointer to search_region */
-            tmpC = &paddedImgC[offsetIdxImgC + rowIdx];
-            tmpP = &paddedImgP[offsetIdxImgP + rowIdx];
+            /* blkC is pointer to this_block and blkP is pointer to search_region */
+            real32_T *blkC = &paddedImgC[offsetIdxImgC + rowIdx];
+            real32_T *blkP = &paddedImgP[offsetIdxImgP + rowIdx];
 
-            MWVIP_SearchMethod_Full_MAD_R(tmpC,tmpP,
+            MWVIP_SearchMethod_Full_MAD_R(blkC,blkP,
                                           rowsPadImgC,rowsPadImgP,
                                           blkWidthX,blkHeightY,
                                           searchRegionWidthX, searchRegionHeightY,
                                           &xIdx, &yIdx);
 
-            yMVcplx[i].re   = (real32_T)(xIdx-maxDX);
-            yMVcplx[i++].im = (real32_T)(yIdx-maxDY);
+            yMVcplx[outIdx].re   = (real32_T)(xIdx-maxDX);
+            yMVcplx[outIdx++].im = (real32_T)(yIdx-maxDY);
         }
     }
 }
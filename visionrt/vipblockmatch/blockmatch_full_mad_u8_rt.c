@@ -0,0 +1,126 @@
+/*
+ *  BLOCKMATCHING_FULL_MAD_U8_RT Helper function for Block Matching block.
+ *
+ *  Copyright 2016 The MathWorks, Inc.
+ */
+#include "vipblockmatch_rt.h"  
+
+LIBMWVISIONRT_API void MWVIP_BlockMatching_Full_MAD_U8(
+                                const uint8_T *uImgCurr,
+                                const uint8_T *uImgPrev,
+                                uint8_T *paddedImgC,
+                                uint8_T *paddedImgP,
+                                real32_T *yMVsqmag,
+                                int32_T *blockSize,
+                                int32_T *overlapSize,
+                                int32_T *maxDisplSize,
+                                const int_T inRows,
+                                const int_T inCols,
+                                const int_T rowsPadImgC,
+                                const int_T colsPadImgC,
+                                const int_T rowsPadImgP,
+                                const int_T colsPadImgP)
+{ 
+    int_T i;
+    int_T  blkCol, numBlkCols, numBlkRows;
+    uint8_T *tmpC, *tmpP;
+    const uint8_T *tmpU;
+
+    const int_T blkHeightY = blockSize[0]; /* [rows=Height(y)     cols=width(x)] */
+    const int_T blkWidthX  = blockSize[1]; 
+
+    const int_T yOverlap   = overlapSize[0];   
+    const int_T xOverlap   = overlapSize[1];
+
+    const int_T maxDY      = maxDisplSize[0];
+    const int_T maxDX      = maxDisplSize[1];
+      
+    const int_T xPadLside = xOverlap/2; /* padding at left */
+    const int_T yPadTside = yOverlap/2; /* padding at top  */
+
+    const int_T xIncr = blkWidthX  - xOverlap;
+    const int_T yIncr = blkHeightY - yOverlap;
+
+    const int_T searchRegionWidthX  = blkWidthX  + 2*maxDX;
+    const int_T searchRegionHeightY = blkHeightY + 2*maxDY;   
+
+    const int_T bytesPerInputCol = inRows*sizeof(uint8_T);
+
+    const int_T startXpadImgP = maxDX+xPadLside;
+    const int_T startYpadImgP = maxDY+yPadTside;
+
+    /*
+            ----------> (x = along column)
+            |
+            |
+            |
+            |
+           \|/
+            '  (y = along row)
+    */
+
+    if (paddedImgC != uImgCurr)
+    {
+        /* copy input (uImgCurr) to dwork (paddedImgC) and pad in all sides */
+        memset(paddedImgC,0, (rowsPadImgC*colsPadImgC*sizeof(uint8_T)));
+        tmpC = &paddedImgC[xPadLside*rowsPadImgC + yPadTside];
+        tmpU = uImgCurr;
+        for (i=0; i<inCols; i++) 
+        {
+        memcpy(tmpC, tmpU, bytesPerInputCol);
+        tmpC += rowsPadImgC;
+        tmpU += inRows;
+        }
+    }
+    
+    /* copy input (uImgPrev) to dwork (paddedImgP) and pad in all sides */
+
+    memset(paddedImgP,0, (rowsPadImgP*colsPadImgP*sizeof(uint8_T)));
+    tmpP = &paddedImgP[startXpadImgP*rowsPadImgP + startYpadImgP];
+    tmpU = uImgPrev;
+    for (i=0; i<inCols; i++) 
+    {
+       memcpy(tmpP, tmpU, bytesPerInputCol);
+       tmpP += rowsPadImgP;
+       tmpU += inRows;
+    }
+
+    numBlkCols = MWVIP_BLOCKMATCH_NUM_BLOCKS(colsPadImgP, startXpadImgP, xIncr);
+    numBlkRows = MWVIP_BLOCKMATCH_NUM_BLOCKS(rowsPadImgP, startYpadImgP, yIncr);
+
+    /* the blocks are independent and block column blkCol writes outputs
+     * blkCol*numBlkRows onwards, so the columns may be searched in parallel */
+#ifdef MWVIP_BLOCKMATCH_PARALLEL
+#pragma omp parallel for schedule(dynamic) if (numBlkCols*numBlkRows >= MWVIP_BLOCKMATCH_MIN_PARALLEL_BLOCKS)
+#endif
+    for (blkCol = 0; blkCol < numBlkCols; blkCol++) 
+    {
+        int_T colIdx = blkCol*xIncr;
+        int_T offsetIdxImgC = colIdx*rowsPadImgC;
+        int_T offsetIdxImgP = colIdx*rowsPadImgP;
+        int_T outIdx = blkCol*numBlkRows;
+        int_T blkRow;
+
+        for (blkRow = 0; blkRow < numBlkRows; blkRow++)
+        {
+            int_T rowIdx = blkRow*yIncr;
+            int_T  dx, dy, xIdx=0, yIdx=0;
+            
+            /* blkC is pointer to this_block and blkP is pointer to search_region */
+            uint8_T *blkC = &paddedImgC[offsetIdxImgC + rowIdx];
+            uint8_T *blkP = &paddedImgP[offsetIdxImgP + rowIdx];
+
+            MWVIP_SearchMethod_Full_MAD_U8(blkC,blkP,
+                                          rowsPadImgC,rowsPadImgP,
+                                          blkWidthX,blkHeightY,
+                                          searchRegionWidthX, searchRegionHeightY,
+                                          &xIdx, &yIdx);
+
+            dx = xIdx-maxDX;
+            dy = yIdx-maxDY;
+            yMVsqmag[outIdx++] = (real32_T)(dx*dx + dy*dy); 
+        }
+    }
+}
+
+/* [EOF] blockmatching_full_mad_u8_rt.c */
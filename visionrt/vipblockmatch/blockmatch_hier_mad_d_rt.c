@@ -0,0 +1,301 @@
+/*
+ *  BLOCKMATCHING_HIER_MAD_D_RT Helper function for Block Matching block.
+ *
+ *  Hierarchical search: both frames are padded as the previous frame of
+ *  the other drivers (rowsPadImgP x colsPadImgP) and reduced numLevels
+ *  times by 2x2 averaging into pyrC and pyrP. Each block is searched
+ *  exhaustively on the coarsest level, where the displacement range is
+ *  divided by 2^numLevels, and the vector is refined by +-1 on each finer
+ *  level. At full resolution the refined vector competes with the zero
+ *  vector, the vector of the block above, and the vectors of the block and
+ *  its four neighbours in the previous frame (prevMV, may be NULL). The
+ *  best of these is refined by +-1 steps until no neighbour is better.
+ *
+ *  yMV receives the motion vectors (x then y for each block, in the order
+ *  of yMVsqmag); pass it as prevMV of the next frame. yMVsqmag may be
+ *  NULL. pyrC and pyrP hold rowsPadImgP*colsPadImgP/3 elements each.
+ *  numLevels is reduced so that the blocks keep at least 2x2 pixels.
+ *
+ *  Copyright 2016 The MathWorks, Inc.
+ */
+#include "vipblockmatch_rt.h"  
+
+/* reduces src (rows x cols) by 2x2 averaging into dst */
+static void MWVIP_HierDownsample_D(const real_T *src, real_T *dst,
+                                  int_T rows, int_T cols)
+{
+    const int_T dstRows = rows>>1;
+    const int_T dstCols = cols>>1;
+    int_T r, c;
+
+    for (c=0; c<dstCols; c++)
+    {
+        const real_T *s0 = &src[2*c*rows];
+        const real_T *s1 = s0 + rows;
+        real_T *d = &dst[c*dstRows];
+        for (r=0; r<dstRows; r++)
+        {
+            d[r] = (s0[2*r] + s0[2*r+1] + s1[2*r] + s1[2*r+1])*0.25;
+        }
+    }
+}
+
+/* sum of absolute differences, abandoned once it reaches bound */
+static real_T MWVIP_HierCost_D(const real_T *blkC, const real_T *blkP,
+                               int_T rows, int_T blkWidthX, int_T blkHeightY,
+                               real_T bound)
+{
+    real_T sum = 0;
+    int_T c1, r1;
+    for (c1=0; c1<blkWidthX; c1++)
+    {
+        const real_T *cs = &blkC[c1*rows];
+        const real_T *pb = &blkP[c1*rows];
+        for (r1=0; r1<blkHeightY; r1++)
+        {
+            sum += fabs(cs[r1] - pb[r1]);
+        }
+        /* the sum can only grow: stop once this candidate cannot win */
+        if (sum >= bound) break;
+    }
+    return sum;
+}
+
+/* moves (dx,dy) to the best displacement of [xLo,xHi] x [yLo,yHi] that
+ * costs less than *best; blkC is at column cx, row cy of imgP */
+static void MWVIP_HierSearch_D(const real_T *blkC, const real_T *imgP,
+                                int_T rows, int_T cx, int_T cy,
+                                int_T blkWidthX, int_T blkHeightY,
+                                int_T xLo, int_T xHi, int_T yLo, int_T yHi,
+                                int_T *dx, int_T *dy, real_T *best)
+{
+    int_T x, y;
+    for (x=xLo; x<=xHi; x++)
+    {
+        const real_T *colP = &imgP[(cx+x)*rows + cy];
+        for (y=yLo; y<=yHi; y++)
+        {
+            real_T cost = MWVIP_HierCost_D(blkC, &colP[y], rows,
+                                          blkWidthX, blkHeightY, best[0]);
+            if (cost < best[0])
+            {
+                best[0] = cost;
+                dx[0] = x;
+                dy[0] = y;
+            }
+        }
+    }
+}
+
+LIBMWVISIONRT_API void MWVIP_BlockMatching_Hier_MAD_D(
+                                const real_T *uImgCurr,
+                                const real_T *uImgPrev,
+                                real_T *paddedImgC,
+                                real_T *paddedImgP,
+                                real_T *pyrC,
+                                real_T *pyrP,
+                                const int32_T *prevMV,
+                                int32_T *yMV,
+                                real_T *yMVsqmag,
+                                int32_T *blockSize,
+                                int32_T *overlapSize,
+                                int32_T *maxDisplSize,
+                                int32_T numLevels,
+                                const int_T inRows,
+                                const int_T inCols,
+                                const int_T rowsPadImgP,
+                                const int_T colsPadImgP)
+{ 
+    int_T i;
+    int_T  blkCol, numBlkCols, numBlkRows;
+    real_T *tmpC, *tmpP;
+    const real_T *tmpU, *tmpV;
+    const real_T *levelC[MWVIP_BLOCKMATCH_MAX_LEVELS+1];
+    const real_T *levelP[MWVIP_BLOCKMATCH_MAX_LEVELS+1];
+
+    const int_T blkHeightY = blockSize[0]; /* [rows=Height(y)     cols=width(x)] */
+    const int_T blkWidthX  = blockSize[1]; 
+
+    const int_T yOverlap   = overlapSize[0];   
+    const int_T xOverlap   = overlapSize[1];
+
+    const int_T maxDY      = maxDisplSize[0];
+    const int_T maxDX      = maxDisplSize[1];
+      
+    const int_T xPadLside = xOverlap/2; /* padding at left */
+    const int_T yPadTside = yOverlap/2; /* padding at top  */
+
+    const int_T xIncr = blkWidthX  - xOverlap;
+    const int_T yIncr = blkHeightY - yOverlap;
+
+    const int_T bytesPerInputCol = inRows*sizeof(real_T);
+
+    const int_T startXpadImgP = maxDX+xPadLside;
+    const int_T startYpadImgP = maxDY+yPadTside;
+
+    int_T numLev = MIN(numLevels, MWVIP_BLOCKMATCH_MAX_LEVELS);
+    while (numLev > 0 && ((blkWidthX>>numLev) < 2 || (blkHeightY>>numLev) < 2))
+    {
+        numLev--;
+    }
+
+    /* copy both inputs to dwork (paddedImgC, paddedImgP) and pad in all sides */
+    memset(paddedImgC,0, (rowsPadImgP*colsPadImgP*sizeof(real_T)));
+    memset(paddedImgP,0, (rowsPadImgP*colsPadImgP*sizeof(real_T)));
+    tmpC = &paddedImgC[startXpadImgP*rowsPadImgP + startYpadImgP];
+    tmpP = &paddedImgP[startXpadImgP*rowsPadImgP + startYpadImgP];
+    tmpU = uImgCurr;
+    tmpV = uImgPrev;
+    for (i=0; i<inCols; i++) 
+    {
+       memcpy(tmpC, tmpU, bytesPerInputCol);
+       memcpy(tmpP, tmpV, bytesPerInputCol);
+       tmpC += rowsPadImgP;
+       tmpP += rowsPadImgP;
+       tmpU += inRows;
+       tmpV += inRows;
+    }
+
+    /* pyramid: level i is (rowsPadImgP>>i) x (colsPadImgP>>i) */
+    levelC[0] = paddedImgC;
+    levelP[0] = paddedImgP;
+    tmpC = pyrC;
+    tmpP = pyrP;
+    for (i=1; i<=numLev; i++)
+    {
+        const int_T rows = rowsPadImgP>>(i-1);
+        const int_T cols = colsPadImgP>>(i-1);
+        MWVIP_HierDownsample_D(levelC[i-1], tmpC, rows, cols);
+        MWVIP_HierDownsample_D(levelP[i-1], tmpP, rows, cols);
+        levelC[i] = tmpC;
+        levelP[i] = tmpP;
+        tmpC += (rows>>1)*(cols>>1);
+        tmpP += (rows>>1)*(cols>>1);
+    }
+
+    numBlkCols = MWVIP_BLOCKMATCH_NUM_BLOCKS(colsPadImgP, startXpadImgP, xIncr);
+    numBlkRows = MWVIP_BLOCKMATCH_NUM_BLOCKS(rowsPadImgP, startYpadImgP, yIncr);
+
+    /* the predictors of a block are the block above, in the same block
+     * column, and prevMV, so the columns may be searched in parallel */
+#ifdef MWVIP_BLOCKMATCH_PARALLEL
+#pragma omp parallel for schedule(dynamic) if (numBlkCols*numBlkRows >= MWVIP_BLOCKMATCH_MIN_PARALLEL_BLOCKS)
+#endif
+    for (blkCol = 0; blkCol < numBlkCols; blkCol++) 
+    {
+        int_T colIdx = blkCol*xIncr;
+        int_T outIdx = blkCol*numBlkRows;
+        int_T blkRow;
+
+        for (blkRow = 0; blkRow < numBlkRows; blkRow++)
+        {
+            int_T rowIdx = blkRow*yIncr;
+            int_T dx = 0, dy = 0;
+            int_T lev, k;
+            int_T candX[8], candY[8];
+            int_T numCand = 0;
+            real_T best;
+
+            /* coarse to fine, down to level 1 */
+            for (lev = numLev; lev > 0; lev--)
+            {
+                const int_T rows = rowsPadImgP>>lev;
+                const int_T cx = (colIdx+maxDX)>>lev;
+                const int_T cy = (rowIdx+maxDY)>>lev;
+                const int_T bw = blkWidthX>>lev;
+                const int_T bh = blkHeightY>>lev;
+                const int_T rx = (maxDX + (1<<lev) - 1)>>lev;
+                const int_T ry = (maxDY + (1<<lev) - 1)>>lev;
+                const int_T xLo = MAX(-rx, -cx);
+                const int_T xHi = MIN( rx, ((colsPadImgP>>lev) - bw) - cx);
+                const int_T yLo = MAX(-ry, -cy);
+                const int_T yHi = MIN( ry, rows - bh - cy);
+                const real_T *blkC = &levelC[lev][cx*rows + cy];
+
+                best = MAX_real_T;
+                if (lev == numLev)
+                {
+                    MWVIP_HierSearch_D(blkC, levelP[lev], rows, cx, cy, bw, bh,
+                                        xLo, xHi, yLo, yHi, &dx, &dy, &best);
+                }
+                else
+                {
+                    int_T x0 = MIN(MAX(2*dx, xLo), xHi);
+                    int_T y0 = MIN(MAX(2*dy, yLo), yHi);
+                    MWVIP_HierSearch_D(blkC, levelP[lev], rows, cx, cy, bw, bh,
+                                        MAX(x0-1, xLo), MIN(x0+1, xHi),
+                                        MAX(y0-1, yLo), MIN(y0+1, yHi),
+                                        &dx, &dy, &best);
+                }
+            }
+
+            /* full resolution: the pyramid vector and the predictors */
+            if (numLev > 0)
+            {
+                candX[numCand] = 2*dx; candY[numCand++] = 2*dy;
+            }
+            candX[numCand] = 0; candY[numCand++] = 0;
+            if (blkRow > 0)
+            {
+                candX[numCand] = yMV[2*(outIdx-1)];
+                candY[numCand++] = yMV[2*(outIdx-1)+1];
+            }
+            if (prevMV != NULL)
+            {
+                int_T nbr[5];
+                int_T numNbr = 0;
+                nbr[numNbr++] = outIdx;
+                if (blkRow > 0)              nbr[numNbr++] = outIdx-1;
+                if (blkRow < numBlkRows-1)   nbr[numNbr++] = outIdx+1;
+                if (blkCol > 0)              nbr[numNbr++] = outIdx-numBlkRows;
+                if (blkCol < numBlkCols-1)   nbr[numNbr++] = outIdx+numBlkRows;
+                for (k=0; k<numNbr; k++)
+                {
+                    candX[numCand] = prevMV[2*nbr[k]];
+                    candY[numCand++] = prevMV[2*nbr[k]+1];
+                }
+            }
+
+            {
+                const int_T cx = colIdx+maxDX;
+                const int_T cy = rowIdx+maxDY;
+                const real_T *blkC = &paddedImgC[cx*rowsPadImgP + cy];
+                int_T x0, y0;
+
+                best = MAX_real_T;
+                dx = 0;
+                dy = 0;
+                for (k=0; k<numCand; k++)
+                {
+                    x0 = MIN(MAX(candX[k], -maxDX), maxDX);
+                    y0 = MIN(MAX(candY[k], -maxDY), maxDY);
+                    MWVIP_HierSearch_D(blkC, paddedImgP, rowsPadImgP, cx, cy,
+                                        blkWidthX, blkHeightY,
+                                        x0, x0, y0, y0, &dx, &dy, &best);
+                }
+
+                /* the cost decreases at each step, so the descent ends */
+                do
+                {
+                    x0 = dx;
+                    y0 = dy;
+                    MWVIP_HierSearch_D(blkC, paddedImgP, rowsPadImgP, cx, cy,
+                                        blkWidthX, blkHeightY,
+                                        MAX(x0-1, -maxDX), MIN(x0+1, maxDX),
+                                        MAX(y0-1, -maxDY), MIN(y0+1, maxDY),
+                                        &dx, &dy, &best);
+                } while (dx != x0 || dy != y0);
+            }
+
+            yMV[2*outIdx]   = (int32_T)dx;
+            yMV[2*outIdx+1] = (int32_T)dy;
+            if (yMVsqmag)
+            {
+                yMVsqmag[outIdx] = (real_T)(dx*dx + dy*dy);
+            }
+            outIdx++;
+        }
+    }
+}
+
+/* [EOF] blockmatching_hier_mad_d_rt.c */
@@ -0,0 +1,267 @@
+/*
+ *  BLOCKMATCH_SAD_INT_RT Sum of absolute differences of integer blocks,
+ *  shared by the uint8 and uint16 MAD search methods.
+ *
+ *  Blocks are column major. The rows of each column are contiguous, so
+ *  each column is processed with one SIMD instruction per 16 (uint8) or 8
+ *  (uint16) rows: psadbw with SSE2, vabd/vpadal with NEON. The sums are
+ *  exact, so the selected motion vectors do not depend on the instruction
+ *  set. On x86 the AVX2 kernels, which take two uint8 columns or 16 uint16
+ *  rows per instruction, are used when MWVIP_CpuFeatures reports AVX2;
+ *  they are compiled for AVX2 whatever the flags of the build.
+ *
+ *  Copyright 2016 The MathWorks, Inc.
+ */
+
+#ifndef blockmatch_sad_int_rt_h
+#define blockmatch_sad_int_rt_h
+
+#include "vipblockmatch_rt.h"
+
+#if defined(__ARM_NEON__) || defined(__ARM_NEON)
+#include <arm_neon.h>
+#define MWVIP_BLOCKMATCH_NEON 1
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define MWVIP_BLOCKMATCH_SSE2 1
+#endif
+
+#if defined(MWVIP_BLOCKMATCH_SSE2) && (defined(_MSC_VER) || defined(__GNUC__) || defined(__clang__))
+#include <immintrin.h>
+#include "vipcpu_rt.h"
+#define MWVIP_BLOCKMATCH_AVX2 1
+#if defined(__GNUC__) || defined(__clang__)
+#define MWVIP_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define MWVIP_TARGET_AVX2
+#endif
+#endif
+
+/* sum over the block of |blkCS - blkPB|; 255*65536 and 65535*65536 fit
+ * in uint32_T, which bounds the block area to 65536 elements */
+MWVIP_INLINE uint32_T MWVIP_SAD_U8_Base(const uint8_T *blkCS, const uint8_T *blkPB,
+                                      int_T rowsImgCS, int_T rowsImgPB,
+                                      int_T blkWidthX, int_T blkHeightY)
+{
+    uint32_T sum = 0;
+    int_T c1, r1;
+#if defined(MWVIP_BLOCKMATCH_SSE2)
+    __m128i acc = _mm_setzero_si128();
+#elif defined(MWVIP_BLOCKMATCH_NEON)
+    uint32x4_t acc = vdupq_n_u32(0);
+#endif
+
+    for (c1 = 0; c1 < blkWidthX; c1++)
+    {
+        const uint8_T *cs = &blkCS[c1*rowsImgCS];
+        const uint8_T *pb = &blkPB[c1*rowsImgPB];
+        r1 = 0;
+#if defined(MWVIP_BLOCKMATCH_SSE2)
+        for (; r1 + 16 <= blkHeightY; r1 += 16)
+        {
+            __m128i a = _mm_loadu_si128((const __m128i *)&cs[r1]);
+            __m128i b = _mm_loadu_si128((const __m128i *)&pb[r1]);
+            acc = _mm_add_epi64(acc, _mm_sad_epu8(a, b));
+        }
+#elif defined(MWVIP_BLOCKMATCH_NEON)
+        for (; r1 + 16 <= blkHeightY; r1 += 16)
+        {
+            uint8x16_t d = vabdq_u8(vld1q_u8(&cs[r1]), vld1q_u8(&pb[r1]));
+            acc = vpadalq_u16(acc, vpaddlq_u8(d));
+        }
+#endif
+        for (; r1 < blkHeightY; r1++)
+        {
+            sum += (cs[r1] > pb[r1]) ? (uint32_T)(cs[r1] - pb[r1])
+                                     : (uint32_T)(pb[r1] - cs[r1]);
+        }
+    }
+
+#if defined(MWVIP_BLOCKMATCH_SSE2)
+    /* two 64-bit partial sums, each below 2^32 */
+    sum += (uint32_T)_mm_cvtsi128_si32(acc)
+         + (uint32_T)_mm_cvtsi128_si32(_mm_srli_si128(acc, 8));
+#elif defined(MWVIP_BLOCKMATCH_NEON)
+    {
+        uint64x2_t acc2 = vpaddlq_u32(acc);
+        sum += (uint32_T)(vgetq_lane_u64(acc2, 0) + vgetq_lane_u64(acc2, 1));
+    }
+#endif
+    return sum;
+}
+
+MWVIP_INLINE uint32_T MWVIP_SAD_U16_Base(const uint16_T *blkCS, const uint16_T *blkPB,
+                                       int_T rowsImgCS, int_T rowsImgPB,
+                                       int_T blkWidthX, int_T blkHeightY)
+{
+    uint32_T sum = 0;
+    int_T c1, r1;
+#if defined(MWVIP_BLOCKMATCH_SSE2)
+    const __m128i zero = _mm_setzero_si128();
+    __m128i acc = _mm_setzero_si128();
+#elif defined(MWVIP_BLOCKMATCH_NEON)
+    uint32x4_t acc = vdupq_n_u32(0);
+#endif
+
+    for (c1 = 0; c1 < blkWidthX; c1++)
+    {
+        const uint16_T *cs = &blkCS[c1*rowsImgCS];
+        const uint16_T *pb = &blkPB[c1*rowsImgPB];
+        r1 = 0;
+#if defined(MWVIP_BLOCKMATCH_SSE2)
+        for (; r1 + 8 <= blkHeightY; r1 += 8)
+        {
+            __m128i a = _mm_loadu_si128((const __m128i *)&cs[r1]);
+            __m128i b = _mm_loadu_si128((const __m128i *)&pb[r1]);
+            /* |a-b| with unsigned saturation, widened to 32 bits */
+            __m128i d = _mm_or_si128(_mm_subs_epu16(a, b), _mm_subs_epu16(b, a));
+            acc = _mm_add_epi32(acc, _mm_add_epi32(_mm_unpacklo_epi16(d, zero),
+                                                   _mm_unpackhi_epi16(d, zero)));
+        }
+#elif defined(MWVIP_BLOCKMATCH_NEON)
+        for (; r1 + 8 <= blkHeightY; r1 += 8)
+        {
+            acc = vpadalq_u16(acc, vabdq_u16(vld1q_u16(&cs[r1]), vld1q_u16(&pb[r1])));
+        }
+#endif
+        for (; r1 < blkHeightY; r1++)
+        {
+            sum += (cs[r1] > pb[r1]) ? (uint32_T)(cs[r1] - pb[r1])
+                                     : (uint32_T)(pb[r1] - cs[r1]);
+        }
+    }
+
+#if defined(MWVIP_BLOCKMATCH_SSE2)
+    acc = _mm_add_epi32(acc, _mm_srli_si128(acc, 8));
+    acc = _mm_add_epi32(acc, _mm_srli_si128(acc, 4));
+    sum += (uint32_T)_mm_cvtsi128_si32(acc);
+#elif defined(MWVIP_BLOCKMATCH_NEON)
+    {
+        uint64x2_t acc2 = vpaddlq_u32(acc);
+        sum += (uint32_T)(vgetq_lane_u64(acc2, 0) + vgetq_lane_u64(acc2, 1));
+    }
+#endif
+    return sum;
+}
+
+#if defined(MWVIP_BLOCKMATCH_AVX2)
+/* two columns per instruction, 16 rows of each */
+MWVIP_TARGET_AVX2
+static uint32_T MWVIP_SAD_U8_AVX2(const uint8_T *blkCS, const uint8_T *blkPB,
+                                  int_T rowsImgCS, int_T rowsImgPB,
+                                  int_T blkWidthX, int_T blkHeightY)
+{
+    uint32_T sum = 0;
+    int_T c1, r1;
+    __m256i acc = _mm256_setzero_si256();
+
+    for (c1 = 0; c1 + 2 <= blkWidthX; c1 += 2)
+    {
+        const uint8_T *cs = &blkCS[c1*rowsImgCS];
+        const uint8_T *pb = &blkPB[c1*rowsImgPB];
+        for (r1 = 0; r1 + 16 <= blkHeightY; r1 += 16)
+        {
+            __m256i a = _mm256_inserti128_si256(_mm256_castsi128_si256(
+                            _mm_loadu_si128((const __m128i *)&cs[r1])),
+                            _mm_loadu_si128((const __m128i *)&cs[r1 + rowsImgCS]), 1);
+            __m256i b = _mm256_inserti128_si256(_mm256_castsi128_si256(
+                            _mm_loadu_si128((const __m128i *)&pb[r1])),
+                            _mm_loadu_si128((const __m128i *)&pb[r1 + rowsImgPB]), 1);
+            acc = _mm256_add_epi64(acc, _mm256_sad_epu8(a, b));
+        }
+        if (r1 < blkHeightY)
+        {
+            sum += MWVIP_SAD_U8_Base(&cs[r1], &pb[r1], rowsImgCS, rowsImgPB,
+                                     2, blkHeightY - r1);
+        }
+    }
+    if (c1 < blkWidthX)
+    {
+        sum += MWVIP_SAD_U8_Base(&blkCS[c1*rowsImgCS], &blkPB[c1*rowsImgPB],
+                                 rowsImgCS, rowsImgPB, 1, blkHeightY);
+    }
+
+    /* four 64-bit partial sums, each below 2^32 */
+    sum += (uint32_T)_mm256_extract_epi32(acc, 0) + (uint32_T)_mm256_extract_epi32(acc, 2)
+         + (uint32_T)_mm256_extract_epi32(acc, 4) + (uint32_T)_mm256_extract_epi32(acc, 6);
+    return sum;
+}
+
+MWVIP_TARGET_AVX2
+static uint32_T MWVIP_SAD_U16_AVX2(const uint16_T *blkCS, const uint16_T *blkPB,
+                                   int_T rowsImgCS, int_T rowsImgPB,
+                                   int_T blkWidthX, int_T blkHeightY)
+{
+    uint32_T sum = 0;
+    int_T c1, r1;
+    const __m256i zero = _mm256_setzero_si256();
+    __m256i acc = _mm256_setzero_si256();
+    __m128i acc128;
+
+    for (c1 = 0; c1 < blkWidthX; c1++)
+    {
+        const uint16_T *cs = &blkCS[c1*rowsImgCS];
+        const uint16_T *pb = &blkPB[c1*rowsImgPB];
+        for (r1 = 0; r1 + 16 <= blkHeightY; r1 += 16)
+        {
+            __m256i a = _mm256_loadu_si256((const __m256i *)&cs[r1]);
+            __m256i b = _mm256_loadu_si256((const __m256i *)&pb[r1]);
+            __m256i d = _mm256_or_si256(_mm256_subs_epu16(a, b), _mm256_subs_epu16(b, a));
+            acc = _mm256_add_epi32(acc, _mm256_add_epi32(_mm256_unpacklo_epi16(d, zero),
+                                                         _mm256_unpackhi_epi16(d, zero)));
+        }
+        if (r1 < blkHeightY)
+        {
+            sum += MWVIP_SAD_U16_Base(&cs[r1], &pb[r1], rowsImgCS, rowsImgPB,
+                                      1, blkHeightY - r1);
+        }
+    }
+
+    acc128 = _mm_add_epi32(_mm256_castsi256_si128(acc), _mm256_extracti128_si256(acc, 1));
+    acc128 = _mm_add_epi32(acc128, _mm_srli_si128(acc128, 8));
+    acc128 = _mm_add_epi32(acc128, _mm_srli_si128(acc128, 4));
+    return sum + (uint32_T)_mm_cvtsi128_si32(acc128);
+}
+
+/* resolved on the first call in each translation unit */
+static int_T mwvipSadUseAVX2 = -1;
+
+MWVIP_INLINE int_T MWVIP_SAD_UseAVX2(void)
+{
+    if (mwvipSadUseAVX2 < 0)
+    {
+        mwvipSadUseAVX2 = (MWVIP_CpuFeatures() & MWVIP_CPU_AVX2) != 0;
+    }
+    return mwvipSadUseAVX2;
+}
+#endif
+
+MWVIP_INLINE uint32_T MWVIP_SAD_U8(const uint8_T *blkCS, const uint8_T *blkPB,
+                                 int_T rowsImgCS, int_T rowsImgPB,
+                                 int_T blkWidthX, int_T blkHeightY)
+{
+#if defined(MWVIP_BLOCKMATCH_AVX2)
+    if (MWVIP_SAD_UseAVX2())
+    {
+        return MWVIP_SAD_U8_AVX2(blkCS, blkPB, rowsImgCS, rowsImgPB, blkWidthX, blkHeightY);
+    }
+#endif
+    return MWVIP_SAD_U8_Base(blkCS, blkPB, rowsImgCS, rowsImgPB, blkWidthX, blkHeightY);
+}
+
+MWVIP_INLINE uint32_T MWVIP_SAD_U16(const uint16_T *blkCS, const uint16_T *blkPB,
+                                  int_T rowsImgCS, int_T rowsImgPB,
+                                  int_T blkWidthX, int_T blkHeightY)
+{
+#if defined(MWVIP_BLOCKMATCH_AVX2)
+    if (MWVIP_SAD_UseAVX2())
+    {
+        return MWVIP_SAD_U16_AVX2(blkCS, blkPB, rowsImgCS, rowsImgPB, blkWidthX, blkHeightY);
+    }
+#endif
+    return MWVIP_SAD_U16_Base(blkCS, blkPB, rowsImgCS, rowsImgPB, blkWidthX, blkHeightY);
+}
+
+#endif /* blockmatch_sad_int_rt_h */
+
+/* [EOF] blockmatch_sad_int_rt.h */
@@ -0,0 +1,142 @@
+/*
+ *  BLOCKMATCHING_STREAM_U16_RT Helper function for Block Matching block.
+ *
+ *  Streaming mode: the current frame of one call is the previous frame of
+ *  the next one, so both frames are kept zero padded in the geometry of
+ *  paddedImgP (rowsPadImgP x colsPadImgP) and the two buffers swap roles.
+ *  Each call copies the new frame once, into the interior of the buffer
+ *  that held the frame before the previous one; the borders are cleared
+ *  only on the first call. Blocks of the current frame are read from the
+ *  same buffer, maxDY rows and maxDX columns into their search region, so
+ *  the motion vectors are those of MWVIP_BlockMatching_<Method>_U16 with
+ *  the same previous frame.
+ *
+ *  *prevSlot is the state: -1 before the first call (the previous frame is
+ *  then all zeros), otherwise 0 or 1 for the buffer holding the previous
+ *  frame. searchFcn is any MWVIP_SearchMethod_* for this data type. Either
+ *  yMVsqmag or yMVcplx receives the motion vectors; the other may be NULL.
+ *
+ *  Copyright 2016 The MathWorks, Inc.
+ */
+#include "vipblockmatch_rt.h"  
+
+LIBMWVISIONRT_API void MWVIP_BlockMatching_Stream_U16(
+                                const uint16_T *uImgCurr,
+                                uint16_T *paddedImg0,
+                                uint16_T *paddedImg1,
+                                int32_T *prevSlot,
+                                MWVIP_SEARCH_METHOD_FUNC_U16 searchFcn,
+                                real32_T *yMVsqmag,
+                                creal32_T *yMVcplx,
+                                int32_T *blockSize,
+                                int32_T *overlapSize,
+                                int32_T *maxDisplSize,
+                                const int_T inRows,
+                                const int_T inCols,
+                                const int_T rowsPadImgP,
+                                const int_T colsPadImgP)
+{ 
+    int_T i;
+    int_T  blkCol, numBlkCols, numBlkRows;
+    uint16_T *tmpP, *paddedImgC, *paddedImgP;
+    const uint16_T *tmpU;
+    int32_T currSlot;
+
+    const int_T blkHeightY = blockSize[0]; /* [rows=Height(y)     cols=width(x)] */
+    const int_T blkWidthX  = blockSize[1]; 
+
+    const int_T yOverlap   = overlapSize[0];   
+    const int_T xOverlap   = overlapSize[1];
+
+    const int_T maxDY      = maxDisplSize[0];
+    const int_T maxDX      = maxDisplSize[1];
+      
+    const int_T xPadLside = xOverlap/2; /* padding at left */
+    const int_T yPadTside = yOverlap/2; /* padding at top  */
+
+    const int_T xIncr = blkWidthX  - xOverlap;
+    const int_T yIncr = blkHeightY - yOverlap;
+
+    const int_T searchRegionWidthX  = blkWidthX  + 2*maxDX;
+    const int_T searchRegionHeightY = blkHeightY + 2*maxDY;   
+
+    const int_T bytesPerInputCol = inRows*sizeof(uint16_T);
+
+    const int_T startXpadImgP = maxDX+xPadLside;
+    const int_T startYpadImgP = maxDY+yPadTside;
+
+    if (prevSlot[0] < 0)
+    {
+        /* first frame: the borders of both buffers stay zero from now on */
+        memset(paddedImg0,0, (rowsPadImgP*colsPadImgP*sizeof(uint16_T)));
+        memset(paddedImg1,0, (rowsPadImgP*colsPadImgP*sizeof(uint16_T)));
+        currSlot = 0;
+        paddedImgP = paddedImg1;
+    }
+    else
+    {
+        currSlot = 1 - prevSlot[0];
+        paddedImgP = (prevSlot[0] == 0) ? paddedImg0 : paddedImg1;
+    }
+    paddedImgC = (currSlot == 0) ? paddedImg0 : paddedImg1;
+
+    /* copy input (uImgCurr) to the interior of its buffer */
+    tmpP = &paddedImgC[startXpadImgP*rowsPadImgP + startYpadImgP];
+    tmpU = uImgCurr;
+    for (i=0; i<inCols; i++) 
+    {
+       memcpy(tmpP, tmpU, bytesPerInputCol);
+       tmpP += rowsPadImgP;
+       tmpU += inRows;
+    }
+
+    numBlkCols = MWVIP_BLOCKMATCH_NUM_BLOCKS(colsPadImgP, startXpadImgP, xIncr);
+    numBlkRows = MWVIP_BLOCKMATCH_NUM_BLOCKS(rowsPadImgP, startYpadImgP, yIncr);
+
+    /* the blocks are independent and block column blkCol writes outputs
+     * blkCol*numBlkRows onwards, so the columns may be searched in parallel */
+#ifdef MWVIP_BLOCKMATCH_PARALLEL
+#pragma omp parallel for schedule(dynamic) if (numBlkCols*numBlkRows >= MWVIP_BLOCKMATCH_MIN_PARALLEL_BLOCKS)
+#endif
+    for (blkCol = 0; blkCol < numBlkCols; blkCol++) 
+    {
+        int_T colIdx = blkCol*xIncr;
+        int_T offsetIdxImgP = colIdx*rowsPadImgP;
+        int_T outIdx = blkCol*numBlkRows;
+        int_T blkRow;
+
+        for (blkRow = 0; blkRow < numBlkRows; blkRow++)
+        {
+            int_T rowIdx = blkRow*yIncr;
+            int_T  dx, dy, xIdx=0, yIdx=0;
+            
+            /* blkP is pointer to search_region and blkC to this_block,
+             * displaced by (maxDY, maxDX) inside it */
+            uint16_T *blkP = &paddedImgP[offsetIdxImgP + rowIdx];
+            uint16_T *blkC = &paddedImgC[offsetIdxImgP + maxDX*rowsPadImgP + rowIdx + maxDY];
+
+            searchFcn(blkC,blkP,
+                      rowsPadImgP,rowsPadImgP,
+                      blkWidthX,blkHeightY,
+                      searchRegionWidthX, searchRegionHeightY,
+                      &xIdx, &yIdx);
+
+            dx = xIdx-maxDX;
+            dy = yIdx-maxDY;
+            if (yMVsqmag)
+            {
+                yMVsqmag[outIdx] = (real32_T)(dx*dx + dy*dy); 
+            }
+            if (yMVcplx)
+            {
+                yMVcplx[outIdx].re = (real32_T)dx;
+                yMVcplx[outIdx].im = (real32_T)dy;
+            }
+            outIdx++;
+        }
+    }
+
+    prevSlot[0] = currSlot;
+}
+
+/* [EOF] blockmatching_stream_u16_rt.c */
@@ -0,0 +1,61 @@
+/*
+ *  SEARCHMETHOD_3STEP_MAD_U16_RT Helper function for Block Matching block.
+ *
+ *  Copyright 2016 The MathWorks, Inc.
+ */
+#include "blockmatch_sad_int_rt.h"  
+
+LIBMWVISIONRT_API void MWVIP_SearchMethod_3Step_MAD_U16(const uint16_T *blkCS, const uint16_T *blkPB, /* CS = current image (smaller block), PB = previous image (bigger block) */
+                                             int_T rowsImgCS,   int_T rowsImgPB,  
+                                             int_T blkCSWidthX, int_T blkCSHeightY,  
+                                             int_T blkPBWidthX, int_T blkPBHeightY,  
+                                             int_T *xIdx,         int_T *yIdx)
+{
+    const int_T endRowIdx = blkPBHeightY-blkCSHeightY+1;
+    const int_T endColIdx = blkPBWidthX -blkCSWidthX +1;
+    uint32_T sum3= 0;  /* holds the minimum value */
+    int_T p;
+    int_T flag = 0;
+    int_T midIdxR = endRowIdx/2;
+    int_T midIdxC = endColIdx/2;
+    int_T range = MIN(midIdxR,midIdxC);
+
+    int_T delta = (int_T)(range/2) + 1;
+    while (delta > 0) {
+      int_T iy = MAX((midIdxC - delta),0);
+      int_T ix = MAX((midIdxR - delta),0);
+      int_T colPts = 3;
+      p = iy;
+      while (colPts--) {
+        int_T rowPts = 3;
+        int_T q = ix;
+        while (rowPts--) {
+          uint32_T sum2 = MWVIP_SAD_U16(blkCS, &blkPB[q + rowsImgPB*p],
+                                        rowsImgCS, rowsImgPB,
+                                        blkCSWidthX, blkCSHeightY);
+          /* Store the new minimum and get the corresponding indices. */
+          if (flag == 0) {
+            sum3 = sum2;
+            yIdx[0] = q;
+            xIdx[0] = p;
+            flag = 1;
+          } else {
+            if (sum2 < sum3) {
+              sum3 = sum2;
+              yIdx[0] = q;
+              xIdx[0] = p;
+            }
+          }
+          q += delta;
+          while ((rowPts > 0) && (q >= endRowIdx)) q--;
+        }
+        p += delta;
+        while ((colPts > 0) && (p >= endColIdx)) p--;
+      }
+      midIdxC = xIdx[0];
+      midIdxR = yIdx[0];
+      delta--;
+    }
+}
+
+/* [EOF] searchmethod_3step_mad_u16_rt.c */
@@ -35,6 +35,8 @@ LIBMWVISIONRT_API void MWVIP_SearchMethod_Full_MAD_D(const real_T *blkCS, const
                real_T dist = blkCS[rowOffsetCS+r1] - otherBlock[rowOffsetPB+r1]; 
                mysum += fabs(dist);
             }
+            /* the sum can only grow: stop once this candidate cannot win */
+            if (mysum >= minVal) break;
          }
         
         if (mysum<minVal)
@@ -0,0 +1,41 @@
+/*
+ *  SEARCHMETHOD_FULL_MAD_U16_RT Helper function for Block Matching block.
+ *
+ *  Copyright 2016 The MathWorks, Inc.
+ */
+#include "blockmatch_sad_int_rt.h"  
+
+LIBMWVISIONRT_API void MWVIP_SearchMethod_Full_MAD_U16(const uint16_T *blkCS, const uint16_T *blkPB, /* CS = current image (smaller block), PB = previous image (bigger block) */
+                                             int_T rowsImgCS,   int_T rowsImgPB,  
+                                             int_T blkCSWidthX, int_T blkCSHeightY,  
+                                             int_T blkPBWidthX, int_T blkPBHeightY,  
+                                             int_T *xIdx,         int_T *yIdx)
+{
+    uint32_T minVal= MAX_uint32_T;   
+    int_T xEnd = blkPBWidthX  - blkCSWidthX  +1; /* 2*maxDX+1 */
+    int_T yEnd = blkPBHeightY - blkCSHeightY +1; /* 2*maxDY+1 */
+    int_T x,y;
+
+    xIdx[0]=0;
+    yIdx[0]=0;
+
+    for (x=0; x<xEnd;x++)
+    {
+      int_T rowOffsetAll =   x*rowsImgPB; 
+      for (y=0; y<yEnd; y++) 
+      {
+         const uint16_T *otherBlock = &blkPB[rowOffsetAll+y]; /* searchRegion */
+         uint32_T mysum = MWVIP_SAD_U16(blkCS, otherBlock, rowsImgCS, rowsImgPB,
+                                       blkCSWidthX, blkCSHeightY);
+        
+        if (mysum<minVal)
+        {
+              minVal=mysum;
+              xIdx[0]=x;
+              yIdx[0]=y;
+        }
+      }
+    }
+}
+
+/* [EOF] searchmethod_full_mad_u16_rt.c */
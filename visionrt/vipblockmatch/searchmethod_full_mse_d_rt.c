@@ -36,6 +36,8 @@ LIBMWVISIONRT_API void MWVIP_SearchMethod_Full_MSE_D(const real_T *blkCS, const
                mysum += dist*dist;
                dist=dist*1;
             }
+            /* the sum can only grow: stop once this candidate cannot win */
+            if (mysum >= minVal) break;
          }
         
         if (mysum<minVal)
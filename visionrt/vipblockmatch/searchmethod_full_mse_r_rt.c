@@ -35,6 +35,8 @@ LIBMWVISIONRT_API void MWVIP_SearchMethod_Full_MSE_R(const real32_T *blkCS, cons
                real32_T dist = blkCS[rowOffsetCS+r1] - otherBlock[rowOffsetPB+r1]; 
                mysum += dist*dist;
             }
+            /* the sum can only grow: stop once this candidate cannot win */
+            if (mysum >= minVal) break;
          }
         
         if (mysum<minVal)
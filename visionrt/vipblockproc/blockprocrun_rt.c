@@ -0,0 +1,44 @@
+/*
+ *  BLOCKPROCRUN_RT runtime function for VIPBLKS Block Processing block
+ *
+ *  Runs the iterations of the block in the order of the tile table, or,
+ *  for a sub-block process without states, on several threads. Dynamic
+ *  scheduling one block at a time hands the next block to the first free
+ *  thread, which balances blocks of uneven cost and the partial blocks at
+ *  the edges.
+ *
+ *  Copyright 2016 The MathWorks, Inc.
+ */
+#include "vipblockproc_rt.h"
+#if defined(MWVIP_BLOCKPROC_PARALLEL)
+#include <omp.h>
+#endif
+
+int_T MWVIP_BlockProc_MaxThreads(void)
+{
+#if defined(MWVIP_BLOCKPROC_PARALLEL)
+    return (int_T)omp_get_max_threads();
+#else
+    return 1;
+#endif
+}
+
+void MWVIP_BlockProc_Run(const MWVIP_BLOCKPROC_TILE *tiles, int32_T numTiles,
+                         MWVIP_BlockProc_Fcn fcn, void *ctx, boolean_T parallel)
+{
+    int32_T k;
+#if defined(MWVIP_BLOCKPROC_PARALLEL)
+    if (parallel && numTiles > 1) {
+        #pragma omp parallel for schedule(dynamic, 1)
+        for (k = 0; k < numTiles; k++) {
+            fcn(ctx, &tiles[k], (int_T)omp_get_thread_num());
+        }
+        return;
+    }
+#else
+    (void)parallel;
+#endif
+    for (k = 0; k < numTiles; k++) fcn(ctx, &tiles[k], 0);
+}
+
+/* [EOF] blockprocrun_rt.c */
@@ -0,0 +1,90 @@
+/*
+ *  BLOCKPROCTILES_RT runtime function for VIPBLKS Block Processing block
+ *
+ *  Lists the blocks of an input once, with the part of each inside the
+ *  input, and copies blocks in and out of the grid.
+ *
+ *  Copyright 2016 The MathWorks, Inc.
+ */
+#include <string.h>
+#include "vipblockproc_rt.h"
+
+/* number of blocks along one dimension */
+static int32_T NumBlocks(int_T size, int_T blk, int_T ovl)
+{
+    const int_T step = (blk - ovl > 0) ? blk - ovl : 1;
+    if (size <= blk) return 1;
+    return (int32_T)(1 + (size - blk + step - 1)/step);
+}
+
+void MWVIP_BlockProc_GridSize(int_T rows, int_T cols,
+                              int_T blkRows, int_T blkCols,
+                              int_T ovlRows, int_T ovlCols,
+                              int32_T *gridRows, int32_T *gridCols)
+{
+    *gridRows = NumBlocks(rows, blkRows, ovlRows);
+    *gridCols = NumBlocks(cols, blkCols, ovlCols);
+}
+
+void MWVIP_BlockProc_Tiles(int_T rows, int_T cols,
+                           int_T blkRows, int_T blkCols,
+                           int_T ovlRows, int_T ovlCols,
+                           boolean_T rowWise,
+                           MWVIP_BLOCKPROC_TILE *tiles)
+{
+    const int_T stepRows = (blkRows - ovlRows > 0) ? blkRows - ovlRows : 1;
+    const int_T stepCols = (blkCols - ovlCols > 0) ? blkCols - ovlCols : 1;
+    int32_T gridRows, gridCols, i, j;
+
+    MWVIP_BlockProc_GridSize(rows, cols, blkRows, blkCols, ovlRows, ovlCols,
+                             &gridRows, &gridCols);
+    for (j = 0; j < gridCols; j++) {
+        for (i = 0; i < gridRows; i++) {
+            const int32_T iter = rowWise ? i*gridCols + j : j*gridRows + i;
+            MWVIP_BLOCKPROC_TILE *t = &tiles[iter];
+            const int_T r = i*stepRows, c = j*stepCols;
+            t->iter    = iter;
+            t->gridRow = i;
+            t->gridCol = j;
+            t->row     = (int32_T)r;
+            t->col     = (int32_T)c;
+            t->rows    = (int32_T)((r + blkRows <= rows) ? blkRows : rows - r);
+            t->cols    = (int32_T)((c + blkCols <= cols) ? blkCols : cols - c);
+        }
+    }
+}
+
+void MWVIP_BlockProc_Extract(const void *in, int_T rows, int_T elemSize,
+                             const MWVIP_BLOCKPROC_TILE *tile,
+                             int_T blkRows, int_T blkCols, void *blk)
+{
+    const uint8_T *src = (const uint8_T *)in + ((size_t)tile->col*rows + tile->row)*elemSize;
+    uint8_T *dst = (uint8_T *)blk;
+    const size_t inside = (size_t)tile->rows*elemSize, full = (size_t)blkRows*elemSize;
+    int_T j;
+    for (j = 0; j < tile->cols; j++) {
+        memcpy(dst, src, inside);
+        if (inside < full) memset(dst + inside, 0, full - inside);
+        src += (size_t)rows*elemSize;
+        dst += full;
+    }
+    if (tile->cols < blkCols) memset(dst, 0, (blkCols - tile->cols)*full);
+}
+
+void MWVIP_BlockProc_Insert(void *out, int_T outRows, int_T elemSize,
+                            const MWVIP_BLOCKPROC_TILE *tile,
+                            int_T outBlkRows, int_T outBlkCols, const void *blk)
+{
+    uint8_T *dst = (uint8_T *)out + ((size_t)tile->gridCol*outBlkCols*outRows +
+                                     (size_t)tile->gridRow*outBlkRows)*elemSize;
+    const uint8_T *src = (const uint8_T *)blk;
+    const size_t len = (size_t)outBlkRows*elemSize;
+    int_T j;
+    for (j = 0; j < outBlkCols; j++) {
+        memcpy(dst, src, len);
+        src += len;
+        dst += (size_t)outRows*elemSize;
+    }
+}
+
+/* [EOF] blockproctiles_rt.c */
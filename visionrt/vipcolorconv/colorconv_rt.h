@@ -0,0 +1,332 @@
+/*
+ *  COLORCONV_RT Coefficients and SIMD helpers of the color space
+ *  conversion kernels.
+ *
+ *  The Y'CbCr coefficients follow from the luma weights Kr and Kb of the
+ *  standard. The uint8 kernels keep them in Q15 (R'G'B' -> Y'CbCr) or Q13
+ *  (Y'CbCr -> R'G'B'), small enough for the 16 bit multiply-adds of SSE2
+ *  (pmaddwd) and NEON (vmlal), and the scalar code uses the same integer
+ *  arithmetic, so the SIMD and the scalar pixels are identical.
+ *
+ *  The constant terms are paired with a lane holding 256 or 1, so that a
+ *  single pmaddwd adds them: an offset of 16 or 128 plus one half, in Q15,
+ *  is 2112 or 16448 times 256.
+ *
+ *  Copyright 2016 The MathWorks, Inc.
+ */
+
+#ifndef colorconv_rt_h
+#define colorconv_rt_h
+
+#include "vipcolorconv_rt.h"
+
+#if defined(__ARM_NEON__) || defined(__ARM_NEON)
+#include <arm_neon.h>
+#define MWVIP_CSC_NEON 1
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define MWVIP_CSC_SSE2 1
+#endif
+
+#define MWVIP_CSC_Q(x, q) ((int16_T)((x)*(double)(1 << (q)) + ((x) < 0 ? -0.5 : 0.5)))
+
+/* coefficients of R'G'B' in [0, 255] and Y'CbCr in [16, 235], [16, 240] */
+#define MWVIP_CSC_Y_R(kr, kb)  (219.0*(kr)/255.0)
+#define MWVIP_CSC_Y_G(kr, kb)  (219.0*(1.0 - (kr) - (kb))/255.0)
+#define MWVIP_CSC_Y_B(kr, kb)  (219.0*(kb)/255.0)
+#define MWVIP_CSC_CB_R(kr, kb) (-112.0*(kr)/(1.0 - (kb))/255.0)
+#define MWVIP_CSC_CB_G(kr, kb) (-112.0*(1.0 - (kr) - (kb))/(1.0 - (kb))/255.0)
+#define MWVIP_CSC_CB_B(kr, kb) (112.0/255.0)
+#define MWVIP_CSC_CR_R(kr, kb) (112.0/255.0)
+#define MWVIP_CSC_CR_G(kr, kb) (-112.0*(1.0 - (kr) - (kb))/(1.0 - (kr))/255.0)
+#define MWVIP_CSC_CR_B(kr, kb) (-112.0*(kb)/(1.0 - (kr))/255.0)
+#define MWVIP_CSC_Y_SCALE(kr, kb) (255.0/219.0)
+#define MWVIP_CSC_CR_TO_R(kr, kb) (2.0*(1.0 - (kr))*255.0/224.0)
+#define MWVIP_CSC_CB_TO_G(kr, kb) (-2.0*(1.0 - (kb))*(kb)/(1.0 - (kr) - (kb))*255.0/224.0)
+#define MWVIP_CSC_CR_TO_G(kr, kb) (-2.0*(1.0 - (kr))*(kr)/(1.0 - (kr) - (kb))*255.0/224.0)
+#define MWVIP_CSC_CB_TO_B(kr, kb) (2.0*(1.0 - (kb))*255.0/224.0)
+
+typedef struct {
+    /* R'G'B' -> Y', Cb, Cr in Q15: R, G, B weights and offset/256 */
+    int16_T y[4];
+    int16_T cb[4];
+    int16_T cr[4];
+    /* Y'CbCr -> R'G'B' in Q13 */
+    int16_T yScale;
+    int16_T crToR;
+    int16_T cbToG;
+    int16_T crToG;
+    int16_T cbToB;
+    /* the same in single precision */
+    real32_T fy[3];
+    real32_T fcb[3];
+    real32_T fcr[3];
+    real32_T fyScale;
+    real32_T fcrToR;
+    real32_T fcbToG;
+    real32_T fcrToG;
+    real32_T fcbToB;
+} MWVIP_CSC_COEFFS;
+
+#define MWVIP_CSC_COEFFS_INIT(kr, kb) { \
+    {MWVIP_CSC_Q(MWVIP_CSC_Y_R(kr, kb), 15), MWVIP_CSC_Q(MWVIP_CSC_Y_G(kr, kb), 15), \
+     MWVIP_CSC_Q(MWVIP_CSC_Y_B(kr, kb), 15), 2112}, \
+    {MWVIP_CSC_Q(MWVIP_CSC_CB_R(kr, kb), 15), MWVIP_CSC_Q(MWVIP_CSC_CB_G(kr, kb), 15), \
+     MWVIP_CSC_Q(MWVIP_CSC_CB_B(kr, kb), 15), 16448}, \
+    {MWVIP_CSC_Q(MWVIP_CSC_CR_R(kr, kb), 15), MWVIP_CSC_Q(MWVIP_CSC_CR_G(kr, kb), 15), \
+     MWVIP_CSC_Q(MWVIP_CSC_CR_B(kr, kb), 15), 16448}, \
+    MWVIP_CSC_Q(MWVIP_CSC_Y_SCALE(kr, kb), 13), MWVIP_CSC_Q(MWVIP_CSC_CR_TO_R(kr, kb), 13), \
+    MWVIP_CSC_Q(MWVIP_CSC_CB_TO_G(kr, kb), 13), MWVIP_CSC_Q(MWVIP_CSC_CR_TO_G(kr, kb), 13), \
+    MWVIP_CSC_Q(MWVIP_CSC_CB_TO_B(kr, kb), 13), \
+    {(real32_T)MWVIP_CSC_Y_R(kr, kb), (real32_T)MWVIP_CSC_Y_G(kr, kb), \
+     (real32_T)MWVIP_CSC_Y_B(kr, kb)}, \
+    {(real32_T)MWVIP_CSC_CB_R(kr, kb), (real32_T)MWVIP_CSC_CB_G(kr, kb), \
+     (real32_T)MWVIP_CSC_CB_B(kr, kb)}, \
+    {(real32_T)MWVIP_CSC_CR_R(kr, kb), (real32_T)MWVIP_CSC_CR_G(kr, kb), \
+     (real32_T)MWVIP_CSC_CR_B(kr, kb)}, \
+    (real32_T)MWVIP_CSC_Y_SCALE(kr, kb), (real32_T)MWVIP_CSC_CR_TO_R(kr, kb), \
+    (real32_T)MWVIP_CSC_CB_TO_G(kr, kb), (real32_T)MWVIP_CSC_CR_TO_G(kr, kb), \
+    (real32_T)MWVIP_CSC_CB_TO_B(kr, kb)}
+
+MWVIP_INLINE const MWVIP_CSC_COEFFS *MWVIP_CSC_GetCoeffs(int_T standard)
+{
+    static const MWVIP_CSC_COEFFS coeffs[2] = {
+        MWVIP_CSC_COEFFS_INIT(0.299, 0.114),
+        MWVIP_CSC_COEFFS_INIT(0.2126, 0.0722)
+    };
+    return &coeffs[standard == MWVIP_CSC_REC709 ? 1 : 0];
+}
+
+/* Q15 sum of one of Y', Cb, Cr with its offset and half; c is y, cb or cr */
+MWVIP_INLINE int32_T MWVIP_CSC_Dot(const int16_T *c, int32_T r, int32_T g, int32_T b)
+{
+    return c[0]*r + c[1]*g + c[2]*b + c[3]*256;
+}
+
+MWVIP_INLINE uint8_T MWVIP_CSC_Sat8(int32_T x)
+{
+    return (uint8_T)(x < 0 ? 0 : (x > 255 ? 255 : x));
+}
+
+/* Y'CbCr -> R'G'B' of one pixel */
+MWVIP_INLINE void MWVIP_CSC_ToRGB(const MWVIP_CSC_COEFFS *k, int32_T y, int32_T cb,
+                                  int32_T cr, uint8_T *r, uint8_T *g, uint8_T *b)
+{
+    int32_T yy = k->yScale*(y - 16) + 4096;
+    cb -= 128;
+    cr -= 128;
+    *r = MWVIP_CSC_Sat8((yy + k->crToR*cr) >> 13);
+    *g = MWVIP_CSC_Sat8((yy + k->cbToG*cb + k->crToG*cr) >> 13);
+    *b = MWVIP_CSC_Sat8((yy + k->cbToB*cb) >> 13);
+}
+
+#if defined(MWVIP_CSC_SSE2)
+
+typedef __m128i MWVIP_CSC_U8X16;
+#define MWVIP_CSC_LOAD16(p)      _mm_loadu_si128((const __m128i *)(p))
+#define MWVIP_CSC_STORE16(p, a)  _mm_storeu_si128((__m128i *)(p), (a))
+#define MWVIP_CSC_ZIPLO16(a, b)  _mm_unpacklo_epi8((a), (b))
+#define MWVIP_CSC_ZIPHI16(a, b)  _mm_unpackhi_epi8((a), (b))
+
+/* the Q15 sums of 4 pixels, rg holding (R, G) and b1 (B, 256) pairs */
+MWVIP_INLINE __m128i MWVIP_CSC_Dot4(const int16_T *c, __m128i rg, __m128i b1)
+{
+    const __m128i crg = _mm_set1_epi32((int32_T)((uint32_T)(uint16_T)c[0] |
+                                                 ((uint32_T)(uint16_T)c[1] << 16)));
+    const __m128i cb1 = _mm_set1_epi32((int32_T)((uint32_T)(uint16_T)c[2] |
+                                                 ((uint32_T)(uint16_T)c[3] << 16)));
+    return _mm_add_epi32(_mm_madd_epi16(rg, crg), _mm_madd_epi16(b1, cb1));
+}
+
+/* the Q15 sums of 16 pixels */
+MWVIP_INLINE void MWVIP_CSC_Dot16(const int16_T *c, __m128i r, __m128i g, __m128i b,
+                                  __m128i *sum)
+{
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i one = _mm_set1_epi16(256);
+    __m128i r16[2], g16[2], b16[2];
+    int_T h;
+    r16[0] = _mm_unpacklo_epi8(r, zero);
+    r16[1] = _mm_unpackhi_epi8(r, zero);
+    g16[0] = _mm_unpacklo_epi8(g, zero);
+    g16[1] = _mm_unpackhi_epi8(g, zero);
+    b16[0] = _mm_unpacklo_epi8(b, zero);
+    b16[1] = _mm_unpackhi_epi8(b, zero);
+    for (h = 0; h < 2; h++) {
+        sum[2*h]   = MWVIP_CSC_Dot4(c, _mm_unpacklo_epi16(r16[h], g16[h]),
+                                    _mm_unpacklo_epi16(b16[h], one));
+        sum[2*h+1] = MWVIP_CSC_Dot4(c, _mm_unpackhi_epi16(r16[h], g16[h]),
+                                    _mm_unpackhi_epi16(b16[h], one));
+    }
+}
+
+/* 16 bytes from 4 vectors of 4 sums shifted right by shift */
+MWVIP_INLINE __m128i MWVIP_CSC_Pack16(const __m128i *sum, int_T shift)
+{
+    const __m128i cnt = _mm_cvtsi32_si128(shift);
+    return _mm_packus_epi16(
+        _mm_packs_epi32(_mm_sra_epi32(sum[0], cnt), _mm_sra_epi32(sum[1], cnt)),
+        _mm_packs_epi32(_mm_sra_epi32(sum[2], cnt), _mm_sra_epi32(sum[3], cnt)));
+}
+
+/* Y'CbCr -> R'G'B' of 16 pixels */
+MWVIP_INLINE void MWVIP_CSC_ToRGB16(const MWVIP_CSC_COEFFS *k, __m128i y, __m128i cb,
+                                    __m128i cr, __m128i *r, __m128i *g, __m128i *b)
+{
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i c16 = _mm_set1_epi16(16), c128 = _mm_set1_epi16(128);
+    const __m128i one = _mm_set1_epi16(1);
+    const __m128i half = _mm_set1_epi32(4096);
+    const __m128i kR  = _mm_set1_epi32((int32_T)((uint32_T)(uint16_T)k->yScale |
+                                                 ((uint32_T)(uint16_T)k->crToR << 16)));
+    const __m128i kG  = _mm_set1_epi32((int32_T)((uint32_T)(uint16_T)k->yScale |
+                                                 ((uint32_T)(uint16_T)k->cbToG << 16)));
+    const __m128i kG2 = _mm_set1_epi32((int32_T)((uint32_T)(uint16_T)k->crToG |
+                                                 ((uint32_T)4096 << 16)));
+    const __m128i kB  = _mm_set1_epi32((int32_T)((uint32_T)(uint16_T)k->yScale |
+                                                 ((uint32_T)(uint16_T)k->cbToB << 16)));
+    __m128i sr[4], sg[4], sb[4];
+    int_T h, q;
+    for (h = 0; h < 2; h++) {
+        __m128i y16  = _mm_sub_epi16(h ? _mm_unpackhi_epi8(y, zero) : _mm_unpacklo_epi8(y, zero), c16);
+        __m128i cb16 = _mm_sub_epi16(h ? _mm_unpackhi_epi8(cb, zero) : _mm_unpacklo_epi8(cb, zero), c128);
+        __m128i cr16 = _mm_sub_epi16(h ? _mm_unpackhi_epi8(cr, zero) : _mm_unpacklo_epi8(cr, zero), c128);
+        for (q = 0; q < 2; q++) {
+            __m128i ycr = q ? _mm_unpackhi_epi16(y16, cr16) : _mm_unpacklo_epi16(y16, cr16);
+            __m128i ycb = q ? _mm_unpackhi_epi16(y16, cb16) : _mm_unpacklo_epi16(y16, cb16);
+            __m128i cr1 = q ? _mm_unpackhi_epi16(cr16, one) : _mm_unpacklo_epi16(cr16, one);
+            sr[2*h+q] = _mm_add_epi32(_mm_madd_epi16(ycr, kR), half);
+            sg[2*h+q] = _mm_add_epi32(_mm_madd_epi16(ycb, kG), _mm_madd_epi16(cr1, kG2));
+            sb[2*h+q] = _mm_add_epi32(_mm_madd_epi16(ycb, kB), half);
+        }
+    }
+    *r = MWVIP_CSC_Pack16(sr, 13);
+    *g = MWVIP_CSC_Pack16(sg, 13);
+    *b = MWVIP_CSC_Pack16(sb, 13);
+}
+
+#elif defined(MWVIP_CSC_NEON)
+
+typedef uint8x16_t MWVIP_CSC_U8X16;
+#define MWVIP_CSC_LOAD16(p)      vld1q_u8(p)
+#define MWVIP_CSC_STORE16(p, a)  vst1q_u8((p), (a))
+#define MWVIP_CSC_ZIPLO16(a, b)  vzipq_u8((a), (b)).val[0]
+#define MWVIP_CSC_ZIPHI16(a, b)  vzipq_u8((a), (b)).val[1]
+
+/* the Q15 sums of 4 pixels */
+MWVIP_INLINE int32x4_t MWVIP_CSC_Dot4(const int16_T *c, int16x4_t r, int16x4_t g,
+                                      int16x4_t b)
+{
+    int32x4_t s = vdupq_n_s32((int32_T)c[3]*256);
+    s = vmlal_n_s16(s, r, c[0]);
+    s = vmlal_n_s16(s, g, c[1]);
+    return vmlal_n_s16(s, b, c[2]);
+}
+
+/* the Q15 sums of 16 pixels */
+MWVIP_INLINE void MWVIP_CSC_Dot16(const int16_T *c, uint8x16_t r, uint8x16_t g,
+                                  uint8x16_t b, int32x4_t *sum)
+{
+    int16x8_t r16[2], g16[2], b16[2];
+    int_T h;
+    r16[0] = vreinterpretq_s16_u16(vmovl_u8(vget_low_u8(r)));
+    r16[1] = vreinterpretq_s16_u16(vmovl_u8(vget_high_u8(r)));
+    g16[0] = vreinterpretq_s16_u16(vmovl_u8(vget_low_u8(g)));
+    g16[1] = vreinterpretq_s16_u16(vmovl_u8(vget_high_u8(g)));
+    b16[0] = vreinterpretq_s16_u16(vmovl_u8(vget_low_u8(b)));
+    b16[1] = vreinterpretq_s16_u16(vmovl_u8(vget_high_u8(b)));
+    for (h = 0; h < 2; h++) {
+        sum[2*h]   = MWVIP_CSC_Dot4(c, vget_low_s16(r16[h]), vget_low_s16(g16[h]),
+                                    vget_low_s16(b16[h]));
+        sum[2*h+1] = MWVIP_CSC_Dot4(c, vget_high_s16(r16[h]), vget_high_s16(g16[h]),
+                                    vget_high_s16(b16[h]));
+    }
+}
+
+/* 16 bytes from 4 vectors of 4 sums shifted right by shift */
+MWVIP_INLINE uint8x16_t MWVIP_CSC_Pack16(const int32x4_t *sum, int_T shift)
+{
+    const int32x4_t cnt = vdupq_n_s32(-shift);
+    int16x8_t lo = vcombine_s16(vqmovn_s32(vshlq_s32(sum[0], cnt)),
+                                vqmovn_s32(vshlq_s32(sum[1], cnt)));
+    int16x8_t hi = vcombine_s16(vqmovn_s32(vshlq_s32(sum[2], cnt)),
+                                vqmovn_s32(vshlq_s32(sum[3], cnt)));
+    return vcombine_u8(vqmovun_s16(lo), vqmovun_s16(hi));
+}
+
+/* Y'CbCr -> R'G'B' of 16 pixels */
+MWVIP_INLINE void MWVIP_CSC_ToRGB16(const MWVIP_CSC_COEFFS *k, uint8x16_t y, uint8x16_t cb,
+                                    uint8x16_t cr, uint8x16_t *r, uint8x16_t *g,
+                                    uint8x16_t *b)
+{
+    int32x4_t sr[4], sg[4], sb[4];
+    int_T h, q;
+    for (h = 0; h < 2; h++) {
+        int16x8_t y16 = vsubq_s16(vreinterpretq_s16_u16(vmovl_u8(h ? vget_high_u8(y) : vget_low_u8(y))),
+                                  vdupq_n_s16(16));
+        int16x8_t cb16 = vsubq_s16(vreinterpretq_s16_u16(vmovl_u8(h ? vget_high_u8(cb) : vget_low_u8(cb))),
+                                   vdupq_n_s16(128));
+        int16x8_t cr16 = vsubq_s16(vreinterpretq_s16_u16(vmovl_u8(h ? vget_high_u8(cr) : vget_low_u8(cr))),
+                                   vdupq_n_s16(128));
+        for (q = 0; q < 2; q++) {
+            int16x4_t y4  = q ? vget_high_s16(y16) : vget_low_s16(y16);
+            int16x4_t cb4 = q ? vget_high_s16(cb16) : vget_low_s16(cb16);
+            int16x4_t cr4 = q ? vget_high_s16(cr16) : vget_low_s16(cr16);
+            int32x4_t yy = vmlal_n_s16(vdupq_n_s32(4096), y4, k->yScale);
+            sr[2*h+q] = vmlal_n_s16(yy, cr4, k->crToR);
+            sg[2*h+q] = vmlal_n_s16(vmlal_n_s16(yy, cb4, k->cbToG), cr4, k->crToG);
+            sb[2*h+q] = vmlal_n_s16(yy, cb4, k->cbToB);
+        }
+    }
+    *r = MWVIP_CSC_Pack16(sr, 13);
+    *g = MWVIP_CSC_Pack16(sg, 13);
+    *b = MWVIP_CSC_Pack16(sb, 13);
+}
+
+#endif
+
+#if defined(MWVIP_CSC_SSE2) || defined(MWVIP_CSC_NEON)
+
+/* transposes 16 lines by 4 macropixels of a packed 4:2:2 frame of cols
+ * macropixels per line, from line r and macropixel j: t[4*m + k] then
+ * holds byte k of macropixel j + m of the 16 lines */
+MWVIP_INLINE void MWVIP_CSC_Transpose16(const uint8_T *frame, int_T r, int_T j,
+                                        int_T cols, MWVIP_CSC_U8X16 *t)
+{
+    MWVIP_CSC_U8X16 b[16];
+    int_T i, s;
+    for (i = 0; i < 16; i++) {
+        t[i] = MWVIP_CSC_LOAD16(&frame[4*((r + i)*cols + j)]);
+    }
+    /* four perfect shuffles of the 16 vectors transpose the 16x16 bytes */
+    for (s = 0; s < 4; s++) {
+        for (i = 0; i < 8; i++) {
+            b[2*i]   = MWVIP_CSC_ZIPLO16(t[i], t[i+8]);
+            b[2*i+1] = MWVIP_CSC_ZIPHI16(t[i], t[i+8]);
+        }
+        for (i = 0; i < 16; i++) {
+            t[i] = b[i];
+        }
+    }
+}
+
+#endif
+
+/* byte offsets of Y0, U, Y1 and V in a macropixel of the layout */
+MWVIP_INLINE void MWVIP_CSC_Packed422Offsets(int_T layout, int_T *off)
+{
+    static const int_T offsets[3][4] = {
+        {0, 1, 2, 3},   /* YUY2 */
+        {1, 0, 3, 2},   /* UYVY */
+        {0, 3, 2, 1}    /* YVYU */
+    };
+    int_T k;
+    if (layout < 0 || layout > 2) layout = MWVIP_CSC_YUY2;
+    for (k = 0; k < 4; k++) {
+        off[k] = offsets[layout][k];
+    }
+}
+
+#endif /* colorconv_rt_h */
+
+/* [EOF] colorconv_rt.h */
@@ -0,0 +1,77 @@
+/*
+ *  HSV2RGB_R_RT runtime function for VIPBLKS Color Space Conversion block
+ *
+ *  Converts single precision HSV pixels to R'G'B' as hsv2rgb does, 4 at a
+ *  time: the sector floor(6*H) picks each component among V, V*(1-S),
+ *  V*(1-S*F) and V*(1-S*(1-F)), F being the fraction of 6*H.
+ *
+ *  Copyright 2016 The MathWorks, Inc.
+ */
+#include "colorconv_rt.h"
+
+#if defined(MWVIP_CSC_SSE2)
+#define MWVIP_CSC_SELECT(m, a, b) _mm_or_ps(_mm_and_ps((m), (a)), _mm_andnot_ps((m), (b)))
+#endif
+
+LIBMWVISIONRT_API void MWVIP_HSV2RGB_R(const real32_T *h, const real32_T *s,
+                                       const real32_T *v, real32_T *r,
+                                       real32_T *g, real32_T *b,
+                                       int_T numPixels)
+{
+    int_T i = 0;
+
+#if defined(MWVIP_CSC_SSE2)
+    const __m128 one = _mm_set1_ps(1.0F);
+    for (; i <= numPixels - 4; i += 4) {
+        const __m128 vv = _mm_loadu_ps(&v[i]);
+        const __m128 vs = _mm_loadu_ps(&s[i]);
+        const __m128 h6 = _mm_mul_ps(_mm_loadu_ps(&h[i]), _mm_set1_ps(6.0F));
+        /* floor of the nonnegative hue */
+        const __m128i k = _mm_cvttps_epi32(h6);
+        const __m128 f = _mm_sub_ps(h6, _mm_cvtepi32_ps(k));
+        const __m128 e = vv;
+        const __m128 t = _mm_mul_ps(vv, _mm_sub_ps(one, vs));
+        const __m128 n = _mm_mul_ps(vv, _mm_sub_ps(one, _mm_mul_ps(vs, f)));
+        const __m128 p = _mm_mul_ps(vv, _mm_sub_ps(one, _mm_mul_ps(vs, _mm_sub_ps(one, f))));
+        const __m128 k1 = _mm_castsi128_ps(_mm_cmpeq_epi32(k, _mm_set1_epi32(1)));
+        const __m128 k2 = _mm_castsi128_ps(_mm_cmpeq_epi32(k, _mm_set1_epi32(2)));
+        const __m128 k3 = _mm_castsi128_ps(_mm_cmpeq_epi32(k, _mm_set1_epi32(3)));
+        const __m128 k4 = _mm_castsi128_ps(_mm_cmpeq_epi32(k, _mm_set1_epi32(4)));
+        const __m128 k5 = _mm_castsi128_ps(_mm_cmpeq_epi32(k, _mm_set1_epi32(5)));
+        /* sectors 0 and 6 are the default */
+        __m128 vr = e, vg = p, vb = t;
+        vr = MWVIP_CSC_SELECT(k1, n, vr);
+        vg = MWVIP_CSC_SELECT(k1, e, vg);
+        vr = MWVIP_CSC_SELECT(_mm_or_ps(k2, k3), t, vr);
+        vg = MWVIP_CSC_SELECT(k2, e, vg);
+        vb = MWVIP_CSC_SELECT(k2, p, vb);
+        vg = MWVIP_CSC_SELECT(k3, n, vg);
+        vb = MWVIP_CSC_SELECT(_mm_or_ps(k3, k4), e, vb);
+        vr = MWVIP_CSC_SELECT(k4, p, vr);
+        vg = MWVIP_CSC_SELECT(_mm_or_ps(k4, k5), t, vg);
+        vb = MWVIP_CSC_SELECT(k5, n, vb);
+        _mm_storeu_ps(&r[i], vr);
+        _mm_storeu_ps(&g[i], vg);
+        _mm_storeu_ps(&b[i], vb);
+    }
+#endif
+    for (; i < numPixels; i++) {
+        const real32_T vv = v[i], vs = s[i];
+        const real32_T h6 = h[i]*6.0F;
+        const int_T k = (int_T)h6;
+        const real32_T f = h6 - (real32_T)k;
+        const real32_T t = vv*(1.0F - vs);
+        const real32_T n = vv*(1.0F - vs*f);
+        const real32_T p = vv*(1.0F - vs*(1.0F - f));
+        switch (k) {
+          case 1:  r[i] = n;  g[i] = vv; b[i] = t;  break;
+          case 2:  r[i] = t;  g[i] = vv; b[i] = p;  break;
+          case 3:  r[i] = t;  g[i] = n;  b[i] = vv; break;
+          case 4:  r[i] = p;  g[i] = t;  b[i] = vv; break;
+          case 5:  r[i] = vv; g[i] = t;  b[i] = n;  break;
+          default: r[i] = vv; g[i] = p;  b[i] = t;  break;
+        }
+    }
+}
+
+/* [EOF] hsv2rgb_r_rt.c */
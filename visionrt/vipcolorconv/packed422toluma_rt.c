@@ -0,0 +1,50 @@
+/*
+ *  PACKED422TOLUMA_RT runtime function for VIPBLKS Color Space Conversion block
+ *
+ *  Extracts the Y' plane of a packed 4:2:2 frame, e.g. the staging buffer
+ *  of MWVIP_UYVY_ReadFrame, for the intensity output of the block, in
+ *  tiles of 16 lines by 4 macropixels transposed in registers.
+ *
+ *  Copyright 2016 The MathWorks, Inc.
+ */
+#include "colorconv_rt.h"
+
+LIBMWVISIONRT_API void MWVIP_Packed422ToLuma_U8(const uint8_T *frame, int_T layout,
+                                                uint8_T *y, int_T rows, int_T cols)
+{
+    int_T off[4];
+    int_T i = 0, j;
+
+    MWVIP_CSC_Packed422Offsets(layout, off);
+
+#if defined(MWVIP_CSC_SSE2) || defined(MWVIP_CSC_NEON)
+    for (; i <= rows - 16; i += 16) {
+        for (j = 0; j <= cols - 4; j += 4) {
+            MWVIP_CSC_U8X16 t[16];
+            int_T m;
+            MWVIP_CSC_Transpose16(frame, i, j, cols, t);
+            for (m = 0; m < 4; m++) {
+                MWVIP_CSC_STORE16(&y[2*(j + m)*rows + i], t[4*m + off[0]]);
+                MWVIP_CSC_STORE16(&y[(2*(j + m) + 1)*rows + i], t[4*m + off[2]]);
+            }
+        }
+        for (; j < cols; j++) {
+            int_T ii;
+            for (ii = i; ii < i + 16; ii++) {
+                const uint8_T *mp = &frame[4*(ii*cols + j)];
+                y[2*j*rows + ii] = mp[off[0]];
+                y[(2*j + 1)*rows + ii] = mp[off[2]];
+            }
+        }
+    }
+#endif
+    for (; i < rows; i++) {
+        for (j = 0; j < cols; j++) {
+            const uint8_T *mp = &frame[4*(i*cols + j)];
+            y[2*j*rows + i] = mp[off[0]];
+            y[(2*j + 1)*rows + i] = mp[off[2]];
+        }
+    }
+}
+
+/* [EOF] packed422toluma_rt.c */
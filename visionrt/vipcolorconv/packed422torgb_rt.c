@@ -0,0 +1,65 @@
+/*
+ *  PACKED422TORGB_RT runtime function for VIPBLKS Color Space Conversion block
+ *
+ *  Converts a packed 4:2:2 Rec. 601 frame, e.g. the staging buffer of
+ *  MWVIP_UYVY_ReadFrame, straight to column major R'G'B' planes. Tiles of
+ *  16 lines by 4 macropixels are transposed in registers, so that each
+ *  byte of a macropixel lands in a vector of 16 rows of a column.
+ *
+ *  Copyright 2016 The MathWorks, Inc.
+ */
+#include "colorconv_rt.h"
+
+LIBMWVISIONRT_API void MWVIP_Packed422ToRGB_U8(const uint8_T *frame, int_T layout,
+                                               uint8_T *r, uint8_T *g, uint8_T *b,
+                                               int_T rows, int_T cols)
+{
+    const MWVIP_CSC_COEFFS *k = MWVIP_CSC_GetCoeffs(MWVIP_CSC_REC601);
+    int_T off[4];
+    int_T i = 0, j;
+
+    MWVIP_CSC_Packed422Offsets(layout, off);
+
+#if defined(MWVIP_CSC_SSE2) || defined(MWVIP_CSC_NEON)
+    for (; i <= rows - 16; i += 16) {
+        for (j = 0; j <= cols - 4; j += 4) {
+            MWVIP_CSC_U8X16 t[16], vr, vg, vb;
+            int_T m, c;
+            MWVIP_CSC_Transpose16(frame, i, j, cols, t);
+            for (m = 0; m < 4; m++) {
+                const MWVIP_CSC_U8X16 *mp = &t[4*m];
+                for (c = 0; c < 2; c++) {
+                    const int_T n = 2*(j + m)*rows + c*rows + i;
+                    MWVIP_CSC_ToRGB16(k, mp[off[2*c]], mp[off[1]], mp[off[3]], &vr, &vg, &vb);
+                    MWVIP_CSC_STORE16(&r[n], vr);
+                    MWVIP_CSC_STORE16(&g[n], vg);
+                    MWVIP_CSC_STORE16(&b[n], vb);
+                }
+            }
+        }
+        /* the last macropixels of the lines */
+        for (; j < cols; j++) {
+            int_T ii, c;
+            for (ii = i; ii < i + 16; ii++) {
+                const uint8_T *mp = &frame[4*(ii*cols + j)];
+                for (c = 0; c < 2; c++) {
+                    const int_T n = 2*j*rows + c*rows + ii;
+                    MWVIP_CSC_ToRGB(k, mp[off[2*c]], mp[off[1]], mp[off[3]], &r[n], &g[n], &b[n]);
+                }
+            }
+        }
+    }
+#endif
+    for (; i < rows; i++) {
+        for (j = 0; j < cols; j++) {
+            const uint8_T *mp = &frame[4*(i*cols + j)];
+            int_T c;
+            for (c = 0; c < 2; c++) {
+                const int_T n = 2*j*rows + c*rows + i;
+                MWVIP_CSC_ToRGB(k, mp[off[2*c]], mp[off[1]], mp[off[3]], &r[n], &g[n], &b[n]);
+            }
+        }
+    }
+}
+
+/* [EOF] packed422torgb_rt.c */
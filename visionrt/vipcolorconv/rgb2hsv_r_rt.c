@@ -0,0 +1,79 @@
+/*
+ *  RGB2HSV_R_RT runtime function for VIPBLKS Color Space Conversion block
+ *
+ *  Converts single precision R'G'B' pixels to HSV as rgb2hsv does, 4 at a
+ *  time. The hue of the largest component wins, B over G over R, and is 0
+ *  for grays; the saturation is 0 for black.
+ *
+ *  Copyright 2016 The MathWorks, Inc.
+ */
+#include "colorconv_rt.h"
+
+#if defined(MWVIP_CSC_SSE2)
+#define MWVIP_CSC_SELECT(m, a, b) _mm_or_ps(_mm_and_ps((m), (a)), _mm_andnot_ps((m), (b)))
+#endif
+
+LIBMWVISIONRT_API void MWVIP_RGB2HSV_R(const real32_T *r, const real32_T *g,
+                                       const real32_T *b, real32_T *h,
+                                       real32_T *s, real32_T *v,
+                                       int_T numPixels)
+{
+    int_T i = 0;
+
+#if defined(MWVIP_CSC_SSE2)
+    const __m128 zero = _mm_setzero_ps(), one = _mm_set1_ps(1.0F);
+    for (; i <= numPixels - 4; i += 4) {
+        const __m128 vr = _mm_loadu_ps(&r[i]);
+        const __m128 vg = _mm_loadu_ps(&g[i]);
+        const __m128 vb = _mm_loadu_ps(&b[i]);
+        const __m128 mx = _mm_max_ps(_mm_max_ps(vr, vg), vb);
+        const __m128 mn = _mm_min_ps(_mm_min_ps(vr, vg), vb);
+        const __m128 d = _mm_sub_ps(mx, mn);
+        const __m128 gray = _mm_cmpeq_ps(d, zero);
+        /* 1 in place of a 0 delta, as rgb2hsv */
+        const __m128 dd = _mm_add_ps(d, _mm_and_ps(gray, one));
+        __m128 hue = _mm_div_ps(_mm_sub_ps(vg, vb), dd);
+        __m128 sat;
+        hue = MWVIP_CSC_SELECT(_mm_cmpeq_ps(vg, mx),
+                               _mm_add_ps(_mm_set1_ps(2.0F), _mm_div_ps(_mm_sub_ps(vb, vr), dd)),
+                               hue);
+        hue = MWVIP_CSC_SELECT(_mm_cmpeq_ps(vb, mx),
+                               _mm_add_ps(_mm_set1_ps(4.0F), _mm_div_ps(_mm_sub_ps(vr, vg), dd)),
+                               hue);
+        hue = _mm_div_ps(hue, _mm_set1_ps(6.0F));
+        hue = _mm_add_ps(hue, _mm_and_ps(_mm_cmplt_ps(hue, zero), one));
+        hue = _mm_andnot_ps(gray, hue);
+        sat = _mm_andnot_ps(_mm_or_ps(gray, _mm_cmpeq_ps(mx, zero)), _mm_div_ps(d, mx));
+        _mm_storeu_ps(&h[i], hue);
+        _mm_storeu_ps(&s[i], sat);
+        _mm_storeu_ps(&v[i], mx);
+    }
+#endif
+    for (; i < numPixels; i++) {
+        const real32_T vr = r[i], vg = g[i], vb = b[i];
+        real32_T mx = vr > vg ? vr : vg;
+        real32_T mn = vr < vg ? vr : vg;
+        real32_T d, hue;
+        mx = mx > vb ? mx : vb;
+        mn = mn < vb ? mn : vb;
+        d = mx - mn;
+        if (d == 0.0F) {
+            h[i] = 0.0F;
+            s[i] = 0.0F;
+        } else {
+            if (vb == mx) {
+                hue = 4.0F + (vr - vg)/d;
+            } else if (vg == mx) {
+                hue = 2.0F + (vb - vr)/d;
+            } else {
+                hue = (vg - vb)/d;
+            }
+            hue = hue/6.0F;
+            h[i] = hue < 0.0F ? hue + 1.0F : hue;
+            s[i] = d/mx;
+        }
+        v[i] = mx;
+    }
+}
+
+/* [EOF] rgb2hsv_r_rt.c */
@@ -0,0 +1,87 @@
+/*
+ *  RGB2YCBCR_R_RT runtime function for VIPBLKS Color Space Conversion block
+ *
+ *  Converts whole single precision R'G'B' planes to Y'CbCr, 4 pixels of a
+ *  column at a time, with 4:4:4 or 4:2:2 chroma.
+ *
+ *  Copyright 2016 The MathWorks, Inc.
+ */
+#include "colorconv_rt.h"
+
+#define MWVIP_CSC_Y_OFFSET (16.0F/255.0F)
+#define MWVIP_CSC_C_OFFSET (128.0F/255.0F)
+
+LIBMWVISIONRT_API void MWVIP_RGB2YCbCr_R(const real32_T *r, const real32_T *g,
+                                         const real32_T *b, real32_T *y,
+                                         real32_T *cb, real32_T *cr,
+                                         int_T rows, int_T cols,
+                                         int_T standard, int_T chroma)
+{
+    const MWVIP_CSC_COEFFS *k = MWVIP_CSC_GetCoeffs(standard);
+    const boolean_T withChroma = (boolean_T)(cb != NULL && cr != NULL);
+    const int_T step = (chroma == MWVIP_CSC_CHROMA_422) ? 2 : 1;
+    const real32_T scale = (step == 2) ? 0.5F : 1.0F;
+    int_T i, j, c;
+
+    for (j = 0; j < cols; j += step) {
+        const int_T j1 = (step == 2 && j + 1 < cols) ? j + 1 : j;
+        real32_T *cbCol = withChroma ? cb + (j/step)*rows : NULL;
+        real32_T *crCol = withChroma ? cr + (j/step)*rows : NULL;
+
+        i = 0;
+#if defined(MWVIP_CSC_SSE2)
+        for (; i <= rows - 4; i += 4) {
+            __m128 sumCb = _mm_setzero_ps(), sumCr = _mm_setzero_ps();
+            for (c = 0; c < step; c++) {
+                const int_T jc = c ? j1 : j;
+                const int_T n = jc*rows + i;
+                const __m128 vr = _mm_loadu_ps(&r[n]);
+                const __m128 vg = _mm_loadu_ps(&g[n]);
+                const __m128 vb = _mm_loadu_ps(&b[n]);
+                if (c == 0 || jc != j) {
+                    __m128 vy = _mm_add_ps(_mm_mul_ps(vr, _mm_set1_ps(k->fy[0])),
+                                           _mm_set1_ps(MWVIP_CSC_Y_OFFSET));
+                    vy = _mm_add_ps(vy, _mm_mul_ps(vg, _mm_set1_ps(k->fy[1])));
+                    vy = _mm_add_ps(vy, _mm_mul_ps(vb, _mm_set1_ps(k->fy[2])));
+                    _mm_storeu_ps(&y[n], vy);
+                }
+                if (withChroma) {
+                    sumCb = _mm_add_ps(sumCb, _mm_mul_ps(vr, _mm_set1_ps(k->fcb[0])));
+                    sumCb = _mm_add_ps(sumCb, _mm_mul_ps(vg, _mm_set1_ps(k->fcb[1])));
+                    sumCb = _mm_add_ps(sumCb, _mm_mul_ps(vb, _mm_set1_ps(k->fcb[2])));
+                    sumCr = _mm_add_ps(sumCr, _mm_mul_ps(vr, _mm_set1_ps(k->fcr[0])));
+                    sumCr = _mm_add_ps(sumCr, _mm_mul_ps(vg, _mm_set1_ps(k->fcr[1])));
+                    sumCr = _mm_add_ps(sumCr, _mm_mul_ps(vb, _mm_set1_ps(k->fcr[2])));
+                }
+            }
+            if (withChroma) {
+                _mm_storeu_ps(&cbCol[i], _mm_add_ps(_mm_mul_ps(sumCb, _mm_set1_ps(scale)),
+                                                    _mm_set1_ps(MWVIP_CSC_C_OFFSET)));
+                _mm_storeu_ps(&crCol[i], _mm_add_ps(_mm_mul_ps(sumCr, _mm_set1_ps(scale)),
+                                                    _mm_set1_ps(MWVIP_CSC_C_OFFSET)));
+            }
+        }
+#endif
+        for (; i < rows; i++) {
+            real32_T sumCb = 0.0F, sumCr = 0.0F;
+            for (c = 0; c < step; c++) {
+                const int_T jc = c ? j1 : j;
+                const int_T n = jc*rows + i;
+                const real32_T vr = r[n], vg = g[n], vb = b[n];
+                if (c == 0 || jc != j) {
+                    y[n] = vr*k->fy[0] + MWVIP_CSC_Y_OFFSET + vg*k->fy[1] + vb*k->fy[2];
+                }
+                if (withChroma) {
+                    sumCb += vr*k->fcb[0] + vg*k->fcb[1] + vb*k->fcb[2];
+                    sumCr += vr*k->fcr[0] + vg*k->fcr[1] + vb*k->fcr[2];
+                }
+            }
+            if (withChroma) {
+                cbCol[i] = sumCb*scale + MWVIP_CSC_C_OFFSET;
+                crCol[i] = sumCr*scale + MWVIP_CSC_C_OFFSET;
+            }
+        }
+    }
+}
+
+/* [EOF] rgb2ycbcr_r_rt.c */
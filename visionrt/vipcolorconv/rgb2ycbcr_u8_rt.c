@@ -0,0 +1,100 @@
+/*
+ *  RGB2YCBCR_U8_RT runtime function for VIPBLKS Color Space Conversion block
+ *
+ *  Converts whole uint8 R'G'B' planes to Y'CbCr, 16 pixels of a column at
+ *  a time, with 4:4:4 or 4:2:2 chroma. The 4:2:2 chroma is the rounded
+ *  mean of the Q15 chroma of the two columns, computed in the same pass.
+ *
+ *  Copyright 2016 The MathWorks, Inc.
+ */
+#include "colorconv_rt.h"
+
+LIBMWVISIONRT_API void MWVIP_RGB2YCbCr_U8(const uint8_T *r, const uint8_T *g,
+                                          const uint8_T *b, uint8_T *y,
+                                          uint8_T *cb, uint8_T *cr,
+                                          int_T rows, int_T cols,
+                                          int_T standard, int_T chroma)
+{
+    const MWVIP_CSC_COEFFS *k = MWVIP_CSC_GetCoeffs(standard);
+    const boolean_T withChroma = (boolean_T)(cb != NULL && cr != NULL);
+    const int_T step = (chroma == MWVIP_CSC_CHROMA_422) ? 2 : 1;
+    int_T i, j, c;
+
+    for (j = 0; j < cols; j += step) {
+        /* the columns converted together, the last one repeated when odd */
+        const int_T j1 = (step == 2 && j + 1 < cols) ? j + 1 : j;
+        const int_T shift = (step == 2) ? 16 : 15;
+        uint8_T *cbCol = withChroma ? cb + (j/step)*rows : NULL;
+        uint8_T *crCol = withChroma ? cr + (j/step)*rows : NULL;
+
+        i = 0;
+#if defined(MWVIP_CSC_SSE2) || defined(MWVIP_CSC_NEON)
+        for (; i <= rows - 16; i += 16) {
+#if defined(MWVIP_CSC_SSE2)
+            __m128i sy[4], scb[4], scr[4], t[4];
+#else
+            int32x4_t sy[4], scb[4], scr[4], t[4];
+#endif
+            int_T q;
+            for (c = 0; c < step; c++) {
+                const int_T jc = c ? j1 : j;
+                const int_T n = jc*rows + i;
+                MWVIP_CSC_U8X16 vr = MWVIP_CSC_LOAD16(&r[n]);
+                MWVIP_CSC_U8X16 vg = MWVIP_CSC_LOAD16(&g[n]);
+                MWVIP_CSC_U8X16 vb = MWVIP_CSC_LOAD16(&b[n]);
+                if (c == 0 || jc != j) {
+                    MWVIP_CSC_Dot16(k->y, vr, vg, vb, sy);
+                    MWVIP_CSC_STORE16(&y[n], MWVIP_CSC_Pack16(sy, 15));
+                }
+                if (!withChroma) continue;
+                if (c == 0) {
+                    MWVIP_CSC_Dot16(k->cb, vr, vg, vb, scb);
+                    MWVIP_CSC_Dot16(k->cr, vr, vg, vb, scr);
+                } else {
+                    MWVIP_CSC_Dot16(k->cb, vr, vg, vb, t);
+                    for (q = 0; q < 4; q++) {
+#if defined(MWVIP_CSC_SSE2)
+                        scb[q] = _mm_add_epi32(scb[q], t[q]);
+#else
+                        scb[q] = vaddq_s32(scb[q], t[q]);
+#endif
+                    }
+                    MWVIP_CSC_Dot16(k->cr, vr, vg, vb, t);
+                    for (q = 0; q < 4; q++) {
+#if defined(MWVIP_CSC_SSE2)
+                        scr[q] = _mm_add_epi32(scr[q], t[q]);
+#else
+                        scr[q] = vaddq_s32(scr[q], t[q]);
+#endif
+                    }
+                }
+            }
+            if (withChroma) {
+                MWVIP_CSC_STORE16(&cbCol[i], MWVIP_CSC_Pack16(scb, shift));
+                MWVIP_CSC_STORE16(&crCol[i], MWVIP_CSC_Pack16(scr, shift));
+            }
+        }
+#endif
+        for (; i < rows; i++) {
+            int32_T sumCb = 0, sumCr = 0;
+            for (c = 0; c < step; c++) {
+                const int_T jc = c ? j1 : j;
+                const int_T n = jc*rows + i;
+                const int32_T vr = r[n], vg = g[n], vb = b[n];
+                if (c == 0 || jc != j) {
+                    y[n] = MWVIP_CSC_Sat8(MWVIP_CSC_Dot(k->y, vr, vg, vb) >> 15);
+                }
+                if (withChroma) {
+                    sumCb += MWVIP_CSC_Dot(k->cb, vr, vg, vb);
+                    sumCr += MWVIP_CSC_Dot(k->cr, vr, vg, vb);
+                }
+            }
+            if (withChroma) {
+                cbCol[i] = MWVIP_CSC_Sat8(sumCb >> shift);
+                crCol[i] = MWVIP_CSC_Sat8(sumCr >> shift);
+            }
+        }
+    }
+}
+
+/* [EOF] rgb2ycbcr_u8_rt.c */
@@ -0,0 +1,62 @@
+/*
+ *  YCBCR2RGB_R_RT runtime function for VIPBLKS Color Space Conversion block
+ *
+ *  Converts whole single precision Y'CbCr planes, with 4:4:4 or 4:2:2
+ *  chroma, to R'G'B' saturated to [0, 1], 4 pixels of a column at a time.
+ *
+ *  Copyright 2016 The MathWorks, Inc.
+ */
+#include "colorconv_rt.h"
+
+#define MWVIP_CSC_SAT01(x) ((x) < 0.0F ? 0.0F : ((x) > 1.0F ? 1.0F : (x)))
+
+LIBMWVISIONRT_API void MWVIP_YCbCr2RGB_R(const real32_T *y, const real32_T *cb,
+                                         const real32_T *cr, real32_T *r,
+                                         real32_T *g, real32_T *b,
+                                         int_T rows, int_T cols,
+                                         int_T standard, int_T chroma)
+{
+    const MWVIP_CSC_COEFFS *k = MWVIP_CSC_GetCoeffs(standard);
+    const int_T shift = (chroma == MWVIP_CSC_CHROMA_422) ? 1 : 0;
+    int_T i, j;
+
+    for (j = 0; j < cols; j++) {
+        const int_T n0 = j*rows;
+        const real32_T *cbCol = cb + (j >> shift)*rows;
+        const real32_T *crCol = cr + (j >> shift)*rows;
+
+        i = 0;
+#if defined(MWVIP_CSC_SSE2)
+        {
+            const __m128 zero = _mm_setzero_ps(), one = _mm_set1_ps(1.0F);
+            for (; i <= rows - 4; i += 4) {
+                const __m128 vy = _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(&y[n0 + i]),
+                                                        _mm_set1_ps(16.0F/255.0F)),
+                                             _mm_set1_ps(k->fyScale));
+                const __m128 vcb = _mm_sub_ps(_mm_loadu_ps(&cbCol[i]), _mm_set1_ps(128.0F/255.0F));
+                const __m128 vcr = _mm_sub_ps(_mm_loadu_ps(&crCol[i]), _mm_set1_ps(128.0F/255.0F));
+                __m128 vr = _mm_add_ps(vy, _mm_mul_ps(vcr, _mm_set1_ps(k->fcrToR)));
+                __m128 vg = _mm_add_ps(vy, _mm_mul_ps(vcb, _mm_set1_ps(k->fcbToG)));
+                __m128 vb = _mm_add_ps(vy, _mm_mul_ps(vcb, _mm_set1_ps(k->fcbToB)));
+                vg = _mm_add_ps(vg, _mm_mul_ps(vcr, _mm_set1_ps(k->fcrToG)));
+                _mm_storeu_ps(&r[n0 + i], _mm_min_ps(_mm_max_ps(vr, zero), one));
+                _mm_storeu_ps(&g[n0 + i], _mm_min_ps(_mm_max_ps(vg, zero), one));
+                _mm_storeu_ps(&b[n0 + i], _mm_min_ps(_mm_max_ps(vb, zero), one));
+            }
+        }
+#endif
+        for (; i < rows; i++) {
+            const real32_T vy = (y[n0 + i] - 16.0F/255.0F)*k->fyScale;
+            const real32_T vcb = cbCol[i] - 128.0F/255.0F;
+            const real32_T vcr = crCol[i] - 128.0F/255.0F;
+            const real32_T vr = vy + vcr*k->fcrToR;
+            const real32_T vg = vy + vcb*k->fcbToG + vcr*k->fcrToG;
+            const real32_T vb = vy + vcb*k->fcbToB;
+            r[n0 + i] = MWVIP_CSC_SAT01(vr);
+            g[n0 + i] = MWVIP_CSC_SAT01(vg);
+            b[n0 + i] = MWVIP_CSC_SAT01(vb);
+        }
+    }
+}
+
+/* [EOF] ycbcr2rgb_r_rt.c */
@@ -0,0 +1,44 @@
+/*
+ *  YCBCR2RGB_U8_RT runtime function for VIPBLKS Color Space Conversion block
+ *
+ *  Converts whole uint8 Y'CbCr planes, with 4:4:4 or 4:2:2 chroma, to
+ *  R'G'B', 16 pixels of a column at a time.
+ *
+ *  Copyright 2016 The MathWorks, Inc.
+ */
+#include "colorconv_rt.h"
+
+LIBMWVISIONRT_API void MWVIP_YCbCr2RGB_U8(const uint8_T *y, const uint8_T *cb,
+                                          const uint8_T *cr, uint8_T *r,
+                                          uint8_T *g, uint8_T *b,
+                                          int_T rows, int_T cols,
+                                          int_T standard, int_T chroma)
+{
+    const MWVIP_CSC_COEFFS *k = MWVIP_CSC_GetCoeffs(standard);
+    const int_T shift = (chroma == MWVIP_CSC_CHROMA_422) ? 1 : 0;
+    int_T i, j;
+
+    for (j = 0; j < cols; j++) {
+        const int_T n0 = j*rows;
+        const uint8_T *cbCol = cb + (j >> shift)*rows;
+        const uint8_T *crCol = cr + (j >> shift)*rows;
+
+        i = 0;
+#if defined(MWVIP_CSC_SSE2) || defined(MWVIP_CSC_NEON)
+        for (; i <= rows - 16; i += 16) {
+            MWVIP_CSC_U8X16 vr, vg, vb;
+            MWVIP_CSC_ToRGB16(k, MWVIP_CSC_LOAD16(&y[n0 + i]), MWVIP_CSC_LOAD16(&cbCol[i]),
+                              MWVIP_CSC_LOAD16(&crCol[i]), &vr, &vg, &vb);
+            MWVIP_CSC_STORE16(&r[n0 + i], vr);
+            MWVIP_CSC_STORE16(&g[n0 + i], vg);
+            MWVIP_CSC_STORE16(&b[n0 + i], vb);
+        }
+#endif
+        for (; i < rows; i++) {
+            MWVIP_CSC_ToRGB(k, y[n0 + i], cbCol[i], crCol[i],
+                            &r[n0 + i], &g[n0 + i], &b[n0 + i]);
+        }
+    }
+}
+
+/* [EOF] ycbcr2rgb_u8_rt.c */
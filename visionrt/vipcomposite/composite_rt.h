@@ -0,0 +1,57 @@
+/*
+ *  COMPOSITE_RT run clipping and SIMD macros of the compositing kernels.
+ *
+ *  Copyright 2016 The MathWorks, Inc.
+ */
+
+#ifndef composite_rt_h
+#define composite_rt_h
+
+#include <string.h>
+#include "vipcomposite_rt.h"
+
+#if defined(__ARM_NEON__) || defined(__ARM_NEON)
+#include <arm_neon.h>
+#define MWVIP_COMPOSITE_NEON 1
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define MWVIP_COMPOSITE_SSE2 1
+#endif
+
+/*
+ * Run k of the overlay, column k when there are no runs, clipped to dst.
+ * Returns 0 when nothing of it lands on dst; otherwise *srcOff and *dstOff
+ * are the offsets of its first pixel in a plane of src and of dst.
+ */
+MWVIP_INLINE boolean_T MWVIP_Composite_Run(const MWVIP_COMPOSITE_RUN *runs,
+                                           int32_T k, int_T sRows,
+                                           int_T dRows, int_T dCols,
+                                           int_T row0, int_T col0,
+                                           size_t *srcOff, size_t *dstOff,
+                                           int_T *len)
+{
+    int_T col = k, row = 0, n = sRows, r, c;
+    if (runs != NULL) {
+        col = runs[k].col;
+        row = runs[k].row;
+        n = runs[k].len;
+    }
+    c = col + col0;
+    r = row + row0;
+    if (c < 0 || c >= dCols) return 0;
+    if (r < 0) {
+        row -= r;
+        n += r;
+        r = 0;
+    }
+    if (r + n > dRows) n = dRows - r;
+    if (n <= 0) return 0;
+    *srcOff = (size_t)col*sRows + row;
+    *dstOff = (size_t)c*dRows + r;
+    *len = n;
+    return 1;
+}
+
+#endif /* composite_rt_h */
+
+/* [EOF] composite_rt.h */
@@ -0,0 +1,101 @@
+/*
+ *  COMPOSITE_U16_RT runtime function for VIPBLKS Compositing block
+ *
+ *  Blends uint16 runs with alpha in Q15. The products are formed in 32
+ *  bit lanes, from the low and high halves of the 16 bit multiplies on
+ *  SSE2, and dst*(32768-a) + src*a + 16384 stays below 2^31. SSE2 has no
+ *  unsigned 32 to 16 bit pack: the results are offset by -32768 around the
+ *  signed pack and back.
+ *
+ *  Copyright 2016 The MathWorks, Inc.
+ */
+#include "composite_rt.h"
+
+/* n pixels; alpha holds n values, or one when step is 0 */
+static void BlendRun(uint16_T *d, const uint16_T *s, const uint16_T *alpha,
+                     int_T step, int_T n)
+{
+    int_T i = 0;
+#if defined(MWVIP_COMPOSITE_SSE2)
+    const __m128i one = _mm_set1_epi16((short)32768), half = _mm_set1_epi32(16384);
+    const __m128i bias = _mm_set1_epi32(32768), flip = _mm_set1_epi16((short)0x8000);
+    __m128i a = _mm_set1_epi16((short)alpha[0]);
+    for (; i + 8 <= n; i += 8) {
+        const __m128i x = _mm_loadu_si128((const __m128i *)&d[i]);
+        const __m128i y = _mm_loadu_si128((const __m128i *)&s[i]);
+        __m128i b, xl, xh, yl, yh, lo, hi;
+        if (step) a = _mm_loadu_si128((const __m128i *)&alpha[i]);
+        b = _mm_sub_epi16(one, a);
+        xl = _mm_mullo_epi16(x, b);
+        xh = _mm_mulhi_epu16(x, b);
+        yl = _mm_mullo_epi16(y, a);
+        yh = _mm_mulhi_epu16(y, a);
+        lo = _mm_add_epi32(_mm_unpacklo_epi16(xl, xh), _mm_unpacklo_epi16(yl, yh));
+        hi = _mm_add_epi32(_mm_unpackhi_epi16(xl, xh), _mm_unpackhi_epi16(yl, yh));
+        lo = _mm_sub_epi32(_mm_srli_epi32(_mm_add_epi32(lo, half), 15), bias);
+        hi = _mm_sub_epi32(_mm_srli_epi32(_mm_add_epi32(hi, half), 15), bias);
+        _mm_storeu_si128((__m128i *)&d[i], _mm_xor_si128(_mm_packs_epi32(lo, hi), flip));
+    }
+#elif defined(MWVIP_COMPOSITE_NEON)
+    const uint16x8_t one = vdupq_n_u16(32768);
+    uint16x8_t a = vdupq_n_u16(alpha[0]);
+    for (; i + 8 <= n; i += 8) {
+        const uint16x8_t x = vld1q_u16(&d[i]);
+        const uint16x8_t y = vld1q_u16(&s[i]);
+        uint16x8_t b;
+        uint32x4_t lo, hi;
+        if (step) a = vld1q_u16(&alpha[i]);
+        b = vsubq_u16(one, a);
+        lo = vmlal_u16(vmull_u16(vget_low_u16(x), vget_low_u16(b)), vget_low_u16(y), vget_low_u16(a));
+        hi = vmlal_u16(vmull_u16(vget_high_u16(x), vget_high_u16(b)), vget_high_u16(y), vget_high_u16(a));
+        vst1q_u16(&d[i], vcombine_u16(vrshrn_n_u32(lo, 15), vrshrn_n_u32(hi, 15)));
+    }
+#endif
+    for (; i < n; i++) {
+        const uint32_T a = alpha[i*step];
+        d[i] = (uint16_T)((d[i]*(32768U - a) + s[i]*a + 16384U) >> 15);
+    }
+}
+void MWVIP_Composite_Blend_U16(uint16_T *dst, int_T dRows, int_T dCols,
+                               const uint16_T *src, int_T sRows,
+                               int_T sCols, int_T nChans,
+                               int_T row0, int_T col0,
+                               const uint16_T *alphaQ,
+                               boolean_T alphaPerPixel,
+                               const MWVIP_COMPOSITE_RUN *runs,
+                               int32_T numRuns)
+{
+    const int32_T numItems = (runs != NULL) ? numRuns : (int32_T)sCols;
+    const size_t dPlane = (size_t)dRows*dCols, sPlane = (size_t)sRows*sCols;
+    const uint16_T one = (uint16_T)(1 << MWVIP_COMPOSITE_ALPHA_BITS_U16);
+    int32_T k;
+
+    /* a uniform alpha of 0 leaves dst, one of 1 copies */
+    if (alphaQ != NULL && !alphaPerPixel) {
+        if (alphaQ[0] == 0) return;
+        if (alphaQ[0] >= one) alphaQ = NULL;
+    }
+#if defined(MWVIP_COMPOSITE_PARALLEL)
+    #pragma omp parallel for schedule(static) \
+        if ((size_t)sRows*sCols*nChans >= MWVIP_COMPOSITE_MIN_PARALLEL && numItems > 1)
+#endif
+    for (k = 0; k < numItems; k++) {
+        size_t srcOff, dstOff;
+        int_T len, ch;
+        if (!MWVIP_Composite_Run(runs, k, sRows, dRows, dCols, row0, col0,
+                                  &srcOff, &dstOff, &len)) continue;
+        for (ch = 0; ch < nChans; ch++) {
+            uint16_T *d = &dst[ch*dPlane + dstOff];
+            const uint16_T *s = &src[ch*sPlane + srcOff];
+            if (alphaQ == NULL) {
+                memcpy(d, s, len*sizeof(uint16_T));
+            } else if (alphaPerPixel) {
+                BlendRun(d, s, &alphaQ[srcOff], 1, len);
+            } else {
+                BlendRun(d, s, alphaQ, 0, len);
+            }
+        }
+    }
+}
+
+/* [EOF] composite_u16_rt.c */
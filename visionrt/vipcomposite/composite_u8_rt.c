@@ -0,0 +1,102 @@
+/*
+ *  COMPOSITE_U8_RT runtime function for VIPBLKS Compositing block
+ *
+ *  Blends uint8 runs with alpha in Q8: dst*(256-a) + src*a + 128 stays
+ *  below 2^16, so 16 bit lanes without sign hold the whole sum.
+ *
+ *  Copyright 2016 The MathWorks, Inc.
+ */
+#include "composite_rt.h"
+
+/* n pixels; alpha holds n values, or one when step is 0 */
+static void BlendRun(uint8_T *d, const uint8_T *s, const uint16_T *alpha,
+                     int_T step, int_T n)
+{
+    int_T i = 0;
+#if defined(MWVIP_COMPOSITE_SSE2)
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i one = _mm_set1_epi16(256), half = _mm_set1_epi16(128);
+    __m128i alo = _mm_set1_epi16((short)alpha[0]), ahi = alo;
+    for (; i + 16 <= n; i += 16) {
+        const __m128i x = _mm_loadu_si128((const __m128i *)&d[i]);
+        const __m128i y = _mm_loadu_si128((const __m128i *)&s[i]);
+        __m128i lo, hi;
+        if (step) {
+            alo = _mm_loadu_si128((const __m128i *)&alpha[i]);
+            ahi = _mm_loadu_si128((const __m128i *)&alpha[i+8]);
+        }
+        lo = _mm_add_epi16(_mm_mullo_epi16(_mm_unpacklo_epi8(x, zero), _mm_sub_epi16(one, alo)),
+                           _mm_mullo_epi16(_mm_unpacklo_epi8(y, zero), alo));
+        hi = _mm_add_epi16(_mm_mullo_epi16(_mm_unpackhi_epi8(x, zero), _mm_sub_epi16(one, ahi)),
+                           _mm_mullo_epi16(_mm_unpackhi_epi8(y, zero), ahi));
+        lo = _mm_srli_epi16(_mm_add_epi16(lo, half), 8);
+        hi = _mm_srli_epi16(_mm_add_epi16(hi, half), 8);
+        _mm_storeu_si128((__m128i *)&d[i], _mm_packus_epi16(lo, hi));
+    }
+#elif defined(MWVIP_COMPOSITE_NEON)
+    const uint16x8_t one = vdupq_n_u16(256);
+    uint16x8_t alo = vdupq_n_u16(alpha[0]), ahi = alo;
+    for (; i + 16 <= n; i += 16) {
+        const uint8x16_t x = vld1q_u8(&d[i]);
+        const uint8x16_t y = vld1q_u8(&s[i]);
+        uint16x8_t lo, hi;
+        if (step) {
+            alo = vld1q_u16(&alpha[i]);
+            ahi = vld1q_u16(&alpha[i+8]);
+        }
+        lo = vmlaq_u16(vmulq_u16(vmovl_u8(vget_low_u8(x)), vsubq_u16(one, alo)),
+                       vmovl_u8(vget_low_u8(y)), alo);
+        hi = vmlaq_u16(vmulq_u16(vmovl_u8(vget_high_u8(x)), vsubq_u16(one, ahi)),
+                       vmovl_u8(vget_high_u8(y)), ahi);
+        vst1q_u8(&d[i], vcombine_u8(vrshrn_n_u16(lo, 8), vrshrn_n_u16(hi, 8)));
+    }
+#endif
+    for (; i < n; i++) {
+        const uint32_T a = alpha[i*step];
+        d[i] = (uint8_T)((d[i]*(256U - a) + s[i]*a + 128U) >> 8);
+    }
+}
+
+void MWVIP_Composite_Blend_U8(uint8_T *dst, int_T dRows, int_T dCols,
+                              const uint8_T *src, int_T sRows,
+                              int_T sCols, int_T nChans,
+                              int_T row0, int_T col0,
+                              const uint16_T *alphaQ,
+                              boolean_T alphaPerPixel,
+                              const MWVIP_COMPOSITE_RUN *runs,
+                              int32_T numRuns)
+{
+    const int32_T numItems = (runs != NULL) ? numRuns : (int32_T)sCols;
+    const size_t dPlane = (size_t)dRows*dCols, sPlane = (size_t)sRows*sCols;
+    const uint16_T one = (uint16_T)(1 << MWVIP_COMPOSITE_ALPHA_BITS_U8);
+    int32_T k;
+
+    /* a uniform alpha of 0 leaves dst, one of 1 copies */
+    if (alphaQ != NULL && !alphaPerPixel) {
+        if (alphaQ[0] == 0) return;
+        if (alphaQ[0] >= one) alphaQ = NULL;
+    }
+#if defined(MWVIP_COMPOSITE_PARALLEL)
+    #pragma omp parallel for schedule(static) \
+        if ((size_t)sRows*sCols*nChans >= MWVIP_COMPOSITE_MIN_PARALLEL && numItems > 1)
+#endif
+    for (k = 0; k < numItems; k++) {
+        size_t srcOff, dstOff;
+        int_T len, ch;
+        if (!MWVIP_Composite_Run(runs, k, sRows, dRows, dCols, row0, col0,
+                                 &srcOff, &dstOff, &len)) continue;
+        for (ch = 0; ch < nChans; ch++) {
+            uint8_T *d = &dst[ch*dPlane + dstOff];
+            const uint8_T *s = &src[ch*sPlane + srcOff];
+            if (alphaQ == NULL) {
+                memcpy(d, s, len);
+            } else if (alphaPerPixel) {
+                BlendRun(d, s, &alphaQ[srcOff], 1, len);
+            } else {
+                BlendRun(d, s, alphaQ, 0, len);
+            }
+        }
+    }
+}
+
+/* [EOF] composite_u8_rt.c */
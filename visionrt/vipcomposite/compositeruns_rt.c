@@ -0,0 +1,44 @@
+/*
+ *  COMPOSITERUNS_RT runtime function for VIPBLKS Compositing block
+ *
+ *  Converts the opacity to the fixed point alpha of the blending kernels
+ *  and the mask to column runs, once for all the frames that share them.
+ *
+ *  Copyright 2016 The MathWorks, Inc.
+ */
+#include "composite_rt.h"
+
+void MWVIP_Composite_AlphaQ(const real_T *alpha, int_T n,
+                            int_T fracBits, uint16_T *alphaQ)
+{
+    const real_T one = (real_T)(1 << fracBits);
+    int_T i;
+    for (i = 0; i < n; i++) {
+        const real_T a = alpha[i];
+        alphaQ[i] = (uint16_T)((a <= 0.0) ? 0.0 : ((a >= 1.0) ? one : (real_T)(int_T)(a*one + 0.5)));
+    }
+}
+
+int32_T MWVIP_Composite_MaskRuns(const boolean_T *mask, int_T rows, int_T cols,
+                                 MWVIP_COMPOSITE_RUN *runs)
+{
+    int32_T numRuns = 0;
+    int_T r, c;
+    for (c = 0; c < cols; c++) {
+        const boolean_T *m = &mask[(size_t)c*rows];
+        for (r = 0; r < rows; ) {
+            int_T start;
+            while (r < rows && !m[r]) r++;
+            if (r == rows) break;
+            start = r;
+            while (r < rows && m[r]) r++;
+            runs[numRuns].col = (int32_T)c;
+            runs[numRuns].row = (int32_T)start;
+            runs[numRuns].len = (int32_T)(r - start);
+            numRuns++;
+        }
+    }
+    return numRuns;
+}
+
+/* [EOF] compositeruns_rt.c */
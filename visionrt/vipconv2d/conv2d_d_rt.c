@@ -0,0 +1,401 @@
+/*
+ *  CONV2D_D_RT runtime function for VIPBLKS 2-D FIR Filter block
+ *
+ *  Convolves a double precision image with the direct, separable or FFT
+ *  strategy, see vipconv2d_rt.h. All strategies are built on two
+ *  contiguous loops: the multiply-add of a scaled column into another,
+ *  and the radix-2 FFT of a column.
+ *
+ *  Copyright 2016 The MathWorks, Inc.
+ */
+#include <math.h>
+#include "conv2d_rt.h"
+#include "vipsvd_rt.h"
+
+/* y[i] += w*x[i], i < n */
+static void Axpy(real_T w, const real_T *x, real_T *y, int_T n)
+{
+    int_T i = 0;
+#if defined(MWVIP_CONV2D_SSE2)
+    const __m128d wv = _mm_set1_pd(w);
+    for (; i + 4 <= n; i += 4) {
+        const __m128d y0 = _mm_add_pd(_mm_loadu_pd(&y[i]),   _mm_mul_pd(wv, _mm_loadu_pd(&x[i])));
+        const __m128d y1 = _mm_add_pd(_mm_loadu_pd(&y[i+2]), _mm_mul_pd(wv, _mm_loadu_pd(&x[i+2])));
+        _mm_storeu_pd(&y[i],   y0);
+        _mm_storeu_pd(&y[i+2], y1);
+    }
+#endif
+    for (; i < n; i++) {
+        y[i] += w*x[i];
+    }
+}
+
+/* y[i] += w*x[i + shift] for the i < n that read inside x[0 .. xSize-1] */
+static void AxpyShifted(real_T w, const real_T *x, int_T xSize, int_T shift,
+                        real_T *y, int_T n)
+{
+    const int_T lo = (shift < 0) ? -shift : 0;
+    const int_T hi = (xSize - shift < n) ? xSize - shift : n;
+    if (w != 0.0 && hi > lo) {
+        Axpy(w, &x[lo + shift], &y[lo], hi - lo);
+    }
+}
+
+/* ------------------------------------------------------------------ */
+/* direct                                                              */
+/* ------------------------------------------------------------------ */
+
+static void ConvDirect(const real_T *in, int_T inRows, int_T inCols,
+                       const real_T *k, int_T kRows, int_T kCols,
+                       real_T *out, int_T outRows, int_T outCols,
+                       int_T offRows, int_T offCols)
+{
+    int_T j;
+#if defined(MWVIP_CONV2D_PARALLEL)
+    #pragma omp parallel for schedule(static) \
+        if ((real_T)outRows*outCols*kRows*kCols >= MWVIP_CONV2D_MIN_PARALLEL)
+#endif
+    for (j = 0; j < outCols; j++) {
+        real_T *y = &out[(size_t)j*outRows];
+        int_T a, b, i;
+        for (i = 0; i < outRows; i++) y[i] = 0.0;
+        for (b = 0; b < kCols; b++) {
+            const int_T q = j + offCols - b;
+            if (q < 0 || q >= inCols) continue;
+            for (a = 0; a < kRows; a++) {
+                AxpyShifted(k[b*kRows + a], &in[(size_t)q*inRows], inRows,
+                            offRows - a, y, outRows);
+            }
+        }
+    }
+}
+
+/* ------------------------------------------------------------------ */
+/* separable                                                           */
+/* ------------------------------------------------------------------ */
+
+/*
+ * The kernel as rank column-times-row terms: u holds the kRows-long
+ * columns scaled by the singular values, v the kCols-long rows. Returns
+ * the rank, 0 when the SVD failed, -1 when out of memory.
+ */
+static int_T Factorize(const real_T *k, int_T kRows, int_T kCols,
+                       real_T *u, real_T *v)
+{
+    const boolean_T tall = (boolean_T)(kRows >= kCols);
+    const int_T n = tall ? kRows : kCols;
+    const int_T p = tall ? kCols : kRows;
+    real_T *x = (real_T *)malloc(((size_t)n*p + (size_t)p*p + p)*sizeof(real_T));
+    real_T *vs, *s;
+    int_T a, b, t, rank = 0;
+
+    if (x == NULL) return -1;
+    vs = x + (size_t)n*p;
+    s = vs + (size_t)p*p;
+    /* x is the kernel, or its transpose, so that n >= p */
+    for (b = 0; b < kCols; b++) {
+        for (a = 0; a < kRows; a++) {
+            x[tall ? b*kRows + a : a*kCols + b] = k[b*kRows + a];
+        }
+    }
+    if (MWVIP_SVD_Jacobi_D(x, n, p, s, vs, 1) == 0) {
+        /* x = U, kernel = U S V' or (U S V')' */
+        while (rank < p && s[rank] > s[0]*n*EPS_real_T) rank++;
+        for (t = 0; t < rank; t++) {
+            for (a = 0; a < kRows; a++) {
+                u[t*kRows + a] = s[t]*(tall ? x[t*n + a] : vs[t*p + a]);
+            }
+            for (b = 0; b < kCols; b++) {
+                v[t*kCols + b] = tall ? vs[t*p + b] : x[t*n + b];
+            }
+        }
+    }
+    free(x);
+    return rank;
+}
+
+static boolean_T ConvSeparable(const real_T *in, int_T inRows, int_T inCols,
+                               const real_T *u, const real_T *v, int_T rank,
+                               int_T kRows, int_T kCols,
+                               real_T *out, int_T outRows, int_T outCols,
+                               int_T offRows, int_T offCols)
+{
+#if defined(MWVIP_CONV2D_PARALLEL)
+    const boolean_T parallel = (boolean_T)((real_T)outRows*outCols*(kRows + kCols) >=
+                                           MWVIP_CONV2D_MIN_PARALLEL);
+#endif
+    /* the input columns the output columns reach */
+    const int_T q0 = (offCols - kCols + 1 > 0) ? offCols - kCols + 1 : 0;
+    const int_T q1 = (outCols + offCols < inCols) ? outCols + offCols : inCols;
+    real_T *tmp;
+    int_T t, q, j;
+
+    for (j = 0; j < outRows*outCols; j++) out[j] = 0.0;
+    if (q1 <= q0) return 1;
+    tmp = (real_T *)malloc((size_t)outRows*(q1 - q0)*sizeof(real_T));
+    if (tmp == NULL) return 0;
+
+    for (t = 0; t < rank; t++) {
+        const real_T *ut = &u[t*kRows];
+        const real_T *vt = &v[t*kCols];
+        /* the column filter on the input columns */
+#if defined(MWVIP_CONV2D_PARALLEL)
+        #pragma omp parallel for schedule(static) if (parallel)
+#endif
+        for (q = q0; q < q1; q++) {
+            real_T *y = &tmp[(size_t)(q - q0)*outRows];
+            int_T a, i;
+            for (i = 0; i < outRows; i++) y[i] = 0.0;
+            for (a = 0; a < kRows; a++) {
+                AxpyShifted(ut[a], &in[(size_t)q*inRows], inRows, offRows - a, y, outRows);
+            }
+        }
+        /* the row filter across them */
+#if defined(MWVIP_CONV2D_PARALLEL)
+        #pragma omp parallel for schedule(static) if (parallel)
+#endif
+        for (j = 0; j < outCols; j++) {
+            int_T b;
+            for (b = 0; b < kCols; b++) {
+                const int_T c = j + offCols - b;
+                if (c < q0 || c >= q1 || vt[b] == 0.0) continue;
+                Axpy(vt[b], &tmp[(size_t)(c - q0)*outRows], &out[(size_t)j*outRows], outRows);
+            }
+        }
+    }
+    free(tmp);
+    return 1;
+}
+
+/* ------------------------------------------------------------------ */
+/* FFT                                                                 */
+/* ------------------------------------------------------------------ */
+
+/* e^(-2 pi i m/n), m < n/2 */
+static void Twiddles(int_T n, real_T *wr, real_T *wi)
+{
+    const real_T pi = 3.14159265358979323846;
+    int_T m;
+    for (m = 0; m < n/2; m++) {
+        wr[m] =  cos(2.0*pi*m/n);
+        wi[m] = -sin(2.0*pi*m/n);
+    }
+}
+
+/* in place forward FFT of n = 2^m points; FFT(im, re) is the inverse,
+ * not divided by n */
+static void FFT(real_T *re, real_T *im, int_T n, const real_T *wr, const real_T *wi)
+{
+    int_T i, j, m, len;
+    for (i = 1, j = 0; i < n; i++) {
+        int_T bit = n >> 1;
+        for (; j & bit; bit >>= 1) j ^= bit;
+        j ^= bit;
+        if (i < j) {
+            real_T x = re[i]; re[i] = re[j]; re[j] = x;
+            x = im[i]; im[i] = im[j]; im[j] = x;
+        }
+    }
+    for (len = 2; len <= n; len <<= 1) {
+        const int_T half = len >> 1, step = n/len;
+        for (i = 0; i < n; i += len) {
+            for (m = 0; m < half; m++) {
+                const real_T cr = wr[m*step], ci = wi[m*step];
+                const int_T p = i + m, q = p + half;
+                const real_T tr = re[q]*cr - im[q]*ci;
+                const real_T ti = re[q]*ci + im[q]*cr;
+                re[q] = re[p] - tr;
+                im[q] = im[p] - ti;
+                re[p] += tr;
+                im[p] += ti;
+            }
+        }
+    }
+}
+
+/* 2-D FFT of n1-by-n2 column major points, the rows through rowRe, rowIm */
+static void FFT2(real_T *re, real_T *im, int_T n1, int_T n2,
+                 const real_T *wr1, const real_T *wi1,
+                 const real_T *wr2, const real_T *wi2,
+                 real_T *rowRe, real_T *rowIm)
+{
+    int_T r, c;
+    for (c = 0; c < n2; c++) {
+        FFT(&re[(size_t)c*n1], &im[(size_t)c*n1], n1, wr1, wi1);
+    }
+    if (n2 == 1) return;
+    for (r = 0; r < n1; r++) {
+        for (c = 0; c < n2; c++) {
+            rowRe[c] = re[(size_t)c*n1 + r];
+            rowIm[c] = im[(size_t)c*n1 + r];
+        }
+        FFT(rowRe, rowIm, n2, wr2, wi2);
+        for (c = 0; c < n2; c++) {
+            re[(size_t)c*n1 + r] = rowRe[c];
+            im[(size_t)c*n1 + r] = rowIm[c];
+        }
+    }
+}
+
+/* the n1-by-n2 input block of a tile, zero outside the image */
+static void LoadTile(const real_T *in, int_T inRows, int_T inCols,
+                     int_T r0, int_T c0, real_T *dst, int_T n1, int_T n2)
+{
+    int_T r, c;
+    for (c = 0; c < n2; c++) {
+        real_T *y = &dst[(size_t)c*n1];
+        for (r = 0; r < n1; r++) y[r] = 0.0;
+        if (c0 + c >= 0 && c0 + c < inCols) {
+            const int_T lo = (r0 < 0) ? -r0 : 0;
+            const int_T hi = (inRows - r0 < n1) ? inRows - r0 : n1;
+            const real_T *x = &in[(size_t)(c0 + c)*inRows];
+            for (r = lo; r < hi; r++) y[r] = x[r0 + r];
+        }
+    }
+}
+
+static boolean_T ConvFFT(const real_T *in, int_T inRows, int_T inCols,
+                         const real_T *k, int_T kRows, int_T kCols,
+                         real_T *out, int_T outRows, int_T outCols,
+                         int_T offRows, int_T offCols, int_T n1, int_T n2)
+{
+    const int_T len1 = n1 - kRows + 1, len2 = n2 - kCols + 1;
+    const int_T tiles1 = (outRows + len1 - 1)/len1;
+    const int_T numTiles = tiles1*((outCols + len2 - 1)/len2);
+    const int_T numPairs = (numTiles + 1)/2;
+    const size_t points = (size_t)n1*n2;
+    real_T *kRe = (real_T *)malloc((2*points + n1 + n2 + 2*(size_t)n2)*sizeof(real_T));
+    real_T *kIm, *wr1, *wi1, *wr2, *wi2;
+    boolean_T ok = 1;
+    int_T pair;
+
+    if (kRe == NULL) return 0;
+    kIm = kRe + points;
+    wr1 = kIm + points;
+    wi1 = wr1 + n1/2;
+    wr2 = wi1 + n1/2;
+    wi2 = wr2 + n2/2;
+    Twiddles(n1, wr1, wi1);
+    Twiddles(n2, wr2, wi2);
+
+    /* spectrum of the kernel, with the 1/(n1*n2) of the inverse FFT */
+    {
+        size_t m;
+        int_T a, b;
+        for (m = 0; m < points; m++) kRe[m] = kIm[m] = 0.0;
+        for (b = 0; b < kCols; b++) {
+            for (a = 0; a < kRows; a++) {
+                kRe[(size_t)b*n1 + a] = k[b*kRows + a]/(real_T)points;
+            }
+        }
+        /* the row buffers of the twiddle block are free until the tiles */
+        FFT2(kRe, kIm, n1, n2, wr1, wi1, wr2, wi2, wi2 + n2/2, wi2 + n2/2 + n2);
+    }
+
+#if defined(MWVIP_CONV2D_PARALLEL)
+    #pragma omp parallel if ((real_T)outRows*outCols*kRows*kCols >= MWVIP_CONV2D_MIN_PARALLEL) \
+        reduction(&&:ok)
+#endif
+    {
+        real_T *re = (real_T *)malloc((2*points + 2*(size_t)n2)*sizeof(real_T));
+        real_T *im = (re != NULL) ? re + points : NULL;
+        if (re == NULL) ok = 0;
+#if defined(MWVIP_CONV2D_PARALLEL)
+        #pragma omp for schedule(dynamic, 1)
+#endif
+        for (pair = 0; pair < numPairs; pair++) {
+            int_T h, m;
+            if (re == NULL) continue;
+            /* tile 2*pair in the real part, 2*pair+1 in the imaginary part */
+            for (h = 0; h < 2; h++) {
+                const int_T tile = 2*pair + h;
+                real_T *dst = h ? im : re;
+                if (tile < numTiles) {
+                    const int_T i0 = (tile % tiles1)*len1, j0 = (tile / tiles1)*len2;
+                    LoadTile(in, inRows, inCols, i0 + offRows - kRows + 1,
+                             j0 + offCols - kCols + 1, dst, n1, n2);
+                } else {
+                    for (m = 0; m < (int_T)points; m++) dst[m] = 0.0;
+                }
+            }
+            FFT2(re, im, n1, n2, wr1, wi1, wr2, wi2, im + points, im + points + n2);
+            for (m = 0; m < (int_T)points; m++) {
+                const real_T x = re[m]*kRe[m] - im[m]*kIm[m];
+                im[m] = re[m]*kIm[m] + im[m]*kRe[m];
+                re[m] = x;
+            }
+            FFT2(im, re, n1, n2, wr1, wi1, wr2, wi2, im + points, im + points + n2);
+            /* the last len1-by-len2 points are the outputs of the tile */
+            for (h = 0; h < 2 && 2*pair + h < numTiles; h++) {
+                const int_T tile = 2*pair + h;
+                const int_T i0 = (tile % tiles1)*len1, j0 = (tile / tiles1)*len2;
+                const int_T rows = (outRows - i0 < len1) ? outRows - i0 : len1;
+                const int_T cols = (outCols - j0 < len2) ? outCols - j0 : len2;
+                const real_T *src = h ? im : re;
+                int_T r, c;
+                for (c = 0; c < cols; c++) {
+                    const real_T *x = &src[(size_t)(c + kCols - 1)*n1 + kRows - 1];
+                    real_T *y = &out[(size_t)(j0 + c)*outRows + i0];
+                    for (r = 0; r < rows; r++) y[r] = x[r];
+                }
+            }
+        }
+        free(re);
+    }
+    free(kRe);
+    return ok;
+}
+
+/* ------------------------------------------------------------------ */
+
+int_T MWVIP_Conv2D_D(const real_T *in, int_T inRows, int_T inCols,
+                     const real_T *kernel, int_T kRows, int_T kCols,
+                     real_T *out, int_T shape, boolean_T correlate,
+                     int_T strategy)
+{
+    const int_T kSize = kRows*kCols;
+    const int_T maxRank = (kRows < kCols) ? kRows : kCols;
+    int_T outRows, outCols, offRows, offCols, n1, n2, m, rank = 0;
+    boolean_T ok = 1;
+    real_T *k, *u, *v;
+
+    MWVIP_Conv2D_Shape(inRows, kRows, shape, &outRows, &offRows);
+    MWVIP_Conv2D_Shape(inCols, kCols, shape, &outCols, &offCols);
+    if (outRows <= 0 || outCols <= 0 || kSize <= 0) {
+        for (m = 0; m < outRows*outCols; m++) out[m] = 0.0;
+        return MWVIP_CONV2D_DIRECT;
+    }
+
+    k = (real_T *)malloc((kSize + (size_t)maxRank*(kRows + kCols))*sizeof(real_T));
+    if (k == NULL) return -1;
+    u = k + kSize;
+    v = u + (size_t)maxRank*kRows;
+    for (m = 0; m < kSize; m++) {
+        k[m] = correlate ? kernel[kSize - 1 - m] : kernel[m];
+    }
+
+    if (strategy == MWVIP_CONV2D_AUTO || strategy == MWVIP_CONV2D_SEPARABLE) {
+        rank = Factorize(k, kRows, kCols, u, v);
+        if (rank < 0) {
+            free(k);
+            return -1;
+        }
+    }
+    strategy = MWVIP_Conv2D_Plan(inRows, inCols, kRows, kCols, shape, rank, strategy, &n1, &n2);
+
+    if (strategy == MWVIP_CONV2D_SEPARABLE) {
+        ok = ConvSeparable(in, inRows, inCols, u, v, rank, kRows, kCols,
+                           out, outRows, outCols, offRows, offCols);
+    } else if (strategy == MWVIP_CONV2D_FFT) {
+        ok = ConvFFT(in, inRows, inCols, k, kRows, kCols,
+                     out, outRows, outCols, offRows, offCols, n1, n2);
+    } else {
+        strategy = MWVIP_CONV2D_DIRECT;
+        ConvDirect(in, inRows, inCols, k, kRows, kCols,
+                   out, outRows, outCols, offRows, offCols);
+    }
+    free(k);
+    return ok ? strategy : -1;
+}
+
+/* [EOF] conv2d_d_rt.c */
@@ -0,0 +1,93 @@
+/*
+ *  CONV2D_PLAN_RT runtime function for VIPBLKS 2-D FIR Filter block
+ *
+ *  Picks the convolution strategy from the sizes of the image, of the
+ *  kernel and of the output, and the rank of the kernel. The costs are
+ *  counted in multiply-adds of the direct path:
+ *   direct     outRows*outCols*kRows*kCols
+ *   separable  rank*(outRows*inCols*kRows + outRows*outCols*kCols), the
+ *              column filter running on every input column
+ *   FFT        per pair of tiles of P points, a forward and an inverse
+ *              2-D FFT of (P/2)log2(P) butterflies each, and the P complex
+ *              products with the kernel spectrum
+ *  The FFT sizes are searched from the smallest power of two holding the
+ *  kernel to the smallest holding the whole full convolution.
+ *
+ *  Copyright 2016 The MathWorks, Inc.
+ */
+#include <math.h>
+#include "conv2d_rt.h"
+
+static int_T NextPow2(int_T n)
+{
+    int_T p = 1;
+    while (p < n) p <<= 1;
+    return p;
+}
+
+static real_T FFTCost(int_T outRows, int_T outCols, int_T kRows, int_T kCols,
+                      int_T n1, int_T n2)
+{
+    const real_T numTiles = (real_T)((outRows + n1 - kRows)/(n1 - kRows + 1)) *
+                            (real_T)((outCols + n2 - kCols)/(n2 - kCols + 1));
+    const real_T points = (real_T)n1*n2;
+    const real_T log2p = log((real_T)points)/log(2.0);
+    return floor((numTiles + 1.0)/2.0) *
+           (points*log2p*MWVIP_CONV2D_FFT_WEIGHT + 4.0*points);
+}
+
+int_T MWVIP_Conv2D_Plan(int_T inRows, int_T inCols, int_T kRows, int_T kCols,
+                        int_T shape, int_T rank, int_T strategy,
+                        int_T *fftRows, int_T *fftCols)
+{
+    int_T outRows, outCols, offset, n1, n2;
+    real_T best, cost;
+
+    MWVIP_Conv2D_Shape(inRows, kRows, shape, &outRows, &offset);
+    MWVIP_Conv2D_Shape(inCols, kCols, shape, &outCols, &offset);
+
+    /* the FFT sizes, needed by the FFT strategy whoever picked it */
+    best = -1.0;
+    *fftRows = NextPow2(kRows);
+    *fftCols = NextPow2(kCols);
+    if (outRows > 0 && outCols > 0) {
+        const int_T max1 = NextPow2(outRows + kRows - 1);
+        const int_T max2 = NextPow2(outCols + kCols - 1);
+        for (n1 = NextPow2(kRows); n1 <= max1; n1 <<= 1) {
+            for (n2 = NextPow2(kCols); n2 <= max2; n2 <<= 1) {
+                cost = FFTCost(outRows, outCols, kRows, kCols, n1, n2);
+                if (best < 0.0 || cost < best) {
+                    best = cost;
+                    *fftRows = n1;
+                    *fftCols = n2;
+                }
+            }
+        }
+    }
+
+    if (strategy == MWVIP_CONV2D_SEPARABLE && rank <= 0) {
+        return MWVIP_CONV2D_DIRECT;
+    }
+    if (strategy != MWVIP_CONV2D_AUTO) {
+        return strategy;
+    }
+    if (outRows <= 0 || outCols <= 0) {
+        return MWVIP_CONV2D_DIRECT;
+    }
+
+    strategy = MWVIP_CONV2D_FFT;
+    cost = (real_T)outRows*outCols*kRows*kCols;
+    if (cost <= best) {
+        best = cost;
+        strategy = MWVIP_CONV2D_DIRECT;
+    }
+    if (rank > 0) {
+        cost = (real_T)rank*((real_T)outRows*inCols*kRows + (real_T)outRows*outCols*kCols);
+        if (cost < best) {
+            strategy = MWVIP_CONV2D_SEPARABLE;
+        }
+    }
+    return strategy;
+}
+
+/* [EOF] conv2d_plan_rt.c */
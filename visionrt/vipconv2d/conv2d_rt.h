@@ -0,0 +1,43 @@
+/*
+ *  CONV2D_RT output shapes and SIMD macros of the 2-D convolution kernels.
+ *
+ *  Copyright 2016 The MathWorks, Inc.
+ */
+
+#ifndef conv2d_rt_h
+#define conv2d_rt_h
+
+#include <stdlib.h>
+#include "vipconv2d_rt.h"
+
+#if defined(__ARM_NEON__) || defined(__ARM_NEON)
+#include <arm_neon.h>
+#define MWVIP_CONV2D_NEON 1
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define MWVIP_CONV2D_SSE2 1
+#endif
+
+/*
+ * Size of the output along one dimension, and the index in the full
+ * convolution of its first element: full convolution index i holds
+ * sum over a of kernel(a) * in(i - a).
+ */
+MWVIP_INLINE void MWVIP_Conv2D_Shape(int_T inSize, int_T kSize, int_T shape,
+                                     int_T *outSize, int_T *offset)
+{
+    if (shape == MWVIP_CONV2D_SAME) {
+        *outSize = inSize;
+        *offset  = kSize/2;
+    } else if (shape == MWVIP_CONV2D_VALID) {
+        *outSize = (inSize >= kSize) ? inSize - kSize + 1 : 0;
+        *offset  = kSize - 1;
+    } else {
+        *outSize = (inSize > 0) ? inSize + kSize - 1 : 0;
+        *offset  = 0;
+    }
+}
+
+#endif /* conv2d_rt_h */
+
+/* [EOF] conv2d_rt.h */
@@ -0,0 +1,117 @@
+/*
+ *  cpufeatures_rt.c
+ *
+ *  Run-time detection of the instruction sets: CPUID and XGETBV on x86,
+ *  the auxiliary vector (HWCAP) on 32-bit ARM Linux. NEON is part of the
+ *  AArch64 base architecture.
+ *
+ *  Copyright 2016 The MathWorks, Inc.
+ */
+#include "vipcpu_rt.h"
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define MWVIP_CPU_X86 1
+#if defined(_MSC_VER)
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#define MWVIP_CPU_ARM64 1
+#elif defined(__arm__) && defined(__linux__)
+#define MWVIP_CPU_ARM_LINUX 1
+#include <sys/auxv.h>
+#ifndef HWCAP_NEON
+#define HWCAP_NEON (1 << 12)
+#endif
+#endif
+
+#if defined(MWVIP_CPU_X86)
+static void cpuid(uint32_T leaf, uint32_T subleaf, uint32_T *r)
+{
+#if defined(_MSC_VER)
+    int regs[4];
+    __cpuidex(regs, (int)leaf, (int)subleaf);
+    r[0] = (uint32_T)regs[0]; r[1] = (uint32_T)regs[1];
+    r[2] = (uint32_T)regs[2]; r[3] = (uint32_T)regs[3];
+#else
+    unsigned int a, b, c, d;
+    __cpuid_count(leaf, subleaf, a, b, c, d);
+    r[0] = a; r[1] = b; r[2] = c; r[3] = d;
+#endif
+}
+
+/* register state enabled by the operating system (XCR0) */
+static uint32_T xgetbv0(void)
+{
+#if defined(_MSC_VER)
+    return (uint32_T)_xgetbv(0);
+#else
+    uint32_T lo, hi;
+    __asm__ __volatile__ ("xgetbv" : "=a"(lo), "=d"(hi) : "c"(0));
+    (void)hi;
+    return lo;
+#endif
+}
+
+static uint32_T detectFeatures(void)
+{
+    uint32_T r[4], maxLeaf, xcr0 = 0, f = 0;
+    cpuid(0, 0, r);
+    maxLeaf = r[0];
+    if (maxLeaf < 1) return 0;
+
+    cpuid(1, 0, r);
+    if (r[3] & (1U << 26)) f |= MWVIP_CPU_SSE2;
+    if (r[2] & (1U << 20)) f |= MWVIP_CPU_SSE42;
+    if (r[2] & (1U << 23)) f |= MWVIP_CPU_POPCNT;
+    /* OSXSAVE: the OS saves the YMM (and ZMM) state */
+    if (r[2] & (1U << 27)) xcr0 = xgetbv0();
+    if ((r[2] & (1U << 28)) && (xcr0 & 0x6U) == 0x6U) {
+        f |= MWVIP_CPU_AVX;
+        if (r[2] & (1U << 12)) f |= MWVIP_CPU_FMA;
+        if (maxLeaf >= 7) {
+            cpuid(7, 0, r);
+            if (r[1] & (1U << 5)) f |= MWVIP_CPU_AVX2;
+            if ((xcr0 & 0xE6U) == 0xE6U) {
+                if (r[1] & (1U << 16)) f |= MWVIP_CPU_AVX512F;
+                if (r[1] & (1U << 30)) f |= MWVIP_CPU_AVX512BW;
+            }
+        }
+    }
+    return f;
+}
+#elif defined(MWVIP_CPU_ARM64)
+static uint32_T detectFeatures(void)
+{
+    return MWVIP_CPU_NEON;
+}
+#elif defined(MWVIP_CPU_ARM_LINUX)
+static uint32_T detectFeatures(void)
+{
+    return (getauxval(AT_HWCAP) & HWCAP_NEON) ? MWVIP_CPU_NEON : 0U;
+}
+#else
+static uint32_T detectFeatures(void)
+{
+    return 0U;
+}
+#endif
+
+/* the detection gives the same result on every thread, so concurrent
+ * first calls only repeat it */
+static volatile uint32_T cpuFeatures = 0U;
+static volatile int_T    cpuFeaturesKnown = 0;
+
+LIBMWVISIONRT_API uint32_T MWVIP_CpuFeatures(void)
+{
+#if defined(MWVIP_CPU_DISPATCH_OFF)
+    return 0U;
+#else
+    if (!cpuFeaturesKnown) {
+        cpuFeatures = detectFeatures();
+        cpuFeaturesKnown = 1;
+    }
+    return cpuFeatures;
+#endif
+}
@@ -0,0 +1,176 @@
+/*
+ *  DCT8X8_U8_RT runtime function for VIPBLKS 2-D DCT block
+ *
+ *  Transforms the 8-by-8 blocks of a uint8 frame after the level shift of
+ *  128, which keeps the sums of both passes within 16 bits; the shift comes
+ *  back as 1024 on the DC coefficient. The second pass also removes the
+ *  factor 8 the passes leave on the coefficients, rounding only once.
+ *
+ *  Copyright 2016 The MathWorks, Inc.
+ */
+#include "dct_rt.h"
+
+#define PASS2_BITS (MWVIP_DCT_PASS1_BITS + 3)
+
+#if defined(MWVIP_DCT_SSE2) || defined(MWVIP_DCT_NEON)
+
+/* 1-D DCT across the 8 vectors, each lane a line of the block */
+MWVIP_INLINE void FdctPass(MWVIP_DCT_V16 *d, boolean_T pass1)
+{
+    const int_T n = pass1 ? MWVIP_DCT_CONST_BITS - MWVIP_DCT_PASS1_BITS
+                          : MWVIP_DCT_CONST_BITS + PASS2_BITS;
+    const MWVIP_DCT_V16 t0 = MWVIP_DCT_ADD(d[0], d[7]), t7 = MWVIP_DCT_SUB(d[0], d[7]);
+    const MWVIP_DCT_V16 t1 = MWVIP_DCT_ADD(d[1], d[6]), t6 = MWVIP_DCT_SUB(d[1], d[6]);
+    const MWVIP_DCT_V16 t2 = MWVIP_DCT_ADD(d[2], d[5]), t5 = MWVIP_DCT_SUB(d[2], d[5]);
+    const MWVIP_DCT_V16 t3 = MWVIP_DCT_ADD(d[3], d[4]), t4 = MWVIP_DCT_SUB(d[3], d[4]);
+    const MWVIP_DCT_V16 t10 = MWVIP_DCT_ADD(t0, t3), t13 = MWVIP_DCT_SUB(t0, t3);
+    const MWVIP_DCT_V16 t11 = MWVIP_DCT_ADD(t1, t2), t12 = MWVIP_DCT_SUB(t1, t2);
+    const MWVIP_DCT_V16 z3 = MWVIP_DCT_ADD(t4, t6), z4 = MWVIP_DCT_ADD(t5, t7);
+    MWVIP_DCT_V32 z3r, z4r;
+
+    /* |t10 + t11| <= 8*4096 */
+#if defined(MWVIP_DCT_SSE2)
+    if (pass1) {
+        d[0] = _mm_slli_epi16(_mm_add_epi16(t10, t11), MWVIP_DCT_PASS1_BITS);
+        d[4] = _mm_slli_epi16(_mm_sub_epi16(t10, t11), MWVIP_DCT_PASS1_BITS);
+    } else {
+        const __m128i r = _mm_set1_epi16(1 << (PASS2_BITS - 1));
+        d[0] = _mm_srai_epi16(_mm_add_epi16(_mm_add_epi16(t10, t11), r), PASS2_BITS);
+        d[4] = _mm_srai_epi16(_mm_add_epi16(_mm_sub_epi16(t10, t11), r), PASS2_BITS);
+    }
+#else
+    if (pass1) {
+        d[0] = vshlq_n_s16(vaddq_s16(t10, t11), MWVIP_DCT_PASS1_BITS);
+        d[4] = vshlq_n_s16(vsubq_s16(t10, t11), MWVIP_DCT_PASS1_BITS);
+    } else {
+        d[0] = vrshrq_n_s16(vaddq_s16(t10, t11), PASS2_BITS);
+        d[4] = vrshrq_n_s16(vsubq_s16(t10, t11), PASS2_BITS);
+    }
+#endif
+    d[2] = MWVIP_DCT_NarrowV(MWVIP_DCT_Dot(t13, t12,
+                                           MWVIP_DCT_FIX_0_541196100 + MWVIP_DCT_FIX_0_765366865,
+                                           MWVIP_DCT_FIX_0_541196100), n);
+    d[6] = MWVIP_DCT_NarrowV(MWVIP_DCT_Dot(t13, t12, MWVIP_DCT_FIX_0_541196100,
+                                           MWVIP_DCT_FIX_0_541196100 - MWVIP_DCT_FIX_1_847759065), n);
+
+    z3r = MWVIP_DCT_Dot(z3, z4, MWVIP_DCT_FIX_1_175875602 - MWVIP_DCT_FIX_1_961570560,
+                        MWVIP_DCT_FIX_1_175875602);
+    z4r = MWVIP_DCT_Dot(z3, z4, MWVIP_DCT_FIX_1_175875602,
+                        MWVIP_DCT_FIX_1_175875602 - MWVIP_DCT_FIX_0_390180644);
+    d[7] = MWVIP_DCT_NarrowV(MWVIP_DCT_Add32(MWVIP_DCT_Dot(t4, t7,
+                                 MWVIP_DCT_FIX_0_298631336 - MWVIP_DCT_FIX_0_899976223,
+                                 -MWVIP_DCT_FIX_0_899976223), z3r), n);
+    d[1] = MWVIP_DCT_NarrowV(MWVIP_DCT_Add32(MWVIP_DCT_Dot(t4, t7, -MWVIP_DCT_FIX_0_899976223,
+                                 MWVIP_DCT_FIX_1_501321110 - MWVIP_DCT_FIX_0_899976223), z4r), n);
+    d[5] = MWVIP_DCT_NarrowV(MWVIP_DCT_Add32(MWVIP_DCT_Dot(t5, t6,
+                                 MWVIP_DCT_FIX_2_053119869 - MWVIP_DCT_FIX_2_562915447,
+                                 -MWVIP_DCT_FIX_2_562915447), z4r), n);
+    d[3] = MWVIP_DCT_NarrowV(MWVIP_DCT_Add32(MWVIP_DCT_Dot(t5, t6, -MWVIP_DCT_FIX_2_562915447,
+                                 MWVIP_DCT_FIX_3_072711026 - MWVIP_DCT_FIX_2_562915447), z3r), n);
+}
+
+static void FdctBlock(const uint8_T *in, int16_T *out, int_T rows)
+{
+    MWVIP_DCT_V16 d[8];
+    int_T j;
+#if defined(MWVIP_DCT_SSE2)
+    const __m128i zero = _mm_setzero_si128(), shift = _mm_set1_epi16(128);
+    for (j = 0; j < 8; j++) {
+        d[j] = _mm_sub_epi16(_mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *)&in[j*rows]),
+                                               zero), shift);
+    }
+#else
+    const uint8x8_t shift = vdup_n_u8(128);
+    for (j = 0; j < 8; j++) {
+        d[j] = vreinterpretq_s16_u16(vsubl_u8(vld1_u8(&in[j*rows]), shift));
+    }
+#endif
+    FdctPass(d, 1);
+    MWVIP_DCT_Transpose(d);
+    FdctPass(d, 0);
+    MWVIP_DCT_Transpose(d);
+#if defined(MWVIP_DCT_SSE2)
+    d[0] = _mm_add_epi16(d[0], _mm_cvtsi32_si128(MWVIP_DCT_DC_SHIFT));
+    for (j = 0; j < 8; j++) _mm_storeu_si128((__m128i *)&out[j*rows], d[j]);
+#else
+    d[0] = vsetq_lane_s16((int16_T)(vgetq_lane_s16(d[0], 0) + MWVIP_DCT_DC_SHIFT), d[0], 0);
+    for (j = 0; j < 8; j++) vst1q_s16(&out[j*rows], d[j]);
+#endif
+}
+
+#else
+
+/* 1-D DCT of x[0], x[xs], ..., x[7*xs] into y[0], y[ys], ... */
+static void Fdct1(const int32_T *x, int_T xs, int32_T *y, int_T ys, boolean_T pass1)
+{
+    const int_T n = pass1 ? MWVIP_DCT_CONST_BITS - MWVIP_DCT_PASS1_BITS
+                          : MWVIP_DCT_CONST_BITS + PASS2_BITS;
+    const int32_T t0 = x[0] + x[7*xs], t7 = x[0] - x[7*xs];
+    const int32_T t1 = x[xs] + x[6*xs], t6 = x[xs] - x[6*xs];
+    const int32_T t2 = x[2*xs] + x[5*xs], t5 = x[2*xs] - x[5*xs];
+    const int32_T t3 = x[3*xs] + x[4*xs], t4 = x[3*xs] - x[4*xs];
+    const int32_T t10 = t0 + t3, t13 = t0 - t3;
+    const int32_T t11 = t1 + t2, t12 = t1 - t2;
+    const int32_T z3 = t4 + t6, z4 = t5 + t7;
+    int32_T z3r, z4r;
+
+    if (pass1) {
+        y[0]    = (t10 + t11) * (1 << MWVIP_DCT_PASS1_BITS);
+        y[4*ys] = (t10 - t11) * (1 << MWVIP_DCT_PASS1_BITS);
+    } else {
+        y[0]    = MWVIP_DCT_Narrow(t10 + t11, PASS2_BITS);
+        y[4*ys] = MWVIP_DCT_Narrow(t10 - t11, PASS2_BITS);
+    }
+    y[2*ys] = MWVIP_DCT_Narrow(t13*(MWVIP_DCT_FIX_0_541196100 + MWVIP_DCT_FIX_0_765366865) +
+                               t12*MWVIP_DCT_FIX_0_541196100, n);
+    y[6*ys] = MWVIP_DCT_Narrow(t13*MWVIP_DCT_FIX_0_541196100 +
+                               t12*(MWVIP_DCT_FIX_0_541196100 - MWVIP_DCT_FIX_1_847759065), n);
+
+    z3r = z3*(MWVIP_DCT_FIX_1_175875602 - MWVIP_DCT_FIX_1_961570560) + z4*MWVIP_DCT_FIX_1_175875602;
+    z4r = z3*MWVIP_DCT_FIX_1_175875602 + z4*(MWVIP_DCT_FIX_1_175875602 - MWVIP_DCT_FIX_0_390180644);
+    y[7*ys] = MWVIP_DCT_Narrow(t4*(MWVIP_DCT_FIX_0_298631336 - MWVIP_DCT_FIX_0_899976223) -
+                               t7*MWVIP_DCT_FIX_0_899976223 + z3r, n);
+    y[ys]   = MWVIP_DCT_Narrow(t7*(MWVIP_DCT_FIX_1_501321110 - MWVIP_DCT_FIX_0_899976223) -
+                               t4*MWVIP_DCT_FIX_0_899976223 + z4r, n);
+    y[5*ys] = MWVIP_DCT_Narrow(t5*(MWVIP_DCT_FIX_2_053119869 - MWVIP_DCT_FIX_2_562915447) -
+                               t6*MWVIP_DCT_FIX_2_562915447 + z4r, n);
+    y[3*ys] = MWVIP_DCT_Narrow(t6*(MWVIP_DCT_FIX_3_072711026 - MWVIP_DCT_FIX_2_562915447) -
+                               t5*MWVIP_DCT_FIX_2_562915447 + z3r, n);
+}
+
+static void FdctBlock(const uint8_T *in, int16_T *out, int_T rows)
+{
+    int32_T x[64], w[64];
+    int_T i, j;
+    for (j = 0; j < 8; j++) {
+        for (i = 0; i < 8; i++) x[8*j + i] = (int32_T)in[j*rows + i] - 128;
+    }
+    /* along the rows of the block, then along its columns */
+    for (i = 0; i < 8; i++) Fdct1(&x[i], 8, &w[8*i], 1, 1);
+    for (j = 0; j < 8; j++) Fdct1(&w[j], 8, &x[8*j], 1, 0);
+    x[0] += MWVIP_DCT_DC_SHIFT;
+    for (j = 0; j < 8; j++) {
+        for (i = 0; i < 8; i++) out[j*rows + i] = (int16_T)x[8*j + i];
+    }
+}
+
+#endif
+
+void MWVIP_DCT8x8_U8(const uint8_T *in, int_T rows, int_T cols, int16_T *out)
+{
+    const int_T bRows = rows/8, bCols = cols/8;
+    int_T bc;
+#if defined(MWVIP_DCT_PARALLEL)
+    #pragma omp parallel for schedule(static) \
+        if ((size_t)rows*cols >= MWVIP_DCT_MIN_PARALLEL && bCols > 1)
+#endif
+    for (bc = 0; bc < bCols; bc++) {
+        int_T br;
+        for (br = 0; br < bRows; br++) {
+            const size_t off = (size_t)8*bc*rows + 8*br;
+            FdctBlock(&in[off], &out[off], rows);
+        }
+    }
+}
+
+/* [EOF] dct8x8_u8_rt.c */
@@ -0,0 +1,178 @@
+/*
+ *  DCT_RT constants and 8 lane vector operations of the 8-by-8 DCT.
+ *
+ *  A block is held as 8 vectors of 8 int16 lanes, one per column. A pass
+ *  works across the vectors, so it transforms the 8 lines of the block at
+ *  once; a transpose between the passes and one after the second bring the
+ *  coefficients back to columns. The products of the rotations are formed
+ *  in pairs, a*ka + b*kb, in 32 bit lanes and narrowed with rounding and
+ *  saturation, exactly as the C code does it.
+ *
+ *  Copyright 2016 The MathWorks, Inc.
+ */
+
+#ifndef dct_rt_h
+#define dct_rt_h
+
+#include "vipdct_rt.h"
+
+#if defined(__ARM_NEON__) || defined(__ARM_NEON)
+#include <arm_neon.h>
+#define MWVIP_DCT_NEON 1
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define MWVIP_DCT_SSE2 1
+#endif
+
+#define MWVIP_DCT_CONST_BITS 13
+#define MWVIP_DCT_PASS1_BITS 2
+
+/* cos and sin products, scaled by 2^13 */
+#define MWVIP_DCT_FIX_0_298631336  2446
+#define MWVIP_DCT_FIX_0_390180644  3196
+#define MWVIP_DCT_FIX_0_541196100  4433
+#define MWVIP_DCT_FIX_0_765366865  6270
+#define MWVIP_DCT_FIX_0_899976223  7373
+#define MWVIP_DCT_FIX_1_175875602  9633
+#define MWVIP_DCT_FIX_1_501321110  12299
+#define MWVIP_DCT_FIX_1_847759065  15137
+#define MWVIP_DCT_FIX_1_961570560  16069
+#define MWVIP_DCT_FIX_2_053119869  16819
+#define MWVIP_DCT_FIX_2_562915447  20995
+#define MWVIP_DCT_FIX_3_072711026  25172
+
+/* the coefficient saturation of the IDCT, about the level shift */
+#define MWVIP_DCT_COEF_MIN   (-1024)
+#define MWVIP_DCT_COEF_MAX   1023
+#define MWVIP_DCT_DC_SHIFT   1024
+
+/* round x/2^n to nearest and saturate to int16 */
+MWVIP_INLINE int32_T MWVIP_DCT_Narrow(int32_T x, int_T n)
+{
+    x = (x + (1 << (n - 1))) >> n;
+    return (x < -32768) ? -32768 : ((x > 32767) ? 32767 : x);
+}
+
+#if defined(MWVIP_DCT_SSE2)
+
+typedef __m128i MWVIP_DCT_V16;
+typedef struct { __m128i lo, hi; } MWVIP_DCT_V32;
+
+#define MWVIP_DCT_ADD(a, b)  _mm_add_epi16(a, b)
+#define MWVIP_DCT_SUB(a, b)  _mm_sub_epi16(a, b)
+
+/* a*ka + b*kb */
+MWVIP_INLINE MWVIP_DCT_V32 MWVIP_DCT_Dot(MWVIP_DCT_V16 a, MWVIP_DCT_V16 b,
+                                         int16_T ka, int16_T kb)
+{
+    const __m128i k = _mm_set_epi16(kb, ka, kb, ka, kb, ka, kb, ka);
+    MWVIP_DCT_V32 r;
+    r.lo = _mm_madd_epi16(_mm_unpacklo_epi16(a, b), k);
+    r.hi = _mm_madd_epi16(_mm_unpackhi_epi16(a, b), k);
+    return r;
+}
+
+MWVIP_INLINE MWVIP_DCT_V32 MWVIP_DCT_Add32(MWVIP_DCT_V32 a, MWVIP_DCT_V32 b)
+{
+    a.lo = _mm_add_epi32(a.lo, b.lo);
+    a.hi = _mm_add_epi32(a.hi, b.hi);
+    return a;
+}
+
+MWVIP_INLINE MWVIP_DCT_V32 MWVIP_DCT_Sub32(MWVIP_DCT_V32 a, MWVIP_DCT_V32 b)
+{
+    a.lo = _mm_sub_epi32(a.lo, b.lo);
+    a.hi = _mm_sub_epi32(a.hi, b.hi);
+    return a;
+}
+
+/* MWVIP_DCT_Narrow of each lane */
+MWVIP_INLINE MWVIP_DCT_V16 MWVIP_DCT_NarrowV(MWVIP_DCT_V32 a, int_T n)
+{
+    const __m128i r = _mm_set1_epi32(1 << (n - 1));
+    return _mm_packs_epi32(_mm_srai_epi32(_mm_add_epi32(a.lo, r), n),
+                           _mm_srai_epi32(_mm_add_epi32(a.hi, r), n));
+}
+
+MWVIP_INLINE void MWVIP_DCT_Transpose(MWVIP_DCT_V16 *v)
+{
+    const __m128i a0 = _mm_unpacklo_epi16(v[0], v[1]), a1 = _mm_unpackhi_epi16(v[0], v[1]);
+    const __m128i a2 = _mm_unpacklo_epi16(v[2], v[3]), a3 = _mm_unpackhi_epi16(v[2], v[3]);
+    const __m128i a4 = _mm_unpacklo_epi16(v[4], v[5]), a5 = _mm_unpackhi_epi16(v[4], v[5]);
+    const __m128i a6 = _mm_unpacklo_epi16(v[6], v[7]), a7 = _mm_unpackhi_epi16(v[6], v[7]);
+    const __m128i b0 = _mm_unpacklo_epi32(a0, a2), b1 = _mm_unpackhi_epi32(a0, a2);
+    const __m128i b2 = _mm_unpacklo_epi32(a1, a3), b3 = _mm_unpackhi_epi32(a1, a3);
+    const __m128i b4 = _mm_unpacklo_epi32(a4, a6), b5 = _mm_unpackhi_epi32(a4, a6);
+    const __m128i b6 = _mm_unpacklo_epi32(a5, a7), b7 = _mm_unpackhi_epi32(a5, a7);
+    v[0] = _mm_unpacklo_epi64(b0, b4);
+    v[1] = _mm_unpackhi_epi64(b0, b4);
+    v[2] = _mm_unpacklo_epi64(b1, b5);
+    v[3] = _mm_unpackhi_epi64(b1, b5);
+    v[4] = _mm_unpacklo_epi64(b2, b6);
+    v[5] = _mm_unpackhi_epi64(b2, b6);
+    v[6] = _mm_unpacklo_epi64(b3, b7);
+    v[7] = _mm_unpackhi_epi64(b3, b7);
+}
+
+#elif defined(MWVIP_DCT_NEON)
+
+typedef int16x8_t MWVIP_DCT_V16;
+typedef struct { int32x4_t lo, hi; } MWVIP_DCT_V32;
+
+#define MWVIP_DCT_ADD(a, b)  vaddq_s16(a, b)
+#define MWVIP_DCT_SUB(a, b)  vsubq_s16(a, b)
+
+/* a*ka + b*kb */
+MWVIP_INLINE MWVIP_DCT_V32 MWVIP_DCT_Dot(MWVIP_DCT_V16 a, MWVIP_DCT_V16 b,
+                                         int16_T ka, int16_T kb)
+{
+    MWVIP_DCT_V32 r;
+    r.lo = vmlal_n_s16(vmull_n_s16(vget_low_s16(a), ka), vget_low_s16(b), kb);
+    r.hi = vmlal_n_s16(vmull_n_s16(vget_high_s16(a), ka), vget_high_s16(b), kb);
+    return r;
+}
+
+MWVIP_INLINE MWVIP_DCT_V32 MWVIP_DCT_Add32(MWVIP_DCT_V32 a, MWVIP_DCT_V32 b)
+{
+    a.lo = vaddq_s32(a.lo, b.lo);
+    a.hi = vaddq_s32(a.hi, b.hi);
+    return a;
+}
+
+MWVIP_INLINE MWVIP_DCT_V32 MWVIP_DCT_Sub32(MWVIP_DCT_V32 a, MWVIP_DCT_V32 b)
+{
+    a.lo = vsubq_s32(a.lo, b.lo);
+    a.hi = vsubq_s32(a.hi, b.hi);
+    return a;
+}
+
+/* MWVIP_DCT_Narrow of each lane */
+MWVIP_INLINE MWVIP_DCT_V16 MWVIP_DCT_NarrowV(MWVIP_DCT_V32 a, int_T n)
+{
+    const int32x4_t s = vdupq_n_s32(-n);
+    return vcombine_s16(vqmovn_s32(vrshlq_s32(a.lo, s)), vqmovn_s32(vrshlq_s32(a.hi, s)));
+}
+
+MWVIP_INLINE void MWVIP_DCT_Transpose(MWVIP_DCT_V16 *v)
+{
+    const int16x8x2_t a0 = vtrnq_s16(v[0], v[1]), a1 = vtrnq_s16(v[2], v[3]);
+    const int16x8x2_t a2 = vtrnq_s16(v[4], v[5]), a3 = vtrnq_s16(v[6], v[7]);
+    const int32x4x2_t b0 = vtrnq_s32(vreinterpretq_s32_s16(a0.val[0]), vreinterpretq_s32_s16(a1.val[0]));
+    const int32x4x2_t b1 = vtrnq_s32(vreinterpretq_s32_s16(a0.val[1]), vreinterpretq_s32_s16(a1.val[1]));
+    const int32x4x2_t b2 = vtrnq_s32(vreinterpretq_s32_s16(a2.val[0]), vreinterpretq_s32_s16(a3.val[0]));
+    const int32x4x2_t b3 = vtrnq_s32(vreinterpretq_s32_s16(a2.val[1]), vreinterpretq_s32_s16(a3.val[1]));
+    v[0] = vreinterpretq_s16_s32(vcombine_s32(vget_low_s32(b0.val[0]), vget_low_s32(b2.val[0])));
+    v[1] = vreinterpretq_s16_s32(vcombine_s32(vget_low_s32(b1.val[0]), vget_low_s32(b3.val[0])));
+    v[2] = vreinterpretq_s16_s32(vcombine_s32(vget_low_s32(b0.val[1]), vget_low_s32(b2.val[1])));
+    v[3] = vreinterpretq_s16_s32(vcombine_s32(vget_low_s32(b1.val[1]), vget_low_s32(b3.val[1])));
+    v[4] = vreinterpretq_s16_s32(vcombine_s32(vget_high_s32(b0.val[0]), vget_high_s32(b2.val[0])));
+    v[5] = vreinterpretq_s16_s32(vcombine_s32(vget_high_s32(b1.val[0]), vget_high_s32(b3.val[0])));
+    v[6] = vreinterpretq_s16_s32(vcombine_s32(vget_high_s32(b0.val[1]), vget_high_s32(b2.val[1])));
+    v[7] = vreinterpretq_s16_s32(vcombine_s32(vget_high_s32(b1.val[1]), vget_high_s32(b3.val[1])));
+}
+
+#endif
+
+#endif /* dct_rt_h */
+
+/* [EOF] dct_rt.h */
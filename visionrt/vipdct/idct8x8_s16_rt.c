@@ -0,0 +1,177 @@
+/*
+ *  IDCT8X8_S16_RT runtime function for VIPBLKS 2-D IDCT block
+ *
+ *  Inverse transforms the 8-by-8 blocks of coefficients to uint8 pixels.
+ *  Saturated to 11 bits, the coefficients keep the 32 bit sums of both
+ *  passes from overflowing and the outputs of the first pass within 16
+ *  bits. The odd part is written as two pairs of products per output, so
+ *  that no sum of coefficients is formed in 16 bits either. The second
+ *  pass removes the factor 8 of the passes and adds back the level shift
+ *  of 128 before saturating to uint8.
+ *
+ *  Copyright 2016 The MathWorks, Inc.
+ */
+#include "dct_rt.h"
+
+#define PASS1_SHIFT (MWVIP_DCT_CONST_BITS - MWVIP_DCT_PASS1_BITS)
+#define PASS2_SHIFT (MWVIP_DCT_CONST_BITS + MWVIP_DCT_PASS1_BITS + 3)
+
+#define FIX_ONE (1 << MWVIP_DCT_CONST_BITS)
+
+/* even part: y0 +- y4 and the rotation of y2, y6 */
+#define K_EVEN_2  (MWVIP_DCT_FIX_0_541196100 + MWVIP_DCT_FIX_0_765366865)
+#define K_EVEN_6  (MWVIP_DCT_FIX_0_541196100 - MWVIP_DCT_FIX_1_847759065)
+
+/* odd part: the weights of y1, y3, y5, y7 in each of its outputs */
+#define K0_1 (MWVIP_DCT_FIX_1_175875602 - MWVIP_DCT_FIX_0_899976223)
+#define K0_3 (MWVIP_DCT_FIX_1_175875602 - MWVIP_DCT_FIX_1_961570560)
+#define K0_5 (MWVIP_DCT_FIX_1_175875602)
+#define K0_7 (MWVIP_DCT_FIX_0_298631336 - MWVIP_DCT_FIX_0_899976223 + \
+              MWVIP_DCT_FIX_1_175875602 - MWVIP_DCT_FIX_1_961570560)
+#define K1_1 (MWVIP_DCT_FIX_1_175875602 - MWVIP_DCT_FIX_0_390180644)
+#define K1_3 (MWVIP_DCT_FIX_1_175875602 - MWVIP_DCT_FIX_2_562915447)
+#define K1_5 (MWVIP_DCT_FIX_2_053119869 - MWVIP_DCT_FIX_2_562915447 + \
+              MWVIP_DCT_FIX_1_175875602 - MWVIP_DCT_FIX_0_390180644)
+#define K1_7 (MWVIP_DCT_FIX_1_175875602)
+#define K2_1 (MWVIP_DCT_FIX_1_175875602)
+#define K2_3 (MWVIP_DCT_FIX_3_072711026 - MWVIP_DCT_FIX_2_562915447 + \
+              MWVIP_DCT_FIX_1_175875602 - MWVIP_DCT_FIX_1_961570560)
+#define K2_5 (MWVIP_DCT_FIX_1_175875602 - MWVIP_DCT_FIX_2_562915447)
+#define K2_7 (MWVIP_DCT_FIX_1_175875602 - MWVIP_DCT_FIX_1_961570560)
+#define K3_1 (MWVIP_DCT_FIX_1_501321110 - MWVIP_DCT_FIX_0_899976223 + \
+              MWVIP_DCT_FIX_1_175875602 - MWVIP_DCT_FIX_0_390180644)
+#define K3_3 (MWVIP_DCT_FIX_1_175875602)
+#define K3_5 (MWVIP_DCT_FIX_1_175875602 - MWVIP_DCT_FIX_0_390180644)
+#define K3_7 (MWVIP_DCT_FIX_1_175875602 - MWVIP_DCT_FIX_0_899976223)
+
+#if defined(MWVIP_DCT_SSE2) || defined(MWVIP_DCT_NEON)
+
+/* 1-D IDCT across the 8 vectors, each lane a line of the block */
+MWVIP_INLINE void IdctPass(MWVIP_DCT_V16 *d, int_T n)
+{
+    const MWVIP_DCT_V32 t0 = MWVIP_DCT_Dot(d[0], d[4], FIX_ONE, FIX_ONE);
+    const MWVIP_DCT_V32 t1 = MWVIP_DCT_Dot(d[0], d[4], FIX_ONE, -FIX_ONE);
+    const MWVIP_DCT_V32 t2 = MWVIP_DCT_Dot(d[2], d[6], MWVIP_DCT_FIX_0_541196100, K_EVEN_6);
+    const MWVIP_DCT_V32 t3 = MWVIP_DCT_Dot(d[2], d[6], K_EVEN_2, MWVIP_DCT_FIX_0_541196100);
+    const MWVIP_DCT_V32 t10 = MWVIP_DCT_Add32(t0, t3), t13 = MWVIP_DCT_Sub32(t0, t3);
+    const MWVIP_DCT_V32 t11 = MWVIP_DCT_Add32(t1, t2), t12 = MWVIP_DCT_Sub32(t1, t2);
+    const MWVIP_DCT_V32 o0 = MWVIP_DCT_Add32(MWVIP_DCT_Dot(d[1], d[3], K0_1, K0_3),
+                                             MWVIP_DCT_Dot(d[5], d[7], K0_5, K0_7));
+    const MWVIP_DCT_V32 o1 = MWVIP_DCT_Add32(MWVIP_DCT_Dot(d[1], d[3], K1_1, K1_3),
+                                             MWVIP_DCT_Dot(d[5], d[7], K1_5, K1_7));
+    const MWVIP_DCT_V32 o2 = MWVIP_DCT_Add32(MWVIP_DCT_Dot(d[1], d[3], K2_1, K2_3),
+                                             MWVIP_DCT_Dot(d[5], d[7], K2_5, K2_7));
+    const MWVIP_DCT_V32 o3 = MWVIP_DCT_Add32(MWVIP_DCT_Dot(d[1], d[3], K3_1, K3_3),
+                                             MWVIP_DCT_Dot(d[5], d[7], K3_5, K3_7));
+
+    d[0] = MWVIP_DCT_NarrowV(MWVIP_DCT_Add32(t10, o3), n);
+    d[7] = MWVIP_DCT_NarrowV(MWVIP_DCT_Sub32(t10, o3), n);
+    d[1] = MWVIP_DCT_NarrowV(MWVIP_DCT_Add32(t11, o2), n);
+    d[6] = MWVIP_DCT_NarrowV(MWVIP_DCT_Sub32(t11, o2), n);
+    d[2] = MWVIP_DCT_NarrowV(MWVIP_DCT_Add32(t12, o1), n);
+    d[5] = MWVIP_DCT_NarrowV(MWVIP_DCT_Sub32(t12, o1), n);
+    d[3] = MWVIP_DCT_NarrowV(MWVIP_DCT_Add32(t13, o0), n);
+    d[4] = MWVIP_DCT_NarrowV(MWVIP_DCT_Sub32(t13, o0), n);
+}
+
+static void IdctBlock(const int16_T *in, uint8_T *out, int_T rows)
+{
+    MWVIP_DCT_V16 d[8];
+    int_T j;
+#if defined(MWVIP_DCT_SSE2)
+    const __m128i lo = _mm_set1_epi16(MWVIP_DCT_COEF_MIN), hi = _mm_set1_epi16(MWVIP_DCT_COEF_MAX);
+    const __m128i center = _mm_set1_epi16(128);
+    for (j = 0; j < 8; j++) d[j] = _mm_loadu_si128((const __m128i *)&in[j*rows]);
+    d[0] = _mm_subs_epi16(d[0], _mm_cvtsi32_si128(MWVIP_DCT_DC_SHIFT));
+    for (j = 0; j < 8; j++) d[j] = _mm_min_epi16(_mm_max_epi16(d[j], lo), hi);
+#else
+    const int16x8_t lo = vdupq_n_s16(MWVIP_DCT_COEF_MIN), hi = vdupq_n_s16(MWVIP_DCT_COEF_MAX);
+    const int16x8_t center = vdupq_n_s16(128);
+    for (j = 0; j < 8; j++) d[j] = vld1q_s16(&in[j*rows]);
+    d[0] = vqsubq_s16(d[0], vsetq_lane_s16(MWVIP_DCT_DC_SHIFT, vdupq_n_s16(0), 0));
+    for (j = 0; j < 8; j++) d[j] = vminq_s16(vmaxq_s16(d[j], lo), hi);
+#endif
+    IdctPass(d, PASS1_SHIFT);
+    MWVIP_DCT_Transpose(d);
+    IdctPass(d, PASS2_SHIFT);
+    MWVIP_DCT_Transpose(d);
+#if defined(MWVIP_DCT_SSE2)
+    for (j = 0; j < 8; j++) {
+        _mm_storel_epi64((__m128i *)&out[j*rows],
+                         _mm_packus_epi16(_mm_adds_epi16(d[j], center), center));
+    }
+#else
+    for (j = 0; j < 8; j++) vst1_u8(&out[j*rows], vqmovun_s16(vqaddq_s16(d[j], center)));
+#endif
+}
+
+#else
+
+/* 1-D IDCT of x[0], x[xs], ..., x[7*xs] into y[0], y[ys], ... */
+static void Idct1(const int32_T *x, int_T xs, int32_T *y, int_T ys, int_T n)
+{
+    const int32_T y0 = x[0], y1 = x[xs], y2 = x[2*xs], y3 = x[3*xs];
+    const int32_T y4 = x[4*xs], y5 = x[5*xs], y6 = x[6*xs], y7 = x[7*xs];
+    const int32_T t0 = (y0 + y4)*FIX_ONE, t1 = (y0 - y4)*FIX_ONE;
+    const int32_T t2 = y2*MWVIP_DCT_FIX_0_541196100 + y6*K_EVEN_6;
+    const int32_T t3 = y2*K_EVEN_2 + y6*MWVIP_DCT_FIX_0_541196100;
+    const int32_T t10 = t0 + t3, t13 = t0 - t3;
+    const int32_T t11 = t1 + t2, t12 = t1 - t2;
+    const int32_T o0 = y1*K0_1 + y3*K0_3 + y5*K0_5 + y7*K0_7;
+    const int32_T o1 = y1*K1_1 + y3*K1_3 + y5*K1_5 + y7*K1_7;
+    const int32_T o2 = y1*K2_1 + y3*K2_3 + y5*K2_5 + y7*K2_7;
+    const int32_T o3 = y1*K3_1 + y3*K3_3 + y5*K3_5 + y7*K3_7;
+
+    y[0]    = MWVIP_DCT_Narrow(t10 + o3, n);
+    y[7*ys] = MWVIP_DCT_Narrow(t10 - o3, n);
+    y[ys]   = MWVIP_DCT_Narrow(t11 + o2, n);
+    y[6*ys] = MWVIP_DCT_Narrow(t11 - o2, n);
+    y[2*ys] = MWVIP_DCT_Narrow(t12 + o1, n);
+    y[5*ys] = MWVIP_DCT_Narrow(t12 - o1, n);
+    y[3*ys] = MWVIP_DCT_Narrow(t13 + o0, n);
+    y[4*ys] = MWVIP_DCT_Narrow(t13 - o0, n);
+}
+
+static void IdctBlock(const int16_T *in, uint8_T *out, int_T rows)
+{
+    int32_T x[64], w[64];
+    int_T i, j;
+    for (j = 0; j < 8; j++) {
+        for (i = 0; i < 8; i++) {
+            int32_T c = in[j*rows + i];
+            if (i == 0 && j == 0) c -= MWVIP_DCT_DC_SHIFT;
+            x[8*j + i] = (c < MWVIP_DCT_COEF_MIN) ? MWVIP_DCT_COEF_MIN :
+                         ((c > MWVIP_DCT_COEF_MAX) ? MWVIP_DCT_COEF_MAX : c);
+        }
+    }
+    /* along the rows of the block, then along its columns */
+    for (i = 0; i < 8; i++) Idct1(&x[i], 8, &w[8*i], 1, PASS1_SHIFT);
+    for (j = 0; j < 8; j++) Idct1(&w[j], 8, &x[8*j], 1, PASS2_SHIFT);
+    for (j = 0; j < 8; j++) {
+        for (i = 0; i < 8; i++) {
+            const int32_T v = x[8*j + i] + 128;
+            out[j*rows + i] = (uint8_T)((v < 0) ? 0 : ((v > 255) ? 255 : v));
+        }
+    }
+}
+
+#endif
+
+void MWVIP_IDCT8x8_S16(const int16_T *in, int_T rows, int_T cols, uint8_T *out)
+{
+    const int_T bRows = rows/8, bCols = cols/8;
+    int_T bc;
+#if defined(MWVIP_DCT_PARALLEL)
+    #pragma omp parallel for schedule(static) \
+        if ((size_t)rows*cols >= MWVIP_DCT_MIN_PARALLEL && bCols > 1)
+#endif
+    for (bc = 0; bc < bCols; bc++) {
+        int_T br;
+        for (br = 0; br < bRows; br++) {
+            const size_t off = (size_t)8*bc*rows + 8*br;
+            IdctBlock(&in[off], &out[off], rows);
+        }
+    }
+}
+
+/* [EOF] idct8x8_s16_rt.c */
@@ -0,0 +1,135 @@
+/*
+ *  DEMOSAIC_RT Bayer phases, filters and SIMD helpers of the demosaicing
+ *  kernels.
+ *
+ *  All filters are kept as sums scaled by 16, so that both methods and the
+ *  pixels that keep their own color end with the same rounding shift. The
+ *  uint8 kernels compute them in 16 bit lanes and the uint16 kernels in 32
+ *  bit lanes; the scalar border pixels use the same integer arithmetic.
+ *
+ *  Copyright 2016 The MathWorks, Inc.
+ */
+
+#ifndef demosaic_rt_h
+#define demosaic_rt_h
+
+#include "vipdemosaic_rt.h"
+
+#if defined(__ARM_NEON__) || defined(__ARM_NEON)
+#include <arm_neon.h>
+#define MWVIP_DEMOSAIC_NEON 1
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define MWVIP_DEMOSAIC_SSE2 1
+#endif
+
+/* filters of a missing color, see vipdemosaic_rt.h */
+#define MWVIP_DEMOSAIC_OWN  0   /* the pixel itself */
+#define MWVIP_DEMOSAIC_G    1   /* G at R or B */
+#define MWVIP_DEMOSAIC_ROW  2   /* color of the row neighbors at G */
+#define MWVIP_DEMOSAIC_COL  3   /* color of the column neighbors at G */
+#define MWVIP_DEMOSAIC_DIAG 4   /* B at R or R at B */
+#define MWVIP_DEMOSAIC_NUM_FILTERS 5
+
+/* rows of a column demosaiced into the buffers of the gray output */
+#define MWVIP_DEMOSAIC_CHUNK 256
+
+/* rgb2gray of one pixel, rounded as rgb2gray rounds */
+#define MWVIP_DEMOSAIC_GRAY(r, g, b) (0.2989*(r) + 0.5870*(g) + 0.1140*(b) + 0.5)
+
+/* sel[ch][p] is the filter of channel ch (R, G, B) on the rows of parity p
+ * of a column of parity q */
+typedef struct {
+    int_T sel[3][2];
+} MWVIP_DEMOSAIC_PHASE;
+
+/* 0, 1, 2 for R, G, B at (p, q) of the top left 2x2 pixels */
+MWVIP_INLINE int_T MWVIP_Demosaic_ColorAt(int_T alignment, int_T p, int_T q)
+{
+    static const int_T colors[4][2][2] = {
+        {{1, 2}, {0, 1}},   /* GBRG */
+        {{1, 0}, {2, 1}},   /* GRBG */
+        {{2, 1}, {1, 0}},   /* BGGR */
+        {{0, 1}, {1, 2}}    /* RGGB */
+    };
+    if (alignment < 0 || alignment > 3) alignment = MWVIP_DEMOSAIC_RGGB;
+    return colors[alignment][p][q];
+}
+
+MWVIP_INLINE void MWVIP_Demosaic_Phase(int_T alignment, int_T q,
+                                       MWVIP_DEMOSAIC_PHASE *phase)
+{
+    int_T p, ch;
+    for (p = 0; p < 2; p++) {
+        const int_T color = MWVIP_Demosaic_ColorAt(alignment, p, q);
+        for (ch = 0; ch < 3; ch++) {
+            int_T f;
+            if (ch == color) {
+                f = MWVIP_DEMOSAIC_OWN;
+            } else if (color == 1) {
+                f = (MWVIP_Demosaic_ColorAt(alignment, p, 1-q) == ch) ?
+                    MWVIP_DEMOSAIC_ROW : MWVIP_DEMOSAIC_COL;
+            } else {
+                f = (ch == 1) ? MWVIP_DEMOSAIC_G : MWVIP_DEMOSAIC_DIAG;
+            }
+            phase->sel[ch][p] = f;
+        }
+    }
+}
+
+/* index k mirrored about the first and the last of n */
+MWVIP_INLINE int_T MWVIP_Demosaic_Reflect(int_T k, int_T n)
+{
+    if (n == 1) return 0;
+    while (k < 0 || k >= n) {
+        if (k < 0) k = -k;
+        if (k >= n) k = 2*(n-1) - k;
+    }
+    return k;
+}
+
+/* the 5 filters of one pixel, scaled by 16; h2, v2 are W+E and N+S, hh, vv
+ * WW+EE and NN+SS, d4 the sum of the diagonal neighbors */
+MWVIP_INLINE void MWVIP_Demosaic_Filters(int_T method, int32_T c, int32_T v2,
+                                         int32_T h2, int32_T vv, int32_T hh,
+                                         int32_T d4, int32_T *f)
+{
+    f[MWVIP_DEMOSAIC_OWN] = 16*c;
+    if (method == MWVIP_DEMOSAIC_GRADIENT) {
+        f[MWVIP_DEMOSAIC_G]    = 8*c + 4*(v2 + h2) - 2*(vv + hh);
+        f[MWVIP_DEMOSAIC_ROW]  = 10*c + 8*h2 - 2*hh - 2*d4 + vv;
+        f[MWVIP_DEMOSAIC_COL]  = 10*c + 8*v2 - 2*vv - 2*d4 + hh;
+        f[MWVIP_DEMOSAIC_DIAG] = 12*c + 4*d4 - 3*(vv + hh);
+    } else {
+        f[MWVIP_DEMOSAIC_G]    = 4*(v2 + h2);
+        f[MWVIP_DEMOSAIC_ROW]  = 8*h2;
+        f[MWVIP_DEMOSAIC_COL]  = 8*v2;
+        f[MWVIP_DEMOSAIC_DIAG] = 4*d4;
+    }
+}
+
+/*
+ * The same on vectors, with the lane operations ADD, SUB and SHL (shift
+ * left by a constant) of the includer; f is an array of 5 vectors.
+ */
+#define MWVIP_DEMOSAIC_SIMD_FILTERS(ADD, SUB, SHL, method, c, v2, h2, vv, hh, d4, f) \
+do { \
+    f[MWVIP_DEMOSAIC_OWN] = SHL(c, 4); \
+    if ((method) == MWVIP_DEMOSAIC_GRADIENT) { \
+        const MWVIP_DM_VEC c8 = SHL(c, 3), d2 = SHL(d4, 1), sq = ADD(vv, hh); \
+        const MWVIP_DM_VEC c10 = ADD(c8, SHL(c, 1)); \
+        f[MWVIP_DEMOSAIC_G]    = SUB(ADD(c8, SHL(ADD(v2, h2), 2)), SHL(sq, 1)); \
+        f[MWVIP_DEMOSAIC_ROW]  = ADD(SUB(SUB(ADD(c10, SHL(h2, 3)), SHL(hh, 1)), d2), vv); \
+        f[MWVIP_DEMOSAIC_COL]  = ADD(SUB(SUB(ADD(c10, SHL(v2, 3)), SHL(vv, 1)), d2), hh); \
+        f[MWVIP_DEMOSAIC_DIAG] = SUB(SUB(ADD(ADD(c8, SHL(c, 2)), SHL(d4, 2)), sq), SHL(sq, 1)); \
+    } else { \
+        f[MWVIP_DEMOSAIC_G]    = SHL(ADD(v2, h2), 2); \
+        f[MWVIP_DEMOSAIC_ROW]  = SHL(h2, 3); \
+        f[MWVIP_DEMOSAIC_COL]  = SHL(v2, 3); \
+        f[MWVIP_DEMOSAIC_DIAG] = SHL(d4, 2); \
+    } \
+} while (0)
+
+#endif /* demosaic_rt_h */
+
+/* [EOF] demosaic_rt.h */
@@ -0,0 +1,214 @@
+/*
+ *  DEMOSAIC_U16_RT runtime function for VIPBLKS Demosaic block
+ *
+ *  Demosaics a whole uint16 Bayer image, e.g. the 10 to 16 bit raw frames
+ *  of machine vision cameras. The interior pixels of a column are filtered
+ *  8 at a time in two vectors of 32 bit lanes; the two rows next to the
+ *  top and the bottom border take the scalar path with mirrored rows.
+ *
+ *  Copyright 2016 The MathWorks, Inc.
+ */
+#include "demosaic_rt.h"
+
+#if defined(MWVIP_DEMOSAIC_SSE2)
+typedef __m128i MWVIP_DM_VEC;
+#define MWVIP_DM_ADD(a, b) _mm_add_epi32((a), (b))
+#define MWVIP_DM_SUB(a, b) _mm_sub_epi32((a), (b))
+#define MWVIP_DM_SHL(a, n) _mm_slli_epi32((a), (n))
+#elif defined(MWVIP_DEMOSAIC_NEON)
+typedef int32x4_t MWVIP_DM_VEC;
+#define MWVIP_DM_ADD(a, b) vaddq_s32((a), (b))
+#define MWVIP_DM_SUB(a, b) vsubq_s32((a), (b))
+#define MWVIP_DM_SHL(a, n) vshlq_n_s32((a), (n))
+#endif
+
+static uint16_T SatU16(int32_T x)
+{
+    return (uint16_T)(x < 0 ? 0 : (x > 65535 ? 65535 : x));
+}
+
+/* one pixel of column col[2], rows mirrored about the border */
+static void DemosaicPixel(const uint16_T *const *col, int_T rows, int_T i,
+                          const MWVIP_DEMOSAIC_PHASE *phase, int_T method,
+                          uint16_T *r, uint16_T *g, uint16_T *b)
+{
+    const int_T im2 = MWVIP_Demosaic_Reflect(i-2, rows);
+    const int_T im1 = MWVIP_Demosaic_Reflect(i-1, rows);
+    const int_T ip1 = MWVIP_Demosaic_Reflect(i+1, rows);
+    const int_T ip2 = MWVIP_Demosaic_Reflect(i+2, rows);
+    const int_T p = i & 1;
+    int32_T f[MWVIP_DEMOSAIC_NUM_FILTERS];
+
+    MWVIP_Demosaic_Filters(method, col[2][i],
+                           (int32_T)col[2][im1] + col[2][ip1], (int32_T)col[1][i] + col[3][i],
+                           (int32_T)col[2][im2] + col[2][ip2], (int32_T)col[0][i] + col[4][i],
+                           (int32_T)col[1][im1] + col[1][ip1] + col[3][im1] + col[3][ip1], f);
+    *r = SatU16((f[phase->sel[0][p]] + 8) >> 4);
+    *g = SatU16((f[phase->sel[1][p]] + 8) >> 4);
+    *b = SatU16((f[phase->sel[2][p]] + 8) >> 4);
+}
+
+#if defined(MWVIP_DEMOSAIC_SSE2) || defined(MWVIP_DEMOSAIC_NEON)
+/* 8 pixels widened to two vectors of 32 bit lanes */
+static void Widen(const uint16_T *p, MWVIP_DM_VEC *v)
+{
+#if defined(MWVIP_DEMOSAIC_SSE2)
+    const __m128i x = _mm_loadu_si128((const __m128i *)p);
+    v[0] = _mm_unpacklo_epi16(x, _mm_setzero_si128());
+    v[1] = _mm_unpackhi_epi16(x, _mm_setzero_si128());
+#else
+    const uint16x8_t x = vld1q_u16(p);
+    v[0] = vreinterpretq_s32_u32(vmovl_u16(vget_low_u16(x)));
+    v[1] = vreinterpretq_s32_u32(vmovl_u16(vget_high_u16(x)));
+#endif
+}
+
+/* rows i to i+7 of column col[2], i even and 2 <= i <= rows-10 */
+static void DemosaicBlock(const uint16_T *const *col, int_T i,
+                          const MWVIP_DEMOSAIC_PHASE *phase, int_T method,
+                          uint16_T *r, uint16_T *g, uint16_T *b)
+{
+    MWVIP_DM_VEC c[2], n[2], s[2], nn[2], ss[2], w[2], e[2], ww[2], ee[2];
+    MWVIP_DM_VEC nw[2], sw[2], ne[2], se[2];
+    MWVIP_DM_VEC f[2][MWVIP_DEMOSAIC_NUM_FILTERS];
+    uint16_T *out[3];
+    int_T h, ch;
+
+    Widen(&col[2][i], c);
+    Widen(&col[2][i-1], n);
+    Widen(&col[2][i+1], s);
+    Widen(&col[2][i-2], nn);
+    Widen(&col[2][i+2], ss);
+    Widen(&col[1][i], w);
+    Widen(&col[3][i], e);
+    Widen(&col[0][i], ww);
+    Widen(&col[4][i], ee);
+    Widen(&col[1][i-1], nw);
+    Widen(&col[1][i+1], sw);
+    Widen(&col[3][i-1], ne);
+    Widen(&col[3][i+1], se);
+    for (h = 0; h < 2; h++) {
+        const MWVIP_DM_VEC v2 = MWVIP_DM_ADD(n[h], s[h]);
+        const MWVIP_DM_VEC h2 = MWVIP_DM_ADD(w[h], e[h]);
+        const MWVIP_DM_VEC vv = MWVIP_DM_ADD(nn[h], ss[h]);
+        const MWVIP_DM_VEC hh = MWVIP_DM_ADD(ww[h], ee[h]);
+        const MWVIP_DM_VEC d4 = MWVIP_DM_ADD(MWVIP_DM_ADD(nw[h], sw[h]),
+                                             MWVIP_DM_ADD(ne[h], se[h]));
+        MWVIP_DEMOSAIC_SIMD_FILTERS(MWVIP_DM_ADD, MWVIP_DM_SUB, MWVIP_DM_SHL,
+                                    method, c[h], v2, h2, vv, hh, d4, f[h]);
+    }
+
+    out[0] = r;
+    out[1] = g;
+    out[2] = b;
+    for (ch = 0; ch < 3; ch++) {
+        const int_T fe = phase->sel[ch][0], fo = phase->sel[ch][1];
+#if defined(MWVIP_DEMOSAIC_SSE2)
+        const __m128i even = _mm_set_epi32(0, -1, 0, -1);
+        const __m128i maxVal = _mm_set1_epi32(65535);
+        __m128i v[2];
+        for (h = 0; h < 2; h++) {
+            __m128i x = _mm_or_si128(_mm_and_si128(even, f[h][fe]),
+                                     _mm_andnot_si128(even, f[h][fo]));
+            __m128i m;
+            x = _mm_srai_epi32(_mm_add_epi32(x, _mm_set1_epi32(8)), 4);
+            /* saturate to [0, 65535], then pack as signed around 32768 */
+            x = _mm_and_si128(x, _mm_cmpgt_epi32(x, _mm_set1_epi32(-1)));
+            m = _mm_cmpgt_epi32(x, maxVal);
+            x = _mm_or_si128(_mm_andnot_si128(m, x), _mm_and_si128(m, maxVal));
+            v[h] = _mm_sub_epi32(x, _mm_set1_epi32(32768));
+        }
+        _mm_storeu_si128((__m128i *)out[ch],
+                         _mm_xor_si128(_mm_packs_epi32(v[0], v[1]),
+                                       _mm_set1_epi16((int16_T)0x8000)));
+#else
+        const uint32x4_t even = vreinterpretq_u32_u64(vdupq_n_u64(0x00000000FFFFFFFFULL));
+        uint16x4_t v[2];
+        for (h = 0; h < 2; h++) {
+            int32x4_t x = vbslq_s32(even, f[h][fe], f[h][fo]);
+            v[h] = vqmovun_s32(vshrq_n_s32(vaddq_s32(x, vdupq_n_s32(8)), 4));
+        }
+        vst1q_u16(out[ch], vcombine_u16(v[0], v[1]));
+#endif
+    }
+}
+#endif
+
+/* rows i0 to i1-1 of column col[2] into r, g, b */
+static void DemosaicSpan(const uint16_T *const *col, int_T rows, int_T i0, int_T i1,
+                         const MWVIP_DEMOSAIC_PHASE *phase, int_T method,
+                         uint16_T *r, uint16_T *g, uint16_T *b)
+{
+    int_T i = i0;
+    while (i < i1) {
+#if defined(MWVIP_DEMOSAIC_SSE2) || defined(MWVIP_DEMOSAIC_NEON)
+        if (i >= 2 && (i & 1) == 0 && i + 8 <= rows - 2 && i + 8 <= i1) {
+            DemosaicBlock(col, i, phase, method, &r[i-i0], &g[i-i0], &b[i-i0]);
+            i += 8;
+            continue;
+        }
+#endif
+        DemosaicPixel(col, rows, i, phase, method, &r[i-i0], &g[i-i0], &b[i-i0]);
+        i++;
+    }
+}
+
+static void DemosaicColumn(const uint16_T *in, uint16_T *rgb, uint16_T *gray,
+                           int_T rows, int_T cols, int_T j,
+                           int_T alignment, int_T method)
+{
+    const uint16_T *col[5];
+    MWVIP_DEMOSAIC_PHASE phase;
+    int_T k, i0;
+
+    for (k = 0; k < 5; k++) {
+        col[k] = &in[MWVIP_Demosaic_Reflect(j+k-2, cols)*rows];
+    }
+    MWVIP_Demosaic_Phase(alignment, j & 1, &phase);
+
+    if (gray == NULL) {
+        DemosaicSpan(col, rows, 0, rows, &phase, method, &rgb[j*rows],
+                     &rgb[(cols+j)*rows], &rgb[(2*cols+j)*rows]);
+        return;
+    }
+    /* the gray pixels from chunks of the column still in cache */
+    for (i0 = 0; i0 < rows; i0 += MWVIP_DEMOSAIC_CHUNK) {
+        const int_T i1 = (rows - i0 < MWVIP_DEMOSAIC_CHUNK) ? rows : i0 + MWVIP_DEMOSAIC_CHUNK;
+        uint16_T buf[3][MWVIP_DEMOSAIC_CHUNK];
+        uint16_T *r = buf[0], *g = buf[1], *b = buf[2];
+        int_T i;
+        if (rgb != NULL) {
+            r = &rgb[j*rows + i0];
+            g = &rgb[(cols+j)*rows + i0];
+            b = &rgb[(2*cols+j)*rows + i0];
+        }
+        DemosaicSpan(col, rows, i0, i1, &phase, method, r, g, b);
+        for (i = 0; i < i1 - i0; i++) {
+            gray[j*rows + i0 + i] = (uint16_T)MWVIP_DEMOSAIC_GRAY(r[i], g[i], b[i]);
+        }
+    }
+}
+
+LIBMWVISIONRT_API void MWVIP_Demosaic_U16(const uint16_T *in, uint16_T *rgb,
+                                          uint16_T *gray, int_T rows, int_T cols,
+                                          int_T alignment, int_T method)
+{
+    const int_T numStrips = (cols + MWVIP_DEMOSAIC_STRIP_COLS - 1)/MWVIP_DEMOSAIC_STRIP_COLS;
+    int_T s;
+
+    if ((rgb == NULL && gray == NULL) || rows <= 0) return;
+#if defined(MWVIP_DEMOSAIC_PARALLEL)
+    #pragma omp parallel for schedule(dynamic, 1) \
+        if (rows*cols >= MWVIP_DEMOSAIC_MIN_PARALLEL)
+#endif
+    for (s = 0; s < numStrips; s++) {
+        const int_T j1 = (s+1)*MWVIP_DEMOSAIC_STRIP_COLS < cols ?
+                         (s+1)*MWVIP_DEMOSAIC_STRIP_COLS : cols;
+        int_T j;
+        for (j = s*MWVIP_DEMOSAIC_STRIP_COLS; j < j1; j++) {
+            DemosaicColumn(in, rgb, gray, rows, cols, j, alignment, method);
+        }
+    }
+}
+
+/* [EOF] demosaic_u16_rt.c */
@@ -0,0 +1,172 @@
+/*
+ *  DEMOSAIC_U8_RT runtime function for VIPBLKS Demosaic block
+ *
+ *  Demosaics a whole uint8 Bayer image. The interior pixels of a column
+ *  are filtered 8 at a time in 16 bit lanes; the two rows next to the top
+ *  and the bottom border take the scalar path with mirrored rows.
+ *
+ *  Copyright 2016 The MathWorks, Inc.
+ */
+#include "demosaic_rt.h"
+
+#if defined(MWVIP_DEMOSAIC_SSE2)
+typedef __m128i MWVIP_DM_VEC;
+#define MWVIP_DM_ADD(a, b) _mm_add_epi16((a), (b))
+#define MWVIP_DM_SUB(a, b) _mm_sub_epi16((a), (b))
+#define MWVIP_DM_SHL(a, n) _mm_slli_epi16((a), (n))
+#define MWVIP_DM_LOAD(p)   _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *)(p)), \
+                                             _mm_setzero_si128())
+#elif defined(MWVIP_DEMOSAIC_NEON)
+typedef int16x8_t MWVIP_DM_VEC;
+#define MWVIP_DM_ADD(a, b) vaddq_s16((a), (b))
+#define MWVIP_DM_SUB(a, b) vsubq_s16((a), (b))
+#define MWVIP_DM_SHL(a, n) vshlq_n_s16((a), (n))
+#define MWVIP_DM_LOAD(p)   vreinterpretq_s16_u16(vmovl_u8(vld1_u8(p)))
+#endif
+
+static uint8_T SatU8(int32_T x)
+{
+    return (uint8_T)(x < 0 ? 0 : (x > 255 ? 255 : x));
+}
+
+/* one pixel of column col[2], rows mirrored about the border */
+static void DemosaicPixel(const uint8_T *const *col, int_T rows, int_T i,
+                          const MWVIP_DEMOSAIC_PHASE *phase, int_T method,
+                          uint8_T *r, uint8_T *g, uint8_T *b)
+{
+    const int_T im2 = MWVIP_Demosaic_Reflect(i-2, rows);
+    const int_T im1 = MWVIP_Demosaic_Reflect(i-1, rows);
+    const int_T ip1 = MWVIP_Demosaic_Reflect(i+1, rows);
+    const int_T ip2 = MWVIP_Demosaic_Reflect(i+2, rows);
+    const int_T p = i & 1;
+    int32_T f[MWVIP_DEMOSAIC_NUM_FILTERS];
+
+    MWVIP_Demosaic_Filters(method, col[2][i],
+                           col[2][im1] + col[2][ip1], col[1][i] + col[3][i],
+                           col[2][im2] + col[2][ip2], col[0][i] + col[4][i],
+                           col[1][im1] + col[1][ip1] + col[3][im1] + col[3][ip1], f);
+    *r = SatU8((f[phase->sel[0][p]] + 8) >> 4);
+    *g = SatU8((f[phase->sel[1][p]] + 8) >> 4);
+    *b = SatU8((f[phase->sel[2][p]] + 8) >> 4);
+}
+
+#if defined(MWVIP_DEMOSAIC_SSE2) || defined(MWVIP_DEMOSAIC_NEON)
+/* rows i to i+7 of column col[2], i even and 2 <= i <= rows-10 */
+static void DemosaicBlock(const uint8_T *const *col, int_T i,
+                          const MWVIP_DEMOSAIC_PHASE *phase, int_T method,
+                          uint8_T *r, uint8_T *g, uint8_T *b)
+{
+    const MWVIP_DM_VEC c  = MWVIP_DM_LOAD(&col[2][i]);
+    const MWVIP_DM_VEC v2 = MWVIP_DM_ADD(MWVIP_DM_LOAD(&col[2][i-1]), MWVIP_DM_LOAD(&col[2][i+1]));
+    const MWVIP_DM_VEC h2 = MWVIP_DM_ADD(MWVIP_DM_LOAD(&col[1][i]), MWVIP_DM_LOAD(&col[3][i]));
+    const MWVIP_DM_VEC vv = MWVIP_DM_ADD(MWVIP_DM_LOAD(&col[2][i-2]), MWVIP_DM_LOAD(&col[2][i+2]));
+    const MWVIP_DM_VEC hh = MWVIP_DM_ADD(MWVIP_DM_LOAD(&col[0][i]), MWVIP_DM_LOAD(&col[4][i]));
+    const MWVIP_DM_VEC d4 = MWVIP_DM_ADD(
+        MWVIP_DM_ADD(MWVIP_DM_LOAD(&col[1][i-1]), MWVIP_DM_LOAD(&col[1][i+1])),
+        MWVIP_DM_ADD(MWVIP_DM_LOAD(&col[3][i-1]), MWVIP_DM_LOAD(&col[3][i+1])));
+    uint8_T *out[3];
+    MWVIP_DM_VEC f[MWVIP_DEMOSAIC_NUM_FILTERS];
+    int_T ch;
+
+    out[0] = r;
+    out[1] = g;
+    out[2] = b;
+    MWVIP_DEMOSAIC_SIMD_FILTERS(MWVIP_DM_ADD, MWVIP_DM_SUB, MWVIP_DM_SHL,
+                                method, c, v2, h2, vv, hh, d4, f);
+    for (ch = 0; ch < 3; ch++) {
+        const MWVIP_DM_VEC fe = f[phase->sel[ch][0]];
+        const MWVIP_DM_VEC fo = f[phase->sel[ch][1]];
+#if defined(MWVIP_DEMOSAIC_SSE2)
+        /* the even rows in the low half of each 32 bit lane */
+        const __m128i even = _mm_set1_epi32(0x0000FFFF);
+        __m128i v = _mm_or_si128(_mm_and_si128(even, fe), _mm_andnot_si128(even, fo));
+        v = _mm_srai_epi16(_mm_add_epi16(v, _mm_set1_epi16(8)), 4);
+        _mm_storel_epi64((__m128i *)out[ch], _mm_packus_epi16(v, v));
+#else
+        const uint16x8_t even = vreinterpretq_u16_u32(vdupq_n_u32(0x0000FFFF));
+        int16x8_t v = vbslq_s16(even, fe, fo);
+        v = vshrq_n_s16(vaddq_s16(v, vdupq_n_s16(8)), 4);
+        vst1_u8(out[ch], vqmovun_s16(v));
+#endif
+    }
+}
+#endif
+
+/* rows i0 to i1-1 of column col[2] into r, g, b */
+static void DemosaicSpan(const uint8_T *const *col, int_T rows, int_T i0, int_T i1,
+                         const MWVIP_DEMOSAIC_PHASE *phase, int_T method,
+                         uint8_T *r, uint8_T *g, uint8_T *b)
+{
+    int_T i = i0;
+    while (i < i1) {
+#if defined(MWVIP_DEMOSAIC_SSE2) || defined(MWVIP_DEMOSAIC_NEON)
+        if (i >= 2 && (i & 1) == 0 && i + 8 <= rows - 2 && i + 8 <= i1) {
+            DemosaicBlock(col, i, phase, method, &r[i-i0], &g[i-i0], &b[i-i0]);
+            i += 8;
+            continue;
+        }
+#endif
+        DemosaicPixel(col, rows, i, phase, method, &r[i-i0], &g[i-i0], &b[i-i0]);
+        i++;
+    }
+}
+
+static void DemosaicColumn(const uint8_T *in, uint8_T *rgb, uint8_T *gray,
+                           int_T rows, int_T cols, int_T j,
+                           int_T alignment, int_T method)
+{
+    const uint8_T *col[5];
+    MWVIP_DEMOSAIC_PHASE phase;
+    int_T k, i0;
+
+    for (k = 0; k < 5; k++) {
+        col[k] = &in[MWVIP_Demosaic_Reflect(j+k-2, cols)*rows];
+    }
+    MWVIP_Demosaic_Phase(alignment, j & 1, &phase);
+
+    if (gray == NULL) {
+        DemosaicSpan(col, rows, 0, rows, &phase, method, &rgb[j*rows],
+                     &rgb[(cols+j)*rows], &rgb[(2*cols+j)*rows]);
+        return;
+    }
+    /* the gray pixels from chunks of the column still in cache */
+    for (i0 = 0; i0 < rows; i0 += MWVIP_DEMOSAIC_CHUNK) {
+        const int_T i1 = (rows - i0 < MWVIP_DEMOSAIC_CHUNK) ? rows : i0 + MWVIP_DEMOSAIC_CHUNK;
+        uint8_T buf[3][MWVIP_DEMOSAIC_CHUNK];
+        uint8_T *r = buf[0], *g = buf[1], *b = buf[2];
+        int_T i;
+        if (rgb != NULL) {
+            r = &rgb[j*rows + i0];
+            g = &rgb[(cols+j)*rows + i0];
+            b = &rgb[(2*cols+j)*rows + i0];
+        }
+        DemosaicSpan(col, rows, i0, i1, &phase, method, r, g, b);
+        for (i = 0; i < i1 - i0; i++) {
+            gray[j*rows + i0 + i] = (uint8_T)MWVIP_DEMOSAIC_GRAY(r[i], g[i], b[i]);
+        }
+    }
+}
+
+LIBMWVISIONRT_API void MWVIP_Demosaic_U8(const uint8_T *in, uint8_T *rgb,
+                                         uint8_T *gray, int_T rows, int_T cols,
+                                         int_T alignment, int_T method)
+{
+    const int_T numStrips = (cols + MWVIP_DEMOSAIC_STRIP_COLS - 1)/MWVIP_DEMOSAIC_STRIP_COLS;
+    int_T s;
+
+    if ((rgb == NULL && gray == NULL) || rows <= 0) return;
+#if defined(MWVIP_DEMOSAIC_PARALLEL)
+    #pragma omp parallel for schedule(dynamic, 1) \
+        if (rows*cols >= MWVIP_DEMOSAIC_MIN_PARALLEL)
+#endif
+    for (s = 0; s < numStrips; s++) {
+        const int_T j1 = (s+1)*MWVIP_DEMOSAIC_STRIP_COLS < cols ?
+                         (s+1)*MWVIP_DEMOSAIC_STRIP_COLS : cols;
+        int_T j;
+        for (j = s*MWVIP_DEMOSAIC_STRIP_COLS; j < j1; j++) {
+            DemosaicColumn(in, rgb, gray, rows, cols, j, alignment, method);
+        }
+    }
+}
+
+/* [EOF] demosaic_u8_rt.c */
@@ -0,0 +1,55 @@
+/*
+ *  DRAWSHAPES_RT edge table and scan of the batched polygon filling.
+ *
+ *  The table is built once per call by MWVIP_PolyFill_Build and walked by
+ *  MWVIP_PolyFill_Scan, which hands every span to the blending function of
+ *  the data type. Each band of columns keeps its own active edge list; the
+ *  edges already active at the first column of a band are found among the
+ *  edges of the buckets before it.
+ *
+ *  Copyright 2016 The MathWorks, Inc.
+ */
+
+#ifndef drawshapes_rt_h
+#define drawshapes_rt_h
+
+#include <stdlib.h>
+#include <string.h>
+#include "vipdrawshapes_rt.h"
+
+#if defined(__ARM_NEON__) || defined(__ARM_NEON)
+#include <arm_neon.h>
+#define MWVIP_DRAWSHAPES_NEON 1
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define MWVIP_DRAWSHAPES_SSE2 1
+#endif
+
+typedef struct {
+    int32_T c0, r0;     /* first vertex, by column */
+    int32_T dr, dc;     /* to the second vertex, dc > 0 */
+    int32_T start, end; /* the columns it covers, clipped: [start, end) */
+    int32_T shape;
+} MWVIP_POLYFILL_EDGE;
+
+typedef struct {
+    MWVIP_POLYFILL_EDGE *edges;   /* sorted by start */
+    int32_T *first;               /* edges[first[c] .. first[c+1]-1] start at c */
+    int32_T  numEdges;
+    int32_T  rows, cols;
+} MWVIP_POLYFILL_TABLE;
+
+/* rows r0 .. r1 of column col, inside the image, are covered by shape */
+typedef void (*MWVIP_PolyFill_SpanFcn)(void *ctx, int32_T shape, int32_T col,
+                                       int32_T r0, int32_T r1);
+
+extern boolean_T MWVIP_PolyFill_Build(const int32_T *pts, const int32_T *numVertices,
+                                      int_T numPolygons, int_T rows, int_T cols,
+                                      MWVIP_POLYFILL_TABLE *table);
+extern void MWVIP_PolyFill_Free(MWVIP_POLYFILL_TABLE *table);
+extern boolean_T MWVIP_PolyFill_Scan(const MWVIP_POLYFILL_TABLE *table,
+                                     MWVIP_PolyFill_SpanFcn span, void *ctx);
+
+#endif /* drawshapes_rt_h */
+
+/* [EOF] drawshapes_rt.h */
@@ -0,0 +1,62 @@
+/*
+ *  FILLPOLYGONS_R_RT runtime function for VIPBLKS Draw Shapes and Draw
+ *  Markers blocks
+ *
+ *  Fills a batch of polygons in a single precision image. A translucent
+ *  span is blended in a plain loop, which the compiler vectorizes.
+ *
+ *  Copyright 2016 The MathWorks, Inc.
+ */
+#include "drawshapes_rt.h"
+
+typedef struct {
+    real32_T *img;
+    int_T rows, cols, nChans;
+    const real32_T *color;
+    const real32_T *opacity;
+} FillContext;
+
+static void FillSpan(void *ctx, int32_T shape, int32_T col, int32_T r0, int32_T r1)
+{
+    const FillContext *f = (const FillContext *)ctx;
+    const size_t plane = (size_t)f->rows*f->cols;
+    const real32_T *c = &f->color[shape*f->nChans];
+    const real32_T a = (f->opacity != NULL) ? f->opacity[shape] : 1.0F;
+    int_T ch, i;
+
+    for (ch = 0; ch < f->nChans; ch++) {
+        real32_T *y = &f->img[ch*plane + (size_t)col*f->rows];
+        if (a == 1.0F) {
+            for (i = r0; i <= r1; i++) y[i] = c[ch];
+        } else {
+            for (i = r0; i <= r1; i++) y[i] += a*(c[ch] - y[i]);
+        }
+    }
+}
+
+boolean_T MWVIP_FillPolygons_R(real32_T *img, int_T rows, int_T cols,
+                               int_T nChans, const int32_T *pts,
+                               const int32_T *numVertices,
+                               int_T numPolygons,
+                               const real32_T *color,
+                               const real32_T *opacity)
+{
+    MWVIP_POLYFILL_TABLE table;
+    FillContext ctx;
+    boolean_T ok;
+
+    if (!MWVIP_PolyFill_Build(pts, numVertices, numPolygons, rows, cols, &table)) {
+        return 0;
+    }
+    ctx.img = img;
+    ctx.rows = rows;
+    ctx.cols = cols;
+    ctx.nChans = nChans;
+    ctx.color = color;
+    ctx.opacity = opacity;
+    ok = MWVIP_PolyFill_Scan(&table, FillSpan, &ctx);
+    MWVIP_PolyFill_Free(&table);
+    return ok;
+}
+
+/* [EOF] fillpolygons_r_rt.c */
@@ -0,0 +1,204 @@
+/*
+ *  POLYFILL_RT runtime function for VIPBLKS Draw Shapes and Draw Markers
+ *  blocks
+ *
+ *  Builds the edge table of a batch of polygons and scans it column by
+ *  column. The counting sort by first column is stable, so the edges of a
+ *  bucket stay in the order of their polygons, and so does the active edge
+ *  list they are merged into: the crossings of one polygon are next to
+ *  each other and only those few are sorted by row.
+ *
+ *  Copyright 2016 The MathWorks, Inc.
+ */
+#include "drawshapes_rt.h"
+
+/* floor(a/b), b > 0 */
+static int32_T FloorDiv(int32_T a, int32_T b)
+{
+    return (a >= 0) ? a/b : -((-a + b - 1)/b);
+}
+
+/* row of the edge at column x, rounded half up */
+static int32_T CrossRow(const MWVIP_POLYFILL_EDGE *e, int32_T x)
+{
+    return e->r0 + FloorDiv(2*(x - e->c0)*e->dr + e->dc, 2*e->dc);
+}
+
+boolean_T MWVIP_PolyFill_Build(const int32_T *pts, const int32_T *numVertices,
+                               int_T numPolygons, int_T rows, int_T cols,
+                               MWVIP_POLYFILL_TABLE *table)
+{
+    MWVIP_POLYFILL_EDGE *unsorted;
+    int_T p, v, total = 0, numEdges = 0;
+    const int32_T *poly = pts;
+
+    table->edges = NULL;
+    table->first = NULL;
+    table->numEdges = 0;
+    table->rows = (int32_T)rows;
+    table->cols = (int32_T)cols;
+    for (p = 0; p < numPolygons; p++) total += numVertices[p];
+
+    unsorted = (MWVIP_POLYFILL_EDGE *)malloc((total > 0 ? total : 1)*sizeof(MWVIP_POLYFILL_EDGE));
+    table->edges = (MWVIP_POLYFILL_EDGE *)malloc((total > 0 ? total : 1)*sizeof(MWVIP_POLYFILL_EDGE));
+    table->first = (int32_T *)calloc(cols + 2, sizeof(int32_T));
+    if (unsorted == NULL || table->edges == NULL || table->first == NULL) {
+        free(unsorted);
+        MWVIP_PolyFill_Free(table);
+        return 0;
+    }
+
+    for (p = 0; p < numPolygons; p++) {
+        const int_T n = numVertices[p];
+        int32_T maxCol = (n > 0) ? poly[1] : 0;
+        for (v = 1; v < n; v++) {
+            if (poly[2*v+1] > maxCol) maxCol = poly[2*v+1];
+        }
+        for (v = 0; v < n; v++) {
+            const int_T w = (v + 1 == n) ? 0 : v + 1;
+            int32_T ra = poly[2*v], ca = poly[2*v+1];
+            int32_T rb = poly[2*w], cb = poly[2*w+1];
+            MWVIP_POLYFILL_EDGE *e = &unsorted[numEdges];
+            int32_T end;
+            if (ca == cb) continue;         /* along the scanline */
+            if (ca > cb) {
+                int32_T t = ra; ra = rb; rb = t;
+                t = ca; ca = cb; cb = t;
+            }
+            /* the last column of the polygon belongs to it */
+            end = (cb == maxCol) ? cb + 1 : cb;
+            e->c0 = ca;
+            e->r0 = ra;
+            e->dr = rb - ra;
+            e->dc = cb - ca;
+            e->start = (ca < 0) ? 0 : ca;
+            e->end = (end > cols) ? (int32_T)cols : end;
+            e->shape = (int32_T)p;
+            if (e->start < e->end) numEdges++;
+        }
+        poly += 2*n;
+    }
+
+    /* counting sort by first column */
+    for (v = 0; v < numEdges; v++) table->first[unsorted[v].start + 2]++;
+    for (v = 2; v <= cols + 1; v++) table->first[v] += table->first[v-1];
+    for (v = 0; v < numEdges; v++) {
+        table->edges[table->first[unsorted[v].start + 1]++] = unsorted[v];
+    }
+    table->numEdges = (int32_T)numEdges;
+    free(unsorted);
+    return 1;
+}
+
+void MWVIP_PolyFill_Free(MWVIP_POLYFILL_TABLE *table)
+{
+    free(table->edges);
+    free(table->first);
+    table->edges = NULL;
+    table->first = NULL;
+}
+
+/* (shape, edge index) pairs */
+static int ComparePairs(const void *a, const void *b)
+{
+    const int32_T *p = (const int32_T *)a, *q = (const int32_T *)b;
+    if (p[0] != q[0]) return (p[0] < q[0]) ? -1 : 1;
+    return (p[1] < q[1]) ? -1 : (p[1] > q[1]);
+}
+
+/* edges active at the first column b0 of a band, in the order of their
+ * polygons; pairs holds 2 entries per edge */
+static int32_T InitActive(const MWVIP_POLYFILL_TABLE *table, int32_T b0,
+                          int32_T *active, int32_T *pairs)
+{
+    int32_T i, n = 0;
+    for (i = 0; i < table->first[b0]; i++) {
+        if (table->edges[i].end > b0) {
+            pairs[2*n]   = table->edges[i].shape;
+            pairs[2*n+1] = i;
+            n++;
+        }
+    }
+    qsort(pairs, n, 2*sizeof(int32_T), ComparePairs);
+    for (i = 0; i < n; i++) active[i] = pairs[2*i+1];
+    return n;
+}
+
+static void ScanBand(const MWVIP_POLYFILL_TABLE *table, int32_T b0, int32_T b1,
+                     int32_T *active, int32_T *merged, int32_T *row,
+                     MWVIP_PolyFill_SpanFcn span, void *ctx)
+{
+    const MWVIP_POLYFILL_EDGE *edges = table->edges;
+    /* merged and row are contiguous */
+    int32_T numActive = InitActive(table, b0, active, merged);
+    int32_T x;
+
+    for (x = b0; x < b1; x++) {
+        int32_T i, j, n = 0;
+        const int32_T n0 = table->first[x], n1 = table->first[x+1];
+
+        /* drop the ended edges and merge the new ones, by shape */
+        for (i = 0, j = n0; i < numActive || j < n1; ) {
+            if (i < numActive && edges[active[i]].end <= x) {
+                i++;
+            } else if (j < n1 && (i >= numActive || edges[j].shape < edges[active[i]].shape)) {
+                merged[n++] = j++;
+            } else {
+                merged[n++] = active[i++];
+            }
+        }
+        memcpy(active, merged, n*sizeof(int32_T));
+        numActive = n;
+
+        /* the crossings of each polygon, sorted by row, pair into spans */
+        for (i = 0; i < numActive; ) {
+            const int32_T shape = edges[active[i]].shape;
+            int32_T k, m = 0;
+            for (j = i; j < numActive && edges[active[j]].shape == shape; j++) {
+                const int32_T r = CrossRow(&edges[active[j]], x);
+                for (k = m; k > 0 && row[k-1] > r; k--) row[k] = row[k-1];
+                row[k] = r;
+                m++;
+            }
+            for (k = 0; k + 1 < m; k += 2) {
+                const int32_T r0 = (row[k] < 0) ? 0 : row[k];
+                const int32_T r1 = (row[k+1] >= table->rows) ? table->rows - 1 : row[k+1];
+                if (r0 <= r1) span(ctx, shape, x, r0, r1);
+            }
+            i = j;
+        }
+    }
+}
+
+boolean_T MWVIP_PolyFill_Scan(const MWVIP_POLYFILL_TABLE *table,
+                              MWVIP_PolyFill_SpanFcn span, void *ctx)
+{
+    const int32_T numBands = (table->cols + MWVIP_DRAWSHAPES_BAND_COLS - 1) /
+                             MWVIP_DRAWSHAPES_BAND_COLS;
+    const int32_T size = (table->numEdges > 0) ? table->numEdges : 1;
+    boolean_T ok = 1;
+
+    if (table->numEdges == 0) return 1;
+#if defined(MWVIP_DRAWSHAPES_PARALLEL)
+    #pragma omp parallel if (table->numEdges >= MWVIP_DRAWSHAPES_MIN_PARALLEL) reduction(&&:ok)
+#endif
+    {
+        int32_T *buf = (int32_T *)malloc(3*(size_t)size*sizeof(int32_T));
+        int32_T band;
+        if (buf == NULL) ok = 0;
+#if defined(MWVIP_DRAWSHAPES_PARALLEL)
+        #pragma omp for schedule(dynamic, 1)
+#endif
+        for (band = 0; band < numBands; band++) {
+            const int32_T b0 = band*MWVIP_DRAWSHAPES_BAND_COLS;
+            const int32_T b1 = (b0 + MWVIP_DRAWSHAPES_BAND_COLS < table->cols) ?
+                               b0 + MWVIP_DRAWSHAPES_BAND_COLS : table->cols;
+            if (buf == NULL) continue;
+            ScanBand(table, b0, b1, buf, buf + size, buf + 2*(size_t)size, span, ctx);
+        }
+        free(buf);
+    }
+    return ok;
+}
+
+/* [EOF] polyfill_rt.c */
@@ -7,6 +7,32 @@
 #include "vipdrawtext_rt.h"
 #include <string.h> 
 
+/*
+ * Part of the glyph bitmap that falls inside the image. Rows i (along the
+ * image width) and columns j (along the image height) of the bitmap are
+ * drawn for iStart <= i < iEnd and jStart <= j < jEnd, so that the kernels
+ * blend whole spans without checking the image bounds for every pixel.
+ */
+typedef struct {
+    int32_T iStart, iEnd;
+    int32_T jStart, jEnd;
+} MWVIP_DRAWTEXT_CLIP;
+
+static void DrawTextClip(int32_T x, int32_T y,
+                         int_T outerLoop, int_T innerLoop,
+                         uint32_T imageWidth, uint32_T imageHeight,
+                         MWVIP_DRAWTEXT_CLIP* clip)
+{
+    int32_T iEnd = (int32_T)imageWidth  - x;
+    int32_T jEnd = (int32_T)imageHeight - y;
+    clip->iStart = (x < 0) ? -x : 0;
+    clip->jStart = (y < 0) ? -y : 0;
+    clip->iEnd   = (iEnd < outerLoop) ? iEnd : outerLoop;
+    clip->jEnd   = (jEnd < innerLoop) ? jEnd : innerLoop;
+    if (clip->iEnd < clip->iStart) clip->iEnd = clip->iStart;
+    if (clip->jEnd < clip->jStart) clip->jEnd = clip->jStart;
+}
+
 /*****************************  double ****************************************/
 
 /*  RGB  */
@@ -28,14 +54,14 @@ LIBMWVISIONRT_API void MWVIP_DrawText_RGB_double_AA(const uint8_T* bitmap,
                                              boolean_T isImageTransposed)
 { 
     int32_T  i, j,x,y;
-    uint32_T pixelIndexCpy;
     real_T	bitmapVal, valR, valG, valB;
     real_T *outR = (real_T*) outputImageR,
         *outG = (real_T*) outputImageG,
         *outB = (real_T*) outputImageB;
     const real_T*  colorVector = (const real_T*) colorVect; 
     real_T opacity = *((const real_T*)opacityPtr);
-    int_T outerLoop, innerLoop, bitmapIndx = 0;
+    int_T outerLoop, innerLoop, bitmapStep;
+    MWVIP_DRAWTEXT_CLIP clip;
     if (isImageTransposed) {
         outerLoop = bitmapHeight;
         innerLoop = bitmapWidth;
@@ -47,22 +73,14 @@ LIBMWVISIONRT_API void MWVIP_DrawText_RGB_double_AA(const uint8_T* bitmap,
         x = pen_x + left_bearing;
         y = pen_y - top_bearing;
     }
-    pixelIndexCpy = y + (x * imageHeight);
-    for(i = 0; i < outerLoop; i++) {
-        uint32_T pixelIndex = pixelIndexCpy - 1;
-        for(j = 0; j < innerLoop; j++)
-        {
-            pixelIndex++;
-            if(	(x < (-i)) || (x >= ((int32_T)imageWidth-i)) ||
-                (y < (-j)) || (y >= ((int32_T)imageHeight-j))) {
-                    bitmapIndx++;
-                    continue;
-            }
-
-            if (isImageTransposed)
-                bitmapVal = (real_T)bitmap[bitmapIndx++] / 255.0;
-            else
-                bitmapVal = (real_T)bitmap[j * bitmapWidth + i] / 255.0;
+    DrawTextClip(x, y, outerLoop, innerLoop, imageWidth, imageHeight, &clip);
+    bitmapStep = isImageTransposed ? 1 : bitmapWidth;
+    for(i = clip.iStart; i < clip.iEnd; i++) {
+        uint32_T pixelIndex = (uint32_T)(y + clip.jStart) + (uint32_T)(x + i) * imageHeight;
+        const uint8_T *bitmapPtr = isImageTransposed ? &bitmap[i * innerLoop + clip.jStart]
+                                                     : &bitmap[clip.jStart * bitmapWidth + i];
+        for(j = clip.jStart; j < clip.jEnd; j++, pixelIndex++, bitmapPtr += bitmapStep) {
+            bitmapVal = (real_T)*bitmapPtr / 255.0;
             
 
             if(bitmapVal == 0.0)
@@ -92,7 +110,6 @@ LIBMWVISIONRT_API void MWVIP_DrawText_RGB_double_AA(const uint8_T* bitmap,
             outG[pixelIndex] = valG;
             outB[pixelIndex] = valB;
         }
-        pixelIndexCpy += imageHeight;
     }
 }
 
@@ -114,14 +131,14 @@ LIBMWVISIONRT_API void MWVIP_DrawText_RGB_double(const uint8_T* bitmap,
                                           boolean_T isImageTransposed)
 {
     int32_T  i, j,x,y;
-    uint32_T pixelIndexCpy;
     real_T	bitmapVal, valR, valG, valB;
     real_T	*outR = (real_T*) outputImageR,
         *outG = (real_T*) outputImageG,
         *outB = (real_T*) outputImageB;
     const real_T *colorVector = (const real_T*) colorVect;
     real_T opacity = *((const real_T*)opacityPtr);
-    int_T outerLoop, innerLoop, bitmapIndx = 0;
+    int_T outerLoop, innerLoop, bitmapStep;
+    MWVIP_DRAWTEXT_CLIP clip;
     if (isImageTransposed) {
         outerLoop = bitmapHeight;
         innerLoop = bitmapWidth;
@@ -133,21 +150,14 @@ LIBMWVISIONRT_API void MWVIP_DrawText_RGB_double(const uint8_T* bitmap,
         x = pen_x + left_bearing;
         y = pen_y - top_bearing;
     }
-    pixelIndexCpy = y + (x * imageHeight);
-    for(i = 0; i < outerLoop; i++) {
-        uint32_T pixelIndex = pixelIndexCpy - 1;
-        for(j = 0; j < innerLoop; j++) {
-            pixelIndex++;
-            if(	(x < (-i)) || (x >= ((int32_T)imageWidth-i)) ||
-                (y < (-j)) || (y >= ((int32_T)imageHeight-j))) {
-                bitmapIndx++;
-                continue;
-            }
-
-            if (isImageTransposed)
-                bitmapVal = (real_T)bitmap[bitmapIndx++] / 255.0;
-            else
-                bitmapVal = (real_T)bitmap[j * bitmapWidth + i] / 255.0;
+    DrawTextClip(x, y, outerLoop, innerLoop, imageWidth, imageHeight, &clip);
+    bitmapStep = isImageTransposed ? 1 : bitmapWidth;
+    for(i = clip.iStart; i < clip.iEnd; i++) {
+        uint32_T pixelIndex = (uint32_T)(y + clip.jStart) + (uint32_T)(x + i) * imageHeight;
+        const uint8_T *bitmapPtr = isImageTransposed ? &bitmap[i * innerLoop + clip.jStart]
+                                                     : &bitmap[clip.jStart * bitmapWidth + i];
+        for(j = clip.jStart; j < clip.jEnd; j++, pixelIndex++, bitmapPtr += bitmapStep) {
+            bitmapVal = (real_T)*bitmapPtr / 255.0;
 
             if(bitmapVal == 0.0)
                 continue;
@@ -167,7 +177,6 @@ LIBMWVISIONRT_API void MWVIP_DrawText_RGB_double(const uint8_T* bitmap,
             outG[pixelIndex] = valG;
             outB[pixelIndex] = valB;
         }
-        pixelIndexCpy += imageHeight;
     }
 }
 
@@ -189,12 +198,12 @@ LIBMWVISIONRT_API void MWVIP_DrawText_I_double_AA(const uint8_T* bitmap,
                                            boolean_T isImageTransposed)
 {
     int32_T  i, j,x,y;
-    uint32_T pixelIndexCpy;
     real_T	bitmapVal, valI;
     real_T	*out = (real_T*) outputImageR;
     const real_T  *colorVector = (const real_T*) colorVect;
     real_T opacity = *((const real_T*)opacityPtr);
-    int_T outerLoop, innerLoop, bitmapIndx = 0;
+    int_T outerLoop, innerLoop, bitmapStep;
+    MWVIP_DRAWTEXT_CLIP clip;
     if (isImageTransposed) {
         outerLoop = bitmapHeight;
         innerLoop = bitmapWidth;
@@ -206,21 +215,14 @@ LIBMWVISIONRT_API void MWVIP_DrawText_I_double_AA(const uint8_T* bitmap,
         x = pen_x + left_bearing;
         y = pen_y - top_bearing;
     }
-    pixelIndexCpy = y + (x * imageHeight);
-    for(i = 0; i < outerLoop; i++) {
-        uint32_T pixelIndex = pixelIndexCpy - 1;
-        for(j = 0; j < innerLoop; j++) {
-            pixelIndex++;
-            if(	(x < (-i)) || (x >= ((int32_T)imageWidth-i)) ||
-                (y < (-j)) || (y >= ((int32_T)imageHeight-j))) {
-                bitmapIndx++;
-                continue;
-            }
-
-            if (isImageTransposed)
-                bitmapVal = (real_T)bitmap[bitmapIndx++] / 255.0;
-            else
-                bitmapVal = (real_T)bitmap[j * bitmapWidth + i] / 255.0;
+    DrawTextClip(x, y, outerLoop, innerLoop, imageWidth, imageHeight, &clip);
+    bitmapStep = isImageTransposed ? 1 : bitmapWidth;
+    for(i = clip.iStart; i < clip.iEnd; i++) {
+        uint32_T pixelIndex = (uint32_T)(y + clip.jStart) + (uint32_T)(x + i) * imageHeight;
+        const uint8_T *bitmapPtr = isImageTransposed ? &bitmap[i * innerLoop + clip.jStart]
+                                                     : &bitmap[clip.jStart * bitmapWidth + i];
+        for(j = clip.jStart; j < clip.jEnd; j++, pixelIndex++, bitmapPtr += bitmapStep) {
+            bitmapVal = (real_T)*bitmapPtr / 255.0;
 
             if(bitmapVal == 0.0)
                 continue;
@@ -241,7 +243,6 @@ LIBMWVISIONRT_API void MWVIP_DrawText_I_double_AA(const uint8_T* bitmap,
 
             out[pixelIndex] = valI;
         }
-        pixelIndexCpy += imageHeight;
     }
 }
 
@@ -261,12 +262,12 @@ LIBMWVISIONRT_API void MWVIP_DrawText_I_double(const uint8_T* bitmap,
                                         boolean_T isImageTransposed)
 {
     int32_T  i, j,x,y;
-    uint32_T pixelIndexCpy;
     real_T	bitmapVal, valI;
     real_T	*out = (real_T*) outputImageR;
     const real_T*  colorVector = (const real_T*) colorVect;
     real_T opacity = *((const real_T*)opacityPtr);
-    int_T outerLoop, innerLoop, bitmapIndx = 0;
+    int_T outerLoop, innerLoop, bitmapStep;
+    MWVIP_DRAWTEXT_CLIP clip;
     if (isImageTransposed) {
         outerLoop = bitmapHeight;
         innerLoop = bitmapWidth;
@@ -278,21 +279,14 @@ LIBMWVISIONRT_API void MWVIP_DrawText_I_double(const uint8_T* bitmap,
         x = pen_x + left_bearing;
         y = pen_y - top_bearing;
     }
-    pixelIndexCpy = y + (x * imageHeight);
-    for(i = 0; i < outerLoop; i++) {
-        uint32_T pixelIndex = pixelIndexCpy - 1;
-        for(j = 0; j < innerLoop; j++) {
-            pixelIndex++;
-            if(	(x < (-i)) || (x >= ((int32_T)imageWidth-i)) ||
-                (y < (-j)) || (y >= ((int32_T)imageHeight-j))) {
-                bitmapIndx++;
-                continue;
-            }
-
-            if (isImageTransposed)
-                bitmapVal = (real_T)bitmap[bitmapIndx++] / 255.0;
-            else
-                bitmapVal = (real_T)bitmap[j * bitmapWidth + i] / 255.0;
+    DrawTextClip(x, y, outerLoop, innerLoop, imageWidth, imageHeight, &clip);
+    bitmapStep = isImageTransposed ? 1 : bitmapWidth;
+    for(i = clip.iStart; i < clip.iEnd; i++) {
+        uint32_T pixelIndex = (uint32_T)(y + clip.jStart) + (uint32_T)(x + i) * imageHeight;
+        const uint8_T *bitmapPtr = isImageTransposed ? &bitmap[i * innerLoop + clip.jStart]
+                                                     : &bitmap[clip.jStart * bitmapWidth + i];
+        for(j = clip.jStart; j < clip.jEnd; j++, pixelIndex++, bitmapPtr += bitmapStep) {
+            bitmapVal = (real_T)*bitmapPtr / 255.0;
 
             if(bitmapVal == 0.0)
                 continue;
@@ -305,7 +299,6 @@ LIBMWVISIONRT_API void MWVIP_DrawText_I_double(const uint8_T* bitmap,
             }
             out[pixelIndex] = valI;
         }
-        pixelIndexCpy += imageHeight;
     }
 }
 
@@ -332,14 +325,14 @@ LIBMWVISIONRT_API void MWVIP_DrawText_RGB_single_AA(const uint8_T* bitmap,
                                              boolean_T isImageTransposed)
 {
     int32_T  i, j,x,y;
-    uint32_T pixelIndexCpy;
     real32_T	bitmapVal, valR, valG, valB;
     real32_T *outR = (real32_T*) outputImageR,
         *outG = (real32_T*) outputImageG,
         *outB = (real32_T*) outputImageB;
     const real32_T*  colorVector = (const real32_T*) colorVect;
     real32_T opacity = *((const real32_T*)opacityPtr);
-    int_T outerLoop, innerLoop, bitmapIndx = 0;
+    int_T outerLoop, innerLoop, bitmapStep;
+    MWVIP_DRAWTEXT_CLIP clip;
     if (isImageTransposed) {
         outerLoop = bitmapHeight;
         innerLoop = bitmapWidth;
@@ -351,21 +344,14 @@ LIBMWVISIONRT_API void MWVIP_DrawText_RGB_single_AA(const uint8_T* bitmap,
         x = pen_x + left_bearing;
         y = pen_y - top_bearing;
     }
-    pixelIndexCpy = y + (x * imageHeight);
-    for(i = 0; i < outerLoop; i++) {
-        uint32_T pixelIndex = pixelIndexCpy - 1;
-        for(j = 0; j < innerLoop; j++) {
-            pixelIndex++;
-            if(	(x < (-i)) || (x >= ((int32_T)imageWidth-i)) ||
-                (y < (-j)) || (y >= ((int32_T)imageHeight-j))) {
-                bitmapIndx++;
-                continue;
-            }
-
-            if (isImageTransposed)
-                bitmapVal = (real32_T)bitmap[bitmapIndx++] / 255.0F;
-            else
-                bitmapVal = (real32_T)bitmap[j * bitmapWidth + i] / 255.0F;
+    DrawTextClip(x, y, outerLoop, innerLoop, imageWidth, imageHeight, &clip);
+    bitmapStep = isImageTransposed ? 1 : bitmapWidth;
+    for(i = clip.iStart; i < clip.iEnd; i++) {
+        uint32_T pixelIndex = (uint32_T)(y + clip.jStart) + (uint32_T)(x + i) * imageHeight;
+        const uint8_T *bitmapPtr = isImageTransposed ? &bitmap[i * innerLoop + clip.jStart]
+                                                     : &bitmap[clip.jStart * bitmapWidth + i];
+        for(j = clip.jStart; j < clip.jEnd; j++, pixelIndex++, bitmapPtr += bitmapStep) {
+            bitmapVal = (real32_T)*bitmapPtr / 255.0F;
 
             if(bitmapVal == 0.0F)
                 continue;
@@ -394,7 +380,6 @@ LIBMWVISIONRT_API void MWVIP_DrawText_RGB_single_AA(const uint8_T* bitmap,
             outG[pixelIndex] = valG;
             outB[pixelIndex] = valB;
         }
-        pixelIndexCpy += imageHeight;
     }
 }
 
@@ -416,14 +401,14 @@ LIBMWVISIONRT_API void MWVIP_DrawText_RGB_single(const uint8_T* bitmap,
                                           boolean_T isImageTransposed)
 {
     int32_T  i, j,x,y;
-    uint32_T pixelIndexCpy;
     real32_T	bitmapVal, valR, valG, valB;
     real32_T	*outR = (real32_T*) outputImageR,
         *outG = (real32_T*) outputImageG,
         *outB = (real32_T*) outputImageB;
     const real32_T   *colorVector = (const real32_T*) colorVect;
     real32_T opacity = *((const real32_T*)opacityPtr);
-    int_T outerLoop, innerLoop, bitmapIndx = 0;
+    int_T outerLoop, innerLoop, bitmapStep;
+    MWVIP_DRAWTEXT_CLIP clip;
     if (isImageTransposed) {
         outerLoop = bitmapHeight;
         innerLoop = bitmapWidth;
@@ -435,21 +420,14 @@ LIBMWVISIONRT_API void MWVIP_DrawText_RGB_single(const uint8_T* bitmap,
         x = pen_x + left_bearing;
         y = pen_y - top_bearing;
     }
-    pixelIndexCpy = y + (x * imageHeight);
-    for(i = 0; i < outerLoop; i++) {
-        uint32_T pixelIndex = pixelIndexCpy - 1;
-        for(j = 0; j < innerLoop; j++) {
-            pixelIndex++;
-            if(	(x < (-i)) || (x >= ((int32_T)imageWidth-i)) ||
-                (y < (-j)) || (y >= ((int32_T)imageHeight-j))) {
-                bitmapIndx++;
-                continue;
-            }
-
-            if (isImageTransposed)
-                bitmapVal = (real32_T)bitmap[bitmapIndx++] / 255.0F;
-            else
-                bitmapVal = (real32_T)bitmap[j * bitmapWidth + i] / 255.0F;
+    DrawTextClip(x, y, outerLoop, innerLoop, imageWidth, imageHeight, &clip);
+    bitmapStep = isImageTransposed ? 1 : bitmapWidth;
+    for(i = clip.iStart; i < clip.iEnd; i++) {
+        uint32_T pixelIndex = (uint32_T)(y + clip.jStart) + (uint32_T)(x + i) * imageHeight;
+        const uint8_T *bitmapPtr = isImageTransposed ? &bitmap[i * innerLoop + clip.jStart]
+                                                     : &bitmap[clip.jStart * bitmapWidth + i];
+        for(j = clip.jStart; j < clip.jEnd; j++, pixelIndex++, bitmapPtr += bitmapStep) {
+            bitmapVal = (real32_T)*bitmapPtr / 255.0F;
 
             if(bitmapVal == 0.0F)
                 continue;
@@ -469,7 +447,6 @@ LIBMWVISIONRT_API void MWVIP_DrawText_RGB_single(const uint8_T* bitmap,
             outG[pixelIndex] = valG;
             outB[pixelIndex] = valB;
         }
-        pixelIndexCpy += imageHeight;
     }
 }
 
@@ -491,12 +468,12 @@ LIBMWVISIONRT_API void MWVIP_DrawText_I_single_AA(const uint8_T* bitmap,
                                            boolean_T isImageTransposed)
 {
     int32_T  i, j,x,y;
-    uint32_T pixelIndexCpy;
     real32_T	bitmapVal, valI;
     real32_T	*out = (real32_T*) outputImageR;
     const real32_T  *colorVector = (const real32_T*) colorVect;
     real32_T opacity = *((const real32_T*)opacityPtr);
-    int_T outerLoop, innerLoop, bitmapIndx = 0;
+    int_T outerLoop, innerLoop, bitmapStep;
+    MWVIP_DRAWTEXT_CLIP clip;
     if (isImageTransposed) {
         outerLoop = bitmapHeight;
         innerLoop = bitmapWidth;
@@ -508,21 +485,14 @@ LIBMWVISIONRT_API void MWVIP_DrawText_I_single_AA(const uint8_T* bitmap,
         x = pen_x + left_bearing;
         y = pen_y - top_bearing;
     }
-    pixelIndexCpy = y + (x * imageHeight);
-    for(i = 0; i < outerLoop; i++) {
-        uint32_T pixelIndex = pixelIndexCpy - 1;
-        for(j = 0; j < innerLoop; j++) {
-            pixelIndex++;
-            if(	(x < (-i)) || (x >= ((int32_T)imageWidth-i)) ||
-                (y < (-j)) || (y >= ((int32_T)imageHeight-j))) {
-                bitmapIndx++;
-                continue;
-            }
-
-            if (isImageTransposed)
-                bitmapVal = (real32_T)bitmap[bitmapIndx++] / 255.0F;
-            else
-                bitmapVal = (real32_T)bitmap[j * bitmapWidth + i] / 255.0F;
+    DrawTextClip(x, y, outerLoop, innerLoop, imageWidth, imageHeight, &clip);
+    bitmapStep = isImageTransposed ? 1 : bitmapWidth;
+    for(i = clip.iStart; i < clip.iEnd; i++) {
+        uint32_T pixelIndex = (uint32_T)(y + clip.jStart) + (uint32_T)(x + i) * imageHeight;
+        const uint8_T *bitmapPtr = isImageTransposed ? &bitmap[i * innerLoop + clip.jStart]
+                                                     : &bitmap[clip.jStart * bitmapWidth + i];
+        for(j = clip.jStart; j < clip.jEnd; j++, pixelIndex++, bitmapPtr += bitmapStep) {
+            bitmapVal = (real32_T)*bitmapPtr / 255.0F;
 
             if(bitmapVal == 0.0F)
                 continue;
@@ -543,7 +513,6 @@ LIBMWVISIONRT_API void MWVIP_DrawText_I_single_AA(const uint8_T* bitmap,
 
             out[pixelIndex] = valI;
         }
-        pixelIndexCpy += imageHeight;
     }
 }
 
@@ -563,12 +532,12 @@ LIBMWVISIONRT_API void MWVIP_DrawText_I_single(const uint8_T* bitmap,
                                         boolean_T isImageTransposed)
 {
     int32_T  i, j,x,y;
-    uint32_T pixelIndexCpy;
     real32_T	bitmapVal, valI;
     real32_T	*out = (real32_T*) outputImageR;
     const real32_T*  colorVector = (const real32_T*) colorVect;
     real32_T opacity = *((const real32_T*)opacityPtr);
-    int_T outerLoop, innerLoop, bitmapIndx = 0;
+    int_T outerLoop, innerLoop, bitmapStep;
+    MWVIP_DRAWTEXT_CLIP clip;
     if (isImageTransposed) {
         outerLoop = bitmapHeight;
         innerLoop = bitmapWidth;
@@ -580,21 +549,14 @@ LIBMWVISIONRT_API void MWVIP_DrawText_I_single(const uint8_T* bitmap,
         x = pen_x + left_bearing;
         y = pen_y - top_bearing;
     }
-    pixelIndexCpy = y + (x * imageHeight);
-    for(i = 0; i < outerLoop; i++) {
-        uint32_T pixelIndex = pixelIndexCpy - 1;
-        for(j = 0; j < innerLoop; j++) {
-            pixelIndex++;
-            if(	(x < (-i)) || (x >= ((int32_T)imageWidth-i)) ||
-                (y < (-j)) || (y >= ((int32_T)imageHeight-j))) {
-                bitmapIndx++;
-                continue;
-            }
-
-            if (isImageTransposed)
-                bitmapVal = (real32_T)bitmap[bitmapIndx++] / 255.0F;
-            else
-                bitmapVal = (real32_T)bitmap[j * bitmapWidth + i] / 255.0F;
+    DrawTextClip(x, y, outerLoop, innerLoop, imageWidth, imageHeight, &clip);
+    bitmapStep = isImageTransposed ? 1 : bitmapWidth;
+    for(i = clip.iStart; i < clip.iEnd; i++) {
+        uint32_T pixelIndex = (uint32_T)(y + clip.jStart) + (uint32_T)(x + i) * imageHeight;
+        const uint8_T *bitmapPtr = isImageTransposed ? &bitmap[i * innerLoop + clip.jStart]
+                                                     : &bitmap[clip.jStart * bitmapWidth + i];
+        for(j = clip.jStart; j < clip.jEnd; j++, pixelIndex++, bitmapPtr += bitmapStep) {
+            bitmapVal = (real32_T)*bitmapPtr / 255.0F;
 
             if(bitmapVal == 0.0F)
                 continue;
@@ -608,12 +570,352 @@ LIBMWVISIONRT_API void MWVIP_DrawText_I_single(const uint8_T* bitmap,
 
             out[pixelIndex] = valI;
         }
-        pixelIndexCpy += imageHeight;
     }
 }
 
 
 
+/*************************  uint8 and uint16 **************************************/
+
+/*
+ * The integer kernels blend in fixed point. With c the coverage of the
+ * bitmap (0..255) and opacity the real_T opacity, the color is mixed into
+ * the pixel with the Q16 weight w = opacity*c/255 (w = opacity for the
+ * non anti-aliased kernels):
+ *
+ *     pixel = (color*w + pixel*(65536-w) + 32768) >> 16
+ *
+ * which does not overflow 32 bits for 16 bit pixels. The pixels are done
+ * in place, without going through a floating point copy of the image.
+ */
+#define MWVIP_DrawText_Q16One   65536U
+
+static uint32_T DrawTextOpacityQ16(const void* opacityPtr)
+{
+    real_T opacity = *((const real_T*)opacityPtr);
+    if (opacity >= 1.0) return MWVIP_DrawText_Q16One;
+    if (opacity <= 0.0) return 0U;
+    return (uint32_T)(opacity * MWVIP_DrawText_Q16One + 0.5);
+}
+
+#define MWVIP_DrawText_Blend(T, pixel, color, w) \
+    ((T)(((uint32_T)(color)*(w) + (uint32_T)(pixel)*(MWVIP_DrawText_Q16One-(w)) + 32768U) >> 16))
+
+/* numPlanes planes of uint8_T, 1 for intensity and 3 for RGB */
+static void DrawTextFixedPoint_U8(const uint8_T* bitmap,
+                                  int32_T pen_x,
+                                  int32_T pen_y,
+                                  int32_T left_bearing,
+                                  int32_T top_bearing,
+                                  uint16_T bitmapWidth,
+                                  uint16_T bitmapHeight,
+                                  uint32_T imageWidth,
+                                  uint32_T imageHeight,
+                                  uint8_T** out,
+                                  int_T numPlanes,
+                                  const uint8_T* colorVector,
+                                  const void* opacityPtr,
+                                  boolean_T isAntiAliased,
+                                  boolean_T isImageTransposed)
+{
+    int32_T  i, j, x, y;
+    int_T    k;
+    const uint32_T alpha = DrawTextOpacityQ16(opacityPtr);
+    int_T outerLoop, innerLoop, bitmapStep;
+    MWVIP_DRAWTEXT_CLIP clip;
+    if (alpha == 0U) return;
+    if (isImageTransposed) {
+        outerLoop = bitmapHeight;
+        innerLoop = bitmapWidth;
+        y = pen_x + left_bearing;
+        x = pen_y - top_bearing;
+    } else {
+        outerLoop = bitmapWidth;
+        innerLoop = bitmapHeight; 
+        x = pen_x + left_bearing;
+        y = pen_y - top_bearing;
+    }
+    DrawTextClip(x, y, outerLoop, innerLoop, imageWidth, imageHeight, &clip);
+    bitmapStep = isImageTransposed ? 1 : bitmapWidth;
+    for(i = clip.iStart; i < clip.iEnd; i++) {
+        uint32_T pixelIndex = (uint32_T)(y + clip.jStart) + (uint32_T)(x + i) * imageHeight;
+        const uint8_T *bitmapPtr = isImageTransposed ? &bitmap[i * innerLoop + clip.jStart]
+                                                     : &bitmap[clip.jStart * bitmapWidth + i];
+        for(j = clip.jStart; j < clip.jEnd; j++, pixelIndex++, bitmapPtr += bitmapStep) {
+            uint32_T bitmapVal, w;
+            bitmapVal = *bitmapPtr;
+
+            if(bitmapVal == 0U)
+                continue;
+
+            if (isAntiAliased && bitmapVal != 255U)
+                w = (alpha * bitmapVal + 127U) / 255U;
+            else
+                w = alpha;
+
+            if (w == MWVIP_DrawText_Q16One) {
+                for (k = 0; k < numPlanes; k++)
+                    out[k][pixelIndex] = colorVector[k];
+            } else {
+                for (k = 0; k < numPlanes; k++)
+                    out[k][pixelIndex] = MWVIP_DrawText_Blend(uint8_T, out[k][pixelIndex], colorVector[k], w);
+            }
+        }
+    }
+}
+
+LIBMWVISIONRT_API void MWVIP_DrawText_RGB_uint8_AA(const uint8_T* bitmap,
+                                             int32_T pen_x,
+                                             int32_T pen_y,
+                                             int32_T left_bearing,
+                                             int32_T top_bearing,
+                                             uint16_T bitmapWidth,
+                                             uint16_T bitmapHeight,
+                                             uint32_T imageWidth,
+                                             uint32_T imageHeight,
+                                             void* outputImageR,
+                                             void* outputImageG,
+                                             void* outputImageB,
+                                             const void* colorVect,
+                                             const void* opacityPtr,
+                                             boolean_T isImageTransposed)
+{
+    uint8_T* out[3];
+    out[0] = (uint8_T*) outputImageR;
+    out[1] = (uint8_T*) outputImageG;
+    out[2] = (uint8_T*) outputImageB;
+    DrawTextFixedPoint_U8(bitmap, pen_x, pen_y, left_bearing, top_bearing,
+                          bitmapWidth, bitmapHeight, imageWidth, imageHeight,
+                          out, 3, (const uint8_T*) colorVect, opacityPtr,
+                          true, isImageTransposed);
+}
+
+LIBMWVISIONRT_API void MWVIP_DrawText_RGB_uint8(const uint8_T* bitmap,
+                                             int32_T pen_x,
+                                             int32_T pen_y,
+                                             int32_T left_bearing,
+                                             int32_T top_bearing,
+                                             uint16_T bitmapWidth,
+                                             uint16_T bitmapHeight,
+                                             uint32_T imageWidth,
+                                             uint32_T imageHeight,
+                                             void* outputImageR,
+                                             void* outputImageG,
+                                             void* outputImageB,
+                                             const void* colorVect,
+                                             const void* opacityPtr,
+                                             boolean_T isImageTransposed)
+{
+    uint8_T* out[3];
+    out[0] = (uint8_T*) outputImageR;
+    out[1] = (uint8_T*) outputImageG;
+    out[2] = (uint8_T*) outputImageB;
+    DrawTextFixedPoint_U8(bitmap, pen_x, pen_y, left_bearing, top_bearing,
+                          bitmapWidth, bitmapHeight, imageWidth, imageHeight,
+                          out, 3, (const uint8_T*) colorVect, opacityPtr,
+                          false, isImageTransposed);
+}
+
+LIBMWVISIONRT_API void MWVIP_DrawText_I_uint8_AA(const uint8_T* bitmap,
+                                           int32_T pen_x,
+                                           int32_T pen_y,
+                                           int32_T left_bearing,
+                                           int32_T top_bearing,
+                                           uint16_T bitmapWidth,
+                                           uint16_T bitmapHeight,
+                                           uint32_T imageWidth,
+                                           uint32_T imageHeight,
+                                           void* outputImageR,
+                                           const void* colorVect,
+                                           const void* opacityPtr,
+                                           boolean_T isImageTransposed)
+{
+    uint8_T* out = (uint8_T*) outputImageR;
+    DrawTextFixedPoint_U8(bitmap, pen_x, pen_y, left_bearing, top_bearing,
+                          bitmapWidth, bitmapHeight, imageWidth, imageHeight,
+                          &out, 1, (const uint8_T*) colorVect, opacityPtr,
+                          true, isImageTransposed);
+}
+
+LIBMWVISIONRT_API void MWVIP_DrawText_I_uint8(const uint8_T* bitmap,
+                                           int32_T pen_x,
+                                           int32_T pen_y,
+                                           int32_T left_bearing,
+                                           int32_T top_bearing,
+                                           uint16_T bitmapWidth,
+                                           uint16_T bitmapHeight,
+                                           uint32_T imageWidth,
+                                           uint32_T imageHeight,
+                                           void* outputImageR,
+                                           const void* colorVect,
+                                           const void* opacityPtr,
+                                           boolean_T isImageTransposed)
+{
+    uint8_T* out = (uint8_T*) outputImageR;
+    DrawTextFixedPoint_U8(bitmap, pen_x, pen_y, left_bearing, top_bearing,
+                          bitmapWidth, bitmapHeight, imageWidth, imageHeight,
+                          &out, 1, (const uint8_T*) colorVect, opacityPtr,
+                          false, isImageTransposed);
+}
+
+/* numPlanes planes of uint16_T, 1 for intensity and 3 for RGB */
+static void DrawTextFixedPoint_U16(const uint8_T* bitmap,
+                                  int32_T pen_x,
+                                  int32_T pen_y,
+                                  int32_T left_bearing,
+                                  int32_T top_bearing,
+                                  uint16_T bitmapWidth,
+                                  uint16_T bitmapHeight,
+                                  uint32_T imageWidth,
+                                  uint32_T imageHeight,
+                                  uint16_T** out,
+                                  int_T numPlanes,
+                                  const uint16_T* colorVector,
+                                  const void* opacityPtr,
+                                  boolean_T isAntiAliased,
+                                  boolean_T isImageTransposed)
+{
+    int32_T  i, j, x, y;
+    int_T    k;
+    const uint32_T alpha = DrawTextOpacityQ16(opacityPtr);
+    int_T outerLoop, innerLoop, bitmapStep;
+    MWVIP_DRAWTEXT_CLIP clip;
+    if (alpha == 0U) return;
+    if (isImageTransposed) {
+        outerLoop = bitmapHeight;
+        innerLoop = bitmapWidth;
+        y = pen_x + left_bearing;
+        x = pen_y - top_bearing;
+    } else {
+        outerLoop = bitmapWidth;
+        innerLoop = bitmapHeight; 
+        x = pen_x + left_bearing;
+        y = pen_y - top_bearing;
+    }
+    DrawTextClip(x, y, outerLoop, innerLoop, imageWidth, imageHeight, &clip);
+    bitmapStep = isImageTransposed ? 1 : bitmapWidth;
+    for(i = clip.iStart; i < clip.iEnd; i++) {
+        uint32_T pixelIndex = (uint32_T)(y + clip.jStart) + (uint32_T)(x + i) * imageHeight;
+        const uint8_T *bitmapPtr = isImageTransposed ? &bitmap[i * innerLoop + clip.jStart]
+                                                     : &bitmap[clip.jStart * bitmapWidth + i];
+        for(j = clip.jStart; j < clip.jEnd; j++, pixelIndex++, bitmapPtr += bitmapStep) {
+            uint32_T bitmapVal, w;
+            bitmapVal = *bitmapPtr;
+
+            if(bitmapVal == 0U)
+                continue;
+
+            if (isAntiAliased && bitmapVal != 255U)
+                w = (alpha * bitmapVal + 127U) / 255U;
+            else
+                w = alpha;
+
+            if (w == MWVIP_DrawText_Q16One) {
+                for (k = 0; k < numPlanes; k++)
+                    out[k][pixelIndex] = colorVector[k];
+            } else {
+                for (k = 0; k < numPlanes; k++)
+                    out[k][pixelIndex] = MWVIP_DrawText_Blend(uint16_T, out[k][pixelIndex], colorVector[k], w);
+            }
+        }
+    }
+}
+
+LIBMWVISIONRT_API void MWVIP_DrawText_RGB_uint16_AA(const uint8_T* bitmap,
+                                             int32_T pen_x,
+                                             int32_T pen_y,
+                                             int32_T left_bearing,
+                                             int32_T top_bearing,
+                                             uint16_T bitmapWidth,
+                                             uint16_T bitmapHeight,
+                                             uint32_T imageWidth,
+                                             uint32_T imageHeight,
+                                             void* outputImageR,
+                                             void* outputImageG,
+                                             void* outputImageB,
+                                             const void* colorVect,
+                                             const void* opacityPtr,
+                                             boolean_T isImageTransposed)
+{
+    uint16_T* out[3];
+    out[0] = (uint16_T*) outputImageR;
+    out[1] = (uint16_T*) outputImageG;
+    out[2] = (uint16_T*) outputImageB;
+    DrawTextFixedPoint_U16(bitmap, pen_x, pen_y, left_bearing, top_bearing,
+                          bitmapWidth, bitmapHeight, imageWidth, imageHeight,
+                          out, 3, (const uint16_T*) colorVect, opacityPtr,
+                          true, isImageTransposed);
+}
+
+LIBMWVISIONRT_API void MWVIP_DrawText_RGB_uint16(const uint8_T* bitmap,
+                                             int32_T pen_x,
+                                             int32_T pen_y,
+                                             int32_T left_bearing,
+                                             int32_T top_bearing,
+                                             uint16_T bitmapWidth,
+                                             uint16_T bitmapHeight,
+                                             uint32_T imageWidth,
+                                             uint32_T imageHeight,
+                                             void* outputImageR,
+                                             void* outputImageG,
+                                             void* outputImageB,
+                                             const void* colorVect,
+                                             const void* opacityPtr,
+                                             boolean_T isImageTransposed)
+{
+    uint16_T* out[3];
+    out[0] = (uint16_T*) outputImageR;
+    out[1] = (uint16_T*) outputImageG;
+    out[2] = (uint16_T*) outputImageB;
+    DrawTextFixedPoint_U16(bitmap, pen_x, pen_y, left_bearing, top_bearing,
+                          bitmapWidth, bitmapHeight, imageWidth, imageHeight,
+                          out, 3, (const uint16_T*) colorVect, opacityPtr,
+                          false, isImageTransposed);
+}
+
+LIBMWVISIONRT_API void MWVIP_DrawText_I_uint16_AA(const uint8_T* bitmap,
+                                           int32_T pen_x,
+                                           int32_T pen_y,
+                                           int32_T left_bearing,
+                                           int32_T top_bearing,
+                                           uint16_T bitmapWidth,
+                                           uint16_T bitmapHeight,
+                                           uint32_T imageWidth,
+                                           uint32_T imageHeight,
+                                           void* outputImageR,
+                                           const void* colorVect,
+                                           const void* opacityPtr,
+                                           boolean_T isImageTransposed)
+{
+    uint16_T* out = (uint16_T*) outputImageR;
+    DrawTextFixedPoint_U16(bitmap, pen_x, pen_y, left_bearing, top_bearing,
+                          bitmapWidth, bitmapHeight, imageWidth, imageHeight,
+                          &out, 1, (const uint16_T*) colorVect, opacityPtr,
+                          true, isImageTransposed);
+}
+
+LIBMWVISIONRT_API void MWVIP_DrawText_I_uint16(const uint8_T* bitmap,
+                                           int32_T pen_x,
+                                           int32_T pen_y,
+                                           int32_T left_bearing,
+                                           int32_T top_bearing,
+                                           uint16_T bitmapWidth,
+                                           uint16_T bitmapHeight,
+                                           uint32_T imageWidth,
+                                           uint32_T imageHeight,
+                                           void* outputImageR,
+                                           const void* colorVect,
+                                           const void* opacityPtr,
+                                           boolean_T isImageTransposed)
+{
+    uint16_T* out = (uint16_T*) outputImageR;
+    DrawTextFixedPoint_U16(bitmap, pen_x, pen_y, left_bearing, top_bearing,
+                          bitmapWidth, bitmapHeight, imageWidth, imageHeight,
+                          &out, 1, (const uint16_T*) colorVect, opacityPtr,
+                          false, isImageTransposed);
+}
+
+
 static const DRAW_TEXT_FUNC_RGB antiAliasedDrawTextFcns_RGB[] =
 {
     /* real_T */
@@ -623,11 +925,11 @@ static const DRAW_TEXT_FUNC_RGB antiAliasedDrawTextFcns_RGB[] =
     /* int8_T */
     NULL,
     /* uint8_T */
-    NULL,
+    MWVIP_DrawText_RGB_uint8_AA,
     /* int16_T */
     NULL,
     /* uint16_T */
-    NULL,
+    MWVIP_DrawText_RGB_uint16_AA,
     /* int32_T */
     NULL,
     /* uint32_T */
@@ -645,11 +947,11 @@ static const DRAW_TEXT_FUNC_RGB drawTextFcns_RGB[] =
     /* int8_T */
     NULL,
     /* uint8_T */
-    NULL,
+    MWVIP_DrawText_RGB_uint8,
     /* int16_T */
     NULL,
     /* uint16_T */
-    NULL,
+    MWVIP_DrawText_RGB_uint16,
     /* int32_T */
     NULL,
     /* uint32_T */
@@ -669,11 +971,11 @@ static const DRAW_TEXT_FUNC_I antiAliasedDrawTextFcns_Intensity[] =
     /* int8_T */
     NULL,
     /* uint8_T */
-    NULL,
+    MWVIP_DrawText_I_uint8_AA,
     /* int16_T */
     NULL,
     /* uint16_T */
-    NULL,
+    MWVIP_DrawText_I_uint16_AA,
     /* int32_T */
     NULL,
     /* uint32_T */
@@ -693,11 +995,11 @@ static const DRAW_TEXT_FUNC_I drawTextFcns_Intensity[] =
     /* int8_T */
     NULL,
     /* uint8_T */
-    NULL,
+    MWVIP_DrawText_I_uint8,
     /* int16_T */
     NULL,
     /* uint16_T */
-    NULL,
+    MWVIP_DrawText_I_uint16,
     /* int32_T */
     NULL,
     /* uint32_T */
@@ -720,6 +1022,118 @@ static const DRAW_TEXT_FUNC_I* drawTextFunctions_I[] =
 };
 
 
+/*
+ * Glyph runs: all the glyphs of a string are drawn with one call. Glyphs
+ * that lie entirely outside the image are skipped before the kernel is
+ * called.
+ */
+static boolean_T DrawTextGlyphIsVisible(const MWVIP_DRAWTEXT_GLYPH* glyph,
+                                        uint32_T imageWidth,
+                                        uint32_T imageHeight,
+                                        boolean_T isImageTransposed)
+{
+    MWVIP_DRAWTEXT_CLIP clip;
+    if (isImageTransposed) {
+        DrawTextClip(glyph->pen_y - glyph->top_bearing, glyph->pen_x + glyph->left_bearing,
+                     glyph->bitmapHeight, glyph->bitmapWidth, imageWidth, imageHeight, &clip);
+    } else {
+        DrawTextClip(glyph->pen_x + glyph->left_bearing, glyph->pen_y - glyph->top_bearing,
+                     glyph->bitmapWidth, glyph->bitmapHeight, imageWidth, imageHeight, &clip);
+    }
+    return (boolean_T)((clip.iStart < clip.iEnd) && (clip.jStart < clip.jEnd));
+}
+
+LIBMWVISIONRT_API void MWVIP_DrawTextRun_RGB(DRAW_TEXT_FUNC_RGB drawTextFcn,
+                                             const MWVIP_DRAWTEXT_GLYPH* glyphs,
+                                             int32_T numGlyphs,
+                                             uint32_T imageWidth,
+                                             uint32_T imageHeight,
+                                             void* outputImageR,
+                                             void* outputImageG,
+                                             void* outputImageB,
+                                             const void* colorVect,
+                                             const void* opacityPtr,
+                                             boolean_T isImageTransposed)
+{
+    int32_T n;
+    for (n = 0; n < numGlyphs; n++) {
+        const MWVIP_DRAWTEXT_GLYPH* glyph = &glyphs[n];
+        if (glyph->bitmap == NULL ||
+            !DrawTextGlyphIsVisible(glyph, imageWidth, imageHeight, isImageTransposed))
+            continue;
+        drawTextFcn(glyph->bitmap, glyph->pen_x, glyph->pen_y,
+                    glyph->left_bearing, glyph->top_bearing,
+                    glyph->bitmapWidth, glyph->bitmapHeight,
+                    imageWidth, imageHeight,
+                    outputImageR, outputImageG, outputImageB,
+                    colorVect, opacityPtr, isImageTransposed);
+    }
+}
+
+LIBMWVISIONRT_API void MWVIP_DrawTextRun_I(DRAW_TEXT_FUNC_I drawTextFcn,
+                                           const MWVIP_DRAWTEXT_GLYPH* glyphs,
+                                           int32_T numGlyphs,
+                                           uint32_T imageWidth,
+                                           uint32_T imageHeight,
+                                           void* outputImageR,
+                                           const void* colorVect,
+                                           const void* opacityPtr,
+                                           boolean_T isImageTransposed)
+{
+    int32_T n;
+    for (n = 0; n < numGlyphs; n++) {
+        const MWVIP_DRAWTEXT_GLYPH* glyph = &glyphs[n];
+        if (glyph->bitmap == NULL ||
+            !DrawTextGlyphIsVisible(glyph, imageWidth, imageHeight, isImageTransposed))
+            continue;
+        drawTextFcn(glyph->bitmap, glyph->pen_x, glyph->pen_y,
+                    glyph->left_bearing, glyph->top_bearing,
+                    glyph->bitmapWidth, glyph->bitmapHeight,
+                    imageWidth, imageHeight,
+                    outputImageR, colorVect, opacityPtr, isImageTransposed);
+    }
+}
+
+
+LIBMWVISIONRT_API int32_T MWVIP_DrawText_LayoutGlyphs(const MWVIP_DRAWTEXT_ATLAS* atlas,
+                                                       const uint16_T* text,
+                                                       int32_T numChars,
+                                                       int32_T textLocX,
+                                                       int32_T textLocY,
+                                                       MWVIP_DRAWTEXT_GLYPH* glyphs)
+{
+    int32_T n, numGlyphs = 0;
+    int32_T penX = textLocX;
+    int32_T penY = textLocY + atlas->fontAscend; /* baseline of the first line */
+    for (n = 0; n < numChars; n++) {
+        const uint16_T charcode = text[n];
+        uint16_T glyphIdx;
+        if (charcode == 10U) {
+            penY += atlas->fontLinespace;
+            penX  = textLocX;
+            continue;
+        }
+        glyphIdx = (charcode < atlas->numCharcodes) ? atlas->glyphIdxFromCharcode[charcode] : 0U;
+        if (glyphIdx == 0U) {
+            penX += atlas->spaceCharWidth;
+            continue;
+        }
+        if (atlas->glyphWidths[glyphIdx] != 0U && atlas->glyphHeights[glyphIdx] != 0U) {
+            MWVIP_DRAWTEXT_GLYPH* glyph = &glyphs[numGlyphs++];
+            glyph->bitmap       = &atlas->glyphBitmapArray[atlas->glyphBitmapStartIdx[glyphIdx]];
+            glyph->pen_x        = penX;
+            glyph->pen_y        = penY;
+            glyph->left_bearing = atlas->glyphLeftBearings[glyphIdx];
+            glyph->top_bearing  = atlas->glyphTopBearings[glyphIdx];
+            glyph->bitmapWidth  = atlas->glyphWidths[glyphIdx];
+            glyph->bitmapHeight = atlas->glyphHeights[glyphIdx];
+        }
+        penX += atlas->glyphXAdvances[glyphIdx];
+    }
+    return numGlyphs;
+}
+
+
 LIBMWVISIONRT_API DRAW_TEXT_FUNC_RGB MWVIP_GetDrawTextFcn_RGB(int_T dataTypeID, boolean_T isAntiAliased)
 {
     DRAW_TEXT_FUNC_RGB ret = (drawTextFunctions_RGB[isAntiAliased])[dataTypeID];
@@ -0,0 +1,335 @@
+/*
+ *  CANNY_COLUMN_RT Column kernels shared by the Canny stages.
+ *
+ *  MWVIP_RC_Gaussian_Smoothing_* and MWVIP_NonMaximum_Suppression_* process
+ *  the whole image with these, and MWVIP_Canny_Fused_Magnitude_* one
+ *  column at a time, so both compute every pixel the same way.
+ *
+ *  Copyright 2016 The MathWorks, Inc.
+ */
+
+#ifndef canny_column_rt_h
+#define canny_column_rt_h
+
+#include "vipedge_rt.h"
+
+/* blur of one column along its rows, with circular boundaries. Rows whose
+ * taps do not wrap are filtered one tap at a time, which vectorizes. */
+MWVIP_INLINE void MWVIP_Canny_BlurCol_R(const real32_T *in,
+                                       const real32_T *gauss1D,
+                                       real32_T *out,
+                                       int_T inpRows,
+                                       int_T halfFiltLen)
+{
+    int_T r,k, R1, R2;
+    real32_T sumC;
+    /* rows [rBeg, rEnd) do not wrap around */
+    const int_T rBeg = (halfFiltLen-1 < inpRows) ? halfFiltLen-1 : inpRows;
+    const int_T rEnd = (inpRows-halfFiltLen+1 > rBeg) ? inpRows-halfFiltLen+1 : rBeg;
+
+    for (r=0; r<inpRows; r++)
+    {
+        if (r == rBeg) r = rEnd; /* interior below */
+        if (r >= inpRows) break;
+        sumC = gauss1D[0] * in[r];
+        for (k=1; k<halfFiltLen; k++)
+        {
+            R1 = (r+k)%inpRows; R2 = (r-k+inpRows)%inpRows;
+            sumC += gauss1D[k]*(in[R1] + in[R2]);
+        }
+        out[r] = sumC;
+    }
+    for (r=rBeg; r<rEnd; r++)
+    {
+        out[r] = gauss1D[0] * in[r];
+    }
+    for (k=1; k<halfFiltLen; k++)
+    {
+        const real32_T g = gauss1D[k];
+        for (r=rBeg; r<rEnd; r++)
+        {
+            out[r] += g*(in[r+k] + in[r-k]);
+        }
+    }
+}
+
+/* non-maximum suppression of rows 1 to inpRows-2 of one column, from the
+ * gradients of the columns on its left (L), itself (M) and its right (R) */
+MWVIP_INLINE void MWVIP_Canny_NMSCol_R(const real32_T *dcL,
+                                      const real32_T *dcM,
+                                      const real32_T *dcR,
+                                      const real32_T *drL,
+                                      const real32_T *drM,
+                                      const real32_T *drR,
+                                      real32_T *out,
+                                      int_T inpRows)
+{
+    int_T r;
+    real32_T ratio, mag, mag1, mag2, mag3, mag4, dc_rc, dr_rc;
+    real32_T mag12, mag34;
+
+    for (r=1; r<inpRows-1; r++)
+    {
+        /* gradient component dc_rc and dr_rc: they are directional */
+        dc_rc = dcM[r]; 
+        dr_rc = drM[r]; 
+
+        mag  = Rnorm(dc_rc, dr_rc);
+
+        /* get the nighboring four pixels' magnitude */
+
+        if (fabsf(dr_rc) > fabsf(dc_rc))
+        {
+            /* The derivative along row is biggest, so gradient direction is UP-DOWN */
+            ratio = fabsf(dc_rc)/fabsf(dr_rc);
+
+            mag2 = Rnorm(dcM[r-1], drM[r-1]);  
+            mag4 = Rnorm(dcM[r+1], drM[r+1]); 
+            if (dc_rc*dr_rc > 0)
+            {
+                mag3 = Rnorm(dcR[r+1], drR[r+1]);
+                mag1 = Rnorm(dcL[r-1], drL[r-1]);
+            } 
+            else
+            {
+                mag3 = Rnorm(dcL[r+1], drL[r+1]);
+                mag1 = Rnorm(dcR[r-1], drR[r-1]);
+            }
+        } 
+        else
+        {
+            /* The derivative along column is biggest, so gradient direction is LEFT-RIGHT */
+            ratio = fabsf(dr_rc)/fabsf(dc_rc);
+
+            mag2 = Rnorm(dcR[r], drR[r]);  
+            mag4 = Rnorm(dcL[r], drL[r]); 
+            if (dc_rc*dr_rc > 0)
+            {
+                mag3 = Rnorm(dcL[r-1], drL[r-1]);
+                mag1 = Rnorm(dcR[r+1], drR[r+1]);
+            }
+            else
+            {
+                mag1 = Rnorm(dcR[r-1], drR[r-1]);
+                mag3 = Rnorm(dcL[r+1], drL[r+1]);
+            }
+        }
+
+        /* interpolate the surrounding discrete grid values to get the gradient  */
+        /* magnitudes are calculated at the neighbourhood boundary in both       */
+        /* directions perpendicular to the centre pixel                          */
+
+        mag12 = ratio*mag1 + (1.0F-ratio)*mag2;
+        mag34 = ratio*mag3 + (1.0F-ratio)*mag4;
+
+        /* Non-maximal suppression means that the pixel (r,c) must have a larger */ 
+        /* gradient magnitude than its neighbors in the gradient direction       */
+
+        if ( (mag > mag12) && (mag > mag34) )  /* ratio always < 1 */
+        {
+            out[r] = mag;  
+        }
+        /* The next two items handle special case when a tie occurs. This is a
+           rare event that can happen with synthetic images. g676673 */
+        else if (mag >= mag12 && mag == mag34) /* for a perfect square this corresponds 
+                                                  to bottom and left edges */
+        {
+            out[r] = 0;
+
+            if ((fabs(dr_rc) > fabs(dc_rc)) && (drM[r] < 0 ))      /* up-down */
+            {
+                out[r] = mag;
+            }
+            else if ((fabs(dr_rc) < fabs(dc_rc)) && (dcM[r] > 0 )) /* right-left */
+            {
+                out[r] = mag;
+            }
+            else
+            {
+                out[r] = 0;
+            }
+        }
+        else if (mag == mag12 && mag >= mag34)
+        {
+            if ((fabs(dr_rc) > fabs(dc_rc)) && (drM[r] > 0 ))      /* up-down */
+            {
+                out[r] = mag;
+            }
+            else if ((fabs(dr_rc) < fabs(dc_rc)) && (dcM[r] < 0 )) /* right-left */
+            {
+                out[r] = mag;
+            }
+            else
+            {
+                out[r] = 0;
+            }
+        }
+        else
+        {
+            out[r] = 0; 
+        }
+
+    }
+}
+
+/* blur of one column along its rows, with circular boundaries. Rows whose
+ * taps do not wrap are filtered one tap at a time, which vectorizes. */
+MWVIP_INLINE void MWVIP_Canny_BlurCol_D(const real_T *in,
+                                       const real_T *gauss1D,
+                                       real_T *out,
+                                       int_T inpRows,
+                                       int_T halfFiltLen)
+{
+    int_T r,k, R1, R2;
+    real_T sumC;
+    /* rows [rBeg, rEnd) do not wrap around */
+    const int_T rBeg = (halfFiltLen-1 < inpRows) ? halfFiltLen-1 : inpRows;
+    const int_T rEnd = (inpRows-halfFiltLen+1 > rBeg) ? inpRows-halfFiltLen+1 : rBeg;
+
+    for (r=0; r<inpRows; r++)
+    {
+        if (r == rBeg) r = rEnd; /* interior below */
+        if (r >= inpRows) break;
+        sumC = gauss1D[0] * in[r];
+        for (k=1; k<halfFiltLen; k++)
+        {
+            R1 = (r+k)%inpRows; R2 = (r-k+inpRows)%inpRows;
+            sumC += gauss1D[k]*(in[R1] + in[R2]);
+        }
+        out[r] = sumC;
+    }
+    for (r=rBeg; r<rEnd; r++)
+    {
+        out[r] = gauss1D[0] * in[r];
+    }
+    for (k=1; k<halfFiltLen; k++)
+    {
+        const real_T g = gauss1D[k];
+        for (r=rBeg; r<rEnd; r++)
+        {
+            out[r] += g*(in[r+k] + in[r-k]);
+        }
+    }
+}
+
+/* non-maximum suppression of rows 1 to inpRows-2 of one column, from the
+ * gradients of the columns on its left (L), itself (M) and its right (R) */
+MWVIP_INLINE void MWVIP_Canny_NMSCol_D(const real_T *dcL,
+                                      const real_T *dcM,
+                                      const real_T *dcR,
+                                      const real_T *drL,
+                                      const real_T *drM,
+                                      const real_T *drR,
+                                      real_T *out,
+                                      int_T inpRows)
+{
+    int_T r;
+    real_T ratio, mag, mag1, mag2, mag3, mag4, dc_rc, dr_rc;
+    real_T mag12, mag34;
+
+    for (r=1; r<inpRows-1; r++)
+    {
+        /* gradient component dc_rc and dr_rc: they are directional */
+        dc_rc = dcM[r]; 
+        dr_rc = drM[r]; 
+
+        mag  = Dnorm(dc_rc, dr_rc);
+
+        /* get the nighboring four pixels' magnitude */
+
+        if (fabs(dr_rc) > fabs(dc_rc))
+        {
+            /* The derivative along row is biggest, so gradient direction is UP-DOWN */
+            ratio = fabs(dc_rc)/fabs(dr_rc);
+
+            mag2 = Dnorm(dcM[r-1], drM[r-1]);  
+            mag4 = Dnorm(dcM[r+1], drM[r+1]); 
+            if (dc_rc*dr_rc > 0)
+            {
+                mag3 = Dnorm(dcR[r+1], drR[r+1]);
+                mag1 = Dnorm(dcL[r-1], drL[r-1]);
+            } 
+            else
+            {
+                mag3 = Dnorm(dcL[r+1], drL[r+1]);
+                mag1 = Dnorm(dcR[r-1], drR[r-1]);
+            }
+        } 
+        else
+        {
+            /* The derivative along column is biggest, so gradient direction is LEFT-RIGHT */
+            ratio = fabs(dr_rc)/fabs(dc_rc);
+
+            mag2 = Dnorm(dcR[r], drR[r]);  
+            mag4 = Dnorm(dcL[r], drL[r]); 
+            if (dc_rc*dr_rc > 0)
+            {
+                mag3 = Dnorm(dcL[r-1], drL[r-1]);
+                mag1 = Dnorm(dcR[r+1], drR[r+1]);
+            }
+            else
+            {
+                mag1 = Dnorm(dcR[r-1], drR[r-1]);
+                mag3 = Dnorm(dcL[r+1], drL[r+1]);
+            }
+        }
+
+        /* interpolate the surrounding discrete grid values to get the gradient  */
+        /* magnitudes are calculated at the neighbourhood boundary in both       */
+        /* directions perpendicular to the centre pixel                          */
+
+        mag12 = ratio*mag1 + (1.0-ratio)*mag2;
+        mag34 = ratio*mag3 + (1.0-ratio)*mag4;
+
+        /* Non-maximal suppression means that the pixel (r,c) must have a larger */ 
+        /* gradient magnitude than its neighbors in the gradient direction       */
+
+        if ( (mag > mag12) && (mag > mag34) )  /* ratio always < 1 */
+        {
+            out[r] = mag; 
+        }
+        /* The next two items handle special case when a tie occurs. This is a
+           rare event that can happen with synthetic images. g676673 */
+        else if (mag >= mag12 && mag == mag34) /* for a perfect square this corresponds 
+                                                  to bottom and left edges */
+        {
+            out[r] = 0;
+
+            if ((fabs(dr_rc) > fabs(dc_rc)) && (drM[r] < 0 ))      /* up-down */
+            {
+                out[r] = mag;
+            }
+            else if ((fabs(dr_rc) < fabs(dc_rc)) && (dcM[r] > 0 )) /* right-left */
+            {
+                out[r] = mag;
+            }
+            else
+            {
+                out[r] = 0;
+            }
+        }
+        else if (mag == mag12 && mag >= mag34)
+        {
+            if ((fabs(dr_rc) > fabs(dc_rc)) && (drM[r] > 0 ))      /* up-down */
+            {
+                out[r] = mag;
+            }
+            else if ((fabs(dr_rc) < fabs(dc_rc)) && (dcM[r] < 0 )) /* right-left */
+            {
+                out[r] = mag;
+            }
+            else
+            {
+                out[r] = 0;
+            }
+        }
+        else
+        {
+            out[r] = 0; 
+        }
+    }
+}
+
+#endif /* canny_column_rt_h */
+
+/* [EOF] canny_column_rt.h */
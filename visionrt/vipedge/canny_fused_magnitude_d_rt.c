@@ -0,0 +1,147 @@
+/*
+ *  CANNY_FUSED_MAGNITUDE_D_RT Helper function for Edge block (Canny method).
+ *
+ *  Computes the normalized magnitude after non-maximum suppression, as
+ *  MWVIP_RC_Gaussian_Smoothing_D, MWVIP_C_Derivative_Image_D,
+ *  MWVIP_R_Derivative_Image_D and MWVIP_NonMaximum_Suppression_D in
+ *  sequence, but one column at a time: the intermediate images are never
+ *  written. lineBuffer holds (2*halfFiltLen+6)*inpRows elements:
+ *
+ *     2*halfFiltLen-1 columns blurred along the column, centered on c,
+ *       from which the derivative across the columns (dc) of c is taken,
+ *     3 columns of dc and 3 columns of dr, from which the suppression of
+ *       column c-1 is done, and
+ *     1 column blurred along the row, from which dr of c is taken.
+ *
+ *  Every pixel is computed with the same operations in the same order as
+ *  the separate stages, so tmpOrMag is the same.
+ *
+ *  Copyright 2016 The MathWorks, Inc.
+ */
+#include "canny_column_rt.h"
+
+LIBMWVISIONRT_API void MWVIP_Canny_Fused_Magnitude_D(const real_T *inpImg,
+                                                 const real_T *gauss1D,
+                                                 const real_T *dgauss1D,
+                                                 real_T *lineBuffer,
+                                                 real_T *tmpOrMag,
+                                                 int_T inpRows,
+                                                 int_T inpCols,
+                                                 int_T halfFiltLen)
+{
+    const int_T halfWin  = halfFiltLen-1;
+    const int_T winLen   = 2*halfFiltLen-1;
+    const int_T inpWidth = inpRows*inpCols;
+    real_T *cBlurRing = lineBuffer;
+    real_T *dcRing    = &cBlurRing[winLen*inpRows];
+    real_T *drRing    = &dcRing[3*inpRows];
+    real_T *rBlurCol  = &drRing[3*inpRows];
+    real_T maxMagnitude = 0;
+    int_T r,c,k,i,jj;
+
+    /* columns -halfWin..halfWin-1 of the window of column 0; column
+     * jj (unwrapped) is in slot jj mod winLen */
+    for (jj=-halfWin; jj<halfWin; jj++)
+    {
+        const int_T col  = ((jj % inpCols) + inpCols) % inpCols;
+        const int_T slot = ((jj % winLen) + winLen) % winLen;
+        MWVIP_Canny_BlurCol_D(&inpImg[col*inpRows],gauss1D,
+                              &cBlurRing[slot*inpRows],inpRows,halfFiltLen);
+    }
+
+    for (c=0; c<inpCols; c++)
+    {
+        const real_T *in = &inpImg[c*inpRows];
+        real_T *dcCol = &dcRing[(c%3)*inpRows];
+        real_T *drCol = &drRing[(c%3)*inpRows];
+
+        /* complete the window of column c */
+        {
+            const int_T col  = (c+halfWin) % inpCols;
+            const int_T slot = (c+halfWin) % winLen;
+            MWVIP_Canny_BlurCol_D(&inpImg[col*inpRows],gauss1D,
+                                  &cBlurRing[slot*inpRows],inpRows,halfFiltLen);
+        }
+
+        /* derivative across the columns of the column blur */
+        for (r=0; r<inpRows; r++)
+        {
+            dcCol[r] = 0;
+        }
+        for (k=1; k<halfFiltLen; k++)
+        {
+            const real_T dg = dgauss1D[k];
+            const real_T *in1 = &cBlurRing[((c+k) % winLen)*inpRows];
+            const real_T *in2 = &cBlurRing[(((c-k) % winLen + winLen) % winLen)*inpRows];
+            for (r=0; r<inpRows; r++)
+            {
+                dcCol[r] += dg*(-in1[r] + in2[r]);
+            }
+        }
+
+        /* blur along the row and derivative along the column */
+        for (r=0; r<inpRows; r++)
+        {
+            rBlurCol[r] = gauss1D[0] * in[r];
+        }
+        for (k=1; k<halfFiltLen; k++)
+        {
+            const real_T g = gauss1D[k];
+            const real_T *in1 = &inpImg[((c+k)%inpCols)*inpRows];
+            const real_T *in2 = &inpImg[((c-k+inpCols)%inpCols)*inpRows];
+            for (r=0; r<inpRows; r++)
+            {
+                rBlurCol[r] += g*(in1[r] + in2[r]);
+            }
+        }
+        for (r=0; r<inpRows; r++)
+        {
+            real_T sum = 0;
+            for (k=1; k<halfFiltLen; k++)
+            {
+                const int_T R1 = (r+k)%inpRows, R2 = (r-k+inpRows)%inpRows;
+                sum += dgauss1D[k]*(-rBlurCol[R1] + rBlurCol[R2]);
+            }
+            drCol[r] = sum;
+        }
+
+        /* column c-1 has both neighbours now */
+        if (c >= 2)
+        {
+            const int_T cM = c-1;
+            real_T *out = &tmpOrMag[cM*inpRows];
+            const int_T sL = (cM-1)%3, sM = cM%3, sR = c%3;
+            MWVIP_Canny_NMSCol_D(&dcRing[sL*inpRows],&dcRing[sM*inpRows],&dcRing[sR*inpRows],
+                                 &drRing[sL*inpRows],&drRing[sM*inpRows],&drRing[sR*inpRows],
+                                 out,inpRows);
+            /* top and bottom rows */
+            out[0] = Dnorm(dcRing[sM*inpRows], drRing[sM*inpRows]);
+            if (inpRows > 1)
+            {
+                out[inpRows-1] = Dnorm(dcRing[sM*inpRows+inpRows-1], drRing[sM*inpRows+inpRows-1]);
+            }
+        }
+        /* leftmost and rightmost columns */
+        if (c == 0 || c == inpCols-1)
+        {
+            real_T *out = &tmpOrMag[c*inpRows];
+            for (r=0; r<inpRows; r++)
+            {
+                out[r] = Dnorm(dcCol[r], drCol[r]);
+            }
+        }
+    }
+
+    /* find max magnitude and normalize magnitudes */
+    for (i=0; i<inpWidth; i++)
+    {
+        if (tmpOrMag[i]>maxMagnitude)  maxMagnitude=tmpOrMag[i];
+    }
+    if (maxMagnitude==0) maxMagnitude = DBL_EPSILON;
+    for (i=0; i<inpWidth; i++)
+    {
+        tmpOrMag[i] /=  maxMagnitude; /* now Magnitude is within [0 to 1]  */
+    }
+}
+
+/* [EOF] canny_fused_magnitude_d_rt.c */
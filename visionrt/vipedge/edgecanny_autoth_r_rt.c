@@ -5,122 +5,6 @@
  */
 #include "vipedge_rt.h"  
 
-static void TrackNonRecursive_AR ( boolean_T *edge, 
-                                real32_T  *tmpOrMag,
-                                int16_T   *stackR,
-                                int16_T   *stackC,
-                                int16_T   *stackP,
-                                int16_T   *stackQ,
-                                int_T      r, 
-                                int_T      c, 
-                                real32_T   lowTh, 
-                                int_T      inpRows, 
-                                int_T      inpCols
-                               )
-{
-    int_T p,q,R,C,P,Q;
-    int_T stackIdx            = -1;
-    int_T stackMaxLength      = (inpRows*inpCols);
-    int_T init                = 1;
-    boolean_T prevIsStackDecr = 0;
-    boolean_T IsStackIncr     = 1; 
-    boolean_T IsStackDecr     = 0; 
-    
-   while ((stackIdx>=0 && stackIdx < stackMaxLength) || init)
-   {  
-   /* stackIdx < stackMaxLength this avoids stack overflow;           */
-   /* if stack goes beyond this maxLength, the routine quits and this */
-   /* will give wrong result */
-
-    /*********** init and stack increment stage **********/
-    if (IsStackIncr)
-    {
-        R = init? r : stackR[stackIdx] + stackP[stackIdx]; /* Iold+p; */
-        C = init? c : stackC[stackIdx] + stackQ[stackIdx]; /* Jold+q; */
-
-        IsStackIncr = 0;
-
-        if (edge[R+C*inpRows] == 0) 
-        {
-            edge[R+C*inpRows] = 1;  
-                
-            for (p= -1; p<=1; p++)  
-            {
-                for(q= -1; q<=1; q++)   
-                {
-                    if (p==0 && q==0) continue;
-                    if (isInRange(R+p, C+q, inpRows, inpCols) && 
-                        tmpOrMag[(R+p)+(C+q)*inpRows] >= lowTh)
-                    {
-                        stackIdx++;
-                        stackR[stackIdx] = (int16_T)R; /* Iold+p; */
-                        stackC[stackIdx] = (int16_T)C; /* Jold+q; */
-
-                        stackP[stackIdx] = (int16_T)p; 
-                        stackQ[stackIdx] = (int16_T)q; 
-
-                        IsStackIncr=1;  
-                        prevIsStackDecr=0;
-                            
-                        break;
-                    }
-                }  
-                if (IsStackIncr) break;   
-            } 
-        }
-        if  (init)
-           init=0;
-        else
-           if (IsStackIncr==0) IsStackDecr=1;
-    }
-    /*********** stack decrement stage **********/
-    else if (IsStackDecr)
-    {
-        int_T skip_num_iter, count=0;  
-
-        R = stackR[stackIdx]; 
-        C = stackC[stackIdx]; 
-        P = stackP[stackIdx];
-        Q = stackQ[stackIdx];
-
-        skip_num_iter = 3*(P+1)+ (Q+1);
-        for (p= -1; p<=1; p++)  
-        {
-            for(q= -1; q<=1; q++,count++)   
-            {
-                if (count>skip_num_iter)
-                {
-                    if (p==0 && q==0) {continue;}
-                    if (!prevIsStackDecr && isInRange(R+p, C+q, inpRows, inpCols) && 
-                        tmpOrMag[(R+p)+(C+q)*inpRows] >= lowTh)
-                    {
-                        stackR[stackIdx] = (int16_T)R; /* R+p; */
-                        stackC[stackIdx] = (int16_T)C; /* C+q; */
-
-                        stackP[stackIdx] = (int16_T)p; 
-                        stackQ[stackIdx] = (int16_T)q; 
-
-                        IsStackDecr=0;  
-                        IsStackIncr=1;
-                        prevIsStackDecr=0;
-
-                        break;
-                    }
-                }
-
-            } 
-            if (IsStackIncr) break; 
-        } 
-        if (IsStackDecr) 
-        {
-            stackIdx--;
-            prevIsStackDecr=1;
-        }
-    }
-
-   }
-}
-
 static void EstimateAutoThreshold_R (real32_T *tmpOrMag, 
                                real32_T *highTh, 
                                real32_T *lowTh,
@@ -168,10 +52,7 @@ static void EstimateAutoThreshold_R (real32_T *tmpOrMag,
 
 static void HysteresisThresholding_AR (boolean_T *edge, 
                                     real32_T  *tmpOrMag,
-                                    int16_T   *stackR,
-                                    int16_T   *stackC,
-                                    int16_T   *stackP,
-                                    int16_T   *stackQ,
+                                    uint32_T  *worklist,
                                     real32_T   highTh, 
                                     real32_T   lowTh, 
                                     int_T      inpRows, 
@@ -179,25 +60,11 @@ static void HysteresisThresholding_AR (boolean_T *edge,
                                     int_T      quarterFiltLen,
                               const real32_T  *autoPercent)
 {
-    /* Hysteresis is used to track along the remaining pixels that have not      */
-    /* been suppressed. Hysteresis uses two thresholds and if the magnitude      */
-    /* is below the first threshold, it is set to zero (made a nonedge). If      */
-    /* the magnitude is above the high threshold, it is made an edge. And if     */
-    /* the magnitude is between the 2 thresholds, then it is set to zero unless  */
-    /* there is a path from this pixel to a pixel with a gradient above T2.      */
-
-    int_T r,c;
-    
-    memset(edge,0,inpRows*inpCols*sizeof(boolean_T));
-
     EstimateAutoThreshold_R (tmpOrMag, &highTh, &lowTh,inpRows,
                            inpCols,quarterFiltLen,autoPercent);
 
-    for (r=0; r<inpRows; r++)
-      for (c=0; c<inpCols; c++)
-        if (tmpOrMag[r+c*inpRows] >= highTh)
-             TrackNonRecursive_AR (edge,tmpOrMag,stackR,stackC,stackP,stackQ,
-                                r, c, lowTh, inpRows,inpCols);
+    MWVIP_Hysteresis_Thresholding_R (edge,tmpOrMag,worklist,highTh,lowTh,
+                                   inpRows,inpCols);
 }
 
 
@@ -216,10 +83,6 @@ LIBMWVISIONRT_API void MWVIP_EdgeCanny_autoTh_R(
 {
     real32_T lowTh  = 0; 
     real32_T highTh = 0;
-    int16_T *stackR;
-    int16_T *stackC;
-    int16_T *stackP;
-    int16_T *stackQ;
     const int_T quarterFiltLen = halfFiltLen/2;
     const int_T inpWidth       = inpRows*inpCols;
     int_T r,c;
@@ -239,12 +102,8 @@ LIBMWVISIONRT_API void MWVIP_EdgeCanny_autoTh_R(
     MWVIP_NonMaximum_Suppression_R(cFiltered,rFiltered,tmpOrMag,inpRows,inpCols); 
 
     /* step-5: Hysteresis thresholding of edge pixels */
-    stackR = (int16_T *)cFiltered;
-    stackC = (int16_T *)rFiltered;
-    stackP = &stackR[inpWidth];
-    stackQ = &stackC[inpWidth];
-
-    HysteresisThresholding_AR (outEdge,tmpOrMag,stackR,stackC,stackP,stackQ,
+    /* cFiltered is free again and holds the worklist */
+    HysteresisThresholding_AR (outEdge,tmpOrMag,(uint32_T *)cFiltered,
                             highTh,lowTh,inpRows,inpCols,
                             quarterFiltLen,autoPercent);
 
@@ -0,0 +1,122 @@
+/*
+ *  EDGECANNY_FUSED_AUTOTH_D_RT Helper function for Edge block (Canny method).
+ *
+ *  Same edges as MWVIP_EdgeCanny_autoTh_D. The smoothing, the derivatives and
+ *  the non-maximum suppression are done one column at a time by
+ *  MWVIP_Canny_Fused_Magnitude_D, so the only images written are the
+ *  magnitude and the edges. lineBuffer holds (2*halfFiltLen+6)*inpRows
+ *  elements and worklist inpRows*inpCols elements.
+ *
+ *  Copyright 2016 The MathWorks, Inc.
+ */
+#include "vipedge_rt.h"  
+
+static void EstimateAutoThreshold_FD (real_T *tmpOrMag, 
+                               real_T *highTh, 
+                               real_T *lowTh,
+                               int_T inpRows,
+                               int_T inpCols,
+                               int_T quarterFiltLen,
+                         const real_T *autoPercent)
+{
+    /* consider 256 bins in histogram */
+    int_T r,c,i, hist[N_BINS];
+    real_T PercentOfPixelsNotEdges = autoPercent[0]/100.0;  
+    real_T ThresholdRatio          = 0.4; /* Used for selecting thresholds */
+    int_T inpWidth                   = inpRows*inpCols;
+    real_T thresh                  = PercentOfPixelsNotEdges*inpWidth;
+    boolean_T done                   = false;
+    real_T sum_hist                = 0;
+
+
+    /* Build a histogram of the magnitude image. */
+    memset((byte_T *)hist,0,N_BINS*sizeof(int_T));
+
+    for (r=quarterFiltLen; r<inpRows-quarterFiltLen; r++)
+      for (c=quarterFiltLen; c<inpCols-quarterFiltLen; c++)
+      {
+        real_T valBasedIdx = (tmpOrMag[r+c*inpRows] * N_BINS_MIN1);   
+        hist[(uint8_T)valBasedIdx]++;  
+      }
+
+    /* highThresh = find(cumsum(counts) > PercentOfPixelsNotEdges*p*q,1,'first') / 64; */
+    done=false;
+    sum_hist=0;
+    i=0;
+    while(!done)
+    {
+        sum_hist += hist[i++];
+        if ((sum_hist>thresh) || (i >= N_BINS ))
+        {
+            highTh[0] = (real_T)i/N_BINS;
+            lowTh[0] = ThresholdRatio*highTh[0];
+            done=true;
+        }
+    }
+      
+}
+
+static void HysteresisThresholding_FAD (boolean_T *edge, 
+                                    real_T  *tmpOrMag,
+                                    uint32_T  *worklist,
+                                    real_T   highTh, 
+                                    real_T   lowTh, 
+                                    int_T      inpRows, 
+                                    int_T      inpCols,
+                                    int_T      quarterFiltLen,
+                              const real_T  *autoPercent)
+{
+    EstimateAutoThreshold_FD (tmpOrMag, &highTh, &lowTh,inpRows,
+                            inpCols,quarterFiltLen,autoPercent);
+
+    MWVIP_Hysteresis_Thresholding_D (edge,tmpOrMag,worklist,highTh,lowTh,
+                                   inpRows,inpCols);
+}
+
+
+LIBMWVISIONRT_API void MWVIP_EdgeCanny_Fused_autoTh_D(
+    const real_T  *inpImg,
+    const real_T  *gauss1D,
+    const real_T  *dgauss1D,
+          real_T  *lineBuffer, /* DWork (2*halfFiltLen+6) columns */
+         boolean_T  *outEdge,
+          real_T  *tmpOrMag,   /* DWork same size as image */
+        uint32_T  *worklist,   /* DWork same size as image */
+    const real_T  *autoPercent,
+          int_T  inpRows,
+          int_T  inpCols,
+          int_T  halfFiltLen)
+{
+    real_T lowTh  = 0; 
+    real_T highTh = 0;
+    const int_T quarterFiltLen = halfFiltLen/2;
+    int_T r,c;
+    
+    /* step-1 to step-4: smoothing, derivatives and non-maximum suppression */
+    MWVIP_Canny_Fused_Magnitude_D(inpImg,gauss1D,dgauss1D,lineBuffer,tmpOrMag,
+                                 inpRows,inpCols,halfFiltLen);
+
+    /* step-5: Hysteresis thresholding of edge pixels */
+    HysteresisThresholding_FAD (outEdge,tmpOrMag,worklist,
+                            highTh,lowTh,inpRows,inpCols,
+                            quarterFiltLen,autoPercent);
+
+    /* step-6: Take care of border pixels */
+    for (r=0; r<quarterFiltLen; r++)
+      for (c=0; c<inpCols; c++)
+        outEdge[r+c*inpRows] = 0; 
+
+    for (r=inpRows-1; r>inpRows-1-quarterFiltLen; r--)
+      for (c=0; c<inpCols; c++)
+        outEdge[r+c*inpRows] = 0; 
+
+    for (r=0; r<inpRows; r++)
+      for (c=0; c<quarterFiltLen; c++)
+        outEdge[r+c*inpRows] = 0; 
+
+    for (r=0; r<inpRows; r++)
+      for (c=inpCols-quarterFiltLen-1; c<inpCols; c++)
+        outEdge[r+c*inpRows] = 0; 
+}
+
+/* [EOF] edgecanny_fused_autoth_d_rt.c */
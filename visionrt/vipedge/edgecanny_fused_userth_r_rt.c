@@ -0,0 +1,58 @@
+/*
+ *  EDGECANNY_FUSED_USERTH_R_RT Helper function for Edge block (Canny method).
+ *
+ *  Same edges as MWVIP_EdgeCanny_userTh_R. The smoothing, the derivatives and
+ *  the non-maximum suppression are done one column at a time by
+ *  MWVIP_Canny_Fused_Magnitude_R, so the only images written are the
+ *  magnitude and the edges. lineBuffer holds (2*halfFiltLen+6)*inpRows
+ *  elements and worklist inpRows*inpCols elements.
+ *
+ *  Copyright 2016 The MathWorks, Inc.
+ */
+#include "vipedge_rt.h"  
+
+LIBMWVISIONRT_API void MWVIP_EdgeCanny_Fused_userTh_R(
+    const real32_T  *inpImg,
+    const real32_T  *gauss1D,
+    const real32_T  *dgauss1D,
+          real32_T  *lineBuffer, /* DWork (2*halfFiltLen+6) columns */
+         boolean_T  *outEdge,
+          real32_T  *tmpOrMag,   /* DWork same size as image */
+          uint32_T  *worklist,   /* DWork same size as image */
+    const real32_T  *ThreshCanny,
+          int_T  inpRows,
+          int_T  inpCols,
+          int_T  halfFiltLen)
+{
+    real32_T lowTh  = ThreshCanny[0]; 
+    real32_T highTh = ThreshCanny[1];
+    const int_T quarterFiltLen = halfFiltLen/2;
+    int_T r,c;
+    
+    /* step-1 to step-4: smoothing, derivatives and non-maximum suppression */
+    MWVIP_Canny_Fused_Magnitude_R(inpImg,gauss1D,dgauss1D,lineBuffer,tmpOrMag,
+                                 inpRows,inpCols,halfFiltLen);
+
+    /* step-5: Hysteresis thresholding of edge pixels */
+    MWVIP_Hysteresis_Thresholding_R (outEdge,tmpOrMag,worklist,
+                                   highTh,lowTh,inpRows,inpCols);
+
+    /* step-6: Take care of border pixels */
+    for (r=0; r<quarterFiltLen; r++)
+      for (c=0; c<inpCols; c++)
+        outEdge[r+c*inpRows] = 0; 
+
+    for (r=inpRows-1; r>inpRows-1-quarterFiltLen; r--)
+      for (c=0; c<inpCols; c++)
+        outEdge[r+c*inpRows] = 0; 
+
+    for (r=0; r<inpRows; r++)
+      for (c=0; c<quarterFiltLen; c++)
+        outEdge[r+c*inpRows] = 0; 
+
+    for (r=0; r<inpRows; r++)
+      for (c=inpCols-quarterFiltLen-1; c<inpCols; c++)
+        outEdge[r+c*inpRows] = 0; 
+}
+
+/* [EOF] edgecanny_fused_userth_r_rt.c */
@@ -0,0 +1,131 @@
+/*
+ *  HYSTERESIS_THRESHOLDING_D_RT Helper function for Edge block (Canny method).
+ *
+ *  Hysteresis is used to track along the remaining pixels that have not
+ *  been suppressed. A pixel is an edge if its magnitude is at least
+ *  highTh, or at least lowTh with an 8-connected path of such pixels to
+ *  one at least highTh.
+ *
+ *  The pixels to visit are kept in worklist as 32-bit linear indices. A
+ *  pixel is marked when it is added, so it is added once at most and
+ *  worklist needs inpRows*inpCols elements. The image is cut into tiles
+ *  of MWVIP_EDGE_TILE_COLS columns (one tile unless compiled with OpenMP),
+ *  which are tracked independently, each in its own part of worklist.
+ *  The edges that meet at the tile boundaries are then tracked across the
+ *  tiles. The edges are those of a single tracking over the whole image.
+ *
+ *  Copyright 2016 The MathWorks, Inc.
+ */
+#include "vipedge_rt.h"  
+
+/* tracks the pixels of worklist[0..numItems-1] to their neighbours of
+ * columns [colBeg, colEnd) */
+static void MWVIP_HysteresisTrack_D(boolean_T *edge,
+                                   const real_T *mag,
+                                   uint32_T  *worklist,
+                                   int_T      numItems,
+                                   real_T      lowTh,
+                                   int_T      inpRows,
+                                   int_T      colBeg,
+                                   int_T      colEnd)
+{
+    int_T p,q;
+    while (numItems > 0)
+    {
+        const uint32_T idx = worklist[--numItems];
+        const int_T C = (int_T)(idx/(uint32_T)inpRows);
+        const int_T R = (int_T)idx - C*inpRows;
+
+        for (q= -1; q<=1; q++)
+        {
+            if (C+q < colBeg || C+q >= colEnd) continue;
+            for (p= -1; p<=1; p++)
+            {
+                const uint32_T nIdx = idx + (uint32_T)(q*inpRows + p);
+                if (R+p < 0 || R+p >= inpRows) continue;
+                if (!edge[nIdx] && mag[nIdx] >= lowTh)
+                {
+                    edge[nIdx] = 1;
+                    worklist[numItems++] = nIdx;
+                }
+            }
+        }
+    }
+}
+
+LIBMWVISIONRT_API void MWVIP_Hysteresis_Thresholding_D(boolean_T *edge,
+                                                   const real_T *mag,
+                                                   uint32_T  *worklist,
+                                                   real_T      highTh,
+                                                   real_T      lowTh,
+                                                   int_T      inpRows,
+                                                   int_T      inpCols)
+{
+#ifdef MWVIP_EDGE_PARALLEL
+    const int_T tileCols = MWVIP_EDGE_TILE_COLS;
+#else
+    const int_T tileCols = (inpCols > 0) ? inpCols : 1;
+#endif
+    const int_T numTiles = (inpCols + tileCols - 1)/tileCols;
+    int_T tile, b, r;
+    int_T numItems = 0;
+
+    memset(edge,0,inpRows*inpCols*sizeof(boolean_T));
+
+    /* phase 1: track each tile on its own */
+#ifdef MWVIP_EDGE_PARALLEL
+#pragma omp parallel for schedule(dynamic) if (numTiles > 1)
+#endif
+    for (tile=0; tile<numTiles; tile++)
+    {
+        const int_T colBeg = tile*tileCols;
+        const int_T colEnd = (colBeg+tileCols < inpCols) ? colBeg+tileCols : inpCols;
+        uint32_T *tileList = &worklist[colBeg*inpRows];
+        int_T tileItems = 0;
+        uint32_T idx;
+
+        for (idx=(uint32_T)(colBeg*inpRows); idx<(uint32_T)(colEnd*inpRows); idx++)
+        {
+            if (mag[idx] >= highTh)
+            {
+                edge[idx] = 1;
+                tileList[tileItems++] = idx;
+            }
+        }
+        MWVIP_HysteresisTrack_D(edge,mag,tileList,tileItems,lowTh,
+                                inpRows,colBeg,colEnd);
+    }
+
+    /* phase 2: continue the edges through the tile boundaries */
+    for (b=1; b<numTiles; b++)
+    {
+        const int_T cR = b*tileCols; /* first column right of the boundary */
+        for (r=0; r<inpRows; r++)
+        {
+            int_T p;
+            for (p= -1; p<=1; p++)
+            {
+                uint32_T idxL, idxR;
+                if (r+p < 0 || r+p >= inpRows) continue;
+                idxL = (uint32_T)((cR-1)*inpRows + r);
+                idxR = (uint32_T)(cR*inpRows + r+p);
+                if (edge[idxL] && !edge[idxR] && mag[idxR] >= lowTh)
+                {
+                    edge[idxR] = 1;
+                    worklist[numItems++] = idxR;
+                }
+                idxL = (uint32_T)((cR-1)*inpRows + r+p);
+                idxR = (uint32_T)(cR*inpRows + r);
+                if (edge[idxR] && !edge[idxL] && mag[idxL] >= lowTh)
+                {
+                    edge[idxL] = 1;
+                    worklist[numItems++] = idxL;
+                }
+            }
+        }
+    }
+    MWVIP_HysteresisTrack_D(edge,mag,worklist,numItems,lowTh,
+                            inpRows,0,inpCols);
+}
+
+/* [EOF] hysteresis_thresholding_d_rt.c */
@@ -3,7 +3,7 @@
  *
  *  Copyright 1995-2005 The MathWorks, Inc.
  */
-#include "vipedge_rt.h"  
+#include "canny_column_rt.h"
 
 LIBMWVISIONRT_API void MWVIP_NonMaximum_Suppression_R(real32_T *dc,
                                   real32_T *dr,
@@ -13,114 +13,14 @@ LIBMWVISIONRT_API void MWVIP_NonMaximum_Suppression_R(real32_T *dc,
 {   
     int_T r,c,i;
     int_T RC_mi_1;
-    real32_T ratio, mag, mag1, mag2, mag3, mag4, dc_rc, dr_rc;
-    real32_T mag12, mag34;
     int_T inpWidth        = inpRows*inpCols;
     real32_T maxMagnitude = 0;
-    for (r=1; r<inpRows-1; r++)
+    for (c=1; c<inpCols-1; c++)
     {
-      for (c=1; c<inpCols-1; c++)
-      {
-        /* gradient component dc_rc and dr_rc: they are directional */
-        dc_rc = dc[r+c*inpRows]; 
-        dr_rc = dr[r+c*inpRows]; 
-
-        mag  = Rnorm(dc_rc, dr_rc);
-
-        /* get the nighboring four pixels' magnitude */
-
-        if (fabsf(dr_rc) > fabsf(dc_rc))
-        {
-            /* The derivative along row is biggest, so gradient direction is UP-DOWN */
-            ratio = fabsf(dc_rc)/fabsf(dr_rc);
-
-            mag2 = Rnorm(dc[(r-1)+c*inpRows], dr[(r-1)+c*inpRows]);  
-            mag4 = Rnorm(dc[(r+1)+c*inpRows], dr[(r+1)+c*inpRows]); 
-            if (dc_rc*dr_rc > 0)
-            {
-                mag3 = Rnorm(dc[(r+1)+(c+1)*inpRows], dr[(r+1)+(c+1)*inpRows]);
-                mag1 = Rnorm(dc[(r-1)+(c-1)*inpRows], dr[(r-1)+(c-1)*inpRows]);
-            } 
-            else
-            {
-                mag3 = Rnorm(dc[(r+1)+(c-1)*inpRows], dr[(r+1)+(c-1)*inpRows]);
-                mag1 = Rnorm(dc[(r-1)+(c+1)*inpRows], dr[(r-1)+(c+1)*inpRows]);
-            }
-        } 
-        else
-        {
-            /* The derivative along column is biggest, so gradient direction is LEFT-RIGHT */
-            ratio = fabsf(dr_rc)/fabsf(dc_rc);
-
-            mag2 = Rnorm(dc[r+(c+1)*inpRows], dr[r+(c+1)*inpRows]);  
-            mag4 = Rnorm(dc[r+(c-1)*inpRows], dr[r+(c-1)*inpRows]); 
-            if (dc_rc*dr_rc > 0)
-            {
-                mag3 = Rnorm(dc[(r-1)+(c-1)*inpRows], dr[(r-1)+(c-1)*inpRows]);
-                mag1 = Rnorm(dc[(r+1)+(c+1)*inpRows], dr[(r+1)+(c+1)*inpRows]);
-            }
-            else
-            {
-                mag1 = Rnorm(dc[(r-1)+(c+1)*inpRows], dr[(r-1)+(c+1)*inpRows]);
-                mag3 = Rnorm(dc[(r+1)+(c-1)*inpRows], dr[(r+1)+(c-1)*inpRows]);
-            }
-        }
-
-        /* interpolate the surrounding discrete grid values to get the gradient  */
-        /* magnitudes are calculated at the neighbourhood boundary in both       */
-        /* directions perpendicular to the centre pixel                          */
-
-        mag12 = ratio*mag1 + (1.0F-ratio)*mag2;
-        mag34 = ratio*mag3 + (1.0F-ratio)*mag4;
-
-        /* Non-maximal suppression means that the pixel (r,c) must have a larger */ 
-        /* gradient magnitude than its neighbors in the gradient direction       */
-
-        if ( (mag > mag12) && (mag > mag34) )  /* ratio always < 1 */
-        {
-            tmpOrMag[r+c*inpRows] = mag;  
-        }
-        /* The next two items handle special case when a tie occurs. This is a
-           rare event that can happen with synthetic images. g676673 */
-        else if (mag >= mag12 && mag == mag34) /* for a perfect square this corresponds 
-                                                  to bottom and left edges */
-        {
-            tmpOrMag[r+c*inpRows] = 0;
-
-            if ((fabs(dr_rc) > fabs(dc_rc)) && (dr[r+c*inpRows] < 0 ))      /* up-down */
-            {
-                tmpOrMag[r+c*inpRows] = mag;
-            }
-            else if ((fabs(dr_rc) < fabs(dc_rc)) && (dc[r+c*inpRows] > 0 )) /* right-left */
-            {
-                tmpOrMag[r+c*inpRows] = mag;
-            }
-            else
-            {
-                tmpOrMag[r+c*inpRows] = 0;
-            }
-        }
-        else if (mag == mag12 && mag >= mag34)
-        {
-            if ((fabs(dr_rc) > fabs(dc_rc)) && (dr[r+c*inpRows] > 0 ))      /* up-down */
-            {
-                tmpOrMag[r+c*inpRows] = mag;
-            }
-            else if ((fabs(dr_rc) < fabs(dc_rc)) && (dc[r+c*inpRows] < 0 )) /* right-left */
-            {
-                tmpOrMag[r+c*inpRows] = mag;
-            }
-            else
-            {
-                tmpOrMag[r+c*inpRows] = 0;
-            }
-        }
-        else
-        {
-            tmpOrMag[r+c*inpRows] = 0; 
-        }
-
-      }
+        const int_T idx = c*inpRows;
+        MWVIP_Canny_NMSCol_R(&dc[idx-inpRows],&dc[idx],&dc[idx+inpRows],
+                             &dr[idx-inpRows],&dr[idx],&dr[idx+inpRows],
+                             &tmpOrMag[idx],inpRows);
     }
 
     /* setting the magnitude of four border pixels */
@@ -1,9 +1,17 @@
 /*
  *  RC_GAUSSIAN_SMOOTHING_R_RT Helper function for Edge block (Canny method).
  *
- *  Copyright 1995-2005 The MathWorks, Inc.
+ *  filteredDataC is input blurred along each column and filteredDataR
+ *  input blurred along each row, both with circular boundaries. Rows whose
+ *  taps do not wrap are filtered without index arithmetic, one tap at a
+ *  time over the contiguous rows of a column, which vectorizes. The row
+ *  direction blur is done on strips of MWVIP_EDGE_STRIP_ROWS rows, so that
+ *  the columns read by the taps stay in cache. The sums are accumulated in
+ *  the same order for every pixel as before.
+ *
+ *  Copyright 1995-2016 The MathWorks, Inc.
  */
-#include "vipedge_rt.h"  
+#include "canny_column_rt.h"
 
 LIBMWVISIONRT_API void MWVIP_RC_Gaussian_Smoothing_R(const real32_T *input,
                                               const real32_T *gauss1D,
@@ -14,29 +22,41 @@ LIBMWVISIONRT_API void MWVIP_RC_Gaussian_Smoothing_R(const real32_T *input,
                                               int_T halfFiltLen)
 {   
     /* (1D Separable convolution) */
-    int_T r,c,k, R1, R2, C1, C2;
-    real32_T sumC, sumR;
-    int32_T linIdx_rc; /* linear index of [r][c]: c*inpRows+r */
+    int_T r,c,k, C1, C2, strip;
+
+    /* Blur in the column direction */
+    for (c=0; c<inpCols; c++)
+    {
+        MWVIP_Canny_BlurCol_R(&input[c*inpRows],gauss1D,&filteredDataC[c*inpRows],
+                              inpRows,halfFiltLen);
+    }
 
-    for (r=0; r<inpRows; r++)
+    /* Blur in the row direction */
+    for (strip=0; strip<inpRows; strip+=MWVIP_EDGE_STRIP_ROWS)
     {
+        const int_T stripLen = (inpRows-strip < MWVIP_EDGE_STRIP_ROWS) ?
+                               inpRows-strip : MWVIP_EDGE_STRIP_ROWS;
         for (c=0; c<inpCols; c++)
         {
-            linIdx_rc = c*inpRows+r;
-            sumC = gauss1D[0] * input[linIdx_rc]; 
-            sumR = sumC;  
+            const real32_T *in = &input[c*inpRows + strip];
+            real32_T *out = &filteredDataR[c*inpRows + strip];
+
+            for (r=0; r<stripLen; r++)
+            {
+                out[r] = gauss1D[0] * in[r];
+            }
             for (k=1; k<halfFiltLen; k++)
             {
-                /* Blur in the column direction  */
-                R1 = (r+k)%inpRows; R2 = (r-k+inpRows)%inpRows;
-                sumC += gauss1D[k]*(input[c*inpRows+R1] + input[c*inpRows+R2]);
-
-                /* Blur in the row direction */
+                const real32_T g = gauss1D[k];
+                const real32_T *in1, *in2;
                 C1 = (c+k)%inpCols; C2 = (c-k+inpCols)%inpCols;
-                sumR += gauss1D[k]*(input[C1*inpRows+r] + input[C2*inpRows+r]);
+                in1 = &input[C1*inpRows + strip];
+                in2 = &input[C2*inpRows + strip];
+                for (r=0; r<stripLen; r++)
+                {
+                    out[r] += g*(in1[r] + in2[r]);
+                }
             }
-            filteredDataC[linIdx_rc] = sumC; 
-            filteredDataR[linIdx_rc] = sumR;
         }
     }
 }
@@ -0,0 +1,99 @@
+/*
+ *  byteswap_frame_rt.c
+ *
+ *  Reverses the bytes of each of the numElems elements of bpe bytes in
+ *  src and writes them to dst, which may be src. Meant to be applied once
+ *  to a whole frame of a big endian stream, in place of MWVIP_byteSwapN
+ *  and MWVIP_WriteByteSwapN per element. Elements of 2, 4 and 8 bytes are
+ *  swapped 16 bytes at a time with pshufb (SSSE3), shifts and shuffles
+ *  (SSE2) or vrev (NEON).
+ *
+ *  Copyright 2016 The MathWorks, Inc.
+ */
+#include "vipendian_rt.h"
+
+#if defined(__ARM_NEON__) || defined(__ARM_NEON)
+#include <arm_neon.h>
+#define MWVIP_BYTESWAP_NEON 1
+#elif defined(__SSSE3__)
+#include <tmmintrin.h>
+#define MWVIP_BYTESWAP_SSSE3 1
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define MWVIP_BYTESWAP_SSE2 1
+#endif
+
+#if defined(MWVIP_BYTESWAP_SSE2)
+/* swaps the bytes of each 16 bit lane */
+static __m128i ByteSwap16(__m128i x)
+{
+    return _mm_or_si128(_mm_slli_epi16(x, 8), _mm_srli_epi16(x, 8));
+}
+#endif
+
+/* number of leading bytes swapped with SIMD instructions */
+static size_t ByteSwapVector(const byte_T *src, byte_T *dst, size_t numBytes, int_T bpe)
+{
+    size_t i = 0;
+#if defined(MWVIP_BYTESWAP_NEON)
+    for (; i + 16 <= numBytes; i += 16) {
+        uint8x16_t x = vld1q_u8(&src[i]);
+        x = (bpe == 2) ? vrev16q_u8(x) : (bpe == 4) ? vrev32q_u8(x) : vrev64q_u8(x);
+        vst1q_u8(&dst[i], x);
+    }
+#elif defined(MWVIP_BYTESWAP_SSSE3)
+    const __m128i mask = (bpe == 2) ?
+        _mm_setr_epi8(1, 0, 3, 2, 5, 4, 7, 6, 9, 8, 11, 10, 13, 12, 15, 14) :
+        (bpe == 4) ?
+        _mm_setr_epi8(3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12) :
+        _mm_setr_epi8(7, 6, 5, 4, 3, 2, 1, 0, 15, 14, 13, 12, 11, 10, 9, 8);
+    for (; i + 16 <= numBytes; i += 16) {
+        __m128i x = _mm_loadu_si128((const __m128i *)&src[i]);
+        _mm_storeu_si128((__m128i *)&dst[i], _mm_shuffle_epi8(x, mask));
+    }
+#elif defined(MWVIP_BYTESWAP_SSE2)
+    for (; i + 16 <= numBytes; i += 16) {
+        __m128i x = ByteSwap16(_mm_loadu_si128((const __m128i *)&src[i]));
+        if (bpe == 4) {
+            /* then swap the 16 bit halves of each 32 bit lane */
+            x = _mm_shufflehi_epi16(_mm_shufflelo_epi16(x, 0xB1), 0xB1);
+        } else if (bpe == 8) {
+            /* then reverse the 16 bit quarters of each 64 bit lane */
+            x = _mm_shufflehi_epi16(_mm_shufflelo_epi16(x, 0x1B), 0x1B);
+        }
+        _mm_storeu_si128((__m128i *)&dst[i], x);
+    }
+#else
+    (void)src;
+    (void)dst;
+    (void)numBytes;
+    (void)bpe;
+#endif
+    return i;
+}
+
+LIBMWVISIONRT_API void MWVIP_ByteSwapFrame(const void *src, void *dst,
+                                           int_T numElems, int_T bpe)
+{
+    const byte_T *in = (const byte_T *)src;
+    byte_T *out = (byte_T *)dst;
+    size_t numBytes = (size_t)numElems*bpe;
+    size_t i = 0;
+
+    if (bpe == 2 || bpe == 4 || bpe == 8) {
+        i = ByteSwapVector(in, out, numBytes, bpe);
+    }
+    for (; i < numBytes; i += bpe) {
+        /* element by element; correct in place as well */
+        int_T f = 0, r = bpe - 1;
+        while (f <= r) {
+            byte_T temp = in[i + f];
+            out[i + f] = in[i + r];
+            out[i + r] = temp;
+            f++;
+            r--;
+        }
+    }
+}
+
+/* [EOF] byteswap_frame_rt.c */
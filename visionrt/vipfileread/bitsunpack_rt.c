@@ -0,0 +1,40 @@
+/*
+*  BITSUNPACK_RT runtime function for VIPBLKS Read Binary File block
+*
+*  Unpacks numValues samples of numBits bits (1 to 16) from a bit stream
+*  held in memory, least significant bit first, as MWVIP_getValue reads
+*  them from the file. Each sample is extracted with one unaligned 32 bit
+*  load, shift and mask instead of one call per byte; the last samples,
+*  whose load would pass the end of the stream, are read byte by byte.
+*
+*  Copyright 2016 The MathWorks, Inc.
+*/
+#include "vipfileread_rt.h"
+
+LIBMWVISIONRT_API void MWVIP_BitsUnpack(const uint8_T *src,
+                                        uint16_T *dst,
+                                        int_T numValues,
+                                        int_T numBits)
+{
+    const uint32_T mask = (1U << numBits) - 1U;
+    size_t numBytes = ((size_t)numValues*numBits + 7) >> 3;
+    size_t pos = 0;
+    int_T i = 0;
+
+    for (; i < numValues && (pos >> 3) + 4 <= numBytes; i++, pos += numBits) {
+        const uint8_T *b = &src[pos >> 3];
+        uint32_T word = (uint32_T)b[0] | ((uint32_T)b[1] << 8) |
+                        ((uint32_T)b[2] << 16) | ((uint32_T)b[3] << 24);
+        dst[i] = (uint16_T)((word >> (pos & 7)) & mask);
+    }
+    for (; i < numValues; i++, pos += numBits) {
+        size_t k, last = (pos + numBits - 1) >> 3;
+        uint32_T word = 0;
+        for (k = pos >> 3; k <= last; k++) {
+            word |= (uint32_T)src[k] << (8*(k - (pos >> 3)));
+        }
+        dst[i] = (uint16_T)((word >> (pos & 7)) & mask);
+    }
+}
+
+/* [EOF] bitsunpack_rt.c */
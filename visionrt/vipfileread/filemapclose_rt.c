@@ -0,0 +1,32 @@
+/*
+*  FILEMAPCLOSE_RT runtime function for VIPBLKS Read Binary File block
+*
+*  Copyright 2016 The MathWorks, Inc.
+*/
+#include "vipfileread_rt.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#endif
+
+LIBMWVISIONRT_API void MWVIP_FileMapClose(void *mapDW)
+{
+    MWVIP_FILEMAP *map = (MWVIP_FILEMAP *) mapDW;
+#ifdef _WIN32
+    if (map->base != NULL) UnmapViewOfFile((LPCVOID)map->base);
+    if (map->mapHandle != NULL) CloseHandle((HANDLE)map->mapHandle);
+    if (map->fileHandle != NULL) CloseHandle((HANDLE)map->fileHandle);
+#else
+    if (map->base != NULL) munmap((void *)map->base, map->fileBytes);
+#endif
+    map->base       = NULL;
+    map->fileBytes  = 0;
+    map->numFrames  = 0;
+    map->curFrame   = 0;
+    map->fileHandle = NULL;
+    map->mapHandle  = NULL;
+}
+
+/* [EOF] filemapclose_rt.c */
@@ -0,0 +1,31 @@
+/*
+*  FILEMAPNEXTFRAME_RT runtime function for VIPBLKS Read Binary File block
+*
+*  Returns a pointer to the data of the current frame of the memory mapped
+*  source and moves to the next frame. At the end of the file, returns NULL
+*  and, as MWVIP_handleFilePtr does, decrements numLoops, rewinds and sets
+*  eofflag.
+*
+*  Copyright 2016 The MathWorks, Inc.
+*/
+#include "vipfileread_rt.h"
+
+LIBMWVISIONRT_API const uint8_T *MWVIP_FileMapNextFrame(void *mapDW,
+							  int32_T   *numLoops,
+							  boolean_T *eofflag)
+{
+    MWVIP_FILEMAP *map = (MWVIP_FILEMAP *) mapDW;
+    const uint8_T *frame;
+
+    if (map->curFrame >= map->numFrames) {
+        numLoops[0]--;
+        map->curFrame = 0;
+        eofflag[0] = 1;
+        return NULL;
+    }
+    frame = map->base + (size_t)map->curFrame*map->frameBytes;
+    map->curFrame++;
+    return frame;
+}
+
+/* [EOF] filemapnextframe_rt.c */
@@ -0,0 +1,94 @@
+/*
+*  FILEMAPOPEN_RT runtime function for VIPBLKS Read Binary File block
+*
+*  Maps FileName read only into mapDW, a MWVIP_FILEMAP. As with
+*  MWVIP_OpenAndCheckIfFileExists, returns true if the file cannot be
+*  opened or mapped.
+*
+*  Copyright 2016 The MathWorks, Inc.
+*/
+#if !defined(_WIN32) && !defined(_FILE_OFFSET_BITS)
+#define _FILE_OFFSET_BITS 64
+#endif
+#include "vipfileread_rt.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+LIBMWVISIONRT_API boolean_T MWVIP_FileMapOpen(void *mapDW, const char *FileName,
+                                              int_T frameBytes)
+{
+    MWVIP_FILEMAP *map = (MWVIP_FILEMAP *) mapDW;
+
+    map->base       = NULL;
+    map->fileBytes  = 0;
+    map->frameBytes = (size_t)frameBytes;
+    map->numFrames  = 0;
+    map->curFrame   = 0;
+    map->fileHandle = NULL;
+    map->mapHandle  = NULL;
+    if (frameBytes <= 0) return 1;
+
+#ifdef _WIN32
+    {
+        LARGE_INTEGER size;
+        HANDLE hFile = CreateFileA(FileName, GENERIC_READ, FILE_SHARE_READ, NULL,
+                                   OPEN_EXISTING, FILE_FLAG_RANDOM_ACCESS, NULL);
+        if (hFile == INVALID_HANDLE_VALUE) return 1;
+        if (!GetFileSizeEx(hFile, &size)) {
+            CloseHandle(hFile);
+            return 1;
+        }
+        map->fileHandle = (void *)hFile;
+        map->fileBytes  = (size_t)size.QuadPart;
+        if (map->fileBytes > 0) {
+            HANDLE hMap = CreateFileMappingA(hFile, NULL, PAGE_READONLY, 0, 0, NULL);
+            if (hMap == NULL) {
+                CloseHandle(hFile);
+                map->fileHandle = NULL;
+                return 1;
+            }
+            map->base = (const uint8_T *)MapViewOfFile(hMap, FILE_MAP_READ, 0, 0, 0);
+            if (map->base == NULL) {
+                CloseHandle(hMap);
+                CloseHandle(hFile);
+                map->fileHandle = NULL;
+                return 1;
+            }
+            map->mapHandle = (void *)hMap;
+        }
+    }
+#else
+    {
+        struct stat st;
+        int fd = open(FileName, O_RDONLY);
+        if (fd < 0) return 1;
+        if (fstat(fd, &st) != 0 || (off_t)(size_t)st.st_size != st.st_size) {
+            close(fd);
+            return 1;
+        }
+        map->fileBytes = (size_t)st.st_size;
+        if (map->fileBytes > 0) {
+            void *p = mmap(NULL, map->fileBytes, PROT_READ, MAP_SHARED, fd, 0);
+            if (p == MAP_FAILED) {
+                close(fd);
+                return 1;
+            }
+            map->base = (const uint8_T *)p;
+        }
+        /* the mapping stays valid once the descriptor is closed */
+        close(fd);
+    }
+#endif
+
+    map->numFrames = (int32_T)(map->fileBytes/map->frameBytes);
+    return 0;
+}
+
+/* [EOF] filemapopen_rt.c */
@@ -0,0 +1,19 @@
+/*
+*  FILEMAPSEEK_RT runtime function for VIPBLKS Read Binary File block
+*
+*  Positions the memory mapped source at the zero based frame frameIdx.
+*  A frame past the end makes the next read report the end of the file.
+*
+*  Copyright 2016 The MathWorks, Inc.
+*/
+#include "vipfileread_rt.h"
+
+LIBMWVISIONRT_API void MWVIP_FileMapSeek(void *mapDW, int32_T frameIdx)
+{
+    MWVIP_FILEMAP *map = (MWVIP_FILEMAP *) mapDW;
+    if (frameIdx < 0) frameIdx = 0;
+    if (frameIdx > map->numFrames) frameIdx = map->numFrames;
+    map->curFrame = frameIdx;
+}
+
+/* [EOF] filemapseek_rt.c */
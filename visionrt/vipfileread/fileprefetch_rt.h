@@ -0,0 +1,75 @@
+/*
+ *  FILEPREFETCH_RT Read-ahead source of the VIPBLKS Read Binary File block.
+ *
+ *  A background thread reads the file one frame at a time into a ring of
+ *  numSlots frame buffers and the model step takes the oldest filled slot,
+ *  so the step waits on disk I/O only when the reader falls behind. The
+ *  slot returned by MWVIP_FilePrefetchNextFrame stays owned by the step
+ *  until the next call, which hands it back to the reader.
+ *
+ *  A short read marks the slot as the end of the file, after which the
+ *  reader rewinds and carries on with the next loop of the file, as the
+ *  ReadLine functions do.
+ *
+ *  Copyright 2016 The MathWorks, Inc.
+ */
+
+#ifndef fileprefetch_rt_h
+#define fileprefetch_rt_h
+
+#include "vipfileread_rt.h"
+#include <stdio.h>
+
+#ifdef _WIN32
+#include <windows.h>
+typedef CRITICAL_SECTION   MWVIP_MUTEX;
+typedef CONDITION_VARIABLE MWVIP_COND;
+typedef HANDLE             MWVIP_THREAD;
+#define MWVIP_MUTEX_INIT(m)      InitializeCriticalSection(m)
+#define MWVIP_MUTEX_DESTROY(m)   DeleteCriticalSection(m)
+#define MWVIP_MUTEX_LOCK(m)      EnterCriticalSection(m)
+#define MWVIP_MUTEX_UNLOCK(m)    LeaveCriticalSection(m)
+#define MWVIP_COND_INIT(c)       InitializeConditionVariable(c)
+#define MWVIP_COND_DESTROY(c)
+#define MWVIP_COND_WAIT(c, m)    SleepConditionVariableCS((c), (m), INFINITE)
+#define MWVIP_COND_SIGNAL(c)     WakeConditionVariable(c)
+#else
+#include <pthread.h>
+typedef pthread_mutex_t    MWVIP_MUTEX;
+typedef pthread_cond_t     MWVIP_COND;
+typedef pthread_t          MWVIP_THREAD;
+#define MWVIP_MUTEX_INIT(m)      pthread_mutex_init((m), NULL)
+#define MWVIP_MUTEX_DESTROY(m)   pthread_mutex_destroy(m)
+#define MWVIP_MUTEX_LOCK(m)      pthread_mutex_lock(m)
+#define MWVIP_MUTEX_UNLOCK(m)    pthread_mutex_unlock(m)
+#define MWVIP_COND_INIT(c)       pthread_cond_init((c), NULL)
+#define MWVIP_COND_DESTROY(c)    pthread_cond_destroy(c)
+#define MWVIP_COND_WAIT(c, m)    pthread_cond_wait((c), (m))
+#define MWVIP_COND_SIGNAL(c)     pthread_cond_signal(c)
+#endif
+
+typedef struct {
+    FILE      *fptr;
+    size_t     frameBytes;
+    int_T      numSlots;
+    uint8_T   *buffers;    /* numSlots*frameBytes */
+    boolean_T *slotEof;    /* the slot is the end of the file */
+
+    /* ring state, guarded by lock */
+    int_T      head;       /* next slot to fill */
+    int_T      tail;       /* oldest filled slot */
+    int_T      count;      /* number of filled slots */
+    boolean_T  held;       /* the step owns the tail slot */
+    boolean_T  stop;
+    boolean_T  rewindReq;
+    uint32_T   generation; /* bumped by a rewind, to drop reads in flight */
+
+    MWVIP_MUTEX  lock;
+    MWVIP_COND   notEmpty;
+    MWVIP_COND   notFull;
+    MWVIP_THREAD thread;
+} MWVIP_FILEPREFETCH;
+
+#endif /* fileprefetch_rt_h */
+
+/* [EOF] fileprefetch_rt.h */
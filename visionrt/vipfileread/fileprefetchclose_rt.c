@@ -0,0 +1,36 @@
+/*
+*  FILEPREFETCHCLOSE_RT runtime function for VIPBLKS Read Binary File block
+*
+*  Copyright 2016 The MathWorks, Inc.
+*/
+#include "fileprefetch_rt.h"
+#include <stdlib.h>
+
+LIBMWVISIONRT_API void MWVIP_FilePrefetchClose(void *prefetchDW)
+{
+    MWVIP_FILEPREFETCH **pfDW = (MWVIP_FILEPREFETCH **) prefetchDW;
+    MWVIP_FILEPREFETCH *pf = pfDW[0];
+    if (pf == NULL) return;
+
+    MWVIP_MUTEX_LOCK(&pf->lock);
+    pf->stop = 1;
+    MWVIP_COND_SIGNAL(&pf->notFull);
+    MWVIP_MUTEX_UNLOCK(&pf->lock);
+#ifdef _WIN32
+    WaitForSingleObject(pf->thread, INFINITE);
+    CloseHandle(pf->thread);
+#else
+    pthread_join(pf->thread, NULL);
+#endif
+
+    MWVIP_COND_DESTROY(&pf->notFull);
+    MWVIP_COND_DESTROY(&pf->notEmpty);
+    MWVIP_MUTEX_DESTROY(&pf->lock);
+    fclose(pf->fptr);
+    free(pf->buffers);
+    free(pf->slotEof);
+    free(pf);
+    pfDW[0] = NULL;
+}
+
+/* [EOF] fileprefetchclose_rt.c */
@@ -0,0 +1,49 @@
+/*
+*  FILEPREFETCHNEXTFRAME_RT runtime function for VIPBLKS Read Binary File block
+*
+*  Hands the previous frame back to the read-ahead thread and returns the
+*  next one, waiting only if it has not been read yet. At the end of the
+*  file, returns NULL and, as MWVIP_handleFilePtr does, decrements
+*  numLoops and sets eofflag; a partial last frame is not returned.
+*
+*  Copyright 2016 The MathWorks, Inc.
+*/
+#include "fileprefetch_rt.h"
+
+LIBMWVISIONRT_API const uint8_T *MWVIP_FilePrefetchNextFrame(void *prefetchDW,
+							  int32_T   *numLoops,
+							  boolean_T *eofflag)
+{
+    MWVIP_FILEPREFETCH *pf = ((MWVIP_FILEPREFETCH **) prefetchDW)[0];
+    const uint8_T *frame = NULL;
+    boolean_T eof;
+
+    MWVIP_MUTEX_LOCK(&pf->lock);
+    if (pf->held) {
+        pf->tail = (pf->tail + 1) % pf->numSlots;
+        pf->count--;
+        pf->held = 0;
+        MWVIP_COND_SIGNAL(&pf->notFull);
+    }
+    while (pf->count == 0) {
+        MWVIP_COND_WAIT(&pf->notEmpty, &pf->lock);
+    }
+    eof = pf->slotEof[pf->tail];
+    if (eof) {
+        pf->tail = (pf->tail + 1) % pf->numSlots;
+        pf->count--;
+        MWVIP_COND_SIGNAL(&pf->notFull);
+    } else {
+        frame = &pf->buffers[(size_t)pf->tail*pf->frameBytes];
+        pf->held = 1;
+    }
+    MWVIP_MUTEX_UNLOCK(&pf->lock);
+
+    if (eof) {
+        numLoops[0]--;
+        eofflag[0] = 1;
+    }
+    return frame;
+}
+
+/* [EOF] fileprefetchnextframe_rt.c */
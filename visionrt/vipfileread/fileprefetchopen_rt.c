@@ -0,0 +1,105 @@
+/*
+*  FILEPREFETCHOPEN_RT runtime function for VIPBLKS Read Binary File block
+*
+*  Opens FileName and starts the read-ahead thread with a ring of
+*  numBuffers frames of frameBytes bytes. prefetchDW receives the state.
+*  As with MWVIP_OpenAndCheckIfFileExists, returns true on failure.
+*
+*  Copyright 2016 The MathWorks, Inc.
+*/
+#include "fileprefetch_rt.h"
+#include <stdlib.h>
+
+#ifdef _WIN32
+static DWORD WINAPI PrefetchThread(LPVOID arg)
+#else
+static void *PrefetchThread(void *arg)
+#endif
+{
+    MWVIP_FILEPREFETCH *pf = (MWVIP_FILEPREFETCH *) arg;
+
+    MWVIP_MUTEX_LOCK(&pf->lock);
+    while (!pf->stop) {
+        uint32_T generation;
+        uint8_T *slot;
+        size_t numRead;
+
+        if (pf->rewindReq) {
+            rewind(pf->fptr);
+            pf->rewindReq = 0;
+        }
+        if (pf->count == pf->numSlots) {
+            MWVIP_COND_WAIT(&pf->notFull, &pf->lock);
+            continue;
+        }
+
+        /* the step never touches the head slot while the ring is not full */
+        generation = pf->generation;
+        slot = &pf->buffers[(size_t)pf->head*pf->frameBytes];
+        MWVIP_MUTEX_UNLOCK(&pf->lock);
+        numRead = fread(slot, 1, pf->frameBytes, pf->fptr);
+        MWVIP_MUTEX_LOCK(&pf->lock);
+
+        if (pf->stop || generation != pf->generation) continue;
+        pf->slotEof[pf->head] = (numRead < pf->frameBytes);
+        if (pf->slotEof[pf->head]) rewind(pf->fptr);
+        pf->head = (pf->head + 1) % pf->numSlots;
+        pf->count++;
+        MWVIP_COND_SIGNAL(&pf->notEmpty);
+    }
+    MWVIP_MUTEX_UNLOCK(&pf->lock);
+    return 0;
+}
+
+LIBMWVISIONRT_API boolean_T MWVIP_FilePrefetchOpen(void *prefetchDW,
+                                                   const char *FileName,
+                                                   int_T frameBytes,
+                                                   int_T numBuffers)
+{
+    MWVIP_FILEPREFETCH **pfDW = (MWVIP_FILEPREFETCH **) prefetchDW;
+    MWVIP_FILEPREFETCH *pf;
+    boolean_T failed;
+
+    pfDW[0] = NULL;
+    if (frameBytes <= 0) return 1;
+    if (numBuffers < 2) numBuffers = 2;
+
+    pf = (MWVIP_FILEPREFETCH *)calloc(1, sizeof(MWVIP_FILEPREFETCH));
+    if (pf == NULL) return 1;
+    pf->fptr       = fopen(FileName, "rb");
+    pf->frameBytes = (size_t)frameBytes;
+    pf->numSlots   = numBuffers;
+    pf->buffers    = (uint8_T *)malloc((size_t)numBuffers*pf->frameBytes);
+    pf->slotEof    = (boolean_T *)calloc((size_t)numBuffers, sizeof(boolean_T));
+    if (pf->fptr == NULL || pf->buffers == NULL || pf->slotEof == NULL) {
+        if (pf->fptr != NULL) fclose(pf->fptr);
+        free(pf->buffers);
+        free(pf->slotEof);
+        free(pf);
+        return 1;
+    }
+
+    MWVIP_MUTEX_INIT(&pf->lock);
+    MWVIP_COND_INIT(&pf->notEmpty);
+    MWVIP_COND_INIT(&pf->notFull);
+#ifdef _WIN32
+    pf->thread = CreateThread(NULL, 0, PrefetchThread, pf, 0, NULL);
+    failed = (pf->thread == NULL);
+#else
+    failed = (pthread_create(&pf->thread, NULL, PrefetchThread, pf) != 0);
+#endif
+    if (failed) {
+        MWVIP_COND_DESTROY(&pf->notFull);
+        MWVIP_COND_DESTROY(&pf->notEmpty);
+        MWVIP_MUTEX_DESTROY(&pf->lock);
+        fclose(pf->fptr);
+        free(pf->buffers);
+        free(pf->slotEof);
+        free(pf);
+        return 1;
+    }
+    pfDW[0] = pf;
+    return 0;
+}
+
+/* [EOF] fileprefetchopen_rt.c */
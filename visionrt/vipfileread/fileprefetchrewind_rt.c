@@ -0,0 +1,27 @@
+/*
+*  FILEPREFETCHREWIND_RT runtime function for VIPBLKS Read Binary File block
+*
+*  Drops the frames read ahead and restarts the reader at the beginning of
+*  the file. The frame returned last must not be used afterwards.
+*
+*  Copyright 2016 The MathWorks, Inc.
+*/
+#include "fileprefetch_rt.h"
+
+LIBMWVISIONRT_API void MWVIP_FilePrefetchRewind(void *prefetchDW)
+{
+    MWVIP_FILEPREFETCH *pf = ((MWVIP_FILEPREFETCH **) prefetchDW)[0];
+    if (pf == NULL) return;
+
+    MWVIP_MUTEX_LOCK(&pf->lock);
+    pf->head  = 0;
+    pf->tail  = 0;
+    pf->count = 0;
+    pf->held  = 0;
+    pf->rewindReq = 1;
+    pf->generation++;
+    MWVIP_COND_SIGNAL(&pf->notFull);
+    MWVIP_MUTEX_UNLOCK(&pf->lock);
+}
+
+/* [EOF] fileprefetchrewind_rt.c */
@@ -0,0 +1,50 @@
+/*
+*  FOURCCFRAMEBYTES_RT runtime function for VIPBLKS Read Binary File block
+*
+*  Number of bytes of one rows-by-cols frame of a FourCC format, or 0 if
+*  the size of the format is not known. rows and cols are those of the
+*  Y component; the chroma sizes follow vipblkgetFOURCCLIST.m.
+*
+*  Copyright 2016 The MathWorks, Inc.
+*/
+#include "vipfileread_rt.h"
+#include "vip_fourcclist_sim.h"
+
+LIBMWVISIONRT_API int_T MWVIP_FourCC_FrameBytes(int_T fourcc, int_T rows, int_T cols)
+{
+    int_T numPix = rows*cols;
+    switch (fourcc) {
+    case AYUV:
+        return 4*numPix;
+    case IYU2:
+        return 3*numPix;
+    case cyuv: case IUYV: case UYNV: case UYVY: case Y422: case Y42T:
+    case YUNV: case YUY2: case YUYV: case YVYU:
+    case YV16:
+        return 2*numPix;
+    case IY41: case IYU1: case Y411: case Y41P: case Y41T:
+        return numPix + numPix/2;
+    case CLJR:
+    case GREY: case Y8: case Y800:
+        return numPix;
+    case I420: case IYUV: case YV12: case NV12: case NV21:
+    case IMC2: case IMC4:
+        return numPix + 2*(rows/2)*(cols/2);
+    case IMC1: case IMC3:
+        /* the chroma lines have the stride of the Y lines */
+        return numPix + 2*(rows/2)*cols;
+    case YVU9:
+        return numPix + 2*(rows/4)*(cols/4);
+    case IF09:
+        /* YVU9 followed by one delta byte per 4x4 block */
+        return numPix + 3*(rows/4)*(cols/4);
+    case V210:
+        /* groups of 6 pixels in 16 bytes, read as MWVIP_V210_ReadLine
+         * does, without padding of the lines */
+        return rows*(cols/6)*16;
+    default:
+        return 0;
+    }
+}
+
+/* [EOF] fourccframebytes_rt.c */
@@ -0,0 +1,51 @@
+/*
+*  FOURCCPLANEOFFSETS_RT runtime function for VIPBLKS Read Binary File block
+*
+*  Byte offsets of the Y, U and V planes inside a frame of a planar FourCC
+*  format. Each plane is stored row by row without padding, so a row
+*  major output can point into a mapped frame instead of copying it.
+*  Returns the number of planes: 3, 2 for the interleaved chroma of NV12
+*  and NV21, and 1 for the packed formats, whose frame is a single block.
+*
+*  Copyright 2016 The MathWorks, Inc.
+*/
+#include "vipfileread_rt.h"
+#include "vip_fourcclist_sim.h"
+
+LIBMWVISIONRT_API int_T MWVIP_FourCC_PlaneOffsets(int_T fourcc, int_T rows, int_T cols,
+                                                  int_T *planeOffsets)
+{
+    int_T numPix = rows*cols;
+    int_T chroma;
+
+    planeOffsets[0] = 0;
+    switch (fourcc) {
+    case I420: case IYUV:
+        chroma = (rows/2)*(cols/2);
+        planeOffsets[1] = numPix;
+        planeOffsets[2] = numPix + chroma;
+        return 3;
+    case YV12:
+        chroma = (rows/2)*(cols/2);
+        planeOffsets[1] = numPix + chroma;
+        planeOffsets[2] = numPix;
+        return 3;
+    case YV16:
+        chroma = rows*(cols/2);
+        planeOffsets[1] = numPix + chroma;
+        planeOffsets[2] = numPix;
+        return 3;
+    case YVU9: case IF09:
+        chroma = (rows/4)*(cols/4);
+        planeOffsets[1] = numPix + chroma;
+        planeOffsets[2] = numPix;
+        return 3;
+    case NV12: case NV21:
+        planeOffsets[1] = numPix;
+        return 2;
+    default:
+        return 1;
+    }
+}
+
+/* [EOF] fourccplaneoffsets_rt.c */
@@ -0,0 +1,248 @@
+/*
+ *  PACKED422_READFRAME_RT Frame-at-a-time reader for the packed 4:2:2
+ *  formats (YUY2, UYVY, YVYU, Y42T) of the VIPBLKS Read Binary File block.
+ *
+ *  The ReadLine functions read one byte per fread call. Here the whole
+ *  frame is read with a single fread into a staging buffer, which is then
+ *  deinterleaved into the column major Y, U and V planes. Each line of the
+ *  file is a row of the planes, so the deinterleave is a transpose: tiles
+ *  of 16 lines by 4 macropixels are transposed with 16x16 byte shuffles
+ *  (SSE2 or NEON), which gives one contiguous 16 byte store per column.
+ *
+ *  When the file ends inside the frame, the bytes that were read are
+ *  stored as the ReadLine functions would have stored them, and the
+ *  numLoops/rewind/eofflag handling is the same.
+ *
+ *  Copyright 2016 The MathWorks, Inc.
+ */
+
+#ifndef packed422_readframe_rt_h
+#define packed422_readframe_rt_h
+
+#include "vipfileread_rt.h"
+#include <stdio.h>
+
+#if defined(__ARM_NEON__) || defined(__ARM_NEON)
+#include <arm_neon.h>
+#define MWVIP_FILEREAD_NEON 1
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define MWVIP_FILEREAD_SSE2 1
+#endif
+
+/* byte offsets of the components inside a 4 byte macropixel */
+typedef struct {
+    int_T y0;
+    int_T u;
+    int_T y1;
+    int_T v;
+} MWVIP_PACKED422_LAYOUT;
+
+/* stores byte b of a macropixel; lsb is the Y42T plane, or NULL */
+MWVIP_INLINE void MWVIP_Packed422_StoreByte(const MWVIP_PACKED422_LAYOUT *lay,
+                                          int_T b, byte_T val,
+                                          byte_T *y, byte_T *u, byte_T *v,
+                                          byte_T *lsb, int_T r, int_T j,
+                                          int_T rows)
+{
+    if (b == lay->u) {
+        u[j*rows + r] = val;
+    } else if (b == lay->v) {
+        v[j*rows + r] = val;
+    } else {
+        int_T yIdx = 2*j*rows + r + ((b == lay->y1) ? rows : 0);
+        if (lsb != NULL) {
+            lsb[yIdx] = val & 0x01;
+            val &= 0xFE;
+        }
+        y[yIdx] = val;
+    }
+}
+
+/* deinterleaves lines [r0, r0+nLines) of the staging buffer */
+MWVIP_INLINE void MWVIP_Packed422_Scalar(const MWVIP_PACKED422_LAYOUT *lay,
+                                       const byte_T *stage,
+                                       byte_T *y, byte_T *u, byte_T *v,
+                                       byte_T *lsb, int_T r0, int_T nLines,
+                                       int_T j0, int_T rows, int_T cols)
+{
+    int_T r, j;
+    for (r = r0; r < r0 + nLines; r++) {
+        const byte_T *line = &stage[4*r*cols];
+        for (j = j0; j < cols; j++) {
+            const byte_T *mp = &line[4*j];
+            int_T rowsj  = j*rows + r;
+            int_T rowsj2 = 2*j*rows + r;
+            byte_T y0 = mp[lay->y0];
+            byte_T y1 = mp[lay->y1];
+            u[rowsj] = mp[lay->u];
+            v[rowsj] = mp[lay->v];
+            if (lsb != NULL) {
+                lsb[rowsj2]      = y0 & 0x01;
+                lsb[rowsj2+rows] = y1 & 0x01;
+                y0 &= 0xFE;
+                y1 &= 0xFE;
+            }
+            y[rowsj2]      = y0;
+            y[rowsj2+rows] = y1;
+        }
+    }
+}
+
+#if defined(MWVIP_FILEREAD_SSE2) || defined(MWVIP_FILEREAD_NEON)
+
+#if defined(MWVIP_FILEREAD_SSE2)
+typedef __m128i MWVIP_BYTE16;
+#define MWVIP_LOAD16(p)      _mm_loadu_si128((const __m128i *)(p))
+#define MWVIP_STORE16(p, a)  _mm_storeu_si128((__m128i *)(p), (a))
+#define MWVIP_ZIPLO16(a, b)  _mm_unpacklo_epi8((a), (b))
+#define MWVIP_ZIPHI16(a, b)  _mm_unpackhi_epi8((a), (b))
+#define MWVIP_AND16(a, m)    _mm_and_si128((a), _mm_set1_epi8((char)(m)))
+#else
+typedef uint8x16_t MWVIP_BYTE16;
+#define MWVIP_LOAD16(p)      vld1q_u8(p)
+#define MWVIP_STORE16(p, a)  vst1q_u8((p), (a))
+#define MWVIP_ZIPLO16(a, b)  vzipq_u8((a), (b)).val[0]
+#define MWVIP_ZIPHI16(a, b)  vzipq_u8((a), (b)).val[1]
+#define MWVIP_AND16(a, m)    vandq_u8((a), vdupq_n_u8((uint8_T)(m)))
+#endif
+
+/* transposes 16 lines by 4 macropixels starting at line r, macropixel j */
+MWVIP_INLINE void MWVIP_Packed422_Tile(const MWVIP_PACKED422_LAYOUT *lay,
+                                     const byte_T *stage,
+                                     byte_T *y, byte_T *u, byte_T *v,
+                                     byte_T *lsb, int_T r, int_T j,
+                                     int_T rows, int_T cols)
+{
+    MWVIP_BYTE16 a[16], b[16];
+    int_T i, s, m;
+
+    for (i = 0; i < 16; i++) {
+        a[i] = MWVIP_LOAD16(&stage[4*((r + i)*cols + j)]);
+    }
+    /* four perfect shuffles of the 16 vectors transpose the 16x16 bytes:
+     * a[k] then holds byte k of the 16 lines */
+    for (s = 0; s < 4; s++) {
+        for (i = 0; i < 8; i++) {
+            b[2*i]   = MWVIP_ZIPLO16(a[i], a[i+8]);
+            b[2*i+1] = MWVIP_ZIPHI16(a[i], a[i+8]);
+        }
+        for (i = 0; i < 16; i++) {
+            a[i] = b[i];
+        }
+    }
+
+    for (m = 0; m < 4; m++) {
+        int_T rowsj  = (j + m)*rows + r;
+        int_T rowsj2 = 2*(j + m)*rows + r;
+        MWVIP_BYTE16 y0 = a[4*m + lay->y0];
+        MWVIP_BYTE16 y1 = a[4*m + lay->y1];
+        MWVIP_STORE16(&u[rowsj], a[4*m + lay->u]);
+        MWVIP_STORE16(&v[rowsj], a[4*m + lay->v]);
+        if (lsb != NULL) {
+            MWVIP_STORE16(&lsb[rowsj2],      MWVIP_AND16(y0, 0x01));
+            MWVIP_STORE16(&lsb[rowsj2+rows], MWVIP_AND16(y1, 0x01));
+            y0 = MWVIP_AND16(y0, 0xFE);
+            y1 = MWVIP_AND16(y1, 0xFE);
+        }
+        MWVIP_STORE16(&y[rowsj2],      y0);
+        MWVIP_STORE16(&y[rowsj2+rows], y1);
+    }
+}
+
+#endif
+
+/* deinterleaves the first nLines complete lines of the staging buffer */
+MWVIP_INLINE void MWVIP_Packed422_Lines(const MWVIP_PACKED422_LAYOUT *lay,
+                                      const byte_T *stage,
+                                      byte_T *y, byte_T *u, byte_T *v,
+                                      byte_T *lsb, int_T nLines,
+                                      int_T rows, int_T cols)
+{
+    int_T r = 0;
+#if defined(MWVIP_FILEREAD_SSE2) || defined(MWVIP_FILEREAD_NEON)
+    int_T cols4 = cols & ~3;
+    for (; r + 16 <= nLines; r += 16) {
+        int_T j;
+        for (j = 0; j < cols4; j += 4) {
+            MWVIP_Packed422_Tile(lay, stage, y, u, v, lsb, r, j, rows, cols);
+        }
+        if (cols4 < cols) {
+            MWVIP_Packed422_Scalar(lay, stage, y, u, v, lsb, r, 16, cols4, rows, cols);
+        }
+    }
+#endif
+    MWVIP_Packed422_Scalar(lay, stage, y, u, v, lsb, r, nLines - r, 0, rows, cols);
+}
+
+/* reads a rows-by-cols macropixel frame; stageBuf holds 4*rows*cols bytes.
+ * With a NULL Y port the frame is left packed in stageBuf for the
+ * MWVIP_Packed422To* conversions of vipcolorconv_rt.h; past the end of the
+ * file it keeps the bytes of the previous frame, as the ports would. */
+MWVIP_INLINE boolean_T MWVIP_Packed422_ReadFrame(const MWVIP_PACKED422_LAYOUT *lay,
+                                               void *fptrDW,
+                                               uint8_T *stageBuf,
+                                               uint8_T *portAddr_0,
+                                               uint8_T *portAddr_1,
+                                               uint8_T *portAddr_2,
+                                               uint8_T *portAddr_3,
+                                               int32_T   *numLoops,
+                                               boolean_T *eofflag,
+                                               int_T rows,
+                                               int_T cols)
+{
+    FILE **fptr = (FILE **) fptrDW;
+    const byte_T *stage = (const byte_T *)stageBuf;
+    byte_T *y   = (byte_T *)portAddr_0;
+    byte_T *u   = (byte_T *)portAddr_1;
+    byte_T *v   = (byte_T *)portAddr_2;
+    byte_T *lsb = (byte_T *)portAddr_3;
+    size_t lineBytes  = 4*(size_t)cols;
+    size_t frameBytes = lineBytes*(size_t)rows;
+    size_t numRead;
+    int_T nLines;
+
+    if (frameBytes == 0) return 1;
+
+    numRead = fread(stageBuf, 1, frameBytes, fptr[0]);
+    nLines  = (int_T)(numRead/lineBytes);
+    if (y == NULL) {
+        if (numRead == frameBytes) return 1;
+        numLoops[0]--;
+        rewind(fptr[0]);
+        eofflag[0] = 1;
+        return 0;
+    }
+    MWVIP_Packed422_Lines(lay, stage, y, u, v, lsb, nLines, rows, cols);
+    if (numRead == frameBytes) return 1;
+
+    /* the rest of the last line, up to the end of the file */
+    {
+        size_t k;
+        size_t start = (size_t)nLines*lineBytes;
+        int_T jEof = (int_T)((numRead - start) >> 2);
+        for (k = start; k < numRead; k++) {
+            int_T j = (int_T)((k - start) >> 2);
+            int_T b = (int_T)((k - start) & 3);
+            MWVIP_Packed422_StoreByte(lay, b, stage[k], y, u, v,
+                                      (j < jEof) ? lsb : NULL, nLines, j, rows);
+        }
+        /* Y42T_ReadLine splits the Y bytes of the macropixel at the end of
+         * the file before it tests feof, whether or not they were read */
+        if (lsb != NULL) {
+            int_T yIdx = 2*jEof*rows + nLines;
+            lsb[yIdx]      = y[yIdx] & 0x01;
+            y[yIdx]        = y[yIdx] & 0xFE;
+            lsb[yIdx+rows] = y[yIdx+rows] & 0x01;
+            y[yIdx+rows]   = y[yIdx+rows] & 0xFE;
+        }
+    }
+    numLoops[0]--;
+    rewind(fptr[0]);
+    eofflag[0] = 1;
+    return 0;
+}
+
+#endif /* packed422_readframe_rt_h */
+
+/* [EOF] packed422_readframe_rt.h */
@@ -0,0 +1,160 @@
+/*
+*  V210_UNPACKFRAME_RT runtime function for VIPBLKS Read Binary File block
+*
+*  Unpacks a V210 frame held in memory (from MWVIP_FileMapNextFrame or
+*  MWVIP_FilePrefetchNextFrame) into the column major uint16 Y, U and V
+*  planes, as MWVIP_V210_ReadLine does line by line. Each line holds cols
+*  groups of 6 pixels in 4 little endian 32 bit words, with 3 10 bit
+*  samples per word. As in MWVIP_V210_ReadBits, the third sample of a word
+*  keeps the 2 padding bits above it.
+*
+*  The planes are column major, so 16 byte groups of 8 lines are unpacked
+*  together: the words are transposed 4x4 to gather one word of 4 lines
+*  per vector, the samples are extracted with shifts and masks and packed
+*  to 16 bits, which makes each store 8 contiguous samples of a column.
+*
+*  Copyright 2016 The MathWorks, Inc.
+*/
+#include "vipfileread_rt.h"
+
+#if defined(__ARM_NEON__) || defined(__ARM_NEON)
+#include <arm_neon.h>
+#define MWVIP_V210_NEON 1
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define MWVIP_V210_SSE2 1
+#endif
+
+/* plane and column, relative to the group, of the 12 samples of a group */
+static const int_T v210Plane[12] = {1, 0, 2,  0, 1, 0,  2, 0, 1,  0, 2, 0};
+static const int_T v210Col[12]   = {0, 0, 0,  1, 1, 2,  1, 3, 2,  4, 2, 5};
+
+static void V210UnpackScalar(const uint8_T *src, uint16_T **planes,
+                             int_T r0, int_T nLines, int_T rows, int_T cols)
+{
+    int_T r, j, k;
+    for (r = r0; r < r0 + nLines; r++) {
+        for (j = 0; j < cols; j++) {
+            const uint8_T *grp = &src[16*((size_t)r*cols + j)];
+            for (k = 0; k < 12; k++) {
+                const uint8_T *w = &grp[4*(k/3)];
+                uint32_T word = (uint32_T)w[0] | ((uint32_T)w[1] << 8) |
+                                ((uint32_T)w[2] << 16) | ((uint32_T)w[3] << 24);
+                int_T p = v210Plane[k];
+                int_T colsPerGroup = (p == 0) ? 6 : 3;
+                word >>= 10*(k % 3);
+                planes[p][(j*colsPerGroup + v210Col[k])*rows + r] =
+                    (uint16_T)((k % 3 == 2) ? word : (word & 0x3FF));
+            }
+        }
+    }
+}
+
+#if defined(MWVIP_V210_SSE2) || defined(MWVIP_V210_NEON)
+
+#if defined(MWVIP_V210_SSE2)
+typedef __m128i MWVIP_V210_VEC;
+#define V210_LOAD(p)        _mm_loadu_si128((const __m128i *)(p))
+#define V210_STORE(p, a)    _mm_storeu_si128((__m128i *)(p), (a))
+#define V210_MASK(w)        _mm_and_si128((w), _mm_set1_epi32(0x3FF))
+#define V210_SHIFT(w, s)    _mm_srli_epi32((w), (s))
+/* samples are below 4096, so the signed saturation does not clip */
+#define V210_PACK(lo, hi)   _mm_packs_epi32((lo), (hi))
+
+static void V210Transpose4(MWVIP_V210_VEC *x)
+{
+    __m128i t0 = _mm_unpacklo_epi32(x[0], x[1]);
+    __m128i t1 = _mm_unpacklo_epi32(x[2], x[3]);
+    __m128i t2 = _mm_unpackhi_epi32(x[0], x[1]);
+    __m128i t3 = _mm_unpackhi_epi32(x[2], x[3]);
+    x[0] = _mm_unpacklo_epi64(t0, t1);
+    x[1] = _mm_unpackhi_epi64(t0, t1);
+    x[2] = _mm_unpacklo_epi64(t2, t3);
+    x[3] = _mm_unpackhi_epi64(t2, t3);
+}
+#else
+typedef uint32x4_t MWVIP_V210_VEC;
+#define V210_LOAD(p)        vreinterpretq_u32_u8(vld1q_u8(p))
+#define V210_STORE(p, a)    vst1q_u16((p), (a))
+#define V210_MASK(w)        vandq_u32((w), vdupq_n_u32(0x3FF))
+#define V210_SHIFT(w, s)    vshrq_n_u32((w), (s))
+#define V210_PACK(lo, hi)   vcombine_u16(vmovn_u32(lo), vmovn_u32(hi))
+
+static void V210Transpose4(MWVIP_V210_VEC *x)
+{
+    uint32x4x2_t t0 = vtrnq_u32(x[0], x[1]);
+    uint32x4x2_t t1 = vtrnq_u32(x[2], x[3]);
+    x[0] = vcombine_u32(vget_low_u32(t0.val[0]),  vget_low_u32(t1.val[0]));
+    x[1] = vcombine_u32(vget_low_u32(t0.val[1]),  vget_low_u32(t1.val[1]));
+    x[2] = vcombine_u32(vget_high_u32(t0.val[0]), vget_high_u32(t1.val[0]));
+    x[3] = vcombine_u32(vget_high_u32(t0.val[1]), vget_high_u32(t1.val[1]));
+}
+#endif
+
+/* unpacks group j of lines r..r+7; the file is little endian, as is the
+ * host of the SIMD path */
+static void V210UnpackTile(const uint8_T *src, uint16_T **planes,
+                           int_T r, int_T j, int_T rows, int_T cols)
+{
+    MWVIP_V210_VEC lo[4], hi[4];
+    int_T i, k;
+
+    for (i = 0; i < 4; i++) {
+        lo[i] = V210_LOAD(&src[16*((size_t)(r + i)*cols + j)]);
+        hi[i] = V210_LOAD(&src[16*((size_t)(r + 4 + i)*cols + j)]);
+    }
+    /* lo[w], hi[w]: word w of lines r..r+3 and r+4..r+7 */
+    V210Transpose4(lo);
+    V210Transpose4(hi);
+
+    for (k = 0; k < 12; k++) {
+        int_T w = k/3;
+        int_T p = v210Plane[k];
+        int_T colsPerGroup = (p == 0) ? 6 : 3;
+        uint16_T *dst = &planes[p][(j*colsPerGroup + v210Col[k])*rows + r];
+        MWVIP_V210_VEC fLo, fHi;
+        switch (k % 3) {
+        case 0:
+            fLo = V210_MASK(lo[w]);
+            fHi = V210_MASK(hi[w]);
+            break;
+        case 1:
+            fLo = V210_MASK(V210_SHIFT(lo[w], 10));
+            fHi = V210_MASK(V210_SHIFT(hi[w], 10));
+            break;
+        default:
+            fLo = V210_SHIFT(lo[w], 20);
+            fHi = V210_SHIFT(hi[w], 20);
+            break;
+        }
+        V210_STORE(dst, V210_PACK(fLo, fHi));
+    }
+}
+
+#endif
+
+LIBMWVISIONRT_API void MWVIP_V210_UnpackFrame(const uint8_T *src,
+							 void *portAddr_0,
+							 void *portAddr_1,
+							 void *portAddr_2,
+							 int_T rows,
+							 int_T cols)
+{
+    uint16_T *planes[3];
+    int_T r = 0;
+    planes[0] = (uint16_T *)portAddr_0;
+    planes[1] = (uint16_T *)portAddr_1;
+    planes[2] = (uint16_T *)portAddr_2;
+
+#if defined(MWVIP_V210_SSE2) || defined(MWVIP_V210_NEON)
+    for (; r + 8 <= rows; r += 8) {
+        int_T j;
+        for (j = 0; j < cols; j++) {
+            V210UnpackTile(src, planes, r, j, rows, cols);
+        }
+    }
+#endif
+    V210UnpackScalar(src, planes, r, rows - r, rows, cols);
+}
+
+/* [EOF] v210_unpackframe_rt.c */
@@ -0,0 +1,29 @@
+/*
+*  YVYU_READFRAME_RT runtime function for VIPBLKS Read Binary File block
+*
+*  Reads a whole frame with one fread into stageBuf (4*rows*cols bytes)
+*  and deinterleaves it as MWVIP_YVYU_ReadLine does line by line.
+*
+*  Copyright 2016 The MathWorks, Inc.
+*/
+#include "packed422_readframe_rt.h"
+
+LIBMWVISIONRT_API boolean_T MWVIP_YVYU_ReadFrame(void *fptrDW,
+							 uint8_T *stageBuf,
+							 uint8_T *portAddr_0,
+							 uint8_T *portAddr_1,
+							 uint8_T *portAddr_2,
+							 int32_T   *numLoops,
+							 boolean_T *eofflag, 
+							 int_T rows, 
+							 int_T cols)
+{
+    /* byte offsets of Y0, U, Y1 and V */
+    static const MWVIP_PACKED422_LAYOUT lay = {0, 3, 2, 1};
+
+    return MWVIP_Packed422_ReadFrame(&lay, fptrDW, stageBuf,
+                                     portAddr_0, portAddr_1, portAddr_2, NULL,
+                                     numLoops, eofflag, rows, cols);
+}
+
+/* [EOF] yvyu_readframe_rt.c */
@@ -0,0 +1,38 @@
+/*
+*  BITSPACK_RT runtime function for VIPBLKS Write Binary File block
+*
+*  Packs numValues samples of numBits bits (1 to 16) into a bit stream in
+*  memory, least significant bit first, the layout read back by
+*  MWVIP_BitsUnpack. The bits above numBits are dropped. The samples are
+*  accumulated in a 32 bit register that is flushed a byte at a time; the
+*  last byte is padded with zeros. dst holds (numValues*numBits+7)/8 bytes.
+*
+*  Copyright 2016 The MathWorks, Inc.
+*/
+#include "vipfilewrite_rt.h"
+
+LIBMWVISIONRT_API void MWVIP_BitsPack(uint8_T *dst,
+                                      const uint16_T *src,
+                                      int_T numValues,
+                                      int_T numBits)
+{
+    const uint32_T mask = (1U << numBits) - 1U;
+    uint32_T acc = 0;
+    int_T numAcc = 0;
+    int_T i;
+
+    for (i = 0; i < numValues; i++) {
+        acc |= ((uint32_T)src[i] & mask) << numAcc;
+        numAcc += numBits;
+        while (numAcc >= 8) {
+            *dst++ = (uint8_T)acc;
+            acc >>= 8;
+            numAcc -= 8;
+        }
+    }
+    if (numAcc > 0) {
+        *dst = (uint8_T)acc;
+    }
+}
+
+/* [EOF] bitspack_rt.c */
@@ -0,0 +1,168 @@
+/*
+ *  PACKED422_WRITEFRAME_RT Frame-at-a-time writer for the packed 4:2:2
+ *  formats (YUY2, UYVY, YVYU, Y42T) of the VIPBLKS Write Binary File block.
+ *
+ *  The WriteLine functions write one byte per fwrite call. Here the column
+ *  major Y, U and V planes of the whole frame are interleaved into a
+ *  staging buffer, which is written with a single fwrite. Each row of the
+ *  planes is a line of the file, so the interleave is a transpose: tiles
+ *  of 4 macropixels by 16 lines are loaded as 16 contiguous column vectors
+ *  and transposed with 16x16 byte shuffles (SSE2 or NEON).
+ *
+ *  Copyright 2016 The MathWorks, Inc.
+ */
+
+#ifndef packed422_writeframe_rt_h
+#define packed422_writeframe_rt_h
+
+#include "vipfilewrite_rt.h"
+#include <stdio.h>
+
+#if defined(__ARM_NEON__) || defined(__ARM_NEON)
+#include <arm_neon.h>
+#define MWVIP_FILEWRITE_NEON 1
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define MWVIP_FILEWRITE_SSE2 1
+#endif
+
+/* byte offsets of the components inside a 4 byte macropixel */
+typedef struct {
+    int_T y0;
+    int_T u;
+    int_T y1;
+    int_T v;
+} MWVIP_PACKED422_WRITE_LAYOUT;
+
+/* interleaves lines [r0, r0+nLines), macropixels [j0, cols) */
+MWVIP_INLINE void MWVIP_Packed422_Pack_Scalar(const MWVIP_PACKED422_WRITE_LAYOUT *lay,
+                                            byte_T *stage,
+                                            const byte_T *y, const byte_T *u,
+                                            const byte_T *v, const byte_T *lsb,
+                                            int_T r0, int_T nLines, int_T j0,
+                                            int_T rows, int_T cols)
+{
+    int_T r, j;
+    for (r = r0; r < r0 + nLines; r++) {
+        byte_T *line = &stage[4*r*cols];
+        for (j = j0; j < cols; j++) {
+            byte_T *mp = &line[4*j];
+            int_T rowsj  = j*rows + r;
+            int_T rowsj2 = 2*j*rows + r;
+            mp[lay->u]  = u[rowsj];
+            mp[lay->v]  = v[rowsj];
+            if (lsb != NULL) {
+                mp[lay->y0] = y[rowsj2]      | lsb[rowsj2];
+                mp[lay->y1] = y[rowsj2+rows] | lsb[rowsj2+rows];
+            } else {
+                mp[lay->y0] = y[rowsj2];
+                mp[lay->y1] = y[rowsj2+rows];
+            }
+        }
+    }
+}
+
+#if defined(MWVIP_FILEWRITE_SSE2) || defined(MWVIP_FILEWRITE_NEON)
+
+#if defined(MWVIP_FILEWRITE_SSE2)
+typedef __m128i MWVIP_WBYTE16;
+#define MWVIP_WLOAD16(p)      _mm_loadu_si128((const __m128i *)(p))
+#define MWVIP_WSTORE16(p, a)  _mm_storeu_si128((__m128i *)(p), (a))
+#define MWVIP_WZIPLO16(a, b)  _mm_unpacklo_epi8((a), (b))
+#define MWVIP_WZIPHI16(a, b)  _mm_unpackhi_epi8((a), (b))
+#define MWVIP_WOR16(a, b)     _mm_or_si128((a), (b))
+#else
+typedef uint8x16_t MWVIP_WBYTE16;
+#define MWVIP_WLOAD16(p)      vld1q_u8(p)
+#define MWVIP_WSTORE16(p, a)  vst1q_u8((p), (a))
+#define MWVIP_WZIPLO16(a, b)  vzipq_u8((a), (b)).val[0]
+#define MWVIP_WZIPHI16(a, b)  vzipq_u8((a), (b)).val[1]
+#define MWVIP_WOR16(a, b)     vorrq_u8((a), (b))
+#endif
+
+/* interleaves 4 macropixels starting at macropixel j of lines r..r+15 */
+MWVIP_INLINE void MWVIP_Packed422_Pack_Tile(const MWVIP_PACKED422_WRITE_LAYOUT *lay,
+                                          byte_T *stage,
+                                          const byte_T *y, const byte_T *u,
+                                          const byte_T *v, const byte_T *lsb,
+                                          int_T r, int_T j,
+                                          int_T rows, int_T cols)
+{
+    MWVIP_WBYTE16 a[16], b[16];
+    int_T i, s, m;
+
+    /* a[k] holds byte k of the 4 macropixels for the 16 lines */
+    for (m = 0; m < 4; m++) {
+        int_T rowsj  = (j + m)*rows + r;
+        int_T rowsj2 = 2*(j + m)*rows + r;
+        MWVIP_WBYTE16 y0 = MWVIP_WLOAD16(&y[rowsj2]);
+        MWVIP_WBYTE16 y1 = MWVIP_WLOAD16(&y[rowsj2+rows]);
+        if (lsb != NULL) {
+            y0 = MWVIP_WOR16(y0, MWVIP_WLOAD16(&lsb[rowsj2]));
+            y1 = MWVIP_WOR16(y1, MWVIP_WLOAD16(&lsb[rowsj2+rows]));
+        }
+        a[4*m + lay->y0] = y0;
+        a[4*m + lay->y1] = y1;
+        a[4*m + lay->u]  = MWVIP_WLOAD16(&u[rowsj]);
+        a[4*m + lay->v]  = MWVIP_WLOAD16(&v[rowsj]);
+    }
+    /* four perfect shuffles of the 16 vectors transpose the 16x16 bytes */
+    for (s = 0; s < 4; s++) {
+        for (i = 0; i < 8; i++) {
+            b[2*i]   = MWVIP_WZIPLO16(a[i], a[i+8]);
+            b[2*i+1] = MWVIP_WZIPHI16(a[i], a[i+8]);
+        }
+        for (i = 0; i < 16; i++) {
+            a[i] = b[i];
+        }
+    }
+    for (i = 0; i < 16; i++) {
+        MWVIP_WSTORE16(&stage[4*((r + i)*cols + j)], a[i]);
+    }
+}
+
+#endif
+
+/* interleaves the rows-by-cols macropixel frame into the staging buffer */
+MWVIP_INLINE void MWVIP_Packed422_Pack(const MWVIP_PACKED422_WRITE_LAYOUT *lay,
+                                     byte_T *stage,
+                                     const byte_T *y, const byte_T *u,
+                                     const byte_T *v, const byte_T *lsb,
+                                     int_T rows, int_T cols)
+{
+    int_T r = 0;
+#if defined(MWVIP_FILEWRITE_SSE2) || defined(MWVIP_FILEWRITE_NEON)
+    int_T cols4 = cols & ~3;
+    for (; r + 16 <= rows; r += 16) {
+        int_T j;
+        for (j = 0; j < cols4; j += 4) {
+            MWVIP_Packed422_Pack_Tile(lay, stage, y, u, v, lsb, r, j, rows, cols);
+        }
+        if (cols4 < cols) {
+            MWVIP_Packed422_Pack_Scalar(lay, stage, y, u, v, lsb, r, 16, cols4, rows, cols);
+        }
+    }
+#endif
+    MWVIP_Packed422_Pack_Scalar(lay, stage, y, u, v, lsb, r, rows - r, 0, rows, cols);
+}
+
+/* writes a rows-by-cols macropixel frame; stageBuf holds 4*rows*cols bytes */
+MWVIP_INLINE void MWVIP_Packed422_WriteFrame(const MWVIP_PACKED422_WRITE_LAYOUT *lay,
+                                           void *fptrDW,
+                                           uint8_T *stageBuf,
+                                           const byte_T *portAddr0,
+                                           const byte_T *portAddr1,
+                                           const byte_T *portAddr2,
+                                           const byte_T *portAddr3,
+                                           int_T rows,
+                                           int_T cols)
+{
+    FILE **fptr = (FILE **) fptrDW;
+    MWVIP_Packed422_Pack(lay, (byte_T *)stageBuf, portAddr0, portAddr1, portAddr2,
+                         portAddr3, rows, cols);
+    fwrite(stageBuf, 1, 4*(size_t)rows*(size_t)cols, fptr[0]);
+}
+
+#endif /* packed422_writeframe_rt_h */
+
+/* [EOF] packed422_writeframe_rt.h */
@@ -0,0 +1,161 @@
+/*
+*  V210_PACKFRAME_RT runtime function for VIPBLKS Write Binary File block
+*
+*  Packs the column major uint16 Y, U and V planes of a frame into V210 in
+*  memory, as MWVIP_V210_WriteLine does line by line, so that the frame
+*  can be written with a single fwrite. dst holds 16*rows*cols bytes.
+*
+*  Groups of 8 lines are packed together: 8 contiguous samples of each
+*  column are widened to 32 bits, shifted into the 4 words of the group
+*  and the words of 4 lines are transposed 4x4 into the 16 bytes of each
+*  line.
+*
+*  Copyright 2016 The MathWorks, Inc.
+*/
+#include "vipfilewrite_rt.h"
+
+#if defined(__ARM_NEON__) || defined(__ARM_NEON)
+#include <arm_neon.h>
+#define MWVIP_V210_NEON 1
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define MWVIP_V210_SSE2 1
+#endif
+
+/* plane and column, relative to the group, of the 12 samples of a group */
+static const int_T v210Plane[12] = {1, 0, 2,  0, 1, 0,  2, 0, 1,  0, 2, 0};
+static const int_T v210Col[12]   = {0, 0, 0,  1, 1, 2,  1, 3, 2,  4, 2, 5};
+
+/* the bytes of MWVIP_V210_WriteBits: bits 14 and 15 of the middle sample
+ * do not reach the last byte, the other excess bits are kept */
+#define V210_WORD(s0, s1, s2) \
+    ((uint32_T)(s0) | (((uint32_T)(s1) & 0x3FFF) << 10) | ((uint32_T)(s2) << 20))
+
+static void V210PackScalar(uint8_T *dst, const uint16_T **planes,
+                           int_T r0, int_T nLines, int_T rows, int_T cols)
+{
+    int_T r, j, w, k;
+    for (r = r0; r < r0 + nLines; r++) {
+        for (j = 0; j < cols; j++) {
+            uint8_T *grp = &dst[16*((size_t)r*cols + j)];
+            for (w = 0; w < 4; w++) {
+                uint16_T s[3];
+                uint32_T word;
+                for (k = 0; k < 3; k++) {
+                    int_T p = v210Plane[3*w + k];
+                    int_T colsPerGroup = (p == 0) ? 6 : 3;
+                    s[k] = planes[p][(j*colsPerGroup + v210Col[3*w + k])*rows + r];
+                }
+                word = V210_WORD(s[0], s[1], s[2]);
+                grp[4*w]   = (uint8_T)(word);
+                grp[4*w+1] = (uint8_T)(word >> 8);
+                grp[4*w+2] = (uint8_T)(word >> 16);
+                grp[4*w+3] = (uint8_T)(word >> 24);
+            }
+        }
+    }
+}
+
+#if defined(MWVIP_V210_SSE2) || defined(MWVIP_V210_NEON)
+
+#if defined(MWVIP_V210_SSE2)
+typedef __m128i MWVIP_V210_VEC;
+#define V210_LOAD16(p)      _mm_loadu_si128((const __m128i *)(p))
+#define V210_STORE(p, a)    _mm_storeu_si128((__m128i *)(p), (a))
+#define V210_WIDEN_LO(a)    _mm_unpacklo_epi16((a), _mm_setzero_si128())
+#define V210_WIDEN_HI(a)    _mm_unpackhi_epi16((a), _mm_setzero_si128())
+#define V210_VWORD(s0, s1, s2) \
+    _mm_or_si128(_mm_or_si128((s0), \
+        _mm_slli_epi32(_mm_and_si128((s1), _mm_set1_epi32(0x3FFF)), 10)), \
+        _mm_slli_epi32((s2), 20))
+
+static void V210Transpose4(MWVIP_V210_VEC *x)
+{
+    __m128i t0 = _mm_unpacklo_epi32(x[0], x[1]);
+    __m128i t1 = _mm_unpacklo_epi32(x[2], x[3]);
+    __m128i t2 = _mm_unpackhi_epi32(x[0], x[1]);
+    __m128i t3 = _mm_unpackhi_epi32(x[2], x[3]);
+    x[0] = _mm_unpacklo_epi64(t0, t1);
+    x[1] = _mm_unpackhi_epi64(t0, t1);
+    x[2] = _mm_unpacklo_epi64(t2, t3);
+    x[3] = _mm_unpackhi_epi64(t2, t3);
+}
+#else
+typedef uint32x4_t MWVIP_V210_VEC;
+#define V210_LOAD16(p)      vld1q_u16(p)
+#define V210_STORE(p, a)    vst1q_u8((p), vreinterpretq_u8_u32(a))
+#define V210_WIDEN_LO(a)    vmovl_u16(vget_low_u16(a))
+#define V210_WIDEN_HI(a)    vmovl_u16(vget_high_u16(a))
+#define V210_VWORD(s0, s1, s2) \
+    vorrq_u32(vorrq_u32((s0), \
+        vshlq_n_u32(vandq_u32((s1), vdupq_n_u32(0x3FFF)), 10)), \
+        vshlq_n_u32((s2), 20))
+
+static void V210Transpose4(MWVIP_V210_VEC *x)
+{
+    uint32x4x2_t t0 = vtrnq_u32(x[0], x[1]);
+    uint32x4x2_t t1 = vtrnq_u32(x[2], x[3]);
+    x[0] = vcombine_u32(vget_low_u32(t0.val[0]),  vget_low_u32(t1.val[0]));
+    x[1] = vcombine_u32(vget_low_u32(t0.val[1]),  vget_low_u32(t1.val[1]));
+    x[2] = vcombine_u32(vget_high_u32(t0.val[0]), vget_high_u32(t1.val[0]));
+    x[3] = vcombine_u32(vget_high_u32(t0.val[1]), vget_high_u32(t1.val[1]));
+}
+#endif
+
+/* packs group j of lines r..r+7; the file is little endian, as is the
+ * host of the SIMD path */
+static void V210PackTile(uint8_T *dst, const uint16_T **planes,
+                         int_T r, int_T j, int_T rows, int_T cols)
+{
+    MWVIP_V210_VEC lo[4], hi[4];
+    int_T i, w, k;
+
+    for (w = 0; w < 4; w++) {
+        MWVIP_V210_VEC sLo[3], sHi[3];
+        for (k = 0; k < 3; k++) {
+            int_T p = v210Plane[3*w + k];
+            int_T colsPerGroup = (p == 0) ? 6 : 3;
+            const uint16_T *src = &planes[p][(j*colsPerGroup + v210Col[3*w + k])*rows + r];
+            sLo[k] = V210_WIDEN_LO(V210_LOAD16(src));
+            sHi[k] = V210_WIDEN_HI(V210_LOAD16(src));
+        }
+        /* word w of lines r..r+3 and r+4..r+7 */
+        lo[w] = V210_VWORD(sLo[0], sLo[1], sLo[2]);
+        hi[w] = V210_VWORD(sHi[0], sHi[1], sHi[2]);
+    }
+    V210Transpose4(lo);
+    V210Transpose4(hi);
+
+    for (i = 0; i < 4; i++) {
+        V210_STORE(&dst[16*((size_t)(r + i)*cols + j)], lo[i]);
+        V210_STORE(&dst[16*((size_t)(r + 4 + i)*cols + j)], hi[i]);
+    }
+}
+
+#endif
+
+LIBMWVISIONRT_API void MWVIP_V210_PackFrame(uint8_T *dst,
+							 const void *portAddr_0,
+							 const void *portAddr_1,
+							 const void *portAddr_2,
+							 int_T rows,
+							 int_T cols)
+{
+    const uint16_T *planes[3];
+    int_T r = 0;
+    planes[0] = (const uint16_T *)portAddr_0;
+    planes[1] = (const uint16_T *)portAddr_1;
+    planes[2] = (const uint16_T *)portAddr_2;
+
+#if defined(MWVIP_V210_SSE2) || defined(MWVIP_V210_NEON)
+    for (; r + 8 <= rows; r += 8) {
+        int_T j;
+        for (j = 0; j < cols; j++) {
+            V210PackTile(dst, planes, r, j, rows, cols);
+        }
+    }
+#endif
+    V210PackScalar(dst, planes, r, rows - r, rows, cols);
+}
+
+/* [EOF] v210_packframe_rt.c */
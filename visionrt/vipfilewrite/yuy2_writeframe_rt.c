@@ -0,0 +1,27 @@
+/*
+*  YUY2_WRITEFRAME_RT runtime function for VIPBLKS Write Binary File block
+*
+*  Interleaves a whole frame into stageBuf (4*rows*cols bytes) as
+*  MWVIP_YUY2_WriteLine does line by line, and writes it with one fwrite.
+*
+*  Copyright 2016 The MathWorks, Inc.
+*/
+#include "packed422_writeframe_rt.h"
+
+LIBMWVISIONRT_API void MWVIP_YUY2_WriteFrame(void *fptrDW,
+							 uint8_T *stageBuf,
+							 const byte_T *portAddr0,
+							 const byte_T *portAddr1,
+							 const byte_T *portAddr2,
+							 int_T rows, 
+							 int_T cols)
+{
+    /* byte offsets of Y0, U, Y1 and V */
+    static const MWVIP_PACKED422_WRITE_LAYOUT lay = {0, 1, 2, 3};
+
+    MWVIP_Packed422_WriteFrame(&lay, fptrDW, stageBuf,
+                               portAddr0, portAddr1, portAddr2, NULL,
+                               rows, cols);
+}
+
+/* [EOF] yuy2_writeframe_rt.c */
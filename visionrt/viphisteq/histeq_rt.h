@@ -0,0 +1,30 @@
+/*
+ *  HISTEQ_RT SIMD macros of the histogram equalization kernels.
+ *
+ *  Copyright 2016 The MathWorks, Inc.
+ */
+
+#ifndef histeq_rt_h
+#define histeq_rt_h
+
+#include <string.h>
+#include "viphisteq_rt.h"
+
+#if defined(__ARM_NEON__) || defined(__ARM_NEON)
+#include <arm_neon.h>
+#define MWVIP_HISTEQ_NEON 1
+#if defined(__aarch64__) || defined(_M_ARM64)
+#define MWVIP_HISTEQ_NEON_TBL 1
+#endif
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define MWVIP_HISTEQ_SSE2 1
+#endif
+
+/* number of blocks of MWVIP_HISTEQ_BLOCK pixels */
+#define MWVIP_HISTEQ_NUM_BLOCKS(numel) \
+    ((int_T)(((numel) + MWVIP_HISTEQ_BLOCK - 1)/MWVIP_HISTEQ_BLOCK))
+
+#endif /* histeq_rt_h */
+
+/* [EOF] histeq_rt.h */
@@ -0,0 +1,105 @@
+/*
+ *  HISTEQLUT_RT histeq lookup table and graythresh threshold from a 256
+ *  bin histogram
+ *
+ *  Copyright 2016 The MathWorks, Inc.
+ */
+#include "histeq_rt.h"
+
+/*
+ * Level j goes to the target bin k that minimizes the distance between
+ * the cumulative target histogram at k and the cumulative histogram at j,
+ * shifted by half the count of level j, among the bins not more than a
+ * rounding error below it, as histeq chooses them.
+ */
+void MWVIP_HistEq_LUT_U8(const uint32_T *hist,
+                         const real_T *hgram,
+                         int_T numBins,
+                         uint8_T *lut)
+{
+    real_T numel = 0.0, total = 0.0, cum = 0.0, tolNeg;
+    real_T cumd[256];
+    int_T j, k;
+
+    if (numBins < 2 || numBins > 256) {
+        memset(lut, 0, 256);
+        return;
+    }
+    for (j = 0; j < 256; j++) numel += (real_T)hist[j];
+    for (k = 0; k < numBins; k++) total += (hgram != NULL) ? hgram[k] : 1.0;
+    for (k = 0; k < numBins; k++) {
+        cum += (hgram != NULL) ? hgram[k] : 1.0;
+        cumd[k] = (total > 0.0) ? numel*cum/total : 0.0;
+    }
+    tolNeg = -numel*1.4901161193847656e-08;   /* sqrt(eps) */
+
+    cum = 0.0;
+    for (j = 0; j < 256; j++) {
+        const real_T tol = (j > 0 && j < 255) ? 0.5*(real_T)hist[j] : 0.0;
+        real_T best = 0.0;
+        int_T bestK = 0;
+        cum += (real_T)hist[j];
+        for (k = 0; k < numBins; k++) {
+            real_T err = cumd[k] - cum + tol;
+            if (err < tolNeg) err = numel;
+            if (k == 0 || err < best) {
+                best = err;
+                bestK = k;
+            }
+        }
+        lut[j] = (uint8_T)((real_T)bestK*255.0/(real_T)(numBins-1) + 0.5);
+    }
+}
+
+/*
+ * Otsu: the between class variance of the cut after level k is
+ *     (Mt*c - M*N)^2 / (N^2*c*(N-c))
+ * with N pixels, c of them at levels 0..k, M the sum of their levels and
+ * Mt that of all of them. Cuts with an empty class are skipped, and ties
+ * are averaged, as graythresh does.
+ */
+uint8_T MWVIP_Otsu_U8(const uint32_T *hist,
+                      real_T *level,
+                      real_T *effectiveness)
+{
+    real_T numel = 0.0, sumT = 0.0, c = 0.0, sum = 0.0;
+    real_T best = -1.0, sumBest = 0.0, numBest = 0.0, t = 0.0;
+    int_T k;
+
+    for (k = 0; k < 256; k++) {
+        numel += (real_T)hist[k];
+        sumT  += (real_T)hist[k]*(real_T)k;
+    }
+    for (k = 0; k < 255; k++) {
+        real_T d, sb;
+        c   += (real_T)hist[k];
+        sum += (real_T)hist[k]*(real_T)k;
+        if (c == 0.0 || c == numel) continue;
+        d  = sumT*c - sum*numel;
+        sb = d*d/(c*(numel - c));
+        if (sb > best) {
+            best = sb;
+            sumBest = (real_T)k;
+            numBest = 1.0;
+        } else if (sb == best) {
+            sumBest += (real_T)k;
+            numBest += 1.0;
+        }
+    }
+    if (numBest > 0.0) t = sumBest/numBest;
+
+    if (level != NULL) *level = t/255.0;
+    if (effectiveness != NULL) {
+        /* between class over total variance, both times N^2 */
+        real_T var = 0.0;
+        const real_T mean = (numel > 0.0) ? sumT/numel : 0.0;
+        for (k = 0; k < 256; k++) {
+            var += (real_T)hist[k]*((real_T)k - mean)*((real_T)k - mean);
+        }
+        *effectiveness = (numBest > 0.0 && var > 0.0) ? best/(numel*var) : 0.0;
+    }
+    /* the levels are integers: above t is above floor(t) */
+    return (uint8_T)t;
+}
+
+/* [EOF] histeqlut_rt.c */
@@ -0,0 +1,113 @@
+/*
+ *  HISTEQTHRESH_U8_RT fused histogram equalization and autothreshold of
+ *  a uint8 frame
+ *
+ *  The second pass reads each pixel once for both outputs. The threshold
+ *  is a saturated subtraction compared with zero. The lookup of a 256
+ *  entry table takes four 64 byte table instructions on AArch64, vqtbx4q
+ *  leaving the lanes out of its table untouched; SSE2 has no byte
+ *  shuffle, so the table is read one pixel at a time there.
+ *
+ *  Copyright 2016 The MathWorks, Inc.
+ */
+#include "histeq_rt.h"
+
+static void ApplyBlock(const uint8_T *in, size_t n, const uint8_T *lut,
+                       uint8_T cut, uint8_T *eq, boolean_T *bw)
+{
+    size_t i = 0;
+#if defined(MWVIP_HISTEQ_SSE2)
+    const __m128i vcut = _mm_set1_epi8((char)cut);
+    const __m128i zero = _mm_setzero_si128(), one = _mm_set1_epi8(1);
+    for (; i + 16 <= n; i += 16) {
+        const __m128i x = _mm_loadu_si128((const __m128i *)&in[i]);
+        if (bw != NULL) {
+            const __m128i below = _mm_cmpeq_epi8(_mm_subs_epu8(x, vcut), zero);
+            _mm_storeu_si128((__m128i *)&bw[i], _mm_andnot_si128(below, one));
+        }
+        if (eq != NULL) {
+            int_T k;
+            for (k = 0; k < 16; k++) eq[i+k] = lut[in[i+k]];
+        }
+    }
+#elif defined(MWVIP_HISTEQ_NEON)
+    const uint8x16_t vcut = vdupq_n_u8(cut), one = vdupq_n_u8(1);
+#if defined(MWVIP_HISTEQ_NEON_TBL)
+    const uint8x16_t v64 = vdupq_n_u8(64);
+    uint8x16x4_t t0, t1, t2, t3;
+    int_T k;
+    for (k = 0; k < 4; k++) {
+        t0.val[k] = vld1q_u8(&lut[16*k]);
+        t1.val[k] = vld1q_u8(&lut[64 + 16*k]);
+        t2.val[k] = vld1q_u8(&lut[128 + 16*k]);
+        t3.val[k] = vld1q_u8(&lut[192 + 16*k]);
+    }
+#endif
+    for (; i + 16 <= n; i += 16) {
+        const uint8x16_t x = vld1q_u8(&in[i]);
+        if (bw != NULL) {
+            vst1q_u8((uint8_t *)&bw[i], vandq_u8(vcgtq_u8(x, vcut), one));
+        }
+        if (eq != NULL) {
+#if defined(MWVIP_HISTEQ_NEON_TBL)
+            uint8x16_t idx = x, y = vqtbl4q_u8(t0, idx);
+            idx = vsubq_u8(idx, v64);
+            y = vqtbx4q_u8(y, t1, idx);
+            idx = vsubq_u8(idx, v64);
+            y = vqtbx4q_u8(y, t2, idx);
+            idx = vsubq_u8(idx, v64);
+            y = vqtbx4q_u8(y, t3, idx);
+            vst1q_u8(&eq[i], y);
+#else
+            int_T j;
+            for (j = 0; j < 16; j++) eq[i+j] = lut[in[i+j]];
+#endif
+        }
+    }
+#endif
+    for (; i < n; i++) {
+        if (eq != NULL) eq[i] = lut[in[i]];
+        if (bw != NULL) bw[i] = (boolean_T)(in[i] > cut);
+    }
+}
+
+void MWVIP_HistEqThresh_Apply_U8(const uint8_T *in, size_t numel,
+                                 const uint8_T *lut,
+                                 uint8_T cut,
+                                 uint8_T *eq,
+                                 boolean_T *bw)
+{
+    const int_T numBlocks = MWVIP_HISTEQ_NUM_BLOCKS(numel);
+    int_T blk;
+#if defined(MWVIP_HISTEQ_PARALLEL)
+    #pragma omp parallel for schedule(static) \
+        if (numel >= MWVIP_HISTEQ_MIN_PARALLEL)
+#endif
+    for (blk = 0; blk < numBlocks; blk++) {
+        const size_t i0 = (size_t)blk*MWVIP_HISTEQ_BLOCK;
+        const size_t n = (numel - i0 < MWVIP_HISTEQ_BLOCK) ? numel - i0 : MWVIP_HISTEQ_BLOCK;
+        ApplyBlock(&in[i0], n, lut, cut,
+                   (eq != NULL) ? &eq[i0] : NULL,
+                   (bw != NULL) ? &bw[i0] : NULL);
+    }
+}
+
+void MWVIP_HistEqThresh_U8(const uint8_T *in, size_t numel,
+                           const real_T *hgram,
+                           int_T numBins,
+                           uint8_T *eq,
+                           boolean_T *bw,
+                           real_T *level,
+                           real_T *effectiveness)
+{
+    uint32_T hist[256];
+    uint8_T lut[256];
+    uint8_T cut;
+
+    MWVIP_Histogram_U8(in, numel, hist);
+    MWVIP_HistEq_LUT_U8(hist, hgram, numBins, lut);
+    cut = MWVIP_Otsu_U8(hist, level, effectiveness);
+    MWVIP_HistEqThresh_Apply_U8(in, numel, lut, cut, eq, bw);
+}
+
+/* [EOF] histeqthresh_u8_rt.c */
@@ -0,0 +1,54 @@
+/*
+ *  HISTOGRAM_U8_RT 256 bin histogram of a uint8 frame
+ *
+ *  Consecutive pixels often have the same level, and incrementing the same
+ *  counter back to back waits for the previous increment to be stored.
+ *  Four sub-histograms, one per pixel of each group of four, break that
+ *  chain; each thread has its own four, added to the histogram once.
+ *
+ *  Copyright 2016 The MathWorks, Inc.
+ */
+#include "histeq_rt.h"
+
+static void CountBlock(const uint8_T *in, size_t n, uint32_T sub[4][256])
+{
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        sub[0][in[i]]++;
+        sub[1][in[i+1]]++;
+        sub[2][in[i+2]]++;
+        sub[3][in[i+3]]++;
+    }
+    for (; i < n; i++) sub[0][in[i]]++;
+}
+
+void MWVIP_Histogram_U8(const uint8_T *in, size_t numel, uint32_T *hist)
+{
+    const int_T numBlocks = MWVIP_HISTEQ_NUM_BLOCKS(numel);
+
+    memset(hist, 0, 256*sizeof(uint32_T));
+#if defined(MWVIP_HISTEQ_PARALLEL)
+    #pragma omp parallel if (numel >= MWVIP_HISTEQ_MIN_PARALLEL)
+#endif
+    {
+        uint32_T sub[4][256];
+        int_T blk, v;
+        memset(sub, 0, sizeof(sub));
+#if defined(MWVIP_HISTEQ_PARALLEL)
+        #pragma omp for schedule(static)
+#endif
+        for (blk = 0; blk < numBlocks; blk++) {
+            const size_t i0 = (size_t)blk*MWVIP_HISTEQ_BLOCK;
+            const size_t n = (numel - i0 < MWVIP_HISTEQ_BLOCK) ? numel - i0 : MWVIP_HISTEQ_BLOCK;
+            CountBlock(&in[i0], n, sub);
+        }
+#if defined(MWVIP_HISTEQ_PARALLEL)
+        #pragma omp critical(MWVIP_Histogram_U8_merge)
+#endif
+        for (v = 0; v < 256; v++) {
+            hist[v] += sub[0][v] + sub[1][v] + sub[2][v] + sub[3][v];
+        }
+    }
+}
+
+/* [EOF] histogram_u8_rt.c */
@@ -0,0 +1,101 @@
+/*
+ *  HOUGH_SPARSE_D_RT Helper function for Hough Transform block.
+ *
+ *  Same accumulator as MWVIP_Hough_D. The on pixels are first gathered
+ *  into the coordinate lists ptCol and ptRow (inRows*inCols elements
+ *  each), so that the image is scanned once instead of the pixels being
+ *  tested for each theta. Each theta then owns one row of yH: the rows are
+ *  accumulated independently, in parallel when compiled with OpenMP, and
+ *  the rho bins of a chunk of points are computed in a loop without
+ *  dependencies, which the compiler can vectorize, before the votes are
+ *  added. rho is computed as in MWVIP_Hough_D, so both give the same
+ *  votes.
+ *
+ *  Copyright 2016 The MathWorks, Inc.
+ */
+#include "viphough_rt.h"  
+
+LIBMWVISIONRT_API void MWVIP_Hough_Sparse_D(
+    const boolean_T  *uBW,
+    real_T           *yH,
+    const real_T     *sineTablePtr, 
+    const real_T     *rho,
+    real_T           *ptCol,
+    real_T           *ptRow,
+    int_T inRows,
+    int_T inCols,
+    int_T rhoLen,
+    int_T Ceil90ByThResPlus1
+)
+{
+    int_T thetaLen = 2*Ceil90ByThResPlus1-2;    
+    real_T firstRho = rho[0];
+    real_T slope = ((firstRho==0) && (rhoLen==1))
+        ? 0 : (rhoLen - 1)/(-2*firstRho) ; /* (endRho - firstRho), endRho=rho[rhoLen-1]=-firstRho); */
+    int_T n,m,thetaIdx;
+    int_T numPoints = 0;
+
+    /* gather the on pixels */
+    for(n=0; n < inCols; n++)
+    {
+        const boolean_T *col = &uBW[n*inRows];
+        for(m=0; m < inRows; m++)
+        {
+            if(col[m]) /* if pixel is 1 (on) */
+            {
+                ptCol[numPoints] = (real_T)n;
+                ptRow[numPoints] = (real_T)m;
+                numPoints++;
+            }
+        }
+    }
+
+    /* Compute the hough transform, one theta (row of yH) at a time */
+#ifdef MWVIP_HOUGH_PARALLEL
+#pragma omp parallel for schedule(static) if (numPoints*thetaLen >= MWVIP_HOUGH_MIN_PARALLEL_VOTES)
+#endif
+    for(thetaIdx=0; thetaIdx<thetaLen; thetaIdx++)
+    {
+        real_T *yHTheta = &yH[thetaIdx*rhoLen];
+        int_T rhoIdxBuf[MWVIP_HOUGH_CHUNK_LEN];
+        real_T cosTheta, sinTheta;
+        int_T p;
+
+        /* x*cos(theta)+y*sin(theta)=rho, theta varies from -90 to 90 */
+        if (thetaIdx < Ceil90ByThResPlus1)
+        {
+            cosTheta = -sineTablePtr[Ceil90ByThResPlus1-1-thetaIdx];
+            sinTheta =  sineTablePtr[thetaIdx];
+        }
+        else
+        {
+            int_T j = thetaIdx - Ceil90ByThResPlus1;
+            cosTheta = -sineTablePtr[j+1];
+            sinTheta = -sineTablePtr[Ceil90ByThResPlus1-2-j];
+        }
+
+        memset((byte_T *)yHTheta,0,rhoLen*sizeof(real_T));
+        for (p=0; p<numPoints; p+=MWVIP_HOUGH_CHUNK_LEN)
+        {
+            const int_T chunkLen = (numPoints-p < MWVIP_HOUGH_CHUNK_LEN) ?
+                                   numPoints-p : MWVIP_HOUGH_CHUNK_LEN;
+            const real_T *x = &ptCol[p];
+            const real_T *y = &ptRow[p];
+            int_T k;
+
+            for (k=0; k<chunkLen; k++)
+            {
+                real_T myrho = x[k]*cosTheta + y[k]*sinTheta;
+                real_T tmpRhoIdx = slope*(myrho - firstRho);
+                /* convert to bin index */
+                rhoIdxBuf[k] = (tmpRhoIdx>0)? (int_T)(tmpRhoIdx+0.5): (int_T)(tmpRhoIdx-0.5); 
+            }
+            for (k=0; k<chunkLen; k++)
+            {
+                yHTheta[rhoIdxBuf[k]]++; /* increment counter */
+            }
+        }
+    }
+}
+
+/* [EOF] hough_sparse_d_rt.c */
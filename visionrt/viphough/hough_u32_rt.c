@@ -0,0 +1,123 @@
+/*
+ *  HOUGH_U32_RT Helper function for Hough Transform block.
+ *
+ *  Hough transform with a uint32_T accumulator and integer arithmetic. The
+ *  bin of rho is slope*(x*cos(theta) + y*sin(theta) - rho[0]), rounded.
+ *  For each theta, slope*cos(theta) and slope*sin(theta) are converted to
+ *  fixed point with fracBits fraction bits into trigQ (2*thetaLen
+ *  elements), and the offset, including the rounding, is added once per
+ *  theta; the votes then use integer multiplies and a shift only.
+ *  fracBits is chosen so that the sums fit in int32_T. A point lying
+ *  within 2^-fracBits*(inRows+inCols) bins of the middle of two bins can
+ *  be counted in the neighbour of the bin chosen by MWVIP_Hough_R.
+ *
+ *  The on pixels are gathered into ptCol and ptRow (inRows*inCols
+ *  elements each) and each theta owns one row of yH, as in
+ *  MWVIP_Hough_Sparse_R.
+ *
+ *  Copyright 2016 The MathWorks, Inc.
+ */
+#include "viphough_rt.h"  
+
+LIBMWVISIONRT_API void MWVIP_Hough_U32(
+    const boolean_T  *uBW,
+    uint32_T           *yH,
+    const real_T     *sineTablePtr, 
+    const real_T     *rho,
+    int32_T          *trigQ,
+    int32_T          *ptCol,
+    int32_T          *ptRow,
+    int_T inRows,
+    int_T inCols,
+    int_T rhoLen,
+    int_T Ceil90ByThResPlus1
+)
+{
+    int_T thetaLen = 2*Ceil90ByThResPlus1-2;    
+    real_T firstRho = rho[0];
+    real_T slope = ((firstRho==0) && (rhoLen==1))
+        ? 0 : (rhoLen - 1)/(-2*firstRho) ; /* (endRho - firstRho), endRho=rho[rhoLen-1]=-firstRho); */
+    int_T n,m,thetaIdx;
+    int_T numPoints = 0;
+    int_T fracBits = MWVIP_HOUGH_MAX_FRAC_BITS;
+    real_T scale;
+    int32_T offsetQ;
+
+    /* |slope*(x*cos + y*sin - firstRho)| <= rhoLen-1, with a margin of 2 */
+    while (fracBits > 0 && (real_T)(rhoLen+1)*(real_T)(1<<fracBits) >= 1073741824.0)
+    {
+        fracBits--;
+    }
+    scale = (real_T)(1<<fracBits);
+    offsetQ = (int32_T)floor(-slope*firstRho*scale + 0.5) + (int32_T)(1<<fracBits>>1);
+
+    for(thetaIdx=0; thetaIdx<thetaLen; thetaIdx++)
+    {
+        real_T cosTheta, sinTheta;
+        if (thetaIdx < Ceil90ByThResPlus1)
+        {
+            cosTheta = -sineTablePtr[Ceil90ByThResPlus1-1-thetaIdx];
+            sinTheta =  sineTablePtr[thetaIdx];
+        }
+        else
+        {
+            int_T j = thetaIdx - Ceil90ByThResPlus1;
+            cosTheta = -sineTablePtr[j+1];
+            sinTheta = -sineTablePtr[Ceil90ByThResPlus1-2-j];
+        }
+        trigQ[2*thetaIdx]   = (int32_T)floor(slope*cosTheta*scale + 0.5);
+        trigQ[2*thetaIdx+1] = (int32_T)floor(slope*sinTheta*scale + 0.5);
+    }
+
+    /* gather the on pixels */
+    for(n=0; n < inCols; n++)
+    {
+        const boolean_T *col = &uBW[n*inRows];
+        for(m=0; m < inRows; m++)
+        {
+            if(col[m]) /* if pixel is 1 (on) */
+            {
+                ptCol[numPoints] = (int32_T)n;
+                ptRow[numPoints] = (int32_T)m;
+                numPoints++;
+            }
+        }
+    }
+
+    /* Compute the hough transform, one theta (row of yH) at a time */
+#ifdef MWVIP_HOUGH_PARALLEL
+#pragma omp parallel for schedule(static) if (numPoints*thetaLen >= MWVIP_HOUGH_MIN_PARALLEL_VOTES)
+#endif
+    for(thetaIdx=0; thetaIdx<thetaLen; thetaIdx++)
+    {
+        uint32_T *yHTheta = &yH[thetaIdx*rhoLen];
+        const int32_T cosQ = trigQ[2*thetaIdx];
+        const int32_T sinQ = trigQ[2*thetaIdx+1];
+        int_T rhoIdxBuf[MWVIP_HOUGH_CHUNK_LEN];
+        int_T p;
+
+        memset((byte_T *)yHTheta,0,rhoLen*sizeof(uint32_T));
+        for (p=0; p<numPoints; p+=MWVIP_HOUGH_CHUNK_LEN)
+        {
+            const int_T chunkLen = (numPoints-p < MWVIP_HOUGH_CHUNK_LEN) ?
+                                   numPoints-p : MWVIP_HOUGH_CHUNK_LEN;
+            const int32_T *x = &ptCol[p];
+            const int32_T *y = &ptRow[p];
+            int_T k;
+
+            for (k=0; k<chunkLen; k++)
+            {
+                int32_T idx = (x[k]*cosQ + y[k]*sinQ + offsetQ) >> fracBits;
+                /* the fixed point rounding may step out by one bin */
+                idx = (idx < 0) ? 0 : idx;
+                rhoIdxBuf[k] = (idx > rhoLen-1) ? rhoLen-1 : idx;
+            }
+            for (k=0; k<chunkLen; k++)
+            {
+                yHTheta[rhoIdxBuf[k]]++; /* increment counter */
+            }
+        }
+    }
+}
+
+/* [EOF] hough_u32_rt.c */
@@ -0,0 +1,255 @@
+/*
+ *  HOUGHLINES_D_RT Helper function for Hough Transform, Find Local Maxima
+ *  and Hough Lines blocks.
+ *
+ *  Hough transform, peak search and line extraction in one call, see
+ *  viphough_rt.h. The accumulator is theta-partitioned as in
+ *  MWVIP_Hough_Sparse_D, so the threads need no partial accumulators to
+ *  merge; the largest vote of each theta row is taken right after the row
+ *  is accumulated. The non-maximum suppression then only visits the bins
+ *  of at least the threshold, and compares each of them with the at most
+ *  maxLines peaks kept so far.
+ *
+ *  Copyright 2016 The MathWorks, Inc.
+ */
+#include <stdlib.h>
+#include "viphough_rt.h"
+
+typedef struct {
+    real_T votes;
+    int32_T  idx;       /* thetaIdx*rhoLen + rhoIdx */
+} HoughBin;
+
+/* decreasing votes, then increasing index as max(H(:)) */
+static int CompareBins(const void *a, const void *b)
+{
+    const HoughBin *p = (const HoughBin *)a;
+    const HoughBin *q = (const HoughBin *)b;
+    if (p->votes != q->votes) return (p->votes > q->votes) ? -1 : 1;
+    return (p->idx < q->idx) ? -1 : ((p->idx > q->idx) ? 1 : 0);
+}
+
+static void ThetaTrig(const real_T *sineTablePtr, int_T Ceil90ByThResPlus1,
+                      int_T thetaIdx, real_T *cosTheta, real_T *sinTheta)
+{
+    if (thetaIdx < Ceil90ByThResPlus1)
+    {
+        *cosTheta = -sineTablePtr[Ceil90ByThResPlus1-1-thetaIdx];
+        *sinTheta =  sineTablePtr[thetaIdx];
+    }
+    else
+    {
+        int_T j = thetaIdx - Ceil90ByThResPlus1;
+        *cosTheta = -sineTablePtr[j+1];
+        *sinTheta = -sineTablePtr[Ceil90ByThResPlus1-2-j];
+    }
+}
+
+/* whether bin (r, t) lies in the neighborhood of peak (r0, t0) */
+static boolean_T InNeighborhood(int_T r, int_T t, int_T r0, int_T t0,
+                                int_T halfRows, int_T halfCols,
+                                int_T rhoLen, int_T thetaLen)
+{
+    const int_T dt = (t > t0) ? t - t0 : t0 - t;
+    if (dt <= halfCols) {
+        return (boolean_T)((r > r0 ? r - r0 : r0 - r) <= halfRows);
+    }
+    /* across the ends of theta, rho changes sign */
+    if (thetaLen - dt <= halfCols) {
+        const int_T rm = rhoLen - 1 - r0;
+        return (boolean_T)((r > rm ? r - rm : rm - r) <= halfRows);
+    }
+    return 0;
+}
+
+/* [x1 y1 x2 y2] where x*c + y*s = p crosses the border of the image */
+static void BorderPoints(real_T c, real_T s, real_T p,
+                         int_T inRows, int_T inCols, real_T *pts)
+{
+    const real_T xMax = (real_T)(inCols-1), yMax = (real_T)(inRows-1);
+    const real_T tol = 1e-4*(xMax + yMax + 1.0);
+    real_T cand[8];
+    int_T numCand = 0, k, found = 0;
+
+    if (fabs(s) > 1e-6) {
+        cand[numCand++] = 0.0;  cand[numCand++] = p/s;
+        cand[numCand++] = xMax;  cand[numCand++] = (p - xMax*c)/s;
+    }
+    if (fabs(c) > 1e-6) {
+        cand[numCand++] = p/c;              cand[numCand++] = 0.0;
+        cand[numCand++] = (p - yMax*s)/c;   cand[numCand++] = yMax;
+    }
+    pts[0] = pts[1] = pts[2] = pts[3] = 0.0;
+    for (k = 0; k < numCand && found < 2; k += 2) {
+        const real_T x = cand[k], y = cand[k+1];
+        if (x < -tol || x > xMax + tol || y < -tol || y > yMax + tol) continue;
+        if (found == 1 && fabs(x - pts[0]) <= tol && fabs(y - pts[1]) <= tol) continue;
+        pts[2*found]   = (x < 0.0) ? 0.0 : ((x > xMax) ? xMax : x);
+        pts[2*found+1] = (y < 0.0) ? 0.0 : ((y > yMax) ? yMax : y);
+        found++;
+    }
+    if (found < 2) {
+        pts[0] = pts[1] = pts[2] = pts[3] = 0.0;
+    }
+}
+
+LIBMWVISIONRT_API int_T MWVIP_HoughLines_D(
+    const boolean_T  *uBW,
+    real_T         *yH,
+    const real_T   *sineTablePtr,
+    const real_T   *rho,
+    real_T         *ptCol,
+    real_T         *ptRow,
+    int_T inRows,
+    int_T inCols,
+    int_T rhoLen,
+    int_T Ceil90ByThResPlus1,
+    real_T threshold,
+    real_T thresholdRatio,
+    int_T nhoodRows,
+    int_T nhoodCols,
+    int_T maxLines,
+    int32_T          *peakIdx,
+    real_T         *lineRho,
+    real_T         *lineTheta,
+    real_T         *linePts
+)
+{
+    int_T thetaLen = 2*Ceil90ByThResPlus1-2;
+    real_T firstRho = rho[0];
+    real_T slope = ((firstRho==0) && (rhoLen==1))
+        ? 0 : (rhoLen - 1)/(-2*firstRho) ; /* (endRho - firstRho), endRho=rho[rhoLen-1]=-firstRho); */
+    int_T n,m,thetaIdx;
+    int_T numPoints = 0, numBins = 0, numLines = 0;
+    real_T *rowMax;
+    real_T maxVotes = 0.0;
+    HoughBin *bins;
+
+    rowMax = (real_T *)malloc(thetaLen*sizeof(real_T));
+    if (rowMax == NULL) return -1;
+
+    /* gather the on pixels */
+    for(n=0; n < inCols; n++)
+    {
+        const boolean_T *col = &uBW[n*inRows];
+        for(m=0; m < inRows; m++)
+        {
+            if(col[m]) /* if pixel is 1 (on) */
+            {
+                ptCol[numPoints] = (real_T)n;
+                ptRow[numPoints] = (real_T)m;
+                numPoints++;
+            }
+        }
+    }
+
+    /* one theta (row of yH) at a time, with its largest vote */
+#ifdef MWVIP_HOUGH_PARALLEL
+#pragma omp parallel for schedule(static) if (numPoints*thetaLen >= MWVIP_HOUGH_MIN_PARALLEL_VOTES)
+#endif
+    for(thetaIdx=0; thetaIdx<thetaLen; thetaIdx++)
+    {
+        real_T *yHTheta = &yH[thetaIdx*rhoLen];
+        int_T rhoIdxBuf[MWVIP_HOUGH_CHUNK_LEN];
+        real_T cosTheta, sinTheta, top = 0.0;
+        int_T p, k;
+
+        ThetaTrig(sineTablePtr, Ceil90ByThResPlus1, thetaIdx, &cosTheta, &sinTheta);
+        memset((byte_T *)yHTheta,0,rhoLen*sizeof(real_T));
+        for (p=0; p<numPoints; p+=MWVIP_HOUGH_CHUNK_LEN)
+        {
+            const int_T chunkLen = (numPoints-p < MWVIP_HOUGH_CHUNK_LEN) ?
+                                   numPoints-p : MWVIP_HOUGH_CHUNK_LEN;
+            const real_T *x = &ptCol[p];
+            const real_T *y = &ptRow[p];
+
+            for (k=0; k<chunkLen; k++)
+            {
+                real_T myrho = x[k]*cosTheta + y[k]*sinTheta;
+                real_T tmpRhoIdx = slope*(myrho - firstRho);
+                /* convert to bin index */
+                rhoIdxBuf[k] = (tmpRhoIdx>0)? (int_T)(tmpRhoIdx+0.5): (int_T)(tmpRhoIdx-0.5);
+            }
+            for (k=0; k<chunkLen; k++)
+            {
+                yHTheta[rhoIdxBuf[k]]++; /* increment counter */
+            }
+        }
+        for (k=0; k<rhoLen; k++)
+        {
+            top = (yHTheta[k] > top) ? yHTheta[k] : top;
+        }
+        rowMax[thetaIdx] = top;
+    }
+
+    for(thetaIdx=0; thetaIdx<thetaLen; thetaIdx++)
+    {
+        maxVotes = (rowMax[thetaIdx] > maxVotes) ? rowMax[thetaIdx] : maxVotes;
+    }
+    if (thresholdRatio*maxVotes > threshold) threshold = thresholdRatio*maxVotes;
+    /* a bin without votes is never a peak */
+    if (threshold < 1.0) threshold = 1.0;
+
+    /* the bins of at least the threshold, from the rows that have some */
+    for(thetaIdx=0; thetaIdx<thetaLen; thetaIdx++)
+    {
+        int_T k;
+        if (rowMax[thetaIdx] < threshold) continue;
+        for (k=0; k<rhoLen; k++)
+        {
+            numBins += (yH[thetaIdx*rhoLen+k] >= threshold);
+        }
+    }
+    bins = (HoughBin *)malloc((numBins > 0 ? numBins : 1)*sizeof(HoughBin));
+    if (bins == NULL)
+    {
+        free(rowMax);
+        return -1;
+    }
+    numBins = 0;
+    for(thetaIdx=0; thetaIdx<thetaLen; thetaIdx++)
+    {
+        int_T k;
+        if (rowMax[thetaIdx] < threshold) continue;
+        for (k=0; k<rhoLen; k++)
+        {
+            if (yH[thetaIdx*rhoLen+k] >= threshold)
+            {
+                bins[numBins].votes = yH[thetaIdx*rhoLen+k];
+                bins[numBins].idx = (int32_T)(thetaIdx*rhoLen+k);
+                numBins++;
+            }
+        }
+    }
+    qsort(bins, numBins, sizeof(HoughBin), CompareBins);
+
+    /* greedy non-maximum suppression */
+    for (n=0; n<numBins && numLines<maxLines; n++)
+    {
+        const int_T r = bins[n].idx % rhoLen;
+        const int_T t = bins[n].idx / rhoLen;
+        boolean_T suppressed = 0;
+        for (m=0; m<numLines && !suppressed; m++)
+        {
+            suppressed = InNeighborhood(r, t, peakIdx[2*m], peakIdx[2*m+1],
+                                        nhoodRows/2, nhoodCols/2, rhoLen, thetaLen);
+        }
+        if (!suppressed)
+        {
+            real_T cosTheta, sinTheta;
+            ThetaTrig(sineTablePtr, Ceil90ByThResPlus1, t, &cosTheta, &sinTheta);
+            peakIdx[2*numLines]   = (int32_T)r;
+            peakIdx[2*numLines+1] = (int32_T)t;
+            lineRho[numLines]     = rho[r];
+            lineTheta[numLines]   = atan2(sinTheta, cosTheta);
+            BorderPoints(cosTheta, sinTheta, rho[r], inRows, inCols, &linePts[4*numLines]);
+            numLines++;
+        }
+    }
+
+    free(bins);
+    free(rowMax);
+    return numLines;
+}
+
+/* [EOF] houghlines_d_rt.c */
@@ -0,0 +1,113 @@
+/*
+ *  mdnfilter_hist_u8_rt.c
+ *
+ *  Constant time uint8 median filter (Perreault and Hebert), for
+ *  neighborhoods too large for the median networks.
+ *
+ *  Images are column major, so the filter moves down each output column.
+ *  The work buffer holds one histogram per input row, counting the kCols
+ *  pixels of that row under the neighborhood of the current output
+ *  column, and the histogram of the whole neighborhood. Moving to the next
+ *  output column updates each row histogram with one pixel out and one in;
+ *  moving down the column adds one row histogram to the neighborhood
+ *  histogram and subtracts another. Each histogram has 256 fine bins and
+ *  16 coarse bins of 16 values each, so the median is found by scanning at
+ *  most 16 coarse and 16 fine bins. The cost per pixel does not depend on
+ *  the neighborhood size.
+ *
+ *  Copyright 2016 The MathWorks, Inc.
+ */
+#include "vipmdnfilter_rt.h"
+#include <string.h>
+
+#define MDN_FINE   256
+#define MDN_COARSE 16
+
+/* h += a - b over the fine and coarse bins */
+static void HistAddSub(uint16_T *h, const uint16_T *a, const uint16_T *b)
+{
+    int_T i;
+    for (i = 0; i < MWVIP_MDNHIST_BINS; i++) {
+        h[i] = (uint16_T)(h[i] + a[i] - b[i]);
+    }
+}
+
+static void HistAdd(uint16_T *h, const uint16_T *a)
+{
+    int_T i;
+    for (i = 0; i < MWVIP_MDNHIST_BINS; i++) {
+        h[i] = (uint16_T)(h[i] + a[i]);
+    }
+}
+
+/* value of 0-based rank in the histogram */
+static uint8_T HistRank(const uint16_T *h, uint32_T rank)
+{
+    const uint16_T *coarse = &h[MDN_FINE];
+    uint32_T count = 0;
+    int_T b = 0, v;
+    while (count + coarse[b] <= rank) {
+        count += coarse[b];
+        b++;
+    }
+    v = b*MDN_COARSE;
+    while (count + h[v] <= rank) {
+        count += h[v];
+        v++;
+    }
+    return (uint8_T)v;
+}
+
+LIBMWVISIONRT_API void MWVIP_MedianFilterHist_U8(const uint8_T *src, uint8_T *dst,
+                                                 int_T nRows, int_T nCols,
+                                                 int_T kRows, int_T kCols,
+                                                 uint16_T *work)
+{
+    const int_T srcRows = nRows + kRows - 1;
+    const uint32_T rank = (uint32_T)(kRows*kCols) / 2;
+    uint16_T *kernel = &work[srcRows*MWVIP_MDNHIST_BINS];
+    int_T c, r, i;
+
+    if (nRows <= 0 || nCols <= 0) return;
+
+    /* row histograms of the first output column */
+    memset(work, 0, (size_t)srcRows*MWVIP_MDNHIST_BINS*sizeof(uint16_T));
+    for (i = 0; i < kCols; i++) {
+        const uint8_T *col = &src[i*srcRows];
+        for (r = 0; r < srcRows; r++) {
+            uint16_T *h = &work[r*MWVIP_MDNHIST_BINS];
+            h[col[r]]++;
+            h[MDN_FINE + (col[r] >> 4)]++;
+        }
+    }
+
+    for (c = 0; c < nCols; c++) {
+        uint8_T *dstCol = &dst[c*nRows];
+
+        if (c > 0) {
+            const uint8_T *out = &src[(c - 1)*srcRows];
+            const uint8_T *in  = &src[(c + kCols - 1)*srcRows];
+            for (r = 0; r < srcRows; r++) {
+                uint16_T *h = &work[r*MWVIP_MDNHIST_BINS];
+                h[out[r]]--;
+                h[MDN_FINE + (out[r] >> 4)]--;
+                h[in[r]]++;
+                h[MDN_FINE + (in[r] >> 4)]++;
+            }
+        }
+
+        memset(kernel, 0, MWVIP_MDNHIST_BINS*sizeof(uint16_T));
+        for (r = 0; r < kRows; r++) {
+            HistAdd(kernel, &work[r*MWVIP_MDNHIST_BINS]);
+        }
+        dstCol[0] = HistRank(kernel, rank);
+
+        for (r = 1; r < nRows; r++) {
+            HistAddSub(kernel, &work[(r + kRows - 1)*MWVIP_MDNHIST_BINS],
+                       &work[(r - 1)*MWVIP_MDNHIST_BINS]);
+            dstCol[r] = HistRank(kernel, rank);
+        }
+    }
+}
+
+/* [EOF] mdnfilter_hist_u8_rt.c */
@@ -0,0 +1,70 @@
+/*
+ *  MDNFILTER_NET_RT Median selection networks of the small median filter
+ *  kernels.
+ *
+ *  MWVIP_MDN_NET9 and MWVIP_MDN_NET25 apply the compare-swap S(a,b), which
+ *  leaves min(a,b) in a and max(a,b) in b, to the 9 or 25 elements of p,
+ *  after which the median is p[4] or p[12]. The other elements are only
+ *  partially ordered. The networks have no data dependent branches, so S
+ *  can be one of the s2* macros of vipmdnfilter_rt.h or a pair of SIMD
+ *  min/max instructions that select the medians of many windows at once.
+ *  Both networks were checked on all 0-1 inputs, which by the 0-1
+ *  principle covers all inputs.
+ *
+ *  Copyright 2016 The MathWorks, Inc.
+ */
+
+#ifndef mdnfilter_net_rt_h
+#define mdnfilter_net_rt_h
+
+#include "vipmdnfilter_rt.h"
+
+/* 19 compare-swaps */
+#define MWVIP_MDN_NET9(S, p) \
+    S(p[1], p[2]); S(p[4], p[5]); S(p[7], p[8]); \
+    S(p[0], p[1]); S(p[3], p[4]); S(p[6], p[7]); \
+    S(p[1], p[2]); S(p[4], p[5]); S(p[7], p[8]); \
+    S(p[0], p[3]); S(p[5], p[8]); S(p[4], p[7]); \
+    S(p[3], p[6]); S(p[1], p[4]); S(p[2], p[5]); \
+    S(p[4], p[7]); S(p[4], p[2]); S(p[6], p[4]); \
+    S(p[4], p[2])
+
+/* 99 compare-swaps */
+#define MWVIP_MDN_NET25(S, p) \
+    S(p[0], p[1]);   S(p[3], p[4]);   S(p[2], p[4]); \
+    S(p[2], p[3]);   S(p[6], p[7]);   S(p[5], p[7]); \
+    S(p[5], p[6]);   S(p[9], p[10]);  S(p[8], p[10]); \
+    S(p[8], p[9]);   S(p[12], p[13]); S(p[11], p[13]); \
+    S(p[11], p[12]); S(p[15], p[16]); S(p[14], p[16]); \
+    S(p[14], p[15]); S(p[18], p[19]); S(p[17], p[19]); \
+    S(p[17], p[18]); S(p[21], p[22]); S(p[20], p[22]); \
+    S(p[20], p[21]); S(p[23], p[24]); S(p[2], p[5]); \
+    S(p[3], p[6]);   S(p[0], p[6]);   S(p[0], p[3]); \
+    S(p[4], p[7]);   S(p[1], p[7]);   S(p[1], p[4]); \
+    S(p[11], p[14]); S(p[8], p[14]);  S(p[8], p[11]); \
+    S(p[12], p[15]); S(p[9], p[15]);  S(p[9], p[12]); \
+    S(p[13], p[16]); S(p[10], p[16]); S(p[10], p[13]); \
+    S(p[20], p[23]); S(p[17], p[23]); S(p[17], p[20]); \
+    S(p[21], p[24]); S(p[18], p[24]); S(p[18], p[21]); \
+    S(p[19], p[22]); S(p[8], p[17]);  S(p[9], p[18]); \
+    S(p[0], p[18]);  S(p[0], p[9]);   S(p[10], p[19]); \
+    S(p[1], p[19]);  S(p[1], p[10]);  S(p[11], p[20]); \
+    S(p[2], p[20]);  S(p[2], p[11]);  S(p[12], p[21]); \
+    S(p[3], p[21]);  S(p[3], p[12]);  S(p[13], p[22]); \
+    S(p[4], p[22]);  S(p[4], p[13]);  S(p[14], p[23]); \
+    S(p[5], p[23]);  S(p[5], p[14]);  S(p[15], p[24]); \
+    S(p[6], p[24]);  S(p[6], p[15]);  S(p[7], p[16]); \
+    S(p[7], p[19]);  S(p[13], p[21]); S(p[15], p[23]); \
+    S(p[7], p[13]);  S(p[7], p[15]);  S(p[1], p[9]); \
+    S(p[3], p[11]);  S(p[5], p[17]);  S(p[11], p[17]); \
+    S(p[9], p[17]);  S(p[4], p[10]);  S(p[6], p[12]); \
+    S(p[7], p[14]);  S(p[4], p[6]);   S(p[4], p[7]); \
+    S(p[12], p[14]); S(p[10], p[14]); S(p[6], p[7]); \
+    S(p[10], p[12]); S(p[6], p[10]);  S(p[6], p[17]); \
+    S(p[12], p[17]); S(p[7], p[17]);  S(p[7], p[10]); \
+    S(p[12], p[18]); S(p[7], p[12]);  S(p[10], p[18]); \
+    S(p[12], p[20]); S(p[10], p[20]); S(p[10], p[12])
+
+#endif /* mdnfilter_net_rt_h */
+
+/* [EOF] mdnfilter_net_rt.h */
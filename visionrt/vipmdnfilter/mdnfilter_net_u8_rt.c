@@ -0,0 +1,188 @@
+/*
+ *  mdnfilter_net_u8_rt.c
+ *
+ *  3x3 and 5x5 uint8 median filters. Images are column major, so the
+ *  windows of consecutive output rows are the same loads shifted by one
+ *  element: each output column is filtered 16 rows at a time (32 with
+ *  AVX2) by loading the k*k window elements of all of them into vectors
+ *  and running the median network of mdnfilter_net_rt.h with min/max
+ *  instructions as the compare-swap. When a column is not a multiple of
+ *  the vector width, the last vector overlaps the one before it; columns
+ *  shorter than a vector use the scalar network.
+ *
+ *  Copyright 2016 The MathWorks, Inc.
+ */
+#include "mdnfilter_net_rt.h"
+
+#if defined(__ARM_NEON__) || defined(__ARM_NEON)
+#include <arm_neon.h>
+#define MWVIP_MDNFILTER_NEON 1
+#define MWVIP_MDNFILTER_LANES 16
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define MWVIP_MDNFILTER_SSE2 1
+#define MWVIP_MDNFILTER_LANES 16
+#endif
+
+#if defined(MWVIP_MDNFILTER_SSE2) && (defined(_MSC_VER) || defined(__GNUC__) || defined(__clang__))
+#include <immintrin.h>
+#include "vipcpu_rt.h"
+#define MWVIP_MDNFILTER_AVX2 1
+#if defined(__GNUC__) || defined(__clang__)
+#define MWVIP_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define MWVIP_TARGET_AVX2
+#endif
+#endif
+
+/* window of output row r of the column at src, srcRows apart */
+#define MDN_WINDOW(p, LOAD, src, srcRows, r, k)                 \
+    {                                                           \
+        int_T dc, dr;                                           \
+        for (dc = 0; dc < (k); dc++) {                          \
+            for (dr = 0; dr < (k); dr++) {                      \
+                (p)[dc*(k) + dr] = LOAD(&(src)[dc*(srcRows) + (r) + dr]); \
+            }                                                   \
+        }                                                       \
+    }
+
+#define MDN_SCALAR_LOAD(x) (*(x))
+
+static void MedianColumnScalar(const uint8_T *src, uint8_T *dst, int_T srcRows,
+                               int_T nRows, int_T k)
+{
+    uint8_T p[25];
+    int_T r;
+    for (r = 0; r < nRows; r++) {
+        MDN_WINDOW(p, MDN_SCALAR_LOAD, src, srcRows, r, k);
+        if (k == 3) {
+            MWVIP_MDN_NET9(s2ui8, p);
+            dst[r] = p[4];
+        } else {
+            MWVIP_MDN_NET25(s2ui8, p);
+            dst[r] = p[12];
+        }
+    }
+}
+
+#if defined(MWVIP_MDNFILTER_SSE2)
+#define MDN_SSE2_LOAD(x) _mm_loadu_si128((const __m128i *)(x))
+#define MDN_SSE2_SORT(a, b) \
+    { __m128i t = _mm_min_epu8(a, b); b = _mm_max_epu8(a, b); a = t; }
+
+static void MedianColumnVector(const uint8_T *src, uint8_T *dst, int_T srcRows,
+                               int_T nRows, int_T k)
+{
+    __m128i p[25];
+    int_T r = 0;
+    for (;;) {
+        MDN_WINDOW(p, MDN_SSE2_LOAD, src, srcRows, r, k);
+        if (k == 3) {
+            MWVIP_MDN_NET9(MDN_SSE2_SORT, p);
+            _mm_storeu_si128((__m128i *)&dst[r], p[4]);
+        } else {
+            MWVIP_MDN_NET25(MDN_SSE2_SORT, p);
+            _mm_storeu_si128((__m128i *)&dst[r], p[12]);
+        }
+        if (r + 16 == nRows) break;
+        r = (r + 32 <= nRows) ? r + 16 : nRows - 16;
+    }
+}
+#elif defined(MWVIP_MDNFILTER_NEON)
+#define MDN_NEON_SORT(a, b) \
+    { uint8x16_t t = vminq_u8(a, b); b = vmaxq_u8(a, b); a = t; }
+
+static void MedianColumnVector(const uint8_T *src, uint8_T *dst, int_T srcRows,
+                               int_T nRows, int_T k)
+{
+    uint8x16_t p[25];
+    int_T r = 0;
+    for (;;) {
+        MDN_WINDOW(p, vld1q_u8, src, srcRows, r, k);
+        if (k == 3) {
+            MWVIP_MDN_NET9(MDN_NEON_SORT, p);
+            vst1q_u8(&dst[r], p[4]);
+        } else {
+            MWVIP_MDN_NET25(MDN_NEON_SORT, p);
+            vst1q_u8(&dst[r], p[12]);
+        }
+        if (r + 16 == nRows) break;
+        r = (r + 32 <= nRows) ? r + 16 : nRows - 16;
+    }
+}
+#endif
+
+#if defined(MWVIP_MDNFILTER_AVX2)
+#define MDN_AVX2_LOAD(x) _mm256_loadu_si256((const __m256i *)(x))
+#define MDN_AVX2_SORT(a, b) \
+    { __m256i t = _mm256_min_epu8(a, b); b = _mm256_max_epu8(a, b); a = t; }
+
+MWVIP_TARGET_AVX2
+static void MedianColumnAVX2(const uint8_T *src, uint8_T *dst, int_T srcRows,
+                             int_T nRows, int_T k)
+{
+    __m256i p[25];
+    int_T r = 0;
+    for (;;) {
+        MDN_WINDOW(p, MDN_AVX2_LOAD, src, srcRows, r, k);
+        if (k == 3) {
+            MWVIP_MDN_NET9(MDN_AVX2_SORT, p);
+            _mm256_storeu_si256((__m256i *)&dst[r], p[4]);
+        } else {
+            MWVIP_MDN_NET25(MDN_AVX2_SORT, p);
+            _mm256_storeu_si256((__m256i *)&dst[r], p[12]);
+        }
+        if (r + 32 == nRows) break;
+        r = (r + 64 <= nRows) ? r + 32 : nRows - 32;
+    }
+}
+
+/* resolved on the first call */
+static int_T mwvipMdnUseAVX2 = -1;
+#endif
+
+static void MedianFilterNet(const uint8_T *src, uint8_T *dst,
+                            int_T nRows, int_T nCols, int_T k)
+{
+    const int_T srcRows = nRows + k - 1;
+    int_T c;
+#if defined(MWVIP_MDNFILTER_AVX2)
+    int_T useAVX2;
+    if (mwvipMdnUseAVX2 < 0) {
+        mwvipMdnUseAVX2 = (MWVIP_CpuFeatures() & MWVIP_CPU_AVX2) != 0;
+    }
+    useAVX2 = mwvipMdnUseAVX2 && nRows >= 32;
+#endif
+
+    for (c = 0; c < nCols; c++) {
+        const uint8_T *srcCol = &src[c*srcRows];
+        uint8_T *dstCol = &dst[c*nRows];
+#if defined(MWVIP_MDNFILTER_AVX2)
+        if (useAVX2) {
+            MedianColumnAVX2(srcCol, dstCol, srcRows, nRows, k);
+            continue;
+        }
+#endif
+#if defined(MWVIP_MDNFILTER_LANES)
+        if (nRows >= MWVIP_MDNFILTER_LANES) {
+            MedianColumnVector(srcCol, dstCol, srcRows, nRows, k);
+            continue;
+        }
+#endif
+        MedianColumnScalar(srcCol, dstCol, srcRows, nRows, k);
+    }
+}
+
+LIBMWVISIONRT_API void MWVIP_MedianFilter3x3_U8(const uint8_T *src, uint8_T *dst,
+                                                int_T nRows, int_T nCols)
+{
+    MedianFilterNet(src, dst, nRows, nCols, 3);
+}
+
+LIBMWVISIONRT_API void MWVIP_MedianFilter5x5_U8(const uint8_T *src, uint8_T *dst,
+                                                int_T nRows, int_T nCols)
+{
+    MedianFilterNet(src, dst, nRows, nCols, 5);
+}
+
+/* [EOF] mdnfilter_net_u8_rt.c */
@@ -0,0 +1,15 @@
+/*
+ *  mdnfilter_sorted_d_rt.c
+ *
+ *  Sliding median filter of double images; see mdnfilter_sorted_rt.h.
+ *  NaN orders after every number.
+ *
+ *  Copyright 2016 The MathWorks, Inc.
+ */
+#define MDN_T real_T
+#define MDN_LT(a,b) ((a) < (b) || ((b) != (b) && (a) == (a)))
+#define MDN_FCN MWVIP_MedianFilterSorted_D
+
+#include "mdnfilter_sorted_rt.h"
+
+/* [EOF] mdnfilter_sorted_d_rt.c */
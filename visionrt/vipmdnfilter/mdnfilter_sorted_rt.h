@@ -0,0 +1,125 @@
+/*
+ *  MDNFILTER_SORTED_RT Sliding median filter on a sorted copy of the
+ *  neighborhood, included once by the file of each data type after it
+ *  defines:
+ *
+ *    MDN_T        element type
+ *    MDN_LT(a,b)  strict weak order of MDN_T
+ *    MDN_FCN      name of the exported filter
+ *
+ *  The work buffer holds the kRows*kCols elements under the neighborhood in
+ *  sorted order, so the median is its middle element. The neighborhood
+ *  snakes through the image, down the even output columns and up the odd
+ *  ones, so that it is only sorted once: a step along a column replaces
+ *  kCols elements, a step to the next column kRows elements. Each
+ *  replacement finds the old element and the place of the new one by
+ *  binary search and moves only the elements between them, which are few
+ *  when neighboring pixels have close values.
+ *
+ *  Copyright 2016 The MathWorks, Inc.
+ */
+
+/* no include guard: the body is instantiated by each includer */
+#include "vipmdnfilter_rt.h"
+#include <string.h>
+
+/* first index of w[lo..hi) whose element is not less than v */
+static int_T MdnLowerBound(const MDN_T *w, int_T lo, int_T hi, MDN_T v)
+{
+    while (lo < hi) {
+        int_T mid = lo + (hi - lo)/2;
+        if (MDN_LT(w[mid], v)) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return lo;
+}
+
+/* first index of w[lo..hi) whose element is greater than v */
+static int_T MdnUpperBound(const MDN_T *w, int_T lo, int_T hi, MDN_T v)
+{
+    while (lo < hi) {
+        int_T mid = lo + (hi - lo)/2;
+        if (MDN_LT(v, w[mid])) {
+            hi = mid;
+        } else {
+            lo = mid + 1;
+        }
+    }
+    return lo;
+}
+
+/* replaces an element equivalent to out, which w holds, with in */
+static void MdnReplace(MDN_T *w, int_T n, MDN_T out, MDN_T in)
+{
+    int_T p = MdnLowerBound(w, 0, n, out);
+    int_T q;
+    if (MDN_LT(in, out)) {
+        q = MdnUpperBound(w, 0, p, in);
+        memmove(&w[q + 1], &w[q], (size_t)(p - q)*sizeof(MDN_T));
+        w[q] = in;
+    } else {
+        q = MdnUpperBound(w, p + 1, n, in);
+        memmove(&w[p], &w[p + 1], (size_t)(q - p - 1)*sizeof(MDN_T));
+        w[q - 1] = in;
+    }
+}
+
+LIBMWVISIONRT_API void MDN_FCN(const MDN_T *src, MDN_T *dst,
+                               int_T nRows, int_T nCols,
+                               int_T kRows, int_T kCols, MDN_T *work)
+{
+    const int_T srcRows = nRows + kRows - 1;
+    const int_T area = kRows*kCols;
+    int_T c, r, i, j;
+
+    if (nRows <= 0 || nCols <= 0) return;
+
+    /* neighborhood of the first output pixel, by insertion */
+    for (j = 0; j < kCols; j++) {
+        for (i = 0; i < kRows; i++) {
+            const int_T n = j*kRows + i;
+            const MDN_T v = src[j*srcRows + i];
+            const int_T q = MdnUpperBound(work, 0, n, v);
+            memmove(&work[q + 1], &work[q], (size_t)(n - q)*sizeof(MDN_T));
+            work[q] = v;
+        }
+    }
+
+    r = 0;
+    for (c = 0; c < nCols; c++) {
+        const MDN_T *srcCol = &src[c*srcRows];
+        if (c > 0) {
+            /* one column to the right, at the row the last one ended */
+            for (i = 0; i < kRows; i++) {
+                MdnReplace(work, area, srcCol[r - srcRows + i],
+                           srcCol[(kCols - 1)*srcRows + r + i]);
+            }
+        }
+        dst[c*nRows + r] = work[area/2];
+
+        if ((c & 1) == 0) {
+            for (r = r + 1; r < nRows; r++) {
+                for (j = 0; j < kCols; j++) {
+                    MdnReplace(work, area, srcCol[j*srcRows + r - 1],
+                               srcCol[j*srcRows + r + kRows - 1]);
+                }
+                dst[c*nRows + r] = work[area/2];
+            }
+            r = nRows - 1;
+        } else {
+            for (r = r - 1; r >= 0; r--) {
+                for (j = 0; j < kCols; j++) {
+                    MdnReplace(work, area, srcCol[j*srcRows + r + kRows],
+                               srcCol[j*srcRows + r]);
+                }
+                dst[c*nRows + r] = work[area/2];
+            }
+            r = 0;
+        }
+    }
+}
+
+/* [EOF] mdnfilter_sorted_rt.h */
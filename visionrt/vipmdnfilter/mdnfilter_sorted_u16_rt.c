@@ -0,0 +1,14 @@
+/*
+ *  mdnfilter_sorted_u16_rt.c
+ *
+ *  Sliding median filter of uint16 images; see mdnfilter_sorted_rt.h.
+ *
+ *  Copyright 2016 The MathWorks, Inc.
+ */
+#define MDN_T uint16_T
+#define MDN_LT(a,b) ((a) < (b))
+#define MDN_FCN MWVIP_MedianFilterSorted_U16
+
+#include "mdnfilter_sorted_rt.h"
+
+/* [EOF] mdnfilter_sorted_u16_rt.c */
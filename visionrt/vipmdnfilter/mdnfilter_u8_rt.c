@@ -0,0 +1,28 @@
+/*
+ *  mdnfilter_u8_rt.c
+ *
+ *  uint8 median filter of any odd neighborhood size. The 3x3 and 5x5
+ *  neighborhoods use the vectorized median networks; the histogram filter,
+ *  whose cost per pixel is constant but higher, takes every other size.
+ *  work is only used by the histogram filter and may be NULL for 3x3 and
+ *  5x5.
+ *
+ *  Copyright 2016 The MathWorks, Inc.
+ */
+#include "vipmdnfilter_rt.h"
+
+LIBMWVISIONRT_API void MWVIP_MedianFilter_U8(const uint8_T *src, uint8_T *dst,
+                                             int_T nRows, int_T nCols,
+                                             int_T kRows, int_T kCols,
+                                             uint16_T *work)
+{
+    if (kRows == 3 && kCols == 3) {
+        MWVIP_MedianFilter3x3_U8(src, dst, nRows, nCols);
+    } else if (kRows == 5 && kCols == 5) {
+        MWVIP_MedianFilter5x5_U8(src, dst, nRows, nCols);
+    } else {
+        MWVIP_MedianFilterHist_U8(src, dst, nRows, nCols, kRows, kCols, work);
+    }
+}
+
+/* [EOF] mdnfilter_u8_rt.c */
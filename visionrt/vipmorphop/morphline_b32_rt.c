@@ -0,0 +1,124 @@
+/*
+ *  MORPHLINE_B32_RT runtime function for VIPBLKS Erosion and Dilation blocks
+ *
+ *  Erodes or dilates a packed binary image by a line. F_s(x), the AND
+ *  (erosion) or OR (dilation) of in(x + k*v) for k = 0 .. s-1, doubles with
+ *  F_2s(x) = F_s(x) op F_s(x + s*v); a line leaving the image never enters
+ *  it again, so the pixels beyond it are simply the identity of op. The
+ *  window k = first .. first+length-1 is the forward part k >= 0 and the
+ *  backward part k < 0, each built by doubling.
+ *
+ *  Copyright 2016 The MathWorks, Inc.
+ */
+#include "morphop_rt.h"
+
+/* word q of a packed column, the identity fill outside the column */
+static uint32_T SourceWord(const uint32_T *col, int_T q, int_T numWords,
+                           uint32_T lastMask, uint32_T fill)
+{
+    if (q < 0 || q >= numWords) return fill;
+    if (q == numWords - 1) return (col[q] & lastMask) | (fill & ~lastMask);
+    return col[q];
+}
+
+/* dst(x) = a(x) op b(x + (dRow, dCol)), b outside the image being the
+ * identity of op */
+static void CombineShifted(const uint32_T *a, const uint32_T *b, uint32_T *dst,
+                           int_T rows, int_T cols, int_T op, int_T dRow, int_T dCol)
+{
+    const int_T numWords = MWVIP_MORPH_PACKED_WORDS(rows);
+    const uint32_T lastMask = (rows & 31) ? (((uint32_T)1 << (rows & 31)) - 1U) : 0xFFFFFFFFU;
+    const uint32_T fill = (op == MWVIP_MORPH_ERODE) ? 0xFFFFFFFFU : 0U;
+    /* source bit of bit 0 of word k: 32*(k + q0) + sh */
+    const int_T q0 = (dRow >= 0) ? (dRow >> 5) : -((-dRow + 31) >> 5);
+    const int_T sh = dRow - 32*q0;
+    int_T j;
+
+#if defined(MWVIP_MORPH_PARALLEL)
+    #pragma omp parallel for schedule(static) \
+        if (rows*cols >= MWVIP_MORPH_MIN_PARALLEL)
+#endif
+    for (j = 0; j < cols; j++) {
+        const uint32_T *aj = &a[j*numWords];
+        uint32_T *dj = &dst[j*numWords];
+        const int_T jb = j + dCol;
+        int_T k;
+        if (jb < 0 || jb >= cols) {
+            if (dj != aj) memcpy(dj, aj, (size_t)numWords*sizeof(uint32_T));
+            continue;
+        }
+        for (k = 0; k < numWords; k++) {
+            const uint32_T *bj = &b[jb*numWords];
+            uint32_T w = SourceWord(bj, k + q0, numWords, lastMask, fill);
+            if (sh != 0) {
+                w = (w >> sh) | (SourceWord(bj, k + q0 + 1, numWords, lastMask, fill) << (32 - sh));
+            }
+            dj[k] = (op == MWVIP_MORPH_ERODE) ? (aj[k] & w) : (aj[k] | w);
+        }
+    }
+}
+
+/* F_s of in along (dr, dc) into one of the two buffers, which it returns */
+static uint32_T *Doubling(const uint32_T *in, uint32_T *buf0, uint32_T *buf1,
+                          int_T rows, int_T cols, int_T op, int_T dr, int_T dc, int_T s)
+{
+    const uint32_T *cur = in;
+    uint32_T *next;
+    int_T p = 1;
+
+    while (2*p <= s) {
+        next = (cur == buf0) ? buf1 : buf0;
+        CombineShifted(cur, cur, next, rows, cols, op, p*dr, p*dc);
+        cur = next;
+        p *= 2;
+    }
+    if (s > p) {
+        next = (cur == buf0) ? buf1 : buf0;
+        CombineShifted(cur, cur, next, rows, cols, op, (s - p)*dr, (s - p)*dc);
+        cur = next;
+    }
+    if (cur == in) {
+        memcpy(buf0, in, (size_t)MWVIP_MORPH_PACKED_WORDS(rows)*cols*sizeof(uint32_T));
+        cur = buf0;
+    }
+    return (uint32_T *)cur;
+}
+
+LIBMWVISIONRT_API boolean_T MWVIP_MorphLine_B32(const uint32_T *in, uint32_T *out,
+                                                int_T rows, int_T cols, int_T op,
+                                                int_T dr, int_T dc, int_T length)
+{
+    const int_T numWords = MWVIP_MORPH_PACKED_WORDS(rows);
+    const size_t size = (size_t)numWords*cols;
+    uint32_T *buf, *forward, *backward;
+    int_T first, j;
+
+    if (rows <= 0 || cols <= 0) return 1;
+    if (length <= 1 || (dr == 0 && dc == 0)) {
+        if (out != in) memcpy(out, in, size*sizeof(uint32_T));
+        return 1;
+    }
+    MWVIP_Morph_Window(op, length, &dr, &dc, &first);
+
+    buf = (uint32_T *)malloc(4*size*sizeof(uint32_T));
+    if (buf == NULL) return 0;
+
+    /* k = 0 .. first+length-1, then k = first .. -1 from x - v backwards */
+    forward = Doubling(in, buf, buf + size, rows, cols, op, dr, dc, first + length);
+    if (first < 0) {
+        backward = Doubling(in, buf + 2*size, buf + 3*size, rows, cols, op, -dr, -dc, -first);
+        CombineShifted(forward, backward, out, rows, cols, op, -dr, -dc);
+    } else {
+        memcpy(out, forward, size*sizeof(uint32_T));
+    }
+    free(buf);
+
+    /* the bits past the last row are kept clear */
+    if (rows & 31) {
+        const uint32_T lastMask = ((uint32_T)1 << (rows & 31)) - 1U;
+        for (j = 0; j < cols; j++) out[j*numWords + numWords - 1] &= lastMask;
+    }
+    return 1;
+}
+
+/* [EOF] morphline_b32_rt.c */
@@ -0,0 +1,194 @@
+/*
+ *  MORPHLINE_U8_RT runtime function for VIPBLKS Erosion and Dilation blocks
+ *
+ *  Erodes or dilates a uint8 image by a line with the van Herk/Gil-Werman
+ *  algorithm. The line of pixels p[0 .. m-1], padded with the identity of
+ *  the operation, is cut into blocks of length points; g holds the running
+ *  min or max from the start of each block and h the one to its end, and
+ *  a window covering parts of two blocks is the min or max of one h and
+ *  one g.
+ *
+ *  Copyright 2016 The MathWorks, Inc.
+ */
+#include "morphop_rt.h"
+
+/* rows of the strips filtered together along horizontal lines */
+#define MWVIP_MORPH_STRIP_ROWS 64
+
+#define MWVIP_MORPH_MIN(a, b) ((a) < (b) ? (a) : (b))
+#define MWVIP_MORPH_MAX(a, b) ((a) > (b) ? (a) : (b))
+
+/* y[t] = OP(p[t .. t+n-1]) for t = 0 .. m-n, from the m padded pixels */
+#define MWVIP_MORPH_DEFINE_VHGW(name, OP) \
+static void name(const uint8_T *p, int_T m, int_T n, uint8_T *g, uint8_T *h, \
+                 uint8_T *y, int_T yStride) \
+{ \
+    int_T b, u, t; \
+    for (b = 0; b < m; b += n) { \
+        const int_T e = (b + n < m) ? b + n : m; \
+        g[b] = p[b]; \
+        for (u = b+1; u < e; u++) g[u] = OP(g[u-1], p[u]); \
+        h[e-1] = p[e-1]; \
+        for (u = e-2; u >= b; u--) h[u] = OP(h[u+1], p[u]); \
+    } \
+    for (t = 0; t + n <= m; t++) y[t*yStride] = OP(h[t], g[t+n-1]); \
+}
+
+MWVIP_MORPH_DEFINE_VHGW(VhgwMin, MWVIP_MORPH_MIN)
+MWVIP_MORPH_DEFINE_VHGW(VhgwMax, MWVIP_MORPH_MAX)
+
+/* the same on column segments of len pixels: p[u] is a segment, or NULL
+ * for the padding, and g, h hold m segments */
+#define MWVIP_MORPH_DEFINE_VHGW_SEGMENTS(name, OP, IDENTITY) \
+static void name(const uint8_T *const *p, int_T m, int_T n, int_T len, \
+                 uint8_T *g, uint8_T *h, uint8_T *const *y) \
+{ \
+    int_T b, u, t, i; \
+    for (b = 0; b < m; b += n) { \
+        const int_T e = (b + n < m) ? b + n : m; \
+        for (u = b; u < e; u++) { \
+            uint8_T *gu = &g[u*len]; \
+            if (p[u] == NULL) { \
+                if (u == b) memset(gu, IDENTITY, (size_t)len); \
+                else memcpy(gu, gu - len, (size_t)len); \
+            } else if (u == b) { \
+                memcpy(gu, p[u], (size_t)len); \
+            } else { \
+                for (i = 0; i < len; i++) gu[i] = OP(gu[i-len], p[u][i]); \
+            } \
+        } \
+        for (u = e-1; u >= b; u--) { \
+            uint8_T *hu = &h[u*len]; \
+            if (p[u] == NULL) { \
+                if (u == e-1) memset(hu, IDENTITY, (size_t)len); \
+                else memcpy(hu, hu + len, (size_t)len); \
+            } else if (u == e-1) { \
+                memcpy(hu, p[u], (size_t)len); \
+            } else { \
+                for (i = 0; i < len; i++) hu[i] = OP(hu[i+len], p[u][i]); \
+            } \
+        } \
+    } \
+    for (t = 0; t + n <= m; t++) { \
+        const uint8_T *ht = &h[t*len], *gt = &g[(t+n-1)*len]; \
+        for (i = 0; i < len; i++) y[t][i] = OP(ht[i], gt[i]); \
+    } \
+}
+
+MWVIP_MORPH_DEFINE_VHGW_SEGMENTS(VhgwSegmentsMin, MWVIP_MORPH_MIN, 255)
+MWVIP_MORPH_DEFINE_VHGW_SEGMENTS(VhgwSegmentsMax, MWVIP_MORPH_MAX, 0)
+
+/* horizontal lines of step dc, on strips of rows */
+static boolean_T MorphHorizontal(const uint8_T *in, uint8_T *out, int_T rows, int_T cols,
+                                 int_T op, int_T dc, int_T length, int_T first)
+{
+    const int_T numStrips = (rows + MWVIP_MORPH_STRIP_ROWS - 1)/MWVIP_MORPH_STRIP_ROWS;
+    const int_T maxM = (cols + dc - 1)/dc + length - 1;
+    boolean_T ok = 1;
+
+#if defined(MWVIP_MORPH_PARALLEL)
+    #pragma omp parallel if (rows*cols >= MWVIP_MORPH_MIN_PARALLEL) reduction(&&:ok)
+#endif
+    {
+        uint8_T *gh = (uint8_T *)malloc(2*(size_t)maxM*MWVIP_MORPH_STRIP_ROWS);
+        const uint8_T **p = (const uint8_T **)malloc((size_t)maxM*sizeof(uint8_T *));
+        uint8_T **y = (uint8_T **)malloc((size_t)maxM*sizeof(uint8_T *));
+        int_T s;
+        if (gh == NULL || p == NULL || y == NULL) ok = 0;
+#if defined(MWVIP_MORPH_PARALLEL)
+        #pragma omp for schedule(dynamic, 1)
+#endif
+        for (s = 0; s < numStrips; s++) {
+            const int_T r0 = s*MWVIP_MORPH_STRIP_ROWS;
+            const int_T len = (rows - r0 < MWVIP_MORPH_STRIP_ROWS) ? rows - r0 : MWVIP_MORPH_STRIP_ROWS;
+            int_T c0;
+            if (gh == NULL || p == NULL || y == NULL) continue;
+            for (c0 = 0; c0 < dc && c0 < cols; c0++) {
+                /* the columns c0, c0+dc, ... padded as the window needs */
+                const int_T numCols = (cols - 1 - c0)/dc + 1;
+                const int_T m = numCols + length - 1;
+                int_T u;
+                for (u = 0; u < m; u++) {
+                    const int_T t = u + first;
+                    p[u] = (t >= 0 && t < numCols) ? &in[(c0 + t*dc)*rows + r0] : NULL;
+                }
+                for (u = 0; u < numCols; u++) {
+                    y[u] = &out[(c0 + u*dc)*rows + r0];
+                }
+                if (op == MWVIP_MORPH_ERODE) {
+                    VhgwSegmentsMin(p, m, length, len, gh, gh + (size_t)maxM*len, y);
+                } else {
+                    VhgwSegmentsMax(p, m, length, len, gh, gh + (size_t)maxM*len, y);
+                }
+            }
+        }
+        free(gh);
+        free((void *)p);
+        free(y);
+    }
+    return ok;
+}
+
+/* any other step, one line of pixels at a time */
+static boolean_T MorphLines(const uint8_T *in, uint8_T *out, int_T rows, int_T cols,
+                            int_T op, int_T dr, int_T dc, int_T length, int_T first)
+{
+    const int_T numLines = MWVIP_Morph_NumLines(rows, cols, dr, dc);
+    const int_T maxM = rows + length - 1;
+    const uint8_T identity = (op == MWVIP_MORPH_ERODE) ? 255 : 0;
+    boolean_T ok = 1;
+
+#if defined(MWVIP_MORPH_PARALLEL)
+    #pragma omp parallel if (rows*cols >= MWVIP_MORPH_MIN_PARALLEL) reduction(&&:ok)
+#endif
+    {
+        uint8_T *buf = (uint8_T *)malloc(4*(size_t)maxM);
+        int_T s;
+        if (buf == NULL) ok = 0;
+#if defined(MWVIP_MORPH_PARALLEL)
+        #pragma omp for schedule(dynamic, 16)
+#endif
+        for (s = 0; s < numLines; s++) {
+            uint8_T *p = buf, *g = buf + maxM, *h = g + maxM, *y = h + maxM;
+            int_T r, c, len, m, u, t;
+            if (buf == NULL) continue;
+            MWVIP_Morph_LineStart(s, rows, cols, dr, dc, &r, &c);
+            len = MWVIP_Morph_LineLength(r, c, rows, cols, dr, dc);
+            m = len + length - 1;
+            for (u = 0; u < m; u++) {
+                t = u + first;
+                p[u] = (t >= 0 && t < len) ? in[(c + t*dc)*rows + r + t*dr] : identity;
+            }
+            if (op == MWVIP_MORPH_ERODE) {
+                VhgwMin(p, m, length, g, h, y, 1);
+            } else {
+                VhgwMax(p, m, length, g, h, y, 1);
+            }
+            for (t = 0; t < len; t++) {
+                out[(c + t*dc)*rows + r + t*dr] = y[t];
+            }
+        }
+        free(buf);
+    }
+    return ok;
+}
+
+LIBMWVISIONRT_API boolean_T MWVIP_MorphLine_U8(const uint8_T *in, uint8_T *out,
+                                               int_T rows, int_T cols, int_T op,
+                                               int_T dr, int_T dc, int_T length)
+{
+    int_T first;
+
+    if (rows <= 0 || cols <= 0) return 1;
+    if (length <= 1 || (dr == 0 && dc == 0)) {
+        if (out != in) memcpy(out, in, (size_t)rows*cols);
+        return 1;
+    }
+    MWVIP_Morph_Window(op, length, &dr, &dc, &first);
+    if (dr == 0) {
+        return MorphHorizontal(in, out, rows, cols, op, dc, length, first);
+    }
+    return MorphLines(in, out, rows, cols, op, dr, dc, length, first);
+}
+
+/* [EOF] morphline_u8_rt.c */
@@ -0,0 +1,75 @@
+/*
+ *  MORPHOP_RT Line geometry shared by the uint8 and the binary erosion and
+ *  dilation kernels.
+ *
+ *  Copyright 2016 The MathWorks, Inc.
+ */
+
+#ifndef morphop_rt_h
+#define morphop_rt_h
+
+#include <stdlib.h>
+#include <string.h>
+#include "vipmorphop_rt.h"
+
+/*
+ * The window of a line: out(x) is the min (erosion) or the max (dilation)
+ * of in(x + k*(dr, dc)) for k = first .. first+length-1. The dilation uses
+ * the reflected line. The step is turned to point down, or right when
+ * horizontal, so that every line of pixels starts on the top or on the
+ * left or right border.
+ */
+MWVIP_INLINE void MWVIP_Morph_Window(int_T op, int_T length, int_T *dr, int_T *dc,
+                                     int_T *first)
+{
+    const int_T center = (length - 1)/2;
+    *first = (op == MWVIP_MORPH_ERODE) ? -center : -(length - 1 - center);
+    if (*dr < 0 || (*dr == 0 && *dc < 0)) {
+        *dr = -*dr;
+        *dc = -*dc;
+        *first = -(*first + length - 1);
+    }
+}
+
+/* number of lines of pixels along the step (dr, dc) turned by
+ * MWVIP_Morph_Window, one per pixel x whose x - (dr, dc) is outside */
+MWVIP_INLINE int_T MWVIP_Morph_NumLines(int_T rows, int_T cols, int_T dr, int_T dc)
+{
+    const int_T topRows = (dr < rows) ? dr : rows;
+    const int_T adc = (dc < 0) ? -dc : dc;
+    const int_T sideCols = (adc < cols) ? adc : cols;
+    return topRows*cols + (rows - topRows)*sideCols;
+}
+
+/* first pixel of line s */
+MWVIP_INLINE void MWVIP_Morph_LineStart(int_T s, int_T rows, int_T cols, int_T dr,
+                                        int_T dc, int_T *r, int_T *c)
+{
+    const int_T topRows = (dr < rows) ? dr : rows;
+    const int_T adc = (dc < 0) ? -dc : dc;
+    const int_T sideCols = (adc < cols) ? adc : cols;
+    if (s < topRows*cols) {
+        *r = s % topRows;
+        *c = s / topRows;
+    } else {
+        s -= topRows*cols;
+        *r = topRows + s % (rows - topRows);
+        *c = s / (rows - topRows);
+        if (dc < 0) *c += cols - sideCols;
+    }
+}
+
+/* number of pixels of the line starting at (r, c) */
+MWVIP_INLINE int_T MWVIP_Morph_LineLength(int_T r, int_T c, int_T rows, int_T cols,
+                                          int_T dr, int_T dc)
+{
+    int_T len = (dr > 0) ? (rows - 1 - r)/dr + 1 : rows*cols;
+    int_T lenC = len;
+    if (dc > 0) lenC = (cols - 1 - c)/dc + 1;
+    if (dc < 0) lenC = c/(-dc) + 1;
+    return (lenC < len) ? lenC : len;
+}
+
+#endif /* morphop_rt_h */
+
+/* [EOF] morphop_rt.h */
@@ -0,0 +1,44 @@
+/*
+ *  MORPHPACK_RT runtime functions for VIPBLKS Erosion and Dilation blocks
+ *
+ *  Packs a binary image 32 rows per word for MWVIP_MorphLine_B32 and
+ *  unpacks the result; the bits past the last row are cleared.
+ *
+ *  Copyright 2016 The MathWorks, Inc.
+ */
+#include "morphop_rt.h"
+
+LIBMWVISIONRT_API void MWVIP_MorphPack_B(const boolean_T *in, uint32_T *packed,
+                                         int_T rows, int_T cols)
+{
+    const int_T numWords = MWVIP_MORPH_PACKED_WORDS(rows);
+    int_T i, j, k;
+
+    for (j = 0; j < cols; j++) {
+        const boolean_T *col = &in[j*rows];
+        for (k = 0; k < numWords; k++) {
+            const int_T i1 = (32*k + 32 < rows) ? 32*k + 32 : rows;
+            uint32_T w = 0;
+            for (i = i1 - 1; i >= 32*k; i--) {
+                w = (w << 1) | (col[i] != 0);
+            }
+            packed[j*numWords + k] = w;
+        }
+    }
+}
+
+LIBMWVISIONRT_API void MWVIP_MorphUnpack_B(const uint32_T *packed, boolean_T *out,
+                                           int_T rows, int_T cols)
+{
+    const int_T numWords = MWVIP_MORPH_PACKED_WORDS(rows);
+    int_T i, j;
+
+    for (j = 0; j < cols; j++) {
+        const uint32_T *col = &packed[j*numWords];
+        for (i = 0; i < rows; i++) {
+            out[j*rows + i] = (boolean_T)((col[i >> 5] >> (i & 31)) & 1U);
+        }
+    }
+}
+
+/* [EOF] morphpack_rt.c */
@@ -0,0 +1,106 @@
+/*
+ *  MORPHSHAPES_RT runtime functions for VIPBLKS Erosion and Dilation blocks
+ *
+ *  Rectangles and octagons as sequences of lines: strel('rectangle') is a
+ *  vertical and a horizontal line, strel('octagon', r) the vertical, the
+ *  horizontal and the two diagonal lines of 2*r/3+1 points.
+ *
+ *  Erosion by a sequence of lines ignores the pixels outside the image at
+ *  every step, which only gives the erosion by their sum when the image
+ *  is the product of its row and column ranges along the lines. The
+ *  octagon is therefore filtered on the image padded by r with the
+ *  identity of the operation, as imerode pads for decomposed strels.
+ *
+ *  Copyright 2016 The MathWorks, Inc.
+ */
+#include "morphop_rt.h"
+
+static const int_T octagonSteps[4][2] = {{1, 0}, {0, 1}, {1, 1}, {1, -1}};
+
+LIBMWVISIONRT_API boolean_T MWVIP_MorphRect_U8(const uint8_T *in, uint8_T *out,
+                                               int_T rows, int_T cols, int_T op,
+                                               int_T height, int_T width)
+{
+    return (boolean_T)(MWVIP_MorphLine_U8(in, out, rows, cols, op, 1, 0, height) &&
+                       MWVIP_MorphLine_U8(out, out, rows, cols, op, 0, 1, width));
+}
+
+LIBMWVISIONRT_API boolean_T MWVIP_MorphOctagon_U8(const uint8_T *in, uint8_T *out,
+                                                  int_T rows, int_T cols, int_T op,
+                                                  int_T radius)
+{
+    const int_T length = 2*(radius/3) + 1;
+    const int_T pad = 3*(radius/3);
+    const int_T pRows = rows + 2*pad, pCols = cols + 2*pad;
+    uint8_T *padded;
+    boolean_T ok = 1;
+    int_T j, k;
+
+    if (rows <= 0 || cols <= 0) return 1;
+    padded = (uint8_T *)malloc((size_t)pRows*pCols);
+    if (padded == NULL) return 0;
+    memset(padded, (op == MWVIP_MORPH_ERODE) ? 255 : 0, (size_t)pRows*pCols);
+    for (j = 0; j < cols; j++) {
+        memcpy(&padded[(j + pad)*pRows + pad], &in[j*rows], (size_t)rows);
+    }
+    for (k = 0; k < 4 && ok; k++) {
+        ok = MWVIP_MorphLine_U8(padded, padded, pRows, pCols, op, octagonSteps[k][0],
+                                octagonSteps[k][1], length);
+    }
+    for (j = 0; j < cols && ok; j++) {
+        memcpy(&out[j*rows], &padded[(j + pad)*pRows + pad], (size_t)rows);
+    }
+    free(padded);
+    return ok;
+}
+
+LIBMWVISIONRT_API boolean_T MWVIP_MorphRect_B32(const uint32_T *in, uint32_T *out,
+                                                int_T rows, int_T cols, int_T op,
+                                                int_T height, int_T width)
+{
+    return (boolean_T)(MWVIP_MorphLine_B32(in, out, rows, cols, op, 1, 0, height) &&
+                       MWVIP_MorphLine_B32(out, out, rows, cols, op, 0, 1, width));
+}
+
+LIBMWVISIONRT_API boolean_T MWVIP_MorphOctagon_B32(const uint32_T *in, uint32_T *out,
+                                                   int_T rows, int_T cols, int_T op,
+                                                   int_T radius)
+{
+    /* the rows are padded by whole words, so that the columns are copied
+     * word by word; the bits past the last row start the bottom padding */
+    const int_T length = 2*(radius/3) + 1;
+    const int_T pad = 3*(radius/3);
+    const int_T padWords = MWVIP_MORPH_PACKED_WORDS(pad);
+    const int_T numWords = MWVIP_MORPH_PACKED_WORDS(rows);
+    const int_T pRows = 32*padWords + rows + pad, pCols = cols + 2*pad;
+    const int_T pWords = MWVIP_MORPH_PACKED_WORDS(pRows);
+    const uint32_T fill = (op == MWVIP_MORPH_ERODE) ? 0xFFFFFFFFU : 0U;
+    const uint32_T lastMask = (rows & 31) ? (((uint32_T)1 << (rows & 31)) - 1U) : 0xFFFFFFFFU;
+    uint32_T *padded;
+    boolean_T ok = 1;
+    int_T j, k;
+    size_t n;
+
+    if (rows <= 0 || cols <= 0) return 1;
+    padded = (uint32_T *)malloc((size_t)pWords*pCols*sizeof(uint32_T));
+    if (padded == NULL) return 0;
+    for (n = 0; n < (size_t)pWords*pCols; n++) padded[n] = fill;
+    for (j = 0; j < cols; j++) {
+        uint32_T *dst = &padded[(j + pad)*pWords + padWords];
+        memcpy(dst, &in[j*numWords], (size_t)numWords*sizeof(uint32_T));
+        dst[numWords-1] = (dst[numWords-1] & lastMask) | (fill & ~lastMask);
+    }
+    for (k = 0; k < 4 && ok; k++) {
+        ok = MWVIP_MorphLine_B32(padded, padded, pRows, pCols, op, octagonSteps[k][0],
+                                 octagonSteps[k][1], length);
+    }
+    for (j = 0; j < cols && ok; j++) {
+        uint32_T *dst = &out[j*numWords];
+        memcpy(dst, &padded[(j + pad)*pWords + padWords], (size_t)numWords*sizeof(uint32_T));
+        dst[numWords-1] &= lastMask;
+    }
+    free(padded);
+    return ok;
+}
+
+/* [EOF] morphshapes_rt.c */
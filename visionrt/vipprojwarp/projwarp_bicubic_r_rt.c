@@ -0,0 +1,173 @@
+/*
+ *  PROJWARP_BICUBIC_R_RT Projective warp of a whole image with bicubic
+ *  interpolation, single precision.
+ *
+ *  Copyright 2016 The MathWorks, Inc.
+ */
+
+#include "vipprojwarp_rt.h"
+
+/* cubic convolution weights of the 4 neighbors of x, in the order of
+ * mwvip_posval_bc_interp_tplt.c: h[0] multiplies the neighbor after x+1 */
+static void CubicWeights(real32_T x, int_T xi, real32_T *h)
+{
+    real32_T x1 = 1-x+xi;
+    real32_T x0 = x1+1;
+    real32_T x2 = x - xi;
+    real32_T x3 = x2+1;
+    h[0] = -(x0*x0*x0) + 5*x0*x0 - 8*x0 + 4;
+    h[3] = -(x3*x3*x3) + 5*x3*x3 - 8*x3 + 4;
+    h[1] = x1*x1*x1 - 2*x1*x1 + 1;
+    h[2] = x2*x2*x2 - 2*x2*x2 + 1;
+}
+
+/* one pixel, with the border cases of mwvip_posval_bc_interp_tplt.c */
+static real32_T BicubicPixel(const real32_T *I, real32_T u, real32_T v,
+                             int_T nRows, int_T nCols)
+{
+    int_T i;
+    int_T ui = (int_T)u;
+    int_T vi = (int_T)v;
+    real32_T h[4], val[4];
+    int_T idx, startCol = 0, endCol = 4;
+    if (v == vi) {
+        /* calculate for just 1 column */
+        startCol = 1;
+        endCol = startCol+1;
+    } else if ((vi == 0) || (vi == (nCols-2))) {
+        /* calculate for just 2 columns*/
+        startCol = 1;
+        endCol = 3;
+    }
+    if (u == ui) {
+        idx = (vi-1+startCol)*nRows + ui;
+        for (i = startCol; i < endCol; i++) {
+            val[i] = I[idx];
+            idx += nRows;
+        }
+    } else if ((ui == 0) || (ui == (nRows-2))) {
+        real32_T frac = u - ui;
+        idx = (vi-1+startCol)*nRows;
+        if (ui > 0)  idx += (nRows-2);
+        for (i = startCol; i < endCol; i++) {
+            val[i] = I[idx]*(1.0F-frac) + I[idx+1]*frac;
+            idx += nRows;
+        }
+    } else {
+        CubicWeights(u, ui, h);
+        idx = (vi-1+startCol)*nRows + (ui-1);
+        for (i = startCol; i < endCol; i++) {
+            val[i] = h[3]*I[idx]+h[2]*I[idx+1]+h[1]*I[idx+2]+h[0]*I[idx+3];
+            idx += nRows;
+        }
+    }
+
+    if (v == vi) {
+        return val[1];
+    } else if ((startCol == 1) && (endCol == 3)) {
+        real32_T frac = v-vi;
+        return val[1]*(1.0F-frac) + val[2]*frac;
+    } else {
+        CubicWeights(v, vi, h);
+        return h[3]*val[0] + h[2]*val[1] + h[1]*val[2] + h[0]*val[3];
+    }
+}
+
+static void WarpColumn(const real32_T *in, real32_T *out, const real32_T *A,
+                       const real32_T *fillVal, boolean_T isScalarFillVal,
+                       int_T nRowsIn, int_T nColsIn, int_T nRowsOut,
+                       int_T nColsOut, int_T nChans, int_T c)
+{
+    const int_T inChanWidth  = nRowsIn*nColsIn;
+    const int_T outChanWidth = nRowsOut*nColsOut;
+    const real32_T maxRow = (real32_T)(nRowsIn-1);
+    const real32_T maxCol = (real32_T)(nColsIn-1);
+    /* u, v and w of row 0 of the scan-line */
+    const real32_T uc = A[3]*c + A[6];
+    const real32_T vc = A[4]*c + A[7];
+    const real32_T wc = A[5]*c + A[8];
+    int_T r0, k, chanIdx;
+
+    for (r0 = 0; r0 < nRowsOut; r0 += MWVIP_PROJWARP_BLOCK) {
+        real32_T row[MWVIP_PROJWARP_BLOCK], col[MWVIP_PROJWARP_BLOCK];
+        int_T n = nRowsOut - r0;
+        int_T numInterior = 0;
+        int_T outIdx = c*nRowsOut + r0;
+        if (n > MWVIP_PROJWARP_BLOCK) n = MWVIP_PROJWARP_BLOCK;
+
+        for (k = 0; k < MWVIP_PROJWARP_BLOCK; k++) {
+            real32_T x = (real32_T)(r0 + k);
+            real32_T recipW = 1/(A[2]*x + wc);
+            row[k] = (A[0]*x + uc)*recipW;
+            col[k] = (A[1]*x + vc)*recipW;
+            /* the 4x4 neighborhood is inside the image, where the
+             * weights of the templates reduce to the general case */
+            numInterior += (row[k] >= 1) & (row[k] < maxRow-1) &
+                           (col[k] >= 1) & (col[k] < maxCol-1);
+        }
+
+        if (numInterior == MWVIP_PROJWARP_BLOCK && n == MWVIP_PROJWARP_BLOCK) {
+            int_T idx[MWVIP_PROJWARP_BLOCK];
+            real32_T hU[MWVIP_PROJWARP_BLOCK][4], hV[MWVIP_PROJWARP_BLOCK][4];
+            for (k = 0; k < MWVIP_PROJWARP_BLOCK; k++) {
+                int_T ui = (int_T)row[k];
+                int_T vi = (int_T)col[k];
+                CubicWeights(row[k], ui, hU[k]);
+                CubicWeights(col[k], vi, hV[k]);
+                idx[k] = (vi-1)*nRowsIn + (ui-1);
+            }
+            for (chanIdx = 0; chanIdx < nChans; chanIdx++) {
+                const real32_T *I = &in[chanIdx*inChanWidth];
+                real32_T *y = &out[chanIdx*outChanWidth + outIdx];
+                for (k = 0; k < MWVIP_PROJWARP_BLOCK; k++) {
+                    const real32_T *h = hU[k];
+                    const real32_T *p = &I[idx[k]];
+                    real32_T val[4];
+                    int_T i;
+                    for (i = 0; i < 4; i++) {
+                        val[i] = h[3]*p[0]+h[2]*p[1]+h[1]*p[2]+h[0]*p[3];
+                        p += nRowsIn;
+                    }
+                    h = hV[k];
+                    y[k] = h[3]*val[0] + h[2]*val[1] + h[1]*val[2] + h[0]*val[3];
+                }
+            }
+        } else {
+            /* border of the warped image */
+            for (k = 0; k < n; k++) {
+                boolean_T inside = (row[k] >= 0) && (row[k] <= maxRow) &&
+                                   (col[k] >= 0) && (col[k] <= maxCol);
+                for (chanIdx = 0; chanIdx < nChans; chanIdx++) {
+                    out[chanIdx*outChanWidth + outIdx + k] = inside ?
+                        BicubicPixel(&in[chanIdx*inChanWidth], row[k], col[k],
+                                     nRowsIn, nColsIn) :
+                        fillVal[isScalarFillVal ? 0 : chanIdx];
+                }
+            }
+        }
+    }
+}
+
+LIBMWVISIONRT_API void MWVIP_ProjWarp_Bicubic_R(const real32_T *in,
+                                                real32_T       *out,
+                                                const real32_T *A,
+                                                const real32_T *fillVal,
+                                                boolean_T       isScalarFillVal,
+                                                int_T nRowsIn,
+                                                int_T nColsIn,
+                                                int_T nRowsOut,
+                                                int_T nColsOut,
+                                                int_T nChans)
+{
+    int_T c;
+#if defined(MWVIP_PROJWARP_PARALLEL)
+    #pragma omp parallel for schedule(dynamic, 8) \
+        if (nRowsOut*nColsOut >= MWVIP_PROJWARP_MIN_PARALLEL)
+#endif
+    for (c = 0; c < nColsOut; c++) {
+        WarpColumn(in, out, A, fillVal, isScalarFillVal, nRowsIn, nColsIn,
+                   nRowsOut, nColsOut, nChans, c);
+    }
+}
+
+/* [EOF] projwarp_bicubic_r_rt.c */
@@ -0,0 +1,118 @@
+/*
+ *  PROJWARP_BILINEAR_R_RT Projective warp of a whole image with bilinear
+ *  interpolation, single precision.
+ *
+ *  Copyright 2016 The MathWorks, Inc.
+ */
+
+#include "vipprojwarp_rt.h"
+
+/* one pixel, with the clamping of mwvip_posval_bl_interp_tplt.c */
+static real32_T BilinearPixel(const real32_T *I, real32_T u, real32_T v,
+                              int_T rows, int_T cols)
+{
+    real32_T deltaU, deltaV, val0, val1;
+    int_T u0 = (int_T)u;
+    int_T u1 = u0+1;
+    int_T v0 = (int_T)v;
+    int_T v1 = v0+1;
+    if (u1 > (rows-1)) u1 = rows-1;
+    if (v1 > (cols-1)) v1 = cols-1;
+    deltaU = u - u0;
+    deltaV = v - v0;
+    val0 = deltaU*I[u1+v0*rows] + (1.0F-deltaU)*I[u0+v0*rows];
+    val1 = deltaU*I[u1+v1*rows] + (1.0F-deltaU)*I[u0+v1*rows];
+    return val1*deltaV + val0*(1.0F-deltaV);
+}
+
+static void WarpColumn(const real32_T *in, real32_T *out, const real32_T *A,
+                       const real32_T *fillVal, boolean_T isScalarFillVal,
+                       int_T nRowsIn, int_T nColsIn, int_T nRowsOut,
+                       int_T nColsOut, int_T nChans, int_T c)
+{
+    const int_T inChanWidth  = nRowsIn*nColsIn;
+    const int_T outChanWidth = nRowsOut*nColsOut;
+    const real32_T maxRow = (real32_T)(nRowsIn-1);
+    const real32_T maxCol = (real32_T)(nColsIn-1);
+    /* u, v and w of row 0 of the scan-line */
+    const real32_T uc = A[3]*c + A[6];
+    const real32_T vc = A[4]*c + A[7];
+    const real32_T wc = A[5]*c + A[8];
+    int_T r0, k, chanIdx;
+
+    for (r0 = 0; r0 < nRowsOut; r0 += MWVIP_PROJWARP_BLOCK) {
+        real32_T row[MWVIP_PROJWARP_BLOCK], col[MWVIP_PROJWARP_BLOCK];
+        int_T n = nRowsOut - r0;
+        int_T numInterior = 0;
+        int_T outIdx = c*nRowsOut + r0;
+        if (n > MWVIP_PROJWARP_BLOCK) n = MWVIP_PROJWARP_BLOCK;
+
+        for (k = 0; k < MWVIP_PROJWARP_BLOCK; k++) {
+            real32_T x = (real32_T)(r0 + k);
+            real32_T recipW = 1/(A[2]*x + wc);
+            row[k] = (A[0]*x + uc)*recipW;
+            col[k] = (A[1]*x + vc)*recipW;
+            /* the 2x2 neighborhood needs no clamping; false for NaN */
+            numInterior += (row[k] >= 0) & (row[k] < maxRow) &
+                           (col[k] >= 0) & (col[k] < maxCol);
+        }
+
+        if (numInterior == MWVIP_PROJWARP_BLOCK && n == MWVIP_PROJWARP_BLOCK) {
+            int_T idx[MWVIP_PROJWARP_BLOCK];
+            real32_T dU[MWVIP_PROJWARP_BLOCK], dV[MWVIP_PROJWARP_BLOCK];
+            for (k = 0; k < MWVIP_PROJWARP_BLOCK; k++) {
+                int_T u0 = (int_T)row[k];
+                int_T v0 = (int_T)col[k];
+                dU[k]  = row[k] - u0;
+                dV[k]  = col[k] - v0;
+                idx[k] = u0 + v0*nRowsIn;
+            }
+            for (chanIdx = 0; chanIdx < nChans; chanIdx++) {
+                const real32_T *I = &in[chanIdx*inChanWidth];
+                real32_T *y = &out[chanIdx*outChanWidth + outIdx];
+                for (k = 0; k < MWVIP_PROJWARP_BLOCK; k++) {
+                    const real32_T *p = &I[idx[k]];
+                    real32_T val0 = dU[k]*p[1]         + (1.0F-dU[k])*p[0];
+                    real32_T val1 = dU[k]*p[nRowsIn+1] + (1.0F-dU[k])*p[nRowsIn];
+                    y[k] = val1*dV[k] + val0*(1.0F-dV[k]);
+                }
+            }
+        } else {
+            /* border of the warped image */
+            for (k = 0; k < n; k++) {
+                boolean_T inside = (row[k] >= 0) && (row[k] <= maxRow) &&
+                                   (col[k] >= 0) && (col[k] <= maxCol);
+                for (chanIdx = 0; chanIdx < nChans; chanIdx++) {
+                    out[chanIdx*outChanWidth + outIdx + k] = inside ?
+                        BilinearPixel(&in[chanIdx*inChanWidth], row[k], col[k],
+                                      nRowsIn, nColsIn) :
+                        fillVal[isScalarFillVal ? 0 : chanIdx];
+                }
+            }
+        }
+    }
+}
+
+LIBMWVISIONRT_API void MWVIP_ProjWarp_Bilinear_R(const real32_T *in,
+                                                 real32_T       *out,
+                                                 const real32_T *A,
+                                                 const real32_T *fillVal,
+                                                 boolean_T       isScalarFillVal,
+                                                 int_T nRowsIn,
+                                                 int_T nColsIn,
+                                                 int_T nRowsOut,
+                                                 int_T nColsOut,
+                                                 int_T nChans)
+{
+    int_T c;
+#if defined(MWVIP_PROJWARP_PARALLEL)
+    #pragma omp parallel for schedule(dynamic, 8) \
+        if (nRowsOut*nColsOut >= MWVIP_PROJWARP_MIN_PARALLEL)
+#endif
+    for (c = 0; c < nColsOut; c++) {
+        WarpColumn(in, out, A, fillVal, isScalarFillVal, nRowsIn, nColsIn,
+                   nRowsOut, nColsOut, nChans, c);
+    }
+}
+
+/* [EOF] projwarp_bilinear_r_rt.c */
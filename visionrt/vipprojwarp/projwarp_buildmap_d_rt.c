@@ -0,0 +1,64 @@
+/*
+ *  PROJWARP_BUILDMAP_R_RT Remap table of a double precision projective
+ *  transformation, for MWVIP_Remap_Bilinear_<DataType>.
+ *
+ *  Copyright 2016 The MathWorks, Inc.
+ */
+
+#include "vipprojwarp_rt.h"
+
+/* fixed point weight of the next row or column, moving the neighborhood
+ * back by one on the last row or column */
+static uint16_T RemapWeight(real_T x, int_T *x0, int_T n)
+{
+    int_T w;
+    *x0 = (int_T)x;
+    if (*x0 >= n-1) {
+        *x0 = n-2;
+        return (uint16_T)MWVIP_REMAP_ONE;
+    }
+    w = (int_T)((x - *x0)*MWVIP_REMAP_ONE + 0.5);
+    return (uint16_T)w;
+}
+
+LIBMWVISIONRT_API void MWVIP_ProjWarp_BuildMap_D(const real_T      *A,
+                                                 MWVIP_REMAP_ENTRY *map,
+                                                 int_T nRowsIn,
+                                                 int_T nColsIn,
+                                                 int_T nRowsOut,
+                                                 int_T nColsOut)
+{
+    const real_T maxRow = (real_T)(nRowsIn-1);
+    const real_T maxCol = (real_T)(nColsIn-1);
+    int_T c;
+#if defined(MWVIP_PROJWARP_PARALLEL)
+    #pragma omp parallel for schedule(static) \
+        if (nRowsOut*nColsOut >= MWVIP_PROJWARP_MIN_PARALLEL)
+#endif
+    for (c = 0; c < nColsOut; c++) {
+        /* the coordinates of MWVIP_ProjWarp_Bilinear_D */
+        const real_T uc = A[3]*c + A[6];
+        const real_T vc = A[4]*c + A[7];
+        const real_T wc = A[5]*c + A[8];
+        MWVIP_REMAP_ENTRY *m = &map[c*nRowsOut];
+        int_T r;
+        for (r = 0; r < nRowsOut; r++) {
+            real_T x = (real_T)r;
+            real_T recipW = 1/(A[2]*x + wc);
+            real_T row = (A[0]*x + uc)*recipW;
+            real_T col = (A[1]*x + vc)*recipW;
+            if ((row >= 0) && (row <= maxRow) && (col >= 0) && (col <= maxCol)) {
+                int_T u0, v0;
+                m[r].wRow = RemapWeight(row, &u0, nRowsIn);
+                m[r].wCol = RemapWeight(col, &v0, nColsIn);
+                m[r].idx  = (int32_T)(u0 + v0*nRowsIn);
+            } else {
+                m[r].idx  = -1;
+                m[r].wRow = 0;
+                m[r].wCol = 0;
+            }
+        }
+    }
+}
+
+/* [EOF] projwarp_buildmap_d_rt.c */
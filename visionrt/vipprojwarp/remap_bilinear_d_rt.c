@@ -0,0 +1,53 @@
+/*
+ *  REMAP_BILINEAR_R_RT Bilinear gather of a double precision image through
+ *  a remap table of MWVIP_ProjWarp_BuildMap_<DataType>.
+ *
+ *  Copyright 2016 The MathWorks, Inc.
+ */
+
+#include "vipprojwarp_rt.h"
+
+LIBMWVISIONRT_API void MWVIP_Remap_Bilinear_D(const real_T            *in,
+                                              real_T                  *out,
+                                              const MWVIP_REMAP_ENTRY *map,
+                                              const real_T            *fillVal,
+                                              boolean_T                isScalarFillVal,
+                                              int_T nRowsIn,
+                                              int_T nColsIn,
+                                              int_T nRowsOut,
+                                              int_T nColsOut,
+                                              int_T nChans)
+{
+    const int_T inChanWidth  = nRowsIn*nColsIn;
+    const int_T outChanWidth = nRowsOut*nColsOut;
+    const real_T scale = 1.0/MWVIP_REMAP_ONE;
+    int_T c;
+#if defined(MWVIP_PROJWARP_PARALLEL)
+    #pragma omp parallel for schedule(static) \
+        if (nRowsOut*nColsOut >= MWVIP_PROJWARP_MIN_PARALLEL)
+#endif
+    for (c = 0; c < nColsOut; c++) {
+        const MWVIP_REMAP_ENTRY *m = &map[c*nRowsOut];
+        int_T chanIdx;
+        for (chanIdx = 0; chanIdx < nChans; chanIdx++) {
+            const real_T *I = &in[chanIdx*inChanWidth];
+            real_T *y = &out[chanIdx*outChanWidth + c*nRowsOut];
+            const real_T fill = fillVal[isScalarFillVal ? 0 : chanIdx];
+            int_T r;
+            for (r = 0; r < nRowsOut; r++) {
+                /* fill pixels gather pixel 0 and discard it, which keeps
+                 * the loop free of branches */
+                const int32_T idx = m[r].idx;
+                const real_T *p = &I[idx < 0 ? 0 : idx];
+                const real_T dU = m[r].wRow*scale;
+                const real_T dV = m[r].wCol*scale;
+                real_T val0 = dU*p[1]         + (1.0-dU)*p[0];
+                real_T val1 = dU*p[nRowsIn+1] + (1.0-dU)*p[nRowsIn];
+                real_T val  = val1*dV + val0*(1.0-dV);
+                y[r] = (idx < 0) ? fill : val;
+            }
+        }
+    }
+}
+
+/* [EOF] remap_bilinear_d_rt.c */
@@ -0,0 +1,53 @@
+/*
+ *  REMAP_BILINEAR_R_RT Bilinear gather of a single precision image through
+ *  a remap table of MWVIP_ProjWarp_BuildMap_<DataType>.
+ *
+ *  Copyright 2016 The MathWorks, Inc.
+ */
+
+#include "vipprojwarp_rt.h"
+
+LIBMWVISIONRT_API void MWVIP_Remap_Bilinear_R(const real32_T          *in,
+                                              real32_T                *out,
+                                              const MWVIP_REMAP_ENTRY *map,
+                                              const real32_T          *fillVal,
+                                              boolean_T                isScalarFillVal,
+                                              int_T nRowsIn,
+                                              int_T nColsIn,
+                                              int_T nRowsOut,
+                                              int_T nColsOut,
+                                              int_T nChans)
+{
+    const int_T inChanWidth  = nRowsIn*nColsIn;
+    const int_T outChanWidth = nRowsOut*nColsOut;
+    const real32_T scale = 1.0F/MWVIP_REMAP_ONE;
+    int_T c;
+#if defined(MWVIP_PROJWARP_PARALLEL)
+    #pragma omp parallel for schedule(static) \
+        if (nRowsOut*nColsOut >= MWVIP_PROJWARP_MIN_PARALLEL)
+#endif
+    for (c = 0; c < nColsOut; c++) {
+        const MWVIP_REMAP_ENTRY *m = &map[c*nRowsOut];
+        int_T chanIdx;
+        for (chanIdx = 0; chanIdx < nChans; chanIdx++) {
+            const real32_T *I = &in[chanIdx*inChanWidth];
+            real32_T *y = &out[chanIdx*outChanWidth + c*nRowsOut];
+            const real32_T fill = fillVal[isScalarFillVal ? 0 : chanIdx];
+            int_T r;
+            for (r = 0; r < nRowsOut; r++) {
+                /* fill pixels gather pixel 0 and discard it, which keeps
+                 * the loop free of branches */
+                const int32_T idx = m[r].idx;
+                const real32_T *p = &I[idx < 0 ? 0 : idx];
+                const real32_T dU = m[r].wRow*scale;
+                const real32_T dV = m[r].wCol*scale;
+                real32_T val0 = dU*p[1]         + (1.0F-dU)*p[0];
+                real32_T val1 = dU*p[nRowsIn+1] + (1.0F-dU)*p[nRowsIn];
+                real32_T val  = val1*dV + val0*(1.0F-dV);
+                y[r] = (idx < 0) ? fill : val;
+            }
+        }
+    }
+}
+
+/* [EOF] remap_bilinear_r_rt.c */
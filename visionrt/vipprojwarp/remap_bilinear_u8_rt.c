@@ -0,0 +1,56 @@
+/*
+ *  REMAP_BILINEAR_U8_RT Bilinear gather of a uint8 image through a remap
+ *  table of MWVIP_ProjWarp_BuildMap_<DataType>, in fixed point.
+ *
+ *  Copyright 2016 The MathWorks, Inc.
+ */
+
+#include "vipprojwarp_rt.h"
+
+/* the 22 bit sums along the rows are brought down to 15 bits, so that the
+ * sum along the columns fits in 32 bits */
+#define REMAP_U8_SHIFT0 7
+#define REMAP_U8_SHIFT1 (2*MWVIP_REMAP_FRAC_BITS - REMAP_U8_SHIFT0)
+
+LIBMWVISIONRT_API void MWVIP_Remap_Bilinear_U8(const uint8_T           *in,
+                                               uint8_T                 *out,
+                                               const MWVIP_REMAP_ENTRY *map,
+                                               const uint8_T           *fillVal,
+                                               boolean_T                isScalarFillVal,
+                                               int_T nRowsIn,
+                                               int_T nColsIn,
+                                               int_T nRowsOut,
+                                               int_T nColsOut,
+                                               int_T nChans)
+{
+    const int_T inChanWidth  = nRowsIn*nColsIn;
+    const int_T outChanWidth = nRowsOut*nColsOut;
+    int_T c;
+#if defined(MWVIP_PROJWARP_PARALLEL)
+    #pragma omp parallel for schedule(static) \
+        if (nRowsOut*nColsOut >= MWVIP_PROJWARP_MIN_PARALLEL)
+#endif
+    for (c = 0; c < nColsOut; c++) {
+        const MWVIP_REMAP_ENTRY *m = &map[c*nRowsOut];
+        int_T chanIdx;
+        for (chanIdx = 0; chanIdx < nChans; chanIdx++) {
+            const uint8_T *I = &in[chanIdx*inChanWidth];
+            uint8_T *y = &out[chanIdx*outChanWidth + c*nRowsOut];
+            const uint8_T fill = fillVal[isScalarFillVal ? 0 : chanIdx];
+            int_T r;
+            for (r = 0; r < nRowsOut; r++) {
+                const int32_T idx = m[r].idx;
+                const uint8_T *p = &I[idx < 0 ? 0 : idx];
+                const uint32_T dU = m[r].wRow;
+                const uint32_T dV = m[r].wCol;
+                uint32_T val0 = (dU*p[1]         + (MWVIP_REMAP_ONE-dU)*p[0]) >> REMAP_U8_SHIFT0;
+                uint32_T val1 = (dU*p[nRowsIn+1] + (MWVIP_REMAP_ONE-dU)*p[nRowsIn]) >> REMAP_U8_SHIFT0;
+                uint32_T val  = (val1*dV + val0*(MWVIP_REMAP_ONE-dV) +
+                                 (1U << (REMAP_U8_SHIFT1-1))) >> REMAP_U8_SHIFT1;
+                y[r] = (idx < 0) ? fill : (uint8_T)val;
+            }
+        }
+    }
+}
+
+/* [EOF] remap_bilinear_u8_rt.c */
@@ -0,0 +1,95 @@
+/*
+ *  UNDISTORT_BUILDMAP_D_RT Remap table of the lens distortion of a camera,
+ *  with the rectification of a stereo camera if any, for
+ *  MWVIP_Remap_Bilinear_<DataType>.
+ *
+ *  Copyright 2016 The MathWorks, Inc.
+ */
+
+#include "vipprojwarp_rt.h"
+
+/* fixed point weight of the next row or column, moving the neighborhood
+ * back by one on the last row or column */
+static uint16_T RemapWeight(real_T x, int_T *x0, int_T n)
+{
+    int_T w;
+    *x0 = (int_T)x;
+    if (*x0 >= n-1) {
+        *x0 = n-2;
+        return (uint16_T)MWVIP_REMAP_ONE;
+    }
+    w = (int_T)((x - *x0)*MWVIP_REMAP_ONE + 0.5);
+    return (uint16_T)w;
+}
+
+LIBMWVISIONRT_API void MWVIP_Undistort_BuildMap_D(const real_T      *K,
+                                                  const real_T      *radial,
+                                                  int_T              numRadial,
+                                                  const real_T      *tangential,
+                                                  const real_T      *Tinv,
+                                                  real_T             xOrigin,
+                                                  real_T             yOrigin,
+                                                  MWVIP_REMAP_ENTRY *map,
+                                                  int_T nRowsIn,
+                                                  int_T nColsIn,
+                                                  int_T nRowsOut,
+                                                  int_T nColsOut)
+{
+    /* IntrinsicMatrix is [fx 0 0; skew fy 0; cx cy 1] */
+    const real_T fx = K[0], skew = K[1], cx = K[2];
+    const real_T fy = K[4], cy = K[5];
+    const real_T k1 = radial[0], k2 = radial[1];
+    const real_T k3 = (numRadial > 2) ? radial[2] : 0.0;
+    const real_T p1 = tangential[0], p2 = tangential[1];
+    const real_T maxRow = (real_T)(nRowsIn-1);
+    const real_T maxCol = (real_T)(nColsIn-1);
+    int_T c;
+#if defined(MWVIP_PROJWARP_PARALLEL)
+    #pragma omp parallel for schedule(static) \
+        if (nRowsOut*nColsOut >= MWVIP_PROJWARP_MIN_PARALLEL)
+#endif
+    for (c = 0; c < nColsOut; c++) {
+        const real_T xc = xOrigin + c;
+        MWVIP_REMAP_ENTRY *m = &map[c*nRowsOut];
+        int_T r;
+        for (r = 0; r < nRowsOut; r++) {
+            real_T x = xc, y = yOrigin + r;
+            real_T xn, yn, r2, alpha, xy, xd, yd, row, col;
+            boolean_T isValid = 1;
+            if (Tinv != NULL) {
+                const real_T u = x*Tinv[0] + y*Tinv[1] + Tinv[2];
+                const real_T v = x*Tinv[3] + y*Tinv[4] + Tinv[5];
+                const real_T w = x*Tinv[6] + y*Tinv[7] + Tinv[8];
+                isValid = (w != 0.0);
+                x = u/w;
+                y = v/w;
+            }
+
+            /* distortPoints */
+            yn = (y - cy)/fy;
+            xn = (x - cx - skew*yn)/fx;
+            r2 = xn*xn + yn*yn;
+            alpha = r2*(k1 + r2*(k2 + r2*k3));
+            xy = xn*yn;
+            xd = xn + xn*alpha + 2.0*p1*xy + p2*(r2 + 2.0*xn*xn);
+            yd = yn + yn*alpha + p1*(r2 + 2.0*yn*yn) + 2.0*p2*xy;
+
+            /* zero based input pixel, as the maps of ImageTransformer less 1 */
+            col = xd*fx + cx + skew*yd - 1.0;
+            row = yd*fy + cy - 1.0;
+            if (isValid && (row >= 0) && (row <= maxRow) &&
+                (col >= 0) && (col <= maxCol)) {
+                int_T u0, v0;
+                m[r].wRow = RemapWeight(row, &u0, nRowsIn);
+                m[r].wCol = RemapWeight(col, &v0, nColsIn);
+                m[r].idx  = (int32_T)(u0 + v0*nRowsIn);
+            } else {
+                m[r].idx  = -1;
+                m[r].wRow = 0;
+                m[r].wCol = 0;
+            }
+        }
+    }
+}
+
+/* [EOF] undistort_buildmap_d_rt.c */
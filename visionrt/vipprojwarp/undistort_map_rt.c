@@ -0,0 +1,92 @@
+/*
+ *  UNDISTORT_MAP_RT Undistortion remap table kept over the frames and
+ *  rebuilt only when the camera, the rectification, the output view or the
+ *  image size change.
+ *
+ *  Copyright 2016 The MathWorks, Inc.
+ */
+
+#include "vipprojwarp_rt.h"
+#include <stdlib.h>
+
+static boolean_T SameValues(const real_T *a, const real_T *b, int_T n)
+{
+    int_T i;
+    for (i = 0; i < n; i++) {
+        if (a[i] != b[i]) return 0;
+    }
+    return 1;
+}
+
+LIBMWVISIONRT_API void MWVIP_UndistortMap_Init(MWVIP_UNDISTORT_MAP *cache)
+{
+    cache->map = NULL;
+    cache->capacity = 0;
+    cache->nRowsOut = 0;
+    cache->nColsOut = 0;
+}
+
+LIBMWVISIONRT_API boolean_T MWVIP_UndistortMap_Update_D(MWVIP_UNDISTORT_MAP *cache,
+                                                        const real_T *K,
+                                                        const real_T *radial,
+                                                        int_T         numRadial,
+                                                        const real_T *tangential,
+                                                        const real_T *Tinv,
+                                                        real_T        xOrigin,
+                                                        real_T        yOrigin,
+                                                        int_T nRowsIn,
+                                                        int_T nColsIn,
+                                                        int_T nRowsOut,
+                                                        int_T nColsOut)
+{
+    const size_t numEntries = (size_t)nRowsOut*nColsOut;
+    real_T k[3];
+    int_T i;
+    k[0] = radial[0];
+    k[1] = radial[1];
+    k[2] = (numRadial > 2) ? radial[2] : 0.0;
+
+    if (cache->map != NULL &&
+        cache->nRowsIn == nRowsIn && cache->nColsIn == nColsIn &&
+        cache->nRowsOut == nRowsOut && cache->nColsOut == nColsOut &&
+        cache->xOrigin == xOrigin && cache->yOrigin == yOrigin &&
+        SameValues(cache->K, K, 9) && SameValues(cache->radial, k, 3) &&
+        SameValues(cache->tangential, tangential, 2) &&
+        cache->hasTinv == (Tinv != NULL) &&
+        (Tinv == NULL || SameValues(cache->Tinv, Tinv, 9))) {
+        return 0;
+    }
+
+    if (numEntries > cache->capacity || cache->map == NULL) {
+        free(cache->map);
+        cache->map = (MWVIP_REMAP_ENTRY *)malloc(
+            (numEntries > 0 ? numEntries : 1)*sizeof(MWVIP_REMAP_ENTRY));
+        cache->capacity = (cache->map != NULL) ? numEntries : 0;
+        if (cache->map == NULL) return 0;
+    }
+
+    for (i = 0; i < 9; i++) cache->K[i] = K[i];
+    for (i = 0; i < 3; i++) cache->radial[i] = k[i];
+    for (i = 0; i < 2; i++) cache->tangential[i] = tangential[i];
+    cache->hasTinv = (boolean_T)(Tinv != NULL);
+    for (i = 0; i < 9; i++) cache->Tinv[i] = (Tinv != NULL) ? Tinv[i] : 0.0;
+    cache->xOrigin  = xOrigin;
+    cache->yOrigin  = yOrigin;
+    cache->nRowsIn  = nRowsIn;
+    cache->nColsIn  = nColsIn;
+    cache->nRowsOut = nRowsOut;
+    cache->nColsOut = nColsOut;
+
+    MWVIP_Undistort_BuildMap_D(K, radial, numRadial, tangential, Tinv,
+                               xOrigin, yOrigin, cache->map,
+                               nRowsIn, nColsIn, nRowsOut, nColsOut);
+    return 1;
+}
+
+LIBMWVISIONRT_API void MWVIP_UndistortMap_Free(MWVIP_UNDISTORT_MAP *cache)
+{
+    free(cache->map);
+    MWVIP_UndistortMap_Init(cache);
+}
+
+/* [EOF] undistort_map_rt.c */
@@ -0,0 +1,305 @@
+/*
+ *  MSAC_R_RT M-estimator sample consensus of single precision data with a
+ *  caller supplied minimal solver.
+ *
+ *  Copyright 2016 The MathWorks, Inc.
+ */
+
+#include "ransac_sample_rt.h"
+#include <stdlib.h>
+
+#define L      MWVIP_SVD_BATCH_LANES
+/* most hypotheses solved and scored before the best model is updated */
+#define ROUND  (4*L)
+/* distances computed between the checks of the truncated sum */
+#define BLOCK  256
+
+/* computeLoopNumber */
+static int_T LoopNumber(int_T sampleSize, real_T confidence, int_T numPts,
+                        int_T inlierNum)
+{
+    real_T p = pow((real_T)inlierNum/(real_T)numPts, (real_T)sampleSize);
+    real_T N;
+    if (p < EPS_real_T) return MAX_int32_T;
+    N = ceil(log10(1.0 - 0.01*confidence)/log10(1.0 - p));
+    return (N < (real_T)MAX_int32_T) ? (int_T)N : MAX_int32_T;
+}
+
+/* sum of the n distances truncated at thr, 4 at a time with SSE2, and
+ * number of those below thr added to count; as in msac.m, a NaN distance
+ * makes the sum NaN */
+static real32_T TruncatedSum(const real32_T *dist, int_T n, real32_T thr,
+                           int_T *count)
+{
+    real32_T acc = 0.0F;
+    int_T i = 0, c = 0;
+#if defined(MWVIP_RANSAC_SSE2)
+    const __m128 vthr = _mm_set1_ps(thr);
+    __m128 vacc = _mm_setzero_ps();
+    __m128i vcount = _mm_setzero_si128();
+    real32_T sums[2];
+    int_T lanes[4];
+    for (; i + 4 <= n; i += 4) {
+        __m128 d = _mm_loadu_ps(dist+i);
+        /* the second operand of min is returned for NaN */
+        vacc = _mm_add_ps(vacc, _mm_min_ps(vthr, d));
+        vcount = _mm_add_epi32(vcount,
+                     _mm_srli_epi32(_mm_castps_si128(_mm_cmplt_ps(d, vthr)), 31));
+    }
+    _mm_storeu_ps(sums, vacc);
+    _mm_storeu_si128((__m128i *)lanes, vcount);
+    acc = sums[0] + sums[1];
+    c = lanes[0] + lanes[1] + lanes[2] + lanes[3];
+#endif
+    for (; i < n; i++) {
+        acc += (dist[i] > thr) ? thr : dist[i];
+        c += (dist[i] < thr);
+    }
+    *count += c;
+    return acc;
+}
+
+/* truncated sum of the distances to model, given up once it reaches bound */
+static real32_T Evaluate(const MWVIP_MSAC_Solver_R *solver, const real32_T *model,
+                       const real32_T *pts1, const real32_T *pts2, int_T numPts,
+                       real32_T thr, real32_T bound, int_T *count)
+{
+    real32_T dist[BLOCK];
+    real32_T acc = 0.0F;
+    int_T first;
+    *count = 0;
+    for (first = 0; first < numPts && acc < bound; first += BLOCK) {
+        int_T n = MIN(BLOCK, numPts - first);
+        solver->distances(solver->data, model, pts1, pts2, numPts, first, n, dist);
+        acc += TruncatedSum(dist, n, thr, count);
+    }
+    return acc;
+}
+
+static int_T FlagInliers(const MWVIP_MSAC_Solver_R *solver, const real32_T *model,
+                         const real32_T *pts1, const real32_T *pts2, int_T numPts,
+                         real32_T thr, boolean_T *inliers)
+{
+    real32_T dist[BLOCK];
+    int_T first, i, count = 0;
+    for (first = 0; first < numPts; first += BLOCK) {
+        int_T n = MIN(BLOCK, numPts - first);
+        solver->distances(solver->data, model, pts1, pts2, numPts, first, n, dist);
+        for (i = 0; i < n; i++) {
+            inliers[first+i] = (boolean_T)(dist[i] < thr);
+            count += inliers[first+i];
+        }
+    }
+    return count;
+}
+
+/* PROSAC order of the correspondences, by increasing metric */
+typedef struct {
+    real32_T metric;
+    int_T  index;
+} MetricIndex;
+
+static int CompareMetric(const void *a, const void *b)
+{
+    const MetricIndex *ma = (const MetricIndex *)a, *mb = (const MetricIndex *)b;
+    if (ma->metric < mb->metric) return -1;
+    if (ma->metric > mb->metric) return 1;
+    return (ma->index > mb->index) - (ma->index < mb->index);
+}
+
+/*
+ * Sorts the correspondences into order and sets growth[n], n = m..numPts,
+ * to the first hypothesis drawn from the first n of them (T'_n - 1 of
+ * Chum and Matas, "Matching with PROSAC", with T_N = maxNumTrials).
+ */
+static boolean_T ProsacSchedule(const real32_T *matchMetric, int_T numPts,
+                                int_T m, int_T maxNumTrials, int_T *order,
+                                real32_T *growth)
+{
+    MetricIndex *sorted = (MetricIndex *)malloc((size_t)numPts*sizeof(MetricIndex));
+    real_T Tn = (real_T)maxNumTrials, Tprime = 1.0;
+    int_T i, n;
+    if (sorted == NULL) return 0;
+    for (i = 0; i < numPts; i++) {
+        sorted[i].metric = matchMetric[i];
+        sorted[i].index  = i;
+    }
+    qsort(sorted, (size_t)numPts, sizeof(MetricIndex), CompareMetric);
+    for (i = 0; i < numPts; i++) order[i] = sorted[i].index;
+    free(sorted);
+
+    for (i = 0; i < m; i++) Tn *= (real_T)(m - i)/(real_T)(numPts - i);
+    growth[m] = 0.0F;
+    for (n = m; n < numPts; n++) {
+        real_T Tn1 = Tn*(real_T)(n + 1)/(real_T)(n + 1 - m);
+        Tprime += ceil(Tn1 - Tn);
+        growth[n+1] = (real32_T)(Tprime - 1.0);
+        Tn = Tn1;
+    }
+    return 1;
+}
+
+/* sample of hypothesis hyp, uniform or with PROSAC when order is set */
+static void DrawSample(uint32_T seed, int_T hyp, int_T numPts, int_T m,
+                       const int_T *order, const real32_T *growth, int_T *idx)
+{
+    int_T lo = m, hi = numPts, k;
+    if (order == NULL) {
+        MWVIP_RANSAC_DrawSample(seed, hyp, numPts, m, idx);
+        return;
+    }
+    /* smallest n whose samples reach hypothesis hyp */
+    while (lo < hi) {
+        int_T mid = lo + (hi - lo)/2;
+        if (growth[mid] >= (real32_T)hyp) {
+            hi = mid;
+        } else {
+            lo = mid + 1;
+        }
+    }
+    MWVIP_RANSAC_DrawProsacSample(seed, hyp, lo, numPts, m, idx);
+    for (k = 0; k < m; k++) idx[k] = order[idx[k]];
+}
+
+LIBMWVISIONRT_API int_T MWVIP_MSAC_R(const MWVIP_MSAC_Solver_R *solver,
+                                     const real32_T              *pts1,
+                                     const real32_T              *pts2,
+                                     int_T                      numPts,
+                                     const real32_T              *matchMetric,
+                                     const MWVIP_MSAC_Params   *params,
+                                     real32_T                    *model,
+                                     boolean_T                 *inliers,
+                                     int_T                     *numTrials,
+                                     int_T                     *numSkipTrials)
+{
+    const int_T  m   = solver->sampleSize;
+    const int_T  q   = solver->modelSize;
+    const int_T  r   = solver->maxModels;
+    const real32_T thr = (real32_T)params->maxDistance;
+    const int_T  maxSkipTrials = (params->maxSkipTrials > 0) ?
+                                 params->maxSkipTrials : 10*params->maxNumTrials;
+    int_T   trialLimit = params->maxNumTrials;
+    int_T   idxTrial = 0, skipTrials = 0, hyp0 = 0, numInliers = 0;
+    real32_T  bestDis = thr*numPts;
+    boolean_T hasModel = 0;
+    int_T  *ints, *samples, *numModels, *bestModel, *count, *order = NULL;
+    real32_T *reals, *models, *loss, *growth = NULL;
+    int_T   i;
+
+    for (i = 0; i < numPts; i++) inliers[i] = 0;
+    *numTrials = 0;
+    *numSkipTrials = 0;
+    if (numPts < m || trialLimit < 1) return 0;
+
+    ints  = (int_T *)malloc(((size_t)ROUND*(m + 3) + 2*(size_t)numPts)*sizeof(int_T));
+    reals = (real32_T *)malloc(((size_t)ROUND*(r*q + 1) + (size_t)numPts + 1)*sizeof(real32_T));
+    if (ints == NULL || reals == NULL) {
+        free(ints);
+        free(reals);
+        return 0;
+    }
+    samples   = ints;
+    numModels = samples + ROUND*m;
+    bestModel = numModels + ROUND;
+    count     = bestModel + ROUND;
+    models    = reals;
+    loss      = models + ROUND*r*q;
+    if (matchMetric != NULL) {
+        order  = count + ROUND;
+        growth = loss + ROUND;
+        if (!ProsacSchedule(matchMetric, numPts, m, params->maxNumTrials,
+                            order, growth)) {
+            order  = NULL;
+            growth = NULL;
+        }
+    }
+
+    while (idxTrial < trialLimit && skipTrials < maxSkipTrials) {
+        /* no more hypotheses than the trials left need */
+        const int_T numChunks = MIN(ROUND/L, (trialLimit - idxTrial + L - 1)/L);
+        const real32_T bound = bestDis;
+        int_T chunk, b;
+
+#if defined(MWVIP_RANSAC_PARALLEL)
+        #pragma omp parallel for schedule(dynamic) \
+            if ((real32_T)numChunks*L*numPts >= MWVIP_RANSAC_MIN_PARALLEL)
+#endif
+        for (chunk = 0; chunk < numChunks; chunk++) {
+            const int_T h0 = chunk*L;
+            int_T h, j;
+            for (h = h0; h < h0 + L; h++) {
+                DrawSample(params->seed, hyp0 + h, numPts, m, order, growth,
+                           &samples[m*h]);
+            }
+            solver->solve(solver->data, pts1, pts2, numPts, &samples[m*h0], L,
+                          &models[r*q*h0], &numModels[h0]);
+            for (h = h0; h < h0 + L; h++) {
+                bestModel[h] = -1;
+                for (j = 0; j < numModels[h]; j++) {
+                    const real32_T *mj = &models[q*(r*h + j)];
+                    if (solver->isValid == NULL || solver->isValid(solver->data, mj)) {
+                        int_T c;
+                        real32_T d = Evaluate(solver, mj, pts1, pts2, numPts, thr,
+                                            bound, &c);
+                        if (bestModel[h] < 0 || d < loss[h]) {
+                            loss[h]      = d;
+                            count[h]     = c;
+                            bestModel[h] = j;
+                        }
+                    }
+                }
+            }
+        }
+
+        /* the trials of msac.m, in the order of the hypotheses */
+        for (b = 0; b < numChunks*L && idxTrial < trialLimit &&
+                    skipTrials < maxSkipTrials; b++) {
+            if (bestModel[b] < 0) {
+                skipTrials++;
+                continue;
+            }
+            if (loss[b] < bestDis) {
+                const real32_T *mb = &models[q*(r*b + bestModel[b])];
+                for (i = 0; i < q; i++) model[i] = mb[i];
+                bestDis    = loss[b];
+                numInliers = count[b];
+                hasModel   = 1;
+                trialLimit = MIN(trialLimit, LoopNumber(m, params->confidence,
+                                                        numPts, numInliers));
+            }
+            idxTrial++;
+        }
+        hyp0 += numChunks*L;
+    }
+    *numTrials = idxTrial;
+    *numSkipTrials = skipTrials;
+
+    if (hasModel && numInliers >= m) {
+        numInliers = FlagInliers(solver, model, pts1, pts2, numPts, thr, inliers);
+        if (params->recomputeModelFromInliers && solver->fit != NULL) {
+            int_T *sel = samples + ROUND*(m + 3) + numPts;
+            int_T numSel = 0;
+            for (i = 0; i < numPts; i++) {
+                if (inliers[i]) sel[numSel++] = i;
+            }
+            if (solver->fit(solver->data, pts1, pts2, numPts, sel, numSel, model) &&
+                (solver->isValid == NULL || solver->isValid(solver->data, model))) {
+                numInliers = FlagInliers(solver, model, pts1, pts2, numPts, thr,
+                                         inliers);
+            } else {
+                numInliers = 0;
+            }
+        }
+    } else {
+        numInliers = 0;
+    }
+    if (numInliers == 0) {
+        for (i = 0; i < numPts; i++) inliers[i] = 0;
+    }
+
+    free(ints);
+    free(reals);
+    return numInliers;
+}
+
+/* [EOF] msac_r_rt.c */
@@ -0,0 +1,362 @@
+/*
+ *  RANSAC_FUNDAMENTAL_D_RT RANSAC estimation of a fundamental matrix from
+ *  single precision point correspondences, and the fundamental matrix
+ *  solver of MWVIP_MSAC_R.
+ *
+ *  Copyright 2016 The MathWorks, Inc.
+ */
+
+#include "ransac_sample_rt.h"
+#include <stdlib.h>
+
+#define L        MWVIP_SVD_BATCH_LANES
+#define NSAMPLE  8
+
+/* c = a*b, 3x3 column major */
+static void Mul3(const real32_T *a, const real32_T *b, real32_T *c)
+{
+    int_T r, k;
+    for (k = 0; k < 3; k++) {
+        for (r = 0; r < 3; r++) {
+            c[3*k+r] = a[r]*b[3*k] + a[3+r]*b[3*k+1] + a[6+r]*b[3*k+2];
+        }
+    }
+}
+
+/* rank 2 fundamental matrix in pixel coordinates of the SVD u*diag(s)*v'
+ * of a normalized one, with a unit Frobenius norm */
+static void ToPixels(const real32_T *u, const real32_T *s, const real32_T *v,
+                     const real32_T *t1, const real32_T *t2, real32_T *F)
+{
+    real32_T T1[9], T2t[9];
+    real32_T Fr[9], tmp[9], nrm = 0.0F;
+    int_T k, c;
+    T1[0] = t1[0];         T1[1] = 0.0F;          T1[2] = 0.0F;
+    T1[3] = 0.0F;          T1[4] = t1[0];         T1[5] = 0.0F;
+    T1[6] = -t1[0]*t1[1];  T1[7] = -t1[0]*t1[2];  T1[8] = 1.0F;
+    T2t[0] = t2[0];  T2t[1] = 0.0F;   T2t[2] = -t2[0]*t2[1];
+    T2t[3] = 0.0F;   T2t[4] = t2[0];  T2t[5] = -t2[0]*t2[2];
+    T2t[6] = 0.0F;   T2t[7] = 0.0F;   T2t[8] = 1.0F;
+    /* drop the smallest singular value */
+    for (c = 0; c < 3; c++) {
+        for (k = 0; k < 3; k++) {
+            Fr[3*c+k] = s[0]*u[k]*v[c] + s[1]*u[3+k]*v[3+c];
+        }
+    }
+    Mul3(T2t, Fr, tmp);
+    Mul3(tmp, T1, F);
+    for (k = 0; k < 9; k++) nrm += F[k]*F[k];
+    if (nrm > 0.0F) {
+        real32_T scale = 1.0F/sqrtf(nrm);
+        for (k = 0; k < 9; k++) F[k] *= scale;
+    }
+}
+
+/* row k of the matrix A of x2'*F*x1 = 0 with n rows, column major, of the
+ * normalized correspondence i */
+#define EIGHT_POINT_ROW(A, n, k, i) \
+    { \
+        real32_T x1 = t1[0]*(pts1[i]        - t1[1]); \
+        real32_T y1 = t1[0]*(pts1[numPts+(i)] - t1[2]); \
+        real32_T x2 = t2[0]*(pts2[i]        - t2[1]); \
+        real32_T y2 = t2[0]*(pts2[numPts+(i)] - t2[2]); \
+        real32_T *r = &(A)[k]; \
+        r[0]      = x2*x1;  r[(n)]    = x2*y1;  r[2*(n)] = x2; \
+        r[3*(n)]  = y2*x1;  r[4*(n)]  = y2*y1;  r[5*(n)] = y2; \
+        r[6*(n)]  = x1;     r[7*(n)]  = y1;     r[8*(n)] = 1.0F; \
+    }
+
+/*
+ * Solves the nh <= L samples of NSAMPLE correspondences in idx into
+ * models, 9 elements each: the 8 point matrices of the normalized samples
+ * are decomposed together, then the null vectors reshaped to 3x3 are
+ * decomposed together to make them rank 2, and brought back to pixel
+ * coordinates. Sample b is normalized with t1 + b*tStride and
+ * t2 + b*tStride.
+ */
+static void SolveChunk(const real32_T *pts1, const real32_T *pts2, int_T numPts,
+                       const int_T *idx, int_T nh, const real32_T *ts1,
+                       const real32_T *ts2, int_T tStride, real32_T *models)
+{
+    real32_T A[L*81], s[L*9], u[L*81], v[L*81], work[L*(81+81+9)];
+    real32_T Fn[L*9];
+    int_T b, k, c;
+
+    for (k = 0; k < L*81; k++) A[k] = 0.0F;
+    for (b = 0; b < nh; b++) {
+        const real32_T *t1 = ts1 + b*tStride, *t2 = ts2 + b*tStride;
+        /* the last row of the 9x9 matrix stays zero */
+        for (k = 0; k < NSAMPLE; k++) EIGHT_POINT_ROW(&A[b*81], 9, k, idx[NSAMPLE*b+k]);
+    }
+    MWVIP_SVD_JacobiBatch_R(A, 9, 9, nh, s, u, v, 1, work);
+
+    for (b = 0; b < nh; b++) {
+        /* right singular vector of the smallest singular value, the rows
+         * of the normalized fundamental matrix */
+        const real32_T *f = &v[b*81 + 72];
+        for (c = 0; c < 3; c++) {
+            for (k = 0; k < 3; k++) Fn[9*b+3*c+k] = f[3*k+c];
+        }
+    }
+    MWVIP_SVD_JacobiBatch_R(Fn, 3, 3, nh, s, u, v, 1, work);
+
+    for (b = 0; b < nh; b++) {
+        ToPixels(&u[9*b], &s[3*b], &v[9*b], ts1 + b*tStride, ts2 + b*tStride,
+                 &models[9*b]);
+    }
+}
+
+/* The model is held in scalars so that the loops over the points
+ * vectorize */
+#define LOAD_MODEL(F) \
+    const real32_T f0 = (F)[0], f1 = (F)[1], f2 = (F)[2], \
+                 f3 = (F)[3], f4 = (F)[4], f5 = (F)[5], \
+                 f6 = (F)[6], f7 = (F)[7], f8 = (F)[8]
+
+/* whether the squared Sampson distance of the correspondence to F is at
+ * most thr2, compared without the division as in the SSE2 loop */
+static int_T SampsonInlier(real32_T f0, real32_T f1, real32_T f2, real32_T f3,
+                           real32_T f4, real32_T f5, real32_T f6, real32_T f7,
+                           real32_T f8, real32_T x1, real32_T y1, real32_T x2,
+                           real32_T y2, real32_T thr2)
+{
+    real32_T a = f0*x1 + f3*y1 + f6;
+    real32_T b = f1*x1 + f4*y1 + f7;
+    real32_T c = f2*x1 + f5*y1 + f8;
+    real32_T d = f0*x2 + f1*y2 + f2;
+    real32_T e = f3*x2 + f4*y2 + f5;
+    real32_T r = x2*a + y2*b + c;
+    return r*r <= thr2*((a*a + b*b) + (d*d + e*e));
+}
+
+#define SAMPSON_INLIER(x1, y1, x2, y2) \
+    SampsonInlier(f0, f1, f2, f3, f4, f5, f6, f7, f8, (x1), (y1), (x2), (y2), thr2)
+
+/* number of correspondences within thr2 (squared), 4 at a time with SSE2 */
+static int_T ScoreModel(const real32_T *F, const real32_T *pts1, const real32_T *pts2,
+                        int_T numPts, real32_T thr2)
+{
+    LOAD_MODEL(F);
+    const real32_T *x1 = pts1, *y1 = pts1 + numPts;
+    const real32_T *x2 = pts2, *y2 = pts2 + numPts;
+    int_T i = 0, count = 0;
+#if defined(MWVIP_RANSAC_SSE2)
+    const __m128 vf0 = _mm_set1_ps(f0), vf1 = _mm_set1_ps(f1), vf2 = _mm_set1_ps(f2);
+    const __m128 vf3 = _mm_set1_ps(f3), vf4 = _mm_set1_ps(f4), vf5 = _mm_set1_ps(f5);
+    const __m128 vf6 = _mm_set1_ps(f6), vf7 = _mm_set1_ps(f7), vf8 = _mm_set1_ps(f8);
+    const __m128 vthr = _mm_set1_ps(thr2);
+    __m128i vcount = _mm_setzero_si128();
+    int_T lanes[4];
+    for (; i + 4 <= numPts; i += 4) {
+        __m128 vx1 = _mm_loadu_ps(x1+i), vy1 = _mm_loadu_ps(y1+i);
+        __m128 vx2 = _mm_loadu_ps(x2+i), vy2 = _mm_loadu_ps(y2+i);
+        __m128 a = _mm_add_ps(_mm_add_ps(_mm_mul_ps(vf0, vx1), _mm_mul_ps(vf3, vy1)), vf6);
+        __m128 b = _mm_add_ps(_mm_add_ps(_mm_mul_ps(vf1, vx1), _mm_mul_ps(vf4, vy1)), vf7);
+        __m128 c = _mm_add_ps(_mm_add_ps(_mm_mul_ps(vf2, vx1), _mm_mul_ps(vf5, vy1)), vf8);
+        __m128 d = _mm_add_ps(_mm_add_ps(_mm_mul_ps(vf0, vx2), _mm_mul_ps(vf1, vy2)), vf2);
+        __m128 e = _mm_add_ps(_mm_add_ps(_mm_mul_ps(vf3, vx2), _mm_mul_ps(vf4, vy2)), vf5);
+        __m128 r = _mm_add_ps(_mm_add_ps(_mm_mul_ps(vx2, a), _mm_mul_ps(vy2, b)), c);
+        __m128 den = _mm_add_ps(_mm_add_ps(_mm_mul_ps(a, a), _mm_mul_ps(b, b)),
+                                 _mm_add_ps(_mm_mul_ps(d, d), _mm_mul_ps(e, e)));
+        /* r^2 <= thr2*den without the division; false for NaN */
+        __m128 isIn = _mm_cmple_ps(_mm_mul_ps(r, r), _mm_mul_ps(vthr, den));
+        vcount = _mm_add_epi32(vcount, _mm_srli_epi32(_mm_castps_si128(isIn), 31));
+    }
+    _mm_storeu_si128((__m128i *)lanes, vcount);
+    count = lanes[0] + lanes[1] + lanes[2] + lanes[3];
+#endif
+    for (; i < numPts; i++) {
+        count += SAMPSON_INLIER(x1[i], y1[i], x2[i], y2[i]);
+    }
+    return count;
+}
+
+static int_T FlagInliers(const real32_T *F, const real32_T *pts1, const real32_T *pts2,
+                         int_T numPts, real32_T thr2, boolean_T *inliers)
+{
+    LOAD_MODEL(F);
+    const real32_T *x1 = pts1, *y1 = pts1 + numPts;
+    const real32_T *x2 = pts2, *y2 = pts2 + numPts;
+    int_T i, count = 0;
+    for (i = 0; i < numPts; i++) {
+        inliers[i] = (boolean_T)SAMPSON_INLIER(x1[i], y1[i], x2[i], y2[i]);
+        count += inliers[i];
+    }
+    return count;
+}
+
+LIBMWVISIONRT_API int_T MWVIP_RANSAC_Fundamental_R(const real32_T *pts1,
+                                                   const real32_T *pts2,
+                                                   int_T         numPts,
+                                                   int_T         numHyp,
+                                                   uint32_T      seed,
+                                                   real32_T        threshold,
+                                                   real32_T       *model,
+                                                   boolean_T    *inliers)
+{
+    const real32_T thr2 = threshold*threshold;
+    const int_T numChunks = (numHyp + L - 1)/L;
+    real32_T t1[3], t2[3];
+    int_T bestCount = -1, bestHyp = numHyp;
+    int_T chunk, k;
+
+    if (numPts < NSAMPLE || numHyp < 1) {
+        for (k = 0; k < numPts; k++) inliers[k] = 0;
+        return 0;
+    }
+    MWVIP_RANSAC_Normalize_R(pts1, numPts, t1);
+    MWVIP_RANSAC_Normalize_R(pts2, numPts, t2);
+
+#if defined(MWVIP_RANSAC_PARALLEL)
+    #pragma omp parallel for schedule(dynamic) \
+        if ((real32_T)numHyp*numPts >= MWVIP_RANSAC_MIN_PARALLEL)
+#endif
+    for (chunk = 0; chunk < numChunks; chunk++) {
+        real32_T models[9*L];
+        int_T h0 = chunk*L;
+        int_T nh = MIN(L, numHyp - h0);
+        int_T idx[NSAMPLE*L];
+        int_T b;
+        for (b = 0; b < nh; b++) {
+            MWVIP_RANSAC_DrawSample(seed, h0+b, numPts, NSAMPLE, &idx[NSAMPLE*b]);
+        }
+        SolveChunk(pts1, pts2, numPts, idx, nh, t1, t2, 0, models);
+        for (b = 0; b < nh; b++) {
+            int_T count = ScoreModel(&models[9*b], pts1, pts2, numPts, thr2);
+#if defined(MWVIP_RANSAC_PARALLEL)
+            #pragma omp critical (MWVIP_RANSAC_Fundamental_R)
+#endif
+            {
+                if (count > bestCount || (count == bestCount && h0+b < bestHyp)) {
+                    int_T m;
+                    bestCount = count;
+                    bestHyp   = h0+b;
+                    for (m = 0; m < 9; m++) model[m] = models[9*b+m];
+                }
+            }
+        }
+    }
+
+    return FlagInliers(model, pts1, pts2, numPts, thr2, inliers);
+}
+
+/*
+ * Fundamental matrix solver of MWVIP_MSAC_R: the model is F as above, the
+ * distance is the Sampson distance, the squared one compared to
+ * maxDistance as by estimateFundamentalMatrix, and each sample is
+ * normalized on its own.
+ */
+static void MSACSolve(void *data, const real32_T *pts1, const real32_T *pts2,
+                      int_T numPts, const int_T *samples, int_T numSamples,
+                      real32_T *models, int_T *numModels)
+{
+    int_T b0, b;
+    (void)data;
+    for (b0 = 0; b0 < numSamples; b0 += L) {
+        const int_T nh = MIN(L, numSamples - b0);
+        real32_T t1[3*L], t2[3*L];
+        for (b = 0; b < nh; b++) {
+            const int_T *idx = &samples[NSAMPLE*(b0+b)];
+            MWVIP_RANSAC_NormalizeSample_R(pts1, numPts, idx, NSAMPLE, &t1[3*b]);
+            MWVIP_RANSAC_NormalizeSample_R(pts2, numPts, idx, NSAMPLE, &t2[3*b]);
+            numModels[b0+b] = 1;
+        }
+        SolveChunk(pts1, pts2, numPts, &samples[NSAMPLE*b0], nh, t1, t2, 3,
+                   &models[9*b0]);
+    }
+}
+
+/* Sampson distances of correspondences first..first+count-1, 4 at a time
+ * with SSE2 */
+static void MSACDistances(void *data, const real32_T *F, const real32_T *pts1,
+                          const real32_T *pts2, int_T numPts, int_T first,
+                          int_T count, real32_T *dist)
+{
+    LOAD_MODEL(F);
+    const real32_T *x1 = pts1 + first, *y1 = pts1 + numPts + first;
+    const real32_T *x2 = pts2 + first, *y2 = pts2 + numPts + first;
+    int_T i = 0;
+#if defined(MWVIP_RANSAC_SSE2)
+    const __m128 vf0 = _mm_set1_ps(f0), vf1 = _mm_set1_ps(f1), vf2 = _mm_set1_ps(f2);
+    const __m128 vf3 = _mm_set1_ps(f3), vf4 = _mm_set1_ps(f4), vf5 = _mm_set1_ps(f5);
+    const __m128 vf6 = _mm_set1_ps(f6), vf7 = _mm_set1_ps(f7), vf8 = _mm_set1_ps(f8);
+    for (; i + 4 <= count; i += 4) {
+        __m128 vx1 = _mm_loadu_ps(x1+i), vy1 = _mm_loadu_ps(y1+i);
+        __m128 vx2 = _mm_loadu_ps(x2+i), vy2 = _mm_loadu_ps(y2+i);
+        __m128 a = _mm_add_ps(_mm_add_ps(_mm_mul_ps(vf0, vx1), _mm_mul_ps(vf3, vy1)), vf6);
+        __m128 b = _mm_add_ps(_mm_add_ps(_mm_mul_ps(vf1, vx1), _mm_mul_ps(vf4, vy1)), vf7);
+        __m128 c = _mm_add_ps(_mm_add_ps(_mm_mul_ps(vf2, vx1), _mm_mul_ps(vf5, vy1)), vf8);
+        __m128 d = _mm_add_ps(_mm_add_ps(_mm_mul_ps(vf0, vx2), _mm_mul_ps(vf1, vy2)), vf2);
+        __m128 e = _mm_add_ps(_mm_add_ps(_mm_mul_ps(vf3, vx2), _mm_mul_ps(vf4, vy2)), vf5);
+        __m128 r = _mm_add_ps(_mm_add_ps(_mm_mul_ps(vx2, a), _mm_mul_ps(vy2, b)), c);
+        __m128 den = _mm_add_ps(_mm_add_ps(_mm_mul_ps(a, a), _mm_mul_ps(b, b)),
+                                 _mm_add_ps(_mm_mul_ps(d, d), _mm_mul_ps(e, e)));
+        _mm_storeu_ps(dist+i, _mm_div_ps(_mm_mul_ps(r, r), den));
+    }
+#endif
+    (void)data;
+    for (; i < count; i++) {
+        real32_T a = f0*x1[i] + f3*y1[i] + f6;
+        real32_T b = f1*x1[i] + f4*y1[i] + f7;
+        real32_T c = f2*x1[i] + f5*y1[i] + f8;
+        real32_T d = f0*x2[i] + f1*y2[i] + f2;
+        real32_T e = f3*x2[i] + f4*y2[i] + f5;
+        real32_T r = x2[i]*a + y2[i]*b + c;
+        dist[i] = r*r/((a*a + b*b) + (d*d + e*e));
+    }
+}
+
+static boolean_T MSACIsValid(void *data, const real32_T *F)
+{
+    int_T k;
+    (void)data;
+    for (k = 0; k < 9; k++) {
+        if (!svd_IsFinite32(F[k])) return 0;
+    }
+    return 1;
+}
+
+/* least squares 8 point fit of the numSel correspondences sel, with
+ * MWVIP_SVD_Jacobi_R */
+static boolean_T MSACFit(void *data, const real32_T *pts1, const real32_T *pts2,
+                         int_T numPts, const int_T *sel, int_T numSel,
+                         real32_T *F)
+{
+    const int_T n = MAX(numSel, 9);
+    real32_T t1[3], t2[3], s[9], v[81], Fn[9];
+    real32_T *A;
+    boolean_T isOk;
+    int_T k, c;
+    (void)data;
+
+    if (numSel < NSAMPLE) return 0;
+    A = (real32_T *)calloc((size_t)n*9, sizeof(real32_T));
+    if (A == NULL) return 0;
+    MWVIP_RANSAC_NormalizeSample_R(pts1, numPts, sel, numSel, t1);
+    MWVIP_RANSAC_NormalizeSample_R(pts2, numPts, sel, numSel, t2);
+    for (k = 0; k < numSel; k++) EIGHT_POINT_ROW(A, n, k, sel[k]);
+    isOk = (boolean_T)(MWVIP_SVD_Jacobi_R(A, n, 9, s, v, 1) == 0);
+    free(A);
+    if (!isOk) return 0;
+    for (c = 0; c < 3; c++) {
+        for (k = 0; k < 3; k++) Fn[3*c+k] = v[72 + 3*k+c];
+    }
+    /* Fn is overwritten with U */
+    isOk = (boolean_T)(MWVIP_SVD_Jacobi_R(Fn, 3, 3, s, v, 1) == 0);
+    if (isOk) ToPixels(Fn, s, v, t1, t2, F);
+    return isOk;
+}
+
+LIBMWVISIONRT_API void MWVIP_MSAC_FundamentalSolver_R(MWVIP_MSAC_Solver_R *solver)
+{
+    solver->sampleSize = NSAMPLE;
+    solver->modelSize  = 9;
+    solver->maxModels  = 1;
+    solver->solve      = MSACSolve;
+    solver->distances  = MSACDistances;
+    solver->isValid    = MSACIsValid;
+    solver->fit        = MSACFit;
+    solver->data       = NULL;
+}
+
+/* [EOF] ransac_fundamental_r_rt.c */
@@ -0,0 +1,311 @@
+/*
+ *  RANSAC_HOMOGRAPHY_D_RT RANSAC estimation of a homography from single
+ *  precision point correspondences, and the homography solver of
+ *  MWVIP_MSAC_R.
+ *
+ *  Copyright 2016 The MathWorks, Inc.
+ */
+
+#include "ransac_sample_rt.h"
+#include <stdlib.h>
+
+#define L        MWVIP_SVD_BATCH_LANES
+#define NSAMPLE  4
+
+/* c = a*b, 3x3 column major */
+static void Mul3(const real32_T *a, const real32_T *b, real32_T *c)
+{
+    int_T r, k;
+    for (k = 0; k < 3; k++) {
+        for (r = 0; r < 3; r++) {
+            c[3*k+r] = a[r]*b[3*k] + a[3+r]*b[3*k+1] + a[6+r]*b[3*k+2];
+        }
+    }
+}
+
+/* brings the null vector h of a normalized DLT matrix, the rows of the
+ * normalized homography, back to pixel coordinates */
+static void ToPixels(const real32_T *h, const real32_T *t1, const real32_T *t2,
+                     real32_T *H)
+{
+    real32_T T1[9], T2inv[9];
+    real32_T Hn[9], tmp[9];
+    int_T k, c;
+    T1[0] = t1[0];         T1[1] = 0.0F;          T1[2] = 0.0F;
+    T1[3] = 0.0F;          T1[4] = t1[0];         T1[5] = 0.0F;
+    T1[6] = -t1[0]*t1[1];  T1[7] = -t1[0]*t1[2];  T1[8] = 1.0F;
+    T2inv[0] = 1.0F/t2[0];  T2inv[1] = 0.0F;        T2inv[2] = 0.0F;
+    T2inv[3] = 0.0F;        T2inv[4] = 1.0F/t2[0];  T2inv[5] = 0.0F;
+    T2inv[6] = t2[1];       T2inv[7] = t2[2];       T2inv[8] = 1.0F;
+    for (c = 0; c < 3; c++) {
+        for (k = 0; k < 3; k++) Hn[3*c+k] = h[3*k+c];
+    }
+    Mul3(T2inv, Hn, tmp);
+    Mul3(tmp, T1, H);
+    if (fabsf(H[8]) > EPS_real32_T) {
+        real32_T scale = 1.0F/H[8];
+        for (k = 0; k < 9; k++) H[k] *= scale;
+    }
+}
+
+/* rows 2k and 2k+1 of the DLT matrix A with n rows, column major, of the
+ * normalized correspondence i */
+#define DLT_ROWS(A, n, k, i) \
+    { \
+        real32_T x1 = t1[0]*(pts1[i]        - t1[1]); \
+        real32_T y1 = t1[0]*(pts1[numPts+(i)] - t1[2]); \
+        real32_T x2 = t2[0]*(pts2[i]        - t2[1]); \
+        real32_T y2 = t2[0]*(pts2[numPts+(i)] - t2[2]); \
+        real32_T *ra = &(A)[2*(k)], *rb = &(A)[2*(k)+1]; \
+        ra[0]     = -x1;    ra[(n)]   = -y1;    ra[2*(n)] = -1.0F; \
+        ra[6*(n)] = x2*x1;  ra[7*(n)] = x2*y1;  ra[8*(n)] = x2; \
+        rb[3*(n)] = -x1;    rb[4*(n)] = -y1;    rb[5*(n)] = -1.0F; \
+        rb[6*(n)] = y2*x1;  rb[7*(n)] = y2*y1;  rb[8*(n)] = y2; \
+    }
+
+/*
+ * Solves the nh <= L samples of NSAMPLE correspondences in idx into
+ * models, 9 elements each: the DLT matrices of the normalized samples are
+ * decomposed together and the null vectors are brought back to pixel
+ * coordinates. Sample b is normalized with t1 + b*tStride and
+ * t2 + b*tStride.
+ */
+static void SolveChunk(const real32_T *pts1, const real32_T *pts2, int_T numPts,
+                       const int_T *idx, int_T nh, const real32_T *ts1,
+                       const real32_T *ts2, int_T tStride, real32_T *models)
+{
+    real32_T A[L*81], s[L*9], u[L*81], v[L*81], work[L*(81+81+9)];
+    int_T b, k;
+
+    for (k = 0; k < L*81; k++) A[k] = 0.0F;
+    for (b = 0; b < nh; b++) {
+        const real32_T *t1 = ts1 + b*tStride, *t2 = ts2 + b*tStride;
+        /* the last row of the 9x9 matrix stays zero */
+        for (k = 0; k < NSAMPLE; k++) DLT_ROWS(&A[b*81], 9, k, idx[NSAMPLE*b+k]);
+    }
+    MWVIP_SVD_JacobiBatch_R(A, 9, 9, nh, s, u, v, 1, work);
+
+    for (b = 0; b < nh; b++) {
+        /* right singular vector of the smallest singular value */
+        ToPixels(&v[b*81 + 72], ts1 + b*tStride, ts2 + b*tStride, &models[9*b]);
+    }
+}
+
+/* transfer distance to p2 of H*p1, squared; NaN for w == 0. The model is
+ * held in scalars so that the loops over the points vectorize. */
+#define LOAD_MODEL(H) \
+    const real32_T h0 = (H)[0], h1 = (H)[1], h2 = (H)[2], \
+                 h3 = (H)[3], h4 = (H)[4], h5 = (H)[5], \
+                 h6 = (H)[6], h7 = (H)[7], h8 = (H)[8]
+#define TRANSFER_DIST2(x1, y1, x2, y2) \
+    (((h0*(x1) + h3*(y1) + h6)/(h2*(x1) + h5*(y1) + h8) - (x2)) * \
+     ((h0*(x1) + h3*(y1) + h6)/(h2*(x1) + h5*(y1) + h8) - (x2)) + \
+     ((h1*(x1) + h4*(y1) + h7)/(h2*(x1) + h5*(y1) + h8) - (y2)) * \
+     ((h1*(x1) + h4*(y1) + h7)/(h2*(x1) + h5*(y1) + h8) - (y2)))
+
+/* number of correspondences within thr2 (squared), 4 at a time with SSE2 */
+static int_T ScoreModel(const real32_T *H, const real32_T *pts1, const real32_T *pts2,
+                        int_T numPts, real32_T thr2)
+{
+    LOAD_MODEL(H);
+    const real32_T *x1 = pts1, *y1 = pts1 + numPts;
+    const real32_T *x2 = pts2, *y2 = pts2 + numPts;
+    int_T i = 0, count = 0;
+#if defined(MWVIP_RANSAC_SSE2)
+    const __m128 vh0 = _mm_set1_ps(h0), vh1 = _mm_set1_ps(h1), vh2 = _mm_set1_ps(h2);
+    const __m128 vh3 = _mm_set1_ps(h3), vh4 = _mm_set1_ps(h4), vh5 = _mm_set1_ps(h5);
+    const __m128 vh6 = _mm_set1_ps(h6), vh7 = _mm_set1_ps(h7), vh8 = _mm_set1_ps(h8);
+    const __m128 vthr = _mm_set1_ps(thr2);
+    __m128i vcount = _mm_setzero_si128();
+    int_T lanes[4];
+    for (; i + 4 <= numPts; i += 4) {
+        __m128 vx1 = _mm_loadu_ps(x1+i), vy1 = _mm_loadu_ps(y1+i);
+        __m128 w  = _mm_add_ps(_mm_add_ps(_mm_mul_ps(vh2, vx1), _mm_mul_ps(vh5, vy1)), vh8);
+        __m128 dx = _mm_sub_ps(_mm_div_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(vh0, vx1),
+                         _mm_mul_ps(vh3, vy1)), vh6), w), _mm_loadu_ps(x2+i));
+        __m128 dy = _mm_sub_ps(_mm_div_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(vh1, vx1),
+                         _mm_mul_ps(vh4, vy1)), vh7), w), _mm_loadu_ps(y2+i));
+        __m128 isIn = _mm_cmple_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)), vthr);
+        vcount = _mm_add_epi32(vcount, _mm_srli_epi32(_mm_castps_si128(isIn), 31));
+    }
+    _mm_storeu_si128((__m128i *)lanes, vcount);
+    count = lanes[0] + lanes[1] + lanes[2] + lanes[3];
+#endif
+    for (; i < numPts; i++) {
+        count += (TRANSFER_DIST2(x1[i], y1[i], x2[i], y2[i]) <= thr2);
+    }
+    return count;
+}
+
+static int_T FlagInliers(const real32_T *H, const real32_T *pts1, const real32_T *pts2,
+                         int_T numPts, real32_T thr2, boolean_T *inliers)
+{
+    LOAD_MODEL(H);
+    const real32_T *x1 = pts1, *y1 = pts1 + numPts;
+    const real32_T *x2 = pts2, *y2 = pts2 + numPts;
+    int_T i, count = 0;
+    for (i = 0; i < numPts; i++) {
+        inliers[i] = (boolean_T)(TRANSFER_DIST2(x1[i], y1[i], x2[i], y2[i]) <= thr2);
+        count += inliers[i];
+    }
+    return count;
+}
+
+LIBMWVISIONRT_API int_T MWVIP_RANSAC_Homography_R(const real32_T *pts1,
+                                                  const real32_T *pts2,
+                                                  int_T         numPts,
+                                                  int_T         numHyp,
+                                                  uint32_T      seed,
+                                                  real32_T        threshold,
+                                                  real32_T       *model,
+                                                  boolean_T    *inliers)
+{
+    const real32_T thr2 = threshold*threshold;
+    const int_T numChunks = (numHyp + L - 1)/L;
+    real32_T t1[3], t2[3];
+    int_T bestCount = -1, bestHyp = numHyp;
+    int_T chunk, k;
+
+    if (numPts < NSAMPLE || numHyp < 1) {
+        for (k = 0; k < numPts; k++) inliers[k] = 0;
+        return 0;
+    }
+    MWVIP_RANSAC_Normalize_R(pts1, numPts, t1);
+    MWVIP_RANSAC_Normalize_R(pts2, numPts, t2);
+
+#if defined(MWVIP_RANSAC_PARALLEL)
+    #pragma omp parallel for schedule(dynamic) \
+        if ((real32_T)numHyp*numPts >= MWVIP_RANSAC_MIN_PARALLEL)
+#endif
+    for (chunk = 0; chunk < numChunks; chunk++) {
+        real32_T models[9*L];
+        int_T h0 = chunk*L;
+        int_T nh = MIN(L, numHyp - h0);
+        int_T idx[NSAMPLE*L];
+        int_T b;
+        for (b = 0; b < nh; b++) {
+            MWVIP_RANSAC_DrawSample(seed, h0+b, numPts, NSAMPLE, &idx[NSAMPLE*b]);
+        }
+        SolveChunk(pts1, pts2, numPts, idx, nh, t1, t2, 0, models);
+        for (b = 0; b < nh; b++) {
+            int_T count = ScoreModel(&models[9*b], pts1, pts2, numPts, thr2);
+#if defined(MWVIP_RANSAC_PARALLEL)
+            #pragma omp critical (MWVIP_RANSAC_Homography_R)
+#endif
+            {
+                if (count > bestCount || (count == bestCount && h0+b < bestHyp)) {
+                    int_T m;
+                    bestCount = count;
+                    bestHyp   = h0+b;
+                    for (m = 0; m < 9; m++) model[m] = models[9*b+m];
+                }
+            }
+        }
+    }
+
+    return FlagInliers(model, pts1, pts2, numPts, thr2, inliers);
+}
+
+/*
+ * Homography solver of MWVIP_MSAC_R: the model is H as above, the
+ * distance is the transfer distance in pixels, and each sample is
+ * normalized on its own.
+ */
+static void MSACSolve(void *data, const real32_T *pts1, const real32_T *pts2,
+                      int_T numPts, const int_T *samples, int_T numSamples,
+                      real32_T *models, int_T *numModels)
+{
+    int_T b0, b;
+    (void)data;
+    for (b0 = 0; b0 < numSamples; b0 += L) {
+        const int_T nh = MIN(L, numSamples - b0);
+        real32_T t1[3*L], t2[3*L];
+        for (b = 0; b < nh; b++) {
+            const int_T *idx = &samples[NSAMPLE*(b0+b)];
+            MWVIP_RANSAC_NormalizeSample_R(pts1, numPts, idx, NSAMPLE, &t1[3*b]);
+            MWVIP_RANSAC_NormalizeSample_R(pts2, numPts, idx, NSAMPLE, &t2[3*b]);
+            numModels[b0+b] = 1;
+        }
+        SolveChunk(pts1, pts2, numPts, &samples[NSAMPLE*b0], nh, t1, t2, 3,
+                   &models[9*b0]);
+    }
+}
+
+/* transfer distances of correspondences first..first+count-1, 2 at a
+ * time with SSE2 */
+static void MSACDistances(void *data, const real32_T *H, const real32_T *pts1,
+                          const real32_T *pts2, int_T numPts, int_T first,
+                          int_T count, real32_T *dist)
+{
+    LOAD_MODEL(H);
+    const real32_T *x1 = pts1 + first, *y1 = pts1 + numPts + first;
+    const real32_T *x2 = pts2 + first, *y2 = pts2 + numPts + first;
+    int_T i = 0;
+#if defined(MWVIP_RANSAC_SSE2)
+    const __m128 vh0 = _mm_set1_ps(h0), vh1 = _mm_set1_ps(h1), vh2 = _mm_set1_ps(h2);
+    const __m128 vh3 = _mm_set1_ps(h3), vh4 = _mm_set1_ps(h4), vh5 = _mm_set1_ps(h5);
+    const __m128 vh6 = _mm_set1_ps(h6), vh7 = _mm_set1_ps(h7), vh8 = _mm_set1_ps(h8);
+    for (; i + 4 <= count; i += 4) {
+        __m128 vx1 = _mm_loadu_ps(x1+i), vy1 = _mm_loadu_ps(y1+i);
+        __m128 w  = _mm_add_ps(_mm_add_ps(_mm_mul_ps(vh2, vx1), _mm_mul_ps(vh5, vy1)), vh8);
+        __m128 dx = _mm_sub_ps(_mm_div_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(vh0, vx1),
+                         _mm_mul_ps(vh3, vy1)), vh6), w), _mm_loadu_ps(x2+i));
+        __m128 dy = _mm_sub_ps(_mm_div_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(vh1, vx1),
+                         _mm_mul_ps(vh4, vy1)), vh7), w), _mm_loadu_ps(y2+i));
+        _mm_storeu_ps(dist+i, _mm_sqrt_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy))));
+    }
+#endif
+    (void)data;
+    for (; i < count; i++) {
+        dist[i] = sqrtf(TRANSFER_DIST2(x1[i], y1[i], x2[i], y2[i]));
+    }
+}
+
+static boolean_T MSACIsValid(void *data, const real32_T *H)
+{
+    int_T k;
+    (void)data;
+    for (k = 0; k < 9; k++) {
+        if (!svd_IsFinite32(H[k])) return 0;
+    }
+    return 1;
+}
+
+/* least squares DLT of the numSel correspondences sel, with
+ * MWVIP_SVD_Jacobi_R */
+static boolean_T MSACFit(void *data, const real32_T *pts1, const real32_T *pts2,
+                         int_T numPts, const int_T *sel, int_T numSel,
+                         real32_T *H)
+{
+    const int_T n = MAX(2*numSel, 9);
+    real32_T t1[3], t2[3], s[9], v[81];
+    real32_T *A;
+    boolean_T isOk;
+    int_T k;
+    (void)data;
+
+    if (numSel < NSAMPLE) return 0;
+    A = (real32_T *)calloc((size_t)n*9, sizeof(real32_T));
+    if (A == NULL) return 0;
+    MWVIP_RANSAC_NormalizeSample_R(pts1, numPts, sel, numSel, t1);
+    MWVIP_RANSAC_NormalizeSample_R(pts2, numPts, sel, numSel, t2);
+    for (k = 0; k < numSel; k++) DLT_ROWS(A, n, k, sel[k]);
+    isOk = (boolean_T)(MWVIP_SVD_Jacobi_R(A, n, 9, s, v, 1) == 0);
+    if (isOk) ToPixels(&v[72], t1, t2, H);
+    free(A);
+    return isOk;
+}
+
+LIBMWVISIONRT_API void MWVIP_MSAC_HomographySolver_R(MWVIP_MSAC_Solver_R *solver)
+{
+    solver->sampleSize = NSAMPLE;
+    solver->modelSize  = 9;
+    solver->maxModels  = 1;
+    solver->solve      = MSACSolve;
+    solver->distances  = MSACDistances;
+    solver->isValid    = MSACIsValid;
+    solver->fit        = MSACFit;
+    solver->data       = NULL;
+}
+
+/* [EOF] ransac_homography_r_rt.c */
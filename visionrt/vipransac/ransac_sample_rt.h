@@ -0,0 +1,161 @@
+/*
+ *  RANSAC_SAMPLE_RT Minimal sample drawing and point normalization shared
+ *  by the MWVIP_RANSAC_<Model>_<DataType> and MWVIP_MSAC_<DataType>
+ *  functions.
+ *
+ *  Copyright 2016 The MathWorks, Inc.
+ */
+
+#ifndef ransac_sample_rt_h
+#define ransac_sample_rt_h
+
+#include "vipransac_rt.h"
+#include "vipsvd_rt.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define MWVIP_RANSAC_SSE2 1
+#endif
+
+/* largest minimal sample, the 8 correspondences of a fundamental matrix */
+#define MWVIP_RANSAC_MAX_SAMPLE 8
+
+/* xorshift32 step; the state is never zero */
+MWVIP_INLINE uint32_T MWVIP_RANSAC_Random(uint32_T *state)
+{
+    uint32_T x = *state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    *state = x;
+    return x;
+}
+
+/* draws the sampleSize distinct correspondences of hypothesis hyp */
+MWVIP_INLINE void MWVIP_RANSAC_DrawSample(uint32_T seed, int_T hyp,
+                                          int_T numPts, int_T sampleSize,
+                                          int_T *idx)
+{
+    uint32_T state = (seed ^ ((uint32_T)hyp * 0x9E3779B9U)) | 1U;
+    int_T k, j;
+    /* decorrelate neighboring hypotheses */
+    MWVIP_RANSAC_Random(&state);
+    MWVIP_RANSAC_Random(&state);
+    for (k = 0; k < sampleSize; k++) {
+        boolean_T isNew;
+        do {
+            idx[k] = (int_T)(MWVIP_RANSAC_Random(&state) % (uint32_T)numPts);
+            isNew = 1;
+            for (j = 0; j < k; j++) {
+                if (idx[j] == idx[k]) isNew = 0;
+            }
+        } while (!isNew);
+    }
+}
+
+/* PROSAC sample of hypothesis hyp: correspondence n-1 and sampleSize-1
+ * others among the first n-1, or a uniform sample once n reaches numPts */
+MWVIP_INLINE void MWVIP_RANSAC_DrawProsacSample(uint32_T seed, int_T hyp,
+                                                int_T n, int_T numPts,
+                                                int_T sampleSize, int_T *idx)
+{
+    if (n < numPts) {
+        idx[0] = n-1;
+        MWVIP_RANSAC_DrawSample(seed, hyp, n-1, sampleSize-1, idx+1);
+    } else {
+        MWVIP_RANSAC_DrawSample(seed, hyp, numPts, sampleSize, idx);
+    }
+}
+
+/* isotropic normalization of Hartley: the points are moved to their
+ * centroid (t[1], t[2]) and scaled by t[0] to a mean distance of sqrt(2) */
+MWVIP_INLINE void MWVIP_RANSAC_Normalize_D(const real_T *pts, int_T numPts,
+                                           real_T *t)
+{
+    real_T cx = 0.0, cy = 0.0, d = 0.0;
+    int_T i;
+    for (i = 0; i < numPts; i++) {
+        cx += pts[i];
+        cy += pts[numPts + i];
+    }
+    cx /= numPts;
+    cy /= numPts;
+    for (i = 0; i < numPts; i++) {
+        real_T dx = pts[i] - cx, dy = pts[numPts + i] - cy;
+        d += sqrt(dx*dx + dy*dy);
+    }
+    d /= numPts;
+    t[0] = (d > 0.0) ? 1.4142135623730951 / d : 1.0;
+    t[1] = cx;
+    t[2] = cy;
+}
+
+MWVIP_INLINE void MWVIP_RANSAC_Normalize_R(const real32_T *pts, int_T numPts,
+                                           real32_T *t)
+{
+    real32_T cx = 0.0F, cy = 0.0F, d = 0.0F;
+    int_T i;
+    for (i = 0; i < numPts; i++) {
+        cx += pts[i];
+        cy += pts[numPts + i];
+    }
+    cx /= numPts;
+    cy /= numPts;
+    for (i = 0; i < numPts; i++) {
+        real32_T dx = pts[i] - cx, dy = pts[numPts + i] - cy;
+        d += sqrtf(dx*dx + dy*dy);
+    }
+    d /= numPts;
+    t[0] = (d > 0.0F) ? 1.41421356F / d : 1.0F;
+    t[1] = cx;
+    t[2] = cy;
+}
+
+/* same, over the n correspondences idx of a sample */
+MWVIP_INLINE void MWVIP_RANSAC_NormalizeSample_D(const real_T *pts, int_T numPts,
+                                                 const int_T *idx, int_T n,
+                                                 real_T *t)
+{
+    real_T cx = 0.0, cy = 0.0, d = 0.0;
+    int_T i;
+    for (i = 0; i < n; i++) {
+        cx += pts[idx[i]];
+        cy += pts[numPts + idx[i]];
+    }
+    cx /= n;
+    cy /= n;
+    for (i = 0; i < n; i++) {
+        real_T dx = pts[idx[i]] - cx, dy = pts[numPts + idx[i]] - cy;
+        d += sqrt(dx*dx + dy*dy);
+    }
+    d /= n;
+    t[0] = (d > 0.0) ? 1.4142135623730951 / d : 1.0;
+    t[1] = cx;
+    t[2] = cy;
+}
+
+MWVIP_INLINE void MWVIP_RANSAC_NormalizeSample_R(const real32_T *pts, int_T numPts,
+                                                 const int_T *idx, int_T n,
+                                                 real32_T *t)
+{
+    real32_T cx = 0.0F, cy = 0.0F, d = 0.0F;
+    int_T i;
+    for (i = 0; i < n; i++) {
+        cx += pts[idx[i]];
+        cy += pts[numPts + idx[i]];
+    }
+    cx /= n;
+    cy /= n;
+    for (i = 0; i < n; i++) {
+        real32_T dx = pts[idx[i]] - cx, dy = pts[numPts + idx[i]] - cy;
+        d += sqrtf(dx*dx + dy*dy);
+    }
+    d /= n;
+    t[0] = (d > 0.0F) ? 1.41421356F / d : 1.0F;
+    t[1] = cx;
+    t[2] = cy;
+}
+
+#endif /* ransac_sample_rt_h */
+
+/* [EOF] ransac_sample_rt.h */
@@ -0,0 +1,106 @@
+/*
+ *  RESIZE_R_RT runtime function for VIPBLKS Resize and Pyramid blocks
+ *
+ *  Resamples a single precision image with the weights of two tap tables.
+ *  The row pass accumulates the ring columns of the taps into the output
+ *  column one tap at a time, a loop the compiler vectorizes.
+ *
+ *  Copyright 2016 The MathWorks, Inc.
+ */
+#include "resize_rt.h"
+
+/* one input column resampled along the rows */
+static void ResampleColumn(const real32_T *src, const MWVIP_RESIZE_TABLE *rowTable,
+                           real32_T *dst)
+{
+    const int32_T numTaps = rowTable->numTaps;
+    const int32_T *index = rowTable->index;
+    const real32_T *weight = rowTable->weight;
+    int32_T k, t;
+
+    for (k = 0; k < rowTable->outSize; k++) {
+        real32_T acc = 0.0F;
+        for (t = 0; t < numTaps; t++) {
+            acc += weight[t]*src[index[t]];
+        }
+        dst[k] = acc;
+        index += numTaps;
+        weight += numTaps;
+    }
+}
+
+/* one output column from the ring columns of its taps */
+static void CombineColumns(const real32_T *const *col, const real32_T *weight,
+                           int32_T numTaps, real32_T *dst, int32_T rows)
+{
+    int32_T i, t;
+    for (i = 0; i < rows; i++) {
+        dst[i] = weight[0]*col[0][i];
+    }
+    for (t = 1; t < numTaps; t++) {
+        const real32_T *src = col[t];
+        const real32_T w = weight[t];
+        for (i = 0; i < rows; i++) {
+            dst[i] += w*src[i];
+        }
+    }
+}
+
+boolean_T MWVIP_Resize_R(const real32_T *in, real32_T *out,
+                         const MWVIP_RESIZE_TABLE *rowTable,
+                         const MWVIP_RESIZE_TABLE *colTable)
+{
+    const int32_T inRows  = rowTable->inSize;
+    const int32_T outRows = rowTable->outSize;
+    const int32_T outCols = colTable->outSize;
+    const int32_T numTaps = colTable->numTaps;
+    const int32_T numStrips = (outCols + MWVIP_RESIZE_STRIP_COLS - 1)/MWVIP_RESIZE_STRIP_COLS;
+    boolean_T ok = 1;
+
+#if defined(MWVIP_RESIZE_PARALLEL)
+    #pragma omp parallel if (outRows*outCols >= MWVIP_RESIZE_MIN_PARALLEL) reduction(&&:ok)
+#endif
+    {
+        real32_T *ring = (real32_T *)malloc((size_t)numTaps*outRows*sizeof(real32_T));
+        int32_T *tag = (int32_T *)malloc((size_t)numTaps*sizeof(int32_T));
+        const real32_T **col = (const real32_T **)malloc((size_t)numTaps*sizeof(real32_T *));
+        int32_T s, t;
+        if (ring == NULL || tag == NULL || col == NULL) {
+            ok = 0;
+        } else {
+            for (t = 0; t < numTaps; t++) tag[t] = -1;
+        }
+        /* contiguous strips per thread, so that the ring carries the
+         * columns shared by neighboring strips */
+#if defined(MWVIP_RESIZE_PARALLEL)
+        #pragma omp for schedule(static)
+#endif
+        for (s = 0; s < numStrips; s++) {
+            const int32_T c0 = s*MWVIP_RESIZE_STRIP_COLS;
+            const int32_T c1 = (c0 + MWVIP_RESIZE_STRIP_COLS < outCols) ?
+                               c0 + MWVIP_RESIZE_STRIP_COLS : outCols;
+            int32_T k;
+            if (ring == NULL || tag == NULL || col == NULL) continue;
+            for (k = c0; k < c1; k++) {
+                const int32_T *index = &colTable->index[k*numTaps];
+                for (t = 0; t < numTaps; t++) {
+                    boolean_T fill;
+                    const int32_T slot = MWVIP_Resize_Slot(index[t], numTaps, tag, &fill);
+                    real32_T *dst = &ring[(size_t)slot*outRows];
+                    if (fill) {
+                        ResampleColumn(&in[(size_t)index[t]*inRows], rowTable, dst);
+                    }
+                    col[t] = dst;
+                }
+                CombineColumns(col, &colTable->weight[k*numTaps], numTaps,
+                               &out[(size_t)k*outRows], outRows);
+            }
+        }
+        free(ring);
+        free(tag);
+        free((void *)col);
+    }
+    return ok;
+}
+
+/* [EOF] resize_r_rt.c */
@@ -0,0 +1,55 @@
+/*
+ *  RESIZE_RT ring buffer and SIMD helpers of the polyphase resampling
+ *  kernels.
+ *
+ *  The ring of a thread holds numTaps resampled input columns of the
+ *  column tap table; input column c lives in slot c % numTaps. The taps of
+ *  an output are numTaps consecutive input columns, or a subset of the
+ *  first or the last numTaps once mirrored, so they never share a slot.
+ *
+ *  Copyright 2016 The MathWorks, Inc.
+ */
+
+#ifndef resize_rt_h
+#define resize_rt_h
+
+#include <stdlib.h>
+#include "vipresize_rt.h"
+
+#if defined(__ARM_NEON__) || defined(__ARM_NEON)
+#include <arm_neon.h>
+#define MWVIP_RESIZE_NEON 1
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define MWVIP_RESIZE_SSE2 1
+#endif
+
+/* fractional bits of the uint8 intermediate, Q14 weights times Q0 pixels
+ * shifted down to Q6 */
+#define MWVIP_RESIZE_MID_BITS 6
+#define MWVIP_RESIZE_MID_SHIFT (14 - MWVIP_RESIZE_MID_BITS)
+#define MWVIP_RESIZE_OUT_SHIFT (14 + MWVIP_RESIZE_MID_BITS)
+
+/* index k mirrored as imresize pads symmetrically: -1 is 0, n is n-1 */
+MWVIP_INLINE int32_T MWVIP_Resize_Mirror(int32_T k, int32_T n)
+{
+    const int32_T period = 2*n;
+    k %= period;
+    if (k < 0) k += period;
+    return (k < n) ? k : period - 1 - k;
+}
+
+/* slot of input column c in the ring, filled by the includer's column
+ * pass when it does not hold c yet */
+MWVIP_INLINE int32_T MWVIP_Resize_Slot(int32_T c, int32_T numTaps,
+                                       int32_T *tag, boolean_T *fill)
+{
+    const int32_T slot = c % numTaps;
+    *fill = (boolean_T)(tag[slot] != c);
+    tag[slot] = c;
+    return slot;
+}
+
+#endif /* resize_rt_h */
+
+/* [EOF] resize_rt.h */
@@ -0,0 +1,142 @@
+/*
+ *  RESIZE_U8_RT runtime function for VIPBLKS Resize and Pyramid blocks
+ *
+ *  Resamples a uint8 image with the Q14 weights of two tap tables. The
+ *  column pass keeps 6 fractional bits in 16 bit lanes, which hold the
+ *  overshoot of the cubic kernel; the row pass combines the ring columns
+ *  two taps at a time with a multiply-add of 16 bit pairs into 32 bit sums.
+ *
+ *  Copyright 2016 The MathWorks, Inc.
+ */
+#include "resize_rt.h"
+
+static uint8_T SatU8(int32_T x)
+{
+    return (uint8_T)(x < 0 ? 0 : (x > 255 ? 255 : x));
+}
+
+/* one input column resampled along the rows into Q6 */
+static void ResampleColumn(const uint8_T *src, const MWVIP_RESIZE_TABLE *rowTable,
+                           int16_T *dst)
+{
+    const int32_T numTaps = rowTable->numTaps;
+    const int32_T *index = rowTable->index;
+    const int16_T *weight = rowTable->weightQ14;
+    int32_T k, t;
+
+    for (k = 0; k < rowTable->outSize; k++) {
+        int32_T acc = 1 << (MWVIP_RESIZE_MID_SHIFT - 1);
+        for (t = 0; t < numTaps; t++) {
+            acc += (int32_T)weight[t]*src[index[t]];
+        }
+        dst[k] = (int16_T)(acc >> MWVIP_RESIZE_MID_SHIFT);
+        index += numTaps;
+        weight += numTaps;
+    }
+}
+
+/* one output column from the ring columns of its taps */
+static void CombineColumns(const int16_T *const *col, const int16_T *weight,
+                           int32_T numTaps, uint8_T *dst, int32_T rows)
+{
+    const int32_T round = 1 << (MWVIP_RESIZE_OUT_SHIFT - 1);
+    int32_T i = 0, t;
+
+#if defined(MWVIP_RESIZE_SSE2)
+    for (; i + 8 <= rows; i += 8) {
+        __m128i lo = _mm_set1_epi32(round), hi = lo;
+        for (t = 0; t < numTaps; t += 2) {
+            const __m128i a = _mm_loadu_si128((const __m128i *)&col[t][i]);
+            const int32_T u = (t + 1 < numTaps) ? t + 1 : t;
+            const int16_T wb = (t + 1 < numTaps) ? weight[t+1] : 0;
+            const __m128i b = _mm_loadu_si128((const __m128i *)&col[u][i]);
+            const __m128i w = _mm_set1_epi32((int32_T)(((uint32_T)(uint16_T)wb << 16) |
+                                                       (uint16_T)weight[t]));
+            lo = _mm_add_epi32(lo, _mm_madd_epi16(_mm_unpacklo_epi16(a, b), w));
+            hi = _mm_add_epi32(hi, _mm_madd_epi16(_mm_unpackhi_epi16(a, b), w));
+        }
+        lo = _mm_srai_epi32(lo, MWVIP_RESIZE_OUT_SHIFT);
+        hi = _mm_srai_epi32(hi, MWVIP_RESIZE_OUT_SHIFT);
+        lo = _mm_packs_epi32(lo, hi);
+        _mm_storel_epi64((__m128i *)&dst[i], _mm_packus_epi16(lo, lo));
+    }
+#elif defined(MWVIP_RESIZE_NEON)
+    for (; i + 8 <= rows; i += 8) {
+        int32x4_t lo = vdupq_n_s32(0), hi = lo;
+        for (t = 0; t < numTaps; t++) {
+            const int16x8_t a = vld1q_s16(&col[t][i]);
+            lo = vmlal_n_s16(lo, vget_low_s16(a), weight[t]);
+            hi = vmlal_n_s16(hi, vget_high_s16(a), weight[t]);
+        }
+        vst1_u8(&dst[i], vqmovun_s16(vcombine_s16(
+            vqmovn_s32(vrshrq_n_s32(lo, MWVIP_RESIZE_OUT_SHIFT)),
+            vqmovn_s32(vrshrq_n_s32(hi, MWVIP_RESIZE_OUT_SHIFT)))));
+    }
+#endif
+    for (; i < rows; i++) {
+        int32_T acc = round;
+        for (t = 0; t < numTaps; t++) {
+            acc += (int32_T)weight[t]*col[t][i];
+        }
+        dst[i] = SatU8(acc >> MWVIP_RESIZE_OUT_SHIFT);
+    }
+}
+
+boolean_T MWVIP_Resize_U8(const uint8_T *in, uint8_T *out,
+                          const MWVIP_RESIZE_TABLE *rowTable,
+                          const MWVIP_RESIZE_TABLE *colTable)
+{
+    const int32_T inRows  = rowTable->inSize;
+    const int32_T outRows = rowTable->outSize;
+    const int32_T outCols = colTable->outSize;
+    const int32_T numTaps = colTable->numTaps;
+    const int32_T numStrips = (outCols + MWVIP_RESIZE_STRIP_COLS - 1)/MWVIP_RESIZE_STRIP_COLS;
+    boolean_T ok = 1;
+
+#if defined(MWVIP_RESIZE_PARALLEL)
+    #pragma omp parallel if (outRows*outCols >= MWVIP_RESIZE_MIN_PARALLEL) reduction(&&:ok)
+#endif
+    {
+        int16_T *ring = (int16_T *)malloc((size_t)numTaps*outRows*sizeof(int16_T));
+        int32_T *tag = (int32_T *)malloc((size_t)numTaps*sizeof(int32_T));
+        const int16_T **col = (const int16_T **)malloc((size_t)numTaps*sizeof(int16_T *));
+        int32_T s, t;
+        if (ring == NULL || tag == NULL || col == NULL) {
+            ok = 0;
+        } else {
+            for (t = 0; t < numTaps; t++) tag[t] = -1;
+        }
+        /* contiguous strips per thread, so that the ring carries the
+         * columns shared by neighboring strips */
+#if defined(MWVIP_RESIZE_PARALLEL)
+        #pragma omp for schedule(static)
+#endif
+        for (s = 0; s < numStrips; s++) {
+            const int32_T c0 = s*MWVIP_RESIZE_STRIP_COLS;
+            const int32_T c1 = (c0 + MWVIP_RESIZE_STRIP_COLS < outCols) ?
+                               c0 + MWVIP_RESIZE_STRIP_COLS : outCols;
+            int32_T k;
+            if (ring == NULL || tag == NULL || col == NULL) continue;
+            for (k = c0; k < c1; k++) {
+                const int32_T *index = &colTable->index[k*numTaps];
+                for (t = 0; t < numTaps; t++) {
+                    boolean_T fill;
+                    const int32_T slot = MWVIP_Resize_Slot(index[t], numTaps, tag, &fill);
+                    int16_T *dst = &ring[(size_t)slot*outRows];
+                    if (fill) {
+                        ResampleColumn(&in[(size_t)index[t]*inRows], rowTable, dst);
+                    }
+                    col[t] = dst;
+                }
+                CombineColumns(col, &colTable->weightQ14[k*numTaps], numTaps,
+                               &out[(size_t)k*outRows], outRows);
+            }
+        }
+        free(ring);
+        free(tag);
+        free((void *)col);
+    }
+    return ok;
+}
+
+/* [EOF] resize_u8_rt.c */
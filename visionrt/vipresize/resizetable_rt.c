@@ -0,0 +1,172 @@
+/*
+ *  RESIZETABLE_RT runtime function for VIPBLKS Resize and Pyramid blocks
+ *
+ *  Builds the tap tables of one dimension: the mirrored input indices and
+ *  the single precision and Q14 weights of every output pixel. The Q14
+ *  weights of an output are rounded to nearest and their rounding error is
+ *  given to the largest one, so that they sum to exactly one and a flat
+ *  image stays flat.
+ *
+ *  Copyright 2016 The MathWorks, Inc.
+ */
+#include <math.h>
+#include "resize_rt.h"
+
+static real_T KernelWidth(int_T kernel)
+{
+    return (kernel == MWVIP_RESIZE_NEAREST) ? 1.0 :
+           ((kernel == MWVIP_RESIZE_BILINEAR) ? 2.0 : 4.0);
+}
+
+/* the kernels of imresize: box, triangle and Keys cubic with a = -0.5 */
+static real_T Kernel(int_T kernel, real_T x)
+{
+    const real_T absx = fabs(x);
+    if (kernel == MWVIP_RESIZE_NEAREST) {
+        return (x >= -0.5 && x < 0.5) ? 1.0 : 0.0;
+    } else if (kernel == MWVIP_RESIZE_BILINEAR) {
+        return (absx <= 1.0) ? 1.0 - absx : 0.0;
+    } else if (absx <= 1.0) {
+        return (1.5*absx - 2.5)*absx*absx + 1.0;
+    } else if (absx <= 2.0) {
+        return ((-0.5*absx + 2.5)*absx - 4.0)*absx + 2.0;
+    }
+    return 0.0;
+}
+
+static real_T Scale(int32_T inSize, int32_T outSize, boolean_T antialias)
+{
+    const real_T scale = (real_T)outSize/(real_T)inSize;
+    return (antialias && scale < 1.0) ? scale : 1.0;
+}
+
+static int16_T RoundQ14(real_T w)
+{
+    return (int16_T)floor(w*MWVIP_RESIZE_Q14_ONE + 0.5);
+}
+
+/* Q14 weights of one output from its single precision weights */
+static void QuantizeOutput(const real32_T *weight, int16_T *weightQ14, int32_T numTaps)
+{
+    int32_T t, largest = 0, sum = 0;
+    for (t = 0; t < numTaps; t++) {
+        weightQ14[t] = RoundQ14(weight[t]);
+        sum += weightQ14[t];
+        if (weight[t] > weight[largest]) largest = t;
+    }
+    weightQ14[largest] = (int16_T)(weightQ14[largest] + MWVIP_RESIZE_Q14_ONE - sum);
+}
+
+static boolean_T TapUsed(const real32_T *weight, int32_T outSize, int32_T maxTaps, int32_T t)
+{
+    int32_T k;
+    for (k = 0; k < outSize; k++) {
+        if (weight[k*maxTaps + t] != 0.0F) return 1;
+    }
+    return 0;
+}
+
+int32_T MWVIP_Resize_MaxTaps(int32_T inSize, int32_T outSize,
+                             int_T kernel, boolean_T antialias)
+{
+    const real_T kernelScale = Scale(inSize, outSize, antialias);
+    return (int32_T)ceil(KernelWidth(kernel)/kernelScale) + 2;
+}
+
+int32_T MWVIP_Resize_BuildTable(int32_T inSize, int32_T outSize,
+                                int_T kernel, boolean_T antialias,
+                                MWVIP_RESIZE_TABLE *table)
+{
+    const real_T scale = (real_T)outSize/(real_T)inSize;
+    const real_T kernelScale = Scale(inSize, outSize, antialias);
+    const real_T width = KernelWidth(kernel)/kernelScale;
+    const int32_T maxTaps = MWVIP_Resize_MaxTaps(inSize, outSize, kernel, antialias);
+    int32_T k, t, first, last, numTaps;
+
+    for (k = 0; k < outSize; k++) {
+        const real_T u = (k + 0.5)/scale - 0.5;
+        const int32_T left = (int32_T)floor(u - width/2.0);
+        int32_T *index = &table->index[k*maxTaps];
+        real32_T *weight = &table->weight[k*maxTaps];
+        real_T sum = 0.0;
+
+        for (t = 0; t < maxTaps; t++) {
+            sum += kernelScale*Kernel(kernel, kernelScale*(u - (left + t)));
+        }
+        for (t = 0; t < maxTaps; t++) {
+            const real_T w = kernelScale*Kernel(kernel, kernelScale*(u - (left + t)));
+            index[t]  = MWVIP_Resize_Mirror(left + t, inSize);
+            weight[t] = (real32_T)(w/sum);
+        }
+    }
+
+    /* drop the leading and trailing taps that are zero for every output;
+     * the taps left stay consecutive, as the ring buffers need */
+    first = 0;
+    last = maxTaps - 1;
+    while (first < last && !TapUsed(table->weight, outSize, maxTaps, first)) first++;
+    while (last > first && !TapUsed(table->weight, outSize, maxTaps, last)) last--;
+    numTaps = last - first + 1;
+
+    for (k = 0; k < outSize; k++) {
+        for (t = 0; t < numTaps; t++) {
+            table->index[k*numTaps + t]  = table->index[k*maxTaps + first + t];
+            table->weight[k*numTaps + t] = table->weight[k*maxTaps + first + t];
+        }
+        if (table->weightQ14 != NULL) {
+            QuantizeOutput(&table->weight[k*numTaps], &table->weightQ14[k*numTaps], numTaps);
+        }
+    }
+
+    table->inSize  = inSize;
+    table->outSize = outSize;
+    table->numTaps = numTaps;
+    return numTaps;
+}
+
+int32_T MWVIP_Resize_PyramidTable(int32_T inSize, boolean_T expand,
+                                  real_T a, MWVIP_RESIZE_TABLE *table)
+{
+    const int32_T numTaps = expand ? 3 : 5;
+    const int32_T outSize = expand ? 2*inSize : (inSize + 1)/2;
+    real_T w[5];
+    int32_T k, t;
+
+    w[0] = w[4] = 0.25 - a/2.0;
+    w[1] = w[3] = 0.25;
+    w[2] = a;
+    for (k = 0; k < outSize; k++) {
+        int32_T *index = &table->index[k*numTaps];
+        real32_T *weight = &table->weight[k*numTaps];
+        if (!expand) {
+            for (t = 0; t < 5; t++) {
+                index[t]  = MWVIP_Resize_Mirror(2*k + t - 2, inSize);
+                weight[t] = (real32_T)w[t];
+            }
+        } else if ((k & 1) == 0) {
+            /* even outputs sit on input k/2: filter taps -2, 0, 2 */
+            for (t = 0; t < 3; t++) {
+                index[t]  = MWVIP_Resize_Mirror(k/2 + t - 1, inSize);
+                weight[t] = (real32_T)(2.0*w[2*t]);
+            }
+        } else {
+            /* odd outputs sit between inputs (k-1)/2 and (k+1)/2: taps -1, 1 */
+            index[0]  = MWVIP_Resize_Mirror(k/2, inSize);
+            index[1]  = MWVIP_Resize_Mirror(k/2 + 1, inSize);
+            index[2]  = index[0];
+            weight[0] = (real32_T)(2.0*w[1]);
+            weight[1] = (real32_T)(2.0*w[3]);
+            weight[2] = 0.0F;
+        }
+        if (table->weightQ14 != NULL) {
+            QuantizeOutput(weight, &table->weightQ14[k*numTaps], numTaps);
+        }
+    }
+
+    table->inSize  = inSize;
+    table->outSize = outSize;
+    table->numTaps = numTaps;
+    return numTaps;
+}
+
+/* [EOF] resizetable_rt.c */
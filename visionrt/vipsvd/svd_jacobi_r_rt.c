@@ -0,0 +1,162 @@
+/*
+ * SVD_JACOBI_D_RT - One-sided Jacobi singular value decomposition of a
+ * large single precision matrix
+ *
+ *  Copyright 2016 The MathWorks, Inc.
+ *
+ * Abstract:
+ *   The columns of x are rotated pairwise until they are orthogonal
+ *   (Hestenes). The singular values are then the column norms, U the
+ *   normalized columns and V the product of the rotations.
+ *
+ *   The pairs are visited in round-robin order: each of the p-1 rounds
+ *   (p rounds for odd p) pairs every column with another one, so the
+ *   rotations of a round touch disjoint columns and are applied in
+ *   parallel. Each rotation is a pass over two contiguous columns.
+ */
+
+#if (!defined(INTEGER_CODE) || !INTEGER_CODE)
+
+#include "vipsvd_rt.h"
+
+/*
+ * Rotate columns i and j of x (and of v), returns 1 when they were not
+ * yet orthogonal. nrm holds the squared column norms, updated with the
+ * rotation so that only the dot product of the pair is computed. Columns
+ * whose squared norm is below small are numerically zero and left alone.
+ */
+static int_T rotate_pair(real32_T *x, real32_T *v, real32_T *nrm, real32_T small,
+                         int_T n, int_T p, int_T i, int_T j, int_T wantv)
+{
+    real32_T *xi = x + i*n, *xj = x + j*n;
+    const real32_T tol = n * EPS_real32_T;
+    const real32_T alpha = nrm[i], beta = nrm[j];
+    real32_T gamma = 0.0F;
+    real32_T zeta, t, c, sn;
+    int_T k;
+
+    for (k=0; k<n; k++) {
+        gamma += xi[k] * xj[k];
+    }
+    if ((fabsf(gamma) <= tol * sqrtf(alpha) * sqrtf(beta)) || (MIN(alpha, beta) <= small)) {
+        return 0;
+    }
+    zeta = (beta - alpha) / (2.0F * gamma);
+    t    = 1.0F / (fabsf(zeta) + sqrtf(1.0F + zeta*zeta));
+    if (zeta < 0.0F) t = -t;
+    c  = 1.0F / sqrtf(1.0F + t*t);
+    sn = c * t;
+    nrm[i] = alpha - t * gamma;
+    nrm[j] = beta  + t * gamma;
+
+    for (k=0; k<n; k++) {
+        real32_T a = xi[k];
+        xi[k] = c * a - sn * xj[k];
+        xj[k] = sn * a + c * xj[k];
+    }
+    if (wantv) {
+        real32_T *vi = v + i*p, *vj = v + j*p;
+        for (k=0; k<p; k++) {
+            real32_T a = vi[k];
+            vi[k] = c * a - sn * vj[k];
+            vj[k] = sn * a + c * vj[k];
+        }
+    }
+    return 1;
+}
+
+/*
+ * Squared norms of the columns of x
+ */
+static void column_norms(const real32_T *x, int_T n, int_T p, real32_T *nrm)
+{
+    int_T j;
+#if defined(MWVIP_SVD_PARALLEL)
+    #pragma omp parallel for if (n*p >= MWVIP_SVD_MIN_PARALLEL)
+#endif
+    for (j=0; j<p; j++) {
+        real32_T sum = 0.0F;
+        int_T i;
+        for (i=0; i<n; i++) sum += x[j*n+i] * x[j*n+i];
+        nrm[j] = sum;
+    }
+}
+
+LIBMWVISIONRT_API int_T MWVIP_SVD_Jacobi_R(real32_T *x,
+                                        int_T n,
+                                        int_T p,
+                                        real32_T *s,
+                                        real32_T *v,
+                                        int_T wantv)
+{
+    /* round-robin over m players, m even; player p is a bye for odd p */
+    const int_T m = p + (p & 1);
+    int_T sweep, numRot = 1;
+    int_T i, j, k;
+
+    if (wantv) {
+        for (k=0; k<p*p; k++)  v[k] = 0.0F;
+        for (k=0; k<p; k++)    v[k*(p+1)] = 1.0F;
+    }
+
+    for (sweep=0; sweep<MWVIP_SVD_JACOBI_MAXSWEEP && numRot>0; sweep++) {
+        int_T r;
+        real32_T small = 0.0F;
+        numRot = 0;
+        /* s holds the squared column norms during the sweeps */
+        column_norms(x, n, p, s);
+        for (k=0; k<p; k++) small = MAX(small, s[k]);
+        small *= (n * EPS_real32_T) * (n * EPS_real32_T);
+        for (r=0; r<m-1; r++) {
+            int_T q;
+#if defined(MWVIP_SVD_PARALLEL)
+            #pragma omp parallel for schedule(dynamic) reduction(+:numRot) \
+                if (n*p >= MWVIP_SVD_MIN_PARALLEL)
+#endif
+            for (q=0; q<m/2; q++) {
+                /* player m-1 stays, the others turn around it */
+                int_T a = (q == 0) ? m-1 : (r + q) % (m-1);
+                int_T b = (r - q + m-1) % (m-1);
+                if (a < p && b < p) {
+                    numRot += rotate_pair(x, v, s, small, n, p, MIN(a,b), MAX(a,b), wantv);
+                }
+            }
+        }
+    }
+
+    column_norms(x, n, p, s);
+    for (k=0; k<p; k++) s[k] = sqrtf(s[k]);
+
+    /*
+     * Order the singular values, with the columns of U and V
+     */
+    for (k=0; k<p-1; k++) {
+        int_T kmax = k;
+        for (j=k+1; j<p; j++) {
+            if (s[j] > s[kmax]) kmax = j;
+        }
+        if (kmax != k) {
+            real32_T temp = s[k]; s[k] = s[kmax]; s[kmax] = temp;
+            for (i=0; i<n; i++) {
+                temp = x[k*n+i]; x[k*n+i] = x[kmax*n+i]; x[kmax*n+i] = temp;
+            }
+            if (wantv) {
+                for (i=0; i<p; i++) {
+                    temp = v[k*p+i]; v[k*p+i] = v[kmax*p+i]; v[kmax*p+i] = temp;
+                }
+            }
+        }
+    }
+
+    if (wantv) {
+        for (k=0; k<p; k++) {
+            real32_T scale = (s[k] > n * EPS_real32_T * s[0]) ? 1.0F / s[k] : 0.0F;
+            for (i=0; i<n; i++) x[k*n+i] *= scale;
+        }
+    }
+    return (numRot > 0);
+}
+
+#endif /* !INTEGER_CODE */
+
+/* [EOF] svd_jacobi_r_rt.c */
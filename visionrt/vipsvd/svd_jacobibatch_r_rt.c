@@ -0,0 +1,294 @@
+/*
+ * SVD_JACOBIBATCH_D_RT - One-sided Jacobi singular value decomposition of
+ * a batch of small single precision matrices
+ *
+ *  Copyright 2016 The MathWorks, Inc.
+ *
+ * Abstract:
+ *   MWVIP_SVD_BATCH_LANES matrices are copied to work with their elements
+ *   interleaved, element (i,j) of all of them being contiguous. Every step
+ *   of the cyclic Jacobi sweep is then an inner loop over the matrices,
+ *   which the compiler vectorizes; a matrix whose column pair is already
+ *   orthogonal gets the identity rotation, so all of them follow the same
+ *   control flow. The sweeps stop when no matrix needs any more rotation.
+ */
+
+#if (!defined(INTEGER_CODE) || !INTEGER_CODE)
+
+#include "vipsvd_rt.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define MWVIP_SVD_SSE2 1
+#endif
+
+#define L MWVIP_SVD_BATCH_LANES
+
+/*
+ * Rotation of each lane, t = 0 (c = 1, s = 0) for the lanes whose columns
+ * are already orthogonal; the rotations are counted in laneRot. The square
+ * roots and divisions are done with SIMD instructions, which compilers do
+ * not generate for sqrtf() without relaxing errno.
+ */
+static void rotation_lanes(const real32_T *alpha, const real32_T *beta,
+                           const real32_T *gamma, const real32_T *small,
+                           real32_T tol, real32_T *c, real32_T *sn, real32_T *tb,
+                           int_T *laneRot)
+{
+    int_T b;
+#if defined(MWVIP_SVD_SSE2)
+    const __m128 one  = _mm_set1_ps(1.0F);
+    const __m128 absm = _mm_castsi128_ps(_mm_set1_epi32(0x7FFFFFFF));
+    const __m128 vtol = _mm_set1_ps(tol);
+    for (b=0; b<L; b+=4) {
+        __m128 va = _mm_loadu_ps(alpha+b);
+        __m128 vb = _mm_loadu_ps(beta+b);
+        __m128 vg = _mm_loadu_ps(gamma+b);
+        __m128 thr = _mm_mul_ps(vtol, _mm_mul_ps(_mm_sqrt_ps(va), _mm_sqrt_ps(vb)));
+        /* columns below small are numerically zero and left alone */
+        __m128 rot = _mm_and_ps(_mm_cmpgt_ps(_mm_and_ps(vg, absm), thr),
+                                _mm_cmpgt_ps(_mm_min_ps(va, vb), _mm_loadu_ps(small+b)));
+        /* 2*gamma, or 1 where there is no rotation */
+        __m128 den = _mm_or_ps(_mm_and_ps(rot, _mm_add_ps(vg, vg)),
+                               _mm_andnot_ps(rot, one));
+        __m128 zeta = _mm_div_ps(_mm_sub_ps(vb, va), den);
+        __m128 az   = _mm_and_ps(zeta, absm);
+        __m128 t    = _mm_div_ps(one, _mm_add_ps(az, _mm_sqrt_ps(
+                          _mm_add_ps(one, _mm_mul_ps(zeta, zeta)))));
+        __m128 vc;
+        /* sign of zeta, zero where there is no rotation */
+        t  = _mm_and_ps(rot, _mm_or_ps(t, _mm_andnot_ps(absm, zeta)));
+        vc = _mm_div_ps(one, _mm_sqrt_ps(_mm_add_ps(one, _mm_mul_ps(t, t))));
+        _mm_storeu_ps(c+b, vc);
+        _mm_storeu_ps(sn+b, _mm_mul_ps(vc, t));
+        _mm_storeu_ps(tb+b, t);
+        {
+            int_T mask = _mm_movemask_ps(rot);
+            laneRot[b]   += mask & 1;
+            laneRot[b+1] += (mask >> 1) & 1;
+            laneRot[b+2] += (mask >> 2) & 1;
+            laneRot[b+3] += mask >> 3;
+        }
+    }
+#else
+    for (b=0; b<L; b++) {
+        int_T rot = (fabsf(gamma[b]) > tol * sqrtf(alpha[b]) * sqrtf(beta[b])) &&
+                    (MIN(alpha[b], beta[b]) > small[b]);
+        real32_T zeta = (beta[b] - alpha[b]) / (rot ? 2.0F * gamma[b] : 1.0F);
+        real32_T t = 1.0F / (fabsf(zeta) + sqrtf(1.0F + zeta*zeta));
+        t = rot ? ((zeta < 0.0F) ? -t : t) : 0.0F;
+        c[b]  = 1.0F / sqrtf(1.0F + t*t);
+        sn[b] = c[b] * t;
+        tb[b] = t;
+        laneRot[b] += rot;
+    }
+#endif
+}
+
+/*
+ * Rotate len interleaved rows of the column pairs x and y
+ */
+static void rotate_lanes(real32_T *x, real32_T *y, int_T len,
+                         const real32_T *c, const real32_T *sn)
+{
+    int_T k, b;
+#if defined(MWVIP_SVD_SSE2)
+    __m128 vc[L/4], vs[L/4];
+    for (b=0; b<L/4; b++) {
+        vc[b] = _mm_loadu_ps(c+4*b);
+        vs[b] = _mm_loadu_ps(sn+4*b);
+    }
+    for (k=0; k<len*L; k+=L) {
+        for (b=0; b<L/4; b++) {
+            __m128 x0 = _mm_loadu_ps(x+k+4*b);
+            __m128 y0 = _mm_loadu_ps(y+k+4*b);
+            _mm_storeu_ps(x+k+4*b, _mm_sub_ps(_mm_mul_ps(vc[b], x0), _mm_mul_ps(vs[b], y0)));
+            _mm_storeu_ps(y+k+4*b, _mm_add_ps(_mm_mul_ps(vs[b], x0), _mm_mul_ps(vc[b], y0)));
+        }
+    }
+#else
+    for (k=0; k<len*L; k+=L) {
+        for (b=0; b<L; b++) {
+            real32_T x0 = x[k+b];
+            x[k+b] = c[b] * x0 - sn[b] * y[k+b];
+            y[k+b] = sn[b] * x0 + c[b] * y[k+b];
+        }
+    }
+#endif
+}
+
+/*
+ * Dot products of len interleaved rows of the column pairs x and y
+ */
+static void dot_lanes(const real32_T *x, const real32_T *y, int_T len,
+                      real32_T *d)
+{
+    int_T k, b;
+#if defined(MWVIP_SVD_SSE2)
+    __m128 acc[L/4];
+    for (b=0; b<L/4; b++) acc[b] = _mm_setzero_ps();
+    for (k=0; k<len*L; k+=L) {
+        for (b=0; b<L/4; b++) {
+            acc[b] = _mm_add_ps(acc[b], _mm_mul_ps(_mm_loadu_ps(x+k+4*b),
+                                                  _mm_loadu_ps(y+k+4*b)));
+        }
+    }
+    for (b=0; b<L/4; b++) _mm_storeu_ps(d+4*b, acc[b]);
+#else
+    for (b=0; b<L; b++) d[b] = 0.0F;
+    for (k=0; k<len*L; k+=L) {
+        for (b=0; b<L; b++) d[b] += x[k+b] * y[k+b];
+    }
+#endif
+}
+
+/*
+ * Squared norm below which a column is numerically zero, relative to the
+ * largest column of each matrix; without it the columns of a rank
+ * deficient matrix, such as the DLT matrices of RANSAC, keep rotating on
+ * rounding noise
+ */
+static void squared_norm_floor(const real32_T *nrm, int_T p, real32_T tol,
+                               real32_T *small)
+{
+    int_T j, b;
+    for (b=0; b<L; b++) small[b] = 0.0F;
+    for (j=0; j<p; j++) {
+        for (b=0; b<L; b++) small[b] = MAX(small[b], nrm[j*L+b]);
+    }
+    for (b=0; b<L; b++) small[b] *= tol * tol;
+}
+
+/*
+ * One cyclic sweep over the column pairs of the interleaved matrices a
+ * (n x p) and v (p x p), counting the rotations of each lane in laneRot;
+ * returns the number of rotations of all the lanes. The squared
+ * column norms nrm are computed once per sweep and then updated with
+ * each rotation, which leaves one dot product per pair.
+ */
+static int_T sweep_lanes(real32_T *a, real32_T *v, real32_T *nrm,
+                         int_T n, int_T p, int_T wantv, int_T *laneRot)
+{
+    const real32_T tol = n * EPS_real32_T;
+    int_T i, j, b, numRot = 0;
+
+    real32_T small[L];
+
+    for (j=0; j<p; j++) {
+        dot_lanes(a + j*n*L, a + j*n*L, n, nrm + j*L);
+    }
+    squared_norm_floor(nrm, p, tol, small);
+    for (b=0; b<L; b++) laneRot[b] = 0;
+
+    for (i=0; i<p-1; i++) {
+        for (j=i+1; j<p; j++) {
+            real32_T gamma[L], c[L], sn[L], t[L];
+            real32_T *ni = nrm + i*L, *nj = nrm + j*L;
+            dot_lanes(a + i*n*L, a + j*n*L, n, gamma);
+            rotation_lanes(ni, nj, gamma, small, tol, c, sn, t, laneRot);
+            for (b=0; b<L; b++) {
+                ni[b] -= t[b] * gamma[b];
+                nj[b] += t[b] * gamma[b];
+            }
+            rotate_lanes(a + i*n*L, a + j*n*L, n, c, sn);
+            if (wantv) {
+                rotate_lanes(v + i*p*L, v + j*p*L, p, c, sn);
+            }
+        }
+    }
+    for (b=0; b<L; b++) numRot += laneRot[b];
+    return numRot;
+}
+
+LIBMWVISIONRT_API int_T MWVIP_SVD_JacobiBatch_R(const real32_T *x,
+                                             int_T n,
+                                             int_T p,
+                                             int_T numMats,
+                                             real32_T *s,
+                                             real32_T *u,
+                                             real32_T *v,
+                                             int_T wantv,
+                                             real32_T *work)
+{
+    const int_T np = n*p, pp = p*p;
+    real32_T *a  = work;
+    real32_T *va = work + L*np;
+    real32_T *nrm = va + L*pp;
+    int_T info = 0;
+    int_T m0;
+
+    for (m0=0; m0<numMats; m0+=L) {
+        int_T nb = MIN(L, numMats-m0);
+        int_T sweep, numRot = 1;
+        int_T laneRot[L];
+        int_T i, j, k, b;
+
+        /* interleave the matrices; unused lanes hold zeros, which are
+         * never rotated */
+        for (k=0; k<np; k++) {
+            for (b=0; b<L; b++) {
+                a[k*L+b] = (b < nb) ? x[(m0+b)*np + k] : 0.0F;
+            }
+        }
+        if (wantv) {
+            for (k=0; k<pp*L; k++)  va[k] = 0.0F;
+            for (k=0; k<p; k++) {
+                for (b=0; b<L; b++) va[k*(p+1)*L+b] = 1.0F;
+            }
+        }
+
+        for (sweep=0; sweep<MWVIP_SVD_JACOBI_MAXSWEEP && numRot>0; sweep++) {
+            numRot = sweep_lanes(a, va, nrm, n, p, wantv, laneRot);
+        }
+        /* the matrices that still rotate did not converge */
+        for (b=0; b<nb; b++) {
+            info += (laneRot[b] > 0);
+        }
+
+        /* de-interleave, ordering the singular values */
+        for (b=0; b<nb; b++) {
+            real32_T *sb = s + (m0+b)*p;
+            for (k=0; k<p; k++) {
+                real32_T nrm = 0.0F;
+                for (i=0; i<n; i++) nrm += a[(k*n+i)*L+b] * a[(k*n+i)*L+b];
+                sb[k] = sqrtf(nrm);
+            }
+            for (k=0; k<p-1; k++) {
+                int_T kmax = k;
+                real32_T temp;
+                for (j=k+1; j<p; j++) {
+                    if (sb[j] > sb[kmax]) kmax = j;
+                }
+                if (kmax != k) {
+                    temp = sb[k]; sb[k] = sb[kmax]; sb[kmax] = temp;
+                    for (i=0; i<n; i++) {
+                        temp = a[(k*n+i)*L+b];
+                        a[(k*n+i)*L+b] = a[(kmax*n+i)*L+b];
+                        a[(kmax*n+i)*L+b] = temp;
+                    }
+                    if (wantv) {
+                        for (i=0; i<p; i++) {
+                            temp = va[(k*p+i)*L+b];
+                            va[(k*p+i)*L+b] = va[(kmax*p+i)*L+b];
+                            va[(kmax*p+i)*L+b] = temp;
+                        }
+                    }
+                }
+            }
+            if (wantv) {
+                real32_T *ub = u + (m0+b)*np;
+                real32_T *vb = v + (m0+b)*pp;
+                for (k=0; k<p; k++) {
+                    real32_T scale = (sb[k] > n * EPS_real32_T * sb[0]) ? 1.0F / sb[k] : 0.0F;
+                    for (i=0; i<n; i++) ub[k*n+i] = a[(k*n+i)*L+b] * scale;
+                }
+                for (k=0; k<pp; k++) vb[k] = va[k*L+b];
+            }
+        }
+    }
+    return info;
+}
+
+#endif /* !INTEGER_CODE */
+
+/* [EOF] svd_jacobibatch_r_rt.c */
@@ -0,0 +1,198 @@
+/*
+ * SVD_RANDOMIZED_R_RT - Randomized truncated singular value decomposition
+ * of a large single precision matrix
+ *
+ *  Copyright 2016 The MathWorks, Inc.
+ *
+ * Abstract:
+ *   The range of x is sampled with l = k + oversample Gaussian test
+ *   vectors, Y = x*Omega, refined by numPowerIter power iterations
+ *   Y = x*(x'*Y) with re-orthonormalization in between, and orthonormalized
+ *   to Q. The small l x p matrix B = Q'*x is decomposed with the one-sided
+ *   Jacobi SVD of B', and the top k singular triplets are lifted back:
+ *   U = Q*W, V the right singular vectors of B.
+ *
+ *   Only the products with x touch the n x p matrix. They are blocked over
+ *   MWVIP_SVD_RAND_BLOCK rows of x, so that a block of x stays in cache
+ *   while it is multiplied by every test vector, and the blocks (or the
+ *   columns of x for x'*Q) are spread over OpenMP threads.
+ */
+
+#if (!defined(INTEGER_CODE) || !INTEGER_CODE)
+
+#include "vipsvd_rt.h"
+
+/*
+ * Gaussian test matrix from a xorshift generator and Box-Muller, so that
+ * a seed always gives the same decomposition
+ */
+static uint32_T next_random(uint32_T *state)
+{
+    uint32_T r = *state;
+    r ^= r << 13;
+    r ^= r >> 17;
+    r ^= r << 5;
+    *state = r;
+    return r;
+}
+
+static void gaussian_matrix(real32_T *omega, int_T numel, uint32_T seed)
+{
+    uint32_T state = (seed != 0U) ? seed : 0x9E3779B9U;
+    int_T k;
+    for (k=0; k<numel; k+=2) {
+        /* uniform in (0, 1] and [0, 1) */
+        real32_T u1 = ((real32_T)next_random(&state) + 1.0F) / 4294967296.0F;
+        real32_T u2 = (real32_T)next_random(&state) / 4294967296.0F;
+        real32_T r  = sqrtf(-2.0F * logf(u1));
+        omega[k] = r * cosf(2.0F * 3.14159265F * u2);
+        if (k+1 < numel) {
+            omega[k+1] = r * sinf(2.0F * 3.14159265F * u2);
+        }
+    }
+}
+
+/*
+ * y (n x l) = x (n x p) * b (p x l), blocked over rows of x
+ */
+static void mult_x_b(const real32_T *x, const real32_T *b, real32_T *y,
+                     int_T n, int_T p, int_T l)
+{
+    const int_T numBlocks = (n + MWVIP_SVD_RAND_BLOCK - 1) / MWVIP_SVD_RAND_BLOCK;
+    int_T blk;
+#if defined(MWVIP_SVD_PARALLEL)
+    #pragma omp parallel for if (n*p >= MWVIP_SVD_MIN_PARALLEL)
+#endif
+    for (blk=0; blk<numBlocks; blk++) {
+        const int_T r0 = blk * MWVIP_SVD_RAND_BLOCK;
+        const int_T r1 = MIN(r0 + MWVIP_SVD_RAND_BLOCK, n);
+        int_T i, j, c;
+        for (j=0; j<l; j++) {
+            real32_T *yj = y + j*n;
+            for (i=r0; i<r1; i++) yj[i] = 0.0F;
+        }
+        for (c=0; c<p; c++) {
+            const real32_T *xc = x + c*n;
+            for (j=0; j<l; j++) {
+                const real32_T bcj = b[j*p + c];
+                real32_T *yj = y + j*n;
+                for (i=r0; i<r1; i++) yj[i] += xc[i] * bcj;
+            }
+        }
+    }
+}
+
+/*
+ * z (p x l) = x' (p x n) * q (n x l): dot products of the columns of x
+ * with those of q, each column of x being read once per row block
+ */
+static void mult_xt_q(const real32_T *x, const real32_T *q, real32_T *z,
+                      int_T n, int_T p, int_T l)
+{
+    int_T c;
+#if defined(MWVIP_SVD_PARALLEL)
+    #pragma omp parallel for if (n*p >= MWVIP_SVD_MIN_PARALLEL)
+#endif
+    for (c=0; c<p; c++) {
+        const real32_T *xc = x + c*n;
+        int_T r0, i, j;
+        for (j=0; j<l; j++) z[j*p + c] = 0.0F;
+        for (r0=0; r0<n; r0+=MWVIP_SVD_RAND_BLOCK) {
+            const int_T r1 = MIN(r0 + MWVIP_SVD_RAND_BLOCK, n);
+            for (j=0; j<l; j++) {
+                const real32_T *qj = q + j*n;
+                real32_T sum = 0.0F;
+                for (i=r0; i<r1; i++) sum += xc[i] * qj[i];
+                z[j*p + c] += sum;
+            }
+        }
+    }
+}
+
+/*
+ * Orthonormalizes the l columns of y (n x l) in place, by modified
+ * Gram-Schmidt applied twice. Columns that vanish against the previous
+ * ones, as for a matrix of rank below l, are set to zero.
+ */
+static void orthonormalize(real32_T *y, int_T n, int_T l)
+{
+    int_T i, j, k, pass;
+    for (j=0; j<l; j++) {
+        real32_T *yj = y + j*n;
+        real32_T nrm0 = 0.0F, nrm = 0.0F;
+        for (i=0; i<n; i++) nrm0 += yj[i] * yj[i];
+        for (pass=0; pass<2; pass++) {
+            for (k=0; k<j; k++) {
+                const real32_T *yk = y + k*n;
+                real32_T dot = 0.0F;
+                for (i=0; i<n; i++) dot += yk[i] * yj[i];
+                for (i=0; i<n; i++) yj[i] -= dot * yk[i];
+            }
+        }
+        for (i=0; i<n; i++) nrm += yj[i] * yj[i];
+        nrm = (nrm > n * EPS_real32_T * nrm0 && nrm > 0.0F) ? 1.0F / sqrtf(nrm) : 0.0F;
+        for (i=0; i<n; i++) yj[i] *= nrm;
+    }
+}
+
+LIBMWVISIONRT_API int_T MWVIP_SVD_Randomized_R(const real32_T *x,
+                                            int_T n,
+                                            int_T p,
+                                            int_T k,
+                                            int_T oversample,
+                                            int_T numPowerIter,
+                                            uint32_T seed,
+                                            real32_T *s,
+                                            real32_T *u,
+                                            real32_T *v,
+                                            int_T wantv,
+                                            real32_T *work)
+{
+    const int_T l = MWVIP_SVD_RANDOMIZED_RANK(n, p, k, oversample);
+    real32_T *q  = work;           /* n x l: samples of the range, then Q */
+    real32_T *z  = q + n*l;        /* p x l: test vectors, then x'*Q */
+    real32_T *bt = z + p*l;        /* p x l: B', then V of B */
+    real32_T *w  = bt + p*l;       /* l x l: U of B */
+    real32_T *sb = w + l*l;        /* l: singular values of B */
+    int_T it, j, status;
+
+    k = MIN(k, l);
+    if (k <= 0) return 0;
+
+    gaussian_matrix(z, p*l, seed);
+    mult_x_b(x, z, q, n, p, l);
+    for (it=0; it<numPowerIter; it++) {
+        orthonormalize(q, n, l);
+        mult_xt_q(x, q, z, n, p, l);
+        orthonormalize(z, p, l);
+        mult_x_b(x, z, q, n, p, l);
+    }
+    orthonormalize(q, n, l);
+
+    /* B' = x'*Q = V*S*W', so B = W*S*V' and x ~ (Q*W)*S*V' */
+    mult_xt_q(x, q, bt, n, p, l);
+    status = MWVIP_SVD_Jacobi_R(bt, p, l, sb, w, wantv);
+    for (j=0; j<k; j++) s[j] = sb[j];
+    if (!wantv) return status;
+
+#if defined(MWVIP_SVD_PARALLEL)
+    #pragma omp parallel for if (n*l >= MWVIP_SVD_MIN_PARALLEL)
+#endif
+    for (j=0; j<k; j++) {
+        const real32_T *wj = w + j*l;
+        real32_T *uj = u + j*n;
+        int_T i, c;
+        for (i=0; i<n; i++) uj[i] = 0.0F;
+        for (c=0; c<l; c++) {
+            const real32_T *qc = q + c*n;
+            const real32_T wcj = wj[c];
+            for (i=0; i<n; i++) uj[i] += qc[i] * wcj;
+        }
+        for (i=0; i<p; i++) v[j*p + i] = bt[j*p + i];
+    }
+    return status;
+}
+
+#endif /* !INTEGER_CODE */
+
+/* [EOF] svd_randomized_r_rt.c */